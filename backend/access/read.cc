@@ -16,7 +16,11 @@
 
 #include "backend/access/read.h"
 
+#include <cstdint>
 #include <ostream>
+#include <vector>
+
+#include "zetasql/public/value.h"
 
 namespace google {
 namespace spanner {
@@ -40,10 +44,37 @@ std::ostream& operator<<(std::ostream& out, const ReadArg& arg) {
     out << "'" << arg.columns[i] << "'";
   }
   out << "]\n";
+  if (arg.sample.has_value()) {
+    if (arg.sample->method == RowSample::Method::kBernoulli) {
+      out << "Sample : BERNOULLI " << arg.sample->fraction << "\n";
+    } else {
+      out << "Sample : RESERVOIR " << arg.sample->num_rows << " ROWS\n";
+    }
+  }
+  if (arg.limit > 0) {
+    out << "Limit  : " << arg.limit << "\n";
+  }
 
   return out;
 }
 
+bool RowCursor::NextBatch(int64_t max_rows,
+                          std::vector<std::vector<zetasql::Value>>* rows) {
+  int64_t num_rows = 0;
+  while (num_rows < max_rows && Next()) {
+    if (num_rows == rows->size()) {
+      rows->emplace_back();
+    }
+    std::vector<zetasql::Value>& row = (*rows)[num_rows++];
+    row.resize(NumColumns());
+    for (int i = 0; i < row.size(); ++i) {
+      row[i] = ColumnValue(i);
+    }
+  }
+  rows->resize(num_rows);
+  return num_rows > 0;
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -17,6 +17,9 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACCESS_READ_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACCESS_READ_H_
 
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -25,6 +28,7 @@
 #include "zetasql/public/value.h"
 #include "absl/status/status.h"
 #include "backend/datamodel/key_set.h"
+#include "backend/storage/row_sampler.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -32,6 +36,8 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
+class Column;
+
 // ReadArg specifies a read request for a single database table.
 //
 // key_set is allowed to have overlapping keys and ranges. Each unique row that
@@ -57,15 +63,35 @@ struct ReadArg {
   // Set of columns to read.
   std::vector<std::string> columns;
 
+  // The schema columns `columns` were resolved to by the producer of this read
+  // (e.g. a query scanning a table), if any. Readers use them in place of
+  // looking `columns` up by name when they are columns of the table read in the
+  // reader's schema.
+  std::vector<const Column*> resolved_columns;
+
   // Whether to allow reading pending commit timestamps. This should only be
   // enabled when enforcement is implemented elsewhere (e.g. queries have this
   // enforced in QueryValidator).
   bool allow_pending_commit_timestamps = false;
+
+  // If set, only a random sample of the rows read is returned, still in key
+  // order. Readers which support sampling skip the rows outside of the sample
+  // without materializing them.
+  std::optional<RowSample> sample;
+
+  // If positive, only the first `limit` rows read (of the sample, if any) are
+  // returned. Readers stop fetching rows from storage once the limit is
+  // reached.
+  int64_t limit = 0;
 };
 
 // Streams a debug string representation of ReadArg to out.
 std::ostream& operator<<(std::ostream& out, const ReadArg& arg);
 
+// Number of rows consumers which process whole results ask RowCursor::NextBatch
+// for at a time.
+inline constexpr int64_t kRowCursorBatchSize = 1024;
+
 // RowCursor is an abstract interface for iterating over rows.
 //
 // All rows will have the same number of columns, column types, and column
@@ -81,6 +107,15 @@ std::ostream& operator<<(std::ostream& out, const ReadArg& arg);
 //       }
 //     }
 //     ZETASQL_RETURN_IF_ERROR(cursor->Status());
+//
+// Consumers of many rows can instead move past a batch of rows at a time:
+//     std::vector<std::vector<zetasql::Value>> rows;
+//     while (cursor->NextBatch(kRowCursorBatchSize, &rows)) {
+//       for (const std::vector<zetasql::Value>& row : rows) {
+//         ...
+//       }
+//     }
+//     ZETASQL_RETURN_IF_ERROR(cursor->Status());
 class RowCursor {
  public:
   virtual ~RowCursor() {}
@@ -90,6 +125,17 @@ class RowCursor {
   // cases, use Status().
   virtual bool Next() = 0;
 
+  // Moves past up to `max_rows` rows and stores their values in `rows`, which
+  // is resized to the number of rows moved past. The value vectors of `rows`
+  // are reused across calls. Returns false if no rows were moved past because
+  // the result set is exhausted or the iterator encountered an error. A call
+  // to ColumnValue() is only valid after a later call to Next() returned true.
+  //
+  // The default implementation calls Next() and ColumnValue() for each row.
+  // Cursors override it to save these virtual calls per row and value.
+  virtual bool NextBatch(int64_t max_rows,
+                         std::vector<std::vector<zetasql::Value>>* rows);
+
   // Returns the status of the iterator. Once the iterator enters an error
   // state, it remains in the error state. Calls to Next() will return
   // false in this state.
@@ -122,6 +168,18 @@ class RowReader {
   // Reads rows from a database based on the provided read_arg.
   virtual absl::Status Read(const ReadArg& read_arg,
                             std::unique_ptr<RowCursor>* cursor) = 0;
+
+  // Reads the same rows as Read, as one cursor per contiguous key range of
+  // about `rows_per_split` rows, in key order. Unlike the cursors returned by
+  // Read, these cursors may be iterated concurrently on different threads.
+  //
+  // Readers which do not support concurrent iteration return no cursors, in
+  // which case the rows must be read with Read.
+  virtual absl::Status ReadSplits(
+      const ReadArg& read_arg, int64_t rows_per_split,
+      std::vector<std::unique_ptr<RowCursor>>* cursors) {
+    return absl::OkStatus();
+  }
 };
 
 }  // namespace backend
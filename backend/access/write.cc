@@ -28,9 +28,10 @@ namespace backend {
 
 void Mutation::AddWriteOp(MutationOpType type, const std::string& table,
                           std::vector<std::string> columns,
-                          std::vector<ValueList> values) {
-  ops_.emplace_back(
-      MutationOp(type, table, std::move(columns), std::move(values)));
+                          std::vector<ValueList> values,
+                          std::vector<const Column*> resolved_columns) {
+  ops_.emplace_back(MutationOp(type, table, std::move(columns),
+                               std::move(values), std::move(resolved_columns)));
 }
 
 void Mutation::AddDeleteOp(const std::string& table, const KeySet& key_set) {
@@ -33,6 +33,8 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
+class Column;
+
 // MutationOpType enumerates the type of mutation operations.
 enum class MutationOpType {
   kInsert,
@@ -47,10 +49,12 @@ struct MutationOp {
   MutationOp() {}
 
   MutationOp(MutationOpType type, const std::string& table,
-             std::vector<std::string>&& columns, std::vector<ValueList>&& rows)
+             std::vector<std::string>&& columns, std::vector<ValueList>&& rows,
+             std::vector<const Column*>&& resolved_columns = {})
       : type(type),
         table(table),
         columns(std::move(columns)),
+        resolved_columns(std::move(resolved_columns)),
         rows(std::move(rows)) {}
 
   MutationOp(MutationOpType type, const std::string& table,
@@ -67,6 +71,13 @@ struct MutationOp {
 
   // Mutation data for kInsert, kUpdate, kInsertOrUpdate, and kReplace.
   std::vector<std::string> columns;
+
+  // The schema columns `columns` were resolved to by the producer of this
+  // mutation (e.g. the frontend decoding its values), if any. Consumers use
+  // them in place of looking `columns` up by name when they are columns of the
+  // table written in the consumer's schema.
+  std::vector<const Column*> resolved_columns;
+
   std::vector<ValueList> rows;
 
   // Mutation data for kDelete.
@@ -87,7 +98,8 @@ class Mutation {
   // this Mutation.
   void AddWriteOp(MutationOpType type, const std::string& table,
                   std::vector<std::string> columns,
-                  std::vector<ValueList> values);
+                  std::vector<ValueList> values,
+                  std::vector<const Column*> resolved_columns = {});
 
   // Adds a Delete MutationOp to this Mutation.
   void AddDeleteOp(const std::string& table, const KeySet& key_set);
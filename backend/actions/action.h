@@ -20,6 +20,7 @@
 #include <string>
 
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "backend/actions/context.h"
 #include "backend/actions/ops.h"
 #include "backend/schema/catalog/table.h"
@@ -54,6 +55,13 @@ class Validator {
   // Validates the given WriteOp within the give action context.
   absl::Status Validate(const ActionContext* ctx, const WriteOp& op) const;
 
+  // Validates all the given WriteOps, which are on distinct rows of the same
+  // table and have the same op type, stopping at the first violation.
+  // Validators which look up rows override this to batch the lookups of all
+  // operations.
+  virtual absl::Status ValidateBatch(const ActionContext* ctx,
+                                     absl::Span<const WriteOp> ops) const;
+
  private:
   virtual absl::Status Validate(const ActionContext* ctx,
                                 const InsertOp& op) const;
@@ -136,6 +144,12 @@ class Effector {
   // action context.
   absl::Status Effect(const ActionContext* ctx, const WriteOp& op) const;
 
+  // Creates additional WriteOp(s) for all the given WriteOps, which are on the
+  // same table and have the same op type. Effectors which look up rows
+  // override this to batch the lookups of all operations.
+  virtual absl::Status EffectBatch(const ActionContext* ctx,
+                                   absl::Span<const WriteOp> ops) const;
+
  private:
   virtual absl::Status Effect(const ActionContext* ctx,
                               const InsertOp& op) const;
@@ -155,6 +169,12 @@ class Verifier {
   // context.
   absl::Status Verify(const ActionContext* ctx, const WriteOp& op) const;
 
+  // Executes the verification on all WriteOps of a statement which apply to
+  // this verifier, stopping at the first violation. Verifiers which look up
+  // rows override this to batch the lookups of all operations.
+  virtual absl::Status VerifyBatch(const ActionContext* ctx,
+                                   absl::Span<const WriteOp> ops) const;
+
  private:
   virtual absl::Status Verify(const ActionContext* ctx,
                               const InsertOp& op) const;
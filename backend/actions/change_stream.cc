@@ -30,6 +30,7 @@
 #include "zetasql/public/types/type.h"
 #include "zetasql/public/types/type_factory.h"
 #include "zetasql/public/value.h"
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
@@ -37,6 +38,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "google/cloud/spanner/bytes.h"
 #include "backend/actions/context.h"
@@ -57,6 +59,7 @@
 #include "nlohmann/json_fwd.hpp"
 #include "nlohmann/json.hpp"
 #include "third_party/spanner_pg/datatypes/extended/spanner_extended_type.h"
+#include "zetasql/base/ret_check.h"
 #include "zetasql/base/status_macros.h"
 namespace google {
 namespace spanner {
@@ -88,14 +91,31 @@ RetrieveTableWithTrackedChangeStreams(const Schema* schema) {
 }
 
 absl::StatusOr<zetasql::Value> RetrieveChangeStreamWithPartitionToken(
-    ReadOnlyStore* store, const ChangeStream* change_stream) {
+    ReadOnlyStore* store, const ChangeStream* change_stream,
+    ActivePartitionTokenCache* partition_token_cache) {
+  const Table* partition_table = change_stream->change_stream_partition_table();
   std::vector<const Column*> read_columns = {
-      change_stream->change_stream_partition_table()->FindColumn(
-          "partition_token"),
-      change_stream->change_stream_partition_table()->FindColumn("end_time")};
-  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<StorageIterator> itr,
-                   store->Read(change_stream->change_stream_partition_table(),
-                               KeyRange::All(), read_columns));
+      partition_table->FindColumn("partition_token"),
+      partition_table->FindColumn("end_time")};
+  if (partition_token_cache != nullptr) {
+    std::optional<std::string> cached_token =
+        partition_token_cache->Get(partition_table->id());
+    if (cached_token.has_value()) {
+      ZETASQL_ASSIGN_OR_RETURN(
+          std::unique_ptr<StorageIterator> itr,
+          store->Read(partition_table,
+                      KeyRange::Point(
+                          Key({zetasql::Value::String(*cached_token)})),
+                      read_columns));
+      if (itr->Next() && itr->ColumnValue(1).is_null()) {
+        return zetasql::Value::String(*cached_token);
+      }
+      ZETASQL_RETURN_IF_ERROR(itr->Status());
+    }
+  }
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::unique_ptr<StorageIterator> itr,
+      store->Read(partition_table, KeyRange::All(), read_columns));
   std::vector<std::string> active_partition_tokens;
   while (itr->Next()) {
     // Find active partitions by filtering partitions with the end_time equal
@@ -105,8 +125,13 @@ absl::StatusOr<zetasql::Value> RetrieveChangeStreamWithPartitionToken(
       active_partition_tokens.push_back(itr->ColumnValue(0).string_value());
     }
   }
-  std::sort(active_partition_tokens.begin(), active_partition_tokens.end());
-  return zetasql::Value::String(active_partition_tokens[0]);
+  ZETASQL_RETURN_IF_ERROR(itr->Status());
+  ZETASQL_RET_CHECK(!active_partition_tokens.empty());
+  const std::string& token = *absl::c_min_element(active_partition_tokens);
+  if (partition_token_cache != nullptr) {
+    partition_token_cache->Set(partition_table->id(), token);
+  }
+  return zetasql::Value::String(token);
 }
 
 bool IsPrimaryKey(const Table* table, const Column* column) {
@@ -185,15 +210,32 @@ DataChangeRecord BuildDataChangeRecord(
   return record;
 }
 
-absl::StatusOr<ValueList> RetrieveExistingValues(
-    const Table* table, std::vector<std::string> non_key_columns,
-    const Key& key, ReadOnlyStore* store) {
-  std::vector<const Column*> columns;
-  columns.reserve(non_key_columns.size());
-  for (const std::string& col : non_key_columns) {
-    columns.push_back(table->FindColumn(col));
+absl::StatusOr<ValueList> CommittedRow::GetValues(
+    const std::vector<std::string>& column_names) {
+  if (!values_.has_value()) {
+    std::vector<const Column*> columns;
+    for (const Column* column : table_->columns()) {
+      if (!IsPrimaryKey(table_, column)) {
+        columns.push_back(column);
+      }
+    }
+    ZETASQL_ASSIGN_OR_RETURN(ValueList values,
+                     store_->ReadCommitted(table_, key_, columns));
+    values_.emplace();
+    for (int i = 0; i < values.size(); ++i) {
+      values_->emplace(columns[i]->Name(), std::move(values[i]));
+    }
+  }
+  ValueList values;
+  if (values_->empty()) {
+    return values;
+  }
+  values.reserve(column_names.size());
+  for (const std::string& name : column_names) {
+    auto it = values_->find(name);
+    ZETASQL_RET_CHECK(it != values_->end()) << "Unknown column " << name;
+    values.push_back(it->second);
   }
-  ZETASQL_ASSIGN_OR_RETURN(ValueList values, store->ReadCommitted(table, key, columns));
   return values;
 }
 
@@ -227,8 +269,7 @@ std::vector<const Column*> GetColumnsForDataChangeRecord(
 // Gets the old values for the recorded columns in a data change record.
 absl::StatusOr<std::vector<zetasql::Value>> GetOldValuesForDataChangeRecord(
     absl::string_view value_capture_type, absl::string_view mod_type,
-    const Table* tracked_table, const Key& key, ReadOnlyStore* store,
-    const std::vector<std::string>& non_key_cols,
+    CommittedRow* committed_row, const std::vector<std::string>& non_key_cols,
     const absl::flat_hash_set<std::string>& modified_tracked_column_names) {
   // For inserts in all value capture types or al mod types in NEW_ROW and
   // NEW_VALUES, we don't need the old values.
@@ -238,9 +279,8 @@ absl::StatusOr<std::vector<zetasql::Value>> GetOldValuesForDataChangeRecord(
     return std::vector<zetasql::Value>();
   }
 
-  ZETASQL_ASSIGN_OR_RETURN(
-      std::vector<zetasql::Value> old_values,
-      RetrieveExistingValues(tracked_table, non_key_cols, key, store));
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<zetasql::Value> old_values,
+                   committed_row->GetValues(non_key_cols));
 
   if (value_capture_type == kChangeStreamValueCaptureTypeNewRowOldValues &&
       mod_type == kUpdate) {
@@ -259,8 +299,7 @@ absl::StatusOr<std::vector<zetasql::Value>> GetNewValuesForDataChangeRecord(
     const Table* tracked_table,
     const std::vector<std::string> modified_tracked_columns_names,
     const std::vector<zetasql::Value>& modified_tracked_values,
-    const Key& key, ReadOnlyStore* store,
-    std::vector<const Column*> tracked_columns) {
+    CommittedRow* committed_row, std::vector<const Column*> tracked_columns) {
   std::vector<zetasql::Value> new_values_for_tracked_cols;
   if (mod_type == kDelete ||
       (mod_type == kUpdate &&
@@ -298,7 +337,7 @@ absl::StatusOr<std::vector<zetasql::Value>> GetNewValuesForDataChangeRecord(
     ZETASQL_ASSIGN_OR_RETURN(
         std::vector<zetasql::Value>
             existing_values_for_tracked_unpopulated_cols,
-        RetrieveExistingValues(tracked_table, unpopulated_cols, key, store));
+        committed_row->GetValues(unpopulated_cols));
 
     absl::flat_hash_map<std::string, zetasql::Value> unpopulated_col_to_value;
     for (int i = 0; i < unpopulated_cols.size(); i++) {
@@ -327,7 +366,7 @@ absl::Status LogTableMod(
     TransactionID transaction_id,
     absl::flat_hash_map<const ChangeStream*, ModGroup>*
         last_mod_group_by_change_stream,
-    ReadOnlyStore* store) {
+    CommittedRow* committed_row) {
   std::string value_capture_type =
       change_stream->value_capture_type().has_value()
           ? change_stream->value_capture_type().value()
@@ -365,7 +404,7 @@ absl::Status LogTableMod(
                    GetNewValuesForDataChangeRecord(
                        value_capture_type, mod_type, tracked_table,
                        modified_tracked_column_names, modified_tracked_values,
-                       key, store, tracked_columns));
+                       committed_row, tracked_columns));
 
   std::vector<zetasql::Value> new_values_for_tracked_cols;
   std::vector<zetasql::Value> old_values_for_tracked_cols;
@@ -389,7 +428,7 @@ absl::Status LogTableMod(
   ZETASQL_ASSIGN_OR_RETURN(
       old_values_for_tracked_cols,
       GetOldValuesForDataChangeRecord(
-          value_capture_type, mod_type, tracked_table, key, store, non_key_cols,
+          value_capture_type, mod_type, committed_row, non_key_cols,
           absl::flat_hash_set<std::string>{
               modified_tracked_column_names.begin(),
               modified_tracked_column_names.end()}));
@@ -414,8 +453,11 @@ absl::Status LogTableMod(
         non_key_cols.begin(), non_key_cols.end()};
     (*last_mod_group_by_change_stream)[change_stream].column_types = {
         column_types.begin(), column_types.end()};
-    Mod mod{tracked_table->primary_key(), non_key_cols, key.column_values(),
-            new_values_for_tracked_cols, old_values_for_tracked_cols};
+    Mod mod{tracked_table->primary_key(),
+            non_key_cols,
+            {key.column_values().begin(), key.column_values().end()},
+            new_values_for_tracked_cols,
+            old_values_for_tracked_cols};
     (*last_mod_group_by_change_stream)[change_stream].mods.push_back(mod);
   }
   return absl::OkStatus();
@@ -439,15 +481,18 @@ GetTrackedColumnsAndValues(std::vector<const Column*> columns,
   return std::make_pair(tracked_columns, tracked_values);
 }
 
+// Same as LogTableMod, but reading the committed values of the modified row
+// through `committed_row`, which may be shared by all the change streams
+// tracking the table of `op`.
 absl::Status LogTableMod(
-    WriteOp op, const ChangeStream* change_stream,
+    const WriteOp& op, const ChangeStream* change_stream,
     zetasql::Value partition_token,
     absl::flat_hash_map<const ChangeStream*, std::vector<DataChangeRecord>>*
         data_change_records_in_transaction_by_change_stream,
     TransactionID transaction_id,
     absl::flat_hash_map<const ChangeStream*, ModGroup>*
         last_mod_group_by_change_stream,
-    ReadOnlyStore* store) {
+    CommittedRow* committed_row) {
   ZETASQL_RETURN_IF_ERROR(std::visit(
       overloaded{
           [&](const InsertOp& op) -> absl::Status {
@@ -463,7 +508,8 @@ absl::Status LogTableMod(
                 tracked_columns_and_values.second, op.table, change_stream,
                 kInsert, partition_token,
                 data_change_records_in_transaction_by_change_stream,
-                transaction_id, last_mod_group_by_change_stream, store));
+                transaction_id, last_mod_group_by_change_stream,
+                committed_row));
             return absl::OkStatus();
           },
           [&](const UpdateOp& op) -> absl::Status {
@@ -479,7 +525,8 @@ absl::Status LogTableMod(
                 tracked_columns_and_values.second, op.table, change_stream,
                 kUpdate, partition_token,
                 data_change_records_in_transaction_by_change_stream,
-                transaction_id, last_mod_group_by_change_stream, store));
+                transaction_id, last_mod_group_by_change_stream,
+                committed_row));
             return absl::OkStatus();
           },
           [&](const DeleteOp& op) -> absl::Status {
@@ -495,7 +542,8 @@ absl::Status LogTableMod(
                 op.key, columns, {}, op.table, change_stream, kDelete,
                 partition_token,
                 data_change_records_in_transaction_by_change_stream,
-                transaction_id, last_mod_group_by_change_stream, store));
+                transaction_id, last_mod_group_by_change_stream,
+                committed_row));
             return absl::OkStatus();
           },
       },
@@ -503,6 +551,22 @@ absl::Status LogTableMod(
   return absl::OkStatus();
 }
 
+absl::Status LogTableMod(
+    WriteOp op, const ChangeStream* change_stream,
+    zetasql::Value partition_token,
+    absl::flat_hash_map<const ChangeStream*, std::vector<DataChangeRecord>>*
+        data_change_records_in_transaction_by_change_stream,
+    TransactionID transaction_id,
+    absl::flat_hash_map<const ChangeStream*, ModGroup>*
+        last_mod_group_by_change_stream,
+    ReadOnlyStore* store) {
+  CommittedRow committed_row(TableOf(op), KeyOf(op), store);
+  return LogTableMod(op, change_stream, std::move(partition_token),
+                     data_change_records_in_transaction_by_change_stream,
+                     transaction_id, last_mod_group_by_change_stream,
+                     &committed_row);
+}
+
 std::string GsqlTypeToSpannerType(const zetasql::Type* type) {
   JSON type_json;
   if (type->IsArray()) {
@@ -779,9 +843,36 @@ std::vector<WriteOp> BuildMutation(
   return write_ops;
 }
 
+std::optional<std::string> ActivePartitionTokenCache::Get(
+    const TableID& partition_table_id) const {
+  absl::MutexLock lock(&mu_);
+  auto itr = tokens_.find(partition_table_id);
+  if (itr == tokens_.end()) {
+    return std::nullopt;
+  }
+  return itr->second;
+}
+
+void ActivePartitionTokenCache::Set(const TableID& partition_table_id,
+                                    std::string partition_token) {
+  absl::MutexLock lock(&mu_);
+  tokens_[partition_table_id] = std::move(partition_token);
+}
+
+void ActivePartitionTokenCache::Invalidate(const TableID& partition_table_id) {
+  absl::MutexLock lock(&mu_);
+  tokens_.erase(partition_table_id);
+}
+
+void ActivePartitionTokenCache::Clear() {
+  absl::MutexLock lock(&mu_);
+  tokens_.clear();
+}
+
 absl::StatusOr<std::vector<WriteOp>> BuildChangeStreamWriteOps(
     const Schema* schema, std::vector<WriteOp> buffered_write_ops,
-    ReadOnlyStore* store, TransactionID transaction_id) {
+    ReadOnlyStore* store, TransactionID transaction_id,
+    ActivePartitionTokenCache* partition_token_cache) {
   // Map for change streams and their partition tokens within the transaction.
   absl::flat_hash_map<const ChangeStream*, zetasql::Value>
       change_stream_with_partition_token;
@@ -798,18 +889,22 @@ absl::StatusOr<std::vector<WriteOp>> BuildChangeStreamWriteOps(
       last_mod_group_by_change_stream;
   for (const auto& write_op : buffered_write_ops) {
     const Table* table = TableOf(write_op);
+    // The committed row is shared by all the change streams tracking the
+    // table, so that it is read once per write op.
+    CommittedRow committed_row(table, KeyOf(write_op), store);
     for (const ChangeStream* change_stream :
          table_with_tracked_change_streams[table]) {
       if (!change_stream_with_partition_token.contains(change_stream)) {
-        change_stream_with_partition_token[change_stream] =
-            RetrieveChangeStreamWithPartitionToken(store, change_stream)
-                .value();
+        ZETASQL_ASSIGN_OR_RETURN(change_stream_with_partition_token[change_stream],
+                         RetrieveChangeStreamWithPartitionToken(
+                             store, change_stream, partition_token_cache));
       }
       ZETASQL_RETURN_IF_ERROR(
           LogTableMod(write_op, change_stream,
                       change_stream_with_partition_token[change_stream],
                       &data_change_records_in_transaction_by_change_stream,
-                      transaction_id, &last_mod_group_by_change_stream, store));
+                      transaction_id, &last_mod_group_by_change_stream,
+                      &committed_row));
     }
   }
   std::vector<WriteOp> write_ops =
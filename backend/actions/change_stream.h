@@ -19,10 +19,21 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "backend/common/ids.h"
 #include "backend/actions/action.h"
 #include "backend/actions/ops.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/value.h"
 #include "backend/schema/catalog/table.h"
 #include "backend/storage/storage.h"
 #include "backend/transaction/actions.h"
@@ -86,6 +97,29 @@ struct ModGroup {
   zetasql::Value partition_token_str;
 };
 
+// The committed values of the row modified by a WriteOp, which data change
+// records capture as old values (OLD_AND_NEW_VALUES, NEW_ROW_AND_OLD_VALUES)
+// or as unmodified new values (NEW_ROW). The row is read at most once, on first
+// use, so that all the change streams tracking the table share one read.
+class CommittedRow {
+ public:
+  CommittedRow(const Table* table, const Key& key, ReadOnlyStore* store)
+      : table_(table), key_(key), store_(store) {}
+
+  // Returns the committed values of the non-key columns `column_names` of the
+  // row, or no values if the row does not exist.
+  absl::StatusOr<ValueList> GetValues(
+      const std::vector<std::string>& column_names);
+
+ private:
+  const Table* table_;
+  const Key& key_;
+  ReadOnlyStore* store_;
+
+  // The values of all non-key columns of the row, once read.
+  std::optional<absl::flat_hash_map<std::string, zetasql::Value>> values_;
+};
+
 // Group table mods belonging to the same DataChangeRecord into the same
 // ModGroup.
 absl::Status LogTableMod(
@@ -108,10 +142,40 @@ std::vector<WriteOp> BuildMutation(
     absl::flat_hash_map<const ChangeStream*, ModGroup>*
         last_mod_group_by_change_stream);
 
-// Build change stream write_ops.
+// The active partition token of each change stream to which the data change
+// records of transactions are written, i.e. the smallest active token of its
+// partition table. Caching it across transactions spares writes to tracked
+// tables a scan of the whole partition history. A cached token is validated
+// with a point read of its partition row, which also locks the row against a
+// concurrent churn ending the partition. The partition churner invalidates the
+// token of a change stream when it churns its partitions.
+//
+// This class is thread safe.
+class ActivePartitionTokenCache {
+ public:
+  // Returns the cached token for the partition table with the given id.
+  std::optional<std::string> Get(const TableID& partition_table_id) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  void Set(const TableID& partition_table_id, std::string partition_token)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  void Invalidate(const TableID& partition_table_id) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Invalidates the tokens of all change streams.
+  void Clear() ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<TableID, std::string> tokens_ ABSL_GUARDED_BY(mu_);
+};
+
+// Build change stream write_ops. If `partition_token_cache` is set, the
+// active partition tokens are looked up in it first.
 absl::StatusOr<std::vector<WriteOp>> BuildChangeStreamWriteOps(
     const Schema* schema, std::vector<WriteOp> buffered_write_ops,
-    ReadOnlyStore* store, TransactionID transaction_id);
+    ReadOnlyStore* store, TransactionID transaction_id,
+    ActivePartitionTokenCache* partition_token_cache = nullptr);
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
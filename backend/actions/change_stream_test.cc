@@ -1232,6 +1232,83 @@ TEST_F(ChangeStreamTest, FloatValueAndTypes) {
   ASSERT_EQ(operation->values[18], zetasql::Value(Bool(false)));
 }
 
+TEST_F(ChangeStreamTest, ReusesCachedPartitionTokenWhileActive) {
+  set_up_partition_token_for_change_stream_partition_table(change_stream_,
+                                                           store());
+  const Table* partition_table =
+      change_stream_->change_stream_partition_table();
+  std::vector<const Column*> partition_columns = {
+      partition_table->FindKeyColumn("partition_token")->column(),
+      partition_table->FindColumn("end_time")};
+  ActivePartitionTokenCache partition_token_cache;
+  std::vector<WriteOp> buffered_write_ops;
+  buffered_write_ops.push_back(
+      Insert(table_, Key({Int64(1)}), base_columns_,
+             {Int64(1), String("value"), String("value2")}));
+  auto partition_token_of_write = [&]() -> zetasql::Value {
+    absl::StatusOr<std::vector<WriteOp>> change_stream_write_ops =
+        BuildChangeStreamWriteOps(schema_.get(), buffered_write_ops, store(),
+                                  1, &partition_token_cache);
+    ZETASQL_EXPECT_OK(change_stream_write_ops);
+    auto* operation = std::get_if<InsertOp>(&(*change_stream_write_ops)[0]);
+    return operation->values[0];
+  };
+
+  EXPECT_EQ(partition_token_of_write(), String("11111"));
+  EXPECT_EQ(partition_token_cache.Get(partition_table->id()), "11111");
+
+  // A new active partition does not replace the cached token while the cached
+  // partition is still active.
+  ZETASQL_ASSERT_OK(store()->Insert(
+      partition_table, Key({String("00000")}), partition_columns,
+      {String("00000"), zetasql::Value::NullTimestamp()}));
+  EXPECT_EQ(partition_token_of_write(), String("11111"));
+
+  // Once the cached partition ends, the active partitions are read again.
+  ZETASQL_ASSERT_OK(store()->Insert(
+      partition_table, Key({String("11111")}), partition_columns,
+      {String("11111"), zetasql::Value::Timestamp(absl::UnixEpoch())}));
+  EXPECT_EQ(partition_token_of_write(), String("00000"));
+  EXPECT_EQ(partition_token_cache.Get(partition_table->id()), "00000");
+}
+
+// Counts the committed reads of a TestReadOnlyStore.
+class CountingReadOnlyStore : public test::TestReadOnlyStore {
+ public:
+  absl::StatusOr<ValueList> ReadCommitted(
+      const Table* table, const Key& key,
+      std::vector<const Column*> columns) const override {
+    ++num_reads_;
+    return test::TestReadOnlyStore::ReadCommitted(table, key, columns);
+  }
+
+  int num_reads() const { return num_reads_; }
+
+ private:
+  mutable int num_reads_ = 0;
+};
+
+TEST_F(ChangeStreamTest, CommittedRowIsReadOnce) {
+  CountingReadOnlyStore store;
+  ZETASQL_ASSERT_OK(store.Insert(table_, Key({Int64(1)}), base_columns_,
+                         {Int64(1), String("value"), String("another")}));
+
+  Key key({Int64(1)});
+  CommittedRow committed_row(table_, key, &store);
+  EXPECT_THAT(committed_row.GetValues({"another_string_col", "string_col"}),
+              zetasql_base::testing::IsOkAndHolds(
+                  testing::ElementsAre(String("another"), String("value"))));
+  EXPECT_THAT(committed_row.GetValues({"string_col"}),
+              zetasql_base::testing::IsOkAndHolds(
+                  testing::ElementsAre(String("value"))));
+  EXPECT_EQ(store.num_reads(), 1);
+
+  Key missing_key({Int64(2)});
+  CommittedRow missing_row(table_, missing_key, &store);
+  EXPECT_THAT(missing_row.GetValues({"string_col"}),
+              zetasql_base::testing::IsOkAndHolds(testing::IsEmpty()));
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
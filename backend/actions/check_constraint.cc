@@ -16,7 +16,9 @@
 
 #include "backend/actions/check_constraint.h"
 
+#include <algorithm>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -87,28 +89,33 @@ absl::Status CheckConstraintVerifier::VerifyInsertUpdateOp(
     const ActionContext* ctx, const Table* table,
     const std::vector<const Column*>& columns,
     const std::vector<zetasql::Value>& values, const Key& key) const {
-  absl::Span<const Column* const> dependent_columns =
-      check_constraint_->dependent_columns();
-  ZETASQL_ASSIGN_OR_RETURN(
-      std::unique_ptr<StorageIterator> itr,
-      ctx->store()->Read(table, KeyRange::Point(key), dependent_columns));
-  ZETASQL_RET_CHECK(itr->Next());
-  ZETASQL_RETURN_IF_ERROR(itr->Status());
   ZETASQL_RET_CHECK_EQ(columns.size(), values.size());
-  ZETASQL_RET_CHECK_EQ(dependent_columns.size(), itr->NumColumns());
-
-  zetasql::ParameterValueMap column_values;
-  for (int i = 0; i < dependent_columns.size(); ++i) {
-    column_values[dependent_columns[i]->Name()] = itr->ColumnValue(i);
-  }
   // The generated column values have been updated in
   // GeneratedColumnEffector::Effect before the CheckConstraintVerifier is
   // executed, so that we are able to evaluate the check constraints depending
   // on the generated values.
+  zetasql::ParameterValueMap column_values;
   for (int i = 0; i < columns.size(); ++i) {
     column_values[columns[i]->Name()] = values[i];
   }
 
+  // Only the dependent columns which the op does not supply have to be read.
+  std::vector<const Column*> columns_to_read;
+  for (const Column* dep : check_constraint_->dependent_columns()) {
+    if (column_values.find(dep->Name()) == column_values.end()) {
+      columns_to_read.push_back(dep);
+    }
+  }
+  if (!columns_to_read.empty()) {
+    ZETASQL_ASSIGN_OR_RETURN(std::optional<ValueList> values,
+                     ctx->store()->ReadRow(table, key, columns_to_read));
+    ZETASQL_RET_CHECK(values.has_value());
+    ZETASQL_RET_CHECK_EQ(columns_to_read.size(), values->size());
+    for (int i = 0; i < columns_to_read.size(); ++i) {
+      column_values[columns_to_read[i]->Name()] = std::move((*values)[i]);
+    }
+  }
+
   ZETASQL_RETURN_IF_ERROR(VerifyRow(column_values, key));
   return absl::OkStatus();
 }
@@ -120,6 +127,18 @@ absl::Status CheckConstraintVerifier::Verify(const ActionContext* ctx,
 
 absl::Status CheckConstraintVerifier::Verify(const ActionContext* ctx,
                                              const UpdateOp& op) const {
+  // An update which leaves all the dependent columns untouched cannot newly
+  // violate the constraint, since the row satisfied it when last written.
+  absl::Span<const Column* const> dependent_columns =
+      check_constraint_->dependent_columns();
+  if (std::none_of(op.columns.begin(), op.columns.end(),
+                   [&dependent_columns](const Column* column) {
+                     return std::find(dependent_columns.begin(),
+                                      dependent_columns.end(),
+                                      column) != dependent_columns.end();
+                   })) {
+    return absl::OkStatus();
+  }
   return VerifyInsertUpdateOp(ctx, op.table, op.columns, op.values, op.key);
 }
 
@@ -17,6 +17,7 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_CONTEXT_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_CONTEXT_H_
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -31,6 +32,7 @@
 #include "backend/schema/catalog/table.h"
 #include "backend/storage/iterator.h"
 #include "common/clock.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
@@ -45,6 +47,8 @@ namespace backend {
 // transaction needs to apply. Within a statement, for a given row operation,
 // all effects resulting from the row operation (including cascading effects)
 // are processed before the next row mutation in the statement is processed.
+// Rows of a mutation with distinct keys may be processed as one batch, in
+// which case the effects of the batch are processed after all of its rows.
 class EffectsBuffer {
  public:
   virtual ~EffectsBuffer() = default;
@@ -84,6 +88,21 @@ class ReadOnlyStore {
   virtual absl::StatusOr<bool> Exists(const Table* table,
                                       const Key& key) const = 0;
 
+  // Returns, for each of the given keys, whether it exists. The default
+  // implementation checks each key in turn; stores override it to look up all
+  // keys at once, which is used by actions that check many rows of a
+  // multi-row mutation.
+  virtual absl::StatusOr<std::vector<bool>> BatchExists(
+      const Table* table, absl::Span<const Key> keys) const {
+    std::vector<bool> exists;
+    exists.reserve(keys.size());
+    for (const Key& key : keys) {
+      ZETASQL_ASSIGN_OR_RETURN(bool key_exists, Exists(table, key));
+      exists.push_back(key_exists);
+    }
+    return exists;
+  }
+
   // Returns true if a row with the given key prefix exist, false if it does
   // not.
   virtual absl::StatusOr<bool> PrefixExists(const Table* table,
@@ -94,6 +113,42 @@ class ReadOnlyStore {
       const Table* table, const KeyRange& key_range,
       absl::Span<const Column* const> columns) const = 0;
 
+  // Reads the given columns of the row with the given key, returning
+  // std::nullopt if it does not exist. The default implementation reads the
+  // key as a point range; stores override it to serve the reads of the same
+  // row by several actions from a cache.
+  virtual absl::StatusOr<std::optional<ValueList>> ReadRow(
+      const Table* table, const Key& key,
+      absl::Span<const Column* const> columns) const {
+    ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<StorageIterator> itr,
+                     Read(table, KeyRange::Point(key), columns));
+    std::optional<ValueList> row;
+    if (itr->Next()) {
+      ValueList& values = row.emplace();
+      for (int i = 0; i < itr->NumColumns(); ++i) {
+        values.push_back(itr->ColumnValue(i));
+      }
+    }
+    ZETASQL_RETURN_IF_ERROR(itr->Status());
+    return row;
+  }
+
+  // Reads the given columns of each of the given keys, returning std::nullopt
+  // for keys which do not exist. The default implementation reads each key in
+  // turn; stores override it to look up all keys at once.
+  virtual absl::StatusOr<std::vector<std::optional<ValueList>>> BatchRead(
+      const Table* table, absl::Span<const Key> keys,
+      absl::Span<const Column* const> columns) const {
+    std::vector<std::optional<ValueList>> rows;
+    rows.reserve(keys.size());
+    for (const Key& key : keys) {
+      ZETASQL_ASSIGN_OR_RETURN(std::optional<ValueList> row,
+                       ReadRow(table, key, columns));
+      rows.push_back(std::move(row));
+    }
+    return rows;
+  }
+
   // Only reads committed values for the given key, ignoring any mutations
   // buffered within the transaction.
   virtual absl::StatusOr<ValueList> ReadCommitted(
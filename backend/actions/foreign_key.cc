@@ -16,8 +16,14 @@
 
 #include "backend/actions/foreign_key.h"
 
+#include <algorithm>
+#include <variant>
+#include <vector>
+
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "backend/actions/action.h"
 #include "backend/actions/context.h"
 #include "backend/actions/ops.h"
@@ -32,19 +38,84 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
+namespace {
+
+// Returns the key of the foreign key columns of a referencing or referenced
+// index data table row. Excludes any extra columns from the primary key that
+// are not used by the foreign key.
+Key ForeignKeyColumnsKey(const ForeignKey* foreign_key, const Key& key) {
+  return Key(std::vector<zetasql::Value>(
+      key.column_values().begin(),
+      key.column_values().begin() +
+          foreign_key->referencing_columns().size()));
+}
+
+// Returns true if the foreign key columns form the whole primary key of the
+// referenced data table, in which case referenced rows can be checked with
+// point lookups that are batched across operations.
+bool ReferencesWholePrimaryKey(const ForeignKey* foreign_key) {
+  return foreign_key->referenced_index() == nullptr &&
+         foreign_key->referenced_data_table()->primary_key().size() ==
+             foreign_key->referencing_columns().size();
+}
+
+// Sorts the keys and removes duplicates, so that each key is looked up once and
+// the lookups visit the table in key order.
+void SortAndDeduplicate(std::vector<Key>* keys) {
+  std::sort(keys->begin(), keys->end());
+  keys->erase(std::unique(keys->begin(), keys->end()), keys->end());
+}
+
+// Returns whether each of the given foreign key columns keys has a row in the
+// referenced data table of `foreign_key`.
+absl::StatusOr<std::vector<bool>> ReferencedKeysExist(
+    const ActionContext* ctx, const ForeignKey* foreign_key,
+    absl::Span<const Key> keys) {
+  const Table* data_table = foreign_key->referenced_data_table();
+  if (ReferencesWholePrimaryKey(foreign_key)) {
+    return ctx->store()->BatchExists(data_table, keys);
+  }
+  std::vector<bool> exists;
+  exists.reserve(keys.size());
+  for (const Key& key : keys) {
+    ZETASQL_ASSIGN_OR_RETURN(bool key_exists,
+                     ctx->store()->PrefixExists(data_table, key));
+    exists.push_back(key_exists);
+  }
+  return exists;
+}
+
+}  // namespace
+
 ForeignKeyReferencingVerifier::ForeignKeyReferencingVerifier(
     const ForeignKey* foreign_key)
     : foreign_key_(foreign_key) {}
 
+absl::Status ForeignKeyReferencingVerifier::VerifyBatch(
+    const ActionContext* ctx, absl::Span<const WriteOp> ops) const {
+  std::vector<Key> keys;
+  for (const WriteOp& op : ops) {
+    if (const InsertOp* insert = std::get_if<InsertOp>(&op)) {
+      keys.push_back(ForeignKeyColumnsKey(foreign_key_, insert->key));
+    }
+  }
+  SortAndDeduplicate(&keys);
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<bool> exists,
+                   ReferencedKeysExist(ctx, foreign_key_, keys));
+  for (int i = 0; i < keys.size(); ++i) {
+    if (!exists[i]) {
+      return error::ForeignKeyReferencedKeyNotFound(
+          foreign_key_->Name(), foreign_key_->referencing_table()->Name(),
+          foreign_key_->referenced_table()->Name(), keys[i].DebugString());
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ForeignKeyReferencingVerifier::Verify(const ActionContext* ctx,
                                                    const InsertOp& op) const {
-  // Check that the corresponding row exists in the referenced index. Exclude
-  // any extra columns from the primary key that are not used by the foreign
-  // key.
-  Key key(std::vector<zetasql::Value>(
-      op.key.column_values().begin(),
-      op.key.column_values().begin() +
-          foreign_key_->referencing_columns().size()));
+  // Check that the corresponding row exists in the referenced index.
+  Key key = ForeignKeyColumnsKey(foreign_key_, op.key);
   ZETASQL_ASSIGN_OR_RETURN(
       bool exists,
       ctx->store()->PrefixExists(foreign_key_->referenced_data_table(), key));
@@ -60,15 +131,30 @@ ForeignKeyReferencedVerifier::ForeignKeyReferencedVerifier(
     const ForeignKey* foreign_key)
     : foreign_key_(foreign_key) {}
 
+absl::Status ForeignKeyReferencedVerifier::VerifyBatch(
+    const ActionContext* ctx, absl::Span<const WriteOp> ops) const {
+  std::vector<Key> keys;
+  for (const WriteOp& op : ops) {
+    if (const DeleteOp* del = std::get_if<DeleteOp>(&op)) {
+      keys.push_back(ForeignKeyColumnsKey(foreign_key_, del->key));
+    }
+  }
+  SortAndDeduplicate(&keys);
+  // Keys which were inserted back later in the transaction are not deleted.
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<bool> referenced_key_exists,
+                   ReferencedKeysExist(ctx, foreign_key_, keys));
+  for (int i = 0; i < keys.size(); ++i) {
+    if (!referenced_key_exists[i]) {
+      ZETASQL_RETURN_IF_ERROR(VerifyNotReferenced(ctx, keys[i]));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ForeignKeyReferencedVerifier::Verify(const ActionContext* ctx,
                                                   const DeleteOp& op) const {
   // Check that the corresponding row does not exist in the referencing index.
-  // Exclude any extra columns from the primary key that are not used by the
-  // foreign key.
-  Key key(std::vector<zetasql::Value>(
-      op.key.column_values().begin(),
-      op.key.column_values().begin() +
-          foreign_key_->referencing_columns().size()));
+  Key key = ForeignKeyColumnsKey(foreign_key_, op.key);
 
   // It is possible that a deleted key is inserted back in the same transaction
   // later. So check whether the key is really deleted before validating the
@@ -77,14 +163,20 @@ absl::Status ForeignKeyReferencedVerifier::Verify(const ActionContext* ctx,
       bool referenced_key_exists,
       ctx->store()->PrefixExists(foreign_key_->referenced_data_table(), key));
   if (!referenced_key_exists) {
-    ZETASQL_ASSIGN_OR_RETURN(bool referencing_key_exists,
-                     ctx->store()->PrefixExists(
-                         foreign_key_->referencing_data_table(), key));
-    if (referencing_key_exists) {
-      return error::ForeignKeyReferencingKeyFound(
-          foreign_key_->Name(), foreign_key_->referencing_table()->Name(),
-          foreign_key_->referenced_table()->Name(), key.DebugString());
-    }
+    return VerifyNotReferenced(ctx, key);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ForeignKeyReferencedVerifier::VerifyNotReferenced(
+    const ActionContext* ctx, const Key& key) const {
+  ZETASQL_ASSIGN_OR_RETURN(
+      bool referencing_key_exists,
+      ctx->store()->PrefixExists(foreign_key_->referencing_data_table(), key));
+  if (referencing_key_exists) {
+    return error::ForeignKeyReferencingKeyFound(
+        foreign_key_->Name(), foreign_key_->referencing_table()->Name(),
+        foreign_key_->referenced_table()->Name(), key.DebugString());
   }
   return absl::OkStatus();
 }
@@ -17,6 +17,7 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_FOREIGN_KEY_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_FOREIGN_KEY_H_
 
+#include "absl/types/span.h"
 #include "backend/actions/action.h"
 #include "backend/actions/context.h"
 #include "backend/actions/ops.h"
@@ -45,6 +46,12 @@ class ForeignKeyReferencingVerifier : public Verifier {
  public:
   explicit ForeignKeyReferencingVerifier(const ForeignKey* foreign_key);
 
+  // Looks up the distinct referenced keys of all inserts in key order, at once
+  // when the foreign key references the primary key of the referenced table.
+  // Reports the smallest referenced key which does not exist.
+  absl::Status VerifyBatch(const ActionContext* ctx,
+                           absl::Span<const WriteOp> ops) const override;
+
  private:
   absl::Status Verify(const ActionContext* ctx,
                       const InsertOp& op) const override;
@@ -71,10 +78,21 @@ class ForeignKeyReferencedVerifier : public Verifier {
  public:
   explicit ForeignKeyReferencedVerifier(const ForeignKey* foreign_key);
 
+  // Looks up whether the distinct keys of all deletes were inserted back in key
+  // order, at once when the foreign key references the primary key of the
+  // referenced table.
+  absl::Status VerifyBatch(const ActionContext* ctx,
+                           absl::Span<const WriteOp> ops) const override;
+
  private:
   absl::Status Verify(const ActionContext* ctx,
                       const DeleteOp& op) const override;
 
+  // Returns an error if the referencing index has rows for the deleted
+  // referenced `key`.
+  absl::Status VerifyNotReferenced(const ActionContext* ctx,
+                                   const Key& key) const;
+
   const ForeignKey* foreign_key_;
 };
 
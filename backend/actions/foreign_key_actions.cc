@@ -124,7 +124,7 @@ std::vector<std::optional<int>> GetPrimaryKeyColumnPositions(
 // Arrange the values in the order of the primary key columns, and return the
 // key. If any of the primary key columns are missing from the given column
 // order then return the prefix of the primary key.
-Key ComputePk(const std::vector<zetasql::Value>& values,
+Key ComputePk(absl::Span<const zetasql::Value> values,
               const std::vector<std::optional<int>>& col_order) {
   std::vector<zetasql::Value> key_value;
   key_value.reserve(col_order.size());
@@ -179,13 +179,13 @@ absl::Status ForeignKeyActionEffector::ProcessDeleteForNonPKReferencingKey(
           foreign_key_->referencing_columns(),
           foreign_key_->referencing_data_table()->primary_key());
   Key index_key = ComputePk(referenced_key.column_values(), column_order);
-  // Retrieve the referencing table key from the row in the referencing
-  // index data table that matches the referenced key.
+  // Retrieve the referencing table key from the key of the rows in the
+  // referencing index data table that match the referenced key. Only the keys
+  // are needed, so no columns are read.
   ZETASQL_ASSIGN_OR_RETURN(
       std::unique_ptr<StorageIterator> itr,
       ctx->store()->Read(foreign_key_->referencing_data_table(),
-                         KeyRange::Prefix(index_key),
-                         foreign_key_->referencing_data_table()->columns()));
+                         KeyRange::Prefix(index_key), {}));
   std::vector<const Column*> referenced_columns;
   std::transform(foreign_key_->referencing_data_table()->primary_key().begin(),
                  foreign_key_->referencing_data_table()->primary_key().end(),
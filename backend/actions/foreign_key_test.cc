@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -109,6 +110,33 @@ TEST_F(ForeignKeyTest, InsertReferencingRowWithoutReferencedRow) {
       StatusIs(absl::StatusCode::kFailedPrecondition));
 }
 
+TEST_F(ForeignKeyTest, InsertReferencingRowsReportsSmallestMissingKey) {
+  ZETASQL_ASSERT_OK(
+      store()->Insert(referenced_data_, Key({Int64(1), Int64(2), Int64(3)}),
+                      referenced_columns_, {Int64(1), Int64(2), Int64(3)}));
+
+  // Several referencing rows share each referenced key, and the smallest of
+  // the keys without a referenced row is reported.
+  std::vector<WriteOp> ops = {
+      Insert(referencing_data_, Key({Int64(7), Int64(8), Int64(1)}),
+             referencing_columns_, {Int64(7), Int64(8), Int64(1)}),
+      Insert(referencing_data_, Key({Int64(1), Int64(2), Int64(2)}),
+             referencing_columns_, {Int64(1), Int64(2), Int64(2)}),
+      Insert(referencing_data_, Key({Int64(3), Int64(4), Int64(3)}),
+             referencing_columns_, {Int64(3), Int64(4), Int64(3)}),
+      Insert(referencing_data_, Key({Int64(1), Int64(2), Int64(4)}),
+             referencing_columns_, {Int64(1), Int64(2), Int64(4)}),
+  };
+  EXPECT_THAT(
+      referencing_verifier_->VerifyBatch(ctx(), ops),
+      StatusIs(absl::StatusCode::kFailedPrecondition,
+               testing::HasSubstr(Key({Int64(3), Int64(4)}).DebugString())));
+
+  ops.erase(ops.begin() + 2);
+  ops.erase(ops.begin());
+  ZETASQL_EXPECT_OK(referencing_verifier_->VerifyBatch(ctx(), ops));
+}
+
 TEST_F(ForeignKeyTest, DeleteReferencedRowWithReferencingRow) {
   // Insert referencing and referenced rows.
   ZETASQL_ASSERT_OK(
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <map>
+#include <optional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -179,6 +180,11 @@ absl::Status GeneratedColumnEffector::Effect(
   // generated columns.
   std::vector<zetasql::ParameterValueMap> row_column_values(
       op.rows.size(), zetasql::ParameterValueMap());
+  for (int i = 0; i < op.rows.size(); ++i) {
+    for (int j = 0; j < op.columns.size(); ++j) {
+      row_column_values[i][op.columns[j]] = op.rows[i][j];
+    }
+  }
   // Evaluate generated columns in topological order.
   for (int i = 0; i < generated_columns_.size(); ++i) {
     const Column* generated_column = generated_columns_[i];
@@ -222,9 +228,6 @@ absl::Status GeneratedColumnEffector::Effect(
 
     for (int i = 0; i < op.rows.size(); ++i) {
       // Calculate values of generated columns for each row.
-      for (int j = 0; j < op.columns.size(); ++j) {
-        row_column_values[i][op.columns[j]] = op.rows[i][j];
-      }
       ZETASQL_ASSIGN_OR_RETURN(
           zetasql::Value value,
           ComputeGeneratedColumnValue(generated_column, row_column_values[i]));
@@ -281,20 +284,30 @@ absl::Status GeneratedColumnEffector::Effect(const ActionContext* ctx,
     }
   }
 
-  zetasql::ParameterValueMap column_values;
-  ZETASQL_ASSIGN_OR_RETURN(
-      std::unique_ptr<StorageIterator> itr,
-      ctx->store()->Read(table_, KeyRange::Point(op.key), dependent_columns_));
-  ZETASQL_RET_CHECK(itr->Next());
-  ZETASQL_RETURN_IF_ERROR(itr->Status());
   ZETASQL_RET_CHECK_EQ(op.columns.size(), op.values.size());
-  ZETASQL_RET_CHECK_EQ(itr->NumColumns(), dependent_columns_.size());
-  for (int i = 0; i < dependent_columns_.size(); ++i) {
-    column_values[dependent_columns_[i]->Name()] = itr->ColumnValue(i);
-  }
+  zetasql::ParameterValueMap column_values;
   for (int i = 0; i < op.columns.size(); ++i) {
     column_values[op.columns[i]->Name()] = op.values[i];
   }
+
+  // Only the dependent columns which the update does not supply have to be
+  // read from the existing row.
+  std::vector<const Column*> columns_to_read;
+  for (const Column* dep : dependent_columns_) {
+    if (column_values.find(dep->Name()) == column_values.end()) {
+      columns_to_read.push_back(dep);
+    }
+  }
+  if (!columns_to_read.empty()) {
+    ZETASQL_ASSIGN_OR_RETURN(
+        std::optional<ValueList> values,
+        ctx->store()->ReadRow(table_, op.key, columns_to_read));
+    ZETASQL_RET_CHECK(values.has_value());
+    ZETASQL_RET_CHECK_EQ(values->size(), columns_to_read.size());
+    for (int i = 0; i < columns_to_read.size(); ++i) {
+      column_values[columns_to_read[i]->Name()] = std::move((*values)[i]);
+    }
+  }
   return Effect(ctx, op.key, &column_values, /*skip_default_values=*/true);
 }
 
@@ -16,10 +16,15 @@
 
 #include "backend/actions/index.h"
 
+#include <algorithm>
 #include <iterator>
+#include <optional>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "backend/common/indexing.h"
 #include "backend/schema/catalog/column.h"
 #include "backend/schema/catalog/index.h"
@@ -39,20 +44,56 @@ namespace {
 absl::StatusOr<Row> ReadBaseTableRow(
     const ActionContext* ctx, const Table* table, const Key& key,
     const std::vector<const Column*>& base_columns) {
-  ZETASQL_ASSIGN_OR_RETURN(
-      std::unique_ptr<StorageIterator> itr,
-      ctx->store()->Read(table, KeyRange::Point(key), base_columns));
-
-  Row base_row;
-  if (itr->Next()) {
-    for (int i = 0; i < itr->NumColumns(); ++i) {
-      base_row[base_columns[i]] = itr->ColumnValue(i);
+  ZETASQL_ASSIGN_OR_RETURN(std::optional<ValueList> values,
+                   ctx->store()->ReadRow(table, key, base_columns));
+
+  Row base_row(table);
+  if (values.has_value()) {
+    for (int i = 0; i < values->size(); ++i) {
+      base_row.Set(base_columns[i], std::move((*values)[i]));
     }
   }
-  ZETASQL_RETURN_IF_ERROR(itr->Status());
   return base_row;
 }
 
+// An index entry to be inserted into the index data table.
+struct IndexEntry {
+  Key key;
+  ValueList values;
+};
+
+// Adds the index entry of the given indexed row to 'entries', unless the entry
+// is filtered out of the index.
+absl::Status AddIndexEntry(const Index* index, const Row& base_row,
+                           std::vector<IndexEntry>* entries) {
+  ZETASQL_ASSIGN_OR_RETURN(Key index_key, ComputeIndexKey(base_row, index));
+  if (ShouldFilterIndexKeyOrValue(index, index_key, base_row)) {
+    return absl::OkStatus();
+  }
+  entries->push_back(
+      IndexEntry{std::move(index_key), ComputeIndexValues(base_row, index)});
+  return absl::OkStatus();
+}
+
+// Adds the index key of the given indexed row to 'keys', unless the entry is
+// filtered out of the index.
+absl::Status AddIndexKey(const Index* index, const Row& base_row,
+                         std::vector<Key>* keys) {
+  ZETASQL_ASSIGN_OR_RETURN(Key index_key, ComputeIndexKey(base_row, index));
+  if (ShouldFilterIndexKeyOrValue(index, index_key, base_row)) {
+    return absl::OkStatus();
+  }
+  keys->push_back(std::move(index_key));
+  return absl::OkStatus();
+}
+
+absl::Status MissingBaseRowError(const UpdateOp& op) {
+  return error::Internal(
+      absl::StrCat("Missing row from base table when an Update index effect "
+                   "is executed. Base Table: ",
+                   op.table->Name(), " Key: ", op.key.DebugString()));
+}
+
 }  // namespace
 
 IndexEffector::IndexEffector(const Index* index) : index_(index) {
@@ -65,16 +106,16 @@ IndexEffector::IndexEffector(const Index* index) : index_(index) {
 absl::Status IndexEffector::Effect(const ActionContext* ctx,
                                    const InsertOp& op) const {
   // Compute the index key and column values.
-  Row base_row = MakeRow(op.columns, op.values);
+  Row base_row = MakeRow(op.table, op.columns, op.values);
   ZETASQL_ASSIGN_OR_RETURN(Key index_key, ComputeIndexKey(base_row, index_));
-  ValueList index_values = ComputeIndexValues(base_row, index_);
   if (ShouldFilterIndexKeyOrValue(index_, index_key, base_row)) {
     return absl::OkStatus();
   }
 
   // Insert the new row in the index.
   ctx->effects()->Insert(index_->index_data_table(), index_key,
-                         index_->index_data_table()->columns(), index_values);
+                         index_->index_data_table()->columns(),
+                         ComputeIndexValues(base_row, index_));
   return absl::OkStatus();
 }
 
@@ -84,10 +125,7 @@ absl::Status IndexEffector::Effect(const ActionContext* ctx,
   ZETASQL_ASSIGN_OR_RETURN(Row base_row,
                    ReadBaseTableRow(ctx, op.table, op.key, base_columns_));
   if (base_row.empty()) {
-    return error::Internal(
-        absl::StrCat("Missing row from base table when an Update index effect "
-                     "is executed. Base Table: ",
-                     op.table->Name(), " Key: ", op.key.DebugString()));
+    return MissingBaseRowError(op);
   }
 
   // If a previous index entry existed, delete it.
@@ -98,17 +136,17 @@ absl::Status IndexEffector::Effect(const ActionContext* ctx,
 
   // Patch new values into value map.
   for (int i = 0; i < op.columns.size(); ++i) {
-    base_row[op.columns[i]] = op.values[i];
+    base_row.Set(op.columns[i], op.values[i]);
   }
   ZETASQL_ASSIGN_OR_RETURN(Key new_index_key, ComputeIndexKey(base_row, index_));
-  ValueList index_values = ComputeIndexValues(base_row, index_);
   if (ShouldFilterIndexKeyOrValue(index_, new_index_key, base_row)) {
     return absl::OkStatus();
   }
 
   // Insert the new row in the index.
   ctx->effects()->Insert(index_->index_data_table(), new_index_key,
-                         index_->index_data_table()->columns(), index_values);
+                         index_->index_data_table()->columns(),
+                         ComputeIndexValues(base_row, index_));
   return absl::OkStatus();
 }
 
@@ -134,6 +172,73 @@ absl::Status IndexEffector::Effect(const ActionContext* ctx,
   return absl::OkStatus();
 }
 
+absl::Status IndexEffector::EffectBatch(const ActionContext* ctx,
+                                        absl::Span<const WriteOp> ops) const {
+  if (ops.empty()) {
+    return absl::OkStatus();
+  }
+
+  // Read the current base row values of all updated and deleted rows at once.
+  const Table* table = TableOf(ops.front());
+  std::vector<Key> base_keys;
+  for (const WriteOp& op : ops) {
+    if (!std::holds_alternative<InsertOp>(op)) {
+      base_keys.push_back(KeyOf(op));
+    }
+  }
+  std::vector<std::optional<ValueList>> base_rows;
+  if (!base_keys.empty()) {
+    ZETASQL_ASSIGN_OR_RETURN(base_rows, ctx->store()->BatchRead(
+                                    table, base_keys, base_columns_));
+  }
+
+  // Compute the index entries to delete and to insert for all operations.
+  std::vector<Key> deleted_keys;
+  std::vector<IndexEntry> inserted_entries;
+  int next_base_row = 0;
+  for (const WriteOp& op : ops) {
+    if (const InsertOp* insert = std::get_if<InsertOp>(&op)) {
+      ZETASQL_RETURN_IF_ERROR(AddIndexEntry(
+          index_, MakeRow(table, insert->columns, insert->values),
+          &inserted_entries));
+      continue;
+    }
+    const std::optional<ValueList>& base_values = base_rows[next_base_row++];
+    if (const UpdateOp* update = std::get_if<UpdateOp>(&op)) {
+      if (!base_values.has_value()) {
+        return MissingBaseRowError(*update);
+      }
+      Row base_row = MakeRow(table, base_columns_, *base_values);
+      ZETASQL_RETURN_IF_ERROR(AddIndexKey(index_, base_row, &deleted_keys));
+      for (int i = 0; i < update->columns.size(); ++i) {
+        base_row.Set(update->columns[i], update->values[i]);
+      }
+      ZETASQL_RETURN_IF_ERROR(AddIndexEntry(index_, base_row, &inserted_entries));
+    } else if (base_values.has_value()) {
+      ZETASQL_RETURN_IF_ERROR(AddIndexKey(
+          index_, MakeRow(table, base_columns_, *base_values), &deleted_keys));
+    }
+  }
+
+  // Buffer the index operations in index key order. Old entries are deleted
+  // before new entries are inserted, so that an update which leaves the index
+  // key unchanged replaces its entry.
+  std::sort(deleted_keys.begin(), deleted_keys.end());
+  std::sort(inserted_entries.begin(), inserted_entries.end(),
+            [](const IndexEntry& a, const IndexEntry& b) {
+              return a.key < b.key;
+            });
+  const Table* index_data_table = index_->index_data_table();
+  for (const Key& key : deleted_keys) {
+    ctx->effects()->Delete(index_data_table, key);
+  }
+  for (const IndexEntry& entry : inserted_entries) {
+    ctx->effects()->Insert(index_data_table, entry.key,
+                           index_data_table->columns(), entry.values);
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
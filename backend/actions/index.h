@@ -17,6 +17,9 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_INDEX_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_INDEX_H_
 
+#include <vector>
+
+#include "absl/types/span.h"
 #include "backend/actions/action.h"
 #include "backend/actions/ops.h"
 #include "backend/schema/catalog/table.h"
@@ -40,10 +43,16 @@ namespace backend {
 //
 // NULL_FILTERED index entries are omitted from all operations above.
 // UNIQUE index checks are handled by UniqueIndexVerifier.
+//
+// For a batch of operations, the indexed rows of all updates and deletes are
+// read at once and the index operations are buffered in index key order.
 class IndexEffector : public Effector {
  public:
   explicit IndexEffector(const Index* index);
 
+  absl::Status EffectBatch(const ActionContext* ctx,
+                           absl::Span<const WriteOp> ops) const override;
+
  private:
   absl::Status Effect(const ActionContext* ctx,
                       const InsertOp& op) const override;
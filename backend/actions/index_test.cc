@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -196,6 +197,74 @@ TEST_F(IndexTest, UpdateCascadesToIndexEntry) {
                            {String("new-value"), Int64(1), String("value2")}}));
 }
 
+TEST_F(IndexTest, BatchInsertCascadesToIndexEntriesInIndexKeyOrder) {
+  // Insert base table entries in base table key order.
+  std::vector<WriteOp> ops = {
+      Insert(table_, Key({Int64(1)}), base_columns_,
+             {Int64(1), String("a"), String("value1")}),
+      Insert(table_, Key({Int64(2)}), base_columns_,
+             {Int64(2), String("b"), String("value2")})};
+  ZETASQL_EXPECT_OK(effector_->EffectBatch(ctx(), ops));
+
+  // Verify index entries are added in index key order, which is descending on
+  // string_col.
+  ASSERT_EQ(effects_buffer()->ops_queue()->size(), 2);
+  EXPECT_THAT(effects_buffer()->ops_queue()->front(),
+              testing::VariantWith<InsertOp>(
+                  InsertOp{index_->index_data_table(),
+                           Key({String("b"), Int64(2)}),
+                           {index_columns_.begin(), index_columns_.end()},
+                           {String("b"), Int64(2), String("value2")}}));
+  effects_buffer()->ops_queue()->pop();
+
+  EXPECT_THAT(effects_buffer()->ops_queue()->front(),
+              testing::VariantWith<InsertOp>(
+                  InsertOp{index_->index_data_table(),
+                           Key({String("a"), Int64(1)}),
+                           {index_columns_.begin(), index_columns_.end()},
+                           {String("a"), Int64(1), String("value1")}}));
+}
+
+TEST_F(IndexTest, BatchUpdateDeletesOldEntriesBeforeInsertingNewEntries) {
+  // Add rows in base table & index.
+  ZETASQL_EXPECT_OK(store()->Insert(table_, Key({Int64(1)}), base_columns_,
+                            {Int64(1), String("a"), String("value1")}));
+  ZETASQL_EXPECT_OK(store()->Insert(table_, Key({Int64(2)}), base_columns_,
+                            {Int64(2), String("b"), String("value2")}));
+
+  // Swap the indexed values of the two rows.
+  std::vector<WriteOp> ops = {
+      Update(table_, Key({Int64(1)}), {table_->FindColumn("string_col")},
+             {String("b")}),
+      Update(table_, Key({Int64(2)}), {table_->FindColumn("string_col")},
+             {String("a")})};
+  ZETASQL_EXPECT_OK(effector_->EffectBatch(ctx(), ops));
+
+  // Verify both old entries are deleted before the new entries are added.
+  ASSERT_EQ(effects_buffer()->ops_queue()->size(), 4);
+  EXPECT_THAT(effects_buffer()->ops_queue()->front(),
+              testing::VariantWith<DeleteOp>(DeleteOp{
+                  index_->index_data_table(), Key({String("b"), Int64(2)})}));
+  effects_buffer()->ops_queue()->pop();
+  EXPECT_THAT(effects_buffer()->ops_queue()->front(),
+              testing::VariantWith<DeleteOp>(DeleteOp{
+                  index_->index_data_table(), Key({String("a"), Int64(1)})}));
+  effects_buffer()->ops_queue()->pop();
+  EXPECT_THAT(effects_buffer()->ops_queue()->front(),
+              testing::VariantWith<InsertOp>(
+                  InsertOp{index_->index_data_table(),
+                           Key({String("b"), Int64(1)}),
+                           {index_columns_.begin(), index_columns_.end()},
+                           {String("b"), Int64(1), String("value1")}}));
+  effects_buffer()->ops_queue()->pop();
+  EXPECT_THAT(effects_buffer()->ops_queue()->front(),
+              testing::VariantWith<InsertOp>(
+                  InsertOp{index_->index_data_table(),
+                           Key({String("a"), Int64(2)}),
+                           {index_columns_.begin(), index_columns_.end()},
+                           {String("a"), Int64(2), String("value2")}}));
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
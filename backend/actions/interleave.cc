@@ -16,12 +16,20 @@
 
 #include "backend/actions/interleave.h"
 
+#include <algorithm>
 #include <memory>
+#include <variant>
+#include <vector>
 
+#include "absl/types/span.h"
+#include "backend/actions/context.h"
+#include "backend/actions/ops.h"
+#include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/storage/iterator.h"
 #include "common/errors.h"
 #include "absl/status/status.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
@@ -82,6 +90,32 @@ InterleaveChildValidator::InterleaveChildValidator(const Table* parent,
       child_(child),
       on_delete_action_(child->on_delete_action()) {}
 
+absl::Status InterleaveChildValidator::ValidateBatch(
+    const ActionContext* ctx, absl::Span<const WriteOp> ops) const {
+  std::vector<Key> parent_keys;
+  parent_keys.reserve(ops.size());
+  for (const WriteOp& op : ops) {
+    if (const InsertOp* insert = std::get_if<InsertOp>(&op)) {
+      parent_keys.push_back(insert->key.Prefix(parent_->primary_key().size()));
+    }
+  }
+  // Child rows are usually inserted in runs under the same parent, which is
+  // then looked up once.
+  std::sort(parent_keys.begin(), parent_keys.end());
+  parent_keys.erase(std::unique(parent_keys.begin(), parent_keys.end()),
+                    parent_keys.end());
+
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<bool> exists,
+                   ctx->store()->BatchExists(parent_, parent_keys));
+  for (int i = 0; i < parent_keys.size(); ++i) {
+    if (!exists[i]) {
+      return error::ParentKeyNotFound(parent_->Name(), child_->Name(),
+                                      parent_keys[i].DebugString());
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status InterleaveChildValidator::Validate(const ActionContext* ctx,
                                                 const InsertOp& op) const {
   // Compute the parent key as prefix of the child key.
@@ -17,7 +17,9 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_INTERLEAVE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_INTERLEAVE_H_
 
+#include "absl/types/span.h"
 #include "backend/actions/action.h"
+#include "backend/actions/context.h"
 #include "backend/actions/ops.h"
 #include "backend/schema/catalog/table.h"
 #include "absl/status/status.h"
@@ -79,6 +81,12 @@ class InterleaveChildValidator : public Validator {
  public:
   InterleaveChildValidator(const Table* parent, const Table* child);
 
+  // Looks up the distinct parent keys of all inserts at once, in key order, so
+  // that a bulk load of child rows probes each parent row once. Reports the
+  // smallest parent key which does not exist.
+  absl::Status ValidateBatch(const ActionContext* ctx,
+                             absl::Span<const WriteOp> ops) const override;
+
  private:
   absl::Status Validate(const ActionContext* ctx,
                         const InsertOp& op) const override;
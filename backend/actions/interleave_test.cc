@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -172,6 +173,39 @@ TEST_F(InterleaveTest, ChildRowInsertSucceedsWithParentRow) {
       ctx(), Insert(cascade_delete_child_, Key({Int64(1), Int64(1)}))));
 }
 
+TEST_F(InterleaveTest, ChildRowBatchInsertSucceedsWithParentRows) {
+  std::unique_ptr<Validator> validator =
+      std::make_unique<InterleaveChildValidator>(parent_table_,
+                                                 cascade_delete_child_);
+  ZETASQL_EXPECT_OK(store()->Insert(parent_table_, Key({Int64(1)}), {}, {}));
+  ZETASQL_EXPECT_OK(store()->Insert(parent_table_, Key({Int64(2)}), {}, {}));
+
+  // Several child rows share each parent row.
+  std::vector<WriteOp> ops = {
+      Insert(cascade_delete_child_, Key({Int64(2), Int64(1)})),
+      Insert(cascade_delete_child_, Key({Int64(1), Int64(1)})),
+      Insert(cascade_delete_child_, Key({Int64(2), Int64(2)})),
+      Insert(cascade_delete_child_, Key({Int64(1), Int64(2)})),
+  };
+  ZETASQL_EXPECT_OK(validator->ValidateBatch(ctx(), ops));
+}
+
+TEST_F(InterleaveTest, ChildRowBatchInsertReportsSmallestMissingParentKey) {
+  std::unique_ptr<Validator> validator =
+      std::make_unique<InterleaveChildValidator>(parent_table_,
+                                                 cascade_delete_child_);
+  ZETASQL_EXPECT_OK(store()->Insert(parent_table_, Key({Int64(2)}), {}, {}));
+
+  std::vector<WriteOp> ops = {
+      Insert(cascade_delete_child_, Key({Int64(3), Int64(1)})),
+      Insert(cascade_delete_child_, Key({Int64(2), Int64(1)})),
+      Insert(cascade_delete_child_, Key({Int64(1), Int64(1)})),
+  };
+  EXPECT_THAT(validator->ValidateBatch(ctx(), ops),
+              StatusIs(absl::StatusCode::kNotFound,
+                       testing::HasSubstr(Key({Int64(1)}).DebugString())));
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "zetasql/public/types/type_factory.h"
@@ -26,6 +27,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "backend/access/write.h"
@@ -56,20 +58,59 @@ namespace backend {
 
 absl::Status ActionRegistry::ExecuteValidators(const ActionContext* ctx,
                                                const WriteOp& op) {
-  for (auto& validator : table_validators_[TableOf(op)]) {
+  for (const Validator* validator :
+       PlanOf(TableOf(op)).validators[op.index()]) {
     ZETASQL_RETURN_IF_ERROR(validator->Validate(ctx, op));
   }
   return absl::OkStatus();
 }
 
+absl::Status ActionRegistry::ExecuteValidators(const ActionContext* ctx,
+                                               absl::Span<const WriteOp> ops) {
+  for (size_t begin = 0; begin < ops.size();) {
+    const Table* table = TableOf(ops[begin]);
+    const size_t op_index = ops[begin].index();
+    size_t end = begin + 1;
+    while (end < ops.size() && TableOf(ops[end]) == table &&
+           ops[end].index() == op_index) {
+      ++end;
+    }
+    for (const Validator* validator : PlanOf(table).validators[op_index]) {
+      ZETASQL_RETURN_IF_ERROR(
+          validator->ValidateBatch(ctx, ops.subspan(begin, end - begin)));
+    }
+    begin = end;
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ActionRegistry::ExecuteEffectors(const ActionContext* ctx,
                                               const WriteOp& op) {
-  for (auto& effector : table_effectors_[TableOf(op)]) {
+  for (const Effector* effector : PlanOf(TableOf(op)).effectors[op.index()]) {
     ZETASQL_RETURN_IF_ERROR(effector->Effect(ctx, op));
   }
   return absl::OkStatus();
 }
 
+absl::Status ActionRegistry::ExecuteEffectors(const ActionContext* ctx,
+                                              absl::Span<const WriteOp> ops) {
+  for (size_t begin = 0; begin < ops.size();) {
+    const Table* table = TableOf(ops[begin]);
+    const size_t op_index = ops[begin].index();
+    size_t end = begin + 1;
+    while (end < ops.size() && TableOf(ops[end]) == table &&
+           ops[end].index() == op_index) {
+      ++end;
+    }
+    for (const Effector* effector : PlanOf(table).effectors[op_index]) {
+      ZETASQL_RETURN_IF_ERROR(
+          effector->EffectBatch(ctx, ops.subspan(begin, end - begin)));
+    }
+    begin = end;
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ActionRegistry::ExecuteGeneratedKeyEffectors(
     const MutationOp& op,
     std::vector<std::vector<zetasql::Value>>* generated_values,
@@ -86,7 +127,7 @@ absl::Status ActionRegistry::ExecuteGeneratedKeyEffectors(
 
 absl::Status ActionRegistry::ExecuteModifiers(const ActionContext* ctx,
                                               const WriteOp& op) {
-  for (auto& modifier : table_modifiers_[TableOf(op)]) {
+  for (const Modifier* modifier : PlanOf(TableOf(op)).modifiers) {
     ZETASQL_RETURN_IF_ERROR(modifier->Modify(ctx, op));
   }
   return absl::OkStatus();
@@ -94,12 +135,64 @@ absl::Status ActionRegistry::ExecuteModifiers(const ActionContext* ctx,
 
 absl::Status ActionRegistry::ExecuteVerifiers(const ActionContext* ctx,
                                               const WriteOp& op) {
-  for (auto& verifier : table_verifiers_[TableOf(op)]) {
+  for (const Verifier* verifier : PlanOf(TableOf(op)).verifiers) {
     ZETASQL_RETURN_IF_ERROR(verifier->Verify(ctx, op));
   }
   return absl::OkStatus();
 }
 
+absl::Status ActionRegistry::ExecuteVerifiers(const ActionContext* ctx,
+                                              absl::Span<const WriteOp> ops) {
+  for (size_t begin = 0; begin < ops.size();) {
+    const Table* table = TableOf(ops[begin]);
+    size_t end = begin + 1;
+    while (end < ops.size() && TableOf(ops[end]) == table) {
+      ++end;
+    }
+    for (const Verifier* verifier : PlanOf(table).verifiers) {
+      ZETASQL_RETURN_IF_ERROR(
+          verifier->VerifyBatch(ctx, ops.subspan(begin, end - begin)));
+    }
+    begin = end;
+  }
+  return absl::OkStatus();
+}
+
+const ActionRegistry::TablePlan& ActionRegistry::PlanOf(
+    const Table* table) const {
+  static const TablePlan* const kEmptyPlan = new TablePlan();
+  auto itr = table_plans_.find(table);
+  return itr == table_plans_.end() ? *kEmptyPlan : itr->second;
+}
+
+void ActionRegistry::AddValidator(const Table* table, OpTypes op_types,
+                                  std::unique_ptr<Validator> validator) {
+  TablePlan& plan = table_plans_[table];
+  for (int i = 0; i < kNumOpTypes; ++i) {
+    if (op_types & (1 << i)) {
+      plan.validators[i].push_back(validator.get());
+    }
+  }
+  validators_.push_back(std::move(validator));
+}
+
+void ActionRegistry::AddEffector(const Table* table, OpTypes op_types,
+                                 std::unique_ptr<Effector> effector) {
+  TablePlan& plan = table_plans_[table];
+  for (int i = 0; i < kNumOpTypes; ++i) {
+    if (op_types & (1 << i)) {
+      plan.effectors[i].push_back(effector.get());
+    }
+  }
+  effectors_.push_back(std::move(effector));
+}
+
+void ActionRegistry::AddVerifier(const Table* table,
+                                 std::unique_ptr<Verifier> verifier) {
+  table_plans_[table].verifiers.push_back(verifier.get());
+  verifiers_.push_back(std::move(verifier));
+}
+
 ActionRegistry::ActionRegistry(const Schema* schema,
                                const FunctionCatalog* function_catalog,
                                zetasql::TypeFactory* type_factory_)
@@ -110,60 +203,58 @@ ActionRegistry::ActionRegistry(const Schema* schema,
 void ActionRegistry::BuildActionRegistry() {
   for (const Table* table : schema_->tables()) {
     // Column value checks for all tables.
-    table_validators_[table].emplace_back(
-        std::make_unique<ColumnValueValidator>());
+    AddValidator(table, kAllOps, std::make_unique<ColumnValueValidator>());
 
     // Row existence checks for all tables.
-    table_validators_[table].emplace_back(
-        std::make_unique<RowExistenceValidator>());
+    AddValidator(table, kInsert | kUpdate,
+                 std::make_unique<RowExistenceValidator>());
 
     // Interleave actions for child tables.
     for (const Table* child : table->children()) {
-      table_validators_[table].emplace_back(
-          std::make_unique<InterleaveParentValidator>(table, child));
+      AddValidator(table, kDelete,
+                   std::make_unique<InterleaveParentValidator>(table, child));
 
-      table_effectors_[table].emplace_back(
-          std::make_unique<InterleaveParentEffector>(table, child));
+      AddEffector(table, kDelete,
+                  std::make_unique<InterleaveParentEffector>(table, child));
     }
 
     // Interleave actions for parent table.
     if (table->parent() != nullptr) {
-      table_validators_[table].emplace_back(
+      AddValidator(
+          table, kInsert,
           std::make_unique<InterleaveChildValidator>(table->parent(), table));
     }
 
     // Actions for Index.
     for (const Index* index : table->indexes()) {
       // Index effects.
-      table_effectors_[table].emplace_back(
-          std::make_unique<IndexEffector>(index));
+      AddEffector(table, kAllOps, std::make_unique<IndexEffector>(index));
 
       // Index uniqueness checks.
       if (index->is_unique()) {
-        table_verifiers_[index->index_data_table()].emplace_back(
-            std::make_unique<UniqueIndexVerifier>(index));
+        AddVerifier(index->index_data_table(),
+                    std::make_unique<UniqueIndexVerifier>(index));
       }
     }
 
     // Actions for foreign keys.
     for (const ForeignKey* foreign_key : table->foreign_keys()) {
-      table_verifiers_[foreign_key->referencing_data_table()].emplace_back(
-          std::make_unique<ForeignKeyReferencingVerifier>(foreign_key));
+      AddVerifier(foreign_key->referencing_data_table(),
+                  std::make_unique<ForeignKeyReferencingVerifier>(foreign_key));
     }
     for (const ForeignKey* foreign_key : table->referencing_foreign_keys()) {
-      table_verifiers_[foreign_key->referenced_data_table()].emplace_back(
-          std::make_unique<ForeignKeyReferencedVerifier>(foreign_key));
+      AddVerifier(foreign_key->referenced_data_table(),
+                  std::make_unique<ForeignKeyReferencedVerifier>(foreign_key));
       if (foreign_key->on_delete_action() == ForeignKey::Action::kCascade) {
-        table_effectors_[table].emplace_back(
-            std::make_unique<ForeignKeyActionEffector>(foreign_key));
+        AddEffector(table, kDelete,
+                    std::make_unique<ForeignKeyActionEffector>(foreign_key));
       }
     }
 
     // Actions for check constraints.
     for (const CheckConstraint* check_constraint : table->check_constraints()) {
-      table_verifiers_[table].emplace_back(
-          std::make_unique<CheckConstraintVerifier>(check_constraint,
-                                                    &catalog_));
+      AddVerifier(table, std::make_unique<CheckConstraintVerifier>(
+                             check_constraint, &catalog_));
     }
 
     // A set containing key columns with default/generated values.
@@ -186,7 +277,8 @@ void ActionRegistry::BuildActionRegistry() {
     for (const Column* column : table->columns()) {
       if (!default_or_generated_key_columns.contains(column->Name()) &&
           (column->is_generated() || column->has_default_value())) {
-        table_effectors_[table].emplace_back(
+        AddEffector(
+            table, kInsert | kUpdate,
             std::make_unique<GeneratedColumnEffector>(table, &catalog_));
         break;
       }
@@ -17,14 +17,19 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_MANAGER_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_MANAGER_H_
 
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "backend/access/write.h"
 #include "backend/actions/action.h"
 #include "backend/actions/context.h"
@@ -43,7 +48,10 @@ namespace backend {
 // ActionRegistry is a collection of actions for a given schema.
 //
 // Transactions use this registry for constraint checking the writes to a
-// database.
+// database. The actions are compiled once per schema into a flat plan per
+// table, with the validators and effectors further split by the type of
+// operation they handle, so that executing the actions for an operation takes
+// a single lookup and only visits the actions which apply to it.
 class ActionRegistry {
  public:
   explicit ActionRegistry(const Schema* schema,
@@ -53,9 +61,24 @@ class ActionRegistry {
   // Executes the list of validators that apply to the given operation.
   absl::Status ExecuteValidators(const ActionContext* ctx, const WriteOp& op);
 
+  // Executes the validators that apply to each of the given operations. Each
+  // validator is handed all consecutive operations on its table with the same
+  // op type at once, so that it can batch its lookups. Hence a validator only
+  // sees the operations after the validators registered before it have
+  // accepted all of them. The operations must be on distinct rows.
+  absl::Status ExecuteValidators(const ActionContext* ctx,
+                                 absl::Span<const WriteOp> ops);
+
   // Executes the list of effectors that apply to the given operation.
   absl::Status ExecuteEffectors(const ActionContext* ctx, const WriteOp& op);
 
+  // Executes the effectors that apply to each of the given operations. Each
+  // effector is handed all consecutive operations on its table with the same
+  // op type at once, so that it can batch its lookups. The operations must be
+  // on distinct rows.
+  absl::Status ExecuteEffectors(const ActionContext* ctx,
+                                absl::Span<const WriteOp> ops);
+
   // Executes the generated key effector that applies to the given mutation op.
   absl::Status ExecuteGeneratedKeyEffectors(
       const MutationOp& op,
@@ -68,35 +91,69 @@ class ActionRegistry {
   // Executes the list of verifiers that apply to the given operation.
   absl::Status ExecuteVerifiers(const ActionContext* ctx, const WriteOp& op);
 
+  // Executes the verifiers that apply to each of the given operations. Each
+  // verifier is handed all consecutive operations on its table at once, so
+  // that it can batch its lookups.
+  absl::Status ExecuteVerifiers(const ActionContext* ctx,
+                                absl::Span<const WriteOp> ops);
+
+  // Returns true if any table of the schema has verifiers. If not, callers
+  // can skip collecting the operations of a statement to verify.
+  bool has_verifiers() const { return !verifiers_.empty(); }
+
  private:
+  // Number of types of operations, i.e. of alternatives of WriteOp.
+  static constexpr int kNumOpTypes = std::variant_size_v<WriteOp>;
+
+  // Bit masks of the types of operations an action handles, indexed by the
+  // position of the operation type in WriteOp.
+  using OpTypes = uint8_t;
+  static constexpr OpTypes kInsert = 1 << 0;
+  static constexpr OpTypes kUpdate = 1 << 1;
+  static constexpr OpTypes kDelete = 1 << 2;
+  static constexpr OpTypes kAllOps = kInsert | kUpdate | kDelete;
+
+  // The actions which apply to the operations on a single table, in the order
+  // in which they were registered. Verifiers receive all the operations on the
+  // table of a statement at once, so they are not split by operation type.
+  struct TablePlan {
+    std::array<std::vector<const Validator*>, kNumOpTypes> validators;
+    std::array<std::vector<const Effector*>, kNumOpTypes> effectors;
+    std::vector<const Modifier*> modifiers;
+    std::vector<const Verifier*> verifiers;
+  };
+
   // Initialize the validators, effectors, modifiers and verifiers for each
   // table in the given schema.
   void BuildActionRegistry();
 
+  // Registers an action for the operations of `op_types` on `table`.
+  void AddValidator(const Table* table, OpTypes op_types,
+                    std::unique_ptr<Validator> validator);
+  void AddEffector(const Table* table, OpTypes op_types,
+                   std::unique_ptr<Effector> effector);
+  void AddVerifier(const Table* table, std::unique_ptr<Verifier> verifier);
+
+  // Returns the plan of `table`, which is empty if no action applies to it.
+  const TablePlan& PlanOf(const Table* table) const;
+
   // Schema used to define the registry of actions.
   const Schema* schema_;
 
-  // List of validators per table.
-  absl::node_hash_map<const Table*, std::vector<std::unique_ptr<Validator>>>
-      table_validators_;
+  // The registered actions, which the plans point into.
+  std::vector<std::unique_ptr<Validator>> validators_;
+  std::vector<std::unique_ptr<Effector>> effectors_;
+  std::vector<std::unique_ptr<Modifier>> modifiers_;
+  std::vector<std::unique_ptr<Verifier>> verifiers_;
 
-  // List of effectors per table.
-  absl::node_hash_map<const Table*, std::vector<std::unique_ptr<Effector>>>
-      table_effectors_;
+  // Plan of actions per table. Tables without any action have no entry.
+  absl::flat_hash_map<const Table*, TablePlan> table_plans_;
 
   // List of effectors for primary key columns per table.
   absl::node_hash_map<const std::string,
                       std::unique_ptr<GeneratedColumnEffector>>
       table_generated_key_effectors_;
 
-  // List of modifiers per table.
-  absl::node_hash_map<const Table*, std::vector<std::unique_ptr<Modifier>>>
-      table_modifiers_;
-
-  // List of verifiers per table.
-  absl::node_hash_map<const Table*, std::vector<std::unique_ptr<Verifier>>>
-      table_verifiers_;
-
   // Used for function resolution in actions.
   Catalog catalog_;
 };
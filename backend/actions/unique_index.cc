@@ -16,9 +16,14 @@
 
 #include "backend/actions/unique_index.h"
 
+#include <variant>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "backend/actions/action.h"
 #include "backend/actions/context.h"
 #include "backend/actions/ops.h"
+#include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/storage/iterator.h"
 #include "common/errors.h"
@@ -32,6 +37,35 @@ namespace backend {
 
 UniqueIndexVerifier::UniqueIndexVerifier(const Index* index) : index_(index) {}
 
+absl::Status UniqueIndexVerifier::VerifyBatch(
+    const ActionContext* ctx, absl::Span<const WriteOp> ops) const {
+  if (!index_->is_unique()) {
+    return absl::OkStatus();
+  }
+
+  // Two inserts of the same index key violate the constraint, and are found
+  // without reading the index.
+  absl::flat_hash_set<Key> index_keys;
+  for (const WriteOp& op : ops) {
+    if (const InsertOp* insert = std::get_if<InsertOp>(&op)) {
+      Key index_key = insert->key.Prefix(index_->key_columns().size());
+      if (!index_keys.insert(index_key).second) {
+        return error::UniqueIndexConstraintViolation(index_->Name(),
+                                                     index_key.DebugString());
+      }
+    }
+  }
+
+  // The remaining inserts are checked against the existing index entries.
+  for (const WriteOp& op : ops) {
+    if (const InsertOp* insert = std::get_if<InsertOp>(&op)) {
+      ZETASQL_RETURN_IF_ERROR(VerifyIndexKey(
+          ctx, insert->key.Prefix(index_->key_columns().size())));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status UniqueIndexVerifier::Verify(const ActionContext* ctx,
                                          const InsertOp& op) const {
   if (!index_->is_unique()) {
@@ -39,8 +73,11 @@ absl::Status UniqueIndexVerifier::Verify(const ActionContext* ctx,
   }
 
   // Prefix key from the index data table.
-  Key index_key = op.key.Prefix(index_->key_columns().size());
+  return VerifyIndexKey(ctx, op.key.Prefix(index_->key_columns().size()));
+}
 
+absl::Status UniqueIndexVerifier::VerifyIndexKey(const ActionContext* ctx,
+                                                 const Key& index_key) const {
   // Find all entries for the the given index key.
   ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<StorageIterator> itr,
                    ctx->store()->Read(index_->index_data_table(),
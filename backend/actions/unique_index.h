@@ -17,9 +17,11 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_UNIQUE_INDEX_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_ACTIONS_UNIQUE_INDEX_H_
 
+#include "absl/types/span.h"
 #include "backend/actions/action.h"
 #include "backend/actions/context.h"
 #include "backend/actions/ops.h"
+#include "backend/datamodel/key.h"
 #include "backend/schema/catalog/index.h"
 #include "absl/status/status.h"
 
@@ -35,14 +37,24 @@ namespace backend {
 // verification is required for an Update operation to an index. Insert
 // operation verifies if there are no duplicate index keys within a unique index
 // table.
+//
+// For a batch of operations, index keys inserted more than once are detected
+// with a hash set, without reading the index.
 class UniqueIndexVerifier : public Verifier {
  public:
   explicit UniqueIndexVerifier(const Index* index);
 
+  absl::Status VerifyBatch(const ActionContext* ctx,
+                           absl::Span<const WriteOp> ops) const override;
+
  private:
   absl::Status Verify(const ActionContext* ctx,
                       const InsertOp& op) const override;
 
+  // Verifies that the index holds a single entry for the given index key.
+  absl::Status VerifyIndexKey(const ActionContext* ctx,
+                              const Key& index_key) const;
+
   // Index to verify unique entries.
   const Index* index_;
 };
@@ -17,6 +17,7 @@
 #include "backend/actions/unique_index.h"
 
 #include <memory>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -96,6 +97,31 @@ TEST_F(UniqueIndexTest, UniqueIndexKeysReturnsOk) {
                                             Key({String("value")}), {}, {})));
 }
 
+TEST_F(UniqueIndexTest, DuplicateIndexKeysInBatchReturnsAlreadyExistsError) {
+  // The duplicate is found from the batch itself, before the index is read.
+  std::vector<WriteOp> ops = {
+      Insert(index_->index_data_table(), Key({String("value"), Int64(3)}), {},
+             {}),
+      Insert(index_->index_data_table(), Key({String("value"), Int64(4)}), {},
+             {})};
+  EXPECT_THAT(verifier_->VerifyBatch(ctx(), ops),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+}
+
+TEST_F(UniqueIndexTest, UniqueIndexKeysInBatchReturnsOk) {
+  ZETASQL_EXPECT_OK(store()->Insert(index_->index_data_table(),
+                            Key({String("value"), Int64(3)}), {}, {}));
+  ZETASQL_EXPECT_OK(store()->Insert(index_->index_data_table(),
+                            Key({String("other-value"), Int64(4)}), {}, {}));
+
+  std::vector<WriteOp> ops = {
+      Insert(index_->index_data_table(), Key({String("value"), Int64(3)}), {},
+             {}),
+      Insert(index_->index_data_table(),
+             Key({String("other-value"), Int64(4)}), {}, {})};
+  ZETASQL_EXPECT_OK(verifier_->VerifyBatch(ctx(), ops));
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
@@ -0,0 +1,94 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "backend/schema/ddl/operations.pb.h"
+#include "backend/schema/parser/ddl_parser.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+// Returns 'num_tables' CREATE TABLE statements with 'num_columns' columns
+// each, the shape of a typical bulk schema load.
+std::vector<std::string> MakeCreateTables(int num_tables, int num_columns) {
+  std::vector<std::string> statements;
+  statements.reserve(num_tables);
+  for (int t = 0; t < num_tables; ++t) {
+    std::string ddl = absl::StrCat("CREATE TABLE Table", t,
+                                   " (Id INT64 NOT NULL");
+    for (int c = 0; c < num_columns; ++c) {
+      absl::StrAppend(&ddl, ", Col", c,
+                      c % 2 == 0 ? " STRING(MAX)" : " TIMESTAMP");
+    }
+    absl::StrAppend(&ddl, ") PRIMARY KEY (Id)");
+    statements.push_back(std::move(ddl));
+  }
+  return statements;
+}
+
+void ParseAll(benchmark::State& state, int64_t max_cached_statements) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_ddl_parser_cache_max_statements, max_cached_statements);
+  ddl::ClearParsedDDLStatementCache();
+  const std::vector<std::string> statements =
+      MakeCreateTables(state.range(0), state.range(1));
+  for (auto _ : state) {
+    for (const std::string& ddl : statements) {
+      ddl::DDLStatement statement;
+      ABSL_CHECK_OK(ddl::ParseDDLStatement(ddl, &statement));
+      benchmark::DoNotOptimize(statement);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * statements.size());
+  ddl::ClearParsedDDLStatementCache();
+}
+
+void BM_ParseCreateTable(benchmark::State& state) {
+  ParseAll(state, /*max_cached_statements=*/0);
+}
+BENCHMARK(BM_ParseCreateTable)
+    ->ArgNames({"tables", "cols"})
+    ->Args({10, 4})
+    ->Args({100, 4})
+    ->Args({100, 32})
+    ->Args({1000, 4})
+    ->Args({5000, 4});
+
+void BM_ParseCreateTableCached(benchmark::State& state) {
+  ParseAll(state, /*max_cached_statements=*/10000);
+}
+BENCHMARK(BM_ParseCreateTableCached)
+    ->ArgNames({"tables", "cols"})
+    ->Args({100, 4})
+    ->Args({100, 32});
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
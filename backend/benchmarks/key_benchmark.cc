@@ -0,0 +1,78 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "backend/datamodel/key.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::String;
+
+// Returns a key with 'num_parts' columns. Keys built with the same
+// 'num_parts' share every column except the last one, which is the worst case
+// for Key::Compare.
+Key MakeKey(int num_parts, int64_t last) {
+  Key key;
+  for (int i = 0; i + 1 < num_parts; ++i) {
+    key.AddColumn(String(absl::StrCat("prefix-", i)), /*desc=*/false);
+  }
+  key.AddColumn(Int64(last), /*desc=*/false);
+  return key;
+}
+
+void BM_KeyCompare(benchmark::State& state) {
+  const int num_parts = state.range(0);
+  const Key lhs = MakeKey(num_parts, 1);
+  const Key rhs = MakeKey(num_parts, 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(lhs.Compare(rhs));
+  }
+}
+BENCHMARK(BM_KeyCompare)->ArgName("cols")->Arg(1)->Arg(4)->Arg(16);
+
+void BM_KeyCompareSorted(benchmark::State& state) {
+  const int64_t num_keys = state.range(0);
+  const int num_parts = state.range(1);
+  std::vector<Key> keys;
+  keys.reserve(num_keys);
+  for (int64_t i = 0; i < num_keys; ++i) {
+    keys.push_back(MakeKey(num_parts, i));
+  }
+  for (auto _ : state) {
+    for (int64_t i = 1; i < num_keys; ++i) {
+      benchmark::DoNotOptimize(keys[i - 1] < keys[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * (num_keys - 1));
+}
+BENCHMARK(BM_KeyCompareSorted)
+    ->ArgNames({"rows", "cols"})
+    ->ArgsProduct({{1 << 10, 1 << 14}, {1, 4, 16}});
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
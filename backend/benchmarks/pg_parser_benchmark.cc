@@ -0,0 +1,86 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/log/check.h"
+#include "third_party/spanner_pg/interface/parser_output.h"
+#include "third_party/spanner_pg/interface/parser_without_serialization.h"
+#include "third_party/spanner_pg/shims/memory_context_manager.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using ::postgres_translator::interfaces::ParserSingleOutput;
+using ::postgres_translator::spangres::ParserWithoutSerialization;
+
+// Short statements of the kind sent by PG drivers, for which setting up the
+// parser can cost as much as parsing itself.
+const std::vector<std::string>& ShortStatements() {
+  static const auto* statements = new std::vector<std::string>{
+      "SELECT 1",
+      "SELECT a, b FROM t WHERE a = $1",
+      "INSERT INTO t (a, b) VALUES ($1, $2)",
+      "UPDATE t SET b = $2 WHERE a = $1",
+      "DELETE FROM t WHERE a = $1",
+      "SELECT count(*) FROM t JOIN u ON t.a = u.a GROUP BY t.b",
+  };
+  return *statements;
+}
+
+// Parses each short statement in its own batch, as the emulator does for every
+// query and DML statement. Each batch initializes the thread's PG memory
+// context, which is a fresh context when 'pooled_context_max_bytes' is 0 and
+// the thread's reset warm context otherwise.
+void ParseAll(benchmark::State& state, int64_t pooled_context_max_bytes) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_spangres_pooled_memory_context_max_bytes,
+                pooled_context_max_bytes);
+  ParserWithoutSerialization parser;
+  const std::vector<std::string>& statements = ShortStatements();
+  for (auto _ : state) {
+    for (const std::string& sql : statements) {
+      ParserSingleOutput output = parser.Parse(sql);
+      ABSL_CHECK_OK(output.output().status());
+      benchmark::DoNotOptimize(output);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * statements.size());
+}
+
+void BM_ParseShortStatementsFreshContext(benchmark::State& state) {
+  ParseAll(state, /*pooled_context_max_bytes=*/0);
+}
+BENCHMARK(BM_ParseShortStatementsFreshContext);
+
+void BM_ParseShortStatementsWarmContext(benchmark::State& state) {
+  ParseAll(state, /*pooled_context_max_bytes=*/1 << 20);
+}
+BENCHMARK(BM_ParseShortStatementsWarmContext);
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,147 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/public/analyzer_output.h"
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "third_party/spanner_pg/interface/parser_without_serialization.h"
+#include "third_party/spanner_pg/interface/spangres_translator_test_wrapper.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using ::postgres_translator::spangres::ParserWithoutSerialization;
+using ::postgres_translator::spangres::SpangresTranslatorTestWrapper;
+
+struct CorpusQuery {
+  std::string name;
+  std::string sql;
+};
+
+// A cross-section of the queries and DML of
+// third_party/spanner_pg/transformer/query_test.cc, run against the same
+// Spangres test catalog.
+const std::vector<CorpusQuery>& QueryCorpus() {
+  static const auto* corpus = new std::vector<CorpusQuery>{
+      {"SelectTableAlias", "select key from keyvalue kv"},
+      {"SelectMixedItems",
+       "select value, key, 12345678912 as col3, 98765432121 as col4, key, "
+       "value from keyvalue"},
+      {"TwoTablesJoin",
+       "select kv.value from keyvalue kv "
+       "left join \"KeyValue2\" kv2 on (kv.value = kv2.value2)"},
+      {"FourTablesTwoJoins",
+       "select kv.key, kv2.value2, kv3.value, kv4.key from keyvalue kv "
+       "join \"KeyValue2\" kv2 on kv.value = kv2.value2, keyvalue "
+       "kv3 join keyvalue kv4 on kv3.key = kv4.key"},
+      {"OrderByInsideSubquery",
+       "select \"$subquery1\".key from "
+       "(select key, value from keyvalue kv order by 2,1) "
+       "\"$subquery1\" order by 1"},
+      {"GroupByInsideSubquery",
+       "select k from (select key+1 as k, value from keyvalue kv "
+       "group by 2,key) sub group by 1"},
+      {"AggregateDistinctFunction",
+       "select count(distinct key) as count from keyvalue where key > "
+       "1234567890123"},
+      {"BoolExpr",
+       "select * from keyvalue where key > 5 and not(key > 10) and "
+       "value='hello' and (key = 6 or value='world')"},
+      {"CaseWhenNoValue",
+       "select case when key = 4 then 8 when key > 6 then "
+       "24 else 100 end as result from keyvalue"},
+      {"WithAlias",
+       "with t1 as (select key kk, value vv from keyvalue), "
+       "t2 as (select kk xx, vv from t1) "
+       "select xx, vv, '--' as col, * from t2"},
+      {"SelectFloorDouble",
+       "select floor(double_value) as floor from \"AllSpangresTypes\""},
+      {"MultiValueInsert",
+       "insert into keyvalue(key, value) values(1234567890123, 'one'), "
+       "(2345678901234, 'two')"},
+      {"InsertSelect",
+       "insert into keyvalue(key, value) select key, value from keyvalue"},
+      {"UpdateReturning",
+       "update keyvalue set value='v' where key=12345678912 "
+       "returning key + 1 as newkey, value as newvalue"},
+      {"DeleteReturning", "delete from keyvalue where true returning *"},
+  };
+  return *corpus;
+}
+
+// Translates 'sql' from PostgreSQL to a ZetaSQL resolved AST, through the
+// parser, the PG analyzer and the forward transformer.
+void Translate(SpangresTranslatorTestWrapper& translator,
+               const std::string& sql) {
+  absl::StatusOr<std::unique_ptr<zetasql::AnalyzerOutput>> output =
+      translator.TranslateQuery(sql);
+  ABSL_CHECK_OK(output.status()) << sql;
+  benchmark::DoNotOptimize(output);
+}
+
+// Returns a translator whose test catalog has already been loaded, which takes
+// seconds and would otherwise be counted against the first iteration.
+std::unique_ptr<SpangresTranslatorTestWrapper> MakeWarmTranslator() {
+  auto translator = std::make_unique<SpangresTranslatorTestWrapper>(
+      std::make_unique<ParserWithoutSerialization>());
+  for (const CorpusQuery& query : QueryCorpus()) {
+    Translate(*translator, query.sql);
+  }
+  return translator;
+}
+
+// Measures translating the whole corpus, one TranslateQuery per statement as
+// the emulator does for every PG query and DML statement.
+void BM_TranslateQueryCorpus(benchmark::State& state) {
+  std::unique_ptr<SpangresTranslatorTestWrapper> translator =
+      MakeWarmTranslator();
+  for (auto _ : state) {
+    for (const CorpusQuery& query : QueryCorpus()) {
+      Translate(*translator, query.sql);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * QueryCorpus().size());
+}
+BENCHMARK(BM_TranslateQueryCorpus);
+
+// Measures translating a single corpus statement, so that a regression can be
+// attributed to the construct that causes it.
+void BM_TranslateQuery(benchmark::State& state) {
+  std::unique_ptr<SpangresTranslatorTestWrapper> translator =
+      MakeWarmTranslator();
+  const CorpusQuery& query = QueryCorpus()[state.range(0)];
+  state.SetLabel(query.name);
+  for (auto _ : state) {
+    Translate(*translator, query.sql);
+  }
+}
+BENCHMARK(BM_TranslateQuery)
+    ->ArgName("query")
+    ->DenseRange(0, QueryCorpus().size() - 1);
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,331 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/spanner/v1/spanner.pb.h"
+#include "zetasql/public/numeric_value.h"
+#include "zetasql/public/value.h"
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "backend/access/write.h"
+#include "backend/common/ids.h"
+#include "backend/database/database.h"
+#include "backend/query/query_context.h"
+#include "backend/query/query_engine.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "backend/transaction/options.h"
+#include "backend/transaction/read_only_transaction.h"
+#include "backend/transaction/read_write_transaction.h"
+#include "common/clock.h"
+#include "common/config.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Bool;
+using zetasql::values::Double;
+using zetasql::values::Int64;
+using zetasql::values::Numeric;
+using zetasql::values::String;
+
+// The users, threads, messages and scalar_types_table tables of the
+// conformance tests' query.test schema.
+const std::vector<std::string>& SchemaDDL() {
+  static const auto* ddl = new std::vector<std::string>{
+      R"sql(
+        CREATE TABLE users (
+          user_id INT64 NOT NULL,
+          name STRING(MAX),
+          age INT64,
+        ) PRIMARY KEY (user_id)
+      )sql",
+      R"sql(
+        CREATE TABLE threads (
+          user_id INT64 NOT NULL,
+          thread_id INT64 NOT NULL,
+          starred BOOL,
+        ) PRIMARY KEY (user_id, thread_id),
+        INTERLEAVE IN PARENT users ON DELETE CASCADE
+      )sql",
+      R"sql(
+        CREATE TABLE messages (
+          user_id INT64 NOT NULL,
+          thread_id INT64 NOT NULL,
+          message_id INT64 NOT NULL,
+          subject STRING(MAX),
+        ) PRIMARY KEY (user_id, thread_id, message_id),
+        INTERLEAVE IN PARENT threads ON DELETE CASCADE
+      )sql",
+      R"sql(
+        CREATE TABLE scalar_types_table (
+          int_val INT64 NOT NULL,
+          bool_val BOOL,
+          float_val FLOAT64,
+          string_val STRING(MAX),
+          numeric_val NUMERIC,
+        ) PRIMARY KEY (int_val)
+      )sql",
+  };
+  return *ddl;
+}
+
+// A query replayed by the benchmarks.
+struct CorpusQuery {
+  const char* name;
+  const char* sql;
+};
+
+// Representative queries of the conformance cases (query.cc,
+// information_schema.cc, ...), rewritten against the tables above so that they
+// scan scaled datasets instead of a handful of rows.
+constexpr CorpusQuery kCorpus[] = {
+    {"constant", "SELECT ARRAY(SELECT STRUCT<INT64>(1))"},
+    {"point_lookup", "SELECT name, age FROM users WHERE user_id = 42"},
+    {"point_lookup_param", "SELECT name, age FROM users WHERE user_id = @id"},
+    {"key_range",
+     "SELECT t.thread_id, t.starred FROM threads t "
+     "WHERE t.user_id BETWEEN 10 AND 20"},
+    {"non_key_filter", "SELECT user_id FROM users WHERE name = 'user-500'"},
+    {"full_scan_order_by",
+     "SELECT * FROM scalar_types_table ORDER BY int_val ASC"},
+    {"order_by_limit",
+     "SELECT user_id, name FROM users ORDER BY age DESC LIMIT 10"},
+    {"count", "SELECT COUNT(*) FROM messages"},
+    {"group_by", "SELECT age, COUNT(*) AS n FROM users GROUP BY age"},
+    {"interleaved_join",
+     "SELECT threads.thread_id, threads.starred, messages.subject "
+     "FROM threads JOIN messages "
+     "ON threads.user_id = messages.user_id "
+     "AND threads.thread_id = messages.thread_id "
+     "WHERE threads.user_id = 7"},
+    {"correlated_exists",
+     "SELECT u.user_id FROM users u WHERE EXISTS ("
+     "SELECT 1 FROM threads t WHERE t.user_id = u.user_id AND t.starred) "
+     "LIMIT 100"},
+    {"scalar_functions",
+     "SELECT CHAR_LENGTH(string_val), POWER(float_val, 2), CEIL(float_val), "
+     "SHA256(string_val) FROM scalar_types_table WHERE int_val < 100"},
+    {"information_schema_tables",
+     "SELECT table_name FROM information_schema.tables "
+     "WHERE table_schema = ''"},
+    {"information_schema_columns",
+     "SELECT table_name, column_name, spanner_type "
+     "FROM information_schema.columns WHERE table_schema = '' "
+     "ORDER BY table_name, ordinal_position"},
+};
+
+constexpr int64_t kCorpusSize = sizeof(kCorpus) / sizeof(kCorpus[0]);
+
+// Number of rows written by each transaction while loading a dataset.
+constexpr int64_t kLoadBatchSize = 10000;
+
+// A database whose users, threads, messages and scalar_types_table tables each
+// hold `num_rows` rows. Each user has 4 threads of 4 messages, so the threads
+// and messages of a row range of users are contiguous.
+class BenchmarkDatabase {
+ public:
+  explicit BenchmarkDatabase(int64_t num_rows) {
+    absl::StatusOr<std::unique_ptr<Database>> database = Database::Create(
+        &clock_, SchemaChangeOperation{.statements = SchemaDDL()});
+    ABSL_CHECK_OK(database.status());
+    database_ = std::move(database).value();
+    for (int64_t start = 0; start < num_rows; start += kLoadBatchSize) {
+      Load(start, std::min(num_rows, start + kLoadBatchSize));
+    }
+  }
+
+  Database* database() { return database_.get(); }
+
+  // Returns the dataset of `num_rows` rows, loading it on first use.
+  static BenchmarkDatabase* Get(int64_t num_rows) {
+    static auto* databases =
+        new std::map<int64_t, std::unique_ptr<BenchmarkDatabase>>();
+    std::unique_ptr<BenchmarkDatabase>& database = (*databases)[num_rows];
+    if (database == nullptr) {
+      database = std::make_unique<BenchmarkDatabase>(num_rows);
+    }
+    return database.get();
+  }
+
+ private:
+  // Loads the rows [start, end) of every table.
+  void Load(int64_t start, int64_t end) {
+    std::vector<ValueList> users, threads, messages, scalars;
+    for (int64_t i = start; i < end; ++i) {
+      users.push_back(
+          {Int64(i), String(absl::StrCat("user-", i)), Int64(i % 100)});
+      threads.push_back({Int64(i / 4), Int64(i % 4), Bool(i % 3 == 0)});
+      messages.push_back({Int64(i / 16), Int64(i / 4 % 4), Int64(i % 4),
+                          String(absl::StrCat("subject-", i))});
+      scalars.push_back(
+          {Int64(i), Bool(i % 2 == 0), Double(i * 0.5),
+           String(absl::StrCat("string-", i)),
+           Numeric(zetasql::NumericValue::FromPackedInt(__int128{i} * 10000000)
+                       .value())});
+    }
+    Mutation mutation;
+    mutation.AddWriteOp(MutationOpType::kInsert, "users",
+                        {"user_id", "name", "age"}, std::move(users));
+    mutation.AddWriteOp(MutationOpType::kInsert, "threads",
+                        {"user_id", "thread_id", "starred"},
+                        std::move(threads));
+    mutation.AddWriteOp(MutationOpType::kInsert, "messages",
+                        {"user_id", "thread_id", "message_id", "subject"},
+                        std::move(messages));
+    mutation.AddWriteOp(MutationOpType::kInsert, "scalar_types_table",
+                        {"int_val", "bool_val", "float_val", "string_val",
+                         "numeric_val"},
+                        std::move(scalars));
+    absl::StatusOr<std::unique_ptr<ReadWriteTransaction>> txn =
+        database_->CreateReadWriteTransaction(ReadWriteOptions(),
+                                              RetryState());
+    ABSL_CHECK_OK(txn.status());
+    ABSL_CHECK_OK((*txn)->Write(mutation));
+    ABSL_CHECK_OK((*txn)->Commit());
+  }
+
+  Clock clock_;
+  std::unique_ptr<Database> database_;
+};
+
+// Runs the corpus queries against the dataset of a benchmark's row count
+// through a QueryEngine of its own, so that the benchmark controls its caches.
+class QueryRunner {
+ public:
+  QueryRunner(int64_t num_rows, int64_t analyzed_query_cache_capacity)
+      : database_(BenchmarkDatabase::Get(num_rows)->database()),
+        engine_(database_->query_engine()->type_factory(),
+                analyzed_query_cache_capacity) {
+    engine_.SetLatestSchemaForFunctionCatalog(database_->GetLatestSchema());
+    absl::StatusOr<std::unique_ptr<ReadOnlyTransaction>> txn =
+        database_->CreateReadOnlyTransaction(ReadOnlyOptions());
+    ABSL_CHECK_OK(txn.status());
+    txn_ = std::move(txn).value();
+  }
+
+  // Executes `query` in `query_mode` and reads all of its rows. Returns the
+  // number of rows read.
+  int64_t Run(const CorpusQuery& query,
+              v1::ExecuteSqlRequest_QueryMode query_mode) {
+    Query q{.sql = query.sql};
+    if (std::string(query.name) == "point_lookup_param") {
+      q.declared_params["id"] = Int64(42);
+    }
+    absl::StatusOr<QueryResult> result = engine_.ExecuteSql(
+        q,
+        QueryContext{.schema = database_->GetLatestSchema(),
+                     .reader = txn_.get()},
+        query_mode);
+    ABSL_CHECK_OK(result.status()) << query.name;
+    int64_t num_rows = 0;
+    if (result->rows != nullptr) {
+      while (result->rows->Next()) ++num_rows;
+      ABSL_CHECK_OK(result->rows->Status()) << query.name;
+    }
+    return num_rows;
+  }
+
+ private:
+  Database* database_;
+  QueryEngine engine_;
+  std::unique_ptr<ReadOnlyTransaction> txn_;
+};
+
+// Benchmarks are parameterized by {corpus query, number of rows}.
+void QueriesAndRows(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"query", "rows"});
+  for (int64_t query = 0; query < kCorpusSize; ++query) {
+    for (int64_t rows : {1000, 100000, 1000000}) {
+      b->Args({query, rows});
+    }
+  }
+}
+
+// Analysis does not depend on the data, so it is measured on the smallest
+// dataset only.
+void Queries(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"query", "rows"});
+  for (int64_t query = 0; query < kCorpusSize; ++query) {
+    b->Args({query, 1000});
+  }
+}
+
+// Measures the analysis of each query: with the analyzed query cache disabled,
+// PLAN mode analyzes the query without evaluating it.
+void BM_QueryAnalyze(benchmark::State& state) {
+  const CorpusQuery& query = kCorpus[state.range(0)];
+  QueryRunner runner(state.range(1), /*analyzed_query_cache_capacity=*/0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(runner.Run(query, v1::ExecuteSqlRequest::PLAN));
+  }
+  state.SetLabel(query.name);
+}
+BENCHMARK(BM_QueryAnalyze)->Apply(Queries);
+
+// Measures the evaluation of each query: the analysis is cached by a first,
+// untimed execution, so iterations only evaluate the query and read its rows.
+void BM_QueryEvaluate(benchmark::State& state) {
+  const CorpusQuery& query = kCorpus[state.range(0)];
+  QueryRunner runner(state.range(1), kDefaultAnalyzedQueryCacheCapacity);
+  int64_t num_rows = runner.Run(query, v1::ExecuteSqlRequest::NORMAL);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(runner.Run(query, v1::ExecuteSqlRequest::NORMAL));
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+  state.SetLabel(query.name);
+}
+BENCHMARK(BM_QueryEvaluate)->Apply(QueriesAndRows);
+
+// Compares the evaluation of the NUMERIC aggregation by the native operators
+// (native = 1) with the reference evaluator (native = 0) on 10M rows.
+void BM_NumericAggregationNativeVsReference(benchmark::State& state) {
+  constexpr CorpusQuery kQuery = {
+      "numeric_sum_avg",
+      "SELECT bool_val, SUM(numeric_val), AVG(numeric_val) "
+      "FROM scalar_types_table GROUP BY bool_val"};
+  bool native_enabled = config::native_query_operators_enabled();
+  config::set_native_query_operators_enabled(state.range(0) != 0);
+  QueryRunner runner(state.range(1), kDefaultAnalyzedQueryCacheCapacity);
+  runner.Run(kQuery, v1::ExecuteSqlRequest::NORMAL);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(runner.Run(kQuery, v1::ExecuteSqlRequest::NORMAL));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+  config::set_native_query_operators_enabled(native_enabled);
+}
+BENCHMARK(BM_NumericAggregationNativeVsReference)
+    ->ArgNames({"native", "rows"})
+    ->Args({0, 10000000})
+    ->Args({1, 10000000})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
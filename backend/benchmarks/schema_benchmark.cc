@@ -0,0 +1,175 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/types/type_factory.h"
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "backend/common/ids.h"
+#include "backend/database/database.h"
+#include "backend/database/pg_oid_assigner/pg_oid_assigner.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "common/clock.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+// Returns the DDL of a schema with 'num_objects' schema objects: a table with
+// a few columns for every other object and a secondary index on each of those
+// tables. Pairing tables with indexes keeps the largest schemas within the
+// per-database table limit.
+std::vector<std::string> MakeSchema(int num_objects) {
+  std::vector<std::string> statements;
+  statements.reserve(num_objects);
+  for (int t = 0; static_cast<int>(statements.size()) < num_objects; ++t) {
+    statements.push_back(absl::StrCat(
+        "CREATE TABLE Table", t,
+        " (Id INT64 NOT NULL, Name STRING(MAX), Value FLOAT64,"
+        " UpdateTime TIMESTAMP) PRIMARY KEY (Id)"));
+    if (static_cast<int>(statements.size()) < num_objects) {
+      statements.push_back(absl::StrCat("CREATE INDEX Table", t,
+                                        "ByName ON Table", t, " (Name)"));
+    }
+  }
+  return statements;
+}
+
+// Owns the per-database state a standalone schema change runs against.
+class SchemaChangeEnvironment {
+ public:
+  SchemaChangeContext context() {
+    return SchemaChangeContext{
+        .type_factory = &type_factory_,
+        .table_id_generator = &table_id_generator_,
+        .column_id_generator = &column_id_generator_,
+        .schema_change_timestamp = absl::Now(),
+        .pg_oid_assigner = &pg_oid_assigner_,
+    };
+  }
+
+ private:
+  zetasql::TypeFactory type_factory_;
+  TableIDGenerator table_id_generator_;
+  ColumnIDGenerator column_id_generator_;
+  PgOidAssigner pg_oid_assigner_{/*enabled=*/false};
+};
+
+// Measures building a schema from scratch with a single batch of DDL, without
+// the database around it.
+void BM_ValidateSchemaFromDDL(benchmark::State& state) {
+  const std::vector<std::string> statements = MakeSchema(state.range(0));
+  for (auto _ : state) {
+    SchemaChangeEnvironment environment;
+    SchemaUpdater updater;
+    absl::StatusOr<std::unique_ptr<const Schema>> schema =
+        updater.ValidateSchemaFromDDL(
+            SchemaChangeOperation{.statements = statements},
+            environment.context());
+    ABSL_CHECK_OK(schema.status());
+    benchmark::DoNotOptimize(schema);
+  }
+  state.SetItemsProcessed(state.iterations() * statements.size());
+}
+BENCHMARK(BM_ValidateSchemaFromDDL)
+    ->ArgName("objects")
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Unit(benchmark::kMillisecond);
+
+// Measures adding one table to an existing schema, the cost of each of the
+// single-statement schema changes a test setup issues after the first.
+void BM_ValidateAddTableToSchema(benchmark::State& state) {
+  SchemaChangeEnvironment environment;
+  const std::vector<std::string> statements = MakeSchema(state.range(0));
+  absl::StatusOr<std::unique_ptr<const Schema>> existing_schema =
+      SchemaUpdater().ValidateSchemaFromDDL(
+          SchemaChangeOperation{.statements = statements},
+          environment.context());
+  ABSL_CHECK_OK(existing_schema.status());
+  const std::vector<std::string> add_table = {
+      "CREATE TABLE NewTable (Id INT64 NOT NULL, Name STRING(MAX))"
+      " PRIMARY KEY (Id)"};
+  for (auto _ : state) {
+    SchemaUpdater updater;
+    absl::StatusOr<std::unique_ptr<const Schema>> schema =
+        updater.ValidateSchemaFromDDL(
+            SchemaChangeOperation{.statements = add_table},
+            environment.context(), existing_schema->get());
+    ABSL_CHECK_OK(schema.status());
+    benchmark::DoNotOptimize(schema);
+  }
+}
+BENCHMARK(BM_ValidateAddTableToSchema)
+    ->ArgName("objects")
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(5000);
+
+// Measures Database::UpdateSchema applying the whole schema to an empty
+// database, including the backfill of the new indexes and the new schema
+// version becoming visible to transactions.
+void BM_UpdateSchema(benchmark::State& state) {
+  const std::vector<std::string> statements = MakeSchema(state.range(0));
+  Clock clock;
+  for (auto _ : state) {
+    state.PauseTiming();
+    absl::StatusOr<std::unique_ptr<Database>> database =
+        Database::Create(&clock, SchemaChangeOperation{});
+    ABSL_CHECK_OK(database.status());
+    state.ResumeTiming();
+
+    int num_successful_statements = 0;
+    absl::Time commit_timestamp;
+    absl::Status backfill_status;
+    ABSL_CHECK_OK((*database)->UpdateSchema(
+        SchemaChangeOperation{.statements = statements},
+        &num_successful_statements, &commit_timestamp, &backfill_status));
+    ABSL_CHECK_OK(backfill_status);
+
+    state.PauseTiming();
+    database->reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * statements.size());
+}
+BENCHMARK(BM_UpdateSchema)
+    ->ArgName("objects")
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
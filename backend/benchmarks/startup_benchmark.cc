@@ -0,0 +1,92 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/spanner/admin/database/v1/common.pb.h"
+#include "zetasql/public/function.h"
+#include "zetasql/public/types/type_factory.h"
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "backend/database/database.h"
+#include "backend/query/function_catalog.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "common/clock.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+namespace database_api = ::google::spanner::admin::database::v1;
+
+// Measures the per-database cost of bringing up the function catalog, without
+// the Spanner PG functions, which are only registered on first use.
+void BM_CreateFunctionCatalog(benchmark::State& state) {
+  zetasql::TypeFactory type_factory;
+  for (auto _ : state) {
+    FunctionCatalog function_catalog(&type_factory);
+    benchmark::DoNotOptimize(function_catalog);
+  }
+}
+BENCHMARK(BM_CreateFunctionCatalog);
+
+// Measures the function catalog bring-up followed by the first lookup of a
+// Spanner PG function, as done by the first PG query of a database.
+void BM_CreateFunctionCatalogAndLoadPGFunctions(benchmark::State& state) {
+  zetasql::TypeFactory type_factory;
+  for (auto _ : state) {
+    FunctionCatalog function_catalog(&type_factory);
+    const zetasql::Function* function = nullptr;
+    function_catalog.GetFunction("pg.map_double_to_int", &function);
+    ABSL_CHECK(function != nullptr);
+    benchmark::DoNotOptimize(function);
+  }
+}
+BENCHMARK(BM_CreateFunctionCatalogAndLoadPGFunctions);
+
+// Measures creating a database with a single table, which is what an emulator
+// started for a test pays before serving its first request.
+void BM_CreateDatabase(benchmark::State& state) {
+  const bool postgresql = state.range(0);
+  const std::vector<std::string> statements = {
+      postgresql ? "CREATE TABLE t (k bigint PRIMARY KEY, v varchar)"
+                 : "CREATE TABLE t (k INT64, v STRING(MAX)) PRIMARY KEY (k)"};
+  Clock clock;
+  for (auto _ : state) {
+    absl::StatusOr<std::unique_ptr<Database>> database = Database::Create(
+        &clock, SchemaChangeOperation{
+                    .statements = statements,
+                    .database_dialect =
+                        postgresql ? database_api::DatabaseDialect::POSTGRESQL
+                                   : database_api::DatabaseDialect::
+                                         GOOGLE_STANDARD_SQL});
+    ABSL_CHECK_OK(database.status());
+    benchmark::DoNotOptimize(database);
+  }
+}
+BENCHMARK(BM_CreateDatabase)->ArgName("postgresql")->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,176 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/storage/in_memory_storage.h"
+#include "backend/storage/iterator.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::String;
+
+constexpr char kTableId[] = "benchmark_table:0";
+
+// Benchmarks are parameterized by {number of rows, number of columns}.
+void RowsAndColumns(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"rows", "cols"});
+  for (int64_t rows : {1 << 10, 1 << 14, 1 << 17}) {
+    for (int64_t cols : {1, 8, 32}) {
+      b->Args({rows, cols});
+    }
+  }
+}
+
+std::vector<ColumnID> MakeColumnIds(int num_columns) {
+  std::vector<ColumnID> column_ids;
+  column_ids.reserve(num_columns);
+  for (int i = 0; i < num_columns; ++i) {
+    column_ids.push_back(absl::StrCat("benchmark_column:", i));
+  }
+  return column_ids;
+}
+
+std::vector<zetasql::Value> MakeRowValues(int64_t row, int num_columns) {
+  std::vector<zetasql::Value> values;
+  values.reserve(num_columns);
+  for (int i = 0; i < num_columns; ++i) {
+    values.push_back(String(absl::StrCat("value-", row, "-", i)));
+  }
+  return values;
+}
+
+// Populates 'storage' with 'num_rows' rows keyed by 0..num_rows-1.
+void Populate(InMemoryStorage* storage, absl::Time timestamp, int64_t num_rows,
+              const std::vector<ColumnID>& column_ids) {
+  for (int64_t row = 0; row < num_rows; ++row) {
+    benchmark::DoNotOptimize(
+        storage->Write(timestamp, kTableId, Key({Int64(row)}), column_ids,
+                       MakeRowValues(row, column_ids.size())));
+  }
+}
+
+void BM_InMemoryStorageWrite(benchmark::State& state) {
+  const int64_t num_rows = state.range(0);
+  const std::vector<ColumnID> column_ids = MakeColumnIds(state.range(1));
+  const std::vector<zetasql::Value> values =
+      MakeRowValues(0, column_ids.size());
+  const absl::Time timestamp = absl::Now();
+
+  InMemoryStorage storage;
+  Populate(&storage, timestamp, num_rows, column_ids);
+  int64_t row = 0;
+  for (auto _ : state) {
+    // Overwrite existing rows so that the table size stays fixed.
+    benchmark::DoNotOptimize(storage.Write(
+        timestamp, kTableId, Key({Int64(row)}), column_ids, values));
+    row = (row + 1) % num_rows;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InMemoryStorageWrite)->Apply(RowsAndColumns);
+
+// Appends rows in ascending key order to an initially empty table, as writes
+// to tables and indexes keyed by commit timestamps do.
+void BM_InMemoryStorageAppend(benchmark::State& state) {
+  const int64_t num_rows = state.range(0);
+  const std::vector<ColumnID> column_ids = MakeColumnIds(state.range(1));
+  const absl::Time timestamp = absl::Now();
+
+  for (auto _ : state) {
+    InMemoryStorage storage;
+    Populate(&storage, timestamp, num_rows, column_ids);
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK(BM_InMemoryStorageAppend)->Apply(RowsAndColumns);
+
+void BM_InMemoryStorageLookup(benchmark::State& state) {
+  const int64_t num_rows = state.range(0);
+  const std::vector<ColumnID> column_ids = MakeColumnIds(state.range(1));
+  const absl::Time timestamp = absl::Now();
+
+  InMemoryStorage storage;
+  Populate(&storage, timestamp, num_rows, column_ids);
+  std::vector<zetasql::Value> values;
+  int64_t row = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(storage.Lookup(
+        timestamp, kTableId, Key({Int64(row)}), column_ids, &values));
+    // Stride through the key space to avoid always hitting adjacent rows.
+    row = (row + 7919) % num_rows;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InMemoryStorageLookup)->Apply(RowsAndColumns);
+
+// Probes keys which do not exist, as insert and foreign key checks mostly do.
+void BM_InMemoryStorageExistsMissingKey(benchmark::State& state) {
+  const int64_t num_rows = state.range(0);
+  const std::vector<ColumnID> column_ids = MakeColumnIds(state.range(1));
+  const absl::Time timestamp = absl::Now();
+
+  InMemoryStorage storage;
+  Populate(&storage, timestamp, num_rows, column_ids);
+  int64_t row = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        storage.Exists(timestamp, kTableId, Key({Int64(num_rows + row)})));
+    row = (row + 7919) % num_rows;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InMemoryStorageExistsMissingKey)->Apply(RowsAndColumns);
+
+void BM_InMemoryStorageReadAll(benchmark::State& state) {
+  const int64_t num_rows = state.range(0);
+  const std::vector<ColumnID> column_ids = MakeColumnIds(state.range(1));
+  const absl::Time timestamp = absl::Now();
+
+  InMemoryStorage storage;
+  Populate(&storage, timestamp, num_rows, column_ids);
+  for (auto _ : state) {
+    std::unique_ptr<StorageIterator> itr;
+    benchmark::DoNotOptimize(
+        storage.Read(timestamp, kTableId, KeyRange::All(), column_ids, &itr));
+    while (itr->Next()) {
+      benchmark::DoNotOptimize(itr->ColumnValue(0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK(BM_InMemoryStorageReadAll)->Apply(RowsAndColumns);
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,185 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "zetasql/public/functions/like.h"
+#include "zetasql/public/functions/string.h"
+#include "zetasql/public/type.pb.h"
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "backend/query/string_functions.h"
+#include "re2/re2.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+// Returns a mixed-case ASCII string of `size` bytes which does not contain
+// "needle" until its end.
+std::string MakeString(int64_t size) {
+  std::string str;
+  while (str.size() < size) {
+    absl::StrAppend(&str, "The Quick Brown Fox Jumps Over The Lazy Dog. ");
+  }
+  str.resize(size - 6);
+  absl::StrAppend(&str, "needle");
+  return str;
+}
+
+constexpr int64_t kMinSize = 1 << 10;
+constexpr int64_t kMaxSize = 64 << 10;
+
+void BM_LowerReference(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  for (auto _ : state) {
+    std::string out;
+    absl::Status error;
+    CHECK(zetasql::functions::LowerUtf8(str, &out, &error));
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_LowerReference)->Range(kMinSize, kMaxSize);
+
+void BM_LowerFastPath(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(StringLower(str));
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_LowerFastPath)->Range(kMinSize, kMaxSize);
+
+void BM_UpperReference(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  for (auto _ : state) {
+    std::string out;
+    absl::Status error;
+    CHECK(zetasql::functions::UpperUtf8(str, &out, &error));
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_UpperReference)->Range(kMinSize, kMaxSize);
+
+void BM_UpperFastPath(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(StringUpper(str));
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_UpperFastPath)->Range(kMinSize, kMaxSize);
+
+void BM_StartsWithReference(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  for (auto _ : state) {
+    bool out;
+    absl::Status error;
+    CHECK(zetasql::functions::StartsWithUtf8(str, "The Quick", &out, &error));
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_StartsWithReference)->Range(kMinSize, kMaxSize);
+
+void BM_StartsWithFastPath(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(StringStartsWith(str, "The Quick"));
+  }
+}
+BENCHMARK(BM_StartsWithFastPath)->Range(kMinSize, kMaxSize);
+
+void BM_StrposReference(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  for (auto _ : state) {
+    int64_t out;
+    absl::Status error;
+    CHECK(zetasql::functions::StrposUtf8(str, "needle", &out, &error));
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_StrposReference)->Range(kMinSize, kMaxSize);
+
+void BM_StrposFastPath(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(StringPosition(str, "needle"));
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_StrposFastPath)->Range(kMinSize, kMaxSize);
+
+void BM_ReplaceWithoutMatchReference(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  for (auto _ : state) {
+    std::string out;
+    absl::Status error;
+    CHECK(zetasql::functions::ReplaceUtf8(str, "haystack", "x", &out, &error));
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_ReplaceWithoutMatchReference)->Range(kMinSize, kMaxSize);
+
+void BM_ReplaceWithoutMatchFastPath(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(StringReplace(str, "haystack", "x"));
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_ReplaceWithoutMatchFastPath)->Range(kMinSize, kMaxSize);
+
+// The reference evaluator also compiles a constant LIKE pattern once.
+void BM_LikeContainsReference(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  std::unique_ptr<RE2> regexp;
+  CHECK_OK(zetasql::functions::CreateLikeRegexp("%needle%",
+                                                zetasql::TYPE_STRING, &regexp));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(RE2::FullMatch(str, *regexp));
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_LikeContainsReference)->Range(kMinSize, kMaxSize);
+
+void BM_LikeContainsFastPath(benchmark::State& state) {
+  const std::string str = MakeString(state.range(0));
+  absl::StatusOr<LikeMatcher> matcher = LikeMatcher::Create("%needle%");
+  CHECK_OK(matcher.status());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(matcher->Matches(str));
+  }
+  state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_LikeContainsFastPath)->Range(kMinSize, kMaxSize);
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,241 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "backend/access/write.h"
+#include "backend/actions/manager.h"
+#include "backend/actions/ops.h"
+#include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/locking/manager.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/versioned_catalog.h"
+#include "backend/storage/in_memory_storage.h"
+#include "backend/transaction/commit_timestamp.h"
+#include "backend/transaction/options.h"
+#include "backend/transaction/read_write_transaction.h"
+#include "backend/transaction/transaction_store.h"
+#include "common/clock.h"
+#include "tests/common/schema_constructor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::String;
+
+// Number of rows in the referenced Parents table.
+constexpr int64_t kNumParents = 16;
+
+// Benchmarks are parameterized by {number of rows, number of columns}.
+void RowsAndColumns(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"rows", "cols"});
+  for (int64_t rows : {1, 64, 1024}) {
+    for (int64_t cols : {1, 8, 32}) {
+      b->Args({rows, cols});
+    }
+  }
+}
+
+std::vector<std::string> MakeValueColumnNames(int num_columns) {
+  std::vector<std::string> names;
+  names.reserve(num_columns);
+  for (int i = 0; i < num_columns; ++i) {
+    names.push_back(absl::StrCat("Col", i));
+  }
+  return names;
+}
+
+// Returns the DDL for a Children table with 'num_columns' STRING columns, a
+// secondary index on the first of them and a foreign key into Parents.
+std::vector<std::string> MakeSchemaDDL(int num_columns) {
+  std::vector<std::string> column_defs;
+  for (const std::string& name : MakeValueColumnNames(num_columns)) {
+    column_defs.push_back(absl::StrCat(name, " STRING(MAX)"));
+  }
+  return {
+      R"sql(
+        CREATE TABLE Parents (
+          ParentId INT64 NOT NULL,
+        ) PRIMARY KEY (ParentId)
+      )sql",
+      absl::StrCat(R"sql(
+        CREATE TABLE Children (
+          ChildId INT64 NOT NULL,
+          ParentId INT64,
+        )sql",
+                   absl::StrJoin(column_defs, ",\n"), R"sql(,
+          CONSTRAINT FK_Parent FOREIGN KEY (ParentId)
+            REFERENCES Parents (ParentId),
+        ) PRIMARY KEY (ChildId)
+      )sql"),
+      R"sql(
+        CREATE INDEX ChildrenByCol0 ON Children(Col0)
+      )sql",
+  };
+}
+
+// Owns the database components needed to run read-write transactions,
+// mirroring the setup in read_write_transaction_test.cc.
+class BenchmarkDatabase {
+ public:
+  explicit BenchmarkDatabase(int num_columns)
+      : type_factory_(std::make_unique<zetasql::TypeFactory>()),
+        lock_manager_(std::make_unique<LockManager>(&clock_)),
+        storage_(std::make_unique<InMemoryStorage>()) {
+    absl::StatusOr<std::unique_ptr<const Schema>> schema =
+        test::CreateSchemaFromDDL(MakeSchemaDDL(num_columns),
+                                  type_factory_.get());
+    ABSL_CHECK_OK(schema.status());
+    versioned_catalog_ =
+        std::make_unique<VersionedCatalog>(std::move(schema).value());
+    action_manager_ = std::make_unique<ActionManager>();
+    action_manager_->AddActionsForSchema(
+        versioned_catalog_->GetSchema(absl::InfiniteFuture()),
+        /*function_catalog=*/nullptr, type_factory_.get());
+
+    Mutation parents;
+    for (int64_t id = 0; id < kNumParents; ++id) {
+      parents.AddWriteOp(MutationOpType::kInsert, "Parents", {"ParentId"},
+                         {{Int64(id)}});
+    }
+    std::unique_ptr<ReadWriteTransaction> txn = CreateReadWriteTransaction();
+    ABSL_CHECK_OK(txn->Write(parents));
+    ABSL_CHECK_OK(txn->Commit());
+  }
+
+  std::unique_ptr<ReadWriteTransaction> CreateReadWriteTransaction() {
+    return std::make_unique<ReadWriteTransaction>(
+        ReadWriteOptions(), RetryState(), ++id_counter_, &clock_,
+        storage_.get(), lock_manager_.get(), versioned_catalog_.get(),
+        action_manager_.get());
+  }
+
+  const Schema* schema() const {
+    return versioned_catalog_->GetSchema(absl::InfiniteFuture());
+  }
+  InMemoryStorage* storage() { return storage_.get(); }
+  LockManager* lock_manager() { return lock_manager_.get(); }
+
+ private:
+  Clock clock_;
+
+  // The type factory must outlive the type objects that it has made.
+  std::unique_ptr<zetasql::TypeFactory> type_factory_;
+  std::unique_ptr<LockManager> lock_manager_;
+  std::unique_ptr<InMemoryStorage> storage_;
+  std::unique_ptr<VersionedCatalog> versioned_catalog_;
+  std::unique_ptr<ActionManager> action_manager_;
+  TransactionID id_counter_ = 0;
+};
+
+// Returns a mutation inserting 'num_rows' Children rows starting at
+// 'first_id', each row referencing an existing parent.
+Mutation MakeChildrenMutation(int64_t first_id, int64_t num_rows,
+                              int num_columns) {
+  std::vector<std::string> columns = {"ChildId", "ParentId"};
+  for (std::string& name : MakeValueColumnNames(num_columns)) {
+    columns.push_back(std::move(name));
+  }
+  std::vector<ValueList> rows;
+  rows.reserve(num_rows);
+  for (int64_t id = first_id; id < first_id + num_rows; ++id) {
+    ValueList row = {Int64(id), Int64(id % kNumParents)};
+    for (int i = 0; i < num_columns; ++i) {
+      row.push_back(String(absl::StrCat("value-", id, "-", i)));
+    }
+    rows.push_back(std::move(row));
+  }
+  Mutation mutation;
+  mutation.AddWriteOp(MutationOpType::kInsert, "Children", std::move(columns),
+                      std::move(rows));
+  return mutation;
+}
+
+void BM_TransactionStoreBufferWriteOp(benchmark::State& state) {
+  const int64_t num_rows = state.range(0);
+  const int num_columns = state.range(1);
+  BenchmarkDatabase db(num_columns);
+  const Table* table = db.schema()->FindTable("Children");
+  std::vector<const Column*> columns = {table->FindColumn("ChildId")};
+  for (const std::string& name : MakeValueColumnNames(num_columns)) {
+    columns.push_back(table->FindColumn(name));
+  }
+
+  std::vector<WriteOp> ops;
+  ops.reserve(num_rows);
+  for (int64_t id = 0; id < num_rows; ++id) {
+    ValueList values = {Int64(id)};
+    for (int i = 0; i < num_columns; ++i) {
+      values.push_back(String(absl::StrCat("value-", id, "-", i)));
+    }
+    ops.push_back(InsertOp{table, Key({Int64(id)}), columns, values});
+  }
+
+  TransactionID id = 0;
+  for (auto _ : state) {
+    std::unique_ptr<LockHandle> lock_handle = db.lock_manager()->CreateHandle(
+        ++id, /*abort_fn=*/nullptr, TransactionPriority(1));
+    CommitTimestampTracker commit_timestamp_tracker;
+    TransactionStore store(db.storage(), lock_handle.get(),
+                           &commit_timestamp_tracker);
+    for (const WriteOp& op : ops) {
+      benchmark::DoNotOptimize(store.BufferWriteOp(op));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK(BM_TransactionStoreBufferWriteOp)->Apply(RowsAndColumns);
+
+void BM_ReadWriteTransactionCommit(benchmark::State& state) {
+  const int64_t num_rows = state.range(0);
+  const int num_columns = state.range(1);
+  BenchmarkDatabase db(num_columns);
+
+  int64_t next_id = 0;
+  for (auto _ : state) {
+    // Building the mutation is not part of the commit path.
+    state.PauseTiming();
+    Mutation mutation = MakeChildrenMutation(next_id, num_rows, num_columns);
+    next_id += num_rows;
+    std::unique_ptr<ReadWriteTransaction> txn = db.CreateReadWriteTransaction();
+    state.ResumeTiming();
+
+    ABSL_CHECK_OK(txn->Write(mutation));
+    ABSL_CHECK_OK(txn->Commit());
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK(BM_ReadWriteTransactionCommit)->Apply(RowsAndColumns);
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
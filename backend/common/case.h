@@ -17,12 +17,16 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_CASE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_CASE_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
 
 namespace google {
 namespace spanner {
@@ -54,19 +58,34 @@ namespace backend {
 //       }
 //     }
 //
-// A hash function object for performing case-insensitive hash on strings.
+// Both function objects are transparent, so containers using them can be
+// looked up with an absl::string_view (or a string literal) without building a
+// std::string key.
+//
+// A hash function object for performing case-insensitive hash on strings. The
+// name is case-folded as it is hashed rather than copied and lowercased, since
+// schema objects are looked up by name on every read, mutation and query.
 struct CaseInsensitiveHash {
-  size_t operator()(const std::string& keyval) const {
-    std::string s = keyval;
-    absl::AsciiStrToLower(&s);
-    return std::hash<std::string>()(s);
+  using is_transparent = void;
+
+  size_t operator()(absl::string_view keyval) const {
+    // FNV-1a over the case-folded bytes, finalized by absl::Hash to spread the
+    // low bits used by the hash containers.
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : keyval) {
+      hash ^= static_cast<unsigned char>(absl::ascii_tolower(c));
+      hash *= 1099511628211ull;
+    }
+    return absl::Hash<uint64_t>()(hash);
   }
 };
 
 // A comparator function object for performing case-insensitive equal
 // comparison on strings.
 struct CaseInsensitiveEqual {
-  bool operator()(const std::string& left, const std::string& right) const {
+  using is_transparent = void;
+
+  bool operator()(absl::string_view left, absl::string_view right) const {
     return absl::EqualsIgnoreCase(left, right);
   }
 };
@@ -23,6 +23,7 @@
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 
 namespace google {
 namespace spanner {
@@ -44,6 +45,28 @@ TEST(CaseTest, CaseInsensitiveHashContainer) {
   EXPECT_NE(*hash_set.begin(), "MY-TEST");
 }
 
+TEST(CaseTest, CaseInsensitiveHashIgnoresCase) {
+  CaseInsensitiveHash hash;
+  EXPECT_EQ(hash("Albums"), hash("ALBUMS"));
+  EXPECT_EQ(hash("Albums"), hash(std::string("albums")));
+  EXPECT_NE(hash("Albums"), hash("Album"));
+  EXPECT_NE(hash(""), hash("a"));
+}
+
+TEST(CaseTest, CaseInsensitiveStringMapSupportsStringViewLookups) {
+  CaseInsensitiveStringMap<int> map;
+  map["Singers"] = 1;
+  map["Albums"] = 2;
+
+  constexpr absl::string_view kName = "x.SINGERS";
+  auto it = map.find(kName.substr(2));
+  ASSERT_NE(it, map.end());
+  EXPECT_EQ(it->first, "Singers");
+  EXPECT_EQ(it->second, 1);
+  EXPECT_TRUE(map.contains(absl::string_view("albums")));
+  EXPECT_FALSE(map.contains(absl::string_view("Songs")));
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
@@ -17,6 +17,7 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_IDS_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_IDS_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -50,6 +51,19 @@ class UniqueIdGenerator {
     return IdType{next_seq_++};
   }
 
+  // Returns the sequence number of the next generated ID.
+  int64_t next_seq() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    return next_seq_;
+  }
+
+  // Makes the IDs generated from now on start at sequence number `seq`, unless
+  // that number has already been used.
+  void AdvanceTo(int64_t seq) ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    next_seq_ = std::max(next_seq_, seq);
+  }
+
  private:
   absl::Mutex mu_;
   int64_t next_seq_ ABSL_GUARDED_BY(mu_);
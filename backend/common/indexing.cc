@@ -79,7 +79,7 @@ bool ShouldFilterIndexKeyOrValue(const Index* index, const Key& key,
   } else {
     // Check for null filtered columns.
     for (const Column* column : index->null_filtered_columns()) {
-      if (GetColumnValueOrNull(base_row, column->source_column()).is_null()) {
+      if (base_row.IsNullOrUnset(column->source_column())) {
         return true;
       }
     }
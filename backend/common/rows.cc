@@ -29,15 +29,15 @@ namespace backend {
 
 zetasql::Value GetColumnValueOrNull(const Row& row,
                                       const Column* const column) {
-  const auto entry = row.find(column);
-  return (entry != row.end()) ? entry->second
-                              : zetasql::Value::Null(column->GetType());
+  const zetasql::Value* value = row.Find(column);
+  return value != nullptr ? *value : zetasql::Value::Null(column->GetType());
 }
 
-Row MakeRow(absl::Span<const Column* const> columns, const ValueList& values) {
-  Row row;
+Row MakeRow(const Table* table, absl::Span<const Column* const> columns,
+            const ValueList& values) {
+  Row row(table);
   for (int i = 0; i < columns.size(); ++i) {
-    row.insert({columns[i], values[i]});
+    row.Set(columns[i], values[i]);
   }
   return row;
 }
@@ -63,6 +63,31 @@ absl::StatusOr<std::vector<const Column*>> GetColumnsByName(
   return columns;
 }
 
+bool AreResolvedColumns(const Table* table,
+                        const std::vector<std::string>& column_names,
+                        absl::Span<const Column* const> resolved_columns) {
+  if (resolved_columns.size() != column_names.size()) {
+    return false;
+  }
+  for (int i = 0; i < resolved_columns.size(); ++i) {
+    if (resolved_columns[i]->table() != table ||
+        resolved_columns[i]->Name() != column_names[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::StatusOr<std::vector<const Column*>> GetColumnsByName(
+    const Table* table, const std::vector<std::string>& column_names,
+    absl::Span<const Column* const> resolved_columns) {
+  if (AreResolvedColumns(table, column_names, resolved_columns)) {
+    return std::vector<const Column*>(resolved_columns.begin(),
+                                      resolved_columns.end());
+  }
+  return GetColumnsByName(table, column_names);
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
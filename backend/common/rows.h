@@ -17,7 +17,14 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_ROWS_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_ROWS_H_
 
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "backend/datamodel/value.h"
 #include "backend/schema/catalog/column.h"
 #include "backend/schema/catalog/table.h"
@@ -28,15 +35,90 @@ namespace emulator {
 namespace backend {
 
 // Common row abstraction used by various parts of the backend.
-using Row = absl::flat_hash_map<const Column* const, zetasql::Value>;
+//
+// A Row holds values for a subset of the columns of a single table. Values are
+// stored densely by column ordinal (see Column::ordinal) next to a presence
+// bitmap, so setting and probing a column is an index into the row rather than
+// a hash map lookup, and a row allocates once however many columns it holds. A
+// second bitmap records which set values are NULL, so that NULL checks (e.g.
+// for NULL_FILTERED indexes) are a bit test rather than a value copy.
+class Row {
+ public:
+  Row() = default;
+  explicit Row(const Table* table)
+      : table_(table),
+        values_(table->columns().size()),
+        present_(table->columns().size()),
+        null_(table->columns().size()) {}
+
+  // The table whose columns this row holds values for.
+  const Table* table() const { return table_; }
+
+  // Sets the value of `column`, which must be a column of table().
+  void Set(const Column* column, zetasql::Value value) {
+    ABSL_DCHECK_EQ(column->table(), table_);
+    const int ordinal = column->ordinal();
+    if (!present_[ordinal]) {
+      present_[ordinal] = true;
+      ++size_;
+    }
+    null_[ordinal] = value.is_null();
+    values_[ordinal] = std::move(value);
+  }
+
+  // Returns the value of `column`, or nullptr if it is not set.
+  const zetasql::Value* Find(const Column* column) const {
+    ABSL_DCHECK_EQ(column->table(), table_);
+    const int ordinal = column->ordinal();
+    return present_[ordinal] ? &values_[ordinal] : nullptr;
+  }
+
+  // Returns true if `column` is not set or is set to NULL, i.e. if
+  // GetColumnValueOrNull(*this, column) is NULL.
+  bool IsNullOrUnset(const Column* column) const {
+    ABSL_DCHECK_EQ(column->table(), table_);
+    const int ordinal = column->ordinal();
+    return !present_[ordinal] || null_[ordinal];
+  }
+
+  // Returns true if no column is set.
+  bool empty() const { return size_ == 0; }
+
+  // Returns the number of columns set.
+  int size() const { return size_; }
+
+  // Calls fn(column, value) for each set column, in column order. `value` is
+  // a const reference, or an rvalue reference if the row is an rvalue so that
+  // the values can be moved out.
+  template <typename Fn>
+  void ForEach(Fn fn) const& {
+    for (int i = 0; i < values_.size(); ++i) {
+      if (present_[i]) fn(table_->columns()[i], values_[i]);
+    }
+  }
+  template <typename Fn>
+  void ForEach(Fn fn) && {
+    for (int i = 0; i < values_.size(); ++i) {
+      if (present_[i]) fn(table_->columns()[i], std::move(values_[i]));
+    }
+  }
+
+ private:
+  const Table* table_ = nullptr;
+  std::vector<zetasql::Value> values_;
+  std::vector<bool> present_;
+  std::vector<bool> null_;
+  int size_ = 0;
+};
 
 // Returns the value from the given Row for the specified column. Returns Null
 // if the specified column was not found.
 zetasql::Value GetColumnValueOrNull(const Row& row,
                                       const Column* const column);
 
-// Returns the column/value map for the given column & value list.
-Row MakeRow(absl::Span<const Column* const> columns, const ValueList& values);
+// Returns the row of `table` holding the given column & value list.
+Row MakeRow(const Table* table, absl::Span<const Column* const> columns,
+            const ValueList& values);
 
 // Returns a list of ColumnIDs from the given set of columns.
 std::vector<ColumnID> GetColumnIDs(absl::Span<const Column* const> columns);
@@ -45,6 +127,21 @@ std::vector<ColumnID> GetColumnIDs(absl::Span<const Column* const> columns);
 absl::StatusOr<std::vector<const Column*>> GetColumnsByName(
     const Table* table, const std::vector<std::string>& column_names);
 
+// Same as above, except that `resolved_columns` are returned without looking
+// `column_names` up when they are the columns of `table` with those names, as
+// is the case for the columns resolved by the producer of a ReadArg or
+// MutationOp against the same schema. Otherwise, e.g. if the schema changed
+// since, the names are looked up.
+absl::StatusOr<std::vector<const Column*>> GetColumnsByName(
+    const Table* table, const std::vector<std::string>& column_names,
+    absl::Span<const Column* const> resolved_columns);
+
+// Returns true if `resolved_columns` are the columns of `table` named
+// `column_names`.
+bool AreResolvedColumns(const Table* table,
+                        const std::vector<std::string>& column_names,
+                        absl::Span<const Column* const> resolved_columns);
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -16,10 +16,19 @@
 
 #include "backend/common/rows.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/types/type_factory.h"
+#include "zetasql/public/value.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "backend/schema/catalog/schema.h"
+#include "tests/common/schema_constructor.h"
 
 namespace google {
 namespace spanner {
@@ -27,7 +36,104 @@ namespace emulator {
 namespace backend {
 namespace {
 
-// TODO: Add tests for row_util functions.
+using ::testing::ElementsAre;
+using ::zetasql_base::testing::IsOkAndHolds;
+using ::zetasql_base::testing::StatusIs;
+
+class RowTest : public testing::Test {
+ protected:
+  zetasql::TypeFactory type_factory_;
+  std::unique_ptr<const Schema> schema_ =
+      test::CreateSchemaWithOneTable(&type_factory_);
+  const Table* table_ = schema_->FindTable("test_table");
+  const Column* int64_col_ = table_->FindColumn("int64_col");
+  const Column* string_col_ = table_->FindColumn("string_col");
+};
+
+TEST_F(RowTest, HoldsValuesOfSetColumns) {
+  Row row(table_);
+  EXPECT_TRUE(row.empty());
+  EXPECT_EQ(row.Find(string_col_), nullptr);
+  EXPECT_EQ(GetColumnValueOrNull(row, string_col_),
+            zetasql::values::NullString());
+
+  row.Set(string_col_, zetasql::values::String("a"));
+  row.Set(string_col_, zetasql::values::String("b"));
+  EXPECT_EQ(row.size(), 1);
+  ASSERT_NE(row.Find(string_col_), nullptr);
+  EXPECT_EQ(*row.Find(string_col_), zetasql::values::String("b"));
+  EXPECT_EQ(row.Find(int64_col_), nullptr);
+}
+
+TEST_F(RowTest, TracksNullColumns) {
+  Row row(table_);
+  EXPECT_TRUE(row.IsNullOrUnset(string_col_));
+
+  row.Set(string_col_, zetasql::values::String("a"));
+  EXPECT_FALSE(row.IsNullOrUnset(string_col_));
+  EXPECT_TRUE(row.IsNullOrUnset(int64_col_));
+
+  row.Set(string_col_, zetasql::values::NullString());
+  EXPECT_TRUE(row.IsNullOrUnset(string_col_));
+  row.Set(string_col_, zetasql::values::String("b"));
+  EXPECT_FALSE(row.IsNullOrUnset(string_col_));
+}
+
+TEST_F(RowTest, VisitsSetColumnsInColumnOrder) {
+  Row row = MakeRow(table_, {string_col_, int64_col_},
+                    {zetasql::values::String("a"), zetasql::values::Int64(1)});
+  std::vector<const Column*> columns;
+  std::vector<zetasql::Value> values;
+  std::move(row).ForEach([&](const Column* column, zetasql::Value&& value) {
+    columns.push_back(column);
+    values.push_back(std::move(value));
+  });
+  EXPECT_THAT(columns, ElementsAre(int64_col_, string_col_));
+  EXPECT_THAT(values, ElementsAre(zetasql::values::Int64(1),
+                                  zetasql::values::String("a")));
+}
+
+class GetColumnsByNameTest : public testing::Test {
+ protected:
+  zetasql::TypeFactory type_factory_;
+  std::unique_ptr<const Schema> schema_ =
+      test::CreateSchemaWithOneTable(&type_factory_);
+  const Table* table_ = schema_->FindTable("test_table");
+  const Column* int64_col_ = table_->FindColumn("int64_col");
+  const Column* string_col_ = table_->FindColumn("string_col");
+};
+
+TEST_F(GetColumnsByNameTest, LooksUpColumnsCaseInsensitively) {
+  EXPECT_THAT(GetColumnsByName(table_, {"STRING_COL", "int64_col"}),
+              IsOkAndHolds(ElementsAre(string_col_, int64_col_)));
+  EXPECT_THAT(GetColumnsByName(table_, {"no_such_col"}),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(GetColumnsByNameTest, UsesResolvedColumnsOfTheTable) {
+  std::vector<std::string> names = {"string_col", "int64_col"};
+  std::vector<const Column*> resolved = {string_col_, int64_col_};
+  EXPECT_TRUE(AreResolvedColumns(table_, names, resolved));
+  EXPECT_THAT(GetColumnsByName(table_, names, resolved),
+              IsOkAndHolds(ElementsAre(string_col_, int64_col_)));
+}
+
+TEST_F(GetColumnsByNameTest, LooksUpStaleResolvedColumnsAgain) {
+  std::vector<std::string> names = {"string_col", "int64_col"};
+
+  // Columns which do not match the names, or which are columns of another
+  // table, are not used.
+  EXPECT_FALSE(AreResolvedColumns(table_, names, {int64_col_, string_col_}));
+  EXPECT_FALSE(AreResolvedColumns(table_, names, {string_col_}));
+  const Table* index_table =
+      schema_->FindIndex("test_index")->index_data_table();
+  std::vector<const Column*> index_columns = {
+      index_table->FindColumn("string_col"),
+      index_table->FindColumn("int64_col")};
+  EXPECT_FALSE(AreResolvedColumns(table_, names, index_columns));
+  EXPECT_THAT(GetColumnsByName(table_, names, index_columns),
+              IsOkAndHolds(ElementsAre(string_col_, int64_col_)));
+}
 
 }  // namespace
 }  // namespace backend
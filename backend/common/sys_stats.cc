@@ -0,0 +1,126 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/common/sys_stats.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "backend/common/ids.h"
+#include "farmhash.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+void QueryStats::RecordExecution(absl::string_view sql,
+                                 const absl::Status& status,
+                                 absl::Duration latency, int64_t rows,
+                                 int64_t rows_written,
+                                 bool in_read_write_transaction,
+                                 absl::Time now) {
+  const int64_t fingerprint =
+      static_cast<int64_t>(farmhash::Fingerprint64(sql));
+  stats_.Update(now, fingerprint, [&](QueryStatsEntry* entry, bool inserted) {
+    if (inserted) {
+      entry->text = std::string(sql.substr(0, kMaxQueryStatsTextLength));
+      entry->text_truncated = sql.size() > kMaxQueryStatsTextLength;
+      entry->text_fingerprint = fingerprint;
+    }
+    ++entry->execution_count;
+    if (in_read_write_transaction) {
+      ++entry->run_in_rw_transaction_count;
+    }
+    if (status.ok()) {
+      entry->total_latency += latency;
+      entry->total_rows += rows;
+      entry->total_rows_written += rows_written;
+      return;
+    }
+    ++entry->failed_count;
+    entry->total_failed_latency += latency;
+    if (status.code() == absl::StatusCode::kCancelled) {
+      ++entry->cancelled_count;
+    } else if (status.code() == absl::StatusCode::kDeadlineExceeded) {
+      ++entry->timed_out_count;
+    }
+  });
+}
+
+int64_t TransactionShape::Fingerprint() const {
+  return static_cast<int64_t>(farmhash::Fingerprint64(absl::StrCat(
+      absl::StrJoin(read_columns, ","), ";",
+      absl::StrJoin(write_constructive_columns, ","), ";",
+      absl::StrJoin(write_delete_tables, ","))));
+}
+
+void TransactionStats::RecordCommit(const TransactionShape& shape,
+                                    const absl::Status& status,
+                                    absl::Duration total_latency,
+                                    absl::Duration commit_latency,
+                                    absl::Time now) {
+  const int64_t fprint = shape.Fingerprint();
+  stats_.Update(now, fprint, [&](TransactionStatsEntry* entry, bool inserted) {
+    if (inserted) {
+      entry->fprint = fprint;
+      entry->read_columns.assign(shape.read_columns.begin(),
+                                 shape.read_columns.end());
+      entry->write_constructive_columns.assign(
+          shape.write_constructive_columns.begin(),
+          shape.write_constructive_columns.end());
+      entry->write_delete_tables.assign(shape.write_delete_tables.begin(),
+                                        shape.write_delete_tables.end());
+    }
+    ++entry->commit_attempt_count;
+    if (status.ok()) {
+      ++entry->commit_count;
+      entry->total_latency += total_latency;
+      entry->total_commit_latency += commit_latency;
+    } else if (status.code() == absl::StatusCode::kAborted) {
+      ++entry->commit_abort_count;
+    } else if (status.code() == absl::StatusCode::kFailedPrecondition) {
+      ++entry->commit_failed_precondition_count;
+    }
+  });
+}
+
+void LockStats::RecordConflict(const TableID& table_id,
+                               absl::string_view start_key,
+                               absl::Duration lock_wait, absl::Time now) {
+  stats_.Update(
+      now, std::make_pair(table_id, std::string(start_key)),
+      [&](LockStatsEntry* entry, bool inserted) {
+        if (inserted) {
+          entry->table_id = table_id;
+          entry->row_range_start_key = std::string(start_key);
+        }
+        ++entry->conflict_count;
+        entry->total_lock_wait += lock_wait;
+      });
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
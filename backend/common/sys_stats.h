@@ -0,0 +1,280 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_SYS_STATS_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_SYS_STATS_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "backend/common/ids.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Length of the intervals over which the statistics of a database's
+// operations are aggregated, as in the SPANNER_SYS.*_TOP_MINUTE tables.
+constexpr absl::Duration kStatsIntervalLength = absl::Minutes(1);
+
+// Number of the most recent intervals for which statistics are kept.
+constexpr int kMaxStatsIntervals = 60;
+
+// Maximum number of distinct statements, transaction shapes or keys tracked in
+// a single interval. Operations on others are not recorded in the interval.
+constexpr int kMaxStatsEntriesPerInterval = 100;
+
+// Maximum length of the statement text kept in query statistics.
+constexpr int kMaxQueryStatsTextLength = 64 * 1024;
+
+// An entry of the statistics of the interval which ends at `interval_end`.
+template <typename Entry>
+struct IntervalEntry {
+  absl::Time interval_end;
+  Entry entry;
+};
+
+// IntervalStats aggregates the statistics of operations into entries keyed by
+// `Key` for each interval of kStatsIntervalLength.
+//
+// Recording an operation takes a single short critical section, so that the
+// statistics can be collected on the hot paths of the database. Entries are
+// reported for the last kMaxStatsIntervals intervals, including the one in
+// progress.
+//
+// This class is thread-safe.
+template <typename Key, typename Entry>
+class IntervalStats {
+ public:
+  // Calls `update(Entry* entry, bool inserted)` on the entry of `key` in the
+  // interval containing `now`. `inserted` is true if the entry was just
+  // default-constructed. Does nothing if the interval already tracks
+  // kMaxStatsEntriesPerInterval other keys.
+  template <typename UpdateFn>
+  void Update(absl::Time now, const Key& key, UpdateFn update)
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    absl::flat_hash_map<Key, Entry>& entries = IntervalEntries(now);
+    auto itr = entries.find(key);
+    bool inserted = false;
+    if (itr == entries.end()) {
+      if (entries.size() >= kMaxStatsEntriesPerInterval) {
+        return;
+      }
+      itr = entries.try_emplace(key).first;
+      inserted = true;
+    }
+    update(&itr->second, inserted);
+  }
+
+  // Returns the entries of all the kept intervals, oldest interval first.
+  std::vector<IntervalEntry<Entry>> Entries() const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    std::vector<IntervalEntry<Entry>> entries;
+    for (const Interval& interval : intervals_) {
+      for (const auto& [key, entry] : interval.entries) {
+        entries.push_back({interval.end, entry});
+      }
+    }
+    return entries;
+  }
+
+ private:
+  struct Interval {
+    absl::Time end;
+    absl::flat_hash_map<Key, Entry> entries;
+  };
+
+  // Returns the entries of the interval containing `now`, starting a new
+  // interval if needed. Operations recorded with a time before the latest
+  // interval (e.g. taken before a concurrent operation started it) are
+  // aggregated into the latest interval.
+  absl::flat_hash_map<Key, Entry>& IntervalEntries(absl::Time now)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    absl::Time end =
+        absl::UnixEpoch() +
+        absl::Floor(now - absl::UnixEpoch(), kStatsIntervalLength) +
+        kStatsIntervalLength;
+    if (intervals_.empty() || intervals_.back().end < end) {
+      intervals_.push_back({end, {}});
+      if (intervals_.size() > kMaxStatsIntervals) {
+        intervals_.pop_front();
+      }
+    }
+    return intervals_.back().entries;
+  }
+
+  mutable absl::Mutex mu_;
+  std::deque<Interval> intervals_ ABSL_GUARDED_BY(mu_);
+};
+
+// Statistics of the executions of a single SQL statement.
+struct QueryStatsEntry {
+  // The text of the statement, truncated to kMaxQueryStatsTextLength.
+  std::string text;
+  bool text_truncated = false;
+
+  // The fingerprint of the full text of the statement.
+  int64_t text_fingerprint = 0;
+
+  // All executions, including the failed ones.
+  int64_t execution_count = 0;
+  int64_t run_in_rw_transaction_count = 0;
+
+  // Latency of the successful executions, and the rows they returned and
+  // wrote.
+  absl::Duration total_latency;
+  int64_t total_rows = 0;
+  int64_t total_rows_written = 0;
+
+  // Failed executions.
+  int64_t failed_count = 0;
+  int64_t cancelled_count = 0;
+  int64_t timed_out_count = 0;
+  absl::Duration total_failed_latency;
+};
+
+// Statistics of the SQL statements executed against a database, reported in
+// SPANNER_SYS.QUERY_STATS_TOP_MINUTE.
+class QueryStats {
+ public:
+  // Records an execution of `sql` which completed at `now` with `status`
+  // after `latency`, returning `rows` rows and writing `rows_written` rows.
+  void RecordExecution(absl::string_view sql, const absl::Status& status,
+                       absl::Duration latency, int64_t rows,
+                       int64_t rows_written, bool in_read_write_transaction,
+                       absl::Time now = absl::Now());
+
+  std::vector<IntervalEntry<QueryStatsEntry>> Entries() const {
+    return stats_.Entries();
+  }
+
+ private:
+  // Entries are keyed by the fingerprint of the statement text.
+  IntervalStats<int64_t, QueryStatsEntry> stats_;
+};
+
+// The columns read and written by a read-write transaction, which identify
+// transactions of the same shape in SPANNER_SYS.TXN_STATS_TOP_MINUTE. Columns
+// are named `table.column`.
+struct TransactionShape {
+  absl::btree_set<std::string> read_columns;
+  absl::btree_set<std::string> write_constructive_columns;
+  absl::btree_set<std::string> write_delete_tables;
+
+  // Returns a fingerprint of the shape, which is stable across processes.
+  int64_t Fingerprint() const;
+
+  void Clear() {
+    read_columns.clear();
+    write_constructive_columns.clear();
+    write_delete_tables.clear();
+  }
+};
+
+// Statistics of the commits of read-write transactions of a single shape.
+struct TransactionStatsEntry {
+  int64_t fprint = 0;
+  std::vector<std::string> read_columns;
+  std::vector<std::string> write_constructive_columns;
+  std::vector<std::string> write_delete_tables;
+
+  // All commit attempts, including the aborted and failed ones.
+  int64_t commit_attempt_count = 0;
+  int64_t commit_count = 0;
+  int64_t commit_abort_count = 0;
+  int64_t commit_failed_precondition_count = 0;
+
+  // Latency of the successful commits, from the first operation of the
+  // transaction attempt and from the commit request.
+  absl::Duration total_latency;
+  absl::Duration total_commit_latency;
+};
+
+// Statistics of the read-write transactions of a database, reported in
+// SPANNER_SYS.TXN_STATS_TOP_MINUTE.
+class TransactionStats {
+ public:
+  // Records a commit of a transaction of `shape` which completed at `now`
+  // with `status`. `total_latency` is measured from the first operation of the
+  // transaction attempt and `commit_latency` from the commit request.
+  void RecordCommit(const TransactionShape& shape, const absl::Status& status,
+                    absl::Duration total_latency, absl::Duration commit_latency,
+                    absl::Time now = absl::Now());
+
+  std::vector<IntervalEntry<TransactionStatsEntry>> Entries() const {
+    return stats_.Entries();
+  }
+
+ private:
+  // Entries are keyed by the fingerprint of the transaction shape.
+  IntervalStats<int64_t, TransactionStatsEntry> stats_;
+};
+
+// Statistics of the lock conflicts on a single row range.
+struct LockStatsEntry {
+  TableID table_id;
+
+  // The debug string of the first key of the contested range.
+  std::string row_range_start_key;
+
+  int64_t conflict_count = 0;
+
+  // The sum, over the conflicts, of the time for which the conflicting locks
+  // had been held when they were contested.
+  absl::Duration total_lock_wait;
+};
+
+// Statistics of the lock conflicts of the transactions of a database,
+// reported in SPANNER_SYS.LOCK_STATS_TOP_MINUTE.
+//
+// The emulator never waits for conflicting locks: the requester either wounds
+// the holders or is aborted (see LockManager). The time a conflicting lock had
+// been held is reported as lock wait, as it bounds from below how long the
+// requester would have waited for it.
+class LockStats {
+ public:
+  // Records a conflict at `now` on the range of `table_id` which starts at
+  // `start_key`, with a lock that had been held for `lock_wait`.
+  void RecordConflict(const TableID& table_id, absl::string_view start_key,
+                      absl::Duration lock_wait, absl::Time now = absl::Now());
+
+  std::vector<IntervalEntry<LockStatsEntry>> Entries() const {
+    return stats_.Entries();
+  }
+
+ private:
+  IntervalStats<std::pair<TableID, std::string>, LockStatsEntry> stats_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_SYS_STATS_H_
@@ -0,0 +1,194 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/common/sys_stats.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "tests/common/proto_matchers.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+// A time at the start of an interval.
+const absl::Time kIntervalStart = absl::FromUnixSeconds(1700000040);
+
+TEST(QueryStatsTest, AggregatesExecutionsOfTheSameStatement) {
+  QueryStats stats;
+  stats.RecordExecution("SELECT 1", absl::OkStatus(), absl::Seconds(1),
+                        /*rows=*/1, /*rows_written=*/0,
+                        /*in_read_write_transaction=*/false, kIntervalStart);
+  stats.RecordExecution("SELECT 1", absl::OkStatus(), absl::Seconds(3),
+                        /*rows=*/1, /*rows_written=*/0,
+                        /*in_read_write_transaction=*/true,
+                        kIntervalStart + absl::Seconds(59));
+  stats.RecordExecution("SELECT 1", absl::DeadlineExceededError("timeout"),
+                        absl::Seconds(5), /*rows=*/0, /*rows_written=*/0,
+                        /*in_read_write_transaction=*/false,
+                        kIntervalStart + absl::Seconds(30));
+
+  std::vector<IntervalEntry<QueryStatsEntry>> entries = stats.Entries();
+  ASSERT_THAT(entries, SizeIs(1));
+  EXPECT_EQ(entries[0].interval_end, kIntervalStart + absl::Minutes(1));
+  const QueryStatsEntry& entry = entries[0].entry;
+  EXPECT_EQ(entry.text, "SELECT 1");
+  EXPECT_FALSE(entry.text_truncated);
+  EXPECT_EQ(entry.execution_count, 3);
+  EXPECT_EQ(entry.run_in_rw_transaction_count, 1);
+  EXPECT_EQ(entry.total_latency, absl::Seconds(4));
+  EXPECT_EQ(entry.total_rows, 2);
+  EXPECT_EQ(entry.failed_count, 1);
+  EXPECT_EQ(entry.timed_out_count, 1);
+  EXPECT_EQ(entry.cancelled_count, 0);
+  EXPECT_EQ(entry.total_failed_latency, absl::Seconds(5));
+}
+
+TEST(QueryStatsTest, SeparatesIntervalsAndStatements) {
+  QueryStats stats;
+  stats.RecordExecution("SELECT 1", absl::OkStatus(), absl::Seconds(1), 1, 0,
+                        false, kIntervalStart);
+  stats.RecordExecution("SELECT 2", absl::OkStatus(), absl::Seconds(1), 1, 0,
+                        false, kIntervalStart);
+  stats.RecordExecution("SELECT 1", absl::OkStatus(), absl::Seconds(1), 1, 0,
+                        false, kIntervalStart + absl::Minutes(1));
+
+  std::vector<IntervalEntry<QueryStatsEntry>> entries = stats.Entries();
+  ASSERT_THAT(entries, SizeIs(3));
+  EXPECT_EQ(entries[2].interval_end, kIntervalStart + absl::Minutes(2));
+  EXPECT_EQ(entries[2].entry.text, "SELECT 1");
+  EXPECT_NE(entries[0].entry.text_fingerprint,
+            entries[1].entry.text_fingerprint);
+}
+
+TEST(QueryStatsTest, TruncatesLongStatements) {
+  QueryStats stats;
+  std::string sql = "SELECT '" + std::string(kMaxQueryStatsTextLength, 'a');
+  stats.RecordExecution(sql, absl::OkStatus(), absl::Seconds(1), 1, 0, false,
+                        kIntervalStart);
+
+  std::vector<IntervalEntry<QueryStatsEntry>> entries = stats.Entries();
+  ASSERT_THAT(entries, SizeIs(1));
+  EXPECT_EQ(entries[0].entry.text.size(), kMaxQueryStatsTextLength);
+  EXPECT_TRUE(entries[0].entry.text_truncated);
+}
+
+TEST(QueryStatsTest, BoundsTheStatementsAndIntervalsKept) {
+  QueryStats stats;
+  for (int i = 0; i <= kMaxStatsEntriesPerInterval; ++i) {
+    stats.RecordExecution(absl::StrCat("SELECT ", i), absl::OkStatus(),
+                          absl::Seconds(1), 1, 0, false, kIntervalStart);
+  }
+  EXPECT_THAT(stats.Entries(), SizeIs(kMaxStatsEntriesPerInterval));
+
+  for (int i = 1; i <= kMaxStatsIntervals; ++i) {
+    stats.RecordExecution("SELECT 1", absl::OkStatus(), absl::Seconds(1), 1, 0,
+                          false, kIntervalStart + i * kStatsIntervalLength);
+  }
+  std::vector<IntervalEntry<QueryStatsEntry>> entries = stats.Entries();
+  ASSERT_THAT(entries, SizeIs(kMaxStatsIntervals));
+  EXPECT_EQ(entries.front().interval_end,
+            kIntervalStart + 2 * kStatsIntervalLength);
+}
+
+TEST(TransactionStatsTest, AggregatesCommitsOfTheSameShape) {
+  TransactionShape shape;
+  shape.read_columns = {"Users.Name"};
+  shape.write_constructive_columns = {"Users.Age", "Users.Name"};
+
+  TransactionStats stats;
+  stats.RecordCommit(shape, absl::OkStatus(), absl::Seconds(2),
+                     absl::Seconds(1), kIntervalStart);
+  stats.RecordCommit(shape, absl::AbortedError("aborted"), absl::Seconds(2),
+                     absl::Seconds(1), kIntervalStart);
+  TransactionShape other_shape;
+  other_shape.write_delete_tables = {"Users"};
+  stats.RecordCommit(other_shape, absl::FailedPreconditionError("failed"),
+                     absl::Seconds(2), absl::Seconds(1), kIntervalStart);
+
+  std::vector<IntervalEntry<TransactionStatsEntry>> entries = stats.Entries();
+  ASSERT_THAT(entries, SizeIs(2));
+  const TransactionStatsEntry& entry =
+      entries[0].entry.fprint == shape.Fingerprint() ? entries[0].entry
+                                                     : entries[1].entry;
+  EXPECT_THAT(entry.read_columns, ElementsAre("Users.Name"));
+  EXPECT_THAT(entry.write_constructive_columns,
+              ElementsAre("Users.Age", "Users.Name"));
+  EXPECT_THAT(entry.write_delete_tables, IsEmpty());
+  EXPECT_EQ(entry.commit_attempt_count, 2);
+  EXPECT_EQ(entry.commit_count, 1);
+  EXPECT_EQ(entry.commit_abort_count, 1);
+  EXPECT_EQ(entry.total_latency, absl::Seconds(2));
+  EXPECT_EQ(entry.total_commit_latency, absl::Seconds(1));
+
+  const TransactionStatsEntry& other_entry =
+      entries[0].entry.fprint == shape.Fingerprint() ? entries[1].entry
+                                                     : entries[0].entry;
+  EXPECT_EQ(other_entry.commit_failed_precondition_count, 1);
+  EXPECT_EQ(other_entry.commit_count, 0);
+}
+
+TEST(TransactionStatsTest, FingerprintsDependOnAllColumns) {
+  TransactionShape read;
+  read.read_columns = {"Users.Name"};
+  TransactionShape write;
+  write.write_constructive_columns = {"Users.Name"};
+  TransactionShape empty;
+  EXPECT_NE(read.Fingerprint(), write.Fingerprint());
+  EXPECT_NE(read.Fingerprint(), empty.Fingerprint());
+  read.Clear();
+  EXPECT_EQ(read.Fingerprint(), empty.Fingerprint());
+}
+
+TEST(LockStatsTest, AggregatesConflictsOnTheSameKey) {
+  LockStats stats;
+  stats.RecordConflict("Users:1", "{Int64(1)}", absl::Seconds(1),
+                       kIntervalStart);
+  stats.RecordConflict("Users:1", "{Int64(1)}", absl::Seconds(2),
+                       kIntervalStart);
+  stats.RecordConflict("Users:1", "{Int64(2)}", absl::Seconds(4),
+                       kIntervalStart);
+
+  std::vector<IntervalEntry<LockStatsEntry>> entries = stats.Entries();
+  ASSERT_THAT(entries, SizeIs(2));
+  const LockStatsEntry& entry =
+      entries[0].entry.row_range_start_key == "{Int64(1)}" ? entries[0].entry
+                                                           : entries[1].entry;
+  EXPECT_EQ(entry.table_id, "Users:1");
+  EXPECT_EQ(entry.conflict_count, 2);
+  EXPECT_EQ(entry.total_lock_wait, absl::Seconds(3));
+}
+
+}  // namespace
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
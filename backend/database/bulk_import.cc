@@ -0,0 +1,248 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/bulk_import.h"
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "backend/common/rows.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/schema/backfills/column_value_backfill.h"
+#include "backend/schema/backfills/index_backfill.h"
+#include "backend/schema/catalog/check_constraint.h"
+#include "backend/schema/catalog/foreign_key.h"
+#include "backend/schema/catalog/index.h"
+#include "backend/schema/updater/parallel_scan.h"
+#include "backend/schema/verifiers/check_constraint_verifiers.h"
+#include "backend/schema/verifiers/column_value_verifiers.h"
+#include "backend/schema/verifiers/foreign_key_verifiers.h"
+#include "backend/storage/in_memory_iterator.h"
+#include "backend/storage/iterator.h"
+#include "backend/storage/storage.h"
+#include "backend/transaction/resolve.h"
+#include "common/errors.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Validates the columns of `import` against the schema.
+absl::Status ValidateColumns(const TableImport& import) {
+  absl::flat_hash_set<const Column*> columns;
+  for (const Column* column : import.columns) {
+    if (column->table() != import.table) {
+      return error::ColumnNotFound(import.table->Name(), column->Name());
+    }
+    if (column->is_generated()) {
+      return error::CannotWriteToGeneratedColumn(import.table->Name(),
+                                                 column->Name());
+    }
+    if (!columns.insert(column).second) {
+      return error::MultipleValuesForColumn(column->Name());
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status VerifyTableIsEmpty(const Table* table,
+                                const SchemaValidationContext* context) {
+  std::unique_ptr<StorageIterator> itr;
+  ZETASQL_RETURN_IF_ERROR(context->storage()->Read(
+      context->pending_commit_timestamp(), table->id(), KeyRange::All(), {},
+      &itr));
+  if (itr->Next()) {
+    return error::BulkImportTableNotEmpty(table->Name());
+  }
+  return itr->Status();
+}
+
+// Sorts the rows of `import` by primary key and loads them into storage.
+absl::Status LoadTable(TableImport* import,
+                       const SchemaValidationContext* context) {
+  const Table* table = import->table;
+  ZETASQL_RETURN_IF_ERROR(VerifyTableIsEmpty(table, context));
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::vector<std::optional<int>> key_indices,
+      ExtractPrimaryKeyIndices(import->columns, table->primary_key()));
+
+  std::vector<FixedRowStorageIterator::Row> rows;
+  rows.reserve(import->rows.size());
+  for (ValueList& values : import->rows) {
+    if (values.size() != import->columns.size()) {
+      return error::MutationColumnAndValueSizeMismatch(import->columns.size(),
+                                                       values.size());
+    }
+    for (int i = 0; i < values.size(); ++i) {
+      const zetasql::Type* column_type = import->columns[i]->GetType();
+      if (!values[i].is_valid() || !values[i].type()->Equals(column_type)) {
+        return error::ColumnValueTypeMismatch(
+            table->Name(), column_type->DebugString(),
+            values[i].is_valid() ? values[i].type()->DebugString()
+                                 : "<invalid>");
+      }
+    }
+    Key key = ComputeKey(values, table->primary_key(), key_indices);
+    rows.emplace_back(std::move(key), std::move(values));
+  }
+  import->rows.clear();
+  import->rows.shrink_to_fit();
+
+  std::sort(rows.begin(), rows.end(),
+            [](const FixedRowStorageIterator::Row& lhs,
+               const FixedRowStorageIterator::Row& rhs) {
+              return lhs.first < rhs.first;
+            });
+  auto duplicate = std::adjacent_find(
+      rows.begin(), rows.end(),
+      [](const FixedRowStorageIterator::Row& lhs,
+         const FixedRowStorageIterator::Row& rhs) {
+        return lhs.first == rhs.first;
+      });
+  if (duplicate != rows.end()) {
+    return error::RowAlreadyExists(table->Name(),
+                                   duplicate->first.DebugString());
+  }
+
+  FixedRowStorageIterator rows_itr(std::move(rows));
+  return context->storage()->LoadSorted(context->pending_commit_timestamp(),
+                                        table->id(),
+                                        GetColumnIDs(import->columns),
+                                        &rows_itr);
+}
+
+// Verifies that every row of the interleaved `table` has a parent row, by
+// scanning the table and its parent in lockstep.
+absl::Status VerifyParentRowsExist(const Table* table,
+                                   const SchemaValidationContext* context) {
+  const Table* parent = table->parent();
+  const int parent_key_size = parent->primary_key().size();
+  const Storage* storage = context->storage();
+  const absl::Time timestamp = context->pending_commit_timestamp();
+  std::unique_ptr<StorageIterator> child_itr;
+  ZETASQL_RETURN_IF_ERROR(
+      storage->Read(timestamp, table->id(), KeyRange::All(), {}, &child_itr));
+  std::unique_ptr<StorageIterator> parent_itr;
+  ZETASQL_RETURN_IF_ERROR(
+      storage->Read(timestamp, parent->id(), KeyRange::All(), {}, &parent_itr));
+  bool has_parent_row = parent_itr->Next();
+  while (child_itr->Next()) {
+    Key parent_key = child_itr->Key().Prefix(parent_key_size);
+    while (has_parent_row && parent_itr->Key() < parent_key) {
+      has_parent_row = parent_itr->Next();
+    }
+    ZETASQL_RETURN_IF_ERROR(parent_itr->Status());
+    if (!has_parent_row || parent_itr->Key() != parent_key) {
+      return error::ParentKeyNotFound(parent->Name(), table->Name(),
+                                      parent_key.DebugString());
+    }
+  }
+  return child_itr->Status();
+}
+
+// Backfills the columns of `import` which are computed rather than imported.
+absl::Status BackfillComputedColumns(const TableImport& import,
+                                     const SchemaValidationContext* context) {
+  for (const Column* column : import.table->columns()) {
+    if (column->is_generated() ||
+        (column->has_default_value() &&
+         std::find(import.columns.begin(), import.columns.end(), column) ==
+             import.columns.end())) {
+      ZETASQL_RETURN_IF_ERROR(BackfillGeneratedColumnValue(column, context));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Verifies the constraints on the rows of `table` which do not depend on other
+// tables.
+absl::Status VerifyRowConstraints(const Table* table,
+                                  const SchemaValidationContext* context) {
+  for (const Column* column : table->columns()) {
+    if (!column->is_nullable()) {
+      ZETASQL_RETURN_IF_ERROR(VerifyColumnNotNull(table, column, context));
+    }
+    if (column->declared_max_length().has_value()) {
+      ZETASQL_RETURN_IF_ERROR(VerifyColumnLength(
+          table, column, *column->declared_max_length(), context));
+    }
+  }
+  for (const CheckConstraint* check_constraint : table->check_constraints()) {
+    ZETASQL_RETURN_IF_ERROR(
+        VerifyCheckConstraintData(check_constraint, context));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status ImportTables(std::vector<TableImport> imports,
+                          const SchemaValidationContext* context) {
+  absl::flat_hash_set<const Table*> tables;
+  for (const TableImport& import : imports) {
+    ZETASQL_RET_CHECK_NE(import.table, nullptr);
+    if (!tables.insert(import.table).second) {
+      return error::BulkImportDuplicateTable(import.table->Name());
+    }
+    ZETASQL_RETURN_IF_ERROR(ValidateColumns(import));
+  }
+
+  // Tables are sorted and loaded in parallel.
+  ZETASQL_RETURN_IF_ERROR(ProcessKeyRanges(imports.size(), [&](int i) {
+    return LoadTable(&imports[i], context);
+  }));
+
+  // Derived data is computed before the constraints which may depend on it are
+  // verified. Each pass is internally parallel over the key ranges of a table.
+  for (const TableImport& import : imports) {
+    ZETASQL_RETURN_IF_ERROR(BackfillComputedColumns(import, context));
+    for (const Index* index : import.table->indexes()) {
+      ZETASQL_RETURN_IF_ERROR(BackfillIndex(index, context));
+    }
+  }
+  ZETASQL_RETURN_IF_ERROR(ProcessKeyRanges(imports.size(), [&](int i) {
+    const Table* table = imports[i].table;
+    if (table->parent() != nullptr) {
+      ZETASQL_RETURN_IF_ERROR(VerifyParentRowsExist(table, context));
+    }
+    return absl::OkStatus();
+  }));
+  for (const TableImport& import : imports) {
+    ZETASQL_RETURN_IF_ERROR(VerifyRowConstraints(import.table, context));
+    for (const ForeignKey* foreign_key : import.table->foreign_keys()) {
+      ZETASQL_RETURN_IF_ERROR(VerifyForeignKeyData(foreign_key, context));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,61 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_BULK_IMPORT_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_BULK_IMPORT_H_
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "backend/datamodel/value.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/schema/updater/schema_validation_context.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// The rows to import into a table, as values of `columns`, in any order.
+struct TableImport {
+  const Table* table = nullptr;
+  std::vector<const Column*> columns;
+  std::vector<ValueList> rows;
+};
+
+// Loads `imports` into the storage of `context`, at its pending commit
+// timestamp, bypassing the mutation path.
+//
+// The rows of each table are sorted by primary key and bulk loaded with
+// Storage::LoadSorted, tables in parallel. Everything a commit would derive
+// from the rows then runs as batch passes over the loaded tables, as for a
+// schema change: generated columns and the default values of columns which are
+// not imported are backfilled, then indexes, and finally the parent rows of
+// interleaved tables, NOT NULL columns, column lengths, check constraints and
+// foreign keys are verified.
+//
+// The imported tables must be empty, and are left partially loaded if the
+// import fails. Imports do not write change stream records.
+absl::Status ImportTables(std::vector<TableImport> imports,
+                          const SchemaValidationContext* context);
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_BULK_IMPORT_H_
@@ -18,7 +18,6 @@
 
 #include <memory>  // NOLINT
 #include <string>
-#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -35,6 +34,7 @@
 #include "absl/time/time.h"
 #include "backend/access/read.h"
 #include "backend/access/write.h"
+#include "backend/database/change_stream/churn_scheduler.h"
 #include "backend/datamodel/key_set.h"
 #include "backend/schema/backfills/change_stream_backfill.h"
 #include "backend/schema/catalog/change_stream.h"
@@ -71,63 +71,61 @@ namespace backend {
 using zetasql::values::String;
 using zetasql::values::StringArray;
 
-void ChangeStreamPartitionChurner::CreateChurningThread(
+void ChangeStreamPartitionChurner::CreateChurningTask(
     absl::string_view change_stream_name) {
   mu_.AssertHeld();
   if (!absl::GetFlag(FLAGS_enable_change_stream_churning)) {
     return;
   }
-  auto churning_thread = std::make_unique<ChurningThread>();
-  auto thread =
-      std::thread(&ChangeStreamPartitionChurner::PeriodicChurnPartitions, this,
-                  std::string(change_stream_name), churning_thread.get());
-  churning_thread->thread = std::move(thread);
-  churn_threads_.try_emplace(change_stream_name, std::move(churning_thread));
+  ChurnScheduler::TaskId task_id = scheduler_->Schedule(
+      absl::GetFlag(FLAGS_change_stream_churn_thread_sleep_interval),
+      [this, name = std::string(change_stream_name)]() {
+        return ChurnPartitionsOnce(name);
+      });
+  churn_tasks_.try_emplace(change_stream_name, task_id);
 }
 
-void ChangeStreamPartitionChurner::ClearChurningThread(
+void ChangeStreamPartitionChurner::ClearChurningTask(
     absl::string_view change_stream_name) {
   mu_.AssertHeld();
-  churn_threads_.erase(change_stream_name);
+  auto it = churn_tasks_.find(change_stream_name);
+  if (it == churn_tasks_.end()) {
+    return;
+  }
+  ABSL_LOG(INFO) << "Stopping churning of change stream " << change_stream_name;
+  scheduler_->Cancel(it->second);
+  churn_tasks_.erase(it);
 }
 
-void ChangeStreamPartitionChurner::ClearAllChurningThreads() {
+void ChangeStreamPartitionChurner::ClearAllChurningTasks() {
   absl::MutexLock l(&mu_);
-  churn_threads_.clear();
+  for (const auto& [change_stream_name, task_id] : churn_tasks_) {
+    scheduler_->Cancel(task_id);
+  }
+  churn_tasks_.clear();
 }
 
-void ChangeStreamPartitionChurner::PeriodicChurnPartitions(
-    absl::string_view change_stream_name, ChurningThread* churning_thread) {
-  while (true) {
-    {
-      absl::MutexLock l(&churning_thread->mu);
-      churning_thread->mu.AwaitWithTimeout(
-          absl::Condition(&churning_thread->stop_thread),
-          absl::GetFlag(FLAGS_change_stream_churn_thread_sleep_interval));
-      if (churning_thread->stop_thread) {
-        return;
-      }
-    }
-    absl::Status s;
-    // In the current state, the emulator only allows one ongoing transaction
-    // at a time. Thus, churn might fail occasionally due to conflict with
-    // another ongoing transaction. We should retry the churn in cases of
-    // failure.
-    do {
-      s = ChurnPartitions(change_stream_name);
-
-      const auto delay =
-          absl::GetFlag(FLAGS_change_stream_churn_thread_retry_jitter) *
-          absl::Uniform<double>(absl::BitGen(), 0, 1);
-      absl::SleepFor(
-          absl::GetFlag(FLAGS_change_stream_churn_thread_retry_sleep_interval) +
-          absl::Milliseconds(delay));
-      if (!s.ok() && !absl::IsAborted(s)) {
-        ABSL_LOG(ERROR) << "Failed to churn change stream " << change_stream_name
-                   << " with status: " << s;
-      }
-    } while (!s.ok());
+absl::Duration ChangeStreamPartitionChurner::ChurnPartitionsOnce(
+    absl::string_view change_stream_name) {
+  // In the current state, the emulator only allows one ongoing transaction
+  // at a time. Thus, churn might fail occasionally due to conflict with
+  // another ongoing transaction. We should retry the churn in cases of
+  // failure.
+  absl::Status s = ChurnPartitions(change_stream_name);
+  if (!s.ok() && !absl::IsAborted(s)) {
+    ABSL_LOG(ERROR) << "Failed to churn change stream " << change_stream_name
+               << " with status: " << s;
   }
+  const auto jitter =
+      absl::GetFlag(FLAGS_change_stream_churn_thread_retry_jitter) *
+      absl::Uniform<double>(absl::BitGen(), 0, 1);
+  absl::Duration delay =
+      absl::GetFlag(FLAGS_change_stream_churn_thread_retry_sleep_interval) +
+      absl::Milliseconds(jitter);
+  if (s.ok()) {
+    delay += absl::GetFlag(FLAGS_change_stream_churn_thread_sleep_interval);
+  }
+  return delay;
 }
 
 // TODO: Change stream churn transactions can potentially cause
@@ -205,7 +203,12 @@ absl::Status ChangeStreamPartitionChurner::ChurnPartitions(
                                      partition_tokens[1], txn.get()));
     }
   }
-  return txn->Commit();
+  ZETASQL_RETURN_IF_ERROR(txn->Commit());
+  if (partition_token_cache_ != nullptr && !churned_partitions.empty()) {
+    partition_token_cache_->Invalidate(
+        change_stream->change_stream_partition_table()->id());
+  }
+  return absl::OkStatus();
 }
 
 absl::Status ChangeStreamPartitionChurner::MovePartition(
@@ -311,28 +314,28 @@ void ChangeStreamPartitionChurner::Update(const Schema* schema) {
   // Iterate through the change streams in the schema.
   absl::MutexLock l(&mu_);
   absl::flat_hash_set<std::string> change_stream_names;
-  for (const auto& [change_stream_name, churn_thread] : churn_threads_) {
+  for (const auto& [change_stream_name, task_id] : churn_tasks_) {
     change_stream_names.insert(change_stream_name);
   }
 
   for (const auto* change_stream : schema->change_streams()) {
-    // If the thread does not exist in the factory.
+    // If the change stream is not churned yet.
     if (!change_stream_names.contains(change_stream->Name())) {
-      CreateChurningThread(change_stream->Name());
+      CreateChurningTask(change_stream->Name());
     }
   }
 
-  // Remove all nonexistent change stream threads.
+  // Stop churning all nonexistent change streams.
   for (auto& change_stream_name : change_stream_names) {
     if (schema->FindChangeStream(change_stream_name) == nullptr) {
-      ClearChurningThread(change_stream_name);
+      ClearChurningTask(change_stream_name);
     }
   }
 }
 
-int ChangeStreamPartitionChurner::GetNumThreads() {
+int ChangeStreamPartitionChurner::GetNumChurnedChangeStreams() {
   absl::MutexLock l(&mu_);
-  return churn_threads_.size();
+  return churn_tasks_.size();
 }
 
 }  // namespace backend
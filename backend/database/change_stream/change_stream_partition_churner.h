@@ -17,12 +17,12 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_CHANGE_STREAM_CHANGE_STREAM_PARTITION_CHURNER_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_CHANGE_STREAM_CHANGE_STREAM_PARTITION_CHURNER_H_
 
-#include <thread>  // NOLINT
-
 #include "absl/base/thread_annotations.h"
 #include "absl/random/random.h"
+#include "backend/actions/change_stream.h"
 #include "backend/actions/manager.h"
 #include "backend/common/ids.h"
+#include "backend/database/change_stream/churn_scheduler.h"
 #include "backend/locking/manager.h"
 #include "backend/schema/catalog/versioned_catalog.h"
 #include "backend/transaction/read_write_transaction.h"
@@ -30,7 +30,7 @@
 // How often to terminate currently active change stream partitions.
 ABSL_DECLARE_FLAG(absl::Duration, change_stream_churning_interval);
 
-// How often to run the thread with the change stream churning logic.
+// How often to run the change stream churning logic.
 ABSL_DECLARE_FLAG(absl::Duration, change_stream_churn_thread_sleep_interval);
 
 // How long to sleep before retrying a failed change stream churn transaction.
@@ -58,59 +58,50 @@ namespace backend {
 // partitions into the partition table. If two partitions have a parent-child
 // relationship, the parent partition will contain the child in the children
 // columns, and the child partition should contain the parent in the parent
-//  columns. The end timestamp of the parent should be the same as the start
-// timestamp of the child. We will run the churning logic for each change
-// stream in a per-change stream background thread that will be cached
-// in this class. We will add background threads or remove background threads
-// from ChangeStreamChurningFactory every time there is a schema change that
-// adds or removes change streams.
+// columns. The end timestamp of the parent should be the same as the start
+// timestamp of the child. The churning logic of each change stream runs as a
+// recurring task of a ChurnScheduler, which is shared by all databases so that
+// the number of churning threads does not grow with the number of databases
+// and change streams. Tasks are scheduled or cancelled every time there is a
+// schema change that adds or removes change streams.
 class ChangeStreamPartitionChurner {
  public:
   using CreateReadWriteTransactionFn =
       std::function<absl::StatusOr<std::unique_ptr<ReadWriteTransaction>>(
           const ReadWriteOptions& options, const RetryState& retry_state)>;
 
+  // If `partition_token_cache` is set, the cached token of a change stream is
+  // invalidated whenever its partitions are churned.
   ChangeStreamPartitionChurner(
       CreateReadWriteTransactionFn create_read_write_transaction_fn,
-      Clock* clock)
+      Clock* clock, ActivePartitionTokenCache* partition_token_cache = nullptr,
+      ChurnScheduler* scheduler = ChurnScheduler::Default())
       : create_read_write_transaction_fn_(create_read_write_transaction_fn),
-        clock_(clock) {}
+        clock_(clock),
+        partition_token_cache_(partition_token_cache),
+        scheduler_(scheduler) {}
 
-  ~ChangeStreamPartitionChurner() { ClearAllChurningThreads(); }
+  ~ChangeStreamPartitionChurner() { ClearAllChurningTasks(); }
 
   void Update(const Schema* schema);
 
-  int GetNumThreads();
+  // Returns the number of change streams whose partitions are being churned.
+  int GetNumChurnedChangeStreams();
 
  private:
   std::vector<std::string> GetAllChangeStreamNames() const;
 
-  struct ChurningThread {
-    std::thread thread;
-    bool stop_thread ABSL_GUARDED_BY(mu) = false;
-    absl::Mutex mu;
-
-    ~ChurningThread() {
-      {
-        absl::MutexLock l(&mu);
-        ABSL_LOG(INFO) << "Stopping ChurningThread ";
-        stop_thread = true;
-      }
-      // Join the thread.
-      thread.join();
-    }
-  };
-
-  void CreateChurningThread(absl::string_view change_stream_name);
+  void CreateChurningTask(absl::string_view change_stream_name);
 
-  void ClearChurningThread(absl::string_view change_stream_name);
+  void ClearChurningTask(absl::string_view change_stream_name);
 
-  void ClearAllChurningThreads();
+  void ClearAllChurningTasks();
 
   absl::Status ChurnPartitions(absl::string_view change_stream_name);
 
-  void PeriodicChurnPartitions(absl::string_view change_stream_name,
-                               ChurningThread* churning_thread);
+  // Runs a single churn attempt of the change stream and returns the delay
+  // until the next one.
+  absl::Duration ChurnPartitionsOnce(absl::string_view change_stream_name);
 
   absl::Status MovePartition(absl::string_view change_stream_name,
                              absl::string_view partition_token,
@@ -132,10 +123,16 @@ class ChangeStreamPartitionChurner {
   // Clock shared across emulator components.
   Clock* clock_;
 
+  // Active partition tokens of the database, or null.
+  ActivePartitionTokenCache* partition_token_cache_;
+
+  // Runs the churning tasks.
+  ChurnScheduler* scheduler_;
+
   mutable absl::Mutex mu_;
 
-  absl::flat_hash_map<std::string, std::unique_ptr<ChurningThread>>
-      churn_threads_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, ChurnScheduler::TaskId> churn_tasks_
+      ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace backend
@@ -259,7 +259,8 @@ class ChangeStreamPartitionChurnerTest : public ::testing::Test {
 
 TEST_F(ChangeStreamPartitionChurnerTest, ChangeStreamChurning) {
   std::string change_stream_one = "change_stream_one";
-  ASSERT_EQ(1, db_->get_change_stream_partition_churner()->GetNumThreads());
+  ASSERT_EQ(1, db_->get_change_stream_partition_churner()
+                   ->GetNumChurnedChangeStreams());
 
   absl::SleepFor(
       absl::GetFlag(FLAGS_change_stream_churn_thread_sleep_interval) * 5);
@@ -275,7 +276,8 @@ TEST_F(ChangeStreamPartitionChurnerTest, ChangeStreamChurning) {
 
   std::string change_stream_two = "change_stream_two";
   AddChangeStream(change_stream_two);
-  ASSERT_EQ(2, db_->get_change_stream_partition_churner()->GetNumThreads());
+  ASSERT_EQ(2, db_->get_change_stream_partition_churner()
+                   ->GetNumChurnedChangeStreams());
 
   absl::SleepFor(
       absl::GetFlag(FLAGS_change_stream_churn_thread_sleep_interval) * 5);
@@ -300,7 +302,8 @@ TEST_F(ChangeStreamPartitionChurnerTest, ChangeStreamChurning) {
 
   std::string change_stream_three = "change_stream_three";
   AddChangeStream(change_stream_three);
-  ASSERT_EQ(3, db_->get_change_stream_partition_churner()->GetNumThreads());
+  ASSERT_EQ(3, db_->get_change_stream_partition_churner()
+                   ->GetNumChurnedChangeStreams());
 
   absl::SleepFor(absl::Seconds(5));
 
@@ -334,13 +337,16 @@ TEST_F(ChangeStreamPartitionChurnerTest, ChangeStreamChurning) {
   VerifyStaleAndActivePartitions(stale_and_active_partitions);
 
   DropChangeStream(change_stream_three);
-  ASSERT_EQ(2, db_->get_change_stream_partition_churner()->GetNumThreads());
+  ASSERT_EQ(2, db_->get_change_stream_partition_churner()
+                   ->GetNumChurnedChangeStreams());
 
   DropChangeStream(change_stream_two);
-  ASSERT_EQ(1, db_->get_change_stream_partition_churner()->GetNumThreads());
+  ASSERT_EQ(1, db_->get_change_stream_partition_churner()
+                   ->GetNumChurnedChangeStreams());
 
   DropChangeStream(change_stream_one);
-  ASSERT_EQ(0, db_->get_change_stream_partition_churner()->GetNumThreads());
+  ASSERT_EQ(0, db_->get_change_stream_partition_churner()
+                   ->GetNumChurnedChangeStreams());
 }
 
 TEST_F(ChangeStreamPartitionChurnerTest, ChangeStreamSplitAndMerge) {
@@ -0,0 +1,193 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/database/change_stream/churn_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+ABSL_FLAG(int, change_stream_churn_threads, 2,
+          "Number of threads running the change stream partition churns of "
+          "all databases.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+ChurnScheduler::ChurnScheduler(int num_threads, absl::Duration tick,
+                               int num_slots)
+    : tick_(tick), start_(absl::Now()) {
+  slots_.resize(std::max(num_slots, 1));
+  timer_ = std::thread(&ChurnScheduler::RunTimer, this);
+  for (int i = 0; i < std::max(num_threads, 1); ++i) {
+    workers_.emplace_back(&ChurnScheduler::RunWorker, this);
+  }
+}
+
+ChurnScheduler::~ChurnScheduler() {
+  {
+    absl::MutexLock l(&mu_);
+    stopping_ = true;
+    ready_cvar_.SignalAll();
+  }
+  timer_.join();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+ChurnScheduler* ChurnScheduler::Default() {
+  static ChurnScheduler* scheduler =
+      new ChurnScheduler(absl::GetFlag(FLAGS_change_stream_churn_threads));
+  return scheduler;
+}
+
+ChurnScheduler::TaskId ChurnScheduler::Schedule(absl::Duration delay,
+                                                Task task) {
+  absl::MutexLock l(&mu_);
+  const TaskId id = next_id_++;
+  TaskState& state = tasks_[id];
+  state.task = std::move(task);
+  AddToWheel(id, &state, absl::Now() + delay);
+  return id;
+}
+
+void ChurnScheduler::Cancel(TaskId id) {
+  absl::MutexLock l(&mu_);
+  auto it = tasks_.find(id);
+  if (it == tasks_.end()) {
+    return;
+  }
+  if (!it->second.running) {
+    // Entries of the task left in the wheel or the ready queue are skipped.
+    tasks_.erase(it);
+    return;
+  }
+  it->second.cancelled = true;
+  while (tasks_.contains(id)) {
+    done_cvar_.Wait(&mu_);
+  }
+}
+
+void ChurnScheduler::AddToWheel(TaskId id, TaskState* state, absl::Time due) {
+  state->due_tick =
+      std::max(absl::IDivDuration(absl::Ceil(due - start_, tick_), tick_,
+                                  /*rem=*/nullptr),
+               processed_tick_ + 1);
+  slots_[state->due_tick % slots_.size()].push_back(id);
+}
+
+bool ChurnScheduler::StoppingOrHasTasks() {
+  return stopping_ || !tasks_.empty();
+}
+
+void ChurnScheduler::RunTimer() {
+  absl::MutexLock l(&mu_);
+  while (!stopping_) {
+    if (tasks_.empty()) {
+      // Stop ticking while there is nothing to run.
+      mu_.Await(absl::Condition(this, &ChurnScheduler::StoppingOrHasTasks));
+    } else {
+      mu_.AwaitWithDeadline(absl::Condition(&stopping_),
+                            start_ + tick_ * (processed_tick_ + 1));
+    }
+    if (stopping_) {
+      return;
+    }
+    const int64_t now_tick = absl::IDivDuration(absl::Now() - start_, tick_,
+                                                /*rem=*/nullptr);
+    // Each slot needs to be visited at most once, even if the timer fell
+    // behind by more than a rotation.
+    const int64_t num_slots = slots_.size();
+    const int64_t first_tick =
+        std::max(processed_tick_ + 1, now_tick - num_slots + 1);
+    bool has_ready = false;
+    for (int64_t tick = first_tick; tick <= now_tick; ++tick) {
+      std::vector<TaskId>& slot = slots_[tick % num_slots];
+      std::vector<TaskId> pending;
+      for (TaskId id : slot) {
+        auto it = tasks_.find(id);
+        if (it == tasks_.end()) {
+          continue;
+        }
+        if (it->second.due_tick > now_tick) {
+          // Due in a later rotation of the wheel.
+          pending.push_back(id);
+          continue;
+        }
+        ready_.push_back(id);
+        has_ready = true;
+      }
+      slot = std::move(pending);
+    }
+    processed_tick_ = std::max(processed_tick_, now_tick);
+    if (has_ready) {
+      ready_cvar_.SignalAll();
+    }
+  }
+}
+
+void ChurnScheduler::RunWorker() {
+  while (true) {
+    TaskId id = 0;
+    TaskState* state = nullptr;
+    {
+      absl::MutexLock l(&mu_);
+      while (true) {
+        while (!stopping_ && ready_.empty()) {
+          ready_cvar_.Wait(&mu_);
+        }
+        if (stopping_) {
+          return;
+        }
+        id = ready_.front();
+        ready_.pop_front();
+        auto it = tasks_.find(id);
+        if (it != tasks_.end()) {
+          state = &it->second;
+          break;
+        }
+      }
+      state->running = true;
+    }
+
+    const absl::Duration delay = state->task();
+
+    absl::MutexLock l(&mu_);
+    state->running = false;
+    if (state->cancelled) {
+      tasks_.erase(id);
+      done_cvar_.SignalAll();
+    } else {
+      AddToWheel(id, state, absl::Now() + delay);
+    }
+  }
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
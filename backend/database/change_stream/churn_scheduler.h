@@ -0,0 +1,146 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_CHANGE_STREAM_CHURN_SCHEDULER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_CHANGE_STREAM_CHURN_SCHEDULER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/flags/declare.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+// Number of threads running the change stream churns of all databases.
+ABSL_DECLARE_FLAG(int, change_stream_churn_threads);
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// ChurnScheduler runs recurring tasks, such as the partition churns of change
+// streams, on a fixed pool of threads.
+//
+// Pending tasks are kept in a hashed timer wheel: a ring of slots, each
+// holding the tasks due in one tick of the wheel, with tasks due more than a
+// rotation away staying in their slot until their round comes up. A timer
+// thread advances the wheel every tick and hands the due tasks to the worker
+// threads. Scheduling and cancelling a task are constant time, and the number
+// of threads does not depend on the number of tasks.
+//
+// This class is thread-safe.
+class ChurnScheduler {
+ public:
+  using TaskId = int64_t;
+
+  // Runs one iteration of a recurring task and returns the delay after which
+  // it should run again.
+  using Task = std::function<absl::Duration()>;
+
+  ChurnScheduler(int num_threads, absl::Duration tick = absl::Milliseconds(10),
+                 int num_slots = 512);
+
+  // Stops the threads, waiting for running tasks to return. Pending tasks are
+  // dropped.
+  ~ChurnScheduler();
+
+  // Returns the scheduler shared by all databases, with the number of threads
+  // set by --change_stream_churn_threads.
+  static ChurnScheduler* Default();
+
+  // Schedules `task` to first run after `delay`, and then after each delay it
+  // returns, until the task is cancelled.
+  TaskId Schedule(absl::Duration delay, Task task) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Cancels the task with the given id. If it is running, waits for it to
+  // return. Must not be called from within the task itself.
+  void Cancel(TaskId id) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of threads of the scheduler, including its timer
+  // thread.
+  int NumThreads() const { return workers_.size() + 1; }
+
+ private:
+  struct TaskState {
+    Task task;
+
+    // Tick at or after which the task is due.
+    int64_t due_tick = 0;
+
+    bool running = false;
+    bool cancelled = false;
+  };
+
+  // Adds the task to the slot of the first tick at or after `due`.
+  void AddToWheel(TaskId id, TaskState* state, absl::Time due)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  bool StoppingOrHasTasks() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Advances the wheel every tick, moving the due tasks to the ready queue.
+  void RunTimer() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Runs the ready tasks and puts them back into the wheel.
+  void RunWorker() ABSL_LOCKS_EXCLUDED(mu_);
+
+  const absl::Duration tick_;
+
+  // Time of tick zero of the wheel.
+  const absl::Time start_;
+
+  absl::Mutex mu_;
+
+  // Signaled when tasks become ready to run, or when the scheduler stops.
+  absl::CondVar ready_cvar_;
+
+  // Signaled when a running task returns.
+  absl::CondVar done_cvar_;
+
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+
+  TaskId next_id_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // Tasks by id. Nodes are stable, so that a running task can be invoked
+  // without holding the lock.
+  absl::node_hash_map<TaskId, TaskState> tasks_ ABSL_GUARDED_BY(mu_);
+
+  // Ids of the tasks pending in each slot of the wheel. Ids of cancelled tasks
+  // are skipped when their slot comes up.
+  std::vector<std::vector<TaskId>> slots_ ABSL_GUARDED_BY(mu_);
+
+  // The last tick whose slot was handed to the workers.
+  int64_t processed_tick_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // Ids of the due tasks, in the order the workers should run them.
+  std::deque<TaskId> ready_ ABSL_GUARDED_BY(mu_);
+
+  std::thread timer_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_CHANGE_STREAM_CHURN_SCHEDULER_H_
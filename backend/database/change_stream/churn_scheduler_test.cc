@@ -0,0 +1,130 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/database/change_stream/churn_scheduler.h"
+
+#include <atomic>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+TEST(ChurnSchedulerTest, RunsTaskAfterDelay) {
+  ChurnScheduler scheduler(/*num_threads=*/1);
+  absl::Notification ran;
+  const absl::Time start = absl::Now();
+  absl::Time run_time;
+  ChurnScheduler::TaskId id =
+      scheduler.Schedule(absl::Milliseconds(50), [&]() {
+        if (!ran.HasBeenNotified()) {
+          run_time = absl::Now();
+          ran.Notify();
+        }
+        return absl::Hours(1);
+      });
+  ran.WaitForNotification();
+  EXPECT_GE(run_time - start, absl::Milliseconds(50));
+  scheduler.Cancel(id);
+}
+
+TEST(ChurnSchedulerTest, ReschedulesTaskWithReturnedDelay) {
+  ChurnScheduler scheduler(/*num_threads=*/1);
+  std::atomic<int> runs = 0;
+  absl::Notification ran_three_times;
+  ChurnScheduler::TaskId id = scheduler.Schedule(absl::ZeroDuration(), [&]() {
+    if (++runs == 3) {
+      ran_three_times.Notify();
+    }
+    return absl::Milliseconds(10);
+  });
+  ran_three_times.WaitForNotification();
+  scheduler.Cancel(id);
+  const int runs_after_cancel = runs;
+  absl::SleepFor(absl::Milliseconds(50));
+  EXPECT_EQ(runs, runs_after_cancel);
+}
+
+TEST(ChurnSchedulerTest, RunsTasksDueBeyondOneRotation) {
+  // A rotation of the wheel spans 40ms.
+  ChurnScheduler scheduler(/*num_threads=*/1, absl::Milliseconds(10),
+                           /*num_slots=*/4);
+  absl::Notification ran;
+  const absl::Time start = absl::Now();
+  absl::Time run_time;
+  ChurnScheduler::TaskId id =
+      scheduler.Schedule(absl::Milliseconds(100), [&]() {
+        if (!ran.HasBeenNotified()) {
+          run_time = absl::Now();
+          ran.Notify();
+        }
+        return absl::Hours(1);
+      });
+  ran.WaitForNotification();
+  EXPECT_GE(run_time - start, absl::Milliseconds(100));
+  scheduler.Cancel(id);
+}
+
+TEST(ChurnSchedulerTest, CancelWaitsForRunningTask) {
+  ChurnScheduler scheduler(/*num_threads=*/1);
+  absl::Notification started;
+  std::atomic<bool> finished = false;
+  ChurnScheduler::TaskId id = scheduler.Schedule(absl::ZeroDuration(), [&]() {
+    started.Notify();
+    absl::SleepFor(absl::Milliseconds(50));
+    finished = true;
+    return absl::Hours(1);
+  });
+  started.WaitForNotification();
+  scheduler.Cancel(id);
+  EXPECT_TRUE(finished);
+}
+
+TEST(ChurnSchedulerTest, RunsManyTasksOnFixedThreads) {
+  ChurnScheduler scheduler(/*num_threads=*/2);
+  constexpr int kNumTasks = 1000;
+  std::atomic<int> runs = 0;
+  absl::Notification all_ran;
+  std::vector<ChurnScheduler::TaskId> ids;
+  for (int i = 0; i < kNumTasks; ++i) {
+    ids.push_back(scheduler.Schedule(absl::Milliseconds(i % 50), [&]() {
+      if (++runs == kNumTasks) {
+        all_ran.Notify();
+      }
+      return absl::Hours(1);
+    }));
+  }
+  all_ran.WaitForNotification();
+  EXPECT_EQ(scheduler.NumThreads(), 3);
+  for (ChurnScheduler::TaskId id : ids) {
+    scheduler.Cancel(id);
+  }
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
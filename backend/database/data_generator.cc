@@ -0,0 +1,547 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/data_generator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/numeric_value.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "backend/actions/check_constraint.h"
+#include "backend/datamodel/key.h"
+#include "backend/query/catalog.h"
+#include "backend/query/function_catalog.h"
+#include "backend/schema/catalog/check_constraint.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/foreign_key.h"
+#include "backend/schema/catalog/index.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/schema/updater/parallel_scan.h"
+#include "backend/transaction/resolve.h"
+#include "common/errors.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Number of rows generated by each parallel chunk of a table.
+constexpr int64_t kRowsPerChunk = 10000;
+
+// Number of times the random values of a row are drawn before giving up on
+// satisfying the check constraints of its table.
+constexpr int kMaxCheckConstraintAttempts = 100;
+
+// Maximum length of generated strings and bytes, and of generated arrays.
+constexpr int64_t kMaxRandomLength = 16;
+constexpr int kMaxArrayLength = 3;
+
+// Number of digits of the ordinals of STRING and BYTES columns, so that their
+// order matches the order of the ordinals.
+constexpr int kOrdinalDigits = 12;
+
+// Tables are generated after the tables they depend on, as for snapshots.
+void AddTableInDependencyOrder(const Table* table,
+                               absl::flat_hash_set<const Table*>* visited,
+                               std::vector<const Table*>* ordered) {
+  if (!visited->insert(table).second) {
+    return;
+  }
+  if (table->parent() != nullptr) {
+    AddTableInDependencyOrder(table->parent(), visited, ordered);
+  }
+  for (const ForeignKey* foreign_key : table->foreign_keys()) {
+    AddTableInDependencyOrder(foreign_key->referenced_table(), visited,
+                              ordered);
+  }
+  ordered->push_back(table);
+}
+
+std::vector<const Table*> TablesInDependencyOrder(const Schema* schema) {
+  absl::flat_hash_set<const Table*> visited;
+  std::vector<const Table*> ordered;
+  for (const Table* table : schema->tables()) {
+    if (table->is_public()) {
+      AddTableInDependencyOrder(table, &visited, &ordered);
+    }
+  }
+  return ordered;
+}
+
+bool CanGenerate(const zetasql::Type* type) {
+  if (type->IsArray()) {
+    return CanGenerate(type->AsArray()->element_type());
+  }
+  return type->IsInt64() || type->IsString() || type->IsBytes() ||
+         type->IsBool() || type->IsDouble() || type->IsFloat() ||
+         type->IsDate() || type->IsTimestamp() || type->IsNumericType();
+}
+
+// Returns the value of `column` for `ordinal`, such that values are distinct
+// and ordered as their ordinals.
+absl::StatusOr<zetasql::Value> OrdinalValue(const Column* column,
+                                            int64_t ordinal) {
+  const zetasql::Type* type = column->GetType();
+  if (type->IsInt64()) {
+    return zetasql::values::Int64(ordinal);
+  }
+  if (type->IsString() || type->IsBytes()) {
+    int digits = std::min<int64_t>(
+        kOrdinalDigits, column->declared_max_length().value_or(kOrdinalDigits));
+    std::string text = absl::StrFormat("%0*d", digits, ordinal);
+    if (text.size() > digits) {
+      return error::DataGenerationNotSupported(
+          absl::StrCat("ordinals of more than ", digits, " digits in column ",
+                       column->FullName()));
+    }
+    return type->IsString() ? zetasql::values::String(text)
+                            : zetasql::values::Bytes(text);
+  }
+  if (type->IsDouble()) {
+    return zetasql::values::Double(ordinal);
+  }
+  if (type->IsFloat()) {
+    return zetasql::values::Float(ordinal);
+  }
+  if (type->IsNumericType()) {
+    return zetasql::values::Numeric(zetasql::NumericValue(ordinal));
+  }
+  if (type->IsTimestamp()) {
+    return zetasql::values::Timestamp(absl::UnixEpoch() +
+                                      absl::Microseconds(ordinal));
+  }
+  if (type->IsDate() && ordinal <= zetasql::types::kDateMax) {
+    return zetasql::values::Date(static_cast<int32_t>(ordinal));
+  }
+  if (type->IsBool() && ordinal <= 1) {
+    return zetasql::values::Bool(ordinal == 1);
+  }
+  return error::DataGenerationNotSupported(
+      absl::StrCat(ordinal + 1, " distinct values of column ",
+                   column->FullName()));
+}
+
+std::string RandomText(std::optional<int64_t> max_length,
+                       std::mt19937_64* random) {
+  int64_t length = std::uniform_int_distribution<int64_t>(
+      1, std::min(kMaxRandomLength, max_length.value_or(kMaxRandomLength)))(
+      *random);
+  std::string text(length, ' ');
+  for (char& c : text) {
+    c = 'a' + std::uniform_int_distribution<int>(0, 25)(*random);
+  }
+  return text;
+}
+
+// Returns a random value of `type`, which CanGenerate.
+zetasql::Value RandomValue(const zetasql::Type* type,
+                           std::optional<int64_t> max_length,
+                           std::mt19937_64* random) {
+  if (type->IsArray()) {
+    std::vector<zetasql::Value> elements(
+        std::uniform_int_distribution<int>(0, kMaxArrayLength)(*random));
+    for (zetasql::Value& element : elements) {
+      element =
+          RandomValue(type->AsArray()->element_type(), max_length, random);
+    }
+    return zetasql::values::Array(type->AsArray(), elements);
+  }
+  if (type->IsInt64()) {
+    return zetasql::values::Int64(
+        std::uniform_int_distribution<int64_t>(0, 999999999)(*random));
+  }
+  if (type->IsString()) {
+    return zetasql::values::String(RandomText(max_length, random));
+  }
+  if (type->IsBytes()) {
+    return zetasql::values::Bytes(RandomText(max_length, random));
+  }
+  if (type->IsBool()) {
+    return zetasql::values::Bool(std::bernoulli_distribution()(*random));
+  }
+  if (type->IsDouble()) {
+    return zetasql::values::Double(
+        std::uniform_real_distribution<double>(0, 1000)(*random));
+  }
+  if (type->IsFloat()) {
+    return zetasql::values::Float(
+        std::uniform_real_distribution<float>(0, 1000)(*random));
+  }
+  if (type->IsDate()) {
+    // Dates between 1970 and 2024.
+    return zetasql::values::Date(
+        std::uniform_int_distribution<int32_t>(0, 19722)(*random));
+  }
+  if (type->IsTimestamp()) {
+    return zetasql::values::Timestamp(
+        absl::FromUnixSeconds(std::uniform_int_distribution<int64_t>(
+            0, 1700000000)(*random)));
+  }
+  return zetasql::values::Numeric(zetasql::NumericValue(
+      std::uniform_int_distribution<int64_t>(0, 999999999)(*random)));
+}
+
+// How the value of a generated column is chosen.
+struct ColumnPlan {
+  enum class Source {
+    // The value of the same key column in the parent row.
+    kParentKey,
+    // The ordinal of the row within its parent row, for the first key column
+    // which is not inherited from the parent.
+    kKeyOrdinal,
+    // The ordinal of the row within the table, for columns of unique indexes.
+    kRowOrdinal,
+    // A column of the row referenced by the foreign key `foreign_key`.
+    kForeignKey,
+    kRandom,
+    kNull,
+  };
+
+  const Column* column;
+  Source source = Source::kRandom;
+  // Index of the parent key column in the columns of the parent import, for
+  // kParentKey.
+  int parent_column = 0;
+  // Index of the referencing foreign key in TablePlan::foreign_keys, and of
+  // the referenced column in the columns of the referenced import, for
+  // kForeignKey.
+  int foreign_key = 0;
+  int referenced_column = 0;
+};
+
+// How the rows of a table are generated. Rows are generated for units: each
+// row of the parent of an interleaved table is a unit holding
+// `rows_per_unit` rows, whereas each row of other tables is a unit of its own.
+struct TablePlan {
+  const Table* table;
+  // The import of the parent table, for interleaved tables.
+  const TableImport* parent = nullptr;
+  int64_t num_units;
+  int64_t rows_per_unit;
+  std::vector<ColumnPlan> columns;
+  // The rows of the imports referenced by foreign keys.
+  std::vector<const std::vector<ValueList>*> foreign_keys;
+  // Indices of the primary key columns in `columns`.
+  std::vector<std::optional<int>> key_indices;
+};
+
+int IndexOf(const std::vector<const Column*>& columns, const Column* column) {
+  auto it = std::find(columns.begin(), columns.end(), column);
+  return it == columns.end() ? -1 : it - columns.begin();
+}
+
+std::vector<const Column*> ColumnsOf(const TablePlan& plan) {
+  std::vector<const Column*> columns;
+  for (const ColumnPlan& column_plan : plan.columns) {
+    columns.push_back(column_plan.column);
+  }
+  return columns;
+}
+
+absl::StatusOr<TablePlan> PlanTable(
+    const Table* table, const DataGeneratorOptions& options,
+    const absl::flat_hash_map<const Table*, const TableImport*>& generated) {
+  TablePlan plan{.table = table};
+  const int parent_key_size =
+      table->parent() == nullptr ? 0 : table->parent()->primary_key().size();
+  // Tables without key columns of their own hold a single row (per parent).
+  const bool has_own_key = table->primary_key().size() > parent_key_size;
+  if (table->parent() != nullptr) {
+    plan.parent = generated.at(table->parent());
+    plan.num_units = plan.parent->rows.size();
+    plan.rows_per_unit = has_own_key ? options.rows_per_parent : 1;
+  } else {
+    plan.num_units = has_own_key ? options.rows_per_table : 1;
+    plan.rows_per_unit = 1;
+  }
+
+  for (int i = 0; i < table->primary_key().size(); ++i) {
+    const Column* column = table->primary_key()[i]->column();
+    if (column->is_generated()) {
+      return error::DataGenerationNotSupported(
+          absl::StrCat("generated key column ", column->FullName()));
+    }
+    ColumnPlan column_plan{.column = column};
+    if (i < parent_key_size) {
+      column_plan.source = ColumnPlan::Source::kParentKey;
+      column_plan.parent_column = IndexOf(
+          plan.parent->columns, table->parent()->primary_key()[i]->column());
+    } else if (i == parent_key_size) {
+      column_plan.source = ColumnPlan::Source::kKeyOrdinal;
+    } else if (!CanGenerate(column->GetType())) {
+      return error::DataGenerationNotSupported(
+          absl::StrCat("key column ", column->FullName()));
+    }
+    plan.columns.push_back(column_plan);
+  }
+
+  absl::flat_hash_map<const Column*, ColumnPlan> foreign_key_columns;
+  for (const ForeignKey* foreign_key : table->foreign_keys()) {
+    auto referenced = generated.find(foreign_key->referenced_table());
+    for (int i = 0; i < foreign_key->referencing_columns().size(); ++i) {
+      const Column* column = foreign_key->referencing_columns()[i];
+      if (table->FindKeyColumn(column->Name()) != nullptr) {
+        return error::DataGenerationNotSupported(
+            absl::StrCat("foreign key ", foreign_key->Name(),
+                         " on key columns of table ", table->Name()));
+      }
+      ColumnPlan column_plan{.column = column,
+                             .source = ColumnPlan::Source::kNull};
+      int referenced_column =
+          referenced == generated.end()
+              ? -1
+              : IndexOf(referenced->second->columns,
+                        foreign_key->referenced_columns()[i]);
+      if (referenced_column >= 0 && !referenced->second->rows.empty()) {
+        column_plan.source = ColumnPlan::Source::kForeignKey;
+        column_plan.foreign_key = plan.foreign_keys.size();
+        column_plan.referenced_column = referenced_column;
+      } else if (!column->is_nullable()) {
+        return error::DataGenerationNotSupported(
+            absl::StrCat("foreign key ", foreign_key->Name(),
+                         " which references no generated values"));
+      }
+      foreign_key_columns.emplace(column, column_plan);
+    }
+    if (referenced != generated.end()) {
+      plan.foreign_keys.push_back(&referenced->second->rows);
+    }
+  }
+
+  absl::flat_hash_set<const Column*> unique_columns;
+  for (const Index* index : table->indexes()) {
+    if (index->is_unique()) {
+      for (const KeyColumn* key_column : index->key_columns()) {
+        unique_columns.insert(key_column->column()->source_column());
+      }
+    }
+  }
+
+  for (const Column* column : table->columns()) {
+    if (table->FindKeyColumn(column->Name()) != nullptr ||
+        column->is_generated() || column->has_default_value()) {
+      continue;
+    }
+    ColumnPlan column_plan{.column = column};
+    if (auto it = foreign_key_columns.find(column);
+        it != foreign_key_columns.end()) {
+      column_plan = it->second;
+    } else if (unique_columns.contains(column)) {
+      column_plan.source = ColumnPlan::Source::kRowOrdinal;
+    } else if (!CanGenerate(column->GetType())) {
+      if (!column->is_nullable()) {
+        return error::DataGenerationNotSupported(
+            absl::StrCat("column ", column->FullName(), " of type ",
+                         column->GetType()->DebugString()));
+      }
+      column_plan.source = ColumnPlan::Source::kNull;
+    }
+    plan.columns.push_back(column_plan);
+  }
+
+  ZETASQL_ASSIGN_OR_RETURN(plan.key_indices,
+                   ExtractPrimaryKeyIndices(ColumnsOf(plan),
+                                            table->primary_key()));
+  return plan;
+}
+
+// Verifies the check constraints of the table of `plan` against `row`.
+absl::Status VerifyCheckConstraints(
+    const TablePlan& plan, const ValueList& row,
+    const std::vector<std::unique_ptr<CheckConstraintVerifier>>& verifiers) {
+  zetasql::ParameterValueMap column_values;
+  // Generated columns and columns with default values are not known yet.
+  for (const Column* column : plan.table->columns()) {
+    column_values[column->Name()] = zetasql::Value::Null(column->GetType());
+  }
+  for (int i = 0; i < plan.columns.size(); ++i) {
+    column_values[plan.columns[i].column->Name()] = row[i];
+  }
+  Key key = ComputeKey(row, plan.table->primary_key(), plan.key_indices);
+  for (const auto& verifier : verifiers) {
+    ZETASQL_RETURN_IF_ERROR(verifier->VerifyRow(column_values, key));
+  }
+  return absl::OkStatus();
+}
+
+// Generates the rows of the units [begin, end) of `plan`, with a random
+// generator seeded by the ordinal of the table and of the chunk.
+absl::StatusOr<std::vector<ValueList>> GenerateChunk(
+    const TablePlan& plan, const Schema* schema,
+    const DataGeneratorOptions& options, uint64_t table_ordinal,
+    uint64_t chunk, int64_t begin, int64_t end) {
+  std::seed_seq seed{options.seed, table_ordinal, chunk};
+  std::mt19937_64 random(seed);
+  std::bernoulli_distribution is_null(options.null_probability);
+
+  // The verifiers hold prepared check constraint expressions, which are not
+  // shared across threads.
+  zetasql::TypeFactory type_factory;
+  FunctionCatalog function_catalog(&type_factory);
+  Catalog catalog(schema, &function_catalog, &type_factory);
+  std::vector<std::unique_ptr<CheckConstraintVerifier>> verifiers;
+  for (const CheckConstraint* check_constraint :
+       plan.table->check_constraints()) {
+    verifiers.push_back(
+        std::make_unique<CheckConstraintVerifier>(check_constraint, &catalog));
+  }
+
+  std::vector<ValueList> rows;
+  rows.reserve((end - begin) * plan.rows_per_unit);
+  std::vector<const ValueList*> referenced_rows(plan.foreign_keys.size());
+  for (int64_t unit = begin; unit < end; ++unit) {
+    for (int64_t i = 0; i < plan.rows_per_unit; ++i) {
+      const int64_t row_ordinal = unit * plan.rows_per_unit + i;
+      const int64_t key_ordinal = plan.parent != nullptr ? i : unit;
+      for (int f = 0; f < plan.foreign_keys.size(); ++f) {
+        const std::vector<ValueList>& candidates = *plan.foreign_keys[f];
+        referenced_rows[f] = &candidates[std::uniform_int_distribution<size_t>(
+            0, candidates.size() - 1)(random)];
+      }
+
+      ValueList row(plan.columns.size());
+      bool has_random_values = false;
+      for (int c = 0; c < plan.columns.size(); ++c) {
+        const ColumnPlan& column_plan = plan.columns[c];
+        const zetasql::Type* type = column_plan.column->GetType();
+        switch (column_plan.source) {
+          case ColumnPlan::Source::kParentKey:
+            row[c] = plan.parent->rows[unit][column_plan.parent_column];
+            break;
+          case ColumnPlan::Source::kKeyOrdinal: {
+            ZETASQL_ASSIGN_OR_RETURN(row[c],
+                             OrdinalValue(column_plan.column, key_ordinal));
+            break;
+          }
+          case ColumnPlan::Source::kRowOrdinal: {
+            ZETASQL_ASSIGN_OR_RETURN(row[c],
+                             OrdinalValue(column_plan.column, row_ordinal));
+            break;
+          }
+          case ColumnPlan::Source::kForeignKey:
+            row[c] = (*referenced_rows[column_plan.foreign_key])
+                [column_plan.referenced_column];
+            break;
+          case ColumnPlan::Source::kNull:
+            row[c] = zetasql::Value::Null(type);
+            break;
+          case ColumnPlan::Source::kRandom:
+            has_random_values = true;
+            break;
+        }
+      }
+
+      for (int attempt = 1; has_random_values; ++attempt) {
+        for (int c = 0; c < plan.columns.size(); ++c) {
+          const ColumnPlan& column_plan = plan.columns[c];
+          if (column_plan.source != ColumnPlan::Source::kRandom) {
+            continue;
+          }
+          const Column* column = column_plan.column;
+          bool is_key = plan.table->FindKeyColumn(column->Name()) != nullptr;
+          row[c] = !is_key && column->is_nullable() && is_null(random)
+                       ? zetasql::Value::Null(column->GetType())
+                       : RandomValue(column->GetType(),
+                                     column->declared_max_length(), &random);
+        }
+        if (verifiers.empty()) {
+          break;
+        }
+        absl::Status status = VerifyCheckConstraints(plan, row, verifiers);
+        if (status.ok()) {
+          break;
+        }
+        if (attempt == kMaxCheckConstraintAttempts) {
+          return error::DataGenerationNotSupported(
+              absl::StrCat("table ", plan.table->Name(),
+                           ", whose check constraints failed ", attempt,
+                           " random rows: ", status.message()));
+        }
+      }
+      rows.push_back(std::move(row));
+    }
+  }
+  return rows;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<TableImport>> GenerateTableData(
+    const Schema* schema, const DataGeneratorOptions& options) {
+  std::vector<const Table*> tables = TablesInDependencyOrder(schema);
+  // Plans of later tables point to the imports of earlier tables.
+  std::vector<TableImport> imports;
+  imports.reserve(tables.size());
+  absl::flat_hash_map<const Table*, const TableImport*> generated;
+  for (uint64_t t = 0; t < tables.size(); ++t) {
+    ZETASQL_ASSIGN_OR_RETURN(TablePlan plan,
+                     PlanTable(tables[t], options, generated));
+    const int64_t units_per_chunk =
+        std::max<int64_t>(1, kRowsPerChunk / plan.rows_per_unit);
+    const int num_chunks =
+        (plan.num_units + units_per_chunk - 1) / units_per_chunk;
+    std::vector<std::vector<ValueList>> chunks(num_chunks);
+    ZETASQL_RETURN_IF_ERROR(ProcessKeyRanges(num_chunks, [&](int chunk) {
+      int64_t begin = chunk * units_per_chunk;
+      int64_t end = std::min(plan.num_units, begin + units_per_chunk);
+      ZETASQL_ASSIGN_OR_RETURN(
+          chunks[chunk],
+          GenerateChunk(plan, schema, options, t, chunk, begin, end));
+      return absl::OkStatus();
+    }));
+
+    TableImport import{.table = tables[t], .columns = ColumnsOf(plan)};
+    for (std::vector<ValueList>& chunk : chunks) {
+      for (ValueList& row : chunk) {
+        import.rows.push_back(std::move(row));
+      }
+    }
+    imports.push_back(std::move(import));
+    generated[tables[t]] = &imports.back();
+  }
+  return imports;
+}
+
+absl::StatusOr<absl::Time> GenerateDatabaseData(
+    Database* database, const DataGeneratorOptions& options) {
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::vector<TableImport> imports,
+      GenerateTableData(database->GetLatestSchema(), options));
+  return database->BulkImport(std::move(imports));
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
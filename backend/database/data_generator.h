@@ -0,0 +1,77 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_DATA_GENERATOR_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_DATA_GENERATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "backend/database/bulk_import.h"
+#include "backend/database/database.h"
+#include "backend/schema/catalog/schema.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+struct DataGeneratorOptions {
+  // Number of rows generated for each table which is not interleaved.
+  int64_t rows_per_table = 1000;
+
+  // Number of rows generated for each interleaved table, per row of its
+  // parent table.
+  int64_t rows_per_parent = 10;
+
+  // Probability for a value of a nullable column to be NULL.
+  double null_probability = 0.1;
+
+  // The same schema, options and seed always generate the same data.
+  uint64_t seed = 0;
+};
+
+// Generates synthetic rows for every public table of `schema`, as imports for
+// Database::BulkImport.
+//
+// Tables are generated after their parents and the tables they reference,
+// and the rows of each table are generated in parallel chunks. Primary keys
+// are generated in key order: the first key column of a table which is not
+// inherited from its parent holds the ordinal of the row, as do the columns of
+// unique indexes, and every interleaved row has a parent row. Foreign key
+// columns copy the referenced columns of a random referenced row. Other
+// columns get random values, which are drawn again until they satisfy the
+// check constraints of the table. Generated columns and columns with default
+// values are left to the import to compute.
+//
+// Columns of types which cannot be generated (e.g. JSON or PROTO) are NULL,
+// and fail generation if they are not nullable.
+absl::StatusOr<std::vector<TableImport>> GenerateTableData(
+    const Schema* schema, const DataGeneratorOptions& options);
+
+// Generates the rows of every table of the latest schema of `database` and
+// bulk imports them, returning the import timestamp.
+absl::StatusOr<absl::Time> GenerateDatabaseData(
+    Database* database, const DataGeneratorOptions& options);
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_DATA_GENERATOR_H_
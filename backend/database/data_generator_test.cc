@@ -0,0 +1,183 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/data_generator.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/public/value.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "backend/access/read.h"
+#include "backend/database/bulk_import.h"
+#include "backend/database/database.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/datamodel/value.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "backend/transaction/options.h"
+#include "common/clock.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using testing::Each;
+using testing::SizeIs;
+using zetasql_base::testing::StatusIs;
+
+class DataGeneratorTest : public ::testing::Test {
+ protected:
+  absl::StatusOr<std::unique_ptr<Database>> CreateDatabase(
+      std::vector<std::string> statements) {
+    return Database::Create(&clock_,
+                            SchemaChangeOperation{.statements = statements});
+  }
+
+  absl::StatusOr<std::vector<ValueList>> ReadAll(
+      Database* database, const std::string& table,
+      const std::vector<std::string>& columns, const std::string& index = "") {
+    ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<ReadOnlyTransaction> txn,
+                     database->CreateReadOnlyTransaction(ReadOnlyOptions()));
+    ReadArg read_arg;
+    read_arg.table = table;
+    read_arg.index = index;
+    read_arg.key_set = KeySet::All();
+    read_arg.columns = columns;
+    std::unique_ptr<RowCursor> cursor;
+    ZETASQL_RETURN_IF_ERROR(txn->Read(read_arg, &cursor));
+    std::vector<ValueList> rows;
+    while (cursor->Next()) {
+      rows.emplace_back();
+      for (int i = 0; i < cursor->NumColumns(); ++i) {
+        rows.back().push_back(cursor->ColumnValue(i));
+      }
+    }
+    ZETASQL_RETURN_IF_ERROR(cursor->Status());
+    return rows;
+  }
+
+  Clock clock_;
+};
+
+const std::vector<std::string>& SingersSchema() {
+  static const auto* statements = new std::vector<std::string>{
+      R"(
+        CREATE TABLE Singers(
+          SingerId INT64 NOT NULL,
+          Name STRING(8) NOT NULL,
+          NameLength INT64 AS (CHAR_LENGTH(Name)) STORED,
+          Score INT64,
+          Tags ARRAY<STRING(MAX)>,
+          CONSTRAINT PositiveScore CHECK (Score > 1000),
+        ) PRIMARY KEY(SingerId)
+      )",
+      R"(
+        CREATE TABLE Albums(
+          SingerId INT64 NOT NULL,
+          AlbumId STRING(MAX) NOT NULL,
+          Title STRING(MAX),
+          Rating INT64 NOT NULL DEFAULT (5),
+        ) PRIMARY KEY(SingerId, AlbumId),
+          INTERLEAVE IN PARENT Singers ON DELETE CASCADE
+      )",
+      R"(
+        CREATE TABLE Fans(
+          FanId INT64 NOT NULL,
+          Email STRING(MAX),
+          FavoriteSingerId INT64 NOT NULL,
+          CONSTRAINT FK_FavoriteSinger FOREIGN KEY (FavoriteSingerId)
+            REFERENCES Singers (SingerId),
+        ) PRIMARY KEY(FanId)
+      )",
+      "CREATE UNIQUE INDEX FansByEmail ON Fans(Email)",
+      "CREATE INDEX AlbumsByTitle ON Albums(Title)"};
+  return *statements;
+}
+
+TEST_F(DataGeneratorTest, GeneratesDataWhichSatisfiesTheSchema) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Database> database,
+                       CreateDatabase(SingersSchema()));
+  ZETASQL_ASSERT_OK(GenerateDatabaseData(database.get(),
+                                 DataGeneratorOptions{.rows_per_table = 50,
+                                                      .rows_per_parent = 3})
+                .status());
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::vector<ValueList> singers,
+      ReadAll(database.get(), "Singers", {"SingerId", "Name", "NameLength"}));
+  ASSERT_THAT(singers, SizeIs(50));
+  for (int i = 0; i < singers.size(); ++i) {
+    EXPECT_EQ(singers[i][0], zetasql::values::Int64(i));
+    EXPECT_EQ(singers[i][2], zetasql::values::Int64(
+                                 singers[i][1].string_value().size()));
+  }
+  // Default values are computed by the import.
+  EXPECT_THAT(
+      ReadAll(database.get(), "Albums", {"Rating"}),
+      zetasql_base::testing::IsOkAndHolds(testing::AllOf(
+          SizeIs(150), Each(ValueList{zetasql::values::Int64(5)}))));
+  EXPECT_THAT(ReadAll(database.get(), "Albums", {"Title"}, "AlbumsByTitle"),
+              zetasql_base::testing::IsOkAndHolds(SizeIs(150)));
+  EXPECT_THAT(ReadAll(database.get(), "Fans", {"Email"}, "FansByEmail"),
+              zetasql_base::testing::IsOkAndHolds(SizeIs(50)));
+}
+
+TEST_F(DataGeneratorTest, GeneratesSameDataForSameSeed) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Database> database,
+                       CreateDatabase(SingersSchema()));
+  const Schema* schema = database->GetLatestSchema();
+  DataGeneratorOptions options{.rows_per_table = 20, .seed = 7};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<TableImport> first,
+                       GenerateTableData(schema, options));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<TableImport> second,
+                       GenerateTableData(schema, options));
+  options.seed = 8;
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<TableImport> other,
+                       GenerateTableData(schema, options));
+  ASSERT_EQ(first.size(), 3);
+  for (int i = 0; i < first.size(); ++i) {
+    EXPECT_EQ(first[i].table, second[i].table);
+    EXPECT_EQ(first[i].rows, second[i].rows);
+  }
+  EXPECT_NE(first[0].rows, other[0].rows);
+}
+
+TEST_F(DataGeneratorTest, RejectsColumnsWhichCannotBeGenerated) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Database> database,
+                       CreateDatabase({R"(
+                         CREATE TABLE T(
+                           K INT64 NOT NULL,
+                           J JSON NOT NULL,
+                         ) PRIMARY KEY(K)
+                       )"}));
+  EXPECT_THAT(GenerateTableData(database->GetLatestSchema(),
+                                DataGeneratorOptions()),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -16,30 +16,60 @@
 
 #include "backend/database/database.h"
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <thread>  // NOLINT
 #include <utility>
+#include <vector>
 
 #include "google/spanner/admin/database/v1/common.pb.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
 #include "absl/functional/bind_front.h"
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "absl/types/variant.h"
 #include "backend/actions/manager.h"
 #include "backend/common/ids.h"
+#include "backend/common/sys_stats.h"
+#include "backend/database/bulk_import.h"
+#include "backend/database/export.h"
 #include "backend/database/change_stream/change_stream_partition_churner.h"
 #include "backend/database/pg_oid_assigner/pg_oid_assigner.h"
+#include "backend/database/schema_template.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/datamodel/value.h"
 #include "backend/locking/manager.h"
+#include "backend/query/query_context.h"
 #include "backend/query/query_engine.h"
+#include "backend/query/spanner_sys_catalog.h"
+#include "backend/schema/catalog/change_stream.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/index.h"
 #include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/table.h"
 #include "backend/schema/catalog/versioned_catalog.h"
+#include "backend/schema/updater/parallel_scan.h"
 #include "backend/schema/updater/schema_updater.h"
 #include "backend/schema/updater/scoped_schema_change_lock.h"
+#include "backend/storage/columnar_storage.h"
 #include "backend/storage/in_memory_storage.h"
+#include "backend/storage/write_ahead_log.h"
+#include "backend/storage/write_ahead_log.pb.h"
 #include "backend/transaction/options.h"
+#include "common/config.h"
+#include "common/constants.h"
+#include "common/errors.h"
+#include "common/profiling.h"
+#include "common/tracing.h"
 #include "absl/status/status.h"
+#include "zetasql/base/ret_check.h"
 #include "zetasql/base/status_macros.h"
 
 namespace google {
@@ -51,20 +81,63 @@ namespace backend {
 // value for an invalid transaction.
 Database::Database() : transaction_id_generator_(1) {}
 
-absl::StatusOr<std::unique_ptr<Database>> Database::Create(
-    Clock* clock, const SchemaChangeOperation& schema_change_operation) {
+std::unique_ptr<Database> Database::CreateEmpty(
+    Clock* clock, database_api::DatabaseDialect dialect,
+    std::unique_ptr<InMemoryStorage> storage) {
   auto database = absl::WrapUnique(new Database());
   database->clock_ = clock;
-  database->storage_ = std::make_unique<InMemoryStorage>();
+  if (storage == nullptr && absl::GetFlag(FLAGS_enable_columnar_storage)) {
+    database->storage_ = std::make_unique<ColumnarStorage>();
+  } else {
+    if (storage == nullptr) {
+      storage = std::make_unique<InMemoryStorage>();
+    }
+    // Versions older than the stale read bound are garbage collected, and so
+    // are dropped by the writes superseding them.
+    if (absl::GetFlag(FLAGS_enable_version_gc)) {
+      storage->set_write_retention(kMaxStaleReadDuration);
+    }
+    database->version_gc_ =
+        std::make_unique<VersionGarbageCollector>(storage.get(), clock);
+    database->storage_ = std::move(storage);
+  }
   database->lock_manager_ = std::make_unique<LockManager>(clock);
-  database->type_factory_ = std::make_unique<zetasql::TypeFactory>();
-  database->query_engine_ =
-      std::make_unique<QueryEngine>(database->type_factory_.get());
+  database->group_committer_ = std::make_unique<GroupCommitter>(
+      database->storage_.get(), database->lock_manager_.get());
+  database->change_stream_commit_notifier_ =
+      std::make_unique<ChangeStreamCommitNotifier>();
+  database->change_stream_log_ = std::make_unique<ChangeStreamLog>();
+  database->type_factory_ = std::make_shared<zetasql::TypeFactory>();
+  database->query_engine_ = std::make_unique<QueryEngine>(
+      database->type_factory_.get(), kDefaultAnalyzedQueryCacheCapacity,
+      config::query_result_cache_capacity());
+  Database* db = database.get();
+  database->query_engine_->SetSpannerSysStats({
+      .table_sizes = [db]() { return db->GetTableSizes(); },
+      .query_stats =
+          [db]() { return db->query_engine_->query_stats().Entries(); },
+      .transaction_stats = [db]() { return db->transaction_stats_.Entries(); },
+      .lock_stats = [db]() { return db->GetLockStats(); },
+  });
+  database->storage_memory_usage_ =
+      profiling::MemoryUsageRegistry::Global()->Register("storage", [db]() {
+        int64_t bytes = 0;
+        for (const auto& [table_id, size] : db->storage_->TableSizesInBytes()) {
+          bytes += size;
+        }
+        return bytes;
+      });
   database->action_manager_ = std::make_unique<ActionManager>();
-  database->dialect_ = schema_change_operation.database_dialect;
+  database->dialect_ = dialect;
   database->pg_oid_assigner_ = std::make_unique<PgOidAssigner>(
-      schema_change_operation.database_dialect ==
-      database_api::DatabaseDialect::POSTGRESQL);
+      dialect == database_api::DatabaseDialect::POSTGRESQL);
+  return database;
+}
+
+absl::StatusOr<std::unique_ptr<Database>> Database::Create(
+    Clock* clock, const SchemaChangeOperation& schema_change_operation) {
+  std::unique_ptr<Database> database =
+      CreateEmpty(clock, schema_change_operation.database_dialect);
 
   if (schema_change_operation.statements.empty()) {
     if (database->dialect_ == database_api::DatabaseDialect::POSTGRESQL) {
@@ -88,27 +161,164 @@ absl::StatusOr<std::unique_ptr<Database>> Database::Create(
         std::make_unique<VersionedCatalog>(std::move(schema));
   }
 
-  database->action_manager_->AddActionsForSchema(
-      database->versioned_catalog_->GetLatestSchema(),
-      database->query_engine_->function_catalog(),
-      database->query_engine_->type_factory());
+  database->InitializeForLatestSchema();
+  return database;
+}
+
+std::unique_ptr<Database> Database::CreateFromTemplate(
+    Clock* clock, std::shared_ptr<const SchemaTemplate> schema_template) {
+  std::unique_ptr<Database> database =
+      CreateEmpty(clock, schema_template->schema()->dialect());
+  database->table_id_generator_.AdvanceTo(
+      schema_template->next_table_id_seq());
+  database->column_id_generator_.AdvanceTo(
+      schema_template->next_column_id_seq());
+  database->versioned_catalog_ =
+      std::make_unique<VersionedCatalog>(schema_template->schema());
+  database->schema_template_ = std::move(schema_template);
+  database->InitializeForLatestSchema();
+  return database;
+}
+
+absl::StatusOr<std::unique_ptr<Database>> Database::Clone() {
+  if (dialect_ == database_api::DatabaseDialect::POSTGRESQL) {
+    return error::DatabaseCloneNotSupported("PostgreSQL dialect databases");
+  }
+  auto* storage = dynamic_cast<InMemoryStorage*>(storage_.get());
+  if (storage == nullptr) {
+    return error::DatabaseCloneNotSupported("databases with columnar storage");
+  }
+
+  // Make an exclusive lock request for the database, so that no commit is in
+  // progress while the storage is cloned.
+  ScopedSchemaChangeLock lock{transaction_id_generator_.NextId(),
+                              lock_manager_.get()};
+  ZETASQL_RETURN_IF_ERROR(lock.Wait());
+
+  std::shared_ptr<const Schema> schema =
+      versioned_catalog_->GetSharedLatestSchema();
+  // Sequence counters are kept in the schema, so they cannot be shared.
+  if (!schema->sequences().empty()) {
+    return error::DatabaseCloneNotSupported("databases with sequences");
+  }
+
+  std::unique_ptr<Database> clone =
+      CreateEmpty(clock_, dialect_, storage->Clone());
+  clone->table_id_generator_.AdvanceTo(table_id_generator_.next_seq());
+  clone->column_id_generator_.AdvanceTo(column_id_generator_.next_seq());
+  clone->change_stream_id_generator_.AdvanceTo(
+      change_stream_id_generator_.next_seq());
+  clone->schema_template_ = schema_template_;
+  clone->cloned_type_factories_ = cloned_type_factories_;
+  clone->cloned_type_factories_.push_back(type_factory_);
+  clone->versioned_catalog_ =
+      std::make_unique<VersionedCatalog>(std::move(schema));
+  clone->InitializeForLatestSchema();
+  return clone;
+}
+
+absl::Status Database::ResetToTimestamp(absl::Time timestamp) {
+  auto* storage = dynamic_cast<InMemoryStorage*>(storage_.get());
+  if (storage == nullptr) {
+    return error::DatabaseResetNotSupported("databases with columnar storage");
+  }
+  if (write_ahead_log_ != nullptr) {
+    return error::DatabaseResetNotSupported("durable databases");
+  }
+
+  // Make an exclusive lock request for the database, so that no commit is in
+  // progress while versions are discarded.
+  ScopedSchemaChangeLock lock{transaction_id_generator_.NextId(),
+                              lock_manager_.get()};
+  ZETASQL_RETURN_IF_ERROR(lock.Wait());
+
+  // Versions older than the stale read bound may have been garbage collected
+  // (see VersionGarbageCollector).
+  const absl::Time min_timestamp = clock_->Now() - kMaxStaleReadDuration;
+  if (timestamp < min_timestamp) {
+    return error::DatabaseResetTimestampTooOld(timestamp, min_timestamp);
+  }
+  if (versioned_catalog_->GetSchema(timestamp) != GetLatestSchema()) {
+    return error::DatabaseResetAcrossSchemaChange(timestamp);
+  }
+  storage->DiscardVersionsAfter(timestamp);
+  change_stream_log_->DiscardAfter(timestamp);
+  partition_token_cache_.Clear();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<absl::Time> Database::BulkImport(
+    std::vector<TableImport> imports) {
+  auto* storage = dynamic_cast<InMemoryStorage*>(storage_.get());
+  if (storage == nullptr) {
+    return error::BulkImportNotSupported("databases with columnar storage");
+  }
+  if (write_ahead_log_ != nullptr) {
+    return error::BulkImportNotSupported("durable databases");
+  }
+  tracing::ScopedSpan span("Database::BulkImport");
+
+  // Make an exclusive lock request for the database, so that no transaction
+  // observes a partially imported table.
+  ScopedSchemaChangeLock lock{transaction_id_generator_.NextId(),
+                              lock_manager_.get()};
+  ZETASQL_RETURN_IF_ERROR(lock.Wait());
+  ZETASQL_ASSIGN_OR_RETURN(absl::Time import_timestamp,
+                   lock.ReserveCommitTimestamp());
+
+  const Schema* schema = GetLatestSchema();
+  SchemaValidationContext context(storage, /*global_names=*/nullptr,
+                                  type_factory_.get(), import_timestamp,
+                                  dialect_);
+  context.SetOldSchemaSnapshot(schema);
+  context.SetValidatedNewSchemaSnapshot(schema);
+  absl::Status status = ImportTables(std::move(imports), &context);
+  if (!status.ok()) {
+    // Nothing else was committed at or after the import timestamp.
+    storage->DiscardVersionsAfter(import_timestamp - absl::Nanoseconds(1));
+    return status;
+  }
+  return import_timestamp;
+}
+
+bool Database::SupportsBulkImport() const {
+  return dynamic_cast<InMemoryStorage*>(storage_.get()) != nullptr &&
+         write_ahead_log_ == nullptr;
+}
+
+absl::StatusOr<absl::Time> Database::Export(const std::string& directory,
+                                            const ReadOnlyOptions& options) {
+  tracing::ScopedSpan span("Database::Export");
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<ReadOnlyTransaction> txn,
+                   CreateReadOnlyTransaction(options));
+  // Getting the schema waits for the commits in progress at the read timestamp
+  // of the transaction to finish, after which storage is safe to read.
+  const Schema* schema = txn->schema();
+  absl::Time read_timestamp = txn->read_timestamp();
+  ZETASQL_RETURN_IF_ERROR(
+      ExportTables(schema, storage_.get(), read_timestamp, directory));
+  return read_timestamp;
+}
 
-  database->change_stream_partition_churner_ =
+void Database::InitializeForLatestSchema() {
+  action_manager_->AddActionsForSchema(versioned_catalog_->GetLatestSchema(),
+                                       query_engine_->function_catalog(),
+                                       query_engine_->type_factory());
+
+  change_stream_partition_churner_ =
       std::make_unique<ChangeStreamPartitionChurner>(
-          absl::bind_front(&Database::CreateReadWriteTransaction,
-                           database.get()),
-          database->clock_);
+          absl::bind_front(&Database::CreateReadWriteTransaction, this),
+          clock_, &partition_token_cache_);
 
-  database->change_stream_partition_churner_->Update(
-      database->versioned_catalog_->GetLatestSchema());
+  change_stream_partition_churner_->Update(
+      versioned_catalog_->GetLatestSchema());
 
   // Some functions need to access the schema (e.g. sequence functions), so
   // set the latest schema to the function catalog here.
-  database->query_engine_->SetLatestSchemaForFunctionCatalog(
-      database->versioned_catalog_->GetLatestSchema());
-
-  return database;
+  query_engine_->SetLatestSchemaForFunctionCatalog(
+      versioned_catalog_->GetLatestSchema());
 }
+
 absl::StatusOr<std::unique_ptr<ReadOnlyTransaction>>
 Database::CreateReadOnlyTransaction(const ReadOnlyOptions& options) {
   return std::make_unique<ReadOnlyTransaction>(
@@ -122,7 +332,71 @@ Database::CreateReadWriteTransaction(const ReadWriteOptions& options,
   return std::make_unique<ReadWriteTransaction>(
       options, retry_state, transaction_id_generator_.NextId(), clock_,
       storage_.get(), lock_manager_.get(), versioned_catalog_.get(),
-      action_manager_.get());
+      action_manager_.get(), write_ahead_log_.get(),
+      change_stream_commit_notifier_.get(), change_stream_log_.get(),
+      group_committer_.get(), &transaction_stats_, &partition_token_cache_);
+}
+
+absl::StatusOr<QueryResult> Database::ExecutePartitionedDml(
+    const Query& query) {
+  const Schema* schema = GetLatestSchema();
+  ZETASQL_ASSIGN_OR_RETURN(std::string table_name,
+                   query_engine_->GetDmlTargetTable(query, schema));
+  const Table* table = schema->FindTable(table_name);
+  ZETASQL_RET_CHECK_NE(table, nullptr);
+  // The key ranges only need to cover the whole key space of the table, so
+  // rows committed after they are split are still modified by some key range.
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::vector<KeyRange> ranges,
+      SplitTableIntoKeyRanges(storage_.get(),
+                              lock_manager_->LastCommitTimestamp(), table->id(),
+                              config::partitioned_dml_rows_per_range()));
+
+  // Without concurrent read-write transactions, the transactions of the key
+  // ranges would abort each other.
+  const int max_threads = config::concurrent_read_write_transactions_enabled()
+                              ? config::partitioned_dml_threads()
+                              : 1;
+  std::vector<QueryResult> results(ranges.size());
+  ZETASQL_RETURN_IF_ERROR(ProcessKeyRanges(
+      ranges.size(), max_threads, [&](int i) -> absl::Status {
+        Query range_query = query;
+        range_query.partition = QueryPartition{.table_name = table_name,
+                                               .key_set = KeySet(ranges[i])};
+        RetryState retry_state;
+        while (true) {
+          ZETASQL_ASSIGN_OR_RETURN(
+              std::unique_ptr<ReadWriteTransaction> txn,
+              CreateReadWriteTransaction(ReadWriteOptions(), retry_state));
+          absl::StatusOr<QueryResult> result = query_engine_->ExecuteSql(
+              range_query,
+              QueryContext{.schema = txn->schema(),
+                           .reader = txn.get(),
+                           .writer = txn.get(),
+                           .commit_timestamp_tracker =
+                               txn->commit_timestamp_tracker(),
+                           .allow_read_write_only_functions = true});
+          absl::Status status = result.status();
+          if (status.ok()) {
+            status = txn->Commit();
+          }
+          if (status.ok()) {
+            results[i] = *std::move(result);
+            return absl::OkStatus();
+          }
+          if (!absl::IsAborted(status)) {
+            txn->Rollback().IgnoreError();
+            return status;
+          }
+          retry_state = txn->retry_state();
+        }
+      }));
+
+  QueryResult result = std::move(results.front());
+  for (size_t i = 1; i < results.size(); ++i) {
+    result.modified_row_count += results[i].modified_row_count;
+  }
+  return result;
 }
 
 SchemaChangeContext Database::GetSchemaChangeContext() {
@@ -142,6 +416,7 @@ absl::Status Database::UpdateSchema(
   if (schema_change_operation.statements.empty()) {
     return error::UpdateDatabaseMissingStatements();
   }
+  tracing::ScopedSpan span("Database::UpdateSchema");
 
   // Make an exclusive lock request for the database. If there are any
   // concurrent transactions it will be denied and the operation aborted.
@@ -174,6 +449,11 @@ absl::Status Database::UpdateSchema(
     action_manager_->AddActionsForSchema(versioned_catalog_->GetLatestSchema(),
                                          query_engine_->function_catalog(),
                                          query_engine_->type_factory());
+    if (write_ahead_log_ != nullptr) {
+      ZETASQL_RETURN_IF_ERROR(LogSchemaChange(schema_change_operation,
+                                      result.num_successful_statements,
+                                      update_timestamp));
+    }
   }
   change_stream_partition_churner_->Update(
       versioned_catalog_->GetLatestSchema());
@@ -186,10 +466,148 @@ absl::Status Database::UpdateSchema(
   return absl::OkStatus();
 }
 
+absl::Status Database::LogSchemaChange(
+    const SchemaChangeOperation& schema_change_operation,
+    int num_successful_statements, absl::Time timestamp) {
+  WalRecord record;
+  record.set_timestamp_micros(absl::ToUnixMicros(timestamp));
+  WalRecord::SchemaChange* schema_change = record.mutable_schema_change();
+  for (int i = 0; i < num_successful_statements; ++i) {
+    schema_change->add_statements(schema_change_operation.statements[i]);
+  }
+  schema_change->set_proto_descriptor_bytes(
+      std::string(schema_change_operation.proto_descriptor_bytes));
+  ZETASQL_ASSIGN_OR_RETURN(WriteAheadLog::Sequence sequence,
+                   write_ahead_log_->Append(record));
+  return write_ahead_log_->Sync(sequence);
+}
+
+absl::Status Database::ApplyWriteAheadLogRecord(const WalRecord& record) {
+  if (record.has_schema_change()) {
+    std::vector<std::string> statements(
+        record.schema_change().statements().begin(),
+        record.schema_change().statements().end());
+    int num_successful_statements;
+    absl::Time commit_timestamp;
+    absl::Status backfill_status;
+    ZETASQL_RETURN_IF_ERROR(UpdateSchema(
+        SchemaChangeOperation{
+            .statements = statements,
+            .proto_descriptor_bytes =
+                record.schema_change().proto_descriptor_bytes(),
+            .database_dialect = dialect_},
+        &num_successful_statements, &commit_timestamp, &backfill_status));
+    return backfill_status;
+  }
+
+  // The original commit timestamp may be older than data restored from a
+  // checkpoint, so the writes are re-applied at a new timestamp.
+  const absl::Time timestamp = clock_->Now();
+  const Schema* schema = GetLatestSchema();
+  for (const WalRecord::Write& write : record.commit().writes()) {
+    const Table* table = nullptr;
+    if (write.has_index_name()) {
+      const Index* index = schema->FindIndex(write.index_name());
+      table = index == nullptr ? nullptr : index->index_data_table();
+    } else {
+      table = schema->FindTable(write.table_name());
+    }
+    if (table == nullptr ||
+        write.key_size() > table->primary_key().size() ||
+        write.key_descending_size() != write.key_size() ||
+        write.key_nulls_last_size() != write.key_size()) {
+      return error::Internal(absl::StrCat(
+          "Write-ahead log write does not match the schema: ",
+          write.ShortDebugString()));
+    }
+
+    Key key;
+    for (int i = 0; i < write.key_size(); ++i) {
+      ZETASQL_ASSIGN_OR_RETURN(
+          zetasql::Value value,
+          zetasql::Value::Deserialize(
+              write.key(i), table->primary_key()[i]->column()->GetType()));
+      key.AddColumn(std::move(value), write.key_descending(i),
+                    write.key_nulls_last(i));
+    }
+    if (write.is_delete()) {
+      ZETASQL_RETURN_IF_ERROR(
+          storage_->Delete(timestamp, table->id(), KeyRange::Point(key)));
+      continue;
+    }
+
+    std::vector<ColumnID> column_ids;
+    ValueList values;
+    for (int i = 0; i < write.column_names_size(); ++i) {
+      const Column* column = table->FindColumn(write.column_names(i));
+      if (column == nullptr || i >= write.values_size()) {
+        return error::Internal(absl::StrCat(
+            "Write-ahead log write does not match the schema: ",
+            write.ShortDebugString()));
+      }
+      ZETASQL_ASSIGN_OR_RETURN(
+          zetasql::Value value,
+          zetasql::Value::Deserialize(write.values(i), column->GetType()));
+      column_ids.push_back(column->id());
+      values.push_back(std::move(value));
+    }
+    ZETASQL_RETURN_IF_ERROR(
+        storage_->Write(timestamp, table->id(), key, column_ids, values));
+  }
+  return absl::OkStatus();
+}
+
 const Schema* Database::GetLatestSchema() const {
   return versioned_catalog_->GetLatestSchema();
 }
 
+std::vector<TableSize> Database::GetTableSizes() const {
+  absl::flat_hash_map<TableID, int64_t> sizes = storage_->TableSizesInBytes();
+  auto size_of = [&sizes](const Table* table) -> int64_t {
+    auto itr = sizes.find(table->id());
+    return itr == sizes.end() ? 0 : itr->second;
+  };
+
+  std::vector<TableSize> table_sizes;
+  const Schema* schema = GetLatestSchema();
+  for (const Table* table : schema->tables()) {
+    table_sizes.push_back({table->Name(), size_of(table)});
+    for (const Index* index : table->indexes()) {
+      table_sizes.push_back(
+          {index->Name(), size_of(index->index_data_table())});
+    }
+  }
+  for (const ChangeStream* change_stream : schema->change_streams()) {
+    table_sizes.push_back(
+        {change_stream->Name(),
+         size_of(change_stream->change_stream_data_table()) +
+             size_of(change_stream->change_stream_partition_table())});
+  }
+  return table_sizes;
+}
+
+std::vector<IntervalEntry<LockStatsEntry>> Database::GetLockStats() const {
+  const Schema* schema = GetLatestSchema();
+  absl::flat_hash_map<TableID, std::string> names;
+  for (const Table* table : schema->tables()) {
+    names[table->id()] = table->Name();
+    for (const Index* index : table->indexes()) {
+      names[index->index_data_table()->id()] = index->Name();
+    }
+  }
+
+  std::vector<IntervalEntry<LockStatsEntry>> entries =
+      lock_manager_->lock_stats().Entries();
+  for (IntervalEntry<LockStatsEntry>& entry : entries) {
+    // Locks on tables dropped since are reported with the table id.
+    auto itr = names.find(entry.entry.table_id);
+    entry.entry.row_range_start_key =
+        absl::StrCat(itr == names.end() ? entry.entry.table_id : itr->second,
+                     entry.entry.row_range_start_key);
+  }
+  return entries;
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "google/spanner/admin/database/v1/common.pb.h"
@@ -30,18 +31,31 @@
 #include "absl/types/variant.h"
 #include "backend/actions/manager.h"
 #include "backend/common/ids.h"
+#include "backend/common/sys_stats.h"
+#include "backend/database/bulk_import.h"
+#include "backend/database/export.h"
 #include "backend/database/change_stream/change_stream_partition_churner.h"
 #include "backend/database/pg_oid_assigner/pg_oid_assigner.h"
+#include "backend/database/schema_template.h"
+#include "backend/database/version_gc/version_garbage_collector.h"
 #include "backend/locking/manager.h"
 #include "backend/query/query_engine.h"
+#include "backend/query/spanner_sys_catalog.h"
 #include "backend/schema/catalog/schema.h"
 #include "backend/schema/catalog/versioned_catalog.h"
 #include "backend/schema/updater/schema_updater.h"
+#include "backend/storage/in_memory_storage.h"
 #include "backend/storage/storage.h"
+#include "backend/storage/write_ahead_log.h"
+#include "backend/storage/write_ahead_log.pb.h"
+#include "backend/transaction/change_stream_commit_notifier.h"
+#include "backend/transaction/change_stream_log.h"
+#include "backend/transaction/group_committer.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/read_only_transaction.h"
 #include "backend/transaction/read_write_transaction.h"
 #include "common/clock.h"
+#include "common/profiling.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -63,6 +77,54 @@ class Database {
   static absl::StatusOr<std::unique_ptr<Database>> Create(
       Clock* clock, const SchemaChangeOperation& schema_change_operation);
 
+  // Constructs a fully initialized database whose initial schema is shared
+  // with all the other databases created from `schema_template`.
+  static std::unique_ptr<Database> CreateFromTemplate(
+      Clock* clock, std::shared_ptr<const SchemaTemplate> schema_template);
+
+  // Constructs a database with the latest schema and all the data of this
+  // database, which shares both with this database (see InMemoryStorage) so
+  // that cloning is cheap however large the database is. The clone is
+  // isolated from this database: later changes to either are not visible to
+  // the other.
+  //
+  // Like a schema change, cloning fails if transactions are in progress, so
+  // that the clone only sees complete commits. Commit history, change stream
+  // records and the write-ahead log are not cloned. PostgreSQL dialect
+  // databases, databases with sequences and databases using columnar storage
+  // cannot be cloned.
+  absl::StatusOr<std::unique_ptr<Database>> Clone();
+
+  // Resets the data of this database to its state as of `timestamp`, by
+  // discarding all the versions committed after it, so that tests can undo
+  // their changes to a shared database without recreating it.
+  //
+  // Like a schema change, resetting fails if transactions are in progress.
+  // `timestamp` must be within the version retention period, and the schema
+  // must not have changed since `timestamp`. Sequence counters are not reset.
+  // Durable databases and databases using columnar storage cannot be reset.
+  absl::Status ResetToTimestamp(absl::Time timestamp);
+
+  // Loads `imports` into the empty tables they name, at a single commit
+  // timestamp which is returned, through the bulk load path of storage rather
+  // than mutations (see ImportTables). Indexes and constraints are backfilled
+  // and verified in batch once all the rows are loaded.
+  //
+  // Like a schema change, importing fails if transactions are in progress. A
+  // failed import leaves no rows behind. Durable databases and databases using
+  // columnar storage cannot be imported into.
+  absl::StatusOr<absl::Time> BulkImport(std::vector<TableImport> imports);
+
+  // Returns true if BulkImport is supported by this database.
+  bool SupportsBulkImport() const;
+
+  // Exports every public table into `directory` (see ExportTables), as of the
+  // read timestamp of a read only transaction with `options`, which is
+  // returned. Tables are read straight from storage, in parallel key ranges.
+  absl::StatusOr<absl::Time> Export(
+      const std::string& directory,
+      const ReadOnlyOptions& options = ReadOnlyOptions());
+
   // Creates a read only transaction attached to this database.
   absl::StatusOr<std::unique_ptr<ReadOnlyTransaction>>
   CreateReadOnlyTransaction(const ReadOnlyOptions& options);
@@ -72,6 +134,17 @@ class Database {
   CreateReadWriteTransaction(const ReadWriteOptions& options,
                              const RetryState& retry_state);
 
+  // Executes a partitioned DML statement. The key space of the statement's
+  // target table is split into key ranges, and the statement is executed on the
+  // rows of each key range in a read-write transaction of its own, which is
+  // retried if it aborts. Key ranges are executed in parallel if concurrent
+  // read-write transactions are enabled.
+  //
+  // The key ranges which committed before a key range failed are not rolled
+  // back. On success, the modified row count of the result is the total
+  // number of rows modified by all the key ranges.
+  absl::StatusOr<QueryResult> ExecutePartitionedDml(const Query& query);
+
   // Updates the schema for this database.
   //
   // All schema changes are applied synchronously and transactionally.
@@ -109,6 +182,21 @@ class Database {
   // Retrives the current version of the schema.
   const Schema* GetLatestSchema() const;
 
+  // Returns the approximate memory used by each table, index and change
+  // stream of the latest schema, counting all the versions kept in storage.
+  // These are the sizes reported in SPANNER_SYS.TABLE_SIZES_STATS_1HOUR.
+  std::vector<TableSize> GetTableSizes() const;
+
+  // Returns the statistics of the lock conflicts in this database, with start
+  // keys prefixed by the name of their table or index. These are the entries
+  // reported in SPANNER_SYS.LOCK_STATS_TOP_MINUTE.
+  std::vector<IntervalEntry<LockStatsEntry>> GetLockStats() const;
+
+  // Returns the statistics of the commits of read-write transactions.
+  const TransactionStats& transaction_stats() const {
+    return transaction_stats_;
+  }
+
   // Used to execute queries against the database.
   QueryEngine* query_engine() { return query_engine_.get(); }
 
@@ -121,14 +209,56 @@ class Database {
 
   PgOidAssigner* get_pg_oid_assigner() { return pg_oid_assigner_.get(); }
 
+  // Makes all subsequent commits and schema changes durable by appending them
+  // to `write_ahead_log` before they are acknowledged. Must be called before
+  // the database is shared with concurrent users.
+  void AttachWriteAheadLog(std::unique_ptr<WriteAheadLog> write_ahead_log) {
+    write_ahead_log_ = std::move(write_ahead_log);
+  }
+
+  // Returns the attached write-ahead log, or null if there is none.
+  WriteAheadLog* write_ahead_log() { return write_ahead_log_.get(); }
+
+  // Returns the notifier of commits to the change streams of this database.
+  ChangeStreamCommitNotifier* change_stream_commit_notifier() {
+    return change_stream_commit_notifier_.get();
+  }
+
+  // Returns the log of the data change records committed to this database.
+  const ChangeStreamLog* change_stream_log() const {
+    return change_stream_log_.get();
+  }
+
+  // Re-applies a record read back from a write-ahead log. Commits are written
+  // directly to storage since they already include all their effects (e.g.
+  // index updates and cascading deletes). Only used to recover a database
+  // before it is shared with concurrent users.
+  absl::Status ApplyWriteAheadLogRecord(const WalRecord& record);
+
  private:
   Database();
   // Delete copy and assignment operators since database shouldn't be copyable.
   Database(const Database&) = delete;
   Database& operator=(const Database&) = delete;
 
+  // Constructs a database with all its subsystems but without a schema. If
+  // `storage` is null, the database starts with an empty storage.
+  static std::unique_ptr<Database> CreateEmpty(
+      Clock* clock, database_api::DatabaseDialect dialect,
+      std::unique_ptr<InMemoryStorage> storage = nullptr);
+
+  // Sets up the subsystems which depend on the schema once the initial schema
+  // has been added to the versioned catalog.
+  void InitializeForLatestSchema();
+
   SchemaChangeContext GetSchemaChangeContext();
 
+  // Appends the successfully applied statements of a schema change to the
+  // write-ahead log and waits for them to become durable.
+  absl::Status LogSchemaChange(
+      const SchemaChangeOperation& schema_change_operation,
+      int num_successful_statements, absl::Time timestamp);
+
   // Clock to provide commit timestamps.
   Clock* clock_;
 
@@ -147,11 +277,45 @@ class Database {
   // Underlying storage for the database.
   std::unique_ptr<Storage> storage_;
 
+  // Log to which commits and schema changes are appended, or null if the
+  // database is not durable. Declared before the change stream partition
+  // churner, whose transactions append to it.
+  std::unique_ptr<WriteAheadLog> write_ahead_log_;
+
   // Lock management.
   std::unique_ptr<LockManager> lock_manager_;
 
+  // Groups the commits of concurrent read-write transactions.
+  std::unique_ptr<GroupCommitter> group_committer_;
+
+  // Statistics of the commits of read-write transactions.
+  TransactionStats transaction_stats_;
+
+  // Active partition tokens of the change streams, which read-write
+  // transactions write their data change records to.
+  ActivePartitionTokenCache partition_token_cache_;
+
+  // Notified by read-write transactions which write to change streams.
+  // Declared before the change stream partition churner, whose transactions
+  // notify it.
+  std::unique_ptr<ChangeStreamCommitNotifier> change_stream_commit_notifier_;
+
+  // Data change records committed to the change streams of this database,
+  // ordered by commit timestamp. Appended to by read-write transactions.
+  std::unique_ptr<ChangeStreamLog> change_stream_log_;
+
+  // Template whose schema this database was created with, or null. Keeps
+  // the types of the shared schema alive. Declared before the versioned
+  // catalog so that it outlives it.
+  std::shared_ptr<const SchemaTemplate> schema_template_;
+
+  // Type factories of the databases this database was cloned from, which own
+  // the types of the schema shared with them. Declared before the versioned
+  // catalog so that they outlive it.
+  std::vector<std::shared_ptr<zetasql::TypeFactory>> cloned_type_factories_;
+
   // Type factory used for all ZetaSQL operations on this database.
-  std::unique_ptr<zetasql::TypeFactory> type_factory_;
+  std::shared_ptr<zetasql::TypeFactory> type_factory_;
 
   // Versioned catalog of this database.
   std::unique_ptr<VersionedCatalog> versioned_catalog_;
@@ -170,6 +334,17 @@ class Database {
 
   // Assigns OIDs to database objects when dialect is POSTGRESQL.
   std::unique_ptr<PgOidAssigner> pg_oid_assigner_;
+
+  // Removes storage versions which can no longer be read. Declared after
+  // storage_ so that it is destroyed (and its thread stopped) first. Null if
+  // the database uses ColumnarStorage.
+  std::unique_ptr<VersionGarbageCollector> version_gc_;
+
+  // Reports the memory used by the storage of this database in heap
+  // profiles. Declared last so that it is unregistered before the storage is
+  // destroyed.
+  std::unique_ptr<profiling::MemoryUsageRegistry::Registration>
+      storage_memory_usage_;
 };
 
 }  // namespace backend
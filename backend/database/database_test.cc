@@ -16,6 +16,7 @@
 
 #include "backend/database/database.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -27,12 +28,17 @@
 #include "tests/common/proto_matchers.h"
 #include "absl/status/status.h"
 #include "backend/access/read.h"
+#include "backend/database/bulk_import.h"
+#include "backend/database/schema_template.h"
 #include "backend/datamodel/key_set.h"
+#include "backend/query/query_engine.h"
+#include "backend/schema/catalog/table.h"
 #include "backend/schema/updater/schema_updater.h"
 #include "backend/transaction/options.h"
 #include "common/clock.h"
 #include "common/config.h"
 #include "common/errors.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
@@ -41,6 +47,7 @@ namespace backend {
 namespace {
 
 using zetasql::values::Int64;
+using zetasql::values::String;
 using zetasql_base::testing::StatusIs;
 
 class DatabaseTest : public ::testing::Test {
@@ -296,6 +303,356 @@ TEST_F(DatabaseTest, SchemaChangeLocksSuccesfullyReleased) {
   ZETASQL_EXPECT_OK(txn->Commit());
 }
 
+TEST_F(DatabaseTest, CreateFromTemplateSharesSchemaButNotData) {
+  std::vector<std::string> create_statements = {R"(
+    CREATE TABLE T(
+      k1 INT64,
+      k2 INT64,
+    ) PRIMARY KEY(k1)
+  )"};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const SchemaTemplate> schema_template,
+      SchemaTemplate::Create(
+          SchemaChangeOperation{.statements = create_statements}));
+  ASSERT_NE(schema_template, nullptr);
+  std::unique_ptr<Database> db1 =
+      Database::CreateFromTemplate(&clock_, schema_template);
+  std::unique_ptr<Database> db2 =
+      Database::CreateFromTemplate(&clock_, schema_template);
+  EXPECT_EQ(db1->GetLatestSchema(), db2->GetLatestSchema());
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ReadWriteTransaction> txn,
+      db1->CreateReadWriteTransaction(ReadWriteOptions(), RetryState()));
+  Mutation m;
+  m.AddWriteOp(MutationOpType::kInsert, "T", {"k1", "k2"},
+               {{Int64(1), Int64(2)}});
+  ZETASQL_ASSERT_OK(txn->Write(m));
+  ZETASQL_ASSERT_OK(txn->Commit());
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ReadOnlyTransaction> read_txn,
+                       db2->CreateReadOnlyTransaction(ReadOnlyOptions()));
+  std::unique_ptr<RowCursor> row_cursor;
+  ZETASQL_ASSERT_OK(read_txn->Read(read_column("T", "k1"), &row_cursor));
+  EXPECT_FALSE(row_cursor->Next());
+}
+
+TEST_F(DatabaseTest, CreateFromTemplateDoesNotReuseTableIds) {
+  std::vector<std::string> create_statements = {R"(
+    CREATE TABLE T(
+      k1 INT64,
+    ) PRIMARY KEY(k1)
+  )"};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const SchemaTemplate> schema_template,
+      SchemaTemplate::Create(
+          SchemaChangeOperation{.statements = create_statements}));
+  ASSERT_NE(schema_template, nullptr);
+  std::unique_ptr<Database> db =
+      Database::CreateFromTemplate(&clock_, schema_template);
+
+  std::vector<std::string> update_statements = {R"(
+    CREATE TABLE T1(
+      a INT64,
+    ) PRIMARY KEY(a)
+  )"};
+  absl::Status backfill_status;
+  int completed_statements;
+  absl::Time commit_ts;
+  ZETASQL_ASSERT_OK(
+      db->UpdateSchema(SchemaChangeOperation{.statements = update_statements},
+                       &completed_statements, &commit_ts, &backfill_status));
+  ZETASQL_ASSERT_OK(backfill_status);
+  const Schema* schema = db->GetLatestSchema();
+  EXPECT_NE(schema->FindTable("T")->id(), schema->FindTable("T1")->id());
+  EXPECT_NE(schema->FindTable("T")->FindColumn("k1")->id(),
+            schema->FindTable("T1")->FindColumn("a")->id());
+  EXPECT_EQ(schema_template->schema()->FindTable("T1"), nullptr);
+}
+
+TEST_F(DatabaseTest, ExecutePartitionedDmlModifiesRowsOfAllKeyRanges) {
+  std::vector<std::string> create_statements = {R"(
+    CREATE TABLE T(
+      k1 INT64,
+      k2 INT64,
+    ) PRIMARY KEY(k1)
+  )"};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Database> database,
+      Database::Create(&clock_,
+                       SchemaChangeOperation{.statements = create_statements}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ReadWriteTransaction> txn,
+      database->CreateReadWriteTransaction(ReadWriteOptions(), RetryState()));
+  Mutation m;
+  for (int i = 0; i < 10; ++i) {
+    m.AddWriteOp(MutationOpType::kInsert, "T", {"k1", "k2"},
+                 {{Int64(i), Int64(i)}});
+  }
+  ZETASQL_ASSERT_OK(txn->Write(m));
+  ZETASQL_ASSERT_OK(txn->Commit());
+
+  const bool concurrent = config::concurrent_read_write_transactions_enabled();
+  const int64_t rows_per_range = config::partitioned_dml_rows_per_range();
+  config::set_partitioned_dml_rows_per_range(3);
+  for (bool concurrent_read_write_transactions : {false, true}) {
+    config::set_concurrent_read_write_transactions_enabled(
+        concurrent_read_write_transactions);
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        QueryResult result,
+        database->ExecutePartitionedDml(
+            Query{.sql = "UPDATE T SET k2 = k2 + 1 WHERE k1 >= 2"}));
+    EXPECT_EQ(result.modified_row_count, 8);
+  }
+  config::set_partitioned_dml_rows_per_range(rows_per_range);
+  config::set_concurrent_read_write_transactions_enabled(concurrent);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ReadOnlyTransaction> read_txn,
+      database->CreateReadOnlyTransaction(ReadOnlyOptions()));
+  std::unique_ptr<RowCursor> row_cursor;
+  ZETASQL_ASSERT_OK(read_txn->Read(read_column("T", "k2"), &row_cursor));
+  std::vector<int64_t> values;
+  while (row_cursor->Next()) {
+    values.push_back(row_cursor->ColumnValue(0).int64_value());
+  }
+  ZETASQL_ASSERT_OK(row_cursor->Status());
+  EXPECT_THAT(values, testing::ElementsAre(0, 1, 4, 5, 6, 7, 8, 9, 10, 11));
+}
+
+TEST_F(DatabaseTest, SchemaWithSequencesHasNoTemplate) {
+  std::vector<std::string> create_statements = {R"(
+    CREATE SEQUENCE seq OPTIONS (sequence_kind = 'bit_reversed_positive')
+  )"};
+  EXPECT_THAT(SchemaTemplate::Create(
+                  SchemaChangeOperation{.statements = create_statements}),
+              zetasql_base::testing::IsOkAndHolds(nullptr));
+}
+
+TEST_F(DatabaseTest, CloneSharesSchemaAndDataButNotLaterWrites) {
+  std::vector<std::string> create_statements = {R"(
+    CREATE TABLE T(
+      k1 INT64,
+    ) PRIMARY KEY(k1)
+  )"};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Database> db,
+      Database::Create(&clock_,
+                       SchemaChangeOperation{.statements = create_statements}));
+  auto insert = [](Database* db, int64_t k1) -> absl::Status {
+    ZETASQL_ASSIGN_OR_RETURN(
+        std::unique_ptr<ReadWriteTransaction> txn,
+        db->CreateReadWriteTransaction(ReadWriteOptions(), RetryState()));
+    Mutation m;
+    m.AddWriteOp(MutationOpType::kInsert, "T", {"k1"}, {{Int64(k1)}});
+    ZETASQL_RETURN_IF_ERROR(txn->Write(m));
+    return txn->Commit();
+  };
+  auto read_keys = [this](Database* db) -> std::vector<int64_t> {
+    std::vector<int64_t> keys;
+    auto read_txn = db->CreateReadOnlyTransaction(ReadOnlyOptions());
+    std::unique_ptr<RowCursor> row_cursor;
+    if (!read_txn.ok() ||
+        !(*read_txn)->Read(read_column("T", "k1"), &row_cursor).ok()) {
+      return keys;
+    }
+    while (row_cursor->Next()) {
+      keys.push_back(row_cursor->ColumnValue(0).int64_value());
+    }
+    return keys;
+  };
+  ZETASQL_ASSERT_OK(insert(db.get(), 1));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Database> clone, db->Clone());
+  EXPECT_EQ(clone->GetLatestSchema(), db->GetLatestSchema());
+  EXPECT_THAT(read_keys(clone.get()), testing::ElementsAre(1));
+
+  ZETASQL_ASSERT_OK(insert(db.get(), 2));
+  ZETASQL_ASSERT_OK(insert(clone.get(), 3));
+  EXPECT_THAT(read_keys(db.get()), testing::ElementsAre(1, 2));
+  EXPECT_THAT(read_keys(clone.get()), testing::ElementsAre(1, 3));
+
+  // The clone remains usable once the original database is gone.
+  db.reset();
+  EXPECT_THAT(read_keys(clone.get()), testing::ElementsAre(1, 3));
+}
+
+TEST_F(DatabaseTest, CloneOfDatabaseWithSequencesIsNotSupported) {
+  std::vector<std::string> create_statements = {R"(
+    CREATE SEQUENCE seq OPTIONS (sequence_kind = 'bit_reversed_positive')
+  )"};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Database> db,
+      Database::Create(&clock_,
+                       SchemaChangeOperation{.statements = create_statements}));
+  EXPECT_THAT(db->Clone(), StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+TEST_F(DatabaseTest, ResetToTimestampDiscardsLaterCommits) {
+  std::vector<std::string> create_statements = {R"(
+    CREATE TABLE T(
+      k1 INT64,
+    ) PRIMARY KEY(k1)
+  )"};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Database> db,
+      Database::Create(&clock_,
+                       SchemaChangeOperation{.statements = create_statements}));
+  auto mutate = [&db](MutationOpType type, int64_t k1) -> absl::Status {
+    ZETASQL_ASSIGN_OR_RETURN(
+        std::unique_ptr<ReadWriteTransaction> txn,
+        db->CreateReadWriteTransaction(ReadWriteOptions(), RetryState()));
+    Mutation m;
+    if (type == MutationOpType::kDelete) {
+      m.AddDeleteOp("T", KeySet(Key({Int64(k1)})));
+    } else {
+      m.AddWriteOp(type, "T", {"k1"}, {{Int64(k1)}});
+    }
+    ZETASQL_RETURN_IF_ERROR(txn->Write(m));
+    return txn->Commit();
+  };
+  auto read_keys = [this, &db]() -> std::vector<int64_t> {
+    std::vector<int64_t> keys;
+    auto read_txn = db->CreateReadOnlyTransaction(ReadOnlyOptions());
+    std::unique_ptr<RowCursor> row_cursor;
+    if (!read_txn.ok() ||
+        !(*read_txn)->Read(read_column("T", "k1"), &row_cursor).ok()) {
+      return keys;
+    }
+    while (row_cursor->Next()) {
+      keys.push_back(row_cursor->ColumnValue(0).int64_value());
+    }
+    return keys;
+  };
+  ZETASQL_ASSERT_OK(mutate(MutationOpType::kInsert, 1));
+  ZETASQL_ASSERT_OK(mutate(MutationOpType::kInsert, 2));
+  absl::Time reset_timestamp = clock_.Now();
+
+  ZETASQL_ASSERT_OK(mutate(MutationOpType::kInsert, 3));
+  ZETASQL_ASSERT_OK(mutate(MutationOpType::kDelete, 1));
+  EXPECT_THAT(read_keys(), testing::ElementsAre(2, 3));
+
+  ZETASQL_ASSERT_OK(db->ResetToTimestamp(reset_timestamp));
+  EXPECT_THAT(read_keys(), testing::ElementsAre(1, 2));
+
+  // The database accepts new commits after the reset.
+  ZETASQL_ASSERT_OK(mutate(MutationOpType::kInsert, 3));
+  EXPECT_THAT(read_keys(), testing::ElementsAre(1, 2, 3));
+
+  EXPECT_THAT(db->ResetToTimestamp(clock_.Now() - absl::Hours(2)),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(DatabaseTest, ResetToTimestampBeforeSchemaChangeIsRejected) {
+  std::vector<std::string> create_statements = {R"(
+    CREATE TABLE T(
+      k1 INT64,
+    ) PRIMARY KEY(k1)
+  )"};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Database> db,
+      Database::Create(&clock_,
+                       SchemaChangeOperation{.statements = create_statements}));
+  absl::Time reset_timestamp = clock_.Now();
+  absl::Status backfill_status;
+  int completed_statements;
+  absl::Time commit_ts;
+  ZETASQL_ASSERT_OK(db->UpdateSchema(
+      SchemaChangeOperation{.statements = {"CREATE INDEX I ON T(k1)"}},
+      &completed_statements, &commit_ts, &backfill_status));
+  ZETASQL_ASSERT_OK(backfill_status);
+  EXPECT_THAT(db->ResetToTimestamp(reset_timestamp),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(DatabaseTest, BulkImportLoadsTablesAndIndexes) {
+  std::vector<std::string> create_statements = {R"(
+    CREATE TABLE P(
+      k1 INT64,
+      v STRING(MAX) NOT NULL,
+    ) PRIMARY KEY(k1)
+  )",
+                                                R"(
+    CREATE TABLE C(
+      k1 INT64,
+      k2 INT64,
+    ) PRIMARY KEY(k1, k2),
+      INTERLEAVE IN PARENT P
+  )",
+                                                "CREATE INDEX I ON P(v)"};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Database> db,
+      Database::Create(&clock_,
+                       SchemaChangeOperation{.statements = create_statements}));
+  const Table* parent = db->GetLatestSchema()->FindTable("P");
+  const Table* child = db->GetLatestSchema()->FindTable("C");
+  auto parent_import = [parent](std::vector<ValueList> rows) {
+    return TableImport{
+        .table = parent,
+        .columns = {parent->FindColumn("k1"), parent->FindColumn("v")},
+        .rows = std::move(rows)};
+  };
+  auto child_import = [child](std::vector<ValueList> rows) {
+    return TableImport{
+        .table = child,
+        .columns = {child->FindColumn("k1"), child->FindColumn("k2")},
+        .rows = std::move(rows)};
+  };
+  auto read_values = [this, &db](std::string table, std::string column,
+                                 std::string index) {
+    std::vector<zetasql::Value> values;
+    auto read_txn = db->CreateReadOnlyTransaction(ReadOnlyOptions());
+    ReadArg args = read_column(table, column);
+    args.index = index;
+    std::unique_ptr<RowCursor> row_cursor;
+    if (!read_txn.ok() || !(*read_txn)->Read(args, &row_cursor).ok()) {
+      return values;
+    }
+    while (row_cursor->Next()) {
+      values.push_back(row_cursor->ColumnValue(0));
+    }
+    return values;
+  };
+
+  // Child rows without a parent row, duplicate keys and NULLs in NOT NULL
+  // columns fail the import, which then leaves no rows behind.
+  std::vector<TableImport> orphan;
+  orphan.push_back(parent_import({{Int64(1), String("b")}}));
+  orphan.push_back(child_import({{Int64(2), Int64(1)}}));
+  EXPECT_THAT(db->BulkImport(std::move(orphan)),
+              StatusIs(absl::StatusCode::kNotFound));
+  std::vector<TableImport> duplicate;
+  duplicate.push_back(
+      parent_import({{Int64(1), String("b")}, {Int64(1), String("a")}}));
+  EXPECT_THAT(db->BulkImport(std::move(duplicate)),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+  std::vector<TableImport> null_value;
+  null_value.push_back(
+      parent_import({{Int64(1), zetasql::values::NullString()}}));
+  EXPECT_THAT(db->BulkImport(std::move(null_value)),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_THAT(read_values("P", "k1", ""), testing::IsEmpty());
+
+  std::vector<TableImport> imports;
+  imports.push_back(parent_import({{Int64(2), String("a")},
+                                   {Int64(3), String("c")},
+                                   {Int64(1), String("b")}}));
+  imports.push_back(child_import({{Int64(3), Int64(1)}, {Int64(1), Int64(1)}}));
+  ZETASQL_ASSERT_OK(db->BulkImport(std::move(imports)).status());
+  EXPECT_THAT(read_values("P", "k1", ""),
+              testing::ElementsAre(Int64(1), Int64(2), Int64(3)));
+  EXPECT_THAT(read_values("P", "k1", "I"),
+              testing::ElementsAre(Int64(2), Int64(1), Int64(3)));
+  EXPECT_THAT(read_values("C", "k1", ""),
+              testing::ElementsAre(Int64(1), Int64(3)));
+
+  // Only empty tables can be imported into.
+  std::vector<TableImport> non_empty;
+  non_empty.push_back(parent_import({{Int64(4), String("d")}}));
+  EXPECT_THAT(db->BulkImport(std::move(non_empty)),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
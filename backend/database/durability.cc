@@ -0,0 +1,206 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/durability.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <system_error>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "zetasql/base/logging.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/database/database.h"
+#include "backend/database/snapshot.h"
+#include "backend/storage/write_ahead_log.h"
+#include "backend/storage/write_ahead_log.pb.h"
+#include "common/clock.h"
+#include "common/errors.h"
+#include "zetasql/base/status_macros.h"
+
+ABSL_FLAG(absl::Duration, wal_checkpoint_interval, absl::Seconds(30),
+          "How often to check whether a durable database should write a new "
+          "checkpoint.");
+
+ABSL_FLAG(int64_t, wal_checkpoint_bytes, 64 << 20,
+          "Size in bytes the write-ahead log of a durable database must grow "
+          "to before a new checkpoint is written.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+std::string CheckpointPath(const std::string& dir) {
+  return absl::StrCat(dir, "/checkpoint.snapshot");
+}
+
+// Flushes the contents of the file or directory at `path` to disk.
+absl::Status SyncPath(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return error::WriteAheadLogIOError(path, "open", errno);
+  }
+  absl::Status status;
+  if (fsync(fd) != 0) {
+    status = error::WriteAheadLogIOError(path, "sync", errno);
+  }
+  close(fd);
+  return status;
+}
+
+}  // namespace
+
+bool IsDurableDatabaseDir(const std::string& dir) {
+  std::error_code ec;
+  return std::filesystem::exists(CheckpointPath(dir), ec);
+}
+
+absl::Status EnableDurability(Database* database, const std::string& dir) {
+  if (database->write_ahead_log() != nullptr || IsDurableDatabaseDir(dir)) {
+    return error::DurableDatabaseDirectoryInUse(dir);
+  }
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<WriteAheadLog> write_ahead_log,
+                   WriteAheadLog::Open(dir));
+  database->AttachWriteAheadLog(std::move(write_ahead_log));
+  absl::Status status = CheckpointDatabase(database, dir);
+  if (!status.ok()) {
+    // Without an initial checkpoint the log cannot be recovered, so don't keep
+    // it around.
+    database->AttachWriteAheadLog(nullptr);
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+  }
+  return status;
+}
+
+absl::Status CheckpointDatabase(Database* database, const std::string& dir) {
+  WriteAheadLog* write_ahead_log = database->write_ahead_log();
+  if (write_ahead_log == nullptr) {
+    return error::DatabaseNotDurable();
+  }
+
+  // Every commit which is not visible to the snapshot below lands in the new
+  // segment, so the segments before it are redundant once the checkpoint is
+  // in place.
+  ZETASQL_RETURN_IF_ERROR(write_ahead_log->Rotate());
+  std::string checkpoint_path = CheckpointPath(dir);
+  std::string temp_path = absl::StrCat(checkpoint_path, ".tmp");
+  ZETASQL_RETURN_IF_ERROR(WriteDatabaseSnapshotToFile(database, temp_path));
+  ZETASQL_RETURN_IF_ERROR(SyncPath(temp_path));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, checkpoint_path, ec);
+  if (ec) {
+    return error::WriteAheadLogIOError(checkpoint_path, "rename", ec.value());
+  }
+  ZETASQL_RETURN_IF_ERROR(SyncPath(dir));
+  return write_ahead_log->RemoveSegmentsBeforeCurrent();
+}
+
+absl::StatusOr<std::unique_ptr<Database>> RecoverDatabase(
+    Clock* clock, const std::string& dir) {
+  absl::Time checkpoint_timestamp;
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<Database> database,
+                   RestoreDatabaseSnapshotFromFile(
+                       clock, CheckpointPath(dir), &checkpoint_timestamp));
+
+  // Segments written before the checkpoint was renamed into place may still
+  // be around if removing them was interrupted; their records are already
+  // reflected in the checkpoint.
+  int64_t num_replayed = 0;
+  ZETASQL_RETURN_IF_ERROR(
+      WriteAheadLog::Replay(dir, [&](const WalRecord& record) -> absl::Status {
+        if (absl::FromUnixMicros(record.timestamp_micros()) <=
+            checkpoint_timestamp) {
+          return absl::OkStatus();
+        }
+        ++num_replayed;
+        return database->ApplyWriteAheadLogRecord(record);
+      }));
+  ZETASQL_VLOG(1) << "Recovered database in " << dir << " replaying "
+          << num_replayed << " write-ahead log records.";
+
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<WriteAheadLog> write_ahead_log,
+                   WriteAheadLog::Open(dir));
+  database->AttachWriteAheadLog(std::move(write_ahead_log));
+  return database;
+}
+
+DatabaseCheckpointer::DatabaseCheckpointer(Database* database, std::string dir)
+    : database_(database), dir_(std::move(dir)) {
+  thread_ = std::thread(&DatabaseCheckpointer::PeriodicCheckpoint, this);
+}
+
+DatabaseCheckpointer::~DatabaseCheckpointer() {
+  {
+    absl::MutexLock lock(&mu_);
+    stop_thread_ = true;
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+absl::Status DatabaseCheckpointer::MaybeCheckpoint() {
+  WriteAheadLog* write_ahead_log = database_->write_ahead_log();
+  if (write_ahead_log == nullptr) {
+    return error::DatabaseNotDurable();
+  }
+  if (write_ahead_log->bytes_since_rotation() <
+      absl::GetFlag(FLAGS_wal_checkpoint_bytes)) {
+    return absl::OkStatus();
+  }
+  // Serializes checkpoints requested directly with those of the background
+  // thread.
+  absl::MutexLock lock(&mu_);
+  return CheckpointDatabase(database_, dir_);
+}
+
+void DatabaseCheckpointer::PeriodicCheckpoint() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.AwaitWithTimeout(absl::Condition(&stop_thread_),
+                           absl::GetFlag(FLAGS_wal_checkpoint_interval));
+      if (stop_thread_) {
+        return;
+      }
+    }
+    absl::Status status = MaybeCheckpoint();
+    if (!status.ok()) {
+      ABSL_LOG(WARNING) << "Failed to checkpoint database in " << dir_ << ": "
+                        << status;
+    }
+  }
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
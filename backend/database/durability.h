@@ -0,0 +1,112 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_DURABILITY_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_DURABILITY_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/declare.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/database/database.h"
+#include "common/clock.h"
+
+// How often to check whether a durable database should be checkpointed.
+ABSL_DECLARE_FLAG(absl::Duration, wal_checkpoint_interval);
+
+// Size the write-ahead log of a durable database must reach before a new
+// checkpoint is written.
+ABSL_DECLARE_FLAG(int64_t, wal_checkpoint_bytes);
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// A durable database keeps its state in a directory holding a checkpoint and
+// a write-ahead log. The checkpoint is a database snapshot (see snapshot.h)
+// taken at some read timestamp, and the log holds every schema change and
+// commit made since the log was last rotated. Recovery restores the checkpoint
+// and replays the log records which are newer than the checkpoint.
+//
+// A checkpoint is written by rotating the log, snapshotting the database into
+// a temporary file which is then renamed over the previous checkpoint, and
+// finally removing the log segments which precede the rotation. A crash at
+// any point leaves either the old or the new checkpoint in place together
+// with all log records needed to roll it forward.
+
+// Makes `database` durable in `dir`: attaches a write-ahead log to it and
+// writes its initial checkpoint. `dir` must not hold a durable database yet.
+// Must be called before the database is shared with concurrent users. Fails
+// with UNIMPLEMENTED for databases which cannot be snapshotted, in which case
+// the database is left as it was.
+absl::Status EnableDurability(Database* database, const std::string& dir);
+
+// Writes a new checkpoint of the durable `database` into `dir` and removes the
+// write-ahead log segments which it makes redundant.
+absl::Status CheckpointDatabase(Database* database, const std::string& dir);
+
+// Recovers the durable database stored in `dir`. Subsequent changes to the
+// recovered database are logged to `dir`.
+absl::StatusOr<std::unique_ptr<Database>> RecoverDatabase(
+    Clock* clock, const std::string& dir);
+
+// Returns true if `dir` holds a durable database.
+bool IsDurableDatabaseDir(const std::string& dir);
+
+// DatabaseCheckpointer checkpoints a durable database in the background once
+// its write-ahead log has grown past --wal_checkpoint_bytes, which bounds both
+// the disk space used by the log and the time spent replaying it on recovery.
+//
+// The background thread is owned by this class and is stopped when this object
+// is destroyed. `database` must outlive this object.
+class DatabaseCheckpointer {
+ public:
+  DatabaseCheckpointer(Database* database, std::string dir);
+  ~DatabaseCheckpointer();
+
+  // Writes a checkpoint if the write-ahead log has grown large enough.
+  absl::Status MaybeCheckpoint() ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  void PeriodicCheckpoint() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // The durable database and the directory it is stored in.
+  Database* database_;
+  const std::string dir_;
+
+  absl::Mutex mu_;
+
+  // Set when the background thread should exit.
+  bool stop_thread_ ABSL_GUARDED_BY(mu_) = false;
+
+  // The background checkpointing thread.
+  std::thread thread_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_DURABILITY_H_
@@ -0,0 +1,199 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/durability.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "backend/access/read.h"
+#include "backend/access/write.h"
+#include "backend/database/database.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/datamodel/value.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "backend/transaction/options.h"
+#include "common/clock.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using testing::ElementsAre;
+using zetasql::values::Int64;
+using zetasql::values::String;
+using zetasql_base::testing::IsOkAndHolds;
+using zetasql_base::testing::StatusIs;
+
+class DurabilityTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = absl::StrCat(
+        testing::TempDir(), "/",
+        testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::filesystem::remove_all(dir_);
+
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        database_,
+        Database::Create(&clock_,
+                         SchemaChangeOperation{.statements = {R"(
+                           CREATE TABLE Singers(
+                             SingerId INT64 NOT NULL,
+                             Name STRING(MAX),
+                           ) PRIMARY KEY(SingerId)
+                         )"}}));
+    ZETASQL_ASSERT_OK(EnableDurability(database_.get(), dir_));
+  }
+
+  absl::Status InsertSinger(Database* database, int64_t id,
+                            const std::string& name) {
+    Mutation m;
+    m.AddWriteOp(MutationOpType::kInsert, "Singers", {"SingerId", "Name"},
+                 {{Int64(id), String(name)}});
+    ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<ReadWriteTransaction> txn,
+                     database->CreateReadWriteTransaction(ReadWriteOptions(),
+                                                          RetryState()));
+    ZETASQL_RETURN_IF_ERROR(txn->Write(m));
+    return txn->Commit();
+  }
+
+  absl::StatusOr<std::vector<ValueList>> ReadAll(
+      Database* database, const std::string& table,
+      const std::vector<std::string>& columns, const std::string& index = "") {
+    ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<ReadOnlyTransaction> txn,
+                     database->CreateReadOnlyTransaction(ReadOnlyOptions()));
+    ReadArg read_arg;
+    read_arg.table = table;
+    read_arg.index = index;
+    read_arg.key_set = KeySet::All();
+    read_arg.columns = columns;
+    std::unique_ptr<RowCursor> cursor;
+    ZETASQL_RETURN_IF_ERROR(txn->Read(read_arg, &cursor));
+    std::vector<ValueList> rows;
+    while (cursor->Next()) {
+      rows.emplace_back();
+      for (int i = 0; i < cursor->NumColumns(); ++i) {
+        rows.back().push_back(cursor->ColumnValue(i));
+      }
+    }
+    ZETASQL_RETURN_IF_ERROR(cursor->Status());
+    return rows;
+  }
+
+  Clock clock_;
+  std::string dir_;
+  std::unique_ptr<Database> database_;
+};
+
+TEST_F(DurabilityTest, RecoversCommitsFromWriteAheadLog) {
+  ZETASQL_ASSERT_OK(InsertSinger(database_.get(), 1, "Marc"));
+  ZETASQL_ASSERT_OK(InsertSinger(database_.get(), 2, "Catalina"));
+  database_.reset();
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Database> recovered,
+                       RecoverDatabase(&clock_, dir_));
+  EXPECT_THAT(ReadAll(recovered.get(), "Singers", {"SingerId", "Name"}),
+              IsOkAndHolds(ElementsAre(
+                  ValueList{Int64(1), String("Marc")},
+                  ValueList{Int64(2), String("Catalina")})));
+}
+
+TEST_F(DurabilityTest, RecoversSchemaChangesAndIndexes) {
+  ZETASQL_ASSERT_OK(InsertSinger(database_.get(), 1, "Marc"));
+  std::vector<absl::Status> statement_statuses;
+  int num_succesful;
+  absl::Time commit_ts;
+  absl::Status backfill_status;
+  ZETASQL_ASSERT_OK(database_->UpdateSchema(
+      SchemaChangeOperation{
+          .statements = {"CREATE INDEX SingersByName ON Singers(Name)"}},
+      &num_succesful, &commit_ts, &backfill_status));
+  ZETASQL_ASSERT_OK(backfill_status);
+  ZETASQL_ASSERT_OK(InsertSinger(database_.get(), 2, "Catalina"));
+  database_.reset();
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Database> recovered,
+                       RecoverDatabase(&clock_, dir_));
+  EXPECT_THAT(
+      ReadAll(recovered.get(), "Singers", {"SingerId", "Name"},
+              "SingersByName"),
+      IsOkAndHolds(ElementsAre(
+          ValueList{Int64(2), String("Catalina")},
+          ValueList{Int64(1), String("Marc")})));
+}
+
+TEST_F(DurabilityTest, RecoversFromCheckpointAndLogTail) {
+  ZETASQL_ASSERT_OK(InsertSinger(database_.get(), 1, "Marc"));
+  ZETASQL_ASSERT_OK(CheckpointDatabase(database_.get(), dir_));
+  ZETASQL_ASSERT_OK(InsertSinger(database_.get(), 2, "Catalina"));
+  database_.reset();
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Database> recovered,
+                       RecoverDatabase(&clock_, dir_));
+  EXPECT_THAT(ReadAll(recovered.get(), "Singers", {"SingerId", "Name"}),
+              IsOkAndHolds(ElementsAre(
+                  ValueList{Int64(1), String("Marc")},
+                  ValueList{Int64(2), String("Catalina")})));
+
+  // The recovered database keeps logging, so it can be recovered again.
+  ZETASQL_ASSERT_OK(InsertSinger(recovered.get(), 3, "Lea"));
+  recovered.reset();
+  ZETASQL_ASSERT_OK_AND_ASSIGN(recovered, RecoverDatabase(&clock_, dir_));
+  EXPECT_THAT(ReadAll(recovered.get(), "Singers", {"SingerId"}),
+              IsOkAndHolds(ElementsAre(
+                  ValueList{Int64(1)}, ValueList{Int64(2)},
+                  ValueList{Int64(3)})));
+}
+
+TEST_F(DurabilityTest, CheckpointerWaitsForLogToGrow) {
+  absl::SetFlag(&FLAGS_wal_checkpoint_bytes, 1 << 20);
+  DatabaseCheckpointer checkpointer(database_.get(), dir_);
+  ZETASQL_ASSERT_OK(InsertSinger(database_.get(), 1, "Marc"));
+  int64_t bytes = database_->write_ahead_log()->bytes_since_rotation();
+  EXPECT_GT(bytes, 0);
+  ZETASQL_ASSERT_OK(checkpointer.MaybeCheckpoint());
+  EXPECT_EQ(database_->write_ahead_log()->bytes_since_rotation(), bytes);
+
+  absl::SetFlag(&FLAGS_wal_checkpoint_bytes, 0);
+  ZETASQL_ASSERT_OK(checkpointer.MaybeCheckpoint());
+  EXPECT_EQ(database_->write_ahead_log()->bytes_since_rotation(), 0);
+  absl::SetFlag(&FLAGS_wal_checkpoint_bytes, 64 << 20);
+}
+
+TEST_F(DurabilityTest, RejectsDirectoryOfAnotherDatabase) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Database> other,
+      Database::Create(&clock_, SchemaChangeOperation{}));
+  EXPECT_THAT(EnableDurability(other.get(), dir_),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
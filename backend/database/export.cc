@@ -0,0 +1,223 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/export.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <system_error>  // NOLINT
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "backend/database/export.pb.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/schema/printer/print_ddl.h"
+#include "backend/schema/updater/parallel_scan.h"
+#include "backend/storage/iterator.h"
+#include "common/errors.h"
+#include "google/protobuf/text_format.h"
+#include "google/protobuf/util/delimited_message_util.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Name of the manifest file of an export.
+constexpr char kManifestFileName[] = "manifest";
+
+// Maximum number of rows in a row group. Bounds the memory used to buffer the
+// rows of a key range before they are written.
+constexpr int kMaxRowsPerRowGroup = 1024;
+
+// A key range of a table which is exported into its own data file.
+struct ExportPartition {
+  const Table* table;
+  std::vector<ColumnID> column_ids;
+  KeyRange key_range;
+  std::string data_file;
+  int64_t row_count = 0;
+};
+
+absl::Status WriteRowGroup(const ExportRowGroup& row_group,
+                           const std::string& path, std::ostream* out) {
+  if (!google::protobuf::util::SerializeDelimitedToOstream(row_group, out)) {
+    return error::Internal(
+        absl::StrCat("Failed to write database export file ", path));
+  }
+  return absl::OkStatus();
+}
+
+// Writes the rows of `partition` into its data file in `directory`.
+absl::Status ExportPartitionRows(const Storage* storage, absl::Time timestamp,
+                                 const std::string& directory,
+                                 ExportPartition* partition) {
+  const std::string path = absl::StrCat(directory, "/", partition->data_file);
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    return error::Internal(
+        absl::StrCat("Failed to open database export file ", path));
+  }
+  std::unique_ptr<StorageIterator> itr;
+  ZETASQL_RETURN_IF_ERROR(storage->Read(timestamp, partition->table->id(),
+                                partition->key_range, partition->column_ids,
+                                &itr));
+  ExportRowGroup row_group;
+  for (int i = 0; i < partition->column_ids.size(); ++i) {
+    row_group.add_columns();
+  }
+  int rows_in_group = 0;
+  while (itr->Next()) {
+    for (int i = 0; i < itr->NumColumns(); ++i) {
+      ZETASQL_RETURN_IF_ERROR(itr->ColumnValue(i).Serialize(
+          row_group.mutable_columns(i)->add_values()));
+    }
+    ++partition->row_count;
+    if (++rows_in_group == kMaxRowsPerRowGroup) {
+      ZETASQL_RETURN_IF_ERROR(WriteRowGroup(row_group, path, &out));
+      for (ExportRowGroup::Column& column : *row_group.mutable_columns()) {
+        column.clear_values();
+      }
+      rows_in_group = 0;
+    }
+  }
+  ZETASQL_RETURN_IF_ERROR(itr->Status());
+  if (rows_in_group > 0) {
+    ZETASQL_RETURN_IF_ERROR(WriteRowGroup(row_group, path, &out));
+  }
+  out.flush();
+  if (!out.good()) {
+    return error::Internal(
+        absl::StrCat("Failed to write database export file ", path));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status ExportTables(const Schema* schema, const Storage* storage,
+                          absl::Time timestamp, const std::string& directory) {
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+  if (ec) {
+    return error::Internal(absl::StrCat(
+        "Failed to create database export directory ", directory, ": ",
+        ec.message()));
+  }
+
+  ExportManifest manifest;
+  manifest.set_read_timestamp_micros(absl::ToUnixMicros(timestamp));
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::shared_ptr<const std::vector<std::string>> statements,
+      GetDDLStatements(schema));
+  for (const std::string& statement : *statements) {
+    manifest.add_ddl_statements(statement);
+  }
+
+  // The partitions of all the tables are exported together, so that small
+  // tables do not leave threads idle.
+  std::vector<ExportPartition> partitions;
+  std::vector<int> first_partition_of_table;
+  for (const Table* table : schema->tables()) {
+    if (!table->is_public()) {
+      continue;
+    }
+    ExportManifest::Table* table_manifest = manifest.add_tables();
+    table_manifest->set_table_name(table->Name());
+    std::vector<ColumnID> column_ids;
+    for (const Column* column : table->columns()) {
+      table_manifest->add_column_names(column->Name());
+      column_ids.push_back(column->id());
+    }
+    ZETASQL_ASSIGN_OR_RETURN(std::vector<KeyRange> key_ranges,
+                     SplitTableIntoKeyRanges(storage, timestamp, table->id()));
+    first_partition_of_table.push_back(partitions.size());
+    for (int i = 0; i < key_ranges.size(); ++i) {
+      std::string data_file = absl::StrFormat("%s-%05d", table->Name(), i);
+      table_manifest->add_data_files(data_file);
+      partitions.push_back(ExportPartition{.table = table,
+                                           .column_ids = column_ids,
+                                           .key_range = key_ranges[i],
+                                           .data_file = data_file});
+    }
+  }
+  first_partition_of_table.push_back(partitions.size());
+
+  ZETASQL_RETURN_IF_ERROR(ProcessKeyRanges(partitions.size(), [&](int i) {
+    return ExportPartitionRows(storage, timestamp, directory, &partitions[i]);
+  }));
+
+  for (int t = 0; t < manifest.tables_size(); ++t) {
+    int64_t row_count = 0;
+    for (int i = first_partition_of_table[t];
+         i < first_partition_of_table[t + 1]; ++i) {
+      row_count += partitions[i].row_count;
+    }
+    manifest.mutable_tables(t)->set_row_count(row_count);
+  }
+
+  // The manifest is written last, so that only complete exports have one.
+  std::string manifest_text;
+  if (!google::protobuf::TextFormat::PrintToString(manifest, &manifest_text)) {
+    return error::Internal("Failed to print database export manifest.");
+  }
+  const std::string manifest_path =
+      absl::StrCat(directory, "/", kManifestFileName);
+  std::ofstream out(manifest_path, std::ios::trunc);
+  out << manifest_text;
+  out.flush();
+  if (!out.good()) {
+    return error::Internal(
+        absl::StrCat("Failed to write database export file ", manifest_path));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<ExportManifest> ReadExportManifest(
+    const std::string& directory) {
+  const std::string manifest_path =
+      absl::StrCat(directory, "/", kManifestFileName);
+  std::ifstream in(manifest_path);
+  if (!in.is_open()) {
+    return error::InvalidDatabaseExport(directory, "missing manifest");
+  }
+  std::stringstream manifest_text;
+  manifest_text << in.rdbuf();
+  ExportManifest manifest;
+  if (!google::protobuf::TextFormat::ParseFromString(manifest_text.str(),
+                                                     &manifest)) {
+    return error::InvalidDatabaseExport(directory, "malformed manifest");
+  }
+  return manifest;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
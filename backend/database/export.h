@@ -0,0 +1,55 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_EXPORT_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_EXPORT_H_
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "backend/database/export.pb.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/storage/storage.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Database exports capture every public table of a database as of a single
+// timestamp, in the column oriented format described in export.proto. Unlike
+// snapshots, which are meant to be restored, exports are meant to be inspected
+// (e.g. when diagnosing test failures), so they also hold generated columns
+// and are written as fast as possible: tables are split into key ranges which
+// are read straight from storage and written to their own data files in
+// parallel, using --schema_scan_threads threads.
+
+// Exports the tables of `schema` as of `timestamp` from `storage` into
+// `directory`, which is created if it does not exist.
+absl::Status ExportTables(const Schema* schema, const Storage* storage,
+                          absl::Time timestamp, const std::string& directory);
+
+// Reads the manifest of the export in `directory`.
+absl::StatusOr<ExportManifest> ReadExportManifest(const std::string& directory);
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_EXPORT_H_
@@ -0,0 +1,169 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/export.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "backend/access/write.h"
+#include "backend/database/database.h"
+#include "backend/database/export.pb.h"
+#include "backend/schema/updater/parallel_scan.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "backend/transaction/options.h"
+#include "common/clock.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/util/delimited_message_util.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using testing::ElementsAre;
+using zetasql::values::Int64;
+using zetasql::values::String;
+using zetasql_base::testing::StatusIs;
+
+class ExportTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = absl::StrCat(
+        testing::TempDir(), "/",
+        testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::filesystem::remove_all(dir_);
+
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        database_,
+        Database::Create(&clock_,
+                         SchemaChangeOperation{.statements = {R"(
+                           CREATE TABLE Singers(
+                             SingerId INT64 NOT NULL,
+                             Name STRING(MAX),
+                             NameLength INT64 AS (CHAR_LENGTH(Name)) STORED,
+                           ) PRIMARY KEY(SingerId)
+                         )"}}));
+  }
+
+  absl::Status Insert(int64_t singer_id, const std::string& name) {
+    ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<ReadWriteTransaction> txn,
+                     database_->CreateReadWriteTransaction(ReadWriteOptions(),
+                                                           RetryState()));
+    Mutation m;
+    m.AddWriteOp(MutationOpType::kInsert, "Singers", {"SingerId", "Name"},
+                 {{Int64(singer_id), String(name)}});
+    ZETASQL_RETURN_IF_ERROR(txn->Write(m));
+    return txn->Commit();
+  }
+
+  // Reads the values of column `column` in all the data files of `table`.
+  std::vector<zetasql::Value> ReadColumn(const ExportManifest::Table& table,
+                                         int column,
+                                         const zetasql::Type* type) {
+    std::vector<zetasql::Value> values;
+    for (const std::string& data_file : table.data_files()) {
+      std::ifstream in(absl::StrCat(dir_, "/", data_file), std::ios::binary);
+      google::protobuf::io::IstreamInputStream input(&in);
+      ExportRowGroup row_group;
+      bool clean_eof = false;
+      while (google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+          &row_group, &input, &clean_eof)) {
+        for (const zetasql::ValueProto& value_proto :
+             row_group.columns(column).values()) {
+          values.push_back(*zetasql::Value::Deserialize(value_proto, type));
+        }
+      }
+      EXPECT_TRUE(clean_eof);
+    }
+    return values;
+  }
+
+  std::string dir_;
+  Clock clock_;
+  std::unique_ptr<Database> database_;
+};
+
+TEST_F(ExportTest, ExportsTablesInKeyRanges) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_schema_scan_rows_per_range, 2);
+  absl::SetFlag(&FLAGS_schema_scan_threads, 4);
+  ZETASQL_ASSERT_OK(Insert(3, "Catalina"));
+  ZETASQL_ASSERT_OK(Insert(1, "Marc"));
+  ZETASQL_ASSERT_OK(Insert(5, "Alice"));
+  ZETASQL_ASSERT_OK(Insert(2, "Bo"));
+  ZETASQL_ASSERT_OK(Insert(4, "Zoe"));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time read_timestamp,
+                       database_->Export(dir_));
+  // Later commits are not exported.
+  ZETASQL_ASSERT_OK(Insert(6, "Ana"));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(ExportManifest manifest,
+                       ReadExportManifest(dir_));
+  EXPECT_EQ(manifest.read_timestamp_micros(),
+            absl::ToUnixMicros(read_timestamp));
+  EXPECT_FALSE(manifest.ddl_statements().empty());
+  ASSERT_EQ(manifest.tables_size(), 1);
+  const ExportManifest::Table& table = manifest.tables(0);
+  EXPECT_EQ(table.table_name(), "Singers");
+  EXPECT_THAT(table.column_names(),
+              ElementsAre("SingerId", "Name", "NameLength"));
+  EXPECT_EQ(table.row_count(), 5);
+  EXPECT_GT(table.data_files_size(), 1);
+
+  EXPECT_THAT(ReadColumn(table, 0, zetasql::types::Int64Type()),
+              ElementsAre(Int64(1), Int64(2), Int64(3), Int64(4), Int64(5)));
+  EXPECT_THAT(ReadColumn(table, 1, zetasql::types::StringType()),
+              ElementsAre(String("Marc"), String("Bo"), String("Catalina"),
+                          String("Zoe"), String("Alice")));
+  EXPECT_THAT(ReadColumn(table, 2, zetasql::types::Int64Type()),
+              ElementsAre(Int64(4), Int64(2), Int64(8), Int64(3), Int64(5)));
+}
+
+TEST_F(ExportTest, ExportsEmptyTables) {
+  ZETASQL_ASSERT_OK(database_->Export(dir_).status());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(ExportManifest manifest,
+                       ReadExportManifest(dir_));
+  ASSERT_EQ(manifest.tables_size(), 1);
+  EXPECT_EQ(manifest.tables(0).row_count(), 0);
+  EXPECT_TRUE(
+      ReadColumn(manifest.tables(0), 0, zetasql::types::Int64Type()).empty());
+}
+
+TEST_F(ExportTest, RejectsMissingManifest) {
+  EXPECT_THAT(ReadExportManifest(dir_),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,88 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/schema_template.h"
+
+#include <memory>
+#include <string>
+
+#include "google/spanner/admin/database/v1/common.pb.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "backend/common/ids.h"
+#include "backend/database/pg_oid_assigner/pg_oid_assigner.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "backend/storage/in_memory_storage.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+std::string SchemaTemplate::Fingerprint(
+    const SchemaChangeOperation& schema_change_operation) {
+  // Every part is length-prefixed so that different statement lists can never
+  // produce the same fingerprint.
+  std::string fingerprint =
+      absl::StrCat(schema_change_operation.database_dialect, ":",
+                   schema_change_operation.proto_descriptor_bytes.size(), ":",
+                   schema_change_operation.proto_descriptor_bytes);
+  for (const std::string& statement : schema_change_operation.statements) {
+    absl::StrAppend(&fingerprint, ":", statement.size(), ":", statement);
+  }
+  return fingerprint;
+}
+
+absl::StatusOr<std::shared_ptr<const SchemaTemplate>> SchemaTemplate::Create(
+    const SchemaChangeOperation& schema_change_operation) {
+  if (schema_change_operation.database_dialect ==
+      database_api::DatabaseDialect::POSTGRESQL) {
+    return nullptr;
+  }
+  auto schema_template = std::shared_ptr<SchemaTemplate>(new SchemaTemplate());
+  TableIDGenerator table_id_generator;
+  ColumnIDGenerator column_id_generator;
+  // A new database has no data, so backfills and verifications read from an
+  // empty storage.
+  InMemoryStorage storage;
+  PgOidAssigner pg_oid_assigner(/*enabled=*/false);
+  SchemaUpdater updater;
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::unique_ptr<const Schema> schema,
+      updater.CreateSchemaFromDDL(
+          schema_change_operation,
+          SchemaChangeContext{
+              .type_factory = &schema_template->type_factory_,
+              .table_id_generator = &table_id_generator,
+              .column_id_generator = &column_id_generator,
+              .storage = &storage,
+              .pg_oid_assigner = &pg_oid_assigner,
+          }));
+  if (!schema->sequences().empty()) {
+    return nullptr;
+  }
+  schema_template->schema_ = std::move(schema);
+  schema_template->next_table_id_seq_ = table_id_generator.next_seq();
+  schema_template->next_column_id_seq_ = column_id_generator.next_seq();
+  return schema_template;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
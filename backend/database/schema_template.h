@@ -0,0 +1,80 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_SCHEMA_TEMPLATE_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_SCHEMA_TEMPLATE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "zetasql/public/type.h"
+#include "absl/status/statusor.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/updater/schema_updater.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// SchemaTemplate is an immutable schema built once from the DDL statements of a
+// CreateDatabase request, which databases created with the same statements
+// share instead of building their own copy.
+//
+// A shared schema must not carry any per-database state. Schemas of
+// PostgreSQL-dialect databases (whose objects are assigned OIDs by the
+// database) and schemas with sequences (whose counters are keyed by sequence
+// ID) are therefore never shared, see Create().
+class SchemaTemplate {
+ public:
+  // Returns the key under which templates built from `schema_change_operation`
+  // are cached. Operations with the same fingerprint build identical schemas.
+  static std::string Fingerprint(
+      const SchemaChangeOperation& schema_change_operation);
+
+  // Builds the schema of `schema_change_operation`. Returns the error of the
+  // first invalid statement, or null if the resulting schema cannot be shared.
+  static absl::StatusOr<std::shared_ptr<const SchemaTemplate>> Create(
+      const SchemaChangeOperation& schema_change_operation);
+
+  // Returns the shared schema.
+  std::shared_ptr<const Schema> schema() const { return schema_; }
+
+  // Sequence numbers of the next table and column IDs after the ones used by
+  // the schema. Databases sharing the schema must not reuse the IDs below.
+  int64_t next_table_id_seq() const { return next_table_id_seq_; }
+  int64_t next_column_id_seq() const { return next_column_id_seq_; }
+
+ private:
+  SchemaTemplate() = default;
+
+  // Owns the types of the shared schema. Declared before schema_ so that it
+  // outlives it.
+  zetasql::TypeFactory type_factory_;
+
+  std::shared_ptr<const Schema> schema_;
+
+  int64_t next_table_id_seq_ = 0;
+  int64_t next_column_id_seq_ = 0;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_SCHEMA_TEMPLATE_H_
@@ -0,0 +1,354 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/snapshot.h"
+
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/spanner/admin/database/v1/common.pb.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "zetasql/public/value.pb.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "backend/access/read.h"
+#include "backend/access/write.h"
+#include "backend/database/bulk_import.h"
+#include "backend/database/database.h"
+#include "backend/database/snapshot.pb.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/datamodel/value.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/foreign_key.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/schema/printer/print_ddl.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "backend/transaction/options.h"
+#include "common/clock.h"
+#include "common/errors.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/util/delimited_message_util.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Version of the snapshot format written by WriteDatabaseSnapshot.
+constexpr int kSnapshotVersion = 1;
+
+// Maximum number of rows inserted by a single transaction during a restore
+// through mutations. Bounds the memory used by buffered mutations for large
+// tables.
+constexpr int kMaxRowsPerRestoreCommit = 10000;
+
+// Appends `table` to `ordered` after the tables it depends on, i.e. its parent
+// and the tables referenced by its foreign keys.
+void AddTableInDependencyOrder(const Table* table,
+                               absl::flat_hash_set<const Table*>* visited,
+                               std::vector<const Table*>* ordered) {
+  if (!visited->insert(table).second) {
+    return;
+  }
+  if (table->parent() != nullptr) {
+    AddTableInDependencyOrder(table->parent(), visited, ordered);
+  }
+  for (const ForeignKey* foreign_key : table->foreign_keys()) {
+    AddTableInDependencyOrder(foreign_key->referenced_table(), visited,
+                              ordered);
+  }
+  ordered->push_back(table);
+}
+
+std::vector<const Table*> TablesInDependencyOrder(const Schema* schema) {
+  absl::flat_hash_set<const Table*> visited;
+  std::vector<const Table*> ordered;
+  for (const Table* table : schema->tables()) {
+    if (table->is_public()) {
+      AddTableInDependencyOrder(table, &visited, &ordered);
+    }
+  }
+  return ordered;
+}
+
+absl::Status WriteRecord(const SnapshotRecord& record, std::ostream* out) {
+  if (!google::protobuf::util::SerializeDelimitedToOstream(record, out)) {
+    return error::Internal("Failed to write database snapshot record.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status WriteTable(ReadOnlyTransaction* txn, const Table* table,
+                        std::ostream* out) {
+  ReadArg read_arg;
+  read_arg.table = table->Name();
+  read_arg.key_set = KeySet::All();
+  SnapshotRecord record;
+  SnapshotRecord::TableHeader* header = record.mutable_table();
+  header->set_table_name(table->Name());
+  for (const Column* column : table->columns()) {
+    if (column->is_generated()) {
+      continue;
+    }
+    read_arg.columns.push_back(column->Name());
+    header->add_column_names(column->Name());
+  }
+  ZETASQL_RETURN_IF_ERROR(WriteRecord(record, out));
+
+  std::unique_ptr<RowCursor> cursor;
+  ZETASQL_RETURN_IF_ERROR(txn->Read(read_arg, &cursor));
+  while (cursor->Next()) {
+    record.Clear();
+    SnapshotRecord::Row* row = record.mutable_row();
+    for (int i = 0; i < cursor->NumColumns(); ++i) {
+      ZETASQL_RETURN_IF_ERROR(cursor->ColumnValue(i).Serialize(row->add_values()));
+    }
+    ZETASQL_RETURN_IF_ERROR(WriteRecord(record, out));
+  }
+  return cursor->Status();
+}
+
+// Buffers the rows of a single table and inserts them into the database being
+// restored in bounded batches, or, for databases which support bulk imports,
+// collects all of them for a single import.
+class TableRestorer {
+ public:
+  TableRestorer(Database* database, const std::string& source,
+                const SnapshotRecord::TableHeader& header)
+      : database_(database),
+        source_(source),
+        header_(header),
+        bulk_import_(database->SupportsBulkImport()) {}
+
+  // Resolves the table and its column types in the restored schema.
+  absl::Status Init() {
+    const Table* table =
+        database_->GetLatestSchema()->FindTable(header_.table_name());
+    if (table == nullptr) {
+      return error::InvalidDatabaseSnapshot(
+          source_, absl::StrCat("unknown table ", header_.table_name()));
+    }
+    import_.table = table;
+    for (const std::string& column_name : header_.column_names()) {
+      const Column* column = table->FindColumn(column_name);
+      if (column == nullptr) {
+        return error::InvalidDatabaseSnapshot(
+            source_, absl::StrCat("unknown column ", header_.table_name(), ".",
+                                  column_name));
+      }
+      column_types_.push_back(column->GetType());
+      import_.columns.push_back(column);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status AddRow(const SnapshotRecord::Row& row) {
+    if (row.values_size() != column_types_.size()) {
+      return error::InvalidDatabaseSnapshot(
+          source_, absl::StrCat("row of table ", header_.table_name(), " has ",
+                                row.values_size(), " values, expected ",
+                                column_types_.size()));
+    }
+    ValueList values;
+    values.reserve(column_types_.size());
+    for (int i = 0; i < row.values_size(); ++i) {
+      ZETASQL_ASSIGN_OR_RETURN(
+          zetasql::Value value,
+          zetasql::Value::Deserialize(row.values(i), column_types_[i]));
+      values.push_back(std::move(value));
+    }
+    rows_.push_back(std::move(values));
+    if (!bulk_import_ && rows_.size() >= kMaxRowsPerRestoreCommit) {
+      return Flush();
+    }
+    return absl::OkStatus();
+  }
+
+  // Commits all the buffered rows, unless they are bulk imported.
+  absl::Status Flush() {
+    if (bulk_import_ || rows_.empty()) {
+      return absl::OkStatus();
+    }
+    Mutation mutation;
+    mutation.AddWriteOp(
+        MutationOpType::kInsert, header_.table_name(),
+        std::vector<std::string>(header_.column_names().begin(),
+                                 header_.column_names().end()),
+        std::move(rows_));
+    rows_.clear();
+    ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<ReadWriteTransaction> txn,
+                     database_->CreateReadWriteTransaction(ReadWriteOptions(),
+                                                           RetryState()));
+    ZETASQL_RETURN_IF_ERROR(txn->Write(mutation));
+    return txn->Commit();
+  }
+
+  // Returns the rows buffered for a bulk import.
+  TableImport ReleaseImport() {
+    import_.rows = std::move(rows_);
+    rows_.clear();
+    return std::move(import_);
+  }
+
+ private:
+  Database* database_;
+  const std::string& source_;
+  const SnapshotRecord::TableHeader header_;
+  const bool bulk_import_;
+  std::vector<const zetasql::Type*> column_types_;
+  std::vector<ValueList> rows_;
+  TableImport import_;
+};
+
+}  // namespace
+
+absl::Status WriteDatabaseSnapshot(Database* database, std::ostream* out) {
+  if (database->dialect() == database_api::DatabaseDialect::POSTGRESQL) {
+    return error::DatabaseSnapshotNotSupported("PostgreSQL dialect databases");
+  }
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<ReadOnlyTransaction> txn,
+                   database->CreateReadOnlyTransaction(ReadOnlyOptions()));
+  const Schema* schema = txn->schema();
+  if (schema->proto_bundle() != nullptr && !schema->proto_bundle()->empty()) {
+    return error::DatabaseSnapshotNotSupported("databases with proto bundles");
+  }
+
+  SnapshotRecord record;
+  SnapshotRecord::Header* header = record.mutable_header();
+  header->set_version(kSnapshotVersion);
+  header->set_read_timestamp_micros(absl::ToUnixMicros(txn->read_timestamp()));
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::shared_ptr<const std::vector<std::string>> statements,
+      GetDDLStatements(schema));
+  for (const std::string& statement : *statements) {
+    header->add_ddl_statements(statement);
+  }
+  ZETASQL_RETURN_IF_ERROR(WriteRecord(record, out));
+
+  for (const Table* table : TablesInDependencyOrder(schema)) {
+    ZETASQL_RETURN_IF_ERROR(WriteTable(txn.get(), table, out));
+  }
+  out->flush();
+  if (!out->good()) {
+    return error::Internal("Failed to write database snapshot.");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<Database>> RestoreDatabaseSnapshot(
+    Clock* clock, std::istream* in, const std::string& source,
+    absl::Time* read_timestamp) {
+  google::protobuf::io::IstreamInputStream input(in);
+  SnapshotRecord record;
+  bool clean_eof = false;
+  if (!google::protobuf::util::ParseDelimitedFromZeroCopyStream(&record, &input,
+                                                      &clean_eof) ||
+      !record.has_header()) {
+    return error::InvalidDatabaseSnapshot(source, "missing snapshot header");
+  }
+  if (record.header().version() != kSnapshotVersion) {
+    return error::InvalidDatabaseSnapshot(
+        source,
+        absl::StrCat("unsupported snapshot version ",
+                     record.header().version()));
+  }
+
+  if (read_timestamp != nullptr) {
+    *read_timestamp =
+        absl::FromUnixMicros(record.header().read_timestamp_micros());
+  }
+
+  std::vector<std::string> statements(record.header().ddl_statements().begin(),
+                                      record.header().ddl_statements().end());
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::unique_ptr<Database> database,
+      Database::Create(clock, SchemaChangeOperation{.statements = statements}));
+
+  std::vector<TableImport> imports;
+  std::unique_ptr<TableRestorer> restorer;
+  while (true) {
+    record.Clear();
+    if (!google::protobuf::util::ParseDelimitedFromZeroCopyStream(&record, &input,
+                                                        &clean_eof)) {
+      if (clean_eof) {
+        break;
+      }
+      return error::InvalidDatabaseSnapshot(source, "truncated snapshot");
+    }
+    if (record.has_table()) {
+      if (restorer != nullptr) {
+        ZETASQL_RETURN_IF_ERROR(restorer->Flush());
+        imports.push_back(restorer->ReleaseImport());
+      }
+      restorer = std::make_unique<TableRestorer>(database.get(), source,
+                                                 record.table());
+      ZETASQL_RETURN_IF_ERROR(restorer->Init());
+    } else if (record.has_row()) {
+      if (restorer == nullptr) {
+        return error::InvalidDatabaseSnapshot(source,
+                                              "row without a table header");
+      }
+      ZETASQL_RETURN_IF_ERROR(restorer->AddRow(record.row()));
+    } else {
+      return error::InvalidDatabaseSnapshot(source, "unexpected record");
+    }
+  }
+  if (restorer != nullptr) {
+    ZETASQL_RETURN_IF_ERROR(restorer->Flush());
+    imports.push_back(restorer->ReleaseImport());
+  }
+  if (database->SupportsBulkImport()) {
+    ZETASQL_RETURN_IF_ERROR(database->BulkImport(std::move(imports)).status());
+  }
+  return database;
+}
+
+absl::Status WriteDatabaseSnapshotToFile(Database* database,
+                                         const std::string& path) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    return error::Internal(
+        absl::StrCat("Failed to open database snapshot file ", path));
+  }
+  return WriteDatabaseSnapshot(database, &out);
+}
+
+absl::StatusOr<std::unique_ptr<Database>> RestoreDatabaseSnapshotFromFile(
+    Clock* clock, const std::string& path, absl::Time* read_timestamp) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) {
+    return error::InvalidDatabaseSnapshot(path, "file cannot be opened");
+  }
+  return RestoreDatabaseSnapshot(clock, &in, path, read_timestamp);
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,68 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_SNAPSHOT_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_SNAPSHOT_H_
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "backend/database/database.h"
+#include "common/clock.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Database snapshots capture the latest schema and data of a database in a
+// compact, streaming binary format (see snapshot.proto), so that large fixture
+// datasets can be loaded without replaying the mutations which created them.
+//
+// Only the latest version of each row is captured. Commit history, change
+// stream records and sequence state are not preserved. PostgreSQL dialect
+// databases and databases with proto bundles are not supported.
+
+// Writes a snapshot of the latest state of `database` to `out`.
+absl::Status WriteDatabaseSnapshot(Database* database, std::ostream* out);
+
+// Creates a new database from a snapshot previously written by
+// WriteDatabaseSnapshot. `source` is only used in error messages. If
+// `read_timestamp` is not null, it is set to the timestamp at which the
+// snapshot was read from the original database. The rows are bulk imported
+// (see Database::BulkImport) into databases which support it.
+absl::StatusOr<std::unique_ptr<Database>> RestoreDatabaseSnapshot(
+    Clock* clock, std::istream* in, const std::string& source = "<stream>",
+    absl::Time* read_timestamp = nullptr);
+
+// Convenience wrappers which write and read snapshots to and from `path`.
+absl::Status WriteDatabaseSnapshotToFile(Database* database,
+                                         const std::string& path);
+absl::StatusOr<std::unique_ptr<Database>> RestoreDatabaseSnapshotFromFile(
+    Clock* clock, const std::string& path,
+    absl::Time* read_timestamp = nullptr);
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_SNAPSHOT_H_
@@ -0,0 +1,210 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/snapshot.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "tests/common/proto_matchers.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "backend/access/read.h"
+#include "backend/access/write.h"
+#include "backend/database/database.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/datamodel/value.h"
+#include "backend/schema/printer/print_ddl.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "backend/transaction/options.h"
+#include "common/clock.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::NullString;
+using zetasql::values::String;
+using zetasql_base::testing::StatusIs;
+
+class SnapshotTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::vector<std::string> create_statements = {
+        R"(
+          CREATE TABLE Singers(
+            SingerId INT64 NOT NULL,
+            Name STRING(MAX),
+            NameLength INT64 AS (CHAR_LENGTH(Name)) STORED,
+          ) PRIMARY KEY(SingerId)
+        )",
+        R"(
+          CREATE TABLE Albums(
+            SingerId INT64 NOT NULL,
+            AlbumId INT64 NOT NULL,
+            Title STRING(MAX),
+          ) PRIMARY KEY(SingerId, AlbumId),
+            INTERLEAVE IN PARENT Singers ON DELETE CASCADE
+        )",
+        R"(
+          CREATE TABLE Fans(
+            FanId INT64 NOT NULL,
+            FavoriteSingerId INT64,
+            CONSTRAINT FK_FavoriteSinger FOREIGN KEY (FavoriteSingerId)
+              REFERENCES Singers (SingerId),
+          ) PRIMARY KEY(FanId)
+        )",
+        R"(
+          CREATE INDEX AlbumsByTitle ON Albums(Title)
+        )"};
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        database_,
+        Database::Create(&clock_, SchemaChangeOperation{
+                                      .statements = create_statements}));
+
+    Mutation m;
+    m.AddWriteOp(MutationOpType::kInsert, "Singers", {"SingerId", "Name"},
+                 {{Int64(1), String("Marc")},
+                  {Int64(2), String("Catalina")},
+                  {Int64(3), NullString()}});
+    m.AddWriteOp(MutationOpType::kInsert, "Albums",
+                 {"SingerId", "AlbumId", "Title"},
+                 {{Int64(1), Int64(1), String("Total Junk")},
+                  {Int64(2), Int64(1), String("Green")}});
+    m.AddWriteOp(MutationOpType::kInsert, "Fans",
+                 {"FanId", "FavoriteSingerId"},
+                 {{Int64(10), Int64(2)}, {Int64(11), Int64(1)}});
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ReadWriteTransaction> txn,
+        database_->CreateReadWriteTransaction(ReadWriteOptions(),
+                                              RetryState()));
+    ZETASQL_ASSERT_OK(txn->Write(m));
+    ZETASQL_ASSERT_OK(txn->Commit());
+  }
+
+  absl::StatusOr<std::vector<ValueList>> ReadAll(
+      Database* database, const std::string& table,
+      const std::vector<std::string>& columns, const std::string& index = "") {
+    ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<ReadOnlyTransaction> txn,
+                     database->CreateReadOnlyTransaction(ReadOnlyOptions()));
+    ReadArg read_arg;
+    read_arg.table = table;
+    read_arg.index = index;
+    read_arg.key_set = KeySet::All();
+    read_arg.columns = columns;
+    std::unique_ptr<RowCursor> cursor;
+    ZETASQL_RETURN_IF_ERROR(txn->Read(read_arg, &cursor));
+    std::vector<ValueList> rows;
+    while (cursor->Next()) {
+      rows.emplace_back();
+      for (int i = 0; i < cursor->NumColumns(); ++i) {
+        rows.back().push_back(cursor->ColumnValue(i));
+      }
+    }
+    ZETASQL_RETURN_IF_ERROR(cursor->Status());
+    return rows;
+  }
+
+  Clock clock_;
+  std::unique_ptr<Database> database_;
+};
+
+TEST_F(SnapshotTest, RestoresSchemaAndData) {
+  std::stringstream snapshot;
+  ZETASQL_ASSERT_OK(WriteDatabaseSnapshot(database_.get(), &snapshot));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Database> restored,
+                       RestoreDatabaseSnapshot(&clock_, &snapshot));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<std::string> original_ddl,
+                       PrintDDLStatements(database_->GetLatestSchema()));
+  EXPECT_THAT(PrintDDLStatements(restored->GetLatestSchema()),
+              zetasql_base::testing::IsOkAndHolds(original_ddl));
+
+  for (const auto& [table, columns] :
+       std::vector<std::pair<std::string, std::vector<std::string>>>{
+           {"Singers", {"SingerId", "Name", "NameLength"}},
+           {"Albums", {"SingerId", "AlbumId", "Title"}},
+           {"Fans", {"FanId", "FavoriteSingerId"}}}) {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<ValueList> expected,
+                         ReadAll(database_.get(), table, columns));
+    EXPECT_THAT(ReadAll(restored.get(), table, columns),
+                zetasql_base::testing::IsOkAndHolds(expected));
+  }
+
+  // Index entries are rebuilt from the restored rows.
+  EXPECT_THAT(ReadAll(restored.get(), "Albums", {"Title"}, "AlbumsByTitle"),
+              zetasql_base::testing::IsOkAndHolds(
+                  testing::ElementsAre(ValueList{String("Green")},
+                                       ValueList{String("Total Junk")})));
+}
+
+TEST_F(SnapshotTest, RestoresEmptyDatabase) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Database> empty,
+                       Database::Create(&clock_, SchemaChangeOperation{}));
+  std::stringstream snapshot;
+  ZETASQL_ASSERT_OK(WriteDatabaseSnapshot(empty.get(), &snapshot));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Database> restored,
+                       RestoreDatabaseSnapshot(&clock_, &snapshot));
+  EXPECT_TRUE(restored->GetLatestSchema()->tables().empty());
+}
+
+TEST_F(SnapshotTest, RejectsPostgreSQLDatabases) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Database> database,
+      Database::Create(
+          &clock_,
+          SchemaChangeOperation{
+              .database_dialect = database_api::DatabaseDialect::POSTGRESQL}));
+  std::stringstream snapshot;
+  EXPECT_THAT(WriteDatabaseSnapshot(database.get(), &snapshot),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+TEST_F(SnapshotTest, RejectsInvalidSnapshots) {
+  std::stringstream empty;
+  EXPECT_THAT(RestoreDatabaseSnapshot(&clock_, &empty),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  std::stringstream snapshot;
+  ZETASQL_ASSERT_OK(WriteDatabaseSnapshot(database_.get(), &snapshot));
+  std::string data = snapshot.str();
+  std::stringstream truncated(data.substr(0, data.size() - 1));
+  EXPECT_THAT(RestoreDatabaseSnapshot(&clock_, &truncated),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(SnapshotTest, RejectsMissingFile) {
+  EXPECT_THAT(
+      RestoreDatabaseSnapshotFromFile(&clock_, "/nonexistent/snapshot.bin"),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
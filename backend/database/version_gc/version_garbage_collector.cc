@@ -0,0 +1,113 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/version_gc/version_garbage_collector.h"
+
+#include <thread>  // NOLINT
+
+#include "zetasql/base/logging.h"
+#include "absl/flags/flag.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/storage/in_memory_storage.h"
+#include "common/clock.h"
+#include "common/constants.h"
+
+ABSL_FLAG(bool, enable_version_gc, true,
+          "Whether to garbage collect storage versions which are older than "
+          "the maximum read staleness.");
+
+ABSL_FLAG(absl::Duration, version_gc_interval, absl::Minutes(1),
+          "How often to run storage version garbage collection.");
+
+ABSL_FLAG(absl::Duration, cold_version_age, absl::Minutes(10),
+          "Age after which storage versions which are not the latest version "
+          "of their cell are moved into compressed per-row blocks during "
+          "version garbage collection. A non-positive age disables "
+          "compression.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+VersionGarbageCollector::VersionGarbageCollector(InMemoryStorage* storage,
+                                                 Clock* clock)
+    : storage_(storage), clock_(clock) {
+  if (absl::GetFlag(FLAGS_enable_version_gc)) {
+    thread_ =
+        std::thread(&VersionGarbageCollector::PeriodicCollectGarbage, this);
+  }
+}
+
+VersionGarbageCollector::~VersionGarbageCollector() {
+  {
+    absl::MutexLock lock(&mu_);
+    stop_thread_ = true;
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+InMemoryStorage::GarbageCollectionStats
+VersionGarbageCollector::CollectGarbage() {
+  InMemoryStorage::GarbageCollectionStats stats =
+      storage_->CollectGarbage(clock_->Now() - kMaxStaleReadDuration);
+  ZETASQL_VLOG(1) << "Version garbage collection removed "
+          << stats.versions_removed << " versions and " << stats.rows_removed
+          << " rows, reclaiming " << stats.bytes_reclaimed << " bytes.";
+
+  const absl::Duration cold_version_age =
+      absl::GetFlag(FLAGS_cold_version_age);
+  if (cold_version_age > absl::ZeroDuration()) {
+    InMemoryStorage::CompressionStats compression_stats =
+        storage_->CompressVersions(clock_->Now() - cold_version_age);
+    ZETASQL_VLOG(1) << "Version compression moved "
+            << compression_stats.versions_compressed << " versions of "
+            << compression_stats.rows_compressed << " rows into cold storage.";
+  }
+
+  absl::MutexLock lock(&mu_);
+  total_stats_.versions_removed += stats.versions_removed;
+  total_stats_.rows_removed += stats.rows_removed;
+  total_stats_.bytes_reclaimed += stats.bytes_reclaimed;
+  return stats;
+}
+
+InMemoryStorage::GarbageCollectionStats VersionGarbageCollector::TotalStats() {
+  absl::MutexLock lock(&mu_);
+  return total_stats_;
+}
+
+void VersionGarbageCollector::PeriodicCollectGarbage() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.AwaitWithTimeout(absl::Condition(&stop_thread_),
+                           absl::GetFlag(FLAGS_version_gc_interval));
+      if (stop_thread_) {
+        return;
+      }
+    }
+    CollectGarbage();
+  }
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,90 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_VERSION_GC_VERSION_GARBAGE_COLLECTOR_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_VERSION_GC_VERSION_GARBAGE_COLLECTOR_H_
+
+#include <thread>  // NOLINT
+
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/declare.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/storage/in_memory_storage.h"
+#include "common/clock.h"
+
+// Whether old storage versions should be garbage collected in the background.
+ABSL_DECLARE_FLAG(bool, enable_version_gc);
+
+// How often to run the background version garbage collection.
+ABSL_DECLARE_FLAG(absl::Duration, version_gc_interval);
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// VersionGarbageCollector periodically removes versions from the storage of a
+// database which can no longer be read.
+//
+// Reads older than kMaxStaleReadDuration are rejected, so all versions which
+// are superseded by a version older than that window are unobservable and are
+// dropped, along with rows which were deleted before the window. Reads which
+// are still in progress bound garbage collection further (see
+// InMemoryStorage::CollectGarbage).
+//
+// Garbage collection runs in a background thread owned by this class which is
+// stopped when this object is destroyed.
+class VersionGarbageCollector {
+ public:
+  VersionGarbageCollector(InMemoryStorage* storage, Clock* clock);
+  ~VersionGarbageCollector();
+
+  // Runs a single garbage collection pass and returns its statistics.
+  InMemoryStorage::GarbageCollectionStats CollectGarbage()
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the statistics accumulated across all garbage collection passes.
+  InMemoryStorage::GarbageCollectionStats TotalStats() ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  void PeriodicCollectGarbage() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Storage of the database.
+  InMemoryStorage* storage_;
+
+  // Clock shared across emulator components.
+  Clock* clock_;
+
+  absl::Mutex mu_;
+
+  // Set when the background thread should exit.
+  bool stop_thread_ ABSL_GUARDED_BY(mu_) = false;
+
+  // Statistics accumulated across all garbage collection passes.
+  InMemoryStorage::GarbageCollectionStats total_stats_ ABSL_GUARDED_BY(mu_);
+
+  // The background garbage collection thread. Not started if version garbage
+  // collection is disabled.
+  std::thread thread_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_VERSION_GC_VERSION_GARBAGE_COLLECTOR_H_
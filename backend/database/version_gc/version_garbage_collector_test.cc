@@ -0,0 +1,150 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/database/version_gc/version_garbage_collector.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/flags/flag.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/storage/in_memory_storage.h"
+#include "common/clock.h"
+#include "common/constants.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+
+class VersionGarbageCollectorTest : public testing::Test {
+ protected:
+  VersionGarbageCollectorTest() {
+    absl::SetFlag(&FLAGS_enable_version_gc, false);
+  }
+
+  ~VersionGarbageCollectorTest() override {
+    absl::SetFlag(&FLAGS_enable_version_gc, true);
+  }
+
+  const TableID kTableId = "test_table:0";
+  const ColumnID kColumnId = "test_column:0";
+  Clock clock_;
+  InMemoryStorage storage_;
+};
+
+TEST_F(VersionGarbageCollectorTest, RemovesVersionsOlderThanMaxStaleness) {
+  VersionGarbageCollector gc(&storage_, &clock_);
+  absl::Time expired_ts = clock_.Now() - kMaxStaleReadDuration -
+                          absl::Minutes(10);
+  absl::Time superseding_ts = expired_ts + absl::Minutes(5);
+  absl::Time recent_ts = clock_.Now();
+  Key key({Int64(1)});
+
+  ZETASQL_ASSERT_OK(storage_.Write(expired_ts, kTableId, key, {kColumnId},
+                           {Int64(1)}));
+  ZETASQL_ASSERT_OK(storage_.Write(superseding_ts, kTableId, key, {kColumnId},
+                           {Int64(2)}));
+  ZETASQL_ASSERT_OK(storage_.Write(recent_ts, kTableId, key, {kColumnId},
+                           {Int64(3)}));
+
+  InMemoryStorage::GarbageCollectionStats stats = gc.CollectGarbage();
+  EXPECT_EQ(stats.versions_removed, 1);
+  EXPECT_EQ(stats.rows_removed, 0);
+  EXPECT_GT(stats.bytes_reclaimed, 0);
+  EXPECT_EQ(gc.TotalStats().versions_removed, 1);
+
+  // Versions which are still observable within the staleness window are kept.
+  std::vector<zetasql::Value> values;
+  absl::Time stale_read_ts =
+      clock_.Now() - kMaxStaleReadDuration + absl::Minutes(1);
+  ZETASQL_EXPECT_OK(
+      storage_.Lookup(stale_read_ts, kTableId, key, {kColumnId}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(2)));
+  ZETASQL_EXPECT_OK(
+      storage_.Lookup(clock_.Now(), kTableId, key, {kColumnId}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(3)));
+}
+
+TEST_F(VersionGarbageCollectorTest, RemovesRowsDeletedBeforeMaxStaleness) {
+  VersionGarbageCollector gc(&storage_, &clock_);
+  absl::Time expired_ts = clock_.Now() - kMaxStaleReadDuration -
+                          absl::Minutes(10);
+  Key deleted_key({Int64(1)});
+  Key live_key({Int64(2)});
+
+  ZETASQL_ASSERT_OK(storage_.Write(expired_ts, kTableId, deleted_key, {kColumnId},
+                           {Int64(1)}));
+  ZETASQL_ASSERT_OK(storage_.Write(expired_ts, kTableId, live_key, {kColumnId},
+                           {Int64(2)}));
+  ZETASQL_ASSERT_OK(storage_.Delete(expired_ts + absl::Minutes(1), kTableId,
+                            KeyRange::Point(deleted_key)));
+
+  InMemoryStorage::GarbageCollectionStats stats = gc.CollectGarbage();
+  EXPECT_EQ(stats.rows_removed, 1);
+
+  std::unique_ptr<StorageIterator> itr;
+  ZETASQL_ASSERT_OK(storage_.Read(clock_.Now(), kTableId, KeyRange::All(),
+                          {kColumnId}, &itr));
+  ASSERT_TRUE(itr->Next());
+  EXPECT_EQ(itr->Key(), live_key);
+  EXPECT_EQ(itr->ColumnValue(0), Int64(2));
+  EXPECT_FALSE(itr->Next());
+
+  // A second pass has nothing left to collect.
+  stats = gc.CollectGarbage();
+  EXPECT_EQ(stats.versions_removed, 0);
+  EXPECT_EQ(stats.rows_removed, 0);
+}
+
+TEST_F(VersionGarbageCollectorTest, ActiveReadersBoundGarbageCollection) {
+  VersionGarbageCollector gc(&storage_, &clock_);
+  absl::Time expired_ts = clock_.Now() - kMaxStaleReadDuration -
+                          absl::Minutes(10);
+  Key key({Int64(1)});
+
+  ZETASQL_ASSERT_OK(
+      storage_.Write(expired_ts, kTableId, key, {kColumnId}, {Int64(1)}));
+  ZETASQL_ASSERT_OK(storage_.Write(expired_ts + absl::Minutes(1), kTableId, key,
+                           {kColumnId}, {Int64(2)}));
+
+  // An in-progress read at the oldest version prevents it from being
+  // collected.
+  std::unique_ptr<StorageIterator> itr;
+  ZETASQL_ASSERT_OK(storage_.Read(expired_ts, kTableId, KeyRange::All(),
+                          {kColumnId}, &itr));
+  EXPECT_EQ(gc.CollectGarbage().versions_removed, 0);
+  ASSERT_TRUE(itr->Next());
+  EXPECT_EQ(itr->ColumnValue(0), Int64(1));
+
+  itr.reset();
+  EXPECT_EQ(gc.CollectGarbage().versions_removed, 1);
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -16,6 +16,7 @@
 
 #include "backend/datamodel/key.h"
 
+#include <iterator>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -67,14 +68,14 @@ int64_t LogicalBytesInternal(const zetasql::Value& value) {
 Key::Key() = default;
 
 Key::Key(std::vector<zetasql::Value> columns)
-    : columns_(std::move(columns)),
-      is_descending_(columns_.size()),
-      is_nulls_last_(columns_.size()) {}
+    : columns_(std::make_move_iterator(columns.begin()),
+               std::make_move_iterator(columns.end())),
+      column_flags_(columns_.size()) {}
 
 void Key::AddColumn(zetasql::Value value, bool desc, bool is_nulls_last) {
   columns_.emplace_back(std::move(value));
-  is_descending_.push_back(desc);
-  is_nulls_last_.push_back(is_nulls_last);
+  column_flags_.push_back((desc ? kDescending : 0) |
+                          (is_nulls_last ? kNullsLast : 0));
 }
 
 int Key::NumColumns() const { return columns_.size(); }
@@ -83,13 +84,29 @@ void Key::SetColumnValue(int i, zetasql::Value value) {
   columns_[i] = std::move(value);
 }
 
-void Key::SetColumnDescending(int i, bool value) { is_descending_[i] = value; }
-void Key::SetColumnNullsLast(int i, bool value) { is_nulls_last_[i] = value; }
+void Key::SetColumnFlag(int i, ColumnFlag flag, bool value) {
+  if (value) {
+    column_flags_[i] |= flag;
+  } else {
+    column_flags_[i] &= ~flag;
+  }
+}
+
+void Key::SetColumnDescending(int i, bool value) {
+  SetColumnFlag(i, kDescending, value);
+}
+void Key::SetColumnNullsLast(int i, bool value) {
+  SetColumnFlag(i, kNullsLast, value);
+}
 
 const zetasql::Value& Key::ColumnValue(int i) const { return columns_[i]; }
 
-bool Key::IsColumnDescending(int i) const { return is_descending_[i]; }
-bool Key::IsColumnNullsLast(int i) const { return is_nulls_last_[i]; }
+bool Key::IsColumnDescending(int i) const {
+  return (column_flags_[i] & kDescending) != 0;
+}
+bool Key::IsColumnNullsLast(int i) const {
+  return (column_flags_[i] & kNullsLast) != 0;
+}
 
 int Key::Compare(const Key& other) const {
   // Handle infinity keys first.
@@ -110,20 +127,20 @@ int Key::Compare(const Key& other) const {
       continue;
     }
     if (columns_[i].is_null() && !other.columns_[i].is_null()) {
-      return is_nulls_last_[i] ? 1 : -1;
+      return IsColumnNullsLast(i) ? 1 : -1;
     }
     if (other.columns_[i].is_null()) {
-      return is_nulls_last_[i] ? -1 : 1;
+      return IsColumnNullsLast(i) ? -1 : 1;
     }
     if (columns_[i].LessThan(other.columns_[i])) {
-      return is_descending_[i] ? 1 : -1;
+      return IsColumnDescending(i) ? 1 : -1;
     }
 
     if (columns_[i].Equals(other.columns_[i])) {
       continue;
     }
 
-    return is_descending_[i] ? -1 : 1;
+    return IsColumnDescending(i) ? -1 : 1;
   }
 
   // If we reached here, *this is a prefix of other.
@@ -158,7 +175,7 @@ Key Key::ToPrefixLimit() const {
 Key Key::Prefix(int n) const {
   Key k = (*this);
   k.columns_.resize(n);
-  k.is_descending_.resize(n);
+  k.column_flags_.resize(n);
   return k;
 }
 
@@ -211,7 +228,7 @@ std::ostream& operator<<(std::ostream& out, const Key& k) {
       out << ", ";
     }
     out << k.ColumnValue(i);
-    if (k.is_descending_[i]) {
+    if (k.IsColumnDescending(i)) {
       out << "↓";
     }
   }
@@ -17,11 +17,15 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATAMODEL_KEY_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATAMODEL_KEY_H_
 
+#include <cstdint>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "zetasql/public/value.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/types/span.h"
 
 namespace google {
 namespace spanner {
@@ -68,9 +72,7 @@ class Key {
   bool IsColumnNullsLast(int i) const;
 
   // Returns all column values in the key.
-  const std::vector<zetasql::Value>& column_values() const {
-    return columns_;
-  }
+  absl::Span<const zetasql::Value> column_values() const { return columns_; }
 
   // Performs a three-way comparison against another key.
   // k1.Compare(k2) returns
@@ -103,9 +105,36 @@ class Key {
   // Returns a debug string suitable to be included in error messages.
   std::string DebugString() const;
 
+  // Hashes the key consistently with operator==, so that keys can be used in
+  // hash containers.
+  template <typename H>
+  friend H AbslHashValue(H h, const Key& key) {
+    if (key.is_infinity_) {
+      return H::combine(std::move(h), key.is_infinity_);
+    }
+    for (const zetasql::Value& column : key.columns_) {
+      h = H::combine(std::move(h), column.HashCode());
+    }
+    return H::combine(std::move(h), key.columns_.size(),
+                      key.is_prefix_limit_);
+  }
+
  private:
+  // Keys of up to this many columns, which covers most primary and index keys,
+  // are stored inline without a heap allocation.
+  static constexpr int kInlineColumns = 4;
+
+  // Bits of the per-column ordering flags.
+  enum ColumnFlag : uint8_t {
+    kDescending = 1 << 0,
+    kNullsLast = 1 << 1,
+  };
+
+  // Sets or clears the given flag of column i.
+  void SetColumnFlag(int i, ColumnFlag flag, bool value);
+
   // Individual columns that make up the key.
-  std::vector<zetasql::Value> columns_;
+  absl::InlinedVector<zetasql::Value, kInlineColumns> columns_;
 
   // Key metadata.
   bool is_infinity_ = false;
@@ -113,9 +142,8 @@ class Key {
 
   // TODO: We may refactor this by creating an immutable class which
   // has both the ordering and null handling.
-  // Column metadata.
-  std::vector<bool> is_descending_;
-  std::vector<bool> is_nulls_last_;
+  // Column metadata, as a bitmask of ColumnFlags per column.
+  absl::InlinedVector<uint8_t, kInlineColumns> column_flags_;
 
   // Friend for member access.
   friend std::ostream& operator<<(std::ostream& out, const Key& k);
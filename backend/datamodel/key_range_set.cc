@@ -0,0 +1,104 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/datamodel/key_range_set.h"
+
+#include <iterator>
+#include <vector>
+
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+void KeyRangeSet::Add(const KeyRange& range) {
+  KeyRange closed_open = range.ToClosedOpen();
+  Key start_key = closed_open.start_key();
+  Key limit_key = closed_open.limit_key();
+  if (!(start_key < limit_key)) {
+    return;
+  }
+
+  // Merge with the range starting before `start_key` if it overlaps or abuts.
+  auto it = ranges_.upper_bound(start_key);
+  if (it != ranges_.begin()) {
+    auto prev = std::prev(it);
+    if (start_key <= prev->second) {
+      start_key = prev->first;
+      if (limit_key < prev->second) {
+        limit_key = prev->second;
+      }
+      it = ranges_.erase(prev);
+    }
+  }
+
+  // Merge with all the ranges starting within the new range.
+  while (it != ranges_.end() && it->first <= limit_key) {
+    if (limit_key < it->second) {
+      limit_key = it->second;
+    }
+    it = ranges_.erase(it);
+  }
+  ranges_.emplace_hint(it, std::move(start_key), std::move(limit_key));
+}
+
+void KeyRangeSet::Remove(const Key& key) {
+  auto it = ranges_.upper_bound(key);
+  if (it == ranges_.begin()) {
+    return;
+  }
+  --it;
+  if (!(key < it->second)) {
+    return;
+  }
+  Key start_key = it->first;
+  Key limit_key = it->second;
+  it = ranges_.erase(it);
+
+  // For a fully specified key, its prefix limit is the smallest key after it.
+  Key key_limit = key.ToPrefixLimit();
+  if (key_limit < limit_key) {
+    it = ranges_.emplace_hint(it, key_limit, std::move(limit_key));
+  }
+  if (start_key < key) {
+    ranges_.emplace_hint(it, std::move(start_key), key);
+  }
+}
+
+bool KeyRangeSet::Contains(const Key& key) const {
+  auto it = ranges_.upper_bound(key);
+  if (it == ranges_.begin()) {
+    return false;
+  }
+  return key < std::prev(it)->second;
+}
+
+std::vector<KeyRange> KeyRangeSet::ranges() const {
+  std::vector<KeyRange> ranges;
+  ranges.reserve(ranges_.size());
+  for (const auto& [start_key, limit_key] : ranges_) {
+    ranges.push_back(KeyRange::ClosedOpen(start_key, limit_key));
+  }
+  return ranges;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,69 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATAMODEL_KEY_RANGE_SET_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATAMODEL_KEY_RANGE_SET_H_
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// KeyRangeSet is the union of a collection of key ranges, which supports
+// removing individual keys from the union.
+//
+// Unlike KeySet, which is a plain container, the ranges are canonicalized into
+// sorted, disjoint closed-open ranges as they are added, so containment checks
+// and key removals take O(log n) time in the number of disjoint ranges.
+class KeyRangeSet {
+ public:
+  // Adds all keys within `range` to the set.
+  void Add(const KeyRange& range);
+
+  // Removes `key` from the set, splitting the range containing it if needed.
+  // `key` must be a fully specified key.
+  void Remove(const Key& key);
+
+  // Returns true if `key` is within one of the ranges of the set.
+  bool Contains(const Key& key) const;
+
+  // Returns the sorted, disjoint closed-open ranges of the set.
+  std::vector<KeyRange> ranges() const;
+
+  // Returns the number of disjoint ranges in the set.
+  int64_t size() const { return ranges_.size(); }
+
+  bool empty() const { return ranges_.empty(); }
+
+ private:
+  // Disjoint closed-open ranges of the set, mapping each start key to its
+  // limit key. Adjacent and overlapping ranges are merged on insertion.
+  std::map<Key, Key> ranges_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATAMODEL_KEY_RANGE_SET_H_
@@ -0,0 +1,134 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/datamodel/key_range_set.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/public/value.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+using zetasql::values::Int64;
+
+Key K(int64_t value) { return Key({Int64(value)}); }
+
+TEST(KeyRangeSet, EmptySetContainsNoKeys) {
+  KeyRangeSet set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_FALSE(set.Contains(K(1)));
+  EXPECT_THAT(set.ranges(), IsEmpty());
+}
+
+TEST(KeyRangeSet, ContainsKeysOfAddedRanges) {
+  KeyRangeSet set;
+  set.Add(KeyRange::ClosedOpen(K(1), K(3)));
+  set.Add(KeyRange::Point(K(5)));
+
+  EXPECT_FALSE(set.Contains(K(0)));
+  EXPECT_TRUE(set.Contains(K(1)));
+  EXPECT_TRUE(set.Contains(K(2)));
+  EXPECT_FALSE(set.Contains(K(3)));
+  EXPECT_FALSE(set.Contains(K(4)));
+  EXPECT_TRUE(set.Contains(K(5)));
+  EXPECT_FALSE(set.Contains(K(6)));
+}
+
+TEST(KeyRangeSet, CanonicalizesRangesToClosedOpen) {
+  KeyRange range = KeyRange::OpenClosed(K(1), K(3));
+  KeyRangeSet set;
+  set.Add(range);
+
+  EXPECT_FALSE(set.Contains(K(1)));
+  EXPECT_TRUE(set.Contains(K(2)));
+  EXPECT_TRUE(set.Contains(K(3)));
+  EXPECT_THAT(set.ranges(), ElementsAre(range.ToClosedOpen()));
+}
+
+TEST(KeyRangeSet, IgnoresEmptyRanges) {
+  KeyRangeSet set;
+  set.Add(KeyRange::Empty());
+  set.Add(KeyRange::ClosedOpen(K(3), K(1)));
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(KeyRangeSet, MergesOverlappingAndAdjacentRanges) {
+  KeyRangeSet set;
+  set.Add(KeyRange::ClosedOpen(K(5), K(7)));
+  set.Add(KeyRange::ClosedOpen(K(1), K(3)));
+  set.Add(KeyRange::ClosedOpen(K(3), K(4)));
+  EXPECT_THAT(set.ranges(), ElementsAre(KeyRange::ClosedOpen(K(1), K(4)),
+                                        KeyRange::ClosedOpen(K(5), K(7))));
+
+  set.Add(KeyRange::ClosedOpen(K(2), K(6)));
+  EXPECT_THAT(set.ranges(), ElementsAre(KeyRange::ClosedOpen(K(1), K(7))));
+
+  set.Add(KeyRange::ClosedOpen(K(0), K(10)));
+  EXPECT_THAT(set.ranges(), ElementsAre(KeyRange::ClosedOpen(K(0), K(10))));
+}
+
+TEST(KeyRangeSet, RemoveSplitsContainingRange) {
+  KeyRangeSet set;
+  set.Add(KeyRange::ClosedOpen(K(1), K(5)));
+
+  set.Remove(K(3));
+  EXPECT_TRUE(set.Contains(K(2)));
+  EXPECT_FALSE(set.Contains(K(3)));
+  EXPECT_TRUE(set.Contains(K(4)));
+  EXPECT_EQ(set.size(), 2);
+
+  set.Remove(K(1));
+  EXPECT_FALSE(set.Contains(K(1)));
+  EXPECT_TRUE(set.Contains(K(2)));
+  EXPECT_EQ(set.size(), 2);
+
+  // Removing keys outside of the set is a no-op.
+  set.Remove(K(3));
+  set.Remove(K(7));
+  EXPECT_EQ(set.size(), 2);
+}
+
+TEST(KeyRangeSet, RemoveOnlyKeyOfPointRange) {
+  KeyRangeSet set;
+  set.Add(KeyRange::Point(K(1)));
+  set.Remove(K(1));
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(KeyRangeSet, RemoveFromRangeAll) {
+  KeyRangeSet set;
+  set.Add(KeyRange::All());
+  set.Remove(K(1));
+  EXPECT_TRUE(set.Contains(K(0)));
+  EXPECT_FALSE(set.Contains(K(1)));
+  EXPECT_TRUE(set.Contains(K(2)));
+}
+
+}  // namespace
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
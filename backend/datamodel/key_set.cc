@@ -141,6 +141,32 @@ void MakeDisjointKeyRanges(const KeySet& set, std::vector<KeyRange>* ranges) {
   ranges->erase(last + 1, next);
 }
 
+KeySet IntersectKeySets(const KeySet& a, const KeySet& b) {
+  std::vector<KeyRange> a_ranges;
+  std::vector<KeyRange> b_ranges;
+  MakeDisjointKeyRanges(a, &a_ranges);
+  MakeDisjointKeyRanges(b, &b_ranges);
+
+  // Both lists are sorted and disjoint, so walk them together, always
+  // advancing past whichever range ends first.
+  KeySet result;
+  auto a_it = a_ranges.begin();
+  auto b_it = b_ranges.begin();
+  while (a_it != a_ranges.end() && b_it != b_ranges.end()) {
+    Key start_key = std::max(a_it->start_key(), b_it->start_key());
+    Key limit_key = std::min(a_it->limit_key(), b_it->limit_key());
+    if (start_key < limit_key) {
+      result.AddRange(KeyRange::ClosedOpen(start_key, limit_key));
+    }
+    if (a_it->limit_key() < b_it->limit_key()) {
+      ++a_it;
+    } else {
+      ++b_it;
+    }
+  }
+  return result;
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -76,6 +76,10 @@ std::ostream& operator<<(std::ostream& out, const KeySet& set);
 // Converts a key set to a sorted list of disjoint closed-open key ranges.
 void MakeDisjointKeyRanges(const KeySet& set, std::vector<KeyRange>* ranges);
 
+// Returns the intersection of two key sets as a set of sorted, disjoint
+// closed-open key ranges.
+KeySet IntersectKeySets(const KeySet& a, const KeySet& b);
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
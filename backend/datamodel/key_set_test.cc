@@ -410,6 +410,38 @@ bool Contains(const KeySet& keyset, const Key& input) {
   return false;
 }
 
+TEST(KeySet, IntersectsKeySets) {
+  KeySet a;
+  a.AddKey(Key({Int64(1)}));
+  a.AddRange(MakeClosedOpenRange(3, 6));
+  a.AddRange(MakeClosedOpenRange(8, 10));
+  KeySet b(MakeClosedOpenRange(1, 9));
+
+  KeySet intersection = IntersectKeySets(a, b);
+
+  EXPECT_TRUE(intersection.keys().empty());
+  EXPECT_THAT(intersection.ranges(),
+              testing::ElementsAre(KeyRange::Point(Key({Int64(1)})),
+                                   MakeClosedOpenRange(3, 6),
+                                   MakeClosedOpenRange(8, 9)));
+}
+
+TEST(KeySet, IntersectsDisjointKeySets) {
+  KeySet intersection = IntersectKeySets(KeySet(MakeClosedOpenRange(1, 3)),
+                                         KeySet(MakeClosedOpenRange(3, 5)));
+
+  EXPECT_TRUE(intersection.keys().empty());
+  EXPECT_TRUE(intersection.ranges().empty());
+}
+
+TEST(KeySet, IntersectsWithAll) {
+  KeySet a(MakeClosedOpenRange(1, 3));
+
+  EXPECT_THAT(IntersectKeySets(a, KeySet::All()).ranges(),
+              testing::ElementsAre(MakeClosedOpenRange(1, 3)));
+  EXPECT_TRUE(IntersectKeySets(a, KeySet()).ranges().empty());
+}
+
 TEST(KeySet, CanonicalizesRandomKeySet) {
   // Choose a random seed unless one is explicitly provided by the test.
   int seed = absl::GetFlag(
@@ -23,6 +23,7 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/hash/hash.h"
 #include "backend/datamodel/value.h"
 
 namespace google {
@@ -91,6 +92,42 @@ TEST(Key, DoesNotNeedBeginEndParts) {
               testing::ElementsAre(start, b_gt_25, b_eq_25, b_lt_25, end));
 }
 
+TEST(Key, KeepsColumnOrderAttributesOfWideKeys) {
+  // More columns than are stored inline.
+  Key key;
+  for (int i = 0; i < 6; ++i) {
+    key.AddColumn(Int64(i), /*desc=*/i % 2 == 1, /*is_nulls_last=*/i % 3 == 0);
+  }
+  key.SetColumnNullsLast(5, true);
+  key.SetColumnDescending(1, false);
+
+  EXPECT_EQ(6, key.NumColumns());
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(Int64(i), key.ColumnValue(i));
+    EXPECT_EQ(i % 2 == 1 && i != 1, key.IsColumnDescending(i));
+    EXPECT_EQ(i % 3 == 0 || i == 5, key.IsColumnNullsLast(i));
+  }
+
+  Key prefix = key.Prefix(4);
+  EXPECT_EQ(4, prefix.NumColumns());
+  EXPECT_TRUE(prefix.IsColumnDescending(3));
+  EXPECT_TRUE(prefix.IsColumnNullsLast(3));
+  EXPECT_TRUE(prefix.IsPrefixOf(key));
+}
+
+TEST(Key, HashesEqualKeysEqually) {
+  Key key({String("One"), Int64(2)});
+  Key same_key({String("One"), Int64(2)});
+  same_key.SetColumnDescending(1, true);
+  Key other_key({String("One"), Int64(3)});
+
+  EXPECT_EQ(key, same_key);
+  EXPECT_EQ(absl::Hash<Key>()(key), absl::Hash<Key>()(same_key));
+  EXPECT_NE(absl::Hash<Key>()(key), absl::Hash<Key>()(other_key));
+  EXPECT_EQ(absl::Hash<Key>()(Key::Infinity()),
+            absl::Hash<Key>()(Key::Infinity()));
+}
+
 TEST(Key, SortsNullsCorrectly) {
   Key null({String("prefix"), Null(Int64Type())});
   Key one({String("prefix"), Int64(1)});
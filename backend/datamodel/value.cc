@@ -0,0 +1,68 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/datamodel/value.h"
+
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/json_value.h"
+#include "zetasql/public/value.h"
+#include "absl/status/statusor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+void ParseJson(zetasql::Value* value) {
+  if (!value->is_valid() || value->is_null()) {
+    return;
+  }
+  if (value->type()->IsJson()) {
+    if (!value->is_unparsed_json()) {
+      return;
+    }
+    absl::StatusOr<zetasql::JSONValue> json =
+        zetasql::JSONValue::ParseJSONString(value->json_value_unparsed());
+    if (json.ok()) {
+      *value = zetasql::Value::Json(*std::move(json));
+    }
+    return;
+  }
+  if (!value->type()->IsArray() ||
+      !value->type()->AsArray()->element_type()->IsJson()) {
+    return;
+  }
+  bool unparsed = false;
+  for (const zetasql::Value& element : value->elements()) {
+    unparsed = unparsed || (!element.is_null() && element.is_unparsed_json());
+  }
+  if (!unparsed) {
+    return;
+  }
+  std::vector<zetasql::Value> elements = value->elements();
+  for (zetasql::Value& element : elements) {
+    ParseJson(&element);
+  }
+  *value = zetasql::Value::Array(value->type()->AsArray(), elements);
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -37,6 +37,13 @@ inline bool operator<(const zetasql::Value& v1, const zetasql::Value& v2) {
 // ValueList is a simple array of Values.
 typedef std::vector<zetasql::Value> ValueList;
 
+// Replaces an unparsed JSON `value`, or an array of JSON values with unparsed
+// elements, by its parsed form, so that JSON functions do not parse the same
+// text again on each call. zetasql::Value::Deserialize() and JSON literals
+// that skip validation produce unparsed JSON. Copies of the parsed value
+// share its document. JSON text that fails to parse is left unparsed.
+void ParseJson(zetasql::Value* value);
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
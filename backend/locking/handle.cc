@@ -21,14 +21,31 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "backend/locking/manager.h"
 #include "common/errors.h"
+#include "common/metrics.h"
+#include "common/tracing.h"
 
 namespace google {
 namespace spanner {
 namespace emulator {
 namespace backend {
 
+namespace {
+
+// Time spent waiting for locks and for reads to become safe at a timestamp.
+metrics::Histogram* LockWaitLatency() {
+  static metrics::Histogram* histogram =
+      metrics::MetricRegistry::Global()->GetHistogram(
+          "emulator_lock_wait_seconds",
+          "Time spent waiting for locks and safe read timestamps, in seconds.",
+          metrics::LatencyBuckets());
+  return histogram;
+}
+
+}  // namespace
+
 LockHandle::LockHandle(LockManager* manager, TransactionID tid,
                        const std::function<absl::Status()>& abort_fn,
                        TransactionPriority priority)
@@ -48,11 +65,7 @@ void LockHandle::EnqueueLock(const LockRequest& request) {
 
 void LockHandle::UnlockAll() { manager_->UnlockAll(this); }
 
-bool LockHandle::IsBlocked() {
-  // The current implementation never blocks.
-  absl::MutexLock lock(&mu_);
-  return false;
-}
+bool LockHandle::IsBlocked() { return manager_->HasPendingRequests(this); }
 
 bool LockHandle::IsAborted() {
   absl::MutexLock lock(&mu_);
@@ -60,7 +73,13 @@ bool LockHandle::IsAborted() {
 }
 
 absl::Status LockHandle::Wait() {
-  // The current implementation never blocks.
+  metrics::ScopedLatencyRecorder latency_recorder(LockWaitLatency());
+  tracing::ScopedSpan span("LockHandle::Wait");
+  manager_->WaitForLocks(this);
+  return status();
+}
+
+absl::Status LockHandle::status() {
   absl::MutexLock lock(&mu_);
   return status_;
 }
@@ -95,10 +114,13 @@ absl::StatusOr<absl::Time> LockHandle::ReserveCommitTimestamp() {
 }
 
 absl::Status LockHandle::MarkCommitted() {
-  return manager_->MarkCommitted(this);
+  LockHandle* handle = this;
+  return manager_->MarkCommitted(absl::MakeConstSpan(&handle, 1));
 }
 
 void LockHandle::WaitForSafeRead(absl::Time read_time) {
+  metrics::ScopedLatencyRecorder latency_recorder(LockWaitLatency());
+  tracing::ScopedSpan span("LockHandle::WaitForSafeRead");
   manager_->WaitForSafeRead(read_time);
 }
 
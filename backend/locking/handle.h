@@ -17,6 +17,10 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_LOCKING_HANDLE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_LOCKING_HANDLE_H_
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -43,7 +47,8 @@ class LockManager;
 // EnqueueLock() is non-blocking and only enqueues the lock request. The
 // transaction can subsequently query whether the requests have completed by
 // checking IsBlocked() or perform a blocking Wait() to find out the final
-// state of the lock requests.
+// state of the lock requests. Requests only block when the lock manager
+// schedules conflicts with wound-wait (see LockManager).
 //
 // Usage (happy path, error handling skipped):
 //    // Get a handle.
@@ -81,7 +86,7 @@ class LockHandle {
   void UnlockAll();
 
   // Returns true if this handle is waiting on any lock requests to complete.
-  bool IsBlocked() ABSL_LOCKS_EXCLUDED(mu_);
+  bool IsBlocked();
 
   // Returns true if this handle has been aborted by the lock manager. Previous
   // locks acquired by the handle are not release automatically. The handle must
@@ -123,6 +128,9 @@ class LockHandle {
   // Resets the state of this handle.
   void Reset() ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Returns the status of the lock handle requests.
+  absl::Status status() ABSL_LOCKS_EXCLUDED(mu_);
+
   // The LockManager which this LockHandle interacts with.
   LockManager* const manager_;
 
@@ -144,6 +152,10 @@ class LockHandle {
 
   // The status of the lock handle requests.
   absl::Status status_ ABSL_GUARDED_BY(mu_);
+
+  // Requests which wait for conflicting locks to be released, in the order
+  // they were enqueued. Guarded by the mutex of the lock manager.
+  std::vector<LockRequest> pending_requests_;
 };
 
 }  // namespace backend
@@ -16,20 +16,29 @@
 
 #include "backend/locking/manager.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/random/random.h"
 #include "absl/random/uniform_int_distribution.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "backend/common/ids.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/locking/request.h"
 #include "common/config.h"
 #include "common/errors.h"
+#include "common/metrics.h"
 #include "zetasql/base/ret_check.h"
 
 namespace google {
@@ -37,12 +46,166 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
+namespace {
+
+// How often a transaction waiting for locks retries wounding the younger
+// holders of the locks which were busy when it last tried.
+constexpr absl::Duration kWoundRetryInterval = absl::Milliseconds(10);
+
+// Transactions aborted by the lock manager, by reason: "wounded" for holders
+// aborted in favor of a conflicting request, "lock_conflict" for requesters
+// which could not wound the holders, "lock_wait_timeout" for requesters which
+// waited for locks in vain, and "commit_conflict" for commits conflicting with
+// the locks of another transaction.
+metrics::Counter* LockAborts(absl::string_view reason) {
+  return metrics::MetricRegistry::Global()->GetCounter(
+      "emulator_lock_aborts_total",
+      "Number of transactions aborted because of lock conflicts.",
+      {{"reason", std::string(reason)}});
+}
+
+}  // namespace
+
 std::unique_ptr<LockHandle> LockManager::CreateHandle(
     TransactionID tid, const std::function<absl::Status()>& abort_fn,
     TransactionPriority priority) {
   return absl::WrapUnique(new LockHandle(this, tid, abort_fn, priority));
 }
 
+bool LockManager::Conflicts(const LockRequest& request,
+                            const LockRequest& held) const {
+  if (!config::concurrent_read_write_transactions_enabled()) {
+    // Any lock held by another transaction conflicts.
+    return true;
+  }
+  return request.ConflictsWith(held);
+}
+
+std::vector<LockHandle*> LockManager::FindConflictingHolders(
+    LockHandle* handle, const LockRequest& request,
+    absl::Time* first_granted_at) {
+  std::vector<LockHandle*> holders;
+  auto check_table_locks = [&](const TableLocks& table_locks) {
+    for (const auto& [tid, held_locks] : table_locks) {
+      if (tid == handle->tid() ||
+          std::find(holders.begin(), holders.end(), held_locks.handle) !=
+              holders.end()) {
+        continue;
+      }
+      for (const LockRequest& held : held_locks.requests) {
+        if (Conflicts(request, held)) {
+          holders.push_back(held_locks.handle);
+          if (first_granted_at != nullptr) {
+            *first_granted_at =
+                std::min(*first_granted_at, held_locks.granted_at);
+          }
+          break;
+        }
+      }
+    }
+  };
+
+  if (request.IsDatabaseWide() ||
+      !config::concurrent_read_write_transactions_enabled()) {
+    for (const auto& [table_id, table_locks] : lock_table_) {
+      check_table_locks(table_locks);
+    }
+    return holders;
+  }
+  for (const TableID& table_id : {request.table_id(), TableID()}) {
+    auto itr = lock_table_.find(table_id);
+    if (itr != lock_table_.end()) {
+      check_table_locks(itr->second);
+    }
+  }
+  return holders;
+}
+
+void LockManager::Grant(LockHandle* handle, const LockRequest& request) {
+  TableLocks& table_locks = lock_table_[request.table_id()];
+  auto [itr, inserted] = table_locks.try_emplace(handle->tid());
+  HeldLocks& held_locks = itr->second;
+  if (inserted) {
+    held_locks.handle = handle;
+    held_locks.granted_at = absl::Now();
+    locked_tables_[handle->tid()].push_back(request.table_id());
+  }
+  for (const LockRequest& held : held_locks.requests) {
+    if (held.Covers(request)) {
+      return;
+    }
+  }
+  held_locks.requests.push_back(request);
+}
+
+void LockManager::ReleaseLocks(TransactionID tid) {
+  auto itr = locked_tables_.find(tid);
+  if (itr == locked_tables_.end()) {
+    return;
+  }
+  for (const TableID& table_id : itr->second) {
+    auto table_itr = lock_table_.find(table_id);
+    if (table_itr == lock_table_.end()) {
+      continue;
+    }
+    table_itr->second.erase(tid);
+    if (table_itr->second.empty()) {
+      lock_table_.erase(table_itr);
+    }
+  }
+  locked_tables_.erase(itr);
+  lock_released_cvar_.SignalAll();
+}
+
+absl::Time LockManager::MinPendingCommitTimestamp() const {
+  absl::Time min_timestamp = absl::InfiniteFuture();
+  for (const auto& [tid, timestamp] : pending_commit_timestamps_) {
+    min_timestamp = std::min(min_timestamp, timestamp);
+  }
+  return min_timestamp;
+}
+
+bool LockManager::IsOlder(LockHandle* handle, LockHandle* other) {
+  if (handle->priority() != other->priority()) {
+    return handle->priority() < other->priority();
+  }
+  return handle->tid() < other->tid();
+}
+
+bool LockManager::WoundOrWait(LockHandle* handle, const LockRequest& request,
+                              absl::Span<LockHandle* const> holders) {
+  bool must_wait = false;
+  for (LockHandle* holder : holders) {
+    if (!IsOlder(handle, holder)) {
+      must_wait = true;
+      continue;
+    }
+    absl::Status status =
+        error::AbortCurrentTransaction(holder->tid(), handle->tid());
+    const bool already_wounded = holder->IsAborted();
+    if (!already_wounded) {
+      LockAborts("wounded")->Increment();
+    }
+    if (holder->TryAbortTransaction(status).ok()) {
+      // Locks of the aborted transaction are released right away.
+      ReleaseLocks(holder->tid());
+      continue;
+    }
+    // The holder is in the middle of an operation. It fails its next lock
+    // wait, or wakes up from its current one, and then releases its locks.
+    if (!already_wounded) {
+      holder->Abort(status);
+      lock_released_cvar_.SignalAll();
+    }
+    must_wait = true;
+  }
+  if (must_wait) {
+    return false;
+  }
+  Grant(handle, request);
+  return true;
+}
+
 void LockManager::EnqueueLock(LockHandle* handle, const LockRequest& request) {
   absl::MutexLock lock(&mu_);
 
@@ -51,49 +214,107 @@ void LockManager::EnqueueLock(LockHandle* handle, const LockRequest& request) {
     return;
   }
 
-  // If there is no transaction holding the lock, we grant it.
-  if (active_handle_ == nullptr) {
-    active_handle_ = handle;
+  // Requests behind a waiting one are granted in order by Wait().
+  if (!handle->pending_requests_.empty()) {
+    handle->pending_requests_.push_back(request);
+    return;
+  }
+
+  // If no other transaction holds a conflicting lock, we grant it.
+  absl::Time first_granted_at = absl::InfiniteFuture();
+  std::vector<LockHandle*> holders =
+      FindConflictingHolders(handle, request, &first_granted_at);
+  if (holders.empty()) {
+    Grant(handle, request);
     return;
   }
+  absl::Time now = absl::Now();
+  lock_stats_.RecordConflict(
+      request.table_id(), request.key_range().start_key().DebugString(),
+      std::max(now - first_granted_at, absl::ZeroDuration()), now);
 
-  // If the requesting transaction is already holding the lock, we grant it.
-  if (active_handle_->tid() == handle->tid()) {
+  if (config::lock_wait_timeout() > absl::ZeroDuration()) {
+    if (!WoundOrWait(handle, request, holders)) {
+      handle->pending_requests_.push_back(request);
+    }
     return;
   }
 
-  // If we reached here, another transaction is already holding the lock.
-  // Randomly abort the current transaction to ensure that starting a new
-  // transaction is not blocked by the current transaction if this is waiting
-  // for a new transaction to finish.
+  // If we reached here, other transactions are already holding conflicting
+  // locks. Randomly abort them to ensure that starting a new transaction is not
+  // blocked by the current transactions if these are waiting for a new
+  // transaction to finish.
   absl::BitGen gen;
   if (absl::uniform_int_distribution<int>(1, 100)(gen) <=
       config::abort_current_transaction_probability()) {
-    auto could_be_aborted = active_handle_->TryAbortTransaction(
-        error::AbortCurrentTransaction(active_handle_->tid(), handle->tid()));
-    if (could_be_aborted.ok()) {
-      active_handle_ = handle;
+    bool all_aborted = true;
+    for (LockHandle* holder : holders) {
+      auto could_be_aborted = holder->TryAbortTransaction(
+          error::AbortCurrentTransaction(holder->tid(), handle->tid()));
+      if (!could_be_aborted.ok()) {
+        all_aborted = false;
+        continue;
+      }
+      // Locks of the aborted transaction are released right away.
+      ReleaseLocks(holder->tid());
+      LockAborts("wounded")->Increment();
+    }
+    if (all_aborted) {
+      Grant(handle, request);
       return;
     }
   }
 
-  // Couldn't abort the transaction currently holding the lock, so abort the
-  // new transaction.
-  handle->Abort(
-      error::AbortConcurrentTransaction(handle->tid(), active_handle_->tid()));
+  // Couldn't abort the transactions holding the locks, so abort the new
+  // transaction.
+  LockAborts("lock_conflict")->Increment();
+  handle->Abort(error::AbortConcurrentTransaction(handle->tid(),
+                                                  holders.front()->tid()));
 }
 
-void LockManager::UnlockAll(LockHandle* handle) {
+void LockManager::WaitForLocks(LockHandle* handle) {
   absl::MutexLock lock(&mu_);
-
-  // If the transaction does not hold the lock, there is nothing to do.
-  if (active_handle_ == nullptr || active_handle_->tid() != handle->tid()) {
-    handle->Reset();
-    return;
+  const absl::Time deadline = absl::Now() + config::lock_wait_timeout();
+  while (!handle->pending_requests_.empty() && !handle->IsAborted()) {
+    const LockRequest& request = handle->pending_requests_.front();
+    std::vector<LockHandle*> holders = FindConflictingHolders(handle, request);
+    if (holders.empty()) {
+      Grant(handle, request);
+      handle->pending_requests_.erase(handle->pending_requests_.begin());
+      continue;
+    }
+    // Younger holders are wounded again on every attempt: they may have been
+    // granted their locks while this transaction was waiting, and wounded
+    // holders which were busy can be aborted once they are idle.
+    if (WoundOrWait(handle, request, holders)) {
+      handle->pending_requests_.erase(handle->pending_requests_.begin());
+      continue;
+    }
+    if (absl::Now() >= deadline) {
+      LockAborts("lock_wait_timeout")->Increment();
+      handle->Abort(error::AbortConcurrentTransaction(handle->tid(),
+                                                      holders.front()->tid()));
+      break;
+    }
+    // Wounded holders which go idle release nothing by themselves, so the
+    // wait is also cut short periodically to retry wounding them.
+    lock_released_cvar_.WaitWithTimeout(
+        &mu_, std::min(kWoundRetryInterval, deadline - absl::Now()));
   }
+  handle->pending_requests_.clear();
+}
 
-  // Clear the active transaction if it holds the lock.
-  active_handle_ = nullptr;
+bool LockManager::HasPendingRequests(LockHandle* handle) {
+  absl::MutexLock lock(&mu_);
+  return !handle->pending_requests_.empty();
+}
+
+void LockManager::UnlockAll(LockHandle* handle) {
+  absl::MutexLock lock(&mu_);
+
+  // Release the locks if the transaction holds any.
+  ReleaseLocks(handle->tid());
+  handle->pending_requests_.clear();
   handle->Reset();
 }
 
@@ -101,35 +322,89 @@ absl::StatusOr<absl::Time> LockManager::ReserveCommitTimestamp(
     LockHandle* handle) {
   absl::MutexLock lock(&mu_);
 
-  // If there is no transaction holding the lock, we grant it to the transaction
-  // requesting commit timestamp. This can happen if transaction has empty
-  // mutations and write locks weren't thus acquired yet.
-  if (active_handle_ == nullptr) {
-    active_handle_ = handle;
-  } else if (active_handle_->tid() != handle->tid()) {
-    // There is another active transaction, abort this transaction.
-    return error::AbortConcurrentTransaction(handle->tid(),
-                                             active_handle_->tid());
+  // A transaction wounded by an older one while it was busy must not commit.
+  absl::Status status = handle->status();
+  if (!status.ok()) {
+    return status;
+  }
+
+  // A commit conflicts with exclusive database-wide locks (e.g. held by schema
+  // changes) of other transactions. If concurrent read-write transactions are
+  // disabled, it conflicts with any lock held by another transaction.
+  bool concurrent = config::concurrent_read_write_transactions_enabled();
+  for (const auto& [table_id, table_locks] : lock_table_) {
+    for (const auto& [tid, held_locks] : table_locks) {
+      if (tid == handle->tid()) {
+        continue;
+      }
+      for (const LockRequest& held : held_locks.requests) {
+        if (!concurrent || (held.IsDatabaseWide() &&
+                            held.mode() == LockMode::kExclusive)) {
+          // There is another active transaction, abort this transaction.
+          absl::Time now = absl::Now();
+          lock_stats_.RecordConflict(
+              held.table_id(), held.key_range().start_key().DebugString(),
+              std::max(now - held_locks.granted_at, absl::ZeroDuration()),
+              now);
+          LockAborts("commit_conflict")->Increment();
+          return error::AbortConcurrentTransaction(handle->tid(), tid);
+        }
+      }
+    }
+  }
+  // If concurrent read-write transactions are disabled, we grant the database
+  // lock to the transaction requesting commit timestamp. This can happen if
+  // transaction has empty mutations and write locks weren't thus acquired yet.
+  if (!concurrent) {
+    Grant(handle, LockRequest(LockMode::kExclusive, /*table_id=*/"",
+                              KeyRange::All(), /*column_ids=*/{}));
   }
 
-  pending_commit_timestamp_ = clock_->Now();
-  return pending_commit_timestamp_;
+  // Announce the commit before taking its timestamp (see
+  // pending_commit_count_).
+  pending_commit_count_.fetch_add(1);
+  absl::Time commit_timestamp = clock_->Now();
+  pending_commit_timestamps_[handle->tid()] = commit_timestamp;
+  pending_commit_count_.store(pending_commit_timestamps_.size());
+  return commit_timestamp;
 }
 
-absl::Status LockManager::MarkCommitted(LockHandle* handle) {
+absl::Status LockManager::MarkCommitted(
+    absl::Span<LockHandle* const> handles) {
   absl::MutexLock lock(&mu_);
 
-  // This transaction should have been set as the active transaction.
-  ZETASQL_RET_CHECK_EQ(active_handle_->tid(), handle->tid())
-      << absl::Substitute("Transaction $0 is not active.", handle->tid());
-
-  last_commit_timestamp_ = pending_commit_timestamp_;
-  pending_commit_timestamp_ = absl::InfiniteFuture();
+  // Waiters are woken even if one of the transactions is not active, since
+  // the commits before it have already been marked.
+  absl::Status status;
+  for (LockHandle* handle : handles) {
+    // This transaction should have reserved a commit timestamp.
+    auto itr = pending_commit_timestamps_.find(handle->tid());
+    if (itr == pending_commit_timestamps_.end()) {
+      status = error::Internal(
+          absl::Substitute("Transaction $0 is not active.", handle->tid()));
+      break;
+    }
+    last_commit_timestamp_ = std::max(last_commit_timestamp_, itr->second);
+    pending_commit_timestamps_.erase(itr);
+  }
+  pending_commit_count_.store(pending_commit_timestamps_.size());
+  // Commits reserved from now on get timestamps after clock_->Now(), and the
+  // ones still pending are at or after their minimum.
+  safe_read_micros_.store(absl::ToUnixMicros(
+      std::min(MinPendingCommitTimestamp(), clock_->Now())));
   pending_commit_cvar_.SignalAll();
-  return absl::OkStatus();
+  return status;
 }
 
 void LockManager::WaitForSafeRead(absl::Time read_time) {
+  // Reads at or before the watermark need not wait for anything. Neither do
+  // reads of the past while no commit is in progress: a commit that starts now
+  // gets a timestamp after clock_->Now() >= read_time.
+  if (absl::ToUnixMicros(read_time) <= safe_read_micros_.load() ||
+      (read_time <= clock_->Now() && pending_commit_count_.load() == 0)) {
+    return;
+  }
+
   absl::MutexLock lock(&mu_);
 
   // Wait for read time to become current if passed a future timestamp  for the
@@ -138,16 +413,33 @@ void LockManager::WaitForSafeRead(absl::Time read_time) {
   bool f = false;
   mu_.AwaitWithDeadline(absl::Condition(&f), read_time);
 
-  while (pending_commit_timestamp_ < read_time) {
+  while (MinPendingCommitTimestamp() < read_time) {
     pending_commit_cvar_.Wait(&mu_);
   }
 }
 
+absl::Time LockManager::SafeReadTimestamp() {
+  // The clock is read before the commit count, so that a commit which is not
+  // counted yet gets a timestamp after `now` (see pending_commit_count_).
+  const absl::Time now = clock_->Now();
+  if (pending_commit_count_.load() == 0) {
+    return now;
+  }
+  absl::ReaderMutexLock lock(&mu_);
+  return std::min(now, MinPendingCommitTimestamp() - absl::Microseconds(1));
+}
+
 absl::Time LockManager::LastCommitTimestamp() {
   absl::ReaderMutexLock lock(&mu_);
   return last_commit_timestamp_;
 }
 
+bool LockManager::IsSnapshotImmutable(absl::Time read_time) {
+  absl::MutexLock lock(&mu_);
+  return read_time <= last_commit_timestamp_ &&
+         MinPendingCommitTimestamp() > read_time;
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -17,15 +17,23 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_LOCKING_MANAGER_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_LOCKING_MANAGER_H_
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "backend/common/ids.h"
+#include "backend/common/sys_stats.h"
 #include "backend/locking/handle.h"
+#include "backend/locking/request.h"
 #include "common/clock.h"
 
 namespace google {
@@ -40,9 +48,29 @@ namespace backend {
 // happens via the LockHandle. See LockHandle methods for more details about
 // this interaction.
 //
-// We currently only implement a whole-database lock. The interface is generic
-// to avoid irreversibly baking the single-lock assumption into the rest of the
-// system.
+// Granted locks are tracked in a lock table keyed by table, holding the key
+// range, columns and mode of every granted LockRequest. By default any lock
+// held by one transaction conflicts with every lock requested by another
+// transaction, i.e. the database behaves as if protected by a single lock.
+// When concurrent read-write transactions are enabled (see
+// config::concurrent_read_write_transactions_enabled()), only requests that
+// overlap in table, key range and columns with at least one of them being
+// exclusive conflict, which allows non-conflicting transactions to run and
+// commit at the same time.
+//
+// By default, conflicts are never waited on. Instead, the requester randomly
+// tries to wound the conflicting holders and is aborted if that fails. If
+// config::lock_wait_timeout() is positive, conflicts are scheduled with
+// wound-wait instead: a requester wounds, i.e. aborts, the holders which are
+// younger than it, and waits in LockHandle::Wait() for the older ones to
+// release their locks, up to the timeout. Transactions are ordered by
+// priority, which is kept across retries so that a retried transaction ages,
+// and then by id. Since only younger transactions ever wait for older ones,
+// waits cannot deadlock. Holders which are busy when they are wounded are
+// aborted at their next lock wait or commit. Conflicts,
+// including those which abort a commit, are recorded in the lock statistics
+// of the database (see LockStats), and aborts are counted by reason in the
+// emulator_lock_aborts_total metric.
 class LockManager {
  public:
   explicit LockManager(Clock* clock) : clock_(clock) {}
@@ -57,6 +85,25 @@ class LockManager {
   // Returns the timestamp at which last schema update or commit completed.
   absl::Time LastCommitTimestamp();
 
+  // Returns the newest timestamp at which a read does not wait for a commit:
+  // it is before the timestamps of the commits in progress, and commits which
+  // start later get later timestamps.
+  absl::Time SafeReadTimestamp() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if the database state at `read_time` can no longer change:
+  // no commit at or before `read_time` is pending, and a later commit always
+  // gets a timestamp after the last completed commit.
+  bool IsSnapshotImmutable(absl::Time read_time) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Marks the commits of all `handles`, which must have reserved commit
+  // timestamps, as completed, and wakes the reads waiting on any of them at
+  // once. Used to complete a group of commits flushed together.
+  absl::Status MarkCommitted(absl::Span<LockHandle* const> handles)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the statistics of the lock conflicts in this database.
+  const LockStats& lock_stats() const { return lock_stats_; }
+
  private:
   // LockHandle simply forwards requests to the LockManager.
   friend class LockHandle;
@@ -65,27 +112,99 @@ class LockManager {
   void UnlockAll(LockHandle* handle) ABSL_LOCKS_EXCLUDED(mu_);
   absl::StatusOr<absl::Time> ReserveCommitTimestamp(LockHandle* handle)
       ABSL_LOCKS_EXCLUDED(mu_);
-  absl::Status MarkCommitted(LockHandle* handle) ABSL_LOCKS_EXCLUDED(mu_);
   void WaitForSafeRead(absl::Time read_time) ABSL_LOCKS_EXCLUDED(mu_);
+  void WaitForLocks(LockHandle* handle) ABSL_LOCKS_EXCLUDED(mu_);
+  bool HasPendingRequests(LockHandle* handle) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if the transaction of `handle` is older, i.e. has precedence
+  // over, the transaction of `other`.
+  static bool IsOlder(LockHandle* handle, LockHandle* other);
+
+  // Wounds the `holders` of locks conflicting with `request` which are
+  // younger than `handle`, and grants `request` if all of them could be aborted
+  // right away. Returns false if `handle` must wait.
+  bool WoundOrWait(LockHandle* handle, const LockRequest& request,
+                   absl::Span<LockHandle* const> holders)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Locks held by a single transaction on a single table.
+  struct HeldLocks {
+    LockHandle* handle = nullptr;
+    std::vector<LockRequest> requests;
+
+    // When the transaction was first granted a lock on the table.
+    absl::Time granted_at;
+  };
+
+  // Granted locks of all transactions on a single table.
+  using TableLocks = absl::flat_hash_map<TransactionID, HeldLocks>;
+
+  // Returns true if `request` conflicts with `held`, a lock granted to
+  // another transaction.
+  bool Conflicts(const LockRequest& request, const LockRequest& held) const;
+
+  // Returns the handles of other transactions holding locks that conflict
+  // with `request` from `handle`. If `first_granted_at` is set, it is set to
+  // the earliest time at which one of them was granted its locks.
+  std::vector<LockHandle*> FindConflictingHolders(
+      LockHandle* handle, const LockRequest& request,
+      absl::Time* first_granted_at = nullptr)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Records `request` as granted to `handle`.
+  void Grant(LockHandle* handle, const LockRequest& request)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Releases all locks held by the transaction with the given id.
+  void ReleaseLocks(TransactionID tid) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the earliest commit timestamp reserved by an in-progress commit,
+  // or absl::InfiniteFuture() if there are none.
+  absl::Time MinPendingCommitTimestamp() const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Mutex to guard state below.
   absl::Mutex mu_;
 
-  // The currently active transaction (only one transaction can be active).
-  LockHandle* active_handle_ ABSL_GUARDED_BY(mu_) = nullptr;
+  // The lock table. Database-wide locks are keyed by the empty table id.
+  absl::flat_hash_map<TableID, TableLocks> lock_table_ ABSL_GUARDED_BY(mu_);
+
+  // The tables on which each transaction currently holds locks.
+  absl::flat_hash_map<TransactionID, std::vector<TableID>> locked_tables_
+      ABSL_GUARDED_BY(mu_);
 
   // System wide monotonic clock used to provide commit and read timestamps.
   Clock* clock_;
 
+  // Statistics of the conflicts between lock requests.
+  LockStats lock_stats_;
+
   // Timestamp at which last schema update or commit completed.
   absl::Time last_commit_timestamp_ ABSL_GUARDED_BY(mu_) = absl::InfinitePast();
 
-  // Commit timestamp being used by an in-progress commit.
-  absl::Time pending_commit_timestamp_ ABSL_GUARDED_BY(mu_) =
-      absl::InfiniteFuture();
+  // Commit timestamps being used by in-progress commits.
+  absl::flat_hash_map<TransactionID, absl::Time> pending_commit_timestamps_
+      ABSL_GUARDED_BY(mu_);
 
-  // Signals completion of pending commit.
+  // Signals completion of a pending commit.
   absl::CondVar pending_commit_cvar_ ABSL_GUARDED_BY(mu_);
+
+  // Signals the release of locks, or the wounding of a waiting transaction.
+  absl::CondVar lock_released_cvar_ ABSL_GUARDED_BY(mu_);
+
+  // Lock-free state consulted by WaitForSafeRead before it takes `mu_`; only
+  // written with `mu_` held.
+  //
+  // The safe read watermark in microseconds since the unix epoch: every commit
+  // with an earlier timestamp has completed, and commits reserved later get a
+  // timestamp at or after it, so reads at or before it never wait.
+  std::atomic<int64_t> safe_read_micros_ =
+      absl::ToUnixMicros(absl::InfinitePast());
+
+  // Number of in-progress commits. Raised before a commit timestamp is taken
+  // from `clock_`, so a reader that sees zero knows that any commit it races
+  // gets a timestamp after the clock value the reader took.
+  std::atomic<int64_t> pending_commit_count_ = 0;
 };
 
 }  // namespace backend
@@ -17,8 +17,10 @@
 #include "backend/locking/manager.h"
 
 #include <atomic>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <string>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -26,8 +28,16 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/status/status.h"
 #include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "backend/common/ids.h"
+#include "backend/common/sys_stats.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "common/config.h"
+#include "common/metrics.h"
+#include "zetasql/public/value.h"
 
 namespace google {
 namespace spanner {
@@ -189,6 +199,329 @@ TEST_F(LockManagerTest, EnsuresSerializationWithParallelTransactions) {
   EXPECT_EQ(n * k, GetValue(absl::InfiniteFuture()));
 }
 
+class ConcurrentLockManagerTest : public LockManagerTest {
+ public:
+  ConcurrentLockManagerTest() {
+    config::set_concurrent_read_write_transactions_enabled(true);
+    config::set_abort_current_transaction_probability(0);
+  }
+  ~ConcurrentLockManagerTest() override {
+    config::set_concurrent_read_write_transactions_enabled(false);
+    config::set_abort_current_transaction_probability(
+        previous_abort_probability_);
+  }
+
+  std::unique_ptr<LockHandle> CreateHandle(TransactionID id) {
+    return manager()->CreateHandle(id, /*try_abort_fn=*/nullptr,
+                                   TransactionPriority(1));
+  }
+
+  static LockRequest RowRequest(LockMode mode, const std::string& table,
+                                int64_t key,
+                                std::vector<ColumnID> columns = {}) {
+    return LockRequest(mode, table,
+                       KeyRange::Point(Key({zetasql::values::Int64(key)})),
+                       columns);
+  }
+
+ private:
+  int previous_abort_probability_ =
+      config::abort_current_transaction_probability();
+};
+
+TEST_F(ConcurrentLockManagerTest, DisjointKeysDoNotConflict) {
+  auto lh1 = CreateHandle(TransactionID(1));
+  auto lh2 = CreateHandle(TransactionID(2));
+
+  lh1->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1));
+  ZETASQL_EXPECT_OK(lh1->Wait());
+  lh2->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 2));
+  ZETASQL_EXPECT_OK(lh2->Wait());
+  lh2->EnqueueLock(RowRequest(LockMode::kExclusive, "other_table", 1));
+  ZETASQL_EXPECT_OK(lh2->Wait());
+
+  // Both transactions can commit concurrently.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time t1, lh1->ReserveCommitTimestamp());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time t2, lh2->ReserveCommitTimestamp());
+  EXPECT_LT(t1, t2);
+  ZETASQL_EXPECT_OK(lh2->MarkCommitted());
+  ZETASQL_EXPECT_OK(lh1->MarkCommitted());
+  EXPECT_EQ(manager()->LastCommitTimestamp(), t2);
+}
+
+TEST_F(ConcurrentLockManagerTest, SharedLocksDoNotConflict) {
+  auto lh1 = CreateHandle(TransactionID(1));
+  auto lh2 = CreateHandle(TransactionID(2));
+
+  lh1->EnqueueLock(
+      LockRequest(LockMode::kShared, "table", KeyRange::All(), {}));
+  ZETASQL_EXPECT_OK(lh1->Wait());
+  lh2->EnqueueLock(
+      LockRequest(LockMode::kShared, "table", KeyRange::All(), {}));
+  ZETASQL_EXPECT_OK(lh2->Wait());
+}
+
+TEST_F(ConcurrentLockManagerTest, OverlappingExclusiveLockIsAborted) {
+  auto lh1 = CreateHandle(TransactionID(1));
+  auto lh2 = CreateHandle(TransactionID(2));
+
+  lh1->EnqueueLock(
+      LockRequest(LockMode::kShared, "table", KeyRange::All(), {}));
+  ZETASQL_EXPECT_OK(lh1->Wait());
+  lh2->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 5));
+  EXPECT_THAT(lh2->Wait(),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kAborted));
+
+  // Once the first transaction releases its locks, the row can be locked.
+  lh1->UnlockAll();
+  lh2->UnlockAll();
+  lh2->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 5));
+  ZETASQL_EXPECT_OK(lh2->Wait());
+}
+
+TEST_F(ConcurrentLockManagerTest, ConflictsAreRecordedInLockStats) {
+  auto lh1 = CreateHandle(TransactionID(1));
+  auto lh2 = CreateHandle(TransactionID(2));
+
+  lh1->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1));
+  ZETASQL_EXPECT_OK(lh1->Wait());
+  lh2->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 2));
+  ZETASQL_EXPECT_OK(lh2->Wait());
+  EXPECT_TRUE(manager()->lock_stats().Entries().empty());
+
+  lh2->EnqueueLock(RowRequest(LockMode::kShared, "table", 1));
+  EXPECT_THAT(lh2->Wait(),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kAborted));
+
+  std::vector<IntervalEntry<LockStatsEntry>> entries =
+      manager()->lock_stats().Entries();
+  ASSERT_EQ(entries.size(), 1);
+  EXPECT_EQ(entries[0].entry.table_id, "table");
+  EXPECT_EQ(entries[0].entry.row_range_start_key,
+            Key({zetasql::values::Int64(1)}).DebugString());
+  EXPECT_EQ(entries[0].entry.conflict_count, 1);
+  EXPECT_GE(entries[0].entry.total_lock_wait, absl::ZeroDuration());
+}
+
+TEST_F(ConcurrentLockManagerTest, CommitConflictsAreRecordedAsAborts) {
+  metrics::Counter* commit_aborts =
+      metrics::MetricRegistry::Global()->GetCounter(
+          "emulator_lock_aborts_total", "", {{"reason", "commit_conflict"}});
+  const int64_t previous_commit_aborts = commit_aborts->value();
+  auto lh1 = CreateHandle(TransactionID(1));
+  auto lh2 = CreateHandle(TransactionID(2));
+
+  lh1->EnqueueLock(
+      LockRequest(LockMode::kExclusive, /*table_id=*/"", KeyRange::All(), {}));
+  ZETASQL_EXPECT_OK(lh1->Wait());
+  EXPECT_THAT(lh2->ReserveCommitTimestamp(),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kAborted));
+
+  std::vector<IntervalEntry<LockStatsEntry>> entries =
+      manager()->lock_stats().Entries();
+  ASSERT_EQ(entries.size(), 1);
+  EXPECT_EQ(entries[0].entry.table_id, "");
+  EXPECT_EQ(entries[0].entry.conflict_count, 1);
+  EXPECT_EQ(commit_aborts->value(), previous_commit_aborts + 1);
+}
+
+TEST_F(ConcurrentLockManagerTest, DisjointColumnsDoNotConflict) {
+  auto lh1 = CreateHandle(TransactionID(1));
+  auto lh2 = CreateHandle(TransactionID(2));
+  auto lh3 = CreateHandle(TransactionID(3));
+
+  lh1->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1, {"c1"}));
+  ZETASQL_EXPECT_OK(lh1->Wait());
+  lh2->EnqueueLock(RowRequest(LockMode::kShared, "table", 1, {"c2"}));
+  ZETASQL_EXPECT_OK(lh2->Wait());
+
+  // Locking the entire row conflicts with any column in the row.
+  lh3->EnqueueLock(RowRequest(LockMode::kShared, "table", 1));
+  EXPECT_THAT(lh3->Wait(),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kAborted));
+}
+
+TEST_F(ConcurrentLockManagerTest, DatabaseLockConflictsWithAnyLock) {
+  auto lh1 = CreateHandle(TransactionID(1));
+  auto lh2 = CreateHandle(TransactionID(2));
+  auto lh3 = CreateHandle(TransactionID(3));
+
+  lh1->EnqueueLock(RowRequest(LockMode::kShared, "table", 1));
+  ZETASQL_EXPECT_OK(lh1->Wait());
+  lh2->EnqueueLock(
+      LockRequest(LockMode::kExclusive, /*table_id=*/"", KeyRange::All(), {}));
+  EXPECT_THAT(lh2->Wait(),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kAborted));
+  lh1->UnlockAll();
+
+  lh3->EnqueueLock(
+      LockRequest(LockMode::kExclusive, /*table_id=*/"", KeyRange::All(), {}));
+  ZETASQL_EXPECT_OK(lh3->Wait());
+  lh1->EnqueueLock(RowRequest(LockMode::kShared, "table", 1));
+  EXPECT_THAT(lh1->Wait(),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kAborted));
+}
+
+class WoundWaitLockManagerTest : public ConcurrentLockManagerTest {
+ public:
+  WoundWaitLockManagerTest() {
+    config::set_lock_wait_timeout(absl::Seconds(5));
+  }
+  ~WoundWaitLockManagerTest() override {
+    config::set_lock_wait_timeout(absl::ZeroDuration());
+  }
+
+  // Returns a handle whose transaction can be aborted if `abortable` is true,
+  // and which is older than the handles with larger priorities.
+  std::unique_ptr<LockHandle> CreateHandle(TransactionID id,
+                                           TransactionPriority priority,
+                                           std::atomic<bool>* abortable) {
+    return manager()->CreateHandle(
+        id,
+        [abortable]() -> absl::Status {
+          return abortable->load() ? absl::OkStatus()
+                                   : absl::UnavailableError("busy");
+        },
+        priority);
+  }
+};
+
+TEST_F(WoundWaitLockManagerTest, OlderTransactionWoundsYoungerHolder) {
+  std::atomic<bool> abortable = true;
+  auto older = CreateHandle(TransactionID(1), 1, &abortable);
+  auto younger = CreateHandle(TransactionID(2), 2, &abortable);
+
+  younger->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1));
+  ZETASQL_EXPECT_OK(younger->Wait());
+  older->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1));
+  EXPECT_FALSE(older->IsBlocked());
+  ZETASQL_EXPECT_OK(older->Wait());
+  EXPECT_TRUE(younger->IsAborted());
+}
+
+TEST_F(WoundWaitLockManagerTest, YoungerTransactionWaitsForOlderHolder) {
+  std::atomic<bool> abortable = true;
+  auto older = CreateHandle(TransactionID(1), 1, &abortable);
+  auto younger = CreateHandle(TransactionID(2), 2, &abortable);
+
+  older->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1));
+  ZETASQL_EXPECT_OK(older->Wait());
+  younger->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1));
+  younger->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 2));
+  EXPECT_TRUE(younger->IsBlocked());
+
+  std::thread waiter([&]() { ZETASQL_EXPECT_OK(younger->Wait()); });
+  absl::SleepFor(absl::Milliseconds(50));
+  EXPECT_FALSE(older->IsAborted());
+  older->UnlockAll();
+  waiter.join();
+  EXPECT_FALSE(younger->IsBlocked());
+
+  // The younger transaction now holds both locks.
+  auto other = CreateHandle(TransactionID(3), 3, &abortable);
+  other->EnqueueLock(RowRequest(LockMode::kShared, "table", 2));
+  EXPECT_TRUE(other->IsBlocked());
+}
+
+TEST_F(WoundWaitLockManagerTest, BusyYoungerHolderIsAbortedOnItsNextWait) {
+  std::atomic<bool> abortable = false;
+  auto older = CreateHandle(TransactionID(1), 1, &abortable);
+  auto younger = CreateHandle(TransactionID(2), 2, &abortable);
+
+  younger->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1));
+  ZETASQL_EXPECT_OK(younger->Wait());
+  older->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1));
+  EXPECT_TRUE(older->IsBlocked());
+  EXPECT_TRUE(younger->IsAborted());
+
+  std::thread waiter([&]() { ZETASQL_EXPECT_OK(older->Wait()); });
+  younger->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 2));
+  EXPECT_THAT(younger->Wait(),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kAborted));
+  EXPECT_THAT(younger->ReserveCommitTimestamp(),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kAborted));
+  younger->UnlockAll();
+  waiter.join();
+}
+
+TEST_F(WoundWaitLockManagerTest, WaitForLocksTimesOut) {
+  config::set_lock_wait_timeout(absl::Milliseconds(50));
+  std::atomic<bool> abortable = true;
+  auto older = CreateHandle(TransactionID(1), 1, &abortable);
+  auto younger = CreateHandle(TransactionID(2), 2, &abortable);
+
+  older->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1));
+  ZETASQL_EXPECT_OK(older->Wait());
+  younger->EnqueueLock(RowRequest(LockMode::kExclusive, "table", 1));
+  EXPECT_THAT(younger->Wait(),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kAborted));
+  EXPECT_FALSE(younger->IsBlocked());
+  EXPECT_FALSE(older->IsAborted());
+}
+
+TEST_F(ConcurrentLockManagerTest, SafeReadWaitsForAllPendingCommits) {
+  auto lh1 = CreateHandle(TransactionID(1));
+  auto lh2 = CreateHandle(TransactionID(2));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time t1, lh1->ReserveCommitTimestamp());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time t2, lh2->ReserveCommitTimestamp());
+  ZETASQL_EXPECT_OK(lh2->MarkCommitted());
+
+  std::atomic<bool> read_done(false);
+  std::thread reader([&]() {
+    lh2->WaitForSafeRead(t2);
+    read_done = true;
+  });
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_FALSE(read_done);
+  EXPECT_LT(t1, t2);
+  ZETASQL_EXPECT_OK(lh1->MarkCommitted());
+  reader.join();
+  EXPECT_TRUE(read_done);
+}
+
+TEST_F(ConcurrentLockManagerTest, SafeReadDoesNotWaitForLaterCommits) {
+  auto lh1 = CreateHandle(TransactionID(1));
+  auto lh2 = CreateHandle(TransactionID(2));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time t1, lh1->ReserveCommitTimestamp());
+  ZETASQL_EXPECT_OK(lh1->MarkCommitted());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time t2, lh2->ReserveCommitTimestamp());
+  EXPECT_LT(t1, t2);
+
+  // Reads up to the pending commit's timestamp return right away.
+  lh1->WaitForSafeRead(t1);
+  lh1->WaitForSafeRead(t2);
+  ZETASQL_EXPECT_OK(lh2->MarkCommitted());
+}
+
+TEST_F(ConcurrentLockManagerTest, SafeReadTimestampIsBeforePendingCommits) {
+  auto lh1 = CreateHandle(TransactionID(1));
+  auto lh2 = CreateHandle(TransactionID(2));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time t1, lh1->ReserveCommitTimestamp());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time t2, lh2->ReserveCommitTimestamp());
+  EXPECT_LT(manager()->SafeReadTimestamp(), t1);
+
+  // Reads at the safe read timestamp return right away.
+  lh1->WaitForSafeRead(manager()->SafeReadTimestamp());
+  ZETASQL_EXPECT_OK(lh1->MarkCommitted());
+  const absl::Time safe_read_timestamp = manager()->SafeReadTimestamp();
+  EXPECT_GE(safe_read_timestamp, t1);
+  EXPECT_LT(safe_read_timestamp, t2);
+
+  ZETASQL_EXPECT_OK(lh2->MarkCommitted());
+  EXPECT_GT(manager()->SafeReadTimestamp(), t2);
+}
+
+TEST_F(ConcurrentLockManagerTest, SafeReadOfThePastWithoutPendingCommits) {
+  auto lh1 = CreateHandle(TransactionID(1));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time t1, lh1->ReserveCommitTimestamp());
+  ZETASQL_EXPECT_OK(lh1->MarkCommitted());
+
+  lh1->WaitForSafeRead(t1 + absl::Microseconds(1));
+}
+
 }  // namespace
 
 }  // namespace backend
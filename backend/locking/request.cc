@@ -16,13 +16,45 @@
 
 #include "backend/locking/request.h"
 
+#include <algorithm>
 #include <vector>
 
+#include "backend/common/ids.h"
+#include "backend/datamodel/key_range.h"
+
 namespace google {
 namespace spanner {
 namespace emulator {
 namespace backend {
 
+namespace {
+
+// Returns true if the two key ranges share at least one key.
+bool KeyRangesOverlap(const KeyRange& a, const KeyRange& b) {
+  KeyRange lhs = a.ToClosedOpen();
+  KeyRange rhs = b.ToClosedOpen();
+  return lhs.start_key() < rhs.limit_key() &&
+         rhs.start_key() < lhs.limit_key() &&
+         lhs.start_key() < lhs.limit_key() && rhs.start_key() < rhs.limit_key();
+}
+
+// Returns true if the two column sets share at least one column. An empty
+// column set refers to the whole row and overlaps every other column set.
+bool ColumnsOverlap(const std::vector<ColumnID>& a,
+                    const std::vector<ColumnID>& b) {
+  if (a.empty() || b.empty()) {
+    return true;
+  }
+  for (const ColumnID& column_id : a) {
+    if (std::find(b.begin(), b.end(), column_id) != b.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
 LockRequest::LockRequest(LockMode mode, TableID table_id,
                          const KeyRange& key_range,
                          const std::vector<ColumnID>& column_ids)
@@ -31,6 +63,40 @@ LockRequest::LockRequest(LockMode mode, TableID table_id,
       key_range_(key_range),
       column_ids_(column_ids) {}
 
+bool LockRequest::ConflictsWith(const LockRequest& other) const {
+  if (mode_ == LockMode::kShared && other.mode_ == LockMode::kShared) {
+    return false;
+  }
+  if (IsDatabaseWide() || other.IsDatabaseWide()) {
+    return true;
+  }
+  return table_id_ == other.table_id_ &&
+         KeyRangesOverlap(key_range_, other.key_range_) &&
+         ColumnsOverlap(column_ids_, other.column_ids_);
+}
+
+bool LockRequest::Covers(const LockRequest& other) const {
+  if (mode_ == LockMode::kShared && other.mode_ == LockMode::kExclusive) {
+    return false;
+  }
+  if (IsDatabaseWide()) {
+    return true;
+  }
+  if (table_id_ != other.table_id_ || !(key_range_ == other.key_range_)) {
+    return false;
+  }
+  if (column_ids_.empty()) {
+    return true;
+  }
+  for (const ColumnID& column_id : other.column_ids_) {
+    if (std::find(column_ids_.begin(), column_ids_.end(), column_id) ==
+        column_ids_.end()) {
+      return false;
+    }
+  }
+  return !other.column_ids_.empty();
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -39,6 +39,25 @@ class LockRequest {
   LockRequest(LockMode mode, TableID table_id, const KeyRange& key_range,
               const std::vector<ColumnID>& column_ids);
 
+  // Accessors.
+  LockMode mode() const { return mode_; }
+  const TableID& table_id() const { return table_id_; }
+  const KeyRange& key_range() const { return key_range_; }
+  const std::vector<ColumnID>& column_ids() const { return column_ids_; }
+
+  // Returns true if this request locks the entire database. Database-wide
+  // requests are represented by an empty table id (e.g. for schema changes).
+  bool IsDatabaseWide() const { return table_id_.empty(); }
+
+  // Returns true if this request cannot be granted while `other` is held by a
+  // different transaction (or vice versa). Two requests conflict if at least
+  // one of them is exclusive and they overlap in table, key range and columns.
+  // An empty column list covers the entire row (including its existence).
+  bool ConflictsWith(const LockRequest& other) const;
+
+  // Returns true if holding this request implies holding `other`.
+  bool Covers(const LockRequest& other) const;
+
  private:
   // The mode in which we want to acquire the lock.
   LockMode mode_;
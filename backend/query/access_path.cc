@@ -0,0 +1,205 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/access_path.h"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/evaluator_table_iterator.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/types/span.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/index.h"
+#include "backend/schema/catalog/table.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Maximum number of keys generated from filters on leading key columns.
+// Filters which would produce more keys are not pushed down. Reading the keys
+// is a single pass over their sorted ranges, so this is large enough for the
+// IN lists of thousands of keys which ORMs generate, and only bounds the cross
+// products of filters on several key columns.
+constexpr int kMaxPushedDownKeys = 64 * 1024;
+
+// Returns the table column which a key column refers to.
+const Column* TableColumn(const KeyColumn* key_column) {
+  const Column* column = key_column->column();
+  return column->source_column() != nullptr ? column->source_column()
+                                            : column;
+}
+
+// Returns the filter on the given column, or nullptr if it is not filtered.
+const zetasql::ColumnFilter* FindFilter(const ColumnFilters& filters,
+                                          const Column* column) {
+  auto itr = filters.find(column);
+  return itr == filters.end() ? nullptr : itr->second;
+}
+
+// Returns the values selected by `filter` on a column of the given type, or
+// nullopt if the filter is not a set of point values of that type.
+std::optional<std::vector<zetasql::Value>> FilterPointValues(
+    const zetasql::ColumnFilter& filter, const zetasql::Type* type) {
+  std::vector<zetasql::Value> values;
+  if (filter.kind() == zetasql::ColumnFilter::kInList) {
+    values = filter.in_list();
+  } else if (filter.lower_bound().is_valid() &&
+             filter.upper_bound().is_valid() &&
+             filter.lower_bound().Equals(filter.upper_bound())) {
+    values.push_back(filter.lower_bound());
+  } else {
+    return std::nullopt;
+  }
+  for (const zetasql::Value& value : values) {
+    if (!value.type()->Equals(type)) {
+      return std::nullopt;
+    }
+  }
+  return values;
+}
+
+// Returns true if `bound` is either unbounded or a value of the given type.
+bool IsUsableRangeBound(const zetasql::Value& bound,
+                        const zetasql::Type* type) {
+  return !bound.is_valid() || bound.type()->Equals(type);
+}
+
+// Returns true if every row of the indexed table has an entry in `index`.
+bool IndexesAllRows(const Index* index) {
+  if (!index->is_null_filtered() && index->null_filtered_columns().empty()) {
+    return true;
+  }
+  for (const KeyColumn* key_column : index->key_columns()) {
+    if (TableColumn(key_column)->is_nullable()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+std::optional<KeySet> KeySetFromColumnFilters(
+    absl::Span<const KeyColumn* const> key_columns,
+    const ColumnFilters& filters) {
+  std::vector<std::vector<zetasql::Value>> prefixes = {{}};
+  int num_key_columns = 0;
+  for (; num_key_columns < key_columns.size(); ++num_key_columns) {
+    const KeyColumn* key_column = key_columns[num_key_columns];
+    const zetasql::ColumnFilter* filter =
+        FindFilter(filters, TableColumn(key_column));
+    if (filter == nullptr) {
+      break;
+    }
+    const zetasql::Type* type = key_column->column()->GetType();
+    std::optional<std::vector<zetasql::Value>> points =
+        FilterPointValues(*filter, type);
+    if (!points.has_value()) {
+      if (filter->kind() != zetasql::ColumnFilter::kRange ||
+          !IsUsableRangeBound(filter->lower_bound(), type) ||
+          !IsUsableRangeBound(filter->upper_bound(), type)) {
+        break;
+      }
+      // Key ranges are specified in key order, which is reversed for
+      // descending key columns.
+      zetasql::Value start = filter->lower_bound();
+      zetasql::Value limit = filter->upper_bound();
+      if (key_column->is_descending()) {
+        std::swap(start, limit);
+      }
+      KeySet key_set;
+      for (const std::vector<zetasql::Value>& prefix : prefixes) {
+        Key start_key(prefix);
+        Key limit_key(prefix);
+        if (start.is_valid()) {
+          start_key.AddColumn(start);
+        }
+        if (limit.is_valid()) {
+          limit_key.AddColumn(limit);
+        }
+        key_set.AddRange(KeyRange::ClosedClosed(start_key, limit_key));
+      }
+      return key_set;
+    }
+    if (prefixes.size() * points->size() > kMaxPushedDownKeys) {
+      break;
+    }
+    std::vector<std::vector<zetasql::Value>> extended_prefixes;
+    extended_prefixes.reserve(prefixes.size() * points->size());
+    for (const std::vector<zetasql::Value>& prefix : prefixes) {
+      for (const zetasql::Value& point : *points) {
+        extended_prefixes.push_back(prefix);
+        extended_prefixes.back().push_back(point);
+      }
+    }
+    prefixes = std::move(extended_prefixes);
+  }
+
+  if (num_key_columns == 0) {
+    return std::nullopt;
+  }
+  KeySet key_set;
+  for (std::vector<zetasql::Value>& prefix : prefixes) {
+    if (num_key_columns == key_columns.size()) {
+      key_set.AddKey(Key(std::move(prefix)));
+    } else {
+      key_set.AddRange(KeyRange::Prefix(Key(std::move(prefix))));
+    }
+  }
+  return key_set;
+}
+
+AccessPath ChooseAccessPath(const Table* table, const ColumnFilters& filters) {
+  AccessPath access_path;
+  if (filters.empty()) {
+    return access_path;
+  }
+  if (std::optional<KeySet> key_set =
+          KeySetFromColumnFilters(table->primary_key(), filters);
+      key_set.has_value()) {
+    access_path.key_set = *std::move(key_set);
+    return access_path;
+  }
+  for (const Index* index : table->indexes()) {
+    if (!IndexesAllRows(index)) {
+      continue;
+    }
+    if (std::optional<KeySet> key_set =
+            KeySetFromColumnFilters(index->index_data_table()->primary_key(),
+                                    filters);
+        key_set.has_value()) {
+      access_path.index = index;
+      access_path.key_set = *std::move(key_set);
+      return access_path;
+    }
+  }
+  return access_path;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
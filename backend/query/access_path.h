@@ -0,0 +1,85 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_ACCESS_PATH_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_ACCESS_PATH_H_
+
+#include <optional>
+
+#include "zetasql/public/evaluator_table_iterator.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/index.h"
+#include "backend/schema/catalog/table.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Filters on the columns of a table, keyed by the column they apply to.
+//
+// Column filters are pushed down by the ZetaSQL evaluator into table scans
+// (see zetasql::EvaluatorTableIterator::SetColumnFilterMap). They are inclusive
+// hints: the evaluator still applies the original predicates to the rows
+// returned, so reading a superset of the matching rows is always correct.
+using ColumnFilters =
+    absl::flat_hash_map<const Column*, const zetasql::ColumnFilter*>;
+
+// AccessPath describes how to read the rows of a table which may satisfy a set
+// of column filters.
+struct AccessPath {
+  // If non-null, the rows are located by reading `key_set` from this index of
+  // the table and then reading the matching rows of the table by primary key.
+  const Index* index = nullptr;
+
+  // The keys to read. These are index keys if `index` is set, and table keys
+  // otherwise.
+  KeySet key_set = KeySet::All();
+};
+
+// Returns the key set implied by `filters` over a key with the given columns,
+// or nullopt if the leading key column is not filtered.
+//
+// Equality and IN filters on a prefix of the key columns become point keys (or
+// key prefixes), and a range filter on the following key column bounds each of
+// those prefixes. Filters on later key columns are left to the evaluator. Key
+// columns which are index columns are matched to filters on the table columns
+// they are sourced from.
+std::optional<KeySet> KeySetFromColumnFilters(
+    absl::Span<const KeyColumn* const> key_columns,
+    const ColumnFilters& filters);
+
+// Chooses the access path for reading the rows of `table` which may satisfy
+// `filters`:
+//   - a bounded read of the table if its leading primary key column is
+//     filtered,
+//   - otherwise a bounded read of the first index whose leading key column is
+//     filtered, followed by a lookup of the matching table rows,
+//   - otherwise a full scan of the table.
+// Null-filtered indexes are only considered if none of their key columns are
+// nullable, since they do not contain every row of the table.
+AccessPath ChooseAccessPath(const Table* table, const ColumnFilters& filters);
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_ACCESS_PATH_H_
@@ -0,0 +1,173 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/access_path.h"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "zetasql/public/evaluator_table_iterator.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/table.h"
+#include "tests/common/schema_constructor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::String;
+
+class AccessPathTest : public testing::Test {
+ public:
+  void SetUp() override {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(schema_, test::CreateSchemaFromDDL(
+                                      {
+                                          R"(
+      CREATE TABLE T (
+        k1 INT64 NOT NULL,
+        k2 INT64 NOT NULL,
+        name STRING(MAX),
+        tag STRING(MAX),
+        age INT64
+      ) PRIMARY KEY (k1, k2))",
+                                          R"(
+      CREATE INDEX TByName ON T(name DESC))",
+                                          R"(
+      CREATE NULL_FILTERED INDEX TByTag ON T(tag))",
+                                      },
+                                      &type_factory_));
+    table_ = schema_->FindTable("T");
+  }
+
+ protected:
+  const Column* column(const std::string& name) {
+    return table_->FindColumn(name);
+  }
+
+  // Returns a filter on the single value `value`.
+  const zetasql::ColumnFilter* Equals(const zetasql::Value& value) {
+    filters_.push_back(std::make_unique<zetasql::ColumnFilter>(value, value));
+    return filters_.back().get();
+  }
+
+  // Returns a filter on the range [lower, upper].
+  const zetasql::ColumnFilter* Between(const zetasql::Value& lower,
+                                         const zetasql::Value& upper) {
+    filters_.push_back(std::make_unique<zetasql::ColumnFilter>(lower, upper));
+    return filters_.back().get();
+  }
+
+  // Returns a filter on the given values.
+  const zetasql::ColumnFilter* In(std::vector<zetasql::Value> values) {
+    filters_.push_back(std::make_unique<zetasql::ColumnFilter>(values));
+    return filters_.back().get();
+  }
+
+  zetasql::TypeFactory type_factory_;
+  std::unique_ptr<const Schema> schema_;
+  const Table* table_ = nullptr;
+  std::vector<std::unique_ptr<zetasql::ColumnFilter>> filters_;
+};
+
+TEST_F(AccessPathTest, UnfilteredReadScansTable) {
+  AccessPath access_path = ChooseAccessPath(table_, {});
+  EXPECT_EQ(access_path.index, nullptr);
+  EXPECT_EQ(access_path.key_set.DebugString(), KeySet::All().DebugString());
+}
+
+TEST_F(AccessPathTest, FilterOnNonIndexedColumnScansTable) {
+  AccessPath access_path =
+      ChooseAccessPath(table_, {{column("age"), Equals(Int64(1))}});
+  EXPECT_EQ(access_path.index, nullptr);
+  EXPECT_EQ(access_path.key_set.DebugString(), KeySet::All().DebugString());
+}
+
+TEST_F(AccessPathTest, FullPrimaryKeyFilterReadsPoints) {
+  AccessPath access_path = ChooseAccessPath(
+      table_, {{column("k1"), Equals(Int64(1))},
+               {column("k2"), In({Int64(2), Int64(3)})},
+               {column("name"), Equals(String("foo"))}});
+  EXPECT_EQ(access_path.index, nullptr);
+  KeySet expected;
+  expected.AddKey(Key({Int64(1), Int64(2)}));
+  expected.AddKey(Key({Int64(1), Int64(3)}));
+  EXPECT_EQ(access_path.key_set.DebugString(), expected.DebugString());
+}
+
+TEST_F(AccessPathTest, PrimaryKeyPrefixAndRangeFilterReadsRanges) {
+  AccessPath access_path = ChooseAccessPath(
+      table_, {{column("k1"), In({Int64(1), Int64(2)})},
+               {column("k2"), Between(Int64(5), zetasql::Value())}});
+  EXPECT_EQ(access_path.index, nullptr);
+  KeySet expected;
+  expected.AddRange(
+      KeyRange::ClosedClosed(Key({Int64(1), Int64(5)}), Key({Int64(1)})));
+  expected.AddRange(
+      KeyRange::ClosedClosed(Key({Int64(2), Int64(5)}), Key({Int64(2)})));
+  EXPECT_EQ(access_path.key_set.DebugString(), expected.DebugString());
+}
+
+TEST_F(AccessPathTest, PrimaryKeyPrefixFilterReadsPrefix) {
+  AccessPath access_path =
+      ChooseAccessPath(table_, {{column("k1"), Equals(Int64(1))}});
+  EXPECT_EQ(access_path.index, nullptr);
+  EXPECT_EQ(access_path.key_set.DebugString(),
+            KeySet(KeyRange::Prefix(Key({Int64(1)}))).DebugString());
+}
+
+TEST_F(AccessPathTest, FilterOnIndexedColumnReadsIndex) {
+  AccessPath access_path = ChooseAccessPath(
+      table_, {{column("name"), Between(String("a"), String("c"))}});
+  EXPECT_EQ(access_path.index, schema_->FindIndex("TByName"));
+  // The index is sorted in descending order of name.
+  EXPECT_EQ(access_path.key_set.DebugString(),
+            KeySet(KeyRange::ClosedClosed(Key({String("c")}),
+                                          Key({String("a")})))
+                .DebugString());
+}
+
+TEST_F(AccessPathTest, NullFilteredIndexOnNullableColumnIsNotUsed) {
+  AccessPath access_path =
+      ChooseAccessPath(table_, {{column("tag"), Equals(String("x"))}});
+  EXPECT_EQ(access_path.index, nullptr);
+  EXPECT_EQ(access_path.key_set.DebugString(), KeySet::All().DebugString());
+}
+
+TEST_F(AccessPathTest, FilterWithMismatchedTypeIsIgnored) {
+  std::optional<KeySet> key_set = KeySetFromColumnFilters(
+      table_->primary_key(), {{column("k1"), Equals(String("1"))}});
+  EXPECT_FALSE(key_set.has_value());
+}
+
+}  // namespace
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
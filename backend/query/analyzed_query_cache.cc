@@ -0,0 +1,160 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/analyzed_query_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "backend/access/read.h"
+#include "backend/schema/catalog/schema.h"
+#include "zetasql/base/ret_check.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+absl::Status ForwardingRowReader::Read(const ReadArg& read_arg,
+                                       std::unique_ptr<RowCursor>* cursor) {
+  ZETASQL_RET_CHECK_NE(reader_, nullptr);
+  return reader_->Read(read_arg, cursor);
+}
+
+absl::Status ForwardingRowReader::ReadSplits(
+    const ReadArg& read_arg, int64_t rows_per_split,
+    std::vector<std::unique_ptr<RowCursor>>* cursors) {
+  ZETASQL_RET_CHECK_NE(reader_, nullptr);
+  return reader_->ReadSplits(read_arg, rows_per_split, cursors);
+}
+
+absl::StatusOr<std::unique_ptr<RowCursor>> ForwardingQueryEvaluator::Evaluate(
+    const std::string& query) {
+  ZETASQL_RET_CHECK_NE(evaluator_, nullptr);
+  return evaluator_->Evaluate(query);
+}
+
+void AnalyzedQueryCache::SetSchema(const Schema* schema) {
+  absl::MutexLock lock(&mu_);
+  if (schema_ == schema) {
+    return;
+  }
+  schema_ = schema;
+  index_.clear();
+  entries_.clear();
+}
+
+bool AnalyzedQueryCache::IsCacheable(const Schema* schema) const {
+  absl::MutexLock lock(&mu_);
+  return capacity_ > 0 && schema != nullptr && schema == schema_;
+}
+
+std::unique_ptr<AnalyzedQuery> AnalyzedQueryCache::Take(const Key& key) {
+  absl::MutexLock lock(&mu_);
+  auto itr = index_.find(key);
+  if (itr == index_.end()) {
+    return nullptr;
+  }
+  std::unique_ptr<AnalyzedQuery> query = std::move(itr->second->second);
+  entries_.erase(itr->second);
+  index_.erase(itr);
+  ++hits_;
+  return query;
+}
+
+std::unique_ptr<AnalyzedQuery> AnalyzedQueryCache::Return(
+    const Key& key, std::unique_ptr<AnalyzedQuery> query) {
+  // Do not keep the per-request reader and evaluator alive in the cache.
+  if (query->catalog != nullptr) {
+    query->catalog->reader.set_reader(nullptr);
+    query->catalog->query_evaluator.set_evaluator(nullptr);
+  }
+
+  absl::MutexLock lock(&mu_);
+  if (key.schema != schema_ || capacity_ <= 0) {
+    return query;
+  }
+  // Another execution of the same statement may have returned its analysis
+  // first, in which case this one is redundant.
+  if (index_.contains(key)) {
+    return query;
+  }
+  entries_.emplace_front(key, std::move(query));
+  index_[key] = entries_.begin();
+  std::unique_ptr<AnalyzedQuery> evicted;
+  if (entries_.size() > capacity_) {
+    evicted = std::move(entries_.back().second);
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  return evicted;
+}
+
+int64_t AnalyzedQueryCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+int64_t AnalyzedQueryCache::hits() const {
+  absl::MutexLock lock(&mu_);
+  return hits_;
+}
+
+void CatalogPool::SetSchema(const Schema* schema) {
+  absl::MutexLock lock(&mu_);
+  if (schema_ == schema) {
+    return;
+  }
+  schema_ = schema;
+  catalogs_.clear();
+}
+
+std::unique_ptr<ReusableCatalog> CatalogPool::Take(const Schema* schema) {
+  absl::MutexLock lock(&mu_);
+  if (schema == nullptr || schema != schema_ || catalogs_.empty()) {
+    return nullptr;
+  }
+  std::unique_ptr<ReusableCatalog> catalog = std::move(catalogs_.back());
+  catalogs_.pop_back();
+  return catalog;
+}
+
+void CatalogPool::Return(std::unique_ptr<ReusableCatalog> catalog) {
+  // Do not keep the per-request reader and evaluator alive in the pool.
+  catalog->reader.set_reader(nullptr);
+  catalog->query_evaluator.set_evaluator(nullptr);
+
+  absl::MutexLock lock(&mu_);
+  if (catalog->schema != schema_ || catalogs_.size() >= capacity_) {
+    return;
+  }
+  catalogs_.push_back(std::move(catalog));
+}
+
+int64_t CatalogPool::size() const {
+  absl::MutexLock lock(&mu_);
+  return catalogs_.size();
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,244 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_ANALYZED_QUERY_CACHE_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_ANALYZED_QUERY_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/spanner/admin/database/v1/common.pb.h"
+#include "zetasql/public/analyzer_options.h"
+#include "zetasql/public/analyzer_output.h"
+#include "zetasql/public/type.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "backend/access/read.h"
+#include "backend/query/catalog.h"
+#include "backend/query/query_engine_options.h"
+#include "backend/query/queryable_view.h"
+#include "backend/schema/catalog/schema.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// A RowReader which forwards reads to a reader set for each execution.
+class ForwardingRowReader : public RowReader {
+ public:
+  void set_reader(RowReader* reader) { reader_ = reader; }
+  RowReader* reader() const { return reader_; }
+
+  absl::Status Read(const ReadArg& read_arg,
+                    std::unique_ptr<RowCursor>* cursor) override;
+
+  absl::Status ReadSplits(
+      const ReadArg& read_arg, int64_t rows_per_split,
+      std::vector<std::unique_ptr<RowCursor>>* cursors) override;
+
+ private:
+  RowReader* reader_ = nullptr;
+};
+
+// A QueryEvaluator which forwards evaluations to an evaluator set for each
+// execution.
+class ForwardingQueryEvaluator : public QueryEvaluator {
+ public:
+  void set_evaluator(QueryEvaluator* evaluator) { evaluator_ = evaluator; }
+
+  absl::StatusOr<std::unique_ptr<RowCursor>> Evaluate(
+      const std::string& query) override;
+
+ private:
+  QueryEvaluator* evaluator_ = nullptr;
+};
+
+// ReusableCatalog holds a catalog of `schema` whose tables read data through
+// `reader` and whose views are evaluated through `query_evaluator`. These must
+// be pointed at the reader and evaluator of the request before a statement
+// analyzed against the catalog is executed. The catalog does not depend on the
+// statement, so it can be reused by other statements once the analysis it was
+// used for is gone (see CatalogPool).
+struct ReusableCatalog {
+  const Schema* schema = nullptr;
+  ForwardingRowReader reader;
+  ForwardingQueryEvaluator query_evaluator;
+  std::unique_ptr<Catalog> catalog;
+};
+
+// ValidatedStatement holds a statement whose hints were rewritten and which
+// passed validation against the schema it was analyzed against, along with the
+// options extracted from its hints.
+struct ValidatedStatement {
+  std::unique_ptr<const zetasql::ResolvedStatement> statement;
+  QueryEngineOptions options;
+
+  // Whether read-write only functions were allowed during validation. A
+  // statement validated without them is also valid where they are allowed.
+  bool allow_read_write_only_functions = false;
+};
+
+// AnalyzedQuery holds the analysis of a SQL statement along with the catalog it
+// was analyzed against. The resolved AST refers to the tables of the catalog.
+struct AnalyzedQuery {
+  zetasql::AnalyzerOptions analyzer_options;
+  std::unique_ptr<ReusableCatalog> catalog;
+
+  // Analysis with unused columns pruned, used to classify and run queries.
+  std::unique_ptr<const zetasql::AnalyzerOutput> analyzer_output;
+
+  // Analysis without unused columns pruned, used to run DML statements.
+  // Computed on first use.
+  std::unique_ptr<const zetasql::AnalyzerOutput> dml_analyzer_output;
+
+  // Validated statements of analyzer_output and dml_analyzer_output, which
+  // spare repeated executions the rewriting and validation passes over the
+  // resolved AST. Computed on first use.
+  std::unique_ptr<const ValidatedStatement> validated_statement;
+  std::unique_ptr<const ValidatedStatement> validated_dml_statement;
+};
+
+// AnalyzedQueryCache is an LRU cache of analyzed SQL statements, which avoids
+// re-analyzing (and re-building the catalog for) statements which are executed
+// repeatedly with different parameter values.
+//
+// Only statements against the current schema of the database are cached, and
+// the cache is cleared whenever a new schema is published. An analyzed query is
+// used by a single execution at a time: Take() removes it from the cache and
+// Return() puts it back once the execution is done.
+//
+// This class is thread-safe.
+class AnalyzedQueryCache {
+ public:
+  struct Key {
+    const Schema* schema = nullptr;
+    database_api::DatabaseDialect dialect =
+        database_api::DatabaseDialect::GOOGLE_STANDARD_SQL;
+    std::string sql;
+    // Names and types of the declared parameters, ordered by name.
+    std::vector<std::pair<std::string, const zetasql::Type*>> param_types;
+
+    bool operator==(const Key& other) const {
+      return schema == other.schema && dialect == other.dialect &&
+             sql == other.sql && param_types == other.param_types;
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      return H::combine(std::move(h), key.schema, key.dialect, key.sql,
+                        key.param_types);
+    }
+  };
+
+  explicit AnalyzedQueryCache(int64_t capacity) : capacity_(capacity) {}
+
+  // Sets the current schema, clearing the cache if it changed.
+  void SetSchema(const Schema* schema) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if statements against `schema` can be cached.
+  bool IsCacheable(const Schema* schema) const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Removes and returns the cached analysis for `key`, or nullptr on a miss.
+  std::unique_ptr<AnalyzedQuery> Take(const Key& key) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Inserts `query` as the most recently used entry, evicting the least
+  // recently used entry if the cache is full. Queries against a schema which
+  // is no longer current are dropped. Returns the entry which is not cached
+  // as a result (`query` itself or the evicted entry), or nullptr if none.
+  std::unique_ptr<AnalyzedQuery> Return(const Key& key,
+                                        std::unique_ptr<AnalyzedQuery> query)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of cached entries.
+  int64_t size() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of calls to Take() which found an entry.
+  int64_t hits() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  using Entries = std::list<std::pair<Key, std::unique_ptr<AnalyzedQuery>>>;
+
+  // Maximum number of cached entries.
+  const int64_t capacity_;
+
+  mutable absl::Mutex mu_;
+
+  // The schema which statements are currently cached for.
+  const Schema* schema_ ABSL_GUARDED_BY(mu_) = nullptr;
+
+  // Cached entries, most recently used first.
+  Entries entries_ ABSL_GUARDED_BY(mu_);
+
+  // Index of entries_ by key.
+  absl::flat_hash_map<Key, Entries::iterator> index_ ABSL_GUARDED_BY(mu_);
+
+  int64_t hits_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// CatalogPool keeps the catalogs of statements which are no longer cached, so
+// that analyzing another statement against the current schema of the database
+// does not rebuild the catalog, which wraps every table, view, model and
+// sequence of the schema. A catalog is used by a single statement at a time:
+// Take() removes it from the pool and Return() puts it back.
+//
+// This class is thread-safe.
+class CatalogPool {
+ public:
+  explicit CatalogPool(int64_t capacity) : capacity_(capacity) {}
+
+  // Sets the current schema, dropping the pooled catalogs if it changed.
+  void SetSchema(const Schema* schema) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Removes and returns a pooled catalog of `schema`, or nullptr if there is
+  // none.
+  std::unique_ptr<ReusableCatalog> Take(const Schema* schema)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Puts `catalog` back into the pool. Catalogs of a schema which is no longer
+  // current are dropped, as are catalogs returned to a full pool.
+  void Return(std::unique_ptr<ReusableCatalog> catalog)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of pooled catalogs.
+  int64_t size() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Maximum number of pooled catalogs.
+  const int64_t capacity_;
+
+  mutable absl::Mutex mu_;
+
+  // The schema which catalogs are currently pooled for.
+  const Schema* schema_ ABSL_GUARDED_BY(mu_) = nullptr;
+
+  std::vector<std::unique_ptr<ReusableCatalog>> catalogs_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_ANALYZED_QUERY_CACHE_H_
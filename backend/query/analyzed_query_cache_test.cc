@@ -0,0 +1,183 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/analyzed_query_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "zetasql/public/type.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "backend/schema/catalog/schema.h"
+#include "tests/common/schema_constructor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+class AnalyzedQueryCacheTest : public testing::Test {
+ protected:
+  AnalyzedQueryCache::Key MakeKey(const Schema* schema,
+                                  const std::string& sql) {
+    AnalyzedQueryCache::Key key;
+    key.schema = schema;
+    key.dialect = schema->dialect();
+    key.sql = sql;
+    return key;
+  }
+
+  zetasql::TypeFactory type_factory_;
+  std::unique_ptr<const Schema> schema_ =
+      test::CreateSchemaWithOneTable(&type_factory_);
+  std::unique_ptr<const Schema> other_schema_ =
+      test::CreateSchemaWithMultiTables(&type_factory_);
+};
+
+TEST_F(AnalyzedQueryCacheTest, TakeReturnsQueriesPutBack) {
+  AnalyzedQueryCache cache(/*capacity=*/2);
+  cache.SetSchema(schema_.get());
+  ASSERT_TRUE(cache.IsCacheable(schema_.get()));
+  AnalyzedQueryCache::Key key = MakeKey(schema_.get(), "SELECT 1");
+
+  EXPECT_EQ(cache.Take(key), nullptr);
+  cache.Return(key, std::make_unique<AnalyzedQuery>());
+  EXPECT_EQ(cache.size(), 1);
+
+  // A query is used by one execution at a time.
+  std::unique_ptr<AnalyzedQuery> query = cache.Take(key);
+  EXPECT_NE(query, nullptr);
+  EXPECT_EQ(cache.Take(key), nullptr);
+  EXPECT_EQ(cache.hits(), 1);
+}
+
+TEST_F(AnalyzedQueryCacheTest, KeysDifferByParameterTypes) {
+  AnalyzedQueryCache cache(/*capacity=*/2);
+  cache.SetSchema(schema_.get());
+  AnalyzedQueryCache::Key int_key = MakeKey(schema_.get(), "SELECT @p");
+  int_key.param_types.emplace_back("p", zetasql::types::Int64Type());
+  AnalyzedQueryCache::Key string_key = int_key;
+  string_key.param_types[0].second = zetasql::types::StringType();
+
+  cache.Return(int_key, std::make_unique<AnalyzedQuery>());
+  EXPECT_EQ(cache.Take(string_key), nullptr);
+  EXPECT_NE(cache.Take(int_key), nullptr);
+}
+
+TEST_F(AnalyzedQueryCacheTest, EvictsLeastRecentlyUsedQuery) {
+  AnalyzedQueryCache cache(/*capacity=*/2);
+  cache.SetSchema(schema_.get());
+  AnalyzedQueryCache::Key key1 = MakeKey(schema_.get(), "SELECT 1");
+  AnalyzedQueryCache::Key key2 = MakeKey(schema_.get(), "SELECT 2");
+  AnalyzedQueryCache::Key key3 = MakeKey(schema_.get(), "SELECT 3");
+
+  cache.Return(key1, std::make_unique<AnalyzedQuery>());
+  cache.Return(key2, std::make_unique<AnalyzedQuery>());
+  // Using key1 makes key2 the least recently used entry.
+  cache.Return(key1, cache.Take(key1));
+  cache.Return(key3, std::make_unique<AnalyzedQuery>());
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.Take(key2), nullptr);
+  EXPECT_NE(cache.Take(key1), nullptr);
+  EXPECT_NE(cache.Take(key3), nullptr);
+}
+
+TEST_F(AnalyzedQueryCacheTest, NewSchemaInvalidatesCachedQueries) {
+  AnalyzedQueryCache cache(/*capacity=*/2);
+  cache.SetSchema(schema_.get());
+  AnalyzedQueryCache::Key key = MakeKey(schema_.get(), "SELECT 1");
+  cache.Return(key, std::make_unique<AnalyzedQuery>());
+  std::unique_ptr<AnalyzedQuery> in_use =
+      std::make_unique<AnalyzedQuery>();
+
+  cache.SetSchema(other_schema_.get());
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_FALSE(cache.IsCacheable(schema_.get()));
+
+  // Queries against the old schema which were in use are dropped on return.
+  cache.Return(key, std::move(in_use));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(AnalyzedQueryCacheTest, ReturnYieldsUncachedQuery) {
+  AnalyzedQueryCache cache(/*capacity=*/1);
+  cache.SetSchema(schema_.get());
+  AnalyzedQueryCache::Key key1 = MakeKey(schema_.get(), "SELECT 1");
+  AnalyzedQueryCache::Key key2 = MakeKey(schema_.get(), "SELECT 2");
+
+  EXPECT_EQ(cache.Return(key1, std::make_unique<AnalyzedQuery>()), nullptr);
+
+  // A redundant analysis is handed back.
+  auto redundant = std::make_unique<AnalyzedQuery>();
+  AnalyzedQuery* redundant_ptr = redundant.get();
+  EXPECT_EQ(cache.Return(key1, std::move(redundant)).get(), redundant_ptr);
+
+  // So is the evicted entry.
+  std::unique_ptr<AnalyzedQuery> query1 = cache.Take(key1);
+  AnalyzedQuery* query1_ptr = query1.get();
+  cache.Return(key1, std::move(query1));
+  EXPECT_EQ(cache.Return(key2, std::make_unique<AnalyzedQuery>()).get(),
+            query1_ptr);
+}
+
+TEST_F(AnalyzedQueryCacheTest, CatalogPoolReusesCatalogsOfCurrentSchema) {
+  CatalogPool pool(/*capacity=*/1);
+  pool.SetSchema(schema_.get());
+  EXPECT_EQ(pool.Take(schema_.get()), nullptr);
+
+  auto catalog = std::make_unique<ReusableCatalog>();
+  catalog->schema = schema_.get();
+  ReusableCatalog* catalog_ptr = catalog.get();
+  pool.Return(std::move(catalog));
+  EXPECT_EQ(pool.size(), 1);
+
+  // Catalogs are only handed out for the schema they were built for.
+  EXPECT_EQ(pool.Take(other_schema_.get()), nullptr);
+  catalog = pool.Take(schema_.get());
+  EXPECT_EQ(catalog.get(), catalog_ptr);
+  EXPECT_EQ(pool.size(), 0);
+
+  // The pool is bounded by its capacity.
+  pool.Return(std::move(catalog));
+  auto extra_catalog = std::make_unique<ReusableCatalog>();
+  extra_catalog->schema = schema_.get();
+  pool.Return(std::move(extra_catalog));
+  EXPECT_EQ(pool.size(), 1);
+
+  // Publishing a new schema drops the pooled catalogs, and catalogs of the old
+  // schema are dropped on return.
+  catalog = pool.Take(schema_.get());
+  pool.SetSchema(other_schema_.get());
+  pool.Return(std::move(catalog));
+  EXPECT_EQ(pool.size(), 0);
+}
+
+TEST_F(AnalyzedQueryCacheTest, ZeroCapacityDisablesCaching) {
+  AnalyzedQueryCache cache(/*capacity=*/0);
+  cache.SetSchema(schema_.get());
+  EXPECT_FALSE(cache.IsCacheable(schema_.get()));
+}
+
+}  // namespace
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -155,10 +155,14 @@ Catalog::Catalog(const Schema* schema, const FunctionCatalog* function_catalog,
                  zetasql::TypeFactory* type_factory,
                  const zetasql::AnalyzerOptions& options, RowReader* reader,
                  QueryEvaluator* query_evaluator,
-                 std::optional<std::string> change_stream_internal_lookup)
+                 std::optional<std::string> change_stream_internal_lookup,
+                 InformationSchemaCatalogCache* information_schema_cache,
+                 const SpannerSysStats* spanner_sys_stats)
     : schema_(schema),
       function_catalog_(function_catalog),
-      type_factory_(type_factory) {
+      type_factory_(type_factory),
+      information_schema_cache_(information_schema_cache),
+      spanner_sys_stats_(spanner_sys_stats) {
   // Pass the sequences to the catalog. This step has to be the first one,
   // because sequences may be used by table columns and views.
   for (const backend::Sequence* sequence : schema->sequences()) {
@@ -176,10 +180,15 @@ Catalog::Catalog(const Schema* schema, const FunctionCatalog* function_catalog,
     models_[model->Name()] = std::make_unique<QueryableModel>(model);
   }
 
-  // Pass the query_evaluator to views.
+  // Pass the query_evaluator to views. GoogleSQL view bodies are analyzed
+  // against this catalog so that statements can inline them.
+  zetasql::Catalog* view_body_catalog =
+      schema->dialect() == database_api::DatabaseDialect::GOOGLE_STANDARD_SQL
+          ? this
+          : nullptr;
   for (const auto* view : schema->views()) {
-    views_[view->Name()] =
-        std::make_unique<QueryableView>(view, query_evaluator);
+    views_[view->Name()] = std::make_unique<QueryableView>(
+        view, query_evaluator, view_body_catalog, type_factory);
   }
 
   if (change_stream_internal_lookup.has_value()) {
@@ -392,7 +401,10 @@ absl::Status Catalog::GetFunctions(
 zetasql::Catalog* Catalog::GetInformationSchemaCatalog() const {
   absl::MutexLock lock(&mu_);
   auto spanner_sys_catalog = GetSpannerSysCatalogWithoutLocks();
-  if (!information_schema_catalog_) {
+  if (!information_schema_catalog_ && information_schema_cache_ != nullptr) {
+    information_schema_catalog_ = information_schema_cache_->Get(
+        InformationSchemaCatalog::kName, schema_);
+  } else if (!information_schema_catalog_) {
     information_schema_catalog_ = std::make_unique<InformationSchemaCatalog>(
         InformationSchemaCatalog::kName, schema_, spanner_sys_catalog);
   }
@@ -406,7 +418,8 @@ SpannerSysCatalog* Catalog::GetSpannerSysCatalog() const {
 
 SpannerSysCatalog* Catalog::GetSpannerSysCatalogWithoutLocks() const {
   if (!spanner_sys_catalog_) {
-    spanner_sys_catalog_ = std::make_unique<SpannerSysCatalog>();
+    spanner_sys_catalog_ =
+        std::make_unique<SpannerSysCatalog>(spanner_sys_stats_);
   }
   return spanner_sys_catalog_.get();
 }
@@ -414,7 +427,10 @@ SpannerSysCatalog* Catalog::GetSpannerSysCatalogWithoutLocks() const {
 zetasql::Catalog* Catalog::GetPGInformationSchemaCatalog() const {
   absl::MutexLock lock(&mu_);
   auto spanner_sys_catalog = GetSpannerSysCatalogWithoutLocks();
-  if (!pg_information_schema_catalog_) {
+  if (!pg_information_schema_catalog_ && information_schema_cache_ != nullptr) {
+    pg_information_schema_catalog_ = information_schema_cache_->Get(
+        InformationSchemaCatalog::kPGName, schema_);
+  } else if (!pg_information_schema_catalog_) {
     pg_information_schema_catalog_ = std::make_unique<InformationSchemaCatalog>(
         InformationSchemaCatalog::kPGName, schema_, spanner_sys_catalog);
   }
@@ -35,6 +35,7 @@
 #include "backend/common/case.h"
 #include "backend/query/analyzer_options.h"
 #include "backend/query/function_catalog.h"
+#include "backend/query/information_schema_catalog.h"
 #include "backend/query/queryable_model.h"
 #include "backend/query/queryable_sequence.h"
 #include "backend/query/queryable_table.h"
@@ -55,14 +56,19 @@ class PGFunctionCatalog;
 class Catalog : public zetasql::EnumerableCatalog {
  public:
   // 'reader' can be nullptr unless CreateEvaluatorTableIterator is called
-  // on tables in the catalog.
+  // on tables in the catalog. If 'information_schema_cache' is set, the
+  // information schema catalogs are obtained from it instead of being built
+  // for this catalog. If 'spanner_sys_stats' is set, the statistics tables of
+  // SPANNER_SYS report the rows obtained from it.
   Catalog(
       const Schema* schema, const FunctionCatalog* function_catalog,
       zetasql::TypeFactory* type_factory,
       const zetasql::AnalyzerOptions& options =
           MakeGoogleSqlAnalyzerOptions(),
       RowReader* reader = nullptr, QueryEvaluator* query_evaluator = nullptr,
-      std::optional<std::string> change_stream_internal_lookup = std::nullopt);
+      std::optional<std::string> change_stream_internal_lookup = std::nullopt,
+      InformationSchemaCatalogCache* information_schema_cache = nullptr,
+      const SpannerSysStats* spanner_sys_stats = nullptr);
 
   std::string FullName() const final {
     // The name of the root catalog is "".
@@ -164,15 +170,21 @@ class Catalog : public zetasql::EnumerableCatalog {
   // do not involve views.
   QueryEvaluator* query_evaluator_ = nullptr;
 
+  // Shared information schema catalogs. May be unset.
+  InformationSchemaCatalogCache* information_schema_cache_ = nullptr;
+
+  // Sources of the statistics reported in SPANNER_SYS. May be unset.
+  const SpannerSysStats* spanner_sys_stats_ = nullptr;
+
   // Mutex to protect state below.
   mutable absl::Mutex mu_;
 
   // Information schema catalog (created only if accessed).
-  mutable std::unique_ptr<zetasql::Catalog> information_schema_catalog_
+  mutable std::shared_ptr<zetasql::Catalog> information_schema_catalog_
       ABSL_GUARDED_BY(mu_);
 
   // PG information schema catalog (created only if accessed).
-  mutable std::unique_ptr<zetasql::Catalog> pg_information_schema_catalog_
+  mutable std::shared_ptr<zetasql::Catalog> pg_information_schema_catalog_
       ABSL_GUARDED_BY(mu_);
 
   // Spanner sys catalog (created only if accessed).
@@ -182,6 +182,15 @@ TEST_F(CatalogTest, FindFunctionFindsCountFunction) {
   EXPECT_EQ(function->Name(), "count");
 }
 
+TEST_F(CatalogTest, GetFunctionsIncludesPGFunctions) {
+  using zetasql::Function;
+  absl::flat_hash_set<const Function*> output;
+  ZETASQL_EXPECT_OK(catalog().GetFunctions(&output));
+  EXPECT_THAT(output, Contains(Property(&Function::Name, "count")));
+  EXPECT_THAT(output,
+              Contains(Property(&Function::Name, "pg.map_double_to_int")));
+}
+
 TEST_F(CatalogTest, GetTablesGetsTheOnlyTable) {
   using zetasql::Table;
   absl::flat_hash_set<const Table*> output;
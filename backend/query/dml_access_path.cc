@@ -0,0 +1,208 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/query/dml_access_path.h"
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/builtin_function.pb.h"
+#include "zetasql/public/evaluator.h"
+#include "zetasql/public/evaluator_table_iterator.h"
+#include "zetasql/public/value.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "zetasql/resolved_ast/resolved_column.h"
+#include "zetasql/resolved_ast/resolved_node.h"
+#include "zetasql/resolved_ast/resolved_node_kind.pb.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/query/access_path.h"
+#include "backend/query/queryable_column.h"
+#include "backend/query/queryable_table.h"
+#include "backend/schema/catalog/column.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Returns true if `expr` is a call to the builtin function `id`.
+bool IsBuiltinCall(const zetasql::ResolvedExpr* expr,
+                   zetasql::FunctionSignatureId id) {
+  if (expr->node_kind() != zetasql::RESOLVED_FUNCTION_CALL) return false;
+  const auto* call = expr->GetAs<zetasql::ResolvedFunctionCall>();
+  return call->function()->IsZetaSQLBuiltin() &&
+         call->signature().context_id() == id &&
+         call->collation_list().empty();
+}
+
+// Returns the value of `expr` if it is a literal or a parameter.
+std::optional<zetasql::Value> ConstantValue(
+    const zetasql::ResolvedExpr* expr,
+    const zetasql::ParameterValueMap& params) {
+  if (expr->node_kind() == zetasql::RESOLVED_LITERAL) {
+    return expr->GetAs<zetasql::ResolvedLiteral>()->value();
+  }
+  if (expr->node_kind() != zetasql::RESOLVED_PARAMETER) return std::nullopt;
+  const auto* parameter = expr->GetAs<zetasql::ResolvedParameter>();
+  if (parameter->name().empty()) return std::nullopt;
+  for (const auto& [name, value] : params) {
+    if (absl::EqualsIgnoreCase(name, parameter->name()) &&
+        value.type()->Equals(parameter->type())) {
+      return value;
+    }
+  }
+  return std::nullopt;
+}
+
+// Collects column filters from the conditions of a WHERE clause on the columns
+// of the target table scan.
+class FilterCollector {
+ public:
+  FilterCollector(const zetasql::ResolvedTableScan* scan,
+                  const zetasql::ParameterValueMap& params)
+      : params_(params) {
+    for (int i = 0; i < scan->column_list_size(); ++i) {
+      columns_.emplace(scan->column_list(i).column_id(),
+                       static_cast<const QueryableColumn*>(
+                           scan->table()->GetColumn(scan->column_index_list(i)))
+                           ->wrapped_column());
+    }
+  }
+
+  // Adds the filters implied by `condition`. Conditions which are not
+  // understood are skipped, since the filters of the other conjuncts hold
+  // regardless of them.
+  void Add(const zetasql::ResolvedExpr* condition) {
+    if (condition->node_kind() != zetasql::RESOLVED_FUNCTION_CALL) return;
+    const auto* call = condition->GetAs<zetasql::ResolvedFunctionCall>();
+    if (IsBuiltinCall(condition, zetasql::FN_AND)) {
+      for (const auto& argument : call->argument_list()) {
+        Add(argument.get());
+      }
+    } else if (IsBuiltinCall(condition, zetasql::FN_EQUAL)) {
+      const zetasql::ResolvedExpr* lhs = call->argument_list(0);
+      const zetasql::ResolvedExpr* rhs = call->argument_list(1);
+      if (FilteredColumn(lhs) == nullptr) std::swap(lhs, rhs);
+      std::optional<zetasql::Value> value = ConstantValue(rhs, params_);
+      if (value.has_value()) {
+        AddFilter(lhs, std::make_unique<zetasql::ColumnFilter>(*value, *value));
+      }
+    } else if (IsBuiltinCall(condition, zetasql::FN_IN)) {
+      std::vector<zetasql::Value> values;
+      for (int i = 1; i < call->argument_list_size(); ++i) {
+        std::optional<zetasql::Value> value =
+            ConstantValue(call->argument_list(i), params_);
+        if (!value.has_value()) return;
+        values.push_back(*std::move(value));
+      }
+      AddFilter(call->argument_list(0),
+                std::make_unique<zetasql::ColumnFilter>(std::move(values)));
+    } else if (IsBuiltinCall(condition, zetasql::FN_IN_ARRAY)) {
+      std::optional<zetasql::Value> array =
+          ConstantValue(call->argument_list(1), params_);
+      if (!array.has_value() || array->is_null()) return;
+      AddFilter(call->argument_list(0),
+                std::make_unique<zetasql::ColumnFilter>(array->elements()));
+    }
+  }
+
+  const ColumnFilters& filters() const { return filters_; }
+
+ private:
+  // Returns the table column referenced by `expr`, if it is a reference to a
+  // column of the target table scan.
+  const Column* FilteredColumn(const zetasql::ResolvedExpr* expr) const {
+    if (expr->node_kind() != zetasql::RESOLVED_COLUMN_REF) return nullptr;
+    const auto* column_ref = expr->GetAs<zetasql::ResolvedColumnRef>();
+    auto it = columns_.find(column_ref->column().column_id());
+    return column_ref->is_correlated() || it == columns_.end() ? nullptr
+                                                               : it->second;
+  }
+
+  // Filters `expr` if it is a column of the target table which is not
+  // filtered yet. Any of several filters on a column is a valid hint.
+  void AddFilter(const zetasql::ResolvedExpr* expr,
+                 std::unique_ptr<zetasql::ColumnFilter> filter) {
+    const Column* column = FilteredColumn(expr);
+    if (column == nullptr || filters_.contains(column)) return;
+    filters_.emplace(column, filter.get());
+    owned_filters_.push_back(std::move(filter));
+  }
+
+  const zetasql::ParameterValueMap& params_;
+  // Table columns of the target table scan, by column id.
+  absl::flat_hash_map<int, const Column*> columns_;
+  ColumnFilters filters_;
+  std::vector<std::unique_ptr<zetasql::ColumnFilter>> owned_filters_;
+};
+
+}  // namespace
+
+std::optional<DmlTargetRows> BoundDmlTargetRows(
+    const zetasql::ResolvedStatement* statement,
+    const zetasql::ParameterValueMap& params) {
+  const zetasql::ResolvedTableScan* scan;
+  const zetasql::ResolvedExpr* where_expr;
+  if (statement->node_kind() == zetasql::RESOLVED_UPDATE_STMT) {
+    const auto* update_statement =
+        statement->GetAs<zetasql::ResolvedUpdateStmt>();
+    scan = update_statement->table_scan();
+    where_expr = update_statement->where_expr();
+  } else if (statement->node_kind() == zetasql::RESOLVED_DELETE_STMT) {
+    const auto* delete_statement =
+        statement->GetAs<zetasql::ResolvedDeleteStmt>();
+    scan = delete_statement->table_scan();
+    where_expr = delete_statement->where_expr();
+  } else {
+    return std::nullopt;
+  }
+  if (scan == nullptr || where_expr == nullptr ||
+      scan->column_index_list_size() != scan->column_list_size()) {
+    return std::nullopt;
+  }
+  const auto* table = dynamic_cast<const QueryableTable*>(scan->table());
+  if (table == nullptr) return std::nullopt;
+
+  std::vector<const zetasql::ResolvedNode*> table_scans;
+  statement->GetDescendantsWithKinds({zetasql::RESOLVED_TABLE_SCAN},
+                                     &table_scans);
+  for (const zetasql::ResolvedNode* node : table_scans) {
+    if (node != scan &&
+        node->GetAs<zetasql::ResolvedTableScan>()->table() == table) {
+      return std::nullopt;
+    }
+  }
+
+  FilterCollector collector(scan, params);
+  collector.Add(where_expr);
+  std::optional<KeySet> key_set = KeySetFromColumnFilters(
+      table->wrapped_table()->primary_key(), collector.filters());
+  if (!key_set.has_value()) return std::nullopt;
+  return DmlTargetRows{.table_name = table->wrapped_table()->Name(),
+                       .key_set = *std::move(key_set)};
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
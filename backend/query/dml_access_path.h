@@ -0,0 +1,60 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_DML_ACCESS_PATH_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_DML_ACCESS_PATH_H_
+
+#include <optional>
+#include <string>
+
+#include "zetasql/public/evaluator.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "backend/datamodel/key_set.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// The rows of the target table of a DML statement which it may modify.
+struct DmlTargetRows {
+  // The name of the target table.
+  std::string table_name;
+
+  // The primary keys of the rows which may satisfy the WHERE clause.
+  KeySet key_set;
+};
+
+// Returns the rows which `statement`, an UPDATE or DELETE statement, may
+// modify given the values of its parameters, if its WHERE clause bounds the
+// primary key of the target table. Equality and IN conditions on the key
+// columns with literals or parameters, conjoined with any other conditions,
+// bound the key (see KeySetFromColumnFilters).
+//
+// Restricting the reads of the target table to these rows is only correct if
+// the target table is not read anywhere else in the statement, so nullopt is
+// also returned if it is.
+std::optional<DmlTargetRows> BoundDmlTargetRows(
+    const zetasql::ResolvedStatement* statement,
+    const zetasql::ParameterValueMap& params);
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_DML_ACCESS_PATH_H_
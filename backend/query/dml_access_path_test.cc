@@ -0,0 +1,137 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/query/dml_access_path.h"
+
+#include <memory>
+#include <optional>
+
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/analyzer_options.h"
+#include "zetasql/public/analyzer_output.h"
+#include "zetasql/public/evaluator.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/types/type_factory.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "backend/datamodel/key.h"
+#include "backend/query/analyzer_options.h"
+#include "backend/query/catalog.h"
+#include "backend/query/function_catalog.h"
+#include "backend/schema/catalog/schema.h"
+#include "tests/common/row_reader.h"
+#include "tests/common/schema_constructor.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+using ::zetasql::values::Int64;
+using ::zetasql::values::Int64Array;
+using ::zetasql_base::testing::IsOkAndHolds;
+
+class DmlAccessPathTest : public testing::Test {
+ protected:
+  DmlAccessPathTest()
+      : schema_(test::CreateSchemaWithOneTable(&type_factory_)),
+        function_catalog_(&type_factory_) {
+    function_catalog_.SetLatestSchema(schema_.get());
+  }
+
+  // Analyzes `sql` and returns the rows it may modify.
+  absl::StatusOr<std::optional<DmlTargetRows>> TargetRows(
+      absl::string_view sql, const zetasql::ParameterValueMap& params = {}) {
+    zetasql::AnalyzerOptions options = MakeGoogleSqlAnalyzerOptions();
+    options.set_prune_unused_columns(false);
+    for (const auto& [name, value] : params) {
+      ZETASQL_RETURN_IF_ERROR(options.AddQueryParameter(name, value.type()));
+    }
+    catalog_ = std::make_unique<Catalog>(schema_.get(), &function_catalog_,
+                                         &type_factory_, options, &reader_);
+    ZETASQL_RETURN_IF_ERROR(zetasql::AnalyzeStatement(sql, options, catalog_.get(),
+                                              &type_factory_, &output_));
+    return BoundDmlTargetRows(output_->resolved_statement(), params);
+  }
+
+  zetasql::TypeFactory type_factory_;
+  std::unique_ptr<const Schema> schema_;
+  FunctionCatalog function_catalog_;
+  test::TestRowReader reader_{{}};
+  std::unique_ptr<Catalog> catalog_;
+  std::unique_ptr<const zetasql::AnalyzerOutput> output_;
+};
+
+TEST_F(DmlAccessPathTest, BoundsUpdateByKeyEquality) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::optional<DmlTargetRows> rows,
+      TargetRows("UPDATE test_table SET string_col = 'x' "
+                 "WHERE @key = int64_col AND string_col = 'y'",
+                 {{"key", Int64(7)}}));
+  ASSERT_TRUE(rows.has_value());
+  EXPECT_EQ(rows->table_name, "test_table");
+  EXPECT_THAT(rows->key_set.keys(), ElementsAre(Key({Int64(7)})));
+  EXPECT_THAT(rows->key_set.ranges(), IsEmpty());
+}
+
+TEST_F(DmlAccessPathTest, BoundsDeleteByKeyList) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::optional<DmlTargetRows> rows,
+      TargetRows("DELETE FROM test_table WHERE int64_col IN (1, 3)"));
+  ASSERT_TRUE(rows.has_value());
+  EXPECT_THAT(rows->key_set.keys(),
+              ElementsAre(Key({Int64(1)}), Key({Int64(3)})));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      rows, TargetRows("DELETE FROM test_table "
+                       "WHERE int64_col IN UNNEST(@keys)",
+                       {{"keys", Int64Array({4, 5})}}));
+  ASSERT_TRUE(rows.has_value());
+  EXPECT_THAT(rows->key_set.keys(),
+              ElementsAre(Key({Int64(4)}), Key({Int64(5)})));
+}
+
+TEST_F(DmlAccessPathTest, DoesNotBoundUnkeyedStatements) {
+  for (absl::string_view sql : {
+           "UPDATE test_table SET string_col = 'x' WHERE string_col = 'y'",
+           "UPDATE test_table SET string_col = 'x' WHERE int64_col > 1",
+           "DELETE FROM test_table WHERE int64_col = int64_col",
+           "DELETE FROM test_table WHERE int64_col = 1 OR string_col = 'x'",
+           "DELETE FROM test_table WHERE TRUE",
+           "INSERT INTO test_table (int64_col) VALUES (1)",
+           // The target table is also read by a subquery.
+           "UPDATE test_table SET string_col = "
+           "(SELECT MAX(string_col) FROM test_table) WHERE int64_col = 1",
+       }) {
+    EXPECT_THAT(TargetRows(sql), IsOkAndHolds(Eq(std::nullopt))) << sql;
+  }
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -29,12 +29,14 @@
 #include "zetasql/public/type.h"
 #include "zetasql/public/types/type_factory.h"
 #include "zetasql/public/value.h"
+#include "absl/base/call_once.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
 #include "absl/types/span.h"
@@ -143,6 +145,11 @@ std::unique_ptr<zetasql::Function> MlPredictRowFunction(
               nullptr}},
       zetasql::FunctionOptions().set_evaluator({EvalMlPredictRow}));
 }
+
+// Returns true if `name` is the name of a Spanner PG function.
+bool IsSpannerPGFunctionName(absl::string_view name) {
+  return absl::StartsWithIgnoreCase(name, "pg.");
+}
 }  // namespace
 
 FunctionCatalog::FunctionCatalog(zetasql::TypeFactory* type_factory,
@@ -156,7 +163,6 @@ FunctionCatalog::FunctionCatalog(zetasql::TypeFactory* type_factory,
   // Add aliases for the functions.
   AddFunctionAliases();
   AddMlFunctions();
-  AddSpannerPGFunctions(type_factory);
 }
 
 void FunctionCatalog::AddZetaSQLBuiltInFunctions(
@@ -223,32 +229,44 @@ void FunctionCatalog::AddMlFunctions() {
 }
 
 // Adds Spanner PG-specific functions to the list of known functions.
-void FunctionCatalog::AddSpannerPGFunctions(
-    zetasql::TypeFactory* type_factory) {
-  SpannerPGFunctions spanner_pg_functions =
-      GetSpannerPGFunctions(catalog_name_);
-
-  for (auto& function : spanner_pg_functions) {
-    // If function exists, add extra signatures instead of overwriting.
-    // Needed for JSONB.
-    if (auto f = functions_.find(function->Name()); f != functions_.end()) {
-      for (auto& sig : function->signatures()) {
-        f->second->AddSignature(sig);
+void FunctionCatalog::MaybeAddSpannerPGFunctions() const {
+  absl::call_once(pg_functions_once_, [this]() {
+    SpannerPGFunctions spanner_pg_functions =
+        GetSpannerPGFunctions(catalog_name_);
+
+    for (auto& function : spanner_pg_functions) {
+      ABSL_DCHECK(IsSpannerPGFunctionName(function->Name()))
+          << function->Name();
+      // If function exists, add extra signatures instead of overwriting.
+      // Needed for JSONB.
+      if (auto f = pg_functions_.find(function->Name());
+          f != pg_functions_.end()) {
+        for (auto& sig : function->signatures()) {
+          f->second->AddSignature(sig);
+        }
+      } else {
+        pg_functions_[function->Name()] = std::move(function);
       }
-    } else {
-      functions_[function->Name()] = std::move(function);
     }
-  }
 
-  SpannerPGTVFs spanner_pg_tvfs = GetSpannerPGTVFs(catalog_name_);
+    SpannerPGTVFs spanner_pg_tvfs = GetSpannerPGTVFs(catalog_name_);
 
-  for (auto& tvf : spanner_pg_tvfs) {
-    table_valued_functions_[tvf->FullName()] = std::move(tvf);
-  }
+    for (auto& tvf : spanner_pg_tvfs) {
+      pg_table_valued_functions_[tvf->FullName()] = std::move(tvf);
+    }
+  });
 }
 
 void FunctionCatalog::GetFunction(const std::string& name,
                                   const zetasql::Function** output) const {
+  if (IsSpannerPGFunctionName(name)) {
+    MaybeAddSpannerPGFunctions();
+    auto function_iter = pg_functions_.find(name);
+    *output = function_iter == pg_functions_.end()
+                  ? nullptr
+                  : function_iter->second.get();
+    return;
+  }
   auto function_iter = functions_.find(name);
   *output =
       function_iter == functions_.end() ? nullptr : function_iter->second.get();
@@ -256,14 +274,25 @@ void FunctionCatalog::GetFunction(const std::string& name,
 
 void FunctionCatalog::GetFunctions(
     absl::flat_hash_set<const zetasql::Function*>* output) const {
+  MaybeAddSpannerPGFunctions();
   for (const auto& [name, function] : functions_) {
     output->insert(function.get());
   }
+  for (const auto& [name, function] : pg_functions_) {
+    output->insert(function.get());
+  }
 }
 
 void FunctionCatalog::GetTableValuedFunction(
     const std::string& name,
     const zetasql::TableValuedFunction** output) const {
+  if (IsSpannerPGFunctionName(name)) {
+    MaybeAddSpannerPGFunctions();
+    auto i = pg_table_valued_functions_.find(name);
+    *output =
+        i == pg_table_valued_functions_.end() ? nullptr : i->second.get();
+    return;
+  }
   auto i = table_valued_functions_.find(name);
   *output = i == table_valued_functions_.end() ? nullptr : i->second.get();
 }
@@ -24,7 +24,9 @@
 #include "zetasql/public/table_valued_function.h"
 #include "zetasql/public/type.h"
 #include "zetasql/public/types/type_factory.h"
+#include "absl/base/call_once.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "backend/common/case.h"
 #include "backend/schema/catalog/schema.h"
 
@@ -39,6 +41,10 @@ constexpr char kCloudSpannerEmulatorFunctionCatalogName[] = "Spanner";
 //
 // The FunctionCatalog supports looking up a function by name and enumerating
 // all existing functions.
+//
+// The Spanner PG functions, all of which are named "pg.<name>", are only
+// registered on the first lookup of such a name or the first enumeration of
+// all functions, so that databases which never use them do not pay for them.
 class FunctionCatalog {
  public:
   // catalog_name allows tests to override the catalog name.
@@ -66,7 +72,8 @@ class FunctionCatalog {
   void AddSpannerFunctions();
   void AddMlFunctions();
 
-  void AddSpannerPGFunctions(zetasql::TypeFactory* type_factory);
+  // Registers the Spanner PG functions on first call. Thread-safe.
+  void MaybeAddSpannerPGFunctions() const;
   void AddFunctionAliases();
 
   std::unique_ptr<zetasql::Function> GetInternalSequenceStateFunction(
@@ -78,6 +85,14 @@ class FunctionCatalog {
   CaseInsensitiveStringMap<std::unique_ptr<zetasql::Function>> functions_;
   CaseInsensitiveStringMap<std::unique_ptr<zetasql::TableValuedFunction>>
       table_valued_functions_;
+  // The Spanner PG functions, populated once by MaybeAddSpannerPGFunctions and
+  // immutable afterwards.
+  mutable absl::once_flag pg_functions_once_;
+  mutable CaseInsensitiveStringMap<std::unique_ptr<zetasql::Function>>
+      pg_functions_;
+  mutable CaseInsensitiveStringMap<
+      std::unique_ptr<zetasql::TableValuedFunction>>
+      pg_table_valued_functions_;
   const std::string catalog_name_;
   // A pointer to the latest schema, since some functions need to access it
   // (e.g. sequence functions).
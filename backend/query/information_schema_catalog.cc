@@ -16,6 +16,7 @@
 
 #include "backend/query/information_schema_catalog.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -32,12 +33,15 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "backend/query/info_schema_columns_metadata_values.h"
 #include "backend/query/spanner_sys_catalog.h"
 #include "backend/query/tables_from_metadata.h"
@@ -53,6 +57,7 @@
 #include "third_party/spanner_pg/catalog/spangres_type.h"
 #include "third_party/spanner_pg/ddl/spangres_direct_schema_printer_impl.h"
 #include "third_party/spanner_pg/ddl/spangres_schema_printer.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
@@ -270,21 +275,30 @@ static const zetasql_base::NoDestructor<
     }};
 
 bool IsNullable(const ColumnsMetaEntry& column) {
-  return std::string(column.is_nullable) == kYes;
+  return absl::string_view(column.is_nullable) == kYes;
 }
 
-// Searches for a metadata entry from metadata_entries. Returns the iterator
-// position to the entry if found, or the interator end if not.
+// Searches for a metadata entry from metadata_entries, whose positions ordered
+// by table name and then column name are `by_name`. Returns the entry if
+// found, or nullptr if not.
 template <typename T>
-typename std::vector<T>::const_iterator FindMetadata(
-    const std::vector<T>& metadata_entries, const std::string& table_name,
-    const std::string& column_name) {
-  for (auto it = metadata_entries.cbegin(); it != metadata_entries.cend();
-       ++it) {
-    if (table_name == it->table_name && column_name == it->column_name)
-      return it;
+const T* FindMetadata(absl::Span<const T> metadata_entries,
+                      absl::Span<const int> by_name,
+                      absl::string_view table_name,
+                      absl::string_view column_name) {
+  const std::pair<absl::string_view, absl::string_view> name(table_name,
+                                                             column_name);
+  auto entry_name = [&](int i) {
+    return std::pair<absl::string_view, absl::string_view>(
+        metadata_entries[i].table_name, metadata_entries[i].column_name);
+  };
+  auto it = std::lower_bound(
+      by_name.begin(), by_name.end(), name,
+      [&](int i, const auto& key) { return entry_name(i) < key; });
+  if (it == by_name.end() || entry_name(*it) != name) {
+    return nullptr;
   }
-  return metadata_entries.cend();
+  return &metadata_entries[*it];
 }
 
 // Returns a reference to an information schema column's metadata. The column's
@@ -296,15 +310,19 @@ const ColumnsMetaEntry& GetColumnMetadata(const DatabaseDialect& dialect,
   if (dialect == DatabaseDialect::POSTGRESQL) {
     std::string table_name = absl::AsciiStrToLower(table->Name());
     std::string column_name = absl::AsciiStrToLower(column->Name());
-    auto m = FindMetadata(PGColumnsMetadata(), table_name, column_name);
-    if (m == PGColumnsMetadata().end()) {
+    const ColumnsMetaEntry* m = FindMetadata(
+        PGColumnsMetadata(), PGColumnsMetadataByName(), table_name,
+        column_name);
+    if (m == nullptr) {
       ABSL_LOG(FATAL) << error << table_name << "." << column_name;
     }
     return *m;
   }
 
-  auto m = FindMetadata(ColumnsMetadata(), table->Name(), column->Name());
-  if (m == ColumnsMetadata().end()) {
+  const ColumnsMetaEntry* m = FindMetadata(
+      ColumnsMetadata(), ColumnsMetadataByName(), table->Name(),
+      column->Name());
+  if (m == nullptr) {
     ABSL_LOG(FATAL) << error << table->Name() << "." << column->Name();
   }
   return *m;
@@ -316,14 +334,13 @@ const IndexColumnsMetaEntry* FindKeyColumnMetadata(
     const DatabaseDialect& dialect, const zetasql::Table* table,
     const zetasql::Column* column) {
   if (dialect == DatabaseDialect::POSTGRESQL) {
-    auto m = FindMetadata(PGIndexColumnsMetadata(),
-                          absl::AsciiStrToLower(table->Name()),
-                          absl::AsciiStrToLower(column->Name()));
-    return m == PGIndexColumnsMetadata().end() ? nullptr : &*m;
+    return FindMetadata(PGIndexColumnsMetadata(),
+                        PGIndexColumnsMetadataByName(),
+                        absl::AsciiStrToLower(table->Name()),
+                        absl::AsciiStrToLower(column->Name()));
   } else {
-    auto m =
-        FindMetadata(IndexColumnsMetadata(), table->Name(), column->Name());
-    return m == IndexColumnsMetadata().end() ? nullptr : &*m;
+    return FindMetadata(IndexColumnsMetadata(), IndexColumnsMetadataByName(),
+                        table->Name(), column->Name());
   }
 }
 
@@ -494,37 +511,159 @@ InformationSchemaCatalog::InformationSchemaCatalog(
     AddTable(table.get());
   }
 
-  FillSchemataTable();
-  // kSpannerStatistics currently has no rows in the emulator so we don't call a
-  // function to fill the table.
-  FillDatabaseOptionsTable();
-  FillColumnOptionsTable();
-
-  // These tables are populated only after all tables have been added to the
-  // catalog (including meta tables) because they add rows based on the tables
-  // in the catalog.
-  FillTablesTable();
-  FillColumnsTable();
-  FillColumnColumnUsageTable();
-  FillIndexesTable();
-  FillIndexColumnsTable();
-  FillCheckConstraintsTable();
-  FillTableConstraintsTable();
-  FillConstraintTableUsageTable();
-  FillReferentialConstraintsTable();
-  FillKeyColumnUsageTable();
-  FillConstraintColumnUsageTable();
-  FillViewsTable();
-  FillChangeStreamsTable();
-  FillChangeStreamColumnsTable();
-  FillChangeStreamOptionsTable();
-  FillChangeStreamTablesTable();
-  FillSequencesTable();
-  FillSequenceOptionsTable();
-  FillModelsTable();
-  FillModelOptionsTable();
-  FillModelColumnsTable();
-  FillModelColumnOptionsTable();
+  // Tables are populated on first lookup (see GetTable). Several of them add
+  // rows based on the tables in the catalog (including meta tables), which
+  // have all been added at this point. kSpannerStatistics currently has no rows
+  // in the emulator so it has no fill function.
+  absl::MutexLock lock(&fill_mu_);
+  pending_fills_ = {
+      {GetNameForDialect(kSchemata),
+       &InformationSchemaCatalog::FillSchemataTable},
+      {GetNameForDialect(kDatabaseOptions),
+       &InformationSchemaCatalog::FillDatabaseOptionsTable},
+      {GetNameForDialect(kColumnOptions),
+       &InformationSchemaCatalog::FillColumnOptionsTable},
+      {GetNameForDialect(kTables), &InformationSchemaCatalog::FillTablesTable},
+      {GetNameForDialect(kColumns),
+       &InformationSchemaCatalog::FillColumnsTable},
+      {GetNameForDialect(kColumnColumnUsage),
+       &InformationSchemaCatalog::FillColumnColumnUsageTable},
+      {GetNameForDialect(kIndexes),
+       &InformationSchemaCatalog::FillIndexesTable},
+      {GetNameForDialect(kIndexColumns),
+       &InformationSchemaCatalog::FillIndexColumnsTable},
+      {GetNameForDialect(kCheckConstraints),
+       &InformationSchemaCatalog::FillCheckConstraintsTable},
+      {GetNameForDialect(kTableConstraints),
+       &InformationSchemaCatalog::FillTableConstraintsTable},
+      {GetNameForDialect(kConstraintTableUsage),
+       &InformationSchemaCatalog::FillConstraintTableUsageTable},
+      {GetNameForDialect(kReferentialConstraints),
+       &InformationSchemaCatalog::FillReferentialConstraintsTable},
+      {GetNameForDialect(kKeyColumnUsage),
+       &InformationSchemaCatalog::FillKeyColumnUsageTable},
+      {GetNameForDialect(kConstraintColumnUsage),
+       &InformationSchemaCatalog::FillConstraintColumnUsageTable},
+      {GetNameForDialect(kViews), &InformationSchemaCatalog::FillViewsTable},
+      {GetNameForDialect(kChangeStreams),
+       &InformationSchemaCatalog::FillChangeStreamsTable},
+      {GetNameForDialect(kChangeStreamColumns),
+       &InformationSchemaCatalog::FillChangeStreamColumnsTable},
+      {GetNameForDialect(kChangeStreamOptions),
+       &InformationSchemaCatalog::FillChangeStreamOptionsTable},
+      {GetNameForDialect(kChangeStreamTables),
+       &InformationSchemaCatalog::FillChangeStreamTablesTable},
+      {GetNameForDialect(kSequences),
+       &InformationSchemaCatalog::FillSequencesTable},
+      {GetNameForDialect(kSequenceOptions),
+       &InformationSchemaCatalog::FillSequenceOptionsTable},
+      {GetNameForDialect(kModels), &InformationSchemaCatalog::FillModelsTable},
+      {GetNameForDialect(kModelOptions),
+       &InformationSchemaCatalog::FillModelOptionsTable},
+      {GetNameForDialect(kModelColumns),
+       &InformationSchemaCatalog::FillModelColumnsTable},
+      {GetNameForDialect(kModelColumnOptions),
+       &InformationSchemaCatalog::FillModelColumnOptionsTable},
+  };
+}
+
+absl::Status InformationSchemaCatalog::GetTable(
+    const std::string& name, const zetasql::Table** table,
+    const FindOptions& options) {
+  ZETASQL_RETURN_IF_ERROR(zetasql::SimpleCatalog::GetTable(name, table, options));
+  if (*table != nullptr) {
+    FillTable((*table)->Name());
+  }
+  return absl::OkStatus();
+}
+
+void InformationSchemaCatalog::FillTable(const std::string& name) {
+  absl::MutexLock lock(&fill_mu_);
+  auto it = pending_fills_.find(name);
+  if (it == pending_fills_.end()) {
+    return;
+  }
+  FillFunction fill = it->second;
+  pending_fills_.erase(it);
+  (this->*fill)();
+}
+
+void InformationSchemaCatalog::DeriveFrom(
+    InformationSchemaCatalog* previous,
+    const CaseInsensitiveStringSet& changed_tables) {
+  RowsByTable reusable_rows;
+  {
+    absl::MutexLock lock(&previous->fill_mu_);
+    for (const auto& [name, rows_by_table] : previous->table_rows_) {
+      TableRows& reusable = reusable_rows[name];
+      for (const auto& [table_name, rows] : rows_by_table) {
+        if (!changed_tables.contains(table_name)) {
+          reusable.emplace(table_name, rows);
+        }
+      }
+    }
+  }
+  absl::MutexLock lock(&fill_mu_);
+  reusable_table_rows_ = std::move(reusable_rows);
+}
+
+const InformationSchemaCatalog::Rows& InformationSchemaCatalog::RowsForTable(
+    const std::string& name, const Table* table,
+    absl::FunctionRef<void(Rows*)> fill_rows) {
+  std::shared_ptr<const Rows>& table_rows = table_rows_[name][table->Name()];
+  auto it = reusable_table_rows_.find(name);
+  if (it != reusable_table_rows_.end()) {
+    auto reusable = it->second.find(table->Name());
+    if (reusable != it->second.end()) {
+      table_rows = reusable->second;
+      return *table_rows;
+    }
+  }
+  auto rows = std::make_shared<Rows>();
+  fill_rows(rows.get());
+  table_rows = std::move(rows);
+  return *table_rows;
+}
+
+std::shared_ptr<InformationSchemaCatalog> InformationSchemaCatalogCache::Get(
+    const std::string& catalog_name, const Schema* schema) {
+  absl::MutexLock lock(&mu_);
+  if (schema != schema_) {
+    return std::make_shared<InformationSchemaCatalog>(catalog_name, schema,
+                                                      &spanner_sys_catalog_);
+  }
+  std::shared_ptr<InformationSchemaCatalog>& catalog = catalogs_[catalog_name];
+  if (catalog == nullptr) {
+    catalog = std::make_shared<InformationSchemaCatalog>(catalog_name, schema,
+                                                         &spanner_sys_catalog_);
+    auto previous = previous_catalogs_.find(catalog_name);
+    if (previous != previous_catalogs_.end()) {
+      catalog->DeriveFrom(previous->second.get(), changed_tables_);
+      previous_catalogs_.erase(previous);
+    }
+  }
+  return catalog;
+}
+
+void InformationSchemaCatalogCache::SetSchema(const Schema* schema) {
+  absl::MutexLock lock(&mu_);
+  if (schema == schema_) {
+    return;
+  }
+  // The catalogs of the previous schema are kept until the catalogs of the new
+  // schema are created from them, if the new schema records how it was derived
+  // from the previous one.
+  const CaseInsensitiveStringSet* changed_tables =
+      schema != nullptr ? schema->TablesChangedSince(schema_) : nullptr;
+  if (changed_tables != nullptr) {
+    previous_catalogs_ = std::move(catalogs_);
+    changed_tables_ = *changed_tables;
+  } else {
+    previous_catalogs_.clear();
+    changed_tables_.clear();
+  }
+  schema_ = schema;
+  catalogs_.clear();
 }
 
 inline std::string InformationSchemaCatalog::GetNameForDialect(
@@ -593,44 +732,47 @@ void InformationSchemaCatalog::FillDatabaseOptionsTable() {
 void InformationSchemaCatalog::FillTablesTable() {
   auto tables = tables_by_name_.at(GetNameForDialect(kTables)).get();
 
-  // Add table rows.
+  // Add table rows, reusing those of unchanged tables.
   std::vector<std::vector<zetasql::Value>> rows;
   for (const Table* table : default_schema_->tables()) {
-    absl::flat_hash_map<std::string, zetasql::Value> specific_kvs;
-    if (dialect_ == DatabaseDialect::POSTGRESQL) {
-      zetasql::Value row_deletion_policy_value = NullString();
-      if (table->row_deletion_policy().has_value()) {
-        // Use the PG schema printer to get the row deletion policy in a format
-        // expected by the PG dialect.
-        absl::StatusOr<std::string> row_deletion_policy =
-            pg_schema_printer_->PrintRowDeletionPolicyForEmulator(
-                table->row_deletion_policy().value());
-        ABSL_CHECK_OK(row_deletion_policy.status());  // crash ok
-        row_deletion_policy_value = String(*row_deletion_policy);
+    const Rows& table_rows = RowsForTable(kTables, table, [&](Rows* new_rows) {
+      absl::flat_hash_map<std::string, zetasql::Value> specific_kvs;
+      if (dialect_ == DatabaseDialect::POSTGRESQL) {
+        zetasql::Value row_deletion_policy_value = NullString();
+        if (table->row_deletion_policy().has_value()) {
+          // Use the PG schema printer to get the row deletion policy in a
+          // format expected by the PG dialect.
+          absl::StatusOr<std::string> row_deletion_policy =
+              pg_schema_printer_->PrintRowDeletionPolicyForEmulator(
+                  table->row_deletion_policy().value());
+          ABSL_CHECK_OK(row_deletion_policy.status());  // crash ok
+          row_deletion_policy_value = String(*row_deletion_policy);
+        }
+        specific_kvs[kRowDeletionPolicyExpression] = row_deletion_policy_value;
+      } else {
+        specific_kvs[kRowDeletionPolicyExpression] =
+            table->row_deletion_policy().has_value()
+                ? String(RowDeletionPolicyToString(
+                      table->row_deletion_policy().value()))
+                : NullString();
       }
-      specific_kvs[kRowDeletionPolicyExpression] = row_deletion_policy_value;
-    } else {
-      specific_kvs[kRowDeletionPolicyExpression] =
-          table->row_deletion_policy().has_value()
-              ? String(RowDeletionPolicyToString(
-                    table->row_deletion_policy().value()))
-              : NullString();
-    }
 
-    specific_kvs[kTableSchema] = DialectDefaultSchema();
-    specific_kvs[kTableName] = String(table->Name());
-    specific_kvs[kTableType] = String(kBaseTable);
-    specific_kvs[kParentTableName] =
-        table->parent() ? String(table->parent()->Name()) : NullString();
-    specific_kvs[kOnDeleteAction] =
-        table->parent()
-            ? String(OnDeleteActionToString(table->on_delete_action()))
-            : NullString();
-    specific_kvs[kSpannerState] = String(kCommitted);
-    // The emulator only supports INTERLEAVE IN PARENT.
-    specific_kvs[kInterleaveType] = String(kInParent);
+      specific_kvs[kTableSchema] = DialectDefaultSchema();
+      specific_kvs[kTableName] = String(table->Name());
+      specific_kvs[kTableType] = String(kBaseTable);
+      specific_kvs[kParentTableName] =
+          table->parent() ? String(table->parent()->Name()) : NullString();
+      specific_kvs[kOnDeleteAction] =
+          table->parent()
+              ? String(OnDeleteActionToString(table->on_delete_action()))
+              : NullString();
+      specific_kvs[kSpannerState] = String(kCommitted);
+      // The emulator only supports INTERLEAVE IN PARENT.
+      specific_kvs[kInterleaveType] = String(kInParent);
 
-    rows.push_back(GetRowFromRowKVs(tables, specific_kvs));
+      new_rows->push_back(GetRowFromRowKVs(tables, specific_kvs));
+    });
+    rows.insert(rows.end(), table_rows.begin(), table_rows.end());
   }
 
   for (const View* view : default_schema_->views()) {
@@ -747,75 +889,81 @@ zetasql::Value GetPGNumericPrecisionRadix(const zetasql::Type* type) {
 void InformationSchemaCatalog::FillColumnsTable() {
   auto columns = tables_by_name_.at(GetNameForDialect(kColumns)).get();
 
-  // Add table rows.
+  // Add table rows, reusing those of unchanged tables.
   std::vector<std::vector<zetasql::Value>> rows;
   absl::flat_hash_map<std::string, zetasql::Value> specific_kvs;
   for (const Table* table : default_schema_->tables()) {
-    int pos = 1;
-    for (const Column* column : table->columns()) {
-      if (dialect_ == DatabaseDialect::POSTGRESQL) {
-        specific_kvs[kColumnDefault] =
-            column->has_default_value()
-                ? String(column->original_expression().value())
-                : NullString();
-
-        const zetasql::Type* type = column->GetType();
-        if (column->has_allows_commit_timestamp()) {
-          specific_kvs[kDataType] = String(kSpannerCommitTimestamp);
-          specific_kvs[kSpannerType] = String(kSpannerCommitTimestamp);
+    const Rows& table_rows = RowsForTable(kColumns, table, [&](Rows* new_rows) {
+      int pos = 1;
+      for (const Column* column : table->columns()) {
+        if (dialect_ == DatabaseDialect::POSTGRESQL) {
+          specific_kvs[kColumnDefault] =
+              column->has_default_value()
+                  ? String(column->original_expression().value())
+                  : NullString();
+
+          const zetasql::Type* type = column->GetType();
+          if (column->has_allows_commit_timestamp()) {
+            specific_kvs[kDataType] = String(kSpannerCommitTimestamp);
+            specific_kvs[kSpannerType] = String(kSpannerCommitTimestamp);
+          } else {
+            specific_kvs[kDataType] = PGDataType(type);
+            specific_kvs[kSpannerType] = GetSpannerType(column);
+          }
+
+          specific_kvs[kCharacterMaximumLength] =
+              (!type->IsArray() &&
+               column->declared_max_length() != std::nullopt)
+                  ? Int64(column->declared_max_length().value())
+                  : NullInt64();
+
+          specific_kvs[kNumericPrecision] = GetPGNumericPrecision(type);
+          specific_kvs[kNumericPrecisionRadix] =
+              GetPGNumericPrecisionRadix(type);
+          specific_kvs[kNumericScale] =
+              type->IsInt64() ? Int64(0) : NullInt64();
+
+          specific_kvs[kGenerationExpression] =
+              column->is_generated()
+                  ? String(column->original_expression().value())
+                  : NullString();
         } else {
-          specific_kvs[kDataType] = PGDataType(type);
+          specific_kvs[kGenerationExpression] = NullString();
+          if (column->is_generated()) {
+            absl::string_view expression = column->expression().value();
+            absl::ConsumePrefix(&expression, "(");
+            absl::ConsumeSuffix(&expression, ")");
+            specific_kvs[kGenerationExpression] = String(expression);
+          }
+
+          specific_kvs[kColumnDefault] =
+              column->has_default_value() ? String(column->expression().value())
+                                          : NullString();
+
+          specific_kvs[kDataType] = NullString();
           specific_kvs[kSpannerType] = GetSpannerType(column);
         }
 
-        specific_kvs[kCharacterMaximumLength] =
-            (!type->IsArray() && column->declared_max_length() != std::nullopt)
-                ? Int64(column->declared_max_length().value())
-                : NullInt64();
-
-        specific_kvs[kNumericPrecision] = GetPGNumericPrecision(type);
-        specific_kvs[kNumericPrecisionRadix] = GetPGNumericPrecisionRadix(type);
-        specific_kvs[kNumericScale] = type->IsInt64() ? Int64(0) : NullInt64();
-
-        specific_kvs[kGenerationExpression] =
-            column->is_generated()
-                ? String(column->original_expression().value())
-                : NullString();
-      } else {
-        specific_kvs[kGenerationExpression] = NullString();
+        specific_kvs[kTableSchema] = DialectDefaultSchema();
+        specific_kvs[kTableName] = String(table->Name());
+        specific_kvs[kColumnName] = String(column->Name());
+        specific_kvs[kOrdinalPosition] = Int64(pos++);
+        specific_kvs[kIsNullable] = String(column->is_nullable() ? kYes : kNo);
+        specific_kvs[kIsGenerated] =
+            String(column->is_generated() ? kAlways : kNever);
         if (column->is_generated()) {
-          absl::string_view expression = column->expression().value();
-          absl::ConsumePrefix(&expression, "(");
-          absl::ConsumeSuffix(&expression, ")");
-          specific_kvs[kGenerationExpression] = String(expression);
+          specific_kvs[kIsStored] =
+              column->is_stored() ? String(kYes) : String(kNo);
+        } else {
+          specific_kvs[kIsStored] = NullString();
         }
+        specific_kvs[kSpannerState] = String(kCommitted);
 
-        specific_kvs[kColumnDefault] =
-            column->has_default_value() ? String(column->expression().value())
-                                        : NullString();
-
-        specific_kvs[kDataType] = NullString();
-        specific_kvs[kSpannerType] = GetSpannerType(column);
+        new_rows->push_back(GetRowFromRowKVs(columns, specific_kvs));
+        specific_kvs.clear();
       }
-
-      specific_kvs[kTableSchema] = DialectDefaultSchema();
-      specific_kvs[kTableName] = String(table->Name());
-      specific_kvs[kColumnName] = String(column->Name());
-      specific_kvs[kOrdinalPosition] = Int64(pos++);
-      specific_kvs[kIsNullable] = String(column->is_nullable() ? kYes : kNo);
-      specific_kvs[kIsGenerated] =
-          String(column->is_generated() ? kAlways : kNever);
-      if (column->is_generated()) {
-        specific_kvs[kIsStored] =
-            column->is_stored() ? String(kYes) : String(kNo);
-      } else {
-        specific_kvs[kIsStored] = NullString();
-      }
-      specific_kvs[kSpannerState] = String(kCommitted);
-
-      rows.push_back(GetRowFromRowKVs(columns, specific_kvs));
-      specific_kvs.clear();
-    }
+    });
+    rows.insert(rows.end(), table_rows.begin(), table_rows.end());
   }
 
   // Add columns for views.
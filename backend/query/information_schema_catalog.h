@@ -22,10 +22,16 @@
 #include <vector>
 
 #include "google/spanner/admin/database/v1/common.pb.h"
+#include "zetasql/public/catalog.h"
 #include "zetasql/public/simple_catalog.h"
 #include "zetasql/public/value.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "backend/common/case.h"
 #include "backend/query/spanner_sys_catalog.h"
 #include "backend/schema/catalog/model.h"
 #include "backend/schema/catalog/schema.h"
@@ -52,6 +58,10 @@ struct IndexColumnsMetaEntry;
 // In production, SPANNER_SYS schemas are also exposed which are not available
 // in the emulator.
 //
+// The rows of each table are computed from the schema the first time the table
+// is looked up through GetTable, so that queries only pay for the tables they
+// read. This class is thread-safe once constructed.
+//
 // This class is tested via tests/conformance/cases/information_schema.cc
 class InformationSchemaCatalog : public zetasql::SimpleCatalog {
  public:
@@ -62,7 +72,40 @@ class InformationSchemaCatalog : public zetasql::SimpleCatalog {
       const std::string& catalog_name, const Schema* default_schema,
       const SpannerSysCatalog* spanner_sys_catalog);
 
+  // Returns the table named `name`, populating its rows if this is the first
+  // lookup of the table.
+  absl::Status GetTable(const std::string& name, const zetasql::Table** table,
+                        const FindOptions& options = FindOptions()) override
+      ABSL_LOCKS_EXCLUDED(fill_mu_);
+
+  // Makes this catalog reuse the rows which `previous` populated for the tables
+  // of its schema that are not in `changed_tables`, instead of computing them
+  // again. `previous` must be a catalog with the same name for the schema from
+  // which this catalog's schema was derived by adding or altering
+  // `changed_tables`. Must be called before the catalog is shared.
+  void DeriveFrom(InformationSchemaCatalog* previous,
+                  const CaseInsensitiveStringSet& changed_tables)
+      ABSL_LOCKS_EXCLUDED(fill_mu_);
+
  private:
+  using FillFunction = void (InformationSchemaCatalog::*)();
+  using Rows = std::vector<std::vector<zetasql::Value>>;
+
+  // Rows of information schema tables describing single tables of the default
+  // schema, by information schema table name and then by table name.
+  using TableRows = CaseInsensitiveStringMap<std::shared_ptr<const Rows>>;
+  using RowsByTable = absl::flat_hash_map<std::string, TableRows>;
+
+  // Populates the table named `name` unless it was already populated.
+  void FillTable(const std::string& name) ABSL_LOCKS_EXCLUDED(fill_mu_);
+
+  // Returns the rows of the information schema table `name` which describe
+  // `table`, computing them with `fill_rows` unless they are reused from the
+  // catalog this one was derived from.
+  const Rows& RowsForTable(const std::string& name, const Table* table,
+                           absl::FunctionRef<void(Rows*)> fill_rows)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(fill_mu_);
+
   const Schema* default_schema_;
   const SpannerSysCatalog* spanner_sys_catalog_;
   const ::google::spanner::admin::database::v1::DatabaseDialect dialect_;
@@ -71,6 +114,23 @@ class InformationSchemaCatalog : public zetasql::SimpleCatalog {
   std::unique_ptr<postgres_translator::spangres::SpangresSchemaPrinter>
       pg_schema_printer_;
 
+  // Serializes the population of tables, which may be looked up by concurrent
+  // queries when the catalog is shared through InformationSchemaCatalogCache.
+  absl::Mutex fill_mu_;
+
+  // Fill functions of the tables which have not been populated yet, by table
+  // name.
+  absl::flat_hash_map<std::string, FillFunction> pending_fills_
+      ABSL_GUARDED_BY(fill_mu_);
+
+  // The rows returned by RowsForTable, which catalogs derived from this one may
+  // reuse.
+  RowsByTable table_rows_ ABSL_GUARDED_BY(fill_mu_);
+
+  // The rows of the catalog this one was derived from which describe unchanged
+  // tables.
+  RowsByTable reusable_table_rows_ ABSL_GUARDED_BY(fill_mu_);
+
   inline std::string GetNameForDialect(absl::string_view name);
   std::pair<zetasql::Value, zetasql::Value> GetPGDataTypeAndSpannerType(
       const zetasql::Type* type, std::optional<int64_t> length);
@@ -88,8 +148,8 @@ class InformationSchemaCatalog : public zetasql::SimpleCatalog {
   void FillDatabaseOptionsTable();
   void FillColumnOptionsTable();
 
-  void FillTablesTable();
-  void FillColumnsTable();
+  void FillTablesTable() ABSL_EXCLUSIVE_LOCKS_REQUIRED(fill_mu_);
+  void FillColumnsTable() ABSL_EXCLUSIVE_LOCKS_REQUIRED(fill_mu_);
   void FillColumnColumnUsageTable();
   void FillIndexesTable();
   void FillIndexColumnsTable();
@@ -125,6 +185,49 @@ class InformationSchemaCatalog : public zetasql::SimpleCatalog {
       std::vector<std::vector<zetasql::Value>>* rows);
 };
 
+// InformationSchemaCatalogCache shares the information schema catalogs of the
+// current schema of a database between queries, so that each table is only
+// populated once per schema version. When the current schema is derived from
+// the previous one by adding or altering tables, the catalogs of the new schema
+// reuse the rows of the previous catalogs which describe the other tables.
+//
+// Catalogs requested for any other schema are built anew for each request. The
+// returned catalogs remain valid after the schema changes for as long as they
+// are referenced, but must not outlive the cache.
+//
+// This class is thread-safe.
+class InformationSchemaCatalogCache {
+ public:
+  // Returns the information schema catalog named `catalog_name` for `schema`.
+  std::shared_ptr<InformationSchemaCatalog> Get(const std::string& catalog_name,
+                                                const Schema* schema)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Sets the current schema, dropping the cached catalogs if it changed.
+  void SetSchema(const Schema* schema) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // The catalogs only read the names and columns of the SPANNER_SYS tables,
+  // which are the same for all schemas.
+  const SpannerSysCatalog spanner_sys_catalog_;
+
+  absl::Mutex mu_;
+
+  // The schema which catalogs are currently cached for.
+  const Schema* schema_ ABSL_GUARDED_BY(mu_) = nullptr;
+
+  // Cached catalogs by catalog name.
+  absl::flat_hash_map<std::string, std::shared_ptr<InformationSchemaCatalog>>
+      catalogs_ ABSL_GUARDED_BY(mu_);
+
+  // The catalogs of the previous schema, by catalog name, which the catalogs
+  // of `schema_` are derived from, and the tables which differ between the
+  // two schemas.
+  absl::flat_hash_map<std::string, std::shared_ptr<InformationSchemaCatalog>>
+      previous_catalogs_ ABSL_GUARDED_BY(mu_);
+  CaseInsensitiveStringSet changed_tables_ ABSL_GUARDED_BY(mu_);
+};
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -16,17 +16,55 @@
 
 #include "backend/query/information_schema_catalog.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "zetasql/public/catalog.h"
+#include "zetasql/public/evaluator_table_iterator.h"
+#include "zetasql/public/types/type_factory.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "backend/common/ids.h"
+#include "backend/database/pg_oid_assigner/pg_oid_assigner.h"
 #include "backend/query/info_schema_columns_metadata_values.h"
 #include "backend/query/spanner_sys_catalog.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/updater/schema_updater.h"
 
 namespace google::spanner::emulator::backend {
 
 namespace {
 
+// Returns the number of rows of `table`, or -1 if it cannot be read.
+int64_t CountRows(const zetasql::Table* table) {
+  auto iterator = table->CreateEvaluatorTableIterator({0});
+  if (!iterator.ok()) {
+    return -1;
+  }
+  int64_t num_rows = 0;
+  while ((*iterator)->NextRow()) {
+    ++num_rows;
+  }
+  return num_rows;
+}
+
+// Returns the table named `name` without populating it.
+const zetasql::Table* FindUnfilledTable(const InformationSchemaCatalog& catalog,
+                                          const std::string& name) {
+  for (const zetasql::Table* table : catalog.tables()) {
+    if (table->Name() == name) {
+      return table;
+    }
+  }
+  return nullptr;
+}
+
 TEST(InformationSchemaCatalogTest, ColumnsMetadataCount) {
   Schema schema;
   SpannerSysCatalog spanner_sys_catalog;
@@ -74,5 +112,136 @@ TEST(InformationSchemaCatalogTest, PGSpannerSysColumnsMetadataCount) {
                                    &spanner_sys_catalog);
   EXPECT_EQ(SpannerSysColumnsMetadata().size(), 293);
 }
+
+// Returns true if `by_name` holds the positions of all of `entries` ordered by
+// table name and then column name.
+template <typename T>
+bool IsOrderedByName(absl::Span<const T> entries,
+                     absl::Span<const int> by_name) {
+  if (by_name.size() != entries.size()) {
+    return false;
+  }
+  std::vector<int> positions(by_name.begin(), by_name.end());
+  std::sort(positions.begin(), positions.end());
+  for (int i = 0; i < positions.size(); ++i) {
+    if (positions[i] != i) {
+      return false;
+    }
+  }
+  auto name = [&](int i) {
+    return std::pair<absl::string_view, absl::string_view>(
+        entries[i].table_name, entries[i].column_name);
+  };
+  for (int i = 1; i < by_name.size(); ++i) {
+    if (name(by_name[i]) < name(by_name[i - 1])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(InformationSchemaCatalogTest, ColumnsMetadataIsIndexedByName) {
+  EXPECT_TRUE(IsOrderedByName(ColumnsMetadata(), ColumnsMetadataByName()));
+  EXPECT_TRUE(
+      IsOrderedByName(IndexColumnsMetadata(), IndexColumnsMetadataByName()));
+  EXPECT_TRUE(IsOrderedByName(PGColumnsMetadata(), PGColumnsMetadataByName()));
+  EXPECT_TRUE(IsOrderedByName(PGIndexColumnsMetadata(),
+                              PGIndexColumnsMetadataByName()));
+}
+
+TEST(InformationSchemaCatalogTest, PopulatesTablesOnFirstLookup) {
+  Schema schema;
+  SpannerSysCatalog spanner_sys_catalog;
+  InformationSchemaCatalog catalog(InformationSchemaCatalog::kName, &schema,
+                                   &spanner_sys_catalog);
+  const zetasql::Table* schemata = FindUnfilledTable(catalog, "SCHEMATA");
+  ASSERT_NE(schemata, nullptr);
+  EXPECT_EQ(CountRows(schemata), 0);
+
+  const zetasql::Table* table = nullptr;
+  ZETASQL_ASSERT_OK(catalog.GetTable("schemata", &table));
+  EXPECT_EQ(table, schemata);
+  // The default schema, INFORMATION_SCHEMA and SPANNER_SYS.
+  EXPECT_EQ(CountRows(table), 3);
+
+  // Later lookups do not populate the table again.
+  ZETASQL_ASSERT_OK(catalog.GetTable("SCHEMATA", &table));
+  EXPECT_EQ(CountRows(table), 3);
+
+  // Other tables are not populated by the lookup.
+  EXPECT_EQ(CountRows(FindUnfilledTable(catalog, "DATABASE_OPTIONS")), 0);
+}
+
+TEST(InformationSchemaCatalogTest, CacheSharesCatalogsOfCurrentSchema) {
+  Schema schema;
+  Schema other_schema;
+  InformationSchemaCatalogCache cache;
+  cache.SetSchema(&schema);
+
+  std::shared_ptr<InformationSchemaCatalog> catalog =
+      cache.Get(InformationSchemaCatalog::kName, &schema);
+  EXPECT_EQ(cache.Get(InformationSchemaCatalog::kName, &schema), catalog);
+  EXPECT_NE(cache.Get(InformationSchemaCatalog::kPGName, &schema), catalog);
+
+  // Catalogs of other schemas are not cached.
+  EXPECT_NE(cache.Get(InformationSchemaCatalog::kName, &other_schema),
+            cache.Get(InformationSchemaCatalog::kName, &other_schema));
+
+  // Changing the schema drops the cached catalogs.
+  cache.SetSchema(&other_schema);
+  std::shared_ptr<InformationSchemaCatalog> other_catalog =
+      cache.Get(InformationSchemaCatalog::kName, &other_schema);
+  EXPECT_NE(other_catalog, catalog);
+  EXPECT_EQ(cache.Get(InformationSchemaCatalog::kName, &other_schema),
+            other_catalog);
+}
+
+TEST(InformationSchemaCatalogTest, CacheDerivesCatalogsOfAlteredSchemas) {
+  zetasql::TypeFactory type_factory;
+  TableIDGenerator table_id_generator;
+  ColumnIDGenerator column_id_generator;
+  PgOidAssigner pg_oid_assigner(/*enabled=*/false);
+  SchemaChangeContext context{.type_factory = &type_factory,
+                              .table_id_generator = &table_id_generator,
+                              .column_id_generator = &column_id_generator,
+                              .pg_oid_assigner = &pg_oid_assigner};
+  auto update_schema = [&](const Schema* schema,
+                           std::vector<std::string> statements) {
+    SchemaUpdater updater;
+    return updater.ValidateSchemaFromDDL(
+        SchemaChangeOperation{.statements = statements}, context, schema);
+  };
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<const Schema> schema,
+      update_schema(nullptr, {"CREATE TABLE T1 (K INT64) PRIMARY KEY (K)",
+                              "CREATE TABLE T2 (K INT64) PRIMARY KEY (K)"}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<const Schema> altered_schema,
+      update_schema(schema.get(), {"ALTER TABLE T1 ADD COLUMN C INT64"}));
+
+  InformationSchemaCatalogCache cache;
+  cache.SetSchema(schema.get());
+  std::shared_ptr<InformationSchemaCatalog> previous_catalog =
+      cache.Get(InformationSchemaCatalog::kName, schema.get());
+  const zetasql::Table* columns = nullptr;
+  ZETASQL_ASSERT_OK(previous_catalog->GetTable("COLUMNS", &columns));
+  const int64_t num_columns = CountRows(columns);
+
+  // The catalog of the altered schema reuses the rows describing T2 and
+  // computes those describing T1 again.
+  cache.SetSchema(altered_schema.get());
+  std::shared_ptr<InformationSchemaCatalog> catalog =
+      cache.Get(InformationSchemaCatalog::kName, altered_schema.get());
+  ZETASQL_ASSERT_OK(catalog->GetTable("COLUMNS", &columns));
+  EXPECT_EQ(CountRows(columns), num_columns + 1);
+
+  // Tables which the previous catalog did not populate are computed anew.
+  const zetasql::Table* tables = nullptr;
+  const zetasql::Table* previous_tables = nullptr;
+  ZETASQL_ASSERT_OK(catalog->GetTable("TABLES", &tables));
+  ZETASQL_ASSERT_OK(previous_catalog->GetTable("TABLES", &previous_tables));
+  EXPECT_EQ(CountRows(tables), CountRows(previous_tables));
+}
+
 }  // namespace
 }  // namespace google::spanner::emulator::backend
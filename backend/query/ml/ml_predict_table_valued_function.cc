@@ -37,10 +37,12 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "backend/common/case.h"
 #include "backend/query/ml/model_evaluator.h"
 #include "backend/query/queryable_model.h"
 #include "common/errors.h"
+#include "common/limits.h"
 #include "zetasql/base/ret_check.h"
 #include "zetasql/base/status_macros.h"
 
@@ -94,7 +96,7 @@ class MlPredictTableValuedFunctionEvaluator
   const zetasql::Value& GetValue(int i) const override {
     DCHECK_GE(i, 0);
     DCHECK_LT(i, output_columns_.size());
-    return output_values_[i];
+    return output_values_[row_index_][i];
   }
 
   absl::Status Status() const override { return status_; }
@@ -102,19 +104,33 @@ class MlPredictTableValuedFunctionEvaluator
   absl::Status Cancel() override { return input_->Cancel(); }
 
   bool NextRow() override {
-    // Advance input iterator, stop if there is an error.
-    if (!input_->NextRow()) {
-      status_ = input_->Status();
-      return false;
+    if (row_index_ + 1 < num_rows_) {
+      ++row_index_;
+      return true;
     }
 
-    // Get all the input values and populate pass-through columns.
-    for (auto& input_column : input_columns_) {
-      *input_column.value = input_->GetValue(input_column.input_index);
+    // Read the next batch of input rows, stop if there is an error.
+    num_rows_ = 0;
+    row_index_ = 0;
+    while (num_rows_ < rows_.size() && input_->NextRow()) {
+      // Get all the input values and populate pass-through columns.
+      for (auto& input_column : input_columns_) {
+        std::vector<zetasql::Value>& values =
+            input_column.is_model_input ? input_values_[num_rows_]
+                                        : output_values_[num_rows_];
+        values[input_column.value_index] =
+            input_->GetValue(input_column.input_index);
+      }
+      ++num_rows_;
+    }
+    status_ = input_->Status();
+    if (!status_.ok() || num_rows_ == 0) {
+      return false;
     }
 
-    // Invoke model evaluator to populate output values.
-    status_ = ModelEvaluator::Predict(model_, model_inputs_, model_outputs_);
+    // Invoke model evaluator to populate output values of the whole batch.
+    status_ = ModelEvaluator::PredictBatch(
+        model_, absl::MakeSpan(rows_.data(), num_rows_));
     return status_.ok();
   }
 
@@ -132,18 +148,24 @@ class MlPredictTableValuedFunctionEvaluator
   struct InputColumn {
     // Index of the input column value to be read.
     int64_t input_index;
-    // Pointer to the value to be set.
-    zetasql::Value* value;
+    // Whether the value is a model input rather than a pass-through column.
+    bool is_model_input;
+    // Index of the value to be set within its row.
+    int64_t value_index;
   };
   std::vector<InputColumn> input_columns_;
-  // Model input columns sent as arguments to ModelEvaluator.
-  CaseInsensitiveStringMap<const ModelEvaluator::ModelColumn> model_inputs_;
-  // Model output columns values of which are set by ModelEvaluator.
-  CaseInsensitiveStringMap<ModelEvaluator::ModelColumn> model_outputs_;
-  // Vector of values referenced by model_inputs_.
-  std::vector<zetasql::Value> input_values_;
-  // Vector of values accessible through GetValue().
-  std::vector<zetasql::Value> output_values_;
+  // Model input and output columns of each row of a batch, sent as arguments
+  // to ModelEvaluator. They reference the values of the same row in
+  // input_values_ and output_values_, which are reused across batches.
+  std::vector<ModelEvaluator::ModelRow> rows_;
+  // Values referenced by the model inputs of each row of a batch.
+  std::vector<std::vector<zetasql::Value>> input_values_;
+  // Values of each row of a batch accessible through GetValue().
+  std::vector<std::vector<zetasql::Value>> output_values_;
+  // Number of rows in the current batch.
+  int64_t num_rows_ = 0;
+  // Index of the current row within the current batch.
+  int64_t row_index_ = 0;
   // Status of the iterator.
   absl::Status status_;
 };
@@ -155,8 +177,14 @@ absl::Status MlPredictTableValuedFunctionEvaluator::Init() {
     input_columns_by_name[input_->GetColumnName(i)].emplace_back(i);
   }
 
-  // Validate that model inputs are satisfied and build model_inputs_.
-  input_values_.resize(model_->NumInputs());
+  // Allocate the buffers of a batch of rows once.
+  rows_.resize(limits::kMaxModelDefaultBatchSize);
+  input_values_.assign(rows_.size(),
+                       std::vector<zetasql::Value>(model_->NumInputs()));
+  output_values_.assign(rows_.size(),
+                        std::vector<zetasql::Value>(output_columns_.size()));
+
+  // Validate that model inputs are satisfied and build the model inputs.
   for (int i = 0; i < model_->NumInputs(); ++i) {
     const QueryableModelColumn* model_column =
         model_->GetInput(i)->GetAs<QueryableModelColumn>();
@@ -196,16 +224,18 @@ absl::Status MlPredictTableValuedFunctionEvaluator::Init() {
     }
 
     input_columns_.push_back(InputColumn{.input_index = input_column_index,
-                                         .value = &input_values_[i]});
+                                         .is_model_input = true,
+                                         .value_index = i});
 
-    model_inputs_.insert(
-        {model_column->Name(),
-         ModelEvaluator::ModelColumn{.model_column = model_column,
-                                     .value = &input_values_[i]}});
+    for (int row = 0; row < rows_.size(); ++row) {
+      rows_[row].inputs.insert(
+          {model_column->Name(),
+           ModelEvaluator::ModelColumn{.model_column = model_column,
+                                       .value = &input_values_[row][i]}});
+    }
   }
 
   // Map output columns to model outputs or passthrough columns.
-  output_values_.resize(output_columns_.size());
   for (int i = 0; i < output_columns_.size(); ++i) {
     const std::string& column_name = output_columns_[i].name;
     const zetasql::Type* column_type = output_columns_[i].type;
@@ -216,11 +246,13 @@ absl::Status MlPredictTableValuedFunctionEvaluator::Init() {
     if (model_column != nullptr) {
       ZETASQL_RET_CHECK(model_column->Is<QueryableModelColumn>());
       ZETASQL_RET_CHECK(model_column->GetType()->Equals(column_type));
-      model_outputs_.insert(
-          {model_column->Name(),
-           ModelEvaluator::ModelColumn{
-               .model_column = model_column->GetAs<QueryableModelColumn>(),
-               .value = &output_values_[i]}});
+      for (int row = 0; row < rows_.size(); ++row) {
+        rows_[row].outputs.insert(
+            {model_column->Name(),
+             ModelEvaluator::ModelColumn{
+                 .model_column = model_column->GetAs<QueryableModelColumn>(),
+                 .value = &output_values_[row][i]}});
+      }
       continue;
     }
 
@@ -236,7 +268,8 @@ absl::Status MlPredictTableValuedFunctionEvaluator::Init() {
           input_->GetColumnType(input_column_index);
       ZETASQL_RET_CHECK(column_type->Equals(input_column_type));
       input_columns_.push_back(InputColumn{.input_index = input_column_index,
-                                           .value = &output_values_[i]});
+                                           .is_model_input = false,
+                                           .value_index = i});
       continue;
     }
 
@@ -28,6 +28,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "backend/common/case.h"
 #include "farmhash.h"
 #include "zetasql/base/ret_check.h"
@@ -187,6 +188,15 @@ absl::Status ModelEvaluator::Predict(
   return DefaultPredict(model, model_inputs, model_outputs);
 }
 
+absl::Status ModelEvaluator::PredictBatch(const zetasql::Model* model,
+                                          absl::Span<ModelRow> rows) {
+  // Custom batched model prediction logic can be added here.
+  for (ModelRow& row : rows) {
+    ZETASQL_RETURN_IF_ERROR(Predict(model, row.inputs, row.outputs));
+  }
+  return absl::OkStatus();
+}
+
 // Default prediction implementation for PG. Takes a fingerprint of all model
 // input and produces a single "Outcome" boolean field.
 absl::Status DefaultPgPredict(absl::string_view endpoint,
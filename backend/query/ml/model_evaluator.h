@@ -22,6 +22,7 @@
 #include "zetasql/public/value.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "backend/common/case.h"
 #include "backend/query/queryable_model.h"
 
@@ -38,6 +39,12 @@ class ModelEvaluator {
     zetasql::Value* value;
   };
 
+  // Model input and output columns of one row of a prediction batch.
+  struct ModelRow {
+    CaseInsensitiveStringMap<const ModelColumn> inputs;
+    CaseInsensitiveStringMap<ModelColumn> outputs;
+  };
+
   static absl::Status DefaultPredict(
       const zetasql::Model* model,
       const CaseInsensitiveStringMap<const ModelColumn>& model_inputs,
@@ -51,6 +58,12 @@ class ModelEvaluator {
       const CaseInsensitiveStringMap<const ModelColumn>& model_inputs,
       CaseInsensitiveStringMap<ModelColumn>& model_outputs);
 
+  // Customizable callback that predicts a batch of rows at once, so that
+  // backends can amortize their per-call overhead. The default implementation
+  // calls Predict for each row.
+  static absl::Status PredictBatch(const zetasql::Model* model,
+                                   absl::Span<ModelRow> rows);
+
   // Prediction function for PG dialect which operates on JSONB values.
   static absl::Status PgPredict(absl::string_view endpoint,
                                 const zetasql::JSONValueConstRef& instance,
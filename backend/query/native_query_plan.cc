@@ -0,0 +1,2040 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/query/native_query_plan.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/builtin_function.pb.h"
+#include "zetasql/public/catalog.h"
+#include "zetasql/public/evaluator.h"
+#include "zetasql/public/evaluator_table_iterator.h"
+#include "zetasql/public/functions/arithmetics.h"
+#include "zetasql/public/numeric_value.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "zetasql/public/value.pb.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "zetasql/resolved_ast/resolved_column.h"
+#include "zetasql/resolved_ast/resolved_node_kind.pb.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/protobuf/descriptor.h"
+#include "backend/datamodel/key.h"
+#include "backend/query/proto_field_reader.h"
+#include "backend/query/query_memory_budget.h"
+#include "backend/query/queryable_column.h"
+#include "backend/query/queryable_table.h"
+#include "backend/query/string_functions.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/storage/row_sampler.h"
+#include "common/config.h"
+#include "common/errors.h"
+#include "zetasql/base/ret_check.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+using Row = std::vector<zetasql::Value>;
+
+// Receives the output rows of an operator, one at a time.
+using RowConsumer = std::function<absl::Status(Row)>;
+
+// Positions of resolved columns, by column id, in the rows of an operator.
+using ColumnSlots = absl::flat_hash_map<int, int>;
+
+// Consumes `bytes` of `budget`, unless the plan has no budget.
+absl::Status Consume(QueryMemoryBudget* budget, int64_t bytes) {
+  return budget == nullptr ? absl::OkStatus() : budget->Consume(bytes);
+}
+
+ColumnSlots SlotsOf(const std::vector<zetasql::ResolvedColumn>& columns) {
+  ColumnSlots slots;
+  for (int i = 0; i < columns.size(); ++i) {
+    slots.emplace(columns[i].column_id(), i);
+  }
+  return slots;
+}
+
+// Returns true if zetasql::Value equality is SQL equality (ignoring NULLs) and
+// zetasql::Value::LessThan is the SQL order for values of `type`.
+bool IsSimpleKeyType(const zetasql::Type* type) {
+  switch (type->kind()) {
+    case zetasql::TYPE_BOOL:
+    case zetasql::TYPE_INT64:
+    case zetasql::TYPE_STRING:
+    case zetasql::TYPE_BYTES:
+    case zetasql::TYPE_DATE:
+    case zetasql::TYPE_TIMESTAMP:
+    case zetasql::TYPE_NUMERIC:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if `call` is a call to the builtin function `id` which uses
+// the default semantics for errors.
+bool IsBuiltinCall(const zetasql::ResolvedFunctionCallBase* call,
+                   zetasql::FunctionSignatureId id) {
+  return call->function()->IsZetaSQLBuiltin() &&
+         call->signature().context_id() == id &&
+         call->error_mode() ==
+             zetasql::ResolvedFunctionCallBase::DEFAULT_ERROR_MODE &&
+         call->collation_list().empty() &&
+         call->generic_argument_list().empty();
+}
+
+// A key of a hash join or of a hash aggregation.
+struct HashKey {
+  Row values;
+
+  bool operator==(const HashKey& other) const {
+    return values == other.values;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const HashKey& key) {
+    for (const zetasql::Value& value : key.values) {
+      h = H::combine(std::move(h), value.HashCode());
+    }
+    return H::combine(std::move(h), key.values.size());
+  }
+};
+
+HashKey KeyOf(const Row& row, const std::vector<int>& slots) {
+  HashKey key;
+  key.values.reserve(slots.size());
+  for (int slot : slots) {
+    key.values.push_back(row[slot]);
+  }
+  return key;
+}
+
+bool HasNull(const HashKey& key) {
+  for (const zetasql::Value& value : key.values) {
+    if (value.is_null()) return true;
+  }
+  return false;
+}
+
+// Returns the values of the current row of `iterator`.
+Row RowOf(const zetasql::EvaluatorTableIterator& iterator) {
+  Row row;
+  row.reserve(iterator.NumColumns());
+  for (int i = 0; i < iterator.NumColumns(); ++i) {
+    row.push_back(iterator.GetValue(i));
+  }
+  return row;
+}
+
+// A scalar operand of an operator: either a column of its input rows or a
+// constant, which is the value of a literal or a parameter.
+struct StringCall;
+struct ProtoFieldAccess;
+
+struct Operand {
+  int slot = -1;
+  zetasql::Value constant;
+  // Set if the operand is the result of a string function call, which is
+  // computed for each row. Only projections and filters have such operands.
+  std::shared_ptr<const StringCall> call;
+  // Set if the operand is a field of a proto operand, which is likewise
+  // computed for each row.
+  std::shared_ptr<const ProtoFieldAccess> field;
+
+  // Returns true if the operand is a call or a field access.
+  bool computed() const { return call != nullptr || field != nullptr; }
+
+  // Returns the value of an operand which is not computed.
+  const zetasql::Value& Get(const Row& row) const {
+    return slot >= 0 ? row[slot] : constant;
+  }
+
+  absl::StatusOr<zetasql::Value> Evaluate(const Row& row) const;
+};
+
+// A call to the STRING signature of one of the functions in
+// string_functions.h. The functions return NULL if any argument is NULL.
+struct StringCall {
+  zetasql::FunctionSignatureId function;
+  std::vector<Operand> arguments;
+  // The pattern of a LIKE with a constant pattern, compiled for all rows.
+  std::optional<LikeMatcher> like_matcher;
+
+  absl::StatusOr<zetasql::Value> Evaluate(const Row& row) const {
+    std::vector<zetasql::Value> values;
+    values.reserve(arguments.size());
+    for (const Operand& argument : arguments) {
+      ZETASQL_ASSIGN_OR_RETURN(zetasql::Value value, argument.Evaluate(row));
+      values.push_back(std::move(value));
+    }
+    for (const zetasql::Value& value : values) {
+      if (value.is_null()) return zetasql::Value::Null(ResultType());
+    }
+    switch (function) {
+      case zetasql::FN_LOWER_STRING: {
+        ZETASQL_ASSIGN_OR_RETURN(std::string lower,
+                         StringLower(values[0].string_value()));
+        return zetasql::Value::String(std::move(lower));
+      }
+      case zetasql::FN_UPPER_STRING: {
+        ZETASQL_ASSIGN_OR_RETURN(std::string upper,
+                         StringUpper(values[0].string_value()));
+        return zetasql::Value::String(std::move(upper));
+      }
+      case zetasql::FN_STARTS_WITH_STRING: {
+        ZETASQL_ASSIGN_OR_RETURN(bool starts_with,
+                         StringStartsWith(values[0].string_value(),
+                                          values[1].string_value()));
+        return zetasql::Value::Bool(starts_with);
+      }
+      case zetasql::FN_STRPOS_STRING: {
+        ZETASQL_ASSIGN_OR_RETURN(int64_t position,
+                         StringPosition(values[0].string_value(),
+                                        values[1].string_value()));
+        return zetasql::Value::Int64(position);
+      }
+      case zetasql::FN_REPLACE_STRING: {
+        ZETASQL_ASSIGN_OR_RETURN(
+            std::string replaced,
+            StringReplace(values[0].string_value(), values[1].string_value(),
+                          values[2].string_value()));
+        return zetasql::Value::String(std::move(replaced));
+      }
+      case zetasql::FN_STRING_LIKE: {
+        if (like_matcher.has_value()) {
+          return zetasql::Value::Bool(
+              like_matcher->Matches(values[0].string_value()));
+        }
+        ZETASQL_ASSIGN_OR_RETURN(LikeMatcher matcher,
+                         LikeMatcher::Create(values[1].string_value()));
+        return zetasql::Value::Bool(matcher.Matches(values[0].string_value()));
+      }
+      default:
+        ZETASQL_RET_CHECK_FAIL() << "Unsupported native string function "
+                         << function;
+    }
+  }
+
+  const zetasql::Type* ResultType() const {
+    switch (function) {
+      case zetasql::FN_STARTS_WITH_STRING:
+      case zetasql::FN_STRING_LIKE:
+        return zetasql::types::BoolType();
+      case zetasql::FN_STRPOS_STRING:
+        return zetasql::types::Int64Type();
+      default:
+        return zetasql::types::StringType();
+    }
+  }
+};
+
+// A ResolvedGetProtoField of a field which ReadProtoField() reads from the
+// serialized message, skipping the other fields instead of parsing it.
+struct ProtoFieldAccess {
+  Operand message;
+  const google::protobuf::FieldDescriptor* field;
+  const zetasql::Type* type;
+  // The value of the field when the message does not have it, which is also
+  // the value for a NULL message if `return_default_value_when_unset`.
+  zetasql::Value default_value;
+  bool return_default_value_when_unset;
+
+  absl::StatusOr<zetasql::Value> Evaluate(const Row& row) const {
+    ZETASQL_ASSIGN_OR_RETURN(zetasql::Value value, message.Evaluate(row));
+    if (value.is_null()) {
+      return return_default_value_when_unset ? default_value
+                                             : zetasql::Value::Null(type);
+    }
+    ZETASQL_ASSIGN_OR_RETURN(std::optional<zetasql::Value> field_value,
+                     ReadProtoField(value.ToCord(), field, type));
+    return field_value.has_value() ? *std::move(field_value) : default_value;
+  }
+};
+
+absl::StatusOr<zetasql::Value> Operand::Evaluate(const Row& row) const {
+  if (call != nullptr) return call->Evaluate(row);
+  if (field != nullptr) return field->Evaluate(row);
+  return Get(row);
+}
+
+// A filter of an IN list of constants or of an IN UNNEST of a constant array,
+// which holds if the operand equals one of the values. NULL operands and
+// elements never match, since the filter is then NULL or FALSE.
+struct Membership {
+  // A column or a constant, which is not computed.
+  Operand operand;
+  // The distinct non-NULL elements, in ascending order.
+  std::vector<zetasql::Value> values;
+  absl::flat_hash_set<HashKey> keys;
+
+  bool Matches(const Row& row) const {
+    const zetasql::Value& value = operand.Get(row);
+    return !value.is_null() && keys.contains(HashKey{.values = {value}});
+  }
+};
+
+Membership MembershipOf(Operand operand,
+                        absl::Span<const zetasql::Value> elements) {
+  Membership membership{.operand = std::move(operand)};
+  for (const zetasql::Value& element : elements) {
+    if (!element.is_null() &&
+        membership.keys.insert(HashKey{.values = {element}}).second) {
+      membership.values.push_back(element);
+    }
+  }
+  std::sort(membership.values.begin(), membership.values.end(),
+            [](const zetasql::Value& a, const zetasql::Value& b) {
+              return a.LessThan(b);
+            });
+  return membership;
+}
+
+// Returns the number of arguments of the string function `id`, or 0 if it is
+// not one of the functions of StringCall.
+int StringFunctionArity(zetasql::FunctionSignatureId id) {
+  switch (id) {
+    case zetasql::FN_LOWER_STRING:
+    case zetasql::FN_UPPER_STRING:
+      return 1;
+    case zetasql::FN_STARTS_WITH_STRING:
+    case zetasql::FN_STRPOS_STRING:
+    case zetasql::FN_STRING_LIKE:
+      return 2;
+    case zetasql::FN_REPLACE_STRING:
+      return 3;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+// NativeOperator evaluates a scan, pushing the rows it produces into a
+// consumer. The values in the rows are those of the column_list of the scan,
+// in order, unless stated otherwise.
+class NativeOperator {
+ public:
+  virtual ~NativeOperator() = default;
+
+  virtual absl::Status Evaluate(const RowConsumer& consumer) const = 0;
+};
+
+namespace {
+
+// If `sample` is set, only the rows of the sample are produced, which the
+// storage draws without reading the other rows.
+//
+// Each of `point_filters` restricts the column at its position in the rows to
+// a set of values in ascending order. They are pushed down to the table
+// iterator, which then only reads the matching keys if the column leads the
+// primary key or an index (see ChooseAccessPath). They are only hints, so the
+// rows must still be filtered by the operator reading the scan.
+class TableScanOperator : public NativeOperator {
+ public:
+  using PointFilters = std::vector<std::pair<int, std::vector<zetasql::Value>>>;
+
+  TableScanOperator(const QueryableTable* table, std::vector<int> column_idxs,
+                    std::optional<RowSample> sample = std::nullopt,
+                    PointFilters point_filters = {})
+      : table_(table),
+        column_idxs_(std::move(column_idxs)),
+        sample_(std::move(sample)),
+        point_filters_(std::move(point_filters)) {}
+
+  absl::Status Evaluate(const RowConsumer& consumer) const override {
+    std::unique_ptr<zetasql::EvaluatorTableIterator> iterator;
+    if (sample_.has_value()) {
+      ZETASQL_ASSIGN_OR_RETURN(iterator,
+                       table_->CreateSampledEvaluatorTableIterator(column_idxs_,
+                                                                   *sample_));
+    } else {
+      ZETASQL_ASSIGN_OR_RETURN(iterator,
+                       table_->CreateEvaluatorTableIterator(column_idxs_));
+    }
+    if (!point_filters_.empty()) {
+      absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>>
+          filter_map;
+      for (const auto& [slot, values] : point_filters_) {
+        filter_map.try_emplace(
+            slot, std::make_unique<zetasql::ColumnFilter>(values));
+      }
+      ZETASQL_RETURN_IF_ERROR(iterator->SetColumnFilterMap(std::move(filter_map)));
+    }
+    while (iterator->NextRow()) {
+      ZETASQL_RETURN_IF_ERROR(consumer(RowOf(*iterator)));
+    }
+    return iterator->Status();
+  }
+
+ private:
+  const QueryableTable* table_;
+  const std::vector<int> column_idxs_;
+  const std::optional<RowSample> sample_;
+  const PointFilters point_filters_;
+};
+
+// Produces the rows of its input for which all the given pairs of operands are
+// equal and not NULL. The rows have the columns of the input.
+// Keeps the rows for which all the equalities and memberships hold and all the
+// predicates, which are BOOL operands, are TRUE.
+class FilterOperator : public NativeOperator {
+ public:
+  FilterOperator(std::unique_ptr<const NativeOperator> input,
+                 std::vector<std::pair<Operand, Operand>> equalities,
+                 std::vector<Operand> predicates,
+                 std::vector<Membership> memberships)
+      : input_(std::move(input)),
+        equalities_(std::move(equalities)),
+        predicates_(std::move(predicates)),
+        memberships_(std::move(memberships)) {}
+
+  absl::Status Evaluate(const RowConsumer& consumer) const override {
+    return input_->Evaluate([&](Row row) -> absl::Status {
+      for (const auto& [lhs, rhs] : equalities_) {
+        ZETASQL_ASSIGN_OR_RETURN(zetasql::Value left, lhs.Evaluate(row));
+        ZETASQL_ASSIGN_OR_RETURN(zetasql::Value right, rhs.Evaluate(row));
+        if (left.is_null() || right.is_null() || !left.Equals(right)) {
+          return absl::OkStatus();
+        }
+      }
+      for (const Membership& membership : memberships_) {
+        if (!membership.Matches(row)) return absl::OkStatus();
+      }
+      for (const Operand& predicate : predicates_) {
+        ZETASQL_ASSIGN_OR_RETURN(zetasql::Value value, predicate.Evaluate(row));
+        if (value.is_null() || !value.bool_value()) return absl::OkStatus();
+      }
+      return consumer(std::move(row));
+    });
+  }
+
+ private:
+  std::unique_ptr<const NativeOperator> input_;
+  const std::vector<std::pair<Operand, Operand>> equalities_;
+  const std::vector<Operand> predicates_;
+  const std::vector<Membership> memberships_;
+};
+
+class ProjectOperator : public NativeOperator {
+ public:
+  ProjectOperator(std::unique_ptr<const NativeOperator> input,
+                  std::vector<Operand> outputs)
+      : input_(std::move(input)), outputs_(std::move(outputs)) {}
+
+  absl::Status Evaluate(const RowConsumer& consumer) const override {
+    return input_->Evaluate([&](Row row) -> absl::Status {
+      Row output;
+      output.reserve(outputs_.size());
+      for (const Operand& operand : outputs_) {
+        ZETASQL_ASSIGN_OR_RETURN(zetasql::Value value, operand.Evaluate(row));
+        output.push_back(std::move(value));
+      }
+      return consumer(std::move(output));
+    });
+  }
+
+ private:
+  std::unique_ptr<const NativeOperator> input_;
+  const std::vector<Operand> outputs_;
+};
+
+// Joins the rows of its left input with the rows of its right input which
+// have equal, non-NULL keys, by building a hash table of the right input and
+// probing it with each left row. Left rows without a match are joined with
+// NULLs when the join is a left outer join. The rows of the hash table are
+// charged to the memory budget of the query.
+//
+// The rows have the columns of the left input followed by those of the right
+// input, and are produced in the order of the left input, then in the order of
+// the right input, like a nested loop join would.
+class HashJoinOperator : public NativeOperator {
+ public:
+  HashJoinOperator(std::unique_ptr<const NativeOperator> left,
+                   std::unique_ptr<const NativeOperator> right,
+                   std::vector<int> left_keys, std::vector<int> right_keys,
+                   bool left_outer, Row null_right_row,
+                   QueryMemoryBudget* budget)
+      : left_(std::move(left)),
+        right_(std::move(right)),
+        left_keys_(std::move(left_keys)),
+        right_keys_(std::move(right_keys)),
+        left_outer_(left_outer),
+        null_right_row_(std::move(null_right_row)),
+        budget_(budget) {}
+
+  absl::Status Evaluate(const RowConsumer& consumer) const override {
+    absl::flat_hash_map<HashKey, std::vector<Row>> right_rows;
+    ZETASQL_RETURN_IF_ERROR(right_->Evaluate([&](Row row) -> absl::Status {
+      HashKey key = KeyOf(row, right_keys_);
+      if (!HasNull(key)) {
+        ZETASQL_RETURN_IF_ERROR(
+            Consume(budget_, QueryMemoryBudget::RowBytes(row)));
+        right_rows[std::move(key)].push_back(std::move(row));
+      }
+      return absl::OkStatus();
+    }));
+
+    return left_->Evaluate([&](Row row) -> absl::Status {
+      HashKey key = KeyOf(row, left_keys_);
+      auto it = HasNull(key) ? right_rows.end() : right_rows.find(key);
+      if (it == right_rows.end()) {
+        if (!left_outer_) return absl::OkStatus();
+        row.insert(row.end(), null_right_row_.begin(), null_right_row_.end());
+        return consumer(std::move(row));
+      }
+      for (const Row& right_row : it->second) {
+        Row joined = row;
+        joined.insert(joined.end(), right_row.begin(), right_row.end());
+        ZETASQL_RETURN_IF_ERROR(consumer(std::move(joined)));
+      }
+      return absl::OkStatus();
+    });
+  }
+
+ private:
+  std::unique_ptr<const NativeOperator> left_;
+  std::unique_ptr<const NativeOperator> right_;
+  const std::vector<int> left_keys_;
+  const std::vector<int> right_keys_;
+  const bool left_outer_;
+  const Row null_right_row_;
+  QueryMemoryBudget* const budget_;
+};
+
+// Joins the rows of a table with the rows of a table interleaved in it whose
+// primary keys start with theirs, by merging the scans of the two tables,
+// which are both in primary key order. Only the current row of each table is
+// held in memory.
+//
+// Left rows without a match are joined with NULLs when the join is a left
+// outer join. The rows have the columns of the left input followed by those of
+// the right input, and are produced in the same order as by HashJoinOperator.
+class InterleavedMergeJoinOperator : public NativeOperator {
+ public:
+  // A scan of one of the tables, with the positions of the columns of the
+  // parent's primary key in its rows.
+  struct Input {
+    const zetasql::Table* table;
+    std::vector<int> column_idxs;
+    std::vector<int> key_slots;
+  };
+
+  InterleavedMergeJoinOperator(Input parent, Input child,
+                               std::vector<const KeyColumn*> key_columns,
+                               bool left_is_parent, bool left_outer,
+                               Row null_right_row)
+      : parent_(std::move(parent)),
+        child_(std::move(child)),
+        key_columns_(std::move(key_columns)),
+        left_is_parent_(left_is_parent),
+        left_outer_(left_outer),
+        null_right_row_(std::move(null_right_row)) {}
+
+  absl::Status Evaluate(const RowConsumer& consumer) const override {
+    ZETASQL_ASSIGN_OR_RETURN(
+        auto parents,
+        parent_.table->CreateEvaluatorTableIterator(parent_.column_idxs));
+    ZETASQL_ASSIGN_OR_RETURN(
+        auto children,
+        child_.table->CreateEvaluatorTableIterator(child_.column_idxs));
+    if (left_is_parent_) {
+      return JoinChildren(parents.get(), children.get(), consumer);
+    }
+    return JoinParent(children.get(), parents.get(), consumer);
+  }
+
+ private:
+  // The scan of one of the tables, positioned on its current row.
+  struct Cursor {
+    zetasql::EvaluatorTableIterator* iterator;
+    bool valid = false;
+    Row row;
+    Key key;
+  };
+
+  // Returns the parent key of `row`, ordered like in both tables.
+  Key KeyOf(const Row& row, const std::vector<int>& key_slots) const {
+    Key key;
+    for (int i = 0; i < key_slots.size(); ++i) {
+      key.AddColumn(row[key_slots[i]], key_columns_[i]->is_descending(),
+                    key_columns_[i]->is_nulls_last());
+    }
+    return key;
+  }
+
+  static bool HasNull(const Key& key) {
+    for (const zetasql::Value& value : key.column_values()) {
+      if (value.is_null()) return true;
+    }
+    return false;
+  }
+
+  // Moves `cursor` to the next row of its table.
+  absl::Status Advance(const Input& input, Cursor* cursor) const {
+    cursor->valid = cursor->iterator->NextRow();
+    if (!cursor->valid) return cursor->iterator->Status();
+    cursor->row = RowOf(*cursor->iterator);
+    cursor->key = KeyOf(cursor->row, input.key_slots);
+    return absl::OkStatus();
+  }
+
+  absl::Status Emit(Row left_row, const Row& right_row,
+                    const RowConsumer& consumer) const {
+    left_row.insert(left_row.end(), right_row.begin(), right_row.end());
+    return consumer(std::move(left_row));
+  }
+
+  // Joins each parent row, from the left input, with the run of child rows
+  // which have its key.
+  absl::Status JoinChildren(zetasql::EvaluatorTableIterator* parents,
+                            zetasql::EvaluatorTableIterator* children,
+                            const RowConsumer& consumer) const {
+    Cursor child{.iterator = children};
+    ZETASQL_RETURN_IF_ERROR(Advance(child_, &child));
+    while (parents->NextRow()) {
+      Row parent = RowOf(*parents);
+      Key key = KeyOf(parent, parent_.key_slots);
+      bool matched = false;
+      if (!HasNull(key)) {
+        while (child.valid && child.key.Compare(key) < 0) {
+          ZETASQL_RETURN_IF_ERROR(Advance(child_, &child));
+        }
+        while (child.valid && child.key.Compare(key) == 0) {
+          ZETASQL_RETURN_IF_ERROR(Emit(parent, child.row, consumer));
+          matched = true;
+          ZETASQL_RETURN_IF_ERROR(Advance(child_, &child));
+        }
+      }
+      if (!matched && left_outer_) {
+        ZETASQL_RETURN_IF_ERROR(
+            Emit(std::move(parent), null_right_row_, consumer));
+      }
+    }
+    return parents->Status();
+  }
+
+  // Joins each child row, from the left input, with the parent row which has
+  // its key, if any.
+  absl::Status JoinParent(zetasql::EvaluatorTableIterator* children,
+                          zetasql::EvaluatorTableIterator* parents,
+                          const RowConsumer& consumer) const {
+    Cursor parent{.iterator = parents};
+    ZETASQL_RETURN_IF_ERROR(Advance(parent_, &parent));
+    while (children->NextRow()) {
+      Row child = RowOf(*children);
+      Key key = KeyOf(child, child_.key_slots);
+      if (!HasNull(key)) {
+        while (parent.valid && parent.key.Compare(key) < 0) {
+          ZETASQL_RETURN_IF_ERROR(Advance(parent_, &parent));
+        }
+        if (parent.valid && parent.key.Compare(key) == 0) {
+          ZETASQL_RETURN_IF_ERROR(Emit(std::move(child), parent.row, consumer));
+          continue;
+        }
+      }
+      if (left_outer_) {
+        ZETASQL_RETURN_IF_ERROR(
+            Emit(std::move(child), null_right_row_, consumer));
+      }
+    }
+    return children->Status();
+  }
+
+  const Input parent_;
+  const Input child_;
+  // The primary key columns of the parent table.
+  const std::vector<const KeyColumn*> key_columns_;
+  const bool left_is_parent_;
+  const bool left_outer_;
+  const Row null_right_row_;
+};
+
+// Groups the rows of its input by the values of the group keys in a hash
+// table, and computes the aggregates of each group. The rows have the group
+// keys followed by the aggregates, and are produced in the order in which
+// their groups first appeared in the input.
+//
+// An aggregation without group keys produces exactly one row, even for an
+// empty input. The groups are charged to the memory budget of the query.
+//
+// SUM and AVG of NUMERIC add the packed fixed-point integers of the arguments
+// in an int128 instead of adding zetasql::Values, and only build the result
+// NumericValue once a group is complete.
+class HashAggregateOperator : public NativeOperator {
+ public:
+  enum class Kind {
+    kCountStar,
+    kCount,
+    kSum,
+    kSumNumeric,
+    kAvgNumeric,
+    kMin,
+    kMax
+  };
+
+  struct Aggregate {
+    Kind kind;
+    // Position of the argument in the input rows, unused for kCountStar.
+    int slot;
+    const zetasql::Type* type;
+  };
+
+  HashAggregateOperator(std::unique_ptr<const NativeOperator> input,
+                        std::vector<int> group_keys,
+                        std::vector<Aggregate> aggregates,
+                        QueryMemoryBudget* budget)
+      : input_(std::move(input)),
+        group_keys_(std::move(group_keys)),
+        aggregates_(std::move(aggregates)),
+        budget_(budget) {}
+
+  absl::Status Evaluate(const RowConsumer& consumer) const override {
+    std::vector<HashKey> keys;
+    std::vector<std::vector<Accumulator>> groups;
+    absl::flat_hash_map<HashKey, int> group_index;
+    if (group_keys_.empty()) {
+      keys.emplace_back();
+      groups.emplace_back(aggregates_.size());
+      group_index.emplace(HashKey(), 0);
+    }
+
+    ZETASQL_RETURN_IF_ERROR(input_->Evaluate([&](Row row) -> absl::Status {
+      HashKey key = KeyOf(row, group_keys_);
+      auto [it, inserted] = group_index.try_emplace(key, groups.size());
+      if (inserted) {
+        ZETASQL_RETURN_IF_ERROR(Consume(
+            budget_, QueryMemoryBudget::RowBytes(key.values) +
+                         aggregates_.size() * sizeof(Accumulator)));
+        keys.push_back(std::move(key));
+        groups.emplace_back(aggregates_.size());
+      }
+      std::vector<Accumulator>& accumulators = groups[it->second];
+      for (int i = 0; i < aggregates_.size(); ++i) {
+        ZETASQL_RETURN_IF_ERROR(
+            Accumulate(aggregates_[i], row, &accumulators[i]));
+      }
+      return absl::OkStatus();
+    }));
+
+    for (int group = 0; group < groups.size(); ++group) {
+      Row output = std::move(keys[group].values);
+      for (int i = 0; i < aggregates_.size(); ++i) {
+        const Accumulator& accumulator = groups[group][i];
+        if (aggregates_[i].kind == Kind::kCountStar ||
+            aggregates_[i].kind == Kind::kCount) {
+          output.push_back(zetasql::Value::Int64(accumulator.count));
+        } else if ((aggregates_[i].kind == Kind::kSumNumeric ||
+                    aggregates_[i].kind == Kind::kAvgNumeric) &&
+                   accumulator.count > 0) {
+          ZETASQL_ASSIGN_OR_RETURN(zetasql::NumericValue result,
+                           NumericResult(aggregates_[i].kind, accumulator));
+          output.push_back(zetasql::Value::Numeric(result));
+        } else if (accumulator.value.has_value()) {
+          output.push_back(*accumulator.value);
+        } else {
+          output.push_back(zetasql::Value::Null(aggregates_[i].type));
+        }
+      }
+      ZETASQL_RETURN_IF_ERROR(consumer(std::move(output)));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  struct Accumulator {
+    int64_t count = 0;
+    // The sum, minimum or maximum of the non-NULL arguments seen so far.
+    std::optional<zetasql::Value> value;
+    // For kSumNumeric and kAvgNumeric, the sum of the packed arguments seen
+    // since the last time it would have overflowed. The sum of the arguments
+    // before that is in `numeric_overflow`.
+    __int128 numeric_sum = 0;
+    std::optional<zetasql::NumericValue::SumAggregator> numeric_overflow;
+  };
+
+  // Adds `packed`, which is at most the largest packed NUMERIC in magnitude, to
+  // the aggregator `sum` as two NUMERICs. Any int128 can be split that way.
+  static void AddPacked(__int128 packed,
+                        zetasql::NumericValue::SumAggregator* sum) {
+    __int128 half = packed / 2;
+    sum->Add(zetasql::NumericValue::FromPackedInt(half).value());
+    sum->Add(zetasql::NumericValue::FromPackedInt(packed - half).value());
+  }
+
+  // Adds the NUMERIC `argument` to the sum of `accumulator`. Like the reference
+  // implementation, only the final sum has to be a valid NUMERIC.
+  static void AccumulateNumeric(const zetasql::NumericValue& argument,
+                                Accumulator* accumulator) {
+    __int128 sum;
+    if (!__builtin_add_overflow(accumulator->numeric_sum,
+                                argument.as_packed_int(), &sum)) {
+      accumulator->numeric_sum = sum;
+      return;
+    }
+    if (!accumulator->numeric_overflow.has_value()) {
+      accumulator->numeric_overflow.emplace();
+    }
+    AddPacked(accumulator->numeric_sum, &*accumulator->numeric_overflow);
+    accumulator->numeric_sum = argument.as_packed_int();
+  }
+
+  // Returns the SUM or AVG of the non-empty NUMERIC `accumulator`, or the
+  // reference implementation's error if it is out of range.
+  static absl::StatusOr<zetasql::NumericValue> NumericResult(
+      Kind kind, const Accumulator& accumulator) {
+    if (kind == Kind::kSumNumeric &&
+        !accumulator.numeric_overflow.has_value()) {
+      absl::StatusOr<zetasql::NumericValue> sum =
+          zetasql::NumericValue::FromPackedInt(accumulator.numeric_sum);
+      if (sum.ok()) return sum;
+    }
+    zetasql::NumericValue::SumAggregator sum =
+        accumulator.numeric_overflow.value_or(
+            zetasql::NumericValue::SumAggregator());
+    AddPacked(accumulator.numeric_sum, &sum);
+    if (kind == Kind::kAvgNumeric) {
+      return sum.GetAverage(accumulator.count);
+    }
+    return sum.GetSum();
+  }
+
+  static absl::Status Accumulate(const Aggregate& aggregate, const Row& row,
+                                 Accumulator* accumulator) {
+    if (aggregate.kind == Kind::kCountStar) {
+      ++accumulator->count;
+      return absl::OkStatus();
+    }
+    const zetasql::Value& argument = row[aggregate.slot];
+    if (argument.is_null()) return absl::OkStatus();
+    ++accumulator->count;
+    if (aggregate.kind == Kind::kSumNumeric ||
+        aggregate.kind == Kind::kAvgNumeric) {
+      AccumulateNumeric(argument.numeric_value(), accumulator);
+      return absl::OkStatus();
+    }
+    if (!accumulator->value.has_value()) {
+      accumulator->value = argument;
+      return absl::OkStatus();
+    }
+    switch (aggregate.kind) {
+      case Kind::kSum: {
+        int64_t sum;
+        absl::Status status;
+        if (!zetasql::functions::Add(accumulator->value->int64_value(),
+                                       argument.int64_value(), &sum,
+                                       &status)) {
+          return status;
+        }
+        accumulator->value = zetasql::Value::Int64(sum);
+        break;
+      }
+      case Kind::kMin:
+        if (argument.LessThan(*accumulator->value)) {
+          accumulator->value = argument;
+        }
+        break;
+      case Kind::kMax:
+        if (accumulator->value->LessThan(argument)) {
+          accumulator->value = argument;
+        }
+        break;
+      default:
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  std::unique_ptr<const NativeOperator> input_;
+  const std::vector<int> group_keys_;
+  const std::vector<Aggregate> aggregates_;
+  QueryMemoryBudget* const budget_;
+};
+
+// A sorted run of rows which a SortOperator spilled to a temporary file. The
+// file is deleted when the run is destroyed. Each value of a row is written as
+// its serialized zetasql::ValueProto, preceded by the size of the proto.
+class SpilledRun {
+ public:
+  static absl::StatusOr<std::unique_ptr<SpilledRun>> Create() {
+    std::FILE* file = std::tmpfile();
+    if (file == nullptr) {
+      return error::Internal(absl::StrCat(
+          "Could not create a temporary file to sort query results: ",
+          std::strerror(errno)));
+    }
+    return absl::WrapUnique(new SpilledRun(file));
+  }
+
+  ~SpilledRun() { std::fclose(file_); }
+
+  // Appends `row` to the run. All rows have the same column types.
+  absl::Status Append(const Row& row) {
+    if (types_.empty()) {
+      for (const zetasql::Value& value : row) {
+        types_.push_back(value.type());
+      }
+    }
+    for (const zetasql::Value& value : row) {
+      zetasql::ValueProto value_proto;
+      ZETASQL_RETURN_IF_ERROR(value.Serialize(&value_proto));
+      buffer_.clear();
+      value_proto.AppendToString(&buffer_);
+      const uint32_t size = buffer_.size();
+      if (std::fwrite(&size, sizeof(size), 1, file_) != 1 ||
+          std::fwrite(buffer_.data(), 1, size, file_) != size) {
+        return FileError("write");
+      }
+    }
+    ++num_rows_;
+    return absl::OkStatus();
+  }
+
+  // Prepares the run for reading once all of its rows have been appended.
+  absl::Status FinishWriting() {
+    if (std::fflush(file_) != 0 || std::fseek(file_, 0, SEEK_SET) != 0) {
+      return FileError("rewind");
+    }
+    return absl::OkStatus();
+  }
+
+  // Reads the next row of the run into `row`. Returns false once all rows of
+  // the run have been read.
+  absl::StatusOr<bool> Next(Row* row) {
+    if (num_rows_read_ == num_rows_) return false;
+    row->clear();
+    row->reserve(types_.size());
+    for (const zetasql::Type* type : types_) {
+      uint32_t size;
+      if (std::fread(&size, sizeof(size), 1, file_) != 1) {
+        return FileError("read");
+      }
+      buffer_.resize(size);
+      if (std::fread(buffer_.data(), 1, size, file_) != size) {
+        return FileError("read");
+      }
+      zetasql::ValueProto value_proto;
+      if (!value_proto.ParseFromString(buffer_)) {
+        return error::Internal("Could not parse a spilled query result row");
+      }
+      ZETASQL_ASSIGN_OR_RETURN(zetasql::Value value,
+                       zetasql::Value::Deserialize(value_proto, type));
+      row->push_back(std::move(value));
+    }
+    ++num_rows_read_;
+    return true;
+  }
+
+ private:
+  explicit SpilledRun(std::FILE* file) : file_(file) {}
+
+  absl::Status FileError(absl::string_view operation) const {
+    return error::Internal(absl::StrCat("Could not ", operation,
+                                        " the temporary file of a sorted run "
+                                        "of query results: ",
+                                        std::strerror(errno)));
+  }
+
+  std::FILE* const file_;
+  std::vector<const zetasql::Type*> types_;
+  int64_t num_rows_ = 0;
+  int64_t num_rows_read_ = 0;
+  std::string buffer_;
+};
+
+// Sorts the rows of its input, which keep their relative order when their sort
+// keys are equal. With a limit, only the first `offset + limit` rows are kept
+// in a bounded heap while the input is consumed, and the first `offset` of
+// them are skipped. Without a limit, the input is sorted in runs of about
+// `memory_limit` bytes, all but the last of which are spilled to temporary
+// files, and the runs are merged. The rows have the columns of the input.
+class SortOperator : public NativeOperator {
+ public:
+  struct SortKey {
+    int slot;
+    bool descending;
+    bool nulls_first;
+  };
+
+  SortOperator(std::unique_ptr<const NativeOperator> input,
+               std::vector<SortKey> keys, std::optional<int64_t> limit,
+               int64_t offset, int64_t memory_limit)
+      : input_(std::move(input)),
+        keys_(std::move(keys)),
+        limit_(limit),
+        offset_(offset),
+        memory_limit_(memory_limit) {}
+
+  absl::Status Evaluate(const RowConsumer& consumer) const override {
+    if (!limit_.has_value()) {
+      return SortAll(consumer);
+    }
+
+    // Rows are ordered by their sort keys, then by their position in the
+    // input, so that the top of the heap is the last of the kept rows.
+    using SequencedRow = std::pair<Row, int64_t>;
+    auto before = [this](const SequencedRow& a, const SequencedRow& b) {
+      if (Precedes(a.first, b.first)) return true;
+      if (Precedes(b.first, a.first)) return false;
+      return a.second < b.second;
+    };
+    const int64_t capacity =
+        *limit_ > INT64_MAX - offset_ ? INT64_MAX : *limit_ + offset_;
+
+    std::vector<SequencedRow> rows;
+    int64_t sequence = 0;
+    ZETASQL_RETURN_IF_ERROR(input_->Evaluate([&](Row row) -> absl::Status {
+      rows.emplace_back(std::move(row), sequence++);
+      std::push_heap(rows.begin(), rows.end(), before);
+      if (rows.size() > capacity) {
+        std::pop_heap(rows.begin(), rows.end(), before);
+        rows.pop_back();
+      }
+      return absl::OkStatus();
+    }));
+
+    std::sort_heap(rows.begin(), rows.end(), before);
+    for (int64_t i = offset_; i < rows.size(); ++i) {
+      ZETASQL_RETURN_IF_ERROR(consumer(std::move(rows[i].first)));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Sorts all rows of the input, spilling sorted runs of them to temporary
+  // files whenever the rows kept in memory exceed memory_limit_.
+  absl::Status SortAll(const RowConsumer& consumer) const {
+    auto before = [this](const Row& a, const Row& b) {
+      return Precedes(a, b);
+    };
+    std::vector<std::unique_ptr<SpilledRun>> runs;
+    std::vector<Row> rows;
+    int64_t rows_size = 0;
+    ZETASQL_RETURN_IF_ERROR(input_->Evaluate([&](Row row) -> absl::Status {
+      rows_size += sizeof(Row);
+      for (const zetasql::Value& value : row) {
+        rows_size += value.physical_byte_size();
+      }
+      rows.push_back(std::move(row));
+      if (rows_size < memory_limit_) return absl::OkStatus();
+
+      std::stable_sort(rows.begin(), rows.end(), before);
+      ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<SpilledRun> run, SpilledRun::Create());
+      for (const Row& sorted_row : rows) {
+        ZETASQL_RETURN_IF_ERROR(run->Append(sorted_row));
+      }
+      ZETASQL_RETURN_IF_ERROR(run->FinishWriting());
+      runs.push_back(std::move(run));
+      rows.clear();
+      rows_size = 0;
+      return absl::OkStatus();
+    }));
+    std::stable_sort(rows.begin(), rows.end(), before);
+
+    int64_t position = 0;
+    auto emit = [&](Row row) -> absl::Status {
+      if (position++ < offset_) return absl::OkStatus();
+      return consumer(std::move(row));
+    };
+    if (runs.empty()) {
+      for (Row& row : rows) {
+        ZETASQL_RETURN_IF_ERROR(emit(std::move(row)));
+      }
+      return absl::OkStatus();
+    }
+
+    // Merges the spilled runs and the rows left in memory, which follow all
+    // spilled rows in the input. The heap holds the next row of each run, and
+    // rows with equal keys are taken from the earlier run first.
+    const int num_runs = runs.size() + 1;
+    int64_t next_in_memory = 0;
+    auto next_of_run = [&](int run, Row* row) -> absl::StatusOr<bool> {
+      if (run < runs.size()) return runs[run]->Next(row);
+      if (next_in_memory == rows.size()) return false;
+      *row = std::move(rows[next_in_memory++]);
+      return true;
+    };
+    using RunRow = std::pair<Row, int>;
+    auto after = [this](const RunRow& a, const RunRow& b) {
+      if (Precedes(b.first, a.first)) return true;
+      if (Precedes(a.first, b.first)) return false;
+      return a.second > b.second;
+    };
+    std::vector<RunRow> heads;
+    for (int run = 0; run < num_runs; ++run) {
+      Row row;
+      ZETASQL_ASSIGN_OR_RETURN(bool has_row, next_of_run(run, &row));
+      if (has_row) {
+        heads.emplace_back(std::move(row), run);
+        std::push_heap(heads.begin(), heads.end(), after);
+      }
+    }
+    while (!heads.empty()) {
+      std::pop_heap(heads.begin(), heads.end(), after);
+      RunRow& head = heads.back();
+      const int run = head.second;
+      ZETASQL_RETURN_IF_ERROR(emit(std::move(head.first)));
+      Row row;
+      ZETASQL_ASSIGN_OR_RETURN(bool has_row, next_of_run(run, &row));
+      if (has_row) {
+        head.first = std::move(row);
+        std::push_heap(heads.begin(), heads.end(), after);
+      } else {
+        heads.pop_back();
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Returns true if `a` sorts strictly before `b`.
+  bool Precedes(const Row& a, const Row& b) const {
+    for (const SortKey& key : keys_) {
+      const zetasql::Value& x = a[key.slot];
+      const zetasql::Value& y = b[key.slot];
+      if (x.is_null() || y.is_null()) {
+        if (x.is_null() == y.is_null()) continue;
+        return x.is_null() == key.nulls_first;
+      }
+      if (x.LessThan(y)) return !key.descending;
+      if (y.LessThan(x)) return key.descending;
+    }
+    return false;
+  }
+
+  std::unique_ptr<const NativeOperator> input_;
+  const std::vector<SortKey> keys_;
+  const std::optional<int64_t> limit_;
+  const int64_t offset_;
+  const int64_t memory_limit_;
+};
+
+// Skips the first `offset` rows of its input and produces at most `limit` of
+// the following rows. The rows have the columns of the input. Once the limit
+// is reached, the input is stopped by returning a status, which the operator
+// recognizes by its payload, so that the rest of the input is not read.
+class LimitOperator : public NativeOperator {
+ public:
+  LimitOperator(std::unique_ptr<const NativeOperator> input,
+                std::optional<int64_t> limit, int64_t offset)
+      : input_(std::move(input)), limit_(limit), offset_(offset) {}
+
+  absl::Status Evaluate(const RowConsumer& consumer) const override {
+    if (limit_.has_value() && *limit_ <= 0) return absl::OkStatus();
+    int64_t position = 0;
+    absl::Status status = input_->Evaluate([&](Row row) -> absl::Status {
+      int64_t i = position++;
+      if (i < offset_) return absl::OkStatus();
+      if (limit_.has_value() && i - offset_ >= *limit_) return LimitReached();
+      ZETASQL_RETURN_IF_ERROR(consumer(std::move(row)));
+      if (limit_.has_value() && i - offset_ + 1 >= *limit_) {
+        return LimitReached();
+      }
+      return absl::OkStatus();
+    });
+    if (status.GetPayload(kLimitReachedPayload) == Id()) {
+      return absl::OkStatus();
+    }
+    return status;
+  }
+
+ private:
+  static constexpr absl::string_view kLimitReachedPayload =
+      "emulator.spanner.google.com/native_query_plan/limit_reached";
+
+  // Identifies this operator in the payload of the status which stops its
+  // input, so that the status is told apart from errors of the input and from
+  // the statuses of other limits.
+  absl::Cord Id() const {
+    return absl::Cord(absl::StrCat(reinterpret_cast<uintptr_t>(this)));
+  }
+
+  absl::Status LimitReached() const {
+    absl::Status status = absl::CancelledError("LIMIT reached");
+    status.SetPayload(kLimitReachedPayload, Id());
+    return status;
+  }
+
+  std::unique_ptr<const NativeOperator> input_;
+  const std::optional<int64_t> limit_;
+  const int64_t offset_;
+};
+
+// Produces a row for each element of the array of each input row, in array
+// order. The rows have the columns of the input followed by the element and,
+// if `with_offset`, its 0-based offset. The elements are read from the array
+// in place, and copies of a value share its contents, so large arrays are not
+// copied. An outer scan also produces a row with a NULL element and offset
+// for input rows whose array is empty or NULL. Without input, the array is
+// evaluated once on an empty row.
+class ArrayScanOperator : public NativeOperator {
+ public:
+  ArrayScanOperator(std::unique_ptr<const NativeOperator> input,
+                    Operand array, bool with_offset, bool is_outer)
+      : input_(std::move(input)),
+        array_(std::move(array)),
+        with_offset_(with_offset),
+        is_outer_(is_outer) {}
+
+  absl::Status Evaluate(const RowConsumer& consumer) const override {
+    if (input_ == nullptr) return Unnest(Row(), consumer);
+    return input_->Evaluate([&](Row row) -> absl::Status {
+      return Unnest(std::move(row), consumer);
+    });
+  }
+
+ private:
+  absl::Status Unnest(Row row, const RowConsumer& consumer) const {
+    ZETASQL_ASSIGN_OR_RETURN(zetasql::Value array, array_.Evaluate(row));
+    const int num_elements = array.is_null() ? 0 : array.num_elements();
+    if (num_elements == 0) {
+      if (!is_outer_) return absl::OkStatus();
+      row.push_back(
+          zetasql::Value::Null(array.type()->AsArray()->element_type()));
+      if (with_offset_) row.push_back(zetasql::Value::NullInt64());
+      return consumer(std::move(row));
+    }
+    for (int i = 0; i < num_elements; ++i) {
+      // The last element takes the input row instead of a copy.
+      Row output;
+      if (i + 1 < num_elements) {
+        output = row;
+      } else {
+        output = std::move(row);
+      }
+      output.push_back(array.element(i));
+      if (with_offset_) output.push_back(zetasql::Value::Int64(i));
+      ZETASQL_RETURN_IF_ERROR(consumer(std::move(output)));
+    }
+    return absl::OkStatus();
+  }
+
+  std::unique_ptr<const NativeOperator> input_;
+  const Operand array_;
+  const bool with_offset_;
+  const bool is_outer_;
+};
+
+// Builds the operators evaluating the scans of a query. Each Plan* method
+// returns an operator producing the column_list of its scan, or nullptr if the
+// scan or any of its inputs has an unsupported shape.
+class Planner {
+ public:
+  Planner(const zetasql::ParameterValueMap& params, QueryMemoryBudget* budget)
+      : params_(params), budget_(budget) {}
+
+  std::unique_ptr<const NativeOperator> Plan(
+      const zetasql::ResolvedScan* scan) {
+    switch (scan->node_kind()) {
+      case zetasql::RESOLVED_TABLE_SCAN:
+        return PlanTableScan(scan->GetAs<zetasql::ResolvedTableScan>());
+      case zetasql::RESOLVED_FILTER_SCAN:
+        return PlanFilterScan(scan->GetAs<zetasql::ResolvedFilterScan>());
+      case zetasql::RESOLVED_PROJECT_SCAN:
+        return PlanProjectScan(scan->GetAs<zetasql::ResolvedProjectScan>());
+      case zetasql::RESOLVED_JOIN_SCAN:
+        return PlanJoinScan(scan->GetAs<zetasql::ResolvedJoinScan>());
+      case zetasql::RESOLVED_AGGREGATE_SCAN:
+        return PlanAggregateScan(scan->GetAs<zetasql::ResolvedAggregateScan>());
+      case zetasql::RESOLVED_ORDER_BY_SCAN:
+        return PlanSort(scan->GetAs<zetasql::ResolvedOrderByScan>(),
+                        scan->column_list(), std::nullopt, 0);
+      case zetasql::RESOLVED_LIMIT_OFFSET_SCAN:
+        return PlanLimitOffsetScan(
+            scan->GetAs<zetasql::ResolvedLimitOffsetScan>());
+      case zetasql::RESOLVED_SAMPLE_SCAN:
+        return PlanSampleScan(scan->GetAs<zetasql::ResolvedSampleScan>());
+      case zetasql::RESOLVED_ARRAY_SCAN:
+        return PlanArrayScan(scan->GetAs<zetasql::ResolvedArrayScan>());
+      default:
+        return nullptr;
+    }
+  }
+
+ private:
+  // Returns the operand for a column reference, literal or parameter whose
+  // columns are in `slots`.
+  std::optional<Operand> MakeOperand(const zetasql::ResolvedExpr* expr,
+                                     const ColumnSlots& slots) const {
+    switch (expr->node_kind()) {
+      case zetasql::RESOLVED_COLUMN_REF: {
+        const auto* column_ref = expr->GetAs<zetasql::ResolvedColumnRef>();
+        auto it = slots.find(column_ref->column().column_id());
+        if (column_ref->is_correlated() || it == slots.end()) {
+          return std::nullopt;
+        }
+        return Operand{.slot = it->second};
+      }
+      case zetasql::RESOLVED_LITERAL:
+        return Operand{
+            .constant = expr->GetAs<zetasql::ResolvedLiteral>()->value()};
+      case zetasql::RESOLVED_PARAMETER: {
+        const auto* parameter = expr->GetAs<zetasql::ResolvedParameter>();
+        if (parameter->name().empty()) return std::nullopt;
+        for (const auto& [name, value] : params_) {
+          if (absl::EqualsIgnoreCase(name, parameter->name()) &&
+              value.type()->Equals(parameter->type())) {
+            return Operand{.constant = value};
+          }
+        }
+        return std::nullopt;
+      }
+      default:
+        return std::nullopt;
+    }
+  }
+
+  // Returns the value of a LIMIT or OFFSET, which must be a non-negative
+  // constant.
+  std::optional<int64_t> MakeCount(const zetasql::ResolvedExpr* expr) const {
+    std::optional<Operand> operand = MakeOperand(expr, ColumnSlots());
+    if (!operand.has_value() || !operand->constant.type()->IsInt64() ||
+        operand->constant.is_null() || operand->constant.int64_value() < 0) {
+      return std::nullopt;
+    }
+    return operand->constant.int64_value();
+  }
+
+  // Returns the operand for `expr`, which is either an operand of MakeOperand,
+  // a call of a string function of StringCall or a ProtoFieldAccess on such
+  // expressions.
+  std::optional<Operand> MakeExpression(const zetasql::ResolvedExpr* expr,
+                                        const ColumnSlots& slots) const {
+    if (expr->node_kind() == zetasql::RESOLVED_GET_PROTO_FIELD) {
+      return MakeProtoFieldAccess(expr->GetAs<zetasql::ResolvedGetProtoField>(),
+                                  slots);
+    }
+    if (expr->node_kind() != zetasql::RESOLVED_FUNCTION_CALL) {
+      return MakeOperand(expr, slots);
+    }
+    const auto* call = expr->GetAs<zetasql::ResolvedFunctionCall>();
+    auto function = static_cast<zetasql::FunctionSignatureId>(
+        call->signature().context_id());
+    int arity = StringFunctionArity(function);
+    if (arity == 0 || !IsBuiltinCall(call, function) ||
+        call->argument_list_size() != arity) {
+      return std::nullopt;
+    }
+    auto string_call = std::make_shared<StringCall>();
+    string_call->function = function;
+    for (const auto& argument : call->argument_list()) {
+      if (!argument->type()->IsString()) return std::nullopt;
+      std::optional<Operand> operand = MakeExpression(argument.get(), slots);
+      if (!operand.has_value()) return std::nullopt;
+      string_call->arguments.push_back(*std::move(operand));
+    }
+    const Operand& pattern = string_call->arguments.back();
+    if (function == zetasql::FN_STRING_LIKE && pattern.slot < 0 &&
+        !pattern.computed() && !pattern.constant.is_null()) {
+      // Invalid patterns are left for the reference evaluator to report.
+      absl::StatusOr<LikeMatcher> matcher =
+          LikeMatcher::Create(pattern.constant.string_value());
+      if (!matcher.ok()) return std::nullopt;
+      string_call->like_matcher = *std::move(matcher);
+    }
+    return Operand{.call = std::move(string_call)};
+  }
+
+  // Returns the operand reading the field of `get_field`. Format annotations,
+  // such as DATE on an INT32 field, give other types to the fields, which
+  // CanReadProtoField() rejects. Has-bit reads and required fields are left
+  // to the reference evaluator.
+  std::optional<Operand> MakeProtoFieldAccess(
+      const zetasql::ResolvedGetProtoField* get_field,
+      const ColumnSlots& slots) const {
+    if (get_field->get_has_bit() || !get_field->default_value().is_valid() ||
+        !CanReadProtoField(get_field->field_descriptor(), get_field->type())) {
+      return std::nullopt;
+    }
+    std::optional<Operand> message = MakeExpression(get_field->expr(), slots);
+    if (!message.has_value()) return std::nullopt;
+    return Operand{.field = std::make_shared<ProtoFieldAccess>(ProtoFieldAccess{
+                       .message = *std::move(message),
+                       .field = get_field->field_descriptor(),
+                       .type = get_field->type(),
+                       .default_value = get_field->default_value(),
+                       .return_default_value_when_unset =
+                           get_field->return_default_value_when_unset(),
+                   })};
+  }
+
+  // Returns the membership for `call`, an IN list of constants or an IN UNNEST
+  // of a constant array, whose tested operand is a column in `slots` or a
+  // constant with a simple key type.
+  std::optional<Membership> MakeMembership(
+      const zetasql::ResolvedFunctionCall* call,
+      const ColumnSlots& slots) const {
+    const bool in_array = IsBuiltinCall(call, zetasql::FN_IN_ARRAY);
+    if ((!in_array && !IsBuiltinCall(call, zetasql::FN_IN)) ||
+        call->argument_list_size() < 2 ||
+        (in_array && call->argument_list_size() != 2)) {
+      return std::nullopt;
+    }
+    const zetasql::Type* type = call->argument_list(0)->type();
+    if (!IsSimpleKeyType(type)) return std::nullopt;
+    std::optional<Operand> operand = MakeOperand(call->argument_list(0), slots);
+    if (!operand.has_value()) return std::nullopt;
+    std::vector<zetasql::Value> elements;
+    for (int i = 1; i < call->argument_list_size(); ++i) {
+      std::optional<Operand> element =
+          MakeOperand(call->argument_list(i), ColumnSlots());
+      if (!element.has_value()) return std::nullopt;
+      if (!in_array) {
+        elements.push_back(std::move(element->constant));
+        continue;
+      }
+      // UNNEST of a NULL array produces no elements.
+      const zetasql::Value& array = element->constant;
+      if (!array.type()->IsArray()) return std::nullopt;
+      if (!array.is_null()) elements = array.elements();
+    }
+    for (const zetasql::Value& element : elements) {
+      if (!element.type()->Equals(type)) return std::nullopt;
+    }
+    return MembershipOf(*std::move(operand), elements);
+  }
+
+  // Flattens `expr`, a conjunction of equalities of operands with simple key
+  // types, into `equalities`. If `predicates` is set, the conjunction may also
+  // have BOOL string function calls, which are added to `predicates`, and the
+  // operands may be string function calls. If `memberships` is set, the
+  // conjunction may also have IN lists and IN UNNESTs of constants, which are
+  // added to `memberships`.
+  bool MakeEqualities(const zetasql::ResolvedExpr* expr,
+                      const ColumnSlots& slots,
+                      std::vector<std::pair<Operand, Operand>>* equalities,
+                      std::vector<Operand>* predicates = nullptr,
+                      std::vector<Membership>* memberships = nullptr) {
+    if (expr->node_kind() != zetasql::RESOLVED_FUNCTION_CALL) return false;
+    const auto* call = expr->GetAs<zetasql::ResolvedFunctionCall>();
+    if (IsBuiltinCall(call, zetasql::FN_AND)) {
+      for (const auto& argument : call->argument_list()) {
+        if (!MakeEqualities(argument.get(), slots, equalities, predicates,
+                            memberships)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    auto make_operand = [&](const zetasql::ResolvedExpr* operand_expr) {
+      return predicates != nullptr ? MakeExpression(operand_expr, slots)
+                                   : MakeOperand(operand_expr, slots);
+    };
+    if (predicates != nullptr && expr->type()->IsBool()) {
+      if (std::optional<Operand> predicate = make_operand(expr);
+          predicate.has_value()) {
+        predicates->push_back(*std::move(predicate));
+        return true;
+      }
+    }
+    if (memberships != nullptr) {
+      if (std::optional<Membership> membership = MakeMembership(call, slots);
+          membership.has_value()) {
+        memberships->push_back(*std::move(membership));
+        return true;
+      }
+    }
+    if (!IsBuiltinCall(call, zetasql::FN_EQUAL) ||
+        call->argument_list_size() != 2) {
+      return false;
+    }
+    const zetasql::ResolvedExpr* lhs = call->argument_list(0);
+    const zetasql::ResolvedExpr* rhs = call->argument_list(1);
+    if (!IsSimpleKeyType(lhs->type()) || !lhs->type()->Equals(rhs->type())) {
+      return false;
+    }
+    std::optional<Operand> left = make_operand(lhs);
+    std::optional<Operand> right = make_operand(rhs);
+    if (!left.has_value() || !right.has_value()) return false;
+    equalities->emplace_back(*std::move(left), *std::move(right));
+    return true;
+  }
+
+  // Returns `input`, whose rows hold the columns in `slots`, projected to
+  // `columns`.
+  static std::unique_ptr<const NativeOperator> Project(
+      std::unique_ptr<const NativeOperator> input, const ColumnSlots& slots,
+      const std::vector<zetasql::ResolvedColumn>& columns) {
+    if (input == nullptr) return nullptr;
+    std::vector<Operand> outputs;
+    bool identity = columns.size() == slots.size();
+    for (int i = 0; i < columns.size(); ++i) {
+      auto it = slots.find(columns[i].column_id());
+      if (it == slots.end()) return nullptr;
+      identity = identity && it->second == i;
+      outputs.push_back(Operand{.slot = it->second});
+    }
+    if (identity) return input;
+    return std::make_unique<ProjectOperator>(std::move(input),
+                                             std::move(outputs));
+  }
+
+  // Returns the table read by `scan` if it is a supported table scan.
+  static const QueryableTable* ScannedTable(const zetasql::ResolvedScan* scan) {
+    if (scan->node_kind() != zetasql::RESOLVED_TABLE_SCAN) return nullptr;
+    const auto* table_scan = scan->GetAs<zetasql::ResolvedTableScan>();
+    if (table_scan->for_system_time_expr() != nullptr ||
+        table_scan->column_index_list_size() !=
+            table_scan->column_list_size()) {
+      return nullptr;
+    }
+    return dynamic_cast<const QueryableTable*>(table_scan->table());
+  }
+
+  // Returns the table column at position `slot` in the rows of `scan`.
+  static const Column* ScannedColumn(const zetasql::ResolvedTableScan* scan,
+                                     int slot) {
+    return static_cast<const QueryableColumn*>(
+               scan->table()->GetColumn(scan->column_index_list(slot)))
+        ->wrapped_column();
+  }
+
+  std::unique_ptr<const NativeOperator> PlanTableScan(
+      const zetasql::ResolvedTableScan* scan) {
+    const QueryableTable* table = ScannedTable(scan);
+    if (table == nullptr) return nullptr;
+    return std::make_unique<TableScanOperator>(table,
+                                               scan->column_index_list());
+  }
+
+  // Returns the sample of `scan`, which must be a BERNOULLI sample of a
+  // constant percentage in [0, 100] or a RESERVOIR sample of a constant
+  // non-negative number of rows, without REPEATABLE, WITH WEIGHT or PARTITION
+  // BY.
+  std::optional<RowSample> MakeSample(
+      const zetasql::ResolvedSampleScan* scan) const {
+    if (scan->repeatable_argument() != nullptr ||
+        scan->weight_column() != nullptr ||
+        !scan->partition_by_list().empty()) {
+      return std::nullopt;
+    }
+    std::optional<Operand> size = MakeOperand(scan->size(), ColumnSlots());
+    if (!size.has_value() || size->constant.is_null()) return std::nullopt;
+    const zetasql::Value& value = size->constant;
+
+    RowSample sample;
+    if (absl::EqualsIgnoreCase(scan->method(), "bernoulli") &&
+        scan->unit() == zetasql::ResolvedSampleScan::PERCENT) {
+      double percent;
+      if (value.type()->IsInt64()) {
+        percent = static_cast<double>(value.int64_value());
+      } else if (value.type()->IsDouble()) {
+        percent = value.double_value();
+      } else {
+        return std::nullopt;
+      }
+      // Out of range percentages are errors reported by the evaluator.
+      if (!(percent >= 0 && percent <= 100)) return std::nullopt;
+      sample.method = RowSample::Method::kBernoulli;
+      sample.fraction = percent / 100;
+      return sample;
+    }
+    if (absl::EqualsIgnoreCase(scan->method(), "reservoir") &&
+        scan->unit() == zetasql::ResolvedSampleScan::ROWS) {
+      std::optional<int64_t> num_rows = MakeCount(scan->size());
+      if (!num_rows.has_value()) return std::nullopt;
+      sample.method = RowSample::Method::kReservoir;
+      sample.num_rows = *num_rows;
+      return sample;
+    }
+    return std::nullopt;
+  }
+
+  // Samples of table scans are drawn by the storage as the table is read.
+  std::unique_ptr<const NativeOperator> PlanSampleScan(
+      const zetasql::ResolvedSampleScan* scan) {
+    const QueryableTable* table = ScannedTable(scan->input_scan());
+    if (table == nullptr) return nullptr;
+    std::optional<RowSample> sample = MakeSample(scan);
+    if (!sample.has_value()) return nullptr;
+    const auto* table_scan =
+        scan->input_scan()->GetAs<zetasql::ResolvedTableScan>();
+    return Project(std::make_unique<TableScanOperator>(
+                       table, table_scan->column_index_list(), *sample),
+                   SlotsOf(table_scan->column_list()), scan->column_list());
+  }
+
+  // Plans an UNNEST, whose array is an expression of the input columns or a
+  // constant. UNNESTs with a join condition are left to the reference
+  // evaluator.
+  std::unique_ptr<const NativeOperator> PlanArrayScan(
+      const zetasql::ResolvedArrayScan* scan) {
+    if (scan->join_expr() != nullptr) return nullptr;
+    std::unique_ptr<const NativeOperator> input;
+    std::vector<zetasql::ResolvedColumn> columns;
+    if (scan->input_scan() != nullptr) {
+      input = Plan(scan->input_scan());
+      if (input == nullptr) return nullptr;
+      columns = scan->input_scan()->column_list();
+    }
+    std::optional<Operand> array =
+        MakeExpression(scan->array_expr(), SlotsOf(columns));
+    if (!array.has_value()) return nullptr;
+    columns.push_back(scan->element_column());
+    const bool with_offset = scan->array_offset_column() != nullptr;
+    if (with_offset) columns.push_back(scan->array_offset_column()->column());
+    return Project(std::make_unique<ArrayScanOperator>(
+                       std::move(input), *std::move(array), with_offset,
+                       scan->is_outer()),
+                   SlotsOf(columns), scan->column_list());
+  }
+
+  // Returns a merge join for `scan` if one of its inputs scans a table and the
+  // other scans a table interleaved in it, and the join keys pair each column
+  // of the parent's primary key with the same column of the child's, or
+  // nullptr otherwise.
+  std::unique_ptr<const NativeOperator> PlanInterleavedMergeJoin(
+      const zetasql::ResolvedJoinScan* scan, const std::vector<int>& left_keys,
+      const std::vector<int>& right_keys, const Row& null_right_row) {
+    const QueryableTable* left_table = ScannedTable(scan->left_scan());
+    const QueryableTable* right_table = ScannedTable(scan->right_scan());
+    if (left_table == nullptr || right_table == nullptr) return nullptr;
+    bool left_is_parent;
+    if (right_table->wrapped_table()->parent() ==
+        left_table->wrapped_table()) {
+      left_is_parent = true;
+    } else if (left_table->wrapped_table()->parent() ==
+               right_table->wrapped_table()) {
+      left_is_parent = false;
+    } else {
+      return nullptr;
+    }
+    const auto* parent_scan =
+        (left_is_parent ? scan->left_scan() : scan->right_scan())
+            ->GetAs<zetasql::ResolvedTableScan>();
+    const auto* child_scan =
+        (left_is_parent ? scan->right_scan() : scan->left_scan())
+            ->GetAs<zetasql::ResolvedTableScan>();
+    const QueryableTable* parent_table =
+        left_is_parent ? left_table : right_table;
+    const QueryableTable* child_table =
+        left_is_parent ? right_table : left_table;
+
+    absl::Span<const KeyColumn* const> parent_key =
+        parent_table->wrapped_table()->primary_key();
+    absl::Span<const KeyColumn* const> child_key =
+        child_table->wrapped_table()->primary_key();
+    if (parent_key.empty() || child_key.size() < parent_key.size()) {
+      return nullptr;
+    }
+    InterleavedMergeJoinOperator::Input parent{
+        .table = parent_table,
+        .column_idxs = parent_scan->column_index_list(),
+        .key_slots = std::vector<int>(parent_key.size(), -1)};
+    InterleavedMergeJoinOperator::Input child{
+        .table = child_table,
+        .column_idxs = child_scan->column_index_list(),
+        .key_slots = std::vector<int>(parent_key.size(), -1)};
+    for (int k = 0; k < left_keys.size(); ++k) {
+      int parent_slot = left_is_parent ? left_keys[k] : right_keys[k];
+      int child_slot = left_is_parent ? right_keys[k] : left_keys[k];
+      const Column* parent_column = ScannedColumn(parent_scan, parent_slot);
+      auto it = std::find_if(parent_key.begin(), parent_key.end(),
+                             [&](const KeyColumn* key_column) {
+                               return key_column->column() == parent_column;
+                             });
+      if (it == parent_key.end()) return nullptr;
+      int i = it - parent_key.begin();
+      if (ScannedColumn(child_scan, child_slot) != child_key[i]->column() ||
+          child_key[i]->is_descending() != parent_key[i]->is_descending() ||
+          child_key[i]->is_nulls_last() != parent_key[i]->is_nulls_last()) {
+        return nullptr;
+      }
+      parent.key_slots[i] = parent_slot;
+      child.key_slots[i] = child_slot;
+    }
+    for (int i = 0; i < parent_key.size(); ++i) {
+      if (parent.key_slots[i] < 0) return nullptr;
+    }
+    return std::make_unique<InterleavedMergeJoinOperator>(
+        std::move(parent), std::move(child),
+        std::vector<const KeyColumn*>(parent_key.begin(), parent_key.end()),
+        left_is_parent, scan->join_type() == zetasql::ResolvedJoinScan::LEFT,
+        null_right_row);
+  }
+
+  // Filters of a table scan on its columns which select sets of values, i.e.
+  // memberships and equalities with constants, are also pushed down to the
+  // scan, so that only the matching keys are read if the columns are keys.
+  std::unique_ptr<const NativeOperator> PlanFilterScan(
+      const zetasql::ResolvedFilterScan* scan) {
+    ColumnSlots slots = SlotsOf(scan->input_scan()->column_list());
+    std::vector<std::pair<Operand, Operand>> equalities;
+    std::vector<Operand> predicates;
+    std::vector<Membership> memberships;
+    if (!MakeEqualities(scan->filter_expr(), slots, &equalities, &predicates,
+                        &memberships)) {
+      return nullptr;
+    }
+    std::unique_ptr<const NativeOperator> input;
+    if (const QueryableTable* table = ScannedTable(scan->input_scan());
+        table != nullptr) {
+      input = std::make_unique<TableScanOperator>(
+          table,
+          scan->input_scan()
+              ->GetAs<zetasql::ResolvedTableScan>()
+              ->column_index_list(),
+          std::nullopt, PointFiltersOf(equalities, memberships));
+    } else {
+      input = Plan(scan->input_scan());
+    }
+    if (input == nullptr) return nullptr;
+    return Project(
+        std::make_unique<FilterOperator>(
+            std::move(input), std::move(equalities), std::move(predicates),
+            std::move(memberships)),
+        slots, scan->column_list());
+  }
+
+  // Returns the sets of values which `equalities` and `memberships` select
+  // for the columns they test, at most one per column.
+  static TableScanOperator::PointFilters PointFiltersOf(
+      const std::vector<std::pair<Operand, Operand>>& equalities,
+      const std::vector<Membership>& memberships) {
+    TableScanOperator::PointFilters point_filters;
+    absl::flat_hash_set<int> filtered_slots;
+    auto add = [&](const Operand& operand, std::vector<zetasql::Value> values) {
+      if (operand.slot >= 0 && !operand.computed() &&
+          filtered_slots.insert(operand.slot).second) {
+        point_filters.emplace_back(operand.slot, std::move(values));
+      }
+    };
+    for (const Membership& membership : memberships) {
+      add(membership.operand, membership.values);
+    }
+    auto add_equality = [&](const Operand& column, const Operand& constant) {
+      if (constant.slot < 0 && !constant.computed() &&
+          !constant.constant.is_null()) {
+        add(column, {constant.constant});
+      }
+    };
+    for (const auto& [lhs, rhs] : equalities) {
+      add_equality(lhs, rhs);
+      add_equality(rhs, lhs);
+    }
+    return point_filters;
+  }
+
+  std::unique_ptr<const NativeOperator> PlanProjectScan(
+      const zetasql::ResolvedProjectScan* scan) {
+    std::unique_ptr<const NativeOperator> input = Plan(scan->input_scan());
+    if (input == nullptr) return nullptr;
+    ColumnSlots slots = SlotsOf(scan->input_scan()->column_list());
+    absl::flat_hash_map<int, Operand> computed;
+    for (const auto& computed_column : scan->expr_list()) {
+      std::optional<Operand> operand =
+          MakeExpression(computed_column->expr(), slots);
+      if (!operand.has_value()) return nullptr;
+      computed.emplace(computed_column->column().column_id(),
+                       *std::move(operand));
+    }
+    std::vector<Operand> outputs;
+    for (const zetasql::ResolvedColumn& column : scan->column_list()) {
+      if (auto it = computed.find(column.column_id()); it != computed.end()) {
+        outputs.push_back(it->second);
+      } else if (auto it = slots.find(column.column_id()); it != slots.end()) {
+        outputs.push_back(Operand{.slot = it->second});
+      } else {
+        return nullptr;
+      }
+    }
+    return std::make_unique<ProjectOperator>(std::move(input),
+                                             std::move(outputs));
+  }
+
+  std::unique_ptr<const NativeOperator> PlanJoinScan(
+      const zetasql::ResolvedJoinScan* scan) {
+    if ((scan->join_type() != zetasql::ResolvedJoinScan::INNER &&
+         scan->join_type() != zetasql::ResolvedJoinScan::LEFT) ||
+        scan->join_expr() == nullptr) {
+      return nullptr;
+    }
+    const auto& left_columns = scan->left_scan()->column_list();
+    const auto& right_columns = scan->right_scan()->column_list();
+    ColumnSlots slots = SlotsOf(left_columns);
+    for (int i = 0; i < right_columns.size(); ++i) {
+      slots.emplace(right_columns[i].column_id(), left_columns.size() + i);
+    }
+
+    // Each equality must compare a column of the left input with a column of
+    // the right input.
+    std::vector<std::pair<Operand, Operand>> equalities;
+    if (!MakeEqualities(scan->join_expr(), slots, &equalities)) {
+      return nullptr;
+    }
+    std::vector<int> left_keys;
+    std::vector<int> right_keys;
+    for (auto [lhs, rhs] : equalities) {
+      if (lhs.slot < 0 || rhs.slot < 0) return nullptr;
+      if (lhs.slot > rhs.slot) std::swap(lhs, rhs);
+      if (lhs.slot >= left_columns.size() || rhs.slot < left_columns.size()) {
+        return nullptr;
+      }
+      left_keys.push_back(lhs.slot);
+      right_keys.push_back(rhs.slot - left_columns.size());
+    }
+
+    Row null_right_row;
+    for (const zetasql::ResolvedColumn& column : right_columns) {
+      null_right_row.push_back(zetasql::Value::Null(column.type()));
+    }
+    if (auto merge_join = PlanInterleavedMergeJoin(scan, left_keys, right_keys,
+                                                   null_right_row);
+        merge_join != nullptr) {
+      return Project(std::move(merge_join), slots, scan->column_list());
+    }
+
+    std::unique_ptr<const NativeOperator> left = Plan(scan->left_scan());
+    if (left == nullptr) return nullptr;
+    std::unique_ptr<const NativeOperator> right = Plan(scan->right_scan());
+    if (right == nullptr) return nullptr;
+    return Project(
+        std::make_unique<HashJoinOperator>(
+            std::move(left), std::move(right), std::move(left_keys),
+            std::move(right_keys),
+            scan->join_type() == zetasql::ResolvedJoinScan::LEFT,
+            std::move(null_right_row), budget_),
+        slots, scan->column_list());
+  }
+
+  std::optional<HashAggregateOperator::Aggregate> MakeAggregate(
+      const zetasql::ResolvedExpr* expr, const ColumnSlots& slots) const {
+    using Kind = HashAggregateOperator::Kind;
+    if (expr->node_kind() != zetasql::RESOLVED_AGGREGATE_FUNCTION_CALL) {
+      return std::nullopt;
+    }
+    const auto* call = expr->GetAs<zetasql::ResolvedAggregateFunctionCall>();
+    if (call->distinct() || call->having_modifier() != nullptr ||
+        !call->order_by_item_list().empty() || call->limit() != nullptr ||
+        call->null_handling_modifier() !=
+            zetasql::ResolvedNonScalarFunctionCallBase::DEFAULT_NULL_HANDLING) {
+      return std::nullopt;
+    }
+    if (IsBuiltinCall(call, zetasql::FN_COUNT_STAR)) {
+      return HashAggregateOperator::Aggregate{Kind::kCountStar, -1,
+                                              call->type()};
+    }
+
+    Kind kind;
+    if (IsBuiltinCall(call, zetasql::FN_COUNT)) {
+      kind = Kind::kCount;
+    } else if (IsBuiltinCall(call, zetasql::FN_SUM_INT64)) {
+      kind = Kind::kSum;
+    } else if (IsBuiltinCall(call, zetasql::FN_SUM_NUMERIC)) {
+      kind = Kind::kSumNumeric;
+    } else if (IsBuiltinCall(call, zetasql::FN_AVG_NUMERIC)) {
+      kind = Kind::kAvgNumeric;
+    } else if (IsBuiltinCall(call, zetasql::FN_MIN)) {
+      kind = Kind::kMin;
+    } else if (IsBuiltinCall(call, zetasql::FN_MAX)) {
+      kind = Kind::kMax;
+    } else {
+      return std::nullopt;
+    }
+    if (call->argument_list_size() != 1) return std::nullopt;
+    const zetasql::ResolvedExpr* argument = call->argument_list(0);
+    if (kind != Kind::kCount && !IsSimpleKeyType(argument->type())) {
+      return std::nullopt;
+    }
+    std::optional<Operand> operand = MakeOperand(argument, slots);
+    if (!operand.has_value() || operand->slot < 0) return std::nullopt;
+    return HashAggregateOperator::Aggregate{kind, operand->slot, call->type()};
+  }
+
+  std::unique_ptr<const NativeOperator> PlanAggregateScan(
+      const zetasql::ResolvedAggregateScan* scan) {
+    if (!scan->grouping_set_list().empty() ||
+        !scan->rollup_column_list().empty() ||
+        !scan->collation_list().empty()) {
+      return nullptr;
+    }
+    ColumnSlots input_slots = SlotsOf(scan->input_scan()->column_list());
+    ColumnSlots slots;
+    std::vector<int> group_keys;
+    for (const auto& group_by : scan->group_by_list()) {
+      std::optional<Operand> operand =
+          MakeOperand(group_by->expr(), input_slots);
+      if (!operand.has_value() || operand->slot < 0 ||
+          !IsSimpleKeyType(group_by->expr()->type())) {
+        return nullptr;
+      }
+      slots.emplace(group_by->column().column_id(), group_keys.size());
+      group_keys.push_back(operand->slot);
+    }
+    std::vector<HashAggregateOperator::Aggregate> aggregates;
+    for (const auto& aggregate : scan->aggregate_list()) {
+      if (aggregate->node_kind() != zetasql::RESOLVED_COMPUTED_COLUMN) {
+        return nullptr;
+      }
+      const auto* computed_column =
+          aggregate->GetAs<zetasql::ResolvedComputedColumn>();
+      std::optional<HashAggregateOperator::Aggregate> made =
+          MakeAggregate(computed_column->expr(), input_slots);
+      if (!made.has_value()) return nullptr;
+      slots.emplace(computed_column->column().column_id(),
+                    group_keys.size() + aggregates.size());
+      aggregates.push_back(*made);
+    }
+
+    std::unique_ptr<const NativeOperator> input = Plan(scan->input_scan());
+    if (input == nullptr) return nullptr;
+    return Project(std::make_unique<HashAggregateOperator>(
+                       std::move(input), std::move(group_keys),
+                       std::move(aggregates), budget_),
+                   slots, scan->column_list());
+  }
+
+  // Plans the sort of `scan` keeping the first `offset + limit` rows, with the
+  // output `columns`.
+  std::unique_ptr<const NativeOperator> PlanSort(
+      const zetasql::ResolvedOrderByScan* scan,
+      const std::vector<zetasql::ResolvedColumn>& columns,
+      std::optional<int64_t> limit, int64_t offset) {
+    ColumnSlots slots = SlotsOf(scan->input_scan()->column_list());
+    std::vector<SortOperator::SortKey> keys;
+    for (const auto& item : scan->order_by_item_list()) {
+      std::optional<Operand> operand = MakeOperand(item->column_ref(), slots);
+      if (!operand.has_value() || operand->slot < 0 ||
+          !IsSimpleKeyType(item->column_ref()->type()) ||
+          item->collation_name() != nullptr || !item->collation().Empty()) {
+        return nullptr;
+      }
+      using OrderByItemEnums = zetasql::ResolvedOrderByItemEnums;
+      bool nulls_first =
+          item->null_order() == OrderByItemEnums::NULLS_FIRST ||
+          (item->null_order() == OrderByItemEnums::ORDER_UNSPECIFIED &&
+           !item->is_descending());
+      keys.push_back({operand->slot, item->is_descending(), nulls_first});
+    }
+
+    std::unique_ptr<const NativeOperator> input = Plan(scan->input_scan());
+    if (input == nullptr) return nullptr;
+    return Project(std::make_unique<SortOperator>(
+                       std::move(input), std::move(keys), limit, offset,
+                       config::query_sort_memory_limit_bytes()),
+                   slots, columns);
+  }
+
+  std::unique_ptr<const NativeOperator> PlanLimitOffsetScan(
+      const zetasql::ResolvedLimitOffsetScan* scan) {
+    std::optional<int64_t> limit;
+    if (scan->limit() != nullptr) {
+      limit = MakeCount(scan->limit());
+      if (!limit.has_value()) return nullptr;
+    }
+    int64_t offset = 0;
+    if (scan->offset() != nullptr) {
+      std::optional<int64_t> count = MakeCount(scan->offset());
+      if (!count.has_value()) return nullptr;
+      offset = *count;
+    }
+
+    const zetasql::ResolvedScan* input_scan = scan->input_scan();
+    if (input_scan->node_kind() == zetasql::RESOLVED_ORDER_BY_SCAN) {
+      const auto* order_by = input_scan->GetAs<zetasql::ResolvedOrderByScan>();
+      for (const zetasql::ResolvedColumn& column : scan->column_list()) {
+        if (!SlotsOf(order_by->column_list()).contains(column.column_id())) {
+          return nullptr;
+        }
+      }
+      return PlanSort(order_by, scan->column_list(), limit, offset);
+    }
+    std::unique_ptr<const NativeOperator> input = Plan(input_scan);
+    if (input == nullptr) return nullptr;
+    return Project(
+        std::make_unique<LimitOperator>(std::move(input), limit, offset),
+        SlotsOf(input_scan->column_list()), scan->column_list());
+  }
+
+  const zetasql::ParameterValueMap& params_;
+  QueryMemoryBudget* budget_;
+};
+
+}  // namespace
+
+NativeQueryPlan::NativeQueryPlan(std::unique_ptr<const NativeOperator> root,
+                                 std::vector<int> output_slots,
+                                 QueryMemoryBudget* budget)
+    : root_(std::move(root)),
+      output_slots_(std::move(output_slots)),
+      budget_(budget) {}
+
+NativeQueryPlan::~NativeQueryPlan() = default;
+
+std::unique_ptr<NativeQueryPlan> NativeQueryPlan::Create(
+    const zetasql::ResolvedQueryStmt* query,
+    const zetasql::ParameterValueMap& params, QueryMemoryBudget* budget) {
+  if (query->is_value_table()) return nullptr;
+  Planner planner(params, budget);
+  std::unique_ptr<const NativeOperator> root = planner.Plan(query->query());
+  if (root == nullptr) return nullptr;
+
+  ColumnSlots slots = SlotsOf(query->query()->column_list());
+  std::vector<int> output_slots;
+  for (const auto& output_column : query->output_column_list()) {
+    auto it = slots.find(output_column->column().column_id());
+    if (it == slots.end()) return nullptr;
+    output_slots.push_back(it->second);
+  }
+  return absl::WrapUnique(
+      new NativeQueryPlan(std::move(root), std::move(output_slots), budget));
+}
+
+absl::StatusOr<std::vector<std::vector<zetasql::Value>>>
+NativeQueryPlan::Execute() const {
+  std::vector<Row> rows;
+  ZETASQL_RETURN_IF_ERROR(root_->Evaluate([&](Row row) -> absl::Status {
+    Row output;
+    output.reserve(output_slots_.size());
+    for (int slot : output_slots_) {
+      output.push_back(row[slot]);
+    }
+    ZETASQL_RETURN_IF_ERROR(Consume(budget_, QueryMemoryBudget::RowBytes(output)));
+    rows.push_back(std::move(output));
+    return absl::OkStatus();
+  }));
+  return rows;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,110 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_NATIVE_QUERY_PLAN_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_NATIVE_QUERY_PLAN_H_
+
+#include <memory>
+#include <vector>
+
+#include "zetasql/public/evaluator.h"
+#include "zetasql/public/value.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "absl/status/statusor.h"
+#include "backend/query/query_memory_budget.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// An operator of a NativeQueryPlan, defined in native_query_plan.cc.
+class NativeOperator;
+
+// NativeQueryPlan evaluates common query shapes with hash-based operators
+// instead of the ZetaSQL reference evaluator, which evaluates joins as nested
+// loops and sorts its whole input for every ORDER BY.
+//
+// The supported scans are:
+//   - table scans of QueryableTables, optionally sampled with TABLESAMPLE
+//     BERNOULLI or RESERVOIR, in which case the storage only materializes the
+//     rows of the sample,
+//   - filters which are conjunctions of equalities, of calls of STARTS_WITH
+//     and LIKE, and of IN lists and IN UNNESTs of literals and parameters.
+//     Those comparing the columns of a table scan with constants are pushed
+//     down to the scan, which then reads only the matching keys if the
+//     columns lead the primary key or an index,
+//   - projections of columns, literals, parameters and calls of LOWER, UPPER,
+//     STARTS_WITH, STRPOS, REPLACE and LIKE on STRING values, which take ASCII
+//     fast paths (see string_functions.h),
+//   - in both of the above, fields of PROTO values, which are read from the
+//     serialized message without parsing it (see proto_field_reader.h),
+//   - UNNESTs of arrays of the input rows or of constant arrays, optionally
+//     WITH OFFSET and LEFT JOINed, which read the elements in place,
+//   - inner and left outer equi-joins, evaluated as hash joins, or as merge
+//     joins of the primary key ordered scans when they join a table with a
+//     table interleaved in it on the parent's primary key,
+//   - GROUP BY columns with COUNT, COUNT(*), SUM, MIN and MAX, evaluated as
+//     hash aggregations,
+//   - ORDER BY columns, optionally followed by LIMIT and OFFSET, which keeps
+//     only the top rows in a bounded heap. Without LIMIT, sorted runs of the
+//     input are spilled to temporary files once they exceed
+//     config::query_sort_memory_limit_bytes() and merged.
+//
+// The build sides of hash joins, the groups of hash aggregations and the
+// output rows are charged to the memory budget of the query, if it has one,
+// and the plan fails with RESOURCE_EXHAUSTED once the budget is exceeded.
+//
+// Join, grouping and sort keys are limited to types whose equality and order
+// are the same for the evaluator and for zetasql::Value (e.g. no floating
+// point or collated strings), so that the results match the reference
+// evaluator's up to the order of rows the query leaves undefined.
+class NativeQueryPlan {
+ public:
+  // Returns the plan for `query` with the given parameter values, or nullptr
+  // if any part of the query has an unsupported shape, in which case it must
+  // be evaluated by the reference evaluator. `budget`, if not null, must
+  // outlive the plan.
+  static std::unique_ptr<NativeQueryPlan> Create(
+      const zetasql::ResolvedQueryStmt* query,
+      const zetasql::ParameterValueMap& params,
+      QueryMemoryBudget* budget = nullptr);
+
+  ~NativeQueryPlan();
+
+  // Evaluates the plan, returning the values of the output columns of the
+  // query for each row.
+  absl::StatusOr<std::vector<std::vector<zetasql::Value>>> Execute() const;
+
+ private:
+  NativeQueryPlan(std::unique_ptr<const NativeOperator> root,
+                  std::vector<int> output_slots, QueryMemoryBudget* budget);
+
+  std::unique_ptr<const NativeOperator> root_;
+
+  // Positions of the output columns of the query in the rows of root_.
+  std::vector<int> output_slots_;
+
+  QueryMemoryBudget* budget_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_NATIVE_QUERY_PLAN_H_
@@ -0,0 +1,667 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/native_query_plan.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/analyzer_options.h"
+#include "zetasql/public/analyzer_output.h"
+#include "zetasql/public/evaluator.h"
+#include "zetasql/public/numeric_value.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/types/type_factory.h"
+#include "zetasql/public/value.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/flags/reflection.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/query/analyzer_options.h"
+#include "backend/query/catalog.h"
+#include "backend/query/function_catalog.h"
+#include "backend/query/query_memory_budget.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/storage/row_sampler.h"
+#include "common/config.h"
+#include "tests/common/row_reader.h"
+#include "tests/common/schema_constructor.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::IsNull;
+using ::testing::NotNull;
+using ::testing::UnorderedElementsAre;
+using ::zetasql::values::Bool;
+using ::zetasql::values::Int64;
+using ::zetasql::values::NullBool;
+using ::zetasql::values::NullInt64;
+using ::zetasql::values::NullString;
+using ::zetasql::values::String;
+using ::zetasql_base::testing::IsOkAndHolds;
+using ::zetasql_base::testing::StatusIs;
+
+// A RowCursor which counts the rows moved past by the wrapped cursor.
+class CountingRowCursor : public RowCursor {
+ public:
+  CountingRowCursor(std::unique_ptr<RowCursor> cursor, int64_t* rows_read)
+      : cursor_(std::move(cursor)), rows_read_(rows_read) {}
+
+  bool Next() override {
+    if (!cursor_->Next()) return false;
+    ++*rows_read_;
+    return true;
+  }
+  absl::Status Status() const override { return cursor_->Status(); }
+  int NumColumns() const override { return cursor_->NumColumns(); }
+  const std::string ColumnName(int i) const override {
+    return cursor_->ColumnName(i);
+  }
+  const zetasql::Value ColumnValue(int i) const override {
+    return cursor_->ColumnValue(i);
+  }
+  const zetasql::Type* ColumnType(int i) const override {
+    return cursor_->ColumnType(i);
+  }
+
+ private:
+  std::unique_ptr<RowCursor> cursor_;
+  int64_t* rows_read_;
+};
+
+// A TestRowReader which records the samples and key sets requested by the
+// reads of a plan, and counts the rows they read.
+class RecordingRowReader : public test::TestRowReader {
+ public:
+  using TestRowReader::TestRowReader;
+
+  absl::Status Read(const ReadArg& read_arg,
+                    std::unique_ptr<RowCursor>* cursor) override {
+    samples_.push_back(read_arg.sample);
+    key_sets_.push_back(read_arg.key_set);
+    ZETASQL_RETURN_IF_ERROR(TestRowReader::Read(read_arg, cursor));
+    *cursor = std::make_unique<CountingRowCursor>(std::move(*cursor),
+                                                  &rows_read_);
+    return absl::OkStatus();
+  }
+
+  const std::vector<std::optional<RowSample>>& samples() const {
+    return samples_;
+  }
+  const std::vector<KeySet>& key_sets() const { return key_sets_; }
+  int64_t rows_read() const { return rows_read_; }
+
+ private:
+  std::vector<std::optional<RowSample>> samples_;
+  std::vector<KeySet> key_sets_;
+  int64_t rows_read_ = 0;
+};
+
+class NativeQueryPlanTest : public testing::Test {
+ protected:
+  NativeQueryPlanTest()
+      : schema_(test::CreateSchemaWithOneTable(&type_factory_)),
+        function_catalog_(&type_factory_) {
+    function_catalog_.SetLatestSchema(schema_.get());
+  }
+
+  // Analyzes `sql` and returns its native plan, or nullptr if the query has a
+  // shape which is not supported.
+  absl::StatusOr<std::unique_ptr<NativeQueryPlan>> Plan(
+      absl::string_view sql, const zetasql::ParameterValueMap& params = {},
+      QueryMemoryBudget* budget = nullptr) {
+    zetasql::AnalyzerOptions options = MakeGoogleSqlAnalyzerOptions();
+    for (const auto& [name, value] : params) {
+      ZETASQL_RETURN_IF_ERROR(options.AddQueryParameter(name, value.type()));
+    }
+    catalog_ = std::make_unique<Catalog>(schema_.get(), &function_catalog_,
+                                         &type_factory_, options, &reader_);
+    ZETASQL_RETURN_IF_ERROR(zetasql::AnalyzeStatement(sql, options, catalog_.get(),
+                                              &type_factory_, &output_));
+    return NativeQueryPlan::Create(
+        output_->resolved_statement()->GetAs<zetasql::ResolvedQueryStmt>(),
+        params, budget);
+  }
+
+  zetasql::TypeFactory type_factory_;
+  std::unique_ptr<const Schema> schema_;
+  FunctionCatalog function_catalog_;
+  RecordingRowReader reader_{
+      {{"test_table",
+        {{"int64_col", "string_col"},
+         {zetasql::types::Int64Type(), zetasql::types::StringType()},
+         {{Int64(1), String("one")},
+          {Int64(2), String("two")},
+          {Int64(3), NullString()},
+          {Int64(4), String("four")}}}}}};
+  std::unique_ptr<Catalog> catalog_;
+  std::unique_ptr<const zetasql::AnalyzerOutput> output_;
+};
+
+TEST_F(NativeQueryPlanTest, ScansTables) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto plan,
+                       Plan("SELECT string_col, int64_col FROM test_table"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(String("one"), Int64(1)),
+                                       ElementsAre(String("two"), Int64(2)),
+                                       ElementsAre(NullString(), Int64(3)),
+                                       ElementsAre(String("four"), Int64(4)))));
+}
+
+TEST_F(NativeQueryPlanTest, FiltersOnEqualities) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT int64_col, 'x' AS x FROM test_table "
+                      "WHERE string_col = @s AND int64_col = 2",
+                      {{"s", String("two")}}));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(2), String("x")))));
+}
+
+TEST_F(NativeQueryPlanTest, HashJoinSkipsNullKeys) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT a.int64_col, b.int64_col FROM test_table a "
+                      "JOIN test_table b ON a.string_col = b.string_col"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(1), Int64(1)),
+                                       ElementsAre(Int64(2), Int64(2)),
+                                       ElementsAre(Int64(4), Int64(4)))));
+}
+
+TEST_F(NativeQueryPlanTest, LeftHashJoinPadsUnmatchedRowsWithNulls) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan,
+      Plan("SELECT a.int64_col, b.string_col FROM test_table a "
+           "LEFT JOIN (SELECT * FROM test_table WHERE int64_col = 2) b "
+           "ON a.int64_col = b.int64_col"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(1), NullString()),
+                                       ElementsAre(Int64(2), String("two")),
+                                       ElementsAre(Int64(3), NullString()),
+                                       ElementsAre(Int64(4), NullString()))));
+}
+
+TEST_F(NativeQueryPlanTest, HashJoinFailsOnceMemoryBudgetIsExceeded) {
+  // The budget is exceeded by the first row of the hash table.
+  QueryMemoryBudget budget(/*limit_bytes=*/1);
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT a.int64_col FROM test_table a "
+                      "JOIN test_table b ON a.int64_col = b.int64_col",
+                      {}, &budget));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(), StatusIs(absl::StatusCode::kResourceExhausted));
+}
+
+TEST_F(NativeQueryPlanTest, ChargesGroupsAndOutputRowsToMemoryBudget) {
+  QueryMemoryBudget budget(/*limit_bytes=*/0);
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT string_col, COUNT(*) FROM test_table "
+                      "GROUP BY string_col",
+                      {}, &budget));
+  ASSERT_THAT(plan, NotNull());
+  ZETASQL_ASSERT_OK(plan->Execute());
+  EXPECT_GT(budget.used_bytes(),
+            4 * QueryMemoryBudget::RowBytes({String("one"), Int64(1)}));
+}
+
+class InterleavedMergeJoinTest : public NativeQueryPlanTest {
+ protected:
+  InterleavedMergeJoinTest() {
+    schema_ = test::CreateSchemaWithInterleaving(&type_factory_);
+    function_catalog_.SetLatestSchema(schema_.get());
+    reader_ = test::TestRowReader{
+        {{"Parent",
+          {{"k1", "c1"},
+           {zetasql::types::Int64Type(), zetasql::types::StringType()},
+           {{Int64(1), String("a")},
+            {Int64(2), String("b")},
+            {Int64(4), String("d")}}}},
+         {"CascadeDeleteChild",
+          {{"k1", "k2", "c1"},
+           {zetasql::types::Int64Type(), zetasql::types::Int64Type(),
+            zetasql::types::StringType()},
+           {{Int64(1), Int64(1), String("a1")},
+            {Int64(1), Int64(2), String("a2")},
+            {Int64(3), Int64(1), String("c1")},
+            {Int64(4), Int64(1), String("d1")}}}}}};
+  }
+};
+
+TEST_F(InterleavedMergeJoinTest, JoinsParentsWithTheirChildren) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT p.c1, c.c1 FROM Parent p "
+                      "JOIN CascadeDeleteChild c ON p.k1 = c.k1"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(
+      plan->Execute(),
+      IsOkAndHolds(ElementsAre(ElementsAre(String("a"), String("a1")),
+                               ElementsAre(String("a"), String("a2")),
+                               ElementsAre(String("d"), String("d1")))));
+}
+
+TEST_F(InterleavedMergeJoinTest, LeftJoinPadsParentsWithoutChildren) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT p.k1, c.k2 FROM Parent p "
+                      "LEFT JOIN CascadeDeleteChild c ON c.k1 = p.k1"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(1), Int64(1)),
+                                       ElementsAre(Int64(1), Int64(2)),
+                                       ElementsAre(Int64(2), NullInt64()),
+                                       ElementsAre(Int64(4), Int64(1)))));
+}
+
+TEST_F(InterleavedMergeJoinTest, JoinsChildrenWithTheirParent) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT c.c1, p.c1 FROM CascadeDeleteChild c "
+                      "LEFT JOIN Parent p ON p.k1 = c.k1"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(
+      plan->Execute(),
+      IsOkAndHolds(ElementsAre(ElementsAre(String("a1"), String("a")),
+                               ElementsAre(String("a2"), String("a")),
+                               ElementsAre(String("c1"), NullString()),
+                               ElementsAre(String("d1"), String("d")))));
+}
+
+TEST_F(InterleavedMergeJoinTest, HashJoinsOnOtherKeys) {
+  // Joining the parent key with a column which is not its prefix in the child
+  // key falls back to a hash join, which gives the same rows.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT p.k1, c.k1 FROM Parent p "
+                      "JOIN CascadeDeleteChild c ON p.k1 = c.k2"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(1), Int64(1)),
+                                       ElementsAre(Int64(1), Int64(3)),
+                                       ElementsAre(Int64(1), Int64(4)),
+                                       ElementsAre(Int64(2), Int64(1)))));
+}
+
+TEST_F(NativeQueryPlanTest, AggregatesWithoutGroupByReturnOneRow) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT COUNT(*), COUNT(string_col), SUM(int64_col), "
+                      "MIN(string_col), MAX(int64_col) FROM test_table"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(4), Int64(3),
+                                                   Int64(10), String("four"),
+                                                   Int64(4)))));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      plan, Plan("SELECT COUNT(*), SUM(int64_col) FROM test_table "
+                 "WHERE string_col = 'none'"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(), IsOkAndHolds(ElementsAre(
+                                   ElementsAre(Int64(0), NullInt64()))));
+}
+
+TEST_F(NativeQueryPlanTest, AggregatesGroupsInHashTable) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT b.string_col, COUNT(*), MIN(a.int64_col) "
+                      "FROM test_table a JOIN test_table b "
+                      "ON a.int64_col = b.int64_col GROUP BY b.string_col"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(
+      plan->Execute(),
+      IsOkAndHolds(UnorderedElementsAre(
+          ElementsAre(String("one"), Int64(1), Int64(1)),
+          ElementsAre(String("two"), Int64(1), Int64(2)),
+          ElementsAre(NullString(), Int64(1), Int64(3)),
+          ElementsAre(String("four"), Int64(1), Int64(4)))));
+}
+
+TEST_F(NativeQueryPlanTest, SumReturnsErrorOnOverflow) {
+  reader_ = test::TestRowReader{
+      {{"test_table",
+        {{"int64_col", "string_col"},
+         {zetasql::types::Int64Type(), zetasql::types::StringType()},
+         {{Int64(std::numeric_limits<int64_t>::max()), String("max")},
+          {Int64(1), String("one")}}}}}};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto plan,
+                       Plan("SELECT SUM(int64_col) FROM test_table"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+class NumericAggregateTest : public NativeQueryPlanTest {
+ protected:
+  NumericAggregateTest() {
+    schema_ = test::CreateSimpleDefaultValuesSchema(&type_factory_);
+    function_catalog_.SetLatestSchema(schema_.get());
+  }
+
+  // Makes `players` hold one row per balance, in groups of two players.
+  void SetBalances(const std::vector<zetasql::Value>& balances) {
+    std::vector<std::vector<zetasql::Value>> rows;
+    for (int i = 0; i < balances.size(); ++i) {
+      rows.push_back({Int64(i / 2), balances[i]});
+    }
+    reader_ = test::TestRowReader{
+        {{"players",
+          {{"player_id", "account_balance"},
+           {zetasql::types::Int64Type(), zetasql::types::NumericType()},
+           rows}}}};
+  }
+};
+
+zetasql::Value Numeric(absl::string_view value) {
+  return zetasql::values::Numeric(
+      zetasql::NumericValue::FromStringStrict(value).value());
+}
+
+TEST_F(NumericAggregateTest, SumsAndAveragesNumerics) {
+  SetBalances({Numeric("1.5"), Numeric("2.25"), Numeric("-0.000000001"),
+               zetasql::values::NullNumeric()});
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT player_id, SUM(account_balance), "
+                      "AVG(account_balance) FROM players GROUP BY player_id"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(
+                  ElementsAre(Int64(0), Numeric("3.75"), Numeric("1.875")),
+                  ElementsAre(Int64(1), Numeric("-0.000000001"),
+                              Numeric("-0.000000001")))));
+
+  // A group of only NULLs sums and averages to NULL.
+  SetBalances({zetasql::values::NullNumeric()});
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      plan, Plan("SELECT SUM(account_balance), AVG(account_balance) "
+                 "FROM players"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(
+                  ElementsAre(zetasql::values::NullNumeric(),
+                              zetasql::values::NullNumeric()))));
+}
+
+TEST_F(NumericAggregateTest, OnlyTheFinalNumericSumMustBeInRange) {
+  zetasql::Value max =
+      zetasql::values::Numeric(zetasql::NumericValue::MaxValue());
+  zetasql::Value min =
+      zetasql::values::Numeric(zetasql::NumericValue::MinValue());
+  // The partial sums overflow an int128, but the sum and average do not.
+  SetBalances({max, max, min, min, max});
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT SUM(account_balance), AVG(account_balance) "
+                      "FROM players"));
+  ASSERT_THAT(plan, NotNull());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(zetasql::NumericValue average,
+                       zetasql::NumericValue::MaxValue().Divide(
+                           zetasql::NumericValue(int64_t{5})));
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(
+                  ElementsAre(max, zetasql::values::Numeric(average)))));
+
+  SetBalances({max, Numeric("0.000000001")});
+  ZETASQL_ASSERT_OK_AND_ASSIGN(plan,
+                       Plan("SELECT SUM(account_balance) FROM players"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST_F(NativeQueryPlanTest, SortsNullsFirstInAscendingOrder) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT int64_col FROM test_table ORDER BY string_col"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(
+                  ElementsAre(Int64(3)), ElementsAre(Int64(4)),
+                  ElementsAre(Int64(1)), ElementsAre(Int64(2)))));
+}
+
+TEST_F(NativeQueryPlanTest, MergesSortedRunsSpilledToTemporaryFiles) {
+  absl::FlagSaver flag_saver;
+  // Spills a run for every row.
+  config::set_query_sort_memory_limit_bytes(1);
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT int64_col, string_col FROM test_table "
+                      "ORDER BY string_col DESC"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(2), String("two")),
+                                       ElementsAre(Int64(1), String("one")),
+                                       ElementsAre(Int64(4), String("four")),
+                                       ElementsAre(Int64(3), NullString()))));
+}
+
+TEST_F(NativeQueryPlanTest, KeepsTopRowsOfLimit) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT int64_col FROM test_table "
+                      "ORDER BY string_col DESC LIMIT @limit OFFSET 1",
+                      {{"limit", Int64(2)}}));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(1)),
+                                       ElementsAre(Int64(4)))));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      plan, Plan("SELECT int64_col FROM test_table "
+                 "ORDER BY string_col DESC NULLS FIRST LIMIT 2"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(3)),
+                                       ElementsAre(Int64(2)))));
+}
+
+TEST_F(NativeQueryPlanTest, StopsReadingOnceLimitIsReached) {
+  std::vector<std::vector<zetasql::Value>> rows;
+  for (int64_t i = 0; i < 1000; ++i) {
+    rows.push_back({Int64(i), String(absl::StrCat(i))});
+  }
+  reader_ = RecordingRowReader{
+      {{"test_table",
+        {{"int64_col", "string_col"},
+         {zetasql::types::Int64Type(), zetasql::types::StringType()},
+         rows}}}};
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT int64_col FROM test_table LIMIT 2 OFFSET 1"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(1)),
+                                       ElementsAre(Int64(2)))));
+  EXPECT_LT(reader_.rows_read(), 100);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(plan,
+                       Plan("SELECT int64_col FROM test_table LIMIT 0"));
+  ASSERT_THAT(plan, NotNull());
+  int64_t rows_read = reader_.rows_read();
+  EXPECT_THAT(plan->Execute(), IsOkAndHolds(IsEmpty()));
+  EXPECT_EQ(reader_.rows_read(), rows_read);
+}
+
+TEST_F(NativeQueryPlanTest, PushesTableSamplesToTheReader) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT int64_col FROM test_table "
+                      "TABLESAMPLE BERNOULLI (12.5 PERCENT)"));
+  ASSERT_THAT(plan, NotNull());
+  ZETASQL_EXPECT_OK(plan->Execute());
+  ASSERT_THAT(reader_.samples(), ElementsAre(testing::Ne(std::nullopt)));
+  EXPECT_EQ(reader_.samples()[0]->method, RowSample::Method::kBernoulli);
+  EXPECT_DOUBLE_EQ(reader_.samples()[0]->fraction, 0.125);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      plan, Plan("SELECT string_col FROM test_table "
+                 "TABLESAMPLE RESERVOIR (@n ROWS)",
+                 {{"n", Int64(3)}}));
+  ASSERT_THAT(plan, NotNull());
+  ZETASQL_EXPECT_OK(plan->Execute());
+  ASSERT_EQ(reader_.samples().size(), 2);
+  ASSERT_TRUE(reader_.samples()[1].has_value());
+  EXPECT_EQ(reader_.samples()[1]->method, RowSample::Method::kReservoir);
+  EXPECT_EQ(reader_.samples()[1]->num_rows, 3);
+
+  // Invalid sizes are left to the evaluator, which reports them.
+  EXPECT_THAT(Plan("SELECT int64_col FROM test_table "
+                   "TABLESAMPLE BERNOULLI (@p PERCENT)",
+                   {{"p", Int64(101)}}),
+              IsOkAndHolds(IsNull()));
+  EXPECT_THAT(Plan("SELECT int64_col FROM test_table "
+                   "TABLESAMPLE RESERVOIR (@n ROWS)",
+                   {{"n", Int64(-1)}}),
+              IsOkAndHolds(IsNull()));
+}
+
+TEST_F(NativeQueryPlanTest, ReadsKeysOfUnnestedArrays) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan,
+      Plan("SELECT int64_col, string_col FROM test_table "
+           "WHERE int64_col IN UNNEST(@ids)",
+           {{"ids", zetasql::values::Int64Array({4, 1, 4, 7})}}));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(1), String("one")),
+                                       ElementsAre(Int64(4), String("four")))));
+  // The distinct keys are read in order.
+  ASSERT_EQ(reader_.key_sets().size(), 1);
+  EXPECT_THAT(reader_.key_sets()[0].keys(),
+              ElementsAre(Key({Int64(1)}), Key({Int64(4)}), Key({Int64(7)})));
+  EXPECT_TRUE(reader_.key_sets()[0].ranges().empty());
+}
+
+TEST_F(NativeQueryPlanTest, FiltersOnInLists) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT int64_col FROM test_table "
+                      "WHERE string_col IN ('two', @s, NULL)",
+                      {{"s", String("four")}}));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(2)),
+                                       ElementsAre(Int64(4)))));
+
+  // UNNEST of a NULL array matches no rows.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      plan, Plan("SELECT int64_col FROM test_table "
+                 "WHERE int64_col IN UNNEST(@ids)",
+                 {{"ids", zetasql::Value::Null(
+                              zetasql::types::Int64ArrayType())}}));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(), IsOkAndHolds(testing::IsEmpty()));
+}
+
+TEST_F(NativeQueryPlanTest, ProjectsStringFunctions) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan,
+      Plan("SELECT UPPER(string_col), STRPOS(string_col, 'o'), "
+           "REPLACE(LOWER(string_col), 'o', '0'), string_col LIKE '%o' "
+           "FROM test_table"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(
+      plan->Execute(),
+      IsOkAndHolds(ElementsAre(
+          ElementsAre(String("ONE"), Int64(1), String("0ne"), Bool(false)),
+          ElementsAre(String("TWO"), Int64(3), String("tw0"), Bool(true)),
+          ElementsAre(NullString(), NullInt64(), NullString(), NullBool()),
+          ElementsAre(String("FOUR"), Int64(2), String("f0ur"),
+                      Bool(false)))));
+}
+
+TEST_F(NativeQueryPlanTest, FiltersOnStringFunctions) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT int64_col FROM test_table "
+                      "WHERE STARTS_WITH(string_col, @prefix) "
+                      "AND UPPER(string_col) = 'TWO'",
+                      {{"prefix", String("t")}}));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(2)))));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(plan, Plan("SELECT int64_col FROM test_table "
+                                  "WHERE string_col LIKE '_o%'"));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(4)))));
+}
+
+TEST_F(NativeQueryPlanTest, UnnestsArrays) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT x, o FROM UNNEST(@xs) AS x WITH OFFSET o",
+                      {{"xs", zetasql::values::StringArray({"a", "b"})}}));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(String("a"), Int64(0)),
+                                       ElementsAre(String("b"), Int64(1)))));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      plan, Plan("SELECT int64_col, x FROM test_table, UNNEST(@xs) AS x "
+                 "WHERE int64_col = 2",
+                 {{"xs", zetasql::values::Int64Array({5, 6})}}));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(2), Int64(5)),
+                                       ElementsAre(Int64(2), Int64(6)))));
+}
+
+TEST_F(NativeQueryPlanTest, LeftJoinedUnnestPadsEmptyArraysWithNull) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto plan, Plan("SELECT int64_col, x FROM test_table "
+                      "LEFT JOIN UNNEST(@xs) AS x WHERE int64_col = 1",
+                      {{"xs", zetasql::Value::Null(
+                                  zetasql::types::Int64ArrayType())}}));
+  ASSERT_THAT(plan, NotNull());
+  EXPECT_THAT(plan->Execute(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(1), NullInt64()))));
+}
+
+TEST_F(NativeQueryPlanTest, ReturnsNullForUnsupportedShapes) {
+  for (absl::string_view sql : {
+           "SELECT int64_col + 1 FROM test_table",
+           "SELECT a.int64_col FROM test_table a "
+           "JOIN test_table b ON a.int64_col < b.int64_col",
+           "SELECT a.int64_col FROM test_table a CROSS JOIN test_table b",
+           "SELECT COUNT(DISTINCT string_col) FROM test_table",
+           "SELECT int64_col FROM test_table WHERE string_col != 'one'",
+           "SELECT LENGTH(string_col) FROM test_table",
+           "SELECT string_col LIKE 'a\\\\' FROM test_table",
+           "SELECT int64_col FROM test_table "
+           "UNION ALL SELECT int64_col FROM test_table",
+       }) {
+    EXPECT_THAT(Plan(sql), IsOkAndHolds(IsNull())) << sql;
+  }
+  EXPECT_THAT(Plan("SELECT int64_col FROM test_table LIMIT @limit",
+                   {{"limit", NullInt64()}}),
+              IsOkAndHolds(IsNull()));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,137 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/query/parallel_row_cursor.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "backend/access/read.h"
+#include "third_party/spanner_pg/interface/pg_arena.h"
+#include "third_party/spanner_pg/shims/memory_context_pg_arena.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+ParallelRowCursor::ParallelRowCursor(
+    std::vector<std::unique_ptr<RowCursor>> cursors, int num_threads)
+    : cursors_(std::move(cursors)), window_(2 * std::max(1, num_threads)) {
+  if (!cursors_.empty()) {
+    for (int i = 0; i < cursors_[0]->NumColumns(); ++i) {
+      column_names_.push_back(cursors_[0]->ColumnName(i));
+      column_types_.push_back(cursors_[0]->ColumnType(i));
+    }
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    splits_.resize(cursors_.size());
+  }
+  num_threads = std::min<int>(num_threads, cursors_.size());
+  threads_.reserve(num_threads);
+  for (int t = 0; t < num_threads; ++t) {
+    threads_.emplace_back([this]() { Work(); });
+  }
+}
+
+ParallelRowCursor::~ParallelRowCursor() {
+  cancelled_ = true;
+  {
+    // Wake up the threads waiting for the consumer.
+    absl::MutexLock lock(&mu_);
+    consumed_splits_ = cursors_.size();
+  }
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void ParallelRowCursor::Work() {
+  // Comparing PG.NUMERIC keys calls into PG, which requires a PG arena on
+  // every thread.
+  absl::StatusOr<std::unique_ptr<postgres_translator::interfaces::PGArena>>
+      arena = postgres_translator::spangres::MemoryContextPGArena::Init(
+          nullptr);
+  while (true) {
+    int i;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &ParallelRowCursor::CanTakeSplit));
+      if (next_split_ >= splits_.size() || cancelled_) return;
+      i = next_split_++;
+    }
+
+    std::vector<std::vector<zetasql::Value>> rows;
+    absl::Status status =
+        arena.ok() ? Buffer(cursors_[i].get(), &rows) : arena.status();
+
+    absl::MutexLock lock(&mu_);
+    splits_[i].rows = std::move(rows);
+    splits_[i].status = std::move(status);
+    splits_[i].done = true;
+  }
+}
+
+bool ParallelRowCursor::CanTakeSplit() const {
+  return next_split_ >= splits_.size() ||
+         next_split_ < consumed_splits_ + window_;
+}
+
+absl::Status ParallelRowCursor::Buffer(
+    RowCursor* cursor, std::vector<std::vector<zetasql::Value>>* rows) {
+  std::vector<std::vector<zetasql::Value>> batch;
+  while (!cancelled_ && cursor->NextBatch(kRowCursorBatchSize, &batch)) {
+    rows->insert(rows->end(), std::make_move_iterator(batch.begin()),
+                 std::make_move_iterator(batch.end()));
+  }
+  return cursor->Status();
+}
+
+bool ParallelRowCursor::Next() {
+  if (!status_.ok()) return false;
+  if (++row_index_ < rows_.size()) return true;
+
+  // Move on to the rows of the next split, which lets another thread take a
+  // new split.
+  absl::MutexLock lock(&mu_);
+  while (consumed_splits_ < splits_.size()) {
+    Split& split = splits_[consumed_splits_++];
+    mu_.Await(absl::Condition(&split.done));
+    if (!split.status.ok()) {
+      status_ = split.status;
+      return false;
+    }
+    rows_ = std::move(split.rows);
+    row_index_ = 0;
+    if (!rows_.empty()) return true;
+  }
+  return false;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
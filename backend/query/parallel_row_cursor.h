@@ -0,0 +1,121 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_PARALLEL_ROW_CURSOR_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_PARALLEL_ROW_CURSOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "backend/access/read.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// ParallelRowCursor returns the rows of a sequence of cursors, in order, while
+// iterating the cursors ahead of the consumer on up to `num_threads` threads.
+// Each thread takes the next cursor which no thread has taken yet as soon as it
+// is done with its previous one, and buffers its rows until the consumer gets
+// to them. At most 2 * `num_threads` cursors are buffered at a time.
+//
+// The cursors must all have the same columns, and must support being iterated
+// on threads other than the one which created them (see
+// RowReader::ReadSplits). Iteration stops at the first cursor which fails.
+class ParallelRowCursor : public RowCursor {
+ public:
+  ParallelRowCursor(std::vector<std::unique_ptr<RowCursor>> cursors,
+                    int num_threads);
+
+  // Stops the threads once they are done with the cursors they are iterating.
+  ~ParallelRowCursor() override;
+
+  bool Next() override;
+  absl::Status Status() const override { return status_; }
+  int NumColumns() const override { return column_names_.size(); }
+  const std::string ColumnName(int i) const override {
+    return column_names_[i];
+  }
+  const zetasql::Value ColumnValue(int i) const override {
+    return rows_[row_index_][i];
+  }
+  const zetasql::Type* ColumnType(int i) const override {
+    return column_types_[i];
+  }
+
+ private:
+  // The rows of a cursor, once buffered by a thread.
+  struct Split {
+    bool done = false;
+    std::vector<std::vector<zetasql::Value>> rows;
+    absl::Status status;
+  };
+
+  // Takes and buffers cursors until there are none left or the consumer is
+  // gone.
+  void Work();
+
+  // Returns true if a thread may take the next cursor, which it may unless too
+  // many cursors are already buffered ahead of the consumer.
+  bool CanTakeSplit() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  absl::Status Buffer(RowCursor* cursor,
+                      std::vector<std::vector<zetasql::Value>>* rows);
+
+  std::vector<std::unique_ptr<RowCursor>> cursors_;
+  std::vector<std::string> column_names_;
+  std::vector<const zetasql::Type*> column_types_;
+
+  // Maximum number of cursors buffered ahead of the consumer.
+  const int window_;
+
+  absl::Mutex mu_;
+  std::vector<Split> splits_ ABSL_GUARDED_BY(mu_);
+
+  // Index of the next cursor to be taken by a thread.
+  int next_split_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // Number of splits whose rows were moved to the consumer.
+  int consumed_splits_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // Set when the consumer is destroyed, to stop the threads early.
+  std::atomic<bool> cancelled_ = false;
+
+  // Rows of the current cursor, moved out of splits_ by the consumer.
+  std::vector<std::vector<zetasql::Value>> rows_;
+  int64_t row_index_ = -1;
+  absl::Status status_;
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_PARALLEL_ROW_CURSOR_H_
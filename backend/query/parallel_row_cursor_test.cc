@@ -0,0 +1,123 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/parallel_row_cursor.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+#include "backend/access/read.h"
+#include "tests/common/row_cursor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::zetasql_base::testing::StatusIs;
+
+// A cursor which fails without returning any rows.
+class FailingRowCursor : public test::TestRowCursor {
+ public:
+  FailingRowCursor()
+      : TestRowCursor({"k"}, {zetasql::types::Int64Type()}, {}) {}
+
+  absl::Status Status() const override {
+    return absl::InternalError("failed");
+  }
+};
+
+// Returns `num_cursors` cursors of `rows_per_cursor` consecutive keys each.
+std::vector<std::unique_ptr<RowCursor>> MakeCursors(int num_cursors,
+                                                    int rows_per_cursor) {
+  std::vector<std::unique_ptr<RowCursor>> cursors;
+  for (int c = 0; c < num_cursors; ++c) {
+    std::vector<std::vector<zetasql::Value>> rows;
+    for (int r = 0; r < rows_per_cursor; ++r) {
+      rows.push_back({zetasql::values::Int64(c * rows_per_cursor + r)});
+    }
+    cursors.push_back(std::make_unique<test::TestRowCursor>(
+        std::vector<std::string>{"k"},
+        std::vector<const zetasql::Type*>{zetasql::types::Int64Type()}, rows));
+  }
+  return cursors;
+}
+
+std::vector<int64_t> ReadKeys(RowCursor* cursor) {
+  std::vector<int64_t> keys;
+  while (cursor->Next()) {
+    keys.push_back(cursor->ColumnValue(0).int64_value());
+  }
+  return keys;
+}
+
+TEST(ParallelRowCursorTest, ReturnsRowsOfCursorsInOrder) {
+  ParallelRowCursor cursor(MakeCursors(/*num_cursors=*/50,
+                                       /*rows_per_cursor=*/7),
+                           /*num_threads=*/4);
+  ASSERT_EQ(cursor.NumColumns(), 1);
+  EXPECT_EQ(cursor.ColumnName(0), "k");
+  EXPECT_TRUE(cursor.ColumnType(0)->IsInt64());
+
+  std::vector<int64_t> expected;
+  for (int64_t k = 0; k < 50 * 7; ++k) expected.push_back(k);
+  EXPECT_THAT(ReadKeys(&cursor), ElementsAreArray(expected));
+  ZETASQL_EXPECT_OK(cursor.Status());
+}
+
+TEST(ParallelRowCursorTest, SkipsEmptyCursors) {
+  std::vector<std::unique_ptr<RowCursor>> cursors = MakeCursors(3, 0);
+  for (auto& cursor : MakeCursors(1, 2)) cursors.push_back(std::move(cursor));
+  for (auto& cursor : MakeCursors(2, 0)) cursors.push_back(std::move(cursor));
+
+  ParallelRowCursor cursor(std::move(cursors), /*num_threads=*/2);
+  EXPECT_THAT(ReadKeys(&cursor), ElementsAreArray({0, 1}));
+  ZETASQL_EXPECT_OK(cursor.Status());
+}
+
+TEST(ParallelRowCursorTest, StopsAtFirstFailingCursor) {
+  std::vector<std::unique_ptr<RowCursor>> cursors = MakeCursors(2, 2);
+  cursors.push_back(std::make_unique<FailingRowCursor>());
+  for (auto& cursor : MakeCursors(2, 2)) cursors.push_back(std::move(cursor));
+
+  ParallelRowCursor cursor(std::move(cursors), /*num_threads=*/3);
+  EXPECT_THAT(ReadKeys(&cursor), ElementsAreArray({0, 1, 2, 3}));
+  EXPECT_THAT(cursor.Status(), StatusIs(absl::StatusCode::kInternal));
+  EXPECT_FALSE(cursor.Next());
+}
+
+TEST(ParallelRowCursorTest, CanBeDestroyedBeforeAllRowsAreRead) {
+  auto cursor = std::make_unique<ParallelRowCursor>(MakeCursors(100, 100),
+                                                    /*num_threads=*/4);
+  ASSERT_TRUE(cursor->Next());
+  EXPECT_EQ(cursor->ColumnValue(0).int64_value(), 0);
+  cursor.reset();
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -127,6 +127,8 @@ absl::Status PartitionabilityValidator::ValidateSimpleScan(
         }
         return error_status;
       case zetasql::RESOLVED_TABLE_SCAN:
+        root_table_ = schema_->FindTable(
+            current_node->GetAs<zetasql::ResolvedTableScan>()->table()->Name());
         return absl::OkStatus();
       default:
         return error_status;
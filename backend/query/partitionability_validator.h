@@ -42,6 +42,10 @@ class PartitionabilityValidator : public zetasql::ResolvedASTVisitor {
     return zetasql::ResolvedASTVisitor::DefaultVisit(node);
   }
 
+  // Returns the table scanned by a query validated as a simple table scan, or
+  // null if the query has no table scan.
+  const Table* root_table() const { return root_table_; }
+
  private:
   // Returns OK if query is partitionable.
   absl::Status ValidatePartitionability(const zetasql::ResolvedNode* node);
@@ -53,6 +57,8 @@ class PartitionabilityValidator : public zetasql::ResolvedASTVisitor {
   bool HasSubquery(const zetasql::ResolvedNode* node);
 
   const Schema* schema_;
+
+  const Table* root_table_ = nullptr;
 };
 
 }  // namespace backend
@@ -73,6 +73,7 @@ TEST_F(PartitionabilityValidatorTest, ValidateSimpleScanPartitionable) {
                                        std::move(project_scan));
 
   ZETASQL_ASSERT_OK(query_stmt->Accept(&validator));
+  EXPECT_EQ(validator.root_table(), schema()->FindTable("test_table"));
 }
 
 TEST_F(PartitionabilityValidatorTest,
@@ -176,6 +177,7 @@ TEST_F(PartitionabilityValidatorTest, SelectOneIsPartitionable) {
   const zetasql::ResolvedStatement* resolved_statement =
       analyzer_output->resolved_statement();
   ZETASQL_EXPECT_OK(resolved_statement->Accept(&validator));
+  EXPECT_EQ(validator.root_table(), nullptr);
 }
 
 TEST_F(PartitionabilityValidatorTest,
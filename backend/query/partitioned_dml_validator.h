@@ -39,6 +39,11 @@ class PartitionedDMLValidator : public zetasql::ResolvedASTVisitor {
     if (node->node_kind() == zetasql::RESOLVED_INSERT_STMT) {
       return error::NoInsertForPartitionedDML();
     }
+    // The statement is executed in many transactions, whose returned rows
+    // are not combined.
+    if (node->node_kind() == zetasql::RESOLVED_RETURNING_CLAUSE) {
+      return error::NoReturningForPartitionedDML();
+    }
     // For other kinds of DML statements, visit the full tree to collect
     // the number of tables involved.
     return zetasql::ResolvedASTVisitor::DefaultVisit(node);
@@ -89,6 +89,15 @@ TEST_F(PartitionedDMLValidatorTest, PartitionedDMLDoesNotSupportInsert) {
             error::NoInsertForPartitionedDML());
 }
 
+TEST_F(PartitionedDMLValidatorTest, PartitionedDMLDoesNotSupportThenReturn) {
+  auto stmt = AnalyzeQuery(
+      "UPDATE test_table SET string_col = 'a' WHERE int64_col > 0 "
+      "THEN RETURN int64_col");
+  PartitionedDMLValidator validator;
+  EXPECT_EQ(stmt->resolved_statement()->Accept(&validator),
+            error::NoReturningForPartitionedDML());
+}
+
 }  // namespace
 
 }  // namespace backend
@@ -14,8 +14,12 @@
 // limitations under the License.
 //
 
+
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/flags/parse.h"
 #include "zetasql/base/logging.h"
@@ -35,6 +39,9 @@ using ::riegeli::CFileReader;
 
 static constexpr char kCsvSeparator = ',';
 
+constexpr absl::string_view kInfoSchemaColumnsMetadataPath =
+    "external/com_google_cloud_spanner_emulator/backend/query/";
+
 std::string GetMetadataFileByDialect(const DatabaseDialect& dialect,
                                      absl::string_view gsql_file,
                                      absl::string_view pg_file) {
@@ -51,123 +58,159 @@ std::string GetMetadataFileByDialect(const DatabaseDialect& dialect,
       // Should never get here.
       break;
   }
-
-  constexpr absl::string_view kInfoSchemaColumnsMetadataPath =
-      "external/com_google_cloud_spanner_emulator/backend/query/";
   return absl::StrCat(kInfoSchemaColumnsMetadataPath, metadata_file);
 }
 
-// This is used to create c++ code which are used to populate information
-// schema. It reads information schema data from csv files and
-// populates a header file with a static vector.
-
-std::string PopulateInfoSchemaColumnsMetadata(const DatabaseDialect& dialect) {
-  std::string prefix = "";
-  if (dialect == DatabaseDialect::POSTGRESQL) {
-    prefix = "PG";
-  }
-  std::string metadata_code = absl::Substitute(
-      R"(inline const std::vector<ColumnsMetaEntry>& $0ColumnsMetadata() {
-  // clang-format off
-  static const zetasql_base::NoDestructor<std::vector<ColumnsMetaEntry>>
-      kColumnsMetadata({
-)",
-      prefix);
+// A field of the metadata CSV files, in the order of the fields of the entry
+// struct it populates. Quoted fields are emitted as string literals and other
+// fields as they are.
+struct MetadataField {
+  absl::string_view name;
+  bool quoted = true;
+};
 
-  constexpr absl::string_view kGSQLInfoSchemaColumnsMetadata =
-      "info_schema_columns_metadata.csv";
-  constexpr absl::string_view kPGInfoSchemaColumnsMetadata =
-      "pg_info_schema_columns_metadata.csv";
-  std::string metadata_file = GetMetadataFileByDialect(
-      dialect, kGSQLInfoSchemaColumnsMetadata, kPGInfoSchemaColumnsMetadata);
+// This is used to create c++ code which are used to populate information
+// schema. It reads the records of `metadata_file` and populates a header file
+// with a constexpr array `k<accessor>` of `entry_type` and an inline function
+// `accessor` returning a span over it, so that no metadata is parsed at
+// runtime.
+//
+// If `index_by_name` is true, also populates an array `k<accessor>ByName` of
+// the positions of the entries ordered by table name and then column name, and
+// an inline function `<accessor>ByName` returning a span over it, so that
+// entries can be looked up by binary search.
+std::string PopulateMetadata(absl::string_view metadata_file,
+                             absl::string_view entry_type,
+                             absl::string_view accessor,
+                             const std::vector<MetadataField>& fields,
+                             bool index_by_name) {
   CsvReaderBase::Options options;
   options.set_field_separator(kCsvSeparator);
-  options.set_required_header(
-      {"table_name", "column_name", "is_nullable", "spanner_type"});
+  std::vector<std::string> header;
+  for (const MetadataField& field : fields) {
+    header.emplace_back(field.name);
+  }
+  options.set_required_header(header);
   CFileReader file_reader = CFileReader(metadata_file);
   CsvReader csv_reader(&file_reader, options);
   ZETASQL_VLOG(csv_reader.status().ok())
       << "Error reading csv file:" << csv_reader.status();
-  absl::StrAppend(&metadata_code, "  // NOLINTBEGIN(whitespace/line_length)\n");
+
+  std::string entries;
+  std::vector<std::pair<std::string, std::string>> names;
   for (CsvRecord record; csv_reader.ReadRecord(record);) {
-    std::string table_name = absl::StrCat("\"", record["table_name"], "\"");
-    std::string column_name = absl::StrCat("\"", record["column_name"], "\"");
-    std::string is_nullable = absl::StrCat("\"", record["is_nullable"], "\"");
-    std::string spanner_type = absl::StrCat("\"", record["spanner_type"], "\"");
-    absl::StrAppend(&metadata_code, "    {", table_name, ", ", column_name,
-                    ", ", is_nullable, ", ", spanner_type, "},\n");
+    absl::StrAppend(&entries, "    {");
+    for (int i = 0; i < fields.size(); ++i) {
+      absl::string_view value = record[fields[i].name];
+      absl::StrAppend(&entries, i > 0 ? ", " : "",
+                      fields[i].quoted ? absl::StrCat("\"", value, "\"")
+                                       : std::string(value));
+    }
+    absl::StrAppend(&entries, "},\n");
+    names.emplace_back(record["table_name"], record["column_name"]);
   }
-  absl::StrAppend(&metadata_code, R"(  });
-  // NOLINTEND(whitespace/line_length)
-  // clang-format on
-    return *kColumnsMetadata;
-}
-
-)");
   ZETASQL_VLOG(csv_reader.Close()) << csv_reader.status();
+
+  if (names.empty()) {
+    // Arrays can not be empty.
+    std::string metadata_code = absl::Substitute(
+        R"(inline absl::Span<const $0> $1() { return {}; }
+
+)",
+        entry_type, accessor);
+    if (index_by_name) {
+      absl::StrAppend(&metadata_code, "inline absl::Span<const int> ", accessor,
+                      "ByName() { return {}; }\n\n");
+    }
+    return metadata_code;
+  }
+
+  std::string metadata_code = absl::Substitute(
+      R"(// clang-format off
+// NOLINTBEGIN(whitespace/line_length)
+inline constexpr $0 k$1[] = {
+$2};
+// NOLINTEND(whitespace/line_length)
+// clang-format on
+
+inline absl::Span<const $0> $1() { return k$1; }
+
+)",
+      entry_type, accessor, entries);
+  if (!index_by_name) {
+    return metadata_code;
+  }
+
+  // Entries with the same names keep their order, so that a search finds the
+  // first of them.
+  std::vector<int> by_name(names.size());
+  for (int i = 0; i < by_name.size(); ++i) {
+    by_name[i] = i;
+  }
+  std::stable_sort(by_name.begin(), by_name.end(),
+                   [&](int a, int b) { return names[a] < names[b]; });
+  std::string positions;
+  for (int i = 0; i < by_name.size(); ++i) {
+    absl::StrAppend(&positions, i % 16 == 0 ? "    " : " ", by_name[i], ",",
+                    i % 16 == 15 || i + 1 == by_name.size() ? "\n" : "");
+  }
+  absl::StrAppend(
+      &metadata_code,
+      absl::Substitute(
+          R"(// Positions of the entries of $0() ordered by table name, then by
+// column name.
+inline constexpr int k$0ByName[] = {
+$1};
+
+inline absl::Span<const int> $0ByName() { return k$0ByName; }
+
+)",
+          accessor, positions));
   return metadata_code;
 }
 
+std::string PopulateInfoSchemaColumnsMetadata(const DatabaseDialect& dialect) {
+  std::string prefix = "";
+  if (dialect == DatabaseDialect::POSTGRESQL) {
+    prefix = "PG";
+  }
+  constexpr absl::string_view kGSQLInfoSchemaColumnsMetadata =
+      "info_schema_columns_metadata.csv";
+  constexpr absl::string_view kPGInfoSchemaColumnsMetadata =
+      "pg_info_schema_columns_metadata.csv";
+  return PopulateMetadata(
+      GetMetadataFileByDialect(dialect, kGSQLInfoSchemaColumnsMetadata,
+                               kPGInfoSchemaColumnsMetadata),
+      "ColumnsMetaEntry", absl::StrCat(prefix, "ColumnsMetadata"),
+      {{"table_name"}, {"column_name"}, {"is_nullable"}, {"spanner_type"}},
+      /*index_by_name=*/true);
+}
+
 std::string PopulateInfoSchemaColumnsMetadataForIndex(
     const DatabaseDialect& dialect) {
   std::string prefix = "";
   if (dialect == DatabaseDialect::POSTGRESQL) {
     prefix = "PG";
   }
-  std::string metadata_for_index_code = absl::Substitute(
-      R"(inline const std::vector<IndexColumnsMetaEntry>& $0IndexColumnsMetadata() {
-  // clang-format off
-  static const zetasql_base::NoDestructor<std::vector<IndexColumnsMetaEntry>>
-      kColumnsMetadataForIndex({
-)",
-      prefix);
-
   constexpr absl::string_view kGSQLInfoSchemaColumnsMetadataForIndex =
       "info_schema_columns_metadata_for_index.csv";
   constexpr absl::string_view kPGInfoSchemaColumnsMetadataForIndex =
       "pg_info_schema_columns_metadata_for_index.csv";
-  std::string metadata_file =
+  return PopulateMetadata(
       GetMetadataFileByDialect(dialect, kGSQLInfoSchemaColumnsMetadataForIndex,
-                               kPGInfoSchemaColumnsMetadataForIndex);
-  CsvReaderBase::Options options;
-  options.set_field_separator(kCsvSeparator);
-  options.set_required_header({"table_name", "column_name", "is_nullable",
-                               "column_ordering", "spanner_type",
-                               "ordinal_position"});
-  CFileReader file_reader = CFileReader(metadata_file);
-  CsvReader csv_reader(&file_reader, options);
-  ZETASQL_VLOG(csv_reader.status().ok())
-      << "Error reading csv file:" << csv_reader.status();
-  absl::StrAppend(&metadata_for_index_code,
-                  "  // NOLINTBEGIN(whitespace/line_length)\n");
-
-  for (CsvRecord record; csv_reader.ReadRecord(record);) {
-    std::string table_name = absl::StrCat("\"", record["table_name"], "\"");
-    std::string column_name = absl::StrCat("\"", record["column_name"], "\"");
-    std::string is_nullable = absl::StrCat("\"", record["is_nullable"], "\"");
-    std::string column_ordering =
-        absl::StrCat("\"", record["column_ordering"], "\"");
-    std::string spanner_type = absl::StrCat("\"", record["spanner_type"], "\"");
-    std::string ordinal_position = record["ordinal_position"];
-
-    absl::StrAppend(&metadata_for_index_code, "    {", table_name, ", ",
-                    column_name, ", ", is_nullable, ", ", column_ordering, ", ",
-                    spanner_type, ", ", ordinal_position, "},\n");
-  }
-  absl::StrAppend(&metadata_for_index_code, R"(  });
-  // NOLINTEND(whitespace/line_length)
-  // clang-format on
-    return *kColumnsMetadataForIndex;
-}
-
-)");
-
-  ZETASQL_VLOG(csv_reader.Close()) << csv_reader.status();
-  return metadata_for_index_code;
+                               kPGInfoSchemaColumnsMetadataForIndex),
+      "IndexColumnsMetaEntry", absl::StrCat(prefix, "IndexColumnsMetadata"),
+      {{"table_name"},
+       {"column_name"},
+       {"is_nullable"},
+       {"column_ordering"},
+       {"spanner_type"},
+       {"ordinal_position", /*quoted=*/false}},
+      /*index_by_name=*/true);
 }
 
 std::string PopulateSpannerSysColumnsMetadata() {
-  std::string metadata_code =
+  return absl::StrCat(
       R"(struct SpannerSysColumnsMetaEntry {
   const char* table_name;
   const char* column_name;
@@ -176,85 +219,26 @@ std::string PopulateSpannerSysColumnsMetadata() {
   int primary_key_ordinal;
 };
 
-inline const std::vector<SpannerSysColumnsMetaEntry>&
-SpannerSysColumnsMetadata() {
-  // clang-format off
-  static const zetasql_base::NoDestructor<std::vector<SpannerSysColumnsMetaEntry>>
-      kSpannerSysColumnsMetadata({
-)";
-
-  // clang-format off
-  constexpr absl::string_view kSpannerSysColumnsMetadata =
-      "external/com_google_cloud_spanner_emulator/backend/query/spanner_sys_columns_metadata.csv"; // NOLINT
-  // clang-format on
-  CsvReaderBase::Options options;
-  options.set_field_separator(kCsvSeparator);
-  options.set_required_header({"table_name", "column_name", "is_nullable",
-                               "spanner_type", "ordinal_position"});
-  CFileReader file_reader = CFileReader(kSpannerSysColumnsMetadata);
-  CsvReader csv_reader(&file_reader, options);
-  ZETASQL_VLOG(csv_reader.status().ok())
-      << "Error reading csv file:" << csv_reader.status();
-  absl::StrAppend(&metadata_code, "  // NOLINTBEGIN(whitespace/line_length)\n");
-  for (CsvRecord record; csv_reader.ReadRecord(record);) {
-    std::string table_name = absl::StrCat("\"", record["table_name"], "\"");
-    std::string column_name = absl::StrCat("\"", record["column_name"], "\"");
-    std::string is_nullable = absl::StrCat("\"", record["is_nullable"], "\"");
-    std::string spanner_type = absl::StrCat("\"", record["spanner_type"], "\"");
-    std::string ordinal_position = record["ordinal_position"];
-    absl::StrAppend(&metadata_code, "    {", table_name, ", ", column_name,
-                    ", ", is_nullable, ", ", spanner_type, ", ",
-                    ordinal_position, "},\n");
-  }
-  absl::StrAppend(&metadata_code, R"(  });
-  // NOLINTEND(whitespace/line_length)
-  // clang-format on
-    return *kSpannerSysColumnsMetadata;
-}
-
-)");
-  ZETASQL_VLOG(csv_reader.Close()) << csv_reader.status();
-  return metadata_code;
+)",
+      PopulateMetadata(
+          absl::StrCat(kInfoSchemaColumnsMetadataPath,
+                       "spanner_sys_columns_metadata.csv"),
+          "SpannerSysColumnsMetaEntry", "SpannerSysColumnsMetadata",
+          {{"table_name"},
+           {"column_name"},
+           {"is_nullable"},
+           {"spanner_type"},
+           {"ordinal_position", /*quoted=*/false}},
+          /*index_by_name=*/false));
 }
 
 std::string PopulatePGCatalogColumnsMetadata() {
-  std::string metadata_code =
-      R"(inline const std::vector<ColumnsMetaEntry>& PGCatalogColumnsMetadata() {
-  // clang-format off
-  static const zetasql_base::NoDestructor<std::vector<ColumnsMetaEntry>>
-      kPGCatalogColumnsMetadata({
-)";
-
-  // clang-format off
-  constexpr absl::string_view kPGCatalogColumnsMetadata =
-      "external/com_google_cloud_spanner_emulator/backend/query/pg_catalog_columns_metadata.csv"; // NOLINT
-  // clang-format on
-  CsvReaderBase::Options options;
-  options.set_field_separator(kCsvSeparator);
-  options.set_required_header(
-      {"table_name", "column_name", "is_nullable", "spanner_type"});
-  CFileReader file_reader = CFileReader(kPGCatalogColumnsMetadata);
-  CsvReader csv_reader(&file_reader, options);
-  ZETASQL_VLOG(csv_reader.status().ok())  // crash ok
-      << "Error reading csv file:" << csv_reader.status();
-  absl::StrAppend(&metadata_code, "  // NOLINTBEGIN(whitespace/line_length)\n");
-  for (CsvRecord record; csv_reader.ReadRecord(record);) {
-    std::string table_name = absl::StrCat("\"", record["table_name"], "\"");
-    std::string column_name = absl::StrCat("\"", record["column_name"], "\"");
-    std::string is_nullable = absl::StrCat("\"", record["is_nullable"], "\"");
-    std::string spanner_type = absl::StrCat("\"", record["spanner_type"], "\"");
-    absl::StrAppend(&metadata_code, "    {", table_name, ", ", column_name,
-                    ", ", is_nullable, ", ", spanner_type, "},\n");
-  }
-  absl::StrAppend(&metadata_code, R"(  });
-  // NOLINTEND(whitespace/line_length)
-  // clang-format on
-    return *kPGCatalogColumnsMetadata;
-}
-
-)");
-  ZETASQL_VLOG(csv_reader.Close()) << csv_reader.status();  // crash ok
-  return metadata_code;
+  return PopulateMetadata(
+      absl::StrCat(kInfoSchemaColumnsMetadataPath,
+                   "pg_catalog_columns_metadata.csv"),
+      "ColumnsMetaEntry", "PGCatalogColumnsMetadata",
+      {{"table_name"}, {"column_name"}, {"is_nullable"}, {"spanner_type"}},
+      /*index_by_name=*/false);
 }
 
 int main(int argc, char* argv[]) {
@@ -264,10 +248,7 @@ int main(int argc, char* argv[]) {
       R"(#ifndef $0
 #define $0
 
-#include <string>
-#include <vector>
-
-#include "zetasql/base/no_destructor.h"
+#include "absl/types/span.h"
 
 // WARNING -  DO NOT EDIT
 // AUTOGENERATED FILE USING BUILD RULE:
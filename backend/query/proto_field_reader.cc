@@ -0,0 +1,213 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/query/proto_field_reader.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
+#include "common/errors.h"
+#include "zetasql/base/ret_check.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+using ::google::protobuf::FieldDescriptor;
+using ::google::protobuf::internal::WireFormatLite;
+
+zetasql::Value Int32Value(const zetasql::Type* type, int32_t value) {
+  return type->IsInt32() ? zetasql::Value::Int32(value)
+                         : zetasql::Value::Int64(value);
+}
+
+zetasql::Value Uint32Value(const zetasql::Type* type, uint32_t value) {
+  return type->IsUint32() ? zetasql::Value::Uint32(value)
+                          : zetasql::Value::Uint64(value);
+}
+
+}  // namespace
+
+bool CanReadProtoField(const FieldDescriptor* field,
+                       const zetasql::Type* type) {
+  if (field->is_repeated() || field->is_required() ||
+      field->containing_oneof() != nullptr) {
+    return false;
+  }
+  switch (field->type()) {
+    case FieldDescriptor::TYPE_INT32:
+    case FieldDescriptor::TYPE_SINT32:
+    case FieldDescriptor::TYPE_SFIXED32:
+      return type->IsInt32() || type->IsInt64();
+    case FieldDescriptor::TYPE_INT64:
+    case FieldDescriptor::TYPE_SINT64:
+    case FieldDescriptor::TYPE_SFIXED64:
+      return type->IsInt64();
+    case FieldDescriptor::TYPE_UINT32:
+    case FieldDescriptor::TYPE_FIXED32:
+      return type->IsUint32() || type->IsUint64();
+    case FieldDescriptor::TYPE_UINT64:
+    case FieldDescriptor::TYPE_FIXED64:
+      return type->IsUint64();
+    case FieldDescriptor::TYPE_BOOL:
+      return type->IsBool();
+    case FieldDescriptor::TYPE_DOUBLE:
+      return type->IsDouble();
+    case FieldDescriptor::TYPE_FLOAT:
+      return type->IsFloat() || type->IsDouble();
+    case FieldDescriptor::TYPE_STRING:
+      return type->IsString();
+    case FieldDescriptor::TYPE_BYTES:
+      return type->IsBytes();
+    case FieldDescriptor::TYPE_MESSAGE:
+      return type->IsProto() && type->AsProto()->descriptor()->full_name() ==
+                                    field->message_type()->full_name();
+    default:
+      return false;
+  }
+}
+
+absl::StatusOr<std::optional<zetasql::Value>> ReadProtoField(
+    const absl::Cord& message, const FieldDescriptor* field,
+    const zetasql::Type* type) {
+  ZETASQL_RET_CHECK(CanReadProtoField(field, type));
+  std::string flattened;
+  absl::string_view bytes;
+  if (auto flat = message.TryFlat(); flat.has_value()) {
+    bytes = *flat;
+  } else {
+    flattened = std::string(message);
+    bytes = flattened;
+  }
+  google::protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8_t*>(bytes.data()),
+      static_cast<int>(bytes.size()));
+  const auto wire_type = WireFormatLite::WireTypeForFieldType(
+      static_cast<WireFormatLite::FieldType>(field->type()));
+  auto malformed = [field] {
+    return error::MalformedProtoValue(field->containing_type()->full_name());
+  };
+
+  // Occurrences with another wire type are unknown fields to the parser, so
+  // they are skipped like the other fields.
+  bool found = false;
+  uint64_t scalar = 0;
+  std::string payload;
+  std::string occurrence;
+  while (true) {
+    const uint32_t tag = input.ReadTag();
+    if (tag == 0) {
+      if (!input.ExpectAtEnd()) return malformed();
+      break;
+    }
+    if (WireFormatLite::GetTagFieldNumber(tag) != field->number() ||
+        WireFormatLite::GetTagWireType(tag) != wire_type) {
+      if (!WireFormatLite::SkipField(&input, tag)) return malformed();
+      continue;
+    }
+    found = true;
+    switch (wire_type) {
+      case WireFormatLite::WIRETYPE_VARINT:
+        if (!input.ReadVarint64(&scalar)) return malformed();
+        break;
+      case WireFormatLite::WIRETYPE_FIXED32: {
+        uint32_t value;
+        if (!input.ReadLittleEndian32(&value)) return malformed();
+        scalar = value;
+        break;
+      }
+      case WireFormatLite::WIRETYPE_FIXED64:
+        if (!input.ReadLittleEndian64(&scalar)) return malformed();
+        break;
+      case WireFormatLite::WIRETYPE_LENGTH_DELIMITED: {
+        uint32_t length;
+        if (!input.ReadVarint32(&length) ||
+            !input.ReadString(&occurrence, static_cast<int>(length))) {
+          return malformed();
+        }
+        // Concatenated serialized messages parse as their merge.
+        if (field->type() == FieldDescriptor::TYPE_MESSAGE) {
+          payload.append(occurrence);
+        } else {
+          payload.swap(occurrence);
+        }
+        break;
+      }
+      default:
+        ZETASQL_RET_CHECK_FAIL() << "Unexpected wire type " << wire_type;
+    }
+  }
+  if (!found) return std::nullopt;
+
+  switch (field->type()) {
+    case FieldDescriptor::TYPE_INT32:
+      return Int32Value(type, static_cast<int32_t>(scalar));
+    case FieldDescriptor::TYPE_SINT32:
+      return Int32Value(type, WireFormatLite::ZigZagDecode32(
+                                  static_cast<uint32_t>(scalar)));
+    case FieldDescriptor::TYPE_SFIXED32:
+      return Int32Value(type,
+                        static_cast<int32_t>(static_cast<uint32_t>(scalar)));
+    case FieldDescriptor::TYPE_INT64:
+    case FieldDescriptor::TYPE_SFIXED64:
+      return zetasql::Value::Int64(static_cast<int64_t>(scalar));
+    case FieldDescriptor::TYPE_SINT64:
+      return zetasql::Value::Int64(WireFormatLite::ZigZagDecode64(scalar));
+    case FieldDescriptor::TYPE_UINT32:
+    case FieldDescriptor::TYPE_FIXED32:
+      return Uint32Value(type, static_cast<uint32_t>(scalar));
+    case FieldDescriptor::TYPE_UINT64:
+    case FieldDescriptor::TYPE_FIXED64:
+      return zetasql::Value::Uint64(scalar);
+    case FieldDescriptor::TYPE_BOOL:
+      return zetasql::Value::Bool(scalar != 0);
+    case FieldDescriptor::TYPE_DOUBLE:
+      return zetasql::Value::Double(WireFormatLite::DecodeDouble(scalar));
+    case FieldDescriptor::TYPE_FLOAT: {
+      const float value =
+          WireFormatLite::DecodeFloat(static_cast<uint32_t>(scalar));
+      return type->IsFloat() ? zetasql::Value::Float(value)
+                             : zetasql::Value::Double(value);
+    }
+    case FieldDescriptor::TYPE_STRING:
+      return zetasql::Value::String(payload);
+    case FieldDescriptor::TYPE_BYTES:
+      return zetasql::Value::Bytes(payload);
+    case FieldDescriptor::TYPE_MESSAGE:
+      return zetasql::Value::Proto(type->AsProto(), absl::Cord(payload));
+    default:
+      ZETASQL_RET_CHECK_FAIL() << "Unsupported field type "
+                       << field->type_name();
+  }
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,59 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_PROTO_FIELD_READER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_PROTO_FIELD_READER_H_
+
+#include <optional>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "google/protobuf/descriptor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Reads single fields of serialized proto messages for native evaluation of
+// queries. The other fields of the message are skipped on the wire without
+// being decoded, and no message object is built.
+
+// Returns true if ReadProtoField() can read `field` as a value of `type`: the
+// field is optional and not in a oneof, and `type` is the type ZetaSQL gives
+// to fields of its kind without a format annotation. Enum and group fields are
+// not supported.
+bool CanReadProtoField(const google::protobuf::FieldDescriptor* field,
+                       const zetasql::Type* type);
+
+// Returns the value of `field` in `message`, a serialized message of the type
+// containing `field`, as a value of `type`, or std::nullopt if the message
+// does not have the field. As in a parsed message, the last occurrence of a
+// scalar field wins and the occurrences of a message field are merged.
+// Requires CanReadProtoField(field, type).
+absl::StatusOr<std::optional<zetasql::Value>> ReadProtoField(
+    const absl::Cord& message, const google::protobuf::FieldDescriptor* field,
+    const zetasql::Type* type);
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_PROTO_FIELD_READER_H_
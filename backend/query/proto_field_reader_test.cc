@@ -0,0 +1,158 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/query/proto_field_reader.h"
+
+#include <optional>
+#include <string>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/wrappers.pb.h"
+#include "tests/common/test.pb.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using ::emulator::tests::common::Parent;
+using ::emulator::tests::common::Simple;
+using ::zetasql_base::testing::IsOkAndHolds;
+using ::zetasql_base::testing::StatusIs;
+
+const google::protobuf::FieldDescriptor* FieldOf(
+    const google::protobuf::Descriptor* descriptor, absl::string_view name) {
+  return descriptor->FindFieldByName(std::string(name));
+}
+
+TEST(ProtoFieldReaderTest, ReadsStringFields) {
+  const auto* field = FieldOf(Simple::descriptor(), "field");
+  Simple simple;
+  simple.set_field("value");
+  simple.add_int64_arr(7);
+  EXPECT_THAT(ReadProtoField(absl::Cord(simple.SerializeAsString()), field,
+                             zetasql::types::StringType()),
+              IsOkAndHolds(zetasql::Value::String("value")));
+
+  simple.clear_field();
+  EXPECT_THAT(ReadProtoField(absl::Cord(simple.SerializeAsString()), field,
+                             zetasql::types::StringType()),
+              IsOkAndHolds(std::nullopt));
+}
+
+TEST(ProtoFieldReaderTest, LastOccurrenceOfScalarFieldWins) {
+  Simple first;
+  first.set_field("first");
+  Simple last;
+  last.set_field("last");
+  EXPECT_THAT(ReadProtoField(absl::Cord(first.SerializeAsString() +
+                                        last.SerializeAsString()),
+                             FieldOf(Simple::descriptor(), "field"),
+                             zetasql::types::StringType()),
+              IsOkAndHolds(zetasql::Value::String("last")));
+}
+
+TEST(ProtoFieldReaderTest, MergesOccurrencesOfMessageField) {
+  zetasql::TypeFactory type_factory;
+  const zetasql::ProtoType* type;
+  ZETASQL_ASSERT_OK(type_factory.MakeProtoType(Simple::descriptor(), &type));
+  Parent first;
+  first.mutable_child()->set_field("child");
+  Parent last;
+  last.mutable_child()->add_int64_arr(3);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::optional<zetasql::Value> child,
+      ReadProtoField(
+          absl::Cord(first.SerializeAsString() + last.SerializeAsString()),
+          FieldOf(Parent::descriptor(), "child"), type));
+  ASSERT_TRUE(child.has_value());
+  Simple simple;
+  ASSERT_TRUE(simple.ParseFromString(std::string(child->ToCord())));
+  EXPECT_EQ(simple.field(), "child");
+  EXPECT_THAT(simple.int64_arr(), testing::ElementsAre(3));
+}
+
+TEST(ProtoFieldReaderTest, ReadsNumericFields) {
+  google::protobuf::Int32Value int32_value;
+  int32_value.set_value(-5);
+  EXPECT_THAT(
+      ReadProtoField(absl::Cord(int32_value.SerializeAsString()),
+                     FieldOf(google::protobuf::Int32Value::descriptor(),
+                             "value"),
+                     zetasql::types::Int64Type()),
+      IsOkAndHolds(zetasql::Value::Int64(-5)));
+
+  google::protobuf::UInt64Value uint64_value;
+  uint64_value.set_value(uint64_t{1} << 63);
+  EXPECT_THAT(
+      ReadProtoField(absl::Cord(uint64_value.SerializeAsString()),
+                     FieldOf(google::protobuf::UInt64Value::descriptor(),
+                             "value"),
+                     zetasql::types::Uint64Type()),
+      IsOkAndHolds(zetasql::Value::Uint64(uint64_t{1} << 63)));
+
+  google::protobuf::DoubleValue double_value;
+  double_value.set_value(2.5);
+  EXPECT_THAT(
+      ReadProtoField(absl::Cord(double_value.SerializeAsString()),
+                     FieldOf(google::protobuf::DoubleValue::descriptor(),
+                             "value"),
+                     zetasql::types::DoubleType()),
+      IsOkAndHolds(zetasql::Value::Double(2.5)));
+
+  google::protobuf::BoolValue bool_value;
+  bool_value.set_value(true);
+  EXPECT_THAT(
+      ReadProtoField(absl::Cord(bool_value.SerializeAsString()),
+                     FieldOf(google::protobuf::BoolValue::descriptor(),
+                             "value"),
+                     zetasql::types::BoolType()),
+      IsOkAndHolds(zetasql::Value::Bool(true)));
+}
+
+TEST(ProtoFieldReaderTest, RejectsUnsupportedFields) {
+  EXPECT_TRUE(CanReadProtoField(FieldOf(Simple::descriptor(), "field"),
+                                zetasql::types::StringType()));
+  EXPECT_FALSE(CanReadProtoField(FieldOf(Simple::descriptor(), "field"),
+                                 zetasql::types::BytesType()));
+  EXPECT_FALSE(CanReadProtoField(FieldOf(Simple::descriptor(), "int64_arr"),
+                                 zetasql::types::Int64ArrayType()));
+}
+
+TEST(ProtoFieldReaderTest, FailsOnMalformedMessages) {
+  // A length-delimited field 1 whose length exceeds the message.
+  EXPECT_THAT(ReadProtoField(absl::Cord("\x0a\x05" "ab"),
+                             FieldOf(Simple::descriptor(), "field"),
+                             zetasql::types::StringType()),
+              StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -17,6 +17,9 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_CONTEXT_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_CONTEXT_H_
 
+#include <optional>
+
+#include "absl/time/time.h"
 #include "backend/access/read.h"
 #include "backend/access/write.h"
 #include "backend/schema/catalog/schema.h"
@@ -45,6 +48,12 @@ struct QueryContext {
   // transactions. E.g. when analyzing a column expression, in partitioned DML,
   // or read-write transactions.
   bool allow_read_write_only_functions = false;
+
+  // If set, `reader` reads a snapshot of the database at this timestamp which
+  // can no longer change, so the results of deterministic queries can be
+  // reused by other queries reading at the same timestamp (see
+  // QueryResultCache).
+  std::optional<absl::Time> immutable_snapshot_timestamp;
 };
 
 }  // namespace backend
@@ -18,10 +18,13 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
+#include <random>
 #include <set>
 #include <string>
 #include <tuple>
@@ -35,6 +38,7 @@
 #include "zetasql/public/catalog.h"
 #include "zetasql/public/evaluator.h"
 #include "zetasql/public/evaluator_table_iterator.h"
+#include "zetasql/public/function.h"
 #include "zetasql/public/language_options.h"
 #include "zetasql/public/options.pb.h"
 #include "zetasql/public/parse_helpers.h"
@@ -46,6 +50,7 @@
 #include "zetasql/resolved_ast/resolved_node_kind.pb.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -56,30 +61,39 @@
 #include "backend/access/write.h"
 #include "backend/common/case.h"
 #include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/datamodel/key_set.h"
 #include "backend/datamodel/value.h"
+#include "backend/query/analyzed_query_cache.h"
 #include "backend/query/analyzer_options.h"
 #include "backend/query/catalog.h"
 #include "backend/query/change_stream/change_stream_query_validator.h"
+#include "backend/query/dml_access_path.h"
 #include "backend/query/dml_query_validator.h"
 #include "backend/query/feature_filter/query_size_limits_checker.h"
 #include "backend/query/function_catalog.h"
 #include "backend/query/hint_rewriter.h"
 #include "backend/query/index_hint_validator.h"
+#include "backend/query/native_query_plan.h"
 #include "backend/query/partitionability_validator.h"
 #include "backend/query/partitioned_dml_validator.h"
 #include "backend/query/query_context.h"
 #include "backend/query/query_engine_options.h"
+#include "backend/query/query_result_cache.h"
 #include "backend/query/query_validator.h"
 #include "backend/query/queryable_column.h"
 #include "backend/query/queryable_table.h"
 #include "backend/query/queryable_view.h"
+#include "backend/query/spanner_sys_catalog.h"
 #include "backend/schema/catalog/schema.h"
 #include "backend/transaction/commit_timestamp.h"
 #include "common/config.h"
+#include "common/metrics.h"
 #include "common/constants.h"
 #include "common/errors.h"
 #include "common/feature_flags.h"
 #include "common/limits.h"
+#include "common/tracing.h"
 #include "frontend/converters/values.h"
 #include "third_party/spanner_pg/interface/emulator_parser.h"
 #include "third_party/spanner_pg/interface/pg_arena.h"
@@ -94,6 +108,9 @@ namespace emulator {
 namespace backend {
 namespace {
 
+// Rows read or produced by a query between two checks for its cancellation.
+constexpr int64_t kCancellationCheckInterval = 1024;
+
 // A RowCursor backed by vectors (one per each row) of values.
 class VectorsRowCursor : public RowCursor {
  public:
@@ -143,12 +160,43 @@ zetasql::EvaluatorOptions CommonEvaluatorOptions(
   absl::LoadTimeZone(kDefaultTimeZone, &time_zone);
   options.default_time_zone = time_zone;
   options.scramble_undefined_orderings = true;
+  // The evaluator bounds the rows it materializes for each operator, e.g. to
+  // sort, join or aggregate them, which is capped by the memory limit of
+  // queries.
+  if (const int64_t limit = config::query_memory_limit_bytes(); limit > 0) {
+    options.max_intermediate_byte_size =
+        std::min(options.max_intermediate_byte_size, limit);
+  }
   return options;
 }
 
+// Latency of analyzing queries, including the translation of PostgreSQL
+// queries, and excluding analyses reused from the analyzed query cache.
+metrics::Histogram* AnalyzeLatency() {
+  static metrics::Histogram* histogram =
+      metrics::MetricRegistry::Global()->GetHistogram(
+          "emulator_query_analyze_seconds",
+          "Latency of analyzing SQL statements, in seconds.",
+          metrics::LatencyBuckets());
+  return histogram;
+}
+
+// Latency of executing analyzed queries and DML statements.
+metrics::Histogram* ExecuteLatency() {
+  static metrics::Histogram* histogram =
+      metrics::MetricRegistry::Global()->GetHistogram(
+          "emulator_query_execute_seconds",
+          "Latency of executing analyzed SQL statements, in seconds.",
+          metrics::LatencyBuckets());
+  return histogram;
+}
+
 absl::StatusOr<zetasql::AnalyzerOptions> MakeAnalyzerOptionsWithParameters(
     const zetasql::ParameterValueMap& params) {
   zetasql::AnalyzerOptions options = MakeGoogleSqlAnalyzerOptions();
+  // References to views are replaced by their analyzed bodies, so that the
+  // predicates of statements on views apply to the scans of the base tables.
+  options.enable_rewrite(zetasql::REWRITE_INLINE_SQL_VIEWS);
   for (const auto& [name, value] : params) {
     ZETASQL_RETURN_IF_ERROR(options.AddQueryParameter(name, value.type()));
   }
@@ -236,28 +284,52 @@ struct ExecuteUpdateResult {
   std::unique_ptr<RowCursor> returning_row_cursor;
 };
 
-absl::StatusOr<std::unique_ptr<RowCursor>> BuildReturningRowResult(
-    std::unique_ptr<zetasql::EvaluatorTableIterator> iterator) {
-  if (iterator == nullptr) {
-    return nullptr;
+// A RowCursor over the rows returned by the THEN RETURN clause of a DML
+// statement. The rows are read from the evaluator as the cursor is consumed,
+// so that they are not copied before being streamed back.
+class ReturningRowCursor : public RowCursor {
+ public:
+  ReturningRowCursor(std::unique_ptr<zetasql::PreparedModify> prepared,
+                     std::unique_ptr<zetasql::EvaluatorTableIterator> iterator)
+      : prepared_(std::move(prepared)), iterator_(std::move(iterator)) {}
+
+  bool Next() override { return iterator_->NextRow(); }
+
+  absl::Status Status() const override { return iterator_->Status(); }
+
+  int NumColumns() const override { return iterator_->NumColumns(); }
+
+  const std::string ColumnName(int i) const override {
+    return iterator_->GetColumnName(i);
   }
-  std::vector<std::vector<zetasql::Value>> values;
-  while (iterator->NextRow()) {
-    values.emplace_back();
-    values.back().reserve(iterator->NumColumns());
-    for (int i = 0; i < iterator->NumColumns(); ++i) {
-      values.back().push_back(iterator->GetValue(i));
-    }
+
+  const zetasql::Type* ColumnType(int i) const override {
+    return iterator_->GetColumnType(i);
   }
-  ZETASQL_RETURN_IF_ERROR(iterator->Status());
 
-  std::vector<std::string> names;
-  std::vector<const zetasql::Type*> types;
-  for (int i = 0; i < iterator->NumColumns(); ++i) {
-    names.push_back(iterator->GetColumnName(i));
-    types.push_back(iterator->GetColumnType(i));
+  const zetasql::Value ColumnValue(int i) const override {
+    return iterator_->GetValue(i);
   }
-  return std::make_unique<VectorsRowCursor>(names, types, values);
+
+ private:
+  // The statement which returned the iterator, kept alive for as long as the
+  // iterator.
+  const std::unique_ptr<zetasql::PreparedModify> prepared_;
+  const std::unique_ptr<zetasql::EvaluatorTableIterator> iterator_;
+};
+
+// Returns a cursor over the rows of `iterator`, which `*prepared` returned for
+// the THEN RETURN clause of its statement, or nullptr if there is no such
+// iterator. The cursor takes ownership of `*prepared`, so that the statement
+// outlives the iterator.
+std::unique_ptr<RowCursor> BuildReturningRowResult(
+    std::unique_ptr<zetasql::PreparedModify>* prepared,
+    std::unique_ptr<zetasql::EvaluatorTableIterator> iterator) {
+  if (iterator == nullptr) {
+    return nullptr;
+  }
+  return std::make_unique<ReturningRowCursor>(std::move(*prepared),
+                                              std::move(iterator));
 }
 
 // Builds a INSERT mutation and returns it along with a count of inserted rows
@@ -560,8 +632,8 @@ absl::StatusOr<ExecuteUpdateResult> EvaluateResolvedInsert(
     return MaybeTransformZetaSQLDMLError(status_or.status());
   }
   auto iterator = std::move(status_or).value();
-  ZETASQL_ASSIGN_OR_RETURN(auto cursor,
-                   BuildReturningRowResult(std::move(returning_iter)));
+  std::unique_ptr<RowCursor> cursor =
+      BuildReturningRowResult(&prepared_insert, std::move(returning_iter));
 
   ZETASQL_ASSIGN_OR_RETURN(const auto& mutation_and_count,
                    BuildInsert(std::move(iterator), op_type, pending_ts_columns,
@@ -606,8 +678,8 @@ absl::StatusOr<ExecuteUpdateResult> EvaluateResolvedUpdate(
     return MaybeTransformZetaSQLDMLError(status_or.status());
   }
   auto iterator = std::move(status_or).value();
-  ZETASQL_ASSIGN_OR_RETURN(auto cursor,
-                   BuildReturningRowResult(std::move(returning_iter)));
+  std::unique_ptr<RowCursor> cursor =
+      BuildReturningRowResult(&prepared_update, std::move(returning_iter));
   const auto& mutation_and_count =
       BuildUpdate(std::move(iterator), MutationOpType::kUpdate,
                   pending_ts_columns, updated_columns, schema);
@@ -628,8 +700,8 @@ absl::StatusOr<ExecuteUpdateResult> EvaluateResolvedDelete(
   std::unique_ptr<zetasql::EvaluatorTableIterator> returning_iter;
   ZETASQL_ASSIGN_OR_RETURN(auto iterator,
                    prepared_delete->Execute(parameters, {}, &returning_iter));
-  ZETASQL_ASSIGN_OR_RETURN(auto cursor,
-                   BuildReturningRowResult(std::move(returning_iter)));
+  std::unique_ptr<RowCursor> cursor =
+      BuildReturningRowResult(&prepared_delete, std::move(returning_iter));
 
   const auto& mutation_and_count = BuildDelete(std::move(iterator));
   return ExecuteUpdateResult{mutation_and_count.first,
@@ -673,13 +745,32 @@ absl::StatusOr<std::unique_ptr<RowCursor>> ResolveCallStatement() {
   return std::make_unique<VectorsRowCursor>(names, types, values);
 }
 
+// Returns the seed with which the rows of `query` are scrambled when it does
+// not order them. Executions of the same query with the same parameters at the
+// same snapshot produce the same rows in the same order, so a streaming read
+// resumed by re-executing the query picks up where it left off.
+uint64_t ScrambleSeed(const Query& query,
+                      const zetasql::ParameterValueMap& params,
+                      const QueryContext& context) {
+  uint64_t seed = absl::HashOf(query.sql);
+  for (const auto& [name, value] : params) {
+    seed = absl::HashOf(seed, name, value.HashCode());
+  }
+  if (context.immutable_snapshot_timestamp.has_value()) {
+    seed = absl::HashOf(seed, *context.immutable_snapshot_timestamp);
+  }
+  return seed;
+}
+
 // Uses googlesql/public/evaluator to evaluate a query statement represented by
 // a resolved AST and returns a row cursor.
 absl::StatusOr<std::unique_ptr<RowCursor>> EvaluateQuery(
     const zetasql::ResolvedStatement* resolved_statement,
     const zetasql::ParameterValueMap& params,
     zetasql::TypeFactory* type_factory, int64_t* num_output_rows,
-    const v1::ExecuteSqlRequest_QueryMode query_mode) {
+    const v1::ExecuteSqlRequest_QueryMode query_mode,
+    const std::function<absl::Status()>& check_cancelled,
+    QueryMemoryBudget* memory_budget, uint64_t scramble_seed) {
   if (resolved_statement->node_kind() == zetasql::RESOLVED_CALL_STMT) {
     // Evaluation of a CALL statement is currently a no-op. This is added to
     // ensure the emulator doesn't error out when the customer tries the CALL
@@ -689,9 +780,35 @@ absl::StatusOr<std::unique_ptr<RowCursor>> EvaluateQuery(
   ZETASQL_RET_CHECK_EQ(resolved_statement->node_kind(), zetasql::RESOLVED_QUERY_STMT)
       << "input is not a query statement";
 
+  // Evaluate the query with the emulator's own operators if it has one of the
+  // shapes they support, falling back to the reference evaluator otherwise.
+  const auto* query_stmt =
+      resolved_statement->GetAs<zetasql::ResolvedQueryStmt>();
+  if (query_mode != v1::ExecuteSqlRequest::PLAN &&
+      config::native_query_operators_enabled()) {
+    if (auto plan = NativeQueryPlan::Create(query_stmt, params, memory_budget);
+        plan != nullptr) {
+      std::vector<std::string> names;
+      std::vector<const zetasql::Type*> types;
+      for (const auto& output_column : query_stmt->output_column_list()) {
+        names.push_back(output_column->name());
+        types.push_back(output_column->column().type());
+      }
+      ZETASQL_ASSIGN_OR_RETURN(auto values, plan->Execute());
+      // Like the reference evaluator with scramble_undefined_orderings, do
+      // not let applications depend on the order of rows produced by hash
+      // joins and aggregations when the query does not define one.
+      if (!query_stmt->query()->is_ordered()) {
+        std::shuffle(values.begin(), values.end(),
+                     std::mt19937_64(scramble_seed));
+      }
+      *num_output_rows = values.size();
+      return std::make_unique<VectorsRowCursor>(names, types, values);
+    }
+  }
+
   auto prepared_query = std::make_unique<zetasql::PreparedQuery>(
-      resolved_statement->GetAs<zetasql::ResolvedQueryStmt>(),
-      CommonEvaluatorOptions(type_factory));
+      query_stmt, CommonEvaluatorOptions(type_factory));
   // Call PrepareQuery to set the AnalyzerOptions that we used to Analyze the
   // statement.
   ZETASQL_ASSIGN_OR_RETURN(auto analyzer_options,
@@ -719,11 +836,17 @@ absl::StatusOr<std::unique_ptr<RowCursor>> EvaluateQuery(
     ZETASQL_ASSIGN_OR_RETURN(auto iterator, prepared_query->Execute(params));
 
     while (iterator->NextRow()) {
+      // Queries which compute many rows without reading any, e.g. from
+      // generated arrays, are also checked for cancellation.
+      if (check_cancelled && values.size() % kCancellationCheckInterval == 0) {
+        ZETASQL_RETURN_IF_ERROR(check_cancelled());
+      }
       values.emplace_back();
       values.back().reserve(iterator->NumColumns());
       for (int i = 0; i < iterator->NumColumns(); ++i) {
         values.back().push_back(iterator->GetValue(i));
       }
+      ZETASQL_RETURN_IF_ERROR(memory_budget->ConsumeRow(values.back()));
     }
     ZETASQL_RETURN_IF_ERROR(iterator->Status());
     *num_output_rows = values.size();
@@ -837,6 +960,136 @@ ExtractValidatedResolvedStatementAndOptions(
   return statement;
 }
 
+// Returns the validated statement of `analyzer_output` in `context`. The
+// statement cached in `*validated` is reused if it was validated in a context
+// at least as restrictive as `context`, re-checking only the reads of pending
+// commit timestamps, which depend on the writes of the transaction. Otherwise
+// the statement is validated again and replaces the cached one.
+absl::StatusOr<const ValidatedStatement*> GetValidatedStatement(
+    const zetasql::AnalyzerOutput* analyzer_output,
+    const QueryContext& context,
+    std::unique_ptr<const ValidatedStatement>* validated) {
+  if (*validated != nullptr &&
+      (context.allow_read_write_only_functions ||
+       !(*validated)->allow_read_write_only_functions)) {
+    if (context.commit_timestamp_tracker != nullptr) {
+      PendingCommitTimestampReadValidator validator(
+          context.commit_timestamp_tracker);
+      ZETASQL_RETURN_IF_ERROR((*validated)->statement->Accept(&validator));
+    }
+    return validated->get();
+  }
+  auto statement = std::make_unique<ValidatedStatement>();
+  ZETASQL_ASSIGN_OR_RETURN(statement->statement,
+                   ExtractValidatedResolvedStatementAndOptions(
+                       analyzer_output, context, &statement->options));
+  statement->allow_read_write_only_functions =
+      context.allow_read_write_only_functions;
+  *validated = std::move(statement);
+  return validated->get();
+}
+
+// Implements ResolvedASTVisitor to determine whether a query returns the same
+// rows whenever it is run against the same snapshot of the database. Queries
+// which call functions that are not immutable (such as CURRENT_TIMESTAMP or
+// RAND), sample tables, read SPANNER_SYS tables computed at scan time, or read
+// views or table valued functions, whose evaluation is not visible in the
+// resolved AST, are not.
+class DeterministicQueryVisitor : public zetasql::ResolvedASTVisitor {
+ public:
+  bool deterministic() const { return deterministic_; }
+
+ private:
+  absl::Status VisitResolvedFunctionCall(
+      const zetasql::ResolvedFunctionCall* node) override {
+    CheckFunction(node->function());
+    return DefaultVisit(node);
+  }
+  absl::Status VisitResolvedAggregateFunctionCall(
+      const zetasql::ResolvedAggregateFunctionCall* node) override {
+    CheckFunction(node->function());
+    return DefaultVisit(node);
+  }
+  absl::Status VisitResolvedAnalyticFunctionCall(
+      const zetasql::ResolvedAnalyticFunctionCall* node) override {
+    CheckFunction(node->function());
+    return DefaultVisit(node);
+  }
+  absl::Status VisitResolvedTableScan(
+      const zetasql::ResolvedTableScan* node) override {
+    if (dynamic_cast<const QueryableView*>(node->table()) != nullptr ||
+        SpannerSysCatalog::IsVolatileTable(node->table())) {
+      deterministic_ = false;
+    }
+    return DefaultVisit(node);
+  }
+  absl::Status VisitResolvedSampleScan(
+      const zetasql::ResolvedSampleScan* node) override {
+    deterministic_ = false;
+    return DefaultVisit(node);
+  }
+  absl::Status VisitResolvedTVFScan(
+      const zetasql::ResolvedTVFScan* node) override {
+    deterministic_ = false;
+    return DefaultVisit(node);
+  }
+
+  void CheckFunction(const zetasql::Function* function) {
+    if (function->function_options().volatility !=
+        zetasql::FunctionEnums::IMMUTABLE) {
+      deterministic_ = false;
+    }
+  }
+
+  bool deterministic_ = true;
+};
+
+// Returns true if the result of `statement` can be replayed to later
+// executions against the same immutable snapshot.
+bool IsReplayableQuery(const zetasql::ResolvedStatement* statement) {
+  if (statement->node_kind() != zetasql::RESOLVED_QUERY_STMT) {
+    return false;
+  }
+  DeterministicQueryVisitor visitor;
+  return statement->Accept(&visitor).ok() && visitor.deterministic();
+}
+
+// Replaces the rows of `result` with a cursor over a copy of them, and returns
+// the rows for caching.
+absl::StatusOr<std::shared_ptr<const CachedQueryResult>> MaterializeResult(
+    QueryResult* result) {
+  auto cached = std::make_shared<CachedQueryResult>();
+  RowCursor* cursor = result->rows.get();
+  for (int i = 0; i < cursor->NumColumns(); ++i) {
+    cached->column_names.push_back(cursor->ColumnName(i));
+    cached->column_types.push_back(cursor->ColumnType(i));
+  }
+  while (cursor->Next()) {
+    cached->rows.emplace_back();
+    cached->rows.back().reserve(cursor->NumColumns());
+    for (int i = 0; i < cursor->NumColumns(); ++i) {
+      cached->rows.back().push_back(cursor->ColumnValue(i));
+    }
+  }
+  ZETASQL_RETURN_IF_ERROR(cursor->Status());
+  cached->parameter_types = result->parameter_types;
+  result->rows = std::make_unique<VectorsRowCursor>(
+      cached->column_names, cached->column_types, cached->rows);
+  return cached;
+}
+
+// Returns a result which replays `cached`.
+QueryResult ReplayResult(const CachedQueryResult& cached,
+                         absl::Time start_time) {
+  QueryResult result;
+  result.rows = std::make_unique<VectorsRowCursor>(
+      cached.column_names, cached.column_types, cached.rows);
+  result.parameter_types = cached.parameter_types;
+  result.num_output_rows = cached.rows.size();
+  result.elapsed_time = absl::Now() - start_time;
+  return result;
+}
+
 // Implements ResolvedASTVisitor to get the target table that various DML
 // statements modify.
 class ExtractDmlTargetTableVisitor : public zetasql::ResolvedASTVisitor {
@@ -863,6 +1116,230 @@ class ExtractDmlTargetTableVisitor : public zetasql::ResolvedASTVisitor {
   std::optional<std::string> target_table_;
 };
 
+// A RowReader which restricts reads of one table to the rows with the given
+// keys. Used to read only the rows of a partitioned query's root table within
+// the partition, and only the rows of a DML statement's target table which
+// its WHERE clause may select.
+class KeySetRowReader : public RowReader {
+ public:
+  KeySetRowReader(RowReader* reader, std::string table_name, KeySet key_set)
+      : reader_(reader),
+        table_name_(std::move(table_name)),
+        key_set_(std::move(key_set)) {}
+
+  absl::Status Read(const ReadArg& read_arg,
+                    std::unique_ptr<RowCursor>* cursor) override {
+    if (read_arg.table != table_name_ || !read_arg.index.empty()) {
+      return reader_->Read(read_arg, cursor);
+    }
+    return reader_->Read(RestrictedReadArg(read_arg), cursor);
+  }
+
+  absl::Status ReadSplits(
+      const ReadArg& read_arg, int64_t rows_per_split,
+      std::vector<std::unique_ptr<RowCursor>>* cursors) override {
+    if (read_arg.table != table_name_ || !read_arg.index.empty()) {
+      return reader_->ReadSplits(read_arg, rows_per_split, cursors);
+    }
+    return reader_->ReadSplits(RestrictedReadArg(read_arg), rows_per_split,
+                               cursors);
+  }
+
+ private:
+  ReadArg RestrictedReadArg(const ReadArg& read_arg) const {
+    ReadArg restricted_read_arg = read_arg;
+    restricted_read_arg.key_set = IntersectKeySets(read_arg.key_set, key_set_);
+    return restricted_read_arg;
+  }
+
+  RowReader* reader_;
+  const std::string table_name_;
+  const KeySet key_set_;
+};
+
+// A RowCursor which accounts the rows and bytes it reads, and the time spent
+// reading them, to the statistics of a table scan.
+class ProfilingRowCursor : public RowCursor {
+ public:
+  ProfilingRowCursor(std::unique_ptr<RowCursor> cursor, TableScanStats* stats)
+      : cursor_(std::move(cursor)), stats_(stats) {}
+
+  bool Next() override {
+    absl::Time start = absl::Now();
+    bool has_row = cursor_->Next();
+    if (has_row) {
+      ++stats_->rows_scanned;
+      for (int i = 0; i < cursor_->NumColumns(); ++i) {
+        const zetasql::Value value = cursor_->ColumnValue(i);
+        if (value.is_valid()) {
+          stats_->bytes_read += value.physical_byte_size();
+        }
+      }
+    }
+    stats_->latency += absl::Now() - start;
+    return has_row;
+  }
+
+  absl::Status Status() const override { return cursor_->Status(); }
+  int NumColumns() const override { return cursor_->NumColumns(); }
+  const std::string ColumnName(int i) const override {
+    return cursor_->ColumnName(i);
+  }
+  const zetasql::Value ColumnValue(int i) const override {
+    return cursor_->ColumnValue(i);
+  }
+  const zetasql::Type* ColumnType(int i) const override {
+    return cursor_->ColumnType(i);
+  }
+
+ private:
+  std::unique_ptr<RowCursor> cursor_;
+  TableScanStats* stats_;
+};
+
+// A RowCursor which stops with the error returned by a cancellation check,
+// which it calls every kCancellationCheckInterval rows.
+class CancellableRowCursor : public RowCursor {
+ public:
+  CancellableRowCursor(std::unique_ptr<RowCursor> cursor,
+                       const std::function<absl::Status()>* check_cancelled)
+      : cursor_(std::move(cursor)), check_cancelled_(check_cancelled) {}
+
+  bool Next() override {
+    if (++rows_since_check_ >= kCancellationCheckInterval && !Check()) {
+      return false;
+    }
+    return status_.ok() && cursor_->Next();
+  }
+
+  bool NextBatch(int64_t max_rows,
+                 std::vector<std::vector<zetasql::Value>>* rows) override {
+    if (!Check()) {
+      return false;
+    }
+    return cursor_->NextBatch(max_rows, rows);
+  }
+
+  absl::Status Status() const override {
+    return status_.ok() ? cursor_->Status() : status_;
+  }
+  int NumColumns() const override { return cursor_->NumColumns(); }
+  const std::string ColumnName(int i) const override {
+    return cursor_->ColumnName(i);
+  }
+  const zetasql::Value ColumnValue(int i) const override {
+    return cursor_->ColumnValue(i);
+  }
+  const zetasql::Type* ColumnType(int i) const override {
+    return cursor_->ColumnType(i);
+  }
+
+ private:
+  // Returns false, and keeps the error, if the query was cancelled.
+  bool Check() {
+    rows_since_check_ = 0;
+    if (status_.ok()) {
+      status_ = (*check_cancelled_)();
+    }
+    return status_.ok();
+  }
+
+  std::unique_ptr<RowCursor> cursor_;
+  const std::function<absl::Status()>* check_cancelled_;
+  int64_t rows_since_check_ = 0;
+  absl::Status status_;
+};
+
+// A RowReader whose cursors stop once the query issuing the reads is
+// cancelled. Reads are checked when issued and as their rows are read.
+class CancellableRowReader : public RowReader {
+ public:
+  CancellableRowReader(RowReader* reader,
+                       const std::function<absl::Status()>* check_cancelled)
+      : reader_(reader), check_cancelled_(check_cancelled) {}
+
+  absl::Status Read(const ReadArg& read_arg,
+                    std::unique_ptr<RowCursor>* cursor) override {
+    ZETASQL_RETURN_IF_ERROR((*check_cancelled_)());
+    ZETASQL_RETURN_IF_ERROR(reader_->Read(read_arg, cursor));
+    *cursor = std::make_unique<CancellableRowCursor>(std::move(*cursor),
+                                                     check_cancelled_);
+    return absl::OkStatus();
+  }
+
+  absl::Status ReadSplits(
+      const ReadArg& read_arg, int64_t rows_per_split,
+      std::vector<std::unique_ptr<RowCursor>>* cursors) override {
+    ZETASQL_RETURN_IF_ERROR((*check_cancelled_)());
+    ZETASQL_RETURN_IF_ERROR(reader_->ReadSplits(read_arg, rows_per_split, cursors));
+    for (std::unique_ptr<RowCursor>& cursor : *cursors) {
+      cursor = std::make_unique<CancellableRowCursor>(std::move(cursor),
+                                                      check_cancelled_);
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  RowReader* reader_;
+  const std::function<absl::Status()>* check_cancelled_;
+};
+
+// A RowReader which collects the statistics of the reads issued by a query
+// executed in PROFILE mode. Reads are aggregated per table, index and whether
+// they scanned the whole table or index. Reads are not split, so that the
+// statistics are only updated from the thread executing the query.
+class ProfilingRowReader : public RowReader {
+ public:
+  explicit ProfilingRowReader(RowReader* reader) : reader_(reader) {}
+
+  absl::Status Read(const ReadArg& read_arg,
+                    std::unique_ptr<RowCursor>* cursor) override {
+    TableScanStats* stats = FindOrAddStats(read_arg);
+    ++stats->num_executions;
+    absl::Time start = absl::Now();
+    absl::Status status = reader_->Read(read_arg, cursor);
+    stats->latency += absl::Now() - start;
+    ZETASQL_RETURN_IF_ERROR(status);
+    *cursor = std::make_unique<ProfilingRowCursor>(std::move(*cursor), stats);
+    return absl::OkStatus();
+  }
+
+  // Returns the statistics of the reads issued so far, in the order in which
+  // their targets were first read.
+  std::vector<TableScanStats> table_scans() const {
+    std::vector<TableScanStats> table_scans;
+    table_scans.reserve(table_scans_.size());
+    for (const auto& stats : table_scans_) {
+      table_scans.push_back(*stats);
+    }
+    return table_scans;
+  }
+
+ private:
+  TableScanStats* FindOrAddStats(const ReadArg& read_arg) {
+    const KeySet& key_set = read_arg.key_set;
+    bool full_scan = key_set.keys().empty() && key_set.ranges().size() == 1 &&
+                     key_set.ranges()[0] == KeyRange::All();
+    for (const auto& stats : table_scans_) {
+      if (stats->table == read_arg.table && stats->index == read_arg.index &&
+          stats->full_scan == full_scan) {
+        return stats.get();
+      }
+    }
+    auto stats = std::make_unique<TableScanStats>();
+    stats->table = read_arg.table;
+    stats->index = read_arg.index;
+    stats->full_scan = full_scan;
+    table_scans_.push_back(std::move(stats));
+    return table_scans_.back().get();
+  }
+
+  RowReader* reader_;
+
+  // Owned so that the statistics outlive the cursors that update them.
+  std::vector<std::unique_ptr<TableScanStats>> table_scans_;
+};
+
 // A QueryEvaluator instance against a specific QueryEngine and QueryContext.
 class QueryEvaluatorForEngine : public QueryEvaluator {
  public:
@@ -890,13 +1367,22 @@ class QueryEvaluatorForEngine : public QueryEvaluator {
 
 absl::StatusOr<std::string> QueryEngine::GetDmlTargetTable(
     const Query& query, const Schema* schema) const {
+  std::unique_ptr<ReusableCatalog> catalog =
+      TakeCatalog(schema, /*change_stream_internal_lookup=*/std::nullopt);
+  absl::StatusOr<std::string> target_table =
+      AnalyzeDmlTargetTable(query, schema, catalog->catalog.get());
+  catalog_pool_.Return(std::move(catalog));
+  return target_table;
+}
+
+absl::StatusOr<std::string> QueryEngine::AnalyzeDmlTargetTable(
+    const Query& query, const Schema* schema, Catalog* catalog) const {
   ZETASQL_ASSIGN_OR_RETURN(auto analyzer_options,
                    MakeAnalyzerOptionsWithParameters(query.declared_params));
   analyzer_options.set_prune_unused_columns(true);
-  Catalog catalog(schema, &function_catalog_, type_factory_, analyzer_options);
   ZETASQL_ASSIGN_OR_RETURN(
       auto analyzer_output,
-      Analyze(query.sql, &catalog, analyzer_options, type_factory_));
+      Analyze(query.sql, catalog, analyzer_options, type_factory_));
   ZETASQL_ASSIGN_OR_RETURN(auto params,
                    ExtractParameters(query, analyzer_output.get()));
   ZETASQL_ASSIGN_OR_RETURN(auto statement,
@@ -917,43 +1403,259 @@ absl::StatusOr<QueryResult> QueryEngine::ExecuteSql(
   return ExecuteSql(query, context, v1::ExecuteSqlRequest::NORMAL);
 }
 
-absl::StatusOr<QueryResult> QueryEngine::ExecuteSql(
-    const Query& query, const QueryContext& context,
-    v1::ExecuteSqlRequest_QueryMode query_mode) const {
-  absl::Time start_time = absl::Now();
-  ZETASQL_ASSIGN_OR_RETURN(auto analyzer_options,
+absl::StatusOr<std::unique_ptr<AnalyzedQuery>> QueryEngine::AnalyzeQuery(
+    const Query& query, const Schema* schema) const {
+  metrics::ScopedLatencyRecorder latency_recorder(AnalyzeLatency());
+  auto analyzed_query = std::make_unique<AnalyzedQuery>();
+  ZETASQL_ASSIGN_OR_RETURN(analyzed_query->analyzer_options,
                    MakeAnalyzerOptionsWithParameters(query.declared_params));
+  zetasql::AnalyzerOptions& analyzer_options =
+      analyzed_query->analyzer_options;
   analyzer_options.set_prune_unused_columns(true);
 
-  QueryEvaluatorForEngine view_evaluator(*this, context);
-  Catalog catalog{
-      context.schema,
-      &function_catalog_,
-      type_factory_,
-      analyzer_options,
-      context.reader,
-      &view_evaluator,
-      query.change_stream_internal_lookup,
-  };
+  analyzed_query->catalog =
+      TakeCatalog(schema, query.change_stream_internal_lookup);
+  Catalog* catalog = analyzed_query->catalog->catalog.get();
 
-  std::unique_ptr<const zetasql::AnalyzerOutput> analyzer_output;
-  if (context.schema->dialect() == database_api::DatabaseDialect::POSTGRESQL &&
+  if (schema->dialect() == database_api::DatabaseDialect::POSTGRESQL &&
       !query.change_stream_internal_lookup.has_value()) {
-    ZETASQL_ASSIGN_OR_RETURN(analyzer_output,
-                     AnalyzePostgreSQL(query.sql, &catalog, analyzer_options,
+    ZETASQL_ASSIGN_OR_RETURN(analyzed_query->analyzer_output,
+                     AnalyzePostgreSQL(query.sql, catalog, analyzer_options,
                                        type_factory_, &function_catalog_));
-
   } else {
-    ZETASQL_ASSIGN_OR_RETURN(analyzer_output, Analyze(query.sql, &catalog,
-                                              analyzer_options, type_factory_));
+    ZETASQL_ASSIGN_OR_RETURN(
+        analyzed_query->analyzer_output,
+        Analyze(query.sql, catalog, analyzer_options, type_factory_));
   }
+  return analyzed_query;
+}
 
-  ZETASQL_ASSIGN_OR_RETURN(auto params,
-                   ExtractParameters(query, analyzer_output.get()));
+std::unique_ptr<ReusableCatalog> QueryEngine::TakeCatalog(
+    const Schema* schema,
+    const std::optional<std::string>& change_stream_internal_lookup) const {
+  if (!change_stream_internal_lookup.has_value()) {
+    std::unique_ptr<ReusableCatalog> catalog = catalog_pool_.Take(schema);
+    if (catalog != nullptr) {
+      return catalog;
+    }
+  }
+  // The catalog only uses the analyzer options to analyze the expressions of
+  // generated and default columns, which cannot refer to query parameters. It
+  // is thus built without the parameters of the statement so that other
+  // statements can reuse it.
+  auto catalog = std::make_unique<ReusableCatalog>();
+  catalog->schema = schema;
+  catalog->catalog = std::make_unique<Catalog>(
+      schema, &function_catalog_, type_factory_, MakeGoogleSqlAnalyzerOptions(),
+      &catalog->reader, &catalog->query_evaluator,
+      change_stream_internal_lookup, &information_schema_cache_,
+      &spanner_sys_stats_);
+  return catalog;
+}
 
-  ZETASQL_ASSIGN_OR_RETURN(auto resolved_statement,
-                   ExtractValidatedResolvedStatementAndOptions(
-                       analyzer_output.get(), context));
+absl::StatusOr<std::unique_ptr<AnalyzedQuery>> QueryEngine::TakeAnalyzedQuery(
+    const Query& query, const Schema* schema,
+    std::optional<AnalyzedQueryCache::Key>* cache_key) const {
+  // Reuse the analysis of a previous use of the same statement if possible.
+  // This matters most for PostgreSQL statements, whose analysis parses and
+  // translates them into a ZetaSQL resolved AST.
+  cache_key->reset();
+  if (!query.change_stream_internal_lookup.has_value() &&
+      analyzed_query_cache_.IsCacheable(schema)) {
+    AnalyzedQueryCache::Key& key = cache_key->emplace();
+    key.schema = schema;
+    key.dialect = schema->dialect();
+    key.sql = query.sql;
+    for (const auto& [name, value] : query.declared_params) {
+      key.param_types.emplace_back(name, value.type());
+    }
+    std::unique_ptr<AnalyzedQuery> analyzed_query =
+        analyzed_query_cache_.Take(key);
+    if (analyzed_query != nullptr) {
+      return analyzed_query;
+    }
+  }
+  return AnalyzeQuery(query, schema);
+}
+
+std::optional<QueryResultCache::Key> QueryEngine::GetResultCacheKey(
+    const Query& query, const QueryContext& context,
+    v1::ExecuteSqlRequest_QueryMode query_mode) const {
+  // PLAN and PROFILE results are not replayed, as they describe the
+  // execution. Partitions and internal lookups are not worth caching.
+  if (!query_result_cache_.enabled() ||
+      !context.immutable_snapshot_timestamp.has_value() ||
+      query_mode != v1::ExecuteSqlRequest::NORMAL ||
+      query.partition.has_value() ||
+      query.change_stream_internal_lookup.has_value() ||
+      !query.undeclared_params.empty()) {
+    return std::nullopt;
+  }
+  QueryResultCache::Key key;
+  key.schema = context.schema;
+  key.sql = query.sql;
+  key.params.assign(query.declared_params.begin(),
+                    query.declared_params.end());
+  key.read_timestamp = *context.immutable_snapshot_timestamp;
+  return key;
+}
+
+void QueryEngine::ReturnAnalyzedQuery(
+    const std::optional<AnalyzedQueryCache::Key>& cache_key,
+    std::unique_ptr<AnalyzedQuery> analyzed_query) const {
+  if (!cache_key.has_value()) {
+    return;
+  }
+  std::unique_ptr<AnalyzedQuery> uncached =
+      analyzed_query_cache_.Return(*cache_key, std::move(analyzed_query));
+  if (uncached == nullptr) {
+    return;
+  }
+  // Once the analysis is gone, other statements can reuse its catalog.
+  std::unique_ptr<ReusableCatalog> catalog = std::move(uncached->catalog);
+  uncached.reset();
+  catalog_pool_.Return(std::move(catalog));
+}
+
+absl::StatusOr<QueryResult> QueryEngine::ExecuteSql(
+    const Query& query, const QueryContext& context,
+    v1::ExecuteSqlRequest_QueryMode query_mode) const {
+  tracing::ScopedSpan span("QueryEngine::ExecuteSql");
+  absl::Time start_time = absl::Now();
+  absl::StatusOr<QueryResult> result =
+      ExecuteSqlUnrecorded(query, context, query_mode);
+  absl::Time end_time = absl::Now();
+  query_stats_.RecordExecution(
+      query.sql, result.status(), end_time - start_time,
+      result.ok() ? result->num_output_rows : 0,
+      result.ok() ? result->modified_row_count : 0,
+      /*in_read_write_transaction=*/context.writer != nullptr, end_time);
+  return result;
+}
+
+absl::StatusOr<QueryResult> QueryEngine::ExecuteSqlUnrecorded(
+    const Query& query, const QueryContext& context,
+    v1::ExecuteSqlRequest_QueryMode query_mode) const {
+  absl::Time start_time = absl::Now();
+
+  std::optional<QueryResultCache::Key> result_cache_key =
+      GetResultCacheKey(query, context, query_mode);
+  if (result_cache_key.has_value()) {
+    std::shared_ptr<const CachedQueryResult> cached =
+        query_result_cache_.Lookup(*result_cache_key);
+    if (cached != nullptr) {
+      return ReplayResult(*cached, start_time);
+    }
+  }
+
+  std::optional<AnalyzedQueryCache::Key> cache_key;
+  std::unique_ptr<AnalyzedQuery> analyzed_query;
+  {
+    tracing::ScopedSpan span("QueryEngine::Analyze");
+    ZETASQL_ASSIGN_OR_RETURN(analyzed_query,
+                     TakeAnalyzedQuery(query, context.schema, &cache_key));
+  }
+
+  // In PROFILE mode, all reads of the query, including those issued to
+  // evaluate the views it references, are profiled.
+  std::optional<ProfilingRowReader> profiling_reader;
+  QueryContext reader_context = context;
+  if (query_mode == v1::ExecuteSqlRequest::PROFILE) {
+    profiling_reader.emplace(context.reader);
+    reader_context.reader = &*profiling_reader;
+  }
+
+  // Reads stop once the query is cancelled, including the reads issued to
+  // evaluate the views it references.
+  std::optional<CancellableRowReader> cancellable_reader;
+  if (query.check_cancelled) {
+    cancellable_reader.emplace(reader_context.reader, &query.check_cancelled);
+    reader_context.reader = &*cancellable_reader;
+  }
+
+  QueryEvaluatorForEngine view_evaluator(*this, reader_context);
+  std::optional<KeySetRowReader> partitioned_reader;
+  if (query.partition.has_value()) {
+    partitioned_reader.emplace(reader_context.reader,
+                               query.partition->table_name,
+                               query.partition->key_set);
+    analyzed_query->catalog->reader.set_reader(&*partitioned_reader);
+  } else {
+    analyzed_query->catalog->reader.set_reader(reader_context.reader);
+  }
+  analyzed_query->catalog->query_evaluator.set_evaluator(&view_evaluator);
+  absl::StatusOr<QueryResult> result;
+  {
+    metrics::ScopedLatencyRecorder latency_recorder(ExecuteLatency());
+    // Query rows are produced lazily by the returned cursor, so for queries
+    // this covers preparing the evaluation, not reading the results.
+    tracing::ScopedSpan span("QueryEngine::Evaluate");
+    result = ExecuteAnalyzedSql(query, context, query_mode, start_time,
+                                analyzed_query.get());
+  }
+  if (result.ok() && result->rows != nullptr && result_cache_key.has_value() &&
+      IsReplayableQuery(
+          analyzed_query->analyzer_output->resolved_statement())) {
+    absl::StatusOr<std::shared_ptr<const CachedQueryResult>> cached =
+        MaterializeResult(&*result);
+    if (cached.ok()) {
+      query_result_cache_.Insert(*result_cache_key, *std::move(cached));
+    } else {
+      result = cached.status();
+    }
+  }
+  ReturnAnalyzedQuery(cache_key, std::move(analyzed_query));
+  if (result.ok() && profiling_reader.has_value()) {
+    result->table_scans = profiling_reader->table_scans();
+  }
+  return result;
+}
+
+absl::StatusOr<QueryResult> QueryEngine::ExecuteAnalyzedSql(
+    const Query& query, const QueryContext& context,
+    v1::ExecuteSqlRequest_QueryMode query_mode, absl::Time start_time,
+    AnalyzedQuery* analyzed_query) const {
+  Catalog& catalog = *analyzed_query->catalog->catalog;
+  const zetasql::AnalyzerOutput* analyzer_output =
+      analyzed_query->analyzer_output.get();
+
+  ZETASQL_ASSIGN_OR_RETURN(auto params, ExtractParameters(query, analyzer_output));
+
+  // DML statements are run from the analysis without unused columns pruned,
+  // so that is the analysis which is validated for them.
+  const bool is_dml =
+      IsDMLStmt(analyzer_output->resolved_statement()->node_kind());
+  std::unique_ptr<const ValidatedStatement>* validated =
+      &analyzed_query->validated_statement;
+  if (is_dml) {
+    if (analyzed_query->dml_analyzer_output == nullptr) {
+      zetasql::AnalyzerOptions analyzer_options =
+          analyzed_query->analyzer_options;
+      analyzer_options.set_prune_unused_columns(false);
+      if (context.schema->dialect() ==
+          database_api::DatabaseDialect::POSTGRESQL) {
+        ZETASQL_ASSIGN_OR_RETURN(
+            analyzed_query->dml_analyzer_output,
+            AnalyzePostgreSQL(query.sql, &catalog, analyzer_options,
+                              type_factory_, &function_catalog_));
+      } else {
+        ZETASQL_ASSIGN_OR_RETURN(
+            analyzed_query->dml_analyzer_output,
+            Analyze(query.sql, &catalog, analyzer_options, type_factory_));
+      }
+    }
+    analyzer_output = analyzed_query->dml_analyzer_output.get();
+    validated = &analyzed_query->validated_dml_statement;
+  }
+  const ValidatedStatement* validated_statement;
+  {
+    tracing::ScopedSpan span("QueryEngine::Prepare");
+    ZETASQL_ASSIGN_OR_RETURN(
+        validated_statement,
+        GetValidatedStatement(analyzer_output, context, validated));
+  }
+  const zetasql::ResolvedStatement* resolved_statement =
+      validated_statement->statement.get();
 
   // Change stream queries are not directly executed via this generic ExecuteSql
   // function in query engine. If a change stream query reaches here, it is from
@@ -963,48 +1665,53 @@ absl::StatusOr<QueryResult> QueryEngine::ExecuteSql(
       absl::flat_hash_map<std::string, zetasql::Value>(params.begin(),
                                                          params.end())};
   ZETASQL_ASSIGN_OR_RETURN(auto is_change_stream,
-                   validator.IsChangeStreamQuery(resolved_statement.get()));
+                   validator.IsChangeStreamQuery(resolved_statement));
   if (is_change_stream) {
     return error::ChangeStreamQueriesMustBeStreaming();
   }
 
+  QueryMemoryBudget own_memory_budget(config::query_memory_limit_bytes());
+  QueryMemoryBudget* memory_budget = query.memory_budget != nullptr
+                                         ? query.memory_budget
+                                         : &own_memory_budget;
   QueryResult result;
-  if (!IsDMLStmt(analyzer_output->resolved_statement()->node_kind())) {
+  if (!is_dml) {
     ZETASQL_ASSIGN_OR_RETURN(
         auto cursor,
-        EvaluateQuery(resolved_statement.get(), params, type_factory_,
-                      &result.num_output_rows, query_mode));
+        EvaluateQuery(resolved_statement, params, type_factory_,
+                      &result.num_output_rows, query_mode,
+                      query.check_cancelled, memory_budget,
+                      ScrambleSeed(query, params, context)));
     result.rows = std::move(cursor);
   } else {
     ZETASQL_RET_CHECK_NE(context.writer, nullptr);
-    analyzer_options.set_prune_unused_columns(false);
-    if (context.schema->dialect() ==
-        database_api::DatabaseDialect::POSTGRESQL) {
-      ZETASQL_ASSIGN_OR_RETURN(analyzer_output,
-                       AnalyzePostgreSQL(query.sql, &catalog, analyzer_options,
-                                         type_factory_, &function_catalog_));
-    } else {
-      ZETASQL_ASSIGN_OR_RETURN(
-          analyzer_output,
-          Analyze(query.sql, &catalog, analyzer_options, type_factory_));
-    }
-    ZETASQL_ASSIGN_OR_RETURN(resolved_statement,
-                     ExtractValidatedResolvedStatementAndOptions(
-                         analyzer_output.get(), context));
-
     // Only execute the SQL statement if the user did not request PLAN mode.
     if (query_mode != v1::ExecuteSqlRequest::PLAN) {
-      ZETASQL_ASSIGN_OR_RETURN(
-          auto execute_update_result,
-          EvaluateUpdate(resolved_statement.get(), &catalog, params,
+      // The evaluator scans the whole target table of the statement, so reads
+      // of the table are restricted to the rows its WHERE clause may select.
+      ForwardingRowReader& catalog_reader = analyzed_query->catalog->reader;
+      RowReader* statement_reader = catalog_reader.reader();
+      std::optional<KeySetRowReader> target_reader;
+      if (std::optional<DmlTargetRows> target_rows =
+              BoundDmlTargetRows(resolved_statement, params);
+          target_rows.has_value()) {
+        target_reader.emplace(statement_reader,
+                              std::move(target_rows->table_name),
+                              std::move(target_rows->key_set));
+        catalog_reader.set_reader(&*target_reader);
+      }
+      absl::StatusOr<ExecuteUpdateResult> evaluated =
+          EvaluateUpdate(resolved_statement, &catalog, params,
                          type_factory_, context.schema->dialect(),
-                         context.schema));
+                         context.schema);
+      catalog_reader.set_reader(statement_reader);
+      ZETASQL_ASSIGN_OR_RETURN(auto execute_update_result, std::move(evaluated));
       ZETASQL_RETURN_IF_ERROR(context.writer->Write(execute_update_result.mutation));
       result.modified_row_count = execute_update_result.modify_row_count;
       result.rows = std::move(execute_update_result.returning_row_cursor);
     } else {
       // Add the columns and types of the returning clause to the result.
-      auto returning_clause = GetReturningClause(resolved_statement.get());
+      auto returning_clause = GetReturningClause(resolved_statement);
       if (returning_clause != nullptr) {
         std::vector<std::string> names;
         std::vector<const zetasql::Type*> types;
@@ -1052,35 +1759,42 @@ const zetasql::ResolvedReturningClause* GetReturningClause(
 }
 
 absl::Status QueryEngine::IsPartitionable(const Query& query,
-                                          const QueryContext& context) const {
-  ZETASQL_ASSIGN_OR_RETURN(auto analyzer_options,
-                   MakeAnalyzerOptionsWithParameters(query.declared_params));
-  analyzer_options.set_prune_unused_columns(true);
-  Catalog catalog{context.schema, &function_catalog_, type_factory_,
-                  analyzer_options};
+                                          const QueryContext& context,
+                                          const Table** root_table) const {
+  // The partitions of a query are executed with the same statement, so the
+  // analysis is shared with their executions through the cache.
+  std::optional<AnalyzedQueryCache::Key> cache_key;
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<AnalyzedQuery> analyzed_query,
+                   TakeAnalyzedQuery(query, context.schema, &cache_key));
+  absl::Status status =
+      ValidatePartitionable(analyzed_query.get(), context, root_table);
+  ReturnAnalyzedQuery(cache_key, std::move(analyzed_query));
+  return status;
+}
 
-  std::unique_ptr<const zetasql::AnalyzerOutput> analyzer_output;
-  if (context.schema->dialect() == database_api::DatabaseDialect::POSTGRESQL) {
-    ZETASQL_ASSIGN_OR_RETURN(analyzer_output,
-                     AnalyzePostgreSQL(query.sql, &catalog, analyzer_options,
-                                       type_factory_, &function_catalog_));
-  } else {
-    ZETASQL_ASSIGN_OR_RETURN(analyzer_output, Analyze(query.sql, &catalog,
-                                              analyzer_options, type_factory_));
+absl::Status QueryEngine::ValidatePartitionable(
+    AnalyzedQuery* analyzed_query, const QueryContext& context,
+    const Table** root_table) const {
+  ZETASQL_ASSIGN_OR_RETURN(
+      const ValidatedStatement* validated,
+      GetValidatedStatement(analyzed_query->analyzer_output.get(), context,
+                            &analyzed_query->validated_statement));
+  const zetasql::ResolvedStatement* resolved_statement =
+      validated->statement.get();
+  if (root_table != nullptr) {
+    *root_table = nullptr;
   }
-
-  QueryEngineOptions options;
-  ZETASQL_ASSIGN_OR_RETURN(auto resolved_statement,
-                   ExtractValidatedResolvedStatementAndOptions(
-                       analyzer_output.get(), context,
-                       &options));
-  if (options.disable_query_partitionability_check) {
+  if (validated->options.disable_query_partitionability_check) {
     return absl::OkStatus();
   }
 
   // Perform partitionability checks on the query
   PartitionabilityValidator part_validator{context.schema};
-  return resolved_statement->Accept(&part_validator);
+  ZETASQL_RETURN_IF_ERROR(resolved_statement->Accept(&part_validator));
+  if (root_table != nullptr) {
+    *root_table = part_validator.root_table();
+  }
+  return absl::OkStatus();
 }
 
 absl::Status QueryEngine::IsValidPartitionedDML(
@@ -1089,14 +1803,23 @@ absl::Status QueryEngine::IsValidPartitionedDML(
     return error::InvalidOperationUsingPartitionedDmlTransaction();
   }
 
+  std::unique_ptr<ReusableCatalog> catalog = TakeCatalog(
+      context.schema, /*change_stream_internal_lookup=*/std::nullopt);
+  absl::Status status =
+      ValidatePartitionedDML(query, context, catalog->catalog.get());
+  catalog_pool_.Return(std::move(catalog));
+  return status;
+}
+
+absl::Status QueryEngine::ValidatePartitionedDML(const Query& query,
+                                                 const QueryContext& context,
+                                                 Catalog* catalog) const {
   ZETASQL_ASSIGN_OR_RETURN(auto analyzer_options,
                    MakeAnalyzerOptionsWithParameters(query.declared_params));
   analyzer_options.set_prune_unused_columns(true);
-  Catalog catalog{context.schema, &function_catalog_, type_factory_,
-                  analyzer_options};
   ZETASQL_ASSIGN_OR_RETURN(
       auto analyzer_output,
-      Analyze(query.sql, &catalog, analyzer_options, type_factory_));
+      Analyze(query.sql, catalog, analyzer_options, type_factory_));
 
   ZETASQL_ASSIGN_OR_RETURN(auto resolved_statement,
                    ExtractValidatedResolvedStatementAndOptions(
@@ -1117,40 +1840,45 @@ bool IsDMLQuery(const std::string& query) {
 absl::StatusOr<ChangeStreamQueryValidator::ChangeStreamMetadata>
 QueryEngine::TryGetChangeStreamMetadata(const Query& query,
                                         const Schema* schema,
-                                        bool in_read_write_txn) {
-  const absl::Time start_time = absl::Now();
-  ZETASQL_ASSIGN_OR_RETURN(auto analyzer_options,
-                   MakeAnalyzerOptionsWithParameters(query.declared_params));
-  analyzer_options.set_prune_unused_columns(true);
-  zetasql::TypeFactory type_factory;
-  FunctionCatalog function_catalog(&type_factory);
-  Catalog catalog{schema, &function_catalog, &type_factory, analyzer_options};
-  std::unique_ptr<const zetasql::AnalyzerOutput> analyzer_output;
-  if (schema->dialect() == database_api::DatabaseDialect::POSTGRESQL) {
-    ZETASQL_ASSIGN_OR_RETURN(analyzer_output,
-                     AnalyzePostgreSQL(query.sql, &catalog, analyzer_options,
-                                       &type_factory, &function_catalog));
-  } else {
-    ZETASQL_ASSIGN_OR_RETURN(analyzer_output, Analyze(query.sql, &catalog,
-                                              analyzer_options, &type_factory));
-  }
+                                        bool in_read_write_txn) const {
+  // Every streaming query is classified before it is executed. Sharing the
+  // analysis with the execution through the cache means that repeated
+  // statements are analyzed neither here nor there.
+  std::optional<AnalyzedQueryCache::Key> cache_key;
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<AnalyzedQuery> analyzed_query,
+                   TakeAnalyzedQuery(query, schema, &cache_key));
+  absl::StatusOr<ChangeStreamQueryValidator::ChangeStreamMetadata> metadata =
+      GetChangeStreamMetadata(query, schema, in_read_write_txn,
+                              analyzed_query.get());
+  ReturnAnalyzedQuery(cache_key, std::move(analyzed_query));
+  return metadata;
+}
 
-  ZETASQL_ASSIGN_OR_RETURN(auto params,
-                   ExtractParameters(query, analyzer_output.get()));
+absl::StatusOr<ChangeStreamQueryValidator::ChangeStreamMetadata>
+QueryEngine::GetChangeStreamMetadata(
+    const Query& query, const Schema* schema, bool in_read_write_txn,
+    AnalyzedQuery* analyzed_query) const {
+  const absl::Time start_time = absl::Now();
+  const zetasql::AnalyzerOutput* analyzer_output =
+      analyzed_query->analyzer_output.get();
+  ZETASQL_ASSIGN_OR_RETURN(auto params, ExtractParameters(query, analyzer_output));
 
   ZETASQL_ASSIGN_OR_RETURN(
-      auto resolved_statement,
-      ExtractValidatedResolvedStatementAndOptions(
-          analyzer_output.get(),
+      const ValidatedStatement* validated,
+      GetValidatedStatement(
+          analyzer_output,
           QueryContext{.schema = schema,
-                       .allow_read_write_only_functions = in_read_write_txn}));
+                       .allow_read_write_only_functions = in_read_write_txn},
+          &analyzed_query->validated_statement));
+  const zetasql::ResolvedStatement* resolved_statement =
+      validated->statement.get();
 
   ChangeStreamQueryValidator validator{
       schema, start_time,
       absl::flat_hash_map<std::string, zetasql::Value>(params.begin(),
                                                          params.end())};
   ZETASQL_ASSIGN_OR_RETURN(auto is_change_stream,
-                   validator.IsChangeStreamQuery(resolved_statement.get()));
+                   validator.IsChangeStreamQuery(resolved_statement));
 
   if (is_change_stream) {
     ZETASQL_RETURN_IF_ERROR(resolved_statement->Accept(&validator));
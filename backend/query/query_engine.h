@@ -17,21 +17,34 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_ENGINE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_ENGINE_H_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "google/protobuf/struct.pb.h"
 #include "google/spanner/v1/spanner.pb.h"
 #include "zetasql/public/analyzer_options.h"
+#include "zetasql/public/analyzer_output.h"
 #include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "backend/common/sys_stats.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/query/analyzed_query_cache.h"
 #include "backend/query/change_stream/change_stream_query_validator.h"
 #include "backend/query/function_catalog.h"
+#include "backend/query/information_schema_catalog.h"
 #include "backend/query/query_context.h"
+#include "backend/query/query_memory_budget.h"
+#include "backend/query/query_result_cache.h"
+#include "backend/query/spanner_sys_catalog.h"
 #include "backend/schema/catalog/schema.h"
 #include "absl/status/status.h"
 
@@ -40,6 +53,16 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
+// QueryPartition restricts a partitioned query to a contiguous subset of the
+// rows of the table it scans (see PartitionQuery).
+struct QueryPartition {
+  // The name of the table scanned by the query.
+  std::string table_name;
+
+  // The primary keys of the rows of `table_name` within the partition.
+  KeySet key_set;
+};
+
 // Query specifies the input of a query request.
 struct Query {
   // The SQL string to be executed.
@@ -56,6 +79,21 @@ struct Query {
   // If not empty,the current query is an internal query against a non public
   // partition or data table of this change stream
   std::optional<std::string> change_stream_internal_lookup;
+
+  // If set, the query only reads the rows of a single partition of its root
+  // table.
+  std::optional<QueryPartition> partition;
+
+  // If set, called as the query reads and produces rows, possibly from several
+  // threads at once. The query stops with the returned error once it is not
+  // OK, e.g. because the client which issued it went away.
+  std::function<absl::Status()> check_cancelled;
+
+  // If set, the memory which the query keeps while it executes is charged to
+  // this budget, which the caller may keep charging its response to.
+  // Otherwise, the query is charged to a budget of its own with a limit of
+  // config::query_memory_limit_bytes(). Not owned.
+  QueryMemoryBudget* memory_budget = nullptr;
 };
 
 // Returns true if the given query is a DML statement.
@@ -65,6 +103,33 @@ bool IsDMLQuery(const std::string& query);
 const zetasql::ResolvedReturningClause* GetReturningClause(
     const zetasql::ResolvedStatement* resolved_statement);
 
+// TableScanStats holds the execution statistics of the reads a query issued
+// against a table or index, as collected in PROFILE mode. Reads of the same
+// target along the same kind of access path are aggregated.
+struct TableScanStats {
+  // The table read.
+  std::string table;
+
+  // The index read, or empty if the base table was read.
+  std::string index;
+
+  // True if the reads scanned the whole table or index (i.e. read
+  // KeySet::All()), which is typically a sign of a missing filter or index.
+  bool full_scan = false;
+
+  // The number of reads issued.
+  int64_t num_executions = 0;
+
+  // The number of rows read from storage.
+  int64_t rows_scanned = 0;
+
+  // The size of the values read from storage.
+  int64_t bytes_read = 0;
+
+  // Time spent reading from storage.
+  absl::Duration latency;
+};
+
 // QueryResult specifies the output of a query request.
 struct QueryResult {
   // A row cursor containing the query result rows. It's null for DML requests
@@ -82,13 +147,39 @@ struct QueryResult {
 
   // Query execution elapsed time.
   absl::Duration elapsed_time;
+
+  // Statistics of the table and index reads issued by the query, in the order
+  // they were first issued. Only populated in PROFILE mode.
+  std::vector<TableScanStats> table_scans;
 };
 
+// Default maximum number of analyzed statements cached by a QueryEngine.
+constexpr int64_t kDefaultAnalyzedQueryCacheCapacity = 256;
+
+// Maximum number of unused catalogs kept by a QueryEngine for reuse.
+constexpr int64_t kCatalogPoolCapacity = 8;
+
 // QueryEngine handles SQL-related requests.
+//
+// The analysis of statements executed through ExecuteSql is cached (see
+// AnalyzedQueryCache) for the latest schema set through
+// SetLatestSchemaForFunctionCatalog. Declared parameter types must be owned by
+// `type_factory` for the cached analyses to remain valid. Catalogs of the
+// latest schema are reused between statements (see CatalogPool). If
+// `query_result_cache_capacity` is positive, the results of deterministic
+// queries which read an immutable snapshot are cached (see QueryResultCache).
+// Every execution through ExecuteSql is recorded in query_stats().
 class QueryEngine {
  public:
-  explicit QueryEngine(zetasql::TypeFactory* type_factory)
-      : type_factory_(type_factory), function_catalog_(type_factory) {}
+  explicit QueryEngine(
+      zetasql::TypeFactory* type_factory,
+      int64_t analyzed_query_cache_capacity = kDefaultAnalyzedQueryCacheCapacity,
+      int64_t query_result_cache_capacity = 0)
+      : type_factory_(type_factory),
+        function_catalog_(type_factory),
+        catalog_pool_(kCatalogPoolCapacity),
+        analyzed_query_cache_(analyzed_query_cache_capacity),
+        query_result_cache_(query_result_cache_capacity) {}
 
   // Returns the name of the table that a given DML query modifies.
   absl::StatusOr<std::string> GetDmlTargetTable(const Query& query,
@@ -104,9 +195,11 @@ class QueryEngine {
       const Query& query, const QueryContext& context,
       v1::ExecuteSqlRequest_QueryMode query_mode) const;
 
-  // Returns OK if query is partitionable.
-  absl::Status IsPartitionable(const Query& query,
-                               const QueryContext& context) const;
+  // Returns OK if query is partitionable. If `root_table` is not null, it is
+  // set to the table scanned by the query, or to null if the query cannot be
+  // split by the keys of a single table.
+  absl::Status IsPartitionable(const Query& query, const QueryContext& context,
+                               const Table** root_table = nullptr) const;
 
   // Returns OK if the 'query' is a DML statement that can be executed through
   // partitioned DML.
@@ -118,21 +211,130 @@ class QueryEngine {
   // valid change stream query. Returns corresponding error status if current
   // query is an invalid regular query, a non-change stream tvf query or an
   // invalid change stream tvf query.
-  static absl::StatusOr<ChangeStreamQueryValidator::ChangeStreamMetadata>
+  absl::StatusOr<ChangeStreamQueryValidator::ChangeStreamMetadata>
   TryGetChangeStreamMetadata(const Query& query, const Schema* schema,
-                             bool in_read_write_txn = false);
+                             bool in_read_write_txn = false) const;
 
   zetasql::TypeFactory* type_factory() const { return type_factory_; }
 
   const FunctionCatalog* function_catalog() const { return &function_catalog_; }
 
+  // Sets the latest schema of the database. This also invalidates analyzed
+  // statements and catalogs cached for the previous schema.
   void SetLatestSchemaForFunctionCatalog(const Schema* schema) {
     function_catalog_.SetLatestSchema(schema);
+    information_schema_cache_.SetSchema(schema);
+    catalog_pool_.SetSchema(schema);
+    analyzed_query_cache_.SetSchema(schema);
+    query_result_cache_.SetSchema(schema);
+  }
+
+  const AnalyzedQueryCache& analyzed_query_cache() const {
+    return analyzed_query_cache_;
+  }
+
+  const CatalogPool& catalog_pool() const { return catalog_pool_; }
+
+  const QueryResultCache& query_result_cache() const {
+    return query_result_cache_;
+  }
+
+  // Sets the sources of the statistics reported in SPANNER_SYS. Must be called
+  // before the first query.
+  void SetSpannerSysStats(SpannerSysStats spanner_sys_stats) {
+    spanner_sys_stats_ = std::move(spanner_sys_stats);
   }
 
+  // Returns the statistics of the statements executed through ExecuteSql.
+  const QueryStats& query_stats() const { return query_stats_; }
+
  private:
+  // Returns a catalog of `schema` from the pool, or builds a new one. Catalogs
+  // for change stream internal lookups are always built anew.
+  std::unique_ptr<ReusableCatalog> TakeCatalog(
+      const Schema* schema,
+      const std::optional<std::string>& change_stream_internal_lookup) const;
+
+  // Analyzes `query` against a new catalog for `schema`.
+  absl::StatusOr<std::unique_ptr<AnalyzedQuery>> AnalyzeQuery(
+      const Query& query, const Schema* schema) const;
+
+  // Returns the cached analysis of `query` against `schema`, removing it from
+  // the cache, or analyzes `query` if it is not cached. `cache_key` is set to
+  // the key under which ReturnAnalyzedQuery caches the analysis once the caller
+  // is done with it, or to nullopt if it cannot be cached.
+  absl::StatusOr<std::unique_ptr<AnalyzedQuery>> TakeAnalyzedQuery(
+      const Query& query, const Schema* schema,
+      std::optional<AnalyzedQueryCache::Key>* cache_key) const;
+
+  // Returns the key under which the result of `query` is cached, or nullopt if
+  // the result of `query` in `context` cannot be cached.
+  std::optional<QueryResultCache::Key> GetResultCacheKey(
+      const Query& query, const QueryContext& context,
+      v1::ExecuteSqlRequest_QueryMode query_mode) const;
+
+  // Puts an analysis obtained from TakeAnalyzedQuery back into the cache.
+  void ReturnAnalyzedQuery(
+      const std::optional<AnalyzedQueryCache::Key>& cache_key,
+      std::unique_ptr<AnalyzedQuery> analyzed_query) const;
+
+  // Implements GetDmlTargetTable against `catalog`.
+  absl::StatusOr<std::string> AnalyzeDmlTargetTable(const Query& query,
+                                                    const Schema* schema,
+                                                    Catalog* catalog) const;
+
+  // Implements IsValidPartitionedDML against `catalog`.
+  absl::Status ValidatePartitionedDML(const Query& query,
+                                      const QueryContext& context,
+                                      Catalog* catalog) const;
+
+  // Implements IsPartitionable for an analyzed query.
+  absl::Status ValidatePartitionable(AnalyzedQuery* analyzed_query,
+                                     const QueryContext& context,
+                                     const Table** root_table) const;
+
+  // Implements TryGetChangeStreamMetadata for an analyzed query.
+  absl::StatusOr<ChangeStreamQueryValidator::ChangeStreamMetadata>
+  GetChangeStreamMetadata(const Query& query, const Schema* schema,
+                          bool in_read_write_txn,
+                          AnalyzedQuery* analyzed_query) const;
+
+  // Implements ExecuteSql, without recording the execution in query_stats_.
+  absl::StatusOr<QueryResult> ExecuteSqlUnrecorded(
+      const Query& query, const QueryContext& context,
+      v1::ExecuteSqlRequest_QueryMode query_mode) const;
+
+  // Executes a query which was analyzed by AnalyzeQuery.
+  absl::StatusOr<QueryResult> ExecuteAnalyzedSql(
+      const Query& query, const QueryContext& context,
+      v1::ExecuteSqlRequest_QueryMode query_mode, absl::Time start_time,
+      AnalyzedQuery* analyzed_query) const;
+
   zetasql::TypeFactory* type_factory_;
   FunctionCatalog function_catalog_;
+
+  // Sources of the statistics reported in SPANNER_SYS.
+  SpannerSysStats spanner_sys_stats_;
+
+  // Statistics of the statements executed through ExecuteSql.
+  mutable QueryStats query_stats_;
+
+  // Information schema catalogs shared by the queries against the latest
+  // schema. Declared before analyzed_query_cache_ since the cached catalogs
+  // refer to it.
+  mutable InformationSchemaCatalogCache information_schema_cache_;
+
+  // Catalogs which are not used by any cached statement. Declared before
+  // analyzed_query_cache_ since the cached statements return their catalogs to
+  // it.
+  mutable CatalogPool catalog_pool_;
+
+  // Cache of analyzed statements. Declared after function_catalog_ since the
+  // cached catalogs refer to it.
+  mutable AnalyzedQueryCache analyzed_query_cache_;
+
+  // Cache of the results of queries which read immutable snapshots.
+  mutable QueryResultCache query_result_cache_;
 };
 
 }  // namespace backend
@@ -46,6 +46,7 @@
 #include "backend/datamodel/value.h"
 #include "backend/query/query_context.h"
 #include "backend/schema/catalog/schema.h"
+#include "common/config.h"
 #include "common/limits.h"
 #include "tests/common/row_reader.h"
 #include "tests/common/schema_constructor.h"
@@ -66,6 +67,7 @@ using testing::AllOf;
 using testing::ElementsAre;
 using testing::Field;
 using testing::HasSubstr;
+using testing::IsEmpty;
 using testing::IsTrue;
 using testing::Property;
 using testing::Return;
@@ -535,6 +537,217 @@ TEST_P(QueryEngineTest, ExecuteSqlSelectsOneFromTable) {
                                ElementsAre(Int64(1)))));
 }
 
+TEST_P(QueryEngineTest, ExecuteSqlStopsOnceCancelled) {
+  Query query{"SELECT int64_col FROM test_table"};
+  int checks = 0;
+  query.check_cancelled = [&checks]() {
+    ++checks;
+    return absl::CancelledError("cancelled");
+  };
+  EXPECT_THAT(
+      query_engine().ExecuteSql(query, QueryContext{schema(), reader()}),
+      StatusIs(absl::StatusCode::kCancelled));
+  EXPECT_GT(checks, 0);
+
+  // Queries which are not cancelled are unaffected by the check.
+  query.check_cancelled = []() { return absl::OkStatus(); };
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      query_engine().ExecuteSql(query, QueryContext{schema(), reader()}));
+  EXPECT_THAT(
+      GetAllColumnValues(std::move(result.rows)),
+      IsOkAndHolds(UnorderedElementsAre(ElementsAre(Int64(1)),
+                                        ElementsAre(Int64(2)),
+                                        ElementsAre(Int64(4)))));
+}
+
+TEST_P(QueryEngineTest, ExecuteSqlFailsOnceMemoryBudgetIsExceeded) {
+  Query query{"SELECT int64_col FROM test_table"};
+  QueryMemoryBudget small_budget(/*limit_bytes=*/1);
+  query.memory_budget = &small_budget;
+  EXPECT_THAT(
+      query_engine().ExecuteSql(query, QueryContext{schema(), reader()}),
+      StatusIs(absl::StatusCode::kResourceExhausted));
+
+  // The rows of the result stay charged to the budget of the caller.
+  QueryMemoryBudget large_budget(/*limit_bytes=*/1 << 20);
+  query.memory_budget = &large_budget;
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      query_engine().ExecuteSql(query, QueryContext{schema(), reader()}));
+  EXPECT_THAT(
+      GetAllColumnValues(std::move(result.rows)),
+      IsOkAndHolds(UnorderedElementsAre(ElementsAre(Int64(1)),
+                                        ElementsAre(Int64(2)),
+                                        ElementsAre(Int64(4)))));
+  EXPECT_GT(large_budget.used_bytes(), 0);
+}
+
+TEST_P(QueryEngineTest, ExecuteSqlReusesAnalysisForLatestSchema) {
+  query_engine().SetLatestSchemaForFunctionCatalog(schema());
+  for (int i = 0; i < 2; ++i) {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        QueryResult result,
+        query_engine().ExecuteSql(Query{"SELECT int64_col FROM test_table"},
+                                  QueryContext{schema(), reader()}));
+    EXPECT_THAT(
+        GetAllColumnValues(std::move(result.rows)),
+        IsOkAndHolds(UnorderedElementsAre(ElementsAre(Int64(1)),
+                                          ElementsAre(Int64(2)),
+                                          ElementsAre(Int64(4)))));
+  }
+  EXPECT_EQ(query_engine().analyzed_query_cache().hits(), 1);
+  EXPECT_EQ(query_engine().analyzed_query_cache().size(), 1);
+
+  // Publishing a new schema invalidates the cached analysis.
+  query_engine().SetLatestSchemaForFunctionCatalog(multi_table_schema());
+  EXPECT_EQ(query_engine().analyzed_query_cache().size(), 0);
+}
+
+TEST_P(QueryEngineTest, ExecuteSqlReusesAnalysisOfClassifiedQuery) {
+  query_engine().SetLatestSchemaForFunctionCatalog(schema());
+  Query query{"SELECT int64_col FROM test_table"};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto metadata, query_engine().TryGetChangeStreamMetadata(
+                                          query, schema()));
+  EXPECT_FALSE(metadata.is_change_stream_query);
+  ZETASQL_EXPECT_OK(query_engine().IsPartitionable(query, QueryContext{schema()}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      query_engine().ExecuteSql(query, QueryContext{schema(), reader()}));
+  EXPECT_THAT(
+      GetAllColumnValues(std::move(result.rows)),
+      IsOkAndHolds(UnorderedElementsAre(ElementsAre(Int64(1)),
+                                        ElementsAre(Int64(2)),
+                                        ElementsAre(Int64(4)))));
+  EXPECT_EQ(query_engine().analyzed_query_cache().hits(), 2);
+  EXPECT_EQ(query_engine().analyzed_query_cache().size(), 1);
+}
+
+TEST_P(QueryEngineTest, RevalidatesCachedStatementInMoreRestrictiveContext) {
+  if (GetParam() == database_api::DatabaseDialect::POSTGRESQL) {
+    GTEST_SKIP();
+  }
+  Query query{"SELECT GET_NEXT_SEQUENCE_VALUE(SEQUENCE myseq)"};
+  ZETASQL_EXPECT_OK(query_engine().TryGetChangeStreamMetadata(
+      query, sequence_schema(), /*in_read_write_txn=*/true));
+
+  // The statement validated for a read-write transaction is validated again
+  // for a read-only transaction, which does not allow the function.
+  EXPECT_THAT(query_engine().TryGetChangeStreamMetadata(
+                  query, sequence_schema(), /*in_read_write_txn=*/false),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_EQ(query_engine().analyzed_query_cache().hits(), 1);
+
+  // The failed validation does not replace the cached statement.
+  ZETASQL_EXPECT_OK(query_engine().TryGetChangeStreamMetadata(
+      query, sequence_schema(), /*in_read_write_txn=*/true));
+  EXPECT_EQ(query_engine().analyzed_query_cache().hits(), 2);
+}
+
+TEST_P(QueryEngineTest, ReusesCatalogOfLatestSchemaAcrossStatements) {
+  if (GetParam() == database_api::DatabaseDialect::POSTGRESQL) {
+    // GetDmlTargetTable only analyzes GoogleSQL statements.
+    GTEST_SKIP();
+  }
+  query_engine().SetLatestSchemaForFunctionCatalog(schema());
+  EXPECT_EQ(query_engine().catalog_pool().size(), 0);
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::string table,
+      query_engine().GetDmlTargetTable(
+          Query{"DELETE FROM test_table WHERE int64_col = 1"}, schema()));
+  EXPECT_EQ(table, "test_table");
+  EXPECT_EQ(query_engine().catalog_pool().size(), 1);
+
+  // A different statement takes the pooled catalog instead of building one.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      table,
+      query_engine().GetDmlTargetTable(
+          Query{"DELETE FROM test_table WHERE int64_col = 2"}, schema()));
+  EXPECT_EQ(table, "test_table");
+  EXPECT_EQ(query_engine().catalog_pool().size(), 1);
+
+  // Catalogs of other schemas are not pooled, and publishing a new schema
+  // drops the pooled catalogs.
+  ZETASQL_ASSERT_OK(query_engine().GetDmlTargetTable(
+      Query{"DELETE FROM test_table WHERE true"}, multi_table_schema()));
+  EXPECT_EQ(query_engine().catalog_pool().size(), 1);
+  query_engine().SetLatestSchemaForFunctionCatalog(multi_table_schema());
+  EXPECT_EQ(query_engine().catalog_pool().size(), 0);
+}
+
+TEST_P(QueryEngineTest, ExecuteSqlReplaysResultsOfImmutableSnapshots) {
+  QueryEngine engine(type_factory(), kDefaultAnalyzedQueryCacheCapacity,
+                     /*query_result_cache_capacity=*/4);
+  engine.SetLatestSchemaForFunctionCatalog(schema());
+  Query query{"SELECT int64_col FROM test_table"};
+  QueryContext snapshot_context{schema(), reader()};
+  snapshot_context.immutable_snapshot_timestamp = absl::FromUnixSeconds(1);
+
+  // Results are not cached unless the reader reads an immutable snapshot.
+  ZETASQL_ASSERT_OK(engine.ExecuteSql(query, QueryContext{schema(), reader()}));
+  EXPECT_EQ(engine.query_result_cache().size(), 0);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(QueryResult result,
+                       engine.ExecuteSql(query, snapshot_context));
+  EXPECT_THAT(
+      GetAllColumnValues(std::move(result.rows)),
+      IsOkAndHolds(UnorderedElementsAre(ElementsAre(Int64(1)),
+                                        ElementsAre(Int64(2)),
+                                        ElementsAre(Int64(4)))));
+  EXPECT_EQ(engine.query_result_cache().size(), 1);
+
+  // The cached rows are replayed without reading the snapshot again.
+  test::TestRowReader empty_reader{
+      {{"test_table",
+        {{"int64_col", "string_col", "date_col", "timestamp_col"},
+         {zetasql::types::Int64Type(), zetasql::types::StringType(),
+          zetasql::types::DateType(), zetasql::types::TimestampType()}}}}};
+  snapshot_context.reader = &empty_reader;
+  ZETASQL_ASSERT_OK_AND_ASSIGN(result, engine.ExecuteSql(query, snapshot_context));
+  EXPECT_EQ(result.num_output_rows, 3);
+  EXPECT_THAT(
+      GetAllColumnValues(std::move(result.rows)),
+      IsOkAndHolds(UnorderedElementsAre(ElementsAre(Int64(1)),
+                                        ElementsAre(Int64(2)),
+                                        ElementsAre(Int64(4)))));
+  EXPECT_EQ(engine.query_result_cache().hits(), 1);
+
+  // A different read timestamp reads the snapshot.
+  snapshot_context.immutable_snapshot_timestamp = absl::FromUnixSeconds(2);
+  ZETASQL_ASSERT_OK_AND_ASSIGN(result, engine.ExecuteSql(query, snapshot_context));
+  EXPECT_EQ(result.num_output_rows, 0);
+
+  if (GetParam() == database_api::DatabaseDialect::GOOGLE_STANDARD_SQL) {
+    // The results of non-deterministic queries are not cached.
+    ZETASQL_ASSERT_OK(engine.ExecuteSql(
+        Query{"SELECT CURRENT_TIMESTAMP() AS now"}, snapshot_context));
+    EXPECT_EQ(engine.query_result_cache().size(), 2);
+  }
+}
+
+TEST_P(QueryEngineTest, NativeOperatorsMatchReferenceEvaluator) {
+  for (const std::string& sql : {
+           "SELECT a.int64_col, b.string_col FROM test_table a "
+           "JOIN test_table b ON a.int64_col = b.int64_col "
+           "ORDER BY a.int64_col DESC LIMIT 2",
+           "SELECT COUNT(*), MIN(string_col), MAX(int64_col) FROM test_table",
+           "SELECT int64_col FROM test_table ORDER BY string_col",
+       }) {
+    config::set_native_query_operators_enabled(false);
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        QueryResult expected,
+        query_engine().ExecuteSql(Query{sql},
+                                  QueryContext{schema(), reader()}));
+    config::set_native_query_operators_enabled(true);
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        QueryResult result,
+        query_engine().ExecuteSql(Query{sql},
+                                  QueryContext{schema(), reader()}));
+    EXPECT_EQ(result.num_output_rows, expected.num_output_rows) << sql;
+    EXPECT_EQ(ToString(result), ToString(expected)) << sql;
+  }
+}
+
 TEST_P(QueryEngineTest, PlanSqlSelectsOneFromTable) {
   ZETASQL_ASSERT_OK_AND_ASSIGN(
       QueryResult result,
@@ -548,6 +761,32 @@ TEST_P(QueryEngineTest, PlanSqlSelectsOneFromTable) {
               IsOkAndHolds(ElementsAre()));
 }
 
+TEST_P(QueryEngineTest, ProfileSqlCollectsTableScanStats) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      query_engine().ExecuteSql(Query{"SELECT int64_col FROM test_table"},
+                                QueryContext{schema(), reader()},
+                                v1::ExecuteSqlRequest::PROFILE));
+  EXPECT_EQ(result.num_output_rows, 3);
+  ASSERT_EQ(result.table_scans.size(), 1);
+  const TableScanStats& scan = result.table_scans[0];
+  EXPECT_EQ(scan.table, "test_table");
+  EXPECT_EQ(scan.index, "");
+  EXPECT_TRUE(scan.full_scan);
+  EXPECT_EQ(scan.num_executions, 1);
+  EXPECT_EQ(scan.rows_scanned, 3);
+  EXPECT_GT(scan.bytes_read, 0);
+}
+
+TEST_P(QueryEngineTest, ExecuteSqlDoesNotCollectTableScanStats) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      query_engine().ExecuteSql(Query{"SELECT int64_col FROM test_table"},
+                                QueryContext{schema(), reader()}));
+  EXPECT_EQ(result.num_output_rows, 3);
+  EXPECT_THAT(result.table_scans, IsEmpty());
+}
+
 TEST_P(QueryEngineTest, ExecuteSqlSelectsGenerateUUIDFromTable) {
   // When using the postgres  dialect, generate_uuid() is exposed only via the
   // 'spanner' namespace.
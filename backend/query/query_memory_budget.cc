@@ -0,0 +1,56 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/query_memory_budget.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/status/status.h"
+#include "common/errors.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+absl::Status QueryMemoryBudget::Consume(int64_t bytes) {
+  const int64_t used =
+      used_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  if (limit_bytes_ > 0 && used > limit_bytes_) {
+    return error::QueryMemoryLimitExceeded(limit_bytes_);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryMemoryBudget::ConsumeRow(
+    const std::vector<zetasql::Value>& row) {
+  return Consume(RowBytes(row));
+}
+
+int64_t QueryMemoryBudget::RowBytes(const std::vector<zetasql::Value>& row) {
+  int64_t bytes = sizeof(row);
+  for (const zetasql::Value& value : row) {
+    bytes += value.physical_byte_size();
+  }
+  return bytes;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,73 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_MEMORY_BUDGET_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_MEMORY_BUDGET_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/status/status.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// QueryMemoryBudget bounds the approximate number of bytes which a query keeps
+// in memory while it executes: the rows of its result, the build sides of its
+// hash joins and groups of its hash aggregations, and its buffered response.
+// Once the bytes consumed exceed the limit, the query fails with
+// RESOURCE_EXHAUSTED instead of growing the heap of the whole process.
+//
+// This class is thread-safe.
+class QueryMemoryBudget {
+ public:
+  // A limit of zero or less does not bound the query.
+  explicit QueryMemoryBudget(int64_t limit_bytes) : limit_bytes_(limit_bytes) {}
+
+  QueryMemoryBudget(const QueryMemoryBudget&) = delete;
+  QueryMemoryBudget& operator=(const QueryMemoryBudget&) = delete;
+
+  // Consumes `bytes` of the budget, returning error::QueryMemoryLimitExceeded
+  // if the query now holds more than the limit. The bytes stay consumed either
+  // way, so every later call fails too.
+  absl::Status Consume(int64_t bytes);
+
+  // Same as Consume(RowBytes(row)).
+  absl::Status ConsumeRow(const std::vector<zetasql::Value>& row);
+
+  // Approximate number of bytes which `row` holds in memory.
+  static int64_t RowBytes(const std::vector<zetasql::Value>& row);
+
+  int64_t limit_bytes() const { return limit_bytes_; }
+  int64_t used_bytes() const {
+    return used_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const int64_t limit_bytes_;
+  std::atomic<int64_t> used_bytes_ = 0;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_MEMORY_BUDGET_H_
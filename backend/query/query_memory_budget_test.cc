@@ -0,0 +1,71 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/query_memory_budget.h"
+
+#include <cstdint>
+#include <string>
+
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::String;
+using ::zetasql_base::testing::StatusIs;
+
+TEST(QueryMemoryBudgetTest, FailsOnceLimitIsExceeded) {
+  QueryMemoryBudget budget(/*limit_bytes=*/100);
+  ZETASQL_EXPECT_OK(budget.Consume(60));
+  ZETASQL_EXPECT_OK(budget.Consume(40));
+  EXPECT_EQ(budget.used_bytes(), 100);
+
+  EXPECT_THAT(budget.Consume(1),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  // The bytes stay consumed, so the query keeps failing.
+  EXPECT_THAT(budget.Consume(0),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+}
+
+TEST(QueryMemoryBudgetTest, DoesNotLimitWithoutLimit) {
+  QueryMemoryBudget budget(/*limit_bytes=*/0);
+  ZETASQL_EXPECT_OK(budget.Consume(int64_t{1} << 40));
+  EXPECT_EQ(budget.used_bytes(), int64_t{1} << 40);
+}
+
+TEST(QueryMemoryBudgetTest, ChargesRowsByTheSizeOfTheirValues) {
+  const std::string large(1024, 'x');
+  EXPECT_GT(QueryMemoryBudget::RowBytes({Int64(1), String(large)}),
+            QueryMemoryBudget::RowBytes({Int64(1), String("x")}));
+
+  QueryMemoryBudget budget(/*limit_bytes=*/1024);
+  EXPECT_THAT(budget.ConsumeRow({String(large)}),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
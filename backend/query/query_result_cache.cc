@@ -0,0 +1,87 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/query/query_result_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "backend/schema/catalog/schema.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+void QueryResultCache::SetSchema(const Schema* schema) {
+  absl::MutexLock lock(&mu_);
+  if (schema_ == schema) {
+    return;
+  }
+  schema_ = schema;
+  index_.clear();
+  entries_.clear();
+}
+
+std::shared_ptr<const CachedQueryResult> QueryResultCache::Lookup(
+    const Key& key) {
+  absl::MutexLock lock(&mu_);
+  auto itr = index_.find(key);
+  if (itr == index_.end()) {
+    return nullptr;
+  }
+  // Move the entry to the front of the list as the most recently used one.
+  entries_.splice(entries_.begin(), entries_, itr->second);
+  ++hits_;
+  return itr->second->second;
+}
+
+void QueryResultCache::Insert(const Key& key,
+                              std::shared_ptr<const CachedQueryResult> result) {
+  absl::MutexLock lock(&mu_);
+  if (key.schema != schema_ || capacity_ <= 0) {
+    return;
+  }
+  // Another execution of the same query may have inserted its result first,
+  // which is then identical to this one.
+  if (index_.contains(key)) {
+    return;
+  }
+  entries_.emplace_front(key, std::move(result));
+  index_[key] = entries_.begin();
+  while (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+int64_t QueryResultCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+int64_t QueryResultCache::hits() const {
+  absl::MutexLock lock(&mu_);
+  return hits_;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,136 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_RESULT_CACHE_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_RESULT_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/analyzer_options.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/schema/catalog/schema.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// CachedQueryResult holds the rows returned by a query, which can be replayed
+// to other executions of the query.
+struct CachedQueryResult {
+  std::vector<std::string> column_names;
+  std::vector<const zetasql::Type*> column_types;
+  std::vector<std::vector<zetasql::Value>> rows;
+  zetasql::QueryParametersMap parameter_types;
+};
+
+// QueryResultCache is an LRU cache of the results of deterministic queries
+// which read an immutable snapshot of the database. Since such a snapshot
+// cannot change, repeated executions of the same query with the same
+// parameters at the same read timestamp return the same rows, which are then
+// replayed from the cache instead of being evaluated again.
+//
+// Only results against the current schema of the database are cached, and the
+// cache is cleared whenever a new schema is published.
+//
+// This class is thread-safe.
+class QueryResultCache {
+ public:
+  struct Key {
+    const Schema* schema = nullptr;
+    std::string sql;
+    // Names and values of the declared parameters, ordered by name.
+    std::vector<std::pair<std::string, zetasql::Value>> params;
+    absl::Time read_timestamp;
+
+    bool operator==(const Key& other) const {
+      return schema == other.schema && sql == other.sql &&
+             params == other.params && read_timestamp == other.read_timestamp;
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      h = H::combine(std::move(h), key.schema, key.sql, key.read_timestamp);
+      for (const auto& [name, value] : key.params) {
+        h = H::combine(std::move(h), name, value.HashCode());
+      }
+      return h;
+    }
+  };
+
+  // A capacity of zero disables the cache.
+  explicit QueryResultCache(int64_t capacity) : capacity_(capacity) {}
+
+  // Returns true if results can be cached at all.
+  bool enabled() const { return capacity_ > 0; }
+
+  // Sets the current schema, clearing the cache if it changed.
+  void SetSchema(const Schema* schema) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the cached result for `key`, or nullptr on a miss.
+  std::shared_ptr<const CachedQueryResult> Lookup(const Key& key)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Inserts `result` as the most recently used entry, evicting the least
+  // recently used entry if the cache is full. Results against a schema which is
+  // no longer current are dropped.
+  void Insert(const Key& key, std::shared_ptr<const CachedQueryResult> result)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of cached results.
+  int64_t size() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of calls to Lookup() which found a result.
+  int64_t hits() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  using Entries =
+      std::list<std::pair<Key, std::shared_ptr<const CachedQueryResult>>>;
+
+  // Maximum number of cached results.
+  const int64_t capacity_;
+
+  mutable absl::Mutex mu_;
+
+  // The schema which results are currently cached for.
+  const Schema* schema_ ABSL_GUARDED_BY(mu_) = nullptr;
+
+  // Cached results, most recently used first.
+  Entries entries_ ABSL_GUARDED_BY(mu_);
+
+  // Index of entries_ by key.
+  absl::flat_hash_map<Key, Entries::iterator> index_ ABSL_GUARDED_BY(mu_);
+
+  int64_t hits_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_RESULT_CACHE_H_
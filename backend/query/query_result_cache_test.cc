@@ -0,0 +1,148 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/query/query_result_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "backend/schema/catalog/schema.h"
+#include "tests/common/schema_constructor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+class QueryResultCacheTest : public testing::Test {
+ protected:
+  QueryResultCache::Key MakeKey(const Schema* schema, const std::string& sql,
+                                absl::Time read_timestamp) {
+    QueryResultCache::Key key;
+    key.schema = schema;
+    key.sql = sql;
+    key.read_timestamp = read_timestamp;
+    return key;
+  }
+
+  std::shared_ptr<const CachedQueryResult> MakeResult(int64_t value) {
+    auto result = std::make_shared<CachedQueryResult>();
+    result->column_names = {"c"};
+    result->column_types = {zetasql::types::Int64Type()};
+    result->rows = {{zetasql::values::Int64(value)}};
+    return result;
+  }
+
+  zetasql::TypeFactory type_factory_;
+  std::unique_ptr<const Schema> schema_ =
+      test::CreateSchemaWithOneTable(&type_factory_);
+  std::unique_ptr<const Schema> other_schema_ =
+      test::CreateSchemaWithMultiTables(&type_factory_);
+  absl::Time t1_ = absl::FromUnixSeconds(1);
+  absl::Time t2_ = absl::FromUnixSeconds(2);
+};
+
+TEST_F(QueryResultCacheTest, LookupReturnsInsertedResults) {
+  QueryResultCache cache(/*capacity=*/2);
+  cache.SetSchema(schema_.get());
+  QueryResultCache::Key key = MakeKey(schema_.get(), "SELECT 1", t1_);
+
+  EXPECT_EQ(cache.Lookup(key), nullptr);
+  std::shared_ptr<const CachedQueryResult> result = MakeResult(1);
+  cache.Insert(key, result);
+  EXPECT_EQ(cache.size(), 1);
+
+  // Results are shared between executions.
+  EXPECT_EQ(cache.Lookup(key), result);
+  EXPECT_EQ(cache.Lookup(key), result);
+  EXPECT_EQ(cache.hits(), 2);
+}
+
+TEST_F(QueryResultCacheTest, KeysDifferByReadTimestampAndParameters) {
+  QueryResultCache cache(/*capacity=*/4);
+  cache.SetSchema(schema_.get());
+  QueryResultCache::Key key = MakeKey(schema_.get(), "SELECT @p", t1_);
+  key.params.emplace_back("p", zetasql::values::Int64(1));
+  cache.Insert(key, MakeResult(1));
+
+  QueryResultCache::Key other_timestamp = key;
+  other_timestamp.read_timestamp = t2_;
+  EXPECT_EQ(cache.Lookup(other_timestamp), nullptr);
+
+  QueryResultCache::Key other_value = key;
+  other_value.params[0].second = zetasql::values::Int64(2);
+  EXPECT_EQ(cache.Lookup(other_value), nullptr);
+
+  QueryResultCache::Key same = key;
+  EXPECT_NE(cache.Lookup(same), nullptr);
+}
+
+TEST_F(QueryResultCacheTest, EvictsLeastRecentlyUsedResult) {
+  QueryResultCache cache(/*capacity=*/2);
+  cache.SetSchema(schema_.get());
+  QueryResultCache::Key key1 = MakeKey(schema_.get(), "SELECT 1", t1_);
+  QueryResultCache::Key key2 = MakeKey(schema_.get(), "SELECT 2", t1_);
+  QueryResultCache::Key key3 = MakeKey(schema_.get(), "SELECT 3", t1_);
+
+  cache.Insert(key1, MakeResult(1));
+  cache.Insert(key2, MakeResult(2));
+  // Looking up key1 makes key2 the least recently used entry.
+  EXPECT_NE(cache.Lookup(key1), nullptr);
+  cache.Insert(key3, MakeResult(3));
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.Lookup(key2), nullptr);
+  EXPECT_NE(cache.Lookup(key1), nullptr);
+  EXPECT_NE(cache.Lookup(key3), nullptr);
+}
+
+TEST_F(QueryResultCacheTest, NewSchemaInvalidatesCachedResults) {
+  QueryResultCache cache(/*capacity=*/2);
+  cache.SetSchema(schema_.get());
+  QueryResultCache::Key key = MakeKey(schema_.get(), "SELECT 1", t1_);
+  cache.Insert(key, MakeResult(1));
+
+  cache.SetSchema(other_schema_.get());
+  EXPECT_EQ(cache.size(), 0);
+
+  // Results against the old schema are dropped on insertion.
+  cache.Insert(key, MakeResult(1));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(QueryResultCacheTest, ZeroCapacityDisablesCaching) {
+  QueryResultCache cache(/*capacity=*/0);
+  cache.SetSchema(schema_.get());
+  EXPECT_FALSE(cache.enabled());
+  QueryResultCache::Key key = MakeKey(schema_.get(), "SELECT 1", t1_);
+  cache.Insert(key, MakeResult(1));
+  EXPECT_EQ(cache.Lookup(key), nullptr);
+}
+
+}  // namespace
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -402,6 +402,49 @@ absl::Status CheckAllowedCasts(const zetasql::Type* from_type,
   return absl::OkStatus();
 }
 
+// Enforces restrictions on reading tables/columns containing pending commit
+// timestamps tracked by `commit_timestamp_tracker`, which may be null.
+absl::Status CheckPendingCommitTimestampReadsOfScan(
+    const CommitTimestampTracker* commit_timestamp_tracker,
+    const zetasql::ResolvedTableScan* table_scan,
+    absl::Span<const zetasql::ResolvedStatement::ObjectAccess> access_list =
+        {}) {
+  ZETASQL_RET_CHECK(access_list.empty() ||
+            access_list.size() == table_scan->column_index_list_size());
+  // A commit timestamp tracker is not always present (e.g. read-only txns).
+  if (commit_timestamp_tracker == nullptr) {
+    return absl::OkStatus();
+  }
+
+  // Any table in the user schema will be a QueryableTable. We use this property
+  // to skip table scans against system tables (e.g. information_schema.tables)
+  // since these tables do not have corresponding backend schema nodes.
+  //
+  // Skipping these tables is safe because they are not writable and do not
+  // contain commit timestamps (pending or otherwise).
+  if (!table_scan->table()->Is<QueryableTable>()) {
+    return absl::OkStatus();
+  }
+
+  const Table* table =
+      table_scan->table()->GetAs<QueryableTable>()->wrapped_table();
+  ZETASQL_RET_CHECK(table != nullptr);
+  std::vector<const Column*> columns;
+  for (int i = 0; i < table_scan->column_index_list_size(); ++i) {
+    // Ignore scan columns which are not read
+    if (i < access_list.size() &&
+        !(access_list[i] & zetasql::ResolvedStatement::READ)) {
+      continue;
+    }
+    int idx = table_scan->column_index_list(i);
+    std::string column_name = table_scan->table()->GetColumn(idx)->Name();
+    const Column* column = table->FindColumn(column_name);
+    ZETASQL_RET_CHECK(column != nullptr);
+    columns.push_back(column);
+  }
+  return commit_timestamp_tracker->CheckRead(table, columns);
+}
+
 }  // namespace
 
 absl::Status QueryValidator::DefaultVisit(const zetasql::ResolvedNode* node) {
@@ -552,40 +595,8 @@ absl::Status QueryValidator::VisitResolvedSampleScan(
 absl::Status QueryValidator::CheckPendingCommitTimestampReads(
     const zetasql::ResolvedTableScan* table_scan,
     absl::Span<const zetasql::ResolvedStatement::ObjectAccess> access_list) {
-  ZETASQL_RET_CHECK(access_list.empty() ||
-            access_list.size() == table_scan->column_index_list_size());
-  // A commit timestamp tracker is not always present (e.g. read-only txns).
-  if (context_.commit_timestamp_tracker == nullptr) {
-    return absl::OkStatus();
-  }
-
-  // Any table in the user schema will be a QueryableTable. We use this property
-  // to skip table scans against system tables (e.g. information_schema.tables)
-  // since these tables do not have corresponding backend schema nodes.
-  //
-  // Skipping these tables is safe because they are not writable and do not
-  // contain commit timestamps (pending or otherwise).
-  if (!table_scan->table()->Is<QueryableTable>()) {
-    return absl::OkStatus();
-  }
-
-  const Table* table =
-      table_scan->table()->GetAs<QueryableTable>()->wrapped_table();
-  ZETASQL_RET_CHECK(table != nullptr);
-  std::vector<const Column*> columns;
-  for (int i = 0; i < table_scan->column_index_list_size(); ++i) {
-    // Ignore scan columns which are not read
-    if (i < access_list.size() &&
-        !(access_list[i] & zetasql::ResolvedStatement::READ)) {
-      continue;
-    }
-    int idx = table_scan->column_index_list(i);
-    std::string column_name = table_scan->table()->GetColumn(idx)->Name();
-    const Column* column = table->FindColumn(column_name);
-    ZETASQL_RET_CHECK(column != nullptr);
-    columns.push_back(column);
-  }
-  return context_.commit_timestamp_tracker->CheckRead(table, columns);
+  return CheckPendingCommitTimestampReadsOfScan(
+      context_.commit_timestamp_tracker, table_scan, access_list);
 }
 
 absl::Status QueryValidator::VisitResolvedInsertStmt(
@@ -626,6 +637,45 @@ absl::Status QueryValidator::VisitResolvedTableScan(
   return DefaultVisit(node);
 }
 
+absl::Status PendingCommitTimestampReadValidator::VisitResolvedInsertStmt(
+    const zetasql::ResolvedInsertStmt* node) {
+  if (node->table_scan() != nullptr) {
+    dml_table_scans_.insert(node->table_scan());
+  }
+  return DefaultVisit(node);
+}
+
+absl::Status PendingCommitTimestampReadValidator::VisitResolvedUpdateStmt(
+    const zetasql::ResolvedUpdateStmt* node) {
+  if (node->table_scan() != nullptr) {
+    ZETASQL_RETURN_IF_ERROR(CheckPendingCommitTimestampReadsOfScan(
+        commit_timestamp_tracker_, node->table_scan(),
+        node->column_access_list()));
+    dml_table_scans_.insert(node->table_scan());
+  }
+  return DefaultVisit(node);
+}
+
+absl::Status PendingCommitTimestampReadValidator::VisitResolvedDeleteStmt(
+    const zetasql::ResolvedDeleteStmt* node) {
+  if (node->table_scan() != nullptr) {
+    ZETASQL_RETURN_IF_ERROR(CheckPendingCommitTimestampReadsOfScan(
+        commit_timestamp_tracker_, node->table_scan(),
+        node->column_access_list()));
+    dml_table_scans_.insert(node->table_scan());
+  }
+  return DefaultVisit(node);
+}
+
+absl::Status PendingCommitTimestampReadValidator::VisitResolvedTableScan(
+    const zetasql::ResolvedTableScan* node) {
+  if (!dml_table_scans_.contains(node)) {
+    ZETASQL_RETURN_IF_ERROR(CheckPendingCommitTimestampReadsOfScan(
+        commit_timestamp_tracker_, node));
+  }
+  return DefaultVisit(node);
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
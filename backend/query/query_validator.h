@@ -36,6 +36,7 @@
 #include "backend/query/query_engine_options.h"
 #include "backend/schema/catalog/index.h"
 #include "backend/schema/catalog/schema.h"
+#include "backend/transaction/commit_timestamp.h"
 
 namespace google {
 namespace spanner {
@@ -169,6 +170,37 @@ class QueryValidator : public zetasql::ResolvedASTVisitor {
   QueryEngineOptions* extracted_options_;
 };
 
+// Implements ResolvedASTVisitor to enforce only the restrictions on reading
+// tables/columns containing pending commit timestamps. These depend on the
+// writes of the transaction, so they are re-checked whenever a statement which
+// was validated by QueryValidator before is executed again.
+class PendingCommitTimestampReadValidator
+    : public zetasql::ResolvedASTVisitor {
+ public:
+  explicit PendingCommitTimestampReadValidator(
+      const CommitTimestampTracker* commit_timestamp_tracker)
+      : commit_timestamp_tracker_(commit_timestamp_tracker) {}
+
+ protected:
+  absl::Status VisitResolvedInsertStmt(
+      const zetasql::ResolvedInsertStmt* node) override;
+
+  absl::Status VisitResolvedUpdateStmt(
+      const zetasql::ResolvedUpdateStmt* node) override;
+
+  absl::Status VisitResolvedDeleteStmt(
+      const zetasql::ResolvedDeleteStmt* node) override;
+
+  absl::Status VisitResolvedTableScan(
+      const zetasql::ResolvedTableScan* node) override;
+
+ private:
+  const CommitTimestampTracker* commit_timestamp_tracker_;
+
+  // Table scans from DML statements, see QueryValidator.
+  absl::flat_hash_set<const zetasql::ResolvedTableScan*> dml_table_scans_;
+};
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -17,6 +17,7 @@
 #include "backend/query/queryable_table.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -30,6 +31,7 @@
 #include "zetasql/public/evaluator_table_iterator.h"
 #include "zetasql/public/types/type_factory.h"
 #include "zetasql/public/value.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
@@ -39,8 +41,13 @@
 #include "absl/strings/strip.h"  //
 #include "absl/types/span.h"
 #include "backend/access/read.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/query/access_path.h"
+#include "backend/query/parallel_row_cursor.h"
 #include "backend/query/queryable_column.h"
 #include "backend/schema/catalog/column.h"
+#include "common/config.h"
 #include "common/constants.h"
 #include "common/feature_flags.h"
 #include "absl/status/status.h"
@@ -51,56 +58,196 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
-// An implementation of EvaluatorTableIterator which wraps a RowCursor.
+// Number of rows in the first batch read by RowCursorEvaluatorTableIterator.
+// Later batches double in size up to kRowCursorBatchSize.
+constexpr int64_t kFirstTableIteratorBatchSize = 16;
+
+// An implementation of EvaluatorTableIterator which reads the table through a
+// RowReader.
+//
+// The read is only issued on the first call to NextRow so that column filters
+// set by the evaluator through SetColumnFilterMap can choose a narrower access
+// path than a full table scan (see ChooseAccessPath).
 //
 // Used by QueryableTable::CreateEvaluatorTableIterator.
 class RowCursorEvaluatorTableIterator
     : public zetasql::EvaluatorTableIterator {
  public:
-  explicit RowCursorEvaluatorTableIterator(std::unique_ptr<RowCursor> cursor)
-      : cursor_(std::move(cursor)) {
-    values_.reserve(cursor_->NumColumns());
-    for (int i = 0; i < cursor_->NumColumns(); ++i) {
-      values_.push_back(zetasql::values::Null(cursor_->ColumnType(i)));
+  // `columns` are the table columns read by this iterator. Filters are not
+  // pushed down if `columns` is empty, or if `read_arg` reads a sample, which
+  // must be drawn from all the rows of the table.
+  RowCursorEvaluatorTableIterator(const backend::Table* table,
+                                  RowReader* reader, ReadArg read_arg,
+                                  std::vector<const zetasql::Type*> column_types,
+                                  std::vector<const Column*> columns)
+      : table_(table),
+        reader_(reader),
+        read_arg_(std::move(read_arg)),
+        column_types_(std::move(column_types)),
+        columns_(std::move(columns)) {
+    null_values_.reserve(column_types_.size());
+    for (const zetasql::Type* type : column_types_) {
+      null_values_.push_back(zetasql::values::Null(type));
     }
   }
 
-  int NumColumns() const override { return cursor_->NumColumns(); }
+  int NumColumns() const override { return column_types_.size(); }
 
   std::string GetColumnName(int i) const override {
-    return cursor_->ColumnName(i);
+    return read_arg_.columns[i];
   }
 
   const zetasql::Type* GetColumnType(int i) const override {
-    return cursor_->ColumnType(i);
+    return column_types_[i];
+  }
+
+  absl::Status SetColumnFilterMap(
+      absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>>
+          filter_map) override {
+    // Filters are only hints, so they can be ignored once reading started.
+    if (cursor_ != nullptr || columns_.empty() ||
+        read_arg_.sample.has_value()) {
+      return absl::OkStatus();
+    }
+    ColumnFilters filters;
+    for (const auto& [idx, filter] : filter_map) {
+      if (idx >= 0 && idx < columns_.size()) {
+        filters[columns_[idx]] = filter.get();
+      }
+    }
+    access_path_ = ChooseAccessPath(table_, filters);
+    return absl::OkStatus();
   }
 
   bool NextRow() override {
-    if (cursor_->Next()) {
-      for (int i = 0; i < cursor_->NumColumns(); ++i) {
-        values_[i] = cursor_->ColumnValue(i);
+    if (cursor_ == nullptr) {
+      status_ = OpenCursor();
+      if (!status_.ok()) {
+        return false;
       }
+    }
+    if (++row_index_ < rows_.size()) {
       return true;
-    } else {
+    }
+    if (!cursor_->NextBatch(batch_size_, &rows_)) {
       return false;
     }
+    batch_size_ = std::min(2 * batch_size_, kRowCursorBatchSize);
+    row_index_ = 0;
+    return true;
   }
 
-  const zetasql::Value& GetValue(int i) const override { return values_[i]; }
+  const zetasql::Value& GetValue(int i) const override {
+    if (row_index_ >= rows_.size()) {
+      return null_values_[i];
+    }
+    return rows_[row_index_][i];
+  }
 
-  absl::Status Status() const override { return cursor_->Status(); }
+  absl::Status Status() const override {
+    if (!status_.ok() || cursor_ == nullptr) {
+      return status_;
+    }
+    return cursor_->Status();
+  }
 
   // Cancel is best-effort and not required.
   absl::Status Cancel() override { return absl::OkStatus(); }
 
  private:
-  // The wrapped RowCursor.
+  // Issues the read along the chosen access path.
+  absl::Status OpenCursor() {
+    if (access_path_.index == nullptr) {
+      read_arg_.key_set = access_path_.key_set;
+      return ReadTable();
+    }
+
+    // Read the primary keys of the matching rows from the index, then read the
+    // rows themselves from the table.
+    ReadArg index_read_arg;
+    index_read_arg.table = read_arg_.table;
+    index_read_arg.index = access_path_.index->Name();
+    index_read_arg.key_set = access_path_.key_set;
+    index_read_arg.allow_pending_commit_timestamps =
+        read_arg_.allow_pending_commit_timestamps;
+    for (const KeyColumn* key_column : table_->primary_key()) {
+      index_read_arg.columns.push_back(key_column->column()->Name());
+    }
+    std::unique_ptr<RowCursor> index_cursor;
+    ZETASQL_RETURN_IF_ERROR(reader_->Read(index_read_arg, &index_cursor));
+    KeySet key_set;
+    while (index_cursor->Next()) {
+      Key key;
+      for (int i = 0; i < index_cursor->NumColumns(); ++i) {
+        key.AddColumn(index_cursor->ColumnValue(i));
+      }
+      key_set.AddKey(key);
+    }
+    ZETASQL_RETURN_IF_ERROR(index_cursor->Status());
+    read_arg_.key_set = std::move(key_set);
+    return reader_->Read(read_arg_, &cursor_);
+  }
+
+  // Reads the key ranges of the table on several threads if the reader
+  // supports it, and in a single read otherwise.
+  absl::Status ReadTable() {
+    const int num_threads = config::query_scan_threads();
+    // A sample is drawn over the whole read, so it is not split.
+    if (num_threads > 1 && !read_arg_.sample.has_value()) {
+      std::vector<std::unique_ptr<RowCursor>> cursors;
+      ZETASQL_RETURN_IF_ERROR(reader_->ReadSplits(
+          read_arg_, config::query_scan_rows_per_range(), &cursors));
+      if (cursors.size() == 1) {
+        cursor_ = std::move(cursors[0]);
+        return absl::OkStatus();
+      }
+      if (cursors.size() > 1) {
+        cursor_ = std::make_unique<ParallelRowCursor>(std::move(cursors),
+                                                      num_threads);
+        return absl::OkStatus();
+      }
+    }
+    return reader_->Read(read_arg_, &cursor_);
+  }
+
+  // The table being read.
+  const backend::Table* table_;
+
+  // The reader through which the table is read.
+  RowReader* reader_;
+
+  // The read to issue. Its key set is determined by the access path.
+  ReadArg read_arg_;
+
+  // Types of the columns of this iterator.
+  std::vector<const zetasql::Type*> column_types_;
+
+  // Table columns read by this iterator.
+  std::vector<const Column*> columns_;
+
+  // The access path chosen from the column filters. A full table scan unless
+  // SetColumnFilterMap chooses otherwise.
+  AccessPath access_path_;
+
+  // The cursor over the rows read, opened on the first call to NextRow.
   std::unique_ptr<RowCursor> cursor_;
 
-  // Values of the current row. EvaluatorTableIterator::GetValue need to return
-  // a reference so we need to buffer the values instead of simply delegate to
+  // Status of opening the cursor.
+  absl::Status status_;
+
+  // Rows of the current batch read from the cursor, and the index of the
+  // current row in it. EvaluatorTableIterator::GetValue needs to return a
+  // reference so we need to buffer the values instead of simply delegate to
   // RowCursor::ColumnValue.
-  std::vector<zetasql::Value> values_;
+  std::vector<std::vector<zetasql::Value>> rows_;
+  int64_t row_index_ = 0;
+
+  // Number of rows to read in the next batch. Batches start small so that
+  // queries which stop early (e.g. at a LIMIT) do not read far ahead.
+  int64_t batch_size_ = kFirstTableIteratorBatchSize;
+
+  // Values returned by GetValue when there is no current row.
+  std::vector<zetasql::Value> null_values_;
 };
 
 absl::StatusOr<std::unique_ptr<const zetasql::AnalyzerOutput>>
@@ -191,11 +338,25 @@ QueryableTable::QueryableTable(
 absl::StatusOr<std::unique_ptr<zetasql::EvaluatorTableIterator>>
 QueryableTable::CreateEvaluatorTableIterator(
     absl::Span<const int> column_idxs) const {
+  return CreateIterator(column_idxs, std::nullopt);
+}
+
+absl::StatusOr<std::unique_ptr<zetasql::EvaluatorTableIterator>>
+QueryableTable::CreateSampledEvaluatorTableIterator(
+    absl::Span<const int> column_idxs, const RowSample& sample) const {
+  return CreateIterator(column_idxs, sample);
+}
+
+absl::StatusOr<std::unique_ptr<zetasql::EvaluatorTableIterator>>
+QueryableTable::CreateIterator(absl::Span<const int> column_idxs,
+                               const std::optional<RowSample>& sample) const {
   ZETASQL_RET_CHECK_NE(reader_, nullptr);
 
   std::vector<std::string> column_names;
+  std::vector<const zetasql::Type*> column_types;
   for (int idx : column_idxs) {
     column_names.push_back(GetColumn(idx)->Name());
+    column_types.push_back(GetColumn(idx)->GetType());
   }
 
   ReadArg read_arg;
@@ -207,10 +368,19 @@ QueryableTable::CreateEvaluatorTableIterator(
   // Furthermore, without enabling this certain internal reads issued by the
   // ZetaSQL reference implementation will be rejected.
   read_arg.allow_pending_commit_timestamps = true;
+  read_arg.sample = sample;
+
+  // Filters on the columns read can be used to choose an access path.
+  std::vector<const Column*> columns;
+  for (int idx : column_idxs) {
+    columns.push_back(columns_[idx]->wrapped_column());
+  }
 
   // If current table is a change stream internal data/partition table, change
-  // the read arg to access internal tables directly.
+  // the read arg to access internal tables directly. Filters are not pushed
+  // down for these tables.
   if (wrapped_table_->owner_change_stream() != nullptr) {
+    columns.clear();
     absl::string_view change_stream_name = read_arg.table;
     if (absl::StartsWith(read_arg.table, kChangeStreamPartitionTablePrefix)) {
       absl::ConsumePrefix(&change_stream_name,
@@ -221,9 +391,12 @@ QueryableTable::CreateEvaluatorTableIterator(
       read_arg.change_stream_for_data_table = change_stream_name;
     }
   }
-  std::unique_ptr<RowCursor> cursor;
-  ZETASQL_RETURN_IF_ERROR(reader_->Read(read_arg, &cursor));
-  return std::make_unique<RowCursorEvaluatorTableIterator>(std::move(cursor));
+  // The columns were resolved against the query's schema, which the reader
+  // reads, so the reader does not need to look them up again.
+  read_arg.resolved_columns = columns;
+  return std::make_unique<RowCursorEvaluatorTableIterator>(
+      wrapped_table_, reader_, std::move(read_arg), std::move(column_types),
+      std::move(columns));
 }
 
 const zetasql::Column* QueryableTable::FindColumnByName(
@@ -29,6 +29,7 @@
 #include "backend/query/queryable_column.h"
 #include "backend/schema/catalog/change_stream.h"
 #include "backend/schema/catalog/table.h"
+#include "backend/storage/row_sampler.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -76,7 +77,18 @@ class QueryableTable : public zetasql::Table {
   CreateEvaluatorTableIterator(
       absl::Span<const int> column_idxs) const override;
 
+  // Like CreateEvaluatorTableIterator, but the iterator only returns a random
+  // `sample` of the rows of the table, which the storage draws without reading
+  // the other rows.
+  absl::StatusOr<std::unique_ptr<zetasql::EvaluatorTableIterator>>
+  CreateSampledEvaluatorTableIterator(absl::Span<const int> column_idxs,
+                                      const RowSample& sample) const;
+
  private:
+  absl::StatusOr<std::unique_ptr<zetasql::EvaluatorTableIterator>>
+  CreateIterator(absl::Span<const int> column_idxs,
+                 const std::optional<RowSample>& sample) const;
+
   absl::StatusOr<std::unique_ptr<const zetasql::AnalyzerOutput>>
   AnalyzeColumnExpression(
       const Column* column, zetasql::TypeFactory* type_factory,
@@ -17,13 +17,22 @@
 #include "backend/query/queryable_table.h"
 
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "zetasql/public/evaluator_table_iterator.h"
 #include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "backend/access/read.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/datamodel/key_set.h"
 #include "backend/query/catalog.h"
 #include "backend/query/queryable_column.h"
 #include "tests/common/row_cursor.h"
@@ -39,10 +48,45 @@ namespace {
 
 using testing::ElementsAre;
 
+// A RowReader which records the reads it served.
+class RecordingRowReader : public RowReader {
+ public:
+  explicit RecordingRowReader(RowReader* reader) : reader_(reader) {}
+
+  absl::Status Read(const ReadArg& read_arg,
+                    std::unique_ptr<RowCursor>* cursor) override {
+    read_args_.push_back(read_arg);
+    return reader_->Read(read_arg, cursor);
+  }
+
+  const std::vector<ReadArg>& read_args() const { return read_args_; }
+
+ private:
+  RowReader* reader_;
+  std::vector<ReadArg> read_args_;
+};
+
 class QueryableTableTest : public testing::Test {
  public:
   const Schema* schema() { return schema_.get(); }
   RowReader* reader() { return &reader_; }
+  RecordingRowReader* recording_reader() { return &recording_reader_; }
+
+  // Reads the given columns of test_table with the given column filters and
+  // returns the key set which was read.
+  std::string ReadKeySetWithFilters(
+      absl::Span<const int> column_idxs,
+      absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>>
+          filter_map) {
+    QueryableTable table{schema()->FindTable("test_table"),
+                         recording_reader()};
+    auto iterator = table.CreateEvaluatorTableIterator(column_idxs).value();
+    ZETASQL_EXPECT_OK(iterator->SetColumnFilterMap(std::move(filter_map)));
+    while (iterator->NextRow()) {
+    }
+    ZETASQL_EXPECT_OK(iterator->Status());
+    return recording_reader()->read_args().back().key_set.DebugString();
+  }
 
  private:
   zetasql::TypeFactory type_factory_;
@@ -53,6 +97,7 @@ class QueryableTableTest : public testing::Test {
         {{"int64_col", "string_col"},
          {zetasql::types::Int64Type(), zetasql::types::StringType()},
          {{zetasql::values::Int64(42), zetasql::values::String("foo")}}}}}};
+  RecordingRowReader recording_reader_{&reader_};
 };
 
 TEST_F(QueryableTableTest, FindColumnByName) {
@@ -114,6 +159,62 @@ TEST_F(QueryableTableTest, CreateEvaluatorTableIteratorWithAllColumns) {
   ASSERT_FALSE(iterator->NextRow());
 }
 
+TEST_F(QueryableTableTest, EqualityFilterOnKeyIsPushedDownAsPointRead) {
+  absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>> filters;
+  filters[0] = std::make_unique<zetasql::ColumnFilter>(
+      zetasql::values::Int64(42), zetasql::values::Int64(42));
+  EXPECT_EQ(ReadKeySetWithFilters({0, 1}, std::move(filters)),
+            KeySet(Key({zetasql::values::Int64(42)})).DebugString());
+}
+
+TEST_F(QueryableTableTest, InListFilterOnKeyIsPushedDownAsPointReads) {
+  absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>> filters;
+  // Index 1 refers to int64_col among the columns of the iterator.
+  filters[1] = std::make_unique<zetasql::ColumnFilter>(
+      std::vector<zetasql::Value>{zetasql::values::Int64(1),
+                                    zetasql::values::Int64(42)});
+  KeySet expected;
+  expected.AddKey(Key({zetasql::values::Int64(1)}));
+  expected.AddKey(Key({zetasql::values::Int64(42)}));
+  EXPECT_EQ(ReadKeySetWithFilters({1, 0}, std::move(filters)),
+            expected.DebugString());
+}
+
+TEST_F(QueryableTableTest, RangeFilterOnKeyIsPushedDownAsRangeRead) {
+  absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>> filters;
+  filters[0] = std::make_unique<zetasql::ColumnFilter>(
+      zetasql::values::Int64(10), zetasql::Value());
+  EXPECT_EQ(ReadKeySetWithFilters({0}, std::move(filters)),
+            KeySet(KeyRange::ClosedClosed(Key({zetasql::values::Int64(10)}),
+                                          Key()))
+                .DebugString());
+}
+
+TEST_F(QueryableTableTest, FilterOnIndexedColumnReadsThroughIndex) {
+  absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>> filters;
+  // Index 0 refers to string_col among the columns of the iterator, which is
+  // the key of test_index.
+  filters[0] = std::make_unique<zetasql::ColumnFilter>(
+      zetasql::values::String("foo"), zetasql::values::String("foo"));
+  EXPECT_EQ(ReadKeySetWithFilters({1}, std::move(filters)),
+            KeySet(Key({zetasql::values::Int64(42)})).DebugString());
+
+  // The table read is preceded by a bounded read of the index.
+  const std::vector<ReadArg>& read_args = recording_reader()->read_args();
+  ASSERT_EQ(read_args.size(), 2);
+  EXPECT_EQ(read_args[0].index, "test_index");
+  EXPECT_THAT(read_args[0].columns, ElementsAre("int64_col"));
+  EXPECT_EQ(read_args[0].key_set.DebugString(),
+            KeySet(KeyRange::Prefix(Key({zetasql::values::String("foo")})))
+                .DebugString());
+  EXPECT_TRUE(read_args[1].index.empty());
+}
+
+TEST_F(QueryableTableTest, UnfilteredReadScansTable) {
+  EXPECT_EQ(ReadKeySetWithFilters({0, 1}, {}), KeySet::All().DebugString());
+  EXPECT_EQ(recording_reader()->read_args().size(), 1);
+}
+
 }  // namespace
 
 }  // namespace backend
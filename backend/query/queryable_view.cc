@@ -22,17 +22,25 @@
 #include <utility>
 #include <vector>
 
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/analyzer_options.h"
+#include "zetasql/public/analyzer_output.h"
 #include "zetasql/public/catalog.h"
 #include "zetasql/public/evaluator_table_iterator.h"
 #include "zetasql/public/simple_catalog.h"
 #include "zetasql/public/types/type.h"
+#include "zetasql/public/types/type_factory.h"
 #include "zetasql/public/value.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "zetasql/resolved_ast/resolved_node_kind.pb.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "backend/query/analyzer_options.h"
 #include "zetasql/base/ret_check.h"
 #include "zetasql/base/status_macros.h"
 
@@ -105,8 +113,13 @@ class ViewRowCursorEvaluatorTableIterator
 }  // namespace
 
 QueryableView::QueryableView(const backend::View* view,
-                             QueryEvaluator* query_evaluator)
-    : wrapped_view_(view), query_evaluator_(query_evaluator) {
+                             QueryEvaluator* query_evaluator,
+                             zetasql::Catalog* body_catalog,
+                             zetasql::TypeFactory* type_factory)
+    : wrapped_view_(view),
+      query_evaluator_(query_evaluator),
+      body_catalog_(body_catalog),
+      type_factory_(type_factory) {
   for (const View::Column& column : view->columns()) {
     columns_.push_back(std::make_unique<const zetasql::SimpleColumn>(
         view->Name(), column.name, column.type,
@@ -124,6 +137,54 @@ QueryableView::CreateEvaluatorTableIterator(
       std::move(cursor), column_idxs);
 }
 
+const zetasql::ResolvedScan* QueryableView::view_query() const {
+  if (body_catalog_ == nullptr) {
+    return nullptr;
+  }
+  absl::MutexLock lock(&mu_);
+  if (!body_analyzed_) {
+    body_analyzed_ = true;
+    absl::StatusOr<std::unique_ptr<const zetasql::AnalyzerOutput>> output =
+        AnalyzeBody();
+    if (output.ok()) {
+      body_analyzer_output_ = *std::move(output);
+    }
+  }
+  if (body_analyzer_output_ == nullptr) {
+    return nullptr;
+  }
+  return body_analyzer_output_->resolved_statement()
+      ->GetAs<zetasql::ResolvedQueryStmt>()
+      ->query();
+}
+
+absl::StatusOr<std::unique_ptr<const zetasql::AnalyzerOutput>>
+QueryableView::AnalyzeBody() const {
+  zetasql::AnalyzerOptions options = MakeGoogleSqlAnalyzerOptions();
+  options.set_prune_unused_columns(true);
+  // Views referenced by the body are inlined into its analysis.
+  options.enable_rewrite(zetasql::REWRITE_INLINE_SQL_VIEWS);
+  std::unique_ptr<const zetasql::AnalyzerOutput> output;
+  ZETASQL_RETURN_IF_ERROR(zetasql::AnalyzeStatement(
+      wrapped_view_->body(), options, body_catalog_, type_factory_, &output));
+  ZETASQL_RET_CHECK_EQ(output->resolved_statement()->node_kind(),
+               zetasql::RESOLVED_QUERY_STMT);
+
+  // The scan replaces the view column by column, so its columns must be the
+  // output columns of the body, in the order of the view columns.
+  const auto* query_stmt =
+      output->resolved_statement()->GetAs<zetasql::ResolvedQueryStmt>();
+  const zetasql::ResolvedScan* scan = query_stmt->query();
+  ZETASQL_RET_CHECK_EQ(scan->column_list_size(), columns_.size());
+  ZETASQL_RET_CHECK_EQ(query_stmt->output_column_list_size(), columns_.size());
+  for (int i = 0; i < columns_.size(); ++i) {
+    const zetasql::ResolvedColumn& column = scan->column_list(i);
+    ZETASQL_RET_CHECK(column == query_stmt->output_column_list(i)->column());
+    ZETASQL_RET_CHECK(column.type()->Equals(columns_[i]->GetType()));
+  }
+  return output;
+}
+
 const zetasql::Column* QueryableView::FindColumnByName(
     const std::string& name) const {
   for (const auto& c : columns_) {
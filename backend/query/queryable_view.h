@@ -22,10 +22,16 @@
 #include <string>
 #include <vector>
 
+#include "zetasql/public/analyzer_output.h"
 #include "zetasql/public/catalog.h"
 #include "zetasql/public/evaluator_table_iterator.h"
 #include "zetasql/public/simple_catalog.h"
+#include "zetasql/public/sql_view.h"
+#include "zetasql/public/types/type_factory.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "backend/access/read.h"
 #include "backend/schema/catalog/view.h"
@@ -46,10 +52,19 @@ class QueryEvaluator {
 };
 
 // A wrapper over View class which implements the zetasql::Table interface.
-class QueryableView : public zetasql::Table {
+//
+// If constructed with a `body_catalog`, the view body is analyzed against it on
+// first use, and statements analyzed with REWRITE_INLINE_SQL_VIEWS against the
+// same catalog have their references to the view replaced by the analyzed body.
+// Predicates on the view then apply to the scans of its base tables. Otherwise,
+// or if the body cannot be inlined, the view is evaluated through
+// `query_evaluator` as an opaque query.
+class QueryableView : public zetasql::SQLView {
  public:
   QueryableView(const backend::View* view,
-                QueryEvaluator* query_evaluator = nullptr);
+                QueryEvaluator* query_evaluator = nullptr,
+                zetasql::Catalog* body_catalog = nullptr,
+                zetasql::TypeFactory* type_factory = nullptr);
 
   std::string Name() const override { return wrapped_view_->Name(); }
 
@@ -71,12 +86,29 @@ class QueryableView : public zetasql::Table {
 
   const backend::View* wrapped_view() const { return wrapped_view_; }
 
+  // Spanner only supports views with invoker's rights.
+  SqlSecurity sql_security() const override { return kSecurityInvoker; }
+
+  // Returns true if the view body was analyzed into a scan which can replace
+  // references to the view.
+  bool enable_view_inline() const override { return view_query() != nullptr; }
+
+  // Returns the analyzed view body, whose columns are the columns of the view
+  // in order, or null if the view cannot be inlined.
+  const zetasql::ResolvedScan* view_query() const override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
   // Override CreateEvaluatorTableIterator.
   absl::StatusOr<std::unique_ptr<zetasql::EvaluatorTableIterator>>
   CreateEvaluatorTableIterator(
       absl::Span<const int> column_idxs) const override;
 
  private:
+  // Analyzes the view body against `body_catalog_`. Returns an error if the
+  // body cannot replace references to the view.
+  absl::StatusOr<std::unique_ptr<const zetasql::AnalyzerOutput>> AnalyzeBody()
+      const;
+
   // The underlying View object which backs the QueryableView.
   const backend::View* wrapped_view_;
 
@@ -85,6 +117,18 @@ class QueryableView : public zetasql::Table {
 
   // Holds an object which is used to evaluate the view definition.
   QueryEvaluator* query_evaluator_;
+
+  // Catalog and type factory against which the view body is analyzed for
+  // inlining, or null if the view is not inlined.
+  zetasql::Catalog* body_catalog_;
+  zetasql::TypeFactory* type_factory_;
+
+  // The analysis of the view body, computed on first use and shared by all the
+  // statements analyzed against the catalog which owns this view.
+  mutable absl::Mutex mu_;
+  mutable bool body_analyzed_ ABSL_GUARDED_BY(mu_) = false;
+  mutable std::unique_ptr<const zetasql::AnalyzerOutput> body_analyzer_output_
+      ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace backend
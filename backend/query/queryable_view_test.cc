@@ -21,16 +21,24 @@
 #include <utility>
 #include <vector>
 
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/analyzer_options.h"
+#include "zetasql/public/analyzer_output.h"
 #include "zetasql/public/catalog.h"
 #include "zetasql/public/type.h"
 #include "zetasql/public/type.pb.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "zetasql/resolved_ast/resolved_node_kind.pb.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "backend/query/analyzer_options.h"
 #include "backend/query/catalog.h"
+#include "backend/query/function_catalog.h"
 #include "backend/query/queryable_column.h"
+#include "backend/schema/catalog/schema.h"
 #include "common/feature_flags.h"
 #include "tests/common/schema_constructor.h"
 #include "tests/common/scoped_feature_flags_setter.h"
@@ -72,6 +80,67 @@ TEST_F(QueryableViewTest, FindColumnByName) {
   EXPECT_EQ(view.FindColumnByName("int_col"), nullptr);
 }
 
+class InlinedViewTest : public testing::Test {
+ public:
+  InlinedViewTest()
+      : flag_setter_(EmulatorFeatureFlags::Flags{.enable_views = true}),
+        function_catalog_(&type_factory_),
+        schema_(test::CreateSchemaWithView(&type_factory_)),
+        catalog_(schema_.get(), &function_catalog_, &type_factory_) {}
+
+ protected:
+  absl::StatusOr<std::unique_ptr<const zetasql::AnalyzerOutput>> Analyze(
+      const std::string& sql) {
+    zetasql::AnalyzerOptions options = MakeGoogleSqlAnalyzerOptions();
+    options.enable_rewrite(zetasql::REWRITE_INLINE_SQL_VIEWS);
+    std::unique_ptr<const zetasql::AnalyzerOutput> output;
+    ZETASQL_RETURN_IF_ERROR(zetasql::AnalyzeStatement(sql, options, &catalog_,
+                                                &type_factory_, &output));
+    return output;
+  }
+
+  const QueryableView* FindView(const std::string& name) {
+    const zetasql::Table* table = nullptr;
+    ZETASQL_EXPECT_OK(catalog_.FindTable({name}, &table));
+    return dynamic_cast<const QueryableView*>(table);
+  }
+
+  test::ScopedEmulatorFeatureFlagsSetter flag_setter_;
+  zetasql::TypeFactory type_factory_;
+  const FunctionCatalog function_catalog_;
+  std::unique_ptr<const Schema> schema_;
+  Catalog catalog_;
+};
+
+TEST_F(InlinedViewTest, ReferencesToViewsScanTheBaseTables) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<const zetasql::AnalyzerOutput> output,
+      Analyze("SELECT col FROM test_view WHERE vcol = 3"));
+  std::vector<const zetasql::ResolvedNode*> scans;
+  output->resolved_statement()->GetDescendantsWithKinds(
+      {zetasql::RESOLVED_TABLE_SCAN}, &scans);
+  ASSERT_EQ(scans.size(), 1);
+  EXPECT_EQ(scans[0]->GetAs<zetasql::ResolvedTableScan>()->table()->Name(),
+            "test_table");
+}
+
+TEST_F(InlinedViewTest, ViewBodyIsAnalyzedOnce) {
+  const QueryableView* view = FindView("test_view");
+  ASSERT_NE(view, nullptr);
+  EXPECT_TRUE(view->enable_view_inline());
+  const zetasql::ResolvedScan* view_query = view->view_query();
+  ASSERT_NE(view_query, nullptr);
+  EXPECT_EQ(view_query->column_list_size(), view->NumColumns());
+  ZETASQL_ASSERT_OK(Analyze("SELECT vcol FROM test_view").status());
+  EXPECT_EQ(view->view_query(), view_query);
+}
+
+TEST_F(InlinedViewTest, ViewsWithoutBodyCatalogAreNotInlined) {
+  QueryableView view{schema_->FindView("test_view")};
+  EXPECT_FALSE(view.enable_view_inline());
+  EXPECT_EQ(view.view_query(), nullptr);
+}
+
 }  // namespace
 
 }  // namespace backend
@@ -16,13 +16,27 @@
 
 #include "backend/query/spanner_sys_catalog.h"
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "zetasql/public/catalog.h"
+#include "zetasql/public/evaluator_table_iterator.h"
 #include "zetasql/public/simple_catalog.h"
+#include "zetasql/public/types/type.h"
 #include "zetasql/public/value.h"
 #include "zetasql/base/no_destructor.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "backend/common/sys_stats.h"
 #include "backend/query/info_schema_columns_metadata_values.h"
 #include "backend/query/tables_from_metadata.h"
 
@@ -34,36 +48,162 @@ namespace backend {
 namespace {
 
 using ::zetasql::values::Bool;
+using ::zetasql::values::Bytes;
 using ::zetasql::values::Date;
+using ::zetasql::values::Double;
 using ::zetasql::values::Int64;
+using ::zetasql::values::String;
+using ::zetasql::values::StringArray;
+using ::zetasql::values::Timestamp;
 
 static constexpr char kSupportedOptimizerVersions[] =
     "SUPPORTED_OPTIMIZER_VERSIONS";
+static constexpr char kTableSizesStats1Hour[] = "TABLE_SIZES_STATS_1HOUR";
+static constexpr char kQueryStatsTopMinute[] = "QUERY_STATS_TOP_MINUTE";
+static constexpr char kTxnStatsTopMinute[] = "TXN_STATS_TOP_MINUTE";
+static constexpr char kLockStatsTopMinute[] = "LOCK_STATS_TOP_MINUTE";
 
 static const zetasql_base::NoDestructor<absl::flat_hash_set<std::string>>
     kSupportedTables{{
         kSupportedOptimizerVersions,
+        kTableSizesStats1Hour,
+        kQueryStatsTopMinute,
+        kTxnStatsTopMinute,
+        kLockStatsTopMinute,
     }};
+
+// Tables whose rows are computed when they are scanned.
+static const zetasql_base::NoDestructor<absl::flat_hash_set<std::string>>
+    kVolatileTables{{
+        kTableSizesStats1Hour,
+        kQueryStatsTopMinute,
+        kTxnStatsTopMinute,
+        kLockStatsTopMinute,
+    }};
+
+// The values of the columns of a row, by column name. Columns without a value
+// are NULL.
+using RowValues = absl::flat_hash_map<std::string, zetasql::Value>;
+
+// An EvaluatorTableIterator over rows computed upfront, which emits the
+// columns at the given indexes of each row.
+class RowsEvaluatorTableIterator : public zetasql::EvaluatorTableIterator {
+ public:
+  RowsEvaluatorTableIterator(const zetasql::Table* table,
+                             absl::Span<const int> column_idxs,
+                             std::vector<std::vector<zetasql::Value>> rows)
+      : table_(table),
+        column_idxs_(column_idxs.begin(), column_idxs.end()),
+        rows_(std::move(rows)) {}
+
+  int NumColumns() const override { return column_idxs_.size(); }
+
+  std::string GetColumnName(int i) const override {
+    return table_->GetColumn(column_idxs_[i])->Name();
+  }
+
+  const zetasql::Type* GetColumnType(int i) const override {
+    return table_->GetColumn(column_idxs_[i])->GetType();
+  }
+
+  bool NextRow() override { return ++pos_ < rows_.size(); }
+
+  const zetasql::Value& GetValue(int i) const override {
+    return rows_[pos_][column_idxs_[i]];
+  }
+
+  absl::Status Status() const override { return absl::OkStatus(); }
+  absl::Status Cancel() override { return absl::OkStatus(); }
+
+ private:
+  const zetasql::Table* table_;
+  const std::vector<int> column_idxs_;
+  const std::vector<std::vector<zetasql::Value>> rows_;
+  int pos_ = -1;
+};
+
+// Returns `value` as a value of the column `type`. FLOAT64 columns are mapped
+// to FLOAT columns (see kSpannerTypeToGSQLType), so DOUBLE values are narrowed
+// for them.
+zetasql::Value ToColumnType(const zetasql::Type* type, zetasql::Value value) {
+  if (type->IsFloat() && value.type()->IsDouble()) {
+    return value.is_null() ? zetasql::Value::NullFloat()
+                           : zetasql::Value::Float(value.double_value());
+  }
+  return value;
+}
+
+// Makes `table` report the rows returned by `rows_fn` whenever it is scanned.
+void SetRowsFn(zetasql::SimpleTable* table,
+               std::function<std::vector<RowValues>()> rows_fn) {
+  table->SetEvaluatorTableIteratorFactory(
+      [table, rows_fn = std::move(rows_fn)](absl::Span<const int> column_idxs)
+          -> absl::StatusOr<std::unique_ptr<zetasql::EvaluatorTableIterator>> {
+        std::vector<std::vector<zetasql::Value>> rows;
+        for (RowValues& values : rows_fn()) {
+          std::vector<zetasql::Value> row;
+          row.reserve(table->NumColumns());
+          for (int i = 0; i < table->NumColumns(); ++i) {
+            const zetasql::Column* column = table->GetColumn(i);
+            auto itr = values.find(column->Name());
+            row.push_back(itr == values.end()
+                              ? zetasql::Value::Null(column->GetType())
+                              : ToColumnType(column->GetType(),
+                                             std::move(itr->second)));
+          }
+          rows.push_back(std::move(row));
+        }
+        return std::make_unique<RowsEvaluatorTableIterator>(
+            table, column_idxs, std::move(rows));
+      });
+}
+
+// Returns the average of `total` over `count` values, or NULL if there are
+// none.
+zetasql::Value Average(double total, int64_t count) {
+  return count == 0 ? zetasql::Value::NullDouble() : Double(total / count);
+}
+
+zetasql::Value AverageSeconds(absl::Duration total, int64_t count) {
+  return Average(absl::ToDoubleSeconds(total), count);
+}
+
 }  // namespace
 
-SpannerSysCatalog::SpannerSysCatalog() : zetasql::SimpleCatalog(kName) {
+SpannerSysCatalog::SpannerSysCatalog(const SpannerSysStats* stats)
+    : zetasql::SimpleCatalog(kName) {
   // TODO: Use inheritance and pass SpannerSysColumnsMetadata
   // directly to AddTablesFromMetadata.
-  std::vector<ColumnsMetaEntry> columns;
-  for (const auto& column : SpannerSysColumnsMetadata()) {
-    columns.push_back({.table_name = column.table_name,
-                       .column_name = column.column_name,
-                       .is_nullable = column.is_nullable,
-                       .spanner_type = column.spanner_type});
-  }
+  static const zetasql_base::NoDestructor<std::vector<ColumnsMetaEntry>>
+      kColumns([] {
+        std::vector<ColumnsMetaEntry> columns;
+        for (const auto& column : SpannerSysColumnsMetadata()) {
+          columns.push_back({.table_name = column.table_name,
+                             .column_name = column.column_name,
+                             .is_nullable = column.is_nullable,
+                             .spanner_type = column.spanner_type});
+        }
+        return columns;
+      }());
 
-  tables_by_name_ = AddTablesFromMetadata(columns, *kSpannerTypeToGSQLType,
+  tables_by_name_ = AddTablesFromMetadata(*kColumns, *kSpannerTypeToGSQLType,
                                           *kSupportedTables);
   for (auto& [name, table] : tables_by_name_) {
     AddTable(table.get());
   }
 
   FillOptimizerVersionsTable();
+  if (stats != nullptr) {
+    FillTableSizesTable(stats);
+    FillQueryStatsTable(stats);
+    FillTransactionStatsTable(stats);
+    FillLockStatsTable(stats);
+  }
+}
+
+bool SpannerSysCatalog::IsVolatileTable(const zetasql::Table* table) {
+  return dynamic_cast<const zetasql::SimpleTable*>(table) != nullptr &&
+         kVolatileTables->contains(table->Name());
 }
 
 void SpannerSysCatalog::FillOptimizerVersionsTable() {
@@ -80,6 +220,110 @@ void SpannerSysCatalog::FillOptimizerVersionsTable() {
   table->SetContents(rows);
 }
 
+void SpannerSysCatalog::FillTableSizesTable(const SpannerSysStats* stats) {
+  if (!stats->table_sizes) {
+    return;
+  }
+  SetRowsFn(tables_by_name_.at(kTableSizesStats1Hour).get(), [stats]() {
+    // Sizes are reported as of now, in the interval which ends at the last
+    // full hour.
+    absl::Time interval_end = absl::FromUnixSeconds(
+        absl::ToUnixSeconds(absl::Now()) / 3600 * 3600);
+    std::vector<RowValues> rows;
+    for (const TableSize& size : stats->table_sizes()) {
+      rows.push_back({
+          {"INTERVAL_END", Timestamp(interval_end)},
+          {"TABLE_NAME", String(size.table_name)},
+          {"USED_BYTES", Double(size.used_bytes)},
+      });
+    }
+    return rows;
+  });
+}
+
+void SpannerSysCatalog::FillQueryStatsTable(const SpannerSysStats* stats) {
+  if (!stats->query_stats) {
+    return;
+  }
+  SetRowsFn(tables_by_name_.at(kQueryStatsTopMinute).get(), [stats]() {
+    std::vector<RowValues> rows;
+    for (const auto& [interval_end, entry] : stats->query_stats()) {
+      const int64_t succeeded = entry.execution_count - entry.failed_count;
+      rows.push_back({
+          {"INTERVAL_END", Timestamp(interval_end)},
+          {"TEXT", String(entry.text)},
+          {"TEXT_TRUNCATED", Bool(entry.text_truncated)},
+          {"TEXT_FINGERPRINT", Int64(entry.text_fingerprint)},
+          {"EXECUTION_COUNT", Int64(entry.execution_count)},
+          {"STATEMENT_COUNT", Int64(entry.execution_count)},
+          {"RUN_IN_RW_TRANSACTION_EXECUTION_COUNT",
+           Int64(entry.run_in_rw_transaction_count)},
+          {"AVG_LATENCY_SECONDS",
+           AverageSeconds(entry.total_latency, succeeded)},
+          {"AVG_ROWS", Average(entry.total_rows, succeeded)},
+          {"AVG_ROWS_WRITTEN", Average(entry.total_rows_written, succeeded)},
+          {"ALL_FAILED_EXECUTION_COUNT", Int64(entry.failed_count)},
+          {"ALL_FAILED_AVG_LATENCY_SECONDS",
+           AverageSeconds(entry.total_failed_latency, entry.failed_count)},
+          {"CANCELLED_OR_DISCONNECTED_EXECUTION_COUNT",
+           Int64(entry.cancelled_count)},
+          {"TIMED_OUT_EXECUTION_COUNT", Int64(entry.timed_out_count)},
+      });
+    }
+    return rows;
+  });
+}
+
+void SpannerSysCatalog::FillTransactionStatsTable(
+    const SpannerSysStats* stats) {
+  if (!stats->transaction_stats) {
+    return;
+  }
+  SetRowsFn(tables_by_name_.at(kTxnStatsTopMinute).get(), [stats]() {
+    std::vector<RowValues> rows;
+    for (const auto& [interval_end, entry] : stats->transaction_stats()) {
+      rows.push_back({
+          {"INTERVAL_END", Timestamp(interval_end)},
+          {"FPRINT", Int64(entry.fprint)},
+          {"READ_COLUMNS", StringArray(entry.read_columns)},
+          {"WRITE_CONSTRUCTIVE_COLUMNS",
+           StringArray(entry.write_constructive_columns)},
+          {"WRITE_DELETE_TABLES", StringArray(entry.write_delete_tables)},
+          {"ATTEMPT_COUNT", Int64(entry.commit_attempt_count)},
+          {"COMMIT_ATTEMPT_COUNT", Int64(entry.commit_attempt_count)},
+          {"COMMIT_ABORT_COUNT", Int64(entry.commit_abort_count)},
+          {"COMMIT_FAILED_PRECONDITION_COUNT",
+           Int64(entry.commit_failed_precondition_count)},
+          // All the data of the emulator is in a single split.
+          {"AVG_PARTICIPANTS", Double(1)},
+          {"AVG_TOTAL_LATENCY_SECONDS",
+           AverageSeconds(entry.total_latency, entry.commit_count)},
+          {"AVG_COMMIT_LATENCY_SECONDS",
+           AverageSeconds(entry.total_commit_latency, entry.commit_count)},
+      });
+    }
+    return rows;
+  });
+}
+
+void SpannerSysCatalog::FillLockStatsTable(const SpannerSysStats* stats) {
+  if (!stats->lock_stats) {
+    return;
+  }
+  SetRowsFn(tables_by_name_.at(kLockStatsTopMinute).get(), [stats]() {
+    std::vector<RowValues> rows;
+    for (const auto& [interval_end, entry] : stats->lock_stats()) {
+      rows.push_back({
+          {"INTERVAL_END", Timestamp(interval_end)},
+          {"ROW_RANGE_START_KEY", Bytes(entry.row_range_start_key)},
+          {"LOCK_WAIT_SECONDS",
+           Double(absl::ToDoubleSeconds(entry.total_lock_wait))},
+      });
+    }
+    return rows;
+  });
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
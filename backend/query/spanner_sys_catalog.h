@@ -17,22 +17,55 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_SPANNER_SYS_CATALOG_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_SPANNER_SYS_CATALOG_H_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "zetasql/public/catalog.h"
 #include "zetasql/public/simple_catalog.h"
 #include "absl/container/flat_hash_map.h"
+#include "backend/common/sys_stats.h"
 
 namespace google {
 namespace spanner {
 namespace emulator {
 namespace backend {
 
+// Approximate memory used by a table, index or change stream of a database.
+struct TableSize {
+  std::string table_name;
+  int64_t used_bytes = 0;
+};
+
+// Sources of the rows of the statistics tables of SPANNER_SYS. Each source is
+// called whenever its table is scanned. Tables without a source are empty.
+struct SpannerSysStats {
+  // Returns the current sizes of the tables of the database, reported in
+  // TABLE_SIZES_STATS_1HOUR.
+  std::function<std::vector<TableSize>()> table_sizes;
+
+  // Return the entries reported in QUERY_STATS_TOP_MINUTE, TXN_STATS_TOP_MINUTE
+  // and LOCK_STATS_TOP_MINUTE. The start keys of the lock statistics are
+  // reported as they are, so they should name the table of the key.
+  std::function<std::vector<IntervalEntry<QueryStatsEntry>>()> query_stats;
+  std::function<std::vector<IntervalEntry<TransactionStatsEntry>>()>
+      transaction_stats;
+  std::function<std::vector<IntervalEntry<LockStatsEntry>>()> lock_stats;
+};
+
 class SpannerSysCatalog : public zetasql::SimpleCatalog {
  public:
   static constexpr char kName[] = "SPANNER_SYS";
 
-  explicit SpannerSysCatalog();
+  // The statistics tables report the rows obtained from `stats` if it is set,
+  // and are empty otherwise. `stats` must outlive the catalog.
+  explicit SpannerSysCatalog(const SpannerSysStats* stats = nullptr);
+
+  // Returns true if the rows of `table` are computed when it is scanned, so
+  // that they may differ between scans at the same read timestamp.
+  static bool IsVolatileTable(const zetasql::Table* table);
 
  private:
   // Explicitly storing the tables because we are using SimpleCatalog::AddTable
@@ -41,6 +74,12 @@ class SpannerSysCatalog : public zetasql::SimpleCatalog {
       tables_by_name_;
 
   void FillOptimizerVersionsTable();
+
+  // Make the statistics tables report the rows obtained from `stats`.
+  void FillTableSizesTable(const SpannerSysStats* stats);
+  void FillQueryStatsTable(const SpannerSysStats* stats);
+  void FillTransactionStatsTable(const SpannerSysStats* stats);
+  void FillLockStatsTable(const SpannerSysStats* stats);
 };
 
 }  // namespace backend
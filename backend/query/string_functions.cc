@@ -0,0 +1,179 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/query/string_functions.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "zetasql/public/functions/like.h"
+#include "zetasql/public/functions/string.h"
+#include "zetasql/public/type.pb.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+#include "re2/re2.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// The high bit of each byte of a word.
+constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+
+// The LIKE wildcards and escape character.
+bool IsLikeSpecial(char c) { return c == '%' || c == '_' || c == '\\'; }
+
+}  // namespace
+
+bool IsAscii(absl::string_view str) {
+  const char* data = str.data();
+  size_t size = str.size();
+  // Accumulating the words and testing once lets the compiler vectorize the
+  // loop.
+  uint64_t bits = 0;
+  for (; size >= sizeof(uint64_t);
+       data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    bits |= word;
+  }
+  for (; size > 0; ++data, --size) {
+    bits |= static_cast<unsigned char>(*data);
+  }
+  return (bits & kHighBits) == 0;
+}
+
+absl::StatusOr<std::string> StringLower(absl::string_view str) {
+  if (IsAscii(str)) {
+    return absl::AsciiStrToLower(str);
+  }
+  std::string out;
+  absl::Status error;
+  if (!zetasql::functions::LowerUtf8(str, &out, &error)) {
+    return error;
+  }
+  return out;
+}
+
+absl::StatusOr<std::string> StringUpper(absl::string_view str) {
+  if (IsAscii(str)) {
+    return absl::AsciiStrToUpper(str);
+  }
+  std::string out;
+  absl::Status error;
+  if (!zetasql::functions::UpperUtf8(str, &out, &error)) {
+    return error;
+  }
+  return out;
+}
+
+absl::StatusOr<bool> StringStartsWith(absl::string_view str,
+                                      absl::string_view prefix) {
+  if (IsAscii(str) && IsAscii(prefix)) {
+    return absl::StartsWith(str, prefix);
+  }
+  bool out;
+  absl::Status error;
+  if (!zetasql::functions::StartsWithUtf8(str, prefix, &out, &error)) {
+    return error;
+  }
+  return out;
+}
+
+absl::StatusOr<int64_t> StringPosition(absl::string_view str,
+                                       absl::string_view substr) {
+  if (IsAscii(str) && IsAscii(substr)) {
+    size_t pos = str.find(substr);
+    return pos == absl::string_view::npos ? 0 : static_cast<int64_t>(pos) + 1;
+  }
+  int64_t out;
+  absl::Status error;
+  if (!zetasql::functions::StrposUtf8(str, substr, &out, &error)) {
+    return error;
+  }
+  return out;
+}
+
+absl::StatusOr<std::string> StringReplace(absl::string_view str,
+                                          absl::string_view from,
+                                          absl::string_view to) {
+  // Most calls replace nothing. Otherwise ReplaceUtf8 also enforces the limit
+  // on the size of the output.
+  if (IsAscii(str) && IsAscii(from) &&
+      (from.empty() || !absl::StrContains(str, from))) {
+    return std::string(str);
+  }
+  std::string out;
+  absl::Status error;
+  if (!zetasql::functions::ReplaceUtf8(str, from, to, &out, &error)) {
+    return error;
+  }
+  return out;
+}
+
+absl::StatusOr<LikeMatcher> LikeMatcher::Create(absl::string_view pattern) {
+  std::unique_ptr<RE2> regexp;
+  ZETASQL_RETURN_IF_ERROR(zetasql::functions::CreateLikeRegexp(
+      pattern, zetasql::TYPE_STRING, &regexp));
+  std::shared_ptr<const RE2> shared_regexp = std::move(regexp);
+
+  absl::string_view literal = pattern;
+  bool leading = absl::ConsumePrefix(&literal, "%");
+  bool trailing = absl::ConsumeSuffix(&literal, "%");
+  for (char c : literal) {
+    if (IsLikeSpecial(c)) {
+      return LikeMatcher(Kind::kRegexp, "", std::move(shared_regexp));
+    }
+  }
+  Kind kind = leading ? (trailing ? Kind::kContains : Kind::kEndsWith)
+                      : (trailing ? Kind::kStartsWith : Kind::kEquals);
+  return LikeMatcher(kind, std::string(literal), std::move(shared_regexp));
+}
+
+bool LikeMatcher::Matches(absl::string_view str) const {
+  if (kind_ == Kind::kRegexp || !IsAscii(str)) {
+    return RE2::FullMatch(str, *regexp_);
+  }
+  switch (kind_) {
+    case Kind::kEquals:
+      return str == literal_;
+    case Kind::kStartsWith:
+      return absl::StartsWith(str, literal_);
+    case Kind::kEndsWith:
+      return absl::EndsWith(str, literal_);
+    case Kind::kContains:
+      return absl::StrContains(str, literal_);
+    case Kind::kRegexp:
+      break;
+  }
+  return RE2::FullMatch(str, *regexp_);
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,87 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_STRING_FUNCTIONS_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_STRING_FUNCTIONS_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "re2/re2.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Implementations of the STRING signatures of LOWER, UPPER, STARTS_WITH,
+// STRPOS, REPLACE and LIKE for native evaluation of queries. Inputs which are
+// entirely ASCII take a fast path; any other input falls back to the
+// zetasql::functions implementations used by the reference evaluator, so that
+// the results and errors are the same as the reference evaluator's.
+
+// Returns true if every byte of `str` is ASCII. Checks 8 bytes at a time.
+bool IsAscii(absl::string_view str);
+
+absl::StatusOr<std::string> StringLower(absl::string_view str);
+absl::StatusOr<std::string> StringUpper(absl::string_view str);
+absl::StatusOr<bool> StringStartsWith(absl::string_view str,
+                                      absl::string_view prefix);
+
+// Returns the 1-based position in characters of the first occurrence of
+// `substr` in `str`, or 0 if there is none.
+absl::StatusOr<int64_t> StringPosition(absl::string_view str,
+                                       absl::string_view substr);
+
+absl::StatusOr<std::string> StringReplace(absl::string_view str,
+                                          absl::string_view from,
+                                          absl::string_view to);
+
+// A STRING LIKE pattern, compiled once to match many strings. Patterns whose
+// only wildcards are a leading or trailing '%' are matched as literal prefix,
+// suffix or substring comparisons; others are matched with the regular
+// expression ZetaSQL builds for the pattern.
+class LikeMatcher {
+ public:
+  // Returns an error if `pattern` is not a valid LIKE pattern.
+  static absl::StatusOr<LikeMatcher> Create(absl::string_view pattern);
+
+  bool Matches(absl::string_view str) const;
+
+ private:
+  enum class Kind { kEquals, kStartsWith, kEndsWith, kContains, kRegexp };
+
+  LikeMatcher(Kind kind, std::string literal, std::shared_ptr<const RE2> regexp)
+      : kind_(kind), literal_(std::move(literal)), regexp_(std::move(regexp)) {}
+
+  Kind kind_;
+  std::string literal_;
+  // Set for every pattern. The literal comparisons only match ASCII strings,
+  // whose characters are bytes; other strings are matched with the regexp.
+  std::shared_ptr<const RE2> regexp_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_STRING_FUNCTIONS_H_
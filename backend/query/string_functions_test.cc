@@ -0,0 +1,129 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/query/string_functions.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using ::zetasql_base::testing::IsOkAndHolds;
+
+TEST(StringFunctionsTest, IsAscii) {
+  EXPECT_TRUE(IsAscii(""));
+  EXPECT_TRUE(IsAscii("abc"));
+  EXPECT_TRUE(IsAscii(std::string(100, 'x')));
+  EXPECT_FALSE(IsAscii("caf\xc3\xa9"));
+  // Non-ASCII bytes are found both in whole words and in the remainder.
+  EXPECT_FALSE(IsAscii(std::string(16, 'x') + "\xc3\xa9"));
+  EXPECT_FALSE(IsAscii("\xc3\xa9" + std::string(16, 'x')));
+}
+
+TEST(StringFunctionsTest, LowerAndUpper) {
+  EXPECT_THAT(StringLower("Hello World"), IsOkAndHolds("hello world"));
+  EXPECT_THAT(StringUpper("Hello World"), IsOkAndHolds("HELLO WORLD"));
+  EXPECT_THAT(StringLower("\xc3\x89T\xc3\x89"),
+              IsOkAndHolds("\xc3\xa9t\xc3\xa9"));
+  EXPECT_THAT(StringUpper("\xc3\xa9t\xc3\xa9"),
+              IsOkAndHolds("\xc3\x89T\xc3\x89"));
+}
+
+TEST(StringFunctionsTest, StartsWith) {
+  EXPECT_THAT(StringStartsWith("prefix-rest", "prefix"), IsOkAndHolds(true));
+  EXPECT_THAT(StringStartsWith("prefix-rest", "rest"), IsOkAndHolds(false));
+  EXPECT_THAT(StringStartsWith("abc", ""), IsOkAndHolds(true));
+  EXPECT_THAT(StringStartsWith("\xc3\xa9t\xc3\xa9", "\xc3\xa9"),
+              IsOkAndHolds(true));
+}
+
+TEST(StringFunctionsTest, Position) {
+  EXPECT_THAT(StringPosition("hello", "l"), IsOkAndHolds(3));
+  EXPECT_THAT(StringPosition("hello", "x"), IsOkAndHolds(0));
+  EXPECT_THAT(StringPosition("hello", ""), IsOkAndHolds(1));
+  // Positions are in characters, not bytes.
+  EXPECT_THAT(StringPosition("\xc3\xa9t\xc3\xa9", "t"), IsOkAndHolds(2));
+}
+
+TEST(StringFunctionsTest, Replace) {
+  EXPECT_THAT(StringReplace("a-b-c", "-", "+"), IsOkAndHolds("a+b+c"));
+  EXPECT_THAT(StringReplace("a-b-c", "x", "+"), IsOkAndHolds("a-b-c"));
+  EXPECT_THAT(StringReplace("a-b-c", "", "+"), IsOkAndHolds("a-b-c"));
+  EXPECT_THAT(StringReplace("aaa", "aa", "b"), IsOkAndHolds("ba"));
+  EXPECT_THAT(StringReplace("\xc3\xa9t\xc3\xa9", "\xc3\xa9", "e"),
+              IsOkAndHolds("ete"));
+}
+
+TEST(StringFunctionsTest, LikeMatchesLiteralPatterns) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LikeMatcher equals, LikeMatcher::Create("abc"));
+  EXPECT_TRUE(equals.Matches("abc"));
+  EXPECT_FALSE(equals.Matches("abcd"));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LikeMatcher starts_with, LikeMatcher::Create("ab%"));
+  EXPECT_TRUE(starts_with.Matches("abc"));
+  EXPECT_FALSE(starts_with.Matches("cab"));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LikeMatcher ends_with, LikeMatcher::Create("%bc"));
+  EXPECT_TRUE(ends_with.Matches("abc"));
+  EXPECT_FALSE(ends_with.Matches("bca"));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LikeMatcher contains, LikeMatcher::Create("%b%"));
+  EXPECT_TRUE(contains.Matches("abc"));
+  EXPECT_FALSE(contains.Matches("ac"));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LikeMatcher any, LikeMatcher::Create("%"));
+  EXPECT_TRUE(any.Matches(""));
+  EXPECT_TRUE(any.Matches("\xc3\xa9"));
+}
+
+TEST(StringFunctionsTest, LikeMatchesOtherPatterns) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LikeMatcher underscore, LikeMatcher::Create("a_c"));
+  EXPECT_TRUE(underscore.Matches("abc"));
+  EXPECT_TRUE(underscore.Matches("a\xc3\xa9"
+                                 "c"));
+  EXPECT_FALSE(underscore.Matches("ac"));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LikeMatcher escaped, LikeMatcher::Create("100\\%"));
+  EXPECT_TRUE(escaped.Matches("100%"));
+  EXPECT_FALSE(escaped.Matches("1000"));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LikeMatcher middle, LikeMatcher::Create("a%c"));
+  EXPECT_TRUE(middle.Matches("abbbc"));
+  EXPECT_FALSE(middle.Matches("abbb"));
+
+  // Regexp characters in the pattern are literals.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LikeMatcher dot, LikeMatcher::Create("a.c%"));
+  EXPECT_TRUE(dot.Matches("a.cd"));
+  EXPECT_FALSE(dot.Matches("abcd"));
+}
+
+TEST(StringFunctionsTest, LikeRejectsInvalidPatterns) {
+  EXPECT_FALSE(LikeMatcher::Create("abc\\").ok());
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
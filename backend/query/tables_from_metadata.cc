@@ -25,6 +25,7 @@
 #include "zetasql/public/value.h"
 #include "absl/log/check.h"
 #include "absl/strings/match.h"
+#include "absl/types/span.h"
 
 namespace google {
 namespace spanner {
@@ -48,7 +49,7 @@ std::unique_ptr<zetasql::SimpleTable> MakeEmptyTable(
 
 absl::flat_hash_map<std::string, std::unique_ptr<zetasql::SimpleTable>>
 AddTablesFromMetadata(
-    const std::vector<ColumnsMetaEntry>& metadata_entries,
+    absl::Span<const ColumnsMetaEntry> metadata_entries,
     const absl::flat_hash_map<std::string, const zetasql::Type*>&
         spanner_to_gsql_type,
     const absl::flat_hash_set<std::string>& supported_tables) {
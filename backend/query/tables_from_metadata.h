@@ -27,6 +27,7 @@
 #include "zetasql/base/no_destructor.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "backend/query/info_schema_columns_metadata_values.h"
 #include "third_party/spanner_pg/datatypes/extended/pg_oid_type.h"
 
@@ -40,7 +41,9 @@ namespace backend {
 static const zetasql_base::NoDestructor<
     absl::flat_hash_map<std::string, const zetasql::Type*>>
     kSpannerTypeToGSQLType{{
+        {"ARRAY<STRING(MAX)>", zetasql::types::StringArrayType()},
         {"BOOL", zetasql::types::BoolType()},
+        {"BYTES(MAX)", zetasql::types::BytesType()},
         {"DATE", zetasql::types::DateType()},
         {"INT64", zetasql::types::Int64Type()},
         {"FLOAT64", zetasql::types::FloatType()},
@@ -74,7 +77,7 @@ static const zetasql_base::NoDestructor<
 // is returned. The metadata entries must be ordered by table name.
 absl::flat_hash_map<std::string, std::unique_ptr<zetasql::SimpleTable>>
 AddTablesFromMetadata(
-    const std::vector<ColumnsMetaEntry>& metadata_entries,
+    absl::Span<const ColumnsMetaEntry> metadata_entries,
     const absl::flat_hash_map<std::string, const zetasql::Type*>&
         spanner_to_gsql_type,
     const absl::flat_hash_set<std::string>& supported_tables);
@@ -16,11 +16,15 @@
 
 #include "backend/schema/backfills/column_value_backfill.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
+#include "absl/flags/flag.h"
 #include "absl/status/statusor.h"
 #include "backend/actions/generated_column.h"
 #include "backend/datamodel/types.h"
@@ -28,6 +32,9 @@
 #include "backend/query/catalog.h"
 #include "backend/query/function_catalog.h"
 #include "backend/schema/catalog/table.h"
+#include "backend/schema/updater/parallel_scan.h"
+#include "backend/storage/in_memory_iterator.h"
+#include "backend/storage/iterator.h"
 #include "absl/status/status.h"
 #include "zetasql/base/status_macros.h"
 
@@ -104,6 +111,43 @@ absl::StatusOr<zetasql::Value> RewriteColumnValue(
   return absl::InternalError("Invalid type conversion");
 }
 
+// Produces the rows of `range` which a backfill rewrites.
+using BackfillRangeFn = std::function<
+    absl::StatusOr<std::vector<FixedRowStorageIterator::Row>>(
+        const KeyRange& range)>;
+
+// Backfills `column_id` of `table` one key range at a time. Ranges are
+// rewritten by up to --schema_scan_threads threads at once and each batch is
+// loaded once all of its reads are done, since the table cannot be written
+// while it is being read. Only one batch of rewritten rows is buffered at a
+// time.
+absl::Status BackfillKeyRanges(const Table* table, ColumnID column_id,
+                               const SchemaValidationContext* context,
+                               const BackfillRangeFn& backfill_range) {
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<KeyRange> ranges,
+                   SplitTableIntoKeyRanges(context->storage(),
+                                           context->pending_commit_timestamp(),
+                                           table->id()));
+  const int batch_size = std::max(1, absl::GetFlag(FLAGS_schema_scan_threads));
+  for (int begin = 0; begin < ranges.size(); begin += batch_size) {
+    const int end = std::min<int>(ranges.size(), begin + batch_size);
+    std::vector<std::vector<FixedRowStorageIterator::Row>> batch(end - begin);
+    ZETASQL_RETURN_IF_ERROR(ProcessKeyRanges(
+        end - begin, batch_size, [&](int i) -> absl::Status {
+          ZETASQL_ASSIGN_OR_RETURN(batch[i], backfill_range(ranges[begin + i]));
+          return absl::OkStatus();
+        }));
+    for (std::vector<FixedRowStorageIterator::Row>& rows : batch) {
+      if (rows.empty()) continue;
+      FixedRowStorageIterator rows_itr(std::move(rows));
+      ZETASQL_RETURN_IF_ERROR(
+          context->storage()->LoadSorted(context->pending_commit_timestamp(),
+                                         table->id(), {column_id}, &rows_itr));
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::Status BackfillColumnValue(const Column* old_column,
@@ -113,24 +157,37 @@ absl::Status BackfillColumnValue(const Column* old_column,
   auto column_id = old_column->id();
   const Table* table = old_column->table();
 
-  std::unique_ptr<StorageIterator> itr;
-  ZETASQL_RETURN_IF_ERROR(context->storage()->Read(context->pending_commit_timestamp(),
-                                           table->id(), KeyRange::All(),
-                                           {column_id}, &itr));
-
-  while (itr->Next()) {
-    std::vector<zetasql::Value> row_values;
-    ZETASQL_RET_CHECK_EQ(itr->NumColumns(), 1);
-    const zetasql::Value& orig_value = itr->ColumnValue(0);
-    ZETASQL_ASSIGN_OR_RETURN(const auto new_column_value,
-                     RewriteColumnValue(old_column->GetType(),
-                                        new_column->GetType(), orig_value));
-    ZETASQL_RETURN_IF_ERROR(context->storage()->Write(
-        context->pending_commit_timestamp(), table->id(), itr->Key(),
-        {column_id}, {new_column_value}));
+  // Stored values already have the new type, e.g. when only the length of the
+  // column changes, so there is nothing to rewrite.
+  if (old_column->GetType()->Equals(new_column->GetType())) {
+    return absl::OkStatus();
   }
 
-  return absl::OkStatus();
+  return BackfillKeyRanges(
+      table, column_id, context,
+      [&](const KeyRange& range)
+          -> absl::StatusOr<std::vector<FixedRowStorageIterator::Row>> {
+        std::unique_ptr<StorageIterator> itr;
+        ZETASQL_RETURN_IF_ERROR(
+            context->storage()->Read(context->pending_commit_timestamp(),
+                                     table->id(), range, {column_id}, &itr));
+        std::vector<FixedRowStorageIterator::Row> rows;
+        while (itr->Next()) {
+          ZETASQL_RET_CHECK_EQ(itr->NumColumns(), 1);
+          const zetasql::Value& orig_value = itr->ColumnValue(0);
+          // Rows without a value for the column are left untouched.
+          if (!orig_value.is_valid()) continue;
+          ZETASQL_ASSIGN_OR_RETURN(
+              zetasql::Value new_column_value,
+              RewriteColumnValue(old_column->GetType(), new_column->GetType(),
+                                 orig_value));
+          rows.emplace_back(
+              itr->Key(),
+              std::vector<zetasql::Value>{std::move(new_column_value)});
+        }
+        ZETASQL_RETURN_IF_ERROR(itr->Status());
+        return rows;
+      });
 }
 
 absl::Status BackfillGeneratedColumnValue(
@@ -139,39 +196,47 @@ absl::Status BackfillGeneratedColumnValue(
             (generated_column->is_generated() ||
              generated_column->has_default_value()));
   ZETASQL_RET_CHECK_NE(context, nullptr);
-  FunctionCatalog function_catalog(context->type_factory());
-  function_catalog.SetLatestSchema(context->validated_new_schema());
-  Catalog catalog(context->validated_new_schema(), &function_catalog,
-                  context->type_factory());
   const Table* table = generated_column->table();
-  GeneratedColumnEffector effector(table, &catalog);
-
   std::vector<ColumnID> column_ids = GetColumnIDs(table->columns());
-  std::unique_ptr<StorageIterator> itr;
-  ZETASQL_RETURN_IF_ERROR(context->storage()->Read(context->pending_commit_timestamp(),
-                                           table->id(), KeyRange::All(),
-                                           column_ids, &itr));
-  while (itr->Next()) {
-    zetasql::ParameterValueMap row_column_values;
-    for (int i = 0; i < itr->NumColumns(); ++i) {
-      // Storage returns invalid values if a value is not present, in which case
-      // we convert it into a typed NULL.
-      row_column_values[table->columns()[i]->Name()] =
-          itr->ColumnValue(i).is_valid()
-              ? itr->ColumnValue(i)
-              : zetasql::Value::Null(table->columns()[i]->GetType());
-    }
-
-    ZETASQL_ASSIGN_OR_RETURN(zetasql::Value value,
-                     effector.ComputeGeneratedColumnValue(generated_column,
-                                                          row_column_values));
-
-    ZETASQL_RETURN_IF_ERROR(context->storage()->Write(
-        context->pending_commit_timestamp(), table->id(), itr->Key(),
-        {generated_column->id()}, {value}));
-  }
 
-  return itr->Status();
+  return BackfillKeyRanges(
+      table, generated_column->id(), context,
+      [&](const KeyRange& range)
+          -> absl::StatusOr<std::vector<FixedRowStorageIterator::Row>> {
+        // The catalogs and the effector cache analyzed expressions, so every
+        // range gets its own.
+        FunctionCatalog function_catalog(context->type_factory());
+        function_catalog.SetLatestSchema(context->validated_new_schema());
+        Catalog catalog(context->validated_new_schema(), &function_catalog,
+                        context->type_factory());
+        GeneratedColumnEffector effector(table, &catalog);
+
+        std::unique_ptr<StorageIterator> itr;
+        ZETASQL_RETURN_IF_ERROR(
+            context->storage()->Read(context->pending_commit_timestamp(),
+                                     table->id(), range, column_ids, &itr));
+        std::vector<FixedRowStorageIterator::Row> rows;
+        while (itr->Next()) {
+          zetasql::ParameterValueMap row_column_values;
+          for (int i = 0; i < itr->NumColumns(); ++i) {
+            // Storage returns invalid values if a value is not present, in
+            // which case we convert it into a typed NULL.
+            row_column_values[table->columns()[i]->Name()] =
+                itr->ColumnValue(i).is_valid()
+                    ? itr->ColumnValue(i)
+                    : zetasql::Value::Null(table->columns()[i]->GetType());
+          }
+
+          ZETASQL_ASSIGN_OR_RETURN(zetasql::Value value,
+                           effector.ComputeGeneratedColumnValue(
+                               generated_column, row_column_values));
+
+          rows.emplace_back(itr->Key(),
+                            std::vector<zetasql::Value>{std::move(value)});
+        }
+        ZETASQL_RETURN_IF_ERROR(itr->Status());
+        return rows;
+      });
 }
 
 }  // namespace backend
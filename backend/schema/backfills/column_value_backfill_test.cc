@@ -28,11 +28,15 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "backend/database/database.h"
 #include "backend/datamodel/key_set.h"
 #include "backend/schema/catalog/schema.h"
+#include "backend/schema/updater/parallel_scan.h"
 #include "backend/schema/updater/schema_updater.h"
 #include "backend/transaction/options.h"
 #include "common/errors.h"
@@ -241,6 +245,50 @@ TEST_F(ColumnValueBackfillTest, BackfillDefaultColumnNotNullFail) {
           testing::HasSubstr("Cannot specify a null value for column")));
 }
 
+TEST_F(ColumnValueBackfillTest, BackfillAcrossKeyRanges) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_schema_scan_rows_per_range, 3);
+  absl::SetFlag(&FLAGS_schema_scan_threads, 2);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ReadWriteTransaction> txn,
+                       database_->CreateReadWriteTransaction(
+                           ReadWriteOptions(), RetryState()));
+  Mutation m;
+  for (int i = 3; i < 20; ++i) {
+    m.AddWriteOp(MutationOpType::kInsert, "TestTable",
+                 {"int64_col", "string_col"},
+                 {{Int64(i), String(absl::StrCat("value", i))}});
+  }
+  ZETASQL_ASSERT_OK(txn->Write(m));
+  ZETASQL_ASSERT_OK(txn->Commit());
+
+  ZETASQL_ASSERT_OK(UpdateSchema({R"(
+    ALTER TABLE TestTable ALTER COLUMN string_col BYTES(10)
+    )"}));
+
+  std::vector<zetasql::Value> expected = {Bytes("ФдΣβaA"), NullBytes()};
+  for (int i = 3; i < 20; ++i) {
+    expected.push_back(Bytes(absl::StrCat("value", i)));
+  }
+  EXPECT_THAT(ColumnValues("string_col"), testing::ElementsAreArray(expected));
+}
+
+TEST_F(ColumnValueBackfillTest, BackfillDefaultColumnAcrossKeyRanges) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_schema_scan_rows_per_range, 1);
+  absl::SetFlag(&FLAGS_schema_scan_threads, 2);
+
+  ZETASQL_ASSERT_OK(UpdateSchema({R"(
+    ALTER TABLE TestTable
+      ADD COLUMN default_col STRING(MAX) DEFAULT ("default")
+    )"}));
+
+  EXPECT_THAT(ColumnValues("default_col"), testing::ElementsAreArray({
+                                               String("default"),
+                                               String("default"),
+                                           }));
+}
+
 class ProtoColumnValueBackfillTest : public ColumnValueBackfillTest {
  protected:
   std::string read_descriptors() {
@@ -16,9 +16,12 @@
 
 #include "backend/schema/backfills/index_backfill.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <queue>
-#include <set>
+#include <utility>
 #include <vector>
 
 #include "zetasql/public/functions/string.h"
@@ -26,6 +29,7 @@
 #include "zetasql/public/value.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "backend/common/ids.h"
@@ -36,7 +40,9 @@
 #include "backend/datamodel/value.h"
 #include "backend/schema/catalog/column.h"
 #include "backend/schema/catalog/index.h"
+#include "backend/schema/updater/parallel_scan.h"
 #include "backend/schema/updater/schema_validation_context.h"
+#include "backend/storage/in_memory_iterator.h"
 #include "backend/storage/in_memory_storage.h"
 #include "backend/storage/iterator.h"
 #include "common/errors.h"
@@ -50,6 +56,61 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
+namespace {
+
+// A row of the index data table computed from a row of the indexed table.
+struct IndexEntry {
+  Key key;
+  ValueList values;
+};
+
+// Computes the index entries of the rows of the indexed table in `key_range`,
+// sorted by index data table key.
+absl::StatusOr<std::vector<IndexEntry>> BuildIndexEntryRun(
+    const Index* index, const KeyRange& key_range,
+    const SchemaValidationContext* context) {
+  absl::Span<const Column* const> base_columns =
+      index->indexed_table()->columns();
+  std::unique_ptr<StorageIterator> itr;
+  ZETASQL_RETURN_IF_ERROR(context->storage()->Read(
+      context->pending_commit_timestamp(), index->indexed_table()->id(),
+      key_range, GetColumnIDs(base_columns), &itr));
+
+  std::vector<IndexEntry> run;
+  while (itr->Next()) {
+    std::vector<zetasql::Value> row_values;
+    row_values.reserve(itr->NumColumns());
+    for (int i = 0; i < itr->NumColumns(); ++i) {
+      // Storage returns invalid values if a value is not present, in which case
+      // we convert it into a typed NULL.
+      row_values.emplace_back(
+          itr->ColumnValue(i).is_valid()
+              ? itr->ColumnValue(i)
+              : zetasql::Value::Null(base_columns[i]->GetType()));
+    }
+
+    // Compute the index key and column values.
+    Row base_row = MakeRow(index->indexed_table(), base_columns, row_values);
+    // Backfill should return failed precondition error for invalid index keys.
+    ZETASQL_ASSIGN_OR_RETURN(Key index_data_table_key, ComputeIndexKey(base_row, index),
+                     _.SetErrorCode(absl::StatusCode::kFailedPrecondition));
+    if (ShouldFilterIndexKeyOrValue(index, index_data_table_key, base_row)) {
+      continue;
+    }
+    run.push_back(IndexEntry{std::move(index_data_table_key),
+                             ComputeIndexValues(base_row, index)});
+  }
+  ZETASQL_RETURN_IF_ERROR(itr->Status());
+
+  std::sort(run.begin(), run.end(),
+            [](const IndexEntry& a, const IndexEntry& b) {
+              return a.key < b.key;
+            });
+  return run;
+}
+
+}  // namespace
+
 absl::Status BackfillIndexAddedColumn(const Index* index,
                                       const Column* added_column,
                                       const SchemaValidationContext* context) {
@@ -99,61 +160,69 @@ absl::Status BackfillIndexAddedColumn(const Index* index,
 
 absl::Status BackfillIndex(const Index* index,
                            const SchemaValidationContext* context) {
-  absl::Span<const Column* const> base_columns =
-      index->indexed_table()->columns();
-  absl::Span<const Column* const> index_columns =
-      index->index_data_table()->columns();
-  std::vector<ColumnID> base_column_ids = GetColumnIDs(base_columns);
-  std::vector<ColumnID> index_column_ids = GetColumnIDs(index_columns);
+  std::vector<ColumnID> index_column_ids =
+      GetColumnIDs(index->index_data_table()->columns());
 
   // TODO: Use actions framework for index backfills.
-  std::unique_ptr<StorageIterator> itr;
-  ZETASQL_RETURN_IF_ERROR(context->storage()->Read(
-      context->pending_commit_timestamp(), index->indexed_table()->id(),
-      KeyRange::All(), base_column_ids, &itr));
-
-  // List of index keys used for verifying index uniqueness.
-  std::set<Key> index_keys;
-  while (itr->Next()) {
-    std::vector<zetasql::Value> row_values;
-    row_values.reserve(itr->NumColumns());
-    for (int i = 0; i < itr->NumColumns(); ++i) {
-      // Storage returns invalid values if a value is not present, in which case
-      // we convert it into a typed NULL.
-      row_values.emplace_back(
-          itr->ColumnValue(i).is_valid()
-              ? itr->ColumnValue(i)
-              : zetasql::Value::Null(base_columns[i]->GetType()));
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::vector<KeyRange> ranges,
+      SplitTableIntoKeyRanges(context->storage(),
+                              context->pending_commit_timestamp(),
+                              index->indexed_table()->id()));
+  std::vector<std::vector<IndexEntry>> runs(ranges.size());
+  ZETASQL_RETURN_IF_ERROR(
+      ProcessKeyRanges(ranges.size(), [&](int i) -> absl::Status {
+        ZETASQL_ASSIGN_OR_RETURN(runs[i],
+                         BuildIndexEntryRun(index, ranges[i], context));
+        return absl::OkStatus();
+      }));
+
+  // Merge the sorted runs so that the index data table is loaded in key
+  // order. Rows with the same index key are adjacent in that order, which
+  // lets uniqueness be checked against the previous row only.
+  using RunPosition = std::pair<int, int>;
+  auto entry_at = [&runs](const RunPosition& position) -> const IndexEntry& {
+    return runs[position.first][position.second];
+  };
+  auto greater = [&entry_at](const RunPosition& a, const RunPosition& b) {
+    return entry_at(b).key < entry_at(a).key;
+  };
+  std::priority_queue<RunPosition, std::vector<RunPosition>, decltype(greater)>
+      heads(greater);
+  for (int i = 0; i < runs.size(); ++i) {
+    if (!runs[i].empty()) {
+      heads.emplace(i, 0);
     }
+  }
 
-    // Compute the index key and column values.
-    Row base_row = MakeRow(base_columns, row_values);
-    // Backfill should return failed precondition error for invalid index keys.
-    ZETASQL_ASSIGN_OR_RETURN(Key index_data_table_key, ComputeIndexKey(base_row, index),
-                     _.SetErrorCode(absl::StatusCode::kFailedPrecondition));
-    ValueList index_values = ComputeIndexValues(base_row, index);
-    if (ShouldFilterIndexKeyOrValue(index, index_data_table_key, base_row)) {
-      continue;
-    }
+  std::vector<FixedRowStorageIterator::Row> index_rows;
+  std::optional<Key> previous_index_key;
+  while (!heads.empty()) {
+    RunPosition position = heads.top();
+    heads.pop();
+    const IndexEntry& entry = entry_at(position);
 
     // Check uniqueness constraints.
     if (index->is_unique()) {
-      Key index_key = index_data_table_key.Prefix(index->key_columns().size());
-      if (index_keys.find(index_key) != index_keys.end()) {
+      Key index_key = entry.key.Prefix(index->key_columns().size());
+      if (previous_index_key.has_value() && *previous_index_key == index_key) {
         return error::UniqueIndexViolationOnIndexCreation(
             index->Name(), index_key.DebugString());
       }
-      // Add key to current list of index keys.
-      index_keys.insert(index_key);
+      previous_index_key = std::move(index_key);
     }
 
-    // Insert the new row in the index.
-    ZETASQL_RETURN_IF_ERROR(context->storage()->Write(
-        context->pending_commit_timestamp(), index->index_data_table()->id(),
-        index_data_table_key, index_column_ids, index_values));
+    index_rows.emplace_back(entry.key, entry.values);
+    if (position.second + 1 < runs[position.first].size()) {
+      heads.emplace(position.first, position.second + 1);
+    }
   }
 
-  return absl::OkStatus();
+  // Insert the new rows in the index.
+  FixedRowStorageIterator index_rows_itr(std::move(index_rows));
+  return context->storage()->LoadSorted(context->pending_commit_timestamp(),
+                                        index->index_data_table()->id(),
+                                        index_column_ids, &index_rows_itr);
 }
 
 }  // namespace backend
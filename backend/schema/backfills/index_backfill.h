@@ -27,6 +27,10 @@ namespace emulator {
 namespace backend {
 
 // Handles backfilling of a newly created Index.
+//
+// The indexed table is split into key ranges whose index entries are computed
+// and sorted concurrently. The sorted runs are then merged into the index data
+// table in index key order.
 absl::Status BackfillIndex(const Index* index,
                            const SchemaValidationContext* context);
 
@@ -25,8 +25,11 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "backend/access/read.h"
@@ -34,6 +37,7 @@
 #include "backend/database/database.h"
 #include "backend/datamodel/value.h"
 #include "backend/schema/catalog/schema.h"
+#include "backend/schema/updater/parallel_scan.h"
 #include "backend/schema/updater/schema_updater.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/read_only_transaction.h"
@@ -242,6 +246,57 @@ TEST(BackfillTest, BackfillUniqueIndex) {
                 "TestIndex", R"({String("value")↓})"));
 }
 
+TEST(BackfillTest, BackfillIndexAcrossKeyRanges) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_schema_scan_rows_per_range, 3);
+  absl::SetFlag(&FLAGS_schema_scan_threads, 4);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(DbInfo db_info, CreateTestDb({kCreateTestTable}));
+  std::vector<ValueList> rows;
+  for (int i = 0; i < 20; ++i) {
+    rows.push_back({Int64(i), String(absl::StrCat("value", i % 7))});
+  }
+  ZETASQL_ASSERT_OK(
+      InsertValues(db_info, "TestTable", {"int64_col", "string_col"}, rows));
+
+  ZETASQL_ASSERT_OK(UpdateSchema(db_info, {R"(
+                            CREATE INDEX TestIndex ON
+                            TestTable(string_col DESC)
+                    )"}));
+
+  // Rows are ordered by the index key, then by the indexed table key.
+  std::vector<ValueList> expected;
+  for (int v = 6; v >= 0; --v) {
+    for (int i = v; i < 20; i += 7) {
+      expected.push_back({String(absl::StrCat("value", v)), Int64(i)});
+    }
+  }
+  EXPECT_THAT(
+      ReadAllRows(db_info, ReadArg{.table = "TestTable",
+                                   .index = "TestIndex",
+                                   .columns = {"string_col", "int64_col"}}),
+      IsOkAndHolds(ElementsAreArray(expected)));
+}
+
+TEST(BackfillTest, BackfillUniqueIndexAcrossKeyRanges) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_schema_scan_rows_per_range, 2);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(DbInfo db_info, CreateTestDb({kCreateTestTable}));
+  ZETASQL_ASSERT_OK(InsertValues(db_info, "TestTable", {"int64_col", "string_col"},
+                         {{Int64(1), String("a")},
+                          {Int64(2), String("b")},
+                          {Int64(3), String("c")},
+                          {Int64(4), String("a")}}));
+
+  EXPECT_EQ(UpdateSchema(db_info, {R"(
+                            CREATE UNIQUE INDEX TestIndex ON
+                            TestTable(string_col)
+                    )"}),
+            error::UniqueIndexViolationOnIndexCreation("TestIndex",
+                                                       R"({String("a")})"));
+}
+
 TEST(BackfillTest, AlterIndexDropColumn) {
   ZETASQL_ASSERT_OK_AND_ASSIGN(DbInfo db_info, CreateTestDb({kCreateTestTable}));
   ZETASQL_ASSERT_OK(InsertValues(
@@ -78,8 +78,7 @@ class Table::Builder {
   }
 
   Builder& add_column(const Column* column) {
-    instance_->columns_.push_back(column);
-    instance_->columns_map_[column->Name()] = column;
+    instance_->AddColumn(column);
     return *this;
   }
 
@@ -154,8 +153,7 @@ class Table::Editor {
   const Table* get() const { return instance_; }
 
   Editor& add_column(const Column* column) {
-    instance_->columns_.push_back(column);
-    instance_->columns_map_[column->Name()] = column;
+    instance_->AddColumn(column);
     return *this;
   }
 
@@ -144,6 +144,9 @@ class Column : public SchemaNode {
   // Returns the table containing the column.
   const Table* table() const { return table_; }
 
+  // Returns the position of the column in table()->columns().
+  int ordinal() const { return ordinal_; }
+
   // Returns the list of all change streams on this column.
   absl::Span<const ChangeStream* const> change_streams() const {
     return change_streams_;
@@ -191,6 +194,8 @@ class Column : public SchemaNode {
 
  private:
   friend class ColumnValidator;
+  // Maintains ordinal_ as the table's columns are added and dropped.
+  friend class Table;
 
   using ValidationFn =
       std::function<absl::Status(const Column*, SchemaValidationContext*)>;
@@ -266,6 +271,9 @@ class Column : public SchemaNode {
   // The table containing the column.
   const Table* table_ = nullptr;
 
+  // The position of the column in the columns of table_.
+  int ordinal_ = -1;
+
   // List of change streams referring to this column. These are owned by the
   // Schema, not by the Column.
   std::vector<const ChangeStream*> change_streams_;
@@ -25,12 +25,16 @@
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/descriptor_database.h"
 #include "zetasql/public/types/proto_type.h"
+#include "absl/base/const_init.h"
+#include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "common/errors.h"
 #include "google/protobuf/descriptor.h"
@@ -42,6 +46,57 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
+struct ProtoBundle::Descriptors {
+  // Returns the Descriptors built from `files`, sharing them with any other
+  // live ProtoBundle built from the same FileDescriptors.
+  static absl::StatusOr<std::shared_ptr<const Descriptors>> GetOrCreate(
+      const google::protobuf::FileDescriptorSet& files);
+
+  google::protobuf::SimpleDescriptorDatabase protodb;
+  google::protobuf::DescriptorPool pool{&protodb};
+};
+
+absl::StatusOr<std::shared_ptr<const ProtoBundle::Descriptors>>
+ProtoBundle::Descriptors::GetOrCreate(
+    const google::protobuf::FileDescriptorSet& files) {
+  // Descriptors are keyed by the serialized FileDescriptorSet rather than a
+  // fingerprint of it so that distinct sets can never collide. Entries are
+  // held weakly and expire along with the last ProtoBundle using them.
+  static absl::Mutex mu(absl::kConstInit);
+  static auto* cache =
+      new absl::flat_hash_map<std::string, std::weak_ptr<const Descriptors>>();
+
+  std::string key = files.SerializeAsString();
+  absl::MutexLock lock(&mu);
+  auto it = cache->find(key);
+  if (it != cache->end()) {
+    if (std::shared_ptr<const Descriptors> descriptors = it->second.lock()) {
+      return descriptors;
+    }
+  }
+
+  auto descriptors = std::make_shared<Descriptors>();
+  for (const auto& file : files.file()) {
+    // Add() should only fail for double insertions which the caller already
+    // takes care of. We return an error if it fails for anything else.
+    ZETASQL_RET_CHECK(descriptors->protodb.Add(file)) << absl::Substitute(
+        "Could not insert FileDescriptor (`$0`) in the database", file.name());
+  }
+  descriptors->pool.AllowUnknownDependencies();
+
+  absl::erase_if(*cache,
+                 [](const auto& entry) { return entry.second.expired(); });
+  (*cache)[std::move(key)] = descriptors;
+  return descriptors;
+}
+
+std::unique_ptr<const ProtoBundle> ProtoBundle::CreateEmpty() {
+  auto proto_bundle = absl::WrapUnique(new ProtoBundle());
+  proto_bundle->descriptors_ =
+      Descriptors::GetOrCreate(google::protobuf::FileDescriptorSet()).value();
+  return proto_bundle;
+}
+
 absl::Status ProtoBundle::Builder::ParseProtoDescriptorBytes(
     absl::string_view proto_descriptor_bytes) {
   if (proto_descriptor_bytes.empty()) {
@@ -123,7 +178,9 @@ absl::Status ProtoBundle::Builder::DeleteTypes(
 
 absl::StatusOr<std::unique_ptr<const ProtoBundle>>
 ProtoBundle::Builder::Build() {
-  absl::flat_hash_set<std::string> encountered_files;
+  // Files are collected in name order so that bundles over the same files
+  // share their descriptors regardless of the order the types were listed in.
+  absl::btree_map<std::string, google::protobuf::FileDescriptorProto> files;
   for (const std::string& proto_type : instance_->types_) {
     google::protobuf::FileDescriptorProto file_descriptor_proto;
     // This is a sanity check as the types were already verified to exist in
@@ -134,22 +191,16 @@ ProtoBundle::Builder::Build() {
         << absl::Substitute("Could not find FileDescriptor for `$0`",
                             proto_type);
 
-    if (!encountered_files.contains(file_descriptor_proto.name())) {
-      // Add() should only fail for double insertions which is already taken
-      // care of. We return an error if it fails for anything else.
-      ZETASQL_RET_CHECK(instance_->protodb_->Add(file_descriptor_proto))
-          << absl::Substitute(
-                 "Could not insert FileDescriptor (`$0`) of `$1` in the "
-                 "database",
-                 file_descriptor_proto.name(), proto_type);
-
-      encountered_files.insert(file_descriptor_proto.name());
-    }
+    std::string file_name = file_descriptor_proto.name();
+    files.try_emplace(std::move(file_name), std::move(file_descriptor_proto));
   }
 
-  instance_->descriptor_pool_ =
-      std::make_unique<google::protobuf::DescriptorPool>(instance_->protodb_.get());
-  instance_->descriptor_pool_->AllowUnknownDependencies();
+  google::protobuf::FileDescriptorSet file_descriptor_set;
+  for (auto& [name, file] : files) {
+    *file_descriptor_set.add_file() = std::move(file);
+  }
+  ZETASQL_ASSIGN_OR_RETURN(instance_->descriptors_,
+                   Descriptors::GetOrCreate(file_descriptor_set));
   ZETASQL_RETURN_IF_ERROR(instance_->CheckUnsupportedFeatures());
   ZETASQL_RETURN_IF_ERROR(instance_->ValidateRestrictedPackages());
 
@@ -212,7 +263,7 @@ absl::Status ProtoBundle::ValidateMessage(
 absl::Status ProtoBundle::CheckUnsupportedFeatures() const {
   for (const auto& type : types_) {
     const google::protobuf::Descriptor* descriptor =
-        descriptor_pool_->FindMessageTypeByName(type);
+        descriptors_->pool.FindMessageTypeByName(type);
     // This would happen if the descriptor is type is enum.
     if (!descriptor) continue;
     absl::flat_hash_set<const google::protobuf::Descriptor*> visited_descriptors;
@@ -228,7 +279,7 @@ absl::StatusOr<const google::protobuf::Descriptor*> ProtoBundle::GetTypeDescript
   }
 
   const google::protobuf::Descriptor* descriptor =
-      descriptor_pool_->FindMessageTypeByName(type);
+      descriptors_->pool.FindMessageTypeByName(type);
   if (descriptor == nullptr) {
     return error::ProtoTypeNotFound(type);
   }
@@ -242,7 +293,7 @@ ProtoBundle::GetEnumTypeDescriptor(absl::string_view type) const {
   }
 
   const google::protobuf::EnumDescriptor* descriptor =
-      descriptor_pool_->FindEnumTypeByName(type);
+      descriptors_->pool.FindEnumTypeByName(type);
   if (descriptor == nullptr) {
     return error::ProtoEnumTypeNotFound(type);
   }
@@ -55,6 +55,9 @@ namespace backend {
 // To emulate the production behavior, we artificially enforce the type checks
 // by storing the list of inserted types separately and verifying that a type
 // exists in this list before returning the descriptors.
+// 3. The descriptor database and pool are immutable once built, so they are
+// shared by every ProtoBundle built from the same FileDescriptors, whether in
+// later schema versions of the same database or in other databases.
 class ProtoBundle {
  public:
   // Returns the list of types.
@@ -75,12 +78,7 @@ class ProtoBundle {
   // proto types.
   // This empty instance will be used to return "Type not found" errors whenever
   // someone tries to use a proto type without creating the proto bundle.
-  static std::unique_ptr<const ProtoBundle> CreateEmpty() {
-    auto proto_bundle = absl::WrapUnique(new ProtoBundle());
-    proto_bundle->descriptor_pool_ =
-        std::make_unique<google::protobuf::DescriptorPool>(proto_bundle->protodb_.get());
-    return proto_bundle;
-  }
+  static std::unique_ptr<const ProtoBundle> CreateEmpty();
 
   // Used to build a new ProtoBundle, either from scratch or from the types
   // defined in a previous proto bundle.
@@ -159,6 +157,9 @@ class ProtoBundle {
   };
 
  private:
+  // The descriptor database and pool built from a set of FileDescriptors.
+  struct Descriptors;
+
   ProtoBundle() = default;
   ProtoBundle& operator=(const ProtoBundle&) = delete;
   // Validates if there are any types that are using unsupported type
@@ -182,19 +183,13 @@ class ProtoBundle {
   absl::btree_set<std::string> types_;
 
   // Descriptor database constructed from the FileDescriptorSet provided along
-  // with the DDL. Since this is built from the FileDescriptor for the
-  // explicitly listed messages, it may hold other unrelated messages that are
-  // co-located in the same proto file where the listed messages are defined.
-  // Hence this should not be used directly for querying descriptors, please
-  // use GetTypeDescriptor and GetEnumDescriptor defined above.
-  const std::unique_ptr<google::protobuf::SimpleDescriptorDatabase> protodb_ =
-      std::make_unique<google::protobuf::SimpleDescriptorDatabase>();
-
-  // An empty descriptor pool which uses the above descriptor database to
-  // query and construct the descriptors from the FileDescriptors. Do not use
-  // this directly for querying proto descriptors for the same reasons listed
-  // above for `protodb_`.
-  std::unique_ptr<google::protobuf::DescriptorPool> descriptor_pool_;
+  // with the DDL, and the descriptor pool built lazily over it. Since this is
+  // built from the FileDescriptor for the explicitly listed messages, it may
+  // hold other unrelated messages that are co-located in the same proto file
+  // where the listed messages are defined. Hence this should not be used
+  // directly for querying descriptors, please use GetTypeDescriptor and
+  // GetEnumDescriptor defined above.
+  std::shared_ptr<const Descriptors> descriptors_;
 };
 
 }  // namespace backend
@@ -590,6 +590,37 @@ TEST_F(ProtoBundleTest, GetTypeDescriptor_SecondGenerationProtoBundle) {
       EqualsMessageDescriptor(::emulator::tests::common::Simple::descriptor()));
 }
 
+TEST_F(ProtoBundleTest, BundlesOverTheSameFilesShareDescriptors) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto builder_a,
+                       ProtoBundle::Builder::New(read_descriptors()));
+  ZETASQL_ASSERT_OK(builder_a->InsertTypes(
+      std::vector<std::string>{kSimpleProtoName, kParentProtoName}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto proto_bundle_a, builder_a->Build());
+
+  // Same files, types listed in a different order.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto builder_b,
+                       ProtoBundle::Builder::New(read_descriptors()));
+  ZETASQL_ASSERT_OK(builder_b->InsertTypes(
+      std::vector<std::string>{kParentProtoName, kSimpleProtoName}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto proto_bundle_b, builder_b->Build());
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto descriptor_a,
+                       proto_bundle_a->GetTypeDescriptor(kSimpleProtoName));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto descriptor_b,
+                       proto_bundle_b->GetTypeDescriptor(kSimpleProtoName));
+  EXPECT_EQ(descriptor_a, descriptor_b);
+
+  // Bundles over different files do not share descriptors.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto builder_c,
+                       ProtoBundle::Builder::New(read_descriptors()));
+  ZETASQL_ASSERT_OK(builder_c->InsertTypes(
+      std::vector<std::string>{kSimpleProtoName, kImportingParentProtoName}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto proto_bundle_c, builder_c->Build());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto descriptor_c,
+                       proto_bundle_c->GetTypeDescriptor(kSimpleProtoName));
+  EXPECT_NE(descriptor_a, descriptor_c);
+}
+
 TEST_F(ProtoBundleTest, GetEnumTypeDescriptor) {
   ZETASQL_ASSERT_OK_AND_ASSIGN(auto builder,
                        ProtoBundle::Builder::New(read_descriptors()));
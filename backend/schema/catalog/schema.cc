@@ -24,6 +24,8 @@
 #include "zetasql/public/types/type.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "backend/schema/catalog/change_stream.h"
 #include "backend/schema/catalog/check_constraint.h"
 #include "backend/schema/catalog/column.h"
@@ -43,6 +45,7 @@
 #include "backend/schema/updater/ddl_type_conversion.h"
 #include "common/constants.h"
 #include "re2/re2.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
@@ -529,6 +532,19 @@ ddl::DDLStatementList Schema::Dump() const {
   return ddl_statements;
 }
 
+absl::StatusOr<std::shared_ptr<const std::vector<std::string>>>
+Schema::GetOrPrintDDLStatements(
+    absl::FunctionRef<absl::StatusOr<std::vector<std::string>>()> print)
+    const {
+  absl::MutexLock lock(&ddl_statements_mu_);
+  if (ddl_statements_ == nullptr) {
+    ZETASQL_ASSIGN_OR_RETURN(std::vector<std::string> statements, print());
+    ddl_statements_ =
+        std::make_shared<const std::vector<std::string>>(std::move(statements));
+  }
+  return ddl_statements_;
+}
+
 Schema::Schema(const SchemaGraph* graph
                ,
                std::shared_ptr<const ProtoBundle> proto_bundle
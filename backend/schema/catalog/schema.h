@@ -23,6 +23,10 @@
 #include <vector>
 
 #include "google/spanner/admin/database/v1/common.pb.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "backend/common/case.h"
 #include "backend/schema/catalog/change_stream.h"
@@ -71,6 +75,14 @@ class Schema {
   // Dumps the schema to ddl::DDLStatementList.
   ddl::DDLStatementList Dump() const;
 
+  // Returns the formatted DDL statements of this schema. The statements are
+  // produced by `print` on the first successful call and shared by all later
+  // callers, since a schema never changes once it has been built.
+  absl::StatusOr<std::shared_ptr<const std::vector<std::string>>>
+  GetOrPrintDDLStatements(
+      absl::FunctionRef<absl::StatusOr<std::vector<std::string>>()> print)
+      const ABSL_LOCKS_EXCLUDED(ddl_statements_mu_);
+
   // Finds a view by its name. Returns a const pointer of the view, or
   // nullptr if the view is not found. Name comparison is case-insensitive.
   const View* FindView(const std::string& view_name) const;
@@ -175,6 +187,25 @@ class Schema {
   // Returns the database dialect.
   database_api::DatabaseDialect dialect() const { return dialect_; }
 
+  // Returns the names of the tables which were added or altered to derive this
+  // schema from `schema`, or nullptr if they are not known, e.g. if this schema
+  // was not derived from `schema` or if schema objects were dropped. All other
+  // tables of this schema are the same as in `schema`.
+  const CaseInsensitiveStringSet* TablesChangedSince(
+      const Schema* schema) const {
+    return schema != nullptr && schema == changed_since_ ? &changed_tables_
+                                                         : nullptr;
+  }
+
+  // Records that this schema was derived from `schema` by adding or altering
+  // `changed_tables`. Called by the schema updater before publishing the
+  // schema.
+  void SetTablesChangedSince(const Schema* schema,
+                             CaseInsensitiveStringSet changed_tables) {
+    changed_since_ = schema;
+    changed_tables_ = std::move(changed_tables);
+  }
+
  private:
   // Tries to find the managed index from the non-fingerprint part of the
   // index name.
@@ -227,6 +258,14 @@ class Schema {
   // comparison on the keys are case-insensitive.
   CaseInsensitiveStringMap<const Index*> index_map_;
 
+  // Guards the lazily printed DDL statements below.
+  mutable absl::Mutex ddl_statements_mu_;
+
+  // The formatted DDL statements of this schema, or nullptr if they have not
+  // been printed yet.
+  mutable std::shared_ptr<const std::vector<std::string>> ddl_statements_
+      ABSL_GUARDED_BY(ddl_statements_mu_);
+
   // Holds the proto type information for this schema. This is a shared pointer
   // to prevent creating multiple copies of the ProtoBundle for every schema
   // update even though there is no type change.
@@ -251,6 +290,11 @@ class Schema {
 
   // Holds the database dialect for this schema.
   const database_api::DatabaseDialect dialect_;
+
+  // The schema this schema was derived from by changing `changed_tables_`, if
+  // known. Only compared with, never dereferenced.
+  const Schema* changed_since_ = nullptr;
+  CaseInsensitiveStringSet changed_tables_;
 };
 
 // A Schema that also owns the SchemaGraph that manages the lifetime of the
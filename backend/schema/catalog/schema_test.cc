@@ -27,6 +27,8 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "backend/schema/builders/change_stream_builder.h"
@@ -645,6 +647,49 @@ TEST_F(SchemaTest, PrintDDLStatementsTestOneTable) {
           "CREATE UNIQUE INDEX test_index ON test_table(string_col DESC)")));
 }
 
+TEST_F(SchemaTest, GetDDLStatementsPrintsOncePerSchema) {
+  std::unique_ptr<const Schema> schema =
+      test::CreateSchemaWithOneTable(type_factory_.get());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const std::vector<std::string>> statements,
+      GetDDLStatements(schema.get()));
+  EXPECT_THAT(*statements, ElementsAre(
+                               R"(CREATE TABLE test_table (
+  int64_col INT64 NOT NULL,
+  string_col STRING(MAX),
+) PRIMARY KEY(int64_col))",
+                               "CREATE UNIQUE INDEX test_index ON "
+                               "test_table(string_col DESC)"));
+
+  // Later calls share the statements printed by the first one.
+  int print_calls = 0;
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const std::vector<std::string>> cached_statements,
+      schema->GetOrPrintDDLStatements(
+          [&]() -> absl::StatusOr<std::vector<std::string>> {
+            ++print_calls;
+            return std::vector<std::string>{};
+          }));
+  EXPECT_EQ(cached_statements, statements);
+  EXPECT_EQ(print_calls, 0);
+}
+
+TEST_F(SchemaTest, GetOrPrintDDLStatementsDoesNotCacheErrors) {
+  Schema schema;
+  EXPECT_THAT(schema.GetOrPrintDDLStatements(
+                  []() -> absl::StatusOr<std::vector<std::string>> {
+                    return absl::InternalError("print failed");
+                  }),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kInternal));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const std::vector<std::string>> statements,
+      schema.GetOrPrintDDLStatements(
+          []() -> absl::StatusOr<std::vector<std::string>> {
+            return std::vector<std::string>{"CREATE SCHEMA s"};
+          }));
+  EXPECT_THAT(*statements, ElementsAre("CREATE SCHEMA s"));
+}
+
 TEST_F(SchemaTest, PrintDDLStatementsTestOneTableWithSynonym) {
   std::unique_ptr<const Schema> schema =
       test::CreateSchemaWithOneTableWithSynonym(type_factory_.get());
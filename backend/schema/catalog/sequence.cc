@@ -16,19 +16,18 @@
 
 #include "backend/schema/catalog/sequence.h"
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 
 #include "zetasql/public/options.pb.h"
 #include "zetasql/public/type.pb.h"
 #include "zetasql/public/value.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
-#include "absl/synchronization/mutex.h"
 #include "backend/schema/graph/schema_graph_editor.h"
 #include "backend/schema/graph/schema_node.h"
 #include "backend/schema/updater/schema_validation_context.h"
@@ -69,17 +68,10 @@ absl::Status Sequence::DeepClone(SchemaGraphEditor* editor,
 }
 
 absl::StatusOr<zetasql::Value> Sequence::GetNextSequenceValue() const {
-  absl::MutexLock lock(&SequenceMutex);
-  if (!Sequence::SequenceLastValues.contains(name_)) {
-    if (start_with_.has_value()) {
-      Sequence::SequenceLastValues[name_] = start_with_.value();
-    } else {
-      Sequence::SequenceLastValues[name_] = kSequenceDefaultStartWith;
-    }
-  }
-  if (Sequence::SequenceLastValues[name_] < 0) {
-    return error::InvalidSequenceStartWithCounterValue();
-  }
+  std::atomic<int64_t>& last_value = counter_->last_value;
+  int64_t counter = kNoValueRetrieved;
+  last_value.compare_exchange_strong(
+      counter, start_with_.value_or(kSequenceDefaultStartWith));
 
   // Retrieve the next value and make sure that it doesn't fall into the skipped
   // range. If it does, keep trying until we have one.
@@ -94,15 +86,22 @@ absl::StatusOr<zetasql::Value> Sequence::GetNextSequenceValue() const {
                 << "].";
       return error::SequenceExhausted(name_);
     }
-    if (Sequence::SequenceLastValues[name_] == kInt64Max) {
-      ABSL_LOG(INFO) << "No additional value can be obtained. The current sequence "
-                << "counter is already at int64max.";
-      return error::SequenceExhausted(name_);
-    }
+    // Claim the current counter, the compare-exchange reloading it whenever a
+    // concurrent caller claimed it first.
+    counter = last_value.load();
+    do {
+      if (counter < 0) {
+        return error::InvalidSequenceStartWithCounterValue();
+      }
+      if (counter == kInt64Max) {
+        ABSL_LOG(INFO) << "No additional value can be obtained. The current "
+                  << "sequence counter is already at int64max.";
+        return error::SequenceExhausted(name_);
+      }
+    } while (!last_value.compare_exchange_weak(counter, counter + 1));
     // In a bit-reversed-positive sequence, we bit-reverse the counter and
     // preserve its sign.
-    value = BitReverse(Sequence::SequenceLastValues[name_]++,
-                       /*preserve_sign=*/true);
+    value = BitReverse(counter, /*preserve_sign=*/true);
 
     ++attempt_count;
   } while (
@@ -115,31 +114,18 @@ absl::StatusOr<zetasql::Value> Sequence::GetNextSequenceValue() const {
 zetasql::Value Sequence::GetInternalSequenceState() const {
   // If no sequence value has been retrieved before, then the current state is
   // NULL.
-  absl::MutexLock lock(&SequenceMutex);
-  if (!Sequence::SequenceLastValues.contains(name_)) {
+  int64_t counter = counter_->last_value.load();
+  if (counter == kNoValueRetrieved) {
     return zetasql::Value::NullInt64();
   }
-  return zetasql::Value::Int64(Sequence::SequenceLastValues[name_]);
+  return zetasql::Value::Int64(counter);
 }
 
 void Sequence::ResetSequenceLastValue() const {
-  absl::MutexLock lock(&SequenceMutex);
-  if (!Sequence::SequenceLastValues.contains(name_)) {
-    return;
-  }
-  if (start_with_.has_value()) {
-    Sequence::SequenceLastValues[name_] = start_with_.value();
-  } else {
-    Sequence::SequenceLastValues[name_] = kSequenceDefaultStartWith;
-  }
-}
-
-void Sequence::RemoveSequenceFromLastValuesMap() const {
-  absl::MutexLock lock(&SequenceMutex);
-  absl::flat_hash_map<std::string, int64_t>::iterator it =
-      Sequence::SequenceLastValues.find(name_);
-  if (it != Sequence::SequenceLastValues.end()) {
-    Sequence::SequenceLastValues.erase(it);
+  int64_t counter = counter_->last_value.load();
+  while (counter != kNoValueRetrieved &&
+         !counter_->last_value.compare_exchange_weak(
+             counter, start_with_.value_or(kSequenceDefaultStartWith))) {
   }
 }
 
@@ -16,14 +16,15 @@
 
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_SCHEMA_CATALOG_SEQUENCE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_SCHEMA_CATALOG_SEQUENCE_H_
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 
 #include "zetasql/public/type.h"
-#include "absl/base/thread_annotations.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
-#include "absl/synchronization/mutex.h"
 #include "backend/common/ids.h"
 #include "backend/schema/ddl/operations.pb.h"
 #include "backend/schema/updater/schema_validation_context.h"
@@ -42,8 +43,6 @@ class Sequence : public SchemaNode {
   std::optional<int64_t> skip_range_min() const { return skip_range_min_; }
   std::optional<int64_t> skip_range_max() const { return skip_range_max_; }
 
-  ~Sequence() { RemoveSequenceFromLastValuesMap(); }
-
   // Returns a unique id of this sequence.
   const SequenceID id() const { return id_; }
 
@@ -57,20 +56,15 @@ class Sequence : public SchemaNode {
     }
     return "INVALID";
   }
-  inline static absl::Mutex SequenceMutex;
-  inline static absl::flat_hash_map<std::string, int64_t> SequenceLastValues
-      ABSL_GUARDED_BY(SequenceMutex);
 
   // Returns the next sequence value according to the sequence kind.
-  absl::StatusOr<zetasql::Value> GetNextSequenceValue() const
-      ABSL_LOCKS_EXCLUDED(SequenceMutex);
+  absl::StatusOr<zetasql::Value> GetNextSequenceValue() const;
 
   // Returns the internal current counter of the sequence.
-  zetasql::Value GetInternalSequenceState() const
-      ABSL_LOCKS_EXCLUDED(SequenceMutex);
+  zetasql::Value GetInternalSequenceState() const;
 
   // Reset the sequence's last value to the schema's current start_with_.
-  void ResetSequenceLastValue() const ABSL_LOCKS_EXCLUDED(SequenceMutex);
+  void ResetSequenceLastValue() const;
 
   // SchemaNode interface implementation.
   // ------------------------------------
@@ -99,8 +93,16 @@ class Sequence : public SchemaNode {
 
   Sequence(const Sequence&) = default;
 
-  void RemoveSequenceFromLastValuesMap() const
-      ABSL_LOCKS_EXCLUDED(SequenceMutex);
+  // Value of the counter before any sequence value has been retrieved.
+  static constexpr int64_t kNoValueRetrieved =
+      std::numeric_limits<int64_t>::min();
+
+  // Counter state of a sequence. It is shared by all the schema versions of the
+  // sequence, since schema updates shallow-clone it, whereas a dropped and
+  // re-created sequence gets a fresh counter.
+  struct Counter {
+    std::atomic<int64_t> last_value = kNoValueRetrieved;
+  };
 
   std::unique_ptr<SchemaNode> ShallowClone() const override {
     return absl::WrapUnique(new Sequence(*this));
@@ -125,6 +127,8 @@ class Sequence : public SchemaNode {
   std::optional<int64_t> start_with_;
   std::optional<int64_t> skip_range_min_;
   std::optional<int64_t> skip_range_max_;
+
+  std::shared_ptr<Counter> counter_ = std::make_shared<Counter>();
 };
 
 }  // namespace backend
@@ -36,6 +36,8 @@ namespace emulator {
 namespace backend {
 namespace {
 
+using ::zetasql_base::testing::IsOkAndHolds;
+
 TEST(SequenceTest, GetSequenceValuesFromMultipleThreads) {
   Sequence::Builder builder;
   builder.set_name("test_seq");
@@ -60,6 +62,38 @@ TEST(SequenceTest, GetSequenceValuesFromMultipleThreads) {
   EXPECT_EQ(sequence_values.size(), 100);
 }
 
+TEST(SequenceTest, SequencesWithTheSameNameHaveIndependentCounters) {
+  Sequence::Builder first_builder;
+  first_builder.set_name("test_seq");
+  const Sequence* first = first_builder.get();
+  Sequence::Builder second_builder;
+  second_builder.set_name("test_seq").set_start_with_counter(10);
+  const Sequence* second = second_builder.get();
+
+  EXPECT_TRUE(first->GetInternalSequenceState().is_null());
+  ZETASQL_ASSERT_OK(first->GetNextSequenceValue());
+  ZETASQL_ASSERT_OK(first->GetNextSequenceValue());
+  EXPECT_EQ(first->GetInternalSequenceState().int64_value(), 3);
+  EXPECT_TRUE(second->GetInternalSequenceState().is_null());
+
+  ZETASQL_ASSERT_OK(second->GetNextSequenceValue());
+  EXPECT_EQ(second->GetInternalSequenceState().int64_value(), 11);
+  EXPECT_EQ(first->GetInternalSequenceState().int64_value(), 3);
+}
+
+TEST(SequenceTest, ResetSequenceLastValueRestartsFromStartWithCounter) {
+  Sequence::Builder builder;
+  builder.set_name("test_seq").set_start_with_counter(5);
+  const Sequence* sequence = builder.get();
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(zetasql::Value first,
+                       sequence->GetNextSequenceValue());
+  ZETASQL_ASSERT_OK(sequence->GetNextSequenceValue());
+  sequence->ResetSequenceLastValue();
+  EXPECT_EQ(sequence->GetInternalSequenceState().int64_value(), 5);
+  EXPECT_THAT(sequence->GetNextSequenceValue(), IsOkAndHolds(first));
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
@@ -151,6 +151,12 @@ std::string OwningObjectType(const Table* table) {
   return table->owner_index() ? "Index" : "Table";
 }
 
+void Table::AddColumn(const Column* column) {
+  const_cast<Column*>(column)->ordinal_ = columns_.size();
+  columns_.push_back(column);
+  columns_map_[column->Name()] = column;
+}
+
 absl::Status Table::Validate(SchemaValidationContext* context) const {
   return validate_(this, context);
 }
@@ -179,6 +185,11 @@ absl::Status Table::DeepClone(SchemaGraphEditor* editor,
       ++it;
     }
   }
+  // Dropping columns shifts the ordinals of the columns after them. The cloned
+  // columns belong to this table only, so they can be updated in place.
+  for (int i = 0; i < columns_.size(); ++i) {
+    const_cast<Column*>(columns_[i])->ordinal_ = i;
+  }
 
   for (auto& key_column : primary_key_) {
     ZETASQL_ASSIGN_OR_RETURN(const auto* schema_node, editor->Clone(key_column));
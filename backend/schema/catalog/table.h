@@ -251,6 +251,9 @@ class Table : public SchemaNode {
   absl::Status DeepClone(SchemaGraphEditor* editor,
                          const SchemaNode* orig) override;
 
+  // Appends `column` to the columns of this table and sets its ordinal.
+  void AddColumn(const Column* column);
+
   // Validation delegates.
   const ValidationFn validate_;
 
@@ -16,6 +16,7 @@
 
 #include "backend/schema/catalog/versioned_catalog.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
@@ -30,34 +31,50 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
-VersionedCatalog::VersionedCatalog() {
-  schemas_[absl::InfinitePast()] = std::make_unique<const Schema>();
-}
+VersionedCatalog::VersionedCatalog()
+    : VersionedCatalog(std::make_shared<const Schema>()) {}
 
 VersionedCatalog::VersionedCatalog(
-    std::unique_ptr<const Schema> initial_schema) {
-  schemas_[absl::InfinitePast()] = std::move(initial_schema);
+    std::shared_ptr<const Schema> initial_schema) {
+  auto schemas = std::make_unique<SchemaVersions>();
+  schemas->emplace_back(absl::InfinitePast(), std::move(initial_schema));
+  schemas_.store(schemas.get(), std::memory_order_release);
+  snapshots_.push_back(std::move(schemas));
 }
 
 const Schema* VersionedCatalog::GetSchema(absl::Time timestamp) const {
-  absl::MutexLock lock(&mu_);
-  auto itr = schemas_.upper_bound(timestamp);
+  const SchemaVersions* schemas = schemas_.load(std::memory_order_acquire);
+  auto itr = std::upper_bound(
+      schemas->begin(), schemas->end(), timestamp,
+      [](absl::Time timestamp, const SchemaVersions::value_type& version) {
+        return timestamp < version.first;
+      });
   itr--;
   return itr->second.get();
 }
 
 const Schema* VersionedCatalog::GetLatestSchema() const {
-  return GetSchema(absl::InfiniteFuture());
+  return schemas_.load(std::memory_order_acquire)->back().second.get();
+}
+
+std::shared_ptr<const Schema> VersionedCatalog::GetSharedLatestSchema() const {
+  return schemas_.load(std::memory_order_acquire)->back().second;
 }
 
 absl::Status VersionedCatalog::AddSchema(absl::Time creation_time,
                                          std::unique_ptr<const Schema> schema) {
   absl::MutexLock lock(&mu_);
-  ZETASQL_RET_CHECK(creation_time > schemas_.rbegin()->first)
+  const SchemaVersions* current = schemas_.load(std::memory_order_relaxed);
+  ZETASQL_RET_CHECK(creation_time > current->back().first)
       << "Failed to insert schema at " << absl::FormatTime(creation_time)
       << ": the latest schema creation timestamp is "
-      << absl::FormatTime(schemas_.rbegin()->first);
-  schemas_[creation_time] = std::move(schema);
+      << absl::FormatTime(current->back().first);
+  auto schemas = std::make_unique<SchemaVersions>();
+  schemas->reserve(current->size() + 1);
+  *schemas = *current;
+  schemas->emplace_back(creation_time, std::move(schema));
+  schemas_.store(schemas.get(), std::memory_order_release);
+  snapshots_.push_back(std::move(schemas));
   return absl::OkStatus();
 }
 
@@ -17,8 +17,10 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_SCHEMA_CATALOG_VERSIONED_CATALOG_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_SCHEMA_CATALOG_VERSIONED_CATALOG_H_
 
-#include <map>
+#include <atomic>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
@@ -33,6 +35,10 @@ namespace backend {
 
 // VersionedCatalog owns schemas that belongs to a single database, and keep a
 // mapping between the schema creation time and the schema object.
+//
+// Schema lookups happen on every transaction and read while schema changes are
+// rare, so lookups are wait-free: the schema versions are published as an
+// immutable snapshot that AddSchema replaces atomically.
 class VersionedCatalog {
  public:
   // The default constructor creates an empty schema in the catalog and assigns
@@ -41,20 +47,26 @@ class VersionedCatalog {
 
   // The single-argument constructor is used when a database is created with an
   // initial schema specified. The initial_schema is added to the catalog and
-  // absl::InfinitePast() is assigned as its creation timestamp.
-  explicit VersionedCatalog(std::unique_ptr<const Schema> initial_schema);
+  // absl::InfinitePast() is assigned as its creation timestamp. The initial
+  // schema may be shared with the catalogs of other databases created from the
+  // same schema (see backend/database/schema_template.h).
+  explicit VersionedCatalog(std::shared_ptr<const Schema> initial_schema);
 
   // Finds the newest schema that is created at or before a given timestamp and
   // returns a pointer to that schema object. There is always a first schema in
   // each VersionedCatalog, which has a creation timestamp of
   // absl::InfinitePast() (see comments of the constructors above). Therefore,
   // GetSchema never returns a nullptr.
-  const Schema* GetSchema(absl::Time timestamp) const ABSL_LOCKS_EXCLUDED(mu_);
+  const Schema* GetSchema(absl::Time timestamp) const;
 
   // Returns the latest schema object in the catalog. Will return the first
   // schema initialized if there are no subsequent new schema. Therefore,
   // GetLatestSchema never returns a nullptr.
-  const Schema* GetLatestSchema() const ABSL_LOCKS_EXCLUDED(mu_);
+  const Schema* GetLatestSchema() const;
+
+  // Returns the latest schema object in the catalog as a shared pointer, so
+  // that it can be shared with the catalog of a clone of the database.
+  std::shared_ptr<const Schema> GetSharedLatestSchema() const;
 
   // Adds a schema at a given timestamp. Returns an error if creation_time is
   // the same or prior to the largest timestamp in all of the schemas. In this
@@ -64,18 +76,24 @@ class VersionedCatalog {
       ABSL_LOCKS_EXCLUDED(mu_);
 
  private:
-  // For guarding concurrent access to `schemas_`.
-  mutable absl::Mutex mu_;
-
-  // A mapping between the creation time of each schema in the catalog and the
-  // schema objects. Used to look up schema at a specific point in time. A first
-  // schema is always created in the constructors. Therefore, this map is never
-  // empty.
-  //
-  // Note that this cannot be changed into a hash map (e.g. std::unordered_map)
-  // because the lookup of schemas by creation timestamp depends on the ordering
-  // of keys in this map.
-  std::map<absl::Time, std::unique_ptr<const Schema>> schemas_
+  // The creation time of each schema in the catalog and the schema objects,
+  // sorted by creation time. Used to look up schema at a specific point in
+  // time. A first schema is always created in the constructors. Therefore,
+  // this is never empty.
+  using SchemaVersions =
+      std::vector<std::pair<absl::Time, std::shared_ptr<const Schema>>>;
+
+  // Serializes AddSchema calls.
+  absl::Mutex mu_;
+
+  // The current snapshot of schema versions. Readers load it without locking.
+  std::atomic<const SchemaVersions*> schemas_;
+
+  // Every snapshot ever published, including the current one. Replaced
+  // snapshots are kept until the catalog is destroyed because readers may
+  // still be searching them, and the schemas they hold are handed out as raw
+  // pointers that stay valid for the catalog's lifetime anyway.
+  std::vector<std::unique_ptr<const SchemaVersions>> snapshots_
       ABSL_GUARDED_BY(mu_);
 };
 
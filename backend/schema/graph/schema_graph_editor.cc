@@ -19,9 +19,11 @@
 #include <algorithm>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "zetasql/base/logging.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -60,7 +62,9 @@ absl::Status SchemaGraphEditor::FixupInternal(const SchemaNode* original,
   ZETASQL_VLOG(4) << std::string(depth_, ' ') << "Fixing "
           << NodeKindString(mutable_clone) << " node :" << mutable_clone;
   ++depth_;
+  fixing_nodes_.push_back(mutable_clone);
   ZETASQL_RETURN_IF_ERROR(mutable_clone->DeepClone(this, original));
+  fixing_nodes_.pop_back();
   --depth_;
   ZETASQL_VLOG(4) << std::string(depth_, ' ')
           << "Finished fixing node: " << mutable_clone->DebugString();
@@ -111,6 +115,9 @@ absl::StatusOr<const SchemaNode*> SchemaGraphEditor::Clone(
             << "Finished cloning node: " << node->DebugString();
     ret = mutable_clone;
   }
+  if (!fixing_nodes_.empty()) {
+    referencing_nodes_[ret].push_back(fixing_nodes_.back());
+  }
   return ret;
 }
 
@@ -128,17 +135,13 @@ absl::Status SchemaGraphEditor::AddNode(
   ZETASQL_RET_CHECK_EQ(deleted_node_, nullptr)
       << "Graph already has a deleted node. It must be canonicalized before "
       << "making further changes.";
+  added_node_set_.insert(node.get());
   added_nodes_.emplace_back(std::move(node));
   return absl::OkStatus();
 }
 
 bool SchemaGraphEditor::IsOriginalNode(const SchemaNode* node) const {
-  for (const auto* schema_node : original_graph_->GetSchemaNodes()) {
-    if (schema_node == node) {
-      return true;
-    }
-  }
-  return false;
+  return original_nodes_.contains(node);
 }
 
 absl::StatusOr<std::unique_ptr<SchemaGraph>>
@@ -169,12 +172,22 @@ SchemaGraphEditor::CanonicalizeGraph() {
                                                std::move(cloned_pool_));
   context_->MakeNewTempSchemaSnapshot(cloned_graph.get());
 
+  // Nodes that neither changed nor reach a changed node were validated with
+  // the same state by a previous schema change, so only the others are
+  // validated again. The set still includes deleted nodes at this point.
+  const bool validate_all_nodes = validate_all_nodes_;
+  absl::flat_hash_set<const SchemaNode*> nodes_to_validate =
+      validate_all_nodes ? absl::flat_hash_set<const SchemaNode*>()
+                         : NodesToValidate();
+
   // Validate the update on cloned nodes which still includes edited and
   // deleted nodes.
   for (const auto* orig_node : original_graph_->GetSchemaNodes()) {
     auto clone = FindClone(orig_node);
     ZETASQL_RET_CHECK_NE(clone, nullptr);
-    ZETASQL_RETURN_IF_ERROR(clone->ValidateUpdate(orig_node, context_));
+    if (validate_all_nodes || nodes_to_validate.contains(clone)) {
+      ZETASQL_RETURN_IF_ERROR(clone->ValidateUpdate(orig_node, context_));
+    }
   }
 
   // Finally, erase deleted nodes from the new graph.
@@ -183,11 +196,18 @@ SchemaGraphEditor::CanonicalizeGraph() {
   }
 
   // Do a final pass on the canonicalized set of nodes to perform per-node
-  // validation.
+  // validation, in graph order.
   for (const auto* node : cloned_graph->GetSchemaNodes()) {
-    ZETASQL_RETURN_IF_ERROR(node->Validate(context_));
+    if (validate_all_nodes || nodes_to_validate.contains(node)) {
+      ZETASQL_RETURN_IF_ERROR(node->Validate(context_));
+    }
   }
   context_->ClearNewTempSchemaSnapshot();
+  // The deleted nodes in `nodes_to_validate` have been freed by Trim(), so the
+  // changed nodes are left unknown after a deletion.
+  if (!validate_all_nodes && deleted_node_ == nullptr) {
+    changed_nodes_ = std::move(nodes_to_validate);
+  }
 
   // Check the invariants around the nodes.
   ZETASQL_RET_CHECK_EQ(cloned_pool_ptr->size(), cloned_graph->GetSchemaNodes().size())
@@ -234,6 +254,29 @@ absl::Status SchemaGraphEditor::CanonicalizeEdits() {
   return absl::OkStatus();
 }
 
+absl::flat_hash_set<const SchemaNode*> SchemaGraphEditor::NodesToValidate()
+    const {
+  absl::flat_hash_set<const SchemaNode*> nodes(edited_clones_.begin(),
+                                               edited_clones_.end());
+  nodes.insert(added_node_set_.begin(), added_node_set_.end());
+  nodes.insert(deleted_clones_.begin(), deleted_clones_.end());
+  std::vector<const SchemaNode*> pending(nodes.begin(), nodes.end());
+  while (!pending.empty()) {
+    const SchemaNode* node = pending.back();
+    pending.pop_back();
+    auto it = referencing_nodes_.find(node);
+    if (it == referencing_nodes_.end()) {
+      continue;
+    }
+    for (const SchemaNode* referencing_node : it->second) {
+      if (nodes.insert(referencing_node).second) {
+        pending.push_back(referencing_node);
+      }
+    }
+  }
+  return nodes;
+}
+
 absl::Status SchemaGraphEditor::Fixup(const SchemaNode* node) {
   ZETASQL_ASSIGN_OR_RETURN(const auto* cloned_node, Clone(node));
   ZETASQL_RET_CHECK_NE(cloned_node, nullptr);
@@ -277,6 +320,15 @@ absl::Status SchemaGraphEditor::CanonicalizeDeletion() {
     ZETASQL_VLOG(5) << "Fixup pass " << i + 1 << " deletions: " << new_deletions;
   }
   delete_fixup_ = false;
+
+  // The references recorded by InitCloneMap() still include the ones to the
+  // deleted nodes, so NodesToValidate() can start from them.
+  for (const auto* node : original_graph_->GetSchemaNodes()) {
+    const SchemaNode* clone = FindClone(node);
+    if (clone->is_deleted()) {
+      deleted_clones_.push_back(clone);
+    }
+  }
   return absl::OkStatus();
 }
 
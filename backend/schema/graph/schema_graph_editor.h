@@ -19,6 +19,9 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -62,6 +65,8 @@ class SchemaGraphEditor {
   SchemaGraphEditor(const SchemaGraph* original_graph,
                     SchemaValidationContext* context)
       : original_graph_(original_graph),
+        original_nodes_(original_graph->GetSchemaNodes().begin(),
+                        original_graph->GetSchemaNodes().end()),
         context_(context),
         cloned_pool_(std::make_unique<SchemaObjectsPool>()) {
     context_->set_added_nodes(&added_nodes_);
@@ -157,6 +162,12 @@ class SchemaGraphEditor {
     return CloneContainer<T>(nodes);
   }
 
+  // Makes CanonicalizeGraph() call ValidateUpdate() and Validate() on every
+  // node, for changes that can affect nodes without editing them (such as a new
+  // proto bundle). Otherwise only the nodes that were added, edited or deleted,
+  // and the nodes that reference them directly or transitively, are validated.
+  void RequireFullValidation() { validate_all_nodes_ = true; }
+
   // Returns true if the graph has any modifications.
   bool HasModifications() const {
     return deleted_node_ != nullptr || !edited_clones_.empty() ||
@@ -166,6 +177,16 @@ class SchemaGraphEditor {
   // Returns a pointer to the original schema graph.
   const SchemaGraph* original_graph() const { return original_graph_; }
 
+  // After CanonicalizeGraph(), returns the nodes of the new graph that were
+  // added or edited, and the nodes that reference them directly or
+  // transitively. All other nodes are unchanged clones of the original ones.
+  // Returns std::nullopt if the changed nodes are not known, which is the case
+  // if a node was deleted or full validation was required.
+  const std::optional<absl::flat_hash_set<const SchemaNode*>>& changed_nodes()
+      const {
+    return changed_nodes_;
+  }
+
  private:
   const SchemaNode* FindClone(const SchemaNode* node) const {
     auto it = clone_map_.find(node);
@@ -202,12 +223,7 @@ class SchemaGraphEditor {
     if (IsOriginalNode(node)) {
       return kOriginal;
     }
-    auto it = std::find_if(
-        added_nodes_.begin(), added_nodes_.end(),
-        [&node](const std::unique_ptr<const SchemaNode>& node_ptr) {
-          return node_ptr.get() == node;
-        });
-    if (it != added_nodes_.end()) {
+    if (added_node_set_.contains(node)) {
       return kAdded;
     }
     if (node == deleted_node_) {
@@ -247,12 +263,21 @@ class SchemaGraphEditor {
   // Canonicalizes the graph to process any pending deletes.
   absl::Status CanonicalizeDeletion();
 
+  // Returns the nodes whose validity may have changed: the added, edited and
+  // deleted nodes and every node referencing one of them, directly or through
+  // other nodes.
+  absl::flat_hash_set<const SchemaNode*> NodesToValidate() const;
+
   // The current depth of the cloning stack.
   int depth_ = 0;
 
   // The original graph.
   const SchemaGraph* original_graph_ = nullptr;
 
+  // The nodes of the original graph. Every node visited while cloning is
+  // classified against this set, so it must not be a scan of the graph.
+  const absl::flat_hash_set<const SchemaNode*> original_nodes_;
+
   // Validation context passed to Validate() and ValidateUpdate() methods for
   // SchemaNode.
   // This is also being used in SchemaUpdaterImpl. This is kept as a pointer
@@ -271,6 +296,17 @@ class SchemaGraphEditor {
   // If true, the SchemaGraph is being visited in the delete fixup phase.
   bool delete_fixup_ = false;
 
+  // The nodes whose DeepClone() is in progress, innermost last.
+  std::vector<const SchemaNode*> fixing_nodes_;
+
+  // For each node of the new graph, the nodes of the new graph that reference
+  // it, as recorded by the Clone() calls made from DeepClone().
+  absl::flat_hash_map<const SchemaNode*, std::vector<const SchemaNode*>>
+      referencing_nodes_;
+
+  // If true, every node of the new graph is validated.
+  bool validate_all_nodes_ = false;
+
   // The set of nodes (cloned + newly added) that will constitue
   // the new SchemaGraph.
   std::vector<const SchemaNode*> new_nodes_;
@@ -287,8 +323,19 @@ class SchemaGraphEditor {
   // The nodes added to the graph.
   std::vector<std::unique_ptr<const SchemaNode>> added_nodes_;
 
+  // The nodes in `added_nodes_`, which remain in the set after being moved to
+  // the cloned pool.
+  absl::flat_hash_set<const SchemaNode*> added_node_set_;
+
   // Clones that were modified/edited.
   absl::flat_hash_set<const SchemaNode*> edited_clones_;
+
+  // Clones marked deleted by CanonicalizeDeletion(), including the ones
+  // deleted because a node they depend on was deleted.
+  std::vector<const SchemaNode*> deleted_clones_;
+
+  // The nodes returned by changed_nodes().
+  std::optional<absl::flat_hash_set<const SchemaNode*>> changed_nodes_;
 };
 
 }  // namespace backend
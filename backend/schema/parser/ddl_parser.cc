@@ -17,6 +17,7 @@
 
 #include "backend/schema/parser/ddl_parser.h"
 
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -27,7 +28,10 @@
 #include "google/protobuf/descriptor.h"
 #include "absl/algorithm/container.h"
 #include "zetasql/base/no_destructor.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
@@ -38,6 +42,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "backend/schema/ddl/operations.pb.h"
 #include "backend/schema/parser/DDLParserTokenManager.h"
 #include "backend/schema/parser/DDLParserTree.h"
@@ -52,6 +57,10 @@
 #include "common/limits.h"
 #include "zetasql/base/status_macros.h"
 
+ABSL_FLAG(int64_t, ddl_parser_cache_max_statements, 10000,
+          "Maximum number of parsed DDL statements kept for reuse when the "
+          "same statement is parsed again. 0 disables the cache.");
+
 namespace google {
 namespace spanner {
 namespace emulator {
@@ -2216,6 +2225,55 @@ void BuildCloudDDLStatement(const SimpleNode* root, absl::string_view ddl_text,
   }
 }
 
+// Parse results of DDL statements, keyed by the statement text. Parsing only
+// depends on the text, and the same schemas tend to be applied over and over
+// (e.g. by every test of a suite), so successful parses are kept and reused.
+// Failed parses are not cached.
+class ParsedStatementCache {
+ public:
+  static ParsedStatementCache* Get() {
+    static zetasql_base::NoDestructor<ParsedStatementCache> cache;
+    return cache.get();
+  }
+
+  // Copies the cached parse of `ddl` into `statement`. Returns false if `ddl`
+  // is not cached.
+  bool Lookup(absl::string_view ddl, DDLStatement* statement) {
+    absl::MutexLock lock(&mu_);
+    auto it = statements_.find(ddl);
+    if (it == statements_.end()) {
+      return false;
+    }
+    *statement = it->second;
+    return true;
+  }
+
+  void Insert(absl::string_view ddl, const DDLStatement& statement) {
+    const int64_t max_statements =
+        absl::GetFlag(FLAGS_ddl_parser_cache_max_statements);
+    if (max_statements <= 0) {
+      return;
+    }
+    absl::MutexLock lock(&mu_);
+    // Start over rather than tracking recency: a full cache means the
+    // statements being parsed are not the repeated ones it is meant for.
+    if (statements_.size() >= static_cast<size_t>(max_statements)) {
+      statements_.clear();
+    }
+    statements_.try_emplace(ddl, statement);
+  }
+
+  void Clear() {
+    absl::MutexLock lock(&mu_);
+    statements_.clear();
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, DDLStatement> statements_
+      ABSL_GUARDED_BY(mu_);
+};
+
 absl::Status UnvalidatedParseCloudDDLStatement(absl::string_view ddl,
                                                DDLStatement* statement) {
   // Special case: JavaCC doesn't like parsing a completely empty string. Return
@@ -2248,9 +2306,17 @@ absl::Status UnvalidatedParseCloudDDLStatement(absl::string_view ddl,
 }  // namespace
 
 absl::Status ParseDDLStatement(absl::string_view ddl, DDLStatement* statement) {
-  return UnvalidatedParseCloudDDLStatement(ddl, statement);
+  ParsedStatementCache* cache = ParsedStatementCache::Get();
+  if (cache->Lookup(ddl, statement)) {
+    return absl::OkStatus();
+  }
+  ZETASQL_RETURN_IF_ERROR(UnvalidatedParseCloudDDLStatement(ddl, statement));
+  cache->Insert(ddl, *statement);
+  return absl::OkStatus();
 }
 
+void ClearParsedDDLStatementCache() { ParsedStatementCache::Get()->Clear(); }
+
 }  // namespace ddl
 }  // namespace backend
 }  // namespace emulator
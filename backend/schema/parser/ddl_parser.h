@@ -17,15 +17,19 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_SCHEMA_PARSER_DDL_PARSER_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_SCHEMA_PARSER_DDL_PARSER_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
 #include "zetasql/base/no_destructor.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/flags/declare.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "backend/schema/ddl/operations.pb.h"
 
+ABSL_DECLARE_FLAG(int64_t, ddl_parser_cache_max_statements);
+
 namespace google {
 namespace spanner {
 namespace emulator {
@@ -59,8 +63,14 @@ extern const char kModelEndpointsOptionName[];
 extern const char kWitnessLocationOptionName[];
 extern const char kDefaultLeaderOptionName[];
 
+// Parses `ddl` into `statement`. Successful parses are cached (see
+// --ddl_parser_cache_max_statements), so parsing the same statement text again
+// returns a copy of the earlier result.
 absl::Status ParseDDLStatement(absl::string_view ddl, DDLStatement* statement);
 
+// Drops all cached parse results.
+void ClearParsedDDLStatementCache();
+
 }  // namespace ddl
 }  // namespace backend
 }  // namespace emulator
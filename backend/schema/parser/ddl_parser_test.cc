@@ -26,6 +26,8 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/substitute.h"
@@ -5110,6 +5112,50 @@ TEST(ParseFGAC, RevokeMembership) {
                 })pb")));
 }
 
+TEST(ParseDDLStatementCache, RepeatedParseReturnsSameStatement) {
+  ClearParsedDDLStatementCache();
+  const std::string ddl = R"sql(
+    CREATE TABLE Users (
+      UserId INT64 NOT NULL,
+      Name STRING(MAX)
+    ) PRIMARY KEY (UserId)
+  )sql";
+  ZETASQL_ASSERT_OK_AND_ASSIGN(DDLStatement first, ParseDDLStatement(ddl));
+  EXPECT_THAT(ParseDDLStatement(ddl), IsOkAndHolds(test::EqualsProto(first)));
+}
+
+TEST(ParseDDLStatementCache, FailedParseIsNotCached) {
+  ClearParsedDDLStatementCache();
+  EXPECT_THAT(ParseDDLStatement("CREATE TABLE"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ParseDDLStatement("CREATE TABLE"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ParseDDLStatementCache, ParsesWithCacheDisabled) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_ddl_parser_cache_max_statements, 0);
+  ClearParsedDDLStatementCache();
+  const std::string ddl = "CREATE TABLE T (K INT64) PRIMARY KEY (K)";
+  ZETASQL_ASSERT_OK_AND_ASSIGN(DDLStatement first, ParseDDLStatement(ddl));
+  EXPECT_THAT(ParseDDLStatement(ddl), IsOkAndHolds(test::EqualsProto(first)));
+}
+
+TEST(ParseDDLStatementCache, ParsesWhenCacheIsFull) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_ddl_parser_cache_max_statements, 1);
+  ClearParsedDDLStatementCache();
+  ZETASQL_EXPECT_OK(ParseDDLStatement("CREATE TABLE T1 (K INT64) PRIMARY KEY (K)"));
+  EXPECT_THAT(ParseDDLStatement("CREATE TABLE T2 (K INT64) PRIMARY KEY (K)"),
+              IsOkAndHolds(test::EqualsProto(R"pb(
+                create_table {
+                  table_name: "T2"
+                  column { column_name: "K" type: INT64 }
+                  primary_key { key_name: "K" }
+                })pb")));
+}
+
+
 }  // namespace
 
 }  // namespace ddl
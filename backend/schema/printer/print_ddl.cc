@@ -90,6 +90,53 @@ std::string TypeToString(const zetasql::Type* type,
   return type_name;
 }
 
+// Appends `name` to `out`, quoting it if it is a reserved word.
+void AppendName(const std::string& name, std::string* out) {
+  if (ddl::IsReservedWord(name)) {
+    absl::StrAppend(out, "`", name, "`");
+  } else {
+    absl::StrAppend(out, name);
+  }
+}
+
+void AppendColumn(const Column* column, std::string* out) {
+  AppendName(column->Name(), out);
+  absl::StrAppend(
+      out, " ",
+      ColumnTypeToString(column->GetType(), column->declared_max_length()));
+  if (!column->is_nullable()) {
+    absl::StrAppend(out, " NOT NULL");
+  }
+  if (column->is_generated()) {
+    absl::StrAppend(out, " AS ", column->expression().value(), " STORED");
+  } else if (column->has_default_value()) {
+    absl::StrAppend(out, " DEFAULT (", column->expression().value(), ")");
+  }
+  if (column->GetType()->IsTimestamp() &&
+      column->has_allows_commit_timestamp()) {
+    absl::StrAppend(out, " OPTIONS (\n    allow_commit_timestamp = ",
+                    column->allows_commit_timestamp() ? "true" : "false",
+                    "\n  )");
+  }
+}
+
+void AppendKeyColumn(const KeyColumn* column, std::string* out) {
+  AppendName(column->column()->Name(), out);
+  if (column->is_descending()) {
+    absl::StrAppend(out, " DESC");
+  }
+}
+
+void AppendKeyColumnList(absl::Span<const KeyColumn* const> columns,
+                         std::string* out) {
+  for (int i = 0; i < columns.size(); ++i) {
+    if (i > 0) {
+      absl::StrAppend(out, ", ");
+    }
+    AppendKeyColumn(columns[i], out);
+  }
+}
+
 }  // namespace
 
 std::string OnDeleteActionToString(Table::OnDeleteAction action) {
@@ -131,34 +178,15 @@ std::string ColumnTypeToString(const zetasql::Type* type,
 }
 
 std::string PrintColumn(const Column* column) {
-  std::string ddl_string = PrintName(column->Name());
-  absl::StrAppend(
-      &ddl_string, " ",
-      ColumnTypeToString(column->GetType(), column->declared_max_length()));
-  if (!column->is_nullable()) {
-    absl::StrAppend(&ddl_string, " NOT NULL");
-  }
-  if (column->is_generated()) {
-    absl::StrAppend(
-        &ddl_string,
-        absl::Substitute(" AS $0 STORED", column->expression().value()));
-  } else if (column->has_default_value()) {
-    absl::StrAppend(
-        &ddl_string,
-        absl::Substitute(" DEFAULT ($0)", column->expression().value()));
-  }
-  if (column->GetType()->IsTimestamp() &&
-      column->has_allows_commit_timestamp()) {
-    absl::StrAppend(&ddl_string, " OPTIONS (\n    allow_commit_timestamp = ",
-                    column->allows_commit_timestamp() ? "true" : "false",
-                    "\n  )");
-  }
+  std::string ddl_string;
+  AppendColumn(column, &ddl_string);
   return ddl_string;
 }
 
 std::string PrintKeyColumn(const KeyColumn* column) {
-  return absl::Substitute("$0$1", PrintName(column->column()->Name()),
-                          (column->is_descending() ? " DESC" : ""));
+  std::string ddl_string;
+  AppendKeyColumn(column, &ddl_string);
+  return ddl_string;
 }
 
 std::string PrintIndex(const Index* index) {
@@ -167,22 +195,12 @@ std::string PrintIndex(const Index* index) {
                   (index->is_null_filtered() ? " NULL_FILTERED" : ""),
                   " INDEX ", PrintName(index->Name()), " ON ",
                   PrintName(index->indexed_table()->Name()), "(");
-
-  std::vector<std::string> pk_clause;
-  pk_clause.reserve(index->key_columns().size());
-  for (int i = 0; i < index->key_columns().size(); ++i) {
-    pk_clause.push_back(PrintKeyColumn(index->key_columns()[i]));
-  }
-  absl::StrAppend(&ddl_string, absl::StrJoin(pk_clause, ", "), ")");
+  AppendKeyColumnList(index->key_columns(), &ddl_string);
+  absl::StrAppend(&ddl_string, ")");
 
   if (!index->stored_columns().empty()) {
-    absl::StrAppend(&ddl_string, " STORING (");
-    std::vector<std::string> storing_clause;
-    storing_clause.reserve(index->stored_columns().size());
-    for (int i = 0; i < index->stored_columns().size(); ++i) {
-      storing_clause.push_back(PrintName(index->stored_columns()[i]->Name()));
-    }
-    absl::StrAppend(&ddl_string, absl::StrJoin(storing_clause, ", "), ")");
+    absl::StrAppend(&ddl_string, " STORING (",
+                    PrintColumnNameList(index->stored_columns()), ")");
   }
 
   if (index->parent()) {
@@ -345,10 +363,18 @@ std::string PrintModel(const Model* model) {
 }
 
 std::string PrintTable(const Table* table) {
-  std::string table_string =
-      absl::Substitute("CREATE TABLE $0 (\n", PrintName(table->Name()));
+  // Columns make up most of a table's DDL; reserve a rough per-column budget
+  // up front so that appending them does not keep reallocating the buffer.
+  constexpr int kEstimatedColumnLength = 48;
+  std::string table_string;
+  table_string.reserve(64 + kEstimatedColumnLength * table->columns().size());
+  absl::StrAppend(&table_string, "CREATE TABLE ");
+  AppendName(table->Name(), &table_string);
+  absl::StrAppend(&table_string, " (\n");
   for (const Column* column : table->columns()) {
-    absl::StrAppend(&table_string, "  ", PrintColumn(column), ",\n");
+    absl::StrAppend(&table_string, "  ");
+    AppendColumn(column, &table_string);
+    absl::StrAppend(&table_string, ",\n");
   }
   for (const ForeignKey* foreign_key : table->foreign_keys()) {
     absl::StrAppend(&table_string, "  ", PrintForeignKey(foreign_key), ",\n");
@@ -362,13 +388,7 @@ std::string PrintTable(const Table* table) {
                     "),\n");
   }
   absl::StrAppend(&table_string, ") PRIMARY KEY(");
-
-  std::vector<std::string> pk_clause;
-  pk_clause.reserve(table->primary_key().size());
-  for (int i = 0; i < table->primary_key().size(); ++i) {
-    pk_clause.push_back(PrintKeyColumn(table->primary_key()[i]));
-  }
-  absl::StrAppend(&table_string, absl::StrJoin(pk_clause, ", "));
+  AppendKeyColumnList(table->primary_key(), &table_string);
 
   if (table->parent() != nullptr) {
     absl::StrAppend(&table_string, "),\n");
@@ -380,10 +400,10 @@ std::string PrintTable(const Table* table) {
   }
 
   if (table->row_deletion_policy().has_value()) {
-    absl::StrAppend(&table_string, ", ROW DELETION POLICY (");
-    absl::StrAppend(&table_string, RowDeletionPolicyToString(
-                                       table->row_deletion_policy().value()));
-    absl::StrAppend(&table_string, ")");
+    absl::StrAppend(&table_string, ", ROW DELETION POLICY (",
+                    RowDeletionPolicyToString(
+                        table->row_deletion_policy().value()),
+                    ")");
   }
   return table_string;
 }
@@ -541,6 +561,12 @@ absl::StatusOr<std::vector<std::string>> PrintDDLStatements(
   return statements;
 }
 
+absl::StatusOr<std::shared_ptr<const std::vector<std::string>>>
+GetDDLStatements(const Schema* schema) {
+  return schema->GetOrPrintDDLStatements(
+      [schema]() { return PrintDDLStatements(schema); });
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
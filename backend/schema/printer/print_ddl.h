@@ -85,6 +85,11 @@ std::string PrintProtoBundle(std::shared_ptr<const ProtoBundle> proto_bundle);
 absl::StatusOr<std::vector<std::string>> PrintDDLStatements(
     const Schema* schema);
 
+// Same as PrintDDLStatements, but the statements are printed at most once per
+// schema and shared by all callers afterwards.
+absl::StatusOr<std::shared_ptr<const std::vector<std::string>>>
+GetDDLStatements(const Schema* schema);
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -0,0 +1,138 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/schema/updater/parallel_scan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/storage/iterator.h"
+#include "backend/storage/storage.h"
+#include "third_party/spanner_pg/interface/pg_arena.h"
+#include "third_party/spanner_pg/shims/memory_context_pg_arena.h"
+#include "zetasql/base/status_macros.h"
+
+ABSL_FLAG(int64_t, schema_scan_rows_per_range, 64 * 1024,
+          "Number of rows of a table in each key range which is processed "
+          "independently by a schema change.");
+
+ABSL_FLAG(int, schema_scan_threads, 8,
+          "Maximum number of threads which process key ranges during a schema "
+          "change.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+absl::StatusOr<std::vector<KeyRange>> SplitTableIntoKeyRanges(
+    const Storage* storage, absl::Time timestamp, const TableID& table_id) {
+  return SplitTableIntoKeyRanges(
+      storage, timestamp, table_id,
+      absl::GetFlag(FLAGS_schema_scan_rows_per_range));
+}
+
+absl::StatusOr<std::vector<KeyRange>> SplitTableIntoKeyRanges(
+    const Storage* storage, absl::Time timestamp, const TableID& table_id,
+    int64_t rows_per_range) {
+  rows_per_range = std::max<int64_t>(1, rows_per_range);
+  std::unique_ptr<StorageIterator> itr;
+  ZETASQL_RETURN_IF_ERROR(
+      storage->Read(timestamp, table_id, KeyRange::All(), {}, &itr));
+
+  std::vector<KeyRange> ranges;
+  Key start_key = KeyRange::All().start_key();
+  int64_t num_rows = 0;
+  while (itr->Next()) {
+    if (num_rows > 0 && num_rows % rows_per_range == 0) {
+      ranges.push_back(KeyRange::ClosedOpen(start_key, itr->Key()));
+      start_key = itr->Key();
+    }
+    ++num_rows;
+  }
+  ZETASQL_RETURN_IF_ERROR(itr->Status());
+  ranges.push_back(
+      KeyRange::ClosedOpen(start_key, KeyRange::All().limit_key()));
+  return ranges;
+}
+
+absl::Status ProcessKeyRanges(
+    int num_ranges, const std::function<absl::Status(int)>& process_range) {
+  return ProcessKeyRanges(num_ranges, absl::GetFlag(FLAGS_schema_scan_threads),
+                          process_range);
+}
+
+absl::Status ProcessKeyRanges(
+    int num_ranges, int max_threads,
+    const std::function<absl::Status(int)>& process_range) {
+  const int num_threads = std::min<int>(num_ranges, max_threads);
+  if (num_threads <= 1) {
+    for (int i = 0; i < num_ranges; ++i) {
+      ZETASQL_RETURN_IF_ERROR(process_range(i));
+    }
+    return absl::OkStatus();
+  }
+
+  std::vector<absl::Status> statuses(num_ranges);
+  std::atomic<int> next_range = 0;
+  std::atomic<int> first_failed_range = num_ranges;
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&]() {
+      // Comparing PG.NUMERIC keys and evaluating PG expressions calls into PG,
+      // which requires a PG arena on every thread.
+      absl::StatusOr<std::unique_ptr<postgres_translator::interfaces::PGArena>>
+          arena = postgres_translator::spangres::MemoryContextPGArena::Init(
+              nullptr);
+      for (int i = next_range++; i < num_ranges; i = next_range++) {
+        if (i > first_failed_range.load()) {
+          continue;
+        }
+        statuses[i] = arena.ok() ? process_range(i) : arena.status();
+        if (!statuses[i].ok()) {
+          int failed = first_failed_range.load();
+          while (i < failed &&
+                 !first_failed_range.compare_exchange_weak(failed, i)) {
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return first_failed_range < num_ranges ? statuses[first_failed_range]
+                                         : absl::OkStatus();
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,75 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_SCHEMA_UPDATER_PARALLEL_SCAN_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_SCHEMA_UPDATER_PARALLEL_SCAN_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "absl/flags/declare.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "backend/common/ids.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/storage/storage.h"
+
+// Number of rows of a table in each key range which is processed independently
+// by a schema change (index backfills and constraint verification).
+ABSL_DECLARE_FLAG(int64_t, schema_scan_rows_per_range);
+
+// Maximum number of threads which process key ranges during a schema change.
+ABSL_DECLARE_FLAG(int, schema_scan_threads);
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Splits the table `table_id` into contiguous key ranges holding about
+// --schema_scan_rows_per_range rows each. The returned ranges cover the whole
+// key space of the table, in key order.
+absl::StatusOr<std::vector<KeyRange>> SplitTableIntoKeyRanges(
+    const Storage* storage, absl::Time timestamp, const TableID& table_id);
+
+// Same as above, but with about `rows_per_range` rows in each key range.
+absl::StatusOr<std::vector<KeyRange>> SplitTableIntoKeyRanges(
+    const Storage* storage, absl::Time timestamp, const TableID& table_id,
+    int64_t rows_per_range);
+
+// Calls `process_range(i)` for every i in [0, num_ranges) using up to
+// --schema_scan_threads threads, each of which owns a PG arena.
+//
+// Once a range fails, ranges after it which have not yet started are skipped.
+// Ranges before it are always processed, so the returned status is that of
+// the first failing range in range order, regardless of thread scheduling.
+absl::Status ProcessKeyRanges(
+    int num_ranges, const std::function<absl::Status(int)>& process_range);
+
+// Same as above, but using up to `max_threads` threads.
+absl::Status ProcessKeyRanges(
+    int num_ranges, int max_threads,
+    const std::function<absl::Status(int)>& process_range);
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_SCHEMA_UPDATER_PARALLEL_SCAN_H_
@@ -101,6 +101,7 @@
 #include "common/errors.h"
 #include "common/feature_flags.h"
 #include "common/limits.h"
+#include "common/tracing.h"
 #include "third_party/spanner_pg/ddl/ddl_translator.h"
 #include "third_party/spanner_pg/ddl/pg_to_spanner_ddl_translator.h"
 #include "third_party/spanner_pg/interface/emulator_parser.h"
@@ -135,6 +136,24 @@ struct ColumnsUsedByIndex {
   std::vector<const Column*> null_filtered_columns;
 };
 
+// The tables and columns that a change stream is registered on, and the ones
+// among them that it tracks explicitly by name.
+struct ChangeStreamTrackedObjects {
+  absl::flat_hash_set<const Table*> tables;
+  absl::flat_hash_set<const Table*> explicitly_tracked_tables;
+  absl::flat_hash_set<const Column*> columns;
+  absl::flat_hash_set<const Column*> explicitly_tracked_columns;
+};
+
+bool IsChangeStreamIn(const ChangeStream* change_stream,
+                      absl::Span<const ChangeStream* const> change_streams) {
+  return std::any_of(change_streams.begin(), change_streams.end(),
+                     [change_stream](const ChangeStream* element) {
+                       return absl::EqualsIgnoreCase(change_stream->Name(),
+                                                     element->Name());
+                     });
+}
+
 // Get all the names of objects in a vector of objects. Useful for creating
 // error messages with multiple objects, i.e. getting all the names of tables in
 // a schema.
@@ -204,6 +223,7 @@ class SchemaUpdaterImpl {
         storage_(storage),
         schema_change_timestamp_(schema_change_ts),
         latest_schema_(existing_schema),
+        existing_schema_(existing_schema),
         editor_(nullptr),
         pg_oid_assigner_(pg_oid_assigner) {}
 
@@ -211,8 +231,11 @@ class SchemaUpdaterImpl {
   absl::Status Init();
 
   // Applies the given `statement` on to `latest_schema_`.
+  // `parsed_statement` is the result of parsing `statement`.
   absl::StatusOr<std::unique_ptr<const Schema>> ApplyDDLStatement(
-      absl::string_view statement, absl::string_view proto_descriptor_bytes,
+      absl::string_view statement,
+      absl::StatusOr<std::unique_ptr<ddl::DDLStatement>> parsed_statement,
+      absl::string_view proto_descriptor_bytes,
       const database_api::DatabaseDialect& dialect);
 
   // Run any pending schema actions resulting from the schema change statements.
@@ -301,6 +324,16 @@ class SchemaUpdaterImpl {
       const ChangeStream* change_stream);
   absl::Status UnregisterChangeStreamFromTrackedObjects(
       const ChangeStream* change_stream);
+  // Returns the tables and columns that `change_stream_for_clause` registers
+  // its change stream on, as RegisterTrackedObjects() does.
+  absl::StatusOr<ChangeStreamTrackedObjects> CollectTrackedObjects(
+      const ddl::ChangeStreamForClause& change_stream_for_clause);
+  // Registers `change_stream` on the tables and columns that
+  // `change_stream_for_clause` tracks, and unregisters it from the ones it no
+  // longer tracks. Only the objects whose registration changes are edited.
+  absl::Status UpdateTrackedObjects(
+      const ddl::ChangeStreamForClause& change_stream_for_clause,
+      const ChangeStream* change_stream);
   absl::Status BuildChangeStreamTrackedObjects(
       const ddl::ChangeStreamForClause& change_stream_for_clause,
       const ChangeStream* change_stream, ChangeStream::Builder* builder);
@@ -555,6 +588,14 @@ class SchemaUpdaterImpl {
   // Not owned.
   const Schema* latest_schema_;
 
+  // The schema the statements are applied to. Not owned.
+  const Schema* existing_schema_;
+
+  // The tables added or altered by the statements applied so far, or nullopt
+  // if they are not known.
+  std::optional<CaseInsensitiveStringSet> changed_tables_ =
+      CaseInsensitiveStringSet();
+
   // The intermediate schema snapshots representing the schema state after
   // applying each statement.
   std::vector<std::unique_ptr<const Schema>> intermediate_schemas_;
@@ -620,7 +661,9 @@ absl::Status ValidateDdlStatement(const ddl::DDLStatement& ddl,
 
 absl::StatusOr<std::unique_ptr<const Schema>>
 SchemaUpdaterImpl::ApplyDDLStatement(
-    absl::string_view statement, absl::string_view proto_descriptor_bytes,
+    absl::string_view statement,
+    absl::StatusOr<std::unique_ptr<ddl::DDLStatement>> parsed_statement,
+    absl::string_view proto_descriptor_bytes,
     const database_api::DatabaseDialect& dialect) {
   if (statement.empty()) {
     return error::EmptyDDLStatement();
@@ -628,7 +671,7 @@ SchemaUpdaterImpl::ApplyDDLStatement(
 
   ZETASQL_RET_CHECK(!editor_->HasModifications());
   ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<ddl::DDLStatement> ddl_statement,
-                   ParseDDLByDialect(statement, dialect));
+                   std::move(parsed_statement));
   ZETASQL_RETURN_IF_ERROR(ValidateDdlStatement(*ddl_statement, dialect));
   // Apply the statement to the schema graph.
   auto proto_bundle = latest_schema_->proto_bundle();
@@ -804,9 +847,33 @@ SchemaUpdaterImpl::ApplyDDLStatement(
   // generation). If there is a need to access proto_bundle after
   // validation, please use schema->proto_bundle().
   statement_context_->set_proto_bundle(proto_bundle);
+  // Columns are validated against the proto bundle, so a new bundle needs all
+  // of them validated again, not only the ones this statement changed.
+  if (proto_bundle != latest_schema_->proto_bundle()) {
+    editor_->RequireFullValidation();
+  }
   ZETASQL_ASSIGN_OR_RETURN(auto new_schema_graph, editor_->CanonicalizeGraph());
-  return std::make_unique<const OwningSchema>(std::move(new_schema_graph),
-                                              proto_bundle, dialect);
+  auto new_schema = std::make_unique<OwningSchema>(std::move(new_schema_graph),
+                                                   proto_bundle, dialect);
+
+  // Record which tables changed since the existing schema, so that derived
+  // state such as the information schema can be updated incrementally.
+  if (changed_tables_.has_value() && editor_->changed_nodes().has_value()) {
+    for (const SchemaNode* node : *editor_->changed_nodes()) {
+      if (const Table* table = node->As<const Table>(); table != nullptr) {
+        changed_tables_->insert(table->Name());
+      } else if (const Column* column = node->As<const Column>();
+                 column != nullptr) {
+        changed_tables_->insert(column->table()->Name());
+      }
+    }
+  } else {
+    changed_tables_.reset();
+  }
+  if (changed_tables_.has_value()) {
+    new_schema->SetTablesChangedSince(existing_schema_, *changed_tables_);
+  }
+  return std::unique_ptr<const Schema>(std::move(new_schema));
 }
 
 absl::StatusOr<std::vector<SchemaValidationContext>>
@@ -814,7 +881,19 @@ SchemaUpdaterImpl::ApplyDDLStatements(
     const SchemaChangeOperation& schema_change_operation) {
   std::vector<SchemaValidationContext> pending_work;
 
-  for (const auto& statement : schema_change_operation.statements) {
+  // Parse all statements up front so that PostgreSQL statements share one PG
+  // memory context. Parse errors are reported when their statement is applied,
+  // after the statements preceding it.
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::vector<absl::StatusOr<std::unique_ptr<ddl::DDLStatement>>>
+          parsed_statements,
+      ParseDDLStatementsByDialect(schema_change_operation.statements,
+                                  schema_change_operation.database_dialect));
+  ZETASQL_RET_CHECK_EQ(parsed_statements.size(),
+               schema_change_operation.statements.size());
+
+  for (int i = 0; i < schema_change_operation.statements.size(); ++i) {
+    const std::string& statement = schema_change_operation.statements[i];
     ZETASQL_VLOG(2) << "Applying statement " << statement;
 
     // Set up the SchemaValidationContext before passing it to `editor_`. This
@@ -847,7 +926,7 @@ SchemaUpdaterImpl::ApplyDDLStatements(
     // If there is a semantic validation error, then we return right away.
     ZETASQL_ASSIGN_OR_RETURN(
         auto new_schema,
-        ApplyDDLStatement(statement,
+        ApplyDDLStatement(statement, std::move(parsed_statements[i]),
                           schema_change_operation.proto_descriptor_bytes,
                           schema_change_operation.database_dialect));
 
@@ -1538,6 +1617,123 @@ absl::Status SchemaUpdaterImpl::UnregisterChangeStreamFromTrackedObjects(
   return absl::OkStatus();
 }
 
+absl::StatusOr<ChangeStreamTrackedObjects>
+SchemaUpdaterImpl::CollectTrackedObjects(
+    const ddl::ChangeStreamForClause& change_stream_for_clause) {
+  ChangeStreamTrackedObjects tracked;
+  auto add_table_with_columns = [&tracked](const Table* table) {
+    tracked.tables.insert(table);
+    for (const Column* column : table->columns()) {
+      // Key columns are not registered, same as in RegisterTrackedObjects().
+      if (column->is_trackable_by_change_stream() &&
+          !table->FindKeyColumn(column->Name())) {
+        tracked.columns.insert(column);
+      }
+    }
+  };
+  if (change_stream_for_clause.all()) {
+    for (const Table* table : latest_schema_->tables()) {
+      if (table->is_trackable_by_change_stream()) {
+        add_table_with_columns(table);
+      }
+    }
+    return tracked;
+  }
+
+  for (const auto& entry :
+       change_stream_for_clause.tracked_tables().table_entry()) {
+    const Table* table = latest_schema_->FindTable(entry.table_name());
+    ZETASQL_RET_CHECK(table != nullptr);
+    if (!table->is_trackable_by_change_stream()) {
+      return error::TrackUntrackableTables(entry.table_name());
+    }
+    tracked.explicitly_tracked_tables.insert(table);
+    if (entry.has_all_columns()) {
+      add_table_with_columns(table);
+    } else if (entry.has_tracked_columns()) {
+      for (const std::string& column_name :
+           entry.tracked_columns().column_name()) {
+        const Column* column = table->FindColumn(column_name);
+        ZETASQL_RET_CHECK(column != nullptr);
+        if (!column->is_trackable_by_change_stream()) {
+          return error::TrackUntrackableColumns(column_name);
+        }
+        tracked.columns.insert(column);
+        tracked.explicitly_tracked_columns.insert(column);
+      }
+    }
+  }
+  return tracked;
+}
+
+absl::Status SchemaUpdaterImpl::UpdateTrackedObjects(
+    const ddl::ChangeStreamForClause& change_stream_for_clause,
+    const ChangeStream* change_stream) {
+  ZETASQL_ASSIGN_OR_RETURN(const ChangeStreamTrackedObjects tracked,
+                   CollectTrackedObjects(change_stream_for_clause));
+  for (const Table* table : latest_schema_->tables()) {
+    const bool was_tracked =
+        IsChangeStreamIn(change_stream, table->change_streams());
+    const bool was_explicitly_tracked = IsChangeStreamIn(
+        change_stream, table->change_streams_explicitly_tracking_table());
+    const bool is_tracked = tracked.tables.contains(table);
+    const bool is_explicitly_tracked =
+        tracked.explicitly_tracked_tables.contains(table);
+    if (was_tracked != is_tracked ||
+        was_explicitly_tracked != is_explicitly_tracked) {
+      ZETASQL_RETURN_IF_ERROR(AlterNode<Table>(
+          table, [&](Table::Editor* editor) -> absl::Status {
+            if (was_tracked || was_explicitly_tracked) {
+              editor->remove_change_stream(change_stream);
+            }
+            if (is_tracked) {
+              editor->add_change_stream(change_stream);
+            }
+            if (is_explicitly_tracked) {
+              editor->add_change_stream_explicitly_tracking_table(
+                  change_stream);
+            }
+            return absl::OkStatus();
+          }));
+    }
+
+    for (const Column* column : table->columns()) {
+      const bool column_was_tracked =
+          IsChangeStreamIn(change_stream, column->change_streams());
+      const bool column_was_explicitly_tracked = IsChangeStreamIn(
+          change_stream, column->change_streams_explicitly_tracking_column());
+      bool column_is_tracked = tracked.columns.contains(column);
+      bool column_is_explicitly_tracked =
+          tracked.explicitly_tracked_columns.contains(column);
+      // Key columns are never unregistered from, to prevent modifications on
+      // key columns with child tables.
+      if (table->FindKeyColumn(column->Name()) != nullptr) {
+        column_is_tracked |= column_was_tracked;
+        column_is_explicitly_tracked |= column_was_explicitly_tracked;
+      }
+      if (column_was_tracked == column_is_tracked &&
+          column_was_explicitly_tracked == column_is_explicitly_tracked) {
+        continue;
+      }
+      ZETASQL_RETURN_IF_ERROR(AlterNode<Column>(
+          column, [&](Column::Editor* editor) -> absl::Status {
+            if (column_was_tracked) {
+              editor->remove_change_stream(change_stream);
+            }
+            if (column_is_tracked) {
+              editor->add_change_stream(change_stream);
+            }
+            if (column_is_explicitly_tracked) {
+              editor->add_change_stream_explicitly_tracking_column(
+                  change_stream);
+            }
+            return absl::OkStatus();
+          }));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status SchemaUpdaterImpl::ValidateLimitsForTrackedObjects(
     const ddl::ChangeStreamForClause& change_stream_for_clause,
     absl::FunctionRef<absl::Status(const Table*)> table_cb,
@@ -2954,51 +3150,52 @@ absl::Status SchemaUpdaterImpl::BuildChangeStreamTrackedObjects(
 absl::Status SchemaUpdaterImpl::EditChangeStreamTrackedObjects(
     const ddl::ChangeStreamForClause& change_stream_for_clause,
     const ChangeStream* change_stream) {
+  if (!change_stream_for_clause.all() &&
+      !change_stream_for_clause.has_tracked_tables()) {
+    return absl::OkStatus();
+  }
+  absl::flat_hash_map<std::string, std::vector<std::string>>
+      tracked_tables_columns;
   if (change_stream_for_clause.all()) {
     for (const auto& table : latest_schema_->tables()) {
       if (!table->is_trackable_by_change_stream()) {
         continue;
       }
-      ZETASQL_RETURN_IF_ERROR(AlterNode<ChangeStream>(
-          change_stream, [table](ChangeStream::Editor* editor) -> absl::Status {
-            editor->add_tracked_tables_columns(table->Name(),
-                                               table->trackable_columns());
-            return absl::OkStatus();
-          }));
+      tracked_tables_columns[table->Name()] = table->trackable_columns();
     }
-    return absl::OkStatus();
-  }
-  if (!change_stream_for_clause.has_tracked_tables()) {
-    return absl::OkStatus();
-  }
-  for (const ddl::ChangeStreamForClause::TrackedTables::Entry& entry :
-       change_stream_for_clause.tracked_tables().table_entry()) {
-    std::vector<std::string> columns;
-    if (!entry.has_all_columns()) {
-      for (const std::string& column_name :
-           entry.tracked_columns().column_name()) {
-        if (latest_schema_->FindTable(entry.table_name())
-                ->is_trackable_by_change_stream()) {
+  } else {
+    for (const ddl::ChangeStreamForClause::TrackedTables::Entry& entry :
+         change_stream_for_clause.tracked_tables().table_entry()) {
+      std::vector<std::string> columns;
+      if (!entry.has_all_columns()) {
+        for (const std::string& column_name :
+             entry.tracked_columns().column_name()) {
+          if (latest_schema_->FindTable(entry.table_name())
+                  ->is_trackable_by_change_stream()) {
+            columns.push_back(column_name);
+          } else {
+            return error::TrackUntrackableColumns(column_name);
+          }
+        }
+      } else {
+        for (const std::string& column_name :
+             latest_schema_->FindTable(entry.table_name())
+                 ->trackable_columns()) {
           columns.push_back(column_name);
-        } else {
-          return error::TrackUntrackableColumns(column_name);
         }
       }
-    } else {
-      for (const std::string& column_name :
-           latest_schema_->FindTable(entry.table_name())->trackable_columns()) {
-        columns.push_back(column_name);
-      }
+      tracked_tables_columns[entry.table_name()] = std::move(columns);
     }
-    ZETASQL_RETURN_IF_ERROR(AlterNode<ChangeStream>(
-        change_stream,
-        [&, entry, columns](ChangeStream::Editor* editor) -> absl::Status {
-          editor->clear_tracked_tables_columns();
-          editor->add_tracked_tables_columns(entry.table_name(), columns);
-          return absl::OkStatus();
-        }));
   }
-  return absl::OkStatus();
+  // Replace the tracked tables and columns in a single edit.
+  return AlterNode<ChangeStream>(
+      change_stream, [&](ChangeStream::Editor* editor) -> absl::Status {
+        editor->clear_tracked_tables_columns();
+        for (auto& [table_name, columns] : tracked_tables_columns) {
+          editor->add_tracked_tables_columns(table_name, std::move(columns));
+        }
+        return absl::OkStatus();
+      });
 }
 
 absl::StatusOr<const Index*> SchemaUpdaterImpl::CreateIndexHelper(
@@ -3452,7 +3649,6 @@ absl::Status SchemaUpdaterImpl::AlterChangeStreamForClause(
                                                 change_stream->Name()));
   ZETASQL_RETURN_IF_ERROR(ValidateChangeStreamLimits(ddl_change_stream_for_clause,
                                              change_stream->Name()));
-  ZETASQL_RETURN_IF_ERROR(UnregisterChangeStreamFromTrackedObjects(change_stream));
   ZETASQL_RETURN_IF_ERROR(AlterNode<ChangeStream>(
       change_stream, [&](ChangeStream::Editor* editor) -> absl::Status {
         editor->set_for_clause(ddl_change_stream_for_clause);
@@ -3461,7 +3657,7 @@ absl::Status SchemaUpdaterImpl::AlterChangeStreamForClause(
       }));
 
   ZETASQL_RETURN_IF_ERROR(
-      RegisterTrackedObjects(ddl_change_stream_for_clause, change_stream));
+      UpdateTrackedObjects(ddl_change_stream_for_clause, change_stream));
   ZETASQL_RETURN_IF_ERROR(EditChangeStreamTrackedObjects(ddl_change_stream_for_clause,
                                                  change_stream));
   return absl::OkStatus();
@@ -4271,15 +4467,23 @@ absl::StatusOr<SchemaChangeResult> SchemaUpdater::UpdateSchemaFromDDL(
                                context.schema_change_timestamp,
                                context.pg_oid_assigner, existing_schema));
   context.pg_oid_assigner->BeginAssignment();
-  ZETASQL_ASSIGN_OR_RETURN(pending_work_,
-                   updater.ApplyDDLStatements(schema_change_operation));
+  {
+    tracing::ScopedSpan span("SchemaUpdater::ApplyDDLStatements");
+    ZETASQL_ASSIGN_OR_RETURN(pending_work_,
+                     updater.ApplyDDLStatements(schema_change_operation));
+  }
   intermediate_schemas_ = updater.GetIntermediateSchemas();
 
   // Use the schema snapshot for the last succesful statement.
   int num_successful = 0;
   std::unique_ptr<const Schema> new_schema = nullptr;
 
-  absl::Status backfill_status = RunPendingActions(&num_successful);
+  absl::Status backfill_status;
+  {
+    // Runs the backfills and verifications of the statements.
+    tracing::ScopedSpan span("SchemaUpdater::RunPendingActions");
+    backfill_status = RunPendingActions(&num_successful);
+  }
   if (num_successful > 0) {
     new_schema = std::move(intermediate_schemas_[num_successful - 1]);
     ZETASQL_RETURN_IF_ERROR(context.pg_oid_assigner->EndAssignmentAtIntermediateSchema(
@@ -4305,44 +4509,63 @@ SchemaUpdater::CreateSchemaFromDDL(
   return std::move(result.updated_schema);
 }
 
+namespace {
+
+// Options for translating PostgreSQL DDL statements to the emulator's DDL.
+postgres_translator::spangres::TranslationOptions PgDDLTranslationOptions() {
+  return {
+      .enable_nulls_ordering = true,
+      .enable_generated_column = true,
+      .enable_column_default = true,
+      .enable_jsonb_type = true,
+      .enable_array_jsonb_type = true,
+      .enable_create_view = true,
+      // This enables Spangres ddl translator to record the original
+      // expression in PG.
+      .enable_expression_string = true,
+      .enable_if_not_exists = true,
+      .enable_change_streams = true,
+      .enable_change_streams_mod_type_filter_options = true,
+      .enable_change_streams_ttl_deletes_filter_option = true,
+      .enable_sequence = true,
+      .enable_virtual_generated_column = true,
+  };
+}
+
+// Parses and translates a PostgreSQL DDL statement. Requires an active PG
+// memory context on this thread.
+absl::StatusOr<std::unique_ptr<ddl::DDLStatement>> ParsePgDDLStatement(
+    absl::string_view statement,
+    const postgres_translator::spangres::PostgreSQLToSpannerDDLTranslator&
+        translator) {
+  ZETASQL_ASSIGN_OR_RETURN(
+      postgres_translator::interfaces::ParserOutput parser_output,
+      postgres_translator::CheckedPgRawParserFullOutput(
+          std::string(statement).c_str()),
+      _ << "failed to parse the DDL statements.");
+  ZETASQL_ASSIGN_OR_RETURN(ddl::DDLStatementList ddl_statement_list,
+                   translator.TranslateForEmulator(parser_output,
+                                                   PgDDLTranslationOptions()));
+  ZETASQL_RET_CHECK_EQ(ddl_statement_list.statement_size(), 1);
+  return std::make_unique<ddl::DDLStatement>(
+      std::move(*ddl_statement_list.mutable_statement(0)));
+}
+
+}  // namespace
+
 absl::StatusOr<std::unique_ptr<ddl::DDLStatement>> ParseDDLByDialect(
     absl::string_view statement, database_api::DatabaseDialect dialect) {
   if (dialect == database_api::DatabaseDialect::POSTGRESQL) {
     ZETASQL_ASSIGN_OR_RETURN(
         std::unique_ptr<postgres_translator::interfaces::PGArena> arena,
         postgres_translator::spangres::MemoryContextPGArena::Init(nullptr));
-    ZETASQL_ASSIGN_OR_RETURN(
-        postgres_translator::interfaces::ParserOutput parser_output,
-        postgres_translator::CheckedPgRawParserFullOutput(
-            std::string(statement).c_str()),
-        _ << "failed to parse the DDL statements.");
     ZETASQL_ASSIGN_OR_RETURN(
         std::unique_ptr<
             postgres_translator::spangres::PostgreSQLToSpannerDDLTranslator>
             translator,
         postgres_translator::spangres::
             CreatePostgreSQLToSpannerDDLTranslator());
-    const postgres_translator::spangres::TranslationOptions options{
-        .enable_nulls_ordering = true,
-        .enable_generated_column = true,
-        .enable_column_default = true,
-        .enable_jsonb_type = true,
-        .enable_array_jsonb_type = true,
-        .enable_create_view = true,
-        // This enables Spangres ddl translator to record the original
-        // expression in PG.
-        .enable_expression_string = true,
-        .enable_if_not_exists = true,
-        .enable_change_streams = true,
-        .enable_change_streams_mod_type_filter_options = true,
-        .enable_change_streams_ttl_deletes_filter_option = true,
-        .enable_sequence = true,
-        .enable_virtual_generated_column = true,
-    };
-    ZETASQL_ASSIGN_OR_RETURN(ddl::DDLStatementList ddl_statement_list,
-                     translator->TranslateForEmulator(parser_output, options));
-    ZETASQL_RET_CHECK_EQ(ddl_statement_list.statement_size(), 1);
-    return std::make_unique<ddl::DDLStatement>(ddl_statement_list.statement(0));
+    return ParsePgDDLStatement(statement, *translator);
   } else {
     auto ddl_statement = std::make_unique<ddl::DDLStatement>();
     ZETASQL_RETURN_IF_ERROR(ddl::ParseDDLStatement(statement, ddl_statement.get()));
@@ -4350,6 +4573,39 @@ absl::StatusOr<std::unique_ptr<ddl::DDLStatement>> ParseDDLByDialect(
   }
 }
 
+absl::StatusOr<std::vector<absl::StatusOr<std::unique_ptr<ddl::DDLStatement>>>>
+ParseDDLStatementsByDialect(absl::Span<const std::string> statements,
+                            database_api::DatabaseDialect dialect) {
+  std::vector<absl::StatusOr<std::unique_ptr<ddl::DDLStatement>>> results;
+  results.reserve(statements.size());
+  if (dialect != database_api::DatabaseDialect::POSTGRESQL) {
+    for (const std::string& statement : statements) {
+      results.push_back(statement.empty()
+                            ? error::EmptyDDLStatement()
+                            : ParseDDLByDialect(statement, dialect));
+    }
+    return results;
+  }
+
+  // The translated statements are protos, so the PG memory context is released
+  // before they are applied. Applying some statements (e.g. CREATE VIEW)
+  // translates PostgreSQL again and needs to set up its own context.
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::unique_ptr<postgres_translator::interfaces::PGArena> arena,
+      postgres_translator::spangres::MemoryContextPGArena::Init(nullptr));
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::unique_ptr<
+          postgres_translator::spangres::PostgreSQLToSpannerDDLTranslator>
+          translator,
+      postgres_translator::spangres::CreatePostgreSQLToSpannerDDLTranslator());
+  for (const std::string& statement : statements) {
+    results.push_back(statement.empty()
+                          ? error::EmptyDDLStatement()
+                          : ParsePgDDLStatement(statement, *translator));
+  }
+  return results;
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -91,6 +91,14 @@ struct SchemaChangeResult {
 absl::StatusOr<std::unique_ptr<ddl::DDLStatement>> ParseDDLByDialect(
     absl::string_view statement, database_api::DatabaseDialect dialect);
 
+// Parses the given statements based on the dialect and returns one result per
+// statement, each either the DDL statement or the error parsing it. PostgreSQL
+// statements are all parsed and translated within a single PG memory context
+// and translator. Empty statements yield an EmptyDDLStatement error.
+absl::StatusOr<std::vector<absl::StatusOr<std::unique_ptr<ddl::DDLStatement>>>>
+ParseDDLStatementsByDialect(absl::Span<const std::string> statements,
+                            database_api::DatabaseDialect dialect);
+
 class SchemaUpdater {
  public:
   SchemaUpdater() = default;
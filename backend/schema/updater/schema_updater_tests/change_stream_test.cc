@@ -974,6 +974,60 @@ TEST_P(SchemaUpdaterTest,
       ALTER TABLE Users DROP COLUMN Name)"}));
 }
 
+TEST_P(SchemaUpdaterTest, AlterChangeStreamOnlyUpdatesChangedTrackedObjects) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto schema, CreateSchema({R"(
+      CREATE TABLE T1 (
+        k1 INT64,
+        c1 STRING(100),
+      ) PRIMARY KEY (k1)
+    )",
+                                                  R"(
+      CREATE TABLE T2 (
+        k2 INT64,
+        c2 STRING(100),
+      ) PRIMARY KEY (k2)
+    )",
+                                                  R"(
+      CREATE TABLE T3 (
+        k3 INT64,
+        c3 STRING(100),
+      ) PRIMARY KEY (k3)
+    )",
+                                                  R"(
+      CREATE CHANGE STREAM C FOR T1(c1), T2)"}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(schema, UpdateSchema(schema.get(), {R"(
+      ALTER CHANGE STREAM C SET FOR T1(c1), T3)"}));
+
+  // T1 keeps a single registration of the change stream.
+  const Column* c1 = schema->FindTable("T1")->FindColumn("c1");
+  EXPECT_EQ(c1->change_streams().size(), 1);
+  EXPECT_EQ(c1->change_streams_explicitly_tracking_column().size(), 1);
+  EXPECT_EQ(schema->FindTable("T1")
+                ->change_streams_explicitly_tracking_table()
+                .size(),
+            1);
+  EXPECT_EQ(schema->FindTable("T2")->change_streams().size(), 0);
+  EXPECT_EQ(schema->FindTable("T2")
+                ->change_streams_explicitly_tracking_table()
+                .size(),
+            0);
+  EXPECT_EQ(
+      schema->FindTable("T2")->FindColumn("c2")->change_streams().size(), 0);
+  EXPECT_EQ(schema->FindTable("T3")->change_streams().size(), 1);
+  EXPECT_EQ(
+      schema->FindTable("T3")->FindColumn("c3")->change_streams().size(), 1);
+
+  absl::flat_hash_map<std::string, std::vector<std::string>>
+      tracked_tables_columns =
+          schema->FindChangeStream("C")->tracked_tables_columns();
+  EXPECT_THAT(tracked_tables_columns["T1"], testing::ElementsAre("c1"));
+  EXPECT_TRUE(tracked_tables_columns.contains("T3"));
+  EXPECT_FALSE(tracked_tables_columns.contains("T2"));
+
+  // T2 is no longer tracked, so it can be dropped.
+  ZETASQL_EXPECT_OK(UpdateSchema(schema.get(), {R"(DROP TABLE T2)"}));
+}
+
 }  // namespace
 
 }  // namespace test
@@ -14,8 +14,14 @@
 // limitations under the License.
 //
 
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "backend/schema/updater/schema_updater.h"
 #include "backend/schema/updater/schema_updater_tests/base.h"
 
 namespace google {
@@ -108,6 +114,65 @@ TEST_P(SchemaUpdaterTest, CreationOrder) {
               testing::ElementsAreArray(expected));
 }
 
+TEST_P(SchemaUpdaterTest, RecordsTablesChangedSinceExistingSchema) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto schema, CreateSchema({R"(
+      CREATE TABLE T1 (
+        k1 INT64,
+        c1 INT64
+      ) PRIMARY KEY (k1)
+    )",
+                                                   R"(
+      CREATE TABLE T2 (
+        k1 INT64
+      ) PRIMARY KEY (k1)
+    )"}));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto altered_schema,
+      UpdateSchema(schema.get(), {"ALTER TABLE T1 ADD COLUMN c2 INT64",
+                                  R"(
+      CREATE TABLE T3 (
+        k1 INT64
+      ) PRIMARY KEY (k1)
+    )"}));
+  const CaseInsensitiveStringSet* changed_tables =
+      altered_schema->TablesChangedSince(schema.get());
+  ASSERT_NE(changed_tables, nullptr);
+  EXPECT_EQ(changed_tables->size(), 2);
+  EXPECT_TRUE(changed_tables->contains("T1"));
+  EXPECT_TRUE(changed_tables->contains("T3"));
+  EXPECT_EQ(altered_schema->TablesChangedSince(altered_schema.get()), nullptr);
+
+  // The changed tables are not tracked through drops.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto dropped_schema,
+      UpdateSchema(altered_schema.get(), {"ALTER TABLE T1 DROP COLUMN c2"}));
+  EXPECT_EQ(dropped_schema->TablesChangedSince(altered_schema.get()), nullptr);
+}
+
+TEST_P(SchemaUpdaterTest, ParsesStatementsInBatch) {
+  std::vector<std::string> statements;
+  if (GetParam() == database_api::DatabaseDialect::POSTGRESQL) {
+    statements = {"CREATE TABLE T1 (k1 bigint PRIMARY KEY)", "",
+                  "CREATE TABL T2 (k1 bigint PRIMARY KEY)",
+                  "CREATE INDEX Idx1 ON T1(k1)"};
+  } else {
+    statements = {"CREATE TABLE T1 (k1 INT64) PRIMARY KEY (k1)", "",
+                  "CREATE TABL T2 (k1 INT64) PRIMARY KEY (k1)",
+                  "CREATE INDEX Idx1 ON T1(k1)"};
+  }
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto parsed, ParseDDLStatementsByDialect(statements, GetParam()));
+  ASSERT_EQ(parsed.size(), 4);
+  ZETASQL_ASSERT_OK(parsed[0]);
+  EXPECT_TRUE((*parsed[0])->has_create_table());
+  EXPECT_THAT(parsed[1], zetasql_base::testing::StatusIs(
+                             absl::StatusCode::kInvalidArgument));
+  EXPECT_FALSE(parsed[2].ok());
+  ZETASQL_ASSERT_OK(parsed[3]);
+  EXPECT_TRUE((*parsed[3])->has_create_index());
+}
+
 }  // namespace
 
 }  // namespace test
@@ -900,6 +900,34 @@ TEST_P(SchemaUpdaterTest, AlterTable_DropColumn) {
   EXPECT_EQ(c1, nullptr);
 }
 
+TEST_P(SchemaUpdaterTest, AlterTable_ColumnOrdinals) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto schema, CreateSchema({R"(
+      CREATE TABLE T (
+        k1 INT64,
+        c1 STRING(MAX),
+        c2 STRING(MAX),
+      ) PRIMARY KEY (k1)
+    )"}));
+  const Table* t = schema->FindTable("T");
+  for (int i = 0; i < t->columns().size(); ++i) {
+    EXPECT_EQ(t->columns()[i]->ordinal(), i);
+  }
+
+  // Dropping a column shifts the ordinals of the columns after it, and added
+  // columns are appended.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto new_schema, UpdateSchema(schema.get(), {R"(
+      ALTER TABLE T DROP COLUMN c1
+    )",
+                                                           R"(
+      ALTER TABLE T ADD COLUMN c3 INT64
+    )"}));
+  t = new_schema->FindTable("T");
+  EXPECT_EQ(t->FindColumn("k1")->ordinal(), 0);
+  EXPECT_EQ(t->FindColumn("c2")->ordinal(), 1);
+  EXPECT_EQ(t->FindColumn("c3")->ordinal(), 2);
+  EXPECT_EQ(schema->FindTable("T")->FindColumn("c2")->ordinal(), 2);
+}
+
 TEST_P(SchemaUpdaterTest, AlterTable_InvalidDropKeyColumn) {
   ZETASQL_ASSERT_OK_AND_ASSIGN(auto schema, CreateSchema({R"(
       CREATE TABLE T (
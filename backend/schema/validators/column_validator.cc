@@ -95,7 +95,15 @@ bool IsAllowedTypeChange(const zetasql::Type* old_column_type,
   return false;
 }
 
-// Validates size reductions and column type changes.
+// Returns true if the values of `column` are copies of those of another column,
+// as for the columns of index data tables. Such values were already verified
+// on the source column, so only backfills need to process them.
+bool MirrorsSourceColumn(const Column* column) {
+  return column->source_column() != nullptr;
+}
+
+// Validates size reductions and column type changes. Changes which only
+// affect metadata, such as widening the max length, schedule no action.
 absl::Status CheckAllowedColumnTypeChange(
     const Column* old_column, const Column* new_column,
     const zetasql::Type* old_column_type,
@@ -109,8 +117,9 @@ absl::Status CheckAllowedColumnTypeChange(
   const auto* old_base_type = BaseType(old_column_type);
   const auto* new_base_type = BaseType(new_column_type);
   if (new_base_type->Equals(old_base_type)) {
-    if (IsResizeable(old_base_type) && new_column->effective_max_length() <
-                                           old_column->effective_max_length()) {
+    if (IsResizeable(old_base_type) && !MirrorsSourceColumn(new_column) &&
+        new_column->effective_max_length() <
+            old_column->effective_max_length()) {
       context->AddAction([old_column,
                           new_column](const SchemaValidationContext* context) {
         return VerifyColumnLength(old_column->table(), old_column,
@@ -118,11 +127,13 @@ absl::Status CheckAllowedColumnTypeChange(
       });
     }
   } else {
-    context->AddAction(
-        [old_column, new_column](const SchemaValidationContext* context) {
-          return VerifyColumnTypeChange(old_column->table(), old_column,
-                                        new_column, context);
-        });
+    if (!MirrorsSourceColumn(new_column)) {
+      context->AddAction(
+          [old_column, new_column](const SchemaValidationContext* context) {
+            return VerifyColumnTypeChange(old_column->table(), old_column,
+                                          new_column, context);
+          });
+    }
     // After verifying that the type change is acceptable, run a backfill
     // to apply the type change to the column values in storage.
     context->AddAction(
@@ -348,7 +359,8 @@ absl::Status ColumnValidator::ValidateUpdate(const Column* column,
     }
   }
 
-  if (old_column->is_nullable_ && !column->is_nullable_) {
+  if (old_column->is_nullable_ && !column->is_nullable_ &&
+      !MirrorsSourceColumn(column)) {
     context->AddAction([old_column](const SchemaValidationContext* context) {
       return VerifyColumnNotNull(old_column->table(), old_column, context);
     });
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "backend/actions/check_constraint.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/query/analyzer_options.h"
@@ -27,15 +28,25 @@
 #include "backend/query/function_catalog.h"
 #include "backend/schema/catalog/column.h"
 #include "backend/schema/catalog/table.h"
+#include "backend/schema/updater/parallel_scan.h"
+#include "backend/storage/iterator.h"
 #include "common/errors.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
 namespace emulator {
 namespace backend {
 
-absl::Status VerifyCheckConstraintData(const CheckConstraint* check_constraint,
-                                       const SchemaValidationContext* context) {
+namespace {
+
+// Verifies the check constraint against every row of its table in
+// `key_range`.
+absl::Status VerifyCheckConstraintDataInRange(
+    const CheckConstraint* check_constraint, const KeyRange& key_range,
+    const SchemaValidationContext* context) {
+  // The verifier holds the prepared check constraint expression, which is not
+  // shared across threads.
   FunctionCatalog function_catalog(context->type_factory());
   Catalog catalog(context->validated_new_schema(), &function_catalog,
                   context->type_factory());
@@ -46,10 +57,10 @@ absl::Status VerifyCheckConstraintData(const CheckConstraint* check_constraint,
   absl::Time timestamp = context->pending_commit_timestamp();
   std::unique_ptr<StorageIterator> iterator;
   std::vector<ColumnID> column_ids = GetColumnIDs(table->columns());
-  ZETASQL_RETURN_IF_ERROR(storage->Read(timestamp, table->id(), KeyRange::All(),
-                                column_ids, &iterator));
+  ZETASQL_RETURN_IF_ERROR(
+      storage->Read(timestamp, table->id(), key_range, column_ids, &iterator));
 
-  // Loop through every row of the table and validate the check constraints.
+  // Loop through every row of the range and validate the check constraints.
   while (iterator->Next()) {
     zetasql::ParameterValueMap row_column_values;
     for (int i = 0; i < iterator->NumColumns(); ++i) {
@@ -65,6 +76,21 @@ absl::Status VerifyCheckConstraintData(const CheckConstraint* check_constraint,
   return iterator->Status();
 }
 
+}  // namespace
+
+absl::Status VerifyCheckConstraintData(const CheckConstraint* check_constraint,
+                                       const SchemaValidationContext* context) {
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::vector<KeyRange> ranges,
+      SplitTableIntoKeyRanges(context->storage(),
+                              context->pending_commit_timestamp(),
+                              check_constraint->table()->id()));
+  return ProcessKeyRanges(ranges.size(), [&](int i) {
+    return VerifyCheckConstraintDataInRange(check_constraint, ranges[i],
+                                            context);
+  });
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -25,7 +25,10 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
 #include "backend/database/database.h"
+#include "backend/schema/updater/parallel_scan.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/read_write_transaction.h"
 #include "common/clock.h"
@@ -120,6 +123,32 @@ TEST_F(CheckConstraintVerifiersTest, InalidExistingData) {
               StatusIs(absl::StatusCode::kOutOfRange));
 }
 
+TEST_F(CheckConstraintVerifiersTest, ValidExistingDataAcrossKeyRanges) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_schema_scan_rows_per_range, 1);
+  absl::SetFlag(&FLAGS_schema_scan_threads, 4);
+  ZETASQL_ASSERT_OK(
+      UpdateSchema({"ALTER TABLE T"
+                    " ADD CONSTRAINT a_gt_zero CHECK(A > 0)"}));
+}
+
+TEST_F(CheckConstraintVerifiersTest, InvalidExistingDataAcrossKeyRanges) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_schema_scan_rows_per_range, 1);
+  absl::SetFlag(&FLAGS_schema_scan_threads, 1);
+  absl::Status sequential_status =
+      UpdateSchema({"ALTER TABLE T"
+                    " ADD CONSTRAINT b_gt_zero CHECK(B > 0)"});
+  EXPECT_THAT(sequential_status, StatusIs(absl::StatusCode::kOutOfRange));
+
+  // The violation reported by a parallel scan is the same as the one reported
+  // by a sequential scan.
+  absl::SetFlag(&FLAGS_schema_scan_threads, 4);
+  EXPECT_EQ(UpdateSchema({"ALTER TABLE T"
+                          " ADD CONSTRAINT b_gt_zero CHECK(B > 0)"}),
+            sequential_status);
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
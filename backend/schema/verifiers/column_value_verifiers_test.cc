@@ -174,6 +174,27 @@ TEST_F(ColumnValueVerifiersTest, VerifyColumnTypeChange) {
       error::InvalidColumnSizeReduction("string_col", 10, 15, "{Int64(2)}"));
 }
 
+TEST_F(ColumnValueVerifiersTest, VerifiesIndexedColumnOnIndexedTable) {
+  ZETASQL_ASSERT_OK(UpdateSchema({R"(
+    CREATE INDEX TestIndex ON TestTable(string_col)
+  )"}));
+
+  // Index data tables mirror the column, so only the table itself is checked.
+  EXPECT_EQ(UpdateSchema({R"(
+    ALTER TABLE TestTable ALTER COLUMN string_col STRING(30) NOT NULL
+  )"}),
+            error::NullValueForNotNullColumn("TestTable", "string_col",
+                                             "{Int64(1)}"));
+  EXPECT_EQ(
+      UpdateSchema({R"(
+    ALTER TABLE TestTable ALTER COLUMN string_col STRING(10)
+  )"}),
+      error::InvalidColumnSizeReduction("string_col", 10, 15, "{Int64(2)}"));
+  ZETASQL_EXPECT_OK(UpdateSchema({R"(
+    ALTER TABLE TestTable ALTER COLUMN string_col STRING(40)
+  )"}));
+}
+
 class ProtoColumnValueVerifierTest : public ColumnValueVerifiersTest {
  protected:
   std::string read_descriptors() {
@@ -16,17 +16,25 @@
 
 #include "backend/schema/verifiers/foreign_key_verifiers.h"
 
-#include <algorithm>
-#include <iterator>
 #include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "zetasql/public/value.h"
 #include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
 #include "backend/schema/catalog/foreign_key.h"
 #include "backend/schema/catalog/index.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/schema/updater/parallel_scan.h"
+#include "backend/storage/iterator.h"
 #include "common/errors.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
@@ -35,48 +43,115 @@ namespace backend {
 
 namespace {
 
-std::vector<ColumnID> DataColumnIds(const Table* data_table, int column_count) {
-  std::vector<ColumnID> column_ids;
-  std::transform(
-      data_table->primary_key().begin(), data_table->primary_key().end(),
-      std::back_inserter(column_ids),
-      [](const KeyColumn* key_column) { return key_column->column()->id(); });
-  return std::vector<ColumnID>(column_ids.begin(),
-                               column_ids.begin() + column_count);
+// Returns true if the first `column_count` key columns of the referencing and
+// referenced data tables sort in the same order. Both tables can then be
+// scanned forward in lockstep instead of looking up each referenced key.
+bool HaveSameKeyOrder(const ForeignKey* foreign_key, int column_count) {
+  absl::Span<const KeyColumn* const> referencing_key =
+      foreign_key->referencing_data_table()->primary_key();
+  absl::Span<const KeyColumn* const> referenced_key =
+      foreign_key->referenced_data_table()->primary_key();
+  for (int i = 0; i < column_count; ++i) {
+    if (referencing_key[i]->is_descending() !=
+            referenced_key[i]->is_descending() ||
+        referencing_key[i]->is_nulls_last() !=
+            referenced_key[i]->is_nulls_last()) {
+      return false;
+    }
+  }
+  return true;
 }
 
-}  // namespace
+// Returns a key with the column values of the given key, without its column
+// order attributes.
+Key ColumnValuesKey(const Key& key) {
+  return Key(std::vector<zetasql::Value>(key.column_values().begin(),
+                                           key.column_values().end()));
+}
 
-absl::Status VerifyForeignKeyData(const ForeignKey* foreign_key,
-                                  const SchemaValidationContext* context) {
+// Verifies that every row of the referencing data table in `key_range` has a
+// matching row in the referenced data table.
+absl::Status VerifyForeignKeyDataInRange(
+    const ForeignKey* foreign_key, const KeyRange& key_range,
+    bool same_key_order, const SchemaValidationContext* context) {
   const Storage* storage = context->storage();
   absl::Time timestamp = context->pending_commit_timestamp();
   int column_count = foreign_key->referencing_columns().size();
   TableID referenced_data_table_id = foreign_key->referenced_data_table()->id();
   std::unique_ptr<StorageIterator> referencing_iterator;
-  ZETASQL_RETURN_IF_ERROR(storage->Read(
-      timestamp, foreign_key->referencing_data_table()->id(), KeyRange::All(),
-      DataColumnIds(foreign_key->referencing_data_table(), column_count),
-      &referencing_iterator));
+  ZETASQL_RETURN_IF_ERROR(storage->Read(timestamp,
+                                foreign_key->referencing_data_table()->id(),
+                                key_range, {}, &referencing_iterator));
+
+  // Cursor over the referenced data table, opened at the first constraint key
+  // of the range when both tables sort in the same order.
+  std::unique_ptr<StorageIterator> referenced_iterator;
+  bool has_referenced_row = false;
+  std::optional<Key> previous_constraint_key;
   while (referencing_iterator->Next()) {
-    Key constraint_key(std::vector<zetasql::Value>(
-        referencing_iterator->Key().column_values().begin(),
-        referencing_iterator->Key().column_values().begin() + column_count));
-    std::unique_ptr<StorageIterator> referenced_iterator;
-    ZETASQL_RETURN_IF_ERROR(storage->Read(timestamp, referenced_data_table_id,
-                                  KeyRange::Point(constraint_key), {},
-                                  &referenced_iterator));
-    if (!referenced_iterator->Next() && referenced_iterator->Status().ok()) {
+    Key constraint_key = referencing_iterator->Key().Prefix(column_count);
+    // Rows of the referencing data table with the same constraint key are
+    // adjacent, so each distinct key only needs to be checked once.
+    if (previous_constraint_key.has_value() &&
+        *previous_constraint_key == constraint_key) {
+      continue;
+    }
+
+    bool found = false;
+    if (same_key_order) {
+      if (referenced_iterator == nullptr) {
+        ZETASQL_RETURN_IF_ERROR(storage->Read(
+            timestamp, referenced_data_table_id,
+            KeyRange::ClosedOpen(constraint_key, KeyRange::All().limit_key()),
+            {}, &referenced_iterator));
+        has_referenced_row = referenced_iterator->Next();
+      }
+      while (has_referenced_row &&
+             referenced_iterator->Key().Prefix(column_count) < constraint_key) {
+        has_referenced_row = referenced_iterator->Next();
+      }
+      ZETASQL_RETURN_IF_ERROR(referenced_iterator->Status());
+      found = has_referenced_row &&
+              referenced_iterator->Key().Prefix(column_count) == constraint_key;
+    } else {
+      std::unique_ptr<StorageIterator> point_iterator;
+      ZETASQL_RETURN_IF_ERROR(storage->Read(
+          timestamp, referenced_data_table_id,
+          KeyRange::Point(ColumnValuesKey(constraint_key)), {},
+          &point_iterator));
+      found = point_iterator->Next();
+      ZETASQL_RETURN_IF_ERROR(point_iterator->Status());
+    }
+    if (!found) {
       return error::ForeignKeyReferencedKeyNotFound(
           foreign_key->Name(), foreign_key->referencing_table()->Name(),
           foreign_key->referenced_table()->Name(),
-          constraint_key.DebugString());
+          ColumnValuesKey(constraint_key).DebugString());
     }
-    ZETASQL_RETURN_IF_ERROR(referenced_iterator->Status());
+    previous_constraint_key = std::move(constraint_key);
   }
   return referencing_iterator->Status();
 }
 
+}  // namespace
+
+absl::Status VerifyForeignKeyData(const ForeignKey* foreign_key,
+                                  const SchemaValidationContext* context) {
+  int column_count = foreign_key->referencing_columns().size();
+  bool same_key_order = HaveSameKeyOrder(foreign_key, column_count);
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::vector<KeyRange> ranges,
+      SplitTableIntoKeyRanges(context->storage(),
+                              context->pending_commit_timestamp(),
+                              foreign_key->referencing_data_table()->id()));
+  // Ranges are verified in parallel. The violation reported is the first one
+  // in referencing key order, as with a single scan.
+  return ProcessKeyRanges(ranges.size(), [&](int i) {
+    return VerifyForeignKeyDataInRange(foreign_key, ranges[i], same_key_order,
+                                       context);
+  });
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
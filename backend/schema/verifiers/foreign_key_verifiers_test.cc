@@ -26,10 +26,15 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
 #include "backend/database/database.h"
+#include "backend/datamodel/key.h"
+#include "backend/schema/updater/parallel_scan.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/read_write_transaction.h"
 #include "common/clock.h"
+#include "common/errors.h"
 
 namespace google {
 namespace spanner {
@@ -123,6 +128,35 @@ TEST_F(ForeignKeyVerifiersTest, InvalidExistingData) {
   EXPECT_THAT(AddForeignKey(), StatusIs(absl::StatusCode::kFailedPrecondition));
 }
 
+TEST_F(ForeignKeyVerifiersTest, ValidExistingDataAcrossKeyRanges) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_schema_scan_rows_per_range, 2);
+  absl::SetFlag(&FLAGS_schema_scan_threads, 4);
+  for (int i = 1; i <= 10; ++i) {
+    Insert("T", {"A", "B", "C"}, {i, i, i + 1});
+    Insert("U", {"X", "Y", "Z"}, {i, i + 1, i});
+    Insert("U", {"X", "Y", "Z"}, {i + 10, i + 1, i});
+  }
+  ZETASQL_EXPECT_OK(AddForeignKey());
+}
+
+TEST_F(ForeignKeyVerifiersTest, InvalidExistingDataAcrossKeyRanges) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_schema_scan_rows_per_range, 2);
+  absl::SetFlag(&FLAGS_schema_scan_threads, 4);
+  for (int i = 1; i <= 10; ++i) {
+    Insert("T", {"A", "B", "C"}, {i, i, i + 1});
+    Insert("U", {"X", "Y", "Z"}, {i, i + 1, i});
+  }
+  Insert("U", {"X", "Y", "Z"}, {11, 16, 15});
+  Insert("U", {"X", "Y", "Z"}, {12, 13, 12});
+
+  // The violation reported is the first one in referencing key order.
+  EXPECT_EQ(AddForeignKey(),
+            error::ForeignKeyReferencedKeyNotFound(
+                "C", "U", "T", Key({Int64(12), Int64(13)}).DebugString()));
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
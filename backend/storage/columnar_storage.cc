@@ -0,0 +1,562 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/columnar_storage.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "backend/storage/in_memory_iterator.h"
+#include "common/errors.h"
+#include "absl/status/status.h"
+
+ABSL_FLAG(bool, enable_columnar_storage, false,
+          "Whether databases store their data column by column, which speeds "
+          "up scans that project few columns of wide tables at the cost of "
+          "slower inserts. Storage versions of such databases are not garbage "
+          "collected.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Number of rows fetched by a RangeIterator per acquisition of the table lock.
+// Larger than for InMemoryStorage since columnar scans are cheap per row.
+static constexpr int kIteratorBatchSize = 256;
+
+// Approximate memory footprint of a single cell version, matching the
+// accounting of InMemoryStorage.
+int64_t VersionSizeInBytes(const zetasql::Value& value) {
+  return sizeof(absl::Time) + sizeof(zetasql::Value) +
+         (value.is_valid() ? value.physical_byte_size() : 0);
+}
+
+}  // namespace
+
+class ColumnarStorage::RangeIterator : public StorageIterator {
+ public:
+  RangeIterator(const ColumnarStorage* storage, absl::Time timestamp,
+                const TableID& table_id, const KeyRange& key_range,
+                const std::vector<ColumnID>& column_ids)
+      : storage_(storage),
+        timestamp_(timestamp),
+        table_id_(table_id),
+        key_range_(key_range),
+        column_ids_(column_ids) {}
+
+  bool Next() override {
+    if (++pos_ < rows_.size()) {
+      return true;
+    }
+    if (done_) {
+      return false;
+    }
+    // Continue after the last row of the previous batch.
+    std::vector<Row> rows;
+    done_ = storage_->ReadRows(timestamp_, table_id_, key_range_,
+                               rows_.empty() ? nullptr : &rows_.back().first,
+                               column_ids_, kIteratorBatchSize, &rows);
+    rows_ = std::move(rows);
+    pos_ = 0;
+    return pos_ < rows_.size();
+  }
+
+  absl::Status Status() const override { return absl::OkStatus(); }
+
+  const class Key& Key() const override { return rows_[pos_].first; }
+
+  int NumColumns() const override { return column_ids_.size(); }
+
+  const zetasql::Value& ColumnValue(int i) const override {
+    return rows_[pos_].second[i];
+  }
+
+ private:
+  using Row = std::pair<class Key, std::vector<zetasql::Value>>;
+
+  const ColumnarStorage* storage_;
+  const absl::Time timestamp_;
+  const TableID table_id_;
+  const KeyRange key_range_;
+  const std::vector<ColumnID> column_ids_;
+
+  // The current batch of rows and the position of the iterator within it.
+  std::vector<Row> rows_;
+  int pos_ = -1;
+
+  // True if there are no rows left to fetch from storage.
+  bool done_ = false;
+};
+
+ColumnarStorage::Table* ColumnarStorage::FindTable(
+    const TableID& table_id) const {
+  absl::ReaderMutexLock lock(&mu_);
+  auto table_itr = tables_.find(table_id);
+  if (table_itr == tables_.end()) {
+    return nullptr;
+  }
+  return table_itr->second.get();
+}
+
+ColumnarStorage::Table* ColumnarStorage::FindOrCreateTable(
+    const TableID& table_id) {
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    auto table_itr = tables_.find(table_id);
+    if (table_itr != tables_.end()) {
+      return table_itr->second.get();
+    }
+  }
+  absl::MutexLock lock(&mu_);
+  std::unique_ptr<Table>& table = tables_[table_id];
+  if (table == nullptr) {
+    table = std::make_unique<Table>();
+  }
+  return table.get();
+}
+
+const zetasql::Value& ColumnarStorage::ValueAtTimestamp(
+    const Cell& cell, absl::Time timestamp) {
+  static const zetasql::Value* kInvalidValue = new zetasql::Value();
+  // Most cells are read at or after their latest version.
+  if (!cell.empty() && cell.back().timestamp <= timestamp) {
+    return cell.back().value;
+  }
+  auto itr = std::upper_bound(
+      cell.begin(), cell.end(), timestamp,
+      [](absl::Time ts, const Version& version) {
+        return ts < version.timestamp;
+      });
+  // Timestamp is earlier than the time the cell was first written to.
+  if (itr == cell.begin()) {
+    return *kInvalidValue;
+  }
+  return std::prev(itr)->value;
+}
+
+bool ColumnarStorage::Exists(const Cell& cell, absl::Time timestamp) {
+  const zetasql::Value& value = ValueAtTimestamp(cell, timestamp);
+  return value.is_valid() && value.bool_value();
+}
+
+int64_t ColumnarStorage::FindOrInsertKey(Table* table, const Key& key) {
+  // Add the key if it does not exist, keeping all columns aligned with it.
+  // Keys written in ascending order are appended without shifting.
+  std::vector<Key>& keys = table->keys;
+  if (keys.empty() || keys.back() < key) {
+    keys.push_back(key);
+    table->exists.emplace_back();
+    for (auto& [column_id, column] : table->columns) {
+      column.emplace_back();
+    }
+    return keys.size() - 1;
+  }
+  auto key_itr = std::lower_bound(keys.begin(), keys.end(), key);
+  int64_t pos = key_itr - keys.begin();
+  if (!(*key_itr == key)) {
+    keys.insert(key_itr, key);
+    table->exists.emplace(table->exists.begin() + pos);
+    for (auto& [column_id, column] : table->columns) {
+      column.emplace(column.begin() + pos);
+    }
+  }
+  return pos;
+}
+
+void ColumnarStorage::SetVersion(Cell* cell, absl::Time timestamp,
+                                 zetasql::Value value) {
+  // Versions are mostly written in timestamp order.
+  if (cell->empty() || cell->back().timestamp < timestamp) {
+    cell->push_back(Version{timestamp, std::move(value)});
+    return;
+  }
+  auto itr = std::lower_bound(
+      cell->begin(), cell->end(), timestamp,
+      [](const Version& version, absl::Time ts) {
+        return version.timestamp < ts;
+      });
+  if (itr != cell->end() && itr->timestamp == timestamp) {
+    itr->value = std::move(value);
+  } else {
+    cell->insert(itr, Version{timestamp, std::move(value)});
+  }
+}
+
+absl::Status ColumnarStorage::Lookup(
+    absl::Time timestamp, const TableID& table_id, const Key& key,
+    const std::vector<ColumnID>& column_ids,
+    std::vector<zetasql::Value>* values) const {
+  // Validate the request.
+  if (!column_ids.empty() && values == nullptr) {
+    return error::Internal(
+        "ColumnarStorage::Lookup was passed a nullptr for "
+        "values, but had non-empty column_ids.");
+  }
+  if (values != nullptr) {
+    values->clear();
+  }
+
+  // Lookup for given table.
+  const Table* table = FindTable(table_id);
+  if (table == nullptr) {
+    return absl::Status(
+        absl::StatusCode::kNotFound,
+        absl::StrCat("Key: ", key.DebugString(), " not found for table: ",
+                     table_id, " at timestamp: ", absl::FormatTime(timestamp)));
+  }
+  absl::ReaderMutexLock lock(&table->mu);
+
+  // Lookup for given key.
+  auto key_itr =
+      std::lower_bound(table->keys.begin(), table->keys.end(), key);
+  if (key_itr == table->keys.end() || !(*key_itr == key)) {
+    return absl::Status(
+        absl::StatusCode::kNotFound,
+        absl::StrCat("Key: ", key.DebugString(), " not found for table: ",
+                     table_id, " at timestamp: ", absl::FormatTime(timestamp)));
+  }
+  int64_t pos = key_itr - table->keys.begin();
+
+  // Verify if the row exists at the given timestamp.
+  if (!Exists(table->exists[pos], timestamp)) {
+    return absl::Status(
+        absl::StatusCode::kNotFound,
+        absl::StrCat(
+            "Key: ", key.DebugString(), " does not exist for table: ", table_id,
+            " at the given timestamp: " + absl::FormatTime(timestamp)));
+  }
+
+  // Fetch the value from the cell at the given timestamp.
+  for (const ColumnID& column_id : column_ids) {
+    auto column_itr = table->columns.find(column_id);
+    if (column_itr == table->columns.end()) {
+      values->emplace_back();
+    } else {
+      values->push_back(ValueAtTimestamp(column_itr->second[pos], timestamp));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarStorage::BatchLookup(
+    absl::Time timestamp, const TableID& table_id, absl::Span<const Key> keys,
+    const std::vector<ColumnID>& column_ids,
+    std::vector<std::optional<std::vector<zetasql::Value>>>* rows) const {
+  rows->assign(keys.size(), std::nullopt);
+  const Table* table = FindTable(table_id);
+  if (table == nullptr || keys.empty()) {
+    return absl::OkStatus();
+  }
+
+  // Visit the keys in sorted order so that each binary search only covers the
+  // keys after the previous match.
+  std::vector<int> order(keys.size());
+  for (int i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(),
+            [&keys](int a, int b) { return keys[a] < keys[b]; });
+
+  absl::ReaderMutexLock lock(&table->mu);
+  std::vector<const Column*> columns;
+  columns.reserve(column_ids.size());
+  for (const ColumnID& column_id : column_ids) {
+    auto column_itr = table->columns.find(column_id);
+    columns.push_back(column_itr == table->columns.end() ? nullptr
+                                                         : &column_itr->second);
+  }
+
+  const std::vector<Key>& table_keys = table->keys;
+  auto key_itr = table_keys.begin();
+  for (int i : order) {
+    key_itr = std::lower_bound(key_itr, table_keys.end(), keys[i]);
+    if (key_itr == table_keys.end()) {
+      break;
+    }
+    int64_t pos = key_itr - table_keys.begin();
+    if (!(*key_itr == keys[i]) || !Exists(table->exists[pos], timestamp)) {
+      continue;
+    }
+    std::vector<zetasql::Value>& values = (*rows)[i].emplace();
+    values.reserve(columns.size());
+    for (const Column* column : columns) {
+      if (column == nullptr) {
+        values.emplace_back();
+      } else {
+        values.push_back(ValueAtTimestamp((*column)[pos], timestamp));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarStorage::Read(
+    absl::Time timestamp, const TableID& table_id, const KeyRange& key_range,
+    const std::vector<ColumnID>& column_ids,
+    std::unique_ptr<StorageIterator>* itr) const {
+  // Validate the request.
+  if (!key_range.IsClosedOpen()) {
+    return error::Internal(
+        absl::StrCat("ColumnarStorage::Read should be called "
+                     "with ClosedOpen key range, found: ",
+                     key_range.DebugString()));
+  }
+
+  // Return an empty iterator for empty key_range.
+  if (key_range.start_key() >= key_range.limit_key()) {
+    *itr = std::make_unique<FixedRowStorageIterator>();
+    return absl::OkStatus();
+  }
+
+  *itr = std::make_unique<RangeIterator>(this, timestamp, table_id, key_range,
+                                         column_ids);
+  return absl::OkStatus();
+}
+
+bool ColumnarStorage::ReadRows(
+    absl::Time timestamp, const TableID& table_id, const KeyRange& key_range,
+    const Key* after_key, const std::vector<ColumnID>& column_ids,
+    int max_rows,
+    std::vector<std::pair<Key, std::vector<zetasql::Value>>>* rows) const {
+  // Lookup for given table.
+  const Table* table = FindTable(table_id);
+  if (table == nullptr) {
+    return true;
+  }
+  absl::ReaderMutexLock lock(&table->mu);
+
+  // Resolve the projected columns once for the whole batch.
+  std::vector<const Column*> columns;
+  columns.reserve(column_ids.size());
+  for (const ColumnID& column_id : column_ids) {
+    auto column_itr = table->columns.find(column_id);
+    columns.push_back(column_itr == table->columns.end() ? nullptr
+                                                         : &column_itr->second);
+  }
+
+  // Lookup keys from the given key range, resuming after the last key which
+  // was already returned.
+  const std::vector<Key>& keys = table->keys;
+  auto key_itr =
+      after_key == nullptr
+          ? std::lower_bound(keys.begin(), keys.end(), key_range.start_key())
+          : std::upper_bound(keys.begin(), keys.end(), *after_key);
+  for (int64_t pos = key_itr - keys.begin();
+       pos < keys.size() && keys[pos] < key_range.limit_key(); ++pos) {
+    if (rows->size() >= max_rows) {
+      return false;
+    }
+    if (!Exists(table->exists[pos], timestamp)) {
+      continue;
+    }
+
+    std::vector<zetasql::Value> values;
+    values.reserve(columns.size());
+    for (const Column* column : columns) {
+      if (column == nullptr) {
+        values.emplace_back();
+      } else {
+        values.push_back(ValueAtTimestamp((*column)[pos], timestamp));
+      }
+    }
+    rows->emplace_back(keys[pos], std::move(values));
+  }
+  return true;
+}
+
+absl::StatusOr<int64_t> ColumnarStorage::CountRows(
+    absl::Time timestamp, const TableID& table_id,
+    const KeyRange& key_range) const {
+  if (!key_range.IsClosedOpen()) {
+    return error::Internal(
+        absl::StrCat("ColumnarStorage::CountRows should be called "
+                     "with ClosedOpen key range, found: ",
+                     key_range.DebugString()));
+  }
+  const Table* table = FindTable(table_id);
+  if (table == nullptr || key_range.start_key() >= key_range.limit_key()) {
+    return 0;
+  }
+  absl::ReaderMutexLock lock(&table->mu);
+  const std::vector<Key>& keys = table->keys;
+  int64_t begin =
+      std::lower_bound(keys.begin(), keys.end(), key_range.start_key()) -
+      keys.begin();
+  int64_t end =
+      std::lower_bound(keys.begin(), keys.end(), key_range.limit_key()) -
+      keys.begin();
+  int64_t count = 0;
+  for (int64_t pos = begin; pos < end; ++pos) {
+    if (Exists(table->exists[pos], timestamp)) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+absl::Status ColumnarStorage::Write(
+    absl::Time timestamp, const TableID& table_id, const Key& key,
+    const std::vector<ColumnID>& column_ids,
+    const std::vector<zetasql::Value>& values) {
+  // Add the table if it does not exist.
+  Table* table = FindOrCreateTable(table_id);
+  absl::MutexLock lock(&table->mu);
+
+  int64_t pos = FindOrInsertKey(table, key);
+
+  // Mark the row as existing if it does not exist.
+  if (!Exists(table->exists[pos], timestamp)) {
+    SetVersion(&table->exists[pos], timestamp, zetasql::values::Bool(true));
+  }
+
+  // Add the values for the given columns.
+  for (int i = 0; i < column_ids.size(); ++i) {
+    Column& column = table->columns[column_ids[i]];
+    if (column.size() < table->keys.size()) {
+      column.resize(table->keys.size());
+    }
+    SetVersion(&column[pos], timestamp, values[i]);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarStorage::LoadSorted(
+    absl::Time timestamp, const TableID& table_id,
+    const std::vector<ColumnID>& column_ids, StorageIterator* rows) {
+  // Add the table if it does not exist.
+  Table* table = FindOrCreateTable(table_id);
+  absl::MutexLock lock(&table->mu);
+
+  // Create all written columns upfront so that the pointers to them remain
+  // valid while rows are added.
+  std::vector<Column*> columns;
+  columns.reserve(column_ids.size());
+  for (const ColumnID& column_id : column_ids) {
+    Column& column = table->columns[column_id];
+    column.resize(table->keys.size());
+    columns.push_back(&column);
+  }
+
+  while (rows->Next()) {
+    int64_t pos = FindOrInsertKey(table, rows->Key());
+    if (!Exists(table->exists[pos], timestamp)) {
+      SetVersion(&table->exists[pos], timestamp, zetasql::values::Bool(true));
+    }
+    for (int i = 0; i < columns.size(); ++i) {
+      SetVersion(&(*columns[i])[pos], timestamp, rows->ColumnValue(i));
+    }
+  }
+  return rows->Status();
+}
+
+absl::Status ColumnarStorage::Delete(absl::Time timestamp,
+                                     const TableID& table_id,
+                                     const KeyRange& key_range) {
+  if (!key_range.IsClosedOpen()) {
+    return error::Internal(
+        absl::StrCat("ColumnarStorage::Delete should be called "
+                     "with ClosedOpen key range, found: ",
+                     key_range.DebugString()));
+  }
+  if (key_range.start_key() >= key_range.limit_key()) {
+    return absl::OkStatus();
+  }
+
+  // Lookup for given table.
+  Table* table = FindTable(table_id);
+  if (table == nullptr) {
+    return absl::OkStatus();
+  }
+  absl::MutexLock lock(&table->mu);
+
+  // Lookup keys from the given key range.
+  const std::vector<Key>& keys = table->keys;
+  int64_t begin =
+      std::lower_bound(keys.begin(), keys.end(), key_range.start_key()) -
+      keys.begin();
+  int64_t end =
+      std::lower_bound(keys.begin(), keys.end(), key_range.limit_key()) -
+      keys.begin();
+
+  // Mark the keys as deleted.
+  for (int64_t pos = begin; pos < end; ++pos) {
+    if (!Exists(table->exists[pos], timestamp)) {
+      continue;
+    }
+    SetVersion(&table->exists[pos], timestamp, zetasql::values::Bool(false));
+    // Column values are marked invalid zetasql::Value to avoid reading the
+    // value of the cell before the delete.
+    for (auto& [column_id, column] : table->columns) {
+      if (!column[pos].empty()) {
+        SetVersion(&column[pos], timestamp, zetasql::Value());
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::flat_hash_map<TableID, int64_t> ColumnarStorage::TableSizesInBytes()
+    const {
+  std::vector<std::pair<TableID, const Table*>> tables;
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    for (const auto& [table_id, table] : tables_) {
+      tables.emplace_back(table_id, table.get());
+    }
+  }
+
+  absl::flat_hash_map<TableID, int64_t> sizes;
+  for (const auto& [table_id, table] : tables) {
+    absl::ReaderMutexLock lock(&table->mu);
+    int64_t& size = sizes[table_id];
+    for (const Key& key : table->keys) {
+      size += key.LogicalSizeInBytes();
+    }
+    for (const Cell& cell : table->exists) {
+      for (const Version& version : cell) {
+        size += VersionSizeInBytes(version.value);
+      }
+    }
+    for (const auto& [column_id, column] : table->columns) {
+      for (const Cell& cell : column) {
+        for (const Version& version : cell) {
+          size += VersionSizeInBytes(version.value);
+        }
+      }
+    }
+  }
+  return sizes;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
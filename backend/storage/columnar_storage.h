@@ -0,0 +1,198 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_COLUMNAR_STORAGE_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_COLUMNAR_STORAGE_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/declare.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/storage/iterator.h"
+#include "backend/storage/storage.h"
+#include "absl/status/status.h"
+
+// Whether databases store their data in ColumnarStorage instead of
+// InMemoryStorage.
+ABSL_DECLARE_FLAG(bool, enable_columnar_storage);
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// ColumnarStorage implements an in-memory multi-version data store which lays
+// out each table column by column.
+//
+// Every table keeps its keys in a sorted vector. Each column is a vector of
+// cells aligned with the keys, and each cell is a vector of versions sorted by
+// timestamp. Row existence is tracked the same way in a dedicated column.
+// Scans therefore resolve each projected column once per batch of rows and
+// then walk contiguous memory, instead of doing a hash lookup per column per
+// row, and counting rows only touches the existence column.
+//
+// The tradeoff is that inserting a key in the middle of a table shifts every
+// column of the table, so this layout suits tables which are mostly read or
+// appended to in key order. Storage versions are not garbage collected.
+//
+// Lookup and Read return invalid zetasql::Value(s) for non-existent columns,
+// matching InMemoryStorage.
+//
+// Each table is guarded by its own reader-writer lock, and iterators returned
+// by Read fetch rows in batches, reacquiring the table lock for each batch.
+//
+// This class is thread-safe.
+class ColumnarStorage : public Storage {
+ public:
+  absl::Status Lookup(absl::Time timestamp, const TableID& table_id,
+                      const Key& key, const std::vector<ColumnID>& column_ids,
+                      std::vector<zetasql::Value>* values) const override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Sorts the keys and resolves each projected column once for all of them,
+  // under a single acquisition of the table lock.
+  absl::Status BatchLookup(
+      absl::Time timestamp, const TableID& table_id, absl::Span<const Key> keys,
+      const std::vector<ColumnID>& column_ids,
+      std::vector<std::optional<std::vector<zetasql::Value>>>* rows)
+      const override ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Status Read(absl::Time timestamp, const TableID& table_id,
+                    const KeyRange& key_range,
+                    const std::vector<ColumnID>& column_ids,
+                    std::unique_ptr<StorageIterator>* itr) const override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Status Write(absl::Time timestamp, const TableID& table_id,
+                     const Key& key, const std::vector<ColumnID>& column_ids,
+                     const std::vector<zetasql::Value>& values) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Writes the rows under a single acquisition of the table lock, resolving
+  // each column once. Rows in ascending key order past the end of the table
+  // are appended to every column without shifting. `rows` must not read from
+  // the same table of this storage.
+  absl::Status LoadSorted(absl::Time timestamp, const TableID& table_id,
+                          const std::vector<ColumnID>& column_ids,
+                          StorageIterator* rows) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Status Delete(absl::Time timestamp, const TableID& table_id,
+                      const KeyRange& key_range) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of rows of `key_range` which exist at `timestamp`
+  // without materializing any column values. KeyRange interval should be in
+  // KeyRange::ClosedOpen format.
+  absl::StatusOr<int64_t> CountRows(absl::Time timestamp,
+                                    const TableID& table_id,
+                                    const KeyRange& key_range) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::flat_hash_map<TableID, int64_t> TableSizesInBytes() const override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // StorageIterator which lazily walks a key range of a table.
+  class RangeIterator;
+
+  struct Version {
+    absl::Time timestamp;
+    zetasql::Value value;
+  };
+
+  // Versions of a single cell sorted by timestamp.
+  using Cell = std::vector<Version>;
+
+  // Cells of a column, aligned with Table::keys.
+  using Column = std::vector<Cell>;
+
+  // A table along with the lock guarding its contents.
+  struct Table {
+    mutable absl::Mutex mu;
+
+    // Sorted keys of all rows ever written to the table.
+    std::vector<Key> keys ABSL_GUARDED_BY(mu);
+
+    // Whether each row exists, as versions of BOOL values.
+    Column exists ABSL_GUARDED_BY(mu);
+
+    // All columns ever written to the table. Every column has as many cells as
+    // there are keys.
+    absl::flat_hash_map<ColumnID, Column> columns ABSL_GUARDED_BY(mu);
+  };
+
+  // Tables are never removed once created, so pointers to them remain valid
+  // for the lifetime of the storage.
+  using Tables = absl::flat_hash_map<TableID, std::unique_ptr<Table>>;
+
+  // Returns the table with the given id, or nullptr if it does not exist.
+  Table* FindTable(const TableID& table_id) const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the table with the given id, creating it if it does not exist.
+  Table* FindOrCreateTable(const TableID& table_id) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the value of `cell` at the specified timestamp, or an invalid value
+  // if the cell was not written at or before it.
+  static const zetasql::Value& ValueAtTimestamp(const Cell& cell,
+                                                  absl::Time timestamp);
+
+  // Returns true if `cell` of the existence column is true at `timestamp`.
+  static bool Exists(const Cell& cell, absl::Time timestamp);
+
+  // Returns the position of `key` in `table`, inserting an empty row for it if
+  // it does not exist yet.
+  static int64_t FindOrInsertKey(Table* table, const Key& key)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(table->mu);
+
+  // Sets the version of `cell` at `timestamp` to `value`.
+  static void SetVersion(Cell* cell, absl::Time timestamp,
+                         zetasql::Value value);
+
+  // Appends up to `max_rows` rows of `key_range` which exist at `timestamp` to
+  // `rows`, starting after `after_key` (or at the start of the key range if
+  // `after_key` is nullptr). Returns true if there are no more rows left in
+  // the key range.
+  bool ReadRows(absl::Time timestamp, const TableID& table_id,
+                const KeyRange& key_range, const Key* after_key,
+                const std::vector<ColumnID>& column_ids, int max_rows,
+                std::vector<std::pair<Key, std::vector<zetasql::Value>>>* rows)
+      const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Guards the set of tables. Table contents are guarded by Table::mu.
+  mutable absl::Mutex mu_;
+  Tables tables_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_COLUMNAR_STORAGE_H_
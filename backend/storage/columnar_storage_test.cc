@@ -0,0 +1,264 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/columnar_storage.h"
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "tests/common/proto_matchers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/storage/in_memory_iterator.h"
+#include "backend/storage/iterator.h"
+#include "absl/status/status.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::String;
+using zetasql_base::testing::IsOkAndHolds;
+
+class ColumnarStorageTest : public testing::Test {
+ protected:
+  const TableID kTableId0 = "test_table:0";
+  const ColumnID kColumnID0 = "test_column:0";
+  const ColumnID kColumnID1 = "test_column:1";
+  const KeyRange kKeyRange0To5 =
+      KeyRange::ClosedOpen(Key({Int64(0)}), Key({Int64(5)}));
+  ColumnarStorage storage_;
+  std::unique_ptr<StorageIterator> itr_;
+};
+
+TEST_F(ColumnarStorageTest, ReadsKeysInSortedOrderRegardlessOfWriteOrder) {
+  absl::Time t0 = absl::Now();
+  for (int i : {3, 0, 4, 1, 2}) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID0},
+                             {String(absl::StrCat("value-", i))}));
+  }
+
+  ZETASQL_EXPECT_OK(
+      storage_.Read(t0, kTableId0, kKeyRange0To5, {kColumnID0}, &itr_));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(i)}));
+    EXPECT_EQ(itr_->ColumnValue(0), String(absl::StrCat("value-", i)));
+  }
+  EXPECT_FALSE(itr_->Next());
+  ZETASQL_EXPECT_OK(itr_->Status());
+}
+
+TEST_F(ColumnarStorageTest, ColumnsStayAlignedWithKeys) {
+  absl::Time t0 = absl::Now();
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(2)}), {kColumnID0},
+                           {String("a-2")}));
+  // Inserting a smaller key and a new column must not shift existing cells.
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(1)}), {kColumnID1},
+                           {String("b-1")}));
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(0)}),
+                           {kColumnID0, kColumnID1},
+                           {String("a-0"), String("b-0")}));
+
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(storage_.Lookup(t0, kTableId0, Key({Int64(2)}),
+                            {kColumnID0, kColumnID1}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(String("a-2"), zetasql::Value()));
+  ZETASQL_EXPECT_OK(storage_.Lookup(t0, kTableId0, Key({Int64(1)}),
+                            {kColumnID0, kColumnID1}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(zetasql::Value(), String("b-1")));
+  ZETASQL_EXPECT_OK(storage_.Lookup(t0, kTableId0, Key({Int64(0)}),
+                            {kColumnID0, kColumnID1}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(String("a-0"), String("b-0")));
+}
+
+TEST_F(ColumnarStorageTest, ReadsVersionAtTimestamp) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  absl::Time t2 = t0 + absl::Seconds(2);
+  Key key({Int64(1)});
+
+  // Versions written out of timestamp order are still ordered.
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t2, kTableId0, key, {kColumnID0}, {String("value-2")}));
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t0, kTableId0, key, {kColumnID0}, {String("value-0")}));
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t1, kTableId0, key, {kColumnID0}, {String("value-1")}));
+
+  std::vector<zetasql::Value> values;
+  EXPECT_EQ(storage_
+                .Lookup(t0 - absl::Seconds(1), kTableId0, key, {kColumnID0},
+                        &values)
+                .code(),
+            absl::StatusCode::kNotFound);
+  ZETASQL_EXPECT_OK(storage_.Lookup(t0, kTableId0, key, {kColumnID0}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(String("value-0")));
+  ZETASQL_EXPECT_OK(storage_.Lookup(t1 + absl::Milliseconds(1), kTableId0, key,
+                            {kColumnID0}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(String("value-1")));
+  ZETASQL_EXPECT_OK(storage_.Lookup(t2, kTableId0, key, {kColumnID0}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(String("value-2")));
+}
+
+TEST_F(ColumnarStorageTest, DeleteHidesRowsFromLaterReads) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  for (int i = 0; i < 5; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID0},
+                             {Int64(i)}));
+  }
+  ZETASQL_EXPECT_OK(storage_.Delete(
+      t1, kTableId0, KeyRange::ClosedOpen(Key({Int64(1)}), Key({Int64(3)}))));
+
+  ZETASQL_EXPECT_OK(
+      storage_.Read(t1, kTableId0, kKeyRange0To5, {kColumnID0}, &itr_));
+  std::vector<zetasql::Value> read_values;
+  while (itr_->Next()) {
+    read_values.push_back(itr_->ColumnValue(0));
+  }
+  EXPECT_THAT(read_values, testing::ElementsAre(Int64(0), Int64(3), Int64(4)));
+
+  // Reads before the delete still see the deleted rows.
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(
+      storage_.Lookup(t0, kTableId0, Key({Int64(1)}), {kColumnID0}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(1)));
+
+  // A row written again after a delete does not see its old values.
+  absl::Time t2 = t1 + absl::Seconds(1);
+  ZETASQL_EXPECT_OK(storage_.Write(t2, kTableId0, Key({Int64(1)}), {kColumnID1},
+                           {Int64(10)}));
+  ZETASQL_EXPECT_OK(storage_.Lookup(t2, kTableId0, Key({Int64(1)}),
+                            {kColumnID0, kColumnID1}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(zetasql::Value(), Int64(10)));
+}
+
+TEST_F(ColumnarStorageTest, CountsRowsInRange) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  for (int i = 0; i < 1000; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID0},
+                             {Int64(i)}));
+  }
+  ZETASQL_EXPECT_OK(storage_.Delete(t1, kTableId0, kKeyRange0To5));
+
+  EXPECT_THAT(storage_.CountRows(t0, kTableId0, KeyRange::All()),
+              IsOkAndHolds(1000));
+  EXPECT_THAT(storage_.CountRows(t1, kTableId0, KeyRange::All()),
+              IsOkAndHolds(995));
+  EXPECT_THAT(storage_.CountRows(t1, "missing_table", KeyRange::All()),
+              IsOkAndHolds(0));
+}
+
+TEST_F(ColumnarStorageTest, LoadSortedWritesAllRows) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(3)}), {kColumnID0},
+                           {String("old-value")}));
+
+  // Rows are mostly in key order, with one row going before the last one.
+  std::vector<FixedRowStorageIterator::Row> rows;
+  for (int i : {1, 3, 4, 6, 5}) {
+    rows.emplace_back(Key({Int64(i)}),
+                      std::vector<zetasql::Value>{String(absl::StrCat(i))});
+  }
+  FixedRowStorageIterator rows_itr(std::move(rows));
+  ZETASQL_EXPECT_OK(storage_.LoadSorted(t1, kTableId0, {kColumnID0}, &rows_itr));
+
+  ZETASQL_EXPECT_OK(
+      storage_.Read(t1, kTableId0, KeyRange::All(), {kColumnID0}, &itr_));
+  std::vector<zetasql::Value> values;
+  while (itr_->Next()) {
+    values.push_back(itr_->ColumnValue(0));
+  }
+  EXPECT_THAT(values, testing::ElementsAre(String("1"), String("3"),
+                                           String("4"), String("5"),
+                                           String("6")));
+
+  // The previous version of an existing row is preserved.
+  ZETASQL_EXPECT_OK(
+      storage_.Lookup(t0, kTableId0, Key({Int64(3)}), {kColumnID0}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(String("old-value")));
+}
+
+TEST_F(ColumnarStorageTest, BatchLookupReturnsRowsInRequestOrder) {
+  absl::Time t0 = absl::Now();
+  for (int i = 0; i < 100; i += 2) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID0},
+                             {Int64(i)}));
+  }
+
+  // Keys are unsorted, repeated and partially missing.
+  std::vector<Key> keys = {Key({Int64(40)}), Key({Int64(3)}),
+                           Key({Int64(0)}),  Key({Int64(98)}),
+                           Key({Int64(40)}), Key({Int64(99)})};
+  std::vector<std::optional<std::vector<zetasql::Value>>> rows;
+  ZETASQL_EXPECT_OK(storage_.BatchLookup(t0, kTableId0, keys, {kColumnID0}, &rows));
+  ASSERT_EQ(rows.size(), keys.size());
+  EXPECT_THAT(*rows[0], testing::ElementsAre(Int64(40)));
+  EXPECT_FALSE(rows[1].has_value());
+  EXPECT_THAT(*rows[2], testing::ElementsAre(Int64(0)));
+  EXPECT_THAT(*rows[3], testing::ElementsAre(Int64(98)));
+  EXPECT_THAT(*rows[4], testing::ElementsAre(Int64(40)));
+  EXPECT_FALSE(rows[5].has_value());
+
+  // Rows are not visible before they were written.
+  ZETASQL_EXPECT_OK(storage_.BatchLookup(t0 - absl::Seconds(1), kTableId0, keys,
+                                 {kColumnID0}, &rows));
+  for (const auto& row : rows) {
+    EXPECT_FALSE(row.has_value());
+  }
+}
+
+TEST_F(ColumnarStorageTest, ReadManyRowsInterleavedWithWrites) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  for (int i = 0; i < 1000; i += 2) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID0},
+                             {Int64(i)}));
+  }
+
+  // Rows inserted at a later timestamp while the iterator is open shift the
+  // columns but are not visible to it.
+  ZETASQL_EXPECT_OK(
+      storage_.Read(t0, kTableId0, KeyRange::All(), {kColumnID0}, &itr_));
+  int expected = 0;
+  while (itr_->Next()) {
+    EXPECT_EQ(itr_->Key(), Key({Int64(expected)}));
+    EXPECT_EQ(itr_->ColumnValue(0), Int64(expected));
+    ZETASQL_EXPECT_OK(storage_.Write(t1, kTableId0, Key({Int64(expected + 1)}),
+                             {kColumnID0}, {Int64(expected + 1)}));
+    expected += 2;
+  }
+  EXPECT_EQ(expected, 1000);
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
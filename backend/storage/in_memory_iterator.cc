@@ -16,6 +16,8 @@
 
 #include "backend/storage/in_memory_iterator.h"
 
+#include <cstdint>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -48,6 +50,28 @@ const zetasql::Value& FixedRowStorageIterator::ColumnValue(int i) const {
   return GetColumns()[i];
 }
 
+LimitedStorageIterator::LimitedStorageIterator(
+    std::vector<std::unique_ptr<StorageIterator>> inputs, int64_t limit)
+    : inputs_(std::move(inputs)), remaining_rows_(limit) {}
+
+bool LimitedStorageIterator::Next() {
+  if (remaining_rows_ <= 0) {
+    return false;
+  }
+  while (input_ < inputs_.size()) {
+    if (inputs_[input_]->Next()) {
+      --remaining_rows_;
+      return true;
+    }
+    status_ = inputs_[input_]->Status();
+    if (!status_.ok()) {
+      return false;
+    }
+    ++input_;
+  }
+  return false;
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
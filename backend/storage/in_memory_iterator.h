@@ -17,6 +17,9 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_IN_MEMORY_ITERATOR_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_IN_MEMORY_ITERATOR_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "zetasql/public/value.h"
@@ -59,6 +62,32 @@ class FixedRowStorageIterator : public StorageIterator {
   int pos_ = -1;
 };
 
+// A StorageIterator returning the first `limit` rows of the given iterators,
+// in order. Used by readers which cannot stop fetching rows at the limit
+// themselves, e.g. because rows are filtered after being fetched.
+class LimitedStorageIterator : public StorageIterator {
+ public:
+  LimitedStorageIterator(std::vector<std::unique_ptr<StorageIterator>> inputs,
+                         int64_t limit);
+
+  bool Next() override;
+  absl::Status Status() const override { return status_; }
+  const class Key& Key() const override { return inputs_[input_]->Key(); }
+  int NumColumns() const override { return inputs_[input_]->NumColumns(); }
+  const zetasql::Value& ColumnValue(int i) const override {
+    return inputs_[input_]->ColumnValue(i);
+  }
+
+ private:
+  std::vector<std::unique_ptr<StorageIterator>> inputs_;
+  size_t input_ = 0;
+
+  // Number of rows which can still be returned.
+  int64_t remaining_rows_;
+
+  absl::Status status_;
+};
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
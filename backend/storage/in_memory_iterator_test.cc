@@ -16,6 +16,7 @@
 
 #include "backend/storage/in_memory_iterator.h"
 
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -108,6 +109,41 @@ TEST(FixedRowStorageIterator, CreateIteratorWithInvalidColumnValues) {
   }
 }
 
+TEST(LimitedStorageIterator, ReturnsFirstRowsOfInputs) {
+  std::vector<std::unique_ptr<StorageIterator>> inputs;
+  for (int i = 0; i < 3; ++i) {
+    std::vector<std::pair<Key, std::vector<Value>>> row_values = {
+        {Key({Int64(2 * i)}), {Int64(20 * i)}},
+        {Key({Int64(2 * i + 1)}), {Int64(20 * i + 10)}}};
+    inputs.push_back(
+        std::make_unique<FixedRowStorageIterator>(std::move(row_values)));
+  }
+
+  LimitedStorageIterator itr(std::move(inputs), /*limit=*/3);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(itr.Next());
+    EXPECT_EQ(Key({Int64(i)}), itr.Key());
+    EXPECT_EQ(Int64(10 * i), itr.ColumnValue(0));
+  }
+  EXPECT_FALSE(itr.Next());
+  ZETASQL_EXPECT_OK(itr.Status());
+}
+
+TEST(LimitedStorageIterator, ReturnsAllRowsBelowLimit) {
+  std::vector<std::unique_ptr<StorageIterator>> inputs;
+  std::vector<std::pair<Key, std::vector<Value>>> row_values = {
+      {Key({Int64(1)}), {Int64(10)}}};
+  inputs.push_back(
+      std::make_unique<FixedRowStorageIterator>(std::move(row_values)));
+  inputs.push_back(std::make_unique<FixedRowStorageIterator>());
+
+  LimitedStorageIterator itr(std::move(inputs), /*limit=*/5);
+  ASSERT_TRUE(itr.Next());
+  EXPECT_EQ(Key({Int64(1)}), itr.Key());
+  EXPECT_FALSE(itr.Next());
+  ZETASQL_EXPECT_OK(itr.Status());
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
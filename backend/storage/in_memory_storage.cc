@@ -16,15 +16,31 @@
 
 #include "backend/storage/in_memory_storage.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
+#include "zetasql/base/logging.h"
 #include "zetasql/public/value.h"
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "backend/datamodel/value.h"
 #include "backend/storage/in_memory_iterator.h"
+#include "backend/storage/row_sampler.h"
+#include "backend/storage/version_block.h"
 #include "common/errors.h"
+#include "zetasql/base/status_macros.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -34,42 +50,442 @@ namespace backend {
 
 namespace {
 
-static constexpr char kExistsColumn[] = "_exists";
+// Number of rows fetched by a RangeIterator per acquisition of the table lock.
+static constexpr int kIteratorBatchSize = 64;
+
+// Number of rows processed by garbage collection per acquisition of the table
+// lock.
+static constexpr int kGarbageCollectionBatchSize = 1024;
+
+// Number of rows a batched lookup or a multi-range read steps over linearly
+// before it falls back to a binary search for the next key.
+static constexpr int kBatchLookupMaxSteps = 8;
+
+// Number of writes applied per exclusive acquisition of the table lock, so that
+// readers of the table (e.g. snapshot reads at older timestamps) wait for at
+// most one batch of a large commit or load rather than all of it.
+static constexpr int kWriteBatchSize = 256;
+
+// Maximum number of rows a range deletion marks deleted one by one. Ranges
+// spanning more rows are deleted with a range tombstone.
+static constexpr int kEagerDeleteMaxRows = 64;
+
+// Number of rows whose size is measured per acquisition of the table lock.
+static constexpr int kTableSizeBatchSize = 1024;
+
+// Maximum number of distinct STRING values of a column which are dictionary
+// encoded. Dictionaries pay off for low-cardinality columns such as status
+// codes; for unique values they would only keep deleted strings alive.
+static constexpr int kMaxDictionarySize = 1024;
+
+// Returns the non-empty ranges of `key_ranges`, or an error if they are not
+// all ClosedOpen. `method` names the storage method they were passed to.
+absl::StatusOr<std::vector<KeyRange>> NonEmptyKeyRanges(
+    absl::string_view method, absl::Span<const KeyRange> key_ranges) {
+  std::vector<KeyRange> non_empty_ranges;
+  non_empty_ranges.reserve(key_ranges.size());
+  for (const KeyRange& key_range : key_ranges) {
+    if (!key_range.IsClosedOpen()) {
+      return error::Internal(absl::StrCat(
+          "InMemoryStorage::", method,
+          " should be called with ClosedOpen key ranges, found: ",
+          key_range.DebugString()));
+    }
+    if (key_range.start_key() < key_range.limit_key()) {
+      non_empty_ranges.push_back(key_range);
+    }
+  }
+  return non_empty_ranges;
+}
+
+// Approximate memory footprint of a single cell version.
+int64_t VersionSizeInBytes(const zetasql::Value& value) {
+  return sizeof(absl::Time) + sizeof(zetasql::Value) +
+         (value.is_valid() ? value.physical_byte_size() : 0);
+}
 
 }  // namespace
 
+class InMemoryStorage::RangeIterator : public StorageIterator {
+ public:
+  // If `sample` is set, only the rows of the sample are returned. If `limit`
+  // is positive, only the first `limit` rows are fetched and returned.
+  RangeIterator(const InMemoryStorage* storage, absl::Time timestamp,
+                const TableID& table_id, std::vector<KeyRange> key_ranges,
+                const std::vector<ColumnID>& column_ids,
+                const std::optional<RowSample>& sample = std::nullopt,
+                int64_t limit = 0)
+      : storage_(storage),
+        timestamp_(timestamp),
+        table_id_(table_id),
+        key_ranges_(std::move(key_ranges)),
+        column_ids_(column_ids),
+        limit_(limit) {
+    if (sample.has_value()) {
+      sampler_ = std::make_unique<RowSampler>(*sample);
+    }
+    storage_->RegisterReader(timestamp_);
+  }
+
+  ~RangeIterator() override { storage_->UnregisterReader(timestamp_); }
+
+  bool Next() override {
+    if (++pos_ < rows_.size()) {
+      return true;
+    }
+    if (done_) {
+      return false;
+    }
+    if (sampler_ != nullptr &&
+        sampler_->sample().method == RowSample::Method::kReservoir) {
+      ReadReservoir();
+      return pos_ < rows_.size();
+    }
+    int max_rows = kIteratorBatchSize;
+    if (limit_ > 0) {
+      max_rows = static_cast<int>(
+          std::min<int64_t>(max_rows, limit_ - num_rows_fetched_));
+    }
+    std::vector<Row> rows;
+    done_ = FetchRows(rows_.empty() ? nullptr : &rows_.back().first, max_rows,
+                      &rows, /*positions=*/nullptr);
+    num_rows_fetched_ += rows.size();
+    if (limit_ > 0 && num_rows_fetched_ >= limit_) {
+      done_ = true;
+    }
+    rows_ = std::move(rows);
+    pos_ = 0;
+    return pos_ < rows_.size();
+  }
+
+  absl::Status Status() const override { return absl::OkStatus(); }
+
+  const class Key& Key() const override { return rows_[pos_].first; }
+
+  int NumColumns() const override { return column_ids_.size(); }
+
+  const zetasql::Value& ColumnValue(int i) const override {
+    return rows_[pos_].second[i];
+  }
+
+ private:
+  using Row = std::pair<class Key, std::vector<zetasql::Value>>;
+
+  // Fetches the next batch of at most `max_rows` rows after `after_key` (or
+  // from the start if it is nullptr) into `rows`. Returns true if there are no
+  // rows left.
+  bool FetchRows(const class Key* after_key, int max_rows,
+                 std::vector<Row>* rows, std::vector<int64_t>* positions) {
+    // Skip the key ranges which end before `after_key`.
+    if (after_key != nullptr) {
+      while (range_pos_ < key_ranges_.size() &&
+             key_ranges_[range_pos_].limit_key() <= *after_key) {
+        ++range_pos_;
+      }
+    }
+    return storage_->ReadRows(
+        timestamp_, table_id_,
+        absl::MakeConstSpan(key_ranges_).subspan(range_pos_), after_key,
+        column_ids_, max_rows, rows, sampler_.get(), positions);
+  }
+
+  // Reads the whole reservoir sample into rows_, in key order.
+  void ReadReservoir() {
+    std::vector<Row> sample;
+    std::optional<class Key> last_key;
+    std::vector<Row> rows;
+    std::vector<int64_t> positions;
+    bool done = false;
+    while (!done) {
+      rows.clear();
+      positions.clear();
+      done = FetchRows(last_key.has_value() ? &*last_key : nullptr,
+                       kIteratorBatchSize, &rows, &positions);
+      if (!rows.empty()) {
+        last_key = rows.back().first;
+      }
+      for (int i = 0; i < rows.size(); ++i) {
+        if (positions[i] == sample.size()) {
+          sample.push_back(std::move(rows[i]));
+        } else {
+          sample[positions[i]] = std::move(rows[i]);
+        }
+      }
+    }
+    std::sort(sample.begin(), sample.end(),
+              [](const Row& a, const Row& b) { return a.first < b.first; });
+    rows_ = std::move(sample);
+    pos_ = 0;
+    done_ = true;
+  }
+
+  const InMemoryStorage* storage_;
+  const absl::Time timestamp_;
+  const TableID table_id_;
+  const std::vector<KeyRange> key_ranges_;
+  const std::vector<ColumnID> column_ids_;
+
+  // Decides which rows are returned, if the iterator reads a sample.
+  std::unique_ptr<RowSampler> sampler_;
+
+  // Maximum number of rows returned if positive, and the number of rows
+  // fetched so far.
+  const int64_t limit_;
+  int64_t num_rows_fetched_ = 0;
+
+  // Index of the first key range which may contain rows not yet fetched.
+  size_t range_pos_ = 0;
+
+  // The current batch of rows and the position of the iterator within it.
+  std::vector<Row> rows_;
+  int pos_ = -1;
+
+  // True if there are no rows left to fetch from storage.
+  bool done_ = false;
+};
+
+InMemoryStorage::Table* InMemoryStorage::FindTable(
+    const TableID& table_id) const {
+  absl::ReaderMutexLock lock(&mu_);
+  auto table_itr = tables_.find(table_id);
+  if (table_itr == tables_.end()) {
+    return nullptr;
+  }
+  return table_itr->second.get();
+}
+
+InMemoryStorage::Table* InMemoryStorage::FindOrCreateTable(
+    const TableID& table_id) {
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    auto table_itr = tables_.find(table_id);
+    if (table_itr != tables_.end()) {
+      return table_itr->second.get();
+    }
+  }
+  absl::MutexLock lock(&mu_);
+  std::unique_ptr<Table>& table = tables_[table_id];
+  if (table == nullptr) {
+    table = std::make_unique<Table>();
+  }
+  return table.get();
+}
+
+bool InMemoryStorage::IsShared(const Table& table) {
+  if (table.state.use_count() > 1) {
+    return true;
+  }
+  // The other owners only read the contents and released them with acquire-
+  // release semantics, so their reads happen before any subsequent write.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return false;
+}
+
+void InMemoryStorage::Unshare(Table* table) {
+  if (IsShared(*table)) {
+    table->state = std::make_shared<TableState>(*table->state);
+  }
+}
+
+std::unique_ptr<InMemoryStorage> InMemoryStorage::Clone() const {
+  auto clone = std::make_unique<InMemoryStorage>();
+  absl::ReaderMutexLock lock(&mu_);
+  absl::MutexLock clone_lock(&clone->mu_);
+  for (const auto& [table_id, table] : tables_) {
+    auto cloned_table = std::make_unique<Table>();
+    absl::ReaderMutexLock table_lock(&table->mu);
+    absl::MutexLock cloned_table_lock(&cloned_table->mu);
+    cloned_table->state = table->state;
+    clone->tables_.emplace(table_id, std::move(cloned_table));
+  }
+  return clone;
+}
+
+void InMemoryStorage::RangeTombstones::SplitAt(const Key& key) {
+  auto itr = segments_.upper_bound(key);
+  if (itr == segments_.begin()) {
+    return;
+  }
+  auto segment_itr = std::prev(itr);
+  if (segment_itr->first < key && key < segment_itr->second.limit) {
+    Segment tail{segment_itr->second.limit, segment_itr->second.timestamps};
+    segment_itr->second.limit = key;
+    segments_.emplace_hint(itr, key, std::move(tail));
+  }
+}
+
+void InMemoryStorage::RangeTombstones::Add(const RangeTombstone& tombstone) {
+  tombstones_.push_back(tombstone);
+  // Tombstones are ClosedOpen, see ValidateDeleteRange().
+  const Key& start = tombstone.key_range.start_key();
+  const Key& limit = tombstone.key_range.limit_key();
+  if (!(start < limit)) {
+    return;
+  }
+  SplitAt(start);
+  SplitAt(limit);
+  // Walks the segments and the gaps between them from `start` to `limit`,
+  // adding the timestamp to the former and filling the latter with new
+  // segments.
+  Key position = start;
+  auto itr = segments_.lower_bound(start);
+  while (position < limit) {
+    if (itr != segments_.end() && itr->first == position) {
+      std::vector<absl::Time>& timestamps = itr->second.timestamps;
+      timestamps.insert(absl::c_upper_bound(timestamps, tombstone.timestamp),
+                        tombstone.timestamp);
+      position = itr->second.limit;
+      ++itr;
+    } else {
+      Key gap_limit =
+          itr == segments_.end() || limit < itr->first ? limit : itr->first;
+      segments_.emplace_hint(itr, position,
+                             Segment{gap_limit, {tombstone.timestamp}});
+      position = std::move(gap_limit);
+    }
+  }
+}
+
+absl::Time InMemoryStorage::RangeTombstones::DeletedAt(
+    const Key& key, absl::Time timestamp) const {
+  auto itr = segments_.upper_bound(key);
+  if (itr == segments_.begin()) {
+    return absl::InfinitePast();
+  }
+  const Segment& segment = std::prev(itr)->second;
+  if (!(key < segment.limit)) {
+    return absl::InfinitePast();
+  }
+  auto timestamp_itr = absl::c_upper_bound(segment.timestamps, timestamp);
+  if (timestamp_itr == segment.timestamps.begin()) {
+    return absl::InfinitePast();
+  }
+  return *std::prev(timestamp_itr);
+}
+
+std::vector<InMemoryStorage::ColumnSlot> InMemoryStorage::FindColumnSlots(
+    const Table& table, const std::vector<ColumnID>& column_ids) {
+  std::vector<ColumnSlot> slots;
+  slots.reserve(column_ids.size());
+  const absl::flat_hash_map<ColumnID, ColumnSlot>& column_slots =
+      table.state->column_slots;
+  for (const ColumnID& column_id : column_ids) {
+    auto itr = column_slots.find(column_id);
+    slots.push_back(itr != column_slots.end() ? itr->second : kMissingSlot);
+  }
+  return slots;
+}
+
+std::vector<InMemoryStorage::ColumnSlot> InMemoryStorage::FindOrAddColumnSlots(
+    Table* table, const std::vector<ColumnID>& column_ids) {
+  std::vector<ColumnSlot> slots;
+  slots.reserve(column_ids.size());
+  absl::flat_hash_map<ColumnID, ColumnSlot>& column_slots =
+      table->state->column_slots;
+  for (const ColumnID& column_id : column_ids) {
+    const ColumnSlot next_slot = column_slots.size() + 1;
+    slots.push_back(
+        column_slots.try_emplace(column_id, next_slot).first->second);
+  }
+  return slots;
+}
+
 zetasql::Value InMemoryStorage::GetCellValueAtTimestamp(
-    const Row& row, const ColumnID& column_id, absl::Time timestamp) const {
+    const TableState& state, const Key& key, const Row& row, ColumnSlot slot,
+    absl::Time timestamp, absl::Time created_at) {
   // Perform the lookup for given cell.
-  auto cell_itr = row.find(column_id);
+  auto cell_itr = row.find(slot);
   if (cell_itr == row.end()) {
     return zetasql::Value();
   }
   const Cell& cell = cell_itr->second;
   auto val_itr = cell.upper_bound(timestamp);
 
-  // Timestamp is earlier than the time the cell was first written to.
+  // Timestamp is earlier than the versions left in the cell, so the version
+  // may have been compressed, or the cell was not written to yet.
   if (val_itr == cell.begin()) {
+    if (state.cold_rows.empty()) {
+      return zetasql::Value();
+    }
+    auto cold_itr = state.cold_rows.find(key);
+    if (cold_itr == state.cold_rows.end()) {
+      return zetasql::Value();
+    }
+    absl::StatusOr<VersionBlock::Cells> cold_cells =
+        cold_itr->second.versions.Decode();
+    if (!cold_cells.ok()) {
+      ZETASQL_LOG(ERROR) << "Could not read old versions of "
+                 << key.DebugString() << ": " << cold_cells.status();
+      return zetasql::Value();
+    }
+    for (const auto& [cold_slot, cold_cell] : *cold_cells) {
+      if (cold_slot != slot) continue;
+      auto cold_val_itr = cold_cell.upper_bound(timestamp);
+      if (cold_val_itr == cold_cell.begin() ||
+          std::prev(cold_val_itr)->first < created_at) {
+        return zetasql::Value();
+      }
+      return std::prev(cold_val_itr)->second;
+    }
     return zetasql::Value();
   }
 
-  // Fetch the value from the column.
+  // Fetch the value from the column, unless it was written before the row
+  // was last created.
   --val_itr;
+  if (val_itr->first < created_at) {
+    return zetasql::Value();
+  }
   return val_itr->second;
 }
 
-bool InMemoryStorage::Exists(const Row& row, absl::Time timestamp) const {
-  zetasql::Value value =
-      GetCellValueAtTimestamp(row, kExistsColumn, timestamp);
-  return value.is_valid() && value.bool_value();
+std::optional<absl::Time> InMemoryStorage::CreatedAt(const Row& row,
+                                                     absl::Time timestamp,
+                                                     absl::Time deleted_at) {
+  auto cell_itr = row.find(kExistsSlot);
+  if (cell_itr == row.end()) {
+    return std::nullopt;
+  }
+
+  // The row was created at the start of the run of true versions which ends
+  // at the latest version at or before the timestamp. Runs are usually a
+  // single version, unless rows were written out of timestamp order.
+  const Cell& cell = cell_itr->second;
+  std::optional<absl::Time> created_at;
+  for (auto itr = cell.upper_bound(timestamp); itr != cell.begin();) {
+    --itr;
+    if (itr->first < deleted_at || !itr->second.bool_value()) {
+      break;
+    }
+    created_at = itr->first;
+  }
+  return created_at;
+}
+
+void InMemoryStorage::MarkExists(Row* row, absl::Time timestamp,
+                                 absl::Time deleted_at) {
+  if (Exists(*row, timestamp, deleted_at)) {
+    return;
+  }
+  Cell& exists_cell = (*row)[kExistsSlot];
+  if (exists_cell.find(timestamp) != exists_cell.end()) {
+    // The row was deleted at the same timestamp, e.g. earlier in the same
+    // commit. Overwriting the deletion joins the new row with the incarnation
+    // before the deletion, so the columns of that incarnation are reset
+    // explicitly.
+    for (auto& [slot, cell] : *row) {
+      if (slot != kExistsSlot) {
+        cell[timestamp] = zetasql::Value();
+      }
+    }
+  }
+  exists_cell[timestamp] = zetasql::values::Bool(true);
 }
 
 absl::Status InMemoryStorage::Lookup(
     absl::Time timestamp, const TableID& table_id, const Key& key,
     const std::vector<ColumnID>& column_ids,
     std::vector<zetasql::Value>* values) const {
-  absl::MutexLock lock(&mu_);
-
   // Validate the request.
   if (!column_ids.empty() && values == nullptr) {
     return error::Internal(
@@ -81,27 +497,30 @@ absl::Status InMemoryStorage::Lookup(
   }
 
   // Lookup for given table.
-  auto table_itr = tables_.find(table_id);
-  if (table_itr == tables_.end()) {
+  const Table* table = FindTable(table_id);
+  if (table == nullptr) {
     return absl::Status(
         absl::StatusCode::kNotFound,
         absl::StrCat("Key: ", key.DebugString(), " not found for table: ",
                      table_id, " at timestamp: ", absl::FormatTime(timestamp)));
   }
-  const Table& table = table_itr->second;
+  absl::ReaderMutexLock lock(&table->mu);
+  const TableState& state = *table->state;
 
   // Lookup for given key.
-  auto row_itr = table.find(key);
-  if (row_itr == table.end()) {
+  auto row_itr = state.rows.find(key);
+  if (row_itr == state.rows.end()) {
     return absl::Status(
         absl::StatusCode::kNotFound,
         absl::StrCat("Key: ", key.DebugString(), " not found for table: ",
                      table_id, " at timestamp: ", absl::FormatTime(timestamp)));
   }
   const Row& row = row_itr->second;
+  const std::optional<absl::Time> created_at = CreatedAt(
+      row, timestamp, state.tombstones.DeletedAt(key, timestamp));
 
   // Verify if the row exists at the given timestamp.
-  if (!Exists(row, timestamp)) {
+  if (!created_at.has_value()) {
     return absl::Status(
         absl::StatusCode::kNotFound,
         absl::StrCat(
@@ -115,20 +534,92 @@ absl::Status InMemoryStorage::Lookup(
   }
 
   // Fetch the value from the cell at the given timestamp.
-  for (int i = 0; i < column_ids.size(); ++i) {
-    values->emplace_back(
-        GetCellValueAtTimestamp(row, column_ids[i], timestamp));
+  for (ColumnSlot slot : FindColumnSlots(*table, column_ids)) {
+    values->emplace_back(GetCellValueAtTimestamp(state, key, row, slot,
+                                                 timestamp, *created_at));
   }
 
   return absl::OkStatus();
 }
 
+bool InMemoryStorage::Exists(absl::Time timestamp, const TableID& table_id,
+                             const Key& key) const {
+  const Table* table = FindTable(table_id);
+  if (table == nullptr) {
+    return false;
+  }
+  absl::ReaderMutexLock lock(&table->mu);
+  const TableState& state = *table->state;
+  auto row_itr = state.rows.find(key);
+  if (row_itr == state.rows.end()) {
+    return false;
+  }
+  return CreatedAt(row_itr->second, timestamp,
+                   state.tombstones.DeletedAt(key, timestamp))
+      .has_value();
+}
+
+absl::Status InMemoryStorage::BatchLookup(
+    absl::Time timestamp, const TableID& table_id, absl::Span<const Key> keys,
+    const std::vector<ColumnID>& column_ids,
+    std::vector<std::optional<std::vector<zetasql::Value>>>* rows) const {
+  rows->assign(keys.size(), std::nullopt);
+  const Table* table = FindTable(table_id);
+  if (table == nullptr || keys.empty()) {
+    return absl::OkStatus();
+  }
+
+  // Visit the keys in sorted order so that each key is found by stepping
+  // forward from the previous one.
+  std::vector<int> order(keys.size());
+  for (int i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(),
+            [&keys](int a, int b) { return keys[a] < keys[b]; });
+
+  absl::ReaderMutexLock lock(&table->mu);
+  const TableState& state = *table->state;
+  const std::vector<ColumnSlot> slots = FindColumnSlots(*table, column_ids);
+  const Rows& table_rows = state.rows;
+  auto row_itr = table_rows.lower_bound(keys[order[0]]);
+  for (int i : order) {
+    const Key& key = keys[i];
+    int steps = 0;
+    while (row_itr != table_rows.end() && row_itr->first < key &&
+           steps < kBatchLookupMaxSteps) {
+      ++row_itr;
+      ++steps;
+    }
+    if (row_itr != table_rows.end() && row_itr->first < key) {
+      row_itr = table_rows.lower_bound(key);
+    }
+    if (row_itr == table_rows.end()) {
+      break;
+    }
+    if (!(row_itr->first == key)) {
+      continue;
+    }
+    const std::optional<absl::Time> created_at =
+        CreatedAt(row_itr->second, timestamp,
+                  state.tombstones.DeletedAt(key, timestamp));
+    if (!created_at.has_value()) {
+      continue;
+    }
+    std::vector<zetasql::Value>& values = (*rows)[i].emplace();
+    values.reserve(slots.size());
+    for (ColumnSlot slot : slots) {
+      values.emplace_back(GetCellValueAtTimestamp(
+          state, key, row_itr->second, slot, timestamp, *created_at));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status InMemoryStorage::Read(
     absl::Time timestamp, const TableID& table_id, const KeyRange& key_range,
     const std::vector<ColumnID>& column_ids,
     std::unique_ptr<StorageIterator>* itr) const {
-  absl::MutexLock lock(&mu_);
-
   // Validate the request.
   if (!key_range.IsClosedOpen()) {
     return error::Internal(
@@ -137,110 +628,825 @@ absl::Status InMemoryStorage::Read(
                      key_range.DebugString()));
   }
 
-  std::vector<FixedRowStorageIterator::Row> rows;
   // Return an empty iterator for empty key_range.
   if (key_range.start_key() >= key_range.limit_key()) {
     *itr = std::make_unique<FixedRowStorageIterator>();
     return absl::OkStatus();
   }
 
-  // Lookup for given table.
-  auto table_itr = tables_.find(table_id);
-  if (table_itr == tables_.end()) {
+  *itr = std::make_unique<RangeIterator>(
+      this, timestamp, table_id, std::vector<KeyRange>{key_range}, column_ids);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryStorage::ReadRanges(
+    absl::Time timestamp, const TableID& table_id,
+    absl::Span<const KeyRange> key_ranges,
+    const std::vector<ColumnID>& column_ids,
+    std::unique_ptr<StorageIterator>* itr) const {
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<KeyRange> non_empty_ranges,
+                   NonEmptyKeyRanges("ReadRanges", key_ranges));
+
+  // Return an empty iterator if all key ranges are empty.
+  if (non_empty_ranges.empty()) {
     *itr = std::make_unique<FixedRowStorageIterator>();
     return absl::OkStatus();
   }
-  const Table& table = table_itr->second;
 
-  // Lookup keys from the given key range.
-  auto row_start_itr = table.lower_bound(key_range.start_key());
-  auto row_end_itr = table.lower_bound(key_range.limit_key());
-  for (auto itr = row_start_itr; itr != row_end_itr; ++itr) {
-    const InMemoryStorage::Row& row = itr->second;
-    if (!Exists(row, timestamp)) {
-      continue;
+  *itr = std::make_unique<RangeIterator>(
+      this, timestamp, table_id, std::move(non_empty_ranges), column_ids);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryStorage::ReadSample(
+    absl::Time timestamp, const TableID& table_id,
+    absl::Span<const KeyRange> key_ranges,
+    const std::vector<ColumnID>& column_ids, const RowSample& sample,
+    std::unique_ptr<StorageIterator>* itr) const {
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<KeyRange> non_empty_ranges,
+                   NonEmptyKeyRanges("ReadSample", key_ranges));
+  if (non_empty_ranges.empty()) {
+    *itr = std::make_unique<FixedRowStorageIterator>();
+    return absl::OkStatus();
+  }
+
+  *itr = std::make_unique<RangeIterator>(this, timestamp, table_id,
+                                         std::move(non_empty_ranges),
+                                         column_ids, sample);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryStorage::ReadFirstRows(
+    absl::Time timestamp, const TableID& table_id,
+    absl::Span<const KeyRange> key_ranges,
+    const std::vector<ColumnID>& column_ids, int64_t limit,
+    std::unique_ptr<StorageIterator>* itr) const {
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<KeyRange> non_empty_ranges,
+                   NonEmptyKeyRanges("ReadFirstRows", key_ranges));
+  if (non_empty_ranges.empty() || limit <= 0) {
+    *itr = std::make_unique<FixedRowStorageIterator>();
+    return absl::OkStatus();
+  }
+
+  *itr = std::make_unique<RangeIterator>(
+      this, timestamp, table_id, std::move(non_empty_ranges), column_ids,
+      /*sample=*/std::nullopt, limit);
+  return absl::OkStatus();
+}
+
+bool InMemoryStorage::ReadRows(
+    absl::Time timestamp, const TableID& table_id,
+    absl::Span<const KeyRange> key_ranges, const Key* after_key,
+    const std::vector<ColumnID>& column_ids,
+    int max_rows,
+    std::vector<std::pair<Key, std::vector<zetasql::Value>>>* rows,
+    RowSampler* sampler, std::vector<int64_t>* positions) const {
+  // Lookup for given table.
+  const Table* table = FindTable(table_id);
+  if (table == nullptr || key_ranges.empty()) {
+    return true;
+  }
+  absl::ReaderMutexLock lock(&table->mu);
+  const TableState& state = *table->state;
+  const std::vector<ColumnSlot> slots = FindColumnSlots(*table, column_ids);
+
+  // Lookup keys from the given key ranges, resuming after the last key which
+  // was already returned. The start of each subsequent key range is found by
+  // stepping forward from the end of the previous one.
+  const Rows& table_rows = state.rows;
+  auto row_itr = after_key == nullptr
+                     ? table_rows.lower_bound(key_ranges.front().start_key())
+                     : table_rows.upper_bound(*after_key);
+  for (int i = 0; i < key_ranges.size(); ++i) {
+    const KeyRange& key_range = key_ranges[i];
+    if (i > 0) {
+      int steps = 0;
+      while (row_itr != table_rows.end() &&
+             row_itr->first < key_range.start_key() &&
+             steps < kBatchLookupMaxSteps) {
+        ++row_itr;
+        ++steps;
+      }
+      if (row_itr != table_rows.end() &&
+          row_itr->first < key_range.start_key()) {
+        row_itr = table_rows.lower_bound(key_range.start_key());
+      }
     }
+    for (; row_itr != table_rows.end() &&
+           row_itr->first < key_range.limit_key();
+         ++row_itr) {
+      if (rows->size() >= max_rows) {
+        return false;
+      }
+      const InMemoryStorage::Row& row = row_itr->second;
+      const std::optional<absl::Time> created_at =
+          CreatedAt(row, timestamp,
+                    state.tombstones.DeletedAt(row_itr->first, timestamp));
+      if (!created_at.has_value()) {
+        continue;
+      }
+      if (sampler != nullptr) {
+        const int64_t position = sampler->Next();
+        if (position == RowSampler::kSkip) {
+          continue;
+        }
+        if (positions != nullptr) {
+          positions->push_back(position);
+        }
+      }
 
-    std::vector<zetasql::Value> values;
-    values.reserve(column_ids.size());
-    for (const ColumnID& column_id : column_ids) {
-      values.emplace_back(GetCellValueAtTimestamp(row, column_id, timestamp));
+      std::vector<zetasql::Value> values;
+      values.reserve(slots.size());
+      for (ColumnSlot slot : slots) {
+        values.emplace_back(GetCellValueAtTimestamp(
+            state, row_itr->first, row, slot, timestamp, *created_at));
+      }
+      rows->emplace_back(row_itr->first, std::move(values));
+    }
+    if (row_itr == table_rows.end()) {
+      break;
     }
-    rows.emplace_back(std::make_pair(itr->first, values));
   }
-  *itr = std::make_unique<FixedRowStorageIterator>(std::move(rows));
-  return absl::OkStatus();
+  return true;
 }
 
 absl::Status InMemoryStorage::Write(
     absl::Time timestamp, const TableID& table_id, const Key& key,
     const std::vector<ColumnID>& column_ids,
     const std::vector<zetasql::Value>& values) {
-  absl::MutexLock lock(&mu_);
-
   // Add the table if it does not exist.
-  Table& table = tables_[table_id];
+  Table* table = FindOrCreateTable(table_id);
+  const absl::Time collectable_before =
+      CollectableBefore(timestamp, OldestReader());
+  absl::MutexLock lock(&table->mu);
+  Unshare(table);
+  WriteRow(timestamp, key, FindOrAddColumnSlots(table, column_ids), values,
+           collectable_before, table->state->rows.end(), table);
+  return absl::OkStatus();
+}
 
-  // Add the row with _exists system column if it does not exist.
-  Row& row = table[key];
-  if (!Exists(row, timestamp)) {
-    row[kExistsColumn][timestamp] = zetasql::values::Bool(true);
+absl::Time InMemoryStorage::CollectableBefore(absl::Time timestamp,
+                                              absl::Time oldest_reader) const {
+  // Reads older than the retention of the write fail once it commits, as they
+  // are past the version garbage collection limit.
+  return std::min(timestamp - write_retention_, oldest_reader);
+}
+
+absl::Time InMemoryStorage::OldestReader() const {
+  if (write_retention_ == absl::InfiniteDuration()) {
+    return absl::InfinitePast();
+  }
+  absl::MutexLock lock(&readers_mu_);
+  return active_read_timestamps_.empty() ? absl::InfiniteFuture()
+                                         : *active_read_timestamps_.begin();
+}
+
+void InMemoryStorage::DropCollectableVersions(absl::Time collectable_before,
+                                              Cell* cell) {
+  auto keep_itr = cell->upper_bound(collectable_before);
+  if (keep_itr != cell->begin()) {
+    cell->erase(cell->begin(), std::prev(keep_itr));
+  }
+}
+
+void InMemoryStorage::Intern(ColumnSlot slot, zetasql::Value* value,
+                             TableState* state) {
+  ParseJson(value);
+  if (!value->is_valid() || value->is_null()) {
+    return;
   }
+  const zetasql::Type* type = value->type();
+  const bool string_array =
+      type->IsArray() && type->AsArray()->element_type()->IsString();
+  if (!type->IsString() && !string_array) {
+    return;
+  }
+  StringDictionary& dictionary = state->dictionaries[slot];
+  if (!string_array) {
+    InternString(value, &dictionary);
+    return;
+  }
+  // The elements of the arrays of a column share its dictionary, so that an
+  // ARRAY<STRING> column of tags holds a single copy of each distinct tag.
+  if (dictionary.overflowed || value->is_empty_array()) {
+    return;
+  }
+  std::vector<zetasql::Value> elements = value->elements();
+  for (zetasql::Value& element : elements) {
+    if (!element.is_null()) {
+      InternString(&element, &dictionary);
+    }
+    if (dictionary.overflowed) {
+      return;
+    }
+  }
+  *value = zetasql::Value::Array(type->AsArray(), elements);
+}
+
+void InMemoryStorage::InternString(zetasql::Value* value,
+                                   StringDictionary* dictionary) {
+  if (dictionary->overflowed) {
+    return;
+  }
+  auto itr = dictionary->values.find(value->string_value());
+  if (itr != dictionary->values.end()) {
+    *value = itr->second;
+    return;
+  }
+  if (dictionary->values.size() >= kMaxDictionarySize) {
+    dictionary->overflowed = true;
+    dictionary->values = {};
+    return;
+  }
+  // The key views the contents of the value stored in the dictionary.
+  dictionary->values.emplace(value->string_value(), *value);
+}
+
+InMemoryStorage::Rows::iterator InMemoryStorage::WriteRow(
+    absl::Time timestamp, Key key, absl::Span<const ColumnSlot> slots,
+    std::vector<zetasql::Value> values, absl::Time collectable_before,
+    Rows::iterator hint, Table* table) {
+  TableState& state = *table->state;
+  state.max_write_timestamp = std::max(state.max_write_timestamp, timestamp);
+
+  // Add the row with _exists system column if it does not exist.
+  auto row_itr = state.rows.try_emplace(hint, std::move(key));
+  Row& row = row_itr->second;
+  MarkExists(&row, timestamp,
+             state.tombstones.DeletedAt(row_itr->first, timestamp));
 
   // Add the values for the given columns.
-  for (int i = 0; i < column_ids.size(); ++i) {
-    row[column_ids[i]][timestamp] = values[i];
+  for (int i = 0; i < slots.size(); ++i) {
+    Intern(slots[i], &values[i], &state);
+    Cell& cell = row[slots[i]];
+    cell[timestamp] = std::move(values[i]);
+    if (cell.begin()->first < collectable_before) {
+      DropCollectableVersions(collectable_before, &cell);
+    }
   }
+  return row_itr;
+}
 
-  return absl::OkStatus();
+absl::Status InMemoryStorage::LoadSorted(
+    absl::Time timestamp, const TableID& table_id,
+    const std::vector<ColumnID>& column_ids, StorageIterator* rows) {
+  // Add the table if it does not exist.
+  Table* table = FindOrCreateTable(table_id);
+  bool done = false;
+  while (!done) {
+    absl::MutexLock lock(&table->mu);
+    Unshare(table);
+    TableState& state = *table->state;
+    // Inserting right before the successor of the previous row takes
+    // amortized constant time when rows arrive in ascending key order. The
+    // hint does not outlive the lock since other writers may restructure the
+    // rows in between batches.
+    auto hint = state.rows.end();
+    state.max_write_timestamp = std::max(state.max_write_timestamp, timestamp);
+    const std::vector<ColumnSlot> slots =
+        FindOrAddColumnSlots(table, column_ids);
+    for (int n = 0; n < kWriteBatchSize; ++n) {
+      if (!rows->Next()) {
+        done = true;
+        break;
+      }
+      auto row_itr = state.rows.try_emplace(hint, rows->Key());
+      Row& row = row_itr->second;
+      MarkExists(&row, timestamp,
+                 state.tombstones.DeletedAt(row_itr->first, timestamp));
+      for (int i = 0; i < slots.size(); ++i) {
+        zetasql::Value value = rows->ColumnValue(i);
+        Intern(slots[i], &value, &state);
+        row[slots[i]][timestamp] = std::move(value);
+      }
+      hint = std::next(row_itr);
+    }
+  }
+  return rows->Status();
 }
 
 absl::Status InMemoryStorage::Delete(absl::Time timestamp,
                                      const TableID& table_id,
                                      const KeyRange& key_range) {
-  absl::MutexLock lock(&mu_);
+  ZETASQL_RETURN_IF_ERROR(ValidateDeleteRange(key_range));
+  if (key_range.start_key() >= key_range.limit_key()) {
+    return absl::OkStatus();
+  }
 
+  // Lookup for given table.
+  Table* table = FindTable(table_id);
+  if (table == nullptr) {
+    return absl::OkStatus();
+  }
+  absl::MutexLock lock(&table->mu);
+  Unshare(table);
+  DeleteRows(timestamp, key_range, table);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryStorage::Apply(absl::Span<StorageWrite> writes) {
+  // Group the writes by table, preserving their order within each table, so
+  // that the lock of each table is acquired once for the whole batch. Deletes
+  // are validated upfront so that an invalid one does not leave the batch
+  // partially applied.
+  std::vector<std::pair<TableID, std::vector<StorageWrite*>>> writes_by_table;
+  absl::flat_hash_map<TableID, int> table_positions;
+  for (StorageWrite& write : writes) {
+    if (write.kind == StorageWrite::Kind::kDelete) {
+      ZETASQL_RETURN_IF_ERROR(ValidateDeleteRange(write.key_range));
+    }
+    auto [itr, inserted] =
+        table_positions.try_emplace(write.table_id, writes_by_table.size());
+    if (inserted) {
+      writes_by_table.emplace_back(write.table_id,
+                                   std::vector<StorageWrite*>());
+    }
+    writes_by_table[itr->second].second.push_back(&write);
+  }
+
+  const absl::Time oldest_reader = OldestReader();
+  for (const auto& [table_id, table_writes] : writes_by_table) {
+    Table* table = FindOrCreateTable(table_id);
+    for (int start = 0; start < table_writes.size();
+         start += kWriteBatchSize) {
+      const int end = std::min<int>(start + kWriteBatchSize,
+                                    table_writes.size());
+      absl::MutexLock lock(&table->mu);
+      Unshare(table);
+      // Buffered ops are sorted by key within each table, so hinting each
+      // write with the successor of the previous row makes insertions
+      // amortized constant time.
+      auto hint = table->state->rows.end();
+      for (int i = start; i < end; ++i) {
+        StorageWrite* write = table_writes[i];
+        if (write->kind == StorageWrite::Kind::kDelete) {
+          if (write->key_range.start_key() < write->key_range.limit_key()) {
+            DeleteRows(write->timestamp, write->key_range, table);
+          }
+          hint = table->state->rows.end();
+        } else {
+          hint = std::next(
+              WriteRow(write->timestamp, std::move(write->key),
+                       FindOrAddColumnSlots(table, write->column_ids),
+                       std::move(write->values),
+                       CollectableBefore(write->timestamp, oldest_reader),
+                       hint, table));
+        }
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryStorage::ValidateDeleteRange(const KeyRange& key_range) {
   if (!key_range.IsClosedOpen()) {
     return error::Internal(
         absl::StrCat("InMemoryStorage::Delete should be called "
                      "with ClosedOpen key range, found: ",
                      key_range.DebugString()));
   }
-  if (key_range.start_key() >= key_range.limit_key()) {
-    return absl::OkStatus();
+  return absl::OkStatus();
+}
+
+void InMemoryStorage::DeleteRows(absl::Time timestamp,
+                                 const KeyRange& key_range, Table* table) {
+  // Lookup keys from the given key range.
+  TableState& state = *table->state;
+  Rows& rows = state.rows;
+  auto row_start_itr = rows.lower_bound(key_range.start_key());
+  if (row_start_itr == rows.end()) {
+    return;
   }
+  auto row_end_itr = rows.lower_bound(key_range.limit_key());
 
-  // Lookup for given table.
-  auto table_itr = tables_.find(table_id);
-  if (table_itr == tables_.end()) {
-    return absl::OkStatus();
+  // A range spanning many rows is deleted by a single tombstone. Since row
+  // versions at the timestamp of a tombstone take precedence over it, so that
+  // rows written after the tombstone in the same commit survive it, the
+  // tombstone must be newer than all versions of the rows it deletes.
+  if (timestamp > state.max_write_timestamp) {
+    int num_rows = 0;
+    for (auto itr = row_start_itr;
+         itr != row_end_itr && num_rows <= kEagerDeleteMaxRows; ++itr) {
+      ++num_rows;
+    }
+    if (num_rows > kEagerDeleteMaxRows) {
+      state.tombstones.Add(RangeTombstone{key_range, timestamp});
+      return;
+    }
+  }
+  // Mark the keys as deleted with a single version of their _exists column.
+  // Readers ignore the column versions of a row written before it was last
+  // created, so they need not be invalidated one by one. Versions written at
+  // the timestamp of the deletion precede it, e.g. in the same commit, and are
+  // superseded by it.
+  const bool may_have_versions_at_timestamp =
+      timestamp <= state.max_write_timestamp;
+  for (auto itr = row_start_itr; itr != row_end_itr; ++itr) {
+    Row& row = itr->second;
+    if (!Exists(row, timestamp,
+                state.tombstones.DeletedAt(itr->first, timestamp))) {
+      continue;
+    }
+    if (may_have_versions_at_timestamp) {
+      for (auto cell_itr = row.begin(); cell_itr != row.end();) {
+        Cell& cell = cell_itr->second;
+        if (cell_itr->first != kExistsSlot && cell.erase(timestamp) > 0 &&
+            cell.empty()) {
+          row.erase(cell_itr++);
+        } else {
+          ++cell_itr;
+        }
+      }
+    }
+    row[kExistsSlot][timestamp] = zetasql::values::Bool(false);
+  }
+}
+
+void InMemoryStorage::RegisterReader(absl::Time timestamp) const {
+  absl::MutexLock lock(&readers_mu_);
+  active_read_timestamps_.insert(timestamp);
+}
+
+void InMemoryStorage::UnregisterReader(absl::Time timestamp) const {
+  absl::MutexLock lock(&readers_mu_);
+  auto itr = active_read_timestamps_.find(timestamp);
+  if (itr != active_read_timestamps_.end()) {
+    active_read_timestamps_.erase(itr);
   }
-  Table& table = table_itr->second;
+}
 
-  // Lookup keys from the given key range.
-  auto row_start_itr = table.lower_bound(key_range.start_key());
-  if (row_start_itr == table.end()) {
-    return absl::OkStatus();
+bool InMemoryStorage::CollectRowGarbage(Row* row, absl::Time gc_timestamp,
+                                        absl::Time deleted_at,
+                                        GarbageCollectionStats* stats) {
+  // Column versions older than the creation of the row visible at
+  // gc_timestamp are not visible at or after gc_timestamp. If no row is
+  // visible at gc_timestamp, none of the versions at or before it are.
+  const std::optional<absl::Time> created_at =
+      CreatedAt(*row, gc_timestamp, deleted_at);
+  for (auto cell_itr = row->begin(); cell_itr != row->end();) {
+    Cell& cell = cell_itr->second;
+    auto keep_itr = cell.upper_bound(gc_timestamp);
+    if (created_at.has_value()) {
+      if (cell_itr->first == kExistsSlot) {
+        // The versions since the creation of the row tell that it exists.
+        keep_itr = cell.find(*created_at);
+      } else if (keep_itr != cell.begin() &&
+                 std::prev(keep_itr)->first >= *created_at) {
+        // The latest version at or before gc_timestamp must be kept since it
+        // is visible at gc_timestamp. All versions before it can be dropped.
+        --keep_itr;
+      }
+    }
+    for (auto itr = cell.begin(); itr != keep_itr; ++itr) {
+      ++stats->versions_removed;
+      stats->bytes_reclaimed += VersionSizeInBytes(itr->second);
+    }
+    cell.erase(cell.begin(), keep_itr);
+
+    if (cell.empty()) {
+      row->erase(cell_itr++);
+      continue;
+    }
+    if (cell_itr->first != kExistsSlot && cell.size() == 1 &&
+        cell.begin()->first <= gc_timestamp &&
+        !cell.begin()->second.is_valid()) {
+      // A cell whose only version is a reset reads the same as a missing
+      // cell.
+      ++stats->versions_removed;
+      stats->bytes_reclaimed += VersionSizeInBytes(cell.begin()->second);
+      row->erase(cell_itr++);
+      continue;
+    }
+    ++cell_itr;
   }
-  auto row_end_itr = table.lower_bound(key_range.limit_key());
 
-  // Mark the keys as deleted.
-  for (auto itr = row_start_itr; itr != row_end_itr; ++itr) {
-    if (!Exists(itr->second, timestamp)) {
+  // A row which is not visible at gc_timestamp is left empty unless it was
+  // written since.
+  return row->empty();
+}
+
+InMemoryStorage::GarbageCollectionStats InMemoryStorage::CollectGarbage(
+    absl::Time gc_timestamp) {
+  {
+    absl::MutexLock lock(&readers_mu_);
+    if (!active_read_timestamps_.empty()) {
+      gc_timestamp = std::min(gc_timestamp, *active_read_timestamps_.begin());
+    }
+  }
+
+  std::vector<Table*> tables;
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    for (const auto& [table_id, table] : tables_) {
+      tables.push_back(table.get());
+    }
+  }
+
+  // Tables are processed in batches of rows to avoid blocking readers and
+  // writers for the duration of the whole pass. Tables shared with a clone of
+  // the storage are skipped rather than copied, since neither side has written
+  // to them since they were cloned.
+  GarbageCollectionStats stats;
+  for (Table* table : tables) {
+    // Range tombstones at or before gc_timestamp are compacted into the rows
+    // they cover during the pass, and dropped once the pass is complete.
+    RangeTombstones compacted;
+    {
+      absl::MutexLock lock(&table->mu);
+      for (const RangeTombstone& tombstone :
+           table->state->tombstones.tombstones()) {
+        if (tombstone.timestamp <= gc_timestamp) {
+          compacted.Add(tombstone);
+        }
+      }
+    }
+
+    std::optional<Key> last_key;
+    bool done = false;
+    while (!done) {
+      absl::MutexLock lock(&table->mu);
+      if (IsShared(*table)) {
+        break;
+      }
+      Rows& rows = table->state->rows;
+      auto row_itr =
+          last_key.has_value() ? rows.upper_bound(*last_key) : rows.begin();
+      for (int i = 0; i < kGarbageCollectionBatchSize && row_itr != rows.end();
+           ++i) {
+        last_key = row_itr->first;
+        // Compressed versions only take part in garbage collection once some
+        // of them can be removed.
+        if (!table->state->cold_rows.empty()) {
+          auto cold_itr = table->state->cold_rows.find(row_itr->first);
+          if (cold_itr != table->state->cold_rows.end() &&
+              cold_itr->second.collectable_at <= gc_timestamp) {
+            DecompressRow(row_itr->first, &row_itr->second,
+                          table->state.get());
+          }
+        }
+        if (CollectRowGarbage(
+                &row_itr->second, gc_timestamp,
+                compacted.DeletedAt(row_itr->first, gc_timestamp), &stats)) {
+          ++stats.rows_removed;
+          stats.bytes_reclaimed += row_itr->first.LogicalSizeInBytes();
+          for (const auto& [slot, cell] : row_itr->second) {
+            for (const auto& [timestamp, value] : cell) {
+              ++stats.versions_removed;
+              stats.bytes_reclaimed += VersionSizeInBytes(value);
+            }
+          }
+          table->state->cold_rows.erase(row_itr->first);
+          row_itr = rows.erase(row_itr);
+        } else {
+          ++row_itr;
+        }
+      }
+      done = row_itr == rows.end();
+    }
+
+    if (!compacted.empty()) {
+      absl::MutexLock lock(&table->mu);
+      if (IsShared(*table)) {
+        continue;
+      }
+      table->state->tombstones.RemoveIf(
+          [&compacted](const RangeTombstone& tombstone) {
+            return absl::c_linear_search(compacted.tombstones(), tombstone);
+          });
+    }
+  }
+  return stats;
+}
+
+int64_t InMemoryStorage::CompressRow(const Key& key, absl::Time cold_timestamp,
+                                     Row* row, TableState* state) {
+  // Returns the end of the versions of `cell` to compress: those older than
+  // cold_timestamp, but not the latest version.
+  auto cold_end = [cold_timestamp](const Cell& cell) {
+    auto end_itr = cell.lower_bound(cold_timestamp);
+    return end_itr == cell.end() ? std::prev(end_itr) : end_itr;
+  };
+
+  VersionBlock::Cells cold_cells;
+  auto cold_itr = state->cold_rows.find(key);
+  if (cold_itr != state->cold_rows.end()) {
+    absl::StatusOr<VersionBlock::Cells> decoded =
+        cold_itr->second.versions.Decode();
+    if (!decoded.ok()) {
+      return 0;
+    }
+    cold_cells = *std::move(decoded);
+  }
+
+  int64_t num_versions = 0;
+  for (const auto& [slot, cell] : *row) {
+    if (slot == kExistsSlot || cell.empty()) continue;
+    auto end_itr = cold_end(cell);
+    if (end_itr == cell.begin()) continue;
+    auto cold_cell_itr = absl::c_find_if(
+        cold_cells, [slot = slot](const auto& cold_cell) {
+          return cold_cell.first == slot;
+        });
+    if (cold_cell_itr == cold_cells.end()) {
+      cold_cell_itr = cold_cells.emplace(cold_cells.end(), slot, Cell());
+    }
+    cold_cell_itr->second.insert(cell.begin(), end_itr);
+    num_versions += std::distance(cell.begin(), end_itr);
+  }
+  if (num_versions == 0) {
+    return 0;
+  }
+  absl::StatusOr<VersionBlock> versions = VersionBlock::Encode(cold_cells);
+  if (!versions.ok()) {
+    return 0;
+  }
+
+  ColdRow cold_row{.versions = *std::move(versions),
+                   .collectable_at = absl::InfiniteFuture()};
+  for (const auto& [slot, cold_cell] : cold_cells) {
+    auto cell_itr = row->find(slot);
+    if (cell_itr == row->end() || cell_itr->second.empty()) {
+      // Only garbage collection removes cells, once it decompressed them.
+      cold_row.collectable_at = absl::InfinitePast();
       continue;
     }
+    Cell& cell = cell_itr->second;
+    cell.erase(cell.begin(), cold_end(cell));
+    const absl::Time second_version =
+        cold_cell.size() > 1 ? std::next(cold_cell.begin())->first
+                             : cell.begin()->first;
+    cold_row.collectable_at = std::min(cold_row.collectable_at, second_version);
+  }
+  state->cold_rows.insert_or_assign(key, std::move(cold_row));
+  return num_versions;
+}
 
-    for (const auto& columns : itr->second) {
-      if (columns.first == kExistsColumn) {
-        itr->second[kExistsColumn][timestamp] = zetasql::values::Bool(false);
+void InMemoryStorage::DecompressRow(const Key& key, Row* row,
+                                    TableState* state) {
+  auto cold_itr = state->cold_rows.find(key);
+  if (cold_itr == state->cold_rows.end()) {
+    return;
+  }
+  absl::StatusOr<VersionBlock::Cells> cold_cells =
+      cold_itr->second.versions.Decode();
+  if (cold_cells.ok()) {
+    for (auto& [slot, cold_cell] : *cold_cells) {
+      (*row)[slot].merge(cold_cell);
+    }
+  } else {
+    ZETASQL_LOG(ERROR) << "Dropping old versions of " << key.DebugString()
+               << ": " << cold_cells.status();
+  }
+  state->cold_rows.erase(cold_itr);
+}
+
+InMemoryStorage::CompressionStats InMemoryStorage::CompressVersions(
+    absl::Time cold_timestamp) {
+  std::vector<Table*> tables;
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    for (const auto& [table_id, table] : tables_) {
+      tables.push_back(table.get());
+    }
+  }
+
+  CompressionStats stats;
+  for (Table* table : tables) {
+    std::optional<Key> last_key;
+    bool done = false;
+    while (!done) {
+      absl::MutexLock lock(&table->mu);
+      if (IsShared(*table)) {
+        break;
+      }
+      Rows& rows = table->state->rows;
+      auto row_itr =
+          last_key.has_value() ? rows.upper_bound(*last_key) : rows.begin();
+      for (int i = 0; i < kGarbageCollectionBatchSize && row_itr != rows.end();
+           ++i, ++row_itr) {
+        last_key = row_itr->first;
+        const int64_t num_versions =
+            CompressRow(row_itr->first, cold_timestamp, &row_itr->second,
+                        table->state.get());
+        if (num_versions > 0) {
+          stats.versions_compressed += num_versions;
+          ++stats.rows_compressed;
+        }
+      }
+      done = row_itr == rows.end();
+    }
+  }
+  return stats;
+}
+
+void InMemoryStorage::DiscardVersionsAfter(absl::Time timestamp) {
+  std::vector<Table*> tables;
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    for (const auto& [table_id, table] : tables_) {
+      tables.push_back(table.get());
+    }
+  }
+
+  auto is_newer = [timestamp](const RangeTombstone& tombstone) {
+    return tombstone.timestamp > timestamp;
+  };
+  auto has_newer_versions = [timestamp, &is_newer](const TableState& state) {
+    if (state.max_write_timestamp > timestamp ||
+        absl::c_any_of(state.tombstones.tombstones(), is_newer) ||
+        !state.cold_rows.empty()) {
+      return true;
+    }
+    // Deletions of rows do not advance max_write_timestamp, but add a version
+    // of their _exists column.
+    for (const auto& [key, row] : state.rows) {
+      auto exists_itr = row.find(kExistsSlot);
+      if (exists_itr != row.end() &&
+          exists_itr->second.upper_bound(timestamp) !=
+              exists_itr->second.end()) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // With no writes in progress, the only contenders for a table lock are
+  // readers, so each table is processed under a single acquisition. Shared
+  // tables are only copied if they have versions to discard.
+  for (Table* table : tables) {
+    absl::MutexLock lock(&table->mu);
+    if (IsShared(*table) && !has_newer_versions(*table->state)) {
+      continue;
+    }
+    Unshare(table);
+    TableState& state = *table->state;
+    state.tombstones.RemoveIf(is_newer);
+    state.max_write_timestamp = std::min(state.max_write_timestamp, timestamp);
+    // Compressed versions may be newer than the timestamp, so they are moved
+    // back into their cells first.
+    while (!state.cold_rows.empty()) {
+      const Key key = state.cold_rows.begin()->first;
+      DecompressRow(key, &state.rows[key], &state);
+    }
+    for (auto row_itr = state.rows.begin(); row_itr != state.rows.end();) {
+      Row& row = row_itr->second;
+      for (auto cell_itr = row.begin(); cell_itr != row.end();) {
+        Cell& cell = cell_itr->second;
+        cell.erase(cell.upper_bound(timestamp), cell.end());
+        if (cell.empty()) {
+          row.erase(cell_itr++);
+        } else {
+          ++cell_itr;
+        }
+      }
+      if (row.empty()) {
+        row_itr = state.rows.erase(row_itr);
       } else {
-        // Column values are marked invalid zetasql::Value to avoid reading
-        // the value of the cell before the delete.
-        itr->second[columns.first][timestamp] = zetasql::Value();
+        ++row_itr;
       }
     }
   }
-  return absl::OkStatus();
+}
+
+absl::flat_hash_map<TableID, int64_t> InMemoryStorage::TableSizesInBytes()
+    const {
+  std::vector<std::pair<TableID, const Table*>> tables;
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    for (const auto& [table_id, table] : tables_) {
+      tables.emplace_back(table_id, table.get());
+    }
+  }
+
+  absl::flat_hash_map<TableID, int64_t> sizes;
+  for (const auto& [table_id, table] : tables) {
+    int64_t& size = sizes[table_id];
+    std::optional<Key> last_key;
+    bool done = false;
+    while (!done) {
+      absl::ReaderMutexLock lock(&table->mu);
+      const Rows& rows = table->state->rows;
+      auto row_itr =
+          last_key.has_value() ? rows.upper_bound(*last_key) : rows.begin();
+      for (int i = 0; i < kTableSizeBatchSize && row_itr != rows.end();
+           ++i, ++row_itr) {
+        last_key = row_itr->first;
+        size += row_itr->first.LogicalSizeInBytes();
+        for (const auto& [slot, cell] : row_itr->second) {
+          for (const auto& [timestamp, value] : cell) {
+            size += VersionSizeInBytes(value);
+          }
+        }
+      }
+      done = row_itr == rows.end();
+    }
+
+    absl::ReaderMutexLock lock(&table->mu);
+    for (const auto& [key, cold_row] : table->state->cold_rows) {
+      size += cold_row.versions.SizeInBytes();
+    }
+  }
+  return sizes;
 }
 
 }  // namespace backend
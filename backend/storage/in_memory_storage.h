@@ -17,13 +17,29 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_IN_MEMORY_STORAGE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_IN_MEMORY_STORAGE_H_
 
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include "zetasql/public/value.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "backend/common/ids.h"
 #include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/storage/iterator.h"
+#include "backend/storage/row_sampler.h"
 #include "backend/storage/storage.h"
+#include "backend/storage/version_block.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -33,12 +49,48 @@ namespace backend {
 
 // InMemoryStorage implements an in-memory multi-version data store.
 //
-// Keys are stored in sorted order. Value versions for a given column are also
-// sorted in order of the timestamp written. Keys are never deleted, but are
-// marked deleted for multi-version lookup.
+// Keys are stored in sorted order, in a B-tree so that monotonic appends (e.g.
+// to tables and indexes keyed by commit timestamps) fill leaf nodes one after
+// the other and range scans walk contiguous arrays of rows rather than chasing
+// a pointer per row. Value versions for a given column are also sorted in
+// order of the timestamp written. Keys are marked deleted for multi-version
+// lookup by a single version of the _exists system column of the row, however
+// many columns it has, and are only removed by CollectGarbage() once the
+// deletion is older than the garbage collection timestamp. Deletions of key
+// ranges spanning many rows are recorded as a single range tombstone instead
+// of marking each row deleted, and are compacted into the rows by
+// CollectGarbage().
 //
 // Lookup and Read return invalid zetasql::Value(s) for non-existent columns.
 //
+// Each table is guarded by its own reader-writer lock; the storage mutex only
+// guards the mapping from TableIDs to tables. Hence operations on different
+// tables (e.g. index table writes and base table scans) do not contend, and
+// multiple readers of the same table proceed in parallel.
+//
+// Iterators returned by Read do not materialize the key range upfront. Instead
+// they walk the underlying rows on demand, in small batches, reacquiring the
+// table lock for each batch. Hence memory and latency of a read scale with
+// the number of rows consumed and writers are not blocked for the duration of
+// an iteration. Since versions are immutable once written, an iterator at a
+// timestamp for which all commits have completed yields a stable snapshot.
+//
+// Versions which are only visible to stale reads can be moved into a compressed
+// block per row by CompressVersions(), leaving the latest version of each cell
+// and all recent versions in the cells. Reads which find no version of a cell
+// at their timestamp decompress the block of the row.
+//
+// STRING values are dictionary encoded per column: every version of a column
+// holding the same string shares a single copy of it, owned by the dictionary
+// of distinct values of the column. Columns with more distinct values than fit
+// in a dictionary store each value separately. Reads copy the shared values,
+// which bumps a reference count rather than copying the string.
+//
+// Clone() forks the storage without copying any rows: the clone shares the
+// contents of every table with the original, and each side copies a table the
+// first time it modifies it. Tables which are only read, such as fixture data
+// shared by many test databases, are never copied.
+//
 // This class is thread-safe.
 class InMemoryStorage : public Storage {
  public:
@@ -47,39 +99,451 @@ class InMemoryStorage : public Storage {
                       std::vector<zetasql::Value>* values) const override
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  bool Exists(absl::Time timestamp, const TableID& table_id,
+              const Key& key) const override ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Sorts the keys and resolves them in a single merge pass over the rows of
+  // the table, under a single acquisition of the table lock.
+  absl::Status BatchLookup(
+      absl::Time timestamp, const TableID& table_id, absl::Span<const Key> keys,
+      const std::vector<ColumnID>& column_ids,
+      std::vector<std::optional<std::vector<zetasql::Value>>>* rows)
+      const override ABSL_LOCKS_EXCLUDED(mu_);
+
   absl::Status Read(absl::Time timestamp, const TableID& table_id,
                     const KeyRange& key_range,
                     const std::vector<ColumnID>& column_ids,
                     std::unique_ptr<StorageIterator>* itr) const override
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Walks all the key ranges with a single iterator, which fetches the rows
+  // of consecutive key ranges in the same batch by stepping forward through
+  // the table.
+  absl::Status ReadRanges(absl::Time timestamp, const TableID& table_id,
+                          absl::Span<const KeyRange> key_ranges,
+                          const std::vector<ColumnID>& column_ids,
+                          std::unique_ptr<StorageIterator>* itr) const override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Walks the key ranges like ReadRanges, but only copies the values of the
+  // rows which are part of the sample.
+  absl::Status ReadSample(absl::Time timestamp, const TableID& table_id,
+                          absl::Span<const KeyRange> key_ranges,
+                          const std::vector<ColumnID>& column_ids,
+                          const RowSample& sample,
+                          std::unique_ptr<StorageIterator>* itr) const override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Walks the key ranges like ReadRanges, but fetches no more than `limit`
+  // rows, so that reading the first row of a range is a single lookup.
+  absl::Status ReadFirstRows(absl::Time timestamp, const TableID& table_id,
+                             absl::Span<const KeyRange> key_ranges,
+                             const std::vector<ColumnID>& column_ids,
+                             int64_t limit,
+                             std::unique_ptr<StorageIterator>* itr) const
+      override ABSL_LOCKS_EXCLUDED(mu_);
+
   absl::Status Write(absl::Time timestamp, const TableID& table_id,
                      const Key& key, const std::vector<ColumnID>& column_ids,
                      const std::vector<zetasql::Value>& values) override
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Inserts the rows in batches, one acquisition of the table lock per batch,
+  // hinting each insertion with the position of the previous row. `rows` must
+  // not read from the same table of this storage.
+  absl::Status LoadSorted(absl::Time timestamp, const TableID& table_id,
+                          const std::vector<ColumnID>& column_ids,
+                          StorageIterator* rows) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
   absl::Status Delete(absl::Time timestamp, const TableID& table_id,
                       const KeyRange& key_range) override
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Applies the writes to a table in batches, one acquisition of its lock per
+  // batch, moving the keys and values of the writes into the cells. Readers of
+  // the table hence wait for at most one batch of writes. A reader at or after
+  // the timestamp of the writes may observe a partially applied commit, as it
+  // may across tables; reads at a timestamp for which all commits have
+  // completed are unaffected.
+  absl::Status Apply(absl::Span<StorageWrite> writes) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Statistics about a single garbage collection pass.
+  struct GarbageCollectionStats {
+    // Number of cell versions removed.
+    int64_t versions_removed = 0;
+
+    // Number of fully deleted rows removed.
+    int64_t rows_removed = 0;
+
+    // Approximate number of bytes reclaimed.
+    int64_t bytes_reclaimed = 0;
+  };
+
+  // Removes versions which can no longer be observed by reads at or after
+  // `gc_timestamp`. For every cell, only the latest version at or before
+  // `gc_timestamp` and all newer versions are kept. Rows which are deleted as
+  // of `gc_timestamp` and have not been written since are removed entirely.
+  //
+  // The garbage collection timestamp is capped at the oldest timestamp of an
+  // active iterator so that in-progress reads are not affected. Subsequent
+  // reads at timestamps older than the effective garbage collection timestamp
+  // may return incomplete results.
+  GarbageCollectionStats CollectGarbage(absl::Time gc_timestamp)
+      ABSL_LOCKS_EXCLUDED(mu_, readers_mu_);
+
+  // Statistics about a single version compression pass.
+  struct CompressionStats {
+    // Number of cell versions moved into compressed blocks.
+    int64_t versions_compressed = 0;
+
+    // Number of rows whose compressed block was created or extended.
+    int64_t rows_compressed = 0;
+  };
+
+  // Moves the versions of every cell older than `cold_timestamp`, except the
+  // latest version of the cell, into a compressed block per row. The _exists
+  // column and rows whose values cannot be serialized stay uncompressed. Like
+  // CollectGarbage(), tables shared with a clone of the storage are skipped.
+  //
+  // Garbage collection decompresses the block of a row once some of its
+  // versions become collectable, and the next pass compresses the remaining
+  // old versions again.
+  CompressionStats CompressVersions(absl::Time cold_timestamp)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Walks each table in batches of rows, reacquiring the table lock for each
+  // batch, so writers are not blocked for the duration of the walk.
+  absl::flat_hash_map<TableID, int64_t> TableSizesInBytes() const override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Discards all the versions and range deletions newer than `timestamp`,
+  // returning every table to its state as of `timestamp` in a single pass over
+  // its rows. The caller must ensure that no writes are in progress and that
+  // `timestamp` is not older than the latest garbage collection timestamp.
+  // Tables shared with a clone of the storage are copied first.
+  void DiscardVersionsAfter(absl::Time timestamp) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns a storage with the same contents, including all versions, which
+  // shares the contents of each table with this storage until either of them
+  // modifies the table. Writes which are in progress while the storage is
+  // cloned may only be partially visible in the clone.
+  std::unique_ptr<InMemoryStorage> Clone() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Makes each write drop the versions of the cells it writes which neither
+  // reads within `retention` of the write nor active iterators can observe,
+  // like CollectGarbage() would, so that the versions of frequently written
+  // cells do not pile up between garbage collection passes. By default, writes
+  // keep all versions. Must be called before the storage is used.
+  void set_write_retention(absl::Duration retention) {
+    write_retention_ = retention;
+  }
+
  private:
+  // StorageIterator which lazily walks sorted key ranges of a table.
+  class RangeIterator;
+
+  // Compact handle of a column of a table, assigned by the table the first
+  // time the column is written. Cells are keyed by slot rather than by
+  // ColumnID, so that accessing a cell hashes an integer and the ColumnIDs of
+  // a request are resolved once rather than once per row.
+  using ColumnSlot = int32_t;
+
+  // Slot of the _exists system column, which tracks whether the row exists.
+  // Its versions turn true where the row is created and false where it is
+  // deleted, and column versions older than the creation of the row are not
+  // visible.
+  static constexpr ColumnSlot kExistsSlot = 0;
+
+  // Slot of columns which were never written to the table.
+  static constexpr ColumnSlot kMissingSlot = -1;
+
   using Cell = std::map<absl::Time, zetasql::Value>;
-  using Row = absl::flat_hash_map<ColumnID, Cell>;
-  using Table = std::map<Key, Row>;
-  using Tables = absl::flat_hash_map<TableID, Table>;
+  using Row = absl::flat_hash_map<ColumnSlot, Cell>;
+  // Insertions and erasures invalidate iterators into Rows, so iterators must
+  // not be kept across them, nor across releases of the table lock.
+  using Rows = absl::btree_map<Key, Row>;
+
+  // A deletion of the rows of a ClosedOpen key range at a timestamp. Row
+  // versions older than the tombstone are hidden from reads at or after it,
+  // versions at or after its timestamp are not.
+  struct RangeTombstone {
+    KeyRange key_range;
+    absl::Time timestamp;
+
+    bool operator==(const RangeTombstone& other) const {
+      return key_range == other.key_range && timestamp == other.timestamp;
+    }
+  };
+
+  // The range tombstones of a table, indexed so that finding the tombstones
+  // covering a key is a binary search rather than a scan of all of them.
+  class RangeTombstones {
+   public:
+    // Adds a tombstone.
+    void Add(const RangeTombstone& tombstone);
+
+    // Removes the tombstones for which `pred` returns true.
+    template <typename Pred>
+    void RemoveIf(Pred pred) {
+      std::vector<RangeTombstone> removed = std::move(tombstones_);
+      tombstones_.clear();
+      segments_.clear();
+      for (const RangeTombstone& tombstone : removed) {
+        if (!pred(tombstone)) Add(tombstone);
+      }
+    }
+
+    // Returns the timestamp of the latest tombstone at or before `timestamp`
+    // which covers `key`, or absl::InfinitePast() if there is none.
+    absl::Time DeletedAt(const Key& key, absl::Time timestamp) const;
+
+    // Returns the tombstones in the order they were added.
+    const std::vector<RangeTombstone>& tombstones() const {
+      return tombstones_;
+    }
+
+    bool empty() const { return tombstones_.empty(); }
 
-  // Returns true if the given row is valid at the specified timestamp.
-  bool Exists(const Row& row, absl::Time timestamp) const
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+   private:
+    // A key range which is, as a whole, covered by the tombstones at
+    // `timestamps`, in increasing order, and not covered by any other.
+    struct Segment {
+      Key limit;
+      std::vector<absl::Time> timestamps;
+    };
 
-  // Returns the value for given row and column_id at the specified timestamp.
-  zetasql::Value GetCellValueAtTimestamp(const Row& row,
-                                           const ColumnID& column_id,
-                                           absl::Time timestamp) const
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    // Splits the segment containing `key`, if any, into the segments before
+    // and from `key`.
+    void SplitAt(const Key& key);
 
+    std::vector<RangeTombstone> tombstones_;
+
+    // Disjoint segments keyed by their start keys. The keys covered by no
+    // tombstone are in no segment.
+    std::map<Key, Segment> segments_;
+  };
+
+  // The distinct STRING values, or ARRAY<STRING> elements, written to a
+  // column.
+  struct StringDictionary {
+    // Values keyed by their contents, which the values own. Copies of a value
+    // share its contents, so the keys remain valid when the map is copied.
+    absl::flat_hash_map<absl::string_view, zetasql::Value> values;
+
+    // Set once the column has too many distinct values to be encoded, in which
+    // case `values` is empty.
+    bool overflowed = false;
+  };
+
+  // The versions of a row moved out of its cells by CompressVersions(). For
+  // each cell, the compressed versions are older than those left in the cell.
+  struct ColdRow {
+    VersionBlock versions;
+
+    // Garbage collection at or after this timestamp may remove some of the
+    // versions, meaning that a cell has two versions at or before it.
+    absl::Time collectable_at;
+  };
+
+  // The contents of a table, which may be shared with clones of the storage.
+  struct TableState {
+    Rows rows;
+
+    // Range deletions not compacted into the rows yet.
+    RangeTombstones tombstones;
+
+    // The latest timestamp at which a row of the table was written.
+    absl::Time max_write_timestamp = absl::InfinitePast();
+
+    // Slots of the columns written to the table, numbered from 1.
+    absl::flat_hash_map<ColumnID, ColumnSlot> column_slots;
+
+    // Dictionaries of the STRING values, and of the elements of the
+    // ARRAY<STRING> values, written to each column, see Intern().
+    absl::flat_hash_map<ColumnSlot, StringDictionary> dictionaries;
+
+    // The compressed versions of rows, see CompressVersions().
+    absl::btree_map<Key, ColdRow> cold_rows;
+  };
+
+  // A table along with the lock guarding its contents. The contents are
+  // immutable while they are shared with another storage, see Unshare().
+  struct Table {
+    mutable absl::Mutex mu;
+    std::shared_ptr<TableState> state ABSL_GUARDED_BY(mu)
+        ABSL_PT_GUARDED_BY(mu) = std::make_shared<TableState>();
+  };
+
+  // Tables are never removed once created, so pointers to them remain valid
+  // for the lifetime of the storage.
+  using Tables = absl::flat_hash_map<TableID, std::unique_ptr<Table>>;
+
+  // Returns the table with the given id, or nullptr if it does not exist.
+  Table* FindTable(const TableID& table_id) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the table with the given id, creating it if it does not exist.
+  Table* FindOrCreateTable(const TableID& table_id) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if the contents of `table` are shared with another storage.
+  static bool IsShared(const Table& table)
+      ABSL_SHARED_LOCKS_REQUIRED(table.mu);
+
+  // Gives `table` its own copy of its contents if they are shared with another
+  // storage. Must be called before the contents are modified.
+  static void Unshare(Table* table) ABSL_EXCLUSIVE_LOCKS_REQUIRED(table->mu);
+
+  // Returns the slots of the given columns of `table`, kMissingSlot for the
+  // columns never written to it.
+  static std::vector<ColumnSlot> FindColumnSlots(
+      const Table& table, const std::vector<ColumnID>& column_ids)
+      ABSL_SHARED_LOCKS_REQUIRED(table.mu);
+
+  // Returns the slots of the given columns of `table`, assigning slots to the
+  // columns never written to it.
+  static std::vector<ColumnSlot> FindOrAddColumnSlots(
+      Table* table, const std::vector<ColumnID>& column_ids)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(table->mu);
+
+  // Replaces a STRING `value` written to the column `slot` of `state`, or
+  // each element of an ARRAY<STRING> `value`, with the equal value of the
+  // dictionary of the column, see InternString(). Unparsed JSON values are
+  // replaced by their parsed form, see ParseJson().
+  static void Intern(ColumnSlot slot, zetasql::Value* value,
+                     TableState* state);
+
+  // Replaces the STRING `value` with the equal value of `dictionary`, adding
+  // it to the dictionary if it is not there yet.
+  static void InternString(zetasql::Value* value,
+                           StringDictionary* dictionary);
+
+  // Writes the column values of the row with the given key into `table`,
+  // inserting the row close to `hint` if it does not exist yet. Versions of
+  // the written cells superseded at or before `collectable_before` are
+  // dropped, see DropCollectableVersions(). Returns the position of the row.
+  static Rows::iterator WriteRow(absl::Time timestamp, Key key,
+                                 absl::Span<const ColumnSlot> slots,
+                                 std::vector<zetasql::Value> values,
+                                 absl::Time collectable_before,
+                                 Rows::iterator hint, Table* table)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(table->mu);
+
+  // Deletes the rows of the non-empty ClosedOpen `key_range`, either by
+  // marking each row as deleted or, if the range spans many rows, by adding a
+  // range tombstone.
+  static void DeleteRows(absl::Time timestamp, const KeyRange& key_range,
+                         Table* table) ABSL_EXCLUSIVE_LOCKS_REQUIRED(table->mu);
+
+  // Returns an error if `key_range` is not in ClosedOpen form.
+  static absl::Status ValidateDeleteRange(const KeyRange& key_range);
+
+  // Returns the timestamp at which the given row was created, if it exists at
+  // the specified timestamp, given that versions of the row older than
+  // `deleted_at` are deleted (see RangeTombstones::DeletedAt()). Returns
+  // std::nullopt if the row does not exist at the timestamp. The caller must
+  // hold the lock of the table containing the row.
+  static std::optional<absl::Time> CreatedAt(const Row& row,
+                                             absl::Time timestamp,
+                                             absl::Time deleted_at);
+
+  // Returns true if the given row is valid at the specified timestamp, see
+  // CreatedAt().
+  static bool Exists(const Row& row, absl::Time timestamp,
+                     absl::Time deleted_at) {
+    return CreatedAt(row, timestamp, deleted_at).has_value();
+  }
+
+  // Marks the given row as existing from the specified timestamp on, unless
+  // it already exists at the timestamp.
+  static void MarkExists(Row* row, absl::Time timestamp, absl::Time deleted_at);
+
+  // Returns the value for given row and column slot at the specified
+  // timestamp, for the row created at `created_at` (see CreatedAt()). Versions
+  // older than those in the cell are looked up in the compressed versions of
+  // the row with the given key in `state`. The caller must hold the lock of the
+  // table containing the row.
+  static zetasql::Value GetCellValueAtTimestamp(const TableState& state,
+                                                  const Key& key,
+                                                  const Row& row,
+                                                  ColumnSlot slot,
+                                                  absl::Time timestamp,
+                                                  absl::Time created_at);
+
+  // Moves the versions of `row` selected by CompressVersions() into the
+  // compressed versions of the row with the given key in `state`. Returns the
+  // number of versions moved. The caller must hold the lock of the table
+  // exclusively.
+  static int64_t CompressRow(const Key& key, absl::Time cold_timestamp,
+                             Row* row, TableState* state);
+
+  // Moves the compressed versions of the row with the given key in `state`,
+  // if any, back into the cells of `row`. The caller must hold the lock of the
+  // table exclusively.
+  static void DecompressRow(const Key& key, Row* row, TableState* state);
+
+  // Appends up to `max_rows` rows of the sorted, disjoint `key_ranges` which
+  // exist at `timestamp` to `rows`, starting after `after_key` (or at the start
+  // of the first key range if `after_key` is nullptr). Returns true if there
+  // are no more rows left in the key ranges.
+  //
+  // If `sampler` is not nullptr, only the rows it samples are appended, and
+  // their positions in the sample are appended to `positions` if it is not
+  // nullptr.
+  bool ReadRows(absl::Time timestamp, const TableID& table_id,
+                absl::Span<const KeyRange> key_ranges, const Key* after_key,
+                const std::vector<ColumnID>& column_ids, int max_rows,
+                std::vector<std::pair<Key, std::vector<zetasql::Value>>>* rows,
+                RowSampler* sampler = nullptr,
+                std::vector<int64_t>* positions = nullptr) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the timestamp before which versions superseded at or before it
+  // can be dropped by a write at `timestamp`, given the timestamp
+  // `oldest_reader` of the oldest active iterator (see OldestReader()).
+  absl::Time CollectableBefore(absl::Time timestamp,
+                               absl::Time oldest_reader) const;
+
+  // Returns the timestamp of the oldest active iterator, or
+  // absl::InfiniteFuture() if there is none. Returns absl::InfinitePast() if
+  // writes keep all versions.
+  absl::Time OldestReader() const ABSL_LOCKS_EXCLUDED(readers_mu_);
+
+  // Drops the versions of `cell` before its latest version at or before
+  // `collectable_before`, which no read at or after it can observe.
+  static void DropCollectableVersions(absl::Time collectable_before,
+                                      Cell* cell);
+
+  // Registers and unregisters the timestamp of an active iterator.
+  void RegisterReader(absl::Time timestamp) const
+      ABSL_LOCKS_EXCLUDED(readers_mu_);
+  void UnregisterReader(absl::Time timestamp) const
+      ABSL_LOCKS_EXCLUDED(readers_mu_);
+
+  // Garbage collects the versions of a single row as described in
+  // CollectGarbage(), given the timestamp `deleted_at` of the latest range
+  // tombstone at or before `gc_timestamp` covering the row. Column versions
+  // which are not visible at gc_timestamp, since they predate the creation of
+  // the row or its deletion, are dropped. Returns true if the row can be
+  // removed. The caller must hold the lock of the table containing the row
+  // exclusively.
+  static bool CollectRowGarbage(Row* row, absl::Time gc_timestamp,
+                                absl::Time deleted_at,
+                                GarbageCollectionStats* stats);
+
+  // Guards the set of tables. Table contents are guarded by Table::mu.
   mutable absl::Mutex mu_;
   Tables tables_ ABSL_GUARDED_BY(mu_);
+
+  // Timestamps of active iterators, which bound garbage collection.
+  mutable absl::Mutex readers_mu_;
+  mutable std::multiset<absl::Time> active_read_timestamps_
+      ABSL_GUARDED_BY(readers_mu_);
+
+  // How long versions written over remain observable, see
+  // set_write_retention().
+  absl::Duration write_retention_ = absl::InfiniteDuration();
 };
 
 }  // namespace backend
@@ -16,17 +16,27 @@
 
 #include "backend/storage/in_memory_storage.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "backend/datamodel/key_range.h"
+#include "backend/storage/in_memory_iterator.h"
 #include "backend/storage/iterator.h"
+#include "backend/storage/storage.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -38,6 +48,7 @@ namespace {
 using zetasql::values::Bool;
 using zetasql::values::Int64;
 using zetasql::values::String;
+using zetasql::values::Timestamp;
 
 class InMemoryStorageTest : public testing::Test {
  protected:
@@ -274,6 +285,155 @@ TEST_F(InMemoryStorageTest, LookupWithoutColumns) {
   EXPECT_TRUE(values.empty());
 }
 
+TEST_F(InMemoryStorageTest, LoadSortedWritesAllRows) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(3)}), {kColumnID},
+                           {String("old-value")}));
+
+  // Rows are mostly in key order, with one row going before the last one.
+  std::vector<FixedRowStorageIterator::Row> rows;
+  for (int i : {1, 3, 4, 6, 5}) {
+    rows.emplace_back(Key({Int64(i)}),
+                      std::vector<zetasql::Value>{String(absl::StrCat(i))});
+  }
+  FixedRowStorageIterator rows_itr(std::move(rows));
+  ZETASQL_EXPECT_OK(storage_.LoadSorted(t1, kTableId0, {kColumnID}, &rows_itr));
+
+  ZETASQL_EXPECT_OK(
+      storage_.Read(t1, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  std::vector<zetasql::Value> values;
+  while (itr_->Next()) {
+    values.push_back(itr_->ColumnValue(0));
+  }
+  EXPECT_THAT(values, testing::ElementsAre(String("1"), String("3"),
+                                           String("4"), String("5"),
+                                           String("6")));
+
+  // The previous version of an existing row is preserved.
+  ZETASQL_EXPECT_OK(
+      storage_.Lookup(t0, kTableId0, Key({Int64(3)}), {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(String("old-value")));
+}
+
+TEST_F(InMemoryStorageTest, EqualStringsOfAColumnShareStorage) {
+  absl::Time t0 = absl::Now();
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(1)}), {kColumnID},
+                           {String("ACTIVE")}));
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(2)}), {kColumnID},
+                           {String("ACTIVE")}));
+  std::vector<FixedRowStorageIterator::Row> rows;
+  rows.emplace_back(Key({Int64(3)}),
+                    std::vector<zetasql::Value>{String("ACTIVE")});
+  FixedRowStorageIterator rows_itr(std::move(rows));
+  ZETASQL_EXPECT_OK(storage_.LoadSorted(t0, kTableId0, {kColumnID}, &rows_itr));
+
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(
+      storage_.Read(t0, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  while (itr_->Next()) {
+    values.push_back(itr_->ColumnValue(0));
+  }
+  ASSERT_THAT(values, testing::ElementsAre(String("ACTIVE"), String("ACTIVE"),
+                                           String("ACTIVE")));
+  EXPECT_EQ(&values[0].string_value(), &values[1].string_value());
+  EXPECT_EQ(&values[0].string_value(), &values[2].string_value());
+}
+
+TEST_F(InMemoryStorageTest, HighCardinalityStringColumnsAreStoredIntact) {
+  absl::Time t0 = absl::Now();
+  constexpr int kNumRows = 5000;
+  for (int i = 0; i < kNumRows; ++i) {
+    ZETASQL_EXPECT_OK(
+        storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID},
+                       {String(absl::StrCat("value-", i % 2000))}));
+  }
+
+  ZETASQL_EXPECT_OK(
+      storage_.Read(t0, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  int i = 0;
+  for (; itr_->Next(); ++i) {
+    EXPECT_EQ(itr_->ColumnValue(0), String(absl::StrCat("value-", i % 2000)));
+  }
+  EXPECT_EQ(i, kNumRows);
+}
+
+TEST_F(InMemoryStorageTest, ApplyWritesAllRowsOfLargeCommit) {
+  absl::Time t0 = absl::Now();
+
+  // Enough writes to a table that they are applied across several lock
+  // acquisitions, followed by a delete of a range of the written rows.
+  constexpr int kNumRows = 1000;
+  std::vector<StorageWrite> writes;
+  for (int i = 0; i < kNumRows; ++i) {
+    StorageWrite& write = writes.emplace_back();
+    write.timestamp = t0;
+    write.table_id = kTableId0;
+    write.key = Key({Int64(i)});
+    write.column_ids = {kColumnID};
+    write.values = {Int64(i)};
+  }
+  StorageWrite& delete_write = writes.emplace_back();
+  delete_write.kind = StorageWrite::Kind::kDelete;
+  delete_write.timestamp = t0;
+  delete_write.table_id = kTableId0;
+  delete_write.key_range =
+      KeyRange::ClosedOpen(Key({Int64(10)}), Key({Int64(kNumRows)}));
+  ZETASQL_EXPECT_OK(storage_.Apply(absl::MakeSpan(writes)));
+
+  ZETASQL_EXPECT_OK(
+      storage_.Read(t0, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->ColumnValue(0), Int64(i));
+  }
+  EXPECT_FALSE(itr_->Next());
+  ZETASQL_EXPECT_OK(itr_->Status());
+}
+
+TEST_F(InMemoryStorageTest, BatchLookupReturnsRowsInRequestOrder) {
+  absl::Time t0 = absl::Now();
+  for (int i = 0; i < 100; i += 2) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID},
+                             {Int64(i)}));
+  }
+
+  // Keys are unsorted, repeated and partially missing.
+  std::vector<Key> keys = {Key({Int64(40)}), Key({Int64(3)}),
+                           Key({Int64(0)}),  Key({Int64(98)}),
+                           Key({Int64(40)}), Key({Int64(99)})};
+  std::vector<std::optional<std::vector<zetasql::Value>>> rows;
+  ZETASQL_EXPECT_OK(storage_.BatchLookup(t0, kTableId0, keys, {kColumnID}, &rows));
+  ASSERT_EQ(rows.size(), keys.size());
+  EXPECT_THAT(*rows[0], testing::ElementsAre(Int64(40)));
+  EXPECT_FALSE(rows[1].has_value());
+  EXPECT_THAT(*rows[2], testing::ElementsAre(Int64(0)));
+  EXPECT_THAT(*rows[3], testing::ElementsAre(Int64(98)));
+  EXPECT_THAT(*rows[4], testing::ElementsAre(Int64(40)));
+  EXPECT_FALSE(rows[5].has_value());
+
+  // Rows are not visible before they were written.
+  ZETASQL_EXPECT_OK(storage_.BatchLookup(t0 - absl::Seconds(1), kTableId0, keys,
+                                 {kColumnID}, &rows));
+  for (const auto& row : rows) {
+    EXPECT_FALSE(row.has_value());
+  }
+}
+
+TEST_F(InMemoryStorageTest, ExistsAtTimestamp) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  Key key({Int64(1)});
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, key, {kColumnID}, {Int64(1)}));
+  ZETASQL_EXPECT_OK(storage_.Delete(t1, kTableId0, KeyRange::Point(key)));
+
+  EXPECT_FALSE(storage_.Exists(t0 - absl::Seconds(1), kTableId0, key));
+  EXPECT_TRUE(storage_.Exists(t0, kTableId0, key));
+  EXPECT_FALSE(storage_.Exists(t1, kTableId0, key));
+  EXPECT_FALSE(storage_.Exists(t0, kTableId0, Key({Int64(2)})));
+  EXPECT_FALSE(storage_.Exists(t0, kTableId1, key));
+}
+
 TEST_F(InMemoryStorageTest, ReadWithoutColumns) {
   absl::Time write_ts = absl::Now();
   absl::Time lookup_ts = write_ts + absl::Seconds(1);
@@ -534,6 +694,119 @@ TEST_F(InMemoryStorageTest, DeleteUsingPrefixKeyRange) {
   EXPECT_FALSE(itr_->Next());
 }
 
+TEST_F(InMemoryStorageTest, DeleteManyRowsHidesRowsUntilRewritten) {
+  const ColumnID kColumnID1 = "test_column:1";
+  absl::Time write_ts = absl::Now();
+  absl::Time delete_ts = write_ts + absl::Seconds(1);
+  absl::Time rewrite_ts = delete_ts + absl::Seconds(1);
+
+  // The range spans enough rows to be deleted with a single range tombstone.
+  constexpr int kNumRows = 1000;
+  for (int i = 0; i < kNumRows; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(write_ts, kTableId0, Key({Int64(i)}),
+                             {kColumnID, kColumnID1}, {Int64(i), Int64(i)}));
+  }
+  ZETASQL_EXPECT_OK(storage_.Delete(
+      delete_ts, kTableId0,
+      KeyRange::ClosedOpen(Key({Int64(10)}), Key({Int64(kNumRows)}))));
+  // A row written after the delete in the same commit survives it, and a row
+  // written later only has the columns written since.
+  ZETASQL_EXPECT_OK(storage_.Write(delete_ts, kTableId0, Key({Int64(20)}),
+                           {kColumnID}, {Int64(200)}));
+  ZETASQL_EXPECT_OK(storage_.Write(rewrite_ts, kTableId0, Key({Int64(30)}),
+                           {kColumnID}, {Int64(300)}));
+
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(storage_.Lookup(write_ts, kTableId0, Key({Int64(500)}),
+                            {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(500)));
+  EXPECT_THAT(storage_.Lookup(delete_ts, kTableId0, Key({Int64(500)}),
+                              {kColumnID}, &values),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+  ZETASQL_EXPECT_OK(storage_.Lookup(rewrite_ts, kTableId0, Key({Int64(30)}),
+                            {kColumnID, kColumnID1}, &values));
+  ASSERT_EQ(values.size(), 2);
+  EXPECT_EQ(values[0], Int64(300));
+  EXPECT_FALSE(values[1].is_valid());
+
+  ZETASQL_EXPECT_OK(storage_.Read(rewrite_ts, kTableId0, KeyRange::All(),
+                          {kColumnID}, &itr_));
+  std::vector<Key> keys;
+  while (itr_->Next()) {
+    keys.push_back(itr_->Key());
+  }
+  ZETASQL_EXPECT_OK(itr_->Status());
+  EXPECT_EQ(keys.size(), 12);
+  EXPECT_EQ(keys[10], Key({Int64(20)}));
+  EXPECT_EQ(keys[11], Key({Int64(30)}));
+
+  // Garbage collection compacts the deletion into the rows.
+  InMemoryStorage::GarbageCollectionStats stats =
+      storage_.CollectGarbage(rewrite_ts);
+  EXPECT_EQ(stats.rows_removed, kNumRows - 12);
+  ZETASQL_EXPECT_OK(storage_.Lookup(rewrite_ts, kTableId0, Key({Int64(30)}),
+                            {kColumnID, kColumnID1}, &values));
+  ASSERT_EQ(values.size(), 2);
+  EXPECT_EQ(values[0], Int64(300));
+  EXPECT_FALSE(values[1].is_valid());
+  EXPECT_THAT(storage_.Lookup(rewrite_ts, kTableId0, Key({Int64(500)}),
+                              {kColumnID}, &values),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(InMemoryStorageTest, OverlappingRangeDeletionsApplyAtTheirTimestamps) {
+  absl::Time write_ts = absl::Now();
+  absl::Time first_delete_ts = write_ts + absl::Seconds(1);
+  absl::Time second_delete_ts = first_delete_ts + absl::Seconds(1);
+  absl::Time rewrite_ts = second_delete_ts + absl::Seconds(1);
+
+  constexpr int kNumRows = 1000;
+  for (int i = 0; i < kNumRows; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(write_ts, kTableId0, Key({Int64(i)}),
+                             {kColumnID}, {Int64(i)}));
+  }
+  ZETASQL_EXPECT_OK(storage_.Delete(
+      first_delete_ts, kTableId0,
+      KeyRange::ClosedOpen(Key({Int64(100)}), Key({Int64(600)}))));
+  ZETASQL_EXPECT_OK(storage_.Delete(
+      second_delete_ts, kTableId0,
+      KeyRange::ClosedOpen(Key({Int64(400)}), Key({Int64(900)}))));
+  ZETASQL_EXPECT_OK(storage_.Write(rewrite_ts, kTableId0, Key({Int64(500)}),
+                           {kColumnID}, {Int64(5000)}));
+
+  auto count_rows = [&](absl::Time timestamp) {
+    ZETASQL_EXPECT_OK(storage_.Read(timestamp, kTableId0, KeyRange::All(),
+                            {kColumnID}, &itr_));
+    int num_rows = 0;
+    while (itr_->Next()) {
+      ++num_rows;
+    }
+    ZETASQL_EXPECT_OK(itr_->Status());
+    return num_rows;
+  };
+  EXPECT_EQ(count_rows(write_ts), kNumRows);
+  EXPECT_EQ(count_rows(first_delete_ts), kNumRows - 500);
+  EXPECT_EQ(count_rows(second_delete_ts), kNumRows - 800);
+  EXPECT_EQ(count_rows(rewrite_ts), kNumRows - 799);
+
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(storage_.Lookup(first_delete_ts, kTableId0, Key({Int64(700)}),
+                            {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(700)));
+  EXPECT_THAT(storage_.Lookup(second_delete_ts, kTableId0, Key({Int64(700)}),
+                              {kColumnID}, &values),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+  ZETASQL_EXPECT_OK(storage_.Lookup(rewrite_ts, kTableId0, Key({Int64(500)}),
+                            {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(5000)));
+
+  // Garbage collection compacts both deletions into the rows.
+  InMemoryStorage::GarbageCollectionStats stats =
+      storage_.CollectGarbage(rewrite_ts);
+  EXPECT_EQ(stats.rows_removed, 799);
+  EXPECT_EQ(count_rows(rewrite_ts), kNumRows - 799);
+}
+
 TEST_F(InMemoryStorageTest, LookupShouldReturnMostRecentColumnValues) {
   absl::Time write_ts = absl::Now();
   absl::Time delete_ts = write_ts + absl::Seconds(1);
@@ -563,6 +836,95 @@ TEST_F(InMemoryStorageTest, LookupShouldReturnMostRecentColumnValues) {
   EXPECT_EQ(itr_->Key(), Key({Int64(1)}));
 }
 
+TEST_F(InMemoryStorageTest, WriteStoresJsonInParsedForm) {
+  absl::Time write_ts = absl::Now();
+  Key key({Int64(1)});
+  ZETASQL_EXPECT_OK(storage_.Write(
+      write_ts, kTableId0, key, {kColumnID},
+      {zetasql::Value::UnvalidatedJsonString(R"({"a": [1, 2]})")}));
+
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(storage_.Lookup(write_ts, kTableId0, key, {kColumnID}, &values));
+  ASSERT_EQ(values.size(), 1);
+  EXPECT_TRUE(values[0].is_validated_json());
+  EXPECT_EQ(values[0].json_string(), R"({"a":[1,2]})");
+}
+
+TEST_F(InMemoryStorageTest, WriteSharesElementsOfStringArrays) {
+  absl::Time write_ts = absl::Now();
+  Key key1({Int64(1)});
+  Key key2({Int64(2)});
+  ZETASQL_EXPECT_OK(storage_.Write(write_ts, kTableId0, key1, {kColumnID},
+                           {zetasql::values::StringArray({"red", "blue"})}));
+  ZETASQL_EXPECT_OK(storage_.Write(write_ts, kTableId0, key2, {kColumnID},
+                           {zetasql::values::StringArray({"blue"})}));
+
+  std::vector<zetasql::Value> values1;
+  std::vector<zetasql::Value> values2;
+  ZETASQL_EXPECT_OK(
+      storage_.Lookup(write_ts, kTableId0, key1, {kColumnID}, &values1));
+  ZETASQL_EXPECT_OK(
+      storage_.Lookup(write_ts, kTableId0, key2, {kColumnID}, &values2));
+  EXPECT_EQ(values1[0], zetasql::values::StringArray({"red", "blue"}));
+  // Both arrays hold the dictionary's copy of "blue".
+  EXPECT_EQ(values1[0].element(1).string_value().data(),
+            values2[0].element(0).string_value().data());
+}
+
+TEST_F(InMemoryStorageTest, DeleteAddsSingleVersionHoweverManyColumns) {
+  absl::Time write_ts = absl::Now();
+  absl::Time delete_ts = write_ts + absl::Seconds(1);
+  std::vector<ColumnID> column_ids;
+  std::vector<zetasql::Value> values;
+  for (int i = 0; i < 10; ++i) {
+    column_ids.push_back(absl::StrCat("test_column:", i));
+    values.push_back(Int64(i));
+  }
+  Key key({Int64(1)});
+  ZETASQL_EXPECT_OK(storage_.Write(write_ts, kTableId0, key, {column_ids[0]},
+                           {values[0]}));
+  ZETASQL_EXPECT_OK(storage_.Write(write_ts, kTableId1, key, column_ids, values));
+  absl::flat_hash_map<TableID, int64_t> sizes = storage_.TableSizesInBytes();
+
+  ZETASQL_EXPECT_OK(storage_.Delete(delete_ts, kTableId0, KeyRange::Point(key)));
+  ZETASQL_EXPECT_OK(storage_.Delete(delete_ts, kTableId1, KeyRange::Point(key)));
+  absl::flat_hash_map<TableID, int64_t> new_sizes =
+      storage_.TableSizesInBytes();
+  EXPECT_GT(new_sizes[kTableId0], sizes[kTableId0]);
+  EXPECT_EQ(new_sizes[kTableId1] - sizes[kTableId1],
+            new_sizes[kTableId0] - sizes[kTableId0]);
+}
+
+TEST_F(InMemoryStorageTest, DeleteAndWriteAtSameTimestampApplyInOrder) {
+  const ColumnID kColumnID1 = "test_column:1";
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  Key key({Int64(1)});
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, key, {kColumnID, kColumnID1},
+                           {Int64(1), Int64(2)}));
+
+  // A row deleted and written again at the same timestamp only has the
+  // columns written after the delete.
+  ZETASQL_EXPECT_OK(storage_.Delete(t1, kTableId0, KeyRange::Point(key)));
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t1, kTableId0, key, {kColumnID}, {Int64(10)}));
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(storage_.Lookup(t1, kTableId0, key, {kColumnID, kColumnID1},
+                            &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(10), zetasql::Value()));
+  ZETASQL_EXPECT_OK(storage_.Lookup(t0, kTableId0, key, {kColumnID, kColumnID1},
+                            &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(1), Int64(2)));
+
+  // A row written and deleted at the same timestamp is deleted.
+  Key other_key({Int64(2)});
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t1, kTableId0, other_key, {kColumnID}, {Int64(20)}));
+  ZETASQL_EXPECT_OK(storage_.Delete(t1, kTableId0, KeyRange::Point(other_key)));
+  EXPECT_THAT(storage_.Lookup(t1, kTableId0, other_key, {kColumnID}, &values),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+}
+
 TEST_F(InMemoryStorageTest, LookupAtOrAfterDeleteTimestampReturnsInvalidValue) {
   Key key({Int64(1)});
   absl::Time write_ts = absl::Now();
@@ -680,6 +1042,541 @@ TEST_F(InMemoryStorageTest, ReadUsingPrefixKeyRange) {
   EXPECT_FALSE(itr_->Next());
 }
 
+TEST_F(InMemoryStorageTest, ReadManyRowsInterleavedWithWrites) {
+  absl::Time write_ts = absl::Now();
+  absl::Time read_ts = write_ts + absl::Seconds(1);
+  absl::Time later_write_ts = read_ts + absl::Seconds(1);
+
+  constexpr int kNumRows = 1000;
+  for (int i = 0; i < kNumRows; i += 2) {
+    ZETASQL_EXPECT_OK(storage_.Write(write_ts, kTableId0, Key({Int64(i)}),
+                             {kColumnID}, {Int64(i)}));
+  }
+
+  ZETASQL_EXPECT_OK(
+      storage_.Read(read_ts, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  for (int i = 0; i < kNumRows; i += 2) {
+    // Writes performed while iterating must not block the iterator and must
+    // not be visible to it since they happened after the read timestamp.
+    ZETASQL_EXPECT_OK(storage_.Write(later_write_ts, kTableId0, Key({Int64(i + 1)}),
+                             {kColumnID}, {Int64(i + 1)}));
+    ZETASQL_EXPECT_OK(storage_.Write(later_write_ts, kTableId1, Key({Int64(i)}),
+                             {kColumnID}, {Int64(i)}));
+    ZETASQL_EXPECT_OK(storage_.Delete(later_write_ts, kTableId0,
+                              KeyRange::Point(Key({Int64(i)}))));
+
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(i)}));
+    EXPECT_EQ(itr_->ColumnValue(0), Int64(i));
+  }
+  EXPECT_FALSE(itr_->Next());
+  ZETASQL_EXPECT_OK(itr_->Status());
+}
+
+TEST_F(InMemoryStorageTest, ReadRangesWalksAllKeyRangesInOrder) {
+  absl::Time t0 = absl::Now();
+  constexpr int kNumRows = 1000;
+  for (int i = 0; i < kNumRows; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID},
+                             {Int64(i)}));
+  }
+
+  // Points spanning several iterator batches, followed by an empty range, a
+  // range and a point past the end of the table.
+  std::vector<KeyRange> key_ranges;
+  std::vector<int64_t> expected_keys;
+  for (int i = 0; i < 600; i += 3) {
+    key_ranges.push_back(KeyRange::Point(Key({Int64(i)})));
+    expected_keys.push_back(i);
+  }
+  key_ranges.push_back(
+      KeyRange::ClosedOpen(Key({Int64(650)}), Key({Int64(650)})));
+  key_ranges.push_back(
+      KeyRange::ClosedOpen(Key({Int64(700)}), Key({Int64(800)})));
+  for (int i = 700; i < 800; ++i) {
+    expected_keys.push_back(i);
+  }
+  key_ranges.push_back(KeyRange::Point(Key({Int64(kNumRows + 1)})));
+
+  ZETASQL_EXPECT_OK(storage_.ReadRanges(t0, kTableId0, key_ranges, {kColumnID},
+                                &itr_));
+  for (int64_t key : expected_keys) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(key)}));
+    EXPECT_EQ(itr_->ColumnValue(0), Int64(key));
+  }
+  EXPECT_FALSE(itr_->Next());
+  ZETASQL_EXPECT_OK(itr_->Status());
+}
+
+TEST_F(InMemoryStorageTest, ReadFirstRowsReturnsFirstLiveRowsOfRanges) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  constexpr int kNumRows = 1000;
+  for (int i = 0; i < kNumRows; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID},
+                             {Int64(i)}));
+  }
+  ZETASQL_EXPECT_OK(
+      storage_.Delete(t1, kTableId0, KeyRange::Point(Key({Int64(102)}))));
+
+  std::vector<KeyRange> key_ranges = {
+      KeyRange::ClosedOpen(Key({Int64(100)}), Key({Int64(110)})),
+      KeyRange::ClosedOpen(Key({Int64(500)}), Key({Int64(kNumRows)}))};
+  std::vector<int64_t> expected_keys;
+  for (int i = 100; i < 110; ++i) {
+    if (i != 102) {
+      expected_keys.push_back(i);
+    }
+  }
+  for (int i = 500; i < 506; ++i) {
+    expected_keys.push_back(i);
+  }
+
+  ZETASQL_EXPECT_OK(storage_.ReadFirstRows(t1, kTableId0, key_ranges, {kColumnID},
+                                   /*limit=*/15, &itr_));
+  for (int64_t key : expected_keys) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(key)}));
+    EXPECT_EQ(itr_->ColumnValue(0), Int64(key));
+  }
+  EXPECT_FALSE(itr_->Next());
+  ZETASQL_EXPECT_OK(itr_->Status());
+
+  // A limit of one row reads the first row of the ranges.
+  ZETASQL_EXPECT_OK(storage_.ReadFirstRows(t1, kTableId0, key_ranges, {kColumnID},
+                                   /*limit=*/1, &itr_));
+  ASSERT_TRUE(itr_->Next());
+  EXPECT_EQ(itr_->Key(), Key({Int64(100)}));
+  EXPECT_FALSE(itr_->Next());
+}
+
+TEST_F(InMemoryStorageTest, ReadSampleReturnsBernoulliSampleInKeyOrder) {
+  absl::Time t0 = absl::Now();
+  constexpr int kNumRows = 1000;
+  for (int i = 0; i < kNumRows; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID},
+                             {Int64(i)}));
+  }
+
+  RowSample sample;
+  sample.method = RowSample::Method::kBernoulli;
+  sample.fraction = 1;
+  ZETASQL_EXPECT_OK(storage_.ReadSample(
+      t0, kTableId0,
+      {KeyRange::ClosedOpen(Key({Int64(100)}), Key({Int64(300)}))},
+      {kColumnID}, sample, &itr_));
+  for (int i = 100; i < 300; ++i) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(i)}));
+    EXPECT_EQ(itr_->ColumnValue(0), Int64(i));
+  }
+  EXPECT_FALSE(itr_->Next());
+
+  sample.fraction = 0;
+  ZETASQL_EXPECT_OK(storage_.ReadSample(t0, kTableId0, {KeyRange::All()},
+                                {kColumnID}, sample, &itr_));
+  EXPECT_FALSE(itr_->Next());
+  ZETASQL_EXPECT_OK(itr_->Status());
+}
+
+TEST_F(InMemoryStorageTest, ReadSampleReturnsReservoirSampleInKeyOrder) {
+  absl::Time t0 = absl::Now();
+  constexpr int kNumRows = 1000;
+  for (int i = 0; i < kNumRows; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID},
+                             {Int64(i)}));
+  }
+  ZETASQL_EXPECT_OK(
+      storage_.Delete(t0 + absl::Seconds(1), kTableId0, KeyRange::All()));
+
+  // The sample spans several iterator batches and only sees rows which exist
+  // at the read timestamp.
+  RowSample sample;
+  sample.method = RowSample::Method::kReservoir;
+  sample.num_rows = 100;
+  ZETASQL_EXPECT_OK(storage_.ReadSample(t0, kTableId0, {KeyRange::All()},
+                                {kColumnID}, sample, &itr_));
+  std::vector<Key> keys;
+  while (itr_->Next()) {
+    EXPECT_EQ(itr_->Key(), Key({itr_->ColumnValue(0)}));
+    keys.push_back(itr_->Key());
+  }
+  ZETASQL_EXPECT_OK(itr_->Status());
+  EXPECT_EQ(keys.size(), 100);
+  EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+  EXPECT_TRUE(std::adjacent_find(keys.begin(), keys.end()) == keys.end());
+
+  ZETASQL_EXPECT_OK(storage_.ReadSample(t0 + absl::Seconds(1), kTableId0,
+                                {KeyRange::All()}, {kColumnID}, sample,
+                                &itr_));
+  EXPECT_FALSE(itr_->Next());
+  ZETASQL_EXPECT_OK(itr_->Status());
+}
+
+TEST_F(InMemoryStorageTest, ConcurrentAccessToDifferentTables) {
+  absl::Time t0 = absl::Now();
+  constexpr int kNumRows = 500;
+  for (int i = 0; i < kNumRows; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID},
+                             {Int64(i)}));
+  }
+
+  // Writes to one table proceed while another table is being scanned.
+  std::thread writer([&] {
+    for (int i = 0; i < kNumRows; ++i) {
+      ZETASQL_EXPECT_OK(storage_.Write(t0 + absl::Seconds(1), kTableId1,
+                               Key({Int64(i)}), {kColumnID}, {Int64(i)}));
+    }
+  });
+  std::thread reader([&] {
+    std::unique_ptr<StorageIterator> itr;
+    ZETASQL_EXPECT_OK(
+        storage_.Read(t0, kTableId0, KeyRange::All(), {kColumnID}, &itr));
+    int count = 0;
+    while (itr->Next()) {
+      EXPECT_EQ(itr->ColumnValue(0), Int64(count));
+      ++count;
+    }
+    EXPECT_EQ(count, kNumRows);
+  });
+  writer.join();
+  reader.join();
+
+  std::vector<zetasql::Value> values;
+  for (int i = 0; i < kNumRows; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Lookup(t0 + absl::Seconds(1), kTableId1,
+                              Key({Int64(i)}), {kColumnID}, &values));
+    EXPECT_THAT(values, testing::ElementsAre(Int64(i)));
+  }
+}
+
+TEST_F(InMemoryStorageTest, CollectGarbageKeepsLatestVisibleVersion) {
+  absl::Time t0 = absl::Now();
+  Key key({Int64(1)});
+
+  for (int i = 0; i < 5; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0 + absl::Seconds(i), kTableId0, key,
+                             {kColumnID}, {Int64(i)}));
+  }
+
+  // Versions at t0 + 0s and t0 + 1s are superseded by the version at t0 + 2s.
+  InMemoryStorage::GarbageCollectionStats stats =
+      storage_.CollectGarbage(t0 + absl::Seconds(2));
+  EXPECT_EQ(stats.versions_removed, 2);
+  EXPECT_EQ(stats.rows_removed, 0);
+  EXPECT_GT(stats.bytes_reclaimed, 0);
+
+  std::vector<zetasql::Value> values;
+  for (int i = 2; i < 5; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Lookup(t0 + absl::Seconds(i), kTableId0, key,
+                              {kColumnID}, &values));
+    EXPECT_THAT(values, testing::ElementsAre(Int64(i)));
+  }
+}
+
+TEST_F(InMemoryStorageTest, WritesDropVersionsPastTheirRetention) {
+  storage_.set_write_retention(absl::Seconds(10));
+  absl::Time t0 = absl::Now();
+  Key key({Int64(1)});
+
+  for (int i = 0; i < 5; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0 + absl::Seconds(i), kTableId0, key,
+                             {kColumnID}, {Int64(i)}));
+  }
+  // An active read keeps the versions it can observe.
+  ZETASQL_EXPECT_OK(storage_.Read(t0 + absl::Seconds(3), kTableId0, KeyRange::All(),
+                          {kColumnID}, &itr_));
+  ZETASQL_EXPECT_OK(storage_.Write(t0 + absl::Seconds(20), kTableId0, key,
+                           {kColumnID}, {Int64(20)}));
+  ASSERT_TRUE(itr_->Next());
+  EXPECT_EQ(itr_->ColumnValue(0), Int64(3));
+  itr_.reset();
+
+  // Of the versions up to the retention bound t0 + 10s of the write at
+  // t0 + 20s, only the latest one is observable, so the write drops the
+  // others.
+  ZETASQL_EXPECT_OK(storage_.Write(t0 + absl::Seconds(20), kTableId0, key,
+                           {kColumnID}, {Int64(21)}));
+  EXPECT_EQ(storage_.CollectGarbage(t0 + absl::Seconds(10)).versions_removed,
+            0);
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(storage_.Lookup(t0 + absl::Seconds(10), kTableId0, key,
+                            {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(4)));
+  ZETASQL_EXPECT_OK(storage_.Lookup(t0 + absl::Seconds(20), kTableId0, key,
+                            {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(21)));
+}
+
+TEST_F(InMemoryStorageTest, CollectGarbageRemovesDeletedRows) {
+  absl::Time t0 = absl::Now();
+  absl::Time delete_ts = t0 + absl::Seconds(1);
+  absl::Time gc_ts = t0 + absl::Seconds(2);
+
+  for (int i = 0; i < 5; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID},
+                             {Int64(i)}));
+  }
+  ZETASQL_EXPECT_OK(storage_.Delete(delete_ts, kTableId0,
+                            KeyRange::ClosedOpen(Key({Int64(1)}),
+                                                 Key({Int64(4)}))));
+  // A row deleted before but re-inserted after the gc timestamp is kept.
+  ZETASQL_EXPECT_OK(storage_.Write(gc_ts + absl::Seconds(1), kTableId0,
+                           Key({Int64(2)}), {kColumnID}, {Int64(20)}));
+
+  InMemoryStorage::GarbageCollectionStats stats = storage_.CollectGarbage(gc_ts);
+  EXPECT_EQ(stats.rows_removed, 2);
+
+  ZETASQL_EXPECT_OK(storage_.Read(gc_ts + absl::Seconds(1), kTableId0,
+                          KeyRange::All(), {kColumnID}, &itr_));
+  std::vector<Key> keys;
+  while (itr_->Next()) {
+    keys.push_back(itr_->Key());
+  }
+  ZETASQL_EXPECT_OK(itr_->Status());
+  EXPECT_THAT(keys, testing::ElementsAre(Key({Int64(0)}), Key({Int64(2)}),
+                                         Key({Int64(4)})));
+}
+
+TEST_F(InMemoryStorageTest, CollectGarbageRemovesRowsOfAppendedTable) {
+  absl::Time t0 = absl::Now();
+  absl::Time delete_ts = t0 + absl::Seconds(1);
+  absl::Time gc_ts = t0 + absl::Seconds(2);
+
+  // Rows are appended in ascending timestamp key order, spanning several
+  // garbage collection batches, and every other row is deleted.
+  constexpr int kNumRows = 5000;
+  for (int i = 0; i < kNumRows; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0,
+                             Key({Timestamp(t0 + absl::Seconds(i))}),
+                             {kColumnID}, {Int64(i)}));
+  }
+  for (int i = 0; i < kNumRows; i += 2) {
+    Key key({Timestamp(t0 + absl::Seconds(i))});
+    ZETASQL_EXPECT_OK(storage_.Delete(delete_ts, kTableId0, KeyRange::Point(key)));
+  }
+
+  InMemoryStorage::GarbageCollectionStats stats = storage_.CollectGarbage(gc_ts);
+  EXPECT_EQ(stats.rows_removed, kNumRows / 2);
+
+  ZETASQL_EXPECT_OK(
+      storage_.Read(gc_ts, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  for (int i = 1; i < kNumRows; i += 2) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->ColumnValue(0), Int64(i));
+  }
+  EXPECT_FALSE(itr_->Next());
+  ZETASQL_EXPECT_OK(itr_->Status());
+}
+
+TEST_F(InMemoryStorageTest, CollectGarbageIsBoundedByActiveReads) {
+  absl::Time t0 = absl::Now();
+  Key key({Int64(1)});
+
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, key, {kColumnID}, {Int64(0)}));
+  ZETASQL_EXPECT_OK(storage_.Write(t0 + absl::Seconds(1), kTableId0, key,
+                           {kColumnID}, {Int64(1)}));
+
+  ZETASQL_EXPECT_OK(
+      storage_.Read(t0, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  EXPECT_EQ(storage_.CollectGarbage(t0 + absl::Seconds(1)).versions_removed, 0);
+  ASSERT_TRUE(itr_->Next());
+  EXPECT_EQ(itr_->ColumnValue(0), Int64(0));
+
+  itr_.reset();
+  EXPECT_EQ(storage_.CollectGarbage(t0 + absl::Seconds(1)).versions_removed, 1);
+}
+
+TEST_F(InMemoryStorageTest, TableSizesInBytesTrackWritesAndGarbageCollection) {
+  absl::Time t0 = absl::Now();
+  EXPECT_TRUE(storage_.TableSizesInBytes().empty());
+
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(1)}), {kColumnID},
+                           {String("value-1")}));
+  int64_t one_version = storage_.TableSizesInBytes().at(kTableId0);
+  EXPECT_GT(one_version, Key({Int64(1)}).LogicalSizeInBytes());
+
+  // Superseded versions count until they are garbage collected.
+  ZETASQL_EXPECT_OK(storage_.Write(t0 + absl::Seconds(1), kTableId0, Key({Int64(1)}),
+                           {kColumnID}, {String("value-2")}));
+  int64_t two_versions = storage_.TableSizesInBytes().at(kTableId0);
+  EXPECT_GT(two_versions, one_version);
+
+  InMemoryStorage::GarbageCollectionStats stats =
+      storage_.CollectGarbage(t0 + absl::Seconds(1));
+  EXPECT_EQ(storage_.TableSizesInBytes().at(kTableId0),
+            two_versions - stats.bytes_reclaimed);
+
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId1, Key({Int64(10)}), {kColumnID},
+                           {String("value-10")}));
+  EXPECT_EQ(storage_.TableSizesInBytes().size(), 2);
+}
+
+TEST_F(InMemoryStorageTest, CloneIsIsolatedFromOriginal) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  Key key1({Int64(1)});
+  Key key2({Int64(2)});
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t0, kTableId0, key1, {kColumnID}, {Int64(1)}));
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t0, kTableId1, key1, {kColumnID}, {Int64(1)}));
+
+  std::unique_ptr<InMemoryStorage> clone = storage_.Clone();
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(clone->Lookup(t0, kTableId0, key1, {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(1)));
+
+  // Writes to either side are not visible to the other.
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t1, kTableId0, key1, {kColumnID}, {Int64(10)}));
+  ZETASQL_EXPECT_OK(clone->Write(t1, kTableId0, key2, {kColumnID}, {Int64(2)}));
+  ZETASQL_EXPECT_OK(clone->Delete(t1, kTableId1, KeyRange::Point(key1)));
+  ZETASQL_EXPECT_OK(clone->Lookup(t1, kTableId0, key1, {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(1)));
+  EXPECT_THAT(storage_.Lookup(t1, kTableId0, key2, {kColumnID}, &values),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+  ZETASQL_EXPECT_OK(storage_.Lookup(t1, kTableId1, key1, {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(1)));
+  EXPECT_THAT(clone->Lookup(t1, kTableId1, key1, {kColumnID}, &values),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+
+  // Garbage collection leaves the tables still shared with the clone alone.
+  clone.reset();
+  std::unique_ptr<InMemoryStorage> other_clone = storage_.Clone();
+  EXPECT_EQ(storage_.CollectGarbage(t1).versions_removed, 0);
+  ZETASQL_EXPECT_OK(
+      other_clone->Lookup(t0, kTableId0, key1, {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(1)));
+}
+
+TEST_F(InMemoryStorageTest, DiscardVersionsAfterRestoresEarlierState) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  Key key1({Int64(1)});
+  Key key2({Int64(2)});
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t0, kTableId0, key1, {kColumnID}, {Int64(1)}));
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t0, kTableId1, key1, {kColumnID}, {Int64(1)}));
+  std::unique_ptr<InMemoryStorage> clone = storage_.Clone();
+
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t1, kTableId0, key1, {kColumnID}, {Int64(10)}));
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t1, kTableId0, key2, {kColumnID}, {Int64(2)}));
+  ZETASQL_EXPECT_OK(storage_.Delete(t1, kTableId1, KeyRange::Point(key1)));
+  ZETASQL_EXPECT_OK(
+      clone->Write(t1, kTableId1, key2, {kColumnID}, {Int64(2)}));
+
+  storage_.DiscardVersionsAfter(t0);
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(storage_.Lookup(t1, kTableId0, key1, {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(1)));
+  EXPECT_THAT(storage_.Lookup(t1, kTableId0, key2, {kColumnID}, &values),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+  ZETASQL_EXPECT_OK(storage_.Lookup(t1, kTableId1, key1, {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(1)));
+
+  // The clone keeps its own later writes.
+  ZETASQL_EXPECT_OK(clone->Lookup(t1, kTableId1, key2, {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(2)));
+
+  // Versions can be written again after the reset timestamp.
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t1, kTableId0, key2, {kColumnID}, {Int64(20)}));
+  ZETASQL_EXPECT_OK(storage_.Lookup(t1, kTableId0, key2, {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(20)));
+}
+
+TEST_F(InMemoryStorageTest, CompressedVersionsRemainReadable) {
+  absl::Time t0 = absl::Now();
+  Key key({Int64(1)});
+  for (int i = 0; i < 5; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0 + absl::Seconds(i), kTableId0, key,
+                             {kColumnID}, {String(absl::StrCat("value-", i))}));
+  }
+
+  InMemoryStorage::CompressionStats stats =
+      storage_.CompressVersions(t0 + absl::Seconds(10));
+  EXPECT_EQ(stats.versions_compressed, 4);
+  EXPECT_EQ(stats.rows_compressed, 1);
+
+  // Compressing again finds nothing more to move.
+  EXPECT_EQ(storage_.CompressVersions(t0 + absl::Seconds(10))
+                .versions_compressed,
+            0);
+
+  std::vector<zetasql::Value> values;
+  for (int i = 0; i < 5; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Lookup(t0 + absl::Seconds(i), kTableId0, key,
+                              {kColumnID}, &values));
+    EXPECT_THAT(values,
+                testing::ElementsAre(String(absl::StrCat("value-", i))));
+  }
+  EXPECT_THAT(storage_.Lookup(t0 - absl::Seconds(1), kTableId0, key,
+                              {kColumnID}, &values),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+
+  ZETASQL_EXPECT_OK(storage_.Read(t0 + absl::Seconds(2), kTableId0, kKeyRange0To5,
+                          {kColumnID}, &itr_));
+  EXPECT_TRUE(itr_->Next());
+  EXPECT_EQ(itr_->ColumnValue(0), String("value-2"));
+  EXPECT_FALSE(itr_->Next());
+}
+
+TEST_F(InMemoryStorageTest, CollectGarbageAfterCompressVersions) {
+  absl::Time t0 = absl::Now();
+  Key key({Int64(1)});
+  for (int i = 0; i < 4; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0 + absl::Seconds(i), kTableId0, key,
+                             {kColumnID}, {Int64(i)}));
+  }
+  EXPECT_EQ(storage_.CompressVersions(t0 + absl::Seconds(10))
+                .versions_compressed,
+            3);
+
+  // Versions before t0 + 2s are superseded and collected, the rest stay
+  // readable.
+  EXPECT_EQ(storage_.CollectGarbage(t0 + absl::Seconds(2)).versions_removed,
+            2);
+  std::vector<zetasql::Value> values;
+  for (int i = 2; i < 4; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Lookup(t0 + absl::Seconds(i), kTableId0, key,
+                              {kColumnID}, &values));
+    EXPECT_THAT(values, testing::ElementsAre(Int64(i)));
+  }
+
+  // Deleting the row lets garbage collection remove it along with its
+  // compressed versions.
+  ZETASQL_EXPECT_OK(storage_.Delete(t0 + absl::Seconds(4), kTableId0,
+                            KeyRange::Point(key)));
+  EXPECT_EQ(storage_.CollectGarbage(t0 + absl::Seconds(5)).rows_removed, 1);
+  EXPECT_THAT(storage_.Lookup(t0 + absl::Seconds(3), kTableId0, key,
+                              {kColumnID}, &values),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(InMemoryStorageTest, DiscardVersionsAfterCompressVersions) {
+  absl::Time t0 = absl::Now();
+  Key key({Int64(1)});
+  for (int i = 0; i < 4; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0 + absl::Seconds(i), kTableId0, key,
+                             {kColumnID}, {Int64(i)}));
+  }
+  storage_.CompressVersions(t0 + absl::Seconds(10));
+
+  storage_.DiscardVersionsAfter(t0 + absl::Seconds(1));
+  std::vector<zetasql::Value> values;
+  ZETASQL_EXPECT_OK(storage_.Lookup(t0 + absl::Seconds(3), kTableId0, key,
+                            {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(1)));
+  ZETASQL_EXPECT_OK(
+      storage_.Lookup(t0, kTableId0, key, {kColumnID}, &values));
+  EXPECT_THAT(values, testing::ElementsAre(Int64(0)));
+}
+
 TEST_F(InMemoryStorageTest,
        ReadUsingInvalidKeyRangeEndpointsReturnsInternalError) {
   absl::Time t0 = absl::Now();
@@ -0,0 +1,160 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/storage/row_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/random/distributions.h"
+#include "absl/status/status.h"
+#include "backend/datamodel/key.h"
+#include "backend/storage/in_memory_iterator.h"
+#include "backend/storage/iterator.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+RowSampler::RowSampler(const RowSample& sample) : sample_(sample) {
+  if (sample_.method == RowSample::Method::kBernoulli) {
+    skip_ = Gap(sample_.fraction);
+  } else if (sample_.num_rows <= 0) {
+    skip_ = std::numeric_limits<int64_t>::max();
+  }
+}
+
+int64_t RowSampler::Gap(double probability) {
+  if (probability >= 1) {
+    return 0;
+  }
+  if (probability <= 0) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  // The number of failures before the first success of Bernoulli trials is
+  // geometrically distributed.
+  const double u = absl::Uniform(absl::IntervalOpenClosed, bitgen_, 0.0, 1.0);
+  const double gap = std::floor(std::log(u) / std::log1p(-probability));
+  if (gap >= static_cast<double>(std::numeric_limits<int64_t>::max())) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return static_cast<int64_t>(gap);
+}
+
+int64_t RowSampler::Next() {
+  if (skip_ > 0) {
+    --skip_;
+    return kSkip;
+  }
+  if (sample_.method == RowSample::Method::kBernoulli) {
+    skip_ = Gap(sample_.fraction);
+    return size_++;
+  }
+
+  // Algorithm L: the first num_rows rows fill the reservoir, and each later
+  // sampled row replaces a uniformly chosen one of them.
+  const double num_rows = static_cast<double>(sample_.num_rows);
+  int64_t position;
+  if (size_ < sample_.num_rows) {
+    position = size_++;
+    if (size_ < sample_.num_rows) {
+      return position;
+    }
+  } else {
+    position = absl::Uniform<int64_t>(bitgen_, 0, sample_.num_rows);
+  }
+  weight_ *= std::exp(
+      std::log(absl::Uniform(absl::IntervalOpenClosed, bitgen_, 0.0, 1.0)) /
+      num_rows);
+  skip_ = Gap(weight_);
+  return position;
+}
+
+SampledStorageIterator::SampledStorageIterator(
+    std::vector<std::unique_ptr<StorageIterator>> inputs,
+    const RowSample& sample)
+    : inputs_(std::move(inputs)), sampler_(sample) {}
+
+int SampledStorageIterator::NumColumns() const {
+  return inputs_.empty() ? 0 : inputs_.front()->NumColumns();
+}
+
+bool SampledStorageIterator::NextInputRow() {
+  while (input_ < inputs_.size()) {
+    if (inputs_[input_]->Next()) {
+      return true;
+    }
+    status_ = inputs_[input_]->Status();
+    if (!status_.ok()) {
+      return false;
+    }
+    ++input_;
+  }
+  return false;
+}
+
+bool SampledStorageIterator::Next() {
+  if (sampler_.sample().method == RowSample::Method::kReservoir) {
+    if (reservoir_ == nullptr) {
+      ReadReservoir();
+    }
+    return status_.ok() && reservoir_->Next();
+  }
+  while (NextInputRow()) {
+    if (sampler_.Next() != RowSampler::kSkip) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SampledStorageIterator::ReadReservoir() {
+  std::vector<FixedRowStorageIterator::Row> rows;
+  while (NextInputRow()) {
+    const int64_t position = sampler_.Next();
+    if (position == RowSampler::kSkip) {
+      continue;
+    }
+    StorageIterator* input = inputs_[input_].get();
+    FixedRowStorageIterator::Row row;
+    row.first = input->Key();
+    row.second.reserve(input->NumColumns());
+    for (int i = 0; i < input->NumColumns(); ++i) {
+      row.second.push_back(input->ColumnValue(i));
+    }
+    if (position == rows.size()) {
+      rows.push_back(std::move(row));
+    } else {
+      rows[position] = std::move(row);
+    }
+  }
+  std::sort(rows.begin(), rows.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  reservoir_ = std::make_unique<FixedRowStorageIterator>(std::move(rows));
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,145 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_ROW_SAMPLER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_ROW_SAMPLER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/random/random.h"
+#include "backend/datamodel/key.h"
+#include "backend/storage/iterator.h"
+#include "absl/status/status.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// A random sample of the rows of a read, e.g. of a table scanned with a
+// TABLESAMPLE clause.
+struct RowSample {
+  enum class Method {
+    // Returns each row with probability `fraction`.
+    kBernoulli,
+    // Returns `num_rows` rows chosen uniformly at random, or all rows if
+    // there are fewer.
+    kReservoir,
+  };
+
+  Method method = Method::kBernoulli;
+  double fraction = 1;
+  int64_t num_rows = 0;
+};
+
+// RowSampler decides which of the rows of a read belong to a RowSample,
+// without looking at the rows. Memory and time are proportional to the number
+// of sampled rows rather than to the number of rows read: the number of rows
+// skipped before the next sampled row is drawn from its distribution (as in
+// Algorithm L for reservoir samples), so that skipped rows need not be
+// materialized by the reader.
+//
+// Usage:
+//   RowSampler sampler(sample);
+//   std::vector<Row> rows;
+//   for (each row of the read, in order) {
+//     int64_t position = sampler.Next();
+//     if (position == RowSampler::kSkip) continue;
+//     if (position == rows.size()) rows.push_back(row);
+//     else rows[position] = row;
+//   }
+//
+// A Bernoulli sample keeps the order of the rows read, a reservoir sample does
+// not.
+class RowSampler {
+ public:
+  // Returned by Next for rows which are not part of the sample.
+  static constexpr int64_t kSkip = -1;
+
+  explicit RowSampler(const RowSample& sample);
+
+  const RowSample& sample() const { return sample_; }
+
+  // Decides whether the next row read is part of the sample. Returns kSkip if
+  // it is not. Otherwise, returns the position of the row in the sample, which
+  // is either the number of rows sampled so far, if the row is added to the
+  // sample, or the position of a sampled row which it replaces.
+  int64_t Next();
+
+ private:
+  // Returns the number of rows to skip before the next row which is sampled
+  // with probability `probability`.
+  int64_t Gap(double probability);
+
+  const RowSample sample_;
+  absl::BitGen bitgen_;
+
+  // Number of rows left to skip before the next sampled row.
+  int64_t skip_ = 0;
+
+  // Number of rows in the sample.
+  int64_t size_ = 0;
+
+  // For reservoir samples, the largest of the random weights of the sampled
+  // rows, tracked as in Algorithm L.
+  double weight_ = 1;
+};
+
+// A StorageIterator returning the rows of the given iterators, in order, which
+// belong to `sample`. Used by readers which cannot skip rows without producing
+// them. Rows of a reservoir sample are buffered once the first row is
+// requested, and returned in key order.
+class SampledStorageIterator : public StorageIterator {
+ public:
+  SampledStorageIterator(std::vector<std::unique_ptr<StorageIterator>> inputs,
+                         const RowSample& sample);
+
+  bool Next() override;
+  absl::Status Status() const override { return status_; }
+  const class Key& Key() const override { return current()->Key(); }
+  int NumColumns() const override;
+  const zetasql::Value& ColumnValue(int i) const override {
+    return current()->ColumnValue(i);
+  }
+
+ private:
+  // Advances to the next row of the inputs. Returns false once all inputs are
+  // exhausted or have failed.
+  bool NextInputRow();
+
+  // Reads all rows of the inputs into reservoir_.
+  void ReadReservoir();
+
+  StorageIterator* current() const {
+    return reservoir_ != nullptr ? reservoir_.get() : inputs_[input_].get();
+  }
+
+  std::vector<std::unique_ptr<StorageIterator>> inputs_;
+  int input_ = 0;
+  RowSampler sampler_;
+  std::unique_ptr<StorageIterator> reservoir_;
+  absl::Status status_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_ROW_SAMPLER_H_
@@ -0,0 +1,164 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/row_sampler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "zetasql/public/value.h"
+#include "backend/datamodel/key.h"
+#include "backend/storage/in_memory_iterator.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+
+RowSample Bernoulli(double fraction) {
+  RowSample sample;
+  sample.method = RowSample::Method::kBernoulli;
+  sample.fraction = fraction;
+  return sample;
+}
+
+RowSample Reservoir(int64_t num_rows) {
+  RowSample sample;
+  sample.method = RowSample::Method::kReservoir;
+  sample.num_rows = num_rows;
+  return sample;
+}
+
+// Returns the indexes of `num_rows` rows which belong to the sample.
+std::vector<int64_t> Sample(const RowSample& sample, int64_t num_rows) {
+  RowSampler sampler(sample);
+  std::vector<int64_t> rows;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    const int64_t position = sampler.Next();
+    if (position == RowSampler::kSkip) {
+      continue;
+    }
+    EXPECT_LE(position, rows.size());
+    if (position == rows.size()) {
+      rows.push_back(i);
+    } else {
+      rows[position] = i;
+    }
+  }
+  return rows;
+}
+
+std::unique_ptr<StorageIterator> MakeIterator(int64_t begin, int64_t end) {
+  std::vector<FixedRowStorageIterator::Row> rows;
+  for (int64_t i = begin; i < end; ++i) {
+    rows.push_back({Key({Int64(i)}), {Int64(i)}});
+  }
+  return std::make_unique<FixedRowStorageIterator>(std::move(rows));
+}
+
+TEST(RowSamplerTest, BernoulliSampleOfNoRows) {
+  EXPECT_TRUE(Sample(Bernoulli(0), 1000).empty());
+}
+
+TEST(RowSamplerTest, BernoulliSampleOfAllRows) {
+  std::vector<int64_t> rows = Sample(Bernoulli(1), 1000);
+  ASSERT_EQ(rows.size(), 1000);
+  for (int64_t i = 0; i < rows.size(); ++i) {
+    EXPECT_EQ(rows[i], i);
+  }
+}
+
+TEST(RowSamplerTest, BernoulliSampleKeepsFractionOfRowsInOrder) {
+  constexpr int64_t kNumRows = 100000;
+  std::vector<int64_t> rows = Sample(Bernoulli(0.1), kNumRows);
+
+  // The number of sampled rows has a standard deviation of about 95, these
+  // bounds are over ten standard deviations wide.
+  EXPECT_GT(rows.size(), 9000);
+  EXPECT_LT(rows.size(), 11000);
+  EXPECT_TRUE(std::is_sorted(rows.begin(), rows.end()));
+}
+
+TEST(RowSamplerTest, ReservoirSampleOfFewerRowsKeepsAllRows) {
+  EXPECT_THAT(Sample(Reservoir(10), 5), testing::ElementsAre(0, 1, 2, 3, 4));
+}
+
+TEST(RowSamplerTest, ReservoirSampleHasRequestedNumberOfDistinctRows) {
+  constexpr int64_t kNumRows = 100000;
+  std::vector<int64_t> rows = Sample(Reservoir(100), kNumRows);
+  ASSERT_EQ(rows.size(), 100);
+  std::set<int64_t> distinct(rows.begin(), rows.end());
+  EXPECT_EQ(distinct.size(), 100);
+  EXPECT_GE(*distinct.begin(), 0);
+  EXPECT_LT(*distinct.rbegin(), kNumRows);
+
+  // Rows past the first hundred must be chosen as well.
+  EXPECT_GE(*distinct.rbegin(), 100);
+}
+
+TEST(RowSamplerTest, ReservoirSampleOfZeroRows) {
+  EXPECT_TRUE(Sample(Reservoir(0), 1000).empty());
+}
+
+TEST(SampledStorageIteratorTest, BernoulliSampleWalksAllInputs) {
+  std::vector<std::unique_ptr<StorageIterator>> inputs;
+  inputs.push_back(MakeIterator(0, 10));
+  inputs.push_back(MakeIterator(10, 10));
+  inputs.push_back(MakeIterator(20, 25));
+  SampledStorageIterator itr(std::move(inputs), Bernoulli(1));
+
+  std::vector<int64_t> keys;
+  while (itr.Next()) {
+    ASSERT_EQ(itr.NumColumns(), 1);
+    EXPECT_EQ(itr.Key(), Key({itr.ColumnValue(0)}));
+    keys.push_back(itr.ColumnValue(0).int64_value());
+  }
+  ZETASQL_EXPECT_OK(itr.Status());
+  EXPECT_EQ(keys.size(), 15);
+  EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+}
+
+TEST(SampledStorageIteratorTest, ReservoirSampleIsReturnedInKeyOrder) {
+  std::vector<std::unique_ptr<StorageIterator>> inputs;
+  inputs.push_back(MakeIterator(0, 500));
+  inputs.push_back(MakeIterator(500, 1000));
+  SampledStorageIterator itr(std::move(inputs), Reservoir(20));
+
+  std::vector<int64_t> keys;
+  while (itr.Next()) {
+    EXPECT_EQ(itr.Key(), Key({itr.ColumnValue(0)}));
+    keys.push_back(itr.ColumnValue(0).int64_value());
+  }
+  ZETASQL_EXPECT_OK(itr.Status());
+  EXPECT_EQ(keys.size(), 20);
+  EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,169 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/storage.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "backend/datamodel/key.h"
+#include "backend/storage/in_memory_iterator.h"
+#include "backend/storage/iterator.h"
+#include "backend/storage/row_sampler.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// A StorageIterator over the rows of a run of StorageWrites.
+class StorageWriteIterator : public StorageIterator {
+ public:
+  explicit StorageWriteIterator(absl::Span<const StorageWrite> writes)
+      : writes_(writes) {}
+
+  bool Next() override {
+    return ++pos_ < static_cast<int64_t>(writes_.size());
+  }
+  absl::Status Status() const override { return absl::OkStatus(); }
+  const class Key& Key() const override { return writes_[pos_].key; }
+  int NumColumns() const override { return writes_[pos_].values.size(); }
+  const zetasql::Value& ColumnValue(int i) const override {
+    return writes_[pos_].values[i];
+  }
+
+ private:
+  absl::Span<const StorageWrite> writes_;
+  int64_t pos_ = -1;
+};
+
+// A StorageIterator which yields the rows of a sequence of iterators in turn.
+class ChainedStorageIterator : public StorageIterator {
+ public:
+  explicit ChainedStorageIterator(
+      std::vector<std::unique_ptr<StorageIterator>> iterators)
+      : iterators_(std::move(iterators)) {}
+
+  bool Next() override {
+    for (; pos_ < iterators_.size(); ++pos_) {
+      if (iterators_[pos_]->Next()) {
+        return true;
+      }
+      status_ = iterators_[pos_]->Status();
+      if (!status_.ok()) {
+        return false;
+      }
+    }
+    return false;
+  }
+  absl::Status Status() const override { return status_; }
+  const class Key& Key() const override { return iterators_[pos_]->Key(); }
+  int NumColumns() const override { return iterators_[pos_]->NumColumns(); }
+  const zetasql::Value& ColumnValue(int i) const override {
+    return iterators_[pos_]->ColumnValue(i);
+  }
+
+ private:
+  std::vector<std::unique_ptr<StorageIterator>> iterators_;
+  size_t pos_ = 0;
+  absl::Status status_;
+};
+
+// Returns true if `a` and `b` can be loaded into storage together.
+bool IsSameWriteShape(const StorageWrite& a, const StorageWrite& b) {
+  return a.kind == StorageWrite::Kind::kWrite &&
+         b.kind == StorageWrite::Kind::kWrite && a.timestamp == b.timestamp &&
+         a.table_id == b.table_id && a.column_ids == b.column_ids;
+}
+
+}  // namespace
+
+absl::Status Storage::ReadRanges(absl::Time timestamp,
+                                 const TableID& table_id,
+                                 absl::Span<const KeyRange> key_ranges,
+                                 const std::vector<ColumnID>& column_ids,
+                                 std::unique_ptr<StorageIterator>* itr) const {
+  std::vector<std::unique_ptr<StorageIterator>> iterators(key_ranges.size());
+  for (size_t i = 0; i < key_ranges.size(); ++i) {
+    ZETASQL_RETURN_IF_ERROR(
+        Read(timestamp, table_id, key_ranges[i], column_ids, &iterators[i]));
+  }
+  *itr = std::make_unique<ChainedStorageIterator>(std::move(iterators));
+  return absl::OkStatus();
+}
+
+absl::Status Storage::ReadSample(absl::Time timestamp, const TableID& table_id,
+                                 absl::Span<const KeyRange> key_ranges,
+                                 const std::vector<ColumnID>& column_ids,
+                                 const RowSample& sample,
+                                 std::unique_ptr<StorageIterator>* itr) const {
+  std::vector<std::unique_ptr<StorageIterator>> iterators(1);
+  ZETASQL_RETURN_IF_ERROR(
+      ReadRanges(timestamp, table_id, key_ranges, column_ids, &iterators[0]));
+  *itr = std::make_unique<SampledStorageIterator>(std::move(iterators), sample);
+  return absl::OkStatus();
+}
+
+absl::Status Storage::ReadFirstRows(
+    absl::Time timestamp, const TableID& table_id,
+    absl::Span<const KeyRange> key_ranges,
+    const std::vector<ColumnID>& column_ids, int64_t limit,
+    std::unique_ptr<StorageIterator>* itr) const {
+  std::vector<std::unique_ptr<StorageIterator>> iterators(1);
+  ZETASQL_RETURN_IF_ERROR(
+      ReadRanges(timestamp, table_id, key_ranges, column_ids, &iterators[0]));
+  *itr = std::make_unique<LimitedStorageIterator>(std::move(iterators), limit);
+  return absl::OkStatus();
+}
+
+absl::Status Storage::Apply(absl::Span<StorageWrite> writes) {
+  for (size_t i = 0; i < writes.size(); ++i) {
+    const StorageWrite& write = writes[i];
+    if (write.kind == StorageWrite::Kind::kDelete) {
+      ZETASQL_RETURN_IF_ERROR(
+          Delete(write.timestamp, write.table_id, write.key_range));
+      continue;
+    }
+    size_t end = i + 1;
+    while (end < writes.size() && IsSameWriteShape(write, writes[end])) {
+      ++end;
+    }
+    if (end - i > 1) {
+      StorageWriteIterator rows(writes.subspan(i, end - i));
+      ZETASQL_RETURN_IF_ERROR(
+          LoadSorted(write.timestamp, write.table_id, write.column_ids, &rows));
+      i = end - 1;
+      continue;
+    }
+    ZETASQL_RETURN_IF_ERROR(Write(write.timestamp, write.table_id, write.key,
+                          write.column_ids, write.values));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -17,20 +17,51 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_STORAGE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_STORAGE_H_
 
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include "zetasql/public/value.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "backend/common/ids.h"
 #include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/storage/iterator.h"
+#include "backend/storage/row_sampler.h"
 #include "absl/status/status.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
 namespace emulator {
 namespace backend {
 
+// StorageWrite is a single row write or key range deletion, applied along with
+// others by Storage::Apply.
+struct StorageWrite {
+  enum class Kind { kWrite, kDelete };
+
+  Kind kind = Kind::kWrite;
+
+  // The timestamp at which the write is applied.
+  absl::Time timestamp;
+
+  // The table written to.
+  TableID table_id;
+
+  // The key and column values of the row written. Unused for deletions.
+  Key key;
+  std::vector<ColumnID> column_ids;
+  std::vector<zetasql::Value> values;
+
+  // The ClosedOpen key range deleted. Unused for writes.
+  KeyRange key_range;
+};
+
 // Storage defines the interface for a multi-version data store.
 //
 // There will be a Storage instance for each database created. The current
@@ -50,6 +81,44 @@ class Storage {
                               const std::vector<ColumnID>& column_ids,
                               std::vector<zetasql::Value>* values) const = 0;
 
+  // Returns true if the given key exists at the specified timestamp. Unlike
+  // Lookup, a missing key is not an error, so callers that expect keys to be
+  // missing, such as existence checks for inserts and foreign keys, do not
+  // pay for building an error message.
+  //
+  // The default implementation calls Lookup.
+  virtual bool Exists(absl::Time timestamp, const TableID& table_id,
+                      const Key& key) const {
+    return Lookup(timestamp, table_id, key, {}, nullptr).ok();
+  }
+
+  // Looks up multiple keys of a table at the specified timestamp. On return,
+  // (*rows)[i] holds the column values for keys[i] as returned by Lookup, or
+  // std::nullopt if keys[i] does not exist. Keys may be given in any order.
+  //
+  // The default implementation looks up each key in turn. Implementations
+  // should override it to resolve all keys in a single pass over the table.
+  virtual absl::Status BatchLookup(
+      absl::Time timestamp, const TableID& table_id, absl::Span<const Key> keys,
+      const std::vector<ColumnID>& column_ids,
+      std::vector<std::optional<std::vector<zetasql::Value>>>* rows) const {
+    rows->clear();
+    rows->reserve(keys.size());
+    for (const Key& key : keys) {
+      std::vector<zetasql::Value> values;
+      absl::Status status =
+          Lookup(timestamp, table_id, key, column_ids, &values);
+      if (status.code() == absl::StatusCode::kNotFound) {
+        rows->emplace_back(std::nullopt);
+      } else if (!status.ok()) {
+        return status;
+      } else {
+        rows->emplace_back(std::move(values));
+      }
+    }
+    return absl::OkStatus();
+  }
+
   // Returns zero or more rows for given key range. Keys are returned in
   // sorted order. See comments on StorageIterator for more details. KeyRange
   // interval should be in KeyRange::ClosedOpen format. Non ClosedOpen ranges
@@ -59,6 +128,42 @@ class Storage {
                             const std::vector<ColumnID>& column_ids,
                             std::unique_ptr<StorageIterator>* itr) const = 0;
 
+  // Returns the rows of all the given key ranges through a single iterator.
+  // The key ranges must be ClosedOpen, sorted and disjoint, as produced by
+  // MakeDisjointKeyRanges, so that keys are returned in sorted order.
+  //
+  // The default implementation chains a Read of each key range.
+  // Implementations should override it to walk all the key ranges in a single
+  // ordered pass over the table.
+  virtual absl::Status ReadRanges(absl::Time timestamp, const TableID& table_id,
+                                  absl::Span<const KeyRange> key_ranges,
+                                  const std::vector<ColumnID>& column_ids,
+                                  std::unique_ptr<StorageIterator>* itr) const;
+
+  // Same as ReadRanges, except that only a random `sample` of the rows is
+  // returned, in key order.
+  //
+  // The default implementation samples the rows of ReadRanges.
+  // Implementations should override it to skip the rows which are not part of
+  // the sample without reading their values.
+  virtual absl::Status ReadSample(absl::Time timestamp,
+                                  const TableID& table_id,
+                                  absl::Span<const KeyRange> key_ranges,
+                                  const std::vector<ColumnID>& column_ids,
+                                  const RowSample& sample,
+                                  std::unique_ptr<StorageIterator>* itr) const;
+
+  // Same as ReadRanges, except that only the first `limit` rows are returned.
+  //
+  // The default implementation stops iterating the rows of ReadRanges after
+  // `limit` rows. Implementations should override it to fetch no more than
+  // `limit` rows from the table.
+  virtual absl::Status ReadFirstRows(
+      absl::Time timestamp, const TableID& table_id,
+      absl::Span<const KeyRange> key_ranges,
+      const std::vector<ColumnID>& column_ids, int64_t limit,
+      std::unique_ptr<StorageIterator>* itr) const;
+
   // Writes column values for given key at the specified timestamp. Column value
   // will be overwritten for non-unique <timestamp, table_id, key, column_id>
   // combination.
@@ -67,12 +172,57 @@ class Storage {
                              const std::vector<ColumnID>& column_ids,
                              const std::vector<zetasql::Value>& values) = 0;
 
+  // Writes every row of `rows` at the specified timestamp, as if by calling
+  // Write with the row's key, `column_ids` and the row's column values, in
+  // which case rows must have as many columns as `column_ids`. Rows are
+  // expected in ascending key order, which lets implementations build the
+  // table in a single pass. Other orders are still written correctly, but
+  // without that speedup.
+  //
+  // The default implementation writes each row in turn.
+  virtual absl::Status LoadSorted(absl::Time timestamp, const TableID& table_id,
+                                  const std::vector<ColumnID>& column_ids,
+                                  StorageIterator* rows) {
+    std::vector<zetasql::Value> values;
+    while (rows->Next()) {
+      values.clear();
+      for (int i = 0; i < rows->NumColumns(); ++i) {
+        values.push_back(rows->ColumnValue(i));
+      }
+      ZETASQL_RETURN_IF_ERROR(
+          Write(timestamp, table_id, rows->Key(), column_ids, values));
+    }
+    return rows->Status();
+  }
+
   // Marks the given key range as deleted at the specified timestamp. Column
   // values at older timestamps are still accessible via Read and Lookup.
   // KeyRange interval should be in KeyRange::ClosedOpen format. Non ClosedOpen
   // ranges will result in INVALID_ARGUMENT.
   virtual absl::Status Delete(absl::Time timestamp, const TableID& table_id,
                               const KeyRange& key_range) = 0;
+
+  // Applies `writes` in order, as if by calling Write or Delete for each of
+  // them. Writes to the same table are applied in order, but writes to
+  // different tables may be interleaved differently. Stops at the first error,
+  // in which case a prefix of the writes to each table may have been applied.
+  //
+  // The keys and values of `writes` may be moved into storage, leaving them
+  // in a valid but unspecified state.
+  //
+  // The default implementation loads runs of consecutive writes to the same
+  // table and columns with LoadSorted and applies the others one by one.
+  virtual absl::Status Apply(absl::Span<StorageWrite> writes);
+
+  // Returns the approximate number of bytes of memory used by each table,
+  // counting the keys and all the stored versions of its rows, including
+  // versions not yet garbage collected. Tables which were never written to
+  // are omitted.
+  //
+  // The default implementation returns no tables.
+  virtual absl::flat_hash_map<TableID, int64_t> TableSizesInBytes() const {
+    return {};
+  }
 };
 
 }  // namespace backend
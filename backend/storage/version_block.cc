@@ -0,0 +1,168 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/storage/version_block.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "zetasql/public/value.pb.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "google/protobuf/wire_format_lite.h"
+#include "absl/algorithm/container.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "common/errors.h"
+#include "lz4.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+using ::google::protobuf::internal::WireFormatLite;
+
+int64_t ToUnixNanos(absl::Time timestamp) {
+  return absl::ToInt64Nanoseconds(timestamp - absl::UnixEpoch());
+}
+
+absl::Status CorruptBlockError() {
+  return error::Internal("Could not decode a compressed block of versions");
+}
+
+}  // namespace
+
+absl::StatusOr<VersionBlock> VersionBlock::Encode(const Cells& cells) {
+  VersionBlock block;
+  std::string encoded;
+  {
+    google::protobuf::io::StringOutputStream stream(&encoded);
+    google::protobuf::io::CodedOutputStream out(&stream);
+    std::string serialized_value;
+    out.WriteVarint32(cells.size());
+    for (const auto& [slot, cell] : cells) {
+      out.WriteVarint32(slot);
+      out.WriteVarint32(cell.size());
+      int64_t previous_nanos = 0;
+      for (const auto& [timestamp, value] : cell) {
+        const int64_t nanos = ToUnixNanos(timestamp);
+        out.WriteVarint64(
+            WireFormatLite::ZigZagEncode64(nanos - previous_nanos));
+        previous_nanos = nanos;
+
+        // Invalid values, which reset a cell, are encoded as type 0.
+        if (!value.is_valid()) {
+          out.WriteVarint32(0);
+          continue;
+        }
+        auto type_itr = absl::c_find(block.types_, value.type());
+        if (type_itr == block.types_.end()) {
+          type_itr = block.types_.insert(type_itr, value.type());
+        }
+        out.WriteVarint32(type_itr - block.types_.begin() + 1);
+
+        zetasql::ValueProto value_proto;
+        ZETASQL_RETURN_IF_ERROR(value.Serialize(&value_proto));
+        serialized_value.clear();
+        value_proto.AppendToString(&serialized_value);
+        out.WriteVarint32(serialized_value.size());
+        out.WriteString(serialized_value);
+      }
+    }
+  }
+
+  block.encoded_size_ = encoded.size();
+  block.compressed_.resize(LZ4_compressBound(encoded.size()));
+  const int compressed_size = LZ4_compress_default(
+      encoded.data(), block.compressed_.data(), encoded.size(),
+      block.compressed_.size());
+  if (compressed_size <= 0) {
+    return error::Internal("Could not compress a block of versions");
+  }
+  block.compressed_.resize(compressed_size);
+  block.compressed_.shrink_to_fit();
+  block.types_.shrink_to_fit();
+  return block;
+}
+
+absl::StatusOr<VersionBlock::Cells> VersionBlock::Decode() const {
+  std::string encoded(encoded_size_, '\0');
+  if (LZ4_decompress_safe(compressed_.data(), encoded.data(),
+                          compressed_.size(),
+                          encoded_size_) != encoded_size_) {
+    return CorruptBlockError();
+  }
+
+  google::protobuf::io::CodedInputStream in(
+      reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size());
+  uint32_t num_cells;
+  if (!in.ReadVarint32(&num_cells)) {
+    return CorruptBlockError();
+  }
+  Cells cells;
+  cells.reserve(num_cells);
+  std::string serialized_value;
+  for (uint32_t i = 0; i < num_cells; ++i) {
+    uint32_t slot;
+    uint32_t num_versions;
+    if (!in.ReadVarint32(&slot) || !in.ReadVarint32(&num_versions)) {
+      return CorruptBlockError();
+    }
+    Cell& cell = cells.emplace_back(slot, Cell()).second;
+    int64_t nanos = 0;
+    for (uint32_t j = 0; j < num_versions; ++j) {
+      uint64_t delta;
+      uint32_t type_index;
+      if (!in.ReadVarint64(&delta) || !in.ReadVarint32(&type_index) ||
+          type_index > types_.size()) {
+        return CorruptBlockError();
+      }
+      nanos += WireFormatLite::ZigZagDecode64(delta);
+      const absl::Time timestamp = absl::UnixEpoch() + absl::Nanoseconds(nanos);
+      if (type_index == 0) {
+        cell.emplace_hint(cell.end(), timestamp, zetasql::Value());
+        continue;
+      }
+
+      uint32_t size;
+      zetasql::ValueProto value_proto;
+      if (!in.ReadVarint32(&size) || !in.ReadString(&serialized_value, size) ||
+          !value_proto.ParseFromString(serialized_value)) {
+        return CorruptBlockError();
+      }
+      ZETASQL_ASSIGN_OR_RETURN(
+          zetasql::Value value,
+          zetasql::Value::Deserialize(value_proto, types_[type_index - 1]));
+      cell.emplace_hint(cell.end(), timestamp, std::move(value));
+    }
+  }
+  return cells;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
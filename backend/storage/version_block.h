@@ -0,0 +1,85 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_VERSION_BLOCK_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_VERSION_BLOCK_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// VersionBlock holds the versions of some cells of a row in compressed form.
+//
+// Each cell is encoded as its versions in timestamp order, each timestamp as
+// the delta from the previous one and each valid value as its serialized
+// zetasql::ValueProto. The encoding is compressed with LZ4. The types of the
+// values are kept uncompressed, and must outlive the block as they must
+// outlive the values.
+//
+// Blocks are immutable: adding versions to a block means decoding it and
+// encoding a new one.
+class VersionBlock {
+ public:
+  // The versions of a cell, keyed by timestamp.
+  using Cell = std::map<absl::Time, zetasql::Value>;
+
+  // Cells keyed by their column slot.
+  using Cells = std::vector<std::pair<int32_t, Cell>>;
+
+  // Encodes and compresses `cells`. Returns an error if a value cannot be
+  // serialized.
+  static absl::StatusOr<VersionBlock> Encode(const Cells& cells);
+
+  // Decompresses and decodes the cells of the block.
+  absl::StatusOr<Cells> Decode() const;
+
+  // Returns the approximate memory usage of the block.
+  int64_t SizeInBytes() const {
+    return sizeof(*this) + compressed_.capacity() +
+           types_.capacity() * sizeof(const zetasql::Type*);
+  }
+
+ private:
+  // The LZ4 compressed encoding of the cells.
+  std::string compressed_;
+
+  // The size of the encoding before compression.
+  int32_t encoded_size_ = 0;
+
+  // The distinct types of the valid values of the cells, which the encoding
+  // refers to by position.
+  std::vector<const zetasql::Type*> types_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_VERSION_BLOCK_H_
@@ -0,0 +1,83 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/version_block.h"
+
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::String;
+
+TEST(VersionBlockTest, DecodesEncodedCells) {
+  absl::Time t0 = absl::Now();
+  VersionBlock::Cells cells;
+  cells.emplace_back(1, VersionBlock::Cell{
+                            {t0, Int64(1)},
+                            {t0 + absl::Nanoseconds(1), zetasql::Value()},
+                            {t0 + absl::Seconds(3), Int64(3)},
+                        });
+  cells.emplace_back(
+      2, VersionBlock::Cell{
+             {t0 - absl::Hours(1), String("old")},
+             {t0, zetasql::Value::Null(zetasql::types::StringType())},
+         });
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(VersionBlock block, VersionBlock::Encode(cells));
+  EXPECT_GT(block.SizeInBytes(), 0);
+  ZETASQL_ASSERT_OK_AND_ASSIGN(VersionBlock::Cells decoded, block.Decode());
+  EXPECT_EQ(decoded, cells);
+}
+
+TEST(VersionBlockTest, DecodesEmptyBlock) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(VersionBlock block, VersionBlock::Encode({}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(VersionBlock::Cells decoded, block.Decode());
+  EXPECT_TRUE(decoded.empty());
+}
+
+TEST(VersionBlockTest, CompressesRepetitiveVersions) {
+  absl::Time t0 = absl::Now();
+  VersionBlock::Cell cell;
+  for (int i = 0; i < 1000; ++i) {
+    cell.emplace(t0 + absl::Seconds(i), String(std::string(100, 'a')));
+  }
+  VersionBlock::Cells cells;
+  cells.emplace_back(1, std::move(cell));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(VersionBlock block, VersionBlock::Encode(cells));
+  EXPECT_LT(block.SizeInBytes(), 1000 * 100);
+}
+
+}  // namespace
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
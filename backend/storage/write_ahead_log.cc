@@ -0,0 +1,316 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/write_ahead_log.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "zetasql/base/logging.h"
+#include "absl/flags/flag.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "backend/storage/write_ahead_log.pb.h"
+#include "common/errors.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "google/protobuf/util/delimited_message_util.h"
+#include "zetasql/base/status_macros.h"
+
+ABSL_FLAG(bool, wal_fsync, true,
+          "If true, write-ahead log records are fsynced before a commit "
+          "returns, so they survive a machine crash. If false, records are "
+          "only written to the OS page cache and survive an emulator crash.");
+
+ABSL_FLAG(absl::Duration, wal_group_commit_window, absl::ZeroDuration(),
+          "How long a write-ahead log sync waits for concurrent commits to "
+          "join it before writing. A longer window trades commit latency for "
+          "fewer fsyncs under concurrent load.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+constexpr absl::string_view kSegmentPrefix = "wal-";
+constexpr absl::string_view kSegmentSuffix = ".log";
+
+std::string SegmentPath(const std::string& dir, int64_t segment_number) {
+  return absl::StrFormat("%s/%s%010d%s", dir, kSegmentPrefix, segment_number,
+                         kSegmentSuffix);
+}
+
+// Returns the numbers of the segments in `dir` in increasing order.
+absl::StatusOr<std::vector<int64_t>> ListSegments(const std::string& dir) {
+  std::vector<int64_t> segments;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    std::string name = entry.path().filename().string();
+    absl::string_view number = name;
+    int64_t segment_number;
+    if (absl::ConsumePrefix(&number, kSegmentPrefix) &&
+        absl::ConsumeSuffix(&number, kSegmentSuffix) &&
+        absl::SimpleAtoi(number, &segment_number)) {
+      segments.push_back(segment_number);
+    }
+  }
+  if (ec) {
+    return error::WriteAheadLogIOError(dir, "list", ec.value());
+  }
+  std::sort(segments.begin(), segments.end());
+  return segments;
+}
+
+// Opens a segment file for appending, creating it if needed.
+int OpenSegment(const std::string& path) {
+  return ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+}
+
+// Writes all of `data` to `fd`, retrying on partial writes.
+absl::Status WriteFully(int fd, absl::string_view data,
+                        const std::string& path) {
+  while (!data.empty()) {
+    ssize_t written = ::write(fd, data.data(), data.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return error::WriteAheadLogIOError(path, "write", errno);
+    }
+    data.remove_prefix(written);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<WriteAheadLog>> WriteAheadLog::Open(
+    const std::string& dir) {
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  if (ec) {
+    return error::WriteAheadLogIOError(dir, "create", ec.value());
+  }
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<int64_t> segments, ListSegments(dir));
+  int64_t segment_number = segments.empty() ? 1 : segments.back() + 1;
+  std::string path = SegmentPath(dir, segment_number);
+  int fd = OpenSegment(path);
+  if (fd < 0) {
+    return error::WriteAheadLogIOError(path, "open", errno);
+  }
+  return absl::WrapUnique(new WriteAheadLog(dir, segment_number, fd));
+}
+
+WriteAheadLog::WriteAheadLog(std::string dir, int64_t segment_number, int fd)
+    : dir_(std::move(dir)), segment_number_(segment_number), fd_(fd) {}
+
+WriteAheadLog::~WriteAheadLog() {
+  Sequence last_appended;
+  {
+    absl::MutexLock lock(&mu_);
+    last_appended = last_appended_;
+  }
+  absl::Status status = Sync(last_appended);
+  if (!status.ok()) {
+    ABSL_LOG(ERROR) << "Failed to sync write-ahead log " << dir_ << ": "
+                    << status;
+  }
+  absl::MutexLock lock(&mu_);
+  ::close(fd_);
+}
+
+absl::StatusOr<WriteAheadLog::Sequence> WriteAheadLog::Append(
+    const WalRecord& record) {
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream output(&serialized);
+    if (!google::protobuf::util::SerializeDelimitedToZeroCopyStream(record,
+                                                          &output)) {
+      return error::Internal("Failed to serialize write-ahead log record.");
+    }
+  }
+  absl::MutexLock lock(&mu_);
+  ZETASQL_RETURN_IF_ERROR(status_);
+  buffer_.append(serialized);
+  bytes_since_rotation_ += serialized.size();
+  return ++last_appended_;
+}
+
+absl::Status WriteAheadLog::Sync(Sequence sequence) {
+  absl::MutexLock lock(&mu_);
+  auto can_proceed = [this, sequence]() ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+    return !sync_in_progress_ || last_synced_ >= sequence || !status_.ok();
+  };
+  while (true) {
+    ZETASQL_RETURN_IF_ERROR(status_);
+    if (last_synced_ >= sequence) {
+      return absl::OkStatus();
+    }
+    if (!sync_in_progress_) {
+      break;
+    }
+    // Another caller is syncing. Its sync may or may not cover `sequence`, so
+    // check again once it is done.
+    mu_.Await(absl::Condition(&can_proceed));
+  }
+  return SyncBufferLocked();
+}
+
+absl::Status WriteAheadLog::SyncBufferLocked() {
+  sync_in_progress_ = true;
+  absl::Duration window = absl::GetFlag(FLAGS_wal_group_commit_window);
+  if (window > absl::ZeroDuration()) {
+    // Let concurrent commits append their records so that they are covered by
+    // this sync.
+    mu_.Unlock();
+    absl::SleepFor(window);
+    mu_.Lock();
+  }
+  std::string data;
+  data.swap(buffer_);
+  const Sequence target = last_appended_;
+  const int fd = fd_;
+  const std::string path = SegmentPath(dir_, segment_number_);
+
+  mu_.Unlock();
+  absl::Status status = WriteFully(fd, data, path);
+  if (status.ok() && absl::GetFlag(FLAGS_wal_fsync) && ::fdatasync(fd) != 0) {
+    status = error::WriteAheadLogIOError(path, "sync", errno);
+  }
+  mu_.Lock();
+
+  sync_in_progress_ = false;
+  if (!status.ok()) {
+    status_ = status;
+    return status;
+  }
+  last_synced_ = std::max(last_synced_, target);
+  return absl::OkStatus();
+}
+
+absl::Status WriteAheadLog::Rotate() {
+  absl::MutexLock lock(&mu_);
+  mu_.Await(absl::Condition(
+      +[](bool* sync_in_progress) { return !*sync_in_progress; },
+      &sync_in_progress_));
+  ZETASQL_RETURN_IF_ERROR(SyncBufferLocked());
+
+  std::string path = SegmentPath(dir_, segment_number_ + 1);
+  int fd = OpenSegment(path);
+  if (fd < 0) {
+    return error::WriteAheadLogIOError(path, "open", errno);
+  }
+  ::close(fd_);
+  fd_ = fd;
+  ++segment_number_;
+  bytes_since_rotation_ = 0;
+  return absl::OkStatus();
+}
+
+absl::Status WriteAheadLog::RemoveSegmentsBeforeCurrent() {
+  int64_t current_segment;
+  {
+    absl::MutexLock lock(&mu_);
+    current_segment = segment_number_;
+  }
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<int64_t> segments, ListSegments(dir_));
+  for (int64_t segment_number : segments) {
+    if (segment_number >= current_segment) {
+      break;
+    }
+    std::string path = SegmentPath(dir_, segment_number);
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    if (ec) {
+      return error::WriteAheadLogIOError(path, "remove", ec.value());
+    }
+  }
+  return absl::OkStatus();
+}
+
+int64_t WriteAheadLog::bytes_since_rotation() const {
+  absl::MutexLock lock(&mu_);
+  return bytes_since_rotation_;
+}
+
+absl::Status WriteAheadLog::Replay(
+    const std::string& dir,
+    const std::function<absl::Status(const WalRecord&)>& fn) {
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<int64_t> segments, ListSegments(dir));
+  for (int i = 0; i < segments.size(); ++i) {
+    const std::string path = SegmentPath(dir, segments[i]);
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+      return error::WriteAheadLogIOError(path, "open", errno);
+    }
+    google::protobuf::io::IstreamInputStream input(&in);
+    int64_t valid_bytes = 0;
+    while (true) {
+      WalRecord record;
+      bool clean_eof = false;
+      if (!google::protobuf::util::ParseDelimitedFromZeroCopyStream(&record, &input,
+                                                          &clean_eof)) {
+        if (clean_eof) {
+          break;
+        }
+        if (i + 1 < segments.size()) {
+          return error::InvalidWriteAheadLog(path, "unreadable record");
+        }
+        // The last record of the last segment was torn by a crash while it
+        // was being written. Drop it so that the segment ends cleanly.
+        ABSL_LOG(WARNING) << "Truncating torn record at offset " << valid_bytes
+                          << " of write-ahead log " << path;
+        in.close();
+        std::error_code ec;
+        std::filesystem::resize_file(path, valid_bytes, ec);
+        if (ec) {
+          return error::WriteAheadLogIOError(path, "truncate", ec.value());
+        }
+        break;
+      }
+      valid_bytes = input.ByteCount();
+      ZETASQL_RETURN_IF_ERROR(fn(record));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
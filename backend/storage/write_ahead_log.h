@@ -0,0 +1,133 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_WRITE_AHEAD_LOG_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_WRITE_AHEAD_LOG_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/declare.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/storage/write_ahead_log.pb.h"
+
+// Whether the write-ahead log fsyncs appended records before a commit returns.
+ABSL_DECLARE_FLAG(bool, wal_fsync);
+
+// How long the write-ahead log waits for concurrent commits to join a sync.
+ABSL_DECLARE_FLAG(absl::Duration, wal_group_commit_window);
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// WriteAheadLog is an append-only log of the changes made to a database,
+// stored as a sequence of numbered segment files in a directory.
+//
+// Appending a record only serializes it into an in-memory buffer. Sync writes
+// the buffer to the current segment with a single sequential write followed by
+// an fsync. Syncs are group committed: while one caller is syncing, other
+// callers wait and are covered by the next sync, so concurrent commits share
+// the cost of an fsync.
+//
+// Rotate starts a new segment so that older segments can be removed once a
+// checkpoint covering them has been written.
+//
+// This class is thread safe.
+class WriteAheadLog {
+ public:
+  // Position of a record in the log. Sequences increase with each append.
+  using Sequence = int64_t;
+
+  // Opens the log in `dir`, creating the directory if needed. Records are
+  // appended to a new segment which follows any existing segments.
+  static absl::StatusOr<std::unique_ptr<WriteAheadLog>> Open(
+      const std::string& dir);
+
+  // Syncs any buffered records and closes the current segment.
+  ~WriteAheadLog();
+
+  // Buffers `record` and returns its sequence. The record is not durable until
+  // Sync returns for a sequence at or past it.
+  absl::StatusOr<Sequence> Append(const WalRecord& record)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Blocks until all records up to and including `sequence` are durable.
+  absl::Status Sync(Sequence sequence) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Syncs all buffered records and starts a new segment.
+  absl::Status Rotate() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Removes all segments before the current one.
+  absl::Status RemoveSegmentsBeforeCurrent() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of bytes appended since the last rotation.
+  int64_t bytes_since_rotation() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Calls `fn` for each record of the log in `dir`, in append order. A record
+  // torn by a crash at the end of the last segment is truncated away; any other
+  // unreadable record is reported as DATA_LOSS.
+  static absl::Status Replay(
+      const std::string& dir,
+      const std::function<absl::Status(const WalRecord&)>& fn);
+
+ private:
+  WriteAheadLog(std::string dir, int64_t segment_number, int fd);
+
+  // Writes out and syncs all buffered records. Releases `mu_` while doing IO;
+  // sync_in_progress_ is set meanwhile so that no other sync starts.
+  absl::Status SyncBufferLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Directory holding the log segments.
+  const std::string dir_;
+
+  mutable absl::Mutex mu_;
+
+  // Number and file descriptor of the segment being appended to.
+  int64_t segment_number_ ABSL_GUARDED_BY(mu_);
+  int fd_ ABSL_GUARDED_BY(mu_);
+
+  // Serialized records which have been appended but not yet written out.
+  std::string buffer_ ABSL_GUARDED_BY(mu_);
+
+  // Sequence of the last appended record and the last durable record.
+  Sequence last_appended_ ABSL_GUARDED_BY(mu_) = 0;
+  Sequence last_synced_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // True while a caller is writing out the buffer without holding `mu_`.
+  bool sync_in_progress_ ABSL_GUARDED_BY(mu_) = false;
+
+  // Bytes appended since the last rotation.
+  int64_t bytes_since_rotation_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // The first write or sync error. Once set, all later syncs fail, since the
+  // contents of the current segment are unknown.
+  absl::Status status_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_WRITE_AHEAD_LOG_H_
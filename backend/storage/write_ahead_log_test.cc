@@ -0,0 +1,171 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/write_ahead_log.h"
+
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "tests/common/proto_matchers.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "backend/storage/write_ahead_log.pb.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using test::EqualsProto;
+
+class WriteAheadLogTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = absl::StrCat(
+        testing::TempDir(), "/",
+        testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::filesystem::remove_all(dir_);
+  }
+
+  static WalRecord SchemaChange(const std::string& statement) {
+    WalRecord record;
+    record.mutable_schema_change()->add_statements(statement);
+    return record;
+  }
+
+  std::vector<WalRecord> ReplayAll() {
+    std::vector<WalRecord> records;
+    ZETASQL_EXPECT_OK(WriteAheadLog::Replay(dir_, [&](const WalRecord& record) {
+      records.push_back(record);
+      return absl::OkStatus();
+    }));
+    return records;
+  }
+
+  std::string dir_;
+};
+
+TEST_F(WriteAheadLogTest, ReplaysSyncedRecords) {
+  {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<WriteAheadLog> wal,
+                         WriteAheadLog::Open(dir_));
+    ZETASQL_ASSERT_OK(wal->Append(SchemaChange("CREATE TABLE A")).status());
+    ZETASQL_ASSERT_OK_AND_ASSIGN(WriteAheadLog::Sequence sequence,
+                         wal->Append(SchemaChange("CREATE TABLE B")));
+    ZETASQL_ASSERT_OK(wal->Sync(sequence));
+  }
+
+  EXPECT_THAT(
+      ReplayAll(),
+      testing::ElementsAre(
+          EqualsProto(R"pb(schema_change { statements: "CREATE TABLE A" })pb"),
+          EqualsProto(
+              R"pb(schema_change { statements: "CREATE TABLE B" })pb")));
+}
+
+TEST_F(WriteAheadLogTest, ReopenAppendsAfterExistingRecords) {
+  for (const std::string& statement : {"CREATE TABLE A", "CREATE TABLE B"}) {
+    // Records which are appended but not explicitly synced are written out
+    // when the log is closed.
+    ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<WriteAheadLog> wal,
+                         WriteAheadLog::Open(dir_));
+    ZETASQL_ASSERT_OK(wal->Append(SchemaChange(statement)).status());
+  }
+
+  std::vector<WalRecord> records = ReplayAll();
+  ASSERT_EQ(records.size(), 2);
+  EXPECT_EQ(records[0].schema_change().statements(0), "CREATE TABLE A");
+  EXPECT_EQ(records[1].schema_change().statements(0), "CREATE TABLE B");
+}
+
+TEST_F(WriteAheadLogTest, RemovesSegmentsBeforeRotation) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<WriteAheadLog> wal,
+                       WriteAheadLog::Open(dir_));
+  ZETASQL_ASSERT_OK(wal->Append(SchemaChange("CREATE TABLE A")).status());
+  EXPECT_GT(wal->bytes_since_rotation(), 0);
+
+  ZETASQL_ASSERT_OK(wal->Rotate());
+  EXPECT_EQ(wal->bytes_since_rotation(), 0);
+  ZETASQL_ASSERT_OK_AND_ASSIGN(WriteAheadLog::Sequence sequence,
+                       wal->Append(SchemaChange("CREATE TABLE B")));
+  ZETASQL_ASSERT_OK(wal->Sync(sequence));
+
+  EXPECT_EQ(ReplayAll().size(), 2);
+  ZETASQL_ASSERT_OK(wal->RemoveSegmentsBeforeCurrent());
+  std::vector<WalRecord> records = ReplayAll();
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(records[0].schema_change().statements(0), "CREATE TABLE B");
+}
+
+TEST_F(WriteAheadLogTest, TruncatesTornRecordAtEndOfLog) {
+  {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<WriteAheadLog> wal,
+                         WriteAheadLog::Open(dir_));
+    ZETASQL_ASSERT_OK(wal->Append(SchemaChange("CREATE TABLE A")).status());
+  }
+  std::string segment;
+  for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+    segment = entry.path().string();
+  }
+  const auto valid_size = std::filesystem::file_size(segment);
+  {
+    // A length prefix promising more bytes than were written.
+    std::ofstream out(segment, std::ios::binary | std::ios::app);
+    out << '\x7f' << "partial";
+  }
+
+  EXPECT_EQ(ReplayAll().size(), 1);
+  EXPECT_EQ(std::filesystem::file_size(segment), valid_size);
+}
+
+TEST_F(WriteAheadLogTest, ConcurrentCommitsShareSyncs) {
+  constexpr int kNumThreads = 8;
+  constexpr int kRecordsPerThread = 50;
+  {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<WriteAheadLog> wal,
+                         WriteAheadLog::Open(dir_));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&wal, t]() {
+        for (int i = 0; i < kRecordsPerThread; ++i) {
+          absl::StatusOr<WriteAheadLog::Sequence> sequence =
+              wal->Append(SchemaChange(absl::StrCat(t, ":", i)));
+          ZETASQL_ASSERT_OK(sequence.status());
+          ZETASQL_ASSERT_OK(wal->Sync(*sequence));
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+
+  EXPECT_EQ(ReplayAll().size(), kNumThreads * kRecordsPerThread);
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -59,26 +60,24 @@ namespace emulator {
 namespace backend {
 absl::StatusOr<bool> TransactionReadOnlyStore::Exists(const Table* table,
                                                       const Key& key) const {
-  absl::StatusOr<ValueList> maybe_row =
-      read_only_store_->Lookup(table, key, {});
-  if (maybe_row.status().code() == absl::StatusCode::kNotFound) {
-    return false;
-  } else if (!maybe_row.ok()) {
-    return maybe_row.status();
+  return read_only_store_->Exists(table, key);
+}
+
+absl::StatusOr<std::vector<bool>> TransactionReadOnlyStore::BatchExists(
+    const Table* table, absl::Span<const Key> keys) const {
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<std::optional<ValueList>> rows,
+                   read_only_store_->BatchLookup(table, keys, {}));
+  std::vector<bool> exists;
+  exists.reserve(rows.size());
+  for (const std::optional<ValueList>& row : rows) {
+    exists.push_back(row.has_value());
   }
-  return true;
+  return exists;
 }
 
 absl::StatusOr<bool> TransactionReadOnlyStore::PrefixExists(
     const Table* table, const Key& prefix_key) const {
-  std::unique_ptr<StorageIterator> itr;
-  ZETASQL_RETURN_IF_ERROR(
-      read_only_store_->Read(table, KeyRange::Point(prefix_key), {}, &itr));
-  if (itr->Next() && itr->Status().ok()) {
-    return true;
-  }
-  ZETASQL_RETURN_IF_ERROR(itr->Status());
-  return false;
+  return read_only_store_->PrefixExists(table, prefix_key);
 }
 
 absl::StatusOr<ValueList> TransactionReadOnlyStore::ReadCommitted(
@@ -99,6 +98,61 @@ absl::StatusOr<std::unique_ptr<StorageIterator>> TransactionReadOnlyStore::Read(
   return itr;
 }
 
+absl::StatusOr<std::optional<ValueList>> TransactionReadOnlyStore::ReadRow(
+    const Table* table, const Key& key,
+    absl::Span<const Column* const> columns) const {
+  if (cache_generation_ != read_only_store_->generation()) {
+    row_cache_.clear();
+    cache_generation_ = read_only_store_->generation();
+  }
+
+  auto [row_itr, inserted] = row_cache_.try_emplace({table, key});
+  CachedRow& row = row_itr->second;
+  std::vector<const Column*> columns_to_read;
+  for (const Column* column : columns) {
+    if (!row.values.contains(column)) {
+      columns_to_read.push_back(column);
+    }
+  }
+  if (inserted || !columns_to_read.empty()) {
+    absl::StatusOr<std::vector<std::optional<ValueList>>> rows =
+        read_only_store_->BatchLookup(
+            table, {key}, columns_to_read,
+            /*allow_pending_commit_timestamps_in_read=*/false);
+    if (!rows.ok()) {
+      if (inserted) {
+        row_cache_.erase(row_itr);
+      }
+      return rows.status();
+    }
+    std::optional<ValueList>& values = rows->front();
+    row.exists = values.has_value();
+    for (int i = 0; i < columns_to_read.size(); ++i) {
+      row.values[columns_to_read[i]] =
+          row.exists ? std::move((*values)[i]) : zetasql::Value();
+    }
+  }
+
+  if (!row.exists) {
+    return std::nullopt;
+  }
+  ValueList values;
+  values.reserve(columns.size());
+  for (const Column* column : columns) {
+    values.push_back(row.values.at(column));
+  }
+  return values;
+}
+
+absl::StatusOr<std::vector<std::optional<ValueList>>>
+TransactionReadOnlyStore::BatchRead(
+    const Table* table, absl::Span<const Key> keys,
+    absl::Span<const Column* const> columns) const {
+  return read_only_store_->BatchLookup(
+      table, keys, columns,
+      /*allow_pending_commit_timestamps_in_read=*/false);
+}
+
 void TransactionEffectsBuffer::Insert(
     const Table* table, const Key& key, absl::Span<const Column* const> columns,
     const std::vector<zetasql::Value>& values) {
@@ -19,17 +19,22 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <queue>
+#include <utility>
 #include <vector>
 
 #include "zetasql/public/value.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "backend/actions/context.h"
 #include "backend/actions/ops.h"
+#include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/schema/catalog/change_stream.h"
 #include "backend/schema/catalog/table.h"
@@ -48,6 +53,11 @@ class ReadWriteTransaction;
 //
 // The storage is backed by the TransactionStore and always performs the read at
 // the latest timestamp.
+//
+// The index, generated column and check constraint actions of a write
+// operation each read the row they apply to. ReadRow caches the columns read
+// of each row, so that every column of a row is read from the TransactionStore
+// at most once until the next mutation is buffered.
 class TransactionReadOnlyStore : public ReadOnlyStore {
  public:
   explicit TransactionReadOnlyStore(const TransactionStore* txn_store)
@@ -56,6 +66,9 @@ class TransactionReadOnlyStore : public ReadOnlyStore {
   absl::StatusOr<bool> Exists(const Table* table,
                               const Key& key) const override;
 
+  absl::StatusOr<std::vector<bool>> BatchExists(
+      const Table* table, absl::Span<const Key> keys) const override;
+
   absl::StatusOr<bool> PrefixExists(const Table* table,
                                     const Key& prefix_key) const override;
 
@@ -67,8 +80,29 @@ class TransactionReadOnlyStore : public ReadOnlyStore {
       const Table* table, const KeyRange& key_range,
       absl::Span<const Column* const> columns) const override;
 
+  absl::StatusOr<std::optional<ValueList>> ReadRow(
+      const Table* table, const Key& key,
+      absl::Span<const Column* const> columns) const override;
+
+  absl::StatusOr<std::vector<std::optional<ValueList>>> BatchRead(
+      const Table* table, absl::Span<const Key> keys,
+      absl::Span<const Column* const> columns) const override;
+
  private:
+  // The columns of a row read so far. Columns of a row which does not exist
+  // hold invalid values.
+  struct CachedRow {
+    bool exists = false;
+    absl::flat_hash_map<const Column*, zetasql::Value> values;
+  };
+
   const TransactionStore* read_only_store_;
+
+  // Rows read by ReadRow, valid while the generation of the TransactionStore
+  // is cache_generation_.
+  mutable absl::flat_hash_map<std::pair<const Table*, Key>, CachedRow>
+      row_cache_;
+  mutable int64_t cache_generation_ = -1;
 };
 
 // TransactionEffectsBuffer is the transaction buffer in which the write
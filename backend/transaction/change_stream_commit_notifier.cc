@@ -0,0 +1,73 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/transaction/change_stream_commit_notifier.h"
+
+#include <algorithm>
+#include <string>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+void ChangeStreamCommitNotifier::NotifyCommit(
+    const absl::flat_hash_set<std::string>& change_stream_names,
+    absl::Time commit_timestamp) {
+  if (change_stream_names.empty()) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  for (const std::string& name : change_stream_names) {
+    auto [itr, inserted] =
+        last_commit_timestamps_.try_emplace(name, commit_timestamp);
+    if (!inserted) {
+      itr->second = std::max(itr->second, commit_timestamp);
+    }
+  }
+  commit_cvar_.SignalAll();
+}
+
+absl::Time ChangeStreamCommitNotifier::WaitForCommit(
+    absl::string_view change_stream_name, absl::Time start,
+    absl::Time deadline) {
+  absl::MutexLock lock(&mu_);
+  while (LastCommitTimestamp(change_stream_name) < start) {
+    // WaitWithDeadline returns true once the deadline has passed.
+    if (commit_cvar_.WaitWithDeadline(&mu_, deadline)) {
+      break;
+    }
+  }
+  return LastCommitTimestamp(change_stream_name);
+}
+
+absl::Time ChangeStreamCommitNotifier::LastCommitTimestamp(
+    absl::string_view change_stream_name) const {
+  auto itr = last_commit_timestamps_.find(change_stream_name);
+  return itr == last_commit_timestamps_.end() ? absl::InfinitePast()
+                                              : itr->second;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
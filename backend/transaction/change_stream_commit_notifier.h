@@ -0,0 +1,82 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_CHANGE_STREAM_COMMIT_NOTIFIER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_CHANGE_STREAM_COMMIT_NOTIFIER_H_
+
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// ChangeStreamCommitNotifier lets change stream readers wait for commits.
+//
+// Read-write transactions notify it when they commit writes to the internal
+// data or partition tables of a change stream. Change stream partition
+// queries wait on it between scans instead of polling those tables, and are
+// woken up as soon as a commit to their change stream lands.
+//
+// Notifications are only hints of when to scan: readers still read the
+// committed records from storage, so a missed or spurious notification only
+// delays or repeats a scan.
+//
+// This class is thread-safe.
+class ChangeStreamCommitNotifier {
+ public:
+  // Records that a transaction which wrote to the change streams named
+  // `change_stream_names` committed at `commit_timestamp`, and wakes up the
+  // readers waiting on them.
+  void NotifyCommit(const absl::flat_hash_set<std::string>& change_stream_names,
+                    absl::Time commit_timestamp) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Waits until a commit at or after `start` is notified for the change
+  // stream named `change_stream_name`, or until `deadline` passes. Returns the
+  // latest commit timestamp notified for the change stream, which is before
+  // `start` if the deadline passed first.
+  absl::Time WaitForCommit(absl::string_view change_stream_name,
+                           absl::Time start, absl::Time deadline)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  absl::Time LastCommitTimestamp(absl::string_view change_stream_name) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  absl::Mutex mu_;
+
+  // The latest notified commit timestamp of each change stream.
+  absl::flat_hash_map<std::string, absl::Time> last_commit_timestamps_
+      ABSL_GUARDED_BY(mu_);
+
+  // Signaled whenever a commit is notified.
+  absl::CondVar commit_cvar_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_CHANGE_STREAM_COMMIT_NOTIFIER_H_
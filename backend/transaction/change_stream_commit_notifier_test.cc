@@ -0,0 +1,85 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/transaction/change_stream_commit_notifier.h"
+
+#include <thread>  // NOLINT
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+TEST(ChangeStreamCommitNotifierTest, ReturnsAtDeadlineWithoutCommits) {
+  ChangeStreamCommitNotifier notifier;
+  absl::Time start = absl::Now();
+  EXPECT_EQ(notifier.WaitForCommit("stream", start,
+                                   start + absl::Milliseconds(10)),
+            absl::InfinitePast());
+}
+
+TEST(ChangeStreamCommitNotifierTest, ReturnsNotifiedCommitImmediately) {
+  ChangeStreamCommitNotifier notifier;
+  absl::Time commit_timestamp = absl::Now();
+  notifier.NotifyCommit({"stream"}, commit_timestamp);
+  EXPECT_EQ(notifier.WaitForCommit("stream", commit_timestamp,
+                                   absl::InfiniteFuture()),
+            commit_timestamp);
+}
+
+TEST(ChangeStreamCommitNotifierTest, IgnoresCommitsToOtherChangeStreams) {
+  ChangeStreamCommitNotifier notifier;
+  absl::Time start = absl::Now();
+  notifier.NotifyCommit({"other_stream"}, start);
+  EXPECT_EQ(notifier.WaitForCommit("stream", start,
+                                   start + absl::Milliseconds(10)),
+            absl::InfinitePast());
+}
+
+TEST(ChangeStreamCommitNotifierTest, IgnoresCommitsBeforeStart) {
+  ChangeStreamCommitNotifier notifier;
+  absl::Time start = absl::Now();
+  notifier.NotifyCommit({"stream"}, start - absl::Seconds(1));
+  EXPECT_EQ(notifier.WaitForCommit("stream", start,
+                                   start + absl::Milliseconds(10)),
+            start - absl::Seconds(1));
+}
+
+TEST(ChangeStreamCommitNotifierTest, WakesUpWaiterOnCommit) {
+  ChangeStreamCommitNotifier notifier;
+  absl::Time start = absl::Now();
+  std::thread committer([&]() {
+    absl::SleepFor(absl::Milliseconds(10));
+    notifier.NotifyCommit({"stream", "other_stream"},
+                          start + absl::Milliseconds(10));
+  });
+  EXPECT_EQ(notifier.WaitForCommit("stream", start, absl::InfiniteFuture()),
+            start + absl::Milliseconds(10));
+  committer.join();
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
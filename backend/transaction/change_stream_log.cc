@@ -0,0 +1,279 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/transaction/change_stream_log.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/access/read.h"
+#include "backend/actions/ops.h"
+#include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/schema/catalog/change_stream.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/transaction/commit_timestamp.h"
+#include "common/limits.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Column positions of the partition token and commit timestamp in the primary
+// key of a change stream data table.
+constexpr int kPartitionTokenKeyColumn = 0;
+constexpr int kCommitTimestampKeyColumn = 1;
+
+// A RowCursor over rows copied out of the log.
+class LogRowCursor : public RowCursor {
+ public:
+  LogRowCursor(const Table* table,
+               std::vector<std::vector<zetasql::Value>> rows)
+      : columns_(table->columns().begin(), table->columns().end()),
+        rows_(std::move(rows)) {}
+
+  bool Next() override { return ++row_index_ < rows_.size(); }
+
+  absl::Status Status() const override { return absl::OkStatus(); }
+
+  int NumColumns() const override { return columns_.size(); }
+
+  const std::string ColumnName(int i) const override {
+    return columns_[i]->Name();
+  }
+
+  const zetasql::Value ColumnValue(int i) const override {
+    return rows_[row_index_][i];
+  }
+
+  const zetasql::Type* ColumnType(int i) const override {
+    return columns_[i]->GetType();
+  }
+
+ private:
+  size_t row_index_ = -1;
+  const std::vector<const Column*> columns_;
+  const std::vector<std::vector<zetasql::Value>> rows_;
+};
+
+// Returns the retention period of `change_stream`, within the supported
+// bounds.
+absl::Duration RetentionPeriod(const ChangeStream* change_stream) {
+  return std::clamp(absl::Seconds(change_stream->parsed_retention_period()),
+                    absl::Seconds(limits::kChangeStreamsMinRetention),
+                    absl::Seconds(limits::kChangeStreamsMaxRetention));
+}
+
+}  // namespace
+
+ChangeStreamLog::ChangeStreamLog(absl::Duration bucket_width)
+    : bucket_width_(bucket_width) {}
+
+absl::Time ChangeStreamLog::BucketStart(absl::Time timestamp) const {
+  return absl::UnixEpoch() +
+         absl::Floor(timestamp - absl::UnixEpoch(), bucket_width_);
+}
+
+void ChangeStreamLog::AppendCommit(const std::vector<WriteOp>& write_ops,
+                                   absl::Time commit_timestamp) {
+  absl::MutexLock lock(&mu_);
+  for (const WriteOp& write_op : write_ops) {
+    const InsertOp* insert_op = std::get_if<InsertOp>(&write_op);
+    if (insert_op == nullptr) {
+      continue;
+    }
+    const ChangeStream* change_stream =
+        insert_op->table->owner_change_stream();
+    if (change_stream == nullptr ||
+        change_stream->change_stream_data_table() != insert_op->table) {
+      continue;
+    }
+    AppendLocked(*insert_op, commit_timestamp);
+  }
+}
+
+void ChangeStreamLog::AppendLocked(const InsertOp& op,
+                                   absl::Time commit_timestamp) {
+  const Table* table = op.table;
+  Record record;
+  record.key =
+      MaybeSetCommitTimestamp(table->primary_key(), op.key, commit_timestamp);
+  record.values.reserve(table->columns().size());
+  for (const Column* column : table->columns()) {
+    auto it = std::find(op.columns.begin(), op.columns.end(), column);
+    record.values.push_back(
+        it == op.columns.end()
+            ? zetasql::Value::Null(column->GetType())
+            : MaybeSetCommitTimestamp(
+                  column, op.values[std::distance(op.columns.begin(), it)],
+                  commit_timestamp));
+  }
+  const absl::Time record_timestamp =
+      record.key.ColumnValue(kCommitTimestampKeyColumn).ToTime();
+  const absl::Time bucket_start = BucketStart(record_timestamp);
+
+  DataTable& data_table = data_tables_[table->id()];
+  Bucket& bucket =
+      data_table
+          .partitions[record.key.ColumnValue(kPartitionTokenKeyColumn)
+                          .string_value()][bucket_start];
+  // Records arrive in commit timestamp order, so this is almost always an
+  // append to the end of the bucket.
+  auto position = std::upper_bound(
+      bucket.begin(), bucket.end(), record.key,
+      [](const Key& key, const Record& other) { return key < other.key; });
+  bucket.insert(position, std::move(record));
+
+  if (bucket_start > data_table.latest_bucket_start) {
+    data_table.latest_bucket_start = bucket_start;
+    TruncateLocked(&data_table,
+                   commit_timestamp -
+                       RetentionPeriod(table->owner_change_stream()));
+  }
+}
+
+std::unique_ptr<RowCursor> ChangeStreamLog::Read(
+    const Table* data_table, const std::string& partition_token,
+    absl::Time start, absl::Time end, bool inclusive_end,
+    int64_t* num_rows) const {
+  std::vector<std::vector<zetasql::Value>> rows;
+  {
+    absl::MutexLock lock(&mu_);
+    auto table_it = data_tables_.find(data_table->id());
+    if (table_it != data_tables_.end()) {
+      auto partition_it = table_it->second.partitions.find(partition_token);
+      if (partition_it != table_it->second.partitions.end()) {
+        const Partition& partition = partition_it->second;
+        for (auto bucket_it = partition.lower_bound(BucketStart(start));
+             bucket_it != partition.end() && bucket_it->first <= end;
+             ++bucket_it) {
+          const Bucket& bucket = bucket_it->second;
+          auto record_it = std::partition_point(
+              bucket.begin(), bucket.end(), [&](const Record& record) {
+                return record.key.ColumnValue(kCommitTimestampKeyColumn)
+                           .ToTime() < start;
+              });
+          for (; record_it != bucket.end(); ++record_it) {
+            const absl::Time record_timestamp =
+                record_it->key.ColumnValue(kCommitTimestampKeyColumn).ToTime();
+            if (record_timestamp > end ||
+                (record_timestamp == end && !inclusive_end)) {
+              break;
+            }
+            rows.push_back(record_it->values);
+          }
+        }
+      }
+    }
+  }
+  *num_rows = rows.size();
+  return std::make_unique<LogRowCursor>(data_table, std::move(rows));
+}
+
+absl::Time ChangeStreamLog::TruncatedBefore(
+    const TableID& data_table_id) const {
+  absl::MutexLock lock(&mu_);
+  auto it = data_tables_.find(data_table_id);
+  return it != data_tables_.end() ? it->second.truncated_before
+                                  : absl::InfinitePast();
+}
+
+int64_t ChangeStreamLog::Truncate(const TableID& data_table_id,
+                                  absl::Time cutoff) {
+  absl::MutexLock lock(&mu_);
+  auto it = data_tables_.find(data_table_id);
+  if (it == data_tables_.end()) {
+    return 0;
+  }
+  return TruncateLocked(&it->second, cutoff);
+}
+
+void ChangeStreamLog::DiscardAfter(absl::Time timestamp) {
+  auto is_kept = [timestamp](const Record& record) {
+    return record.key.ColumnValue(kCommitTimestampKeyColumn).ToTime() <=
+           timestamp;
+  };
+  absl::MutexLock lock(&mu_);
+  for (auto& [data_table_id, data_table] : data_tables_) {
+    for (auto partition_it = data_table.partitions.begin();
+         partition_it != data_table.partitions.end();) {
+      Partition& partition = partition_it->second;
+      partition.erase(partition.upper_bound(timestamp), partition.end());
+      auto bucket_it = partition.find(BucketStart(timestamp));
+      if (bucket_it != partition.end()) {
+        Bucket& bucket = bucket_it->second;
+        bucket.erase(
+            std::partition_point(bucket.begin(), bucket.end(), is_kept),
+            bucket.end());
+        if (bucket.empty()) {
+          partition.erase(bucket_it);
+        }
+      }
+      if (partition.empty()) {
+        data_table.partitions.erase(partition_it++);
+      } else {
+        ++partition_it;
+      }
+    }
+  }
+}
+
+int64_t ChangeStreamLog::TruncateLocked(DataTable* data_table,
+                                        absl::Time cutoff) {
+  // A bucket can be dropped once the end of its span is at or before the
+  // cutoff.
+  const absl::Time last_start = BucketStart(cutoff) - bucket_width_;
+  int64_t records_dropped = 0;
+  for (auto partition_it = data_table->partitions.begin();
+       partition_it != data_table->partitions.end();) {
+    Partition& partition = partition_it->second;
+    auto bucket_end = partition.upper_bound(last_start);
+    for (auto bucket_it = partition.begin(); bucket_it != bucket_end;
+         ++bucket_it) {
+      records_dropped += bucket_it->second.size();
+    }
+    partition.erase(partition.begin(), bucket_end);
+    if (partition.empty()) {
+      data_table->partitions.erase(partition_it++);
+    } else {
+      ++partition_it;
+    }
+  }
+  data_table->truncated_before =
+      std::max(data_table->truncated_before, last_start + bucket_width_);
+  return records_dropped;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
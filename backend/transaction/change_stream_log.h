@@ -0,0 +1,151 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_CHANGE_STREAM_LOG_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_CHANGE_STREAM_LOG_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/access/read.h"
+#include "backend/actions/ops.h"
+#include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/schema/catalog/table.h"
+#include "common/limits.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Number of log buckets spanning the minimum change stream retention period.
+// Retention truncation drops whole buckets, so records are kept for at most
+// this fraction of the minimum retention period past their retention.
+constexpr int kChangeStreamLogBucketsPerMinRetention = 24;
+
+// Default time span of the commit timestamps of a log bucket.
+constexpr absl::Duration kDefaultChangeStreamLogBucketWidth =
+    absl::Seconds(limits::kChangeStreamsMinRetention /
+                  kChangeStreamLogBucketsPerMinRetention);
+
+// ChangeStreamLog holds the data change records of the change streams of a
+// database, ordered by commit timestamp.
+//
+// The records of each partition of a change stream data table are appended to
+// a sequence of buckets, each covering a fixed span of commit timestamps.
+// Change stream partition queries read a commit timestamp range of their
+// partition by binary search, without a range read over the data table and a
+// sort of the result. Records which fall out of the retention period of their
+// change stream are dropped a whole bucket at a time, as new buckets are
+// started.
+//
+// Records are appended as their transactions commit, in addition to being
+// written to the data table in storage, which still serves queries over
+// timestamps the log no longer covers.
+//
+// This class is thread-safe.
+class ChangeStreamLog {
+ public:
+  explicit ChangeStreamLog(
+      absl::Duration bucket_width = kDefaultChangeStreamLogBucketWidth);
+
+  // Appends the inserts of `write_ops` into change stream data tables, which
+  // have committed at `commit_timestamp`. Other write ops are ignored.
+  void AppendCommit(const std::vector<WriteOp>& write_ops,
+                    absl::Time commit_timestamp) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns a cursor over the records of `partition_token` in `data_table`
+  // with a commit timestamp in [start, end), or in [start, end] if
+  // `inclusive_end` is true, in primary key order. The cursor returns all the
+  // columns of `data_table`. Sets `num_rows` to the number of records.
+  std::unique_ptr<RowCursor> Read(const Table* data_table,
+                                  const std::string& partition_token,
+                                  absl::Time start, absl::Time end,
+                                  bool inclusive_end, int64_t* num_rows) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the timestamp before which records of `data_table` may have been
+  // truncated. Reads starting before it may be incomplete.
+  absl::Time TruncatedBefore(const TableID& data_table_id) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Drops the buckets of `data_table_id` which only cover commit timestamps
+  // before `cutoff`. Returns the number of records dropped.
+  int64_t Truncate(const TableID& data_table_id, absl::Time cutoff)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Drops the records of all data tables committed after `timestamp`, e.g.
+  // when the database is reset to `timestamp`.
+  void DiscardAfter(absl::Time timestamp) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // A data change record, along with its data table key.
+  struct Record {
+    Key key;
+    std::vector<zetasql::Value> values;
+  };
+
+  // The records of a partition whose commit timestamps fall in the span of a
+  // bucket, in key order.
+  using Bucket = std::vector<Record>;
+
+  // The buckets of a partition, keyed by the start of their span.
+  using Partition = std::map<absl::Time, Bucket>;
+
+  // The records of a data table.
+  struct DataTable {
+    absl::flat_hash_map<std::string, Partition> partitions;
+
+    // Start of the latest bucket of any partition of the table.
+    absl::Time latest_bucket_start = absl::InfinitePast();
+
+    // See TruncatedBefore().
+    absl::Time truncated_before = absl::InfinitePast();
+  };
+
+  // Returns the start of the span of the bucket containing `timestamp`.
+  absl::Time BucketStart(absl::Time timestamp) const;
+
+  // Appends a single insert into a data table, truncating the data table if
+  // the insert starts a new bucket.
+  void AppendLocked(const InsertOp& op, absl::Time commit_timestamp)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  int64_t TruncateLocked(DataTable* data_table, absl::Time cutoff)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const absl::Duration bucket_width_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<TableID, DataTable> data_tables_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_CHANGE_STREAM_LOG_H_
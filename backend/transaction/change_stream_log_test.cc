@@ -0,0 +1,225 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "backend/transaction/change_stream_log.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "backend/access/read.h"
+#include "backend/actions/ops.h"
+#include "backend/datamodel/key.h"
+#include "backend/schema/catalog/change_stream.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/table.h"
+#include "common/constants.h"
+#include "tests/common/schema_constructor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::Value;
+
+class ChangeStreamLogTest : public testing::Test {
+ protected:
+  ChangeStreamLogTest()
+      : schema_(test::CreateSchemaWithOneTableAndOneChangeStream(
+            &type_factory_)),
+        data_table_(schema_->FindChangeStream("change_stream_test_table")
+                        ->change_stream_data_table()) {}
+
+  // Returns an insert of a data change record into the data table. Columns
+  // other than the primary key columns are left unset.
+  InsertOp DataRecordInsert(const std::string& partition_token,
+                            absl::Time commit_timestamp,
+                            const std::string& record_sequence) {
+    std::vector<Value> values = {
+        Value::String(partition_token), Value::Timestamp(commit_timestamp),
+        Value::String("transaction"), Value::String(record_sequence)};
+    Key key(values);
+    std::vector<const Column*> columns(data_table_->columns().begin(),
+                                       data_table_->columns().begin() + 4);
+    return InsertOp{data_table_, key, columns, values};
+  }
+
+  // Returns the commit timestamps and record sequences read from `log`.
+  std::vector<std::pair<absl::Time, std::string>> ReadRecords(
+      const ChangeStreamLog& log, const std::string& partition_token,
+      absl::Time start, absl::Time end, bool inclusive_end) {
+    int64_t num_rows = 0;
+    std::unique_ptr<RowCursor> cursor = log.Read(
+        data_table_, partition_token, start, end, inclusive_end, &num_rows);
+    std::vector<std::pair<absl::Time, std::string>> records;
+    while (cursor->Next()) {
+      records.emplace_back(cursor->ColumnValue(1).ToTime(),
+                           cursor->ColumnValue(3).string_value());
+    }
+    EXPECT_EQ(num_rows, records.size());
+    return records;
+  }
+
+  zetasql::TypeFactory type_factory_;
+  std::unique_ptr<const Schema> schema_;
+  const Table* data_table_;
+  const absl::Time t0_ = absl::FromUnixSeconds(1699999200);
+};
+
+TEST_F(ChangeStreamLogTest, ReadsCommitTimestampRangeOfPartition) {
+  ChangeStreamLog log;
+  log.AppendCommit({DataRecordInsert("token", t0_, "0")}, t0_);
+  log.AppendCommit({DataRecordInsert("token", t0_ + absl::Seconds(1), "0"),
+                    DataRecordInsert("other_token", t0_ + absl::Seconds(1),
+                                     "1")},
+                   t0_ + absl::Seconds(1));
+  log.AppendCommit({DataRecordInsert("token", t0_ + absl::Seconds(2), "0")},
+                   t0_ + absl::Seconds(2));
+
+  using Records = std::vector<std::pair<absl::Time, std::string>>;
+  EXPECT_EQ(ReadRecords(log, "token", t0_ + absl::Seconds(1),
+                        t0_ + absl::Seconds(2), /*inclusive_end=*/false),
+            (Records{{t0_ + absl::Seconds(1), "0"}}));
+  EXPECT_EQ(ReadRecords(log, "token", t0_ + absl::Seconds(1),
+                        t0_ + absl::Seconds(2), /*inclusive_end=*/true),
+            (Records{{t0_ + absl::Seconds(1), "0"},
+                     {t0_ + absl::Seconds(2), "0"}}));
+  EXPECT_EQ(ReadRecords(log, "other_token", t0_, absl::InfiniteFuture(),
+                        /*inclusive_end=*/false),
+            (Records{{t0_ + absl::Seconds(1), "1"}}));
+  EXPECT_TRUE(ReadRecords(log, "unknown_token", t0_, absl::InfiniteFuture(),
+                          /*inclusive_end=*/false)
+                  .empty());
+}
+
+TEST_F(ChangeStreamLogTest, ReadsRecordsInKeyOrderAcrossBuckets) {
+  ChangeStreamLog log(absl::Minutes(1));
+  const absl::Time t1 = t0_ + absl::Minutes(5);
+  log.AppendCommit(
+      {DataRecordInsert("token", t1, "1"), DataRecordInsert("token", t1, "0")},
+      t1);
+  // A commit with an earlier timestamp landing later still reads in order.
+  log.AppendCommit({DataRecordInsert("token", t0_, "0")}, t0_);
+
+  using Records = std::vector<std::pair<absl::Time, std::string>>;
+  EXPECT_EQ(ReadRecords(log, "token", t0_, t1, /*inclusive_end=*/true),
+            (Records{{t0_, "0"}, {t1, "0"}, {t1, "1"}}));
+  EXPECT_EQ(ReadRecords(log, "token", t0_ + absl::Seconds(1), t1,
+                        /*inclusive_end=*/true),
+            (Records{{t1, "0"}, {t1, "1"}}));
+}
+
+TEST_F(ChangeStreamLogTest, ResolvesPendingCommitTimestamps) {
+  ChangeStreamLog log;
+  log.AppendCommit(
+      {DataRecordInsert("token", kCommitTimestampValueSentinel, "0")}, t0_);
+
+  int64_t num_rows = 0;
+  std::unique_ptr<RowCursor> cursor =
+      log.Read(data_table_, "token", t0_, t0_, /*inclusive_end=*/true,
+               &num_rows);
+  ASSERT_TRUE(cursor->Next());
+  EXPECT_EQ(cursor->NumColumns(), data_table_->columns().size());
+  EXPECT_EQ(cursor->ColumnName(1), "commit_timestamp");
+  EXPECT_EQ(cursor->ColumnValue(1), Value::Timestamp(t0_));
+  EXPECT_TRUE(cursor->ColumnValue(4).is_null());
+  EXPECT_FALSE(cursor->Next());
+}
+
+TEST_F(ChangeStreamLogTest, IgnoresWritesToOtherTables) {
+  ChangeStreamLog log;
+  const Table* table = schema_->FindTable("test_table");
+  log.AppendCommit({InsertOp{table, Key({Value::Int64(1)}),
+                             {table->FindColumn("int64_col")},
+                             {Value::Int64(1)}}},
+                   t0_);
+  EXPECT_EQ(log.Truncate(table->id(), absl::InfiniteFuture()), 0);
+}
+
+TEST_F(ChangeStreamLogTest, TruncatesOnlyBucketsOutOfRetention) {
+  ChangeStreamLog log(absl::Hours(1));
+  log.AppendCommit({DataRecordInsert("token", t0_, "0"),
+                    DataRecordInsert("token", t0_ + absl::Hours(1), "0")},
+                   t0_);
+
+  // Neither bucket ends by the cutoff.
+  EXPECT_EQ(log.Truncate(data_table_->id(), t0_ + absl::Minutes(30)), 0);
+  EXPECT_EQ(log.TruncatedBefore(data_table_->id()), absl::InfinitePast());
+
+  // Only the first bucket ends by the cutoff.
+  EXPECT_EQ(log.Truncate(data_table_->id(), t0_ + absl::Hours(1)), 1);
+  EXPECT_EQ(log.TruncatedBefore(data_table_->id()), t0_ + absl::Hours(1));
+  EXPECT_EQ(ReadRecords(log, "token", absl::InfinitePast(),
+                        absl::InfiniteFuture(), /*inclusive_end=*/false)
+                .size(),
+            1);
+}
+
+TEST_F(ChangeStreamLogTest, DiscardsRecordsCommittedAfterTimestamp) {
+  ChangeStreamLog log(absl::Minutes(1));
+  const absl::Time t1 = t0_ + absl::Seconds(30);
+  const absl::Time t2 = t0_ + absl::Minutes(5);
+  log.AppendCommit({DataRecordInsert("token", t0_, "0")}, t0_);
+  log.AppendCommit({DataRecordInsert("token", t1, "0"),
+                    DataRecordInsert("other_token", t1, "0")},
+                   t1);
+  log.AppendCommit({DataRecordInsert("token", t2, "0")}, t2);
+
+  log.DiscardAfter(t0_);
+  using Records = std::vector<std::pair<absl::Time, std::string>>;
+  EXPECT_EQ(ReadRecords(log, "token", absl::InfinitePast(),
+                        absl::InfiniteFuture(), /*inclusive_end=*/false),
+            (Records{{t0_, "0"}}));
+  EXPECT_TRUE(ReadRecords(log, "other_token", absl::InfinitePast(),
+                          absl::InfiniteFuture(), /*inclusive_end=*/false)
+                  .empty());
+}
+
+TEST_F(ChangeStreamLogTest, TruncatesByRetentionWhenStartingNewBucket) {
+  ChangeStreamLog log(absl::Hours(1));
+  log.AppendCommit({DataRecordInsert("token", t0_, "0"),
+                    DataRecordInsert("other_token", t0_, "0")},
+                   t0_);
+
+  // The data table's change stream has the default retention of one day.
+  const absl::Time t1 = t0_ + absl::Hours(25);
+  log.AppendCommit({DataRecordInsert("token", t1, "0")}, t1);
+
+  EXPECT_GT(log.TruncatedBefore(data_table_->id()), t0_);
+  EXPECT_EQ(ReadRecords(log, "token", absl::InfinitePast(),
+                        absl::InfiniteFuture(), /*inclusive_end=*/false)
+                .size(),
+            1);
+  EXPECT_TRUE(ReadRecords(log, "other_token", absl::InfinitePast(),
+                          absl::InfiniteFuture(), /*inclusive_end=*/false)
+                  .empty());
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -17,6 +17,7 @@
 #include "backend/transaction/commit_timestamp.h"
 
 #include <queue>
+#include <utility>
 #include <variant>
 
 #include "absl/log/check.h"
@@ -166,14 +167,13 @@ absl::Status ValidateCommitTimestampKeySetForDeleteOp(const Table* table,
 }
 
 absl::StatusOr<ValueList> MaybeSetCommitTimestampSentinel(
-    absl::Span<const Column* const> columns, const ValueList& row) {
-  if (row.empty()) return row;
-  ValueList ret_val;
+    absl::Span<const Column* const> columns, ValueList row) {
+  // The values are replaced in place, so that rows are not copied.
   for (int i = 0; i < row.size(); i++) {
-    ZETASQL_ASSIGN_OR_RETURN(ret_val.emplace_back(),
-                     MaybeSetCommitTimestampSentinel(columns[i], row[i]));
+    ZETASQL_ASSIGN_OR_RETURN(row[i], MaybeSetCommitTimestampSentinel(
+                                 columns[i], std::move(row[i])));
   }
-  return ret_val;
+  return row;
 }
 
 absl::StatusOr<KeyRange> MaybeSetCommitTimestampSentinel(
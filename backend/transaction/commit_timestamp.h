@@ -47,7 +47,7 @@ absl::Status ValidateCommitTimestampKeySetForDeleteOp(const Table* table,
 // or read commit timestamp atomically in a timestamp column or timestamp key
 // column with allow_commit_timestamp set to true.
 absl::StatusOr<ValueList> MaybeSetCommitTimestampSentinel(
-    absl::Span<const Column* const> columns, const ValueList& row);
+    absl::Span<const Column* const> columns, ValueList row);
 
 absl::StatusOr<KeyRange> MaybeSetCommitTimestampSentinel(
     absl::Span<const KeyColumn* const> primary_key, const KeyRange& key_range);
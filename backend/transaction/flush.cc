@@ -16,10 +16,24 @@
 
 #include "backend/transaction/flush.h"
 
+#include <utility>
+#include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "backend/common/rows.h"
 #include "backend/common/variant.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/index.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/storage/storage.h"
+#include "backend/storage/write_ahead_log.pb.h"
 #include "backend/transaction/commit_timestamp.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
@@ -28,60 +42,170 @@ namespace backend {
 
 namespace {
 
-absl::Status FlushInsert(const InsertOp& insert_op, Storage* base_storage,
-                         absl::Time commit_timestamp) {
-  const Table* table = insert_op.table;
-  const Key key = MaybeSetCommitTimestamp(table->primary_key(), insert_op.key,
-                                          commit_timestamp);
-  std::vector<ColumnID> column_ids;
-  ValueList column_values;
-  for (int i = 0; i < insert_op.columns.size(); i++) {
-    column_ids.push_back(insert_op.columns[i]->id());
-    column_values.push_back(MaybeSetCommitTimestamp(
-        insert_op.columns[i], insert_op.values[i], commit_timestamp));
+// The columns of a table which may hold pending commit timestamps, computed
+// once per table in a flush since most tables have none.
+struct CommitTimestampColumns {
+  // Positions of such columns in the primary key.
+  std::vector<int> key_positions;
+  // True if any column of the table, including key columns, allows commit
+  // timestamps.
+  bool has_columns = false;
+};
+
+bool AllowsCommitTimestamp(const Column* column) {
+  return column->allows_commit_timestamp() ||
+         (column->source_column() != nullptr &&
+          column->source_column()->allows_commit_timestamp());
+}
+
+CommitTimestampColumns FindCommitTimestampColumns(const Table* table) {
+  CommitTimestampColumns result;
+  for (int i = 0; i < table->primary_key().size(); ++i) {
+    if (AllowsCommitTimestamp(table->primary_key()[i]->column())) {
+      result.key_positions.push_back(i);
+    }
   }
-  return base_storage->Write(commit_timestamp, table->id(), key, column_ids,
-                             column_values);
+  result.has_columns = absl::c_any_of(table->columns(), AllowsCommitTimestamp);
+  return result;
 }
 
-absl::Status FlushUpdate(const UpdateOp& update_op, Storage* base_storage,
-                         absl::Time commit_timestamp) {
-  const Table* table = update_op.table;
-  const Key key = MaybeSetCommitTimestamp(table->primary_key(), update_op.key,
-                                          commit_timestamp);
-  std::vector<ColumnID> column_ids;
-  ValueList column_values;
-  for (int i = 0; i < update_op.columns.size(); i++) {
-    column_ids.push_back(update_op.columns[i]->id());
-    column_values.push_back(MaybeSetCommitTimestamp(
-        update_op.columns[i], update_op.values[i], commit_timestamp));
+// Replaces the pending commit timestamps in the key columns at
+// `key_positions` of `key`. Since user-provided commit timestamps are never
+// in the future, the rewritten keys keep their order relative to the other
+// keys of the table, so the writes remain sorted for storage.
+void SetCommitTimestampInKey(const Table* table,
+                             absl::Span<const int> key_positions,
+                             absl::Time commit_timestamp, Key* key) {
+  for (int i : key_positions) {
+    if (i < key->NumColumns() &&
+        IsPendingCommitTimestamp(table->primary_key()[i]->column(),
+                                 key->ColumnValue(i))) {
+      key->SetColumnValue(i, zetasql::values::Timestamp(commit_timestamp));
+    }
   }
-  return base_storage->Write(commit_timestamp, table->id(), key, column_ids,
-                             column_values);
 }
 
-absl::Status FlushDelete(const DeleteOp& delete_op, Storage* base_storage,
-                         absl::Time commit_timestamp) {
-  return base_storage->Delete(commit_timestamp, delete_op.table->id(),
-                              KeyRange::Point(delete_op.key));
+// Adds an entry for a row of `table` to `wal_commit`. Returns nullptr if
+// `wal_commit` is null or rows of `table` are not logged. Change stream tables
+// are not logged, matching database snapshots.
+absl::StatusOr<WalRecord::Write*> AddWalWrite(const Table* table,
+                                            const Key& key,
+                                            WalRecord::Commit* wal_commit) {
+  if (wal_commit == nullptr || table->owner_change_stream() != nullptr) {
+    return nullptr;
+  }
+  WalRecord::Write* write = wal_commit->add_writes();
+  if (table->owner_index() != nullptr) {
+    write->set_index_name(table->owner_index()->Name());
+  } else {
+    write->set_table_name(table->Name());
+  }
+  for (int i = 0; i < key.NumColumns(); ++i) {
+    ZETASQL_RETURN_IF_ERROR(key.ColumnValue(i).Serialize(write->add_key()));
+    write->add_key_descending(key.IsColumnDescending(i));
+    write->add_key_nulls_last(key.IsColumnNullsLast(i));
+  }
+  return write;
+}
+
+// Appends the write of the row of `op` to `writes`, with pending commit
+// timestamps resolved, and logs it to `wal_commit`. The key and values of `op`
+// are moved into the write, unless the change stream log reads them once they
+// have been flushed.
+template <typename OpT>
+absl::Status PrepareInsertOrUpdate(
+    OpT& op, const CommitTimestampColumns& commit_timestamp_columns,
+    absl::Time commit_timestamp, WalRecord::Commit* wal_commit,
+    std::vector<StorageWrite>* writes) {
+  const Table* table = op.table;
+  const bool keep_op = table->owner_change_stream() != nullptr;
+  StorageWrite& write = writes->emplace_back();
+  write.kind = StorageWrite::Kind::kWrite;
+  write.timestamp = commit_timestamp;
+  write.table_id = table->id();
+  write.key = keep_op ? op.key : std::move(op.key);
+  write.column_ids = GetColumnIDs(op.columns);
+  write.values = keep_op ? op.values : std::move(op.values);
+  if (commit_timestamp_columns.has_columns) {
+    SetCommitTimestampInKey(table, commit_timestamp_columns.key_positions,
+                            commit_timestamp, &write.key);
+    for (int i = 0; i < op.columns.size(); i++) {
+      if (IsPendingCommitTimestamp(op.columns[i], write.values[i])) {
+        write.values[i] = zetasql::values::Timestamp(commit_timestamp);
+      }
+    }
+  }
+  ZETASQL_ASSIGN_OR_RETURN(WalRecord::Write * wal_write,
+                   AddWalWrite(table, write.key, wal_commit));
+  if (wal_write != nullptr) {
+    for (int i = 0; i < op.columns.size(); i++) {
+      wal_write->add_column_names(op.columns[i]->Name());
+      ZETASQL_RETURN_IF_ERROR(write.values[i].Serialize(wal_write->add_values()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status PrepareDelete(const DeleteOp& delete_op,
+                           absl::Time commit_timestamp,
+                           WalRecord::Commit* wal_commit,
+                           std::vector<StorageWrite>* writes) {
+  ZETASQL_ASSIGN_OR_RETURN(WalRecord::Write * wal_write,
+                   AddWalWrite(delete_op.table, delete_op.key, wal_commit));
+  if (wal_write != nullptr) {
+    wal_write->set_is_delete(true);
+  }
+  StorageWrite& write = writes->emplace_back();
+  write.kind = StorageWrite::Kind::kDelete;
+  write.timestamp = commit_timestamp;
+  write.table_id = delete_op.table->id();
+  write.key_range = KeyRange::Point(delete_op.key);
+  return absl::OkStatus();
 }
 
 }  // namespace
 
-absl::Status FlushWriteOpsToStorage(const std::vector<WriteOp>& write_ops,
-                                    Storage* base_storage,
-                                    absl::Time commit_timestamp) {
-  for (const auto& write_op : write_ops) {
+absl::Status PrepareWriteOpsForStorage(std::vector<WriteOp>* write_ops,
+                                       absl::Time commit_timestamp,
+                                       WalRecord::Commit* wal_commit,
+                                       std::vector<StorageWrite>* writes) {
+  writes->reserve(writes->size() + write_ops->size());
+  // Write ops are grouped by table, so the commit timestamp columns of the
+  // last table seen are usually the ones needed.
+  absl::flat_hash_map<const Table*, CommitTimestampColumns>
+      commit_timestamp_columns_by_table;
+  const Table* last_table = nullptr;
+  const CommitTimestampColumns* commit_timestamp_columns = nullptr;
+  auto columns_of = [&](const Table* table) -> const CommitTimestampColumns& {
+    if (table != last_table) {
+      auto [itr, inserted] = commit_timestamp_columns_by_table.try_emplace(
+          table, CommitTimestampColumns());
+      if (inserted) {
+        itr->second = FindCommitTimestampColumns(table);
+      }
+      last_table = table;
+      commit_timestamp_columns = &itr->second;
+    }
+    return *commit_timestamp_columns;
+  };
+  for (WriteOp& write_op : *write_ops) {
     ZETASQL_RETURN_IF_ERROR(std::visit(
         overloaded{
-            [&](const InsertOp& insert_op) {
-              return FlushInsert(insert_op, base_storage, commit_timestamp);
+            [&](InsertOp& insert_op) {
+              return PrepareInsertOrUpdate(insert_op,
+                                           columns_of(insert_op.table),
+                                           commit_timestamp, wal_commit,
+                                           writes);
             },
-            [&](const UpdateOp& update_op) {
-              return FlushUpdate(update_op, base_storage, commit_timestamp);
+            [&](UpdateOp& update_op) {
+              return PrepareInsertOrUpdate(update_op,
+                                           columns_of(update_op.table),
+                                           commit_timestamp, wal_commit,
+                                           writes);
             },
             [&](const DeleteOp& delete_op) {
-              return FlushDelete(delete_op, base_storage, commit_timestamp);
+              return PrepareDelete(delete_op, commit_timestamp, wal_commit,
+                                   writes);
             },
         },
         write_op));
@@ -89,6 +213,25 @@ absl::Status FlushWriteOpsToStorage(const std::vector<WriteOp>& write_ops,
   return absl::OkStatus();
 }
 
+absl::Status FlushWriteOpsToStorage(std::vector<WriteOp> write_ops,
+                                    Storage* base_storage,
+                                    absl::Time commit_timestamp,
+                                    WriteAheadLog* write_ahead_log,
+                                    WriteAheadLog::Sequence* wal_sequence) {
+  WalRecord wal_record;
+  WalRecord::Commit* wal_commit =
+      write_ahead_log != nullptr ? wal_record.mutable_commit() : nullptr;
+  std::vector<StorageWrite> writes;
+  ZETASQL_RETURN_IF_ERROR(PrepareWriteOpsForStorage(
+      &write_ops, commit_timestamp, wal_commit, &writes));
+  ZETASQL_RETURN_IF_ERROR(base_storage->Apply(absl::MakeSpan(writes)));
+  if (write_ahead_log != nullptr && wal_commit->writes_size() > 0) {
+    wal_record.set_timestamp_micros(absl::ToUnixMicros(commit_timestamp));
+    ZETASQL_ASSIGN_OR_RETURN(*wal_sequence, write_ahead_log->Append(wal_record));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
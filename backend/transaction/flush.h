@@ -17,22 +17,47 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_FLUSH_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_FLUSH_H_
 
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "backend/actions/ops.h"
+#include "backend/storage/storage.h"
+#include "backend/storage/write_ahead_log.h"
+#include "backend/storage/write_ahead_log.pb.h"
 
 namespace google {
 namespace spanner {
 namespace emulator {
 namespace backend {
 
-// TODO : Add support to write multiple ops to base storage
-// atomically.
-
 // Flushes each of the write ops to base storage at the given timestamp. Note
 // that calling this function isn't thread safe and appropriate database locks
-// should be acquired.
-absl::Status FlushWriteOpsToStorage(const std::vector<WriteOp>& write_ops,
-                                    Storage* base_storage,
-                                    absl::Time commit_timestamp);
+// should be acquired. Pass the ops as an rvalue to move their rows into
+// storage rather than copying them.
+//
+// If `write_ahead_log` is not null, the flushed rows are also appended to it as
+// a single commit record and `wal_sequence` is set to the sequence of that
+// record. Only the append happens here; the caller must sync the log before
+// acknowledging the commit.
+absl::Status FlushWriteOpsToStorage(
+    std::vector<WriteOp> write_ops, Storage* base_storage,
+    absl::Time commit_timestamp, WriteAheadLog* write_ahead_log = nullptr,
+    WriteAheadLog::Sequence* wal_sequence = nullptr);
+
+// Converts each of the write ops to a storage write at the given timestamp,
+// resolving pending commit timestamps, and appends them to `writes`. If
+// `wal_commit` is not null, the written rows are also logged to it. This lets
+// the ops of several transactions be applied to storage as a single batch.
+//
+// The keys and values of the ops are moved into the writes rather than
+// copied, except for the ops of change stream tables, which the change stream
+// log reads after the flush. Other ops are left in a valid but unspecified
+// state.
+absl::Status PrepareWriteOpsForStorage(std::vector<WriteOp>* write_ops,
+                                       absl::Time commit_timestamp,
+                                       WalRecord::Commit* wal_commit,
+                                       std::vector<StorageWrite>* writes);
 
 }  // namespace backend
 }  // namespace emulator
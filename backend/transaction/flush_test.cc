@@ -16,7 +16,9 @@
 
 #include "backend/transaction/flush.h"
 
+#include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -26,7 +28,9 @@
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "backend/actions/ops.h"
+#include "backend/common/rows.h"
 #include "backend/storage/in_memory_storage.h"
+#include "common/constants.h"
 #include "tests/common/schema_constructor.h"
 
 namespace google {
@@ -37,6 +41,7 @@ namespace {
 
 using zetasql::values::Int64;
 using zetasql::values::String;
+using zetasql::values::Timestamp;
 
 class FlushTest : public testing::Test {
  public:
@@ -132,6 +137,80 @@ TEST_F(FlushTest, CanFlushWriteOpsToStorage) {
                                              {Int64(3), String("value")}}));
 }
 
+TEST_F(FlushTest, CanFlushRunsOfInserts) {
+  absl::Time t0 = absl::Now();
+  ZETASQL_ASSERT_OK(Write(t0, Key({Int64(2)}), {Int64(2), String("value")}));
+
+  // Consecutive inserts with the same columns are loaded together, including
+  // around rows which already exist in base storage.
+  absl::Time t1 = t0 + absl::Seconds(1);
+  std::vector<WriteOp> write_ops;
+  for (int i : {1, 3, 4}) {
+    write_ops.push_back(InsertOp{table_,
+                                 Key({Int64(i)}),
+                                 {int64_col_, string_col_},
+                                 {Int64(i), String("new-value")}});
+  }
+  write_ops.push_back(InsertOp{table_, Key({Int64(5)}), {int64_col_},
+                               {Int64(5)}});
+  ZETASQL_ASSERT_OK(FlushWriteOpsToStorage(write_ops, storage_.get(), t1));
+
+  EXPECT_THAT(ReadAll(t1), IsOkAndHoldsRows({{Int64(1), String("new-value")},
+                                             {Int64(2), String("value")},
+                                             {Int64(3), String("new-value")},
+                                             {Int64(4), String("new-value")},
+                                             {Int64(5), zetasql::Value()}}));
+  EXPECT_THAT(ReadAll(t0), IsOkAndHoldsRows({{Int64(2), String("value")}}));
+}
+
+TEST_F(FlushTest, SetsPendingCommitTimestampsInKeysAndValues) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<const Schema> schema,
+      test::CreateSchemaFromDDL(
+          {
+              R"(
+                CREATE TABLE CommitTimestampTable (
+                  Int64Col  INT64 NOT NULL,
+                  KeyTsCol  TIMESTAMP NOT NULL
+                      OPTIONS (allow_commit_timestamp = true),
+                  TsCol     TIMESTAMP OPTIONS (allow_commit_timestamp = true),
+                ) PRIMARY KEY (Int64Col, KeyTsCol)
+              )"},
+          type_factory_.get()));
+  const Table* table = schema->FindTable("CommitTimestampTable");
+  std::vector<const Column*> columns = {table->FindColumn("Int64Col"),
+                                        table->FindColumn("KeyTsCol"),
+                                        table->FindColumn("TsCol")};
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  zetasql::Value pending = Timestamp(kCommitTimestampValueSentinel);
+
+  // Rows keyed by pending commit timestamps sort after, and are rewritten to
+  // sort after, rows keyed by earlier timestamps.
+  std::vector<WriteOp> write_ops;
+  for (auto [i, key_ts] : std::vector<std::pair<int64_t, zetasql::Value>>{
+           {1, Timestamp(t0)}, {1, pending}, {2, pending}}) {
+    write_ops.push_back(InsertOp{table,
+                                 Key({Int64(i), key_ts}),
+                                 columns,
+                                 {Int64(i), key_ts, pending}});
+  }
+  ZETASQL_ASSERT_OK(FlushWriteOpsToStorage(write_ops, storage_.get(), t1));
+
+  std::unique_ptr<StorageIterator> itr;
+  ZETASQL_ASSERT_OK(storage_->Read(t1, table->id(), KeyRange::All(),
+                           GetColumnIDs(columns), &itr));
+  std::vector<ValueList> rows;
+  while (itr->Next()) {
+    rows.push_back({itr->ColumnValue(0), itr->ColumnValue(1),
+                    itr->ColumnValue(2)});
+  }
+  EXPECT_THAT(rows, testing::ElementsAre(
+                        ValueList{Int64(1), Timestamp(t0), Timestamp(t1)},
+                        ValueList{Int64(1), Timestamp(t1), Timestamp(t1)},
+                        ValueList{Int64(2), Timestamp(t1), Timestamp(t1)}));
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
@@ -0,0 +1,140 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/transaction/group_committer.h"
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "backend/locking/handle.h"
+#include "backend/storage/storage.h"
+#include "backend/storage/write_ahead_log.h"
+#include "backend/storage/write_ahead_log.pb.h"
+#include "backend/transaction/flush.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+void GroupCommitter::Commit(CommitRequest* request) {
+  absl::MutexLock lock(&mu_);
+  queue_.push_back(request);
+  auto can_proceed = [this, request]() ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+    return request->done || !group_in_progress_;
+  };
+  while (true) {
+    mu_.Await(absl::Condition(&can_proceed));
+    if (request->done) {
+      return;
+    }
+
+    // Lead the next group, which includes `request`.
+    group_in_progress_ = true;
+    std::vector<CommitRequest*> group;
+    group.swap(queue_);
+    mu_.Unlock();
+    CommitGroup(group);
+    mu_.Lock();
+    for (CommitRequest* member : group) {
+      member->done = true;
+    }
+    group_in_progress_ = false;
+    ++num_groups_;
+  }
+}
+
+int64_t GroupCommitter::num_groups() const {
+  absl::MutexLock lock(&mu_);
+  return num_groups_;
+}
+
+void GroupCommitter::CommitGroup(const std::vector<CommitRequest*>& group) {
+  // Reserve the commit timestamps in order and convert the ops of each
+  // transaction to storage writes.
+  std::vector<CommitRequest*> reserved;
+  std::vector<WalRecord> wal_records(group.size());
+  std::vector<std::vector<StorageWrite>> writes(group.size());
+  for (int i = 0; i < group.size(); ++i) {
+    CommitRequest* request = group[i];
+    absl::StatusOr<absl::Time> commit_timestamp =
+        request->lock_handle->ReserveCommitTimestamp();
+    if (!commit_timestamp.ok()) {
+      request->status = commit_timestamp.status();
+      continue;
+    }
+    request->commit_timestamp = *commit_timestamp;
+    reserved.push_back(request);
+
+    WalRecord::Commit* wal_commit = request->write_ahead_log != nullptr
+                                        ? wal_records[i].mutable_commit()
+                                        : nullptr;
+    request->status = PrepareWriteOpsForStorage(
+        request->write_ops, request->commit_timestamp, wal_commit, &writes[i]);
+  }
+
+  // Flush the writes of each transaction with its own Storage::Apply call, so
+  // that a failed flush only fails the transaction whose writes it held and
+  // leaves the writes of the other members of the group in place.
+  for (int i = 0; i < group.size(); ++i) {
+    CommitRequest* request = group[i];
+    if (!request->status.ok()) {
+      continue;
+    }
+    request->status = storage_->Apply(absl::MakeSpan(writes[i]));
+    if (!request->status.ok()) {
+      continue;
+    }
+    WalRecord& wal_record = wal_records[i];
+    if (request->write_ahead_log != nullptr &&
+        wal_record.commit().writes_size() > 0) {
+      wal_record.set_timestamp_micros(
+          absl::ToUnixMicros(request->commit_timestamp));
+      absl::StatusOr<WriteAheadLog::Sequence> wal_sequence =
+          request->write_ahead_log->Append(wal_record);
+      if (!wal_sequence.ok()) {
+        request->status = wal_sequence.status();
+        continue;
+      }
+      request->wal_sequence = *wal_sequence;
+    }
+    if (request->on_flushed) {
+      request->on_flushed(request->commit_timestamp);
+    }
+  }
+
+  // Every reserved commit timestamp is released, even if the flush failed.
+  std::vector<LockHandle*> handles;
+  handles.reserve(reserved.size());
+  for (CommitRequest* request : reserved) {
+    handles.push_back(request->lock_handle);
+  }
+  absl::Status mark_status = lock_manager_->MarkCommitted(handles);
+  if (!mark_status.ok()) {
+    for (CommitRequest* request : reserved) {
+      request->status = mark_status;
+    }
+  }
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
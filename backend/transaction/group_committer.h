@@ -0,0 +1,122 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_GROUP_COMMITTER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_GROUP_COMMITTER_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/actions/ops.h"
+#include "backend/locking/handle.h"
+#include "backend/locking/manager.h"
+#include "backend/storage/storage.h"
+#include "backend/storage/write_ahead_log.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// A read-write transaction waiting to be committed by a GroupCommitter.
+struct CommitRequest {
+  // The lock handle of the transaction, through which its commit timestamp is
+  // reserved and its commit marked.
+  LockHandle* lock_handle = nullptr;
+
+  // The buffered ops of the transaction, flushed at its commit timestamp. The
+  // rows of the ops are moved into storage, except for those of change stream
+  // tables (see PrepareWriteOpsForStorage).
+  std::vector<WriteOp>* write_ops = nullptr;
+
+  // If not null, the flushed rows are appended to this log as a single commit
+  // record. The log is not synced.
+  WriteAheadLog* write_ahead_log = nullptr;
+
+  // If set, called with the commit timestamp once the ops have been flushed
+  // and before the commit is marked complete, e.g. to publish change records.
+  std::function<void(absl::Time)> on_flushed;
+
+  // Set once the request has been processed. A commit timestamp is only
+  // reserved (and the commit marked) if `status` is not an error returned by
+  // LockHandle::ReserveCommitTimestamp.
+  absl::Status status;
+  absl::Time commit_timestamp;
+  WriteAheadLog::Sequence wal_sequence = 0;
+
+  // True once the request has been processed. Guarded by the mutex of the
+  // GroupCommitter.
+  bool done = false;
+};
+
+// GroupCommitter flushes the commits of concurrently committing read-write
+// transactions to storage together.
+//
+// The first thread to commit while no group is in progress becomes the leader.
+// It takes all requests queued so far, reserves their commit timestamps in
+// order (so they are monotonic within the group), applies the writes of each
+// transaction with its own Storage::Apply call, so that a failed flush only
+// fails its own transaction, and marks all of the commits complete at once,
+// waking reads waiting on any of them together. Requests which arrive in the
+// meantime queue up for the next group, which one of them leads once the
+// current group is done.
+//
+// Transactions only commit concurrently if concurrent read-write transactions
+// are enabled; otherwise every group holds a single commit.
+//
+// This class is thread-safe.
+class GroupCommitter {
+ public:
+  GroupCommitter(Storage* storage, LockManager* lock_manager)
+      : storage_(storage), lock_manager_(lock_manager) {}
+
+  // Commits `request`, possibly along with the requests of other transactions,
+  // and blocks until it is processed.
+  void Commit(CommitRequest* request) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of groups committed so far.
+  int64_t num_groups() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Commits a group of requests taken from the queue by the leader.
+  void CommitGroup(const std::vector<CommitRequest*>& group)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  Storage* storage_;
+  LockManager* lock_manager_;
+
+  mutable absl::Mutex mu_;
+
+  // Requests waiting for the next group.
+  std::vector<CommitRequest*> queue_ ABSL_GUARDED_BY(mu_);
+
+  // True while a leader is committing a group.
+  bool group_in_progress_ ABSL_GUARDED_BY(mu_) = false;
+
+  int64_t num_groups_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_GROUP_COMMITTER_H_
@@ -0,0 +1,269 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/transaction/group_committer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "tests/common/proto_matchers.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "backend/actions/ops.h"
+#include "backend/common/ids.h"
+#include "backend/locking/handle.h"
+#include "backend/locking/manager.h"
+#include "backend/locking/request.h"
+#include "backend/storage/in_memory_storage.h"
+#include "backend/storage/storage.h"
+#include "common/clock.h"
+#include "common/config.h"
+#include "tests/common/schema_constructor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::String;
+
+// Storage whose Apply fails for any batch writing the row with key `fail_key`.
+class ApplyFailingStorage : public InMemoryStorage {
+ public:
+  explicit ApplyFailingStorage(int64_t fail_key) : fail_key_(fail_key) {}
+
+  absl::Status Apply(absl::Span<StorageWrite> writes) override {
+    for (const StorageWrite& write : writes) {
+      if (write.key == Key({Int64(fail_key_)})) {
+        return absl::InternalError("injected flush failure");
+      }
+    }
+    return InMemoryStorage::Apply(writes);
+  }
+
+ private:
+  const int64_t fail_key_;
+};
+
+class GroupCommitterTest : public testing::Test {
+ public:
+  GroupCommitterTest()
+      : type_factory_(std::make_unique<zetasql::TypeFactory>()),
+        schema_(test::CreateSchemaFromDDL(
+                    {
+                        R"(
+                          CREATE TABLE TestTable (
+                            Int64Col    INT64 NOT NULL,
+                            StringCol   STRING(MAX),
+                          ) PRIMARY KEY (Int64Col)
+                        )"},
+                    type_factory_.get())
+                    .value()),
+        table_(schema_->FindTable("TestTable")),
+        int64_col_(table_->FindColumn("Int64Col")),
+        string_col_(table_->FindColumn("StringCol")) {}
+
+ protected:
+  Clock clock_;
+  InMemoryStorage storage_;
+  LockManager lock_manager_ = LockManager(&clock_);
+  GroupCommitter committer_ = GroupCommitter(&storage_, &lock_manager_);
+
+  // The type factory must outlive the type objects that it has made.
+  std::unique_ptr<zetasql::TypeFactory> type_factory_;
+  std::unique_ptr<const Schema> schema_;
+
+  // Constants
+  const Table* table_;
+  const Column* int64_col_;
+  const Column* string_col_;
+
+  std::vector<WriteOp> InsertRow(int64_t key) {
+    return {InsertOp{table_,
+                     Key({Int64(key)}),
+                     {int64_col_, string_col_},
+                     {Int64(key), String("value")}}};
+  }
+
+  absl::StatusOr<std::vector<ValueList>> ReadAll(absl::Time timestamp) {
+    std::unique_ptr<StorageIterator> itr;
+    ZETASQL_RETURN_IF_ERROR(storage_.Read(timestamp, table_->id(), KeyRange::All(),
+                                  {int64_col_->id(), string_col_->id()},
+                                  &itr));
+
+    std::vector<ValueList> rows;
+    while (itr->Next()) {
+      rows.emplace_back();
+      for (int i = 0; i < itr->NumColumns(); i++) {
+        rows.back().push_back(itr->ColumnValue(i));
+      }
+    }
+    return rows;
+  }
+};
+
+TEST_F(GroupCommitterTest, CommitsSingleRequest) {
+  std::unique_ptr<LockHandle> handle = lock_manager_.CreateHandle(
+      TransactionID(1), /*try_abort_fn=*/nullptr, TransactionPriority(1));
+  std::vector<WriteOp> write_ops = InsertRow(1);
+  absl::Time flushed_timestamp;
+
+  CommitRequest request;
+  request.lock_handle = handle.get();
+  request.write_ops = &write_ops;
+  request.on_flushed = [&](absl::Time timestamp) {
+    flushed_timestamp = timestamp;
+  };
+  committer_.Commit(&request);
+
+  ZETASQL_ASSERT_OK(request.status);
+  EXPECT_TRUE(request.done);
+  EXPECT_EQ(flushed_timestamp, request.commit_timestamp);
+  EXPECT_EQ(committer_.num_groups(), 1);
+  EXPECT_THAT(ReadAll(request.commit_timestamp),
+              zetasql_base::testing::IsOkAndHolds(testing::ElementsAre(
+                  testing::ElementsAre(Int64(1), String("value")))));
+  EXPECT_THAT(ReadAll(request.commit_timestamp - absl::Nanoseconds(1)),
+              zetasql_base::testing::IsOkAndHolds(testing::IsEmpty()));
+}
+
+TEST_F(GroupCommitterTest, FailedReservationIsNotFlushed) {
+  std::unique_ptr<LockHandle> holder = lock_manager_.CreateHandle(
+      TransactionID(1), /*try_abort_fn=*/nullptr, TransactionPriority(1));
+  holder->EnqueueLock(
+      LockRequest(LockMode::kExclusive, table_->id(), KeyRange::All(), {}));
+  ZETASQL_ASSERT_OK(holder->Wait());
+
+  // With concurrent read-write transactions disabled, the lock held by the
+  // other transaction aborts the commit.
+  std::unique_ptr<LockHandle> handle = lock_manager_.CreateHandle(
+      TransactionID(2), /*try_abort_fn=*/nullptr, TransactionPriority(1));
+  std::vector<WriteOp> write_ops = InsertRow(1);
+  bool flushed = false;
+
+  CommitRequest request;
+  request.lock_handle = handle.get();
+  request.write_ops = &write_ops;
+  request.on_flushed = [&](absl::Time) { flushed = true; };
+  committer_.Commit(&request);
+
+  EXPECT_EQ(request.status.code(), absl::StatusCode::kAborted);
+  EXPECT_FALSE(flushed);
+  EXPECT_THAT(ReadAll(absl::InfiniteFuture()),
+              zetasql_base::testing::IsOkAndHolds(testing::IsEmpty()));
+}
+
+TEST_F(GroupCommitterTest, CommitsConcurrentRequests) {
+  config::set_concurrent_read_write_transactions_enabled(true);
+  constexpr int kNumThreads = 8;
+
+  std::vector<std::unique_ptr<LockHandle>> handles;
+  std::vector<std::vector<WriteOp>> write_ops;
+  std::vector<CommitRequest> requests(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i) {
+    handles.push_back(lock_manager_.CreateHandle(TransactionID(i + 1),
+                                                 /*try_abort_fn=*/nullptr,
+                                                 TransactionPriority(1)));
+    write_ops.push_back(InsertRow(i));
+    requests[i].lock_handle = handles[i].get();
+    requests[i].write_ops = &write_ops[i];
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([this, &requests, i]() {
+      committer_.Commit(&requests[i]);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  absl::Time last_commit_timestamp = absl::InfinitePast();
+  for (const CommitRequest& request : requests) {
+    ZETASQL_EXPECT_OK(request.status);
+    last_commit_timestamp =
+        std::max(last_commit_timestamp, request.commit_timestamp);
+  }
+  EXPECT_GE(committer_.num_groups(), 1);
+  EXPECT_LE(committer_.num_groups(), kNumThreads);
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<ValueList> rows,
+                       ReadAll(last_commit_timestamp));
+  EXPECT_EQ(rows.size(), kNumThreads);
+
+  config::set_concurrent_read_write_transactions_enabled(false);
+}
+
+TEST_F(GroupCommitterTest, FailedFlushOnlyFailsItsOwnRequest) {
+  config::set_concurrent_read_write_transactions_enabled(true);
+  constexpr int kNumThreads = 4;
+  ApplyFailingStorage storage(/*fail_key=*/0);
+  GroupCommitter committer(&storage, &lock_manager_);
+
+  std::vector<std::unique_ptr<LockHandle>> handles;
+  std::vector<std::vector<WriteOp>> write_ops;
+  std::vector<CommitRequest> requests(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i) {
+    handles.push_back(lock_manager_.CreateHandle(TransactionID(i + 1),
+                                                 /*try_abort_fn=*/nullptr,
+                                                 TransactionPriority(1)));
+    write_ops.push_back(InsertRow(i));
+    requests[i].lock_handle = handles[i].get();
+    requests[i].write_ops = &write_ops[i];
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&committer, &requests, i]() {
+      committer.Commit(&requests[i]);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  // Whether or not they were committed in the same group, the requests
+  // writing other rows succeed and their rows are in storage.
+  EXPECT_EQ(requests[0].status.code(), absl::StatusCode::kInternal);
+  for (int i = 1; i < kNumThreads; ++i) {
+    ZETASQL_ASSERT_OK(requests[i].status);
+    std::vector<std::optional<std::vector<zetasql::Value>>> rows;
+    ZETASQL_ASSERT_OK(storage.BatchLookup(requests[i].commit_timestamp,
+                                  table_->id(), {Key({Int64(i)})},
+                                  {int64_col_->id()}, &rows));
+    EXPECT_THAT(rows, testing::ElementsAre(testing::Optional(
+                          testing::ElementsAre(Int64(i)))));
+  }
+
+  config::set_concurrent_read_write_transactions_enabled(false);
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -16,6 +16,8 @@
 
 #include "backend/transaction/read_only_transaction.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -26,14 +28,18 @@
 #include "absl/time/time.h"
 #include "backend/access/read.h"
 #include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
 #include "backend/datamodel/key_set.h"
 #include "backend/locking/manager.h"
 #include "backend/storage/in_memory_iterator.h"
+#include "backend/storage/iterator.h"
 #include "backend/storage/storage.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/resolve.h"
 #include "backend/transaction/row_cursor.h"
 #include "common/clock.h"
+#include "common/constants.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -41,12 +47,6 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
-namespace {
-
-absl::Duration kMaxStaleReadDuration = absl::Hours(1);
-
-}  // namespace
-
 ReadOnlyTransaction::ReadOnlyTransaction(
     const ReadOnlyOptions& options, TransactionID transaction_id, Clock* clock,
     Storage* storage, LockManager* lock_manager,
@@ -68,48 +68,140 @@ absl::Status ReadOnlyTransaction::Read(const ReadArg& read_arg,
   absl::MutexLock lock(&mu_);
   // Wait for any concurrent schema change or read-write transactions to commit
   // before accessing database state to perform a read.
-  lock_handle_->WaitForSafeRead(read_timestamp_);
+  const Schema* read_schema = schema();
   if (clock_->Now() - read_timestamp_ >= kMaxStaleReadDuration) {
     return error::ReadTimestampPastVersionGCLimit(read_timestamp_);
   }
 
   ZETASQL_ASSIGN_OR_RETURN(const ResolvedReadArg resolved_read_arg,
-                   ResolveReadArg(read_arg, schema()));
+                   ResolveReadArg(read_arg, read_schema));
 
-  std::vector<std::unique_ptr<StorageIterator>> iterators;
-  for (const auto& key_range : resolved_read_arg.key_ranges) {
-    std::unique_ptr<StorageIterator> itr;
-    ZETASQL_RETURN_IF_ERROR(base_storage_->Read(
-        read_timestamp_, resolved_read_arg.table->id(), key_range,
-        GetColumnIDs(resolved_read_arg.columns), &itr));
-    iterators.push_back(std::move(itr));
+  // Walk all the key ranges of the read, which are sorted and disjoint, in a
+  // single pass over the table.
+  std::vector<std::unique_ptr<StorageIterator>> iterators(1);
+  if (read_arg.sample.has_value()) {
+    ZETASQL_RETURN_IF_ERROR(base_storage_->ReadSample(
+        read_timestamp_, resolved_read_arg.table->id(),
+        resolved_read_arg.key_ranges, GetColumnIDs(resolved_read_arg.columns),
+        *read_arg.sample, &iterators[0]));
+    if (read_arg.limit > 0) {
+      std::unique_ptr<StorageIterator> limited =
+          std::make_unique<LimitedStorageIterator>(std::move(iterators),
+                                                   read_arg.limit);
+      iterators.clear();
+      iterators.push_back(std::move(limited));
+    }
+  } else if (read_arg.limit > 0) {
+    ZETASQL_RETURN_IF_ERROR(base_storage_->ReadFirstRows(
+        read_timestamp_, resolved_read_arg.table->id(),
+        resolved_read_arg.key_ranges, GetColumnIDs(resolved_read_arg.columns),
+        read_arg.limit, &iterators[0]));
+  } else {
+    ZETASQL_RETURN_IF_ERROR(base_storage_->ReadRanges(
+        read_timestamp_, resolved_read_arg.table->id(),
+        resolved_read_arg.key_ranges, GetColumnIDs(resolved_read_arg.columns),
+        &iterators[0]));
   }
   *cursor = std::make_unique<StorageIteratorRowCursor>(
       std::move(iterators), resolved_read_arg.columns);
   return absl::OkStatus();
 }
 
+absl::Status ReadOnlyTransaction::ReadSplits(
+    const ReadArg& read_arg, int64_t rows_per_split,
+    std::vector<std::unique_ptr<RowCursor>>* cursors) {
+  // A sample is drawn over the whole read, not over each split, and so is a
+  // limit.
+  if (!read_arg.index.empty() || read_arg.sample.has_value() ||
+      read_arg.limit > 0 ||
+      !read_arg.change_stream_for_data_table.empty() ||
+      !read_arg.change_stream_for_partition_table.empty()) {
+    return absl::OkStatus();
+  }
+  absl::MutexLock lock(&mu_);
+  const Schema* read_schema = schema();
+  if (clock_->Now() - read_timestamp_ >= kMaxStaleReadDuration) {
+    return error::ReadTimestampPastVersionGCLimit(read_timestamp_);
+  }
+
+  ZETASQL_ASSIGN_OR_RETURN(const ResolvedReadArg resolved_read_arg,
+                   ResolveReadArg(read_arg, read_schema));
+  const TableID table_id = resolved_read_arg.table->id();
+  const std::vector<ColumnID> column_ids =
+      GetColumnIDs(resolved_read_arg.columns);
+  auto add_split = [&](const KeyRange& split) -> absl::Status {
+    std::vector<std::unique_ptr<StorageIterator>> iterators(1);
+    ZETASQL_RETURN_IF_ERROR(base_storage_->Read(read_timestamp_, table_id, split,
+                                        column_ids, &iterators[0]));
+    cursors->push_back(std::make_unique<StorageIteratorRowCursor>(
+        std::move(iterators), resolved_read_arg.columns));
+    return absl::OkStatus();
+  };
+
+  // Cut each key range every `rows_per_split` keys of the snapshot.
+  rows_per_split = std::max<int64_t>(1, rows_per_split);
+  for (const auto& key_range : resolved_read_arg.key_ranges) {
+    std::unique_ptr<StorageIterator> keys;
+    ZETASQL_RETURN_IF_ERROR(
+        base_storage_->Read(read_timestamp_, table_id, key_range, {}, &keys));
+    Key start_key = key_range.start_key();
+    int64_t num_rows = 0;
+    while (keys->Next()) {
+      if (num_rows > 0 && num_rows % rows_per_split == 0) {
+        ZETASQL_RETURN_IF_ERROR(
+            add_split(KeyRange::ClosedOpen(start_key, keys->Key())));
+        start_key = keys->Key();
+      }
+      ++num_rows;
+    }
+    ZETASQL_RETURN_IF_ERROR(keys->Status());
+    ZETASQL_RETURN_IF_ERROR(
+        add_split(KeyRange::ClosedOpen(start_key, key_range.limit_key())));
+  }
+  return absl::OkStatus();
+}
+
+bool ReadOnlyTransaction::ReadsImmutableSnapshot() const {
+  return clock_->Now() - read_timestamp_ < kMaxStaleReadDuration &&
+         lock_manager_->IsSnapshotImmutable(read_timestamp_);
+}
+
 const Schema* ReadOnlyTransaction::schema() const {
+  const Schema* schema = pinned_schema_.load(std::memory_order_acquire);
+  if (schema != nullptr) {
+    return schema;
+  }
   // Wait for any concurrent schema change or read-write transactions to commit
   // before accessing database state to read schemas in versioned_catalog.
   lock_handle_->WaitForSafeRead(read_timestamp_);
-  return versioned_catalog_->GetSchema(read_timestamp_);
+  schema = versioned_catalog_->GetSchema(read_timestamp_);
+  pinned_schema_.store(schema, std::memory_order_release);
+  return schema;
 }
 
 absl::Time ReadOnlyTransaction::PickReadTimestamp() {
   auto get_random_stale_timestamp =
       [this](absl::Time min_timestamp) -> absl::Time {
+    // Reads at or before the safe read timestamp do not wait for the commits
+    // in progress, so the picked read timestamp is not newer than it unless
+    // the bound requires a newer one.
+    const absl::Time max_timestamp =
+        std::max(lock_manager_->SafeReadTimestamp(), min_timestamp);
     // Any reads performed on or before last_commit_timestamp are guaranteed to
     // see a consistent snapshots of all the commits that have already finished.
     // Thus, picked read timestamp need not be older than last_commit_timestamp.
     absl::Time last_commit_timestamp = lock_manager_->LastCommitTimestamp();
     if (min_timestamp < last_commit_timestamp) {
-      min_timestamp = last_commit_timestamp;
+      min_timestamp = std::min(last_commit_timestamp, max_timestamp);
+    }
+    const int64_t max_staleness =
+        absl::ToInt64Microseconds(max_timestamp - min_timestamp);
+    if (max_staleness <= 0) {
+      return max_timestamp;
     }
     absl::BitGen gen;
-    int64_t random_staleness = absl::Uniform<int64_t>(
-        gen, 0, absl::ToInt64Microseconds(clock_->Now() - min_timestamp));
-    return clock_->Now() - absl::Microseconds(random_staleness);
+    int64_t random_staleness = absl::Uniform<int64_t>(gen, 0, max_staleness);
+    return max_timestamp - absl::Microseconds(random_staleness);
   };
   switch (options_.bound) {
     case TimestampBound::kStrongRead: {
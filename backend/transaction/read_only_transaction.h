@@ -17,6 +17,7 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_READ_ONLY_TRANSACTION_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_READ_ONLY_TRANSACTION_H_
 
+#include <atomic>
 #include <memory>
 
 #include "absl/base/thread_annotations.h"
@@ -56,9 +57,23 @@ class ReadOnlyTransaction : public RowReader {
                     std::unique_ptr<RowCursor>* cursor) override
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Splits reads of tables by the keys of the snapshot. Reads of indexes and
+  // change streams are not split.
+  absl::Status ReadSplits(const ReadArg& read_arg, int64_t rows_per_split,
+                          std::vector<std::unique_ptr<RowCursor>>* cursors)
+      override ABSL_LOCKS_EXCLUDED(mu_);
+
   absl::Time read_timestamp() const { return read_timestamp_; }
 
-  // Returns the schema used by this transaction.
+  // Returns true if the data read by this transaction can no longer change, so
+  // that the results of its reads can be reused by other transactions reading
+  // at the same timestamp. This is false for reads past the version GC limit,
+  // which fail.
+  bool ReadsImmutableSnapshot() const;
+
+  // Returns the schema used by this transaction. The first call waits for the
+  // commits before the read timestamp and pins the schema, which later calls
+  // return without waiting again.
   const Schema* schema() const;
 
   // Returns the ID of this transaction.
@@ -95,6 +110,11 @@ class ReadOnlyTransaction : public RowReader {
 
   // The read timestamp picked by this transaction.
   absl::Time read_timestamp_;
+
+  // The schema at the read timestamp, once it is safe to read. Commits before
+  // the read timestamp cannot happen once it is safe, so it stays safe for all
+  // the later reads of the transaction.
+  mutable std::atomic<const Schema*> pinned_schema_ = nullptr;
 };
 
 }  // namespace backend
@@ -16,9 +16,13 @@
 
 #include "backend/transaction/read_only_transaction.h"
 
+#include <cstdint>
 #include <ctime>
+#include <memory>
+#include <vector>
 
 #include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
@@ -26,7 +30,12 @@
 #include "absl/status/status.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "backend/access/read.h"
 #include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/locking/handle.h"
+#include "backend/locking/manager.h"
 #include "backend/schema/catalog/schema.h"
 #include "backend/schema/catalog/versioned_catalog.h"
 #include "backend/storage/in_memory_storage.h"
@@ -96,6 +105,24 @@ TEST_F(ReadOnlyTransactionTest, MinTimestampSnapshotReadTimestamp) {
   EXPECT_LE(t0_, read_timestamp_);
 }
 
+TEST_F(ReadOnlyTransactionTest, MaxStalenessReadIsBeforePendingCommits) {
+  std::unique_ptr<LockHandle> writer = lock_manager_.CreateHandle(
+      TransactionID(2), /*abort_fn=*/nullptr, TransactionPriority(1));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(absl::Time commit_timestamp,
+                       writer->ReserveCommitTimestamp());
+
+  ReadOnlyOptions opts;
+  opts.bound = TimestampBound::kMaxStaleness;
+  opts.staleness = absl::Seconds(10);
+
+  // The read does not wait for the pending commit.
+  ReadOnlyTransaction txn(opts, txn_id_, &clock_, &storage_, &lock_manager_,
+                          &versioned_catalog_);
+  EXPECT_LT(txn.read_timestamp(), commit_timestamp);
+  EXPECT_NE(txn.schema(), nullptr);
+  ZETASQL_EXPECT_OK(writer->MarkCommitted());
+}
+
 TEST_F(ReadOnlyTransactionTest, ExactTimestampSnapshotReadTimestamp) {
   ReadOnlyOptions opts;
   opts.bound = TimestampBound::kExactTimestamp;
@@ -133,6 +160,35 @@ TEST_F(ReadOnlyTransactionTest, GetSchema) {
   EXPECT_EQ(txn2.schema()->FindTable("test_table"), nullptr);
 }
 
+TEST_F(ReadOnlyTransactionTest, PinsSchemaAtFirstUse) {
+  VersionedCatalog catalog;
+  zetasql::TypeFactory type_factory{};
+  ZETASQL_EXPECT_OK(
+      catalog.AddSchema(t0_, test::CreateSchemaWithOneTable(&type_factory)));
+
+  ReadOnlyOptions opts;
+  opts.bound = TimestampBound::kStrongRead;
+
+  ReadOnlyTransaction txn(opts, txn_id_, &clock_, &storage_, &lock_manager_,
+                          &catalog);
+  const Schema* schema = txn.schema();
+  ASSERT_NE(schema, nullptr);
+
+  // A schema change after the read timestamp is not seen by later reads.
+  ZETASQL_EXPECT_OK(catalog.AddSchema(
+      clock_.Now(), test::CreateSchemaWithOneTable(&type_factory)));
+  EXPECT_EQ(txn.schema(), schema);
+
+  ReadArg read_arg;
+  read_arg.table = "test_table";
+  read_arg.key_set = KeySet::All();
+  read_arg.columns = {"int64_col"};
+  std::unique_ptr<RowCursor> cursor;
+  ZETASQL_ASSERT_OK(txn.Read(read_arg, &cursor));
+  EXPECT_FALSE(cursor->Next());
+  EXPECT_EQ(txn.schema(), schema);
+}
+
 TEST_F(ReadOnlyTransactionTest, WaitsForFutureReadTime) {
   VersionedCatalog catalog;
   zetasql::TypeFactory type_factory{};
@@ -153,6 +209,87 @@ TEST_F(ReadOnlyTransactionTest, WaitsForFutureReadTime) {
   EXPECT_GE(clock_.Now(), opts.timestamp);
 }
 
+TEST_F(ReadOnlyTransactionTest, ReadReturnsRowsUpToLimit) {
+  VersionedCatalog catalog;
+  zetasql::TypeFactory type_factory{};
+  ZETASQL_EXPECT_OK(
+      catalog.AddSchema(t0_, test::CreateSchemaWithOneTable(&type_factory)));
+  const Table* table = catalog.GetSchema(t0_)->FindTable("test_table");
+  ASSERT_NE(table, nullptr);
+  const Column* column = table->FindColumn("int64_col");
+  for (int64_t k = 0; k < 10; ++k) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0_, table->id(),
+                             Key({zetasql::values::Int64(k)}), {column->id()},
+                             {zetasql::values::Int64(k)}));
+  }
+
+  ReadOnlyOptions opts;
+  opts.bound = TimestampBound::kStrongRead;
+  ReadOnlyTransaction txn(opts, txn_id_, &clock_, &storage_, &lock_manager_,
+                          &catalog);
+  ReadArg read_arg;
+  read_arg.table = "test_table";
+  read_arg.key_set = KeySet::All();
+  read_arg.columns = {"int64_col"};
+  read_arg.limit = 3;
+
+  std::unique_ptr<RowCursor> cursor;
+  ZETASQL_ASSERT_OK(txn.Read(read_arg, &cursor));
+  std::vector<int64_t> keys;
+  while (cursor->Next()) {
+    keys.push_back(cursor->ColumnValue(0).int64_value());
+  }
+  ZETASQL_EXPECT_OK(cursor->Status());
+  EXPECT_THAT(keys, testing::ElementsAre(0, 1, 2));
+}
+
+TEST_F(ReadOnlyTransactionTest, ReadSplits) {
+  VersionedCatalog catalog;
+  zetasql::TypeFactory type_factory{};
+  ZETASQL_EXPECT_OK(
+      catalog.AddSchema(t0_, test::CreateSchemaWithOneTable(&type_factory)));
+  const Table* table = catalog.GetSchema(t0_)->FindTable("test_table");
+  ASSERT_NE(table, nullptr);
+  const Column* column = table->FindColumn("int64_col");
+  for (int64_t k = 0; k < 10; ++k) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0_, table->id(),
+                             Key({zetasql::values::Int64(k)}), {column->id()},
+                             {zetasql::values::Int64(k)}));
+  }
+
+  ReadOnlyOptions opts;
+  opts.bound = TimestampBound::kStrongRead;
+  ReadOnlyTransaction txn(opts, txn_id_, &clock_, &storage_, &lock_manager_,
+                          &catalog);
+  ReadArg read_arg;
+  read_arg.table = "test_table";
+  read_arg.key_set = KeySet::All();
+  read_arg.columns = {"int64_col"};
+
+  // Each split holds at most 4 keys, and the splits are in key order.
+  std::vector<std::unique_ptr<RowCursor>> cursors;
+  ZETASQL_ASSERT_OK(txn.ReadSplits(read_arg, /*rows_per_split=*/4, &cursors));
+  ASSERT_EQ(cursors.size(), 3);
+  std::vector<int64_t> keys;
+  for (const std::unique_ptr<RowCursor>& cursor : cursors) {
+    int num_rows = 0;
+    while (cursor->Next()) {
+      keys.push_back(cursor->ColumnValue(0).int64_value());
+      ++num_rows;
+    }
+    ZETASQL_EXPECT_OK(cursor->Status());
+    EXPECT_LE(num_rows, 4);
+  }
+  EXPECT_THAT(keys, testing::ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+
+  // Reads of indexes are not split.
+  read_arg.index = "test_index";
+  read_arg.columns = {"string_col"};
+  cursors.clear();
+  ZETASQL_ASSERT_OK(txn.ReadSplits(read_arg, /*rows_per_split=*/4, &cursors));
+  EXPECT_TRUE(cursors.empty());
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
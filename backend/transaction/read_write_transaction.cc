@@ -16,10 +16,14 @@
 
 #include "backend/transaction/read_write_transaction.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <queue>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -35,6 +39,7 @@
 #include "absl/strings/cord.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "backend/access/read.h"
@@ -45,6 +50,7 @@
 #include "backend/actions/ops.h"
 #include "backend/common/ids.h"
 #include "backend/common/rows.h"
+#include "backend/common/sys_stats.h"
 #include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/datamodel/value.h"
@@ -54,12 +60,14 @@
 #include "backend/schema/catalog/schema.h"
 #include "backend/schema/catalog/table.h"
 #include "backend/schema/catalog/versioned_catalog.h"
+#include "backend/storage/in_memory_iterator.h"
 #include "backend/storage/iterator.h"
+#include "backend/storage/row_sampler.h"
 #include "backend/storage/storage.h"
 #include "backend/transaction/actions.h"
 #include "backend/transaction/commit_timestamp.h"
-#include "backend/transaction/flush.h"
 #include "backend/transaction/foreign_key_restrictions.h"
+#include "backend/transaction/group_committer.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/resolve.h"
 #include "backend/transaction/row_cursor.h"
@@ -69,8 +77,8 @@
 #include "common/config.h"
 #include "common/constants.h"
 #include "common/errors.h"
-#include "third_party/spanner_pg/interface/pg_arena.h"
-#include "third_party/spanner_pg/shims/memory_context_pg_arena.h"
+#include "common/metrics.h"
+#include "common/tracing.h"
 #include "zetasql/base/ret_check.h"
 #include "zetasql/base/status_macros.h"
 
@@ -81,6 +89,16 @@ namespace backend {
 
 namespace {
 
+// Latency of committing read-write transactions, including failed commits.
+metrics::Histogram* CommitLatency() {
+  static metrics::Histogram* histogram =
+      metrics::MetricRegistry::Global()->GetHistogram(
+          "emulator_commit_seconds",
+          "Latency of committing read-write transactions, in seconds.",
+          metrics::LatencyBuckets());
+  return histogram;
+}
+
 // Flattens delete mutation to one write op for each key being deleted.
 absl::StatusOr<std::vector<WriteOp>> FlattenDeleteOp(
     const Table* table, const std::vector<KeyRange>& key_ranges,
@@ -105,35 +123,32 @@ absl::StatusOr<std::vector<WriteOp>> FlattenDeleteOp(
 //   corresponding WriteOp of the same type.
 absl::StatusOr<std::vector<WriteOp>> FlattenNonDeleteOpRow(
     MutationOpType type, const Table* table,
-    const std::vector<const Column*>& columns, const Key& key,
-    const ValueList& row, const TransactionStore* transaction_store) {
+    const std::vector<const Column*>& columns, const Key& key, ValueList row,
+    const TransactionStore* transaction_store) {
   std::vector<WriteOp> write_ops;
   switch (type) {
     case MutationOpType::kInsert: {
-      write_ops.push_back(InsertOp{table, key, columns, row});
+      write_ops.push_back(InsertOp{table, key, columns, std::move(row)});
       break;
     }
     case MutationOpType::kUpdate: {
-      write_ops.push_back(UpdateOp{table, key, columns, row});
+      write_ops.push_back(UpdateOp{table, key, columns, std::move(row)});
       break;
     }
     case MutationOpType::kInsertOrUpdate: {
-      absl::StatusOr<ValueList> maybe_row =
-          transaction_store->Lookup(table, key,
-                                    /*columns= */ {});
-      if (maybe_row.ok()) {
+      ZETASQL_ASSIGN_OR_RETURN(bool exists,
+                       transaction_store->Exists(table, key));
+      if (exists) {
         // Row exists and therefore we should only update.
-        write_ops.push_back(UpdateOp{table, key, columns, row});
-      } else if (maybe_row.status().code() == absl::StatusCode::kNotFound) {
-        write_ops.push_back(InsertOp{table, key, columns, row});
+        write_ops.push_back(UpdateOp{table, key, columns, std::move(row)});
       } else {
-        return maybe_row.status();
+        write_ops.push_back(InsertOp{table, key, columns, std::move(row)});
       }
       break;
     }
     case MutationOpType::kReplace: {
       write_ops.push_back(DeleteOp{table, key});
-      write_ops.push_back(InsertOp{table, key, columns, row});
+      write_ops.push_back(InsertOp{table, key, columns, std::move(row)});
       break;
     }
     case MutationOpType::kDelete: {
@@ -156,37 +171,6 @@ RetryState MakeRetryState(const RetryState& retry_state, Clock* clock) {
   return state;
 }
 
-// Splits key_range into 2 parts by key with the key itself being removed. The
-// resulting key ranges are appended to range_list. Returns true if the key was
-// found within the given range, false otherwise.
-bool SplitKeyRangeAndAppend(const KeyRange& key_range, const Key& key,
-                            std::vector<KeyRange>* range_list) {
-  if (!key_range.Contains(key)) {
-    return false;
-  }
-
-  if (key == key_range.start_key() && key == key_range.limit_key()) {
-    // Range only contains the one key.
-    return true;
-  } else if (key == key_range.start_key()) {
-    range_list->push_back(KeyRange(EndpointType::kOpen, key,
-                                   key_range.limit_type(),
-                                   key_range.limit_key()));
-  } else if (key == key_range.limit_key()) {
-    range_list->push_back(KeyRange(key_range.start_type(),
-                                   key_range.start_key(), EndpointType::kOpen,
-                                   key));
-  } else {
-    range_list->push_back(KeyRange(key_range.start_type(),
-                                   key_range.start_key(), EndpointType::kOpen,
-                                   key));
-    range_list->push_back(KeyRange(EndpointType::kOpen, key,
-                                   key_range.limit_type(),
-                                   key_range.limit_key()));
-  }
-  return true;
-}
-
 absl::StatusOr<bool> IsMutationInvolvingForeignKeyAction(
     const MutationOp& mutation_op, const Schema* schema) {
   const Table* table = schema->FindTable(mutation_op.table);
@@ -210,16 +194,32 @@ ReadWriteTransaction::ReadWriteTransaction(
     const ReadWriteOptions& options, const RetryState& retry_state,
     TransactionID transaction_id, Clock* clock, Storage* storage,
     LockManager* lock_manager, const VersionedCatalog* const versioned_catalog,
-    ActionManager* action_manager)
+    ActionManager* action_manager, WriteAheadLog* write_ahead_log,
+    ChangeStreamCommitNotifier* change_stream_commit_notifier,
+    ChangeStreamLog* change_stream_log, GroupCommitter* group_committer,
+    TransactionStats* transaction_stats,
+    ActivePartitionTokenCache* partition_token_cache)
     : options_(options),
       retry_state_(MakeRetryState(retry_state, clock)),
       id_(transaction_id),
       clock_(clock),
       base_storage_(storage),
+      write_ahead_log_(write_ahead_log),
+      change_stream_commit_notifier_(change_stream_commit_notifier),
+      change_stream_log_(change_stream_log),
+      transaction_stats_(transaction_stats),
+      partition_token_cache_(partition_token_cache),
       versioned_catalog_(versioned_catalog),
       lock_handle_(lock_manager->CreateHandle(
           transaction_id, [&]() -> absl::Status { return TryAbort(); },
           retry_state_.priority)),
+      owned_group_committer_(
+          group_committer == nullptr
+              ? std::make_unique<GroupCommitter>(storage, lock_manager)
+              : nullptr),
+      group_committer_(group_committer == nullptr
+                           ? owned_group_committer_.get()
+                           : group_committer),
       commit_timestamp_tracker_(std::make_unique<CommitTimestampTracker>()),
       transaction_store_(std::make_unique<TransactionStore>(
           base_storage_, lock_handle_.get(), commit_timestamp_tracker_.get())),
@@ -248,6 +248,11 @@ absl::Status ReadWriteTransaction::Read(const ReadArg& read_arg,
 
     ZETASQL_ASSIGN_OR_RETURN(const ResolvedReadArg& resolved_read_arg,
                      ResolveReadArg(read_arg, schema_));
+    if (transaction_stats_ != nullptr) {
+      for (const Column* column : resolved_read_arg.columns) {
+        shape_.read_columns.insert(column->FullName());
+      }
+    }
 
     std::vector<std::unique_ptr<StorageIterator>> iterators;
     for (const auto& key_range : resolved_read_arg.key_ranges) {
@@ -257,30 +262,56 @@ absl::Status ReadWriteTransaction::Read(const ReadArg& read_arg,
           read_arg.allow_pending_commit_timestamps));
       iterators.push_back(std::move(itr));
     }
+    // The transaction store merges buffered mutations into each row it reads,
+    // so the sample is drawn from the merged rows.
+    if (read_arg.sample.has_value()) {
+      std::unique_ptr<StorageIterator> sampled =
+          std::make_unique<SampledStorageIterator>(std::move(iterators),
+                                                   *read_arg.sample);
+      iterators.clear();
+      iterators.push_back(std::move(sampled));
+    }
+    // Rows deleted by buffered mutations are only dropped as the base rows are
+    // merged, so the limit is applied to the merged rows.
+    if (read_arg.limit > 0) {
+      std::unique_ptr<StorageIterator> limited =
+          std::make_unique<LimitedStorageIterator>(std::move(iterators),
+                                                   read_arg.limit);
+      iterators.clear();
+      iterators.push_back(std::move(limited));
+    }
     *cursor = std::make_unique<StorageIteratorRowCursor>(
         std::move(iterators), resolved_read_arg.columns);
     return absl::OkStatus();
   });
 }
 
-absl::Status ReadWriteTransaction::ApplyValidators(const WriteOp& op) {
-  return action_registry_->ExecuteValidators(action_context_.get(), op);
+absl::Status ReadWriteTransaction::ApplyValidators(
+    absl::Span<const WriteOp> ops) {
+  return action_registry_->ExecuteValidators(action_context_.get(), ops);
 }
 
-absl::Status ReadWriteTransaction::ApplyEffectors(const WriteOp& op) {
-  return action_registry_->ExecuteEffectors(action_context_.get(), op);
+absl::Status ReadWriteTransaction::ApplyEffectors(
+    absl::Span<const WriteOp> ops) {
+  return action_registry_->ExecuteEffectors(action_context_.get(), ops);
 }
 
 absl::Status ReadWriteTransaction::ApplyStatementVerifiers() {
-  for (const auto& write_op : transaction_store_->GetBufferedOps()) {
-    ZETASQL_RETURN_IF_ERROR(
-        action_registry_->ExecuteVerifiers(action_context_.get(), write_op));
+  // Without unique indexes, foreign keys or check constraints in the schema,
+  // there is nothing to verify and the buffer need not be collected.
+  if (!action_registry_->has_verifiers()) {
+    return absl::OkStatus();
   }
-  return absl::OkStatus();
+
+  // Buffered ops are grouped by table, which lets verifiers batch their
+  // lookups across all rows of a multi-row statement.
+  std::vector<WriteOp> write_ops = transaction_store_->GetBufferedOps();
+  return action_registry_->ExecuteVerifiers(action_context_.get(), write_ops);
 }
 
 void ReadWriteTransaction::UpdateTrackedCommitTimestamps() {
-  commit_timestamp_tracker_->Track(transaction_store_->GetBufferedOps());
+  commit_timestamp_tracker_->Track(
+      transaction_store_->TakeOpsWithNewPendingCommitTimestamps());
 }
 
 const Schema* ReadWriteTransaction::schema() const {
@@ -296,11 +327,21 @@ void ReadWriteTransaction::Reset() {
 
   lock_handle_->UnlockAll();
   transaction_store_->Clear();
+  written_change_streams_.clear();
+  shape_.Clear();
   std::queue<WriteOp> empty;
   write_ops_queue_.swap(empty);
   state_ = State::kUninitialized;
 }
 
+void ReadWriteTransaction::TrackChangeStreamWrite(const WriteOp& write_op) {
+  mu_.AssertHeld();
+  const ChangeStream* change_stream = TableOf(write_op)->owner_change_stream();
+  if (change_stream != nullptr) {
+    written_change_streams_.insert(change_stream->Name());
+  }
+}
+
 absl::Status ReadWriteTransaction::GuardedCall(
     OpType op, const std::function<absl::Status()>& fn) {
   absl::MutexLock lock(&mu_);
@@ -336,6 +377,7 @@ absl::Status ReadWriteTransaction::GuardedCall(
       }
       action_registry_ = maybe_action_registry.value();
       state_ = State::kActive;
+      attempt_start_time_ = absl::Now();
       break;
     }
     case State::kActive: {
@@ -368,36 +410,91 @@ absl::Status ReadWriteTransaction::GuardedCall(
 }
 
 absl::Status ReadWriteTransaction::ProcessWriteOps(
-    const std::vector<WriteOp>& write_ops) {
+    std::vector<WriteOp> write_ops, std::optional<int64_t>* failed_op) {
   mu_.AssertHeld();
 
-  for (const auto& write_op : write_ops) {
-    write_ops_queue_.push(write_op);
+  // Ops left in the queue by an earlier call are processed first, so the
+  // position of an op of `write_ops` in the queue is offset by them.
+  const int64_t queue_offset = write_ops_queue_.size();
+  const int64_t num_write_ops = write_ops.size();
+  int64_t num_popped = 0;
+  for (auto& write_op : write_ops) {
+    write_ops_queue_.push(std::move(write_op));
   }
 
   while (!write_ops_queue_.empty()) {
-    WriteOp write_op = write_ops_queue_.front();
-    write_ops_queue_.pop();
-
-    // Process the operation.
-    ZETASQL_RETURN_IF_ERROR(ApplyValidators(write_op));
-    ZETASQL_RETURN_IF_ERROR(ApplyEffectors(write_op));
+    // Consecutive operations on distinct rows of the same table, such as the
+    // rows of a mutation or the deletes cascading from a deleted row, are
+    // processed as one batch. Their effects are queued behind the batch.
+    std::vector<WriteOp> batch;
+    std::set<Key> batch_keys;
+    const Table* table = TableOf(write_ops_queue_.front());
+    while (!write_ops_queue_.empty() &&
+           TableOf(write_ops_queue_.front()) == table &&
+           batch_keys.insert(KeyOf(write_ops_queue_.front())).second) {
+      batch.push_back(std::move(write_ops_queue_.front()));
+      write_ops_queue_.pop();
+    }
+    const int64_t batch_begin = num_popped - queue_offset;
+    num_popped += batch.size();
+
+    // Process the operations.
+    std::optional<int64_t> failed_in_batch;
+    absl::Status status = ApplyValidators(batch);
+    if (status.ok()) {
+      status = ApplyEffectors(batch);
+    }
+    if (!status.ok() && failed_op != nullptr) {
+      failed_in_batch = FindFailingWriteOp(batch);
+    }
 
     // Apply to transaction store.
-    ZETASQL_RETURN_IF_ERROR(transaction_store_->BufferWriteOp(write_op));
+    for (int64_t i = 0; status.ok() && i < batch.size(); ++i) {
+      status = transaction_store_->BufferWriteOp(batch[i]);
+      if (!status.ok()) {
+        failed_in_batch = i;
+        break;
+      }
+      TrackChangeStreamWrite(batch[i]);
+    }
+
+    if (!status.ok()) {
+      if (failed_op != nullptr && failed_in_batch.has_value() &&
+          batch_begin + *failed_in_batch >= 0 &&
+          batch_begin + *failed_in_batch < num_write_ops) {
+        *failed_op = batch_begin + *failed_in_batch;
+      }
+      return status;
+    }
   }
 
   return absl::OkStatus();
 }
 
+std::optional<int64_t> ReadWriteTransaction::FindFailingWriteOp(
+    absl::Span<const WriteOp> batch) {
+  mu_.AssertHeld();
+  // The failure of the batch resets the transaction, which discards whatever
+  // the ops processed again here leave behind.
+  for (int64_t i = 0; i < batch.size(); ++i) {
+    if (!ApplyValidators(batch.subspan(i, 1)).ok() ||
+        !ApplyEffectors(batch.subspan(i, 1)).ok()) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
 absl::Status ReadWriteTransaction::ProcessChangeStreamWriteOps() {
   mu_.AssertHeld();
   ZETASQL_ASSIGN_OR_RETURN(
       auto write_ops,
       BuildChangeStreamWriteOps(schema_, transaction_store_->GetBufferedOps(),
-                                action_context_->store(), id_));
+                                action_context_->store(), id_,
+                                partition_token_cache_));
   for (const WriteOp& writeop : write_ops) {
     ZETASQL_RETURN_IF_ERROR(transaction_store_->BufferWriteOp(writeop));
+    TrackChangeStreamWrite(writeop);
   }
   return absl::OkStatus();
 }
@@ -432,7 +529,8 @@ ReadWriteTransaction::ResolveNonDeleteMutationOp(const MutationOp& mutation_op,
       mutation_op, &generated_values, &columns_with_generated_values));
 
   ZETASQL_ASSIGN_OR_RETURN(std::vector<const Column*> columns,
-                   GetColumnsByName(table, mutation_op.columns));
+                   GetColumnsByName(table, mutation_op.columns,
+                                    mutation_op.resolved_columns));
   // If we have key columns with generated default values, append them here:
   if (!columns_with_generated_values.empty()) {
     columns.insert(columns.end(), columns_with_generated_values.begin(),
@@ -443,19 +541,24 @@ ReadWriteTransaction::ResolveNonDeleteMutationOp(const MutationOp& mutation_op,
                    ExtractPrimaryKeyIndices(columns, table->primary_key()));
 
   for (int i = 0; i < mutation_op.rows.size(); i++) {
-    const ValueList& row = mutation_op.rows[i];
-    ValueList new_row = row;
+    // The row is copied once out of the mutation and then moved through to
+    // the write ops.
+    ValueList new_row;
+    new_row.reserve(columns.size());
+    new_row.insert(new_row.end(), mutation_op.rows[i].begin(),
+                   mutation_op.rows[i].end());
     // If we have key columns with generated/default values, append them here:
-    new_row.insert(new_row.end(), generated_values[i].begin(),
-                   generated_values[i].end());
+    std::move(generated_values[i].begin(), generated_values[i].end(),
+              std::back_inserter(new_row));
 
     ZETASQL_RET_CHECK_EQ(new_row.size(), columns.size())
         << "MutationOp has difference in size of column and value vectors, "
            "mutation op: "
         << mutation_op.DebugString();
 
-    ZETASQL_ASSIGN_OR_RETURN(resolved_mutation_op.rows.emplace_back(),
-                     MaybeSetCommitTimestampSentinel(columns, new_row));
+    ZETASQL_ASSIGN_OR_RETURN(
+        resolved_mutation_op.rows.emplace_back(),
+        MaybeSetCommitTimestampSentinel(columns, std::move(new_row)));
 
     resolved_mutation_op.keys.push_back(ComputeKey(
         resolved_mutation_op.rows.back(), table->primary_key(), key_indices));
@@ -467,17 +570,23 @@ ReadWriteTransaction::ResolveNonDeleteMutationOp(const MutationOp& mutation_op,
 }
 
 absl::Status ReadWriteTransaction::Write(const Mutation& mutation) {
+  return Write(mutation, /*failed_row=*/nullptr);
+}
+
+absl::Status ReadWriteTransaction::Write(const Mutation& mutation,
+                                         std::optional<int64_t>* failed_row) {
+  tracing::ScopedSpan span("ReadWriteTransaction::Write");
   return GuardedCall(OpType::kWrite, [&]() -> absl::Status {
     mu_.AssertHeld();
     ForeignKeyRestrictions fk_restrictions;
-
-    // When writing, comparison may be required in the process. Comparison of
-    // PG.NUMERIC calls PG to get comparison result (see function
-    // ValueContentLess in datatypes/extended/pg_numeric_type.cc) and therefore
-    // requires a PG arena.
-    ZETASQL_ASSIGN_OR_RETURN(
-        std::unique_ptr<postgres_translator::interfaces::PGArena> arena,
-        postgres_translator::spangres::MemoryContextPGArena::Init(nullptr));
+    // Number of rows of the non-delete ops before the current one.
+    int64_t rows_before = 0;
+    auto row_error = [&](int64_t row, absl::Status status) {
+      if (failed_row != nullptr) {
+        *failed_row = rows_before + row;
+      }
+      return status;
+    };
 
     for (const MutationOp& mutation_op : mutation.ops()) {
       ZETASQL_ASSIGN_OR_RETURN(
@@ -489,75 +598,122 @@ absl::Status ReadWriteTransaction::Write(const Mutation& mutation) {
             ResolvedMutationOp resolved_mutation_op,
             ResolveDeleteMutationOp(mutation_op, schema_, clock_->Now()));
         const std::string& table_name = resolved_mutation_op.table->Name();
+        if (transaction_stats_ != nullptr) {
+          shape_.write_delete_tables.insert(table_name);
+        }
 
         if (has_delete_cascade_foreign_key) {
           ZETASQL_RETURN_IF_ERROR(fk_restrictions.ValidateReferencedDeleteMods(
               table_name, resolved_mutation_op.key_ranges));
         }
 
-        std::vector<KeyRange>& key_ranges =
+        KeyRangeSet& deleted_key_ranges =
             deleted_key_ranges_by_table_[table_name];
-        key_ranges.insert(key_ranges.end(),
-                          resolved_mutation_op.key_ranges.begin(),
-                          resolved_mutation_op.key_ranges.end());
+        for (const KeyRange& key_range : resolved_mutation_op.key_ranges) {
+          deleted_key_ranges.Add(key_range);
+        }
         ZETASQL_ASSIGN_OR_RETURN(std::vector<WriteOp> write_ops,
                          FlattenDeleteOp(resolved_mutation_op.table,
                                          resolved_mutation_op.key_ranges,
                                          transaction_store_.get()));
-        ZETASQL_RETURN_IF_ERROR(ProcessWriteOps(write_ops));
+        ZETASQL_RETURN_IF_ERROR(ProcessWriteOps(std::move(write_ops)));
       } else {
         // Process non-delete Mutation ops.
         ZETASQL_RETURN_IF_ERROR(ValidateNonDeleteMutationOp(mutation_op, schema_));
         ZETASQL_ASSIGN_OR_RETURN(ResolvedMutationOp resolved_mutation_op,
                          ResolveNonDeleteMutationOp(mutation_op, schema_));
         const std::string& table_name = resolved_mutation_op.table->Name();
+        if (transaction_stats_ != nullptr) {
+          for (const Column* column : resolved_mutation_op.columns) {
+            shape_.write_constructive_columns.insert(column->FullName());
+          }
+        }
+
+        // Rows of an Insert, Update or InsertOrUpdate are processed in batches
+        // of distinct keys, which lets effectors look up all rows of a batch
+        // at once. Replaces and mutations involving foreign key actions are
+        // processed row by row.
+        const bool batch_rows =
+            !has_delete_cascade_foreign_key &&
+            resolved_mutation_op.type != MutationOpType::kReplace;
+        std::vector<WriteOp> batch;
+        std::set<Key> batch_keys;
+        int64_t batch_begin = 0;
+        // Batched rows flatten to one op each, so the failing op of a batch
+        // identifies the failing row.
+        auto process_batch = [&]() {
+          std::optional<int64_t> failed_op;
+          absl::Status status = ProcessWriteOps(
+              std::move(batch), failed_row != nullptr ? &failed_op : nullptr);
+          if (!status.ok() && failed_op.has_value()) {
+            return row_error(batch_begin + *failed_op, status);
+          }
+          return status;
+        };
 
         // Process Insert, Update, Replace and InsertOrUpdate.
         for (int i = 0; i < resolved_mutation_op.rows.size(); i++) {
           // Spanner allows deleted entries to be reinserted within the same
           // transaction, so we must update the deleted ranges list in this
           // case.
-          if (resolved_mutation_op.type == MutationOpType::kInsert ||
-              resolved_mutation_op.type == MutationOpType::kInsertOrUpdate) {
-            std::vector<KeyRange> split_key_ranges;
-            auto& deleted_key_ranges = deleted_key_ranges_by_table_[table_name];
-            for (auto it = deleted_key_ranges.begin();
-                 it != deleted_key_ranges.end();) {
-              if (SplitKeyRangeAndAppend(*it, resolved_mutation_op.keys[i],
-                                         &split_key_ranges)) {
-                it = deleted_key_ranges.erase(it);
-              } else {
-                ++it;
-              }
+          auto deleted_key_ranges =
+              deleted_key_ranges_by_table_.find(table_name);
+          if (deleted_key_ranges != deleted_key_ranges_by_table_.end()) {
+            if (resolved_mutation_op.type == MutationOpType::kInsert ||
+                resolved_mutation_op.type == MutationOpType::kInsertOrUpdate) {
+              deleted_key_ranges->second.Remove(resolved_mutation_op.keys[i]);
             }
-            // Insert split key ranges back into the list of deleted key ranges.
-            for (const KeyRange& key_range : split_key_ranges) {
-              deleted_key_ranges.push_back(key_range);
+            if (resolved_mutation_op.type == MutationOpType::kUpdate &&
+                deleted_key_ranges->second.Contains(
+                    resolved_mutation_op.keys[i])) {
+              return row_error(
+                  i, error::UpdateDeletedRowInTransaction(
+                         table_name,
+                         resolved_mutation_op.keys[i].DebugString()));
             }
           }
-          if (resolved_mutation_op.type == MutationOpType::kUpdate) {
-            for (const KeyRange& key_range :
-                 deleted_key_ranges_by_table_[table_name]) {
-              if (key_range.Contains(resolved_mutation_op.keys[i])) {
-                return error::UpdateDeletedRowInTransaction(
-                    table_name, resolved_mutation_op.keys[i].DebugString());
-              }
-            }
+          // A row which repeats a key of the batch must see the effects of
+          // the earlier row, so the batch is processed before it.
+          if (batch_rows &&
+              !batch_keys.insert(resolved_mutation_op.keys[i]).second) {
+            ZETASQL_RETURN_IF_ERROR(process_batch());
+            batch.clear();
+            batch_keys = {resolved_mutation_op.keys[i]};
+            batch_begin = i;
           }
-          ZETASQL_ASSIGN_OR_RETURN(
-              std::vector<WriteOp> write_ops,
+          absl::StatusOr<std::vector<WriteOp>> write_ops =
               FlattenNonDeleteOpRow(
                   resolved_mutation_op.type, resolved_mutation_op.table,
                   resolved_mutation_op.columns, resolved_mutation_op.keys[i],
-                  resolved_mutation_op.rows[i], transaction_store_.get()));
+                  std::move(resolved_mutation_op.rows[i]),
+                  transaction_store_.get());
+          if (!write_ops.ok()) {
+            return row_error(i, write_ops.status());
+          }
 
           if (has_delete_cascade_foreign_key) {
-            ZETASQL_RETURN_IF_ERROR(fk_restrictions.ValidateReferencedMods(
-                write_ops, table_name, schema_));
+            absl::Status status = fk_restrictions.ValidateReferencedMods(
+                *write_ops, table_name, schema_);
+            if (!status.ok()) {
+              return row_error(i, status);
+            }
           }
 
-          ZETASQL_RETURN_IF_ERROR(ProcessWriteOps(write_ops));
+          if (batch_rows) {
+            std::move(write_ops->begin(), write_ops->end(),
+                      std::back_inserter(batch));
+            continue;
+          }
+          std::optional<int64_t> failed_op;
+          absl::Status status =
+              ProcessWriteOps(std::move(*write_ops),
+                              failed_row != nullptr ? &failed_op : nullptr);
+          if (!status.ok()) {
+            return failed_op.has_value() ? row_error(i, status) : status;
+          }
         }
+        ZETASQL_RETURN_IF_ERROR(process_batch());
+        rows_before += resolved_mutation_op.rows.size();
       }
     }
     ZETASQL_RETURN_IF_ERROR(ApplyStatementVerifiers());
@@ -573,41 +729,79 @@ absl::Status ReadWriteTransaction::Write(const Mutation& mutation) {
 }
 
 absl::Status ReadWriteTransaction::Commit() {
+  metrics::ScopedLatencyRecorder latency_recorder(CommitLatency());
+  tracing::ScopedSpan span("ReadWriteTransaction::Commit");
   return GuardedCall(OpType::kCommit, [&]() -> absl::Status {
     mu_.AssertHeld();
-
-    if (retry_state_.abort_retry_count == 0 && ShouldAbortOnFirstCommit()) {
-      return error::AbortReadWriteTransactionOnFirstCommit(id_);
+    absl::Time commit_start_time = absl::Now();
+    absl::Status status = CommitBufferedOps();
+    if (transaction_stats_ != nullptr) {
+      absl::Time now = absl::Now();
+      transaction_stats_->RecordCommit(shape_, status,
+                                       now - attempt_start_time_,
+                                       now - commit_start_time, now);
     }
+    return status;
+  });
+}
+
+absl::Status ReadWriteTransaction::CommitBufferedOps() {
+  if (retry_state_.abort_retry_count == 0 && ShouldAbortOnFirstCommit()) {
+    return error::AbortReadWriteTransactionOnFirstCommit(id_);
+  }
+  {
+    tracing::ScopedSpan span("ReadWriteTransaction::ProcessChangeStreams");
     ZETASQL_RETURN_IF_ERROR(ProcessChangeStreamWriteOps());
+  }
 
-    // When committing, comparison may be required in the process. Comparison of
-    // PG.NUMERIC calls PG to get comparison result (see function
-    // ValueContentLess in datatypes/extended/pg_numeric_type.cc) and therefore
-    // requires a PG arena.
-    ZETASQL_ASSIGN_OR_RETURN(
-        std::unique_ptr<postgres_translator::interfaces::PGArena> arena,
-        postgres_translator::spangres::MemoryContextPGArena::Init(nullptr));
-
-    // Pick a commit timestamp.
-    ZETASQL_ASSIGN_OR_RETURN(commit_timestamp_, lock_handle_->ReserveCommitTimestamp());
-
-    // Write the mutations to the base storage.
-    absl::Status flush_status = FlushWriteOpsToStorage(
-        transaction_store_->GetBufferedOps(), base_storage_, commit_timestamp_);
-    ZETASQL_RETURN_IF_ERROR(lock_handle_->MarkCommitted());
-    if (!flush_status.ok()) {
-      return flush_status;
+  // Pick a commit timestamp and write the mutations to the base storage,
+  // possibly along with those of concurrently committing transactions.
+  // The buffer is consumed, as the transaction cannot be reused whether or
+  // not it commits.
+  std::vector<WriteOp> write_ops = transaction_store_->TakeBufferedOps();
+  CommitRequest request;
+  request.lock_handle = lock_handle_.get();
+  request.write_ops = &write_ops;
+  request.write_ahead_log = write_ahead_log_;
+  // The log is appended to and readers are notified before the commit is
+  // marked, so that a read which waits for this commit to become safe finds
+  // its records in the log and has been notified of it.
+  ChangeStreamLog* change_stream_log =
+      written_change_streams_.empty() ? nullptr : change_stream_log_;
+  ChangeStreamCommitNotifier* notifier = change_stream_commit_notifier_;
+  const absl::flat_hash_set<std::string>& written_change_streams =
+      written_change_streams_;
+  request.on_flushed = [&write_ops, change_stream_log, notifier,
+                        &written_change_streams](absl::Time timestamp) {
+    if (change_stream_log != nullptr) {
+      change_stream_log->AppendCommit(write_ops, timestamp);
     }
+    if (notifier != nullptr) {
+      notifier->NotifyCommit(written_change_streams, timestamp);
+    }
+  };
+  {
+    tracing::ScopedSpan span("GroupCommitter::Commit");
+    group_committer_->Commit(&request);
+  }
+  ZETASQL_RETURN_IF_ERROR(request.status);
+  commit_timestamp_ = request.commit_timestamp;
+  const WriteAheadLog::Sequence wal_sequence = request.wal_sequence;
 
-    // Mark the transaction as committed.
-    state_ = State::kCommitted;
+  // Mark the transaction as committed.
+  state_ = State::kCommitted;
 
-    // Unlock all locks.
-    lock_handle_->UnlockAll();
+  // Unlock all locks.
+  lock_handle_->UnlockAll();
 
-    return absl::OkStatus();
-  });
+  // Wait for the commit to become durable. This happens after releasing the
+  // locks so that concurrent transactions can commit and share the sync.
+  if (write_ahead_log_ != nullptr) {
+    tracing::ScopedSpan span("WriteAheadLog::Sync");
+    ZETASQL_RETURN_IF_ERROR(write_ahead_log_->Sync(wal_sequence));
+  }
+
+  return absl::OkStatus();
 }
 
 absl::Status ReadWriteTransaction::Rollback() {
@@ -17,30 +17,42 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_READ_WRITE_TRANSACTION_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_READ_WRITE_TRANSACTION_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <queue>
+#include <string>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "backend/access/read.h"
 #include "backend/access/write.h"
+#include "backend/actions/change_stream.h"
 #include "backend/actions/context.h"
 #include "backend/actions/manager.h"
 #include "backend/common/case.h"
 #include "backend/common/ids.h"
+#include "backend/common/sys_stats.h"
 #include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
+#include "backend/datamodel/key_range_set.h"
 #include "backend/locking/handle.h"
 #include "backend/locking/manager.h"
 #include "backend/schema/catalog/schema.h"
 #include "backend/schema/catalog/table.h"
 #include "backend/schema/catalog/versioned_catalog.h"
 #include "backend/storage/storage.h"
+#include "backend/storage/write_ahead_log.h"
 #include "backend/transaction/actions.h"
+#include "backend/transaction/change_stream_commit_notifier.h"
+#include "backend/transaction/change_stream_log.h"
 #include "backend/transaction/commit_timestamp.h"
+#include "backend/transaction/group_committer.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/resolve.h"
 #include "backend/transaction/transaction_store.h"
@@ -79,12 +91,16 @@ class ReadWriteTransaction : public RowReader, public RowWriter {
     kInvalid,
   };
 
-  ReadWriteTransaction(const ReadWriteOptions& options,
-                       const RetryState& retry_state,
-                       TransactionID transaction_id, Clock* clock,
-                       Storage* storage, LockManager* lock_manager,
-                       const VersionedCatalog* const versioned_catalog,
-                       ActionManager* action_manager);
+  ReadWriteTransaction(
+      const ReadWriteOptions& options, const RetryState& retry_state,
+      TransactionID transaction_id, Clock* clock, Storage* storage,
+      LockManager* lock_manager, const VersionedCatalog* const versioned_catalog,
+      ActionManager* action_manager, WriteAheadLog* write_ahead_log = nullptr,
+      ChangeStreamCommitNotifier* change_stream_commit_notifier = nullptr,
+      ChangeStreamLog* change_stream_log = nullptr,
+      GroupCommitter* group_committer = nullptr,
+      TransactionStats* transaction_stats = nullptr,
+      ActivePartitionTokenCache* partition_token_cache = nullptr);
 
   absl::Status Read(const ReadArg& read_arg,
                     std::unique_ptr<RowCursor>* cursor) override
@@ -93,6 +109,15 @@ class ReadWriteTransaction : public RowReader, public RowWriter {
   absl::Status Write(const Mutation& mutation) override
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Same as Write(), but when the write fails because of one of the rows of
+  // the non-delete ops of `mutation`, sets `*failed_row` to the index of that
+  // row counted across those ops. Leaves `*failed_row` unset when the failure
+  // cannot be tied to a row, e.g. when it comes from an effect of the rows or
+  // from a statement verifier.
+  absl::Status Write(const Mutation& mutation,
+                     std::optional<int64_t>* failed_row)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
   absl::Status Commit() ABSL_LOCKS_EXCLUDED(mu_);
 
   absl::Status Rollback() ABSL_LOCKS_EXCLUDED(mu_);
@@ -143,17 +168,34 @@ class ReadWriteTransaction : public RowReader, public RowWriter {
 
   absl::Status GuardedCall(OpType op, const std::function<absl::Status()>& fn)
       ABSL_LOCKS_EXCLUDED(mu_);
-  absl::Status ProcessWriteOps(const std::vector<WriteOp>& write_ops);
+  // Processes `write_ops` and their effects. If `failed_op` is not null and
+  // the failure is caused by one of `write_ops` rather than by an effect, sets
+  // `*failed_op` to the index of that op.
+  absl::Status ProcessWriteOps(std::vector<WriteOp> write_ops,
+                               std::optional<int64_t>* failed_op = nullptr);
   absl::Status ProcessChangeStreamWriteOps();
   // Resets the transaction and marks it Active.
   void Reset();
 
+  // Writes the buffered mutations to the base storage at a new commit
+  // timestamp.
+  absl::Status CommitBufferedOps() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Apply the constraint checks and effects to the writes.
-  absl::Status ApplyValidators(const WriteOp& op);
-  absl::Status ApplyEffectors(const WriteOp& op);
+  absl::Status ApplyValidators(absl::Span<const WriteOp> ops);
+  absl::Status ApplyEffectors(absl::Span<const WriteOp> ops);
   absl::Status ApplyStatementVerifiers();
 
-  // Updates commit timestamp tracking to reflect currently buffered ops.
+  // Returns the index of the first op of `batch`, a batch that failed to apply,
+  // which fails to apply on its own. Returns nullopt if each op applies.
+  std::optional<int64_t> FindFailingWriteOp(absl::Span<const WriteOp> batch);
+
+  // Records the change stream owning the table written by `write_op`, if any,
+  // so that its readers are notified when this transaction commits.
+  void TrackChangeStreamWrite(const WriteOp& write_op);
+
+  // Updates commit timestamp tracking to reflect the ops buffered since the
+  // last update.
   void UpdateTrackedCommitTimestamps();
 
   // Converts input non-delete MutationOp into ResolvedMutationOp after
@@ -182,12 +224,37 @@ class ReadWriteTransaction : public RowReader, public RowWriter {
   // Underlying storage of the database.
   Storage* base_storage_;
 
+  // Log to which committed writes are appended, or null if the database is
+  // not durable.
+  WriteAheadLog* write_ahead_log_;
+
+  // Notified of commits which write to change streams, or null if there are
+  // no change stream readers to notify.
+  ChangeStreamCommitNotifier* change_stream_commit_notifier_;
+
+  // Log to which committed data change records are appended, or null if
+  // change stream records are only kept in storage.
+  ChangeStreamLog* change_stream_log_;
+
+  // Statistics to which commits are reported, or null if they are not
+  // collected.
+  TransactionStats* transaction_stats_;
+
+  // Active change stream partition tokens shared by the transactions of the
+  // database, or null if they are read from the partition tables every time.
+  ActivePartitionTokenCache* partition_token_cache_;
+
   // Catalog of schemas.
   const VersionedCatalog* const versioned_catalog_;
 
   // Transaction lock management.
   std::unique_ptr<LockHandle> lock_handle_;
 
+  // Commits this transaction along with concurrently committing ones. Owned
+  // by the transaction if the caller did not provide one.
+  std::unique_ptr<GroupCommitter> owned_group_committer_;
+  GroupCommitter* group_committer_;
+
   // Tracks tables/columns containing pending commit timestamp.
   std::unique_ptr<CommitTimestampTracker> commit_timestamp_tracker_;
 
@@ -203,6 +270,14 @@ class ReadWriteTransaction : public RowReader, public RowWriter {
   // The commit timestamp chosen for this transaction.
   absl::Time commit_timestamp_ ABSL_GUARDED_BY(mu_);
 
+  // The columns read and written by the current attempt of this transaction,
+  // and when the attempt started. Only tracked if transaction_stats_ is set.
+  TransactionShape shape_ ABSL_GUARDED_BY(mu_);
+  absl::Time attempt_start_time_ ABSL_GUARDED_BY(mu_);
+
+  // Names of the change streams whose internal tables this transaction wrote.
+  absl::flat_hash_set<std::string> written_change_streams_ ABSL_GUARDED_BY(mu_);
+
   // Queue of mutations being processed by this transaction.
   std::queue<WriteOp> write_ops_queue_ ABSL_GUARDED_BY(mu_);
 
@@ -212,7 +287,9 @@ class ReadWriteTransaction : public RowReader, public RowWriter {
   // The schema that is in effect at the timestamp picked for this transaction.
   const Schema* schema_ ABSL_GUARDED_BY(mu_);
 
-  CaseInsensitiveStringMap<std::vector<KeyRange>> deleted_key_ranges_by_table_;
+  // Key ranges deleted by this transaction, per table. Keys reinserted after
+  // being deleted are removed from these ranges.
+  CaseInsensitiveStringMap<KeyRangeSet> deleted_key_ranges_by_table_;
 };
 
 }  // namespace backend
@@ -16,8 +16,10 @@
 
 #include "backend/transaction/read_write_transaction.h"
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>  // NOLINT
 #include <utility>
@@ -34,6 +36,7 @@
 #include "backend/actions/manager.h"
 #include "backend/actions/ops.h"
 #include "backend/common/ids.h"
+#include "backend/common/sys_stats.h"
 #include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/datamodel/key_set.h"
@@ -127,11 +130,13 @@ class ReadWriteTransactionTest : public testing::Test {
 
   absl::StatusOr<std::vector<ValueList>> ReadUsingIndex(
       ReadWriteTransaction* txn, KeySet key_set, std::string index,
-      std::vector<std::string> columns, std::string table_name = "test_table") {
+      std::vector<std::string> columns, std::string table_name = "test_table",
+      int64_t limit = 0) {
     backend::ReadArg read_arg{.table = table_name,
                               .index = index,
                               .key_set = key_set,
-                              .columns = columns};
+                              .columns = columns,
+                              .limit = limit};
 
     std::unique_ptr<backend::RowCursor> cursor;
     ZETASQL_RETURN_IF_ERROR(txn->Read(read_arg, &cursor));
@@ -188,6 +193,28 @@ TEST_F(ReadWriteTransactionTest, CanReadAfterFlush) {
                                 {Int64(3), String("value3")}}));
 }
 
+TEST_F(ReadWriteTransactionTest, ReadLimitCountsRowsMergedWithBuffer) {
+  Mutation m;
+  m.AddWriteOp(MutationOpType::kInsert, "test_table",
+               {"int64_col", "string_col"},
+               {{Int64(1), String("value1")},
+                {Int64(2), String("value2")},
+                {Int64(3), String("value3")}});
+  auto txn1 = CreateReadWriteTransaction();
+  ZETASQL_EXPECT_OK(txn1->Write(m));
+  ZETASQL_EXPECT_OK(txn1->Commit());
+
+  // The rows deleted by the transaction do not count towards the limit.
+  Mutation m2;
+  m2.AddDeleteOp("test_table", KeySet(Key({Int64(1)})));
+  auto txn2 = CreateReadWriteTransaction();
+  ZETASQL_EXPECT_OK(txn2->Write(m2));
+  EXPECT_THAT(ReadUsingIndex(txn2.get(), KeySet(KeyRange::All()), /*index=*/"",
+                             {"int64_col", "string_col"}, "test_table",
+                             /*limit=*/1),
+              IsOkAndHoldsRows({{Int64(2), String("value2")}}));
+}
+
 TEST_F(ReadWriteTransactionTest, ReadEmptyDatabase) {
   auto txn1 = CreateReadWriteTransaction();
   EXPECT_THAT(ReadAll(txn1.get(), {"int64_col", "string_col"}),
@@ -259,6 +286,36 @@ TEST_F(ReadWriteTransactionTest, CommitWithNoBufferedMutation) {
   EXPECT_EQ(txn->state(), ReadWriteTransaction::State::kCommitted);
 }
 
+TEST_F(ReadWriteTransactionTest, CommitsAreRecordedInTransactionStats) {
+  TransactionStats transaction_stats;
+  auto txn = std::make_unique<ReadWriteTransaction>(
+      ReadWriteOptions(), RetryState(), ++id_counter_, &clock_, storage_.get(),
+      lock_manager_.get(), versioned_catalog_.get(), action_manager_.get(),
+      /*write_ahead_log=*/nullptr, /*change_stream_commit_notifier=*/nullptr,
+      /*change_stream_log=*/nullptr, /*group_committer=*/nullptr,
+      &transaction_stats);
+  ZETASQL_EXPECT_OK(ReadAll(txn.get(), {"int64_col"}));
+  Mutation m;
+  m.AddWriteOp(MutationOpType::kInsert, "test_table",
+               {"int64_col", "string_col"}, {{Int64(1), String("value")}});
+  m.AddDeleteOp("test_table", KeySet(Key({Int64(2)})));
+  ZETASQL_EXPECT_OK(txn->Write(m));
+  ZETASQL_EXPECT_OK(txn->Commit());
+
+  std::vector<IntervalEntry<TransactionStatsEntry>> entries =
+      transaction_stats.Entries();
+  ASSERT_EQ(entries.size(), 1);
+  const TransactionStatsEntry& entry = entries[0].entry;
+  EXPECT_THAT(entry.read_columns, testing::ElementsAre("test_table.int64_col"));
+  EXPECT_THAT(entry.write_constructive_columns,
+              testing::ElementsAre("test_table.int64_col",
+                                   "test_table.string_col"));
+  EXPECT_THAT(entry.write_delete_tables, testing::ElementsAre("test_table"));
+  EXPECT_EQ(entry.commit_attempt_count, 1);
+  EXPECT_EQ(entry.commit_count, 1);
+  EXPECT_GE(entry.total_latency, entry.total_commit_latency);
+}
+
 TEST_F(ReadWriteTransactionTest, CommitWithMultipleChangesToDatabase) {
   // Buffer mutations.
   Mutation m;
@@ -324,6 +381,54 @@ TEST_F(ReadWriteTransactionTest,
   config::set_abort_current_transaction_probability(current_probability);
 }
 
+TEST_F(ReadWriteTransactionTest,
+       ConcurrentNonConflictingReadWriteTransactionsCommit) {
+  config::set_concurrent_read_write_transactions_enabled(true);
+  Mutation m1;
+  m1.AddWriteOp(MutationOpType::kInsert, "test_table",
+                {"int64_col", "string_col"}, {{Int64(1), String("value-1")}});
+  Mutation m2;
+  m2.AddWriteOp(MutationOpType::kInsert, "test_table",
+                {"int64_col", "string_col"}, {{Int64(2), String("value-2")}});
+
+  // Both transactions write disjoint rows and can run at the same time.
+  auto txn1 = CreateReadWriteTransaction();
+  auto txn2 = CreateReadWriteTransaction();
+  ZETASQL_EXPECT_OK(txn1->Write(m1));
+  ZETASQL_EXPECT_OK(txn2->Write(m2));
+  ZETASQL_EXPECT_OK(txn2->Commit());
+  ZETASQL_EXPECT_OK(txn1->Commit());
+
+  auto txn3 = CreateReadWriteTransaction();
+  EXPECT_THAT(ReadAll(txn3.get(), {"int64_col", "string_col"}),
+              IsOkAndHoldsRows({{Int64(1), String("value-1")},
+                                {Int64(2), String("value-2")}}));
+  config::set_concurrent_read_write_transactions_enabled(false);
+}
+
+TEST_F(ReadWriteTransactionTest,
+       ConcurrentConflictingReadWriteTransactionsReturnsAborted) {
+  config::set_concurrent_read_write_transactions_enabled(true);
+  auto current_probability = config::abort_current_transaction_probability();
+  config::set_abort_current_transaction_probability(0);
+  Mutation m1;
+  m1.AddWriteOp(MutationOpType::kInsert, "test_table",
+                {"int64_col", "string_col"}, {{Int64(1), String("value-1")}});
+  Mutation m2;
+  m2.AddWriteOp(MutationOpType::kInsert, "test_table",
+                {"int64_col", "string_col"}, {{Int64(1), String("value-2")}});
+
+  // Both transactions insert the same row, so the second one is aborted.
+  auto txn1 = CreateReadWriteTransaction();
+  auto txn2 = CreateReadWriteTransaction();
+  ZETASQL_EXPECT_OK(txn1->Write(m1));
+  EXPECT_THAT(txn2->Write(m2), StatusIs(absl::StatusCode::kAborted));
+  ZETASQL_EXPECT_OK(txn1->Commit());
+
+  config::set_abort_current_transaction_probability(current_probability);
+  config::set_concurrent_read_write_transactions_enabled(false);
+}
+
 TEST_F(ReadWriteTransactionTest, ConcurrentTransactionsEventuallySucceed) {
   // Start n threads each doing a transactional increment k times.
   int n = 20;
@@ -713,6 +818,32 @@ TEST_F(ReadWriteTransactionTest, IndexDeleteAreIdempotentTest) {
               IsOkAndHoldsRows({}));
 }
 
+TEST_F(ReadWriteTransactionTest, IndexMultiRowMutationsTest) {
+  // Insert several rows, swap their indexed values and delete some of them
+  // again, each with a single multi-row mutation op.
+  Mutation m;
+  m.AddWriteOp(MutationOpType::kInsert, "test_table",
+               {"int64_col", "string_col"},
+               {{Int64(1), String("a")},
+                {Int64(2), String("b")},
+                {Int64(3), String("c")}});
+  m.AddWriteOp(MutationOpType::kUpdate, "test_table",
+               {"int64_col", "string_col"},
+               {{Int64(1), String("b")}, {Int64(2), String("a")}});
+  m.AddDeleteOp("test_table", KeySet{KeyRange::ClosedClosed(
+                                  Key{{Int64(2)}}, Key{{Int64(3)}})});
+
+  auto txn1 = CreateReadWriteTransaction();
+  ZETASQL_EXPECT_OK(txn1->Write(m));
+  ZETASQL_EXPECT_OK(txn1->Commit());
+
+  // Verify the index only holds the entry of the remaining row.
+  auto txn2 = CreateReadWriteTransaction();
+  EXPECT_THAT(ReadAllUsingIndex(txn2.get(), "test_index",
+                                {"string_col", "int64_col"}),
+              IsOkAndHoldsRows({{String("b"), Int64(1)}}));
+}
+
 TEST_F(ReadWriteTransactionTest, IndexUniquenessFailTest) {
   // Buffer two mutations that should violate index uniqueness constraint.
   Mutation m;
@@ -725,6 +856,21 @@ TEST_F(ReadWriteTransactionTest, IndexUniquenessFailTest) {
   EXPECT_THAT(txn->Write(m), StatusIs(absl::StatusCode::kAlreadyExists));
 }
 
+TEST_F(ReadWriteTransactionTest, WriteReportsFailedRow) {
+  Mutation m;
+  m.AddWriteOp(MutationOpType::kInsert, "test_table",
+               {"int64_col", "string_col"}, {{Int64(1), String("a")}});
+  m.AddWriteOp(MutationOpType::kInsert, "test_table",
+               {"int64_col", "string_col"},
+               {{Int64(2), String("b")}, {Int64(1), String("c")}});
+
+  auto txn = CreateReadWriteTransaction();
+  std::optional<int64_t> failed_row;
+  EXPECT_THAT(txn->Write(m, &failed_row),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+  EXPECT_EQ(failed_row, 2);
+}
+
 TEST_F(ReadWriteTransactionTest, UpdateAfterDeleteFails) {
   Mutation m;
   m.AddDeleteOp("test_table", KeySet{Key{{Int64(4)}}});
@@ -735,6 +881,26 @@ TEST_F(ReadWriteTransactionTest, UpdateAfterDeleteFails) {
   EXPECT_THAT(txn->Write(m), StatusIs(absl::StatusCode::kInvalidArgument));
 }
 
+TEST_F(ReadWriteTransactionTest, UpdateAfterDeleteAndReinsertSucceeds) {
+  Mutation m;
+  m.AddDeleteOp("test_table", KeySet{KeyRange::ClosedClosed(
+                                  Key{{Int64(1)}}, Key{{Int64(10)}})});
+  m.AddWriteOp(MutationOpType::kInsert, "test_table",
+               {"int64_col", "string_col"}, {{Int64(5), String("value")}});
+  m.AddWriteOp(MutationOpType::kUpdate, "test_table",
+               {"int64_col", "string_col"}, {{Int64(5), String("updated")}});
+
+  auto txn = CreateReadWriteTransaction();
+  ZETASQL_EXPECT_OK(txn->Write(m));
+
+  // Only the reinserted key was removed from the deleted range.
+  Mutation update;
+  update.AddWriteOp(MutationOpType::kUpdate, "test_table",
+                    {"int64_col", "string_col"}, {{Int64(6), String("value")}});
+  EXPECT_THAT(txn->Write(update),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST_F(ReadWriteTransactionTest, InsertSucceeds) {
   Mutation m;
   m.AddWriteOp(MutationOpType::kInsert, "test_table",
@@ -297,9 +297,15 @@ absl::StatusOr<ResolvedReadArg> ResolveReadArg(const ReadArg& read_arg,
     read_table = index->index_data_table();
   }
 
-  // Find the columns to read from schema.
+  // Find the columns to read from schema, unless the reader already resolved
+  // them against this schema.
   std::vector<const Column*> columns;
-  for (const auto& column_name : read_arg.columns) {
+  if (AreResolvedColumns(read_table, read_arg.columns,
+                         read_arg.resolved_columns)) {
+    columns = read_arg.resolved_columns;
+  }
+  for (int i = columns.size(); i < read_arg.columns.size(); ++i) {
+    const std::string& column_name = read_arg.columns[i];
     const Column* column = read_table->FindColumn(column_name);
     if (column == nullptr) {
       if (index == nullptr) {
@@ -359,7 +365,8 @@ absl::Status ValidateNonDeleteMutationOp(const MutationOp& mutation_op,
   ZETASQL_RETURN_IF_ERROR(ValidateColumnsAreNotDuplicate(mutation_op.columns));
 
   ZETASQL_ASSIGN_OR_RETURN(std::vector<const Column*> columns,
-                   GetColumnsByName(table, mutation_op.columns));
+                   GetColumnsByName(table, mutation_op.columns,
+                                    mutation_op.resolved_columns));
 
   ZETASQL_RETURN_IF_ERROR(
       ValidateDefaultAndGeneratedKeys(table, columns, mutation_op.type));
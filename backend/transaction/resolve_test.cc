@@ -181,6 +181,18 @@ TEST_F(ResolveTest, CanResolveTableAndColumnsFromReadArgWithIndex) {
               testing::ElementsAre(index_string_col_));
 }
 
+TEST_F(ResolveTest, CannotResolveReadArgWithColumnNotCoveredByIndex) {
+  backend::ReadArg read_arg;
+  read_arg.table = "TestTable";
+  read_arg.index = "TestIndex";
+  read_arg.columns = {"StringCol", "Int64ValCol"};
+  read_arg.key_set = KeySet(Key({String("value")}));
+
+  EXPECT_THAT(ResolveReadArg(read_arg, schema_.get()),
+              StatusIs(absl::StatusCode::kNotFound,
+                       testing::HasSubstr("Int64ValCol")));
+}
+
 TEST_F(ResolveTest, CannotResolveReadArgWithInvalidIndex) {
   backend::ReadArg read_arg;
   read_arg.table = "TestTable";
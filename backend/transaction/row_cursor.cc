@@ -16,7 +16,11 @@
 
 #include "backend/transaction/row_cursor.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
+
+#include "zetasql/public/value.h"
 
 #include "backend/storage/iterator.h"
 
@@ -43,6 +47,35 @@ bool StorageIteratorRowCursor::Next() {
   return false;
 }
 
+bool StorageIteratorRowCursor::NextBatch(
+    int64_t max_rows, std::vector<std::vector<zetasql::Value>>* rows) {
+  // Rows are copied straight from the underlying iterators, with the same
+  // handling of missing values as ColumnValue.
+  int64_t num_rows = 0;
+  while (num_rows < max_rows && current_ < iterators_.size()) {
+    StorageIterator* iterator = iterators_[current_].get();
+    if (!iterator->Next()) {
+      if (!iterator->Status().ok()) {
+        break;
+      }
+      current_ += 1;
+      continue;
+    }
+    if (num_rows == rows->size()) {
+      rows->emplace_back();
+    }
+    std::vector<zetasql::Value>& row = (*rows)[num_rows++];
+    row.resize(columns_.size());
+    for (int i = 0; i < row.size(); ++i) {
+      const zetasql::Value& value = iterator->ColumnValue(i);
+      row[i] = value.is_valid() ? value
+                                : zetasql::Value::Null(columns_[i]->GetType());
+    }
+  }
+  rows->resize(num_rows);
+  return num_rows > 0;
+}
+
 absl::Status StorageIteratorRowCursor::Status() const {
   if (current_ >= iterators_.size()) {
     return absl::OkStatus();
@@ -17,6 +17,11 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_ROW_CURSOR_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_ROW_CURSOR_H_
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "zetasql/public/value.h"
 #include "backend/access/read.h"
 #include "backend/schema/catalog/table.h"
 #include "backend/storage/in_memory_iterator.h"
@@ -39,6 +44,8 @@ class StorageIteratorRowCursor : public RowCursor {
 
   // Implementation of the RowCursor interface
   bool Next() override;
+  bool NextBatch(int64_t max_rows,
+                 std::vector<std::vector<zetasql::Value>>* rows) override;
   absl::Status Status() const override;
   int NumColumns() const override;
   const std::string ColumnName(int i) const override;
@@ -218,6 +218,33 @@ TEST_F(StorageIteratorRowCursorTest, CreateRowCursorMultipleMultiRowIterators) {
   ZETASQL_EXPECT_OK(rowc.Status());
 }
 
+TEST_F(StorageIteratorRowCursorTest, NextBatchReadsAcrossIterators) {
+  std::vector<std::pair<Key, std::vector<Value>>> row_values = {
+      {Key({Int64(1)}), {Int64(10), String("test_string1")}},
+      {Key({Int64(2)}), {Int64(20), zetasql::Value()}}};
+  iterators_.push_back(
+      std::make_unique<FixedRowStorageIterator>(std::move(row_values)));
+  iterators_.push_back(std::make_unique<FixedRowStorageIterator>());
+  row_values = {{Key({Int64(3)}), {Int64(30), String("test_string3")}}};
+  iterators_.push_back(
+      std::make_unique<FixedRowStorageIterator>(std::move(row_values)));
+
+  StorageIteratorRowCursor rowc(std::move(iterators_), std::move(columns_));
+
+  std::vector<std::vector<Value>> rows;
+  ASSERT_TRUE(rowc.NextBatch(/*max_rows=*/2, &rows));
+  EXPECT_THAT(rows, testing::ElementsAre(
+                        testing::ElementsAre(Int64(10), String("test_string1")),
+                        testing::ElementsAre(
+                            Int64(20), zetasql::values::NullString())));
+  ASSERT_TRUE(rowc.NextBatch(/*max_rows=*/2, &rows));
+  EXPECT_THAT(rows, testing::ElementsAre(testing::ElementsAre(
+                        Int64(30), String("test_string3"))));
+  EXPECT_FALSE(rowc.NextBatch(/*max_rows=*/2, &rows));
+  EXPECT_TRUE(rows.empty());
+  ZETASQL_EXPECT_OK(rowc.Status());
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
@@ -16,8 +16,9 @@
 
 #include "backend/transaction/transaction_store.h"
 
-#include <algorithm>
+#include <cstddef>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -52,11 +53,6 @@ namespace backend {
 
 namespace {
 
-bool SortByKey(const FixedRowStorageIterator::Row& a,
-               const FixedRowStorageIterator::Row& b) {
-  return a.first < b.first;
-}
-
 void ResetInvalidValuesToNull(absl::Span<const Column* const> columns,
                               ValueList* values) {
   if (!values) {
@@ -93,12 +89,13 @@ absl::Status TransactionStore::AcquireWriteLock(
 absl::Status TransactionStore::BufferInsert(
     const Table* table, const Key& key, absl::Span<const Column* const> columns,
     const ValueList& values) {
-  // Acquire locks to prevent another transaction to modify this entity.
-  ZETASQL_RETURN_IF_ERROR(AcquireWriteLock(table, KeyRange::Point(key), columns));
+  // Acquire locks to prevent another transaction to modify this entity. An
+  // insert changes the existence of the row, so the whole row is locked.
+  ZETASQL_RETURN_IF_ERROR(AcquireWriteLock(table, KeyRange::Point(key), {}));
 
   RowOp row_op;
   bool row_exists = RowExistsInBuffer(table, key, &row_op);
-  Row row_values;
+  Row row_values(table);
   if (row_exists) {
     // There is an existing delete on this row. Normalize this insert
     // with the previous delete mutation.
@@ -107,9 +104,9 @@ absl::Status TransactionStore::BufferInsert(
 
   // Buffer the insert mutation with the row values to be inserted.
   for (int i = 0; i < columns.size(); ++i) {
-    row_values[columns[i]] = values[i];
+    row_values.Set(columns[i], values[i]);
   }
-  buffered_ops_[table][key] = std::make_pair(OpType::kInsert, row_values);
+  MutableTableOps(table)[key] = std::make_pair(OpType::kInsert, row_values);
   return absl::OkStatus();
 }
 
@@ -124,7 +121,7 @@ absl::Status TransactionStore::BufferUpdate(
 
   // Buffer the update mutation with the cell values to be updated.
   OpType op_type;
-  Row row_values;
+  Row row_values(table);
   if (row_exists) {
     // There is an existing insert or update on this row. Normalize this update
     // with the previous mutation.
@@ -137,9 +134,9 @@ absl::Status TransactionStore::BufferUpdate(
   }
 
   for (int i = 0; i < columns.size(); ++i) {
-    row_values[columns[i]] = values[i];
+    row_values.Set(columns[i], values[i]);
   }
-  buffered_ops_[table][key] = std::make_pair(op_type, row_values);
+  MutableTableOps(table)[key] = std::make_pair(op_type, row_values);
   return absl::OkStatus();
 }
 
@@ -157,28 +154,66 @@ absl::Status TransactionStore::BufferDelete(const Table* table,
   // row).
   if (RowExistsInBuffer(table, key, &row_op) &&
       !RowExistsInStorage(table, key)) {
-    buffered_ops_[table].erase(key);
+    MutableTableOps(table).erase(key);
   } else {
     // Marking all columns null to indicate a delete.
-    Row row_values;
+    Row row_values(table);
     for (auto column : table->columns()) {
-      row_values[column] = zetasql::values::Null(column->GetType());
+      row_values.Set(column, zetasql::values::Null(column->GetType()));
     }
-    buffered_ops_[table][key] = std::make_pair(OpType::kDelete, row_values);
+    MutableTableOps(table)[key] = std::make_pair(OpType::kDelete, row_values);
   }
   return absl::OkStatus();
 }
 
+TransactionStore::TableOps& TransactionStore::MutableTableOps(
+    const Table* table) {
+  DetachReaders();
+  return buffered_ops_.try_emplace(table, &arena_).first->second;
+}
+
+void TransactionStore::Clear() {
+  DetachReaders();
+  // Destroy the maps before releasing the memory they were allocated from.
+  buffered_ops_.clear();
+  arena_.release();
+  pending_commit_timestamp_rows_.clear();
+}
+
 absl::Status TransactionStore::BufferWriteOp(const WriteOp& op) {
+  auto has_pending_commit_timestamp = [](const auto& op) {
+    for (int i = 0; i < op.columns.size(); ++i) {
+      if (IsPendingCommitTimestamp(op.columns[i], op.values[i])) {
+        return true;
+      }
+    }
+    return HasPendingCommitTimestampInKey(op.table, op.key);
+  };
   return std::visit(
       overloaded{
-          [&](const InsertOp& op) {
-            return BufferInsert(op.table, op.key, op.columns, op.values);
+          [&](const InsertOp& op) -> absl::Status {
+            ZETASQL_RETURN_IF_ERROR(
+                BufferInsert(op.table, op.key, op.columns, op.values));
+            if (has_pending_commit_timestamp(op)) {
+              pending_commit_timestamp_rows_.emplace_back(op.table, op.key);
+            }
+            return absl::OkStatus();
+          },
+          [&](const UpdateOp& op) -> absl::Status {
+            ZETASQL_RETURN_IF_ERROR(
+                BufferUpdate(op.table, op.key, op.columns, op.values));
+            if (has_pending_commit_timestamp(op)) {
+              pending_commit_timestamp_rows_.emplace_back(op.table, op.key);
+            }
+            return absl::OkStatus();
           },
-          [&](const UpdateOp& op) {
-            return BufferUpdate(op.table, op.key, op.columns, op.values);
+          [&](const DeleteOp& op) -> absl::Status {
+            ZETASQL_RETURN_IF_ERROR(BufferDelete(op.table, op.key));
+            if (HasPendingCommitTimestampInKey(op.table, op.key)) {
+              pending_commit_timestamp_rows_.emplace_back(op.table, op.key);
+            }
+            return absl::OkStatus();
           },
-          [&](const DeleteOp& op) { return BufferDelete(op.table, op.key); },
       },
       op);
 }
@@ -212,86 +247,181 @@ absl::StatusOr<ValueList> TransactionStore::ReadCommitted(
 //   - insert: add to output storage iterator
 //   - update: these updates should be applied over the base storage row.
 //   - delete: should remove the key read from the base storage.
-absl::Status TransactionStore::Read(
-    const Table* table, const KeyRange& key_range,
-    absl::Span<const Column* const> columns,
-    std::unique_ptr<StorageIterator>* storage_itr,
-    bool allow_pending_commit_timestamps_in_read) const {
-  // Acquire locks to prevent another transaction to modify this entity.
-  ZETASQL_RETURN_IF_ERROR(AcquireReadLock(table, key_range, columns));
+class TransactionStore::MergingIterator : public StorageIterator {
+ public:
+  // Iterates over `base_itr` and the mutations in [begin, end) of `table_ops`.
+  // `table_ops` may be null if the table has no buffered mutations.
+  MergingIterator(const TransactionStore* store, const TableOps* table_ops,
+                  const KeyRange& key_range,
+                  absl::Span<const Column* const> columns,
+                  std::unique_ptr<StorageIterator> base_itr)
+      : columns_(columns.begin(), columns.end()),
+        base_itr_(std::move(base_itr)) {
+    nulls_.reserve(columns_.size());
+    for (const Column* column : columns_) {
+      nulls_.push_back(zetasql::values::Null(column->GetType()));
+    }
+    if (table_ops == nullptr) {
+      detached_ops_.emplace();
+    } else {
+      store_ = store;
+      buffer_itr_ = table_ops->lower_bound(key_range.start_key());
+      buffer_end_ = table_ops->lower_bound(key_range.limit_key());
+      store_->live_readers_.insert(this);
+    }
+    base_valid_ = base_itr_->Next();
+  }
 
-  // Read rows buffered within transaction store.
-  // Table lookup.
-  std::vector<FixedRowStorageIterator::Row> rows;
-  auto table_itr = buffered_ops_.find(table);
-  if (table_itr != buffered_ops_.end()) {
-    auto table = table_itr->second;
-    // Key range lookup.
-    auto begin_itr = table.lower_bound(key_range.start_key());
-    auto end_itr = table.lower_bound(key_range.limit_key());
-
-    for (auto itr = begin_itr; itr != end_itr; ++itr) {
-      if (itr->second.first == OpType::kInsert) {
-        // Add inserts into the StorageIterator.
-        const Row& row_values = itr->second.second;
-        ValueList values;
-        values.reserve(columns.size());
-        for (const Column* column : columns) {
-          if (row_values.find(column) == row_values.end()) {
-            values.emplace_back(zetasql::values::Null(column->GetType()));
-          } else {
-            values.emplace_back(row_values.at(column));
-          }
-        }
-        rows.emplace_back(itr->first, std::move(values));
-      }
+  ~MergingIterator() override {
+    if (store_ != nullptr) {
+      store_->live_readers_.erase(this);
     }
   }
-  auto buffered_rows_count = rows.size();
 
-  // Read from the base storage and apply the changes buffered in transaction
-  // store.
-  std::unique_ptr<StorageIterator> base_itr;
-  ZETASQL_RETURN_IF_ERROR(base_storage_->Read(absl::InfiniteFuture(), table->id(),
-                                      key_range, GetColumnIDs(columns),
-                                      &base_itr));
-  while (base_itr->Next()) {
-    ValueList values;
-    values.reserve(columns.size());
-
-    RowOp row_op;
-    // Merge column values from transaction store & base storage.
-    if (RowExistsInBuffer(table, base_itr->Key(), &row_op)) {
-      if (row_op.first == OpType::kDelete || row_op.first == OpType::kInsert) {
-        // Omit the deletes from the output. The buffered inserts have already
-        // been added to the output.
-        continue;
-      }
-      if (row_op.first == OpType::kUpdate) {
-        // Update the column values to reflect the changes in transaction store.
-        for (int i = 0; i < columns.size(); i++) {
-          if (row_op.second.find(columns[i]) != row_op.second.end()) {
-            values.emplace_back(row_op.second[columns[i]]);
-          } else if (base_itr->ColumnValue(i).is_valid()) {
-            values.emplace_back(base_itr->ColumnValue(i));
-          } else {
-            values.emplace_back(zetasql::values::Null(columns[i]->GetType()));
-          }
-        }
-      }
+  bool Next() override;
+
+  absl::Status Status() const override { return base_itr_->Status(); }
+
+  const class Key& Key() const override {
+    return from_base_ ? base_itr_->Key() : key_;
+  }
+
+  int NumColumns() const override { return columns_.size(); }
+
+  const zetasql::Value& ColumnValue(int i) const override {
+    if (!from_base_) {
+      return values_[i];
+    }
+    const zetasql::Value& value = base_itr_->ColumnValue(i);
+    return value.is_valid() ? value : nulls_[i];
+  }
+
+  // Copies the buffered mutations which have yet to be visited. The
+  // iterator no longer refers to the store afterwards.
+  void Detach() {
+    detached_ops_.emplace(buffer_itr_, buffer_end_);
+    store_ = nullptr;
+  }
+
+ private:
+  bool BufferDone() const {
+    return detached_ops_.has_value()
+               ? detached_pos_ == detached_ops_->size()
+               : buffer_itr_ == buffer_end_;
+  }
+  const class Key& BufferKey() const {
+    return detached_ops_.has_value() ? (*detached_ops_)[detached_pos_].first
+                                     : buffer_itr_->first;
+  }
+  const RowOp& BufferOp() const {
+    return detached_ops_.has_value() ? (*detached_ops_)[detached_pos_].second
+                                     : buffer_itr_->second;
+  }
+  void AdvanceBuffer() {
+    if (detached_ops_.has_value()) {
+      ++detached_pos_;
     } else {
-      // Copy the base storage column values since this row does not exists in
-      // transaction store.
-      for (int i = 0; i < columns.size(); i++) {
-        if (base_itr->ColumnValue(i).is_valid()) {
-          values.emplace_back(base_itr->ColumnValue(i));
-        } else {
-          values.emplace_back(zetasql::values::Null(columns[i]->GetType()));
-        }
+      ++buffer_itr_;
+    }
+  }
+
+  // The store whose buffered mutations are iterated over, null once detached.
+  const TransactionStore* store_ = nullptr;
+  const std::vector<const Column*> columns_;
+  const std::unique_ptr<StorageIterator> base_itr_;
+  // True if base_itr_ is positioned on a row which has not been merged yet.
+  bool base_valid_ = false;
+  // True if base_itr_ has to be advanced by the next call to Next().
+  bool advance_base_ = false;
+  // Position in the buffered mutations while attached to the store.
+  TableOps::const_iterator buffer_itr_;
+  TableOps::const_iterator buffer_end_;
+  // Remaining buffered mutations once detached from the store.
+  std::optional<std::vector<std::pair<class Key, RowOp>>> detached_ops_;
+  size_t detached_pos_ = 0;
+  // Typed NULLs returned for columns the base storage has no value for.
+  ValueList nulls_;
+  // The current row, which is either the unmodified row base_itr_ is
+  // positioned on, or the key_ and values_ merged from the buffer.
+  bool from_base_ = false;
+  class Key key_;
+  ValueList values_;
+};
+
+bool TransactionStore::MergingIterator::Next() {
+  while (true) {
+    if (advance_base_) {
+      base_valid_ = base_itr_->Next();
+      advance_base_ = false;
+    }
+    if (!base_itr_->Status().ok()) {
+      return false;
+    }
+    const bool buffer_valid = !BufferDone();
+    if (!base_valid_ && !buffer_valid) {
+      return false;
+    }
+    const int cmp = !buffer_valid  ? -1
+                    : !base_valid_ ? 1
+                                   : base_itr_->Key().Compare(BufferKey());
+    if (cmp < 0) {
+      // Copy the base storage row since it has no buffered mutation.
+      from_base_ = true;
+      advance_base_ = true;
+      return true;
+    }
+
+    const RowOp& row_op = BufferOp();
+    if (cmp == 0) {
+      advance_base_ = true;
+    } else if (row_op.first != OpType::kInsert) {
+      // Updates and deletes only apply to rows of the base storage.
+      AdvanceBuffer();
+      continue;
+    }
+    if (row_op.first == OpType::kDelete) {
+      // Omit the deletes from the output.
+      AdvanceBuffer();
+      continue;
+    }
+
+    from_base_ = false;
+    key_ = BufferKey();
+    values_.clear();
+    values_.reserve(columns_.size());
+    for (int i = 0; i < columns_.size(); ++i) {
+      if (const zetasql::Value* value = row_op.second.Find(columns_[i])) {
+        values_.push_back(*value);
+      } else if (row_op.first == OpType::kUpdate &&
+                 base_itr_->ColumnValue(i).is_valid()) {
+        // Update the base storage row with the buffered column values.
+        values_.push_back(base_itr_->ColumnValue(i));
+      } else {
+        values_.push_back(nulls_[i]);
       }
     }
-    rows.emplace_back(base_itr->Key(), std::move(values));
+    AdvanceBuffer();
+    return true;
+  }
+}
+
+TransactionStore::~TransactionStore() { DetachReaders(); }
+
+void TransactionStore::DetachReaders() {
+  ++generation_;
+  for (MergingIterator* reader : live_readers_) {
+    reader->Detach();
   }
+  live_readers_.clear();
+}
+
+absl::Status TransactionStore::Read(
+    const Table* table, const KeyRange& key_range,
+    absl::Span<const Column* const> columns,
+    std::unique_ptr<StorageIterator>* storage_itr,
+    bool allow_pending_commit_timestamps_in_read) const {
+  // Acquire locks to prevent another transaction to modify this entity.
+  ZETASQL_RETURN_IF_ERROR(AcquireReadLock(table, key_range, columns));
 
   // Pending commit timestamp values in buffer cannot be returned to
   // clients.
@@ -299,22 +429,21 @@ absl::Status TransactionStore::Read(
     ZETASQL_RETURN_IF_ERROR(commit_timestamp_tracker_->CheckRead(table, columns));
   }
 
-  // The keys need to be sorted to provide iterating in order. The rows added
-  // from buffered ops and the ones added from base storage were already in
-  // sorted order respectively. Merge these two sorted subarrays to get overall
-  // sorted order.
-  ABSL_DCHECK(buffered_rows_count <= rows.size())
-      << buffered_rows_count << " vs " << rows.size();
-  auto first_base_row_iter = rows.begin() + buffered_rows_count;
-  std::inplace_merge(rows.begin(), first_base_row_iter, rows.end(), SortByKey);
-  *storage_itr = std::make_unique<FixedRowStorageIterator>(std::move(rows));
+  // The base storage rows are merged with the buffered mutations of the same
+  // range as the returned iterator advances, see MergingIterator.
+  std::unique_ptr<StorageIterator> base_itr;
+  ZETASQL_RETURN_IF_ERROR(base_storage_->Read(absl::InfiniteFuture(), table->id(),
+                                      key_range, GetColumnIDs(columns),
+                                      &base_itr));
+  auto table_itr = buffered_ops_.find(table);
+  *storage_itr = std::make_unique<MergingIterator>(
+      this, table_itr == buffered_ops_.end() ? nullptr : &table_itr->second,
+      key_range, columns, std::move(base_itr));
   return absl::OkStatus();
 }
 
 bool TransactionStore::RowExistsInStorage(const Table* table, const Key& key) {
-  absl::Status row_in_base_storage =
-      base_storage_->Lookup(absl::InfiniteFuture(), table->id(), key, {}, {});
-  return row_in_base_storage.code() != absl::StatusCode::kNotFound;
+  return base_storage_->Exists(absl::InfiniteFuture(), table->id(), key);
 }
 
 bool TransactionStore::RowExistsInBuffer(const Table* table, const Key& key,
@@ -348,12 +477,7 @@ absl::StatusOr<ValueList> TransactionStore::Lookup(
       case OpType::kInsert: {
         // Fetch the latest value from the cell.
         for (auto column : columns) {
-          auto row_value = row_op.second.find(column);
-          if (row_value != row_op.second.end()) {
-            values.emplace_back(row_value->second);
-          } else {
-            values.emplace_back(zetasql::values::Null(column->GetType()));
-          }
+          values.emplace_back(GetColumnValueOrNull(row_op.second, column));
         }
         break;
       }
@@ -366,9 +490,8 @@ absl::StatusOr<ValueList> TransactionStore::Lookup(
         ResetInvalidValuesToNull(columns, &values);
         for (int i = 0; i < columns.size(); ++i) {
           // Update values retrieved from base storage with new values.
-          auto row_value = row_op.second.find(columns[i]);
-          if (row_value != row_op.second.end()) {
-            values[i] = row_value->second;
+          if (const zetasql::Value* value = row_op.second.Find(columns[i])) {
+            values[i] = *value;
           }
         }
         break;
@@ -387,35 +510,232 @@ absl::StatusOr<ValueList> TransactionStore::Lookup(
   return values;
 }
 
+absl::StatusOr<bool> TransactionStore::Exists(const Table* table,
+                                              const Key& key) const {
+  // Acquire locks to prevent another transaction to modify this entity.
+  ZETASQL_RETURN_IF_ERROR(
+      AcquireReadLock(table, KeyRange::Point(key), /*columns=*/{}));
+
+  // An update only exists if the row it updates exists in the base storage.
+  RowOp row_op;
+  if (RowExistsInBuffer(table, key, &row_op) &&
+      row_op.first != OpType::kUpdate) {
+    return row_op.first == OpType::kInsert;
+  }
+  return base_storage_->Exists(absl::InfiniteFuture(), table->id(), key);
+}
+
+absl::StatusOr<std::vector<std::optional<ValueList>>>
+TransactionStore::BatchLookup(
+    const Table* table, absl::Span<const Key> keys,
+    absl::Span<const Column* const> columns,
+    bool allow_pending_commit_timestamps_in_read) const {
+  // Acquire locks to prevent another transaction to modify these entities.
+  for (const Key& key : keys) {
+    lock_handle_->EnqueueLock(LockRequest(LockMode::kShared, table->id(),
+                                          KeyRange::Point(key),
+                                          GetColumnIDs(columns)));
+  }
+  ZETASQL_RETURN_IF_ERROR(lock_handle_->Wait());
+
+  // Resolve the buffered mutations for each key, and collect the keys which
+  // need to be looked up in the base storage.
+  const TableOps* table_ops = nullptr;
+  auto table_itr = buffered_ops_.find(table);
+  if (table_itr != buffered_ops_.end()) {
+    table_ops = &table_itr->second;
+  }
+  std::vector<const RowOp*> row_ops(keys.size(), nullptr);
+  std::vector<Key> base_keys;
+  std::vector<int> base_key_indexes;
+  for (int i = 0; i < keys.size(); ++i) {
+    if (table_ops != nullptr) {
+      auto op_itr = table_ops->find(keys[i]);
+      if (op_itr != table_ops->end()) {
+        row_ops[i] = &op_itr->second;
+      }
+    }
+    if (row_ops[i] == nullptr || row_ops[i]->first == OpType::kUpdate) {
+      base_keys.push_back(keys[i]);
+      base_key_indexes.push_back(i);
+    }
+  }
+  std::vector<std::optional<ValueList>> base_rows;
+  ZETASQL_RETURN_IF_ERROR(base_storage_->BatchLookup(absl::InfiniteFuture(),
+                                             table->id(), base_keys,
+                                             GetColumnIDs(columns), &base_rows));
+
+  std::vector<std::optional<ValueList>> rows(keys.size());
+  for (int j = 0; j < base_key_indexes.size(); ++j) {
+    if (base_rows[j].has_value()) {
+      ResetInvalidValuesToNull(columns, &*base_rows[j]);
+    }
+    rows[base_key_indexes[j]] = std::move(base_rows[j]);
+  }
+  for (int i = 0; i < keys.size(); ++i) {
+    if (row_ops[i] == nullptr) {
+      continue;
+    }
+    const Row& row_values = row_ops[i]->second;
+    switch (row_ops[i]->first) {
+      case OpType::kInsert: {
+        ValueList& values = rows[i].emplace();
+        for (auto column : columns) {
+          values.emplace_back(GetColumnValueOrNull(row_values, column));
+        }
+        break;
+      }
+      case OpType::kUpdate: {
+        // Values which are not included in the update come from base storage.
+        if (!rows[i].has_value()) {
+          break;
+        }
+        for (int c = 0; c < columns.size(); ++c) {
+          if (const zetasql::Value* value = row_values.Find(columns[c])) {
+            (*rows[i])[c] = *value;
+          }
+        }
+        break;
+      }
+      case OpType::kDelete: {
+        break;
+      }
+    }
+  }
+
+  // Pending commit timestamp values in buffer cannot be returned to
+  // clients.
+  if (!allow_pending_commit_timestamps_in_read) {
+    ZETASQL_RETURN_IF_ERROR(commit_timestamp_tracker_->CheckRead(table, columns));
+  }
+  return rows;
+}
+
+absl::StatusOr<bool> TransactionStore::PrefixExists(
+    const Table* table, const Key& prefix_key) const {
+  const KeyRange key_range = KeyRange::Prefix(prefix_key);
+  // Acquire locks to prevent another transaction to modify this entity.
+  ZETASQL_RETURN_IF_ERROR(AcquireReadLock(table, key_range, /*columns=*/{}));
+
+  // A buffered insert or update in the range is a row which exists. Hence any
+  // buffered mutation left in the range is a delete.
+  const TableOps* table_ops = nullptr;
+  auto table_itr = buffered_ops_.find(table);
+  if (table_itr != buffered_ops_.end()) {
+    table_ops = &table_itr->second;
+    auto end_itr = table_ops->lower_bound(key_range.limit_key());
+    for (auto itr = table_ops->lower_bound(key_range.start_key());
+         itr != end_itr; ++itr) {
+      if (itr->second.first != OpType::kDelete) {
+        return true;
+      }
+    }
+  }
+
+  // Otherwise look for a base storage row which is not deleted within the
+  // transaction.
+  std::unique_ptr<StorageIterator> base_itr;
+  ZETASQL_RETURN_IF_ERROR(base_storage_->Read(absl::InfiniteFuture(), table->id(),
+                                      key_range, /*column_ids=*/{},
+                                      &base_itr));
+  while (base_itr->Next()) {
+    if (table_ops == nullptr ||
+        table_ops->find(base_itr->Key()) == table_ops->end()) {
+      return true;
+    }
+  }
+  ZETASQL_RETURN_IF_ERROR(base_itr->Status());
+  return false;
+}
+
+WriteOp TransactionStore::ToWriteOp(const Table* table, const Key& key,
+                                    const RowOp& row_op) {
+  std::vector<const Column*> columns;
+  ValueList values;
+  row_op.second.ForEach(
+      [&](const Column* column, const zetasql::Value& value) {
+        columns.emplace_back(column);
+        values.emplace_back(value);
+      });
+  switch (row_op.first) {
+    case OpType::kInsert:
+      return InsertOp{table, key, std::move(columns), std::move(values)};
+    case OpType::kUpdate:
+      return UpdateOp{table, key, std::move(columns), std::move(values)};
+    case OpType::kDelete:
+      break;
+  }
+  return DeleteOp{table, key};
+}
+
 std::vector<WriteOp> TransactionStore::GetBufferedOps() const {
   std::vector<WriteOp> buffered_ops;
   for (const auto& entry : buffered_ops_) {
     const Table* table = entry.first;
     for (const auto& row : entry.second) {
-      const Key& key = row.first;
-      const RowOp& row_op = row.second;
+      buffered_ops.push_back(ToWriteOp(table, row.first, row.second));
+    }
+  }
+  return buffered_ops;
+}
+
+std::vector<WriteOp> TransactionStore::TakeOpsWithNewPendingCommitTimestamps() {
+  std::vector<WriteOp> ops;
+  for (const auto& [table, key] : pending_commit_timestamp_rows_) {
+    auto table_ops = buffered_ops_.find(table);
+    if (table_ops == buffered_ops_.end()) {
+      continue;
+    }
+    // The row may since have been removed from the buffer by a delete.
+    auto row = table_ops->second.find(key);
+    if (row != table_ops->second.end()) {
+      ops.push_back(ToWriteOp(table, row->first, row->second));
+    }
+  }
+  pending_commit_timestamp_rows_.clear();
+  ++generation_;
+  return ops;
+}
+
+std::vector<WriteOp> TransactionStore::TakeBufferedOps() {
+  DetachReaders();
+  std::vector<WriteOp> buffered_ops;
+  for (auto& [table, table_ops] : buffered_ops_) {
+    while (!table_ops.empty()) {
+      // Extracting the node allows moving the key out of the map.
+      auto node = table_ops.extract(table_ops.begin());
+      Key& key = node.key();
+      RowOp& row_op = node.mapped();
       std::vector<const Column*> columns;
       ValueList values;
-      for (const auto& cell : row_op.second) {
-        columns.emplace_back(cell.first);
-        values.emplace_back(cell.second);
-      }
+      columns.reserve(row_op.second.size());
+      values.reserve(row_op.second.size());
+      std::move(row_op.second)
+          .ForEach([&](const Column* column, zetasql::Value&& value) {
+            columns.emplace_back(column);
+            values.emplace_back(std::move(value));
+          });
       switch (row_op.first) {
         case OpType::kInsert: {
-          buffered_ops.emplace_back(InsertOp{table, key, columns, values});
+          buffered_ops.emplace_back(InsertOp{table, std::move(key),
+                                             std::move(columns),
+                                             std::move(values)});
           break;
         }
         case OpType::kUpdate: {
-          buffered_ops.emplace_back(UpdateOp{table, key, columns, values});
+          buffered_ops.emplace_back(UpdateOp{table, std::move(key),
+                                             std::move(columns),
+                                             std::move(values)});
           break;
         }
         case OpType::kDelete: {
-          buffered_ops.emplace_back(DeleteOp{table, key});
+          buffered_ops.emplace_back(DeleteOp{table, std::move(key)});
           break;
         }
       }
     }
   }
+  Clear();
   return buffered_ops;
 }
 
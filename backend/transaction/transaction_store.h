@@ -17,13 +17,19 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_TRANSACTION_STORE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_TRANSACTION_STORE_H_
 
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <vector>
 
 #include "zetasql/public/value.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "backend/actions/ops.h"
 #include "backend/common/ids.h"
 #include "backend/datamodel/key.h"
@@ -71,6 +77,11 @@ class TransactionStore {
         lock_handle_(lock_handle),
         commit_timestamp_tracker_(commit_timestamp_tracker) {}
 
+  ~TransactionStore();
+
+  TransactionStore(const TransactionStore&) = delete;
+  TransactionStore& operator=(const TransactionStore&) = delete;
+
   // Buffers a write operation. Acquires write locks.
   absl::Status BufferWriteOp(const WriteOp& op);
 
@@ -81,6 +92,29 @@ class TransactionStore {
       const Table* table, const Key& key,
       absl::Span<const Column* const> columns) const;
 
+  // Returns true if 'key' exists in the merged view of the buffered mutations
+  // and the base storage. Unlike Lookup, a missing key is not an error.
+  // Acquires read locks.
+  absl::StatusOr<bool> Exists(const Table* table, const Key& key) const;
+
+  // Looks up multiple keys at once with the same semantics as Lookup, except
+  // that missing keys yield std::nullopt rather than NOT_FOUND. Keys which are
+  // not resolved by the buffered mutations are looked up in a single batch in
+  // the base storage. Acquires read locks.
+  //
+  // Boolean flag allow_pending_commit_timestamps_in_read has the same meaning
+  // as for Read.
+  absl::StatusOr<std::vector<std::optional<ValueList>>> BatchLookup(
+      const Table* table, absl::Span<const Key> keys,
+      absl::Span<const Column* const> columns,
+      bool allow_pending_commit_timestamps_in_read = true) const;
+
+  // Returns true if a row with the given key prefix exists in the merged view
+  // of the buffered mutations and the base storage. Stops at the first such
+  // row instead of materializing the prefix range. Acquires read locks.
+  absl::StatusOr<bool> PrefixExists(const Table* table,
+                                    const Key& prefix_key) const;
+
   // Only reads committed values for the given key, ignoring any mutations
   // buffered within the transaction. Acquires read locks.
   absl::StatusOr<ValueList> ReadCommitted(
@@ -90,6 +124,10 @@ class TransactionStore {
   // Returns an iterator for column values of 'key_range' by merging information
   // from the buffered mutations and the base storage. Acquires read locks.
   //
+  // Rows are merged lazily as the iterator advances. The iterator reflects the
+  // buffered mutations at the time of the call: mutations buffered while it is
+  // live, or a Clear(), are not visible to it.
+  //
   // Boolean flag allow_pending_commit_timestamps_in_read can be set to false to
   // disallow returning pending_commit_timestamp values to clients.
   absl::Status Read(const Table* table, const KeyRange& key_range,
@@ -100,8 +138,23 @@ class TransactionStore {
   // Returns the buffered mutations.
   std::vector<WriteOp> GetBufferedOps() const;
 
-  // Clears the buffered mutations.
-  void Clear() { buffered_ops_.clear(); }
+  // Returns the buffered mutations of the rows which were written with pending
+  // commit timestamps in their key or values since the last call, so that
+  // tracking them costs time proportional to the new writes rather than to the
+  // whole buffer. Rows written repeatedly may be returned more than once.
+  std::vector<WriteOp> TakeOpsWithNewPendingCommitTimestamps();
+
+  // Returns the buffered mutations, moving their keys and values out of the
+  // buffer instead of copying them, and clears the buffer.
+  std::vector<WriteOp> TakeBufferedOps();
+
+  // Clears the buffered mutations and releases their memory.
+  void Clear();
+
+  // Returns a number which changes whenever the buffered mutations, or the
+  // rows reported as having pending commit timestamps, change. Readers which
+  // cache rows read from this store drop them when it changes.
+  int64_t generation() const { return generation_; }
 
  private:
   // Types of mutations.
@@ -113,6 +166,18 @@ class TransactionStore {
 
   using RowOp = std::pair<OpType, Row>;
 
+  // Buffered mutations of a single table, with nodes allocated from arena_.
+  using TableOps = std::pmr::map<Key, RowOp>;
+
+  // The iterator returned by Read, which merges the base storage rows with
+  // the buffered mutations of a key range.
+  class MergingIterator;
+
+  // Makes all live MergingIterators copy the buffered mutations they have yet
+  // to visit, so that the buffered mutations can be modified, and advances the
+  // generation. Must be called before any modification of buffered_ops_.
+  void DetachReaders();
+
   // Acquires read locks for the specified column ranges.
   absl::Status AcquireReadLock(const Table* table, const KeyRange& key_range,
                                absl::Span<const Column* const> columns) const;
@@ -140,17 +205,40 @@ class TransactionStore {
   // Returns true if a mutation has been buffered for 'key' and fills 'row'.
   bool RowExistsInBuffer(const Table* table, const Key& key, RowOp* row) const;
 
+  // Returns the buffered mutations of 'table', creating them if needed.
+  TableOps& MutableTableOps(const Table* table);
+
+  // Returns the write op for the buffered mutation 'row_op' of 'key'.
+  static WriteOp ToWriteOp(const Table* table, const Key& key,
+                           const RowOp& row_op);
+
   // Underlying storage for the database.
   const Storage* base_storage_;
 
   // Handle for the lock manager.
   LockHandle* lock_handle_;
 
+  // Arena for the buffered mutations. Bulk loads buffer a very large number
+  // of rows per transaction, so map nodes are carved out of a monotonic arena
+  // which is released in one shot by Clear() instead of node by node. Declared
+  // before buffered_ops_ so that it outlives the maps that allocate from it.
+  std::pmr::monotonic_buffer_resource arena_;
+
   // Map that stores the buffered mutations.
-  absl::flat_hash_map<const Table*, std::map<Key, RowOp>> buffered_ops_;
+  absl::flat_hash_map<const Table*, TableOps> buffered_ops_;
 
   // Tracks tables/columns containing pending commit timestamps.
   const CommitTimestampTracker* commit_timestamp_tracker_;
+
+  // Rows written with pending commit timestamps since the last call to
+  // TakeOpsWithNewPendingCommitTimestamps.
+  std::vector<std::pair<const Table*, Key>> pending_commit_timestamp_rows_;
+
+  // The MergingIterators which still iterate directly over buffered_ops_.
+  mutable absl::flat_hash_set<MergingIterator*> live_readers_;
+
+  // See generation().
+  int64_t generation_ = 0;
 };
 
 }  // namespace backend
@@ -17,6 +17,7 @@
 #include "backend/transaction/transaction_store.h"
 
 #include <memory>
+#include <variant>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -33,6 +34,7 @@
 #include "backend/storage/in_memory_storage.h"
 #include "backend/transaction/commit_timestamp.h"
 #include "common/clock.h"
+#include "common/constants.h"
 #include "tests/common/schema_constructor.h"
 
 using zetasql::types::StringType;
@@ -254,6 +256,84 @@ TEST_F(TransactionStoreTest, CanBufferDeleteInsertUpdate) {
   EXPECT_THAT(ReadAll(), IsOkAndHoldsRows({{Int64(1), String("value-3")}}));
 }
 
+TEST_F(TransactionStoreTest, CanBufferWritesAfterClear) {
+  for (int i = 0; i < 1000; ++i) {
+    ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(i)}), {int64_col_, string_col_},
+                           {Int64(i), String("value")}));
+  }
+  transaction_store_.Clear();
+  EXPECT_TRUE(transaction_store_.GetBufferedOps().empty());
+  EXPECT_THAT(ReadAll(), IsOkAndHoldsRows({}));
+
+  // The store remains usable once its buffer has been released.
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(1)}), {int64_col_, string_col_},
+                         {Int64(1), String("new-value")}));
+  EXPECT_THAT(ReadAll(), IsOkAndHoldsRows({{Int64(1), String("new-value")}}));
+}
+
+TEST_F(TransactionStoreTest, TakeBufferedOpsClearsBuffer) {
+  absl::Time t0 = absl::Now();
+  ZETASQL_EXPECT_OK(Write(t0, Key({Int64(2)}), {Int64(2), String("value-1")}));
+
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(1)}), {int64_col_, string_col_},
+                         {Int64(1), String("value-2")}));
+  ZETASQL_EXPECT_OK(BufferDelete(Key({Int64(2)})));
+
+  std::vector<WriteOp> ops = transaction_store_.TakeBufferedOps();
+  ASSERT_EQ(ops.size(), 2);
+  const InsertOp* insert_op = std::get_if<InsertOp>(&ops[0]);
+  ASSERT_NE(insert_op, nullptr);
+  EXPECT_EQ(insert_op->key, Key({Int64(1)}));
+  EXPECT_EQ(insert_op->values.size(), 2);
+  const DeleteOp* delete_op = std::get_if<DeleteOp>(&ops[1]);
+  ASSERT_NE(delete_op, nullptr);
+  EXPECT_EQ(delete_op->key, Key({Int64(2)}));
+
+  EXPECT_TRUE(transaction_store_.GetBufferedOps().empty());
+  EXPECT_THAT(ReadAll(), IsOkAndHoldsRows({{Int64(2), String("value-1")}}));
+}
+
+TEST_F(TransactionStoreTest, TakesOpsWithNewPendingCommitTimestamps) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<const Schema> schema,
+      test::CreateSchemaFromDDL(
+          {
+              R"(
+                CREATE TABLE CommitTimestampTable (
+                  Int64Col  INT64 NOT NULL,
+                  TsCol     TIMESTAMP OPTIONS (allow_commit_timestamp = true),
+                ) PRIMARY KEY (Int64Col)
+              )"},
+          type_factory_.get()));
+  const Table* table = schema->FindTable("CommitTimestampTable");
+  std::vector<const Column*> columns = {table->FindColumn("Int64Col"),
+                                        table->FindColumn("TsCol")};
+  zetasql::Value pending =
+      zetasql::values::Timestamp(kCommitTimestampValueSentinel);
+  zetasql::Value timestamp = zetasql::values::Timestamp(absl::Now());
+
+  ZETASQL_EXPECT_OK(transaction_store_.BufferWriteOp(
+      InsertOp{table, Key({Int64(1)}), columns, {Int64(1), pending}}));
+  ZETASQL_EXPECT_OK(transaction_store_.BufferWriteOp(
+      InsertOp{table, Key({Int64(2)}), columns, {Int64(2), timestamp}}));
+  std::vector<WriteOp> ops =
+      transaction_store_.TakeOpsWithNewPendingCommitTimestamps();
+  ASSERT_EQ(ops.size(), 1);
+  const InsertOp* insert_op = std::get_if<InsertOp>(&ops[0]);
+  ASSERT_NE(insert_op, nullptr);
+  EXPECT_EQ(insert_op->key, Key({Int64(1)}));
+
+  // Rows already taken are not returned again unless they are rewritten.
+  EXPECT_TRUE(
+      transaction_store_.TakeOpsWithNewPendingCommitTimestamps().empty());
+  ZETASQL_EXPECT_OK(transaction_store_.BufferWriteOp(
+      UpdateOp{table, Key({Int64(2)}), {columns[1]}, {pending}}));
+  ops = transaction_store_.TakeOpsWithNewPendingCommitTimestamps();
+  ASSERT_EQ(ops.size(), 1);
+  EXPECT_EQ(std::get<InsertOp>(ops[0]).key, Key({Int64(2)}));
+  EXPECT_EQ(transaction_store_.GetBufferedOps().size(), 2);
+}
+
 TEST_F(TransactionStoreTest, ReadValueNotFound) {
   // Read on empty table.
   EXPECT_THAT(ReadAll(), IsOkAndHoldsRows({}));
@@ -298,6 +378,66 @@ TEST_F(TransactionStoreTest, Lookup) {
   EXPECT_THAT(Lookup(Key({Int64(3)})), StatusIs(absl::StatusCode::kNotFound));
 }
 
+TEST_F(TransactionStoreTest, PrefixExists) {
+  absl::Time t0 = absl::Now();
+  ZETASQL_EXPECT_OK(Write(t0, Key({Int64(1)}), {Int64(1), String("value-1")}));
+  ZETASQL_EXPECT_OK(Write(t0, Key({Int64(2)}), {Int64(2), String("value-2")}));
+  EXPECT_THAT(transaction_store_.PrefixExists(table_, Key()),
+              zetasql_base::testing::IsOkAndHolds(true));
+
+  // Rows deleted within the transaction do not exist.
+  ZETASQL_EXPECT_OK(BufferDelete(Key({Int64(1)})));
+  ZETASQL_EXPECT_OK(BufferDelete(Key({Int64(2)})));
+  EXPECT_THAT(transaction_store_.PrefixExists(table_, Key()),
+              zetasql_base::testing::IsOkAndHolds(false));
+
+  // Rows inserted within the transaction exist.
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(3)}), {int64_col_, string_col_},
+                         {Int64(3), String("value-3")}));
+  EXPECT_THAT(transaction_store_.PrefixExists(table_, Key()),
+              zetasql_base::testing::IsOkAndHolds(true));
+  EXPECT_THAT(transaction_store_.PrefixExists(table_, Key({Int64(2)})),
+              zetasql_base::testing::IsOkAndHolds(false));
+}
+
+TEST_F(TransactionStoreTest, Exists) {
+  absl::Time t0 = absl::Now();
+  ZETASQL_EXPECT_OK(Write(t0, Key({Int64(1)}), {Int64(1), String("value-1")}));
+  EXPECT_THAT(transaction_store_.Exists(table_, Key({Int64(1)})),
+              zetasql_base::testing::IsOkAndHolds(true));
+  EXPECT_THAT(transaction_store_.Exists(table_, Key({Int64(2)})),
+              zetasql_base::testing::IsOkAndHolds(false));
+
+  // Buffered mutations take precedence over the base storage.
+  ZETASQL_EXPECT_OK(BufferDelete(Key({Int64(1)})));
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(2)}), {int64_col_, string_col_},
+                         {Int64(2), String("value-2")}));
+  EXPECT_THAT(transaction_store_.Exists(table_, Key({Int64(1)})),
+              zetasql_base::testing::IsOkAndHolds(false));
+  EXPECT_THAT(transaction_store_.Exists(table_, Key({Int64(2)})),
+              zetasql_base::testing::IsOkAndHolds(true));
+
+  // An update of a missing row does not make it exist.
+  ZETASQL_EXPECT_OK(
+      BufferUpdate(Key({Int64(3)}), {string_col_}, {String("value-3")}));
+  EXPECT_THAT(transaction_store_.Exists(table_, Key({Int64(3)})),
+              zetasql_base::testing::IsOkAndHolds(false));
+}
+
+TEST_F(TransactionStoreTest, GenerationChangesWithBufferedMutations) {
+  int64_t generation = transaction_store_.generation();
+  EXPECT_THAT(Lookup(Key({Int64(1)})), StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_EQ(transaction_store_.generation(), generation);
+
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(1)}), {int64_col_, string_col_},
+                         {Int64(1), String("value")}));
+  EXPECT_NE(transaction_store_.generation(), generation);
+  generation = transaction_store_.generation();
+
+  transaction_store_.Clear();
+  EXPECT_NE(transaction_store_.generation(), generation);
+}
+
 TEST_F(TransactionStoreTest, LookupDelete) {
   EXPECT_THAT(Lookup(Key({Int64(1)})), StatusIs(absl::StatusCode::kNotFound));
 
@@ -373,6 +513,60 @@ TEST_F(TransactionStoreTest, ReadsClosedOpenRange) {
               IsOkAndHoldsRows({}));
 }
 
+TEST_F(TransactionStoreTest, ReadMergesInterleavedBaseAndBufferedRows) {
+  absl::Time t0 = absl::Now();
+  for (int key : {1, 3, 5, 7}) {
+    ZETASQL_EXPECT_OK(
+        Write(t0, Key({Int64(key)}), {Int64(key), String("base")}));
+  }
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(0)}), {int64_col_, string_col_},
+                         {Int64(0), String("new")}));
+  ZETASQL_EXPECT_OK(
+      BufferUpdate(Key({Int64(3)}), {string_col_}, {String("updated")}));
+  ZETASQL_EXPECT_OK(BufferDelete(Key({Int64(5)})));
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(6)}), {int64_col_, string_col_},
+                         {Int64(6), String("new")}));
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(8)}), {int64_col_}, {Int64(8)}));
+
+  EXPECT_THAT(ReadAll(), IsOkAndHoldsRows({{Int64(0), String("new")},
+                                           {Int64(1), String("base")},
+                                           {Int64(3), String("updated")},
+                                           {Int64(6), String("new")},
+                                           {Int64(7), String("base")},
+                                           {Int64(8), Null(StringType())}}));
+}
+
+TEST_F(TransactionStoreTest, ReadIsUnaffectedByLaterWrites) {
+  absl::Time t0 = absl::Now();
+  ZETASQL_EXPECT_OK(Write(t0, Key({Int64(1)}), {Int64(1), String("base")}));
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(2)}), {int64_col_, string_col_},
+                         {Int64(2), String("new")}));
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(3)}), {int64_col_, string_col_},
+                         {Int64(3), String("new")}));
+
+  std::unique_ptr<StorageIterator> itr;
+  ZETASQL_ASSERT_OK(transaction_store_.Read(table_, KeyRange::All(),
+                                    {int64_col_, string_col_}, &itr));
+  ASSERT_TRUE(itr->Next());
+  EXPECT_EQ(itr->Key(), Key({Int64(1)}));
+
+  // Mutations buffered while the iterator is live are not visible to it.
+  ZETASQL_EXPECT_OK(BufferDelete(Key({Int64(2)})));
+  ZETASQL_EXPECT_OK(
+      BufferUpdate(Key({Int64(3)}), {string_col_}, {String("updated")}));
+  ZETASQL_EXPECT_OK(BufferInsert(Key({Int64(4)}), {int64_col_}, {Int64(4)}));
+  transaction_store_.Clear();
+
+  ASSERT_TRUE(itr->Next());
+  EXPECT_EQ(itr->Key(), Key({Int64(2)}));
+  EXPECT_EQ(itr->ColumnValue(1), String("new"));
+  ASSERT_TRUE(itr->Next());
+  EXPECT_EQ(itr->Key(), Key({Int64(3)}));
+  EXPECT_EQ(itr->ColumnValue(1), String("new"));
+  EXPECT_FALSE(itr->Next());
+  ZETASQL_EXPECT_OK(itr->Status());
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
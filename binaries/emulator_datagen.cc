@@ -0,0 +1,147 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Synthetic data generator which builds a benchmark database for a schema.
+//
+// The database is created with the schema in --ddl_file, and the rows of all
+// its tables are generated (see backend::GenerateTableData) and bulk imported.
+// The result is written to --output_snapshot, which the emulator serves by
+// restoring it at startup with --database_snapshots. The same schema, flags
+// and --seed always produce the same data:
+//
+//   bazel run -c opt //binaries:emulator_datagen -- \
+//     --ddl_file=/tmp/schema.sql --rows_per_table=10000000 \
+//     --output_snapshot=/tmp/db.snapshot
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "zetasql/base/logging.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "backend/database/bulk_import.h"
+#include "backend/database/data_generator.h"
+#include "backend/database/database.h"
+#include "backend/database/snapshot.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "common/clock.h"
+#include "common/errors.h"
+#include "zetasql/base/status_macros.h"
+
+ABSL_FLAG(std::string, ddl_file, "",
+          "File with the DDL statements of the database schema, separated by "
+          "semicolons.");
+ABSL_FLAG(int64_t, rows_per_table, 1000,
+          "Number of rows generated for each table which is not interleaved.");
+ABSL_FLAG(int64_t, rows_per_parent, 10,
+          "Number of rows generated for each interleaved table, per row of its "
+          "parent table.");
+ABSL_FLAG(double, null_probability, 0.1,
+          "Probability for a value of a nullable column to be NULL.");
+ABSL_FLAG(uint64_t, seed, 0, "Seed of the generated data.");
+ABSL_FLAG(std::string, output_snapshot, "",
+          "File the snapshot of the generated database is written to.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace {
+
+absl::StatusOr<std::vector<std::string>> ReadDdlStatements(
+    const std::string& path) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    return error::Internal(absl::StrCat("Failed to open DDL file ", path));
+  }
+  std::stringstream contents;
+  contents << in.rdbuf();
+  std::vector<std::string> statements;
+  for (absl::string_view statement : absl::StrSplit(contents.str(), ';')) {
+    statement = absl::StripAsciiWhitespace(statement);
+    if (!statement.empty()) {
+      statements.emplace_back(statement);
+    }
+  }
+  return statements;
+}
+
+absl::Status Run() {
+  if (absl::GetFlag(FLAGS_output_snapshot).empty()) {
+    return error::Internal("--output_snapshot is required.");
+  }
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<std::string> statements,
+                   ReadDdlStatements(absl::GetFlag(FLAGS_ddl_file)));
+  Clock clock;
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::unique_ptr<backend::Database> database,
+      backend::Database::Create(
+          &clock, backend::SchemaChangeOperation{.statements = statements}));
+
+  backend::DataGeneratorOptions options{
+      .rows_per_table = absl::GetFlag(FLAGS_rows_per_table),
+      .rows_per_parent = absl::GetFlag(FLAGS_rows_per_parent),
+      .null_probability = absl::GetFlag(FLAGS_null_probability),
+      .seed = absl::GetFlag(FLAGS_seed)};
+  absl::Time start = absl::Now();
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::vector<backend::TableImport> imports,
+      backend::GenerateTableData(database->GetLatestSchema(), options));
+  int64_t num_rows = 0;
+  for (const backend::TableImport& import : imports) {
+    ABSL_LOG(INFO) << "Generated " << import.rows.size() << " rows for table "
+                   << import.table->Name();
+    num_rows += import.rows.size();
+  }
+  ABSL_LOG(INFO) << "Generated " << num_rows << " rows in "
+                 << absl::Now() - start;
+
+  start = absl::Now();
+  ZETASQL_RETURN_IF_ERROR(database->BulkImport(std::move(imports)).status());
+  ABSL_LOG(INFO) << "Imported " << num_rows << " rows in "
+                 << absl::Now() - start;
+
+  return backend::WriteDatabaseSnapshotToFile(
+      database.get(), absl::GetFlag(FLAGS_output_snapshot));
+}
+
+}  // namespace
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  absl::Status status = google::spanner::emulator::Run();
+  if (!status.ok()) {
+    ABSL_LOG(ERROR) << "Data generation failed: " << status;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
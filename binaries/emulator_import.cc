@@ -0,0 +1,370 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Bulk import tool which builds an emulator database from CSV files.
+//
+// The database is created with the schema in --ddl_file, the CSV files are
+// parsed in parallel and bulk imported (see backend::Database::BulkImport),
+// and the result is written to --output_snapshot. The emulator then serves
+// the database by restoring the snapshot at startup:
+//
+//   bazel run -c opt //binaries:emulator_import -- \
+//     --ddl_file=/tmp/schema.sql --import=Singers=/tmp/singers.csv \
+//     --output_snapshot=/tmp/db.snapshot
+//   gateway_main --database_snapshots=projects/p/instances/i/databases/d=\
+//     /tmp/db.snapshot
+//
+// The first line of each CSV file names the imported columns. Fields are
+// converted as the values of the Cloud Spanner API are: INT64, NUMERIC, BYTES
+// (base64), DATE and TIMESTAMP fields use their API string encoding, ARRAY
+// fields are JSON lists and empty unquoted fields are NULL.
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/struct.pb.h"
+#include "zetasql/public/type.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "zetasql/base/logging.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "backend/database/bulk_import.h"
+#include "backend/database/database.h"
+#include "backend/database/snapshot.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/schema/updater/schema_updater.h"
+#include "common/clock.h"
+#include "common/errors.h"
+#include "frontend/converters/values.h"
+#include "google/protobuf/json/json.h"
+#include "zetasql/base/status_macros.h"
+
+ABSL_FLAG(std::string, ddl_file, "",
+          "File with the DDL statements of the database schema, separated by "
+          "semicolons.");
+ABSL_FLAG(std::vector<std::string>, import, {},
+          "Comma-separated list of <table>=<csv_path> pairs. A table may be "
+          "listed more than once, to import several files into it.");
+ABSL_FLAG(std::string, output_snapshot, "",
+          "File the snapshot of the imported database is written to.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace {
+
+// A field of a CSV record. Quoting distinguishes empty strings from NULLs.
+struct CsvField {
+  std::string text;
+  bool quoted = false;
+};
+
+using CsvRecord = std::vector<CsvField>;
+
+// A CSV file to import into a table.
+struct ImportFile {
+  std::string table_name;
+  std::string path;
+};
+
+absl::StatusOr<std::string> ReadFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) {
+    return error::InvalidImportFile(path, "file cannot be opened");
+  }
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+// Splits `contents` into RFC 4180 records. Quoted fields may contain commas,
+// line breaks and doubled quotes.
+absl::StatusOr<std::vector<CsvRecord>> ParseCsv(const std::string& path,
+                                                absl::string_view contents) {
+  std::vector<CsvRecord> records;
+  CsvRecord record;
+  CsvField field;
+  size_t i = 0;
+  auto end_field = [&]() {
+    record.push_back(std::move(field));
+    field = CsvField();
+  };
+  while (i < contents.size()) {
+    char c = contents[i];
+    if (c == '"' && field.text.empty() && !field.quoted) {
+      field.quoted = true;
+      ++i;
+      while (true) {
+        if (i >= contents.size()) {
+          return error::InvalidImportFile(
+              path, absl::StrCat("unterminated quoted field in record ",
+                                 records.size() + 1));
+        }
+        if (contents[i] == '"') {
+          if (i + 1 < contents.size() && contents[i + 1] == '"') {
+            field.text.push_back('"');
+            i += 2;
+            continue;
+          }
+          ++i;
+          break;
+        }
+        field.text.push_back(contents[i++]);
+      }
+      continue;
+    }
+    if (c == ',') {
+      end_field();
+    } else if (c == '\n' || c == '\r') {
+      end_field();
+      records.push_back(std::move(record));
+      record.clear();
+      if (c == '\r' && i + 1 < contents.size() && contents[i + 1] == '\n') {
+        ++i;
+      }
+    } else if (field.quoted) {
+      return error::InvalidImportFile(
+          path, absl::StrCat("unexpected characters after a quoted field in "
+                             "record ",
+                             records.size() + 1));
+    } else {
+      field.text.push_back(c);
+    }
+    ++i;
+  }
+  if (!record.empty() || !field.text.empty() || field.quoted) {
+    end_field();
+    records.push_back(std::move(record));
+  }
+  return records;
+}
+
+// Converts `field` into the Cloud Spanner API encoding of a value of `type`.
+// Fails with the reason if it cannot be.
+absl::StatusOr<google::protobuf::Value> FieldToProto(
+    const CsvField& field, const zetasql::Type* type) {
+  google::protobuf::Value value_pb;
+  if (field.text.empty() && !field.quoted) {
+    value_pb.set_null_value(google::protobuf::NULL_VALUE);
+  } else if (type->IsArray()) {
+    if (!google::protobuf::json::JsonStringToMessage(field.text, &value_pb)
+             .ok()) {
+      return absl::InvalidArgumentError("ARRAY fields must be JSON lists");
+    }
+  } else if (type->IsBool()) {
+    std::string text = absl::AsciiStrToLower(field.text);
+    if (text != "true" && text != "false") {
+      return absl::InvalidArgumentError("BOOL fields must be true or false");
+    }
+    value_pb.set_bool_value(text == "true");
+  } else if (type->IsDouble() || type->IsFloat()) {
+    double number;
+    if (absl::SimpleAtod(field.text, &number)) {
+      value_pb.set_number_value(number);
+    } else {
+      // NaN and infinities use their string encodings.
+      value_pb.set_string_value(field.text);
+    }
+  } else {
+    value_pb.set_string_value(field.text);
+  }
+  return value_pb;
+}
+
+absl::StatusOr<zetasql::Value> ParseField(const CsvField& field,
+                                          const zetasql::Type* type) {
+  ZETASQL_ASSIGN_OR_RETURN(google::protobuf::Value value_pb,
+                   FieldToProto(field, type));
+  return frontend::ValueFromProto(value_pb, type);
+}
+
+// Parses the CSV file of `file` into the rows of an import of its table.
+absl::StatusOr<backend::TableImport> ParseImportFile(
+    const ImportFile& file, const backend::Schema* schema) {
+  const backend::Table* table = schema->FindTable(file.table_name);
+  if (table == nullptr) {
+    return error::TableNotFound(file.table_name);
+  }
+  ZETASQL_ASSIGN_OR_RETURN(std::string contents, ReadFile(file.path));
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<CsvRecord> records,
+                   ParseCsv(file.path, contents));
+  contents.clear();
+  if (records.empty()) {
+    return error::InvalidImportFile(file.path, "missing header line");
+  }
+
+  backend::TableImport import{.table = table};
+  for (const CsvField& name : records[0]) {
+    const backend::Column* column = table->FindColumn(name.text);
+    if (column == nullptr) {
+      return error::ColumnNotFound(table->Name(), name.text);
+    }
+    import.columns.push_back(column);
+  }
+  import.rows.reserve(records.size() - 1);
+  for (int i = 1; i < records.size(); ++i) {
+    const CsvRecord& record = records[i];
+    if (record.size() == 1 && record[0].text.empty() && !record[0].quoted) {
+      // Blank lines are skipped.
+      continue;
+    }
+    if (record.size() != import.columns.size()) {
+      return error::InvalidImportFile(
+          file.path, absl::StrCat("line ", i + 1, " has ", record.size(),
+                                  " fields, expected ",
+                                  import.columns.size()));
+    }
+    backend::ValueList values;
+    values.reserve(record.size());
+    for (int j = 0; j < record.size(); ++j) {
+      absl::StatusOr<zetasql::Value> value =
+          ParseField(record[j], import.columns[j]->GetType());
+      if (!value.ok()) {
+        return error::InvalidImportFile(
+            file.path, absl::StrCat("line ", i + 1, ", column ",
+                                    import.columns[j]->Name(), ": ",
+                                    value.status().message()));
+      }
+      values.push_back(*std::move(value));
+    }
+    import.rows.push_back(std::move(values));
+  }
+  return import;
+}
+
+absl::StatusOr<std::vector<std::string>> ReadDdlStatements(
+    const std::string& path) {
+  ZETASQL_ASSIGN_OR_RETURN(std::string contents, ReadFile(path));
+  std::vector<std::string> statements;
+  for (absl::string_view statement : absl::StrSplit(contents, ';')) {
+    statement = absl::StripAsciiWhitespace(statement);
+    if (!statement.empty()) {
+      statements.emplace_back(statement);
+    }
+  }
+  return statements;
+}
+
+absl::Status Run() {
+  std::vector<ImportFile> files;
+  for (const std::string& spec : absl::GetFlag(FLAGS_import)) {
+    std::vector<std::string> parts =
+        absl::StrSplit(spec, absl::MaxSplits('=', 1));
+    if (parts.size() != 2 || parts[0].empty() || parts[1].empty()) {
+      return error::InvalidImportFile(spec, "expected <table>=<csv_path>");
+    }
+    files.push_back(ImportFile{.table_name = parts[0], .path = parts[1]});
+  }
+  if (absl::GetFlag(FLAGS_output_snapshot).empty()) {
+    return error::Internal("--output_snapshot is required.");
+  }
+
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<std::string> statements,
+                   ReadDdlStatements(absl::GetFlag(FLAGS_ddl_file)));
+  Clock clock;
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::unique_ptr<backend::Database> database,
+      backend::Database::Create(
+          &clock, backend::SchemaChangeOperation{.statements = statements}));
+  const backend::Schema* schema = database->GetLatestSchema();
+
+  // Files are parsed in parallel, one thread per file.
+  absl::Time start = absl::Now();
+  std::vector<absl::StatusOr<backend::TableImport>> parsed(files.size());
+  {
+    std::vector<std::thread> threads;
+    threads.reserve(files.size());
+    for (int i = 0; i < files.size(); ++i) {
+      threads.emplace_back([&, i]() {
+        parsed[i] = ParseImportFile(files[i], schema);
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+
+  // Files of the same table are merged into a single import, which requires
+  // them to name the same columns.
+  std::vector<backend::TableImport> imports;
+  absl::flat_hash_map<const backend::Table*, int> import_of_table;
+  int64_t num_rows = 0;
+  for (int i = 0; i < files.size(); ++i) {
+    ZETASQL_RETURN_IF_ERROR(parsed[i].status());
+    backend::TableImport& file_import = *parsed[i];
+    num_rows += file_import.rows.size();
+    auto [it, inserted] =
+        import_of_table.emplace(file_import.table, imports.size());
+    if (inserted) {
+      imports.push_back(std::move(file_import));
+      continue;
+    }
+    backend::TableImport& table_import = imports[it->second];
+    if (table_import.columns != file_import.columns) {
+      return error::InvalidImportFile(
+          files[i].path,
+          absl::StrCat("columns differ from the other files of table ",
+                       table_import.table->Name()));
+    }
+    for (backend::ValueList& row : file_import.rows) {
+      table_import.rows.push_back(std::move(row));
+    }
+  }
+  parsed.clear();
+  ABSL_LOG(INFO) << "Parsed " << num_rows << " rows from " << files.size()
+                 << " files in " << absl::Now() - start;
+
+  start = absl::Now();
+  ZETASQL_RETURN_IF_ERROR(database->BulkImport(std::move(imports)).status());
+  ABSL_LOG(INFO) << "Imported " << num_rows << " rows in "
+                 << absl::Now() - start;
+
+  return backend::WriteDatabaseSnapshotToFile(
+      database.get(), absl::GetFlag(FLAGS_output_snapshot));
+}
+
+}  // namespace
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  absl::Status status = google::spanner::emulator::Run();
+  if (!status.ok()) {
+    ABSL_LOG(ERROR) << "Import failed: " << status;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,376 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Load generator which drives an emulator through the full gRPC frontend.
+//
+// By default an in-process frontend::Server is started (the same way the
+// conformance tests do) so that the numbers include request parsing, session
+// and transaction handling and result streaming. Pass --emulator_host_port to
+// target an already running emulator instead.
+//
+// Each workload runs for --duration against a table preloaded with --num_rows
+// rows, and reports its throughput and latency percentiles:
+//
+//   bazel run -c opt //binaries:emulator_loadgen -- \
+//     --workloads=point_read,commit --num_threads=16 --duration=30s
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "google/spanner/admin/database/v1/spanner_database_admin.pb.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "zetasql/base/logging.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "google/cloud/common_options.h"
+#include "google/cloud/grpc_options.h"
+#include "google/cloud/spanner/admin/database_admin_client.h"
+#include "google/cloud/spanner/admin/instance_admin_client.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/create_instance_request_builder.h"
+#include "frontend/server/server.h"
+#include "grpcpp/security/credentials.h"
+
+ABSL_FLAG(std::string, emulator_host_port, "",
+          "Address of a running emulator to drive. If empty, an in-process "
+          "emulator server is started.");
+ABSL_FLAG(std::string, workloads,
+          "point_read,range_scan,commit,batch_dml,change_stream",
+          "Comma separated list of workloads to run, in order. Supported "
+          "workloads are point_read, range_scan, commit, batch_dml and "
+          "change_stream.");
+ABSL_FLAG(int, num_threads, 8, "Number of concurrent clients per workload.");
+ABSL_FLAG(absl::Duration, duration, absl::Seconds(10),
+          "How long each workload runs.");
+ABSL_FLAG(int64_t, num_rows, 10000, "Number of rows preloaded in the table.");
+ABSL_FLAG(int, scan_length, 100, "Number of rows read by each range scan.");
+ABSL_FLAG(int, batch_size, 10, "Number of statements in each batch DML.");
+ABSL_FLAG(int, value_size, 100, "Size in bytes of each row's value.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace {
+
+namespace cloud_spanner = ::google::cloud::spanner;
+
+constexpr char kProjectId[] = "loadgen-project";
+constexpr char kInstanceId[] = "loadgen-instance";
+constexpr char kDatabaseId[] = "loadgen-database";
+constexpr char kTableName[] = "Usertable";
+constexpr char kChangeStreamName[] = "UsertableStream";
+
+// Number of rows written by each commit while preloading the table.
+constexpr int64_t kPreloadBatchSize = 500;
+
+absl::Status ToStatus(const google::cloud::Status& status) {
+  return absl::Status(static_cast<absl::StatusCode>(status.code()),
+                      status.message());
+}
+
+// Keys are zero padded so that their string order matches the numeric order
+// and range scans read contiguous key ranges.
+std::string KeyFor(int64_t i) { return absl::StrFormat("user%010d", i); }
+
+// Runs a single operation of a workload and returns its outcome.
+using Operation = std::function<absl::Status(std::mt19937_64* random)>;
+
+// Outcome of running a workload.
+struct WorkloadResult {
+  int64_t ok_count = 0;
+  int64_t error_count = 0;
+  absl::Duration elapsed;
+  // Latencies of successful operations, sorted.
+  std::vector<absl::Duration> latencies;
+
+  absl::Duration Percentile(double p) const {
+    if (latencies.empty()) return absl::ZeroDuration();
+    size_t index = static_cast<size_t>(p * (latencies.size() - 1));
+    return latencies[index];
+  }
+};
+
+class LoadGenerator {
+ public:
+  explicit LoadGenerator(google::cloud::Options options)
+      : options_(std::move(options)),
+        database_(kProjectId, kInstanceId, kDatabaseId),
+        client_(cloud_spanner::MakeConnection(database_, options_)) {}
+
+  // Creates the instance and database and preloads --num_rows rows.
+  absl::Status Setup() {
+    google::cloud::spanner_admin::InstanceAdminClient instance_client(
+        google::cloud::spanner_admin::MakeInstanceAdminConnection(options_));
+    auto instance = instance_client
+                        .CreateInstance(
+                            cloud_spanner::CreateInstanceRequestBuilder(
+                                database_.instance(), "emulator-config")
+                                .SetDisplayName(kInstanceId)
+                                .SetNodeCount(1)
+                                .Build())
+                        .get();
+    if (!instance) return ToStatus(instance.status());
+
+    google::cloud::spanner_admin::DatabaseAdminClient database_client(
+        google::cloud::spanner_admin::MakeDatabaseAdminConnection(options_));
+    google::spanner::admin::database::v1::CreateDatabaseRequest request;
+    request.set_parent(database_.instance().FullName());
+    request.set_create_statement(
+        absl::StrCat("CREATE DATABASE `", kDatabaseId, "`"));
+    request.add_extra_statements(
+        absl::StrCat("CREATE TABLE ", kTableName,
+                     "(Key STRING(MAX) NOT NULL, Counter INT64, "
+                     "Value STRING(MAX)) PRIMARY KEY (Key)"));
+    request.add_extra_statements(absl::StrCat(
+        "CREATE CHANGE STREAM ", kChangeStreamName, " FOR ", kTableName));
+    auto database = database_client.CreateDatabase(request).get();
+    if (!database) return ToStatus(database.status());
+
+    const int64_t num_rows = absl::GetFlag(FLAGS_num_rows);
+    for (int64_t start = 0; start < num_rows; start += kPreloadBatchSize) {
+      cloud_spanner::InsertMutationBuilder builder(
+          kTableName, {"Key", "Counter", "Value"});
+      for (int64_t i = start; i < std::min(num_rows, start + kPreloadBatchSize);
+           ++i) {
+        builder.EmplaceRow(KeyFor(i), int64_t{0}, value_);
+      }
+      auto commit = client_.Commit(cloud_spanner::Mutations{builder.Build()});
+      if (!commit) return ToStatus(commit.status());
+    }
+    return absl::OkStatus();
+  }
+
+  // Returns the operation implementing `workload`, or nullptr if unknown.
+  Operation OperationFor(const std::string& workload) {
+    if (workload == "point_read") {
+      return [this](std::mt19937_64* random) { return PointRead(random); };
+    } else if (workload == "range_scan") {
+      return [this](std::mt19937_64* random) { return RangeScan(random); };
+    } else if (workload == "commit") {
+      return [this](std::mt19937_64* random) { return Commit(random); };
+    } else if (workload == "batch_dml") {
+      return [this](std::mt19937_64* random) { return BatchDml(random); };
+    } else if (workload == "change_stream") {
+      return [this](std::mt19937_64* random) { return TailChangeStream(); };
+    }
+    return nullptr;
+  }
+
+  // Runs `operation` from --num_threads threads for --duration.
+  WorkloadResult Run(const Operation& operation) {
+    const int num_threads = absl::GetFlag(FLAGS_num_threads);
+    const absl::Time start = absl::Now();
+    const absl::Time deadline = start + absl::GetFlag(FLAGS_duration);
+
+    std::vector<WorkloadResult> thread_results(num_threads);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t] {
+        std::mt19937_64 random(t);
+        WorkloadResult& result = thread_results[t];
+        for (absl::Time now = absl::Now(); now < deadline;) {
+          absl::Status status = operation(&random);
+          absl::Time done = absl::Now();
+          if (status.ok()) {
+            ++result.ok_count;
+            result.latencies.push_back(done - now);
+          } else {
+            ++result.error_count;
+          }
+          now = done;
+        }
+      });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    WorkloadResult result;
+    result.elapsed = absl::Now() - start;
+    for (WorkloadResult& thread_result : thread_results) {
+      result.ok_count += thread_result.ok_count;
+      result.error_count += thread_result.error_count;
+      result.latencies.insert(result.latencies.end(),
+                              thread_result.latencies.begin(),
+                              thread_result.latencies.end());
+    }
+    std::sort(result.latencies.begin(), result.latencies.end());
+    return result;
+  }
+
+ private:
+  int64_t RandomRow(std::mt19937_64* random) {
+    return std::uniform_int_distribution<int64_t>(
+        0, absl::GetFlag(FLAGS_num_rows) - 1)(*random);
+  }
+
+  // Drains `rows`, returning the first error encountered.
+  static absl::Status Drain(cloud_spanner::RowStream rows) {
+    for (const auto& row : rows) {
+      if (!row) return ToStatus(row.status());
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status PointRead(std::mt19937_64* random) {
+    return Drain(client_.Read(
+        kTableName,
+        cloud_spanner::KeySet().AddKey(
+            cloud_spanner::MakeKey(KeyFor(RandomRow(random)))),
+        {"Key", "Counter", "Value"}));
+  }
+
+  absl::Status RangeScan(std::mt19937_64* random) {
+    int64_t start = RandomRow(random);
+    cloud_spanner::ReadOptions read_options;
+    read_options.limit = absl::GetFlag(FLAGS_scan_length);
+    return Drain(client_.Read(
+        kTableName,
+        cloud_spanner::KeySet().AddRange(
+            cloud_spanner::MakeKeyBoundClosed(KeyFor(start)),
+            cloud_spanner::MakeKeyBoundOpen(
+                KeyFor(start + absl::GetFlag(FLAGS_scan_length)))),
+        {"Key", "Counter", "Value"}, read_options));
+  }
+
+  absl::Status Commit(std::mt19937_64* random) {
+    auto commit = client_.Commit(cloud_spanner::Mutations{
+        cloud_spanner::UpdateMutationBuilder(kTableName, {"Key", "Value"})
+            .EmplaceRow(KeyFor(RandomRow(random)), value_)
+            .Build()});
+    return commit ? absl::OkStatus() : ToStatus(commit.status());
+  }
+
+  absl::Status BatchDml(std::mt19937_64* random) {
+    std::vector<cloud_spanner::SqlStatement> statements;
+    for (int i = 0; i < absl::GetFlag(FLAGS_batch_size); ++i) {
+      statements.emplace_back(
+          absl::StrCat("UPDATE ", kTableName,
+                       " SET Counter = Counter + 1 WHERE Key = @key"),
+          cloud_spanner::SqlStatement::ParamType{
+              {"key", cloud_spanner::Value(KeyFor(RandomRow(random)))}});
+    }
+    auto commit = client_.Commit(
+        [&](const cloud_spanner::Transaction& txn)
+            -> google::cloud::StatusOr<cloud_spanner::Mutations> {
+          auto result = client_.ExecuteBatchDml(txn, statements);
+          if (!result) return result.status();
+          if (!result->status.ok()) return result->status;
+          return cloud_spanner::Mutations{};
+        });
+    return commit ? absl::OkStatus() : ToStatus(commit.status());
+  }
+
+  // Reads the change stream's records of the last second, which is what a
+  // change stream reader polling the tail of the stream does.
+  absl::Status TailChangeStream() {
+    absl::Time now = absl::Now();
+    return Drain(client_.ExecuteQuery(cloud_spanner::SqlStatement(
+        absl::StrCat("SELECT ChangeRecord FROM READ_", kChangeStreamName,
+                     "(@start, @end, NULL, 1000)"),
+        {{"start", cloud_spanner::Value(cloud_spanner::MakeTimestamp(
+                                            now - absl::Seconds(1))
+                                            .value())},
+         {"end", cloud_spanner::Value(
+                     cloud_spanner::MakeTimestamp(now).value())}})));
+  }
+
+  const google::cloud::Options options_;
+  const cloud_spanner::Database database_;
+  cloud_spanner::Client client_;
+  const std::string value_ =
+      std::string(absl::GetFlag(FLAGS_value_size), 'x');
+};
+
+void PrintResult(const std::string& workload, const WorkloadResult& result) {
+  absl::PrintF("%-14s %10d %8d %12.1f %10s %10s %10s\n", workload,
+               result.ok_count, result.error_count,
+               result.ok_count / absl::ToDoubleSeconds(result.elapsed),
+               absl::FormatDuration(result.Percentile(0.5)),
+               absl::FormatDuration(result.Percentile(0.99)),
+               absl::FormatDuration(result.Percentile(0.999)));
+}
+
+}  // namespace
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+using ::google::spanner::emulator::LoadGenerator;
+using ::google::spanner::emulator::Operation;
+using Server = ::google::spanner::emulator::frontend::Server;
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  std::unique_ptr<Server> server;
+  std::string host_port = absl::GetFlag(FLAGS_emulator_host_port);
+  if (host_port.empty()) {
+    Server::Options options;
+    options.server_address = "localhost:0";
+    server = Server::Create(options);
+    if (!server) {
+      ABSL_LOG(ERROR) << "Failed to start gRPC server.";
+      return EXIT_FAILURE;
+    }
+    host_port = absl::StrCat(server->host(), ":", server->port());
+  }
+  ABSL_LOG(INFO) << "Driving emulator at " << host_port;
+
+  google::cloud::Options options;
+  options.set<google::cloud::GrpcCredentialOption>(
+      grpc::InsecureChannelCredentials());
+  options.set<google::cloud::EndpointOption>(host_port);
+  LoadGenerator generator(std::move(options));
+
+  std::vector<std::pair<std::string, Operation>> workloads;
+  for (absl::string_view name :
+       absl::StrSplit(absl::GetFlag(FLAGS_workloads), ',', absl::SkipEmpty())) {
+    Operation operation = generator.OperationFor(std::string(name));
+    if (operation == nullptr) {
+      ABSL_LOG(ERROR) << "Unknown workload: " << name;
+      return EXIT_FAILURE;
+    }
+    workloads.emplace_back(std::string(name), std::move(operation));
+  }
+
+  absl::Status status = generator.Setup();
+  if (!status.ok()) {
+    ABSL_LOG(ERROR) << "Failed to set up the database: " << status;
+    return EXIT_FAILURE;
+  }
+
+  absl::PrintF("%-14s %10s %8s %12s %10s %10s %10s\n", "workload", "ops",
+               "errors", "qps", "p50", "p99", "p999");
+  for (const auto& [name, operation] : workloads) {
+    google::spanner::emulator::PrintResult(name, generator.Run(operation));
+  }
+
+  if (server != nullptr) server->Shutdown();
+  return EXIT_SUCCESS;
+}
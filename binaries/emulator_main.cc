@@ -30,6 +30,29 @@ int main(int argc, char** argv) {
   absl::ParseCommandLine(argc, argv);
   Server::Options options;
   options.server_address = google::spanner::emulator::config::grpc_host_port();
+  options.database_snapshots =
+      google::spanner::emulator::config::database_snapshots();
+  options.wal_dir = google::spanner::emulator::config::wal_dir();
+  options.max_active_requests_per_database =
+      google::spanner::emulator::config::max_active_requests_per_database();
+  options.max_queued_requests_per_database =
+      google::spanner::emulator::config::max_queued_requests_per_database();
+  options.num_completion_queues =
+      google::spanner::emulator::config::grpc_num_completion_queues();
+  options.min_pollers = google::spanner::emulator::config::grpc_min_pollers();
+  options.max_pollers = google::spanner::emulator::config::grpc_max_pollers();
+  options.max_threads = google::spanner::emulator::config::grpc_max_threads();
+  options.compression =
+      google::spanner::emulator::config::grpc_compression();
+  options.compression_min_response_bytes =
+      google::spanner::emulator::config::grpc_compression_min_response_bytes();
+  options.http2_stream_window_bytes =
+      google::spanner::emulator::config::grpc_http2_stream_window_bytes();
+  options.http2_write_buffer_bytes =
+      google::spanner::emulator::config::grpc_http2_write_buffer_bytes();
+  options.metrics_address =
+      google::spanner::emulator::config::metrics_host_port();
+  options.rest_address = google::spanner::emulator::config::rest_host_port();
   std::unique_ptr<Server> server = Server::Create(options);
   if (!server) {
     ABSL_LOG(ERROR) << "Failed to start gRPC server.";
@@ -0,0 +1,52 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <cstdlib>
+#include <memory>
+
+#include "absl/flags/parse.h"
+#include "zetasql/base/logging.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "common/config.h"
+#include "frontend/server/cluster_router.h"
+
+using ClusterRouter = ::google::spanner::emulator::frontend::ClusterRouter;
+
+int main(int argc, char** argv) {
+  // Start the cluster router in front of the emulator workers.
+  absl::ParseCommandLine(argc, argv);
+  ClusterRouter::Options options;
+  options.server_address = google::spanner::emulator::config::grpc_host_port();
+  options.worker_addresses =
+      google::spanner::emulator::config::cluster_workers();
+  absl::StatusOr<std::unique_ptr<ClusterRouter>> router =
+      ClusterRouter::Create(options);
+  if (!router.ok()) {
+    ABSL_LOG(ERROR) << "Failed to start cluster router: " << router.status();
+    return EXIT_FAILURE;
+  }
+
+  ABSL_LOG(INFO) << "Cloud Spanner Emulator cluster router running in front of "
+                 << options.worker_addresses.size() << " workers.";
+  ABSL_LOG(INFO) << "Server address: "
+                 << absl::StrCat((*router)->host(), ":", (*router)->port());
+
+  // Block forever until the router is terminated.
+  (*router)->WaitForShutdown();
+
+  return EXIT_SUCCESS;
+}
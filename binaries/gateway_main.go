@@ -53,6 +53,8 @@ var (
 			"requests to allow testing application abort-retry behavior).")
 	disableQueryNullFilteredIndexCheck = flag.Bool("disable_query_null_filtered_index_check", false,
 		"If true, then queries that use NULL_FILTERED indexes will be answered.")
+	enableConcurrentReadWriteTxns = flag.Bool("enable_concurrent_read_write_transactions", false,
+		"If true, non-conflicting read-write transactions can run and commit concurrently.")
 )
 
 // resolveGRPCBinary figures out the full path to the grpc binary from the --grpc_binary flag.
@@ -102,6 +104,7 @@ func main() {
 		LogRequests:                        *logRequests,
 		EnableFaultInjection:               *enableFaultInjection,
 		DisableQueryNullFilteredIndexCheck: *disableQueryNullFilteredIndexCheck,
+		EnableConcurrentReadWriteTxns:      *enableConcurrentReadWriteTxns,
 	}
 	gw := gateway.New(gwopts)
 	gw.Run()
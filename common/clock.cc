@@ -17,6 +17,7 @@
 #include "common/clock.h"
 
 #include <algorithm>
+#include <cstdint>
 
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -27,27 +28,26 @@ namespace emulator {
 
 namespace {
 
-// Returns the current time at microsecond granularity.
-absl::Time NowMicros() {
-  return absl::FromUnixMicros(absl::ToUnixMicros(absl::Now()));
-}
+// Returns the current time in microseconds since the unix epoch.
+int64_t NowMicros() { return absl::ToUnixMicros(absl::Now()); }
 
 }  // namespace
 
-Clock::Clock()
-    : last_system_time_(NowMicros()), last_dispensed_time_(last_system_time_) {}
-
-absl::Time Clock::Now() {
-  absl::MutexLock lock(&mu_);
-
-  absl::Time now = NowMicros();
-  absl::Time next_dispensed_time =
-      last_dispensed_time_ +
-      std::max(absl::Microseconds(1), now - last_system_time_);
-  last_system_time_ = now;
-  last_dispensed_time_ = next_dispensed_time;
-
-  return last_dispensed_time_;
+Clock::Clock() : last_dispensed_micros_(NowMicros()) {}
+
+absl::Time Clock::Reserve(int64_t count) {
+  // Hand out the system time unless it is not past the last dispensed value
+  // (several calls within the same microsecond, or the system clock stepping
+  // backwards), in which case continue right after the last dispensed value.
+  // The update is sequentially consistent so that callers can order other
+  // atomics (e.g. LockManager's pending commit count) against it.
+  int64_t last = last_dispensed_micros_.load();
+  int64_t first;
+  do {
+    first = std::max(last + 1, NowMicros());
+  } while (!last_dispensed_micros_.compare_exchange_weak(last,
+                                                         first + count - 1));
+  return absl::FromUnixMicros(first);
 }
 
 }  // namespace emulator
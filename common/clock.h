@@ -17,7 +17,9 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_CLOCK_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_CLOCK_H_
 
-#include "absl/synchronization/mutex.h"
+#include <atomic>
+#include <cstdint>
+
 #include "absl/time/time.h"
 
 namespace google {
@@ -37,23 +39,27 @@ namespace emulator {
 //   This is to conform with Cloud Spanner's commit timestamps which also
 //   operate at microsecond resolution.
 //
-// This class is thread safe.
+// This class is thread safe. It is lock-free: the last dispensed timestamp is
+// kept in a single atomic and advanced with compare-and-swap, so concurrent
+// callers (read timestamp picks, commit timestamp reservations, change stream
+// ticks) never block each other.
 class Clock {
  public:
   Clock();
 
   // Returns the current time.
-  absl::Time Now() ABSL_LOCKS_EXCLUDED(mu_);
-
- private:
-  // Mutex to guard state below.
-  absl::Mutex mu_;
+  absl::Time Now() { return Reserve(1); }
 
-  // The last value we got from the system clock.
-  absl::Time last_system_time_ ABSL_GUARDED_BY(mu_);
+  // Reserves `count` consecutive timestamps (each one microsecond apart) and
+  // returns the first of them. None of the reserved timestamps will be handed
+  // out by another call, which lets a group of commits take all of their
+  // timestamps with a single atomic update. `count` must be positive.
+  absl::Time Reserve(int64_t count);
 
-  // The last value we handed out in a call to Clock::Now().
-  absl::Time last_dispensed_time_ ABSL_GUARDED_BY(mu_);
+ private:
+  // The last value we handed out in a call to Clock::Reserve(), in
+  // microseconds since the unix epoch.
+  std::atomic<int64_t> last_dispensed_micros_;
 };
 
 }  // namespace emulator
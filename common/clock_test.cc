@@ -16,6 +16,11 @@
 
 #include "common/clock.h"
 
+#include <algorithm>
+#include <functional>
+#include <thread>  // NOLINT
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
@@ -42,6 +47,46 @@ TEST(Clock, ClockReturnsValuesAtMicrosecondGranularity) {
   EXPECT_EQ(t1, absl::FromUnixMicros(absl::ToUnixMicros(t1)));
 }
 
+TEST(Clock, ReserveReturnsTimestampsNotHandedOutByOtherCalls) {
+  Clock clock;
+  absl::Time first = clock.Reserve(10);
+  absl::Time next = clock.Now();
+
+  EXPECT_GE(next, first + absl::Microseconds(10));
+  EXPECT_EQ(first, absl::FromUnixMicros(absl::ToUnixMicros(first)));
+}
+
+TEST(Clock, ConcurrentCallersGetDistinctValues) {
+  constexpr int kNumThreads = 4;
+  constexpr int kCallsPerThread = 1000;
+  Clock clock;
+  std::vector<std::vector<absl::Time>> times(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&clock, &thread_times = times[i]]() {
+      for (int j = 0; j < kCallsPerThread; ++j) {
+        thread_times.push_back(clock.Now());
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<absl::Time> all_times;
+  for (const std::vector<absl::Time>& thread_times : times) {
+    // Each thread observes strictly increasing values.
+    EXPECT_EQ(std::adjacent_find(thread_times.begin(), thread_times.end(),
+                                 std::greater_equal<absl::Time>()),
+              thread_times.end());
+    all_times.insert(all_times.end(), thread_times.begin(),
+                     thread_times.end());
+  }
+  std::sort(all_times.begin(), all_times.end());
+  EXPECT_EQ(std::adjacent_find(all_times.begin(), all_times.end()),
+            all_times.end());
+}
+
 }  // namespace
 
 }  // namespace frontend
@@ -16,16 +16,39 @@
 
 #include "common/config.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/time/time.h"
 
 ABSL_FLAG(std::string, host_port, "localhost:10007",
           "Emulator host IP and port that serves Cloud Spanner gRPC requests.");
 
 ABSL_FLAG(bool, log_requests, false,
           "If true, gRPC request and response messages are streamed to the "
-          "INFO log. This switch is intended for emulator debugging.");
+          "INFO log. This switch is intended for emulator debugging. Messages "
+          "are written by a background thread, see the --request_log_* flags.");
+
+ABSL_FLAG(bool, enable_tracing, false,
+          "If true, the emulator traces requests through the frontend, query "
+          "engine, transactions and schema changes, and writes the spans to "
+          "the INFO log. Requests carrying a W3C traceparent header continue "
+          "the caller's trace.");
+
+ABSL_FLAG(double, request_log_sample_rate, 1.0,
+          "Fraction of gRPC requests which are logged, along with their "
+          "responses, when --log_requests is set.");
+
+ABSL_FLAG(int64_t, request_log_max_message_bytes, 64 << 10,
+          "gRPC messages larger than this many bytes are logged by size only "
+          "when --log_requests is set.");
+
+ABSL_FLAG(int, request_log_buffer_size, 4096,
+          "Maximum number of request log records waiting to be written when "
+          "--log_requests is set. Records beyond it are dropped rather than "
+          "slowing down the requests.");
 
 ABSL_FLAG(
     bool, enable_fault_injection, false,
@@ -51,6 +74,154 @@ ABSL_FLAG(
     "to the current transaction. A value of zero means that the emulator will "
     "never abort the current transaction.");
 
+ABSL_FLAG(bool, enable_concurrent_read_write_transactions, false,
+          "If true, read-write transactions only conflict with each other if "
+          "they access overlapping rows and columns, and non-conflicting "
+          "read-write transactions can run and commit concurrently. If false, "
+          "the emulator only allows one read-write transaction or schema "
+          "change at a time.");
+
+ABSL_FLAG(absl::Duration, lock_wait_timeout, absl::ZeroDuration(),
+          "If positive, lock conflicts between read-write transactions are "
+          "resolved with wound-wait: older transactions abort younger ones, "
+          "and younger transactions wait up to this long for older ones to "
+          "release their locks. If zero, conflicts are resolved by random "
+          "aborts, see --abort_current_transaction_probability.");
+
+ABSL_FLAG(std::vector<std::string>, database_snapshots, {},
+          "Comma-separated list of <database_uri>=<snapshot_path> pairs. Each "
+          "database is restored from its snapshot file when the emulator "
+          "starts, creating its instance if needed. For example: "
+          "projects/p/instances/i/databases/d=/tmp/d.snapshot");
+
+ABSL_FLAG(std::string, wal_dir, "",
+          "If set, databases are made durable by keeping a write-ahead log and "
+          "periodic checkpoints of each database in a subdirectory of this "
+          "directory. Durable databases are recovered when the emulator "
+          "starts. PostgreSQL-dialect databases are not made durable.");
+
+ABSL_FLAG(int, grpc_num_completion_queues, 0,
+          "Number of completion queues that the gRPC server polls for incoming "
+          "requests. 0 uses the gRPC default of one per CPU core.");
+
+ABSL_FLAG(int, grpc_min_pollers, 0,
+          "Minimum number of threads polling each gRPC completion queue. 0 "
+          "uses the gRPC default.");
+
+ABSL_FLAG(int, grpc_max_pollers, 0,
+          "Maximum number of threads polling each gRPC completion queue. 0 "
+          "uses the gRPC default.");
+
+ABSL_FLAG(int, grpc_max_threads, 0,
+          "Maximum number of threads that the gRPC server uses to poll for and "
+          "run requests. Each in-flight request occupies a thread while its "
+          "handler runs, including streaming reads, and requests beyond the "
+          "limit fail with RESOURCE_EXHAUSTED. 0 means no limit.");
+
+ABSL_FLAG(std::string, grpc_compression, "none",
+          "Algorithm with which the gRPC server compresses its responses: "
+          "none, gzip or deflate. Responses are only compressed for clients "
+          "which advertise the algorithm in grpc-accept-encoding.");
+
+ABSL_FLAG(int64_t, grpc_compression_min_response_bytes, 1024,
+          "Unary gRPC responses smaller than this many bytes are sent "
+          "uncompressed. Streaming responses are always compressed when "
+          "--grpc_compression is set.");
+
+ABSL_FLAG(int, grpc_http2_stream_window_bytes, 0,
+          "Initial HTTP/2 flow-control window of each gRPC stream, in bytes. "
+          "Larger windows let clients stream large requests without waiting "
+          "for window updates. 0 uses the gRPC default.");
+
+ABSL_FLAG(int, grpc_http2_write_buffer_bytes, 0,
+          "Maximum number of bytes the gRPC server buffers before writing to "
+          "the network, which lets streamed responses be batched into fewer "
+          "writes. 0 uses the gRPC default.");
+
+ABSL_FLAG(std::string, metrics_host_port, "",
+          "If set, the host and port at which the emulator serves metrics in "
+          "the Prometheus text format over HTTP, at /metrics. Metrics include "
+          "per-method gRPC request latencies, in-flight requests and message "
+          "sizes, and query analysis, query execution, lock wait and commit "
+          "latencies.");
+
+ABSL_FLAG(int, max_active_requests_per_database, 0,
+          "Maximum number of requests for a single database that the emulator "
+          "runs at a time. Further requests for the database wait for one of "
+          "them to finish, so that a heavily loaded database cannot take up "
+          "all server threads when many databases share one emulator. 0 means "
+          "no limit.");
+
+ABSL_FLAG(int, max_queued_requests_per_database, 0,
+          "Maximum number of requests for a single database that wait to run "
+          "when --max_active_requests_per_database is reached. Requests beyond "
+          "it fail with RESOURCE_EXHAUSTED. 0 means no limit.");
+
+ABSL_FLAG(std::string, rest_host_port, "",
+          "If set, the host and port at which the emulator serves the REST "
+          "API over HTTP/1.1, from the same process and handlers as the gRPC "
+          "API. Streaming methods return newline-delimited JSON objects in a "
+          "chunked response.");
+
+ABSL_FLAG(int, query_result_cache_capacity, 0,
+          "Maximum number of query results cached per database. Results are "
+          "only cached for deterministic queries in read-only transactions "
+          "whose read timestamp is at or before the last commit, and are "
+          "replayed to later executions of the same query with the same "
+          "parameters at the same read timestamp. 0 disables the cache.");
+
+ABSL_FLAG(int, query_scan_threads, 8,
+          "Maximum number of threads which read the key ranges of a table "
+          "scanned by a query in a read-only transaction. 1 disables parallel "
+          "scans.");
+
+ABSL_FLAG(int64_t, query_scan_rows_per_range, 64 * 1024,
+          "Number of rows of a table in each key range read by a thread of a "
+          "parallel scan.");
+
+ABSL_FLAG(bool, enable_native_query_operators, true,
+          "If true (the default), then queries made of table scans, equality "
+          "filters, equi-joins, GROUP BY and ORDER BY with LIMIT are "
+          "evaluated with hash joins, hash aggregations and top-K sorts "
+          "instead of the ZetaSQL reference evaluator. Rows of such queries "
+          "without an ORDER BY are returned in a scrambled order, as by the "
+          "reference evaluator. Set to false to evaluate every query with "
+          "the reference evaluator.");
+
+ABSL_FLAG(int64_t, query_sort_memory_limit_bytes, 64 << 20,
+          "Approximate number of bytes of rows which the native sort of a "
+          "query without LIMIT keeps in memory. Larger inputs are sorted in "
+          "runs of this size which are spilled to temporary files and "
+          "merged.");
+
+ABSL_FLAG(int64_t, query_memory_limit_bytes, int64_t{1} << 30,
+          "Approximate number of bytes which a single query may keep in "
+          "memory for its result rows, joins, aggregations and response. "
+          "Queries exceeding it fail with RESOURCE_EXHAUSTED. If zero or "
+          "less, queries are not limited.");
+
+ABSL_FLAG(int, partitioned_dml_threads, 4,
+          "Maximum number of threads which execute the key ranges of a "
+          "partitioned DML statement, each in its own transaction. Key ranges "
+          "are only executed in parallel if concurrent read-write transactions "
+          "are enabled.");
+
+ABSL_FLAG(int64_t, partitioned_dml_rows_per_range, 16 * 1024,
+          "Number of rows of the target table of a partitioned DML statement "
+          "in each key range executed and committed as a transaction.");
+
+ABSL_FLAG(int64_t, max_retained_operations, 10000,
+          "Number of long-running operations above which the oldest completed "
+          "operations are evicted, so that they are no longer returned by "
+          "GetOperation and ListOperations. Running operations are never "
+          "evicted. If zero or less, every operation is retained.");
+
+ABSL_FLAG(std::vector<std::string>, cluster_workers, {},
+          "Comma separated addresses (host:port) of the emulator workers which "
+          "the cluster router places databases onto. The order of the workers "
+          "determines the placement of databases: it must be kept stable, and "
+          "workers can only be appended.");
+
 namespace google {
 namespace spanner {
 namespace emulator {
@@ -60,6 +231,24 @@ std::string grpc_host_port() { return absl::GetFlag(FLAGS_host_port); }
 
 bool should_log_requests() { return absl::GetFlag(FLAGS_log_requests); }
 
+bool tracing_enabled() { return absl::GetFlag(FLAGS_enable_tracing); }
+
+void set_tracing_enabled(bool enabled) {
+  absl::SetFlag(&FLAGS_enable_tracing, enabled);
+}
+
+double request_log_sample_rate() {
+  return absl::GetFlag(FLAGS_request_log_sample_rate);
+}
+
+int64_t request_log_max_message_bytes() {
+  return absl::GetFlag(FLAGS_request_log_max_message_bytes);
+}
+
+int request_log_buffer_size() {
+  return absl::GetFlag(FLAGS_request_log_buffer_size);
+}
+
 bool fault_injection_enabled() {
   return absl::GetFlag(FLAGS_enable_fault_injection);
 }
@@ -76,6 +265,138 @@ void set_abort_current_transaction_probability(int probability) {
   absl::SetFlag(&FLAGS_abort_current_transaction_probability, probability);
 }
 
+bool concurrent_read_write_transactions_enabled() {
+  return absl::GetFlag(FLAGS_enable_concurrent_read_write_transactions);
+}
+
+void set_concurrent_read_write_transactions_enabled(bool enabled) {
+  absl::SetFlag(&FLAGS_enable_concurrent_read_write_transactions, enabled);
+}
+
+absl::Duration lock_wait_timeout() {
+  return absl::GetFlag(FLAGS_lock_wait_timeout);
+}
+
+void set_lock_wait_timeout(absl::Duration timeout) {
+  absl::SetFlag(&FLAGS_lock_wait_timeout, timeout);
+}
+
+std::vector<std::string> database_snapshots() {
+  return absl::GetFlag(FLAGS_database_snapshots);
+}
+
+std::string wal_dir() { return absl::GetFlag(FLAGS_wal_dir); }
+
+int grpc_num_completion_queues() {
+  return absl::GetFlag(FLAGS_grpc_num_completion_queues);
+}
+
+int grpc_min_pollers() { return absl::GetFlag(FLAGS_grpc_min_pollers); }
+
+int grpc_max_pollers() { return absl::GetFlag(FLAGS_grpc_max_pollers); }
+
+int grpc_max_threads() { return absl::GetFlag(FLAGS_grpc_max_threads); }
+
+std::string grpc_compression() {
+  return absl::GetFlag(FLAGS_grpc_compression);
+}
+
+int64_t grpc_compression_min_response_bytes() {
+  return absl::GetFlag(FLAGS_grpc_compression_min_response_bytes);
+}
+
+int grpc_http2_stream_window_bytes() {
+  return absl::GetFlag(FLAGS_grpc_http2_stream_window_bytes);
+}
+
+int grpc_http2_write_buffer_bytes() {
+  return absl::GetFlag(FLAGS_grpc_http2_write_buffer_bytes);
+}
+
+std::string metrics_host_port() {
+  return absl::GetFlag(FLAGS_metrics_host_port);
+}
+
+int max_active_requests_per_database() {
+  return absl::GetFlag(FLAGS_max_active_requests_per_database);
+}
+
+int max_queued_requests_per_database() {
+  return absl::GetFlag(FLAGS_max_queued_requests_per_database);
+}
+
+std::string rest_host_port() { return absl::GetFlag(FLAGS_rest_host_port); }
+
+int query_result_cache_capacity() {
+  return absl::GetFlag(FLAGS_query_result_cache_capacity);
+}
+
+int query_scan_threads() { return absl::GetFlag(FLAGS_query_scan_threads); }
+
+void set_query_scan_threads(int num_threads) {
+  absl::SetFlag(&FLAGS_query_scan_threads, num_threads);
+}
+
+int64_t query_scan_rows_per_range() {
+  return absl::GetFlag(FLAGS_query_scan_rows_per_range);
+}
+
+void set_query_scan_rows_per_range(int64_t rows) {
+  absl::SetFlag(&FLAGS_query_scan_rows_per_range, rows);
+}
+
+bool native_query_operators_enabled() {
+  return absl::GetFlag(FLAGS_enable_native_query_operators);
+}
+
+void set_native_query_operators_enabled(bool enabled) {
+  absl::SetFlag(&FLAGS_enable_native_query_operators, enabled);
+}
+
+int64_t query_sort_memory_limit_bytes() {
+  return absl::GetFlag(FLAGS_query_sort_memory_limit_bytes);
+}
+
+void set_query_sort_memory_limit_bytes(int64_t bytes) {
+  absl::SetFlag(&FLAGS_query_sort_memory_limit_bytes, bytes);
+}
+
+int64_t query_memory_limit_bytes() {
+  return absl::GetFlag(FLAGS_query_memory_limit_bytes);
+}
+
+void set_query_memory_limit_bytes(int64_t bytes) {
+  absl::SetFlag(&FLAGS_query_memory_limit_bytes, bytes);
+}
+
+int partitioned_dml_threads() {
+  return absl::GetFlag(FLAGS_partitioned_dml_threads);
+}
+
+void set_partitioned_dml_threads(int num_threads) {
+  absl::SetFlag(&FLAGS_partitioned_dml_threads, num_threads);
+}
+
+int64_t partitioned_dml_rows_per_range() {
+  return absl::GetFlag(FLAGS_partitioned_dml_rows_per_range);
+}
+
+void set_partitioned_dml_rows_per_range(int64_t rows) {
+  absl::SetFlag(&FLAGS_partitioned_dml_rows_per_range, rows);
+}
+
+int64_t max_retained_operations() {
+  return absl::GetFlag(FLAGS_max_retained_operations);
+}
+
+void set_max_retained_operations(int64_t num_operations) {
+  absl::SetFlag(&FLAGS_max_retained_operations, num_operations);
+}
+
+std::vector<std::string> cluster_workers() {
+  return absl::GetFlag(FLAGS_cluster_workers);
+}
+
 }  // namespace config
 }  // namespace emulator
 }  // namespace spanner
@@ -17,7 +17,11 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_CONFIG_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_CONFIG_H_
 
+#include <cstdint>
 #include <string>
+#include <vector>
+
+#include "absl/time/time.h"
 
 namespace google {
 namespace spanner {
@@ -30,6 +34,19 @@ std::string grpc_host_port();
 // If true, gRPC requests and response messages are streamed to the INFO log.
 bool should_log_requests();
 
+// If true, requests are traced and the spans are written to the INFO log (see
+// tracing::ScopedSpan).
+bool tracing_enabled();
+
+void set_tracing_enabled(bool enabled);
+
+// Tuning of the request log: the fraction of requests logged, the size above
+// which messages are logged by size only, and the number of records buffered
+// before new ones are dropped.
+double request_log_sample_rate();
+int64_t request_log_max_message_bytes();
+int request_log_buffer_size();
+
 // Returns true if fault injection is enabled.
 bool fault_injection_enabled();
 
@@ -54,6 +71,112 @@ int abort_current_transaction_probability();
 
 void set_abort_current_transaction_probability(int probability);
 
+// If true, read-write transactions are only aborted if they conflict with
+// another transaction on overlapping rows and columns. Otherwise, only one
+// read-write transaction or schema change can be active at a time.
+bool concurrent_read_write_transactions_enabled();
+
+void set_concurrent_read_write_transactions_enabled(bool enabled);
+
+// How long a read-write transaction waits for the locks held by older
+// transactions, which are scheduled with wound-wait. Zero disables waiting, in
+// which case conflicts are resolved by random aborts (see
+// abort_current_transaction_probability()).
+absl::Duration lock_wait_timeout();
+
+void set_lock_wait_timeout(absl::Duration timeout);
+
+// Databases to restore from snapshot files at startup, as a list of
+// <database_uri>=<snapshot_path> pairs.
+std::vector<std::string> database_snapshots();
+
+// Directory in which databases are made durable, or empty if databases are
+// only kept in memory.
+std::string wal_dir();
+
+// Thread model of the gRPC server: the number of completion queues, the
+// minimum and maximum number of polling threads per completion queue, and the
+// maximum number of server threads. 0 leaves the gRPC default (no limit for
+// the maximum number of threads).
+int grpc_num_completion_queues();
+int grpc_min_pollers();
+int grpc_max_pollers();
+int grpc_max_threads();
+
+// Compression of gRPC responses: the algorithm ("none", "gzip" or "deflate")
+// and the size below which unary responses are sent uncompressed.
+std::string grpc_compression();
+int64_t grpc_compression_min_response_bytes();
+
+// HTTP/2 tuning of the gRPC server: the initial flow-control window of each
+// stream and the size of the write buffer. 0 leaves the gRPC default.
+int grpc_http2_stream_window_bytes();
+int grpc_http2_write_buffer_bytes();
+
+// The address at which the emulator serves metrics over HTTP, or empty if
+// metrics are not served.
+std::string metrics_host_port();
+
+// Maximum number of requests per database that run at a time, or 0 if
+// requests of different databases are not isolated from each other.
+int max_active_requests_per_database();
+
+// Maximum number of requests per database that wait for a running request of
+// the same database to finish, or 0 for no limit.
+int max_queued_requests_per_database();
+
+// The address at which the emulator serves the REST API over HTTP, or empty if
+// the REST API is not served by the emulator itself.
+std::string rest_host_port();
+
+// Maximum number of query results cached per database for read-only snapshot
+// queries, or 0 if query results are not cached.
+int query_result_cache_capacity();
+
+// Maximum number of threads which read a table scanned by a query in parallel,
+// and the number of rows of the table read by each of these threads at a
+// time. Only reads of read-only snapshots are parallel.
+int query_scan_threads();
+void set_query_scan_threads(int num_threads);
+int64_t query_scan_rows_per_range();
+void set_query_scan_rows_per_range(int64_t rows);
+
+// Returns true if common query shapes are evaluated with hash joins, hash
+// aggregations and top-K sorts instead of the ZetaSQL reference evaluator.
+// On by default; when false every query uses the reference evaluator.
+bool native_query_operators_enabled();
+void set_native_query_operators_enabled(bool enabled);
+
+// Approximate number of bytes of rows which the native sort of a query without
+// LIMIT keeps in memory before spilling a sorted run to a temporary file.
+int64_t query_sort_memory_limit_bytes();
+void set_query_sort_memory_limit_bytes(int64_t bytes);
+
+// Approximate number of bytes which a single query may keep in memory before
+// it fails with RESOURCE_EXHAUSTED. Not limited if zero or less.
+int64_t query_memory_limit_bytes();
+void set_query_memory_limit_bytes(int64_t bytes);
+
+// Maximum number of threads which execute the key ranges of a partitioned DML
+// statement, and the number of rows of its target table in each key range.
+// Each key range is executed and committed in its own transaction. Key ranges
+// are only executed in parallel if concurrent read-write transactions are
+// enabled.
+int partitioned_dml_threads();
+void set_partitioned_dml_threads(int num_threads);
+int64_t partitioned_dml_rows_per_range();
+void set_partitioned_dml_rows_per_range(int64_t rows);
+
+// Number of long-running operations above which the operation manager evicts
+// the oldest completed operations. Operations which are still running are never
+// evicted. Not limited if zero or less.
+int64_t max_retained_operations();
+void set_max_retained_operations(int64_t num_operations);
+
+// Addresses of the emulator workers of the cluster served by the cluster
+// router, in placement order.
+std::vector<std::string> cluster_workers();
+
 }  // namespace config
 }  // namespace emulator
 }  // namespace spanner
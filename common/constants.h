@@ -21,6 +21,7 @@
 #include <limits>
 
 #include "zetasql/public/type.h"
+#include "absl/time/time.h"
 
 constexpr int64_t kInt64Max = std::numeric_limits<int64_t>::max();
 
@@ -59,9 +60,20 @@ constexpr char kCommitTimestampIdentifier[] = "spanner.commit_timestamp()";
 constexpr absl::Time kCommitTimestampValueSentinel =
     absl::FromUnixMicros(zetasql::types::kTimestampMax);
 
+// Maximum staleness of reads. Reads at older timestamps are rejected and
+// storage versions older than this window may be garbage collected.
+constexpr absl::Duration kMaxStaleReadDuration = absl::Hours(1);
+
 // gRPC ResourceInfo binary metadata header.
 constexpr char kResourceInfoBinaryHeader[] = "google.rpc.resourceinfo-bin";
 
+// gRPC request metadata header with which clients opt into an alternative
+// encoding of StreamingRead results, and the value selecting the columnar
+// encoding (see frontend/converters/columnar.h).
+constexpr char kResultEncodingHeader[] =
+    "x-goog-spanner-emulator-result-encoding";
+constexpr char kColumnarResultEncoding[] = "columnar";
+
 // ResourceInfo URL used for including metadata in gRPC error details.
 constexpr char kResourceInfoType[] =
     "type.googleapis.com/google.rpc.ResourceInfo";
@@ -17,6 +17,7 @@
 #include "common/errors.h"
 
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -178,6 +179,15 @@ absl::Status TooManyDatabasesPerInstance(absl::string_view instance_uri) {
           "more information."));
 }
 
+absl::Status TooManyQueuedRequests(absl::string_view database_uri,
+                                   int max_queued_requests) {
+  return absl::Status(
+      absl::StatusCode::kResourceExhausted,
+      absl::StrCat("Too many requests waiting for database: ", database_uri,
+                   ". At most ", max_queued_requests,
+                   " requests can wait for a database at a time."));
+}
+
 absl::Status InvalidDatabaseName(absl::string_view database_id) {
   return absl::Status(
       absl::StatusCode::kInvalidArgument,
@@ -194,6 +204,157 @@ absl::Status CannotCreatePostgreSQLDialectDatabase() {
                       "Cannot create a PostgreSQL database.");
 }
 
+absl::Status DatabaseSnapshotNotSupported(absl::string_view reason) {
+  return absl::Status(
+      absl::StatusCode::kUnimplemented,
+      absl::StrCat("Database snapshots are not supported for ", reason, "."));
+}
+
+absl::Status DatabaseCloneNotSupported(absl::string_view reason) {
+  return absl::Status(
+      absl::StatusCode::kUnimplemented,
+      absl::StrCat("Database clones are not supported for ", reason, "."));
+}
+
+absl::Status DatabaseResetNotSupported(absl::string_view reason) {
+  return absl::Status(
+      absl::StatusCode::kUnimplemented,
+      absl::StrCat("Database resets are not supported for ", reason, "."));
+}
+
+absl::Status BulkImportNotSupported(absl::string_view reason) {
+  return absl::Status(
+      absl::StatusCode::kUnimplemented,
+      absl::StrCat("Bulk imports are not supported for ", reason, "."));
+}
+
+absl::Status BulkImportTableNotEmpty(absl::string_view table_name) {
+  return absl::Status(
+      absl::StatusCode::kFailedPrecondition,
+      absl::Substitute("Cannot bulk import into table $0 which is not empty.",
+                       table_name));
+}
+
+absl::Status BulkImportDuplicateTable(absl::string_view table_name) {
+  return absl::Status(
+      absl::StatusCode::kInvalidArgument,
+      absl::Substitute("Table $0 is imported more than once.", table_name));
+}
+
+absl::Status InvalidImportFile(absl::string_view path,
+                               absl::string_view reason) {
+  return absl::Status(
+      absl::StatusCode::kInvalidArgument,
+      absl::Substitute("Invalid import file $0: $1", path, reason));
+}
+
+absl::Status DataGenerationNotSupported(absl::string_view reason) {
+  return absl::Status(
+      absl::StatusCode::kUnimplemented,
+      absl::StrCat("Cannot generate data for ", reason, "."));
+}
+
+absl::Status DatabaseResetTimestampTooOld(absl::Time timestamp,
+                                          absl::Time min_timestamp) {
+  return absl::Status(
+      absl::StatusCode::kFailedPrecondition,
+      absl::StrCat("Cannot reset the database to ",
+                   absl::FormatTime(timestamp),
+                   " since versions before ", absl::FormatTime(min_timestamp),
+                   " may have been garbage collected."));
+}
+
+absl::Status DatabaseResetAcrossSchemaChange(absl::Time timestamp) {
+  return absl::Status(
+      absl::StatusCode::kFailedPrecondition,
+      absl::StrCat("Cannot reset the database to ",
+                   absl::FormatTime(timestamp),
+                   " since its schema was changed after that timestamp."));
+}
+
+absl::Status InvalidDatabaseSnapshot(absl::string_view path,
+                                     absl::string_view reason) {
+  return absl::Status(
+      absl::StatusCode::kInvalidArgument,
+      absl::Substitute("Invalid database snapshot $0: $1", path, reason));
+}
+
+absl::Status InvalidDatabaseExport(absl::string_view path,
+                                   absl::string_view reason) {
+  return absl::Status(
+      absl::StatusCode::kInvalidArgument,
+      absl::Substitute("Invalid database export $0: $1", path, reason));
+}
+
+absl::Status InvalidCompressionAlgorithm(absl::string_view name) {
+  return absl::Status(
+      absl::StatusCode::kInvalidArgument,
+      absl::Substitute("Invalid gRPC compression algorithm $0: expected one "
+                       "of none, gzip or deflate",
+                       name));
+}
+
+absl::Status InvalidClusterConfiguration(absl::string_view reason) {
+  return absl::Status(
+      absl::StatusCode::kInvalidArgument,
+      absl::Substitute("Invalid emulator cluster configuration: $0", reason));
+}
+
+absl::Status CpuProfileInProgress() {
+  return absl::Status(absl::StatusCode::kFailedPrecondition,
+                      "A CPU profile is already being collected.");
+}
+
+absl::Status RequestCancelled() {
+  return absl::Status(absl::StatusCode::kCancelled,
+                      "The request was cancelled by the client.");
+}
+
+absl::Status RequestDeadlineExceeded() {
+  return absl::Status(absl::StatusCode::kDeadlineExceeded,
+                      "The deadline of the request expired.");
+}
+
+absl::Status QueryMemoryLimitExceeded(int64_t limit_bytes) {
+  return absl::Status(
+      absl::StatusCode::kResourceExhausted,
+      absl::StrCat("The query exceeded its memory limit of ", limit_bytes,
+                   " bytes. Reduce the number or size of the rows it joins, "
+                   "groups or returns, or raise --query_memory_limit_bytes."));
+}
+
+absl::Status CpuProfilingFailed(absl::string_view reason) {
+  return absl::Status(absl::StatusCode::kInternal,
+                      absl::StrCat("Failed to collect a CPU profile: ", reason));
+}
+
+absl::Status InvalidWriteAheadLog(absl::string_view path,
+                                  absl::string_view reason) {
+  return absl::Status(
+      absl::StatusCode::kDataLoss,
+      absl::Substitute("Invalid write-ahead log $0: $1", path, reason));
+}
+
+absl::Status WriteAheadLogIOError(absl::string_view path,
+                                  absl::string_view operation,
+                                  int error_number) {
+  return absl::Status(absl::StatusCode::kInternal,
+                      absl::Substitute("Failed to $0 write-ahead log $1: $2",
+                                       operation, path,
+                                       std::strerror(error_number)));
+}
+
+absl::Status DurableDatabaseDirectoryInUse(absl::string_view dir) {
+  return absl::Status(
+      absl::StatusCode::kAlreadyExists,
+      absl::Substitute("Directory $0 already holds a durable database.", dir));
+}
+
+absl::Status DatabaseNotDurable() {
+  return absl::Status(absl::StatusCode::kFailedPrecondition,
+                      "Database does not have a write-ahead log attached.");
+}
+
 // Operation errors.
 absl::Status InvalidOperationId(absl::string_view id) {
   return absl::Status(absl::StatusCode::kInvalidArgument,
@@ -444,6 +605,11 @@ absl::Status MultipleValuesForColumn(absl::string_view column) {
       absl::Substitute("Multiple values for column $0.", column));
 }
 
+absl::Status InvalidColumnarBatch(absl::string_view reason) {
+  return absl::Status(absl::StatusCode::kInvalidArgument,
+                      absl::Substitute("Invalid columnar batch: $0.", reason));
+}
+
 // Key proto errors.
 absl::Status WrongNumberOfKeyParts(absl::string_view table_or_index_name,
                                    int expected_key_parts, int found_key_parts,
@@ -607,6 +773,18 @@ absl::Status ReplayRequestMismatch(int64_t request_seqno,
                        request_seqno, sql_statement));
 }
 
+absl::Status ReplayOutcomeNoLongerAvailable(int64_t request_seqno,
+                                            absl::string_view sql_statement) {
+  return absl::Status(
+      absl::StatusCode::kFailedPrecondition,
+      absl::Substitute("The returned rows, transaction or query plan of the "
+                       "request with this seqno are no longer retained for "
+                       "replay. Only the most recent DML requests of a "
+                       "transaction can be fully replayed. "
+                       "seqno=$0\nRequested SQL: $1",
+                       request_seqno, sql_statement));
+}
+
 absl::Status PartitionReadDoesNotSupportSingleUseTransaction() {
   return absl::Status(absl::StatusCode::kInvalidArgument,
                       "Partition reads may not be performed in single-use "
@@ -647,6 +825,11 @@ absl::Status NoInsertForPartitionedDML() {
                       "INSERT is not supported for Partitioned DML");
 }
 
+absl::Status NoReturningForPartitionedDML() {
+  return absl::Status(absl::StatusCode::kInvalidArgument,
+                      "THEN RETURN is not supported for Partitioned DML");
+}
+
 absl::Status InvalidOperationUsingPartitionedDmlTransaction() {
   return absl::Status(absl::StatusCode::kInvalidArgument,
                       "PartitionedDml Transactions may only be used to execute "
@@ -1324,6 +1507,12 @@ absl::Status ChangeStreamQueriesMustBeStreaming() {
       "transactions using the ExecuteStreamingSql API.");
 }
 
+absl::Status ChangeStreamQueryStreamClosed() {
+  return absl::Status(absl::StatusCode::kCancelled,
+                      "Change stream query stopped since its response stream "
+                      "was closed.");
+}
+
 absl::Status TooManyIndicesPerDatabase(absl::string_view index_name,
                                        int64_t limit) {
   return absl::Status(absl::StatusCode::kFailedPrecondition,
@@ -3126,6 +3315,28 @@ absl::Status InvalidPartitionedQueryMode() {
       "with partitioned queries.");
 }
 
+absl::Status InvalidResumeToken() {
+  return absl::Status(absl::StatusCode::kInvalidArgument,
+                      "Invalid resume token.");
+}
+
+absl::Status ResumeTokenFromDifferentSnapshot(absl::Time token_timestamp,
+                                              absl::Time read_timestamp) {
+  return absl::Status(
+      absl::StatusCode::kInvalidArgument,
+      absl::Substitute("Resume token was created for a read at timestamp $0, "
+                       "but the transaction reads at timestamp $1.",
+                       absl::FormatTime(token_timestamp),
+                       absl::FormatTime(read_timestamp)));
+}
+
+absl::Status ResumedResultChanged() {
+  return absl::Status(
+      absl::StatusCode::kAborted,
+      "The result of the resumed request differs from the result of the "
+      "interrupted request. Retry the request without a resume token.");
+}
+
 absl::Status RowDeletionPolicyDoesNotExist(absl::string_view table_name) {
   return absl::Status(
       absl::StatusCode::kInvalidArgument,
@@ -3283,6 +3494,14 @@ absl::Status MessageTypeNotSupported(absl::string_view message_name) {
       absl::Substitute("Message type `$0` is not supported.", message_name));
 }
 
+absl::Status MalformedProtoValue(absl::string_view message_name) {
+  return absl::Status(
+      absl::StatusCode::kOutOfRange,
+      absl::Substitute("Failed to read a field of a value of proto type `$0`: "
+                       "the value is not a valid serialized message.",
+                       message_name));
+}
+
 absl::Status RestrictedPackagesCantBeUsed(absl::string_view type_name,
                                           absl::string_view package_name) {
   return absl::Status(
@@ -61,8 +61,39 @@ absl::Status CreateDatabaseMissingCreateStatement();
 absl::Status InvalidCreateDatabaseStatement(absl::string_view statement);
 absl::Status UpdateDatabaseMissingStatements();
 absl::Status TooManyDatabasesPerInstance(absl::string_view instance_uri);
+absl::Status TooManyQueuedRequests(absl::string_view database_uri,
+                                   int max_queued_requests);
 absl::Status InvalidDatabaseName(absl::string_view database_id);
 absl::Status CannotCreatePostgreSQLDialectDatabase();
+absl::Status DatabaseSnapshotNotSupported(absl::string_view reason);
+absl::Status DatabaseCloneNotSupported(absl::string_view reason);
+absl::Status DatabaseResetNotSupported(absl::string_view reason);
+absl::Status DatabaseResetTimestampTooOld(absl::Time timestamp,
+                                          absl::Time min_timestamp);
+absl::Status DatabaseResetAcrossSchemaChange(absl::Time timestamp);
+absl::Status BulkImportNotSupported(absl::string_view reason);
+absl::Status BulkImportTableNotEmpty(absl::string_view table_name);
+absl::Status BulkImportDuplicateTable(absl::string_view table_name);
+absl::Status InvalidImportFile(absl::string_view path,
+                               absl::string_view reason);
+absl::Status DataGenerationNotSupported(absl::string_view reason);
+absl::Status InvalidDatabaseSnapshot(absl::string_view path,
+                                     absl::string_view reason);
+absl::Status InvalidDatabaseExport(absl::string_view path,
+                                   absl::string_view reason);
+absl::Status InvalidCompressionAlgorithm(absl::string_view name);
+absl::Status InvalidClusterConfiguration(absl::string_view reason);
+absl::Status CpuProfileInProgress();
+absl::Status RequestCancelled();
+absl::Status RequestDeadlineExceeded();
+absl::Status QueryMemoryLimitExceeded(int64_t limit_bytes);
+absl::Status CpuProfilingFailed(absl::string_view reason);
+absl::Status InvalidWriteAheadLog(absl::string_view path,
+                                  absl::string_view reason);
+absl::Status WriteAheadLogIOError(absl::string_view path,
+                                  absl::string_view operation, int error_number);
+absl::Status DurableDatabaseDirectoryInUse(absl::string_view dir);
+absl::Status DatabaseNotDurable();
 
 // Operation errors.
 absl::Status InvalidOperationId(absl::string_view id);
@@ -109,6 +140,7 @@ absl::Status InvalidDate(absl::string_view str);
 absl::Status CouldNotParseStringAsBytes(absl::string_view str);
 absl::Status TimestampOutOfRange(absl::string_view time);
 absl::Status MultipleValuesForColumn(absl::string_view column);
+absl::Status InvalidColumnarBatch(absl::string_view reason);
 
 // Key proto errors.
 absl::Status WrongNumberOfKeyParts(absl::string_view table_or_index_name,
@@ -146,12 +178,15 @@ absl::Status DmlSequenceOutOfOrder(int64_t request_seqno, int64_t last_seqno,
                                    absl::string_view sql_statement);
 absl::Status ReplayRequestMismatch(int64_t request_seqno,
                                    absl::string_view sql_statement);
+absl::Status ReplayOutcomeNoLongerAvailable(int64_t request_seqno,
+                                            absl::string_view sql_statement);
 absl::Status PartitionReadDoesNotSupportSingleUseTransaction();
 absl::Status PartitionReadNeedsReadOnlyTxn();
 absl::Status CannotCommitRollbackReadOnlyOrPartitionedDmlTransaction();
 absl::Status CannotReusePartitionedDmlTransaction();
 absl::Status PartitionedDMLOnlySupportsSimpleQuery();
 absl::Status NoInsertForPartitionedDML();
+absl::Status NoReturningForPartitionedDML();
 absl::Status InvalidOperationUsingPartitionedDmlTransaction();
 absl::Status CannotCommitAfterRollback();
 absl::Status CannotRollbackAfterCommit();
@@ -286,6 +321,7 @@ absl::Status IllegalChangeStreamQueryPGSyntax(
 absl::Status ChangeStreamQueriesMustBeSingleUseOnly();
 absl::Status ChangeStreamQueriesMustBeStrongReads();
 absl::Status ChangeStreamQueriesMustBeStreaming();
+absl::Status ChangeStreamQueryStreamClosed();
 absl::Status TooManyIndicesPerDatabase(absl::string_view index_name,
                                        int64_t limit);
 absl::Status TooManyColumns(absl::string_view object_type,
@@ -729,6 +765,12 @@ absl::Status ReadFromDifferentTransaction();
 absl::Status ReadFromDifferentParameters();
 absl::Status InvalidPartitionedQueryMode();
 
+// Resume token errors.
+absl::Status InvalidResumeToken();
+absl::Status ResumeTokenFromDifferentSnapshot(absl::Time token_timestamp,
+                                              absl::Time read_timestamp);
+absl::Status ResumedResultChanged();
+
 // Row Deletion Policy errors.
 absl::Status RowDeletionPolicyDoesNotExist(absl::string_view table_name);
 absl::Status RowDeletionPolicyAlreadyExists(absl::string_view column_name,
@@ -766,6 +808,7 @@ absl::Status ExtensionNotSupported(int tag_number,
                                    absl::string_view field_name);
 absl::Status MessageExtensionsNotSupported(absl::string_view message_name);
 absl::Status MessageTypeNotSupported(absl::string_view message_name);
+absl::Status MalformedProtoValue(absl::string_view message_name);
 
 // Vector length errors
 absl::Status VectorLengthExceedsLimit(absl::string_view column_name,
@@ -127,6 +127,14 @@ constexpr int kMaxStringColumnLength = (kMaxBytesColumnLength / 4);  // 2621440
 // pieces, each no larger than this limit.
 constexpr int64_t kMaxStreamingChunkSize = 1024 * 1024;  // 1 MB
 
+// Desired data size of each partition created by PartitionRead and
+// PartitionQuery when the request does not set partition_size_bytes.
+constexpr int64_t kDefaultPartitionSizeBytes = 1024 * 1024 * 1024;  // 1 GB
+
+// Maximum number of partitions created by PartitionRead and PartitionQuery when
+// the request does not set max_partitions.
+constexpr int64_t kDefaultMaxPartitions = 10000;
+
 // Maximum size of a key in bytes.
 constexpr int kMaxKeySizeBytes = 8 * 1024;  // 8 KB
 
@@ -142,6 +150,14 @@ constexpr int kColumnExpressionMaxDepth = 20;
 // value range.
 constexpr int kMaxGetSequenceValueAttempt = 2000;
 
+// Maximum number of mutation groups of a BatchWrite request which are applied
+// concurrently.
+constexpr int kMaxBatchWriteConcurrency = 8;
+
+// Maximum number of times a mutation group of a BatchWrite request is retried
+// after its transaction was aborted by a concurrent transaction.
+constexpr int kMaxBatchWriteAbortRetries = 3;
+
 }  // namespace limits
 }  // namespace emulator
 }  // namespace spanner
@@ -0,0 +1,234 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "common/metrics.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace metrics {
+
+namespace {
+
+// Escapes a label value as required by the Prometheus text format.
+std::string EscapeLabelValue(absl::string_view value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        escaped.append("\\\\");
+        break;
+      case '"':
+        escaped.append("\\\"");
+        break;
+      case '\n':
+        escaped.append("\\n");
+        break;
+      default:
+        escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+// Formats labels as `name1="value1",name2="value2"`.
+std::string FormatLabels(const Labels& labels) {
+  return absl::StrJoin(labels, ",", [](std::string* out, const auto& label) {
+    absl::StrAppend(out, label.first, "=\"", EscapeLabelValue(label.second),
+                    "\"");
+  });
+}
+
+// Returns `{labels}`, or nothing if there are no labels.
+std::string BracedLabels(absl::string_view labels) {
+  return labels.empty() ? "" : absl::StrCat("{", labels, "}");
+}
+
+// Returns the labels of a histogram bucket, adding the `le` label.
+std::string BucketLabels(absl::string_view labels, absl::string_view le) {
+  return absl::StrCat("{", labels, labels.empty() ? "" : ",", "le=\"", le,
+                      "\"}");
+}
+
+std::vector<double> ExponentialBuckets(double start, double factor,
+                                       int count) {
+  std::vector<double> bounds;
+  bounds.reserve(count);
+  for (double bound = start; count > 0; bound *= factor, --count) {
+    bounds.push_back(bound);
+  }
+  return bounds;
+}
+
+}  // namespace
+
+Histogram::Histogram(std::vector<double> bucket_bounds)
+    : bucket_bounds_(std::move(bucket_bounds)),
+      bucket_counts_(bucket_bounds_.size() + 1, 0) {}
+
+void Histogram::Record(double value) {
+  const size_t bucket =
+      std::lower_bound(bucket_bounds_.begin(), bucket_bounds_.end(), value) -
+      bucket_bounds_.begin();
+  absl::MutexLock lock(&mu_);
+  ++bucket_counts_[bucket];
+  sum_ += value;
+}
+
+Histogram::Snapshot Histogram::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.bucket_bounds = bucket_bounds_;
+  absl::MutexLock lock(&mu_);
+  snapshot.bucket_counts = bucket_counts_;
+  for (int64_t count : bucket_counts_) {
+    snapshot.count += count;
+  }
+  snapshot.sum = sum_;
+  return snapshot;
+}
+
+const std::vector<double>& LatencyBuckets() {
+  static const std::vector<double>* buckets =
+      new std::vector<double>(ExponentialBuckets(0.0001, 2, 21));
+  return *buckets;
+}
+
+const std::vector<double>& ByteSizeBuckets() {
+  static const std::vector<double>* buckets =
+      new std::vector<double>(ExponentialBuckets(64, 4, 11));
+  return *buckets;
+}
+
+MetricRegistry* MetricRegistry::Global() {
+  static MetricRegistry* registry = new MetricRegistry();
+  return registry;
+}
+
+MetricRegistry::Family* MetricRegistry::GetFamily(absl::string_view name,
+                                                  absl::string_view help,
+                                                  Type type) {
+  auto itr = families_.find(name);
+  if (itr == families_.end()) {
+    itr = families_.emplace(std::string(name), Family{}).first;
+    itr->second.type = type;
+    itr->second.help = std::string(help);
+  }
+  ABSL_CHECK(itr->second.type == type)  // Crash OK
+      << "Metric " << name << " was registered with a different type";
+  return &itr->second;
+}
+
+Counter* MetricRegistry::GetCounter(absl::string_view name,
+                                    absl::string_view help,
+                                    const Labels& labels) {
+  absl::MutexLock lock(&mu_);
+  std::unique_ptr<Counter>& counter =
+      GetFamily(name, help, Type::kCounter)->counters[FormatLabels(labels)];
+  if (counter == nullptr) {
+    counter = std::make_unique<Counter>();
+  }
+  return counter.get();
+}
+
+Gauge* MetricRegistry::GetGauge(absl::string_view name, absl::string_view help,
+                                const Labels& labels) {
+  absl::MutexLock lock(&mu_);
+  std::unique_ptr<Gauge>& gauge =
+      GetFamily(name, help, Type::kGauge)->gauges[FormatLabels(labels)];
+  if (gauge == nullptr) {
+    gauge = std::make_unique<Gauge>();
+  }
+  return gauge.get();
+}
+
+Histogram* MetricRegistry::GetHistogram(
+    absl::string_view name, absl::string_view help,
+    const std::vector<double>& bucket_bounds, const Labels& labels) {
+  absl::MutexLock lock(&mu_);
+  Family* family = GetFamily(name, help, Type::kHistogram);
+  if (family->histograms.empty()) {
+    family->bucket_bounds = bucket_bounds;
+  }
+  std::unique_ptr<Histogram>& histogram =
+      family->histograms[FormatLabels(labels)];
+  if (histogram == nullptr) {
+    histogram = std::make_unique<Histogram>(family->bucket_bounds);
+  }
+  return histogram.get();
+}
+
+std::string MetricRegistry::ExportPrometheus() const {
+  absl::MutexLock lock(&mu_);
+  std::string out;
+  for (const auto& [name, family] : families_) {
+    absl::StrAppend(&out, "# HELP ", name, " ", family.help, "\n");
+    switch (family.type) {
+      case Type::kCounter:
+        absl::StrAppend(&out, "# TYPE ", name, " counter\n");
+        for (const auto& [labels, counter] : family.counters) {
+          absl::StrAppend(&out, name, BracedLabels(labels), " ",
+                          counter->value(), "\n");
+        }
+        break;
+      case Type::kGauge:
+        absl::StrAppend(&out, "# TYPE ", name, " gauge\n");
+        for (const auto& [labels, gauge] : family.gauges) {
+          absl::StrAppend(&out, name, BracedLabels(labels), " ", gauge->value(),
+                          "\n");
+        }
+        break;
+      case Type::kHistogram:
+        absl::StrAppend(&out, "# TYPE ", name, " histogram\n");
+        for (const auto& [labels, histogram] : family.histograms) {
+          Histogram::Snapshot snapshot = histogram->GetSnapshot();
+          int64_t cumulative_count = 0;
+          for (size_t i = 0; i < snapshot.bucket_bounds.size(); ++i) {
+            cumulative_count += snapshot.bucket_counts[i];
+            absl::StrAppend(
+                &out, name, "_bucket",
+                BucketLabels(labels, absl::StrCat(snapshot.bucket_bounds[i])),
+                " ", cumulative_count, "\n");
+          }
+          absl::StrAppend(&out, name, "_bucket", BucketLabels(labels, "+Inf"),
+                          " ", snapshot.count, "\n");
+          absl::StrAppend(&out, name, "_sum", BracedLabels(labels), " ",
+                          snapshot.sum, "\n");
+          absl::StrAppend(&out, name, "_count", BracedLabels(labels), " ",
+                          snapshot.count, "\n");
+        }
+        break;
+    }
+  }
+  return out;
+}
+
+}  // namespace metrics
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,170 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_METRICS_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace metrics {
+
+// Label names and values that identify one metric within a metric family,
+// e.g. {{"method", "Spanner.ExecuteSql"}}.
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+// A monotonically increasing count.
+class Counter {
+ public:
+  void Increment(int64_t delta = 1) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_ = 0;
+};
+
+// A count that can go up and down, such as the number of in-flight requests.
+class Gauge {
+ public:
+  void Add(int64_t delta) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_ = 0;
+};
+
+// A distribution of observed values over fixed buckets.
+//
+// This class is thread safe.
+class Histogram {
+ public:
+  // `bucket_bounds` are the inclusive upper bounds of the buckets, in
+  // increasing order. An implicit last bucket holds values above all bounds.
+  explicit Histogram(std::vector<double> bucket_bounds);
+
+  void Record(double value) ABSL_LOCKS_EXCLUDED(mu_);
+
+  struct Snapshot {
+    std::vector<double> bucket_bounds;
+    // Number of values in each bucket (not cumulative), one more than
+    // `bucket_bounds` for the values above all bounds.
+    std::vector<int64_t> bucket_counts;
+    int64_t count = 0;
+    double sum = 0;
+  };
+  Snapshot GetSnapshot() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const std::vector<double> bucket_bounds_;
+
+  mutable absl::Mutex mu_;
+  std::vector<int64_t> bucket_counts_ ABSL_GUARDED_BY(mu_);
+  double sum_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Bucket bounds for latencies, in seconds, from 100us to about 100s.
+const std::vector<double>& LatencyBuckets();
+
+// Bucket bounds for message sizes, in bytes, from 64B to 64MiB.
+const std::vector<double>& ByteSizeBuckets();
+
+// MetricRegistry owns the metrics of the emulator and exports them.
+//
+// Metrics are identified by a family name and their labels. The Get* methods
+// return the existing metric with the given name and labels if there is one,
+// so callers on hot paths should look up their metrics once and keep the
+// returned pointers, which stay valid for the life of the registry.
+//
+// This class is thread safe.
+class MetricRegistry {
+ public:
+  // Returns the process-wide registry.
+  static MetricRegistry* Global();
+
+  Counter* GetCounter(absl::string_view name, absl::string_view help,
+                      const Labels& labels = {}) ABSL_LOCKS_EXCLUDED(mu_);
+  Gauge* GetGauge(absl::string_view name, absl::string_view help,
+                  const Labels& labels = {}) ABSL_LOCKS_EXCLUDED(mu_);
+  // All histograms of a family share the bucket bounds of the first one.
+  Histogram* GetHistogram(absl::string_view name, absl::string_view help,
+                          const std::vector<double>& bucket_bounds,
+                          const Labels& labels = {}) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns all metrics in the Prometheus text exposition format.
+  std::string ExportPrometheus() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  enum class Type { kCounter, kGauge, kHistogram };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::vector<double> bucket_bounds;
+    // Keyed by the formatted labels, so that exports are in a stable order.
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+  };
+
+  Family* GetFamily(absl::string_view name, absl::string_view help, Type type)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable absl::Mutex mu_;
+  std::map<std::string, Family, std::less<>> families_ ABSL_GUARDED_BY(mu_);
+};
+
+// Records the time from its construction to its destruction, in seconds, in
+// a histogram.
+class ScopedLatencyRecorder {
+ public:
+  explicit ScopedLatencyRecorder(Histogram* histogram)
+      : histogram_(histogram), start_(absl::Now()) {}
+  ~ScopedLatencyRecorder() {
+    histogram_->Record(absl::ToDoubleSeconds(absl::Now() - start_));
+  }
+
+  ScopedLatencyRecorder(const ScopedLatencyRecorder&) = delete;
+  ScopedLatencyRecorder& operator=(const ScopedLatencyRecorder&) = delete;
+
+ private:
+  Histogram* histogram_;
+  absl::Time start_;
+};
+
+}  // namespace metrics
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_METRICS_H_
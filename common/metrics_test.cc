@@ -0,0 +1,86 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "common/metrics.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace metrics {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(MetricsTest, ReturnsSameMetricForSameNameAndLabels) {
+  MetricRegistry registry;
+  Counter* counter = registry.GetCounter("requests_total", "Requests.",
+                                         {{"method", "A"}});
+  EXPECT_EQ(counter, registry.GetCounter("requests_total", "Requests.",
+                                         {{"method", "A"}}));
+  EXPECT_NE(counter, registry.GetCounter("requests_total", "Requests.",
+                                         {{"method", "B"}}));
+}
+
+TEST(MetricsTest, ExportsCountersAndGauges) {
+  MetricRegistry registry;
+  registry.GetCounter("requests_total", "Requests.", {{"method", "A"}})
+      ->Increment(3);
+  Gauge* in_flight = registry.GetGauge("in_flight", "In-flight requests.");
+  in_flight->Add(2);
+  in_flight->Add(-1);
+
+  std::string exported = registry.ExportPrometheus();
+  EXPECT_THAT(exported, HasSubstr("# HELP requests_total Requests.\n"
+                                  "# TYPE requests_total counter\n"
+                                  "requests_total{method=\"A\"} 3\n"));
+  EXPECT_THAT(exported, HasSubstr("# TYPE in_flight gauge\nin_flight 1\n"));
+}
+
+TEST(MetricsTest, ExportsCumulativeHistogramBuckets) {
+  MetricRegistry registry;
+  Histogram* histogram = registry.GetHistogram("latency_seconds", "Latency.",
+                                               {1, 10}, {{"method", "A"}});
+  histogram->Record(0.5);
+  histogram->Record(1);
+  histogram->Record(5);
+  histogram->Record(20);
+
+  EXPECT_THAT(registry.ExportPrometheus(),
+              HasSubstr("latency_seconds_bucket{method=\"A\",le=\"1\"} 2\n"
+                        "latency_seconds_bucket{method=\"A\",le=\"10\"} 3\n"
+                        "latency_seconds_bucket{method=\"A\",le=\"+Inf\"} 4\n"
+                        "latency_seconds_sum{method=\"A\"} 26.5\n"
+                        "latency_seconds_count{method=\"A\"} 4\n"));
+}
+
+TEST(MetricsTest, EscapesLabelValues) {
+  MetricRegistry registry;
+  registry.GetCounter("errors_total", "Errors.", {{"message", "a\"b\\c\nd"}})
+      ->Increment();
+  EXPECT_THAT(registry.ExportPrometheus(),
+              HasSubstr("errors_total{message=\"a\\\"b\\\\c\\nd\"} 1\n"));
+}
+
+}  // namespace
+}  // namespace metrics
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,279 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "common/profiling.h"
+
+#include <execinfo.h>
+#include <malloc.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "common/errors.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace profiling {
+
+namespace {
+
+// Deepest call stack recorded by a CPU profile sample. Deeper stacks are
+// truncated.
+constexpr int kMaxStackDepth = 64;
+
+// Frames of a sample which belong to the signal handler and the kernel's
+// signal trampoline rather than to the interrupted thread.
+constexpr int kSkippedFrames = 2;
+
+// Samples kept by a CPU profile, about 8MiB. Further samples are dropped.
+constexpr int kMaxSamples = 1 << 14;
+
+struct Sample {
+  int depth;
+  void* frames[kMaxStackDepth];
+};
+
+// State shared with the SIGPROF handler, which may run on any thread. The
+// handler only records samples while `cpu_profile_samples` is set.
+std::atomic<Sample*> cpu_profile_samples = nullptr;
+std::atomic<int> cpu_profile_num_samples = 0;
+std::atomic<int> cpu_profile_running_handlers = 0;
+
+// Set while a CPU profile is being collected.
+std::atomic<bool> cpu_profile_active = false;
+
+void HandleProfilingSignal(int) {
+  int saved_errno = errno;
+  cpu_profile_running_handlers.fetch_add(1);
+  Sample* samples = cpu_profile_samples.load();
+  if (samples != nullptr) {
+    int index = cpu_profile_num_samples.fetch_add(1);
+    if (index < kMaxSamples) {
+      samples[index].depth =
+          backtrace(samples[index].frames, kMaxStackDepth);
+    }
+  }
+  cpu_profile_running_handlers.fetch_sub(1);
+  errno = saved_errno;
+}
+
+// Installs the SIGPROF handler. The handler stays installed once the first
+// profile has been collected: a signal still pending when profiling stops
+// would otherwise terminate the process.
+absl::Status InstallProfilingSignalHandler() {
+  static absl::Mutex mu(absl::kConstInit);
+  static bool installed = false;
+  absl::MutexLock lock(&mu);
+  if (installed) {
+    return absl::OkStatus();
+  }
+  // backtrace() loads the unwinder on its first call, which is not safe to do
+  // in a signal handler.
+  void* frame;
+  backtrace(&frame, 1);
+
+  struct sigaction action = {};
+  action.sa_handler = HandleProfilingSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, nullptr) != 0) {
+    return error::CpuProfilingFailed(std::strerror(errno));
+  }
+  installed = true;
+  return absl::OkStatus();
+}
+
+absl::Status SetProfilingTimer(absl::Duration interval) {
+  struct itimerval timer = {};
+  timer.it_interval = absl::ToTimeval(interval);
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    return error::CpuProfilingFailed(std::strerror(errno));
+  }
+  return absl::OkStatus();
+}
+
+void AppendWord(uintptr_t word, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&word), sizeof(word));
+}
+
+// Encodes `samples` in the legacy CPU profile format: a header, one record
+// per distinct call stack, a trailer and the memory map of the process, which
+// pprof uses to symbolize the addresses.
+std::string EncodeCpuProfile(const std::vector<Sample>& samples,
+                             absl::Duration period) {
+  std::map<std::vector<uintptr_t>, uintptr_t> stack_counts;
+  for (const Sample& sample : samples) {
+    if (sample.depth <= kSkippedFrames) {
+      continue;
+    }
+    std::vector<uintptr_t> stack;
+    for (int i = kSkippedFrames; i < sample.depth; ++i) {
+      stack.push_back(reinterpret_cast<uintptr_t>(sample.frames[i]));
+    }
+    ++stack_counts[std::move(stack)];
+  }
+
+  std::string profile;
+  // Header: header words, version, sampling period in microseconds, padding.
+  for (uintptr_t word :
+       {uintptr_t{0}, uintptr_t{3}, uintptr_t{0},
+        static_cast<uintptr_t>(absl::ToInt64Microseconds(period)),
+        uintptr_t{0}}) {
+    AppendWord(word, &profile);
+  }
+  for (const auto& [stack, count] : stack_counts) {
+    AppendWord(count, &profile);
+    AppendWord(stack.size(), &profile);
+    for (uintptr_t pc : stack) {
+      AppendWord(pc, &profile);
+    }
+  }
+  for (uintptr_t word : {uintptr_t{0}, uintptr_t{1}, uintptr_t{0}}) {
+    AppendWord(word, &profile);
+  }
+
+  std::ifstream maps("/proc/self/maps");
+  std::stringstream maps_text;
+  maps_text << maps.rdbuf();
+  absl::StrAppend(&profile, maps_text.str());
+  return profile;
+}
+
+}  // namespace
+
+MemoryUsageRegistry* MemoryUsageRegistry::Global() {
+  static MemoryUsageRegistry* registry = new MemoryUsageRegistry();
+  return registry;
+}
+
+MemoryUsageRegistry::Registration::~Registration() {
+  registry_->Unregister(id_);
+}
+
+std::unique_ptr<MemoryUsageRegistry::Registration>
+MemoryUsageRegistry::Register(absl::string_view subsystem,
+                              std::function<int64_t()> estimator) {
+  absl::MutexLock lock(&mu_);
+  int64_t id = next_id_++;
+  estimators_[id] = {std::string(subsystem), std::move(estimator)};
+  return std::unique_ptr<Registration>(new Registration(this, id));
+}
+
+void MemoryUsageRegistry::Unregister(int64_t id) {
+  absl::MutexLock lock(&mu_);
+  estimators_.erase(id);
+}
+
+std::map<std::string, int64_t> MemoryUsageRegistry::EstimateBySubsystem()
+    const {
+  std::map<std::string, int64_t> usage;
+  // Estimators run with the lock held so that they are not unregistered, and
+  // their subsystem destroyed, while they run.
+  absl::ReaderMutexLock lock(&mu_);
+  for (const auto& [id, estimator] : estimators_) {
+    usage[estimator.subsystem] += estimator.estimate();
+  }
+  return usage;
+}
+
+AllocatorStats GetAllocatorStats() {
+  AllocatorStats stats;
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 info = mallinfo2();
+  stats.in_use_bytes = info.uordblks + info.hblkhd;
+  stats.system_bytes = info.arena + info.hblkhd;
+  stats.free_bytes = info.fordblks;
+#endif
+  return stats;
+}
+
+std::string HeapProfile(const MemoryUsageRegistry& registry) {
+  AllocatorStats stats = GetAllocatorStats();
+  std::map<std::string, int64_t> usage = registry.EstimateBySubsystem();
+
+  std::string profile = "# Allocator statistics, in bytes.\n";
+  absl::StrAppend(&profile, "in_use: ", stats.in_use_bytes, "\n");
+  absl::StrAppend(&profile, "system: ", stats.system_bytes, "\n");
+  absl::StrAppend(&profile, "free: ", stats.free_bytes, "\n");
+  absl::StrAppend(&profile, "# Estimated usage by subsystem, in bytes.\n");
+  int64_t attributed = 0;
+  for (const auto& [subsystem, bytes] : usage) {
+    absl::StrAppend(&profile, subsystem, ": ", bytes, "\n");
+    attributed += bytes;
+  }
+  absl::StrAppend(&profile, "unattributed: ",
+                  std::max<int64_t>(0, stats.in_use_bytes - attributed), "\n");
+  return profile;
+}
+
+absl::StatusOr<std::string> CpuProfile(absl::Duration duration,
+                                       int frequency) {
+  if (cpu_profile_active.exchange(true)) {
+    return error::CpuProfileInProgress();
+  }
+  absl::Cleanup deactivate = [] { cpu_profile_active.store(false); };
+
+  ZETASQL_RETURN_IF_ERROR(InstallProfilingSignalHandler());
+  std::vector<Sample> samples(kMaxSamples);
+  cpu_profile_num_samples.store(0);
+  cpu_profile_samples.store(samples.data());
+
+  absl::Duration period = absl::Seconds(1) / std::clamp(frequency, 1, 1000);
+  absl::Status status = SetProfilingTimer(period);
+  if (status.ok()) {
+    absl::SleepFor(duration);
+    status = SetProfilingTimer(absl::ZeroDuration());
+  }
+
+  // Waits for handlers which may still be writing to the samples.
+  cpu_profile_samples.store(nullptr);
+  while (cpu_profile_running_handlers.load() > 0) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  ZETASQL_RETURN_IF_ERROR(status);
+  samples.resize(std::min(cpu_profile_num_samples.load(), kMaxSamples));
+  return EncodeCpuProfile(samples, period);
+}
+
+}  // namespace profiling
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,124 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_PROFILING_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_PROFILING_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace profiling {
+
+// Estimates the memory used by each subsystem of the emulator, such as the
+// storage of the databases.
+//
+// Subsystems register an estimator which walks their data structures when a
+// heap profile is requested, so that attributing memory costs nothing on the
+// allocation path. Several registrations may share a subsystem name, e.g. one
+// per database, and are summed.
+//
+// This class is thread safe.
+class MemoryUsageRegistry {
+ public:
+  // Returns the process-wide registry.
+  static MemoryUsageRegistry* Global();
+
+  // Unregisters its estimator when destroyed. Destruction waits for a running
+  // call to the estimator to return.
+  class Registration {
+   public:
+    ~Registration();
+
+   private:
+    friend class MemoryUsageRegistry;
+    Registration(MemoryUsageRegistry* registry, int64_t id)
+        : registry_(registry), id_(id) {}
+
+    MemoryUsageRegistry* registry_;
+    const int64_t id_;
+  };
+
+  // Registers `estimator`, which returns the approximate number of bytes used
+  // by an instance of `subsystem`. It is called without any lock of the
+  // caller held, and must stay valid until the registration is destroyed.
+  std::unique_ptr<Registration> Register(
+      absl::string_view subsystem, std::function<int64_t()> estimator)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the estimated bytes used by each subsystem, by name.
+  std::map<std::string, int64_t> EstimateBySubsystem() const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Estimator {
+    std::string subsystem;
+    std::function<int64_t()> estimate;
+  };
+
+  void Unregister(int64_t id) ABSL_LOCKS_EXCLUDED(mu_);
+
+  mutable absl::Mutex mu_;
+  int64_t next_id_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::btree_map<int64_t, Estimator> estimators_ ABSL_GUARDED_BY(mu_);
+};
+
+// Statistics of the process' malloc heap. All zero if the C library does not
+// report them.
+struct AllocatorStats {
+  // Bytes in allocated blocks, including blocks mapped on their own.
+  int64_t in_use_bytes = 0;
+  // Bytes obtained from the system, allocated or not.
+  int64_t system_bytes = 0;
+  // Bytes obtained from the system but not allocated.
+  int64_t free_bytes = 0;
+};
+
+AllocatorStats GetAllocatorStats();
+
+// Returns a text heap profile: the allocator statistics followed by the
+// estimates of `registry` per subsystem, one "name: bytes" line each. Bytes in
+// use which no subsystem accounts for are reported as "unattributed".
+std::string HeapProfile(const MemoryUsageRegistry& registry);
+
+// Samples the call stacks of the process' threads `frequency` times per second
+// of CPU time for `duration`, and returns them in the legacy binary CPU
+// profile format read by pprof. Blocks the calling thread for `duration`.
+//
+// Profiling uses SIGPROF, so only one profile is collected at a time and the
+// process must not otherwise use SIGPROF or ITIMER_PROF. Returns
+// FailedPrecondition if another profile is being collected.
+absl::StatusOr<std::string> CpuProfile(absl::Duration duration,
+                                       int frequency = 100);
+
+}  // namespace profiling
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_PROFILING_H_
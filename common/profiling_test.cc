@@ -0,0 +1,113 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "common/profiling.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace profiling {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::zetasql_base::testing::StatusIs;
+
+TEST(MemoryUsageRegistryTest, SumsEstimatesBySubsystem) {
+  MemoryUsageRegistry registry;
+  auto first = registry.Register("storage", [] { return 100; });
+  auto second = registry.Register("storage", [] { return 20; });
+  auto third = registry.Register("schemas", [] { return 3; });
+  EXPECT_THAT(registry.EstimateBySubsystem(),
+              ElementsAre(Pair("schemas", 3), Pair("storage", 120)));
+
+  second.reset();
+  third.reset();
+  EXPECT_THAT(registry.EstimateBySubsystem(),
+              ElementsAre(Pair("storage", 100)));
+  first.reset();
+  EXPECT_THAT(registry.EstimateBySubsystem(), IsEmpty());
+}
+
+TEST(HeapProfileTest, ReportsAllocatorAndSubsystems) {
+  MemoryUsageRegistry registry;
+  auto registration = registry.Register("storage", [] { return 1234; });
+  std::string profile = HeapProfile(registry);
+  EXPECT_THAT(profile, HasSubstr("\nin_use: "));
+  EXPECT_THAT(profile, HasSubstr("\nstorage: 1234\n"));
+  EXPECT_THAT(profile, HasSubstr("\nunattributed: "));
+}
+
+// Returns the word at `index` of a binary CPU profile.
+uintptr_t ProfileWord(const std::string& profile, int index) {
+  uintptr_t word = 0;
+  std::memcpy(&word, profile.data() + index * sizeof(word), sizeof(word));
+  return word;
+}
+
+TEST(CpuProfileTest, SamplesBusyThreads) {
+  std::atomic<bool> done = false;
+  std::thread busy([&done] {
+    volatile uint64_t sum = 0;
+    while (!done.load()) {
+      sum = sum + 1;
+    }
+  });
+  absl::StatusOr<std::string> profile =
+      CpuProfile(absl::Milliseconds(500), /*frequency=*/100);
+  done.store(true);
+  busy.join();
+  ZETASQL_ASSERT_OK(profile);
+
+  ASSERT_GT(profile->size(), 5 * sizeof(uintptr_t));
+  EXPECT_EQ(ProfileWord(*profile, 0), 0);
+  EXPECT_EQ(ProfileWord(*profile, 1), 3);
+  EXPECT_EQ(ProfileWord(*profile, 3), 10000);
+  // The first record follows the header and counts at least one sample.
+  EXPECT_GT(ProfileWord(*profile, 5), 0);
+  // The memory map of the process ends the profile.
+  EXPECT_THAT(*profile, HasSubstr("r-xp"));
+}
+
+TEST(CpuProfileTest, RejectsConcurrentProfiles) {
+  std::thread profiler(
+      [] { ZETASQL_EXPECT_OK(CpuProfile(absl::Milliseconds(500))); });
+  absl::SleepFor(absl::Milliseconds(100));
+  EXPECT_THAT(CpuProfile(absl::Milliseconds(10)),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  profiler.join();
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
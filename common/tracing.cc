@@ -0,0 +1,159 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "common/tracing.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/base/logging.h"
+#include "absl/random/random.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "common/config.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace tracing {
+
+namespace {
+
+// The innermost live span of this thread.
+thread_local ScopedSpan* current_span = nullptr;
+
+void LogSpan(const SpanData& span) {
+  ABSL_LOG(INFO) << "Span " << span.name
+                 << " trace_id=" << span.context.trace_id
+                 << " span_id=" << span.context.span_id
+                 << " parent_span_id=" << span.parent_span_id << " start="
+                 << absl::FormatTime(absl::RFC3339_full, span.start_time,
+                                     absl::UTCTimeZone())
+                 << " duration=" << absl::FormatDuration(span.duration);
+}
+
+SpanExporter& Exporter() {
+  static SpanExporter* exporter = new SpanExporter(LogSpan);
+  return *exporter;
+}
+
+// Returns a random id of `num_bytes` bytes as lowercase hex digits.
+std::string RandomId(int num_bytes) {
+  thread_local absl::BitGen bitgen;
+  std::string id;
+  id.reserve(2 * num_bytes);
+  for (int i = 0; i < num_bytes; i += 8) {
+    absl::StrAppend(&id,
+                    absl::StrFormat("%016x", absl::Uniform<uint64_t>(bitgen)));
+  }
+  id.resize(2 * num_bytes);
+  return id;
+}
+
+// Returns true if `id` is `num_digits` lowercase hex digits, not all zero.
+bool IsValidId(absl::string_view id, int num_digits) {
+  if (id.size() != num_digits) {
+    return false;
+  }
+  bool all_zero = true;
+  for (char c : id) {
+    if (!absl::ascii_isxdigit(c) || absl::ascii_isupper(c)) {
+      return false;
+    }
+    all_zero &= c == '0';
+  }
+  return !all_zero;
+}
+
+}  // namespace
+
+std::optional<SpanContext> ParseTraceparent(absl::string_view traceparent) {
+  std::vector<absl::string_view> parts = absl::StrSplit(traceparent, '-');
+  // Version 00 has exactly four fields; later versions may append more.
+  if (parts.size() < 4 || parts[0].size() != 2 || parts[0] == "ff" ||
+      (parts[0] == "00" && parts.size() != 4) || parts[3].size() != 2 ||
+      !IsValidId(parts[1], 32) || !IsValidId(parts[2], 16)) {
+    return std::nullopt;
+  }
+  return SpanContext{std::string(parts[1]), std::string(parts[2])};
+}
+
+void SetSpanExporter(SpanExporter exporter) {
+  Exporter() = std::move(exporter);
+}
+
+ScopedSpan::ScopedSpan(absl::string_view name) {
+  if (config::tracing_enabled()) {
+    Start(name, current_span != nullptr ? &current_span->data_.context
+                                        : nullptr);
+  }
+}
+
+ScopedSpan::ScopedSpan(absl::string_view name,
+                       const std::optional<SpanContext>& remote_parent) {
+  if (config::tracing_enabled()) {
+    if (remote_parent.has_value()) {
+      Start(name, &*remote_parent);
+    } else {
+      Start(name, current_span != nullptr ? &current_span->data_.context
+                                          : nullptr);
+    }
+  }
+}
+
+void ScopedSpan::Start(absl::string_view name, const SpanContext* parent) {
+  recording_ = true;
+  data_.name = std::string(name);
+  if (parent != nullptr) {
+    data_.context.trace_id = parent->trace_id;
+    data_.parent_span_id = parent->span_id;
+  } else {
+    data_.context.trace_id = RandomId(16);
+  }
+  data_.context.span_id = RandomId(8);
+  enclosing_ = current_span;
+  current_span = this;
+  data_.start_time = absl::Now();
+}
+
+ScopedSpan::~ScopedSpan() {
+  if (!recording_) {
+    return;
+  }
+  data_.duration = absl::Now() - data_.start_time;
+  current_span = enclosing_;
+  Exporter()(data_);
+}
+
+std::optional<SpanContext> CurrentSpanContext() {
+  if (current_span == nullptr) {
+    return std::nullopt;
+  }
+  return current_span->data_.context;
+}
+
+}  // namespace tracing
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
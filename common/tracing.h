@@ -0,0 +1,106 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_TRACING_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_TRACING_H_
+
+#include <functional>
+#include <optional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace tracing {
+
+// Identifies a span within a trace. The ids use the formats of the W3C Trace
+// Context, so that emulator spans can continue the traces of applications.
+struct SpanContext {
+  // 32 lowercase hex digits.
+  std::string trace_id;
+  // 16 lowercase hex digits.
+  std::string span_id;
+};
+
+// Parses the value of a W3C traceparent header, e.g.
+// "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01". Returns nullopt
+// if the value is malformed.
+std::optional<SpanContext> ParseTraceparent(absl::string_view traceparent);
+
+// A finished span.
+struct SpanData {
+  std::string name;
+  SpanContext context;
+  // Id of the enclosing span, empty for the root span of a trace.
+  std::string parent_span_id;
+  absl::Time start_time;
+  absl::Duration duration;
+};
+
+// Receives the spans as they finish, on the thread that ran them.
+using SpanExporter = std::function<void(const SpanData&)>;
+
+// Replaces the exporter of finished spans. The default exporter writes each
+// span as a line of the INFO log. Not thread safe with respect to running
+// spans; meant to be called at startup or in tests.
+void SetSpanExporter(SpanExporter exporter);
+
+// ScopedSpan traces the scope in which it lives, e.g.
+//
+//   tracing::ScopedSpan span("QueryEngine::ExecuteSql");
+//
+// Spans started on a thread while another span is live on it are nested inside
+// that span. Spans are only recorded if tracing is enabled (--enable_tracing);
+// otherwise constructing one only checks the flag.
+class ScopedSpan {
+ public:
+  explicit ScopedSpan(absl::string_view name);
+
+  // Starts a span inside `remote_parent`, such as the span of a client
+  // propagated in request metadata, or inside the current span of this thread
+  // if `remote_parent` is not set.
+  ScopedSpan(absl::string_view name,
+             const std::optional<SpanContext>& remote_parent);
+
+  ~ScopedSpan();
+
+  ScopedSpan(const ScopedSpan&) = delete;
+  ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+ private:
+  friend std::optional<SpanContext> CurrentSpanContext();
+
+  void Start(absl::string_view name, const SpanContext* parent);
+
+  bool recording_ = false;
+  SpanData data_;
+
+  // The span which was current on this thread when this one started.
+  ScopedSpan* enclosing_ = nullptr;
+};
+
+// Returns the context of the innermost live span of this thread, if any.
+std::optional<SpanContext> CurrentSpanContext();
+
+}  // namespace tracing
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_TRACING_H_
@@ -0,0 +1,125 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "common/tracing.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "common/config.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace tracing {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+using ::testing::Not;
+
+class TracingTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    config::set_tracing_enabled(true);
+    SetSpanExporter([this](const SpanData& span) { spans_.push_back(span); });
+  }
+
+  void TearDown() override {
+    config::set_tracing_enabled(false);
+    SetSpanExporter([](const SpanData&) {});
+  }
+
+  std::vector<SpanData> spans_;
+};
+
+TEST_F(TracingTest, NestsSpansOfAThread) {
+  {
+    ScopedSpan outer("outer");
+    ScopedSpan inner("inner");
+  }
+  ASSERT_THAT(spans_, ElementsAre(Field(&SpanData::name, "inner"),
+                                  Field(&SpanData::name, "outer")));
+  const SpanData& inner = spans_[0];
+  const SpanData& outer = spans_[1];
+  EXPECT_EQ(inner.context.trace_id, outer.context.trace_id);
+  EXPECT_EQ(inner.parent_span_id, outer.context.span_id);
+  EXPECT_THAT(outer.parent_span_id, IsEmpty());
+  EXPECT_EQ(outer.context.trace_id.size(), 32);
+  EXPECT_EQ(outer.context.span_id.size(), 16);
+  EXPECT_NE(inner.context.span_id, outer.context.span_id);
+  EXPECT_EQ(CurrentSpanContext(), std::nullopt);
+}
+
+TEST_F(TracingTest, ContinuesRemoteTraces) {
+  std::optional<SpanContext> remote = ParseTraceparent(
+      "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+  ASSERT_TRUE(remote.has_value());
+  {
+    ScopedSpan span("Spanner.ExecuteSql", remote);
+    ScopedSpan child("QueryEngine::ExecuteSql");
+  }
+  ASSERT_EQ(spans_.size(), 2);
+  EXPECT_EQ(spans_[1].context.trace_id, "4bf92f3577b34da6a3ce929d0e0e4736");
+  EXPECT_EQ(spans_[1].parent_span_id, "00f067aa0ba902b7");
+  EXPECT_EQ(spans_[0].parent_span_id, spans_[1].context.span_id);
+}
+
+TEST_F(TracingTest, StartsNewTraceWithoutRemoteParent) {
+  { ScopedSpan span("Spanner.Commit", std::nullopt); }
+  ASSERT_EQ(spans_.size(), 1);
+  EXPECT_THAT(spans_[0].parent_span_id, IsEmpty());
+  EXPECT_THAT(spans_[0].context.trace_id, Not(IsEmpty()));
+}
+
+TEST_F(TracingTest, RecordsNothingWhenDisabled) {
+  config::set_tracing_enabled(false);
+  {
+    ScopedSpan span("span");
+    EXPECT_EQ(CurrentSpanContext(), std::nullopt);
+  }
+  EXPECT_THAT(spans_, IsEmpty());
+}
+
+TEST(TraceparentTest, RejectsMalformedValues) {
+  EXPECT_EQ(ParseTraceparent(""), std::nullopt);
+  EXPECT_EQ(ParseTraceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-01"),
+            std::nullopt);
+  // All-zero ids are invalid.
+  EXPECT_EQ(ParseTraceparent(
+                "00-00000000000000000000000000000000-00f067aa0ba902b7-01"),
+            std::nullopt);
+  EXPECT_EQ(ParseTraceparent(
+                "00-4bf92f3577b34da6a3ce929d0e0e4736-0000000000000000-01"),
+            std::nullopt);
+  // Ids are lowercase.
+  EXPECT_EQ(ParseTraceparent(
+                "00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01"),
+            std::nullopt);
+  EXPECT_EQ(ParseTraceparent(
+                "ff-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01"),
+            std::nullopt);
+}
+
+}  // namespace
+}  // namespace tracing
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
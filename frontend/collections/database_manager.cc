@@ -16,24 +16,38 @@
 
 #include "frontend/collections/database_manager.h"
 
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <map>
 #include <memory>
 #include <string>
+#include <system_error>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "zetasql/base/logging.h"
 #include "absl/base/thread_annotations.h"
+#include "absl/flags/flag.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
 #include "absl/synchronization/mutex.h"
 #include "backend/database/database.h"
+#include "backend/database/durability.h"
+#include "backend/database/schema_template.h"
+#include "backend/database/snapshot.h"
 #include "common/clock.h"
 #include "common/errors.h"
 #include "common/limits.h"
 #include "frontend/common/uris.h"
 #include "zetasql/base/status_macros.h"
 
+ABSL_FLAG(int64_t, database_schema_template_cache_size, 100,
+          "Maximum number of distinct CreateDatabase schemas whose built "
+          "schema is kept and shared by later databases created with the same "
+          "DDL statements. 0 disables sharing.");
+
 namespace google {
 namespace spanner {
 namespace emulator {
@@ -57,6 +71,18 @@ std::vector<std::shared_ptr<Database>> GetDatabasesByInstance(
   return databases;
 }
 
+// Database URIs are mapped to directory names by replacing their slashes with
+// a character which is not allowed in resource ids.
+constexpr char kDurableDirSeparator[] = "~";
+
+// Returns the URI of the instance of the database with the given URI.
+absl::StatusOr<std::string> InstanceUriOf(const std::string& database_uri) {
+  absl::string_view project_id, instance_id, database_id;
+  ZETASQL_RETURN_IF_ERROR(
+      ParseDatabaseUri(database_uri, &project_id, &instance_id, &database_id));
+  return MakeInstanceUri(project_id, instance_id);
+}
+
 }  // namespace
 
 absl::StatusOr<std::shared_ptr<Database>> DatabaseManager::CreateDatabase(
@@ -65,25 +91,119 @@ absl::StatusOr<std::shared_ptr<Database>> DatabaseManager::CreateDatabase(
   // Perform bulk of the work outside the database manager lock to allow
   // CreateDatabase calls to execute in parallel. A common test pattern is to
   // Create/Drop a database per unit test, and run unit tests in parallel. So
-  // we want to optimize this use case.
-  absl::string_view project_id, instance_id, database_id;
-  ZETASQL_RETURN_IF_ERROR(
-      ParseDatabaseUri(database_uri, &project_id, &instance_id, &database_id));
-  std::string instance_uri = MakeInstanceUri(project_id, instance_id);
+  // we want to optimize this use case. Reserving the URI first makes requests
+  // for an existing database, or beyond the quota, fail without building it.
+  ZETASQL_RETURN_IF_ERROR(ReserveDatabaseUri(database_uri));
+  absl::StatusOr<std::unique_ptr<backend::Database>> backend_db =
+      [&]() -> absl::StatusOr<std::unique_ptr<backend::Database>> {
+    ZETASQL_ASSIGN_OR_RETURN(
+        std::shared_ptr<const backend::SchemaTemplate> schema_template,
+        GetSchemaTemplate(schema_change_operation));
+    if (schema_template != nullptr) {
+      return backend::Database::CreateFromTemplate(clock_,
+                                                   std::move(schema_template));
+    }
+    return backend::Database::Create(clock_, schema_change_operation);
+  }();
+  if (!backend_db.ok()) {
+    ReleaseDatabaseUri(database_uri);
+    return backend_db.status();
+  }
+  return AddNewDatabase(database_uri, *std::move(backend_db));
+}
 
-  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<backend::Database> backend_db,
-                   backend::Database::Create(clock_, schema_change_operation));
-  auto database = std::make_shared<Database>(
-      database_uri, std::move(backend_db), clock_->Now());
+absl::StatusOr<std::shared_ptr<const backend::SchemaTemplate>>
+DatabaseManager::GetSchemaTemplate(
+    const backend::SchemaChangeOperation& schema_change_operation) {
+  const int64_t max_templates =
+      absl::GetFlag(FLAGS_database_schema_template_cache_size);
+  if (max_templates <= 0 || schema_change_operation.statements.empty()) {
+    return nullptr;
+  }
+  std::string fingerprint =
+      backend::SchemaTemplate::Fingerprint(schema_change_operation);
+  {
+    absl::MutexLock lock(&mu_);
+    auto itr = schema_templates_.find(fingerprint);
+    if (itr != schema_templates_.end()) {
+      return itr->second;
+    }
+  }
 
-  // Now update the database manager state. We could do the validation checks
-  // at the top of this function, but we would have to do it here again anyway,
-  // so we don't bother optimizing that case.
+  // Build the template outside the lock, like CreateDatabase builds databases.
+  // Invalid statements are not cached and fail every CreateDatabase request.
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::shared_ptr<const backend::SchemaTemplate> schema_template,
+      backend::SchemaTemplate::Create(schema_change_operation));
   absl::MutexLock lock(&mu_);
+  if (schema_templates_.size() >= static_cast<size_t>(max_templates)) {
+    schema_templates_.clear();
+  }
+  // Null templates are cached too, so that schemas which cannot be shared are
+  // not built twice.
+  return schema_templates_.try_emplace(fingerprint, schema_template)
+      .first->second;
+}
 
-  // Check that a database with this name does not already exist.
-  auto itr = database_map_.find(database_uri);
-  if (itr != database_map_.end()) {
+absl::StatusOr<std::shared_ptr<Database>>
+DatabaseManager::RestoreDatabaseFromSnapshot(const std::string& database_uri,
+                                             const std::string& snapshot_path) {
+  ZETASQL_RETURN_IF_ERROR(ReserveDatabaseUri(database_uri));
+  absl::StatusOr<std::unique_ptr<backend::Database>> backend_db =
+      backend::RestoreDatabaseSnapshotFromFile(clock_, snapshot_path);
+  if (!backend_db.ok()) {
+    ReleaseDatabaseUri(database_uri);
+    return backend_db.status();
+  }
+  return AddNewDatabase(database_uri, *std::move(backend_db));
+}
+
+absl::StatusOr<std::shared_ptr<Database>> DatabaseManager::CloneDatabase(
+    const std::string& source_database_uri, const std::string& database_uri) {
+  ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Database> source,
+                   GetDatabase(source_database_uri));
+  ZETASQL_RETURN_IF_ERROR(ReserveDatabaseUri(database_uri));
+  absl::StatusOr<std::unique_ptr<backend::Database>> backend_db =
+      source->backend()->Clone();
+  if (!backend_db.ok()) {
+    ReleaseDatabaseUri(database_uri);
+    return backend_db.status();
+  }
+  return AddNewDatabase(database_uri, *std::move(backend_db));
+}
+
+absl::Status DatabaseManager::SnapshotDatabase(
+    const std::string& database_uri, const std::string& snapshot_path) const {
+  ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Database> database,
+                   GetDatabase(database_uri));
+  return backend::WriteDatabaseSnapshotToFile(database->backend(),
+                                              snapshot_path);
+}
+
+absl::StatusOr<absl::Time> DatabaseManager::ExportDatabase(
+    const std::string& database_uri, const std::string& export_dir) const {
+  ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Database> database,
+                   GetDatabase(database_uri));
+  return database->backend()->Export(export_dir);
+}
+
+std::string DatabaseManager::DurableDatabaseDir(
+    const std::string& database_uri) const {
+  return absl::StrCat(
+      wal_dir_, "/",
+      absl::StrReplaceAll(database_uri, {{"/", kDurableDirSeparator}}));
+}
+
+absl::Status DatabaseManager::ReserveDatabaseUri(
+    const std::string& database_uri) {
+  ZETASQL_ASSIGN_OR_RETURN(std::string instance_uri,
+                   InstanceUriOf(database_uri));
+  absl::MutexLock lock(&mu_);
+
+  // Check that a database with this name does not already exist, and is not
+  // being built by a concurrent request.
+  if (database_map_.find(database_uri) != database_map_.end() ||
+      reserved_database_uris_.contains(database_uri)) {
     return error::DatabaseAlreadyExists(database_uri);
   }
 
@@ -93,10 +213,52 @@ absl::StatusOr<std::shared_ptr<Database>> DatabaseManager::CreateDatabase(
     return error::TooManyDatabasesPerInstance(instance_uri);
   }
 
-  // Record this database in the database manager.
-  database_map_[database_uri] = database;
+  reserved_database_uris_.insert(database_uri);
   num_databases_per_instance_[instance_uri] += 1;
+  return absl::OkStatus();
+}
+
+void DatabaseManager::ReleaseDatabaseUri(const std::string& database_uri) {
+  // The URI was parsed successfully when it was reserved.
+  std::string instance_uri = InstanceUriOf(database_uri).value();
+  absl::MutexLock lock(&mu_);
+  reserved_database_uris_.erase(database_uri);
+  num_databases_per_instance_[instance_uri] -= 1;
+}
+
+std::shared_ptr<Database> DatabaseManager::AddNewDatabase(
+    const std::string& database_uri,
+    std::unique_ptr<backend::Database> backend_db) {
+  if (wal_dir_.empty()) {
+    return AddDatabase(database_uri, std::move(backend_db), nullptr);
+  }
+  // The reservation guarantees that no other database uses this directory.
+  std::string dir = DurableDatabaseDir(database_uri);
+  absl::Status status = backend::EnableDurability(backend_db.get(), dir);
+  if (!status.ok()) {
+    ABSL_LOG(WARNING) << "Database " << database_uri
+                      << " is only kept in memory: " << status;
+    return AddDatabase(database_uri, std::move(backend_db), nullptr);
+  }
+  auto checkpointer =
+      std::make_unique<backend::DatabaseCheckpointer>(backend_db.get(), dir);
+  return AddDatabase(database_uri, std::move(backend_db),
+                     std::move(checkpointer));
+}
+
+std::shared_ptr<Database> DatabaseManager::AddDatabase(
+    const std::string& database_uri,
+    std::unique_ptr<backend::Database> backend_db,
+    std::unique_ptr<backend::DatabaseCheckpointer> checkpointer) {
+  auto database =
+      std::make_shared<Database>(database_uri, std::move(backend_db),
+                                 clock_->Now(), std::move(checkpointer));
 
+  // Record this database in the database manager. Its quota was taken when
+  // its URI was reserved.
+  absl::MutexLock lock(&mu_);
+  reserved_database_uris_.erase(database_uri);
+  database_map_[database_uri] = database;
   return database;
 }
 
@@ -112,7 +274,16 @@ absl::StatusOr<std::shared_ptr<Database>> DatabaseManager::GetDatabase(
 
 absl::Status DatabaseManager::DeleteDatabase(const std::string& database_uri) {
   absl::MutexLock lock(&mu_);
-  if (database_map_.erase(database_uri) > 0) {
+  auto itr = database_map_.find(database_uri);
+  if (itr != database_map_.end()) {
+    // The database may outlive this call while in use by other requests, so
+    // stop its checkpoints before removing its durable state.
+    if (!wal_dir_.empty()) {
+      itr->second->StopCheckpoints();
+      std::error_code ec;
+      std::filesystem::remove_all(DurableDatabaseDir(database_uri), ec);
+    }
+    database_map_.erase(itr);
     absl::string_view project_id, instance_id, database_id;
     ZETASQL_RETURN_IF_ERROR(ParseDatabaseUri(database_uri, &project_id, &instance_id,
                                      &database_id));
@@ -128,6 +299,38 @@ DatabaseManager::ListDatabases(const std::string& instance_uri) const {
   return GetDatabasesByInstance(database_map_, instance_uri);
 }
 
+absl::StatusOr<std::vector<std::string>>
+DatabaseManager::RecoverDurableDatabases() {
+  std::vector<std::string> database_uris;
+  std::error_code ec;
+  if (wal_dir_.empty() || !std::filesystem::exists(wal_dir_, ec)) {
+    return database_uris;
+  }
+  for (const auto& entry : std::filesystem::directory_iterator(wal_dir_, ec)) {
+    std::string dir = entry.path().string();
+    if (!entry.is_directory() || !backend::IsDurableDatabaseDir(dir)) {
+      continue;
+    }
+    std::string database_uri = absl::StrReplaceAll(
+        entry.path().filename().string(), {{kDurableDirSeparator, "/"}});
+    ZETASQL_RETURN_IF_ERROR(ReserveDatabaseUri(database_uri));
+    absl::StatusOr<std::unique_ptr<backend::Database>> backend_db =
+        backend::RecoverDatabase(clock_, dir);
+    if (!backend_db.ok()) {
+      ReleaseDatabaseUri(database_uri);
+      return backend_db.status();
+    }
+    auto checkpointer = std::make_unique<backend::DatabaseCheckpointer>(
+        backend_db->get(), dir);
+    AddDatabase(database_uri, *std::move(backend_db), std::move(checkpointer));
+    database_uris.push_back(database_uri);
+  }
+  if (ec) {
+    return error::WriteAheadLogIOError(wal_dir_, "list", ec.value());
+  }
+  return database_uris;
+}
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
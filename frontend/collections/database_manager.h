@@ -17,36 +17,89 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_DATABASE_MANAGER_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_DATABASE_MANAGER_H_
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/flags/declare.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/database/database.h"
+#include "backend/database/durability.h"
+#include "backend/database/schema_template.h"
 #include "backend/schema/updater/schema_updater.h"
 #include "common/clock.h"
 #include "frontend/entities/database.h"
 #include "absl/status/status.h"
 
+ABSL_DECLARE_FLAG(int64_t, database_schema_template_cache_size);
+
 namespace google {
 namespace spanner {
 namespace emulator {
 namespace frontend {
 
 // DatabaseManager manages the set of active databases in the emulator.
+//
+// If `wal_dir` is not empty, databases are made durable in a subdirectory of
+// `wal_dir` named after their URI (see backend/database/durability.h), and
+// RecoverDurableDatabases brings them back after a restart. Databases which
+// cannot be made durable (e.g. PostgreSQL-dialect databases) are only kept in
+// memory.
 class DatabaseManager {
  public:
-  explicit DatabaseManager(Clock* clock) : clock_(clock) {}
+  explicit DatabaseManager(Clock* clock, std::string wal_dir = "")
+      : clock_(clock), wal_dir_(std::move(wal_dir)) {}
 
   // Creates a database with a schema initialized from `create_statements`.
+  //
+  // The database URI is reserved under the lock and the database is built
+  // outside of it, so that concurrent calls creating different databases run
+  // in parallel. The new database becomes visible to the other methods only
+  // once it is fully built.
+  //
+  // Databases created with the same statements share the schema built for the
+  // first of them (see backend/database/schema_template.h), so that test suites
+  // which create a database per test only build their schema once.
   absl::StatusOr<std::shared_ptr<Database>> CreateDatabase(
       const std::string& database_uri,
       const backend::SchemaChangeOperation& schema_change_operation)
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Creates a database with the schema and data of the snapshot stored at
+  // `snapshot_path` (see backend/database/snapshot.h).
+  absl::StatusOr<std::shared_ptr<Database>> RestoreDatabaseFromSnapshot(
+      const std::string& database_uri, const std::string& snapshot_path)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Creates a database which starts as a clone of the schema and data of the
+  // database `source_database_uri` (see backend::Database::Clone), sharing
+  // them until either database modifies them. Many isolated databases can
+  // thus be forked from a single fixture database at little time and memory
+  // cost.
+  absl::StatusOr<std::shared_ptr<Database>> CloneDatabase(
+      const std::string& source_database_uri, const std::string& database_uri)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Writes a snapshot of the database with the given URI to `snapshot_path`.
+  absl::Status SnapshotDatabase(const std::string& database_uri,
+                                const std::string& snapshot_path) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Exports the latest state of the database with the given URI into
+  // `export_dir` (see backend::Database::Export) and returns its timestamp.
+  absl::StatusOr<absl::Time> ExportDatabase(const std::string& database_uri,
+                                            const std::string& export_dir) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
   // Returns a database with the given URI.
   absl::StatusOr<std::shared_ptr<Database>> GetDatabase(
       const std::string& database_uri) const ABSL_LOCKS_EXCLUDED(mu_);
@@ -59,10 +112,57 @@ class DatabaseManager {
   absl::StatusOr<std::vector<std::shared_ptr<Database>>> ListDatabases(
       const std::string& instance_uri) const ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Recovers all durable databases stored in the write-ahead log directory and
+  // returns their URIs.
+  absl::StatusOr<std::vector<std::string>> RecoverDurableDatabases()
+      ABSL_LOCKS_EXCLUDED(mu_);
+
  private:
+  // Returns the directory in which the database with the given URI is made
+  // durable.
+  std::string DurableDatabaseDir(const std::string& database_uri) const;
+
+  // Returns the cached template of the schema created by
+  // `schema_change_operation`, building it if needed. Returns null if the
+  // schema cannot be shared.
+  absl::StatusOr<std::shared_ptr<const backend::SchemaTemplate>>
+  GetSchemaTemplate(
+      const backend::SchemaChangeOperation& schema_change_operation)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Reserves `database_uri` for a database which is about to be built. Fails
+  // if a database with this URI exists or is being built, or if the instance
+  // is out of database quota. The reservation counts towards the quota until
+  // it is either released or published.
+  absl::Status ReserveDatabaseUri(const std::string& database_uri)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Releases the reservation of a database which failed to build.
+  void ReleaseDatabaseUri(const std::string& database_uri)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Publishes a newly created backend database under the reserved
+  // `database_uri`, making it durable first if a write-ahead log directory is
+  // configured.
+  std::shared_ptr<Database> AddNewDatabase(
+      const std::string& database_uri,
+      std::unique_ptr<backend::Database> backend_db) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Publishes a backend database under the reserved `database_uri` along with
+  // the checkpointer of its durable state, if any.
+  std::shared_ptr<Database> AddDatabase(
+      const std::string& database_uri,
+      std::unique_ptr<backend::Database> backend_db,
+      std::unique_ptr<backend::DatabaseCheckpointer> checkpointer)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
   // System-wide clock.
   Clock* clock_;
 
+  // Directory in which databases are made durable, or empty if they are only
+  // kept in memory.
+  const std::string wal_dir_;
+
   // Mutex to guard state below.
   mutable absl::Mutex mu_;
 
@@ -70,9 +170,19 @@ class DatabaseManager {
   std::map<std::string, std::shared_ptr<Database>> database_map_
       ABSL_GUARDED_BY(mu_);
 
-  // Count of databases per instance.
+  // URIs of the databases which are being built.
+  absl::flat_hash_set<std::string> reserved_database_uris_ ABSL_GUARDED_BY(mu_);
+
+  // Count of databases per instance, including the ones being built.
   absl::flat_hash_map<std::string, int> num_databases_per_instance_
       ABSL_GUARDED_BY(mu_);
+
+  // Schemas shared by new databases, keyed by the fingerprint of the schema
+  // change operation which creates them. Null for schemas which cannot be
+  // shared.
+  absl::flat_hash_map<std::string,
+                      std::shared_ptr<const backend::SchemaTemplate>>
+      schema_templates_ ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace frontend
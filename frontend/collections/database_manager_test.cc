@@ -16,14 +16,23 @@
 
 #include "frontend/collections/database_manager.h"
 
+#include <filesystem>  // NOLINT
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/status/status.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "backend/database/export.h"
+#include "backend/database/export.pb.h"
 #include "frontend/entities/database.h"
 
 namespace google {
@@ -76,6 +85,53 @@ TEST_F(DatabaseManagerTest, CreateExistingDatabaseUriFailsWithAlreadyExists) {
       zetasql_base::testing::StatusIs(absl::StatusCode::kAlreadyExists));
 }
 
+TEST_F(DatabaseManagerTest, ConcurrentCreatesOfSameDatabaseCreateItOnce) {
+  constexpr int kNumThreads = 8;
+  std::vector<absl::Status> statuses(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([this, &statuses, i]() {
+      statuses[i] = database_manager_
+                        .CreateDatabase(database_uri_, empty_schema_operation_)
+                        .status();
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  int num_created = 0;
+  for (const absl::Status& status : statuses) {
+    if (status.ok()) {
+      ++num_created;
+    } else {
+      EXPECT_THAT(status, zetasql_base::testing::StatusIs(
+                              absl::StatusCode::kAlreadyExists));
+    }
+  }
+  EXPECT_EQ(num_created, 1);
+  ZETASQL_EXPECT_OK(database_manager_.GetDatabase(database_uri_));
+}
+
+TEST_F(DatabaseManagerTest, FailedCreateReleasesDatabaseQuota) {
+  std::string database_uri_prefix =
+      "projects/test-project/instances/test-instance/databases/test-database-";
+  backend::SchemaChangeOperation invalid_operation{
+      .statements = {"CREATE TABLE T"}};
+  for (int i = 1; i < 100; ++i) {
+    ZETASQL_ASSERT_OK(database_manager_.CreateDatabase(
+        absl::StrCat(database_uri_prefix, i), empty_schema_operation_));
+  }
+
+  // Failing to build the last database in the quota does not use it up.
+  EXPECT_THAT(database_manager_.CreateDatabase(
+                  absl::StrCat(database_uri_prefix, 100), invalid_operation),
+              zetasql_base::testing::StatusIs(
+                  absl::StatusCode::kInvalidArgument));
+  ZETASQL_EXPECT_OK(database_manager_.CreateDatabase(
+      absl::StrCat(database_uri_prefix, 100), empty_schema_operation_));
+}
+
 TEST_F(DatabaseManagerTest, GetExistingDatabase) {
   ZETASQL_ASSERT_OK_AND_ASSIGN(
       std::shared_ptr<Database> database,
@@ -168,6 +224,156 @@ TEST_F(DatabaseManagerTest, DatabaseQuotaIsEnforced) {
       absl::StrCat(database_uri_prefix, 101), empty_schema_operation_));
 }
 
+TEST_F(DatabaseManagerTest, RestoreDatabaseFromSnapshot) {
+  std::vector<std::string> create_statements = {R"(
+    CREATE TABLE T(
+      k1 INT64,
+      k2 INT64,
+    ) PRIMARY KEY(k1)
+  )"};
+  ZETASQL_ASSERT_OK(database_manager_.CreateDatabase(
+      database_uri_,
+      backend::SchemaChangeOperation{.statements = create_statements}));
+  std::string snapshot_path =
+      absl::StrCat(testing::TempDir(), "/database_manager_snapshot");
+  ZETASQL_ASSERT_OK(database_manager_.SnapshotDatabase(database_uri_, snapshot_path));
+
+  std::string restored_uri = absl::StrCat(database_uri_, "-restored");
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<Database> restored,
+      database_manager_.RestoreDatabaseFromSnapshot(restored_uri,
+                                                    snapshot_path));
+  EXPECT_EQ(restored->database_uri(), restored_uri);
+  EXPECT_NE(restored->backend()->GetLatestSchema()->FindTable("T"), nullptr);
+
+  // Restoring over an existing database fails.
+  EXPECT_THAT(
+      database_manager_.RestoreDatabaseFromSnapshot(restored_uri, snapshot_path),
+      zetasql_base::testing::StatusIs(absl::StatusCode::kAlreadyExists));
+}
+
+TEST_F(DatabaseManagerTest, ExportDatabase) {
+  ZETASQL_ASSERT_OK(database_manager_.CreateDatabase(
+      database_uri_, backend::SchemaChangeOperation{.statements = {R"(
+        CREATE TABLE T(
+          k1 INT64,
+        ) PRIMARY KEY(k1)
+      )"}}));
+  std::string export_dir =
+      absl::StrCat(testing::TempDir(), "/database_manager_export");
+  ZETASQL_ASSERT_OK(
+      database_manager_.ExportDatabase(database_uri_, export_dir).status());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(backend::ExportManifest manifest,
+                       backend::ReadExportManifest(export_dir));
+  ASSERT_EQ(manifest.tables_size(), 1);
+  EXPECT_EQ(manifest.tables(0).table_name(), "T");
+
+  EXPECT_THAT(database_manager_.ExportDatabase(
+                  absl::StrCat(database_uri_, "-missing"), export_dir),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(DatabaseManagerTest, CloneDatabase) {
+  ZETASQL_ASSERT_OK(database_manager_.CreateDatabase(
+      database_uri_, backend::SchemaChangeOperation{.statements = {R"(
+        CREATE TABLE T(
+          k1 INT64,
+        ) PRIMARY KEY(k1)
+      )"}}));
+  std::string clone_uri = absl::StrCat(database_uri_, "-clone");
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<Database> clone,
+      database_manager_.CloneDatabase(database_uri_, clone_uri));
+  EXPECT_EQ(clone->database_uri(), clone_uri);
+  EXPECT_NE(clone->backend()->GetLatestSchema()->FindTable("T"), nullptr);
+
+  EXPECT_THAT(
+      database_manager_.CloneDatabase(database_uri_, clone_uri),
+      zetasql_base::testing::StatusIs(absl::StatusCode::kAlreadyExists));
+  EXPECT_THAT(
+      database_manager_.CloneDatabase(absl::StrCat(database_uri_, "-missing"),
+                                      absl::StrCat(database_uri_, "-clone-2")),
+      zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(DatabaseManagerTest, RecoversDurableDatabases) {
+  std::string wal_dir =
+      absl::StrCat(testing::TempDir(), "/database_manager_wal");
+  std::filesystem::remove_all(wal_dir);
+  std::string deleted_uri = absl::StrCat(database_uri_, "-deleted");
+  {
+    DatabaseManager durable_manager(&clock_, wal_dir);
+    ZETASQL_ASSERT_OK(durable_manager.CreateDatabase(
+        database_uri_, backend::SchemaChangeOperation{.statements = {R"(
+          CREATE TABLE T(
+            k1 INT64,
+          ) PRIMARY KEY(k1)
+        )"}}));
+    ZETASQL_ASSERT_OK(
+        durable_manager.CreateDatabase(deleted_uri, empty_schema_operation_));
+    ZETASQL_ASSERT_OK(durable_manager.DeleteDatabase(deleted_uri));
+  }
+
+  DatabaseManager recovered_manager(&clock_, wal_dir);
+  EXPECT_THAT(recovered_manager.RecoverDurableDatabases(),
+              zetasql_base::testing::IsOkAndHolds(
+                  testing::ElementsAre(database_uri_)));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Database> recovered,
+                       recovered_manager.GetDatabase(database_uri_));
+  EXPECT_NE(recovered->backend()->GetLatestSchema()->FindTable("T"), nullptr);
+  EXPECT_THAT(recovered_manager.GetDatabase(deleted_uri),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(DatabaseManagerTest, DatabasesWithSameStatementsShareSchema) {
+  std::vector<std::string> statements = {
+      "CREATE TABLE T (K INT64) PRIMARY KEY (K)"};
+  backend::SchemaChangeOperation operation{.statements = statements};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Database> first,
+                       database_manager_.CreateDatabase(
+                           absl::StrCat(database_uri_, "-1"), operation));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Database> second,
+                       database_manager_.CreateDatabase(
+                           absl::StrCat(database_uri_, "-2"), operation));
+  EXPECT_EQ(first->backend()->GetLatestSchema(),
+            second->backend()->GetLatestSchema());
+
+  // The shared schema outlives the database it was first used by.
+  ZETASQL_ASSERT_OK(
+      database_manager_.DeleteDatabase(absl::StrCat(database_uri_, "-1")));
+  first.reset();
+  EXPECT_NE(second->backend()->GetLatestSchema()->FindTable("T"), nullptr);
+}
+
+TEST_F(DatabaseManagerTest, DatabasesDoNotShareSchemaWhenDisabled) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_database_schema_template_cache_size, 0);
+  std::vector<std::string> statements = {
+      "CREATE TABLE T (K INT64) PRIMARY KEY (K)"};
+  backend::SchemaChangeOperation operation{.statements = statements};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Database> first,
+                       database_manager_.CreateDatabase(
+                           absl::StrCat(database_uri_, "-1"), operation));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Database> second,
+                       database_manager_.CreateDatabase(
+                           absl::StrCat(database_uri_, "-2"), operation));
+  EXPECT_NE(first->backend()->GetLatestSchema(),
+            second->backend()->GetLatestSchema());
+}
+
+TEST_F(DatabaseManagerTest, CreateDatabaseWithInvalidStatementsAlwaysFails) {
+  std::vector<std::string> statements = {"CREATE TABLE T"};
+  backend::SchemaChangeOperation operation{.statements = statements};
+  EXPECT_THAT(
+      database_manager_.CreateDatabase(database_uri_, operation),
+      zetasql_base::testing::StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(
+      database_manager_.CreateDatabase(database_uri_, operation),
+      zetasql_base::testing::StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(database_manager_.GetDatabase(database_uri_),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+}
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
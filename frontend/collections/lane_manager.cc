@@ -0,0 +1,118 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "frontend/collections/lane_manager.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "common/errors.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+LaneManager::Slot::Slot(Slot&& other)
+    : manager_(other.manager_),
+      lane_(other.lane_),
+      database_uri_(std::move(other.database_uri_)) {
+  other.manager_ = nullptr;
+  other.lane_ = nullptr;
+}
+
+LaneManager::Slot::~Slot() {
+  if (manager_ != nullptr) {
+    manager_->Release(database_uri_, lane_);
+  }
+}
+
+absl::StatusOr<LaneManager::Slot> LaneManager::Admit(
+    const std::string& database_uri) {
+  if (!enabled()) {
+    return Slot();
+  }
+  Lane* lane;
+  {
+    absl::MutexLock lock(&mu_);
+    std::unique_ptr<Lane>& entry = lanes_[database_uri];
+    if (entry == nullptr) {
+      entry = std::make_unique<Lane>();
+    }
+    lane = entry.get();
+    ++lane->users;
+  }
+
+  bool queue_full = false;
+  {
+    absl::MutexLock lock(&lane->mu);
+    if (lane->active_requests >= max_active_requests_) {
+      if (max_queued_requests_ > 0 &&
+          lane->queued_requests >= max_queued_requests_) {
+        queue_full = true;
+      } else {
+        ++lane->queued_requests;
+        while (lane->active_requests >= max_active_requests_) {
+          lane->request_done.Wait(&lane->mu);
+        }
+        --lane->queued_requests;
+      }
+    }
+    if (!queue_full) {
+      ++lane->active_requests;
+    }
+  }
+  if (queue_full) {
+    Unref(database_uri, lane);
+    return error::TooManyQueuedRequests(database_uri, max_queued_requests_);
+  }
+  return Slot(this, lane, database_uri);
+}
+
+int LaneManager::QueuedRequests(const std::string& database_uri) {
+  absl::MutexLock lock(&mu_);
+  auto it = lanes_.find(database_uri);
+  if (it == lanes_.end()) {
+    return 0;
+  }
+  absl::MutexLock lane_lock(&it->second->mu);
+  return it->second->queued_requests;
+}
+
+void LaneManager::Release(const std::string& database_uri, Lane* lane) {
+  {
+    absl::MutexLock lock(&lane->mu);
+    --lane->active_requests;
+    lane->request_done.Signal();
+  }
+  Unref(database_uri, lane);
+}
+
+void LaneManager::Unref(const std::string& database_uri, Lane* lane) {
+  absl::MutexLock lock(&mu_);
+  if (--lane->users == 0) {
+    lanes_.erase(database_uri);
+  }
+}
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
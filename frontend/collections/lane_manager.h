@@ -0,0 +1,133 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_COLLECTIONS_LANE_MANAGER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_COLLECTIONS_LANE_MANAGER_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// LaneManager isolates the requests of different databases from each other.
+//
+// Each database gets an execution lane which admits at most
+// `max_active_requests` requests at a time. Further requests for the database
+// wait for a request of the same database to finish, so that a database under
+// heavy load (e.g. a large backfill) occupies a bounded share of the server's
+// threads and leaves the rest to other databases. At most
+// `max_queued_requests` requests wait per database; requests beyond that fail
+// with RESOURCE_EXHAUSTED instead of tying up more threads.
+//
+// A `max_active_requests` of 0 disables lanes, and a `max_queued_requests` of
+// 0 lets any number of requests wait. Lanes only exist while a request of
+// their database is active or waiting.
+class LaneManager {
+ private:
+  struct Lane;
+
+ public:
+  // A request's admission into its database's lane, held for the duration of
+  // the request. The request leaves the lane when the slot is destroyed.
+  class Slot {
+   public:
+    // An empty slot, for requests which are not admitted into any lane.
+    Slot() = default;
+    Slot(Slot&& other);
+    Slot& operator=(Slot&& other) = delete;
+    ~Slot();
+
+   private:
+    friend class LaneManager;
+    Slot(LaneManager* manager, Lane* lane, std::string database_uri)
+        : manager_(manager),
+          lane_(lane),
+          database_uri_(std::move(database_uri)) {}
+
+    LaneManager* manager_ = nullptr;
+    Lane* lane_ = nullptr;
+    std::string database_uri_;
+  };
+
+  explicit LaneManager(int max_active_requests = 0,
+                       int max_queued_requests = 0)
+      : max_active_requests_(max_active_requests),
+        max_queued_requests_(max_queued_requests) {}
+
+  // Returns true if requests are admitted into per-database lanes.
+  bool enabled() const { return max_active_requests_ > 0; }
+
+  // Admits a request for the database with the given URI into the database's
+  // lane, blocking while the lane is full. Returns an empty slot if lanes are
+  // disabled, or an error if too many requests are waiting for the lane:
+  //   TooManyQueuedRequests if the lane's queue is full.
+  absl::StatusOr<Slot> Admit(const std::string& database_uri);
+
+  // Returns the number of requests waiting for the lane of the database with
+  // the given URI.
+  int QueuedRequests(const std::string& database_uri);
+
+ private:
+  struct Lane {
+    // Mutex to guard state below.
+    absl::Mutex mu;
+
+    // Signalled when a request leaves the lane.
+    absl::CondVar request_done;
+
+    // Number of requests admitted into the lane.
+    int active_requests ABSL_GUARDED_BY(mu) = 0;
+
+    // Number of requests waiting to be admitted into the lane.
+    int queued_requests ABSL_GUARDED_BY(mu) = 0;
+
+    // Number of slots and waiting requests which refer to the lane. Guarded
+    // by the manager's mu_.
+    int users = 0;
+  };
+
+  // Releases the lane of `database_uri`, dropping it once it is not used.
+  void Release(const std::string& database_uri, Lane* lane);
+
+  // Drops a reference to the lane of `database_uri`.
+  void Unref(const std::string& database_uri, Lane* lane);
+
+  const int max_active_requests_;
+  const int max_queued_requests_;
+
+  // Mutex to guard state below.
+  absl::Mutex mu_;
+
+  // Map from database URI to the database's lane.
+  absl::flat_hash_map<std::string, std::unique_ptr<Lane>> lanes_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_COLLECTIONS_LANE_MANAGER_H_
@@ -0,0 +1,119 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "frontend/collections/lane_manager.h"
+
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+namespace {
+
+using ::zetasql_base::testing::StatusIs;
+
+constexpr char kDatabaseUri[] = "projects/p/instances/i/databases/d";
+constexpr char kOtherDatabaseUri[] = "projects/p/instances/i/databases/e";
+
+// Waits until `count` requests wait for the lane of `database_uri`.
+void WaitForQueuedRequests(LaneManager* lanes, const std::string& database_uri,
+                           int count) {
+  while (lanes->QueuedRequests(database_uri) < count) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+}
+
+TEST(LaneManagerTest, AdmitsAllRequestsWhenDisabled) {
+  LaneManager lanes;
+  EXPECT_FALSE(lanes.enabled());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LaneManager::Slot first, lanes.Admit(kDatabaseUri));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LaneManager::Slot second, lanes.Admit(kDatabaseUri));
+}
+
+TEST(LaneManagerTest, QueuesRequestsBeyondTheLimit) {
+  LaneManager lanes(/*max_active_requests=*/1);
+  std::optional<absl::StatusOr<LaneManager::Slot>> first =
+      lanes.Admit(kDatabaseUri);
+  ZETASQL_ASSERT_OK(*first);
+
+  absl::Notification admitted;
+  std::thread waiter([&] {
+    absl::StatusOr<LaneManager::Slot> second = lanes.Admit(kDatabaseUri);
+    ZETASQL_EXPECT_OK(second);
+    admitted.Notify();
+  });
+  WaitForQueuedRequests(&lanes, kDatabaseUri, 1);
+  EXPECT_FALSE(admitted.HasBeenNotified());
+
+  first.reset();
+  admitted.WaitForNotification();
+  waiter.join();
+  EXPECT_EQ(lanes.QueuedRequests(kDatabaseUri), 0);
+}
+
+TEST(LaneManagerTest, DoesNotQueueRequestsOfOtherDatabases) {
+  LaneManager lanes(/*max_active_requests=*/1);
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LaneManager::Slot first, lanes.Admit(kDatabaseUri));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LaneManager::Slot other,
+                       lanes.Admit(kOtherDatabaseUri));
+}
+
+TEST(LaneManagerTest, RejectsRequestsWhenTheQueueIsFull) {
+  LaneManager lanes(/*max_active_requests=*/1, /*max_queued_requests=*/1);
+  std::optional<absl::StatusOr<LaneManager::Slot>> first =
+      lanes.Admit(kDatabaseUri);
+  ZETASQL_ASSERT_OK(*first);
+
+  std::thread waiter([&] { ZETASQL_EXPECT_OK(lanes.Admit(kDatabaseUri)); });
+  WaitForQueuedRequests(&lanes, kDatabaseUri, 1);
+  EXPECT_THAT(lanes.Admit(kDatabaseUri),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+
+  first.reset();
+  waiter.join();
+}
+
+TEST(LaneManagerTest, MovedSlotsLeaveTheLaneOnce) {
+  LaneManager lanes(/*max_active_requests=*/2);
+  {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(LaneManager::Slot slot, lanes.Admit(kDatabaseUri));
+    LaneManager::Slot moved(std::move(slot));
+  }
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LaneManager::Slot first, lanes.Admit(kDatabaseUri));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(LaneManager::Slot second, lanes.Admit(kDatabaseUri));
+}
+
+}  // namespace
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -16,15 +16,21 @@
 
 #include "frontend/collections/operation_manager.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "common/config.h"
 #include "common/errors.h"
 #include "frontend/common/uris.h"
 
@@ -35,6 +41,61 @@ namespace frontend {
 
 const char OperationManager::kAutoGeneratedId[] = "";
 
+OperationManager::~OperationManager() {
+  {
+    absl::MutexLock lock(&executor_mu_);
+    executor_mu_.Await(
+        absl::Condition(this, &OperationManager::BackgroundQueuesEmpty));
+  }
+  JoinFinishedThreads();
+}
+
+void OperationManager::RunInBackground(const std::string& resource_uri,
+                                       std::function<void()> work) {
+  JoinFinishedThreads();
+  absl::MutexLock lock(&executor_mu_);
+  auto [itr, inserted] = background_queues_.try_emplace(resource_uri);
+  itr->second.work.push_back(std::move(work));
+  if (inserted) {
+    itr->second.thread = std::thread(
+        [this, resource_uri]() { RunBackgroundWork(resource_uri); });
+  }
+}
+
+bool OperationManager::BackgroundQueuesEmpty() const {
+  return background_queues_.empty();
+}
+
+void OperationManager::JoinFinishedThreads() {
+  std::vector<std::thread> finished_threads;
+  {
+    absl::MutexLock lock(&executor_mu_);
+    finished_threads.swap(finished_threads_);
+  }
+  for (std::thread& thread : finished_threads) {
+    thread.join();
+  }
+}
+
+void OperationManager::RunBackgroundWork(const std::string& resource_uri) {
+  while (true) {
+    std::function<void()> work;
+    {
+      absl::MutexLock lock(&executor_mu_);
+      auto itr = background_queues_.find(resource_uri);
+      if (itr->second.work.empty()) {
+        // The thread only exits, so it can be joined by whoever takes it.
+        finished_threads_.push_back(std::move(itr->second.thread));
+        background_queues_.erase(itr);
+        return;
+      }
+      work = std::move(itr->second.work.front());
+      itr->second.work.pop_front();
+    }
+    work();
+  }
+}
+
 absl::StatusOr<std::shared_ptr<Operation>> OperationManager::CreateOperation(
     const std::string& resource_uri, const std::string& operation_id) {
   absl::MutexLock lock(&mu_);
@@ -54,11 +115,30 @@ absl::StatusOr<std::shared_ptr<Operation>> OperationManager::CreateOperation(
   // Finally, create the operation.
   std::shared_ptr<Operation> operation =
       std::make_shared<Operation>(operation_uri);
-  operations_map_[operation_uri] = operation;
+  int64_t creation_index = next_creation_index_++;
+  operations_map_[operation_uri] = Entry{operation, creation_index};
+  operations_by_creation_[creation_index] = operation_uri;
+  EvictCompletedOperations();
 
   return operation;
 }
 
+void OperationManager::EvictCompletedOperations() {
+  const int64_t max_operations = config::max_retained_operations();
+  if (max_operations <= 0) return;
+  auto itr = operations_by_creation_.begin();
+  while (static_cast<int64_t>(operations_map_.size()) > max_operations &&
+         itr != operations_by_creation_.end()) {
+    auto operation = operations_map_.find(itr->second);
+    if (!operation->second.operation->done()) {
+      ++itr;
+      continue;
+    }
+    operations_map_.erase(operation);
+    itr = operations_by_creation_.erase(itr);
+  }
+}
+
 absl::StatusOr<std::shared_ptr<Operation>> OperationManager::GetOperation(
     const std::string& operation_uri) {
   absl::MutexLock lock(&mu_);
@@ -67,13 +147,17 @@ absl::StatusOr<std::shared_ptr<Operation>> OperationManager::GetOperation(
   if (itr == operations_map_.end()) {
     return error::OperationNotFound(operation_uri);
   }
-  return itr->second;
+  return itr->second.operation;
 }
 
 absl::Status OperationManager::DeleteOperation(
     const std::string& operation_uri) {
   absl::MutexLock lock(&mu_);
-  operations_map_.erase(operation_uri);
+  auto itr = operations_map_.find(operation_uri);
+  if (itr != operations_map_.end()) {
+    operations_by_creation_.erase(itr->second.creation_index);
+    operations_map_.erase(itr);
+  }
   return absl::OkStatus();
 }
 
@@ -86,13 +170,32 @@ OperationManager::ListOperations(const std::string& resource_uri) {
     if (!absl::StartsWith(itr->first, resource_uri)) {
       break;
     }
-    operations.push_back(itr->second);
+    operations.push_back(itr->second.operation);
     ++itr;
   }
 
   return operations;
 }
 
+std::vector<std::shared_ptr<Operation>> OperationManager::ListOperations(
+    const std::string& resource_uri, const std::string& page_token,
+    int32_t page_size, std::string* next_page_token) {
+  absl::MutexLock lock(&mu_);
+  next_page_token->clear();
+  std::vector<std::shared_ptr<Operation>> operations;
+  auto itr = operations_map_.lower_bound(std::max(resource_uri, page_token));
+  for (; itr != operations_map_.end() &&
+         absl::StartsWith(itr->first, resource_uri);
+       ++itr) {
+    if (static_cast<int32_t>(operations.size()) >= page_size) {
+      *next_page_token = itr->first;
+      break;
+    }
+    operations.push_back(itr->second.operation);
+  }
+  return operations;
+}
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
@@ -17,9 +17,14 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_COLLECTIONS_OPERATION_MANAGER_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_COLLECTIONS_OPERATION_MANAGER_H_
 
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
@@ -35,9 +40,9 @@ namespace frontend {
 
 // OperationManager manages the set of long running operations in the emulator.
 //
-// The emulator does not actually have long running operations - all operations
-// complete immediately. However, these operations are still recorded and are
-// accessible via the longrunning operations api.
+// Most operations in the emulator complete immediately. However, these
+// operations are still recorded and are accessible via the longrunning
+// operations api.
 //
 // Cloud Spanner currently has the following long running operations:
 // - Create an instance
@@ -45,12 +50,18 @@ namespace frontend {
 // - Create a database
 // - Update a database
 //
-// The emulator implementation of these operations executes the operation
-// synchronously, but returns an incomplete operation response. The completed
-// operation is registered with this OperationManager. This ensures that
-// applications developed against the emulator don't assume that the operations
-// finish immediately and have to query the operations api to get the status of
-// the operation.
+// The emulator implementation of most of these operations executes the
+// operation synchronously and registers the completed operation with this
+// OperationManager. Operations that can take a long time (schema changes and
+// their backfills) are instead run on one of the manager's background queues
+// (see RunInBackground) and the handler returns the still-running operation. In
+// both cases applications developed against the emulator can't assume that the
+// operations finish immediately and have to query the operations api to get
+// the status of the operation.
+//
+// Operations are retained until they are deleted, except that once more than
+// config::max_retained_operations() operations are registered, the oldest
+// completed ones are evicted as new ones are created.
 //
 // The interface below does not implement the Cancel and Wait operations. Cancel
 // returns success at the handler level as there is nothing to cancel. Wait is
@@ -63,6 +74,21 @@ class OperationManager {
   // A constant indicating that the operation id should be auto generated.
   static const char kAutoGeneratedId[];
 
+  OperationManager() = default;
+
+  // Waits for all work scheduled with RunInBackground to finish.
+  ~OperationManager();
+
+  // Schedules `work` to run in the background on the queue of `resource_uri`
+  // (e.g. a database URI). Work items of a resource run one at a time in the
+  // order they were scheduled, so long-running operations (like schema
+  // changes) apply in request order without blocking the caller. Queues of
+  // different resources run concurrently, each on its own thread, so a long
+  // backfill of one database does not hold up schema changes of the others.
+  void RunInBackground(const std::string& resource_uri,
+                       std::function<void()> work)
+      ABSL_LOCKS_EXCLUDED(executor_mu_);
+
   // Creates an operation. Some operations (like update database) allow the
   // user to specify the operation id. If the user specifies an operation id,
   // it is used as-is, otherwise a system generated operation id is used.
@@ -85,16 +111,76 @@ class OperationManager {
   absl::StatusOr<std::vector<std::shared_ptr<Operation>>> ListOperations(
       const std::string& resource_uri) ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Lists up to `page_size` of the operations whose URI starts with
+  // `resource_uri`, in URI order, starting at the first one whose URI is not
+  // less than `page_token`. If more operations follow, `next_page_token` is set
+  // to the URI of the next one, and otherwise it is cleared. Only the returned
+  // page is visited.
+  std::vector<std::shared_ptr<Operation>> ListOperations(
+      const std::string& resource_uri, const std::string& page_token,
+      int32_t page_size, std::string* next_page_token)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
  private:
+  // A registered operation.
+  struct Entry {
+    std::shared_ptr<Operation> operation;
+    // Key of the operation in `operations_by_creation_`.
+    int64_t creation_index;
+  };
+
+  // Evicts the oldest completed operations while more than
+  // config::max_retained_operations() operations are registered.
+  void EvictCompletedOperations() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Mutex to guard state below.
   absl::Mutex mu_;
 
   // Counter for the system assigned operation id.
   int next_operation_id_ ABSL_GUARDED_BY(mu_) = 0;
 
-  // Map from operation URI to actual operation.
-  std::map<std::string, std::shared_ptr<Operation>> operations_map_
-      ABSL_GUARDED_BY(mu_);
+  // Map from operation URI to actual operation. Operations of a resource are
+  // contiguous, since their URIs start with the resource URI.
+  std::map<std::string, Entry> operations_map_ ABSL_GUARDED_BY(mu_);
+
+  // URIs of the operations in `operations_map_` by creation order, oldest
+  // first, for eviction.
+  std::map<int64_t, std::string> operations_by_creation_ ABSL_GUARDED_BY(mu_);
+
+  // Creation index of the next operation.
+  int64_t next_creation_index_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // The background work of a resource.
+  struct BackgroundQueue {
+    // Work scheduled with RunInBackground that has not started yet.
+    std::deque<std::function<void()>> work;
+    // The thread which runs the work of the queue.
+    std::thread thread;
+  };
+
+  // Runs the work of the queue of `resource_uri` until the queue is empty,
+  // then removes the queue.
+  void RunBackgroundWork(const std::string& resource_uri)
+      ABSL_LOCKS_EXCLUDED(executor_mu_);
+
+  // Joins the threads of removed queues.
+  void JoinFinishedThreads() ABSL_LOCKS_EXCLUDED(executor_mu_);
+
+  // Returns true if no background work is scheduled or running.
+  bool BackgroundQueuesEmpty() const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(executor_mu_);
+
+  // Mutex to guard the background queues below. Kept separate from `mu_` so
+  // that operation lookups never wait behind scheduling.
+  absl::Mutex executor_mu_;
+
+  // Queues by resource URI. A queue exists while its thread has work to run,
+  // and is created by the first call to RunInBackground after that.
+  std::map<std::string, BackgroundQueue> background_queues_
+      ABSL_GUARDED_BY(executor_mu_);
+
+  // Threads of removed queues which have not been joined yet.
+  std::vector<std::thread> finished_threads_ ABSL_GUARDED_BY(executor_mu_);
 };
 
 }  // namespace frontend
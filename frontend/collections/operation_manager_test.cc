@@ -16,13 +16,20 @@
 
 #include "frontend/collections/operation_manager.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/flags/reflection.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "common/config.h"
 #include "frontend/entities/operation.h"
 
 namespace google {
@@ -138,6 +145,132 @@ TEST_F(OperationManagerTest, ListsOperationsWithSimilarInstanceURI) {
             operation_pb.name());
 }
 
+TEST_F(OperationManagerTest, ListsOperationsInPages) {
+  std::string instance_uri = "projects/test-project/instances/test-instance";
+  for (int i = 0; i < 5; ++i) {
+    ZETASQL_ASSERT_OK(manager()->CreateOperation(instance_uri, absl::StrCat(i)));
+  }
+  ZETASQL_ASSERT_OK(manager()->CreateOperation(
+      "projects/test-project/instances/test-instance-b", "0"));
+
+  std::string operations_uri = absl::StrCat(instance_uri, "/operations");
+  std::vector<std::string> names;
+  std::string page_token;
+  int num_pages = 0;
+  do {
+    std::string next_page_token;
+    for (const auto& operation : manager()->ListOperations(
+             operations_uri, page_token, /*page_size=*/2, &next_page_token)) {
+      google::longrunning::Operation operation_pb;
+      operation->ToProto(&operation_pb);
+      names.push_back(operation_pb.name());
+    }
+    page_token = next_page_token;
+    ++num_pages;
+  } while (!page_token.empty());
+
+  EXPECT_EQ(num_pages, 3);
+  EXPECT_THAT(names, testing::ElementsAre(
+                         absl::StrCat(operations_uri, "/0"),
+                         absl::StrCat(operations_uri, "/1"),
+                         absl::StrCat(operations_uri, "/2"),
+                         absl::StrCat(operations_uri, "/3"),
+                         absl::StrCat(operations_uri, "/4")));
+}
+
+TEST_F(OperationManagerTest, EvictsOldestCompletedOperations) {
+  absl::FlagSaver flag_saver;
+  config::set_max_retained_operations(2);
+  std::string instance_uri = "projects/123/instances/456";
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Operation> running,
+                       manager()->CreateOperation(instance_uri, "0"));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Operation> completed,
+                       manager()->CreateOperation(instance_uri, "1"));
+  completed->SetResponse(google::longrunning::Operation());
+  ZETASQL_ASSERT_OK(manager()->CreateOperation(instance_uri, "2"));
+
+  // The running operation is older, but only completed ones are evicted.
+  ZETASQL_EXPECT_OK(
+      manager()->GetOperation(absl::StrCat(instance_uri, "/operations/0")));
+  EXPECT_THAT(
+      manager()->GetOperation(absl::StrCat(instance_uri, "/operations/1")),
+      zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+  ZETASQL_EXPECT_OK(
+      manager()->GetOperation(absl::StrCat(instance_uri, "/operations/2")));
+
+  // Nothing is evicted while every operation is running.
+  ZETASQL_ASSERT_OK(manager()->CreateOperation(instance_uri, "3"));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<std::shared_ptr<Operation>> operations,
+                       manager()->ListOperations(instance_uri));
+  EXPECT_EQ(operations.size(), 3);
+}
+
+TEST(OperationManagerBackgroundTest, RunsBackgroundWorkInScheduledOrder) {
+  std::vector<int> order;
+  {
+    OperationManager manager;
+    for (int i = 0; i < 5; ++i) {
+      manager.RunInBackground("projects/p/instances/i/databases/d",
+                              [&order, i]() { order.push_back(i); });
+    }
+    // Destroying the manager waits for all scheduled work to finish.
+  }
+  EXPECT_THAT(order, testing::ElementsAre(0, 1, 2, 3, 4));
+}
+
+TEST(OperationManagerBackgroundTest, QueuesOfResourcesRunConcurrently) {
+  absl::Notification release;
+  absl::Notification other_database_ran;
+  std::vector<int> order;
+  {
+    OperationManager manager;
+    manager.RunInBackground("projects/p/instances/i/databases/d1",
+                            [&release, &order]() {
+                              release.WaitForNotification();
+                              order.push_back(0);
+                            });
+    manager.RunInBackground("projects/p/instances/i/databases/d1",
+                            [&order]() { order.push_back(1); });
+    manager.RunInBackground(
+        "projects/p/instances/i/databases/d2",
+        [&other_database_ran]() { other_database_ran.Notify(); });
+
+    // The work of d2 does not wait behind the blocked work of d1.
+    EXPECT_TRUE(
+        other_database_ran.WaitForNotificationWithTimeout(absl::Seconds(30)));
+    release.Notify();
+  }
+  EXPECT_THAT(order, testing::ElementsAre(0, 1));
+}
+
+TEST(OperationManagerBackgroundTest, BackgroundWorkDoesNotBlockLookups) {
+  absl::Notification release;
+  // Declared after `release` so that it is destroyed (and waits for the
+  // background work) first.
+  OperationManager manager;
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<Operation> operation,
+      manager.CreateOperation("projects/123/instances/456", "789"));
+  manager.RunInBackground("projects/123/instances/456",
+                          [&release, operation]() {
+                            release.WaitForNotification();
+                            operation->SetResponse(
+                                google::longrunning::Operation());
+                          });
+
+  // The operation can be polled while its work is still running.
+  absl::StatusOr<std::shared_ptr<Operation>> polled =
+      manager.GetOperation("projects/123/instances/456/operations/789");
+  google::longrunning::Operation operation_pb;
+  if (polled.ok()) {
+    (*polled)->ToProto(&operation_pb);
+  }
+  release.Notify();
+
+  ZETASQL_ASSERT_OK(polled);
+  EXPECT_FALSE(operation_pb.done());
+}
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
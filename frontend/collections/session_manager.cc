@@ -16,11 +16,13 @@
 
 #include "frontend/collections/session_manager.h"
 
-#include <map>
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -36,57 +38,101 @@ namespace spanner {
 namespace emulator {
 namespace frontend {
 
+namespace {
+
+// Sessions that have not been used for this long are deleted.
+constexpr absl::Duration kSessionExpirationTime = absl::Hours(1);
+
+}  // namespace
+
+SessionManager::Shard& SessionManager::ShardFor(
+    const std::string& session_uri) {
+  return shards_[absl::Hash<std::string>()(session_uri) % kNumShards];
+}
+
+void SessionManager::ExpireSessions(Shard& shard, absl::Time now) {
+  while (!shard.expiry_queue.empty() &&
+         now - shard.expiry_queue.front().last_use_time >
+             kSessionExpirationTime) {
+    ExpiryEntry entry = std::move(shard.expiry_queue.front());
+    shard.expiry_queue.pop_front();
+    auto itr = shard.session_map.find(entry.session_uri);
+    if (itr == shard.session_map.end()) {
+      // Already deleted.
+      continue;
+    }
+    absl::Time last_use_time = itr->second->approximate_last_use_time();
+    if (now - last_use_time > kSessionExpirationTime) {
+      shard.session_map.erase(itr);
+    } else {
+      entry.last_use_time = last_use_time;
+      shard.expiry_queue.push_back(std::move(entry));
+    }
+  }
+}
+
 absl::StatusOr<std::shared_ptr<Session>> SessionManager::CreateSession(
     const Labels& labels, std::shared_ptr<Database> database) {
-  absl::MutexLock lock(&mu_);
   const std::string session_id = absl::StrCat(next_session_id_++);
   std::string session_uri =
       MakeSessionUri(database->database_uri(), session_id);
-  std::shared_ptr<Session> session =
-      std::make_shared<Session>(session_uri, labels,
-                                /* create_time = */ clock_->Now(), database);
-  session->set_approximate_last_use_time(clock_->Now());
+  const absl::Time now = clock_->Now();
+  std::shared_ptr<Session> session = std::make_shared<Session>(
+      session_uri, labels, /* create_time = */ now, database);
+  session->set_approximate_last_use_time(now);
 
-  session_map_[session_uri] = session;
+  Shard& shard = ShardFor(session_uri);
+  absl::MutexLock lock(&shard.mu);
+  ExpireSessions(shard, now);
+  shard.expiry_queue.push_back({now, session_uri});
+  shard.session_map[std::move(session_uri)] = session;
   return session;
 }
 
 absl::StatusOr<std::shared_ptr<Session>> SessionManager::GetSession(
     const std::string& session_uri) {
-  absl::MutexLock lock(&mu_);
-  auto itr = session_map_.find(session_uri);
-  if (itr == session_map_.end()) {
+  Shard& shard = ShardFor(session_uri);
+  const absl::Time now = clock_->Now();
+  absl::MutexLock lock(&shard.mu);
+  ExpireSessions(shard, now);
+  auto itr = shard.session_map.find(session_uri);
+  if (itr == shard.session_map.end()) {
     return error::SessionNotFound(session_uri);
   }
   std::shared_ptr<Session> session = itr->second;
-  if (clock_->Now() - session->approximate_last_use_time() > absl::Hours(1)) {
+  if (now - session->approximate_last_use_time() > kSessionExpirationTime) {
     // Delete inactive sessions after 1 hour.
-    session_map_.erase(session_uri);
+    shard.session_map.erase(itr);
     return error::SessionNotFound(session_uri);
   }
-  session->set_approximate_last_use_time(clock_->Now());
+  session->set_approximate_last_use_time(now);
   return session;
 }
 
 absl::StatusOr<std::vector<std::shared_ptr<Session>>>
 SessionManager::ListSessions(const std::string& database_uri) const {
-  absl::MutexLock lock(&mu_);
   std::string session_uri_prefix = absl::StrCat(database_uri, "/");
   std::vector<std::shared_ptr<Session>> sessions;
-  for (auto itr = session_map_.lower_bound(session_uri_prefix);
-       itr != session_map_.end(); ++itr) {
-    if (absl::StartsWith(itr->first, session_uri_prefix)) {
-      sessions.push_back(itr->second);
-    } else {
-      return sessions;
+  for (const Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mu);
+    for (const auto& [session_uri, session] : shard.session_map) {
+      if (absl::StartsWith(session_uri, session_uri_prefix)) {
+        sessions.push_back(session);
+      }
     }
   }
+  std::sort(sessions.begin(), sessions.end(),
+            [](const std::shared_ptr<Session>& a,
+               const std::shared_ptr<Session>& b) {
+              return a->session_uri() < b->session_uri();
+            });
   return sessions;
 }
 
 absl::Status SessionManager::DeleteSession(const std::string& session_uri) {
-  absl::MutexLock lock(&mu_);
-  session_map_.erase(session_uri);
+  Shard& shard = ShardFor(session_uri);
+  absl::MutexLock lock(&shard.mu);
+  shard.session_map.erase(session_uri);
   return absl::OkStatus();
 }
 
@@ -17,13 +17,23 @@
 #ifndef STORAGE_CLOUD_SPANNER_EMULATOR_FRONTEND_SESSION_MANAGER_H_
 #define STORAGE_CLOUD_SPANNER_EMULATOR_FRONTEND_SESSION_MANAGER_H_
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "common/clock.h"
 #include "frontend/entities/database.h"
 #include "frontend/entities/session.h"
-#include "absl/status/status.h"
 
 namespace google {
 namespace spanner {
@@ -31,40 +41,70 @@ namespace emulator {
 namespace frontend {
 
 // Session manager manages the set of active sessions in the emulator.
+//
+// Sessions are spread over a fixed number of shards by session URI, each with
+// its own lock, so that concurrent RPCs on different sessions do not contend.
 class SessionManager {
  public:
   explicit SessionManager(Clock* clock) : clock_(clock) {}
 
   // Creates a session attached to the given database.
   absl::StatusOr<std::shared_ptr<Session>> CreateSession(
-      const Labels& labels, std::shared_ptr<Database> database)
-      ABSL_LOCKS_EXCLUDED(mu_);
+      const Labels& labels, std::shared_ptr<Database> database);
 
   // Returns a session with the given URI.
   absl::StatusOr<std::shared_ptr<Session>> GetSession(
-      const std::string& session_uri) ABSL_LOCKS_EXCLUDED(mu_);
+      const std::string& session_uri);
 
   // Deletes a session with the given URI.
-  absl::Status DeleteSession(const std::string& session_uri)
-      ABSL_LOCKS_EXCLUDED(mu_);
+  absl::Status DeleteSession(const std::string& session_uri);
 
-  // Lists sessions attached to the given database URI.
+  // Lists sessions attached to the given database URI, sorted by session URI.
   absl::StatusOr<std::vector<std::shared_ptr<Session>>> ListSessions(
-      const std::string& database_uri) const ABSL_LOCKS_EXCLUDED(mu_);
+      const std::string& database_uri) const;
 
  private:
+  // Number of shards that sessions are spread over.
+  static constexpr int kNumShards = 16;
+
+  // A session URI and its approximate last use time when it was queued for
+  // expiry.
+  struct ExpiryEntry {
+    absl::Time last_use_time;
+    std::string session_uri;
+  };
+
+  struct Shard {
+    // Mutex to guard state below.
+    mutable absl::Mutex mu;
+
+    // Map from session URI to session objects.
+    absl::flat_hash_map<std::string, std::shared_ptr<Session>> session_map
+        ABSL_GUARDED_BY(mu);
+
+    // Sessions of this shard, oldest last use time first. Entries are not
+    // updated when a session is used; instead, a session that is found to be
+    // still active when its entry reaches the front is queued again with its
+    // current last use time. Entries of deleted sessions are dropped then.
+    std::deque<ExpiryEntry> expiry_queue ABSL_GUARDED_BY(mu);
+  };
+
+  // Returns the shard that holds the session with the given URI.
+  Shard& ShardFor(const std::string& session_uri);
+
+  // Deletes the sessions of `shard` that have been inactive for longer than
+  // the session expiration time. The work done is proportional to the number
+  // of expired entries at the front of the shard's expiry queue.
+  void ExpireSessions(Shard& shard, absl::Time now)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu);
+
   // System-wide clock.
   Clock* clock_;
 
-  // Mutex to guard state below.
-  mutable absl::Mutex mu_;
-
   // Counter for session ids.
-  int next_session_id_ ABSL_GUARDED_BY(mu_) = 0;
+  std::atomic<int64_t> next_session_id_ = 0;
 
-  // Map from session URI to session objects.
-  std::map<std::string, std::shared_ptr<Session>> session_map_
-      ABSL_GUARDED_BY(mu_);
+  std::array<Shard, kNumShards> shards_;
 };
 
 }  // namespace frontend
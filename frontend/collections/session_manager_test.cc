@@ -17,11 +17,15 @@
 #include "frontend/collections/session_manager.h"
 
 #include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/time/time.h"
 #include "common/clock.h"
@@ -138,6 +142,48 @@ TEST_F(SessionManagerTest, ListSessionsWithSimilarPrefix) {
   }
 }
 
+TEST_F(SessionManagerTest, ListSessionsSortedBySessionUri) {
+  int num = 50;
+  for (int i = 0; i < num; i++) {
+    ZETASQL_ASSERT_OK(session_manager_.CreateSession(test_labels_, database_));
+  }
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::shared_ptr<Session>> actual,
+      session_manager_.ListSessions(database_->database_uri()));
+  ASSERT_EQ(actual.size(), num);
+  for (int i = 1; i < num; i++) {
+    EXPECT_LT(actual[i - 1]->session_uri(), actual[i]->session_uri());
+  }
+}
+
+TEST_F(SessionManagerTest, ConcurrentCreateGetAndDeleteSessions) {
+  constexpr int kNumThreads = 16;
+  constexpr int kSessionsPerThread = 50;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([this]() {
+      for (int i = 0; i < kSessionsPerThread; ++i) {
+        absl::StatusOr<std::shared_ptr<Session>> created =
+            session_manager_.CreateSession(test_labels_, database_);
+        ZETASQL_ASSERT_OK(created);
+        const std::string session_uri = (*created)->session_uri();
+        ZETASQL_EXPECT_OK(session_manager_.GetSession(session_uri));
+        if (i % 2 == 0) {
+          ZETASQL_EXPECT_OK(session_manager_.DeleteSession(session_uri));
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::shared_ptr<Session>> actual,
+      session_manager_.ListSessions(database_->database_uri()));
+  EXPECT_EQ(actual.size(), kNumThreads * kSessionsPerThread / 2);
+}
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
@@ -16,17 +16,20 @@
 
 #include "frontend/converters/change_streams.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "google/protobuf/struct.pb.h"
 #include "google/spanner/v1/result_set.pb.h"
+#include "google/spanner/v1/type.pb.h"
 #include "zetasql/public/analyzer.h"
 #include "zetasql/public/analyzer_options.h"
+#include "zetasql/public/json_value.h"
 #include "zetasql/public/simple_catalog.h"
 #include "zetasql/public/type.h"
-#include "zetasql/public/types/array_type.h"
 #include "zetasql/public/types/type.h"
 #include "zetasql/public/types/type_factory.h"
 #include "zetasql/public/value.h"
@@ -36,6 +39,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
+#include "absl/time/time.h"
 #include "backend/access/read.h"
 #include "backend/query/analyzer_options.h"
 #include "common/constants.h"
@@ -54,13 +58,14 @@ namespace frontend {
 namespace spanner_api = ::google::spanner::v1;
 namespace {
 
+// The output type of change stream queries, precomputed once along with its
+// proto form for the result set metadata.
 struct ChangeStreamOutputTypes {
-  enum ReturningType { DATA_CHANGE, HEARTBEAT, CHILD_PARTITIONS };
   ChangeStreamOutputTypes() {
-    ConstructChangeRecordTypes();
-    ConstructChildPartitionRecordTypes();
-    ConstructHeartbeatRecordTypes();
-    ConstructDataChangeRecordTypes();
+    ABSL_CHECK_OK(zetasql::AnalyzeType(
+        absl::Substitute(kChangeStreamTvfOutputFormat, "JSON"),
+        analyzer_options, &catalog, &type_factory, &change_record_arr));
+    ABSL_CHECK_OK(TypeToProto(change_record_arr, &change_record_arr_pb));
   }
 
   zetasql::TypeFactory type_factory;
@@ -68,79 +73,9 @@ struct ChangeStreamOutputTypes {
       "For analyzing change stream output types only.");
   zetasql::AnalyzerOptions analyzer_options =
       backend::MakeGoogleSqlAnalyzerOptions();
-  // Outter most change record output related types.
+  // Outter most change record output type.
   const zetasql::Type* change_record_arr;
-  const zetasql::StructType* change_record_struct;
-  // Heartbeat record related types.
-  const zetasql::ArrayType* heartbeat_record_arr;
-  const zetasql::StructType* heartbeat_record_struct;
-  // Child partition record related types.
-  const zetasql::ArrayType* child_partitions_record_arr;
-  const zetasql::StructType* child_partitions_record_struct;
-  const zetasql::ArrayType* child_partitions_arr;
-  const zetasql::StructType* child_partitions_struct;
-  const zetasql::ArrayType* parents_arr;
-  // Data change record related types
-  const zetasql::ArrayType* data_change_record_arr;
-  const zetasql::StructType* data_change_record_struct;
-  const zetasql::ArrayType* column_types_arr;
-  const zetasql::StructType* column_types_struct;
-  const zetasql::ArrayType* mods_arr;
-  const zetasql::StructType* mods_struct;
-
-  void ConstructChangeRecordTypes() {
-    ABSL_CHECK_OK(zetasql::AnalyzeType(
-        absl::Substitute(kChangeStreamTvfOutputFormat, "JSON"),
-        analyzer_options, &catalog, &type_factory, &change_record_arr));
-    change_record_struct =
-        change_record_arr->AsArray()->element_type()->AsStruct();
-  }
-
-  void ConstructHeartbeatRecordTypes() {
-    bool is_ambiguous;
-    heartbeat_record_arr = change_record_arr->AsArray()
-                               ->element_type()
-                               ->AsStruct()
-                               ->FindField("heartbeat_record", &is_ambiguous)
-                               ->type->AsArray();
-    heartbeat_record_struct = heartbeat_record_arr->element_type()->AsStruct();
-  }
-
-  void ConstructChildPartitionRecordTypes() {
-    bool is_ambiguous;
-    child_partitions_record_arr =
-        change_record_arr->AsArray()
-            ->element_type()
-            ->AsStruct()
-            ->FindField("child_partitions_record", &is_ambiguous)
-            ->type->AsArray();
-    child_partitions_record_struct =
-        child_partitions_record_arr->element_type()->AsStruct();
-    child_partitions_arr = child_partitions_record_struct
-                               ->FindField("child_partitions", &is_ambiguous)
-                               ->type->AsArray();
-    child_partitions_struct = child_partitions_arr->element_type()->AsStruct();
-    parents_arr = zetasql::types::StringArrayType();
-  }
-
-  void ConstructDataChangeRecordTypes() {
-    bool is_ambigous;
-    data_change_record_arr = change_record_arr->AsArray()
-                                 ->element_type()
-                                 ->AsStruct()
-                                 ->FindField("data_change_record", &is_ambigous)
-                                 ->type->AsArray();
-    data_change_record_struct =
-        data_change_record_arr->AsArray()->element_type()->AsStruct();
-    column_types_arr =
-        data_change_record_struct->FindField("column_types", &is_ambigous)
-            ->type->AsArray();
-    column_types_struct =
-        column_types_arr->AsArray()->element_type()->AsStruct();
-    mods_arr = data_change_record_struct->FindField("mods", &is_ambigous)
-                   ->type->AsArray();
-    mods_struct = mods_arr->AsArray()->element_type()->AsStruct();
-  }
+  spanner_api::Type change_record_arr_pb;
 };
 
 // Singleton static struct that contains all the fixed record types.
@@ -150,103 +85,106 @@ const ChangeStreamOutputTypes* GetChangeStreamOutputTypes() {
   return kChangeStreamOutputTypes.get();
 }
 
+// Position of each record type in the change record STRUCT.
+enum class ChangeRecordField { kDataChange, kHeartbeat, kChildPartitions };
+
 std::string ToFragmentIdString(int64_t record_sequence) {
   return absl::StrFormat("%08d", record_sequence);
 }
 
-zetasql::Value CreateEmptyArrayForRecordType(
-    ChangeStreamOutputTypes::ReturningType type) {
-  const ChangeStreamOutputTypes* types = GetChangeStreamOutputTypes();
-  switch (type) {
-    case ChangeStreamOutputTypes::ReturningType::HEARTBEAT:
-      return zetasql::Value::EmptyArray(types->heartbeat_record_arr);
-    case ChangeStreamOutputTypes::ReturningType::CHILD_PARTITIONS:
-      return zetasql::Value::EmptyArray(types->child_partitions_record_arr);
-    case ChangeStreamOutputTypes::DATA_CHANGE:
-      return zetasql::Value::EmptyArray(types->data_change_record_arr);
-  }
+// Records are encoded straight into the wire form of their output type,
+// where STRUCTs and ARRAYs are both list values, instead of being built as
+// zetasql::Values and converted afterwards. Only the leaf values go through
+// ValueToProto.
+google::protobuf::ListValue* AddList(google::protobuf::ListValue* list_pb) {
+  return list_pb->add_values()->mutable_list_value();
 }
 
-absl::StatusOr<zetasql::Value> CreateChangeRecord(
-    zetasql::Value data_change_record, zetasql::Value heartbeat_record,
-    zetasql::Value child_partitions_record) {
-  zetasql::Value change_record_arr_val;
-  zetasql::Value change_record_struct_val;
-  const ChangeStreamOutputTypes* types = GetChangeStreamOutputTypes();
+absl::Status AddValue(const zetasql::Value& value,
+                      google::protobuf::ListValue* list_pb) {
+  return ValueToProto(value, list_pb->add_values());
+}
+
+// Adds the JSON stored as a string in the change stream data table, in the
+// same normalized form as a JSON value.
+absl::Status AddJson(const zetasql::Value& json_string,
+                     google::protobuf::ListValue* list_pb) {
   ZETASQL_ASSIGN_OR_RETURN(
-      change_record_struct_val,
-      zetasql::Value::MakeStruct(
-          types->change_record_struct,
-          {data_change_record, heartbeat_record, child_partitions_record}));
-  return zetasql::Value::MakeArray(types->change_record_arr->AsArray(),
-                                     {change_record_struct_val});
+      zetasql::JSONValue json,
+      zetasql::JSONValue::ParseJSONString(json_string.string_value()));
+  list_pb->add_values()->set_string_value(json.GetConstRef().ToString());
+  return absl::OkStatus();
 }
 
-absl::StatusOr<zetasql::Value> CreateHeartbeatRecord(absl::Time timestamp) {
-  const ChangeStreamOutputTypes* types = GetChangeStreamOutputTypes();
-  std::vector<zetasql::Value> values;
-  values.push_back(zetasql::Value::Timestamp(timestamp));
-  ZETASQL_ASSIGN_OR_RETURN(auto heartbeat, zetasql::Value::MakeStruct(
-                                       types->heartbeat_record_struct, values));
+// Encodes one change record into `change_record_pb`, which has the type
+// ARRAY<STRUCT<data_change_record ARRAY<...>, heartbeat_record ARRAY<...>,
+// child_partitions_record ARRAY<...>>>. The record arrays other than the one
+// for `field` are empty, and the returned list is the single record STRUCT
+// of `field` for the caller to fill.
+google::protobuf::ListValue* AddChangeRecord(
+    ChangeRecordField field, google::protobuf::Value* change_record_pb) {
+  google::protobuf::ListValue* change_record_struct_pb =
+      AddList(change_record_pb->mutable_list_value());
+  google::protobuf::ListValue* record_struct_pb = nullptr;
+  for (ChangeRecordField record_field :
+       {ChangeRecordField::kDataChange, ChangeRecordField::kHeartbeat,
+        ChangeRecordField::kChildPartitions}) {
+    google::protobuf::ListValue* record_arr_pb =
+        AddList(change_record_struct_pb);
+    if (record_field == field) {
+      record_struct_pb = AddList(record_arr_pb);
+    }
+  }
+  return record_struct_pb;
+}
 
-  return zetasql::Value::MakeArray(types->heartbeat_record_arr, {heartbeat});
+absl::Status AddHeartbeatRecord(absl::Time timestamp,
+                                google::protobuf::Value* change_record_pb) {
+  google::protobuf::ListValue* heartbeat_pb =
+      AddChangeRecord(ChangeRecordField::kHeartbeat, change_record_pb);
+  return AddValue(zetasql::Value::Timestamp(timestamp), heartbeat_pb);
 }
 
-absl::StatusOr<zetasql::Value> CreateChildPartitionRecord(
+absl::Status AddChildPartitionRecord(
     backend::RowCursor* cursor, int64_t record_sequence,
-    std::optional<absl::Time> initial_start_timestamp) {
+    std::optional<absl::Time> initial_start_timestamp,
+    google::protobuf::Value* change_record_pb) {
   // The passed in cursor is guaranteed to have the shape of
   // {start_time(TIMESTAMP),partition_token(STRING), parents(ARRAY<STRING>)}
   // due to the fixed shape of change stream internal partition table.
-  const ChangeStreamOutputTypes* types = GetChangeStreamOutputTypes();
-  std::vector<zetasql::Value> values;
-  values.push_back(
-      initial_start_timestamp.has_value()
-          ? zetasql::Value::Timestamp(initial_start_timestamp.value())
-          : cursor->ColumnValue(0));
-  values.push_back(
-      zetasql::Value::String(ToFragmentIdString(record_sequence)));
-
-  std::vector<zetasql::Value> child_partitions_struct_values;
+  google::protobuf::ListValue* child_partitions_record_pb =
+      AddChangeRecord(ChangeRecordField::kChildPartitions, change_record_pb);
+  ZETASQL_RETURN_IF_ERROR(
+      AddValue(initial_start_timestamp.has_value()
+                   ? zetasql::Value::Timestamp(initial_start_timestamp.value())
+                   : cursor->ColumnValue(0),
+               child_partitions_record_pb));
+  child_partitions_record_pb->add_values()->set_string_value(
+      ToFragmentIdString(record_sequence));
 
   // If a split event happens during partition query, one child partition record
   // can contain up to two partition tokens after split. If initial_start_time
   // doesn't have value and there are more than one row contain in the partition
   // table row cursor, we know a split event happened and keep inserting the
   // remaining splitted partition tokens in current row cursor.
+  google::protobuf::ListValue* child_partitions_pb =
+      AddList(child_partitions_record_pb);
   do {
-    zetasql::Value partition_token_val = cursor->ColumnValue(1);
+    google::protobuf::ListValue* child_partition_pb =
+        AddList(child_partitions_pb);
+    ZETASQL_RETURN_IF_ERROR(AddValue(cursor->ColumnValue(1), child_partition_pb));
     // Prevent populating parent tokens for initial partition queries.
-    zetasql::Value parent_partitions_token_val =
-        initial_start_timestamp.has_value()
-            ? zetasql::Value::EmptyArray(types->parents_arr)
-            : cursor->ColumnValue(2);
-    ZETASQL_ASSIGN_OR_RETURN(auto child_partitions_struct_val,
-                     zetasql::Value::MakeStruct(
-                         types->child_partitions_struct,
-                         {partition_token_val, parent_partitions_token_val}));
-    child_partitions_struct_values.push_back(child_partitions_struct_val);
+    if (initial_start_timestamp.has_value()) {
+      AddList(child_partition_pb);
+    } else {
+      ZETASQL_RETURN_IF_ERROR(AddValue(cursor->ColumnValue(2), child_partition_pb));
+    }
   } while (!initial_start_timestamp.has_value() && cursor->Next());
-
-  ZETASQL_ASSIGN_OR_RETURN(auto child_partitions_struct_array_val,
-                   zetasql::Value::MakeArray(types->child_partitions_arr,
-                                               child_partitions_struct_values));
-  values.push_back(child_partitions_struct_array_val);
-  ZETASQL_ASSIGN_OR_RETURN(auto child_partitions_record_struct_val,
-                   zetasql::Value::MakeStruct(
-                       types->child_partitions_record_struct, values));
-  zetasql::Value final_child_partition_record;
-  ZETASQL_ASSIGN_OR_RETURN(
-      final_child_partition_record,
-      zetasql::Value::MakeArray(types->child_partitions_record_arr->AsArray(),
-                                  {child_partitions_record_struct_val}));
-  return final_child_partition_record;
+  return absl::OkStatus();
 }
 
-absl::StatusOr<zetasql::Value> CreateDataChangeRecord(
-    backend::RowCursor* cursor) {
-  const ChangeStreamOutputTypes* types = GetChangeStreamOutputTypes();
-  std::vector<zetasql::Value> values;
+absl::Status AddDataChangeRecord(backend::RowCursor* cursor,
+                                 google::protobuf::Value* change_record_pb) {
   // The passed in cursor is guaranteed to have the shape of
   // {"partition_token(STRING)",
   //  "commit_timestamp(TIMESTAMP)",
@@ -269,19 +207,14 @@ absl::StatusOr<zetasql::Value> CreateDataChangeRecord(
   //  "is_system_transaction(BOOL)"},
   // due to the fixed shape of change stream internal data table.
   ZETASQL_RET_CHECK(cursor->NumColumns() == 19);
-  values.reserve(18);
+  google::protobuf::ListValue* data_change_record_pb =
+      AddChangeRecord(ChangeRecordField::kDataChange, change_record_pb);
   // Skip the first column partition_token(STRING) since partition token is not
   // part of the actual data change record that will be returned to the users.
-  for (int i = 1; i < 6; i++) {
-    // Swap the order of server transaction id and record sequence due to the
-    // different table schema.
-    if (i == 2) {
-      values.push_back(cursor->ColumnValue(3));
-    } else if (i == 3) {
-      values.push_back(cursor->ColumnValue(2));
-    } else {
-      values.push_back(cursor->ColumnValue(i));
-    }
+  // Swap the order of server transaction id and record sequence due to the
+  // different table schema.
+  for (int i : {1, 3, 2, 4, 5}) {
+    ZETASQL_RETURN_IF_ERROR(AddValue(cursor->ColumnValue(i), data_change_record_pb));
   }
 
   // Reconstruct each column type JSON into a struct:
@@ -290,84 +223,49 @@ absl::StatusOr<zetasql::Value> CreateDataChangeRecord(
   //     type JSON,
   //     is_primary_key BOOL,
   //     ordinal_position INT64>>
-  zetasql::Value column_types_name_arr = cursor->ColumnValue(6);
-  zetasql::Value column_types_type_arr = cursor->ColumnValue(7);
-  zetasql::Value column_types_is_primary_key = cursor->ColumnValue(8);
-  zetasql::Value column_types_ordinal_position = cursor->ColumnValue(9);
-  std::vector<zetasql::Value> column_types_arr_structs;
+  const zetasql::Value column_types_name_arr = cursor->ColumnValue(6);
+  const zetasql::Value column_types_type_arr = cursor->ColumnValue(7);
+  const zetasql::Value column_types_is_primary_key = cursor->ColumnValue(8);
+  const zetasql::Value column_types_ordinal_position = cursor->ColumnValue(9);
+  google::protobuf::ListValue* column_types_pb = AddList(data_change_record_pb);
   for (int i = 0; i < column_types_name_arr.num_elements(); i++) {
-    std::vector<zetasql::Value> curr_column_type_vals{
-        column_types_name_arr.element(i),
-        zetasql::Value::Json(
-            zetasql::JSONValue::ParseJSONString(
-                column_types_type_arr.element(i).string_value())
-                .value()),
-        column_types_is_primary_key.element(i),
-        column_types_ordinal_position.element(i)};
-    ZETASQL_ASSIGN_OR_RETURN(auto curr_column_type_struct,
-                     zetasql::Value::MakeStruct(types->column_types_struct,
-                                                  curr_column_type_vals));
-    column_types_arr_structs.push_back(curr_column_type_struct);
+    google::protobuf::ListValue* column_type_pb = AddList(column_types_pb);
+    ZETASQL_RETURN_IF_ERROR(AddValue(column_types_name_arr.element(i), column_type_pb));
+    ZETASQL_RETURN_IF_ERROR(AddJson(column_types_type_arr.element(i), column_type_pb));
+    ZETASQL_RETURN_IF_ERROR(
+        AddValue(column_types_is_primary_key.element(i), column_type_pb));
+    ZETASQL_RETURN_IF_ERROR(
+        AddValue(column_types_ordinal_position.element(i), column_type_pb));
   }
-  ZETASQL_ASSIGN_OR_RETURN(auto column_types_struct_array_val,
-                   zetasql::Value::MakeArray(types->column_types_arr,
-                                               column_types_arr_structs));
-  values.push_back(column_types_struct_array_val);
 
   // Reconstruct each column type JSON into a struct:
   // mods ARRAY<STRUCT<
   //   keys JSON,
   //   new_values JSON,
   //   old_values JSON>>
-  std::vector<zetasql::Value> mods_arr_vals;
-  zetasql::Value mods_keys_arr = cursor->ColumnValue(10);
-  zetasql::Value mods_new_values_arr = cursor->ColumnValue(11);
-  zetasql::Value mods_old_values_arr = cursor->ColumnValue(12);
+  const zetasql::Value mods_keys_arr = cursor->ColumnValue(10);
+  const zetasql::Value mods_new_values_arr = cursor->ColumnValue(11);
+  const zetasql::Value mods_old_values_arr = cursor->ColumnValue(12);
+  google::protobuf::ListValue* mods_pb = AddList(data_change_record_pb);
   for (int i = 0; i < mods_keys_arr.num_elements(); i++) {
-    std::vector<zetasql::Value> curr_mod_vals{
-        zetasql::Value::Json(zetasql::JSONValue::ParseJSONString(
-                                   mods_keys_arr.element(i).string_value())
-                                   .value()),
-        zetasql::Value::Json(
-            zetasql::JSONValue::ParseJSONString(
-                mods_new_values_arr.element(i).string_value())
-                .value()),
-        zetasql::Value::Json(
-            zetasql::JSONValue::ParseJSONString(
-                mods_old_values_arr.element(i).string_value())
-                .value()),
-    };
-
-    ZETASQL_ASSIGN_OR_RETURN(
-        auto curr_mods_struct_val,
-        zetasql::Value::MakeStruct(types->mods_struct, curr_mod_vals));
-    mods_arr_vals.push_back(curr_mods_struct_val);
+    google::protobuf::ListValue* mod_pb = AddList(mods_pb);
+    ZETASQL_RETURN_IF_ERROR(AddJson(mods_keys_arr.element(i), mod_pb));
+    ZETASQL_RETURN_IF_ERROR(AddJson(mods_new_values_arr.element(i), mod_pb));
+    ZETASQL_RETURN_IF_ERROR(AddJson(mods_old_values_arr.element(i), mod_pb));
   }
 
-  ZETASQL_ASSIGN_OR_RETURN(auto mods_struct_array_val,
-                   zetasql::Value::MakeArray(types->mods_arr, mods_arr_vals));
-  values.push_back(mods_struct_array_val);
   for (int i = 13; i < 19; i++) {
-    values.push_back(cursor->ColumnValue(i));
+    ZETASQL_RETURN_IF_ERROR(AddValue(cursor->ColumnValue(i), data_change_record_pb));
   }
-  ZETASQL_ASSIGN_OR_RETURN(
-      auto data_change_record_struct_val,
-      zetasql::Value::MakeStruct(types->data_change_record_struct, values));
-  ZETASQL_ASSIGN_OR_RETURN(
-      auto final_data_change_record,
-      zetasql::Value::MakeArray(types->data_change_record_arr,
-                                  {data_change_record_struct_val}));
-  return final_data_change_record;
+  return absl::OkStatus();
 }
 
-absl::Status PopulateMetadata(
-    std::vector<spanner_api::PartialResultSet>* responses) {
+void PopulateMetadata(std::vector<spanner_api::PartialResultSet>* responses) {
   auto* result_metadata_pb = responses->at(0).mutable_metadata();
   auto* field_pb = result_metadata_pb->mutable_row_type()->add_fields();
   field_pb->set_name(kChangeStreamTvfOutputColumn);
-  ZETASQL_RETURN_IF_ERROR(TypeToProto(GetChangeStreamOutputTypes()->change_record_arr,
-                              field_pb->mutable_type()));
-  return absl::OkStatus();
+  *field_pb->mutable_type() =
+      GetChangeStreamOutputTypes()->change_record_arr_pb;
 }
 
 void PopulateFakeResumeTokens(
@@ -377,26 +275,14 @@ void PopulateFakeResumeTokens(
   }
 }
 
-}  // namespace
-
-absl::StatusOr<std::vector<spanner_api::PartialResultSet>>
-ConvertHeartbeatTimestampToStruct(absl::Time timestamp, bool expect_metadata) {
-  spanner_api::ResultSet result_pb;
-  auto* row_pb = result_pb.add_rows();
-  ZETASQL_ASSIGN_OR_RETURN(auto heartbeat_record, CreateHeartbeatRecord(timestamp));
+// Chunks `result_pb` into the partial result sets sent to the client.
+absl::StatusOr<std::vector<spanner_api::PartialResultSet>> ToResponses(
+    spanner_api::ResultSet result_pb, bool expect_metadata) {
   ZETASQL_ASSIGN_OR_RETURN(
-      auto change_record,
-      CreateChangeRecord(
-          CreateEmptyArrayForRecordType(
-              ChangeStreamOutputTypes::ReturningType::DATA_CHANGE),
-          heartbeat_record,
-          CreateEmptyArrayForRecordType(
-              ChangeStreamOutputTypes::ReturningType::CHILD_PARTITIONS)));
-  ZETASQL_ASSIGN_OR_RETURN(*row_pb->add_values(), ValueToProto(change_record));
-  ZETASQL_ASSIGN_OR_RETURN(auto responses,
-                   ChunkResultSet(result_pb, limits::kMaxStreamingChunkSize));
+      auto responses,
+      ChunkResultSet(std::move(result_pb), limits::kMaxStreamingChunkSize));
   if (expect_metadata) {
-    ZETASQL_RETURN_IF_ERROR(PopulateMetadata(&responses));
+    PopulateMetadata(&responses);
   } else {
     responses.at(0).clear_metadata();
   }
@@ -404,6 +290,16 @@ ConvertHeartbeatTimestampToStruct(absl::Time timestamp, bool expect_metadata) {
   return responses;
 }
 
+}  // namespace
+
+absl::StatusOr<std::vector<spanner_api::PartialResultSet>>
+ConvertHeartbeatTimestampToStruct(absl::Time timestamp, bool expect_metadata) {
+  spanner_api::ResultSet result_pb;
+  ZETASQL_RETURN_IF_ERROR(
+      AddHeartbeatRecord(timestamp, result_pb.add_rows()->add_values()));
+  return ToResponses(std::move(result_pb), expect_metadata);
+}
+
 absl::StatusOr<std::vector<spanner_api::PartialResultSet>>
 ConvertPartitionTableRowCursorToStruct(
     backend::RowCursor* row_cursor,
@@ -411,29 +307,12 @@ ConvertPartitionTableRowCursorToStruct(
   spanner_api::ResultSet result_pb;
   int64_t record_sequence = 0;
   while (row_cursor->Next()) {
-    auto* row_pb = result_pb.add_rows();
-    ZETASQL_ASSIGN_OR_RETURN(auto child_partitions_record,
-                     CreateChildPartitionRecord(row_cursor, record_sequence,
-                                                initial_start_timestamp));
-    ZETASQL_ASSIGN_OR_RETURN(
-        auto change_record,
-        CreateChangeRecord(
-            CreateEmptyArrayForRecordType(ChangeStreamOutputTypes::DATA_CHANGE),
-            CreateEmptyArrayForRecordType(
-                ChangeStreamOutputTypes::ReturningType::HEARTBEAT),
-            child_partitions_record));
-    ZETASQL_ASSIGN_OR_RETURN(*row_pb->add_values(), ValueToProto(change_record));
+    ZETASQL_RETURN_IF_ERROR(AddChildPartitionRecord(
+        row_cursor, record_sequence, initial_start_timestamp,
+        result_pb.add_rows()->add_values()));
     record_sequence++;
   }
-  ZETASQL_ASSIGN_OR_RETURN(auto responses,
-                   ChunkResultSet(result_pb, limits::kMaxStreamingChunkSize));
-  if (expect_metadata) {
-    ZETASQL_RETURN_IF_ERROR(PopulateMetadata(&responses));
-  } else {
-    responses.at(0).clear_metadata();
-  }
-  PopulateFakeResumeTokens(&responses);
-  return responses;
+  return ToResponses(std::move(result_pb), expect_metadata);
 }
 
 absl::StatusOr<std::vector<spanner_api::PartialResultSet>>
@@ -441,28 +320,27 @@ ConvertDataTableRowCursorToStruct(backend::RowCursor* row_cursor,
                                   bool expect_metadata) {
   spanner_api::ResultSet result_pb;
   while (row_cursor->Next()) {
-    auto* row_pb = result_pb.add_rows();
-    ZETASQL_ASSIGN_OR_RETURN(auto data_change_record,
-                     CreateDataChangeRecord(row_cursor));
-    ZETASQL_ASSIGN_OR_RETURN(
-        auto change_record,
-        CreateChangeRecord(
-            data_change_record,
-            CreateEmptyArrayForRecordType(
-                ChangeStreamOutputTypes::ReturningType::HEARTBEAT),
-            CreateEmptyArrayForRecordType(
-                ChangeStreamOutputTypes::ReturningType::CHILD_PARTITIONS)));
-    ZETASQL_ASSIGN_OR_RETURN(*row_pb->add_values(), ValueToProto(change_record));
+    ZETASQL_RETURN_IF_ERROR(
+        AddDataChangeRecord(row_cursor, result_pb.add_rows()->add_values()));
   }
-  ZETASQL_ASSIGN_OR_RETURN(auto responses,
-                   ChunkResultSet(result_pb, limits::kMaxStreamingChunkSize));
-  if (expect_metadata) {
-    ZETASQL_RETURN_IF_ERROR(PopulateMetadata(&responses));
-  } else {
-    responses.at(0).clear_metadata();
+  return ToResponses(std::move(result_pb), expect_metadata);
+}
+
+absl::Status StreamDataTableRowCursorAsStruct(
+    backend::RowCursor* row_cursor, bool expect_metadata,
+    const ChangeStreamResponseSender& send) {
+  while (row_cursor->Next()) {
+    spanner_api::ResultSet result_pb;
+    ZETASQL_RETURN_IF_ERROR(
+        AddDataChangeRecord(row_cursor, result_pb.add_rows()->add_values()));
+    ZETASQL_ASSIGN_OR_RETURN(auto responses,
+                     ToResponses(std::move(result_pb), expect_metadata));
+    expect_metadata = false;
+    for (const auto& response : responses) {
+      ZETASQL_RETURN_IF_ERROR(send(response));
+    }
   }
-  PopulateFakeResumeTokens(&responses);
-  return responses;
+  return row_cursor->Status();
 }
 
 }  // namespace frontend
@@ -17,10 +17,12 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_CHANGE_STREAMS_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_CHANGE_STREAMS_H_
 
+#include <functional>
 #include <optional>
 #include <vector>
 
 #include "google/spanner/v1/result_set.pb.h"
+#include "absl/status/status.h"
 #include "backend/access/read.h"
 namespace google {
 namespace spanner {
@@ -31,6 +33,12 @@ namespace spanner_api = ::google::spanner::v1;
 static constexpr char kChangeStreamDummyResumeToken[] =
     "dummy_resume_token_for_change_streams_on_emulator";
 
+// Sends a partial result set of a change stream query to the client. Returns an
+// error if the response could not be sent, in which case no further responses
+// should be sent.
+using ChangeStreamResponseSender =
+    std::function<absl::Status(const spanner_api::PartialResultSet&)>;
+
 // Takes a row cursor for a change stream partition table, and convert the row
 // cursor into a child partition record partial result set as ARRAY<STRUCT>. If
 // initial_start_time is not empty, current row cursor is yielded from initial
@@ -54,6 +62,15 @@ absl::StatusOr<std::vector<spanner_api::PartialResultSet>>
 ConvertDataTableRowCursorToStruct(backend::RowCursor* row_cursor,
                                   bool expect_metadata = false);
 
+// Takes a row cursor from data table and streams each row as a data change
+// record partial result set as ARRAY<STRUCT>. Each record is converted and
+// passed to `send` before the next row is read, so that the responses for the
+// whole cursor are never buffered at once. Metadata is only populated in the
+// first response if `expect_metadata` is true.
+absl::Status StreamDataTableRowCursorAsStruct(
+    backend::RowCursor* row_cursor, bool expect_metadata,
+    const ChangeStreamResponseSender& send);
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
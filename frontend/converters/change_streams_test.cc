@@ -29,6 +29,7 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/status/status.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/clock.h"
 #include "frontend/converters/chunking.h"
@@ -57,6 +58,7 @@ using zetasql::values::Timestamp;
 using testing::ElementsAre;
 using test::EqualsProto;
 using test::proto::Partially;
+using zetasql_base::testing::StatusIs;
 
 class ChangeStreamResultConverterTest : public testing::Test {
  protected:
@@ -785,6 +787,90 @@ TEST_F(ChangeStreamResultConverterTest,
   ASSERT_EQ(change_recods.data_change_records.size(), 1);
 }
 
+TEST_F(ChangeStreamResultConverterTest,
+       StreamDataTableRowCursorSendsEachRecordAsItIsConverted) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto col_types_name_arr_val,
+      zetasql::Value::MakeArray(StringArrayType(), {String("UserId")}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto col_types_type_arr_val,
+      zetasql::Value::MakeArray(StringArrayType(),
+                                  {String("{\"code\":\"STRING\"}")}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto col_types_is_primary_key_arr_val,
+      zetasql::Value::MakeArray(zetasql::types::BoolArrayType(),
+                                  {Bool(true)}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto col_types_ordinal_position_arr_val,
+      zetasql::Value::MakeArray(zetasql::types::Int64ArrayType(), {Int64(1)}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto mods_keys,
+      zetasql::Value::MakeArray(StringArrayType(),
+                                  {String("{\"UserId\": \"User1\"}")}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto mods_new_values,
+      zetasql::Value::MakeArray(StringArrayType(), {String("{}")}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      auto mods_old_values,
+      zetasql::Value::MakeArray(StringArrayType(), {String("{}")}));
+  std::vector<std::vector<zetasql::Value>> rows;
+  for (const char* record_sequence : {"00000000", "00000001"}) {
+    rows.push_back(
+        {String("test_token"), Timestamp(now_), String("test_id"),
+         String(record_sequence), Bool(false), String("test_table"),
+         col_types_name_arr_val, col_types_type_arr_val,
+         col_types_is_primary_key_arr_val, col_types_ordinal_position_arr_val,
+         mods_keys, mods_new_values, mods_old_values, String("INSERT"),
+         String("OLD_AND_NEW_VALUES"), Int64(2), Int64(1), String(""),
+         Bool(false)});
+  }
+  auto make_cursor = [&]() {
+    return TestRowCursor(
+        {"partition_token", "commit_timestamp", "server_transaction_id",
+         "record_sequence", "is_last_record_in_transaction_in_partition",
+         "table_name", "column_types_name", "column_types_type",
+         "column_type_is_primary_key", "column_types_ordinal_position",
+         "mods_keys", "mods_new_values", "mods_old_values", "mod_type",
+         "value_capture_type", "number_of_records_in_transaction",
+         "number_of_partitions_in_transaction", "transaction_tag",
+         "is_system_transaction"},
+        {StringType(), TimestampType(), StringType(), StringType(), BoolType(),
+         StringType(), StringType(), StringType(), BoolType(), Int64Type(),
+         StringType(), StringType(), StringType(), StringType(), StringType(),
+         Int64Type(), Int64Type(), StringType(), BoolType()},
+        rows);
+  };
+
+  std::vector<PartialResultSet> results;
+  TestRowCursor cursor = make_cursor();
+  ZETASQL_ASSERT_OK(StreamDataTableRowCursorAsStruct(
+      &cursor, /*expect_metadata=*/true,
+      [&](const PartialResultSet& response) {
+        results.push_back(response);
+        return absl::OkStatus();
+      }));
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_TRUE(results[0].has_metadata());
+  EXPECT_FALSE(results[1].has_metadata());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto result_set, backend::test::MergePartialResultSets(
+                                            results, /*columns_per_row=*/1));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(test::ChangeStreamRecords change_records,
+                       test::GetChangeStreamRecordsFromResultSet(result_set));
+  EXPECT_EQ(change_records.data_change_records.size(), 2);
+
+  // A failed send stops the conversion of the remaining records.
+  int num_sends = 0;
+  TestRowCursor closed_cursor = make_cursor();
+  EXPECT_THAT(StreamDataTableRowCursorAsStruct(
+                  &closed_cursor, /*expect_metadata=*/false,
+                  [&](const PartialResultSet&) {
+                    ++num_sends;
+                    return absl::CancelledError("stream closed");
+                  }),
+              StatusIs(absl::StatusCode::kCancelled));
+  EXPECT_EQ(num_sends, 1);
+}
+
 }  // namespace
 
 }  // namespace frontend
@@ -17,6 +17,10 @@
 #include "frontend/converters/chunking.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -72,6 +76,8 @@ int64_t RemovePartialUTF8(absl::string_view string, int64_t available) {
   return available;
 }
 
+}  // namespace
+
 // Constructs a set of PartialResultSets. Data will be chunked as necessary to
 // comply with the Cloud Spanner streaming chunk size limit. Only Strings and
 // Lists need to be chunked (Structs are not a valid column type and will return
@@ -90,8 +96,8 @@ class ResultSetBuilder {
   }
 
   // Adds the incoming value to the set of PartialResultSets chunking as
-  // necessary.
-  absl::Status AddValue(const protobuf::Value& value) {
+  // necessary. Values which are not chunked are moved out of `value`.
+  absl::Status AddValue(protobuf::Value* value) {
     // If the current size exceeds the limit, create a new chunk.
     if (HasExceededChunkLimit()) {
       StartNewResultSet();
@@ -102,16 +108,17 @@ class ResultSetBuilder {
     // partial values will be added to the end of this result set and beginning
     // of the next one. The partial results will be merged back together by the
     // receiving client.
-    auto value_size = value.ByteSizeLong();
-    switch (value.kind_case()) {
+    auto value_size = value->ByteSizeLong();
+    switch (value->kind_case()) {
       case protobuf::Value::kListValue: {
         // Check if list can fit into current chunk.
         if (current_chunk_size_ + value_size <= max_chunk_size_) {
-          AddUnchunkedValue(value);
+          AddUnchunkedValue(value, value_size);
         } else {
           StartList();
-          for (const auto& list_value : value.list_value().values()) {
-            ZETASQL_RETURN_IF_ERROR(AddValue(list_value));
+          for (auto& list_value :
+               *value->mutable_list_value()->mutable_values()) {
+            ZETASQL_RETURN_IF_ERROR(AddValue(&list_value));
           }
           FinishList();
         }
@@ -121,9 +128,9 @@ class ResultSetBuilder {
       case protobuf::Value::kStringValue: {
         // Check if string can fit into current chunk.
         if (current_chunk_size_ + value_size <= max_chunk_size_) {
-          AddUnchunkedValue(value);
+          AddUnchunkedValue(value, value_size);
         } else {
-          AddString(value.string_value());
+          AddString(value->string_value());
         }
         CheckStringBoundary();
         break;
@@ -131,18 +138,26 @@ class ResultSetBuilder {
       case protobuf::Value::kBoolValue:
       case protobuf::Value::kNumberValue:
       case protobuf::Value::kNullValue:
-        AddUnchunkedValue(value);
+        AddUnchunkedValue(value, value_size);
         break;
 
       default:
         return error::Internal(absl::Substitute(
             "Cannot convert value of type ($0) to a potentially "
             "chunked PartialResultSet.",
-            value.GetTypeName()));
+            value->GetTypeName()));
     }
     return absl::OkStatus();
   }
 
+  // Points the builder back at the last result set after the result sets
+  // before it have been moved out of results. Must not be called while a list
+  // is being added, which is never the case between calls to AddValue.
+  void Rebase() {
+    stack_.clear();
+    stack_.push_back(results_->back().mutable_values());
+  }
+
  private:
   ResultSetBuilder(const ResultSetBuilder&) = delete;
   ResultSetBuilder& operator=(const ResultSetBuilder&) = delete;
@@ -156,10 +171,11 @@ class ResultSetBuilder {
   // Adds a value as the next value without chunking. The value will be added to
   // a list if there are any nested lists otherwise it will be added as the next
   // value in results. Used for the fast path when it is known this will not
-  // need to be chunked.
-  void AddUnchunkedValue(const protobuf::Value& value) {
-    *stack_.back()->Add() = value;
-    current_chunk_size_ += value.ByteSizeLong();
+  // need to be chunked. `value_size` is the size of `value`, which is moved
+  // rather than copied since it is not needed afterwards.
+  void AddUnchunkedValue(protobuf::Value* value, int64_t value_size) {
+    *stack_.back()->Add() = std::move(*value);
+    current_chunk_size_ += value_size;
   }
 
   // If a nested list ends at the boundary of the chunk, we need to make sure
@@ -285,22 +301,57 @@ class ResultSetBuilder {
   std::vector<google::protobuf::RepeatedPtrField<protobuf::Value>*> stack_;
 };
 
-}  // namespace
+PartialResultSetEncoder::PartialResultSetEncoder(
+    google::spanner::v1::ResultSetMetadata metadata, int64_t max_chunk_size) {
+  results_.emplace_back();
+  *results_.front().mutable_metadata() = std::move(metadata);
+  builder_ = std::make_unique<ResultSetBuilder>(max_chunk_size, &results_);
+}
+
+PartialResultSetEncoder::~PartialResultSetEncoder() = default;
+
+absl::Status PartialResultSetEncoder::AddValue(protobuf::Value* value) {
+  return builder_->AddValue(value);
+}
+
+std::vector<google::spanner::v1::PartialResultSet>
+PartialResultSetEncoder::TakeCompleted() {
+  // Values are only ever added to the last result set.
+  std::vector<google::spanner::v1::PartialResultSet> completed;
+  if (results_.size() == 1) {
+    return completed;
+  }
+  completed.reserve(results_.size() - 1);
+  std::move(results_.begin(), results_.end() - 1,
+            std::back_inserter(completed));
+  results_.erase(results_.begin(), results_.end() - 1);
+  builder_->Rebase();
+  return completed;
+}
+
+std::vector<google::spanner::v1::PartialResultSet>
+PartialResultSetEncoder::Finish() {
+  builder_.reset();
+  return std::move(results_);
+}
 
 absl::StatusOr<std::vector<google::spanner::v1::PartialResultSet>>
 ChunkResultSet(const google::spanner::v1::ResultSet& set,
                int64_t max_chunk_size) {
-  std::vector<google::spanner::v1::PartialResultSet> results;
-  results.emplace_back();
-  *results.front().mutable_metadata() = set.metadata();
-
-  ResultSetBuilder builder(max_chunk_size, &results);
-  for (const auto& row : set.rows()) {
-    for (const auto& value : row.values()) {
-      ZETASQL_RETURN_IF_ERROR(builder.AddValue(value));
+  google::spanner::v1::ResultSet set_copy = set;
+  return ChunkResultSet(std::move(set_copy), max_chunk_size);
+}
+
+absl::StatusOr<std::vector<google::spanner::v1::PartialResultSet>>
+ChunkResultSet(google::spanner::v1::ResultSet&& set, int64_t max_chunk_size) {
+  PartialResultSetEncoder encoder(std::move(*set.mutable_metadata()),
+                                  max_chunk_size);
+  for (auto& row : *set.mutable_rows()) {
+    for (auto& value : *row.mutable_values()) {
+      ZETASQL_RETURN_IF_ERROR(encoder.AddValue(&value));
     }
   }
-  return results;
+  return encoder.Finish();
 }
 
 }  // namespace frontend
@@ -17,6 +17,8 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_CHUNKING_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_CHUNKING_H_
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "google/protobuf/struct.pb.h"
@@ -36,6 +38,40 @@ namespace frontend {
 absl::StatusOr<std::vector<google::spanner::v1::PartialResultSet>>
 ChunkResultSet(const google::spanner::v1::ResultSet& set, int64_t max_chunk_size);
 
+// Same as above, but consumes `set`, moving values which fit into a chunk
+// instead of copying them.
+absl::StatusOr<std::vector<google::spanner::v1::PartialResultSet>>
+ChunkResultSet(google::spanner::v1::ResultSet&& set, int64_t max_chunk_size);
+
+class ResultSetBuilder;
+
+// Encodes the values of a result one at a time directly into PartialResultSets
+// with the same chunking as ChunkResultSet, without building a ResultSet
+// first. Completed PartialResultSets can be taken out while values are still
+// being added, so that they can be streamed.
+class PartialResultSetEncoder {
+ public:
+  // The first PartialResultSet carries `metadata`.
+  PartialResultSetEncoder(google::spanner::v1::ResultSetMetadata metadata,
+                          int64_t max_chunk_size);
+  ~PartialResultSetEncoder();
+
+  // Adds the next value of the result, in row-major order. Values which are
+  // not chunked are moved out of `value`.
+  absl::Status AddValue(google::protobuf::Value* value);
+
+  // Returns the PartialResultSets which no further values will be added to,
+  // in order, and removes them from the encoder.
+  std::vector<google::spanner::v1::PartialResultSet> TakeCompleted();
+
+  // Returns the remaining PartialResultSets once all values have been added.
+  std::vector<google::spanner::v1::PartialResultSet> Finish();
+
+ private:
+  std::vector<google::spanner::v1::PartialResultSet> results_;
+  std::unique_ptr<ResultSetBuilder> builder_;
+};
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
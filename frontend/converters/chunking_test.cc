@@ -18,6 +18,7 @@
 
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "google/protobuf/struct.pb.h"
@@ -708,6 +709,37 @@ TEST(ChunkingTest, RandomChunking) {
         ResultSet merged_result,
         backend::test::MergePartialResultSets(results, kNumColumns));
     EXPECT_THAT(merged_result, test::EqualsProto(result));
+
+    // Consuming the result set produces the same chunks.
+    ResultSet result_copy = result;
+    ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<PartialResultSet> consumed_results,
+                         ChunkResultSet(std::move(result_copy), kChunkSize));
+    ASSERT_EQ(consumed_results.size(), results.size());
+    for (int j = 0; j < results.size(); ++j) {
+      EXPECT_THAT(consumed_results[j], test::EqualsProto(results[j]));
+    }
+
+    // Encoding the values one at a time while taking out completed chunks
+    // also produces the same chunks.
+    ResultSet encoded_copy = result;
+    PartialResultSetEncoder encoder(std::move(*encoded_copy.mutable_metadata()),
+                                    kChunkSize);
+    std::vector<PartialResultSet> encoded_results;
+    for (auto& row : *encoded_copy.mutable_rows()) {
+      for (auto& value : *row.mutable_values()) {
+        ZETASQL_ASSERT_OK(encoder.AddValue(&value));
+        for (auto& chunk : encoder.TakeCompleted()) {
+          encoded_results.push_back(std::move(chunk));
+        }
+      }
+    }
+    for (auto& chunk : encoder.Finish()) {
+      encoded_results.push_back(std::move(chunk));
+    }
+    ASSERT_EQ(encoded_results.size(), results.size());
+    for (int j = 0; j < results.size(); ++j) {
+      EXPECT_THAT(encoded_results[j], test::EqualsProto(results[j]));
+    }
   }
 }
 
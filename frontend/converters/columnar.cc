@@ -0,0 +1,350 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "frontend/converters/columnar.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/struct.pb.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "backend/access/read.h"
+#include "common/errors.h"
+#include "frontend/converters/values.h"
+#include "absl/status/status.h"
+#include "zetasql/base/ret_check.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+namespace {
+
+using ColumnKind = ColumnarBatchEncoder::ColumnKind;
+
+ColumnKind ColumnKindForType(const zetasql::Type* type) {
+  if (type->IsBool()) return ColumnKind::kBool;
+  if (type->IsInt64()) return ColumnKind::kInt64;
+  if (type->IsDouble()) return ColumnKind::kFloat64;
+  if (type->IsFloat()) return ColumnKind::kFloat32;
+  if (type->IsBytes()) return ColumnKind::kBytes;
+  if (type->IsArray() || type->IsStruct()) return ColumnKind::kValue;
+  return ColumnKind::kString;
+}
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendFixed(uint64_t value, int num_bytes, std::string* out) {
+  for (int i = 0; i < num_bytes; ++i) {
+    out->push_back(static_cast<char>(value & 0xff));
+    value >>= 8;
+  }
+}
+
+void AppendLengthPrefixed(absl::string_view value, std::string* out) {
+  AppendVarint(value.size(), out);
+  out->append(value.data(), value.size());
+}
+
+// Reads the parts of a batch, failing once the input is exhausted.
+class BatchReader {
+ public:
+  explicit BatchReader(absl::string_view input) : input_(input) {}
+
+  bool empty() const { return input_.empty(); }
+
+  absl::StatusOr<uint64_t> ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      ZETASQL_ASSIGN_OR_RETURN(absl::string_view byte, ReadBytes(1));
+      value |= static_cast<uint64_t>(byte[0] & 0x7f) << shift;
+      if ((byte[0] & 0x80) == 0) {
+        return value;
+      }
+    }
+    return error::InvalidColumnarBatch("varint is too long");
+  }
+
+  absl::StatusOr<uint64_t> ReadFixed(int num_bytes) {
+    ZETASQL_ASSIGN_OR_RETURN(absl::string_view bytes, ReadBytes(num_bytes));
+    uint64_t value = 0;
+    for (int i = num_bytes - 1; i >= 0; --i) {
+      value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+    }
+    return value;
+  }
+
+  absl::StatusOr<absl::string_view> ReadLengthPrefixed() {
+    ZETASQL_ASSIGN_OR_RETURN(uint64_t length, ReadVarint());
+    return ReadBytes(length);
+  }
+
+  absl::StatusOr<absl::string_view> ReadBytes(uint64_t num_bytes) {
+    if (num_bytes > input_.size()) {
+      return error::InvalidColumnarBatch("unexpected end of input");
+    }
+    absl::string_view bytes = input_.substr(0, num_bytes);
+    input_.remove_prefix(num_bytes);
+    return bytes;
+  }
+
+ private:
+  absl::string_view input_;
+};
+
+// Sets `value_pb` to a floating point number the same way as ValueToProto.
+void SetNumberValue(double value, google::protobuf::Value* value_pb) {
+  if (std::isfinite(value)) {
+    value_pb->set_number_value(value);
+  } else if (std::isnan(value)) {
+    value_pb->set_string_value("NaN");
+  } else if (value > 0) {
+    value_pb->set_string_value("Infinity");
+  } else {
+    value_pb->set_string_value("-Infinity");
+  }
+}
+
+absl::Status DecodeValue(ColumnKind kind, BatchReader* reader,
+                         google::protobuf::Value* value_pb) {
+  switch (kind) {
+    case ColumnKind::kBool: {
+      ZETASQL_ASSIGN_OR_RETURN(uint64_t value, reader->ReadFixed(1));
+      value_pb->set_bool_value(value != 0);
+      return absl::OkStatus();
+    }
+    case ColumnKind::kInt64: {
+      ZETASQL_ASSIGN_OR_RETURN(uint64_t zigzag, reader->ReadVarint());
+      int64_t value = static_cast<int64_t>(zigzag >> 1) ^
+                      -static_cast<int64_t>(zigzag & 1);
+      value_pb->set_string_value(absl::StrCat(value));
+      return absl::OkStatus();
+    }
+    case ColumnKind::kFloat64: {
+      ZETASQL_ASSIGN_OR_RETURN(uint64_t bits, reader->ReadFixed(8));
+      double value;
+      std::memcpy(&value, &bits, sizeof(value));
+      SetNumberValue(value, value_pb);
+      return absl::OkStatus();
+    }
+    case ColumnKind::kFloat32: {
+      ZETASQL_ASSIGN_OR_RETURN(uint64_t bits, reader->ReadFixed(4));
+      uint32_t bits32 = static_cast<uint32_t>(bits);
+      float value;
+      std::memcpy(&value, &bits32, sizeof(value));
+      SetNumberValue(static_cast<double>(value), value_pb);
+      return absl::OkStatus();
+    }
+    case ColumnKind::kString: {
+      ZETASQL_ASSIGN_OR_RETURN(absl::string_view value,
+                       reader->ReadLengthPrefixed());
+      value_pb->set_string_value(value);
+      return absl::OkStatus();
+    }
+    case ColumnKind::kBytes: {
+      ZETASQL_ASSIGN_OR_RETURN(absl::string_view value,
+                       reader->ReadLengthPrefixed());
+      absl::Base64Escape(value, value_pb->mutable_string_value());
+      return absl::OkStatus();
+    }
+    case ColumnKind::kValue: {
+      ZETASQL_ASSIGN_OR_RETURN(absl::string_view value,
+                       reader->ReadLengthPrefixed());
+      if (!value_pb->ParseFromArray(value.data(), value.size())) {
+        return error::InvalidColumnarBatch("malformed value");
+      }
+      return absl::OkStatus();
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+ColumnarBatchEncoder::ColumnarBatchEncoder(
+    const std::vector<const zetasql::Type*>& column_types) {
+  columns_.reserve(column_types.size());
+  for (const zetasql::Type* type : column_types) {
+    columns_.push_back(Column{ColumnKindForType(type), {}, {}});
+  }
+}
+
+absl::Status ColumnarBatchEncoder::AddRow(const backend::RowCursor& cursor) {
+  row_.clear();
+  for (int i = 0; i < columns_.size(); ++i) {
+    row_.push_back(cursor.ColumnValue(i));
+  }
+  return AddRow(row_);
+}
+
+absl::Status ColumnarBatchEncoder::AddRow(
+    absl::Span<const zetasql::Value> row) {
+  ZETASQL_RET_CHECK_EQ(row.size(), columns_.size());
+  const int bit = num_rows_ % 8;
+  for (int i = 0; i < columns_.size(); ++i) {
+    Column& column = columns_[i];
+    if (bit == 0) {
+      column.null_bitmap.push_back('\0');
+      ++size_;
+    }
+    const zetasql::Value& value = row[i];
+    if (!value.is_valid()) {
+      return error::Internal(
+          "Uninitialized ZetaSQL value passed to ColumnarBatchEncoder");
+    }
+    if (value.is_null()) {
+      column.null_bitmap.back() |= static_cast<char>(1 << bit);
+      continue;
+    }
+    const int64_t old_size = column.values.size();
+    switch (column.kind) {
+      case ColumnKind::kBool:
+        column.values.push_back(value.bool_value() ? 1 : 0);
+        break;
+      case ColumnKind::kInt64: {
+        const int64_t n = value.int64_value();
+        AppendVarint((static_cast<uint64_t>(n) << 1) ^
+                         static_cast<uint64_t>(n >> 63),
+                     &column.values);
+        break;
+      }
+      case ColumnKind::kFloat64: {
+        const double f = value.double_value();
+        uint64_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        AppendFixed(bits, 8, &column.values);
+        break;
+      }
+      case ColumnKind::kFloat32: {
+        const float f = value.float_value();
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        AppendFixed(bits, 4, &column.values);
+        break;
+      }
+      case ColumnKind::kBytes:
+        AppendLengthPrefixed(value.bytes_value(), &column.values);
+        break;
+      case ColumnKind::kString: {
+        if (value.type()->IsString()) {
+          AppendLengthPrefixed(value.string_value(), &column.values);
+          break;
+        }
+        google::protobuf::Value value_pb;
+        ZETASQL_RETURN_IF_ERROR(ValueToProto(value, &value_pb));
+        if (value_pb.kind_case() != google::protobuf::Value::kStringValue) {
+          return error::Internal(absl::StrCat(
+              "Value ", value.DebugString(),
+              " is not encoded as a string by ValueToProto"));
+        }
+        AppendLengthPrefixed(value_pb.string_value(), &column.values);
+        break;
+      }
+      case ColumnKind::kValue: {
+        google::protobuf::Value value_pb;
+        ZETASQL_RETURN_IF_ERROR(ValueToProto(value, &value_pb));
+        AppendLengthPrefixed(value_pb.SerializeAsString(), &column.values);
+        break;
+      }
+    }
+    size_ += column.values.size() - old_size;
+  }
+  ++num_rows_;
+  return absl::OkStatus();
+}
+
+std::string ColumnarBatchEncoder::Finish() {
+  std::string batch;
+  batch.reserve(size_ + 10 * (2 + 2 * columns_.size()));
+  AppendVarint(num_rows_, &batch);
+  AppendVarint(columns_.size(), &batch);
+  for (Column& column : columns_) {
+    batch.push_back(static_cast<char>(column.kind));
+    AppendVarint(column.null_bitmap.size() + column.values.size(), &batch);
+    batch.append(column.null_bitmap);
+    batch.append(column.values);
+    column.null_bitmap.clear();
+    column.values.clear();
+  }
+  num_rows_ = 0;
+  size_ = 0;
+  return batch;
+}
+
+absl::StatusOr<std::vector<std::vector<google::protobuf::Value>>>
+DecodeColumnarBatch(absl::string_view batch) {
+  BatchReader reader(batch);
+  ZETASQL_ASSIGN_OR_RETURN(uint64_t num_rows, reader.ReadVarint());
+  ZETASQL_ASSIGN_OR_RETURN(uint64_t num_columns, reader.ReadVarint());
+  // Every row takes at least one bit of each column's null bitmap.
+  if (num_columns > 0 && num_rows > 8 * batch.size()) {
+    return error::InvalidColumnarBatch("too many rows");
+  }
+  std::vector<std::vector<google::protobuf::Value>> rows(num_rows);
+  for (uint64_t i = 0; i < num_columns; ++i) {
+    ZETASQL_ASSIGN_OR_RETURN(uint64_t kind, reader.ReadFixed(1));
+    if (kind < static_cast<uint64_t>(ColumnKind::kBool) ||
+        kind > static_cast<uint64_t>(ColumnKind::kValue)) {
+      return error::InvalidColumnarBatch(
+          absl::StrCat("unknown column kind ", kind));
+    }
+    ZETASQL_ASSIGN_OR_RETURN(absl::string_view column,
+                     reader.ReadLengthPrefixed());
+    BatchReader column_reader(column);
+    ZETASQL_ASSIGN_OR_RETURN(absl::string_view null_bitmap,
+                     column_reader.ReadBytes((num_rows + 7) / 8));
+    for (uint64_t row = 0; row < num_rows; ++row) {
+      google::protobuf::Value* value_pb = &rows[row].emplace_back();
+      if (null_bitmap[row / 8] & (1 << (row % 8))) {
+        value_pb->set_null_value(google::protobuf::NullValue());
+        continue;
+      }
+      ZETASQL_RETURN_IF_ERROR(
+          DecodeValue(static_cast<ColumnKind>(kind), &column_reader, value_pb));
+    }
+    if (!column_reader.empty()) {
+      return error::InvalidColumnarBatch("unexpected data after column");
+    }
+  }
+  if (!reader.empty()) {
+    return error::InvalidColumnarBatch("unexpected data after last column");
+  }
+  return rows;
+}
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
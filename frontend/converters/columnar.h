@@ -0,0 +1,124 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_COLUMNAR_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_COLUMNAR_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/struct.pb.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "backend/access/read.h"
+#include "absl/status/status.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// Encodes rows of a result column by column into a compact binary batch.
+//
+// This is an emulator-specific result encoding which clients can opt into for
+// large scans (see kResultEncodingHeader in common/constants.h). Values of
+// fixed-width and string types are packed back to back per column instead of
+// being wrapped in one google.protobuf.Value message each. A batch has the
+// following layout, where varints use the protobuf base 128 encoding:
+//
+//   batch  := varint(num_rows) varint(num_columns) column*
+//   column := kind:byte varint(size) null_bitmap value*
+//
+// `size` is the number of bytes of the null bitmap and the values, so that
+// readers can skip columns. Bit i of the null bitmap (least significant bit
+// first, ceil(num_rows / 8) bytes) is set if the value of row i is NULL, and
+// there is one value for each non-NULL row, encoded according to the column
+// kind:
+//
+//   kBool:    one byte, 0 or 1.
+//   kInt64:   zigzag varint.
+//   kFloat64: 8 bytes, little-endian IEEE 754.
+//   kFloat32: 4 bytes, little-endian IEEE 754.
+//   kString:  varint(length) followed by the string_value of the value's
+//             standard encoding (used for all types encoded as strings, such
+//             as STRING, TIMESTAMP, DATE, NUMERIC and JSON).
+//   kBytes:   varint(length) followed by the raw bytes. The standard encoding
+//             is their base64 encoding.
+//   kValue:   varint(length) followed by the serialized google.protobuf.Value
+//             of the standard encoding (used for ARRAY and STRUCT).
+class ColumnarBatchEncoder {
+ public:
+  enum class ColumnKind : uint8_t {
+    kBool = 1,
+    kInt64 = 2,
+    kFloat64 = 3,
+    kFloat32 = 4,
+    kString = 5,
+    kBytes = 6,
+    kValue = 7,
+  };
+
+  explicit ColumnarBatchEncoder(
+      const std::vector<const zetasql::Type*>& column_types);
+
+  // Adds the current row of `cursor`, which has the column types this encoder
+  // was created with.
+  absl::Status AddRow(const backend::RowCursor& cursor);
+
+  // Adds a row with the values `row`, which have the column types this encoder
+  // was created with.
+  absl::Status AddRow(absl::Span<const zetasql::Value> row);
+
+  // Returns the number of rows added since the last call to Finish.
+  int64_t num_rows() const { return num_rows_; }
+
+  // Returns the size of the batch built so far, in bytes, not counting the
+  // batch and column headers.
+  int64_t size() const { return size_; }
+
+  // Returns the encoded batch of the rows added since the last call to Finish
+  // and resets the encoder.
+  std::string Finish();
+
+ private:
+  struct Column {
+    ColumnKind kind;
+    std::string null_bitmap;
+    std::string values;
+  };
+
+  std::vector<Column> columns_;
+  std::vector<zetasql::Value> row_;
+  int64_t num_rows_ = 0;
+  int64_t size_ = 0;
+};
+
+// Decodes a batch produced by ColumnarBatchEncoder into rows of values, in the
+// standard encoding that ValueToProto would have produced for them.
+absl::StatusOr<std::vector<std::vector<google::protobuf::Value>>>
+DecodeColumnarBatch(absl::string_view batch);
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_COLUMNAR_H_
@@ -0,0 +1,157 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "frontend/converters/columnar.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/struct.pb.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "tests/common/proto_matchers.h"
+#include "frontend/converters/values.h"
+#include "tests/common/row_cursor.h"
+#include "absl/status/status.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+namespace {
+
+using ::google::spanner::emulator::test::TestRowCursor;
+using zetasql::Value;
+using zetasql::types::BoolType;
+using zetasql::types::BytesType;
+using zetasql::types::DoubleType;
+using zetasql::types::FloatType;
+using zetasql::types::Int64ArrayType;
+using zetasql::types::Int64Type;
+using zetasql::types::StringType;
+using zetasql::types::TimestampType;
+using zetasql_base::testing::StatusIs;
+
+std::vector<const zetasql::Type*> AllColumnKindTypes() {
+  return {BoolType(),   Int64Type(),     DoubleType(),   FloatType(),
+          StringType(), TimestampType(), BytesType(),    Int64ArrayType()};
+}
+
+// Encodes all rows of `cursor` into a single batch.
+std::string EncodeRows(TestRowCursor* cursor,
+                       const std::vector<const zetasql::Type*>& types) {
+  ColumnarBatchEncoder encoder(types);
+  while (cursor->Next()) {
+    ZETASQL_EXPECT_OK(encoder.AddRow(*cursor));
+  }
+  return encoder.Finish();
+}
+
+TEST(ColumnarBatchTest, DecodesToTheStandardEncodingOfValues) {
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < 20; ++i) {
+    if (i % 3 == 0) {
+      rows.push_back({Value::NullBool(), Value::NullInt64(),
+                      Value::NullDouble(), Value::NullFloat(),
+                      Value::NullString(), Value::NullTimestamp(),
+                      Value::NullBytes(), Value::Null(Int64ArrayType())});
+      continue;
+    }
+    rows.push_back(
+        {Value::Bool(i % 2 == 0),
+         Value::Int64(i % 2 == 0 ? i : -(int64_t{i} << 40)),
+         Value::Double(i == 1 ? std::numeric_limits<double>::quiet_NaN()
+                              : i / 4.0),
+         Value::Float(i == 1 ? -std::numeric_limits<float>::infinity()
+                             : i / 8.0f),
+         Value::String(std::string(i, 'a')),
+         Value::TimestampFromUnixMicros(i * 1000001),
+         Value::Bytes(std::string(i, '\xff')),
+         zetasql::values::Int64Array({i, i + 1})});
+  }
+  TestRowCursor cursor(
+      {"bool", "int64", "double", "float", "string", "timestamp", "bytes",
+       "array"},
+      AllColumnKindTypes(), rows);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto decoded,
+                       DecodeColumnarBatch(EncodeRows(&cursor,
+                                                      AllColumnKindTypes())));
+
+  ASSERT_EQ(decoded.size(), rows.size());
+  for (int i = 0; i < rows.size(); ++i) {
+    ASSERT_EQ(decoded[i].size(), rows[i].size());
+    for (int j = 0; j < rows[i].size(); ++j) {
+      ZETASQL_ASSERT_OK_AND_ASSIGN(google::protobuf::Value expected,
+                           ValueToProto(rows[i][j]));
+      EXPECT_THAT(decoded[i][j], test::EqualsProto(expected))
+          << "row " << i << ", column " << j;
+    }
+  }
+}
+
+TEST(ColumnarBatchTest, FinishStartsANewBatch) {
+  TestRowCursor cursor({"int64"}, {Int64Type()},
+                       {{Value::Int64(1)}, {Value::Int64(2)}});
+  ColumnarBatchEncoder encoder({Int64Type()});
+
+  ASSERT_TRUE(cursor.Next());
+  ZETASQL_ASSERT_OK(encoder.AddRow(cursor));
+  EXPECT_EQ(encoder.num_rows(), 1);
+  EXPECT_GT(encoder.size(), 0);
+  std::string first = encoder.Finish();
+  EXPECT_EQ(encoder.num_rows(), 0);
+  EXPECT_EQ(encoder.size(), 0);
+  ASSERT_TRUE(cursor.Next());
+  ZETASQL_ASSERT_OK(encoder.AddRow(cursor));
+  std::string second = encoder.Finish();
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto first_rows, DecodeColumnarBatch(first));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto second_rows, DecodeColumnarBatch(second));
+  ASSERT_EQ(first_rows.size(), 1);
+  ASSERT_EQ(second_rows.size(), 1);
+  EXPECT_THAT(first_rows[0][0], test::EqualsProto(R"pb(string_value: "1")pb"));
+  EXPECT_THAT(second_rows[0][0],
+              test::EqualsProto(R"pb(string_value: "2")pb"));
+}
+
+TEST(ColumnarBatchTest, RejectsMalformedBatches) {
+  TestRowCursor cursor({"string"}, {StringType()},
+                       {{Value::String("abc")}, {Value::String("def")}});
+  std::string batch = EncodeRows(&cursor, {StringType()});
+
+  EXPECT_THAT(DecodeColumnarBatch(batch.substr(0, batch.size() - 1)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(DecodeColumnarBatch(batch + "x"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  batch[2] = 42;  // Column kind.
+  EXPECT_THAT(DecodeColumnarBatch(batch),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -17,7 +17,11 @@
 #include "frontend/converters/mutations.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <thread>  // NOLINT
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -26,7 +30,9 @@
 #include "google/spanner/v1/result_set.pb.h"
 #include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "backend/access/write.h"
 #include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
@@ -50,49 +56,83 @@ namespace spanner_api = ::google::spanner::v1;
 
 namespace {
 
-absl::Status WriteFromProto(const backend::Schema& schema,
-                            const spanner_api::Mutation::Write& write_pb,
-                            backend::MutationOpType op_type,
-                            backend::Mutation* mutation) {
+// Minimum number of rows in a request for them to be decoded in parallel.
+constexpr int kMinRowsForParallelDecoding = 4096;
+
+// Number of rows decoded by a thread at a time.
+constexpr int kRowsPerDecodingChunk = 1024;
+
+// Maximum number of threads decoding the rows of a request.
+constexpr int kMaxDecodingThreads = 4;
+
+// A Write mutation whose table and columns have been resolved against the
+// schema, but whose rows are yet to be decoded.
+struct ResolvedWrite {
+  const backend::Table* table;
+  std::vector<const backend::Column*> columns;
+  std::vector<std::string> column_names;
+};
+
+absl::StatusOr<ResolvedWrite> ResolveWrite(
+    const backend::Schema& schema,
+    const spanner_api::Mutation::Write& write_pb) {
   if (write_pb.table().empty()) {
     return error::MutationTableRequired();
   }
-  const backend::Table* table = schema.FindTable(write_pb.table());
-  if (table == nullptr) {
+  ResolvedWrite write;
+  write.table = schema.FindTable(write_pb.table());
+  if (write.table == nullptr) {
     return error::TableNotFound(write_pb.table());
   }
 
   // Check that columns exist within table and get the column names.
-  std::vector<const backend::Column*> columns(write_pb.columns_size());
-  std::vector<std::string> column_names(write_pb.columns_size());
+  write.columns.resize(write_pb.columns_size());
+  write.column_names.resize(write_pb.columns_size());
   for (int i = 0; i < write_pb.columns_size(); ++i) {
-    columns[i] = table->FindColumn(write_pb.columns(i));
-    if (columns[i] == nullptr) {
+    write.columns[i] = write.table->FindColumn(write_pb.columns(i));
+    if (write.columns[i] == nullptr) {
       return error::ColumnNotFound(write_pb.table(), write_pb.columns(i));
     }
-    column_names[i] = columns[i]->Name();
+    write.column_names[i] = write.columns[i]->Name();
   }
 
   if (write_pb.values_size() == 0) {
     return error::MissingRequiredFieldError("Write.values");
   }
+  return write;
+}
+
+// Decodes the values of a single row written to `columns`.
+absl::Status RowFromProto(const google::protobuf::ListValue& values,
+                          absl::Span<const backend::Column* const> columns,
+                          backend::ValueList* row_values) {
+  if (values.values_size() != columns.size()) {
+    return error::MutationColumnAndValueSizeMismatch(columns.size(),
+                                                     values.values_size());
+  }
+  row_values->reserve(columns.size());
+  for (int i = 0; i < columns.size(); ++i) {
+    ZETASQL_ASSIGN_OR_RETURN(row_values->emplace_back(),
+                     ValueFromProto(values.values(i), columns[i]->GetType()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status WriteFromProto(const backend::Schema& schema,
+                            const spanner_api::Mutation::Write& write_pb,
+                            backend::MutationOpType op_type,
+                            backend::Mutation* mutation) {
+  ZETASQL_ASSIGN_OR_RETURN(ResolvedWrite write, ResolveWrite(schema, write_pb));
 
   // Populate the list of values for the rows that will be written to.
-  std::vector<backend::ValueList> value_list;
-  for (const google::protobuf::ListValue& values : write_pb.values()) {
-    backend::ValueList row_values;
-    if (values.values_size() != columns.size()) {
-      return error::MutationColumnAndValueSizeMismatch(columns.size(),
-                                                       values.values_size());
-    }
-    for (int i = 0; i < columns.size(); ++i) {
-      ZETASQL_ASSIGN_OR_RETURN(row_values.emplace_back(),
-                       ValueFromProto(values.values(i), columns[i]->GetType()));
-    }
-    value_list.push_back(std::move(row_values));
+  std::vector<backend::ValueList> value_list(write_pb.values_size());
+  for (int i = 0; i < write_pb.values_size(); ++i) {
+    ZETASQL_RETURN_IF_ERROR(
+        RowFromProto(write_pb.values(i), write.columns, &value_list[i]));
   }
-  mutation->AddWriteOp(op_type, table->Name(), std::move(column_names),
-                       std::move(value_list));
+  mutation->AddWriteOp(op_type, write.table->Name(),
+                       std::move(write.column_names), std::move(value_list),
+                       std::move(write.columns));
   return absl::OkStatus();
 }
 
@@ -152,13 +192,149 @@ absl::Status DeleteFromProto(const backend::Schema& schema,
   return absl::OkStatus();
 }
 
+// Returns the Write of the given mutation along with its type, or nullptr if
+// it is not an Insert, Update, InsertOrUpdate or Replace.
+std::pair<const spanner_api::Mutation::Write*, backend::MutationOpType>
+GetWrite(const spanner_api::Mutation& mutation_pb) {
+  switch (mutation_pb.operation_case()) {
+    case spanner_api::Mutation::kInsert:
+      return {&mutation_pb.insert(), backend::MutationOpType::kInsert};
+    case spanner_api::Mutation::kUpdate:
+      return {&mutation_pb.update(), backend::MutationOpType::kUpdate};
+    case spanner_api::Mutation::kInsertOrUpdate:
+      return {&mutation_pb.insert_or_update(),
+              backend::MutationOpType::kInsertOrUpdate};
+    case spanner_api::Mutation::kReplace:
+      return {&mutation_pb.replace(), backend::MutationOpType::kReplace};
+    default:
+      return {nullptr, backend::MutationOpType::kDelete};
+  }
+}
+
+// Converts the mutations like MutationFromProto does, but decodes their rows
+// on multiple threads. Tables, columns and deletes are resolved sequentially
+// first. As with sequential decoding, the error returned is that of the first
+// invalid mutation or row in request order, and the ops are added to
+// `mutation` in request order.
+absl::Status ParallelMutationFromProto(
+    const backend::Schema& schema,
+    const google::protobuf::RepeatedPtrField<spanner_api::Mutation>& mutation_pbs,
+    backend::Mutation* mutation) {
+  // A mutation of the request. The rows of a write are decoded into `rows`,
+  // a delete is converted into `delete_op`.
+  struct Op {
+    const spanner_api::Mutation::Write* write_pb = nullptr;
+    backend::MutationOpType type;
+    ResolvedWrite write;
+    std::vector<backend::ValueList> rows;
+    backend::Mutation delete_op;
+  };
+  // A range of rows of a write decoded by a single thread.
+  struct Chunk {
+    int op;
+    int begin;
+    int end;
+  };
+
+  std::vector<Op> ops;
+  ops.reserve(mutation_pbs.size());
+  std::vector<Chunk> chunks;
+  absl::Status resolve_status;
+  for (const spanner_api::Mutation& mutation_pb : mutation_pbs) {
+    Op& op = ops.emplace_back();
+    if (mutation_pb.operation_case() == spanner_api::Mutation::kDelete) {
+      op.type = backend::MutationOpType::kDelete;
+      resolve_status =
+          DeleteFromProto(schema, mutation_pb.delete_(), &op.delete_op);
+    } else if (mutation_pb.operation_case() ==
+               spanner_api::Mutation::OPERATION_NOT_SET) {
+      resolve_status = error::MissingRequiredFieldError("Mutation.operation");
+    } else {
+      std::tie(op.write_pb, op.type) = GetWrite(mutation_pb);
+      absl::StatusOr<ResolvedWrite> write = ResolveWrite(schema, *op.write_pb);
+      resolve_status = write.status();
+      if (write.ok()) {
+        op.write = *std::move(write);
+        op.rows.resize(op.write_pb->values_size());
+        for (int begin = 0; begin < op.rows.size();
+             begin += kRowsPerDecodingChunk) {
+          chunks.push_back(Chunk{
+              .op = static_cast<int>(ops.size()) - 1,
+              .begin = begin,
+              .end = std::min<int>(begin + kRowsPerDecodingChunk,
+                                   op.rows.size())});
+        }
+      }
+    }
+    // The rows of the mutations before an invalid one are still decoded, since
+    // an invalid row among them takes precedence.
+    if (!resolve_status.ok()) {
+      break;
+    }
+  }
+
+  // Each chunk decodes into its own rows and records its own status, so that
+  // the first failing chunk in request order can be reported.
+  std::vector<absl::Status> chunk_statuses(chunks.size());
+  std::atomic<int> next_chunk = 0;
+  auto decode_chunks = [&]() {
+    for (int c = next_chunk++; c < chunks.size(); c = next_chunk++) {
+      const Chunk& chunk = chunks[c];
+      Op& op = ops[chunk.op];
+      for (int i = chunk.begin; i < chunk.end && chunk_statuses[c].ok(); ++i) {
+        chunk_statuses[c] =
+            RowFromProto(op.write_pb->values(i), op.write.columns, &op.rows[i]);
+      }
+    }
+  };
+  // The calling thread decodes chunks too.
+  const int num_threads = std::min<int>(chunks.size(), kMaxDecodingThreads);
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(decode_chunks);
+  }
+  decode_chunks();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (const absl::Status& status : chunk_statuses) {
+    ZETASQL_RETURN_IF_ERROR(status);
+  }
+  ZETASQL_RETURN_IF_ERROR(resolve_status);
+
+  for (Op& op : ops) {
+    if (op.type == backend::MutationOpType::kDelete) {
+      for (const backend::MutationOp& delete_op : op.delete_op.ops()) {
+        mutation->AddDeleteOp(delete_op.table, delete_op.key_set);
+      }
+      continue;
+    }
+    mutation->AddWriteOp(op.type, op.write.table->Name(),
+                         std::move(op.write.column_names), std::move(op.rows),
+                         std::move(op.write.columns));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::Status MutationFromProto(
     const backend::Schema& schema,
     const google::protobuf::RepeatedPtrField<spanner_api::Mutation>& mutation_pbs,
     backend::Mutation* mutation) {
+  // Requests with many rows are decoded in parallel. Deletes are counted as a
+  // single row.
+  int64_t num_rows = 0;
+  for (const spanner_api::Mutation& mutation_pb : mutation_pbs) {
+    const spanner_api::Mutation::Write* write_pb = GetWrite(mutation_pb).first;
+    num_rows += write_pb == nullptr ? 1 : write_pb->values_size();
+  }
+  if (num_rows >= kMinRowsForParallelDecoding) {
+    return ParallelMutationFromProto(schema, mutation_pbs, mutation);
+  }
+
   for (const spanner_api::Mutation& mutation_pb : mutation_pbs) {
+
     switch (mutation_pb.operation_case()) {
       case spanner_api::Mutation::kInsert:
         ZETASQL_RETURN_IF_ERROR(WriteFromProto(schema, mutation_pb.insert(),
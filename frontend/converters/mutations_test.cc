@@ -28,6 +28,7 @@
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "backend/access/write.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/datamodel/key_set.h"
@@ -174,6 +175,66 @@ TEST_F(AccessProtosTest, CannotCreateMutationFromInvalidProto) {
               StatusIs(absl::StatusCode::kNotFound));
 }
 
+TEST_F(AccessProtosTest, CanCreateMutationWithManyRowsFromProto) {
+  // Enough rows for them to be decoded in parallel chunks.
+  constexpr int kNumRows = 10000;
+  google::protobuf::RepeatedPtrField<google::spanner::v1::Mutation> mutation_pb;
+  google::spanner::v1::Mutation::Write* insert =
+      mutation_pb.Add()->mutable_insert();
+  insert->set_table("test_table");
+  insert->add_columns("int64_col");
+  insert->add_columns("string_col");
+  for (int i = 0; i < kNumRows; ++i) {
+    google::protobuf::ListValue* row = insert->add_values();
+    row->add_values()->set_string_value(absl::StrCat(i));
+    row->add_values()->set_string_value(absl::StrCat("value", i));
+  }
+  google::spanner::v1::Mutation::Delete delete_mutation = PARSE_TEXT_PROTO(R"(
+    table: "test_table"
+    key_set { keys { values { string_value: "0" } } }
+  )");
+  *mutation_pb.Add()->mutable_delete_() = delete_mutation;
+
+  backend::Mutation mutation;
+  ZETASQL_EXPECT_OK(MutationFromProto(*schema_.get(), mutation_pb, &mutation));
+
+  ASSERT_EQ(mutation.ops().size(), 2);
+  EXPECT_EQ(mutation.ops()[0].type, backend::MutationOpType::kInsert);
+  ASSERT_EQ(mutation.ops()[0].rows.size(), kNumRows);
+  for (int i = 0; i < kNumRows; ++i) {
+    EXPECT_EQ(mutation.ops()[0].rows[i][0], zetasql::values::Int64(i));
+    EXPECT_EQ(mutation.ops()[0].rows[i][1],
+              zetasql::values::String(absl::StrCat("value", i)));
+  }
+  EXPECT_EQ(mutation.ops()[1].type, backend::MutationOpType::kDelete);
+  EXPECT_EQ(mutation.ops()[1].key_set.DebugString(), "Key{Int64(0)}");
+}
+
+TEST_F(AccessProtosTest, ManyRowsReportFirstInvalidRowInRequestOrder) {
+  constexpr int kNumRows = 10000;
+  google::protobuf::RepeatedPtrField<google::spanner::v1::Mutation> mutation_pb;
+  google::spanner::v1::Mutation::Write* insert =
+      mutation_pb.Add()->mutable_insert();
+  insert->set_table("test_table");
+  insert->add_columns("int64_col");
+  for (int i = 0; i < kNumRows; ++i) {
+    insert->add_values()->add_values()->set_string_value(absl::StrCat(i));
+  }
+  // A row with too many values late in the insert, followed by a mutation of
+  // a table which doesn't exist.
+  insert->mutable_values(kNumRows - 10)->add_values()->set_string_value("1");
+  google::spanner::v1::Mutation::Write invalid_table = PARSE_TEXT_PROTO(R"(
+    table: "invalid"
+    columns: "int64_col"
+    values { values { string_value: "123" } }
+  )");
+  *mutation_pb.Add()->mutable_insert() = invalid_table;
+
+  backend::Mutation mutation;
+  EXPECT_THAT(MutationFromProto(*schema_.get(), mutation_pb, &mutation),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 }  // namespace
 
 }  // namespace frontend
@@ -24,7 +24,6 @@
 
 #include "google/spanner/v1/result_set.pb.h"
 #include "google/spanner/v1/type.pb.h"
-#include "zetasql/public/json_value.h"
 #include "zetasql/public/value.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -34,7 +33,6 @@
 #include "common/limits.h"
 #include "frontend/converters/change_streams.h"
 #include "frontend/converters/chunking.h"
-#include "frontend/converters/values.h"
 #include "nlohmann/json.hpp"
 #include "zetasql/base/status_macros.h"
 
@@ -207,23 +205,30 @@ void PopulateFakeResumeTokens(
   }
 }
 
-}  // namespace
+// Appends `change_record` to `result_pb` in the wire form of a JSON value.
+// The serialized JSON is already in the normalized form of a JSON value, so it
+// is not parsed again into one.
+void AddChangeRecordRow(const JSON& change_record,
+                        spanner_api::ResultSet* result_pb) {
+  result_pb->add_rows()->add_values()->set_string_value(change_record.dump());
+}
 
-absl::StatusOr<std::vector<spanner_api::PartialResultSet>>
-ConvertHeartbeatTimestampToJson(absl::Time timestamp,
-                                const std::string& tvf_name,
-                                bool expect_metadata) {
-  spanner_api::ResultSet result_pb;
-  auto* row_pb = result_pb.add_rows();
+// Appends the data change record of the current row of `row_cursor` to
+// `result_pb`.
+void AddDataChangeRecordRow(backend::RowCursor* row_cursor,
+                            spanner_api::ResultSet* result_pb) {
   JSON change_record;
-  change_record[kHeartbeatRecord] = CreateHeartbeatRecord(timestamp);
-  ZETASQL_ASSIGN_OR_RETURN(auto heartbeat_record_json_value,
-                   zetasql::JSONValue::ParseJSONString(change_record.dump()));
-  ZETASQL_ASSIGN_OR_RETURN(*row_pb->add_values(),
-                   ValueToProto(zetasql::Value::Json(
-                       std::move(heartbeat_record_json_value))));
-  ZETASQL_ASSIGN_OR_RETURN(auto responses,
-                   ChunkResultSet(result_pb, limits::kMaxStreamingChunkSize));
+  change_record[kDataChangeRecord] = CreateDataChangeRecord(row_cursor);
+  AddChangeRecordRow(change_record, result_pb);
+}
+
+// Chunks `result_pb` into the partial result sets sent to the client.
+absl::StatusOr<std::vector<spanner_api::PartialResultSet>> ToResponses(
+    spanner_api::ResultSet result_pb, const std::string& tvf_name,
+    bool expect_metadata) {
+  ZETASQL_ASSIGN_OR_RETURN(
+      auto responses,
+      ChunkResultSet(std::move(result_pb), limits::kMaxStreamingChunkSize));
   if (expect_metadata) {
     ZETASQL_RETURN_IF_ERROR(PopulateMetadata(&responses, tvf_name));
   } else {
@@ -233,6 +238,19 @@ ConvertHeartbeatTimestampToJson(absl::Time timestamp,
   return responses;
 }
 
+}  // namespace
+
+absl::StatusOr<std::vector<spanner_api::PartialResultSet>>
+ConvertHeartbeatTimestampToJson(absl::Time timestamp,
+                                const std::string& tvf_name,
+                                bool expect_metadata) {
+  spanner_api::ResultSet result_pb;
+  JSON change_record;
+  change_record[kHeartbeatRecord] = CreateHeartbeatRecord(timestamp);
+  AddChangeRecordRow(change_record, &result_pb);
+  return ToResponses(std::move(result_pb), tvf_name, expect_metadata);
+}
+
 absl::StatusOr<std::vector<spanner_api::PartialResultSet>>
 ConvertPartitionTableRowCursorToJson(
     backend::RowCursor* row_cursor,
@@ -241,27 +259,13 @@ ConvertPartitionTableRowCursorToJson(
   spanner_api::ResultSet result_pb;
   int64_t record_sequence = 0;
   while (row_cursor->Next()) {
-    auto* row_pb = result_pb.add_rows();
     JSON change_record;
     change_record[kChildPartitionsRecord] = CreateChildPartitionRecord(
         row_cursor, record_sequence, initial_start_time);
-    ZETASQL_ASSIGN_OR_RETURN(
-        auto child_partitions_record_json_value,
-        zetasql::JSONValue::ParseJSONString(change_record.dump()));
-    ZETASQL_ASSIGN_OR_RETURN(*row_pb->add_values(),
-                     ValueToProto(zetasql::Value::Json(
-                         std::move(child_partitions_record_json_value))));
+    AddChangeRecordRow(change_record, &result_pb);
     record_sequence++;
   }
-  ZETASQL_ASSIGN_OR_RETURN(auto responses,
-                   ChunkResultSet(result_pb, limits::kMaxStreamingChunkSize));
-  if (expect_metadata) {
-    ZETASQL_RETURN_IF_ERROR(PopulateMetadata(&responses, tvf_name));
-  } else {
-    responses.at(0).clear_metadata();
-  }
-  PopulateFakeResumeTokens(&responses);
-  return responses;
+  return ToResponses(std::move(result_pb), tvf_name, expect_metadata);
 }
 
 absl::StatusOr<std::vector<spanner_api::PartialResultSet>>
@@ -270,25 +274,26 @@ ConvertDataTableRowCursorToJson(backend::RowCursor* row_cursor,
                                 bool expect_metadata) {
   spanner_api::ResultSet result_pb;
   while (row_cursor->Next()) {
-    auto* row_pb = result_pb.add_rows();
-    JSON change_record;
-    change_record[kDataChangeRecord] = CreateDataChangeRecord(row_cursor);
-    ZETASQL_ASSIGN_OR_RETURN(
-        auto data_change_record_json_value,
-        zetasql::JSONValue::ParseJSONString(change_record.dump()));
-    ZETASQL_ASSIGN_OR_RETURN(*row_pb->add_values(),
-                     ValueToProto(zetasql::Value::Json(
-                         std::move(data_change_record_json_value))));
+    AddDataChangeRecordRow(row_cursor, &result_pb);
   }
-  ZETASQL_ASSIGN_OR_RETURN(auto responses,
-                   ChunkResultSet(result_pb, limits::kMaxStreamingChunkSize));
-  if (expect_metadata) {
-    ZETASQL_RETURN_IF_ERROR(PopulateMetadata(&responses, tvf_name));
-  } else {
-    responses.at(0).clear_metadata();
+  return ToResponses(std::move(result_pb), tvf_name, expect_metadata);
+}
+
+absl::Status StreamDataTableRowCursorAsJson(
+    backend::RowCursor* row_cursor, const std::string& tvf_name,
+    bool expect_metadata, const ChangeStreamResponseSender& send) {
+  while (row_cursor->Next()) {
+    spanner_api::ResultSet result_pb;
+    AddDataChangeRecordRow(row_cursor, &result_pb);
+    ZETASQL_ASSIGN_OR_RETURN(
+        auto responses,
+        ToResponses(std::move(result_pb), tvf_name, expect_metadata));
+    expect_metadata = false;
+    for (const auto& response : responses) {
+      ZETASQL_RETURN_IF_ERROR(send(response));
+    }
   }
-  PopulateFakeResumeTokens(&responses);
-  return responses;
+  return row_cursor->Status();
 }
 
 }  // namespace frontend
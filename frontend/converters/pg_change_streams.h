@@ -25,6 +25,7 @@
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "backend/access/read.h"
+#include "frontend/converters/change_streams.h"
 #include "nlohmann/json.hpp"
 
 namespace google {
@@ -98,6 +99,13 @@ ConvertDataTableRowCursorToJson(backend::RowCursor* row_cursor,
                                 const std::string& tvf_name,
                                 bool expect_metadata = false);
 
+// Takes a row cursor from data table and streams each row as a data change
+// record partial result set as JSON, as StreamDataTableRowCursorAsStruct does
+// for ARRAY<STRUCT>.
+absl::Status StreamDataTableRowCursorAsJson(
+    backend::RowCursor* row_cursor, const std::string& tvf_name,
+    bool expect_metadata, const ChangeStreamResponseSender& send);
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
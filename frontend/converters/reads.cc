@@ -16,7 +16,13 @@
 
 #include "frontend/converters/reads.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <limits>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "google/protobuf/struct.pb.h"
@@ -25,8 +31,12 @@
 #include "google/spanner/v1/transaction.pb.h"
 #include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
+#include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "backend/access/read.h"
 #include "backend/access/write.h"
 #include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
@@ -39,13 +49,16 @@
 #include "common/errors.h"
 #include "common/limits.h"
 #include "frontend/converters/chunking.h"
+#include "frontend/converters/columnar.h"
 #include "frontend/converters/keys.h"
 #include "frontend/converters/partition.h"
+#include "frontend/converters/resume_token.h"
 #include "frontend/converters/time.h"
 #include "frontend/converters/types.h"
 #include "frontend/converters/values.h"
 #include "frontend/proto/partition_token.pb.h"
 #include "absl/status/status.h"
+#include "zetasql/base/ret_check.h"
 #include "zetasql/base/status_macros.h"
 
 namespace google {
@@ -57,19 +70,6 @@ namespace spanner_api = ::google::spanner::v1;
 
 namespace {
 
-absl::Status ResultSetMetadataToProto(backend::RowCursor* cursor,
-                                      v1::ResultSetMetadata* metadata_pb) {
-  for (int i = 0; i < cursor->NumColumns(); ++i) {
-    auto* field_pb = metadata_pb->mutable_row_type()->add_fields();
-    field_pb->set_name(cursor->ColumnName(i));
-    ZETASQL_RETURN_IF_ERROR(
-        TypeToProto(cursor->ColumnType(i), field_pb->mutable_type()))
-        << " when converting column " << cursor->ColumnName(i) << " of type "
-        << cursor->ColumnType(i) << " at position " << i << " in row cursor";
-  }
-  return absl::OkStatus();
-}
-
 absl::Status ValidateStaleness(absl::Duration staleness) {
   if (staleness < absl::ZeroDuration()) {
     return error::StalenessMustBeNonNegative();
@@ -130,6 +130,15 @@ absl::Status ValidatePartitionToken(
   return absl::OkStatus();
 }
 
+// Returns the number of rows to ask a cursor for in the next batch, once
+// `row_count` of at most `limit` rows (all rows if limit is 0) were read.
+int64_t NextBatchSize(int64_t limit, int64_t row_count) {
+  if (limit <= 0) {
+    return backend::kRowCursorBatchSize;
+  }
+  return std::min(backend::kRowCursorBatchSize, limit - row_count);
+}
+
 }  // namespace
 
 absl::StatusOr<backend::ReadOnlyOptions> ReadOnlyOptionsFromProto(
@@ -193,17 +202,18 @@ absl::Status ReadArgFromProto(const backend::Schema& schema,
     return error::InvalidReadLimitWithPartitionToken();
   }
 
-  auto key_set = request.key_set();
+  std::optional<spanner_api::KeySet> partitioned_key_set;
   if (!request.partition_token().empty()) {
     ZETASQL_ASSIGN_OR_RETURN(auto partition_token,
                      PartitionTokenFromString(request.partition_token()));
     ZETASQL_RETURN_IF_ERROR(ValidatePartitionToken(partition_token, request));
-    key_set = partition_token.partitioned_key_set();
+    partitioned_key_set = partition_token.partitioned_key_set();
   }
 
   read_arg->table = request.table();
   read_arg->index = request.index();
   read_arg->columns.assign(request.columns().begin(), request.columns().end());
+  read_arg->limit = request.limit();
 
   const backend::Table* table = schema.FindTable(request.table());
   if (table == nullptr) {
@@ -217,7 +227,28 @@ absl::Status ReadArgFromProto(const backend::Schema& schema,
     table = index->index_data_table();
   }
 
-  ZETASQL_ASSIGN_OR_RETURN(read_arg->key_set, KeySetFromProto(key_set, *table));
+  ZETASQL_ASSIGN_OR_RETURN(read_arg->key_set,
+                   KeySetFromProto(request.key_set(), *table));
+  if (partitioned_key_set.has_value()) {
+    // A partition only reads the requested keys within its key ranges.
+    ZETASQL_ASSIGN_OR_RETURN(backend::KeySet partition_key_set,
+                     KeySetFromProto(*partitioned_key_set, *table));
+    read_arg->key_set =
+        backend::IntersectKeySets(read_arg->key_set, partition_key_set);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ResultSetMetadataToProto(backend::RowCursor* cursor,
+                                      v1::ResultSetMetadata* metadata_pb) {
+  for (int i = 0; i < cursor->NumColumns(); ++i) {
+    auto* field_pb = metadata_pb->mutable_row_type()->add_fields();
+    field_pb->set_name(cursor->ColumnName(i));
+    ZETASQL_RETURN_IF_ERROR(
+        TypeToProto(cursor->ColumnType(i), field_pb->mutable_type()))
+        << " when converting column " << cursor->ColumnName(i) << " of type "
+        << cursor->ColumnType(i) << " at position " << i << " in row cursor";
+  }
   return absl::OkStatus();
 }
 
@@ -228,26 +259,242 @@ absl::Status RowCursorToResultSetProto(backend::RowCursor* cursor, int limit,
 
   // Iterate over all rows and populate column values into ResultSet.
   int row_count = 0;
-  while (cursor->Next()) {
-    auto* row_pb = result_pb->add_rows();
-    for (int i = 0; i < cursor->NumColumns(); ++i) {
-      ZETASQL_ASSIGN_OR_RETURN(*row_pb->add_values(),
-                       ValueToProto(cursor->ColumnValue(i)));
+  std::vector<std::vector<zetasql::Value>> rows;
+  while ((limit <= 0 || row_count < limit) &&
+         cursor->NextBatch(NextBatchSize(limit, row_count), &rows)) {
+    for (const std::vector<zetasql::Value>& row : rows) {
+      auto* row_pb = result_pb->add_rows();
+      for (const zetasql::Value& value : row) {
+        ZETASQL_RETURN_IF_ERROR(ValueToProto(value, row_pb->add_values()));
+      }
     }
-    ++row_count;
-    if (limit > 0 && limit == row_count) {
-      break;
+    row_count += rows.size();
+  }
+
+  return absl::OkStatus();
+}
+
+namespace {
+
+// Encodes up to `limit` rows of `cursor` (all rows if limit is 0) into
+// `encoder`, calling `on_row` with each row after it is encoded. The
+// `num_skipped_rows` rows which were already read from `cursor` count towards
+// `limit`.
+absl::Status EncodeRowCursor(
+    backend::RowCursor* cursor, int limit, PartialResultSetEncoder* encoder,
+    const std::function<absl::Status(absl::Span<const zetasql::Value>)>&
+        on_row,
+    int64_t num_skipped_rows = 0) {
+  int64_t row_count = num_skipped_rows;
+  std::vector<std::vector<zetasql::Value>> rows;
+  while ((limit <= 0 || row_count < limit) &&
+         cursor->NextBatch(NextBatchSize(limit, row_count), &rows)) {
+    for (const std::vector<zetasql::Value>& row : rows) {
+      for (const zetasql::Value& value : row) {
+        google::protobuf::Value value_pb;
+        ZETASQL_RETURN_IF_ERROR(ValueToProto(value, &value_pb));
+        ZETASQL_RETURN_IF_ERROR(encoder->AddValue(&value_pb));
+      }
+      ZETASQL_RETURN_IF_ERROR(on_row(row));
     }
+    row_count += rows.size();
+  }
+  return cursor->Status();
+}
+
+// Returns `fingerprint` extended with the values `row`.
+uint64_t FingerprintRow(uint64_t fingerprint,
+                        absl::Span<const zetasql::Value> row) {
+  for (const zetasql::Value& value : row) {
+    fingerprint = absl::HashOf(fingerprint, value.HashCode());
   }
+  return fingerprint;
+}
 
+// Advances `cursor` past the rows preceding `resume_from`, and returns an error
+// if they are not the rows `resume_from` was created for.
+absl::Status SkipResumedRows(backend::RowCursor* cursor,
+                             const ResumeToken& resume_from) {
+  int64_t row_count = 0;
+  uint64_t fingerprint = 0;
+  std::vector<std::vector<zetasql::Value>> rows;
+  while (row_count < resume_from.row_count() &&
+         cursor->NextBatch(
+             NextBatchSize(resume_from.row_count(), row_count), &rows)) {
+    for (const std::vector<zetasql::Value>& row : rows) {
+      fingerprint = FingerprintRow(fingerprint, row);
+    }
+    row_count += rows.size();
+  }
+  ZETASQL_RETURN_IF_ERROR(cursor->Status());
+  if (row_count != resume_from.row_count() ||
+      fingerprint != resume_from.rows_fingerprint()) {
+    return error::ResumedResultChanged();
+  }
   return absl::OkStatus();
 }
 
+// Sets resume tokens on the responses of a streamed result which end on a row
+// boundary, i.e. whose completed values add up to whole rows and whose last
+// value is not chunked.
+class ResumeTokenTracker {
+ public:
+  ResumeTokenTracker(const ResumeToken& resume_from, int num_columns)
+      : position_(resume_from),
+        fingerprint_(resume_from.rows_fingerprint()),
+        num_columns_(num_columns) {}
+
+  // Records the values `row` of the next row, after it was encoded.
+  void AddRow(absl::Span<const zetasql::Value> row) {
+    fingerprint_ = FingerprintRow(fingerprint_, row);
+    row_fingerprints_.push_back(fingerprint_);
+  }
+
+  // Sets the resume token of `response`, the next response of the stream, if
+  // it ends on a row boundary.
+  absl::Status SetResumeToken(spanner_api::PartialResultSet* response) {
+    num_values_ += response->values_size();
+    if (response->chunked_value()) {
+      // The last value is completed by the next response.
+      --num_values_;
+    }
+    if (num_columns_ == 0 || response->chunked_value() ||
+        num_values_ % num_columns_ != 0) {
+      return absl::OkStatus();
+    }
+    const int64_t num_rows = num_values_ / num_columns_;
+    if (num_rows > 0) {
+      ZETASQL_RET_CHECK_LE(num_rows, row_fingerprints_.size());
+      position_.set_row_count(position_.row_count() + num_rows);
+      position_.set_rows_fingerprint(row_fingerprints_[num_rows - 1]);
+      row_fingerprints_.erase(row_fingerprints_.begin(),
+                              row_fingerprints_.begin() + num_rows);
+      num_values_ = 0;
+    }
+    ZETASQL_ASSIGN_OR_RETURN(*response->mutable_resume_token(),
+                     ResumeTokenToString(position_));
+    return absl::OkStatus();
+  }
+
+ private:
+  // Position after the last response which ended on a row boundary.
+  ResumeToken position_;
+
+  // Fingerprint of the rows up to the last row added.
+  uint64_t fingerprint_;
+
+  const int num_columns_;
+
+  // Number of values completed by the responses after position_.
+  int64_t num_values_ = 0;
+
+  // Fingerprints of the rows added after position_, one per row.
+  std::deque<uint64_t> row_fingerprints_;
+};
+
+}  // namespace
+
 absl::StatusOr<std::vector<spanner_api::PartialResultSet>>
 RowCursorToPartialResultSetProtos(backend::RowCursor* cursor, int limit) {
-  spanner_api::ResultSet result_set;
-  ZETASQL_RETURN_IF_ERROR(RowCursorToResultSetProto(cursor, limit, &result_set));
-  return ChunkResultSet(result_set, limits::kMaxStreamingChunkSize);
+  spanner_api::ResultSetMetadata metadata;
+  ZETASQL_RETURN_IF_ERROR(ResultSetMetadataToProto(cursor, &metadata));
+  PartialResultSetEncoder encoder(std::move(metadata),
+                                  limits::kMaxStreamingChunkSize);
+  ZETASQL_RETURN_IF_ERROR(EncodeRowCursor(
+      cursor, limit, &encoder,
+      [](absl::Span<const zetasql::Value>) { return absl::OkStatus(); }));
+  return encoder.Finish();
+}
+
+absl::Status StreamRowCursorToPartialResultSetProtos(
+    backend::RowCursor* cursor, int limit, const PartialResultSetSender& send,
+    int64_t max_chunk_size, const ResumeToken* resume_from) {
+  // Rows are encoded directly into PartialResultSets, which are sent as soon
+  // as they are complete. The last completed response is held back so that the
+  // sender can be told which one is last.
+  spanner_api::ResultSetMetadata metadata;
+  ZETASQL_RETURN_IF_ERROR(ResultSetMetadataToProto(cursor, &metadata));
+  PartialResultSetEncoder encoder(std::move(metadata), max_chunk_size);
+  std::optional<ResumeTokenTracker> resume_tokens;
+  int64_t num_skipped_rows = 0;
+  if (resume_from != nullptr) {
+    ZETASQL_RETURN_IF_ERROR(SkipResumedRows(cursor, *resume_from));
+    num_skipped_rows = resume_from->row_count();
+    resume_tokens.emplace(*resume_from, cursor->NumColumns());
+  }
+  std::optional<spanner_api::PartialResultSet> pending;
+  auto send_chunks =
+      [&](std::vector<spanner_api::PartialResultSet> chunks) -> absl::Status {
+    for (auto& chunk : chunks) {
+      if (resume_tokens.has_value()) {
+        ZETASQL_RETURN_IF_ERROR(resume_tokens->SetResumeToken(&chunk));
+      }
+      if (pending.has_value()) {
+        ZETASQL_RETURN_IF_ERROR(send(&*pending, /*is_last=*/false));
+      }
+      pending = std::move(chunk);
+    }
+    return absl::OkStatus();
+  };
+  ZETASQL_RETURN_IF_ERROR(EncodeRowCursor(
+      cursor, limit, &encoder,
+      [&](absl::Span<const zetasql::Value> row) {
+        if (resume_tokens.has_value()) {
+          resume_tokens->AddRow(row);
+        }
+        return send_chunks(encoder.TakeCompleted());
+      },
+      num_skipped_rows));
+  ZETASQL_RETURN_IF_ERROR(send_chunks(encoder.Finish()));
+  return send(&*pending, /*is_last=*/true);
+}
+
+absl::Status StreamRowCursorToColumnarPartialResultSets(
+    backend::RowCursor* cursor, int limit, const PartialResultSetSender& send,
+    int64_t max_chunk_size) {
+  spanner_api::PartialResultSet response;
+  ZETASQL_RETURN_IF_ERROR(
+      ResultSetMetadataToProto(cursor, response.mutable_metadata()));
+  std::vector<const zetasql::Type*> column_types;
+  for (int i = 0; i < cursor->NumColumns(); ++i) {
+    column_types.push_back(cursor->ColumnType(i));
+  }
+  ColumnarBatchEncoder encoder(column_types);
+
+  // Batches grow by a third when base64 encoded.
+  const int64_t max_batch_size = max_chunk_size / 4 * 3;
+  std::optional<spanner_api::PartialResultSet> pending;
+  auto complete_batch = [&]() -> absl::Status {
+    if (pending.has_value()) {
+      ZETASQL_RETURN_IF_ERROR(send(&*pending, /*is_last=*/false));
+    }
+    absl::Base64Escape(encoder.Finish(),
+                       response.add_values()->mutable_string_value());
+    pending = std::move(response);
+    response.Clear();
+    return absl::OkStatus();
+  };
+
+  int row_count = 0;
+  std::vector<std::vector<zetasql::Value>> rows;
+  while ((limit <= 0 || row_count < limit) &&
+         cursor->NextBatch(NextBatchSize(limit, row_count), &rows)) {
+    for (const std::vector<zetasql::Value>& row : rows) {
+      ZETASQL_RETURN_IF_ERROR(encoder.AddRow(row));
+      if (encoder.size() >= max_batch_size) {
+        ZETASQL_RETURN_IF_ERROR(complete_batch());
+      }
+    }
+    row_count += rows.size();
+  }
+  ZETASQL_RETURN_IF_ERROR(cursor->Status());
+  if (encoder.num_rows() > 0) {
+    ZETASQL_RETURN_IF_ERROR(complete_batch());
+  }
+  if (!pending.has_value()) {
+    pending = std::move(response);
+  }
+  return send(&*pending, /*is_last=*/true);
 }
 
 }  // namespace frontend
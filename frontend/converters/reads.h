@@ -17,6 +17,10 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_READS_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_READS_H_
 
+#include <cstdint>
+#include <functional>
+#include <vector>
+
 #include "google/spanner/v1/mutation.pb.h"
 #include "google/spanner/v1/result_set.pb.h"
 #include "google/spanner/v1/spanner.pb.h"
@@ -28,6 +32,8 @@
 #include "backend/common/ids.h"
 #include "backend/schema/catalog/schema.h"
 #include "backend/transaction/options.h"
+#include "common/limits.h"
+#include "frontend/proto/resume_token.pb.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -62,6 +68,51 @@ absl::Status RowCursorToResultSetProto(
 absl::StatusOr<std::vector<google::spanner::v1::PartialResultSet>>
 RowCursorToPartialResultSetProtos(backend::RowCursor* cursor, int limit);
 
+// Callback which sends a single PartialResultSet produced by
+// StreamRowCursorToPartialResultSetProtos. `is_last` is true for the final
+// response of the stream. The sender may modify the response before sending.
+using PartialResultSetSender = std::function<absl::Status(
+    google::spanner::v1::PartialResultSet* response, bool is_last)>;
+
+// Converts a RowCursor to a stream of one or more PartialResultSet protos.
+//
+// Same as RowCursorToPartialResultSetProtos, except that responses are passed
+// to `send` as the cursor is drained instead of being accumulated, so memory
+// usage is bounded by roughly twice max_chunk_size regardless of the size of
+// the result. The first response carries the result set metadata. Rows are
+// encoded directly into the responses, which are chunked the same way as by
+// RowCursorToPartialResultSetProtos. Returns the first error returned by
+// `send`, in which case no further responses are sent.
+//
+// If `resume_from` is set, the responses which end on a row boundary carry a
+// resume token for that position, with the read timestamp of `resume_from`.
+// The stream then starts after the rows preceding `resume_from`, which are
+// skipped without being converted and count towards `limit`, and fails with
+// error::ResumedResultChanged if they differ from the rows it was created for.
+absl::Status StreamRowCursorToPartialResultSetProtos(
+    backend::RowCursor* cursor, int limit, const PartialResultSetSender& send,
+    int64_t max_chunk_size = limits::kMaxStreamingChunkSize,
+    const ResumeToken* resume_from = nullptr);
+
+// Same as StreamRowCursorToPartialResultSetProtos, except that rows are
+// encoded column by column into batches with ColumnarBatchEncoder, for clients
+// which opted into the columnar result encoding.
+//
+// Every response except a metadata-only response for an empty result has
+// exactly one value, whose string_value is the base64 encoding of a batch of
+// whole rows (string values must be valid UTF-8). A batch is completed once its
+// encoding reaches max_chunk_size, so single rows larger than that are sent in
+// a batch of their own instead of being split.
+absl::Status StreamRowCursorToColumnarPartialResultSets(
+    backend::RowCursor* cursor, int limit, const PartialResultSetSender& send,
+    int64_t max_chunk_size = limits::kMaxStreamingChunkSize);
+
+// Converts the column names and types of a RowCursor to a ResultSetMetadata
+// proto.
+absl::Status ResultSetMetadataToProto(
+    backend::RowCursor* cursor,
+    google::spanner::v1::ResultSetMetadata* metadata_pb);
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
@@ -16,7 +16,9 @@
 
 #include "frontend/converters/reads.h"
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "google/spanner/v1/mutation.pb.h"
@@ -29,9 +31,15 @@
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
 #include "absl/status/status.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/datamodel/key_set.h"
 #include "backend/schema/catalog/schema.h"
+#include "frontend/converters/columnar.h"
+#include "frontend/converters/resume_token.h"
+#include "frontend/proto/resume_token.pb.h"
 #include "tests/common/proto_matchers.h"
 #include "tests/common/row_cursor.h"
 #include "tests/common/schema_constructor.h"
@@ -300,6 +308,238 @@ TEST_F(AccessProtosTest, CanConvertRowCursorToPartialResultSetWithLimit) {
                               )"));
 }
 
+TEST_F(AccessProtosTest, StreamsRowCursorAsBoundedPartialResultSets) {
+  constexpr int kNumRows = 40;
+  constexpr int64_t kChunkSize = 32;
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < kNumRows; ++i) {
+    rows.push_back({Bool(i % 2 == 0)});
+  }
+  TestRowCursor cursor({"bool"}, {BoolType()}, rows);
+
+  std::vector<PartialResultSet> results;
+  std::vector<bool> is_last_flags;
+  ZETASQL_ASSERT_OK(StreamRowCursorToPartialResultSetProtos(
+      &cursor, /*limit=*/0,
+      [&](PartialResultSet* response, bool is_last) {
+        results.push_back(*response);
+        is_last_flags.push_back(is_last);
+        return absl::OkStatus();
+      },
+      kChunkSize));
+
+  ASSERT_GT(results.size(), 1);
+  EXPECT_THAT(results[0].metadata(), test::EqualsProto(
+                                         R"(row_type {
+                                              fields {
+                                                name: "bool"
+                                                type { code: BOOL }
+                                              }
+                                            })"));
+  std::vector<bool> values;
+  for (int i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].has_metadata(), i == 0);
+    EXPECT_EQ(is_last_flags[i], i == results.size() - 1);
+    EXPECT_FALSE(results[i].chunked_value());
+    EXPECT_LE(results[i].values_size(), kChunkSize);
+    for (const auto& value : results[i].values()) {
+      values.push_back(value.bool_value());
+    }
+  }
+  ASSERT_EQ(values.size(), kNumRows);
+  for (int i = 0; i < kNumRows; ++i) {
+    EXPECT_EQ(values[i], i % 2 == 0);
+  }
+}
+
+TEST_F(AccessProtosTest, StreamsEmptyRowCursorAsSingleResponse) {
+  TestRowCursor cursor({"bool"}, {BoolType()}, {});
+
+  std::vector<PartialResultSet> results;
+  ZETASQL_ASSERT_OK(StreamRowCursorToPartialResultSetProtos(
+      &cursor, /*limit=*/0, [&](PartialResultSet* response, bool is_last) {
+        EXPECT_TRUE(is_last);
+        results.push_back(*response);
+        return absl::OkStatus();
+      }));
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0], test::EqualsProto(
+                              R"(metadata {
+                                   row_type {
+                                     fields {
+                                       name: "bool"
+                                       type { code: BOOL }
+                                     }
+                                   }
+                                 })"));
+}
+
+TEST_F(AccessProtosTest, StreamsRowCursorAsColumnarBatches) {
+  constexpr int kNumRows = 40;
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < kNumRows; ++i) {
+    rows.push_back({Int64(i)});
+  }
+  TestRowCursor cursor({"int64"}, {Int64Type()}, rows);
+
+  std::vector<PartialResultSet> results;
+  std::vector<bool> is_last_flags;
+  ZETASQL_ASSERT_OK(StreamRowCursorToColumnarPartialResultSets(
+      &cursor, /*limit=*/30,
+      [&](PartialResultSet* response, bool is_last) {
+        results.push_back(*response);
+        is_last_flags.push_back(is_last);
+        return absl::OkStatus();
+      },
+      /*max_chunk_size=*/32));
+
+  ASSERT_GT(results.size(), 1);
+  EXPECT_THAT(results[0].metadata(), test::EqualsProto(
+                                         R"(row_type {
+                                              fields {
+                                                name: "int64"
+                                                type { code: INT64 }
+                                              }
+                                            })"));
+  std::vector<std::string> values;
+  for (int i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].has_metadata(), i == 0);
+    EXPECT_EQ(is_last_flags[i], i == results.size() - 1);
+    ASSERT_EQ(results[i].values_size(), 1);
+    std::string batch;
+    ASSERT_TRUE(
+        absl::Base64Unescape(results[i].values(0).string_value(), &batch));
+    ZETASQL_ASSERT_OK_AND_ASSIGN(auto batch_rows, DecodeColumnarBatch(batch));
+    for (const auto& row : batch_rows) {
+      ASSERT_EQ(row.size(), 1);
+      values.push_back(row[0].string_value());
+    }
+  }
+  ASSERT_EQ(values.size(), 30);
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(values[i], absl::StrCat(i));
+  }
+}
+
+TEST_F(AccessProtosTest, StreamsEmptyRowCursorAsSingleColumnarResponse) {
+  TestRowCursor cursor({"bool"}, {BoolType()}, {});
+
+  std::vector<PartialResultSet> results;
+  ZETASQL_ASSERT_OK(StreamRowCursorToColumnarPartialResultSets(
+      &cursor, /*limit=*/0, [&](PartialResultSet* response, bool is_last) {
+        EXPECT_TRUE(is_last);
+        results.push_back(*response);
+        return absl::OkStatus();
+      }));
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_TRUE(results[0].has_metadata());
+  EXPECT_EQ(results[0].values_size(), 0);
+}
+
+TEST_F(AccessProtosTest, StopsStreamingRowCursorWhenSendFails) {
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < 40; ++i) {
+    rows.push_back({Bool(true)});
+  }
+  TestRowCursor cursor({"bool"}, {BoolType()}, rows);
+
+  int num_sends = 0;
+  EXPECT_THAT(StreamRowCursorToPartialResultSetProtos(
+                  &cursor, /*limit=*/0,
+                  [&](PartialResultSet* response, bool is_last) {
+                    ++num_sends;
+                    return absl::CancelledError("stream closed");
+                  },
+                  /*max_chunk_size=*/32),
+              StatusIs(absl::StatusCode::kCancelled));
+  EXPECT_EQ(num_sends, 1);
+}
+
+// Streams `rows` of an INT64 and a STRING column from `resume_from` into
+// `results`, in responses of at most 32 bytes.
+absl::Status StreamRowsFrom(const std::vector<std::vector<Value>>& rows,
+                            const ResumeToken& resume_from,
+                            std::vector<PartialResultSet>* results) {
+  TestRowCursor cursor({"int64", "string"}, {Int64Type(), StringType()}, rows);
+  return StreamRowCursorToPartialResultSetProtos(
+      &cursor, /*limit=*/0,
+      [&](PartialResultSet* response, bool is_last) {
+        results->push_back(*response);
+        return absl::OkStatus();
+      },
+      /*max_chunk_size=*/32, &resume_from);
+}
+
+// Returns the string values of `results`, with chunked values merged.
+std::vector<std::string> MergeChunkedStrings(
+    absl::Span<const PartialResultSet> results) {
+  std::vector<std::string> values;
+  bool chunked = false;
+  for (const PartialResultSet& result : results) {
+    for (int i = 0; i < result.values_size(); ++i) {
+      if (i == 0 && chunked) {
+        values.back() += result.values(i).string_value();
+      } else {
+        values.push_back(result.values(i).string_value());
+      }
+    }
+    chunked = result.chunked_value();
+  }
+  return values;
+}
+
+TEST_F(AccessProtosTest, ResumesStreamAfterResponsesWithResumeTokens) {
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < 20; ++i) {
+    rows.push_back({Int64(i), String(std::string(i * 5, 'a'))});
+  }
+  std::vector<PartialResultSet> results;
+  ZETASQL_ASSERT_OK(StreamRowsFrom(rows, ResumeToken(), &results));
+  ASSERT_GT(results.size(), 1);
+  EXPECT_FALSE(results.back().resume_token().empty());
+
+  // A stream resumed from a token continues with the values of the responses
+  // after the one carrying the token.
+  int num_resume_tokens = 0;
+  for (int i = 0; i < results.size(); ++i) {
+    if (results[i].resume_token().empty()) {
+      continue;
+    }
+    ++num_resume_tokens;
+    EXPECT_FALSE(results[i].chunked_value());
+    ZETASQL_ASSERT_OK_AND_ASSIGN(ResumeToken resume_from,
+                         ResumeTokenFromString(results[i].resume_token()));
+    std::vector<PartialResultSet> resumed_results;
+    ZETASQL_ASSERT_OK(StreamRowsFrom(rows, resume_from, &resumed_results));
+    EXPECT_TRUE(resumed_results[0].has_metadata());
+    EXPECT_EQ(MergeChunkedStrings(resumed_results),
+              MergeChunkedStrings(absl::MakeSpan(results).subspan(i + 1)));
+  }
+  EXPECT_GT(num_resume_tokens, 1);
+}
+
+TEST_F(AccessProtosTest, ResumingStreamFailsIfSkippedRowsChanged) {
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < 20; ++i) {
+    rows.push_back({Int64(i), String("value")});
+  }
+  std::vector<PartialResultSet> results;
+  ZETASQL_ASSERT_OK(StreamRowsFrom(rows, ResumeToken(), &results));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(ResumeToken resume_from,
+                       ResumeTokenFromString(results.back().resume_token()));
+  ASSERT_EQ(resume_from.row_count(), 20);
+
+  rows[0][1] = String("changed value");
+  std::vector<PartialResultSet> resumed_results;
+  EXPECT_THAT(StreamRowsFrom(rows, resume_from, &resumed_results),
+              StatusIs(absl::StatusCode::kAborted));
+  rows.pop_back();
+  EXPECT_THAT(StreamRowsFrom(rows, resume_from, &resumed_results),
+              StatusIs(absl::StatusCode::kAborted));
+}
+
 TEST_F(AccessProtosTest, CanConvertEmptyRowCursorToResultSet) {
   const zetasql::Type* struct_array;
   ZETASQL_EXPECT_OK(type_factory_->MakeStructTypeFromVector(
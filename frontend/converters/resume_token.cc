@@ -0,0 +1,92 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/converters/resume_token.h"
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/time/time.h"
+#include "common/errors.h"
+#include "frontend/converters/time.h"
+#include "zetasql/base/ret_check.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+namespace spanner_api = ::google::spanner::v1;
+
+absl::StatusOr<std::string> ResumeTokenToString(
+    const ResumeToken& resume_token) {
+  std::string binary_string, token_string;
+  ZETASQL_RET_CHECK(resume_token.SerializeToString(&binary_string))
+      << "Failed to serialize proto: " << resume_token.ShortDebugString();
+  absl::WebSafeBase64Escape(binary_string, &token_string);
+  return token_string;
+}
+
+absl::StatusOr<ResumeToken> ResumeTokenFromString(const std::string& token) {
+  ResumeToken resume_token;
+  if (token.empty()) {
+    return resume_token;
+  }
+  std::string binary_string;
+  if (!absl::WebSafeBase64Unescape(token, &binary_string) ||
+      !resume_token.ParseFromString(binary_string) ||
+      resume_token.row_count() < 0) {
+    return error::InvalidResumeToken();
+  }
+  return resume_token;
+}
+
+spanner_api::TransactionSelector ResumedTransactionSelector(
+    const spanner_api::TransactionSelector& selector,
+    const ResumeToken& resume_token) {
+  spanner_api::TransactionSelector resumed_selector = selector;
+  if (resume_token.has_read_timestamp() && selector.has_single_use() &&
+      selector.single_use().has_read_only()) {
+    *resumed_selector.mutable_single_use()
+         ->mutable_read_only()
+         ->mutable_read_timestamp() = resume_token.read_timestamp();
+  }
+  return resumed_selector;
+}
+
+absl::Status SetResumeTokenReadTimestamp(absl::Time read_timestamp,
+                                         ResumeToken* resume_token) {
+  ZETASQL_ASSIGN_OR_RETURN(google::protobuf::Timestamp read_timestamp_pb,
+                   TimestampToProto(read_timestamp));
+  if (resume_token->has_read_timestamp()) {
+    ZETASQL_ASSIGN_OR_RETURN(absl::Time token_timestamp,
+                     TimestampFromProto(resume_token->read_timestamp()));
+    if (token_timestamp != read_timestamp) {
+      return error::ResumeTokenFromDifferentSnapshot(token_timestamp,
+                                                     read_timestamp);
+    }
+  }
+  *resume_token->mutable_read_timestamp() = read_timestamp_pb;
+  return absl::OkStatus();
+}
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,59 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_RESUME_TOKEN_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_RESUME_TOKEN_H_
+
+#include <string>
+
+#include "google/spanner/v1/transaction.pb.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "frontend/proto/resume_token.pb.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// Converts a resume token into a byte string.
+absl::StatusOr<std::string> ResumeTokenToString(
+    const ResumeToken& resume_token);
+
+// Converts a byte string into a resume token. An empty byte string is the
+// position at the start of a result.
+absl::StatusOr<ResumeToken> ResumeTokenFromString(const std::string& token);
+
+// Returns `selector` with the timestamp bound of a single-use read-only
+// transaction replaced by the snapshot timestamp of `resume_token`, so that a
+// resumed stream reads the same snapshot as the interrupted one.
+google::spanner::v1::TransactionSelector ResumedTransactionSelector(
+    const google::spanner::v1::TransactionSelector& selector,
+    const ResumeToken& resume_token);
+
+// Sets the snapshot timestamp of a stream reading at `read_timestamp` in
+// `resume_token`, or returns an error if the token was created for a stream
+// which read a different snapshot.
+absl::Status SetResumeTokenReadTimestamp(absl::Time read_timestamp,
+                                         ResumeToken* resume_token);
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_CONVERTERS_RESUME_TOKEN_H_
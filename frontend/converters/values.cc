@@ -19,6 +19,7 @@
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,6 +29,7 @@
 #include "zetasql/public/options.pb.h"
 #include "zetasql/public/value.h"
 #include "absl/base/optimization.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/escaping.h"
@@ -87,6 +89,13 @@ static absl::StatusOr<zetasql::Value> CreatePgNumericValueWithMemoryContext(
       numeric_string);
 }
 
+// Formats `value` in decimal directly into the string value of `value_pb`,
+// without a temporary std::string.
+void SetDecimalStringValue(int64_t value, google::protobuf::Value* value_pb) {
+  absl::AlphaNum decimal(value);
+  value_pb->set_string_value(decimal.data(), decimal.size());
+}
+
 static bool IsValidFloat(double value) {
   double float_lower_limit =
       static_cast<double>(std::numeric_limits<float>::lowest());
@@ -377,38 +386,44 @@ absl::StatusOr<zetasql::Value> ValueFromProto(
 
 absl::StatusOr<google::protobuf::Value> ValueToProto(
     const zetasql::Value& value) {
+  google::protobuf::Value value_pb;
+  ZETASQL_RETURN_IF_ERROR(ValueToProto(value, &value_pb));
+  return value_pb;
+}
+
+absl::Status ValueToProto(const zetasql::Value& value,
+                          google::protobuf::Value* value_pb) {
   if (!value.is_valid()) {
     return error::Internal(
         "Uninitialized ZetaSQL value passed to ValueToProto");
   }
 
-  google::protobuf::Value value_pb;
   if (value.is_null()) {
-    value_pb.set_null_value(google::protobuf::NullValue());
-    return value_pb;
+    value_pb->set_null_value(google::protobuf::NullValue());
+    return absl::OkStatus();
   }
 
   switch (value.type_kind()) {
     case zetasql::TypeKind::TYPE_BOOL: {
-      value_pb.set_bool_value(value.bool_value());
+      value_pb->set_bool_value(value.bool_value());
       break;
     }
 
     case zetasql::TypeKind::TYPE_INT64: {
-      value_pb.set_string_value(absl::StrCat(value.int64_value()));
+      SetDecimalStringValue(value.int64_value(), value_pb);
       break;
     }
 
     case zetasql::TypeKind::TYPE_FLOAT: {
       float val = value.float_value();
       if (std::isfinite(val)) {
-        value_pb.set_number_value(static_cast<double>(val));
+        value_pb->set_number_value(static_cast<double>(val));
       } else if (val == std::numeric_limits<float>::infinity()) {
-        value_pb.set_string_value("Infinity");
+        value_pb->set_string_value("Infinity");
       } else if (val == -std::numeric_limits<float>::infinity()) {
-        value_pb.set_string_value("-Infinity");
+        value_pb->set_string_value("-Infinity");
       } else if (std::isnan(val)) {
-        value_pb.set_string_value("NaN");
+        value_pb->set_string_value("NaN");
       } else {
         return error::Internal(absl::StrCat("Unsupported float value ",
                                             value.float_value(),
@@ -420,13 +435,13 @@ absl::StatusOr<google::protobuf::Value> ValueToProto(
     case zetasql::TypeKind::TYPE_DOUBLE: {
       double val = value.double_value();
       if (std::isfinite(val)) {
-        value_pb.set_number_value(val);
+        value_pb->set_number_value(val);
       } else if (val == std::numeric_limits<double>::infinity()) {
-        value_pb.set_string_value("Infinity");
+        value_pb->set_string_value("Infinity");
       } else if (val == -std::numeric_limits<double>::infinity()) {
-        value_pb.set_string_value("-Infinity");
+        value_pb->set_string_value("-Infinity");
       } else if (std::isnan(val)) {
-        value_pb.set_string_value("NaN");
+        value_pb->set_string_value("NaN");
       } else {
         return error::Internal(absl::StrCat("Unsupported double value ",
                                             value.double_value(),
@@ -440,17 +455,17 @@ absl::StatusOr<google::protobuf::Value> ValueToProto(
           static_cast<const SpannerExtendedType*>(value.type())->code();
       switch (type_code) {
         case TypeAnnotationCode::PG_JSONB: {
-          value_pb.set_string_value(
-              std::string(*GetPgJsonbNormalizedValue(value)));
+          absl::CopyCordToString(*GetPgJsonbNormalizedValue(value),
+                                 value_pb->mutable_string_value());
           break;
         }
         case TypeAnnotationCode::PG_NUMERIC: {
-          value_pb.set_string_value(
-              std::string(*GetPgNumericNormalizedValue(value)));
+          absl::CopyCordToString(*GetPgNumericNormalizedValue(value),
+                                 value_pb->mutable_string_value());
           break;
         }
         case TypeAnnotationCode::PG_OID: {
-          value_pb.set_string_value(absl::StrCat(*GetPgOidValue(value)));
+          SetDecimalStringValue(*GetPgOidValue(value), value_pb);
           break;
         }
         default:
@@ -462,10 +477,10 @@ absl::StatusOr<google::protobuf::Value> ValueToProto(
     }
 
     case zetasql::TypeKind::TYPE_TIMESTAMP: {
-      value_pb.set_string_value(
-          absl::StrCat(absl::FormatTime(kRFC3339TimeFormatNoOffset,
-                                        value.ToTime(), absl::UTCTimeZone()),
-                       "Z"));
+      std::string* timestamp_pb = value_pb->mutable_string_value();
+      *timestamp_pb = absl::FormatTime(kRFC3339TimeFormatNoOffset,
+                                       value.ToTime(), absl::UTCTimeZone());
+      timestamp_pb->push_back('Z');
       break;
     }
 
@@ -478,64 +493,70 @@ absl::StatusOr<google::protobuf::Value> ValueToProto(
             "Unsupported date value ", value.DebugString(),
             " passed to ValueToProto. Year must be between 1 and 9999."));
       }
-      absl::StrAppendFormat(value_pb.mutable_string_value(), "%04d-%02d-%02d",
-                            date.year(), date.month(), date.day());
+      std::string* date_pb = value_pb->mutable_string_value();
+      date_pb->clear();
+      absl::StrAppendFormat(date_pb, "%04d-%02d-%02d", date.year(),
+                            date.month(), date.day());
       break;
     }
 
     case zetasql::TypeKind::TYPE_STRING: {
-      value_pb.set_string_value(value.string_value());
+      value_pb->set_string_value(value.string_value());
       break;
     }
 
     case zetasql::TypeKind::TYPE_NUMERIC: {
-      value_pb.set_string_value(value.numeric_value().ToString());
+      std::string* numeric_pb = value_pb->mutable_string_value();
+      numeric_pb->clear();
+      value.numeric_value().AppendToString(numeric_pb);
       break;
     }
 
     case zetasql::TypeKind::TYPE_JSON: {
-      value_pb.set_string_value(value.json_string());
+      value_pb->set_string_value(value.json_string());
       break;
     }
 
     case zetasql::TypeKind::TYPE_BYTES: {
-      absl::Base64Escape(value.bytes_value(), value_pb.mutable_string_value());
+      absl::Base64Escape(value.bytes_value(), value_pb->mutable_string_value());
       break;
     }
 
     case zetasql::TypeKind::TYPE_ENUM: {
-      value_pb.set_string_value(std::to_string(value.enum_value()));
+      SetDecimalStringValue(value.enum_value(), value_pb);
       break;
     }
 
     case zetasql::TypeKind::TYPE_PROTO: {
-      std::string strvalue;
-      absl::CopyCordToString(value.ToCord(), &strvalue);
-      absl::Base64Escape(strvalue, value_pb.mutable_string_value());
+      absl::Cord cord = value.ToCord();
+      if (std::optional<absl::string_view> flat = cord.TryFlat()) {
+        absl::Base64Escape(*flat, value_pb->mutable_string_value());
+      } else {
+        absl::Base64Escape(std::string(cord), value_pb->mutable_string_value());
+      }
       break;
     }
 
     case zetasql::TypeKind::TYPE_ARRAY: {
       google::protobuf::ListValue* list_value_pb =
-          value_pb.mutable_list_value();
+          value_pb->mutable_list_value();
       for (int i = 0; i < value.num_elements(); ++i) {
-        ZETASQL_ASSIGN_OR_RETURN(*list_value_pb->add_values(),
-                         ValueToProto(value.element(i)),
-                         _ << "\nWhen encoding array element #" << i << ": "
-                           << value.element(i).DebugString() << " in "
-                           << value.DebugString());
+        ZETASQL_RETURN_IF_ERROR(
+            ValueToProto(value.element(i), list_value_pb->add_values()))
+            << "\nWhen encoding array element #" << i << ": "
+            << value.element(i).DebugString() << " in " << value.DebugString();
       }
       break;
     }
 
     case zetasql::TypeKind::TYPE_STRUCT: {
       google::protobuf::ListValue* list_value_pb =
-          value_pb.mutable_list_value();
+          value_pb->mutable_list_value();
       for (int i = 0; i < value.num_fields(); ++i) {
-        ZETASQL_ASSIGN_OR_RETURN(
-            *list_value_pb->add_values(), ValueToProto(value.field(i)),
-            _ << "\nWhen encoding struct element #" << i << ": "
-              << value.field(i).DebugString() << " in " << value.DebugString());
+        ZETASQL_RETURN_IF_ERROR(
+            ValueToProto(value.field(i), list_value_pb->add_values()))
+            << "\nWhen encoding struct element #" << i << ": "
+            << value.field(i).DebugString() << " in " << value.DebugString();
       }
       break;
     }
@@ -547,7 +568,7 @@ absl::StatusOr<google::protobuf::Value> ValueToProto(
     }
   }
 
-  return value_pb;
+  return absl::OkStatus();
 }
 
 }  // namespace frontend
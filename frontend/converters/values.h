@@ -47,6 +47,13 @@ absl::StatusOr<zetasql::Value> ValueFromProto(
 absl::StatusOr<google::protobuf::Value> ValueToProto(
     const zetasql::Value& value);
 
+// Same as above, but writes the value proto into `value_pb` instead of
+// returning a new one. Lets callers convert values in place into the messages
+// of an outgoing response, e.g. a newly added element of a ListValue, which
+// may be allocated on an arena. `value_pb` is expected to be empty.
+absl::Status ValueToProto(const zetasql::Value& value,
+                          google::protobuf::Value* value_pb);
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
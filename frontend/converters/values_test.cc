@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "google/protobuf/arena.h"
 #include "zetasql/public/value.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -303,6 +304,14 @@ TEST_F(ValueProtos, ConvertsBasicTypesBetweenValuesAndProtos) {
                          ValueToProto(expected_value));
     EXPECT_THAT(actual_value_pb, test::EqualsProto(expected_value_pb_txt))
         << "When encoding {" << expected_value << "}";
+
+    // Check in place value -> proto conversion into an arena message.
+    google::protobuf::Arena arena;
+    auto* arena_value_pb =
+        google::protobuf::Arena::Create<google::protobuf::Value>(&arena);
+    ZETASQL_ASSERT_OK(ValueToProto(expected_value, arena_value_pb));
+    EXPECT_THAT(*arena_value_pb, test::EqualsProto(expected_value_pb_txt))
+        << "When encoding {" << expected_value << "} in place";
   }
 }
 
@@ -17,12 +17,15 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_DATABASE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_DATABASE_H_
 
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "google/spanner/admin/database/v1/spanner_database_admin.pb.h"
 #include "absl/status/status.h"
 #include "absl/time/time.h"
 #include "backend/database/database.h"
+#include "backend/database/durability.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -38,10 +41,13 @@ namespace frontend {
 // separate module from the frontend and isolate it from gRPC API details.
 class Database {
  public:
-  Database(const std::string& database_uri,
-           std::unique_ptr<backend::Database> backend, absl::Time create_time)
+  Database(
+      const std::string& database_uri,
+      std::unique_ptr<backend::Database> backend, absl::Time create_time,
+      std::unique_ptr<backend::DatabaseCheckpointer> checkpointer = nullptr)
       : database_uri_(database_uri),
         backend_(std::move(backend)),
+        checkpointer_(std::move(checkpointer)),
         create_time_(create_time) {}
 
   // Returns the URI for this database.
@@ -53,6 +59,10 @@ class Database {
   // Converts this database object to its proto representation.
   absl::Status ToProto(admin::database::v1::Database* database);
 
+  // Stops checkpointing a durable database. Must not be called concurrently
+  // with itself.
+  void StopCheckpoints() { checkpointer_.reset(); }
+
  private:
   // The URI for this database.
   const std::string database_uri_;
@@ -60,6 +70,10 @@ class Database {
   // The backend object which implements core database functionality.
   std::unique_ptr<backend::Database> backend_;
 
+  // Checkpoints the backend database if it is durable. Declared after backend_
+  // so that it is stopped before the backend database is destroyed.
+  std::unique_ptr<backend::DatabaseCheckpointer> checkpointer_;
+
   // The time at which this database was created.
   const absl::Time create_time_;
 };
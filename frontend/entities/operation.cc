@@ -49,6 +49,11 @@ void Operation::SetResponse(const google::protobuf::Message& response) {
   status_ = absl::OkStatus();
 }
 
+bool Operation::done() {
+  absl::MutexLock lock(&mu_);
+  return !status_.ok() || response_ != nullptr;
+}
+
 void Operation::ToProto(google::longrunning::Operation* operation_pb) {
   absl::MutexLock lock(&mu_);
 
@@ -54,6 +54,9 @@ class Operation {
   // If an error status was set previously, it will be cleared.
   void SetResponse(const google::protobuf::Message& response) ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Returns true if a response or an error has been set.
+  bool done() ABSL_LOCKS_EXCLUDED(mu_);
+
   // Converts an operation to its proto version.
   void ToProto(google::longrunning::Operation* operation_pb)
       ABSL_LOCKS_EXCLUDED(mu_);
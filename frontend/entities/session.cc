@@ -200,8 +200,7 @@ absl::StatusOr<std::unique_ptr<Transaction>> Session::CreateReadOnly(
       std::unique_ptr<backend::ReadOnlyTransaction> read_only_transaction,
       database_->backend()->CreateReadOnlyTransaction(read_only_options));
   return std::make_unique<Transaction>(std::move(read_only_transaction),
-                                       database_->backend()->query_engine(),
-                                       options, usage);
+                                       database_->backend(), options, usage);
 }
 
 absl::StatusOr<std::unique_ptr<Transaction>> Session::CreateReadWrite(
@@ -214,8 +213,7 @@ absl::StatusOr<std::unique_ptr<Transaction>> Session::CreateReadWrite(
           backend::ReadWriteOptions(), retry_state));
 
   return std::make_unique<Transaction>(std::move(read_write_transaction),
-                                       database_->backend()->query_engine(),
-                                       options, usage);
+                                       database_->backend(), options, usage);
 }
 
 absl::StatusOr<std::shared_ptr<Transaction>> Session::FindAndUseTransaction(
@@ -82,6 +82,9 @@ class Session {
   // Returns the time this session was created.
   absl::Time create_time() const { return create_time_; }
 
+  // Returns the database to which this session is attached.
+  std::shared_ptr<Database> database() const { return database_; }
+
   // Return the time this session was last used.
   absl::Time approximate_last_use_time() const ABSL_LOCKS_EXCLUDED(mu_) {
     absl::MutexLock lock(&mu_);
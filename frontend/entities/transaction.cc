@@ -17,30 +17,43 @@
 #include "frontend/entities/transaction.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 #include <variant>
+#include <vector>
 
+#include "google/protobuf/util/message_differencer.h"
+#include "google/rpc/status.pb.h"
+#include "google/spanner/v1/result_set.pb.h"
 #include "google/spanner/v1/spanner.pb.h"
 #include "zetasql/public/value.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "backend/access/read.h"
 #include "backend/access/write.h"
 #include "backend/common/ids.h"
 #include "backend/common/variant.h"
 #include "backend/database/database.h"
+#include "backend/datamodel/value.h"
+#include "backend/query/query_context.h"
 #include "backend/query/query_engine.h"
+#include "backend/schema/catalog/index.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/table.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/read_write_transaction.h"
 #include "common/constants.h"
 #include "common/errors.h"
+#include "common/tracing.h"
 #include "frontend/converters/time.h"
 #include "frontend/converters/types.h"
 #include "frontend/converters/values.h"
@@ -81,6 +94,128 @@ bool HasPayload(const absl::Status& status, const std::string& url) {
   return status.GetPayload(url).has_value();
 }
 
+// Buffers the rows of consecutive INSERT statements of a batch into the same
+// table and columns, and writes them to the transaction as a single mutation
+// whose rows are processed together. Buffered rows are written before any
+// read, so that statements still read the writes of preceding statements.
+// Rows of tables with unique indexes, foreign keys or check constraints are
+// not coalesced across statements, since those are verified once per write.
+class InsertCoalescingWriter : public backend::RowReader,
+                               public backend::RowWriter {
+ public:
+  InsertCoalescingWriter(backend::ReadWriteTransaction* txn,
+                         const backend::Schema* schema)
+      : txn_(txn), schema_(schema) {}
+
+  // Sets the index of the statement of the batch whose writes follow.
+  void set_statement_index(int index) { statement_index_ = index; }
+
+  absl::Status Read(const backend::ReadArg& read_arg,
+                    std::unique_ptr<backend::RowCursor>* cursor) override {
+    ZETASQL_RETURN_IF_ERROR(Flush());
+    return txn_->Read(read_arg, cursor);
+  }
+
+  absl::Status ReadSplits(
+      const backend::ReadArg& read_arg, int64_t rows_per_split,
+      std::vector<std::unique_ptr<backend::RowCursor>>* cursors) override {
+    ZETASQL_RETURN_IF_ERROR(Flush());
+    return txn_->ReadSplits(read_arg, rows_per_split, cursors);
+  }
+
+  absl::Status Write(const backend::Mutation& mutation) override {
+    if (mutation.ops().size() == 1 &&
+        mutation.ops()[0].type == backend::MutationOpType::kInsert) {
+      const backend::MutationOp& op = mutation.ops()[0];
+      if (buffered_.has_value() &&
+          (buffered_->table != op.table || buffered_->columns != op.columns ||
+           (buffered_statements_.back().first != statement_index_ &&
+            HasStatementVerifiers(op.table)))) {
+        ZETASQL_RETURN_IF_ERROR(Flush());
+      }
+      if (!buffered_.has_value()) {
+        buffered_.emplace(op.type, op.table,
+                          std::vector<std::string>(op.columns),
+                          std::vector<backend::ValueList>());
+      }
+      buffered_->rows.insert(buffered_->rows.end(), op.rows.begin(),
+                             op.rows.end());
+      if (buffered_statements_.empty() ||
+          buffered_statements_.back().first != statement_index_) {
+        buffered_statements_.emplace_back(statement_index_, 0);
+      }
+      buffered_statements_.back().second = buffered_->rows.size();
+      return absl::OkStatus();
+    }
+    ZETASQL_RETURN_IF_ERROR(Flush());
+    return txn_->Write(mutation);
+  }
+
+  // Writes the buffered rows to the transaction.
+  absl::Status Flush() {
+    if (!buffered_.has_value()) {
+      return absl::OkStatus();
+    }
+    backend::Mutation mutation;
+    mutation.AddWriteOp(buffered_->type, buffered_->table,
+                        std::move(buffered_->columns),
+                        std::move(buffered_->rows));
+    buffered_.reset();
+    std::vector<std::pair<int, int64_t>> statements =
+        std::move(buffered_statements_);
+    buffered_statements_.clear();
+    std::optional<int64_t> failed_row;
+    absl::Status status = txn_->Write(mutation, &failed_row);
+    if (!status.ok()) {
+      failed_statement_ = statements.front().first;
+      if (failed_row.has_value()) {
+        for (const auto& [statement, rows_end] : statements) {
+          if (*failed_row < rows_end) {
+            failed_statement_ = statement;
+            break;
+          }
+        }
+      }
+    }
+    return status;
+  }
+
+  // Returns the index of the statement whose buffered rows failed to be
+  // written, if any. A failure which the transaction does not tie to a row,
+  // such as an invalid column, is attributed to the first statement whose
+  // rows were written together.
+  std::optional<int> failed_statement() const { return failed_statement_; }
+
+ private:
+  // Returns true if writes to `table_name` are verified once all rows of a
+  // write are buffered, so that a failure cannot be tied to one of them.
+  bool HasStatementVerifiers(const std::string& table_name) const {
+    const backend::Table* table = schema_->FindTable(table_name);
+    if (table == nullptr) {
+      return false;
+    }
+    if (!table->foreign_keys().empty() ||
+        !table->referencing_foreign_keys().empty() ||
+        !table->check_constraints().empty()) {
+      return true;
+    }
+    for (const backend::Index* index : table->indexes()) {
+      if (index->is_unique()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  backend::ReadWriteTransaction* txn_;
+  const backend::Schema* schema_;
+  std::optional<backend::MutationOp> buffered_;
+  // The statements whose rows are buffered, with the end of their rows.
+  std::vector<std::pair<int, int64_t>> buffered_statements_;
+  int statement_index_ = 0;
+  std::optional<int> failed_statement_;
+};
+
 }  // namespace
 
 using ReadWriteTransactionPtr = std::unique_ptr<backend::ReadWriteTransaction>;
@@ -90,10 +225,11 @@ Transaction::Transaction(
     std::variant<std::unique_ptr<backend::ReadWriteTransaction>,
                  std::unique_ptr<backend::ReadOnlyTransaction>>
         backend_transaction,
-    const backend::QueryEngine* query_engine,
+    backend::Database* database,
     const spanner_api::TransactionOptions& options, const Usage& usage)
     : transaction_(std::move(backend_transaction)),
-      query_engine_(query_engine),
+      database_(database),
+      query_engine_(database->query_engine()),
       usage_type_(usage),
       type_(TypeFromTransactionOptions(options)),
       options_(options) {}
@@ -209,11 +345,12 @@ absl::StatusOr<backend::QueryResult> Transaction::ExecuteSql(
   mu_.AssertHeld();
   switch (type_) {
     case kReadOnly: {
-      return query_engine_->ExecuteSql(
-          query,
-          backend::QueryContext{
-              .schema = schema(), .reader = read_only(), .writer = nullptr},
-          query_mode);
+      backend::QueryContext context{
+          .schema = schema(), .reader = read_only(), .writer = nullptr};
+      if (read_only()->ReadsImmutableSnapshot()) {
+        context.immutable_snapshot_timestamp = read_only()->read_timestamp();
+      }
+      return query_engine_->ExecuteSql(query, context, query_mode);
     }
     case kReadWrite: {
       return query_engine_->ExecuteSql(
@@ -235,14 +372,67 @@ absl::StatusOr<backend::QueryResult> Transaction::ExecuteSql(
           .allow_read_write_only_functions = true};
       ZETASQL_RETURN_IF_ERROR(query_engine_->IsValidPartitionedDML(query, context));
       // PartitionedDml will auto-commit transactions and cannot be reused.
-      ZETASQL_ASSIGN_OR_RETURN(backend::QueryResult result,
-                       query_engine_->ExecuteSql(query, context, query_mode));
+      // Statements are executed in transactions of their own per key range,
+      // except in PLAN and PROFILE modes, whose result describes a single
+      // execution of the statement.
+      backend::QueryResult result;
+      if (query_mode == v1::ExecuteSqlRequest::NORMAL) {
+        ZETASQL_ASSIGN_OR_RETURN(result, database_->ExecutePartitionedDml(query));
+      } else {
+        ZETASQL_ASSIGN_OR_RETURN(result,
+                         query_engine_->ExecuteSql(query, context, query_mode));
+      }
       ZETASQL_RETURN_IF_ERROR(read_write()->Commit());
       return result;
     }
   }
 }
 
+absl::Status Transaction::ExecuteBatchDml(
+    absl::Span<const backend::Query> queries,
+    std::vector<backend::QueryResult>* results) {
+  mu_.AssertHeld();
+  if (type_ != kReadWrite) {
+    for (const backend::Query& query : queries) {
+      ZETASQL_ASSIGN_OR_RETURN(backend::QueryResult result, ExecuteSql(query));
+      results->push_back(std::move(result));
+    }
+    return absl::OkStatus();
+  }
+
+  InsertCoalescingWriter writer(read_write(), schema());
+  const backend::QueryContext context{
+      .schema = schema(),
+      .reader = &writer,
+      .writer = &writer,
+      .commit_timestamp_tracker = read_write()->commit_timestamp_tracker(),
+      .allow_read_write_only_functions = true};
+  absl::Status status;
+  for (int i = 0; i < queries.size(); ++i) {
+    writer.set_statement_index(i);
+    absl::StatusOr<backend::QueryResult> result =
+        query_engine_->ExecuteSql(queries[i], context);
+    if (!result.ok()) {
+      status = result.status();
+      break;
+    }
+    results->push_back(*std::move(result));
+  }
+  // Aborts and constraint errors reset the transaction, so the buffered rows
+  // of the statements preceding such a failure are dropped along with it.
+  if (status.ok() || (!absl::IsAborted(status) &&
+                      !HasPayload(status, kConstraintError))) {
+    absl::Status flushed = writer.Flush();
+    if (!flushed.ok()) {
+      status = flushed;
+    }
+  }
+  if (writer.failed_statement().has_value()) {
+    results->resize(*writer.failed_statement());
+  }
+  return status;
+}
+
 absl::Status Transaction::Write(const backend::Mutation& mutation) {
   mu_.AssertHeld();
   if (type_ == kReadWrite) {
@@ -305,6 +495,76 @@ void Transaction::MaybeInvalidate(const absl::Status& status) {
   }
 }
 
+namespace {
+
+// Rebuilds the ResultSet of an ExecuteSql DML request or the response of an
+// ExecuteBatchDml request from the statistics of its result sets.
+std::variant<spanner_api::ResultSet, spanner_api::ExecuteBatchDmlResponse>
+RebuildDmlOutcome(bool is_batch_dml,
+                  absl::Span<const spanner_api::ResultSetStats> stats,
+                  const google::rpc::Status& batch_status) {
+  if (!is_batch_dml) {
+    spanner_api::ResultSet result_set;
+    result_set.mutable_metadata()->mutable_row_type();
+    if (!stats.empty()) {
+      *result_set.mutable_stats() = stats.front();
+    }
+    return result_set;
+  }
+  spanner_api::ExecuteBatchDmlResponse response;
+  for (int i = 0; i < stats.size(); ++i) {
+    spanner_api::ResultSet* result_set = response.add_result_sets();
+    if (i == 0) {
+      result_set->mutable_metadata()->mutable_row_type();
+    }
+    *result_set->mutable_stats() = stats[i];
+  }
+  *response.mutable_status() = batch_status;
+  return response;
+}
+
+// Returns the statistics of `result_set` that are kept once its request has
+// left the replay window.
+spanner_api::ResultSetStats CompactStats(
+    const spanner_api::ResultSet& result_set) {
+  spanner_api::ResultSetStats stats = result_set.stats();
+  stats.clear_query_plan();
+  stats.clear_query_stats();
+  return stats;
+}
+
+}  // namespace
+
+void Transaction::CompactDmlRequestRecord(DmlRequestRecord& record) {
+  CompactDmlOutcome compact;
+  if (std::holds_alternative<CompactDmlOutcome>(record.outcome)) {
+    return;
+  } else if (const auto* result_set =
+                 std::get_if<spanner_api::ResultSet>(&record.outcome)) {
+    compact.stats.push_back(CompactStats(*result_set));
+    compact.dropped_payload =
+        !google::protobuf::util::MessageDifferencer::Equals(
+            *result_set,
+            std::get<spanner_api::ResultSet>(RebuildDmlOutcome(
+                /*is_batch_dml=*/false, compact.stats, compact.batch_status)));
+  } else {
+    const auto& response =
+        std::get<spanner_api::ExecuteBatchDmlResponse>(record.outcome);
+    compact.is_batch_dml = true;
+    for (const spanner_api::ResultSet& result_set : response.result_sets()) {
+      compact.stats.push_back(CompactStats(result_set));
+    }
+    compact.batch_status = response.status();
+    compact.dropped_payload =
+        !google::protobuf::util::MessageDifferencer::Equals(
+            response, std::get<spanner_api::ExecuteBatchDmlResponse>(
+                          RebuildDmlOutcome(/*is_batch_dml=*/true,
+                                            compact.stats,
+                                            compact.batch_status)));
+  }
+  record.outcome = std::move(compact);
+}
+
 std::optional<Transaction::RequestReplayState>
 Transaction::LookupOrRegisterDmlRequest(int64_t seqno, int64_t request_hash,
                                         const std::string& sql_statement) {
@@ -325,25 +585,51 @@ Transaction::LookupOrRegisterDmlRequest(int64_t seqno, int64_t request_hash,
       return state;
     }
 
-    // Order was valid, so we record the new sequence number.
+    // Order was valid, so we record the new sequence number, and drop the
+    // full outcome of the request which leaves the replay window.
     dml_requests_.emplace(
-        seqno, Transaction::RequestReplayState{.status = absl::OkStatus(),
-                                               .request_hash = request_hash});
+        seqno, DmlRequestRecord{.status = absl::OkStatus(),
+                                .request_hash = request_hash});
+    if (dml_requests_.size() > kDmlReplayWindow) {
+      CompactDmlRequestRecord(
+          std::prev(dml_requests_.end(), kDmlReplayWindow + 1)->second);
+    }
     dml_error_mode_ = DMLErrorHandlingMode::kDmlRequest;
     return std::nullopt;
   }
 
   // Request was found, check to see that the request hash matches.
   if (request_hash != request->second.request_hash) {
-    Transaction::RequestReplayState state = request->second;
+    Transaction::RequestReplayState state;
     state.status = error::ReplayRequestMismatch(seqno, sql_statement);
     dml_error_mode_ = DMLErrorHandlingMode::kDmlRegistrationError;
     return state;
   }
 
-  // Return the saved status for this sequence.
+  // Return the saved status and outcome for this sequence.
+  const DmlRequestRecord& record = request->second;
+  Transaction::RequestReplayState state{.status = record.status,
+                                        .request_hash = record.request_hash};
+  if (const auto* compact = std::get_if<CompactDmlOutcome>(&record.outcome)) {
+    // A failed request is replayed with its error alone, so it stays
+    // replayable whatever its outcome carried.
+    if (compact->dropped_payload && record.status.ok()) {
+      state.status =
+          error::ReplayOutcomeNoLongerAvailable(seqno, sql_statement);
+      dml_error_mode_ = DMLErrorHandlingMode::kDmlRegistrationError;
+      return state;
+    }
+    state.outcome = RebuildDmlOutcome(compact->is_batch_dml, compact->stats,
+                                      compact->batch_status);
+  } else if (const auto* result_set =
+                 std::get_if<spanner_api::ResultSet>(&record.outcome)) {
+    state.outcome = *result_set;
+  } else {
+    state.outcome =
+        std::get<spanner_api::ExecuteBatchDmlResponse>(record.outcome);
+  }
   dml_error_mode_ = DMLErrorHandlingMode::kDmlReplay;
-  return request->second;
+  return state;
 }
 
 void Transaction::SetDmlRequestReplayStatus(const absl::Status& status) {
@@ -374,7 +660,12 @@ void Transaction::SetDmlReplayOutcome(
   ABSL_DCHECK(request != dml_requests_.end())
       << "DML sequence number was not registered.";
   if (request != dml_requests_.end()) {
-    request->second.outcome = outcome;
+    if (auto* result_set = std::get_if<spanner_api::ResultSet>(&outcome)) {
+      request->second.outcome = std::move(*result_set);
+    } else {
+      request->second.outcome =
+          std::move(std::get<spanner_api::ExecuteBatchDmlResponse>(outcome));
+    }
   }
 }
 
@@ -384,6 +675,8 @@ Transaction::DMLErrorHandlingMode Transaction::DMLErrorType() const {
 
 absl::Status Transaction::GuardedCall(OpType op,
                                       const std::function<absl::Status()>& fn) {
+  // The span includes waiting for other calls on this transaction.
+  tracing::ScopedSpan span("Transaction::GuardedCall");
   absl::MutexLock lock(&mu_);
 
   // Cannot reuse a transaction that previously encountered an error.
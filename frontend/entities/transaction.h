@@ -17,20 +17,27 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_ENTITIES_TRANSACTIONS_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_ENTITIES_TRANSACTIONS_H_
 
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <optional>
 #include <variant>
+#include <vector>
 
 #include "google/protobuf/empty.pb.h"
+#include "google/rpc/status.pb.h"
 #include "google/spanner/v1/result_set.pb.h"
 #include "google/spanner/v1/spanner.pb.h"
 #include "google/spanner/v1/transaction.pb.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "backend/common/ids.h"
+#include "backend/database/database.h"
 #include "backend/query/query_engine.h"
 #include "backend/schema/catalog/schema.h"
 #include "backend/transaction/read_only_transaction.h"
@@ -109,7 +116,7 @@ class Transaction {
   Transaction(std::variant<std::unique_ptr<backend::ReadWriteTransaction>,
                            std::unique_ptr<backend::ReadOnlyTransaction>>
                   backend_transaction,
-              const backend::QueryEngine* query_engine,
+              backend::Database* database,
               const spanner_api::TransactionOptions& options,
               const Usage& usage);
 
@@ -143,6 +150,14 @@ class Transaction {
   absl::StatusOr<backend::QueryResult> ExecuteSql(
       const backend::Query& query, v1::ExecuteSqlRequest_QueryMode query_mode);
 
+  // Executes the DML statements of a batch in order, appending the result of
+  // each statement to `results` until one of them fails. Consecutive INSERT
+  // statements into the same table and columns are written to a read-write
+  // transaction as a single mutation. If writing such a mutation fails, the
+  // failure is reported for the first statement whose rows it holds.
+  absl::Status ExecuteBatchDml(absl::Span<const backend::Query> queries,
+                               std::vector<backend::QueryResult>* results);
+
   // Calls Write using the backend transaction.
   absl::Status Write(const backend::Mutation& mutation);
 
@@ -222,11 +237,40 @@ class Transaction {
   // Returns the DML request type.
   DMLErrorHandlingMode DMLErrorType() const;
 
+  // Number of most recent DML requests whose full outcome is kept for replay.
+  // Older requests only keep their status and row counts, which bounds the
+  // memory held by transactions issuing many DML requests.
+  static constexpr int kDmlReplayWindow = 16;
+
   // Disallow copy and assignment.
   Transaction(const Transaction&) = delete;
   Transaction& operator=(const Transaction&) = delete;
 
  private:
+  // The outcome of a DML request which has left the replay window: the
+  // statistics of each of its result sets without query plan or query stats.
+  struct CompactDmlOutcome {
+    bool is_batch_dml = false;
+    std::vector<spanner_api::ResultSetStats> stats;
+    google::rpc::Status batch_status;
+    // True if the full outcome carried more than the above (returned rows,
+    // a non-empty row type, a transaction or a query plan), in which case the
+    // request can no longer be replayed.
+    bool dropped_payload = false;
+  };
+
+  // What is kept for each DML sequence number, see RequestReplayState.
+  struct DmlRequestRecord {
+    absl::Status status;
+    int64_t request_hash;
+    std::variant<spanner_api::ResultSet, spanner_api::ExecuteBatchDmlResponse,
+                 CompactDmlOutcome>
+        outcome;
+  };
+
+  // Replaces the full outcome of `record` with its CompactDmlOutcome.
+  static void CompactDmlRequestRecord(DmlRequestRecord& record);
+
   // Sets the status within the DML RequestReplayState for the currently
   // executing DML. If the current request failed due to a registration error
   // (sequence out of order or request hash mismatch), this will be a no-op.
@@ -246,6 +290,9 @@ class Transaction {
                std::unique_ptr<backend::ReadOnlyTransaction>>
       transaction_;
 
+  // The backend database, which executes partitioned DML statements.
+  backend::Database* database_;
+
   // The query engine for executing queries.
   const backend::QueryEngine* query_engine_;
 
@@ -281,8 +328,9 @@ class Transaction {
   // The type of DML request.
   DMLErrorHandlingMode dml_error_mode_;
 
-  // DML sequence request map.
-  std::map<int64_t, RequestReplayState> dml_requests_ ABSL_GUARDED_BY(mu_);
+  // DML sequence request map. Only the last kDmlReplayWindow records hold a
+  // full outcome.
+  std::map<int64_t, DmlRequestRecord> dml_requests_ ABSL_GUARDED_BY(mu_);
 };
 
 // Return true if the given transaction selector requires the transaction to be
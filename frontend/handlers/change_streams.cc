@@ -17,6 +17,7 @@
 #include "frontend/handlers/change_streams.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -30,17 +31,26 @@
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
 #include "backend/access/read.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/datamodel/key_set.h"
 #include "backend/query/change_stream/change_stream_query_validator.h"
 #include "backend/query/query_engine.h"
 #include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/change_stream.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/transaction/change_stream_commit_notifier.h"
+#include "backend/transaction/change_stream_log.h"
 #include "common/clock.h"
 #include "common/errors.h"
 #include "frontend/converters/change_streams.h"
 #include "frontend/converters/pg_change_streams.h"
 #include "frontend/converters/time.h"
+#include "frontend/entities/database.h"
 #include "frontend/entities/session.h"
 #include "frontend/entities/transaction.h"
 #include "frontend/server/handler.h"
+#include "zetasql/public/value.h"
 #include "zetasql/base/ret_check.h"
 #include "zetasql/base/status_macros.h"
 
@@ -53,6 +63,11 @@ ABSL_FLAG(
     absl::Milliseconds(100),
     "Change streams chopped interval for partition query in milliseconds.");
 
+ABSL_FLAG(int64_t, change_streams_partition_query_max_records_per_scan, 1000,
+          "Number of data change records above which a partition query "
+          "halves its scan window, and below half of which it doubles the "
+          "window again up to the chop interval.");
+
 namespace google {
 namespace spanner {
 namespace emulator {
@@ -109,6 +124,108 @@ bool IsQueryResultEmpty(backend::QueryResult& result) {
   return result.num_output_rows == 0;
 }
 
+// A RowCursor over rows which have already been read.
+class ReadRowsCursor : public backend::RowCursor {
+ public:
+  ReadRowsCursor(std::vector<std::string> column_names,
+                 std::vector<const zetasql::Type*> column_types,
+                 std::vector<std::vector<zetasql::Value>> rows)
+      : column_names_(std::move(column_names)),
+        column_types_(std::move(column_types)),
+        rows_(std::move(rows)) {}
+
+  bool Next() override { return ++row_index_ < rows_.size(); }
+
+  absl::Status Status() const override { return absl::OkStatus(); }
+
+  int NumColumns() const override { return column_names_.size(); }
+
+  const std::string ColumnName(int i) const override {
+    return column_names_[i];
+  }
+
+  const zetasql::Value ColumnValue(int i) const override {
+    return rows_[row_index_][i];
+  }
+
+  const zetasql::Type* ColumnType(int i) const override {
+    return column_types_[i];
+  }
+
+ private:
+  size_t row_index_ = -1;
+  const std::vector<std::string> column_names_;
+  const std::vector<const zetasql::Type*> column_types_;
+  const std::vector<std::vector<zetasql::Value>> rows_;
+};
+
+// Returns the key of the row of `partition_token` in the partition table.
+backend::Key PartitionTableKey(const std::string& partition_token) {
+  return backend::Key({zetasql::values::String(partition_token)});
+}
+
+// Reads the rows of `read_arg` in `txn` into a result which, like the result
+// of a query, knows how many rows it holds.
+absl::StatusOr<backend::QueryResult> ReadIntoResult(
+    Transaction* txn, const backend::ReadArg& read_arg) {
+  std::unique_ptr<backend::RowCursor> cursor;
+  ZETASQL_RETURN_IF_ERROR(txn->Read(read_arg, &cursor));
+  std::vector<std::string> column_names;
+  std::vector<const zetasql::Type*> column_types;
+  for (int i = 0; i < cursor->NumColumns(); ++i) {
+    column_names.push_back(cursor->ColumnName(i));
+    column_types.push_back(cursor->ColumnType(i));
+  }
+  std::vector<std::vector<zetasql::Value>> rows;
+  std::vector<std::vector<zetasql::Value>> batch;
+  while (cursor->NextBatch(backend::kRowCursorBatchSize, &batch)) {
+    rows.insert(rows.end(), batch.begin(), batch.end());
+  }
+  ZETASQL_RETURN_IF_ERROR(cursor->Status());
+  backend::QueryResult result;
+  result.num_output_rows = rows.size();
+  result.rows = std::make_unique<ReadRowsCursor>(
+      std::move(column_names), std::move(column_types), std::move(rows));
+  return result;
+}
+
+// Sends the response on the stream. Send blocks while the client is not
+// reading (gRPC flow control), and fails once the stream is closed.
+absl::Status SendResponse(ServerStream<spanner_api::PartialResultSet>* stream,
+                          const spanner_api::PartialResultSet& response) {
+  if (!stream->Send(response)) {
+    return error::ChangeStreamQueryStreamClosed();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SendResponses(
+    ServerStream<spanner_api::PartialResultSet>* stream,
+    const std::vector<spanner_api::PartialResultSet>& responses) {
+  for (const auto& response : responses) {
+    ZETASQL_RETURN_IF_ERROR(SendResponse(stream, response));
+  }
+  return absl::OkStatus();
+}
+
+// Returns the scan window to use after a scan that returned `num_records`
+// data change records: backlogged partitions are scanned in smaller windows
+// so that a scan's records are streamed back before the next scan is read.
+absl::Duration AdaptScanWindow(absl::Duration scan_window,
+                               int64_t num_records) {
+  const int64_t max_records = absl::GetFlag(
+      FLAGS_change_streams_partition_query_max_records_per_scan);
+  const absl::Duration max_window =
+      absl::GetFlag(FLAGS_change_streams_partition_query_chop_interval);
+  if (num_records > max_records) {
+    return std::max(scan_window / 2, absl::Microseconds(1));
+  }
+  if (num_records < max_records / 2) {
+    return std::min(scan_window * 2, max_window);
+  }
+  return scan_window;
+}
+
 absl::Status ValidateTokenInRetentionWindow(
     const absl::Time tvf_start, const absl::Time current_chopped_start,
     const absl::Time current_token_end,
@@ -137,29 +254,34 @@ absl::Status ChangeStreamsHandler::ProcessDataChangeRecordsAndStreamBack(
     const absl::Time scan_end, bool& expect_metadata,
     absl::Time* last_record_time,
     ServerStream<spanner_api::PartialResultSet>* stream) {
-  std::vector<spanner_api::PartialResultSet> responses;
   if (IsQueryResultEmpty(result) && expect_heartbeat) {
     ZETASQL_ASSIGN_OR_RETURN(
-        responses,
+        auto responses,
         metadata().is_pg
             ? ConvertHeartbeatTimestampToJson(scan_end, metadata().tvf_name,
                                               expect_metadata)
             : ConvertHeartbeatTimestampToStruct(scan_end, expect_metadata));
     expect_metadata = false;
     *last_record_time = scan_end;
-  } else if (!IsQueryResultEmpty(result)) {
-    ZETASQL_ASSIGN_OR_RETURN(responses, metadata().is_pg
-                                    ? ConvertDataTableRowCursorToJson(
-                                          result.rows.get(),
-                                          metadata().tvf_name, expect_metadata)
-                                    : ConvertDataTableRowCursorToStruct(
-                                          result.rows.get(), expect_metadata));
+    return SendResponses(stream, responses);
+  }
+  if (!IsQueryResultEmpty(result)) {
+    // Stream each data change record as soon as it is converted rather than
+    // buffering the whole scan, so a slow reader throttles the conversion.
+    const ChangeStreamResponseSender send =
+        [stream](const spanner_api::PartialResultSet& response) {
+          return SendResponse(stream, response);
+        };
+    ZETASQL_RETURN_IF_ERROR(
+        metadata().is_pg
+            ? StreamDataTableRowCursorAsJson(result.rows.get(),
+                                             metadata().tvf_name,
+                                             expect_metadata, send)
+            : StreamDataTableRowCursorAsStruct(result.rows.get(),
+                                               expect_metadata, send));
     *last_record_time = scan_end;
     expect_metadata = false;
   }
-  for (auto& response : responses) {
-    stream->Send(response);
-  }
   return absl::OkStatus();
 }
 
@@ -197,11 +319,7 @@ absl::Status ChangeStreamsHandler::ExecuteInitialQuery(
             : ConvertPartitionTableRowCursorToStruct(
                   partition_results.rows.get(), metadata().start_timestamp,
                   /*need_metadata=*/true));
-
-    for (auto& response : responses) {
-      stream->Send(response);
-    }
-    return absl::OkStatus();
+    return SendResponses(stream, responses);
   });
 }
 
@@ -216,24 +334,19 @@ absl::StatusOr<absl::Time> ChangeStreamsHandler::TryGetPartitionTokenEndTime(
                    TimestampToProto(read_ts));
   ZETASQL_ASSIGN_OR_RETURN(auto txn, session->CreateSingleUseTransaction(txn_options));
   ZETASQL_RETURN_IF_ERROR(
-      txn->GuardedCall(Transaction::OpType::kSql, [&]() -> absl::Status {
-        backend::Query get_partition_token_time_query =
-            backend::Query{absl::Substitute(
-                "SELECT start_time, end_time "
-                "FROM $0 "
-                "WHERE( partition_token = '$1' )",
-                partition_table_, metadata().partition_token.value())};
-        get_partition_token_time_query.change_stream_internal_lookup =
-            metadata().change_stream_name;
-        ZETASQL_ASSIGN_OR_RETURN(auto token_time_results,
-                         txn->ExecuteSql(get_partition_token_time_query));
-        if (IsQueryResultEmpty(token_time_results)) {
+      txn->GuardedCall(Transaction::OpType::kRead, [&]() -> absl::Status {
+        std::unique_ptr<backend::RowCursor> cursor;
+        ZETASQL_RETURN_IF_ERROR(txn->Read(
+            PartitionTableRead(backend::KeySet(PartitionTableKey(
+                                   metadata().partition_token.value())),
+                               {"start_time", "end_time"}),
+            &cursor));
+        if (!cursor->Next()) {
+          ZETASQL_RETURN_IF_ERROR(cursor->Status());
           return error::
               InvalidChangeStreamTvfArgumentPartitionTokenInvalidChangeStreamName(  // NOLINT
                   metadata().partition_token.value());
         }
-        backend::RowCursor* cursor = token_time_results.rows.get();
-        cursor->Next();
         start = cursor->ColumnValue(0).ToTime();
         // If the end_time of current partition token is null, set the returning
         // end time to InfiniteFuture().
@@ -254,41 +367,103 @@ absl::StatusOr<absl::Time> ChangeStreamsHandler::TryGetPartitionTokenEndTime(
   return end;
 }
 
-backend::Query ChangeStreamsHandler::ConstructDataTablePartitionQuery(
-    absl::Time start, absl::Time end) const {
-  // If user passed end_timestamp is not null and current scan is the last scan
-  // in query lifetime, we do an inclusive scan to include the data change
-  // record with commit_timestamp exactly at the user passed end_timestamp. If
-  // current scan is a middle chopped scan, we do an exclusive scan because all
-  // data records of a partition token has a commit_timestamp in
+bool ChangeStreamsHandler::IsInclusiveScanEnd(absl::Time end) const {
+  return metadata().end_timestamp.has_value() &&
+         metadata().end_timestamp.value() == end;
+}
+
+backend::ReadArg ChangeStreamsHandler::PartitionTableRead(
+    backend::KeySet key_set, std::vector<std::string> columns) const {
+  backend::ReadArg read_arg;
+  // The test only mock partition table is a user table.
+  if (partition_table_ == metadata().partition_table) {
+    read_arg.change_stream_for_partition_table = metadata().change_stream_name;
+  } else {
+    read_arg.table = partition_table_;
+  }
+  read_arg.key_set = std::move(key_set);
+  read_arg.columns = std::move(columns);
+  return read_arg;
+}
+
+backend::ReadArg ChangeStreamsHandler::DataTablePartitionRead(
+    const backend::Table* data_table, absl::Time start, absl::Time end) const {
+  backend::ReadArg read_arg;
+  read_arg.change_stream_for_data_table = metadata().change_stream_name;
+  for (const backend::Column* column : data_table->columns()) {
+    read_arg.columns.push_back(column->Name());
+  }
+  // The data table is keyed by partition token and commit timestamp first, so
+  // the records are one key range, read in commit timestamp order. If user
+  // passed end_timestamp is not null and current scan is the last scan in query
+  // lifetime, we do an inclusive scan to include the data change record with
+  // commit_timestamp exactly at the user passed end_timestamp. If current scan
+  // is a middle chopped scan, we do an exclusive scan because all data records
+  // of a partition token has a commit_timestamp in
   // [partition_start_time,partition_end_time).
-  const bool is_inclusive_read = metadata().end_timestamp.has_value() &&
-                                 metadata().end_timestamp.value() == end;
-  backend::Query data_table_partition_query = backend::Query{absl::Substitute(
-      "SELECT * "
-      "FROM $0 "
-      "WHERE( partition_token='$1' AND commit_timestamp >= '$2' AND "
-      "commit_timestamp $3 '$4' ) ORDER BY partition_token, commit_timestamp, "
-      "server_transaction_id,record_sequence",
-      metadata().data_table, metadata().partition_token.value(), 
-      absl::FormatTime(start, absl::UTCTimeZone()),
-      is_inclusive_read ? "<=" : "<", 
-      absl::FormatTime(end, absl::UTCTimeZone()))};
-  data_table_partition_query.change_stream_internal_lookup =
-      metadata().change_stream_name;
-  return data_table_partition_query;
+  const backend::Key start_key(
+      {zetasql::values::String(metadata().partition_token.value()),
+       zetasql::values::Timestamp(start)});
+  const backend::Key end_key(
+      {zetasql::values::String(metadata().partition_token.value()),
+       zetasql::values::Timestamp(end)});
+  read_arg.key_set = backend::KeySet(
+      IsInclusiveScanEnd(end)
+          ? backend::KeyRange::ClosedClosed(start_key, end_key)
+          : backend::KeyRange::ClosedOpen(start_key, end_key));
+  return read_arg;
+}
+
+absl::StatusOr<backend::QueryResult>
+ChangeStreamsHandler::ReadDataChangeRecords(
+    const backend::ChangeStreamLog* change_stream_log, Transaction* txn,
+    absl::Time start, absl::Time end) const {
+  // Getting the schema waits for the commits before the read timestamp, and so
+  // for their records to be appended to the log.
+  const backend::ChangeStream* change_stream =
+      txn->schema()->FindChangeStream(metadata().change_stream_name);
+  const backend::Table* data_table =
+      change_stream != nullptr ? change_stream->change_stream_data_table()
+                               : nullptr;
+  if (data_table == nullptr) {
+    return error::ChangeStreamNotFound(metadata().change_stream_name);
+  }
+  if (change_stream_log != nullptr &&
+      data_table->Name() == metadata().data_table &&
+      start >= change_stream_log->TruncatedBefore(data_table->id())) {
+    backend::QueryResult result;
+    result.rows = change_stream_log->Read(
+        data_table, metadata().partition_token.value(), start, end,
+        IsInclusiveScanEnd(end), &result.num_output_rows);
+    return result;
+  }
+  return ReadIntoResult(txn, DataTablePartitionRead(data_table, start, end));
 }
 
-backend::Query ChangeStreamsHandler::ConstructPartitionTablePartitionQuery()
-    const {
-  backend::Query data_table_partition_query = backend::Query{absl::Substitute(
-      "SELECT start_time, partition_token, parents FROM $0 "
-      "WHERE (ARRAY_INCLUDES((SELECT children FROM $0 WHERE "
-      "partition_token = '$1'), partition_token)) ORDER BY(partition_token)",
-      partition_table_, metadata().partition_token.value())};
-  data_table_partition_query.change_stream_internal_lookup =
-      metadata().change_stream_name;
-  return data_table_partition_query;
+absl::StatusOr<backend::QueryResult>
+ChangeStreamsHandler::ReadChildPartitionRecords(Transaction* txn) const {
+  std::unique_ptr<backend::RowCursor> cursor;
+  ZETASQL_RETURN_IF_ERROR(txn->Read(
+      PartitionTableRead(backend::KeySet(PartitionTableKey(
+                             metadata().partition_token.value())),
+                         {"children"}),
+      &cursor));
+  backend::KeySet child_keys;
+  if (cursor->Next()) {
+    const zetasql::Value children = cursor->ColumnValue(0);
+    if (!children.is_null()) {
+      for (const zetasql::Value& child : children.elements()) {
+        if (!child.is_null()) {
+          child_keys.AddKey(PartitionTableKey(child.string_value()));
+        }
+      }
+    }
+  }
+  ZETASQL_RETURN_IF_ERROR(cursor->Status());
+  // Rows are read in key order, so the records are ordered by partition token.
+  return ReadIntoResult(
+      txn, PartitionTableRead(std::move(child_keys),
+                              {"start_time", "partition_token", "parents"}));
 }
 
 absl::Status ChangeStreamsHandler::ExecutePartitionQuery(
@@ -312,7 +487,43 @@ absl::Status ChangeStreamsHandler::ExecutePartitionQuery(
   // Metadata is only expected for the first response to users in a single
   // query's lifetime.
   bool expect_metadata = true;
+  backend::ChangeStreamCommitNotifier* commit_notifier =
+      session->database() != nullptr
+          ? session->database()->backend()->change_stream_commit_notifier()
+          : nullptr;
+  const backend::ChangeStreamLog* change_stream_log =
+      session->database() != nullptr
+          ? session->database()->backend()->change_stream_log()
+          : nullptr;
+  // Shrinks while scans return more records than the per-scan limit, and
+  // grows back to the chop interval once the backlog has been drained.
+  absl::Duration scan_window =
+      absl::GetFlag(FLAGS_change_streams_partition_query_chop_interval);
+  bool is_first_scan = true;
+  // The latest commit notified for the change stream, and the latest one known
+  // to be read by a re-scan of the partition table for the token end time.
+  absl::Time last_commit_time = absl::InfinitePast();
+  std::optional<absl::Time> end_time_read_after_commit;
   while (current_start <= tvf_end && current_start < partition_token_end_time) {
+    if (!is_first_scan && commit_notifier != nullptr) {
+      // Instead of scanning every chop interval, wait for a commit to the
+      // change stream (which includes partition churns) or for the next
+      // heartbeat, and scan everything committed up to then. The scan still
+      // reads the committed records, so this only decides when to scan.
+      const absl::Time wait_deadline =
+          std::min({last_record_time + heartbeat_interval, tvf_end,
+                    partition_token_end_time});
+      last_commit_time = commit_notifier->WaitForCommit(
+          metadata().change_stream_name, current_start, wait_deadline);
+      current_end =
+          last_commit_time >= current_start
+              ? std::min(last_commit_time + absl::Microseconds(1),
+                         wait_deadline)
+              : wait_deadline;
+      current_end = std::max(current_end, current_start);
+    }
+    is_first_scan = false;
+    current_end = std::min(current_end, current_start + scan_window);
     // For historical queries where tvf end is in the past, set the read
     // transaction snapshot time to now to prevent >1h stale read, which is now
     // allowed.
@@ -326,11 +537,18 @@ absl::Status ChangeStreamsHandler::ExecutePartitionQuery(
     spanner_api::TransactionOptions txn_options;
     // If the partition token hasn't been churned yet, we re-scan the partition
     // table to see if the end time has been churned and update the partition
-    // end time.
-    if (partition_token_end_time == absl::InfiniteFuture()) {
+    // end time. Churns are commits to the change stream, so an idle partition
+    // woken up only for its heartbeat skips the re-scan when no commit was
+    // notified since the last one whose commit the re-scan read.
+    if (partition_token_end_time == absl::InfiniteFuture() &&
+        (commit_notifier == nullptr ||
+         end_time_read_after_commit != last_commit_time)) {
       ZETASQL_ASSIGN_OR_RETURN(
           partition_token_end_time,
           TryGetPartitionTokenEndTime(session, current_txn_snapshot_time));
+      if (last_commit_time <= current_txn_snapshot_time) {
+        end_time_read_after_commit = last_commit_time;
+      }
     }
     ZETASQL_RETURN_IF_ERROR(ValidateTokenInRetentionWindow(
         metadata().start_timestamp, current_start, partition_token_end_time,
@@ -346,21 +564,20 @@ absl::Status ChangeStreamsHandler::ExecutePartitionQuery(
     ZETASQL_ASSIGN_OR_RETURN(auto txn,
                      session->CreateSingleUseTransaction(txn_options));
     absl::Status status =
-        txn->GuardedCall(Transaction::OpType::kSql, [&]() -> absl::Status {
-          backend::Query read_data_query =
-              ConstructDataTablePartitionQuery(current_start, scan_end);
+        txn->GuardedCall(Transaction::OpType::kRead, [&]() -> absl::Status {
           ZETASQL_ASSIGN_OR_RETURN(auto data_records_results,
-                           txn->ExecuteSql(read_data_query));
+                           ReadDataChangeRecords(change_stream_log, txn.get(),
+                                                 current_start, scan_end));
+          scan_window = AdaptScanWindow(scan_window,
+                                        data_records_results.num_output_rows);
           ZETASQL_RETURN_IF_ERROR(ProcessDataChangeRecordsAndStreamBack(
               data_records_results, expect_heartbeat, scan_end, expect_metadata,
               &last_record_time, stream));
           if (partition_token_end_time <= current_end) {
             // Get child partition records after all data records are returned
             // in current query.
-            backend::Query tail_query_partition_table =
-                ConstructPartitionTablePartitionQuery();
             ZETASQL_ASSIGN_OR_RETURN(auto tail_partition_records_results,
-                             txn->ExecuteSql(tail_query_partition_table));
+                             ReadChildPartitionRecords(txn.get()));
             ZETASQL_RET_CHECK(!IsQueryResultEmpty(tail_partition_records_results));
             ZETASQL_ASSIGN_OR_RETURN(
                 auto responses,
@@ -374,10 +591,7 @@ absl::Status ChangeStreamsHandler::ExecutePartitionQuery(
                           /*initial_start_time=*/std::nullopt,
                           expect_metadata));
             expect_metadata = false;
-            for (auto& response : responses) {
-              stream->Send(response);
-            }
-            return absl::OkStatus();
+            return SendResponses(stream, responses);
           }
           return absl::OkStatus();
         });
@@ -385,9 +599,7 @@ absl::Status ChangeStreamsHandler::ExecutePartitionQuery(
     // Increment by 1 microsecond gap to avoid repetitive records.
     current_start = scan_end + absl::Microseconds(1);
     current_end = std::min(
-        {current_start +
-             absl::GetFlag(FLAGS_change_streams_partition_query_chop_interval),
-         tvf_end, partition_token_end_time});
+        {current_start + scan_window, tvf_end, partition_token_end_time});
   }
 
   // If expect_metadata is still true, stub a heartbeat record.
@@ -398,9 +610,7 @@ absl::Status ChangeStreamsHandler::ExecutePartitionQuery(
             ? ConvertHeartbeatTimestampToJson(tvf_end, metadata().tvf_name,
                                               expect_metadata)
             : ConvertHeartbeatTimestampToStruct(tvf_end, expect_metadata));
-    for (auto& response : extra_heartbeat) {
-      stream->Send(response);
-    }
+    ZETASQL_RETURN_IF_ERROR(SendResponses(stream, extra_heartbeat));
   }
   return absl::OkStatus();
 }
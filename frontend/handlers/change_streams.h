@@ -17,8 +17,10 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_HANDLERS_CHANGE_STREAMS_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_HANDLERS_CHANGE_STREAMS_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "google/spanner/v1/spanner.pb.h"
 #include "absl/flags/declare.h"
@@ -26,12 +28,21 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
+#include "backend/access/read.h"
+#include "backend/datamodel/key_set.h"
 #include "backend/query/change_stream/change_stream_query_validator.h"
 #include "backend/query/query_engine.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/transaction/change_stream_log.h"
 #include "frontend/entities/session.h"
+#include "frontend/entities/transaction.h"
 #include "frontend/server/handler.h"
 
 ABSL_DECLARE_FLAG(bool, cloud_spanner_emulator_test_with_fake_partition_table);
+ABSL_DECLARE_FLAG(absl::Duration,
+                  change_streams_partition_query_chop_interval);
+ABSL_DECLARE_FLAG(int64_t,
+                  change_streams_partition_query_max_records_per_scan);
 
 namespace google {
 namespace spanner {
@@ -75,10 +86,28 @@ class ChangeStreamsHandler {
       ServerStream<spanner_api::PartialResultSet>* stream,
       std::shared_ptr<Session> session);
 
-  backend::Query ConstructPartitionTablePartitionQuery() const;
+  // Returns a read of `columns` of the rows at `key_set` in the partition
+  // table.
+  backend::ReadArg PartitionTableRead(backend::KeySet key_set,
+                                      std::vector<std::string> columns) const;
 
-  backend::Query ConstructDataTablePartitionQuery(absl::Time start,
-                                                  absl::Time end) const;
+  // Returns a read of the data change records of the queried partition in
+  // `data_table` with a commit timestamp from `start` to `end`.
+  backend::ReadArg DataTablePartitionRead(const backend::Table* data_table,
+                                          absl::Time start,
+                                          absl::Time end) const;
+
+  // Reads the child partition records of the queried partition in `txn`.
+  absl::StatusOr<backend::QueryResult> ReadChildPartitionRecords(
+      Transaction* txn) const;
+
+  // Reads the data change records of the queried partition with a commit
+  // timestamp from `start` to `end` in `txn`. The records are read from
+  // `change_stream_log` when it still holds them, and otherwise as a key range
+  // of the change stream data table.
+  absl::StatusOr<backend::QueryResult> ReadDataChangeRecords(
+      const backend::ChangeStreamLog* change_stream_log, Transaction* txn,
+      absl::Time start, absl::Time end) const;
 
   absl::Status ProcessDataChangeRecordsAndStreamBack(
       backend::QueryResult& result, bool expect_heartbeat, absl::Time scan_end,
@@ -91,6 +120,11 @@ class ChangeStreamsHandler {
   }
 
  private:
+  // Returns true if a scan ending at `end` includes records committed at
+  // `end`, which is the case for the last scan of a query with an end
+  // timestamp.
+  bool IsInclusiveScanEnd(absl::Time end) const;
+
   const backend::ChangeStreamQueryValidator::ChangeStreamMetadata& metadata_;
   std::string partition_table_;
 };
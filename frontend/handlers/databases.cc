@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "google/longrunning/operations.pb.h"
@@ -32,11 +33,13 @@
 #include "backend/schema/parser/ddl_parser.h"
 #include "backend/schema/printer/print_ddl.h"
 #include "backend/schema/updater/schema_updater.h"
+#include "common/clock.h"
 #include "common/errors.h"
 #include "common/feature_flags.h"
 #include "frontend/common/uris.h"
 #include "frontend/converters/time.h"
 #include "frontend/entities/database.h"
+#include "frontend/entities/operation.h"
 #include "frontend/server/handler.h"
 #include "zetasql/base/status_macros.h"
 
@@ -51,6 +54,70 @@ namespace database_api = ::google::spanner::admin::database::v1;
 namespace operations_api = ::google::longrunning;
 namespace protobuf_api = ::google::protobuf;
 
+// Applies `statements` to `database` and records the outcome in `operation`.
+// Progress and commit timestamps are reported through `update_md`, which is
+// republished as the operation's metadata when the schema change starts and
+// when it finishes.
+void RunSchemaChange(Database* database, Clock* clock,
+                     const std::vector<std::string>& statements,
+                     const std::string& proto_descriptor_bytes,
+                     database_api::UpdateDatabaseDdlMetadata* update_md,
+                     Operation* operation) {
+  absl::StatusOr<protobuf_api::Timestamp> start_time =
+      TimestampToProto(clock->Now());
+  if (!start_time.ok()) {
+    operation->SetError(start_time.status());
+    return;
+  }
+  if (update_md->progress_size() > 0) {
+    *update_md->mutable_progress(0)->mutable_start_time() = *start_time;
+    operation->SetMetadata(*update_md);
+  }
+
+  backend::Database* backend_database = database->backend();
+  int num_succesful_statements = 0;
+  absl::Time commit_timestamp;
+  absl::Status backfill_status;
+  absl::Status status = backend_database->UpdateSchema(
+      backend::SchemaChangeOperation{
+          .statements = statements,
+          .proto_descriptor_bytes = proto_descriptor_bytes,
+          .database_dialect = backend_database->dialect()},
+      &num_succesful_statements, &commit_timestamp, &backfill_status);
+  if (!status.ok()) {
+    operation->SetError(status);
+    return;
+  }
+
+  // For simplicity in emulator, we have implemented the schema updates in such
+  // a way that all the statements in update ddl execute at the same commit
+  // timestamp. Only the timestamps of the successful statements are reported.
+  absl::StatusOr<protobuf_api::Timestamp> end_time =
+      TimestampToProto(commit_timestamp);
+  if (!end_time.ok()) {
+    operation->SetError(end_time.status());
+    return;
+  }
+  for (int i = 0; i < num_succesful_statements; ++i) {
+    *update_md->add_commit_timestamps() = *end_time;
+    database_api::OperationProgress* progress = update_md->mutable_progress(i);
+    progress->set_progress_percent(100);
+    *progress->mutable_start_time() = *start_time;
+    *progress->mutable_end_time() = *end_time;
+  }
+  // The statement that failed (if any) started but never completed.
+  if (num_succesful_statements < update_md->progress_size()) {
+    *update_md->mutable_progress(num_succesful_statements)
+         ->mutable_start_time() = *start_time;
+  }
+  operation->SetMetadata(*update_md);
+  if (backfill_status.ok()) {
+    operation->SetResponse(protobuf_api::Empty());
+  } else {
+    operation->SetError(backfill_status);
+  }
+}
+
 }  // namespace
 
 // Lists all databases in an instance.
@@ -204,31 +271,13 @@ absl::Status UpdateDatabaseDdl(
     statements.push_back(statement);
   }
 
-  backend::Database* backend_database = database->backend();
-  int num_succesful_statements;
-  absl::Time commit_timestamp;
-  absl::Status backfill_status;
-  ZETASQL_RETURN_IF_ERROR(backend_database->UpdateSchema(
-      backend::SchemaChangeOperation{
-          .statements = statements,
-          .proto_descriptor_bytes = request->proto_descriptors(),
-          .database_dialect = backend_database->dialect()},
-      &num_succesful_statements, &commit_timestamp, &backfill_status));
-
-  // Populate ResultSet metadata.
-  // For simplicity in emulator, we have implemented the schema updates in such
-  // a way that all the statements in update ddl execute at the same commit
-  // timestamp.
+  // Populate the operation metadata. Every statement starts with an empty
+  // progress entry which is filled in as the schema change executes.
   database_api::UpdateDatabaseDdlMetadata update_md;
   update_md.set_database(request->database());
   for (const std::string& statement : statements) {
     update_md.add_statements(statement);
-  }
-
-  // Only the timestamps of the successful statements are reported.
-  for (int i = 0; i < num_succesful_statements; ++i) {
-    ZETASQL_ASSIGN_OR_RETURN(*update_md.add_commit_timestamps(),
-                     TimestampToProto(commit_timestamp));
+    update_md.add_progress();
   }
 
   // Create operation to be returned as part of the response.
@@ -237,13 +286,21 @@ absl::Status UpdateDatabaseDdl(
                    ctx->env()->operation_manager()->CreateOperation(
                        request->database(), request->operation_id()));
   operation->SetMetadata(update_md);
-  if (backfill_status.ok()) {
-    operation->SetResponse(protobuf_api::Empty());
-  } else {
-    operation->SetError(backfill_status);
-  }
   operation->ToProto(response);
 
+  // Schema changes (and the backfills they trigger) can take a long time, so
+  // they run in the background, in request order on the database's queue, and
+  // the client polls the operation for completion.
+  ctx->env()->operation_manager()->RunInBackground(
+      request->database(),
+      [database, operation, clock = ctx->env()->clock(),
+       statements = std::move(statements),
+       proto_descriptor_bytes = request->proto_descriptors(),
+       update_md = std::move(update_md)]() mutable {
+        RunSchemaChange(database.get(), clock, statements,
+                        proto_descriptor_bytes, &update_md, operation.get());
+      });
+
   return absl::OkStatus();
 }
 REGISTER_GRPC_HANDLER(DatabaseAdmin, UpdateDatabaseDdl);
@@ -284,9 +341,12 @@ absl::Status GetDatabaseDdl(RequestContext* ctx,
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Database> database,
                    GetDatabase(ctx, request->database()));
 
-  absl::StatusOr<std::vector<std::string>> printed_statements =
-      backend::PrintDDLStatements(database->backend()->GetLatestSchema());
-  ZETASQL_RETURN_IF_ERROR(printed_statements.status());
+  // The printed statements are memoized on the schema, so repeated calls
+  // against an unchanged schema do not reformat every table and index.
+  ZETASQL_ASSIGN_OR_RETURN(
+      std::shared_ptr<const std::vector<std::string>> printed_statements,
+      backend::GetDDLStatements(database->backend()->GetLatestSchema()));
+  response->mutable_statements()->Reserve(printed_statements->size());
   for (const auto& statement : *printed_statements) {
     response->add_statements(statement);
   }
@@ -14,7 +14,10 @@
 // limitations under the License.
 //
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "google/longrunning/operations.pb.h"
 #include "google/protobuf/empty.pb.h"
@@ -39,9 +42,25 @@ absl::Status ListOperations(
   absl::string_view resource_uri, operation_id;
   ZETASQL_RETURN_IF_ERROR(ParseOperationUri(absl::StrCat(request->name(), "/"),
                                     &resource_uri, &operation_id));
-  ZETASQL_ASSIGN_OR_RETURN(
-      std::vector<std::shared_ptr<Operation>> operations,
-      ctx->env()->operation_manager()->ListOperations(request->name()));
+
+  // Validate that the page_token provided is a valid operation_uri.
+  if (!request->page_token().empty()) {
+    ZETASQL_RETURN_IF_ERROR(
+        ParseOperationUri(request->page_token(), &resource_uri, &operation_id));
+  }
+
+  int32_t page_size = request->page_size();
+  static const int32_t kMaxPageSize = 1000;
+  if (page_size <= 0 || page_size > kMaxPageSize) {
+    page_size = kMaxPageSize;
+  }
+
+  // The operation URI of the first operation of the next page is used as the
+  // next_page_token, so only the requested page of operations is visited.
+  std::vector<std::shared_ptr<Operation>> operations =
+      ctx->env()->operation_manager()->ListOperations(
+          request->name(), request->page_token(), page_size,
+          response->mutable_next_page_token());
   for (const auto& op : operations) {
     op->ToProto(response->add_operations());
   }
@@ -14,8 +14,11 @@
 // limitations under the License.
 //
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "google/protobuf/struct.pb.h"
 #include "google/spanner/v1/keys.pb.h"
@@ -23,14 +26,22 @@
 #include "google/spanner/v1/transaction.pb.h"
 #include "google/spanner/v1/type.pb.h"
 #include "absl/status/status.h"
+#include "zetasql/public/value.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "backend/access/read.h"
 #include "backend/query/query_engine.h"
+#include "backend/schema/catalog/index.h"
+#include "backend/schema/catalog/table.h"
 #include "common/config.h"
 #include "common/errors.h"
+#include "common/limits.h"
 #include "frontend/converters/partition.h"
 #include "frontend/converters/query.h"
 #include "frontend/converters/reads.h"
+#include "frontend/converters/values.h"
 #include "frontend/entities/session.h"
+#include "frontend/entities/transaction.h"
 #include "frontend/proto/partition_token.pb.h"
 #include "frontend/server/handler.h"
 #include "zetasql/base/status_macros.h"
@@ -94,10 +105,13 @@ absl::StatusOr<PartitionToken> CreatePartitionTokenForRead(
   return partition_token;
 }
 
-// Create a partition token for the given partition query request.
+// Create a partition token for the given partition query request. If
+// root_table is not null, the partition only reads the rows of root_table with
+// keys in partitioned_key_set.
 absl::StatusOr<PartitionToken> CreatePartitionTokenForQuery(
     const google::spanner::v1::PartitionQueryRequest& request,
-    const backend::TransactionID& txn_id, bool empty_partition) {
+    const backend::TransactionID& txn_id, const backend::Table* root_table,
+    const google::spanner::v1::KeySet& partitioned_key_set) {
   if (request.sql().empty()) {
     return error::MissingRequiredFieldError("sql");
   }
@@ -110,10 +124,94 @@ absl::StatusOr<PartitionToken> CreatePartitionTokenForQuery(
   *query_params->mutable_params() = request.params();
   *query_params->mutable_param_types() = request.param_types();
 
-  partition_token.set_empty_query_partition(empty_partition);
+  if (root_table == nullptr) {
+    partition_token.set_empty_query_partition(false);
+  } else {
+    query_params->set_root_table(root_table->Name());
+    *partition_token.mutable_partitioned_key_set() = partitioned_key_set;
+  }
   return partition_token;
 }
 
+// Converts the given key column values to a key proto.
+absl::StatusOr<google::protobuf::ListValue> KeyToProto(
+    const std::vector<zetasql::Value>& key) {
+  google::protobuf::ListValue key_pb;
+  for (const zetasql::Value& value : key) {
+    ZETASQL_ASSIGN_OR_RETURN(*key_pb.add_values(), ValueToProto(value));
+  }
+  return key_pb;
+}
+
+// Splits the rows returned by read_arg into contiguous ranges of their key,
+// which is made of the first num_key_columns columns of read_arg. The remaining
+// columns only contribute to the estimated size of each row.
+//
+// Each range holds at least the requested partition size worth of data, except
+// for the last one, and no more ranges than the requested maximum number of
+// partitions are created. Returns a key set with a single range for each
+// partition. Together, the ranges cover the whole key space, so they need to be
+// intersected with the key set that was read.
+absl::StatusOr<std::vector<spanner_api::KeySet>> SplitIntoKeyRanges(
+    Transaction* txn, const backend::ReadArg& read_arg, int num_key_columns,
+    const spanner_api::PartitionOptions& partition_options) {
+  const int64_t partition_size_bytes =
+      partition_options.partition_size_bytes() > 0
+          ? partition_options.partition_size_bytes()
+          : limits::kDefaultPartitionSizeBytes;
+  const int64_t max_partitions = partition_options.max_partitions() > 0
+                                     ? partition_options.max_partitions()
+                                     : limits::kDefaultMaxPartitions;
+
+  // Collect the key and the estimated size of every row.
+  std::vector<std::vector<zetasql::Value>> keys;
+  std::vector<int64_t> sizes;
+  int64_t total_size = 0;
+  ZETASQL_RETURN_IF_ERROR(txn->GuardedCall(
+      Transaction::OpType::kRead, [&]() -> absl::Status {
+        std::unique_ptr<backend::RowCursor> cursor;
+        ZETASQL_RETURN_IF_ERROR(txn->Read(read_arg, &cursor));
+        while (cursor->Next()) {
+          std::vector<zetasql::Value>& key = keys.emplace_back();
+          int64_t size = 0;
+          for (int i = 0; i < cursor->NumColumns(); ++i) {
+            zetasql::Value value = cursor->ColumnValue(i);
+            size += value.physical_byte_size();
+            if (i < num_key_columns) {
+              key.push_back(std::move(value));
+            }
+          }
+          sizes.push_back(size);
+          total_size += size;
+        }
+        return cursor->Status();
+      }));
+
+  // Grow partitions beyond the requested size if needed to respect the
+  // maximum number of partitions.
+  const int64_t target_size = std::max(
+      partition_size_bytes, (total_size + max_partitions - 1) / max_partitions);
+  std::vector<spanner_api::KeySet> key_sets;
+  google::protobuf::ListValue start_key;  // Empty key: start of the key space.
+  int64_t partition_size = 0;
+  for (int i = 0; i < keys.size(); ++i) {
+    // Rows with the same key (e.g. in a non-unique index) cannot be split.
+    if (partition_size >= target_size && key_sets.size() + 1 < max_partitions &&
+        keys[i] != keys[i - 1]) {
+      spanner_api::KeyRange* range = key_sets.emplace_back().add_ranges();
+      *range->mutable_start_closed() = start_key;
+      ZETASQL_ASSIGN_OR_RETURN(start_key, KeyToProto(keys[i]));
+      *range->mutable_end_open() = start_key;
+      partition_size = 0;
+    }
+    partition_size += sizes[i];
+  }
+  spanner_api::KeyRange* range = key_sets.emplace_back().add_ranges();
+  *range->mutable_start_closed() = start_key;
+  range->mutable_end_closed();  // Empty key: end of the key space.
+  return key_sets;
+}
+
 }  //  namespace
 
 // Creates a set of partition tokens for executing parallel read operations.
@@ -142,24 +240,40 @@ absl::Status PartitionRead(RequestContext* ctx,
     ZETASQL_ASSIGN_OR_RETURN(*response->mutable_transaction(), txn->ToProto());
   }
 
-  // Add two partitions to result set, with first partition being empty.
-  ZETASQL_ASSIGN_OR_RETURN(
-      auto empty_partition_token,
-      CreatePartitionTokenForRead(*request, txn->id(), spanner_api::KeySet()));
-  spanner_api::Partition empty_partition;
-  ZETASQL_ASSIGN_OR_RETURN(*empty_partition.mutable_partition_token(),
-                   PartitionTokenToString(empty_partition_token));
-
-  // Second partition contains full result set for requested key_set.
-  ZETASQL_ASSIGN_OR_RETURN(
-      auto full_partition_token,
-      CreatePartitionTokenForRead(*request, txn->id(), request->key_set()));
-  spanner_api::Partition full_partition;
-  ZETASQL_ASSIGN_OR_RETURN(*full_partition.mutable_partition_token(),
-                   PartitionTokenToString(full_partition_token));
+  // Split the requested rows by the key of the table or index they are read
+  // from.
+  spanner_api::ReadRequest read_request;
+  read_request.set_table(request->table());
+  read_request.set_index(request->index());
+  *read_request.mutable_key_set() = request->key_set();
+  backend::ReadArg read_arg;
+  ZETASQL_RETURN_IF_ERROR(ReadArgFromProto(*txn->schema(), read_request, &read_arg));
+  const backend::Table* table = txn->schema()->FindTable(request->table());
+  absl::Span<const backend::KeyColumn* const> key_columns =
+      request->index().empty()
+          ? table->primary_key()
+          : txn->schema()->FindIndex(request->index())->key_columns();
+  for (const backend::KeyColumn* key_column : key_columns) {
+    read_arg.columns.push_back(key_column->column()->Name());
+  }
+  for (const std::string& column : request->columns()) {
+    if (std::find(read_arg.columns.begin(), read_arg.columns.end(), column) ==
+        read_arg.columns.end()) {
+      read_arg.columns.push_back(column);
+    }
+  }
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<spanner_api::KeySet> key_sets,
+                   SplitIntoKeyRanges(txn.get(), read_arg, key_columns.size(),
+                                      request->partition_options()));
 
-  *response->mutable_partitions()->Add() = empty_partition;
-  *response->mutable_partitions()->Add() = full_partition;
+  for (const spanner_api::KeySet& key_set : key_sets) {
+    ZETASQL_ASSIGN_OR_RETURN(
+        auto partition_token,
+        CreatePartitionTokenForRead(*request, txn->id(), key_set));
+    ZETASQL_ASSIGN_OR_RETURN(
+        *response->add_partitions()->mutable_partition_token(),
+        PartitionTokenToString(partition_token));
+  }
 
   return absl::OkStatus();
 }
@@ -199,29 +313,43 @@ absl::Status PartitionQuery(RequestContext* ctx,
                      ,
                      txn->schema()->proto_bundle()
                      ));
+  const backend::Table* root_table = nullptr;
   ZETASQL_RETURN_IF_ERROR(txn->query_engine()->IsPartitionable(
       query,
       backend::QueryContext{
-          .schema = txn->schema(), .reader = nullptr, .writer = nullptr}));
-
-  // Add two partitions to result set, with first partition being empty.
-  ZETASQL_ASSIGN_OR_RETURN(auto empty_partition_token,
-                   CreatePartitionTokenForQuery(*request, txn->id(),
-                                                /*empty_partition =*/true));
-  spanner_api::Partition empty_partition;
-  ZETASQL_ASSIGN_OR_RETURN(*empty_partition.mutable_partition_token(),
-                   PartitionTokenToString(empty_partition_token));
-
-  // Second partition contains full result set for requested query.
-  ZETASQL_ASSIGN_OR_RETURN(auto full_partition_token,
-                   CreatePartitionTokenForQuery(*request, txn->id(),
-                                                /*empty_partition =*/false));
-  spanner_api::Partition full_partition;
-  ZETASQL_ASSIGN_OR_RETURN(*full_partition.mutable_partition_token(),
-                   PartitionTokenToString(full_partition_token));
-
-  *response->mutable_partitions()->Add() = empty_partition;
-  *response->mutable_partitions()->Add() = full_partition;
+          .schema = txn->schema(), .reader = nullptr, .writer = nullptr},
+      &root_table));
+
+  // Queries which scan a single table are split by the primary key of that
+  // table. Other queries are returned as a single partition.
+  std::vector<spanner_api::KeySet> key_sets(1);
+  if (root_table != nullptr) {
+    backend::ReadArg read_arg;
+    read_arg.table = root_table->Name();
+    read_arg.key_set = backend::KeySet::All();
+    for (const backend::KeyColumn* key_column : root_table->primary_key()) {
+      read_arg.columns.push_back(key_column->column()->Name());
+    }
+    for (const backend::Column* column : root_table->columns()) {
+      if (root_table->FindKeyColumn(column->Name()) == nullptr) {
+        read_arg.columns.push_back(column->Name());
+      }
+    }
+    ZETASQL_ASSIGN_OR_RETURN(
+        key_sets,
+        SplitIntoKeyRanges(txn.get(), read_arg,
+                           root_table->primary_key().size(),
+                           request->partition_options()));
+  }
+
+  for (const spanner_api::KeySet& key_set : key_sets) {
+    ZETASQL_ASSIGN_OR_RETURN(auto partition_token,
+                     CreatePartitionTokenForQuery(*request, txn->id(),
+                                                  root_table, key_set));
+    ZETASQL_ASSIGN_OR_RETURN(
+        *response->add_partitions()->mutable_partition_token(),
+        PartitionTokenToString(partition_token));
+  }
 
   return absl::OkStatus();
 }
@@ -15,6 +15,7 @@
 //
 
 #include <string>
+#include <vector>
 
 #include "google/spanner/v1/mutation.pb.h"
 #include "google/spanner/v1/spanner.pb.h"
@@ -24,6 +25,8 @@
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "common/errors.h"
 #include "tests/common/test_env.h"
 
@@ -34,6 +37,8 @@ namespace frontend {
 
 namespace {
 
+using ::testing::UnorderedElementsAre;
+using ::zetasql_base::testing::IsOkAndHolds;
 using ::zetasql_base::testing::StatusIs;
 
 namespace spanner_api = ::google::spanner::v1;
@@ -46,6 +51,60 @@ class PartitionApiTest : public test::ServerTest {
     ZETASQL_ASSERT_OK_AND_ASSIGN(test_session_uri_, CreateTestSession());
   }
 
+  // Inserts rows with keys 0 to num_rows - 1 into test_table.
+  absl::Status PopulateTestTable(int num_rows) {
+    spanner_api::CommitRequest commit_request = PARSE_TEXT_PROTO(R"(
+      single_use_transaction { read_write {} }
+      mutations {
+        insert { table: "test_table" columns: "int64_col" columns: "string_col" }
+      }
+    )");
+    commit_request.set_session(test_session_uri_);
+    auto* insert = commit_request.mutable_mutations(0)->mutable_insert();
+    for (int i = 0; i < num_rows; ++i) {
+      auto* row = insert->add_values();
+      row->add_values()->set_string_value(absl::StrCat(i));
+      row->add_values()->set_string_value("value");
+    }
+    spanner_api::CommitResponse commit_response;
+    return Commit(commit_request, &commit_response);
+  }
+
+  absl::StatusOr<std::string> BeginReadOnlyTransaction() {
+    spanner_api::BeginTransactionRequest txn_request = PARSE_TEXT_PROTO(R"(
+      options { read_only {} }
+    )");
+    txn_request.set_session(test_session_uri_);
+    spanner_api::Transaction txn_response;
+    ZETASQL_RETURN_IF_ERROR(BeginTransaction(txn_request, &txn_response));
+    return txn_response.id();
+  }
+
+  // Returns the keys of the rows of test_table read through the given
+  // partitions.
+  absl::StatusOr<std::vector<std::string>> ReadPartitions(
+      const std::string& txn_id,
+      const spanner_api::PartitionResponse& partitions) {
+    std::vector<std::string> keys;
+    for (const auto& partition : partitions.partitions()) {
+      spanner_api::ReadRequest read_request = PARSE_TEXT_PROTO(R"(
+        table: "test_table"
+        columns: "int64_col"
+        columns: "string_col"
+        key_set { all: true }
+      )");
+      read_request.set_session(test_session_uri_);
+      read_request.mutable_transaction()->set_id(txn_id);
+      read_request.set_partition_token(partition.partition_token());
+      spanner_api::ResultSet read_response;
+      ZETASQL_RETURN_IF_ERROR(Read(read_request, &read_response));
+      for (const auto& row : read_response.rows()) {
+        keys.push_back(row.values(0).string_value());
+      }
+    }
+    return keys;
+  }
+
   std::string test_session_uri_;
 };
 
@@ -141,6 +200,110 @@ TEST_F(PartitionApiTest, CannotReadUsingInvalidPartitionOptions) {
               StatusIs(absl::StatusCode::kInvalidArgument));
 }
 
+TEST_F(PartitionApiTest, SplitsReadIntoRequestedNumberOfPartitions) {
+  ZETASQL_ASSERT_OK(PopulateTestTable(/*num_rows=*/10));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::string txn_id, BeginReadOnlyTransaction());
+
+  spanner_api::PartitionReadRequest partition_read_request = PARSE_TEXT_PROTO(
+      R"(
+        table: "test_table"
+        columns: "int64_col"
+        columns: "string_col"
+        key_set { all: true }
+        partition_options { partition_size_bytes: 1 max_partitions: 4 }
+      )");
+  partition_read_request.set_session(test_session_uri_);
+  partition_read_request.mutable_transaction()->set_id(txn_id);
+
+  spanner_api::PartitionResponse partition_read_response;
+  ZETASQL_ASSERT_OK(PartitionRead(partition_read_request, &partition_read_response));
+  EXPECT_EQ(partition_read_response.partitions_size(), 4);
+
+  // Every row is read by exactly one partition.
+  EXPECT_THAT(ReadPartitions(txn_id, partition_read_response),
+              IsOkAndHolds(UnorderedElementsAre("0", "1", "2", "3", "4", "5",
+                                                "6", "7", "8", "9")));
+}
+
+TEST_F(PartitionApiTest, PartitionsOnlyReadRequestedKeys) {
+  ZETASQL_ASSERT_OK(PopulateTestTable(/*num_rows=*/10));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::string txn_id, BeginReadOnlyTransaction());
+
+  spanner_api::PartitionReadRequest partition_read_request = PARSE_TEXT_PROTO(
+      R"(
+        table: "test_table"
+        columns: "int64_col"
+        columns: "string_col"
+        key_set {
+          keys { values { string_value: "1" } }
+          ranges {
+            start_closed { values { string_value: "5" } }
+            end_open { values { string_value: "8" } }
+          }
+        }
+        partition_options { partition_size_bytes: 1 max_partitions: 10 }
+      )");
+  partition_read_request.set_session(test_session_uri_);
+  partition_read_request.mutable_transaction()->set_id(txn_id);
+
+  spanner_api::PartitionResponse partition_read_response;
+  ZETASQL_ASSERT_OK(PartitionRead(partition_read_request, &partition_read_response));
+  EXPECT_EQ(partition_read_response.partitions_size(), 4);
+
+  // The partitions are read with the key set they were created for.
+  std::vector<std::string> keys;
+  for (const auto& partition : partition_read_response.partitions()) {
+    spanner_api::ReadRequest read_request;
+    read_request.set_session(test_session_uri_);
+    read_request.mutable_transaction()->set_id(txn_id);
+    read_request.set_table("test_table");
+    *read_request.mutable_columns() = partition_read_request.columns();
+    *read_request.mutable_key_set() = partition_read_request.key_set();
+    read_request.set_partition_token(partition.partition_token());
+    spanner_api::ResultSet read_response;
+    ZETASQL_ASSERT_OK(Read(read_request, &read_response));
+    for (const auto& row : read_response.rows()) {
+      keys.push_back(row.values(0).string_value());
+    }
+  }
+  EXPECT_THAT(keys, UnorderedElementsAre("1", "5", "6", "7"));
+}
+
+TEST_F(PartitionApiTest, SplitsSimpleScanQueryByPrimaryKey) {
+  ZETASQL_ASSERT_OK(PopulateTestTable(/*num_rows=*/10));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::string txn_id, BeginReadOnlyTransaction());
+
+  spanner_api::PartitionQueryRequest partition_query_request =
+      PARSE_TEXT_PROTO(R"(
+        sql: "SELECT int64_col FROM test_table"
+        partition_options { partition_size_bytes: 1 max_partitions: 3 }
+      )");
+  partition_query_request.set_session(test_session_uri_);
+  partition_query_request.mutable_transaction()->set_id(txn_id);
+
+  spanner_api::PartitionResponse partition_query_response;
+  ZETASQL_ASSERT_OK(
+      PartitionQuery(partition_query_request, &partition_query_response));
+  EXPECT_EQ(partition_query_response.partitions_size(), 3);
+
+  std::vector<std::string> keys;
+  for (const auto& partition : partition_query_response.partitions()) {
+    spanner_api::ExecuteSqlRequest sql_request;
+    sql_request.set_session(test_session_uri_);
+    sql_request.mutable_transaction()->set_id(txn_id);
+    sql_request.set_sql(partition_query_request.sql());
+    sql_request.set_partition_token(partition.partition_token());
+    spanner_api::ResultSet sql_response;
+    ZETASQL_ASSERT_OK(ExecuteSql(sql_request, &sql_response));
+    EXPECT_GT(sql_response.rows_size(), 0);
+    for (const auto& row : sql_response.rows()) {
+      keys.push_back(row.values(0).string_value());
+    }
+  }
+  EXPECT_THAT(keys, UnorderedElementsAre("0", "1", "2", "3", "4", "5", "6",
+                                         "7", "8", "9"));
+}
+
 }  // namespace
 
 }  // namespace frontend
@@ -14,6 +14,7 @@
 // limitations under the License.
 //
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -27,21 +28,33 @@
 #include "google/spanner/v1/spanner.pb.h"
 #include "google/spanner/v1/transaction.pb.h"
 #include "zetasql/public/analyzer_options.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
 #include "backend/access/read.h"
+#include "backend/datamodel/key_set.h"
 #include "backend/query/change_stream/change_stream_query_validator.h"
 #include "backend/query/query_engine.h"
+#include "backend/query/query_memory_budget.h"
+#include "common/config.h"
 #include "common/constants.h"
 #include "common/errors.h"
+#include "common/limits.h"
 #include "frontend/common/protos.h"
 #include "frontend/common/validations.h"
+#include "frontend/converters/change_streams.h"
+#include "frontend/converters/keys.h"
 #include "frontend/converters/partition.h"
 #include "frontend/converters/query.h"
 #include "frontend/converters/reads.h"
+#include "frontend/converters/resume_token.h"
 #include "frontend/converters/types.h"
 #include "frontend/converters/values.h"
 #include "frontend/entities/session.h"
@@ -141,14 +154,109 @@ absl::Status ValidatePartitionToken(
   return absl::OkStatus();
 }
 
+// Restricts a partitioned query to the rows of its root table within the
+// partition, if the partition token was created for such a partition.
+absl::Status AddQueryPartitionFromPartitionToken(
+    const PartitionToken& partition_token, const backend::Schema& schema,
+    backend::Query* query) {
+  if (!partition_token.has_partitioned_key_set()) {
+    return absl::OkStatus();
+  }
+  const std::string& table_name = partition_token.query_params().root_table();
+  const backend::Table* table = schema.FindTable(table_name);
+  if (table == nullptr) {
+    return error::TableNotFound(table_name);
+  }
+  ZETASQL_ASSIGN_OR_RETURN(
+      backend::KeySet key_set,
+      KeySetFromProto(partition_token.partitioned_key_set(), *table));
+  query->partition = backend::QueryPartition{.table_name = table->Name(),
+                                             .key_set = std::move(key_set)};
+  return absl::OkStatus();
+}
+
 void AddQueryStatsFromQueryResult(const backend::QueryResult& result,
                                   google::protobuf::Struct* stats) {
+  int64_t rows_scanned = 0;
+  int64_t bytes_read = 0;
+  for (const backend::TableScanStats& scan : result.table_scans) {
+    rows_scanned += scan.rows_scanned;
+    bytes_read += scan.bytes_read;
+  }
   (*stats->mutable_fields())["rows_returned"].set_string_value(
       absl::StrCat(result.num_output_rows));
+  (*stats->mutable_fields())["rows_scanned"].set_string_value(
+      absl::StrCat(rows_scanned));
+  (*stats->mutable_fields())["data_bytes_read"].set_string_value(
+      absl::StrCat(bytes_read));
   (*stats->mutable_fields())["elapsed_time"].set_string_value(
       absl::FormatDuration(result.elapsed_time));
 }
 
+// Sets `unit` and `total` of an execution statistic of a plan node, in the
+// format used by Cloud Spanner.
+void SetExecutionStat(absl::string_view name, absl::string_view unit,
+                      absl::string_view total,
+                      google::protobuf::Struct* stats) {
+  auto* fields = (*stats->mutable_fields())[std::string(name)]
+                     .mutable_struct_value()
+                     ->mutable_fields();
+  (*fields)["unit"].set_string_value(std::string(unit));
+  (*fields)["total"].set_string_value(std::string(total));
+}
+
+std::string FormatMilliseconds(absl::Duration duration) {
+  return absl::StrFormat("%.3f", absl::ToDoubleMilliseconds(duration));
+}
+
+// Adds the query plan of a query executed in PROFILE mode. The emulator does
+// not expose the operators of the ZetaSQL reference implementation, so the
+// plan has a root node for the whole query with one child per table or index
+// scan. Scans which read the whole table or index are flagged as full scans.
+void AddProfiledQueryPlan(const backend::QueryResult& result,
+                          v1::ResultSetStats* stats) {
+  v1::QueryPlan* plan = stats->mutable_query_plan();
+  v1::PlanNode* root = plan->add_plan_nodes();
+  root->set_index(0);
+  root->set_kind(v1::PlanNode::RELATIONAL);
+  root->set_display_name("Serialize Result");
+  SetExecutionStat("rows", "rows", absl::StrCat(result.num_output_rows),
+                   root->mutable_execution_stats());
+  SetExecutionStat("latency", "msecs", FormatMilliseconds(result.elapsed_time),
+                   root->mutable_execution_stats());
+
+  for (const backend::TableScanStats& scan : result.table_scans) {
+    v1::PlanNode* node = plan->add_plan_nodes();
+    node->set_index(plan->plan_nodes_size() - 1);
+    node->set_kind(v1::PlanNode::RELATIONAL);
+    node->set_display_name("Scan");
+    root->add_child_links()->set_child_index(node->index());
+
+    auto* metadata = node->mutable_metadata()->mutable_fields();
+    (*metadata)["scan_type"].set_string_value(scan.index.empty() ? "TableScan"
+                                                                 : "IndexScan");
+    (*metadata)["scan_target"].set_string_value(
+        scan.index.empty() ? scan.table : scan.index);
+    if (scan.full_scan) {
+      (*metadata)["Full scan"].set_string_value("true");
+    }
+
+    google::protobuf::Struct* execution_stats = node->mutable_execution_stats();
+    SetExecutionStat("rows", "rows", absl::StrCat(scan.rows_scanned),
+                     execution_stats);
+    SetExecutionStat("scanned_rows", "rows", absl::StrCat(scan.rows_scanned),
+                     execution_stats);
+    SetExecutionStat("bytes_read", "bytes", absl::StrCat(scan.bytes_read),
+                     execution_stats);
+    SetExecutionStat("latency", "msecs", FormatMilliseconds(scan.latency),
+                     execution_stats);
+    (*(*execution_stats->mutable_fields())["execution_summary"]
+          .mutable_struct_value()
+          ->mutable_fields())["num_executions"]
+        .set_string_value(absl::StrCat(scan.num_executions));
+  }
+}
+
 void AddEmptyQueryPlan(v1::ResultSetStats* stats) {
   auto node = stats->mutable_query_plan()->add_plan_nodes();
   auto display_name = std::string("No query plan");
@@ -168,17 +276,6 @@ absl::Status AddUndeclaredParametersFromQueryResult(
   return absl::OkStatus();
 }
 
-absl::StatusOr<backend::QueryResult> ExecuteQuery(
-    const spanner_api::ExecuteBatchDmlRequest_Statement& statement,
-    std::shared_ptr<Transaction> txn) {
-  ZETASQL_ASSIGN_OR_RETURN(const backend::Query query,
-                   QueryFromProto(statement.sql(), statement.params(),
-                                  statement.param_types(),
-                                  txn->query_engine()->type_factory(),
-                                  txn->schema()->proto_bundle()));
-  return txn->ExecuteSql(query);
-}
-
 template <typename Request>
 int64_t SerializeAndHashRequest(const Request& request) {
   std::string serialized_request;
@@ -280,11 +377,27 @@ absl::Status ExecuteSql(RequestContext* ctx,
         }
 
         // Convert and execute provided SQL statement.
-        ZETASQL_ASSIGN_OR_RETURN(const backend::Query query,
+        ZETASQL_ASSIGN_OR_RETURN(backend::Query query,
                          QueryFromProto(request->sql(), request->params(),
                                         request->param_types(),
                                         txn->query_engine()->type_factory(),
                                         txn->schema()->proto_bundle()));
+        query.check_cancelled = [ctx]() { return ctx->CheckNotCancelled(); };
+        // The whole response is buffered, so it is charged to the memory
+        // budget of the query along with the rows it is converted from.
+        backend::QueryMemoryBudget memory_budget(
+            config::query_memory_limit_bytes());
+        query.memory_budget = &memory_budget;
+        bool empty_query_partition = false;
+        if (!request->partition_token().empty()) {
+          ZETASQL_ASSIGN_OR_RETURN(
+              auto partition_token,
+              PartitionTokenFromString(request->partition_token()));
+          ZETASQL_RETURN_IF_ERROR(ValidatePartitionToken(partition_token, request));
+          ZETASQL_RETURN_IF_ERROR(AddQueryPartitionFromPartitionToken(
+              partition_token, *txn->schema(), &query));
+          empty_query_partition = partition_token.empty_query_partition();
+        }
         auto maybe_result = txn->ExecuteSql(query, request->query_mode());
         if (!maybe_result.ok()) {
           absl::Status error = maybe_result.status();
@@ -327,28 +440,20 @@ absl::Status ExecuteSql(RequestContext* ctx,
           ZETASQL_RETURN_IF_ERROR(RowCursorToResultSetProto(result.rows.get(),
                                                     /*limit=*/0, response));
         }
+        ZETASQL_RETURN_IF_ERROR(memory_budget.Consume(response->ByteSizeLong()));
 
-        if (!request->partition_token().empty()) {
-          ZETASQL_ASSIGN_OR_RETURN(
-              auto partition_token,
-              PartitionTokenFromString(request->partition_token()));
-          ZETASQL_RETURN_IF_ERROR(ValidatePartitionToken(partition_token, request));
-          if (partition_token.empty_query_partition()) {
-            response->clear_rows();
-          }
+        if (empty_query_partition) {
+          response->clear_rows();
         }
 
-        // Add basic stats for PROFILE mode. We do this to interoperate with
-        // REPL applications written for Cloud Spanner. The profile will not
-        // contain statistics for plan nodes.
+        // Add query stats and a plan with the statistics of the table scans
+        // for PROFILE mode, and an empty query plan for PLAN mode.
         if (request->query_mode() == spanner_api::ExecuteSqlRequest::PROFILE) {
           AddQueryStatsFromQueryResult(
               result, response->mutable_stats()->mutable_query_stats());
-        }
-        // Add an empty query plan if the user requested either PLAN or PROFILE
-        // query mode.
-        if (request->query_mode() == spanner_api::ExecuteSqlRequest::PLAN ||
-            request->query_mode() == spanner_api::ExecuteSqlRequest::PROFILE) {
+          AddProfiledQueryPlan(result, response->mutable_stats());
+        } else if (request->query_mode() ==
+                   spanner_api::ExecuteSqlRequest::PLAN) {
           AddEmptyQueryPlan(response->mutable_stats());
         }
 
@@ -362,9 +467,11 @@ REGISTER_GRPC_HANDLER(Spanner, ExecuteSql);
 
 // Executes a SQL statement, returning all results as a stream.
 //
-// resume_tokens is not supported in the emulator. This implementation does not
-// limit the size of the response and therefore, chunked_value will always be
-// false.
+// Responses of queries which end on a row boundary carry a resume token, from
+// which an interrupted stream is resumed at the following row. A resumed
+// single-use read-only transaction reads the snapshot of the interrupted one.
+// DML statements cannot be resumed, and change stream queries use their own
+// resume tokens.
 absl::Status ExecuteStreamingSql(
     RequestContext* ctx, const spanner_api::ExecuteSqlRequest* request,
     ServerStream<spanner_api::PartialResultSet>* stream) {
@@ -381,8 +488,20 @@ absl::Status ExecuteStreamingSql(
 
   ZETASQL_RETURN_IF_ERROR(ValidateTransactionSelectorForQuery(request->transaction(),
                                                       is_dml_query));
+
+  // Get the position to resume the stream from.
+  ResumeToken resume_from;
+  if (request->resume_token() != kChangeStreamDummyResumeToken) {
+    if (is_dml_query && !request->resume_token().empty()) {
+      return error::InvalidResumeToken();
+    }
+    ZETASQL_ASSIGN_OR_RETURN(resume_from,
+                     ResumeTokenFromString(request->resume_token()));
+  }
+
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Transaction> txn,
-                   session->FindOrInitTransaction(request->transaction()));
+                   session->FindOrInitTransaction(ResumedTransactionSelector(
+                       request->transaction(), resume_from)));
   ZETASQL_RETURN_IF_ERROR(
       ValidateDirectedReadsOption(request->directed_read_options(), txn));
 
@@ -435,22 +554,36 @@ absl::Status ExecuteStreamingSql(
           ZETASQL_ASSIGN_OR_RETURN(absl::Time read_timestamp, txn->GetReadTimestamp());
           ZETASQL_RETURN_IF_ERROR(ValidateReadTimestampNotTooFarInFuture(
               read_timestamp, ctx->env()->clock()->Now()));
+          ZETASQL_RETURN_IF_ERROR(
+              SetResumeTokenReadTimestamp(read_timestamp, &resume_from));
         }
         // Convert and execute provided SQL statement.
-        ZETASQL_ASSIGN_OR_RETURN(const backend::Query query,
+        ZETASQL_ASSIGN_OR_RETURN(backend::Query query,
                          QueryFromProto(request->sql(), request->params(),
                                         request->param_types(),
                                         txn->query_engine()->type_factory(),
                                         txn->schema()->proto_bundle()));
+        query.check_cancelled = [ctx]() { return ctx->CheckNotCancelled(); };
         bool in_read_write_txn = txn->IsReadWrite() || txn->IsPartitionedDml();
         ZETASQL_ASSIGN_OR_RETURN(change_stream_metadata,
-                         backend::QueryEngine::TryGetChangeStreamMetadata(
+                         txn->query_engine()->TryGetChangeStreamMetadata(
                              query, txn->schema(), in_read_write_txn));
         // if current query is a change stream query, return and exit current
         // transaction lambda to avoid nested transaction call.
         if (change_stream_metadata.is_change_stream_query) {
           return absl::OkStatus();
         }
+        bool empty_query_partition = false;
+        if (!request->partition_token().empty()) {
+          ZETASQL_ASSIGN_OR_RETURN(
+              auto partition_token,
+              PartitionTokenFromString(request->partition_token()));
+          ZETASQL_RETURN_IF_ERROR(ValidatePartitionToken(partition_token, request));
+          ZETASQL_RETURN_IF_ERROR(AddQueryPartitionFromPartitionToken(
+              partition_token, *txn->schema(), &query));
+          empty_query_partition = partition_token.empty_query_partition();
+        }
+
         auto maybe_result = txn->ExecuteSql(query, request->query_mode());
         if (!maybe_result.ok()) {
           absl::Status error = maybe_result.status();
@@ -463,70 +596,68 @@ absl::Status ExecuteStreamingSql(
         }
         backend::QueryResult& result = maybe_result.value();
 
-        std::vector<spanner_api::PartialResultSet> responses;
-        if (is_dml_query) {
-          responses.emplace_back();
-          if (result.rows == nullptr) {
-            // Set empty row type.
-            responses.back().mutable_metadata()->mutable_row_type();
-          } else {
-            // It contains DML THEN RETURN row results.
-            ZETASQL_ASSIGN_OR_RETURN(responses, RowCursorToPartialResultSetProtos(
-                                            result.rows.get(), /*limit=*/0));
+        // Responses are sent as the result rows are converted. The first
+        // response carries the result set metadata and the last one carries
+        // the DML row count.
+        spanner_api::ResultSet replay_result;
+        bool is_first_response = true;
+        auto send = [&](spanner_api::PartialResultSet* response,
+                        bool is_last) -> absl::Status {
+          if (is_first_response) {
+            is_first_response = false;
+            // Populate transaction metadata.
+            if (ShouldReturnTransaction(request->transaction())) {
+              ZETASQL_ASSIGN_OR_RETURN(
+                  *response->mutable_metadata()->mutable_transaction(),
+                  txn->ToProto());
+            }
+            // Return query parameter types.
+            ZETASQL_RETURN_IF_ERROR(AddUndeclaredParametersFromQueryResult(
+                &result.parameter_types, response->mutable_metadata()));
+
+            // Add query stats and a plan with the statistics of the table
+            // scans for PROFILE mode.
+            if (request->query_mode() ==
+                spanner_api::ExecuteSqlRequest::PROFILE) {
+              AddQueryStatsFromQueryResult(
+                  result, response->mutable_stats()->mutable_query_stats());
+              AddProfiledQueryPlan(result, response->mutable_stats());
+            }
+            *replay_result.mutable_metadata() = response->metadata();
           }
-          if (txn->IsPartitionedDml()) {
-            responses.back().mutable_stats()->set_row_count_lower_bound(
-                result.modified_row_count);
-          } else {
-            responses.back().mutable_stats()->set_row_count_exact(
-                result.modified_row_count);
+          if (is_last && is_dml_query) {
+            if (txn->IsPartitionedDml()) {
+              response->mutable_stats()->set_row_count_lower_bound(
+                  result.modified_row_count);
+            } else {
+              response->mutable_stats()->set_row_count_exact(
+                  result.modified_row_count);
+            }
+            *replay_result.mutable_stats() = response->stats();
           }
+          stream->Send(*response);
+          return absl::OkStatus();
+        };
+
+        if (result.rows == nullptr) {
+          // DML without THEN RETURN has an empty row type.
+          spanner_api::PartialResultSet response;
+          response.mutable_metadata()->mutable_row_type();
+          ZETASQL_RETURN_IF_ERROR(send(&response, /*is_last=*/true));
+        } else if (empty_query_partition) {
+          // Return only metadata for an empty partition.
+          spanner_api::PartialResultSet response;
+          ZETASQL_RETURN_IF_ERROR(ResultSetMetadataToProto(
+              result.rows.get(), response.mutable_metadata()));
+          ZETASQL_RETURN_IF_ERROR(send(&response, /*is_last=*/true));
         } else {
-          ZETASQL_ASSIGN_OR_RETURN(responses, RowCursorToPartialResultSetProtos(
-                                          result.rows.get(), /*limit=*/0));
-        }
-
-        if (!request->partition_token().empty()) {
-          ZETASQL_ASSIGN_OR_RETURN(
-              auto partition_token,
-              PartitionTokenFromString(request->partition_token()));
-          ZETASQL_RETURN_IF_ERROR(ValidatePartitionToken(partition_token, request));
-          if (partition_token.empty_query_partition()) {
-            // Clear all partial responses except the first one. Return only
-            // metadata in the first partial response.
-            responses.resize(1);
-            responses.front().clear_values();
-            responses.front().clear_chunked_value();
-          }
-        }
-
-        // Populate transaction metadata.
-        if (ShouldReturnTransaction(request->transaction())) {
-          ZETASQL_ASSIGN_OR_RETURN(
-              *responses.front().mutable_metadata()->mutable_transaction(),
-              txn->ToProto());
-        }
-        // Return query parameter types.
-        ZETASQL_RETURN_IF_ERROR(AddUndeclaredParametersFromQueryResult(
-            &result.parameter_types, responses.front().mutable_metadata()));
-
-        // Add basic stats for PROFILE mode. We do this to interoperate with
-        // REPL applications written for Cloud Spanner. The profile will not
-        // contain statistics for plan nodes.
-        if (request->query_mode() == spanner_api::ExecuteSqlRequest::PROFILE) {
-          AddQueryStatsFromQueryResult(
-              result, responses.front().mutable_stats()->mutable_query_stats());
-        }
-
-        // Send results back to client.
-        for (const auto& response : responses) {
-          stream->Send(response);
+          ZETASQL_RETURN_IF_ERROR(StreamRowCursorToPartialResultSetProtos(
+              result.rows.get(), /*limit=*/0, send,
+              limits::kMaxStreamingChunkSize,
+              is_dml_query ? nullptr : &resume_from));
         }
 
         if (is_dml_query) {
-          spanner_api::ResultSet replay_result;
-          *replay_result.mutable_stats() = responses[0].stats();
-          *replay_result.mutable_metadata() = responses[0].metadata();
           txn->SetDmlReplayOutcome(replay_result);
         }
         return absl::OkStatus();
@@ -603,32 +734,49 @@ absl::Status ExecuteBatchDml(RequestContext* ctx,
       return error::CannotReadOrQueryAfterCommitOrRollback();
     }
 
+    // Convert the statements up to the first one which cannot be executed.
+    // Batches often repeat the same statement with different parameters, so
+    // each distinct statement is classified once. Its analysis is shared
+    // through the analyzed query cache of the query engine.
+    std::vector<backend::Query> queries;
+    queries.reserve(request->statements_size());
+    absl::flat_hash_map<std::string, bool> is_dml_query;
+    absl::Status statement_error;
     for (int index = 0; index < request->statements_size(); ++index) {
       const auto& statement = request->statements(index);
-      if (!backend::IsDMLQuery(statement.sql())) {
-        absl::Status error = error::ExecuteBatchDmlOnlySupportsDmlStatements(
+      auto [itr, inserted] = is_dml_query.try_emplace(statement.sql());
+      if (inserted) {
+        itr->second = backend::IsDMLQuery(statement.sql());
+      }
+      if (!itr->second) {
+        statement_error = error::ExecuteBatchDmlOnlySupportsDmlStatements(
             index, statement.sql());
-        *response->mutable_status() = StatusToProto(error);
-        txn->SetDmlReplayOutcome(*response);
-        return absl::OkStatus();
+        break;
       }
-
-      const auto maybe_result = ExecuteQuery(statement, txn);
-      if (!maybe_result.ok() &&
-          maybe_result.status().code() != absl::StatusCode::kAborted) {
-        absl::Status error = maybe_result.status();
-        *response->mutable_status() = StatusToProto(error);
-        txn->SetDmlReplayOutcome(*response);
-        txn->MaybeInvalidate(error);
-        return absl::OkStatus();
-      } else if (maybe_result.status().code() == absl::StatusCode::kAborted) {
-        return maybe_result.status();
+      absl::StatusOr<backend::Query> query = QueryFromProto(
+          statement.sql(), statement.params(), statement.param_types(),
+          txn->query_engine()->type_factory(), txn->schema()->proto_bundle());
+      if (!query.ok()) {
+        statement_error = query.status();
+        break;
       }
+      query->check_cancelled = [ctx]() { return ctx->CheckNotCancelled(); };
+      queries.push_back(*std::move(query));
+    }
 
-      const auto& result = maybe_result.value();
+    std::vector<backend::QueryResult> results;
+    absl::Status error = txn->ExecuteBatchDml(queries, &results);
+    if (error.code() == absl::StatusCode::kAborted) {
+      return error;
+    }
+    if (error.ok()) {
+      error = statement_error;
+    }
+
+    for (int index = 0; index < results.size(); ++index) {
       spanner_api::ResultSet* result_set = response->add_result_sets();
       result_set->mutable_stats()->set_row_count_exact(
-          result.modified_row_count);
+          results[index].modified_row_count);
 
       // Only populate metadata for first result set.
       if (index == 0) {
@@ -640,6 +788,12 @@ absl::Status ExecuteBatchDml(RequestContext* ctx,
         }
       }
     }
+    if (!error.ok()) {
+      *response->mutable_status() = StatusToProto(error);
+      txn->SetDmlReplayOutcome(*response);
+      txn->MaybeInvalidate(error);
+      return absl::OkStatus();
+    }
 
     // Set the replay outcome.
     txn->SetDmlReplayOutcome(*response);
@@ -321,6 +321,45 @@ TEST_F(QueryApiTest, ExecuteSql) {
                             )"));
 }
 
+TEST_F(QueryApiTest, ExecuteSqlInProfileModeReturnsTableScanStats) {
+  spanner_api::ExecuteSqlRequest request = PARSE_TEXT_PROTO(
+      R"(
+        transaction { single_use { read_only { strong: true } } }
+        sql: "SELECT int64_col FROM test_table"
+        query_mode: PROFILE
+      )");
+  request.set_session(test_session_uri_);
+
+  spanner_api::ResultSet response;
+  ZETASQL_ASSERT_OK(ExecuteSql(request, &response));
+  EXPECT_EQ(response.rows_size(), 3);
+
+  const auto& query_stats = response.stats().query_stats().fields();
+  EXPECT_EQ(query_stats.at("rows_returned").string_value(), "3");
+  EXPECT_EQ(query_stats.at("rows_scanned").string_value(), "3");
+
+  const spanner_api::QueryPlan& plan = response.stats().query_plan();
+  ASSERT_EQ(plan.plan_nodes_size(), 2);
+  EXPECT_EQ(plan.plan_nodes(0).display_name(), "Serialize Result");
+  ASSERT_EQ(plan.plan_nodes(0).child_links_size(), 1);
+  EXPECT_EQ(plan.plan_nodes(0).child_links(0).child_index(), 1);
+
+  const spanner_api::PlanNode& scan = plan.plan_nodes(1);
+  EXPECT_EQ(scan.display_name(), "Scan");
+  const auto& metadata = scan.metadata().fields();
+  EXPECT_EQ(metadata.at("scan_type").string_value(), "TableScan");
+  EXPECT_EQ(metadata.at("scan_target").string_value(), "test_table");
+  EXPECT_EQ(metadata.at("Full scan").string_value(), "true");
+  EXPECT_EQ(scan.execution_stats()
+                .fields()
+                .at("rows")
+                .struct_value()
+                .fields()
+                .at("total")
+                .string_value(),
+            "3");
+}
+
 TEST_F(QueryApiTest, ExecuteSqlWithParameters) {
   spanner_api::ExecuteSqlRequest request = PARSE_TEXT_PROTO(
       R"(
@@ -21,10 +21,14 @@
 #include "google/spanner/v1/result_set.pb.h"
 #include "google/spanner/v1/spanner.pb.h"
 #include "google/spanner/v1/transaction.pb.h"
+#include "absl/strings/string_view.h"
 #include "backend/common/ids.h"
+#include "common/constants.h"
 #include "common/errors.h"
+#include "common/limits.h"
 #include "frontend/common/protos.h"
 #include "frontend/common/validations.h"
+#include "frontend/converters/resume_token.h"
 #include "frontend/entities/session.h"
 #include "frontend/entities/transaction.h"
 #include "frontend/server/handler.h"
@@ -50,6 +54,23 @@ absl::Status ValidateReadTimestampNotTooFarInFuture(absl::Time read_timestamp,
   return absl::OkStatus();
 }
 
+// Returns true if the client asked for the columnar encoding of read results
+// in the request metadata.
+bool UseColumnarResultEncoding(RequestContext* ctx) {
+  if (ctx->grpc() == nullptr) {
+    return false;
+  }
+  auto range =
+      ctx->grpc()->client_metadata().equal_range(kResultEncodingHeader);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (absl::string_view(it->second.data(), it->second.size()) ==
+        kColumnarResultEncoding) {
+      return true;
+    }
+  }
+  return false;
+}
+
 absl::Status ValidateTransactionSelectorForRead(
     const spanner_api::TransactionSelector& selector) {
   if (selector.selector_case() ==
@@ -113,9 +134,14 @@ REGISTER_GRPC_HANDLER(Spanner, Read);
 
 // Reads rows from the database, returning all results as a stream.
 //
-// StreamingReads do not support resume_tokens in the emulator. This
-// implementation does not limit the size of the response and therefore,
-// chunked_value will always be false.
+// Responses which end on a row boundary carry a resume token, from which an
+// interrupted stream is resumed at the following row. A resumed single-use
+// read-only transaction reads the snapshot of the interrupted one.
+//
+// Clients which set kResultEncodingHeader to kColumnarResultEncoding in the
+// request metadata receive the rows as columnar batches instead, see
+// StreamRowCursorToColumnarPartialResultSets. Columnar streams cannot be
+// resumed.
 absl::Status StreamingRead(
     RequestContext* ctx, const spanner_api::ReadRequest* request,
     ServerStream<spanner_api::PartialResultSet>* stream) {
@@ -123,10 +149,19 @@ absl::Status StreamingRead(
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
                    GetSession(ctx, request->session()));
 
+  // Get the position to resume the stream from.
+  const bool use_columnar_encoding = UseColumnarResultEncoding(ctx);
+  if (use_columnar_encoding && !request->resume_token().empty()) {
+    return error::InvalidResumeToken();
+  }
+  ZETASQL_ASSIGN_OR_RETURN(ResumeToken resume_from,
+                   ResumeTokenFromString(request->resume_token()));
+
   // Get underlying transaction.
   ZETASQL_RETURN_IF_ERROR(ValidateTransactionSelectorForRead(request->transaction()));
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Transaction> txn,
-                   session->FindOrInitTransaction(request->transaction()));
+                   session->FindOrInitTransaction(ResumedTransactionSelector(
+                       request->transaction(), resume_from)));
   ZETASQL_RETURN_IF_ERROR(
       ValidateDirectedReadsOption(request->directed_read_options(), txn));
 
@@ -143,6 +178,8 @@ absl::Status StreamingRead(
       ZETASQL_ASSIGN_OR_RETURN(absl::Time read_timestamp, txn->GetReadTimestamp());
       ZETASQL_RETURN_IF_ERROR(ValidateReadTimestampNotTooFarInFuture(
           read_timestamp, ctx->env()->clock()->Now()));
+      ZETASQL_RETURN_IF_ERROR(
+          SetResumeTokenReadTimestamp(read_timestamp, &resume_from));
     }
 
     // Parse read request.
@@ -153,23 +190,28 @@ absl::Status StreamingRead(
     std::unique_ptr<backend::RowCursor> cursor;
     ZETASQL_RETURN_IF_ERROR(txn->Read(read_arg, &cursor));
 
-    // Convert read results to protos.
-    ZETASQL_ASSIGN_OR_RETURN(
-        std::vector<spanner_api::PartialResultSet> responses,
-        RowCursorToPartialResultSetProtos(cursor.get(), request->limit()));
-
-    // Populate transaction metadata.
-    if (ShouldReturnTransaction(request->transaction())) {
-      ZETASQL_ASSIGN_OR_RETURN(
-          *responses.front().mutable_metadata()->mutable_transaction(),
-          txn->ToProto());
-    }
-
-    // Send results back to client.
-    for (const auto& response : responses) {
-      stream->Send(response);
+    // Convert read results to protos and send them back to the client as
+    // they are produced.
+    bool is_first_response = true;
+    auto send = [&](spanner_api::PartialResultSet* response,
+                    bool is_last) -> absl::Status {
+      // Populate transaction metadata.
+      if (is_first_response &&
+          ShouldReturnTransaction(request->transaction())) {
+        ZETASQL_ASSIGN_OR_RETURN(*response->mutable_metadata()->mutable_transaction(),
+                         txn->ToProto());
+      }
+      is_first_response = false;
+      stream->Send(*response);
+      return absl::OkStatus();
+    };
+    if (use_columnar_encoding) {
+      return StreamRowCursorToColumnarPartialResultSets(
+          cursor.get(), request->limit(), send);
     }
-    return absl::OkStatus();
+    return StreamRowCursorToPartialResultSetProtos(
+        cursor.get(), request->limit(), send, limits::kMaxStreamingChunkSize,
+        &resume_from);
   });
 }
 REGISTER_GRPC_HANDLER(Spanner, StreamingRead);
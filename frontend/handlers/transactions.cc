@@ -14,16 +14,34 @@
 // limitations under the License.
 //
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <numeric>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
 
 #include "google/protobuf/empty.pb.h"
+#include "google/protobuf/struct.pb.h"
+#include "google/protobuf/timestamp.pb.h"
 #include "google/spanner/v1/commit_response.pb.h"
 #include "google/spanner/v1/mutation.pb.h"
 #include "google/spanner/v1/spanner.pb.h"
 #include "google/spanner/v1/transaction.pb.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/table.h"
 #include "common/errors.h"
+#include "common/limits.h"
+#include "frontend/common/protos.h"
 #include "frontend/converters/mutations.h"
 #include "frontend/converters/time.h"
 #include "frontend/entities/session.h"
@@ -164,6 +182,263 @@ absl::Status Rollback(RequestContext* ctx,
 }
 REGISTER_GRPC_HANDLER(Spanner, Rollback);
 
+namespace {
+
+// Identifies a row written by a mutation, or a whole table if the row cannot
+// be determined from the mutation (e.g. a range delete).
+using RowToken = std::pair<const backend::Table*, std::string>;
+
+// Returns the token of the row whose key column values are `values`.
+RowToken MakeRowToken(const backend::Table* table,
+                      const std::vector<const protobuf_api::Value*>& values) {
+  std::string encoded_key;
+  for (const protobuf_api::Value* value : values) {
+    // Length-prefix each value so that different keys never collide.
+    std::string encoded_value = value->SerializeAsString();
+    absl::StrAppend(&encoded_key, encoded_value.size(), ":", encoded_value);
+  }
+  return {table, std::move(encoded_key)};
+}
+
+// Adds the rows written by `mutation` to `rows`. Tables for which the written
+// rows cannot be determined are added to `tables` instead.
+void AddMutationFootprint(const backend::Schema& schema,
+                          const spanner_api::Mutation& mutation,
+                          std::vector<RowToken>* rows,
+                          absl::flat_hash_set<const backend::Table*>* tables) {
+  const spanner_api::Mutation::Write* write = nullptr;
+  switch (mutation.operation_case()) {
+    case spanner_api::Mutation::kInsert:
+      write = &mutation.insert();
+      break;
+    case spanner_api::Mutation::kUpdate:
+      write = &mutation.update();
+      break;
+    case spanner_api::Mutation::kInsertOrUpdate:
+      write = &mutation.insert_or_update();
+      break;
+    case spanner_api::Mutation::kReplace:
+      write = &mutation.replace();
+      break;
+    case spanner_api::Mutation::kDelete: {
+      const backend::Table* table =
+          schema.FindTable(mutation.delete_().table());
+      if (table == nullptr) {
+        return;
+      }
+      const spanner_api::KeySet& key_set = mutation.delete_().key_set();
+      if (key_set.all() || key_set.ranges_size() > 0) {
+        tables->insert(table);
+        return;
+      }
+      for (const protobuf_api::ListValue& key : key_set.keys()) {
+        std::vector<const protobuf_api::Value*> values;
+        for (const protobuf_api::Value& value : key.values()) {
+          values.push_back(&value);
+        }
+        rows->push_back(MakeRowToken(table, values));
+      }
+      return;
+    }
+    case spanner_api::Mutation::OPERATION_NOT_SET:
+      return;
+  }
+
+  // Invalid mutations only fail their own commit, they do not conflict.
+  const backend::Table* table = schema.FindTable(write->table());
+  if (table == nullptr) {
+    return;
+  }
+  absl::flat_hash_map<std::string, int> column_index;
+  for (int i = 0; i < write->columns_size(); ++i) {
+    column_index[absl::AsciiStrToLower(write->columns(i))] = i;
+  }
+  std::vector<int> key_column_index;
+  for (const backend::KeyColumn* key_column : table->primary_key()) {
+    auto itr =
+        column_index.find(absl::AsciiStrToLower(key_column->column()->Name()));
+    if (itr == column_index.end()) {
+      tables->insert(table);
+      return;
+    }
+    key_column_index.push_back(itr->second);
+  }
+  for (const protobuf_api::ListValue& row : write->values()) {
+    std::vector<const protobuf_api::Value*> values;
+    for (int index : key_column_index) {
+      if (index >= row.values_size()) {
+        tables->insert(table);
+        return;
+      }
+      values.push_back(&row.values(index));
+    }
+    rows->push_back(MakeRowToken(table, values));
+  }
+}
+
+// Partitions the mutation groups of `request` into sets of groups which write
+// overlapping rows. Groups of different sets can be applied concurrently
+// without contending for the same row locks. Each set lists its groups in
+// request order.
+std::vector<std::vector<int>> PartitionMutationGroups(
+    const backend::Schema& schema,
+    const spanner_api::BatchWriteRequest& request) {
+  const int num_groups = request.mutation_groups_size();
+  std::vector<std::vector<RowToken>> group_rows(num_groups);
+  std::vector<absl::flat_hash_set<const backend::Table*>> group_tables(
+      num_groups);
+  absl::flat_hash_set<const backend::Table*> whole_tables;
+  for (int i = 0; i < num_groups; ++i) {
+    for (const spanner_api::Mutation& mutation :
+         request.mutation_groups(i).mutations()) {
+      AddMutationFootprint(schema, mutation, &group_rows[i], &group_tables[i]);
+    }
+    whole_tables.insert(group_tables[i].begin(), group_tables[i].end());
+  }
+
+  // Union the groups which share a row, and all groups which touch a table
+  // that some group writes as a whole.
+  std::vector<int> parent(num_groups);
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&parent](int group) {
+    while (parent[group] != group) {
+      group = parent[group] = parent[parent[group]];
+    }
+    return group;
+  };
+  absl::flat_hash_map<RowToken, int> row_owner;
+  absl::flat_hash_map<const backend::Table*, int> table_owner;
+  auto claim = [&](auto& owners, const auto& token, int group) {
+    auto [itr, inserted] = owners.try_emplace(token, group);
+    if (!inserted) {
+      parent[find(group)] = find(itr->second);
+    }
+  };
+  for (int i = 0; i < num_groups; ++i) {
+    for (const backend::Table* table : group_tables[i]) {
+      claim(table_owner, table, i);
+    }
+    for (const RowToken& row : group_rows[i]) {
+      if (whole_tables.contains(row.first)) {
+        claim(table_owner, row.first, i);
+      } else {
+        claim(row_owner, row, i);
+      }
+    }
+  }
+
+  std::vector<std::vector<int>> partitions;
+  absl::flat_hash_map<int, int> partition_of_root;
+  for (int i = 0; i < num_groups; ++i) {
+    auto [itr, inserted] =
+        partition_of_root.try_emplace(find(i), partitions.size());
+    if (inserted) {
+      partitions.emplace_back();
+    }
+    partitions[itr->second].push_back(i);
+  }
+  return partitions;
+}
+
+// Applies a mutation group in its own single-use read-write transaction and
+// returns its commit timestamp.
+absl::StatusOr<absl::Time> CommitMutationGroup(
+    Session* session,
+    const spanner_api::BatchWriteRequest::MutationGroup& group) {
+  spanner_api::TransactionOptions options;
+  options.mutable_read_write();
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<Transaction> txn,
+                   session->CreateSingleUseTransaction(options));
+  absl::Time commit_timestamp;
+  ZETASQL_RETURN_IF_ERROR(txn->GuardedCall(
+      Transaction::OpType::kCommit, [&]() -> absl::Status {
+        backend::Mutation mutation;
+        ZETASQL_RETURN_IF_ERROR(
+            MutationFromProto(*txn->schema(), group.mutations(), &mutation));
+        ZETASQL_RETURN_IF_ERROR(txn->Write(mutation));
+        ZETASQL_RETURN_IF_ERROR(txn->Commit());
+        ZETASQL_ASSIGN_OR_RETURN(commit_timestamp, txn->GetCommitTimestamp());
+        return absl::OkStatus();
+      }));
+  return commit_timestamp;
+}
+
+}  // namespace
+
+// Applies groups of mutations non-atomically. Each mutation group is committed
+// in its own transaction, and its result is streamed back as soon as it is
+// known. Groups writing disjoint rows are applied concurrently.
+absl::Status BatchWrite(RequestContext* ctx,
+                        const spanner_api::BatchWriteRequest* request,
+                        ServerStream<spanner_api::BatchWriteResponse>* stream) {
+  // Get session information.
+  ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
+                   GetSession(ctx, request->session()));
+  if (request->mutation_groups().empty()) {
+    return error::MissingRequiredFieldError(
+        "BatchWriteRequest.mutation_groups");
+  }
+
+  // Use the latest schema to find which mutation groups overlap.
+  spanner_api::TransactionOptions options;
+  options.mutable_read_write();
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<Transaction> schema_txn,
+                   session->CreateSingleUseTransaction(options));
+  const std::vector<std::vector<int>> partitions =
+      PartitionMutationGroups(*schema_txn->schema(), *request);
+  schema_txn.reset();
+
+  absl::Mutex stream_mu;
+  std::atomic<int> next_partition = 0;
+  auto apply_partitions = [&]() {
+    for (int p = next_partition++; p < partitions.size();
+         p = next_partition++) {
+      for (int group : partitions[p]) {
+        absl::StatusOr<absl::Time> commit_timestamp;
+        for (int attempt = 0; attempt <= limits::kMaxBatchWriteAbortRetries;
+             ++attempt) {
+          commit_timestamp = CommitMutationGroup(
+              session.get(), request->mutation_groups(group));
+          if (commit_timestamp.status().code() != absl::StatusCode::kAborted) {
+            break;
+          }
+        }
+
+        spanner_api::BatchWriteResponse response;
+        response.add_indexes(group);
+        if (commit_timestamp.ok()) {
+          absl::StatusOr<protobuf_api::Timestamp> timestamp_proto =
+              TimestampToProto(*commit_timestamp);
+          if (timestamp_proto.ok()) {
+            *response.mutable_commit_timestamp() = *timestamp_proto;
+          }
+          *response.mutable_status() = StatusToProto(timestamp_proto.status());
+        } else {
+          *response.mutable_status() =
+              StatusToProto(commit_timestamp.status());
+        }
+        absl::MutexLock lock(&stream_mu);
+        stream->Send(response);
+      }
+    }
+  };
+
+  // The calling thread applies partitions too, so that a request with a single
+  // partition does not start any threads.
+  const int num_threads =
+      std::min<int>(partitions.size(), limits::kMaxBatchWriteConcurrency);
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(apply_partitions);
+  }
+  apply_partitions();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return absl::OkStatus();
+}
+REGISTER_GRPC_HANDLER(Spanner, BatchWrite);
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "google/spanner/v1/commit_response.pb.h"
 #include "google/spanner/v1/spanner.pb.h"
@@ -302,6 +303,127 @@ TEST_F(TransactionApiTest, CanUseTransactionAfterReadError) {
   ZETASQL_EXPECT_OK(Commit(commit_request, &commit_response));
 }
 
+TEST_F(TransactionApiTest, BatchWriteCommitsEachMutationGroup) {
+  spanner_api::BatchWriteRequest request = PARSE_TEXT_PROTO(R"pb(
+    mutation_groups {
+      mutations {
+        insert {
+          table: "test_table"
+          columns: "int64_col"
+          columns: "string_col"
+          values {
+            values { string_value: "1" }
+            values { string_value: "one" }
+          }
+        }
+      }
+    }
+    mutation_groups {
+      mutations {
+        insert {
+          table: "test_table"
+          columns: "int64_col"
+          columns: "string_col"
+          values {
+            values { string_value: "2" }
+            values { string_value: "two" }
+          }
+        }
+      }
+    }
+    mutation_groups {
+      mutations {
+        update {
+          table: "test_table"
+          columns: "int64_col"
+          columns: "string_col"
+          values {
+            values { string_value: "1" }
+            values { string_value: "uno" }
+          }
+        }
+      }
+    }
+  )pb");
+  request.set_session(test_session_uri_);
+
+  std::vector<spanner_api::BatchWriteResponse> responses;
+  ZETASQL_ASSERT_OK(BatchWrite(request, &responses));
+
+  // Each mutation group is reported exactly once.
+  ASSERT_EQ(responses.size(), 3);
+  std::vector<int> indexes;
+  for (const spanner_api::BatchWriteResponse& response : responses) {
+    EXPECT_EQ(response.status().code(), 0) << response.DebugString();
+    EXPECT_TRUE(response.has_commit_timestamp());
+    indexes.insert(indexes.end(), response.indexes().begin(),
+                   response.indexes().end());
+  }
+  EXPECT_THAT(indexes, testing::UnorderedElementsAre(0, 1, 2));
+
+  // Groups writing the same row are applied in request order.
+  spanner_api::ReadRequest read_request = PARSE_TEXT_PROTO(R"pb(
+    table: "test_table"
+    columns: "int64_col"
+    columns: "string_col"
+    key_set { all: true }
+  )pb");
+  read_request.set_session(test_session_uri_);
+  spanner_api::ResultSet read_response;
+  ZETASQL_ASSERT_OK(Read(read_request, &read_response));
+  ASSERT_EQ(read_response.rows_size(), 2);
+  EXPECT_EQ(read_response.rows(0).values(1).string_value(), "uno");
+  EXPECT_EQ(read_response.rows(1).values(1).string_value(), "two");
+}
+
+TEST_F(TransactionApiTest, BatchWriteReportsFailedMutationGroups) {
+  spanner_api::BatchWriteRequest request = PARSE_TEXT_PROTO(R"pb(
+    mutation_groups {
+      mutations {
+        insert {
+          table: "non_existent_table"
+          columns: "int64_col"
+          values { values { string_value: "1" } }
+        }
+      }
+    }
+    mutation_groups {
+      mutations {
+        insert {
+          table: "test_table"
+          columns: "int64_col"
+          values { values { string_value: "1" } }
+        }
+      }
+    }
+  )pb");
+  request.set_session(test_session_uri_);
+
+  std::vector<spanner_api::BatchWriteResponse> responses;
+  ZETASQL_ASSERT_OK(BatchWrite(request, &responses));
+  ASSERT_EQ(responses.size(), 2);
+  for (const spanner_api::BatchWriteResponse& response : responses) {
+    ASSERT_EQ(response.indexes_size(), 1);
+    if (response.indexes(0) == 0) {
+      EXPECT_EQ(response.status().code(),
+                static_cast<int>(absl::StatusCode::kNotFound));
+      EXPECT_FALSE(response.has_commit_timestamp());
+    } else {
+      EXPECT_EQ(response.status().code(), 0);
+      EXPECT_TRUE(response.has_commit_timestamp());
+    }
+  }
+}
+
+TEST_F(TransactionApiTest, BatchWriteRequiresMutationGroups) {
+  spanner_api::BatchWriteRequest request;
+  request.set_session(test_session_uri_);
+
+  std::vector<spanner_api::BatchWriteResponse> responses;
+  EXPECT_THAT(BatchWrite(request, &responses),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 }  // namespace
 
 }  // namespace frontend
@@ -0,0 +1,615 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/server/cluster_router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/base/logging.h"
+#include "google/iam/v1/iam_policy.pb.h"
+#include "google/iam/v1/policy.pb.h"
+#include "google/longrunning/operations.grpc.pb.h"
+#include "google/protobuf/empty.pb.h"
+#include "google/spanner/admin/database/v1/spanner_database_admin.grpc.pb.h"
+#include "google/spanner/admin/instance/v1/spanner_instance_admin.grpc.pb.h"
+#include "google/spanner/v1/spanner.grpc.pb.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "common/errors.h"
+#include "common/limits.h"
+#include "farmhash.h"
+#include "frontend/common/status.h"
+#include "frontend/common/uris.h"
+#include "grpcpp/channel.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/channel_arguments.h"
+#include "grpcpp/support/status.h"
+#include "grpcpp/support/sync_stream.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// Convenience namespace aliases.
+namespace database_api = ::google::spanner::admin::database::v1;
+namespace iam_api = ::google::iam::v1;
+namespace instance_api = ::google::spanner::admin::instance::v1;
+namespace operations_api = ::google::longrunning;
+namespace protobuf_api = ::google::protobuf;
+namespace spanner_api = ::google::spanner::v1;
+
+WorkerRing::WorkerRing(int num_workers, int virtual_nodes)
+    : num_workers_(num_workers) {
+  points_.reserve(num_workers * virtual_nodes);
+  for (int worker = 0; worker < num_workers; ++worker) {
+    for (int node = 0; node < virtual_nodes; ++node) {
+      points_.emplace_back(
+          farmhash::Fingerprint64(absl::StrCat("worker-", worker, "/", node)),
+          worker);
+    }
+  }
+  std::sort(points_.begin(), points_.end());
+}
+
+int WorkerRing::WorkerFor(absl::string_view key) const {
+  if (points_.empty()) {
+    return 0;
+  }
+  auto itr = std::lower_bound(points_.begin(), points_.end(),
+                              std::make_pair(farmhash::Fingerprint64(key), 0));
+  return itr == points_.end() ? points_.front().second : itr->second;
+}
+
+std::string DatabaseUriOf(absl::string_view resource_uri) {
+  std::vector<absl::string_view> parts =
+      absl::StrSplit(resource_uri, absl::MaxSplits('/', 6));
+  if (parts.size() < 6 || parts[0] != "projects" || parts[2] != "instances" ||
+      parts[4] != "databases" || parts[5].empty()) {
+    return "";
+  }
+  parts.resize(6);
+  return absl::StrJoin(parts, "/");
+}
+
+absl::StatusOr<std::string> DatabaseIdOfCreateStatement(
+    absl::string_view create_statement) {
+  if (create_statement.empty()) {
+    return error::CreateDatabaseMissingCreateStatement();
+  }
+  std::vector<absl::string_view> tokens =
+      absl::StrSplit(create_statement, absl::ByAnyChar(" \t\r\n"),
+                     absl::SkipEmpty());
+  if (tokens.size() < 3 || !absl::EqualsIgnoreCase(tokens[0], "CREATE") ||
+      !absl::EqualsIgnoreCase(tokens[1], "DATABASE")) {
+    return error::InvalidCreateDatabaseStatement(create_statement);
+  }
+  // Identifiers are quoted with backticks in GoogleSQL and with double quotes
+  // in PostgreSQL, which folds unquoted identifiers to lower case. Database ids
+  // are lower case in both dialects.
+  absl::string_view database_id = tokens[2];
+  if (database_id.size() >= 2 &&
+      ((database_id.front() == '`' && database_id.back() == '`') ||
+       (database_id.front() == '"' && database_id.back() == '"'))) {
+    return std::string(database_id.substr(1, database_id.size() - 2));
+  }
+  return absl::AsciiStrToLower(database_id);
+}
+
+// Cluster holds the connections to the workers of a cluster.
+class Cluster {
+ public:
+  struct Worker {
+    explicit Worker(const std::string& address) : address(address) {
+      grpc::ChannelArguments args;
+      args.SetMaxSendMessageSize(limits::kMaxGRPCIncomingMessageSize);
+      args.SetMaxReceiveMessageSize(limits::kMaxGRPCOutgoingMessageSize);
+      std::shared_ptr<grpc::Channel> channel = grpc::CreateCustomChannel(
+          address, grpc::InsecureChannelCredentials(), args);
+      database_admin = database_api::DatabaseAdmin::NewStub(channel);
+      instance_admin = instance_api::InstanceAdmin::NewStub(channel);
+      operations = operations_api::Operations::NewStub(channel);
+      spanner = spanner_api::Spanner::NewStub(channel);
+    }
+
+    const std::string address;
+    std::unique_ptr<database_api::DatabaseAdmin::Stub> database_admin;
+    std::unique_ptr<instance_api::InstanceAdmin::Stub> instance_admin;
+    std::unique_ptr<operations_api::Operations::Stub> operations;
+    std::unique_ptr<spanner_api::Spanner::Stub> spanner;
+  };
+
+  explicit Cluster(const std::vector<std::string>& worker_addresses)
+      : ring_(worker_addresses.size()) {
+    for (const std::string& address : worker_addresses) {
+      workers_.push_back(std::make_unique<Worker>(address));
+    }
+  }
+
+  // The worker which serves instance admin reads and instance operations.
+  Worker& primary() { return *workers_.front(); }
+
+  // Returns the worker which owns the database `resource_uri` belongs to, or
+  // the primary worker for resources which do not belong to a database.
+  Worker& ForResource(absl::string_view resource_uri) {
+    std::string database_uri = DatabaseUriOf(resource_uri);
+    if (database_uri.empty()) {
+      return primary();
+    }
+    return *workers_[ring_.WorkerFor(database_uri)];
+  }
+
+  const std::vector<std::unique_ptr<Worker>>& workers() const {
+    return workers_;
+  }
+
+ private:
+  const WorkerRing ring_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+namespace {
+
+using Worker = Cluster::Worker;
+
+// Returns true if the metadata `key` is sent by the client or the workers
+// themselves rather than set by gRPC.
+bool IsForwardedMetadata(grpc::string_ref key) {
+  absl::string_view key_view(key.data(), key.size());
+  return !absl::StartsWith(key_view, "grpc-") &&
+         !absl::StartsWith(key_view, ":") && key_view != "user-agent" &&
+         key_view != "content-type" && key_view != "te";
+}
+
+// Returns the context of a call forwarded to a worker on behalf of the call of
+// `grpc_ctx`, which propagates its deadline, cancellation and metadata.
+std::unique_ptr<grpc::ClientContext> MakeClientContext(
+    const grpc::ServerContext& grpc_ctx) {
+  std::unique_ptr<grpc::ClientContext> client_ctx =
+      grpc::ClientContext::FromServerContext(grpc_ctx);
+  for (const auto& [key, value] : grpc_ctx.client_metadata()) {
+    if (IsForwardedMetadata(key)) {
+      client_ctx->AddMetadata(std::string(key.data(), key.size()),
+                              std::string(value.data(), value.size()));
+    }
+  }
+  return client_ctx;
+}
+
+// Returns the trailing metadata of a worker, such as the resource info of
+// errors, to the client.
+void ReturnTrailingMetadata(const grpc::ClientContext& client_ctx,
+                            grpc::ServerContext* grpc_ctx) {
+  for (const auto& [key, value] : client_ctx.GetServerTrailingMetadata()) {
+    if (IsForwardedMetadata(key)) {
+      grpc_ctx->AddTrailingMetadata(std::string(key.data(), key.size()),
+                                    std::string(value.data(), value.size()));
+    }
+  }
+}
+
+// Forwards a unary call, issued by `call` with the context of the forwarded
+// call, to a worker.
+template <typename CallT>
+grpc::Status ForwardUnary(grpc::ServerContext* grpc_ctx, const CallT& call) {
+  std::unique_ptr<grpc::ClientContext> client_ctx =
+      MakeClientContext(*grpc_ctx);
+  grpc::Status status = call(client_ctx.get());
+  ReturnTrailingMetadata(*client_ctx, grpc_ctx);
+  return status;
+}
+
+// Forwards a server streaming call, opened by `call` with the context of the
+// forwarded call, to a worker. The call is cancelled if the client goes away.
+template <typename ResponseT, typename CallT>
+grpc::Status ForwardStream(grpc::ServerContext* grpc_ctx,
+                           grpc::ServerWriter<ResponseT>* writer,
+                           const CallT& call) {
+  std::unique_ptr<grpc::ClientContext> client_ctx =
+      MakeClientContext(*grpc_ctx);
+  std::unique_ptr<grpc::ClientReaderInterface<ResponseT>> reader =
+      call(client_ctx.get());
+  ResponseT response;
+  bool cancelled = false;
+  while (reader->Read(&response)) {
+    if (!cancelled && !writer->Write(response)) {
+      // The remaining responses are drained before finishing the call.
+      client_ctx->TryCancel();
+      cancelled = true;
+    }
+  }
+  grpc::Status status = reader->Finish();
+  ReturnTrailingMetadata(*client_ctx, grpc_ctx);
+  return status;
+}
+
+// Applies an instance mutation to all workers: first to the primary worker,
+// whose response is returned, then to the other workers. Workers which already
+// converged to the outcome of the mutation are skipped.
+template <typename ResponseT, typename CallT>
+grpc::Status Replicate(grpc::ServerContext* grpc_ctx, Cluster* cluster,
+                       ResponseT* response, const CallT& call) {
+  grpc::Status status = ForwardUnary(
+      grpc_ctx, [&](grpc::ClientContext* client_ctx) {
+        return call(cluster->primary(), client_ctx, response);
+      });
+  if (!status.ok()) {
+    return status;
+  }
+  for (const std::unique_ptr<Worker>& worker : cluster->workers()) {
+    if (worker.get() == &cluster->primary()) {
+      continue;
+    }
+    std::unique_ptr<grpc::ClientContext> client_ctx =
+        MakeClientContext(*grpc_ctx);
+    ResponseT replica_response;
+    grpc::Status replica_status =
+        call(*worker, client_ctx.get(), &replica_response);
+    if (!replica_status.ok() &&
+        replica_status.error_code() != grpc::StatusCode::ALREADY_EXISTS &&
+        replica_status.error_code() != grpc::StatusCode::NOT_FOUND) {
+      ABSL_LOG(ERROR) << "Failed to replicate instance mutation to worker "
+                      << worker->address << ": "
+                      << replica_status.error_message();
+      return replica_status;
+    }
+  }
+  return status;
+}
+
+}  // namespace
+
+// Forwards a unary method to the worker owning the resource named by the
+// `routing_field` of the request.
+#define ROUTE_GRPC_METHOD(StubName, MethodName, RequestType, ResponseType,     \
+                          routing_field)                                       \
+  grpc::Status MethodName(grpc::ServerContext* grpc_ctx,                       \
+                          const RequestType* request, ResponseType* response)  \
+      override {                                                               \
+    Worker& worker = cluster_->ForResource(request->routing_field());          \
+    return ForwardUnary(grpc_ctx, [&](grpc::ClientContext* client_ctx) {       \
+      return worker.StubName->MethodName(client_ctx, *request, response);      \
+    });                                                                        \
+  }
+
+// Forwards a server streaming method to the worker owning the resource named
+// by the `routing_field` of the request.
+#define ROUTE_GRPC_STREAMING_METHOD(StubName, MethodName, RequestType,         \
+                                    ResponseType, routing_field)               \
+  grpc::Status MethodName(grpc::ServerContext* grpc_ctx,                       \
+                          const RequestType* request,                          \
+                          grpc::ServerWriter<ResponseType>* writer) override { \
+    Worker& worker = cluster_->ForResource(request->routing_field());          \
+    return ForwardStream(grpc_ctx, writer,                                     \
+                         [&](grpc::ClientContext* client_ctx) {                \
+                           return worker.StubName->MethodName(client_ctx,      \
+                                                              *request);       \
+                         });                                                   \
+  }
+
+// Applies a unary instance mutation to all workers.
+#define REPLICATE_GRPC_METHOD(MethodName, RequestType, ResponseType)           \
+  grpc::Status MethodName(grpc::ServerContext* grpc_ctx,                       \
+                          const RequestType* request, ResponseType* response)  \
+      override {                                                               \
+    return Replicate(grpc_ctx, cluster_, response,                             \
+                     [&](Worker& worker, grpc::ClientContext* client_ctx,      \
+                         ResponseType* worker_response) {                      \
+                       return worker.instance_admin->MethodName(               \
+                           client_ctx, *request, worker_response);             \
+                     });                                                       \
+  }
+
+// Routing implementation of the Spanner gRPC service. All requests are routed
+// by the database or session they name.
+class RoutingSpannerService : public spanner_api::Spanner::Service {
+ public:
+  explicit RoutingSpannerService(Cluster* cluster) : cluster_(cluster) {}
+
+  // Sessions.
+  ROUTE_GRPC_METHOD(spanner, CreateSession, spanner_api::CreateSessionRequest,
+                    spanner_api::Session, database)
+  ROUTE_GRPC_METHOD(spanner, GetSession, spanner_api::GetSessionRequest,
+                    spanner_api::Session, name)
+  ROUTE_GRPC_METHOD(spanner, ListSessions, spanner_api::ListSessionsRequest,
+                    spanner_api::ListSessionsResponse, database)
+  ROUTE_GRPC_METHOD(spanner, DeleteSession, spanner_api::DeleteSessionRequest,
+                    protobuf_api::Empty, name)
+  ROUTE_GRPC_METHOD(spanner, BatchCreateSessions,
+                    spanner_api::BatchCreateSessionsRequest,
+                    spanner_api::BatchCreateSessionsResponse, database)
+
+  // Reads.
+  ROUTE_GRPC_METHOD(spanner, Read, spanner_api::ReadRequest,
+                    spanner_api::ResultSet, session)
+  ROUTE_GRPC_STREAMING_METHOD(spanner, StreamingRead, spanner_api::ReadRequest,
+                              spanner_api::PartialResultSet, session)
+
+  // Queries.
+  ROUTE_GRPC_METHOD(spanner, ExecuteSql, spanner_api::ExecuteSqlRequest,
+                    spanner_api::ResultSet, session)
+  ROUTE_GRPC_STREAMING_METHOD(spanner, ExecuteStreamingSql,
+                              spanner_api::ExecuteSqlRequest,
+                              spanner_api::PartialResultSet, session)
+  ROUTE_GRPC_METHOD(spanner, ExecuteBatchDml,
+                    spanner_api::ExecuteBatchDmlRequest,
+                    spanner_api::ExecuteBatchDmlResponse, session)
+
+  // Partitions.
+  ROUTE_GRPC_METHOD(spanner, PartitionRead, spanner_api::PartitionReadRequest,
+                    spanner_api::PartitionResponse, session)
+  ROUTE_GRPC_METHOD(spanner, PartitionQuery,
+                    spanner_api::PartitionQueryRequest,
+                    spanner_api::PartitionResponse, session)
+
+  // Transactions.
+  ROUTE_GRPC_METHOD(spanner, BeginTransaction,
+                    spanner_api::BeginTransactionRequest,
+                    spanner_api::Transaction, session)
+  ROUTE_GRPC_METHOD(spanner, Commit, spanner_api::CommitRequest,
+                    spanner_api::CommitResponse, session)
+  ROUTE_GRPC_METHOD(spanner, Rollback, spanner_api::RollbackRequest,
+                    protobuf_api::Empty, session)
+  ROUTE_GRPC_STREAMING_METHOD(spanner, BatchWrite,
+                              spanner_api::BatchWriteRequest,
+                              spanner_api::BatchWriteResponse, session)
+
+ private:
+  Cluster* const cluster_;
+};
+
+// Routing implementation of the DatabaseAdmin gRPC service. Requests are
+// routed by the database they name, and listing databases fans out to all
+// workers.
+class RoutingDatabaseAdminService
+    : public database_api::DatabaseAdmin::Service {
+ public:
+  explicit RoutingDatabaseAdminService(Cluster* cluster) : cluster_(cluster) {}
+
+  // Databases.
+  grpc::Status ListDatabases(grpc::ServerContext* grpc_ctx,
+                             const database_api::ListDatabasesRequest* request,
+                             database_api::ListDatabasesResponse* response)
+      override {
+    // The databases of all workers are merged in name order, and pages are
+    // resumed after the name of the last database returned.
+    std::vector<database_api::Database> databases;
+    for (const std::unique_ptr<Worker>& worker : cluster_->workers()) {
+      database_api::ListDatabasesRequest worker_request;
+      worker_request.set_parent(request->parent());
+      do {
+        std::unique_ptr<grpc::ClientContext> client_ctx =
+            MakeClientContext(*grpc_ctx);
+        database_api::ListDatabasesResponse worker_response;
+        grpc::Status status = worker->database_admin->ListDatabases(
+            client_ctx.get(), worker_request, &worker_response);
+        if (!status.ok()) {
+          ReturnTrailingMetadata(*client_ctx, grpc_ctx);
+          return status;
+        }
+        for (database_api::Database& database :
+             *worker_response.mutable_databases()) {
+          if (request->page_token().empty() ||
+              database.name() > request->page_token()) {
+            databases.push_back(std::move(database));
+          }
+        }
+        worker_request.set_page_token(worker_response.next_page_token());
+      } while (!worker_request.page_token().empty());
+    }
+    std::sort(databases.begin(), databases.end(),
+              [](const database_api::Database& lhs,
+                 const database_api::Database& rhs) {
+                return lhs.name() < rhs.name();
+              });
+
+    const int64_t page_size = request->page_size() > 0
+                                  ? request->page_size()
+                                  : static_cast<int64_t>(databases.size());
+    for (database_api::Database& database : databases) {
+      if (response->databases_size() == page_size) {
+        response->set_next_page_token(
+            response->databases(page_size - 1).name());
+        break;
+      }
+      *response->add_databases() = std::move(database);
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status CreateDatabase(
+      grpc::ServerContext* grpc_ctx,
+      const database_api::CreateDatabaseRequest* request,
+      operations_api::Operation* response) override {
+    absl::StatusOr<std::string> database_id =
+        DatabaseIdOfCreateStatement(request->create_statement());
+    if (!database_id.ok()) {
+      return ToGRPCStatus(database_id.status());
+    }
+    Worker& worker = cluster_->ForResource(
+        MakeDatabaseUri(request->parent(), *database_id));
+    return ForwardUnary(grpc_ctx, [&](grpc::ClientContext* client_ctx) {
+      return worker.database_admin->CreateDatabase(client_ctx, *request,
+                                                   response);
+    });
+  }
+
+  ROUTE_GRPC_METHOD(database_admin, GetDatabase,
+                    database_api::GetDatabaseRequest, database_api::Database,
+                    name)
+  ROUTE_GRPC_METHOD(database_admin, DropDatabase,
+                    database_api::DropDatabaseRequest, protobuf_api::Empty,
+                    database)
+
+  // Schema.
+  ROUTE_GRPC_METHOD(database_admin, UpdateDatabaseDdl,
+                    database_api::UpdateDatabaseDdlRequest,
+                    operations_api::Operation, database)
+  ROUTE_GRPC_METHOD(database_admin, GetDatabaseDdl,
+                    database_api::GetDatabaseDdlRequest,
+                    database_api::GetDatabaseDdlResponse, database)
+
+  // Policies.
+  ROUTE_GRPC_METHOD(database_admin, SetIamPolicy, iam_api::SetIamPolicyRequest,
+                    iam_api::Policy, resource)
+  ROUTE_GRPC_METHOD(database_admin, GetIamPolicy, iam_api::GetIamPolicyRequest,
+                    iam_api::Policy, resource)
+  ROUTE_GRPC_METHOD(database_admin, TestIamPermissions,
+                    iam_api::TestIamPermissionsRequest,
+                    iam_api::TestIamPermissionsResponse, resource)
+
+ private:
+  Cluster* const cluster_;
+};
+
+// Routing implementation of the InstanceAdmin gRPC service. Reads are served by
+// the primary worker and mutations are replicated to all workers.
+class RoutingInstanceAdminService
+    : public instance_api::InstanceAdmin::Service {
+ public:
+  explicit RoutingInstanceAdminService(Cluster* cluster) : cluster_(cluster) {}
+
+  // Instance configs.
+  ROUTE_GRPC_METHOD(instance_admin, ListInstanceConfigs,
+                    instance_api::ListInstanceConfigsRequest,
+                    instance_api::ListInstanceConfigsResponse, parent)
+  ROUTE_GRPC_METHOD(instance_admin, GetInstanceConfig,
+                    instance_api::GetInstanceConfigRequest,
+                    instance_api::InstanceConfig, name)
+
+  // Instances.
+  ROUTE_GRPC_METHOD(instance_admin, ListInstances,
+                    instance_api::ListInstancesRequest,
+                    instance_api::ListInstancesResponse, parent)
+  ROUTE_GRPC_METHOD(instance_admin, GetInstance,
+                    instance_api::GetInstanceRequest, instance_api::Instance,
+                    name)
+  REPLICATE_GRPC_METHOD(CreateInstance, instance_api::CreateInstanceRequest,
+                        operations_api::Operation)
+  REPLICATE_GRPC_METHOD(UpdateInstance, instance_api::UpdateInstanceRequest,
+                        operations_api::Operation)
+  REPLICATE_GRPC_METHOD(DeleteInstance, instance_api::DeleteInstanceRequest,
+                        protobuf_api::Empty)
+
+  // Policies.
+  ROUTE_GRPC_METHOD(instance_admin, SetIamPolicy, iam_api::SetIamPolicyRequest,
+                    iam_api::Policy, resource)
+  ROUTE_GRPC_METHOD(instance_admin, GetIamPolicy, iam_api::GetIamPolicyRequest,
+                    iam_api::Policy, resource)
+  ROUTE_GRPC_METHOD(instance_admin, TestIamPermissions,
+                    iam_api::TestIamPermissionsRequest,
+                    iam_api::TestIamPermissionsResponse, resource)
+
+ private:
+  Cluster* const cluster_;
+};
+
+// Routing implementation of the Operations gRPC service. Operations are named
+// after the resource they operate on, so database operations are routed to the
+// worker of their database and instance operations to the primary worker.
+class RoutingOperationsService : public operations_api::Operations::Service {
+ public:
+  explicit RoutingOperationsService(Cluster* cluster) : cluster_(cluster) {}
+
+  ROUTE_GRPC_METHOD(operations, ListOperations,
+                    operations_api::ListOperationsRequest,
+                    operations_api::ListOperationsResponse, name)
+  ROUTE_GRPC_METHOD(operations, GetOperation,
+                    operations_api::GetOperationRequest,
+                    operations_api::Operation, name)
+  ROUTE_GRPC_METHOD(operations, DeleteOperation,
+                    operations_api::DeleteOperationRequest,
+                    protobuf_api::Empty, name)
+  ROUTE_GRPC_METHOD(operations, CancelOperation,
+                    operations_api::CancelOperationRequest,
+                    protobuf_api::Empty, name)
+  ROUTE_GRPC_METHOD(operations, WaitOperation,
+                    operations_api::WaitOperationRequest,
+                    operations_api::Operation, name)
+
+ private:
+  Cluster* const cluster_;
+};
+
+ClusterRouter::ClusterRouter(std::unique_ptr<Cluster> cluster)
+    : cluster_(std::move(cluster)),
+      database_admin_service_(new RoutingDatabaseAdminService(cluster_.get())),
+      instance_admin_service_(new RoutingInstanceAdminService(cluster_.get())),
+      operations_service_(new RoutingOperationsService(cluster_.get())),
+      spanner_service_(new RoutingSpannerService(cluster_.get())) {}
+
+ClusterRouter::~ClusterRouter() = default;
+
+absl::StatusOr<std::unique_ptr<ClusterRouter>> ClusterRouter::Create(
+    const Options& options) {
+  if (options.worker_addresses.empty()) {
+    return error::InvalidClusterConfiguration("no worker addresses");
+  }
+  std::unique_ptr<ClusterRouter> router = absl::WrapUnique(
+      new ClusterRouter(std::make_unique<Cluster>(options.worker_addresses)));
+  ::grpc::ServerBuilder builder;
+
+  // Configure server address.
+  router->host_ = options.server_address.substr(
+      0, options.server_address.find_last_of(':'));
+  builder.AddListeningPort(options.server_address,
+                           ::grpc::InsecureServerCredentials(), &router->port_);
+
+  // Configure server message limits.
+  builder.AddChannelArgument(GRPC_ARG_MAX_SEND_MESSAGE_LENGTH,
+                             limits::kMaxGRPCOutgoingMessageSize);
+  builder.AddChannelArgument(GRPC_ARG_MAX_RECEIVE_MESSAGE_LENGTH,
+                             limits::kMaxGRPCIncomingMessageSize);
+
+  // Configure services exported on this server.
+  builder.RegisterService(router->spanner_service_.get())
+      .RegisterService(router->database_admin_service_.get())
+      .RegisterService(router->instance_admin_service_.get())
+      .RegisterService(router->operations_service_.get());
+
+  router->grpc_server_ = builder.BuildAndStart();
+  if (router->port_ < 0) {
+    return error::InvalidClusterConfiguration(
+        absl::StrCat("failed to bind to address ", options.server_address));
+  }
+  return router;
+}
+
+void ClusterRouter::WaitForShutdown() { grpc_server_->Wait(); }
+
+void ClusterRouter::Shutdown() { grpc_server_->Shutdown(); }
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,139 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef STORAGE_SPANNER_CLOUD_EMULATOR_FRONTEND_SERVER_CLUSTER_ROUTER_H_
+#define STORAGE_SPANNER_CLOUD_EMULATOR_FRONTEND_SERVER_CLUSTER_ROUTER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "grpcpp/impl/service_type.h"
+#include "grpcpp/server.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// WorkerRing places keys onto a fixed number of workers by consistent hashing.
+//
+// Each worker owns `virtual_nodes` points of a ring of 64-bit fingerprints, and
+// a key is placed on the worker owning the first point at or after the
+// fingerprint of the key. Points only depend on the position of the worker, so
+// placements are stable across restarts, and appending a worker only moves
+// about 1/N of the keys onto it.
+class WorkerRing {
+ public:
+  explicit WorkerRing(int num_workers, int virtual_nodes = 128);
+
+  // Returns the index of the worker which owns `key`.
+  int WorkerFor(absl::string_view key) const;
+
+  int num_workers() const { return num_workers_; }
+
+ private:
+  const int num_workers_;
+
+  // Points of the ring and the index of the worker owning them, sorted by
+  // point.
+  std::vector<std::pair<uint64_t, int>> points_;
+};
+
+// Returns the URI of the database a resource belongs to, such as a database,
+// session or database operation, or an empty string if the resource does not
+// belong to a database.
+std::string DatabaseUriOf(absl::string_view resource_uri);
+
+// Returns the id of the database created by a CREATE DATABASE statement, in
+// either dialect.
+absl::StatusOr<std::string> DatabaseIdOfCreateStatement(
+    absl::string_view create_statement);
+
+class Cluster;
+
+// ClusterRouter serves the Cloud Spanner gRPC API in front of a cluster of
+// emulator worker processes, each started with emulator_main.
+//
+// Databases are sharded across the workers: each database lives on the worker
+// which WorkerRing places its URI on, and every request for a database, or for
+// one of its sessions, transactions or operations, is forwarded to that
+// worker. Since sessions are named after their database, all requests of a
+// session reach the same worker. Listing databases fans out to all workers.
+//
+// Instance admin metadata is replicated: instance mutations are applied to all
+// workers, starting with the first one, which serves instance reads and
+// instance operations.
+//
+// Deadlines, cancellation and client metadata are propagated to the workers,
+// and the trailing metadata of the workers is returned to the client.
+class ClusterRouter {
+ public:
+  struct Options {
+    std::string server_address;
+
+    // Addresses (host:port) of the emulator workers. The order of the workers
+    // determines the placement of databases, so it must be kept stable, and
+    // workers can only be appended.
+    std::vector<std::string> worker_addresses;
+  };
+
+  // Returns an initialized ClusterRouter, or an error if the initialization
+  // failed.
+  static absl::StatusOr<std::unique_ptr<ClusterRouter>> Create(
+      const Options& options);
+
+  ~ClusterRouter();
+
+  std::string host() const { return host_; }
+  int port() const { return port_; }
+
+  // Blocks until the router is shut down.
+  void WaitForShutdown();
+
+  // Shuts down the router.
+  void Shutdown();
+
+ private:
+  explicit ClusterRouter(std::unique_ptr<Cluster> cluster);
+
+  // Address of the gRPC server.
+  std::string host_;
+  int port_ = -1;
+
+  // Workers of the cluster, shared by all services.
+  std::unique_ptr<Cluster> cluster_;
+
+  // Services implemented by the router.
+  std::unique_ptr<grpc::Service> database_admin_service_;
+  std::unique_ptr<grpc::Service> instance_admin_service_;
+  std::unique_ptr<grpc::Service> operations_service_;
+  std::unique_ptr<grpc::Service> spanner_service_;
+
+  // Underlying gRPC server.
+  std::unique_ptr<grpc::Server> grpc_server_;
+};
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // STORAGE_SPANNER_CLOUD_EMULATOR_FRONTEND_SERVER_CLUSTER_ROUTER_H_
@@ -0,0 +1,274 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/server/cluster_router.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/spanner/admin/database/v1/spanner_database_admin.grpc.pb.h"
+#include "google/spanner/admin/instance/v1/spanner_instance_admin.grpc.pb.h"
+#include "google/spanner/v1/spanner.grpc.pb.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "frontend/server/server.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+namespace {
+
+namespace database_api = ::google::spanner::admin::database::v1;
+namespace instance_api = ::google::spanner::admin::instance::v1;
+namespace spanner_api = ::google::spanner::v1;
+
+using ::zetasql_base::testing::IsOkAndHolds;
+using ::zetasql_base::testing::StatusIs;
+
+constexpr char kInstanceUri[] = "projects/p/instances/i";
+
+TEST(WorkerRingTest, PlacesKeysStablyOnAllWorkers) {
+  WorkerRing ring(4);
+  absl::flat_hash_map<int, int> keys_per_worker;
+  for (int i = 0; i < 1000; ++i) {
+    std::string key = absl::StrCat(kInstanceUri, "/databases/db", i);
+    int worker = ring.WorkerFor(key);
+    ASSERT_GE(worker, 0);
+    ASSERT_LT(worker, 4);
+    EXPECT_EQ(WorkerRing(4).WorkerFor(key), worker);
+    ++keys_per_worker[worker];
+  }
+  for (int worker = 0; worker < 4; ++worker) {
+    EXPECT_GT(keys_per_worker[worker], 100);
+  }
+}
+
+TEST(WorkerRingTest, AppendingAWorkerOnlyMovesKeysOntoIt) {
+  WorkerRing ring(3);
+  WorkerRing grown_ring(4);
+  int moved = 0;
+  for (int i = 0; i < 1000; ++i) {
+    std::string key = absl::StrCat(kInstanceUri, "/databases/db", i);
+    if (grown_ring.WorkerFor(key) != ring.WorkerFor(key)) {
+      EXPECT_EQ(grown_ring.WorkerFor(key), 3);
+      ++moved;
+    }
+  }
+  EXPECT_GT(moved, 100);
+  EXPECT_LT(moved, 400);
+}
+
+TEST(ClusterRouterTest, DatabaseUriOfResources) {
+  EXPECT_EQ(DatabaseUriOf("projects/p/instances/i/databases/d"),
+            "projects/p/instances/i/databases/d");
+  EXPECT_EQ(DatabaseUriOf("projects/p/instances/i/databases/d/sessions/s"),
+            "projects/p/instances/i/databases/d");
+  EXPECT_EQ(DatabaseUriOf("projects/p/instances/i/databases/d/operations/o"),
+            "projects/p/instances/i/databases/d");
+  EXPECT_EQ(DatabaseUriOf("projects/p/instances/i"), "");
+  EXPECT_EQ(DatabaseUriOf("projects/p/instances/i/operations/o"), "");
+  EXPECT_EQ(DatabaseUriOf("projects/p/instances/i/databases/"), "");
+}
+
+TEST(ClusterRouterTest, DatabaseIdOfCreateStatements) {
+  EXPECT_THAT(DatabaseIdOfCreateStatement("CREATE DATABASE db"),
+              IsOkAndHolds("db"));
+  EXPECT_THAT(DatabaseIdOfCreateStatement("create database `my-db`"),
+              IsOkAndHolds("my-db"));
+  EXPECT_THAT(DatabaseIdOfCreateStatement("CREATE DATABASE \"pg_db\""),
+              IsOkAndHolds("pg_db"));
+  EXPECT_THAT(DatabaseIdOfCreateStatement("CREATE DATABASE PgDb"),
+              IsOkAndHolds("pgdb"));
+  EXPECT_THAT(DatabaseIdOfCreateStatement(""),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(DatabaseIdOfCreateStatement("CREATE TABLE t"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ClusterRouterTest, RequiresWorkers) {
+  ClusterRouter::Options options;
+  options.server_address = "localhost:0";
+  EXPECT_THAT(ClusterRouter::Create(options),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+class ClusterRouterServingTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ClusterRouter::Options options;
+    options.server_address = "localhost:0";
+    for (int i = 0; i < 2; ++i) {
+      Server::Options worker_options;
+      worker_options.server_address = "localhost:0";
+      workers_.push_back(Server::Create(worker_options));
+      ASSERT_NE(workers_.back(), nullptr);
+      options.worker_addresses.push_back(
+          absl::StrCat("localhost:", workers_.back()->port()));
+    }
+    ZETASQL_ASSERT_OK_AND_ASSIGN(router_, ClusterRouter::Create(options));
+
+    std::shared_ptr<grpc::Channel> channel =
+        grpc::CreateChannel(absl::StrCat("localhost:", router_->port()),
+                            grpc::InsecureChannelCredentials());
+    database_admin_ = database_api::DatabaseAdmin::NewStub(channel);
+    instance_admin_ = instance_api::InstanceAdmin::NewStub(channel);
+    spanner_ = spanner_api::Spanner::NewStub(channel);
+
+    instance_api::CreateInstanceRequest request;
+    request.set_parent("projects/p");
+    request.set_instance_id("i");
+    request.mutable_instance()->set_config(
+        "projects/p/instanceConfigs/emulator-config");
+    request.mutable_instance()->set_display_name("i");
+    request.mutable_instance()->set_node_count(1);
+    grpc::ClientContext ctx;
+    google::longrunning::Operation operation;
+    ASSERT_TRUE(
+        instance_admin_->CreateInstance(&ctx, request, &operation).ok());
+  }
+
+  void TearDown() override {
+    if (router_ != nullptr) {
+      router_->Shutdown();
+    }
+    for (const std::unique_ptr<Server>& worker : workers_) {
+      if (worker != nullptr) {
+        worker->Shutdown();
+      }
+    }
+  }
+
+  grpc::Status CreateDatabase(const std::string& database_id) {
+    database_api::CreateDatabaseRequest request;
+    request.set_parent(kInstanceUri);
+    request.set_create_statement(
+        absl::StrCat("CREATE DATABASE `", database_id, "`"));
+    grpc::ClientContext ctx;
+    google::longrunning::Operation operation;
+    return database_admin_->CreateDatabase(&ctx, request, &operation);
+  }
+
+  std::vector<std::unique_ptr<Server>> workers_;
+  std::unique_ptr<ClusterRouter> router_;
+  std::unique_ptr<database_api::DatabaseAdmin::Stub> database_admin_;
+  std::unique_ptr<instance_api::InstanceAdmin::Stub> instance_admin_;
+  std::unique_ptr<spanner_api::Spanner::Stub> spanner_;
+};
+
+TEST_F(ClusterRouterServingTest, ReplicatesInstances) {
+  for (const std::unique_ptr<Server>& worker : workers_) {
+    ZETASQL_EXPECT_OK(
+        worker->env()->instance_manager()->GetInstance(kInstanceUri));
+  }
+
+  instance_api::GetInstanceRequest request;
+  request.set_name(kInstanceUri);
+  grpc::ClientContext ctx;
+  instance_api::Instance instance;
+  ASSERT_TRUE(instance_admin_->GetInstance(&ctx, request, &instance).ok());
+  EXPECT_EQ(instance.name(), kInstanceUri);
+}
+
+TEST_F(ClusterRouterServingTest, ShardsDatabasesAcrossWorkers) {
+  constexpr int kNumDatabases = 10;
+  for (int i = 0; i < kNumDatabases; ++i) {
+    ASSERT_TRUE(CreateDatabase(absl::StrCat("db", i)).ok());
+  }
+
+  // Each database lives on exactly one worker, and both workers hold some.
+  std::vector<int> databases_per_worker(workers_.size());
+  for (int i = 0; i < kNumDatabases; ++i) {
+    std::string database_uri = absl::StrCat(kInstanceUri, "/databases/db", i);
+    int num_copies = 0;
+    for (size_t w = 0; w < workers_.size(); ++w) {
+      if (workers_[w]->env()->database_manager()->GetDatabase(database_uri)
+              .ok()) {
+        ++databases_per_worker[w];
+        ++num_copies;
+      }
+    }
+    EXPECT_EQ(num_copies, 1) << database_uri;
+  }
+  EXPECT_THAT(databases_per_worker, testing::Each(testing::Gt(0)));
+
+  // Listing databases merges all workers, in pages.
+  std::vector<std::string> names;
+  database_api::ListDatabasesRequest request;
+  request.set_parent(kInstanceUri);
+  request.set_page_size(3);
+  do {
+    grpc::ClientContext ctx;
+    database_api::ListDatabasesResponse response;
+    ASSERT_TRUE(database_admin_->ListDatabases(&ctx, request, &response).ok());
+    EXPECT_LE(response.databases_size(), 3);
+    for (const database_api::Database& database : response.databases()) {
+      names.push_back(database.name());
+    }
+    request.set_page_token(response.next_page_token());
+  } while (!request.page_token().empty());
+  EXPECT_EQ(names.size(), kNumDatabases);
+  EXPECT_TRUE(std::is_sorted(names.begin(), names.end()));
+}
+
+TEST_F(ClusterRouterServingTest, RoutesSessionsToTheirDatabase) {
+  for (int i = 0; i < 4; ++i) {
+    std::string database_id = absl::StrCat("db", i);
+    ASSERT_TRUE(CreateDatabase(database_id).ok());
+
+    spanner_api::CreateSessionRequest create_request;
+    create_request.set_database(
+        absl::StrCat(kInstanceUri, "/databases/", database_id));
+    grpc::ClientContext create_ctx;
+    spanner_api::Session session;
+    ASSERT_TRUE(
+        spanner_->CreateSession(&create_ctx, create_request, &session).ok());
+
+    spanner_api::ExecuteSqlRequest query;
+    query.set_session(session.name());
+    query.set_sql("SELECT 1");
+    grpc::ClientContext query_ctx;
+    spanner_api::ResultSet result;
+    ASSERT_TRUE(spanner_->ExecuteSql(&query_ctx, query, &result).ok());
+    ASSERT_EQ(result.rows_size(), 1);
+    EXPECT_EQ(result.rows(0).values(0).string_value(), "1");
+  }
+}
+
+TEST_F(ClusterRouterServingTest, ForwardsErrorsOfWorkers) {
+  spanner_api::GetSessionRequest request;
+  request.set_name(
+      absl::StrCat(kInstanceUri, "/databases/missing/sessions/s"));
+  grpc::ClientContext ctx;
+  spanner_api::Session session;
+  EXPECT_EQ(spanner_->GetSession(&ctx, request, &session).error_code(),
+            grpc::StatusCode::NOT_FOUND);
+}
+
+}  // namespace
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,110 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/server/compression.h"
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "common/errors.h"
+#include "grpc/compression.h"
+#include "grpcpp/server_context.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+namespace {
+
+// Header in which clients list the encodings they can decompress.
+constexpr absl::string_view kAcceptEncodingHeader = "grpc-accept-encoding";
+
+// Enables `options.algorithm` on the call if the client accepts it. Clients
+// which did not advertise the algorithm get uncompressed responses, since some
+// of them (e.g. Go clients without a registered decompressor) fail the call
+// otherwise.
+void MaybeCompress(const CompressionOptions& options,
+                   grpc::ServerContext* grpc_ctx) {
+  auto [begin, end] =
+      grpc_ctx->client_metadata().equal_range(kAcceptEncodingHeader.data());
+  for (auto it = begin; it != end; ++it) {
+    if (AcceptsEncoding(absl::string_view(it->second.data(), it->second.size()),
+                        options.algorithm)) {
+      grpc_ctx->set_compression_algorithm(options.algorithm);
+      return;
+    }
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<grpc_compression_algorithm> ParseCompressionAlgorithm(
+    absl::string_view name) {
+  if (absl::EqualsIgnoreCase(name, "none")) {
+    return GRPC_COMPRESS_NONE;
+  }
+  if (absl::EqualsIgnoreCase(name, "gzip")) {
+    return GRPC_COMPRESS_GZIP;
+  }
+  if (absl::EqualsIgnoreCase(name, "deflate")) {
+    return GRPC_COMPRESS_DEFLATE;
+  }
+  return error::InvalidCompressionAlgorithm(name);
+}
+
+bool AcceptsEncoding(absl::string_view accept_encoding,
+                     grpc_compression_algorithm algorithm) {
+  const char* algorithm_name = nullptr;
+  if (algorithm == GRPC_COMPRESS_NONE ||
+      !grpc_compression_algorithm_name(algorithm, &algorithm_name)) {
+    return false;
+  }
+  for (absl::string_view encoding : absl::StrSplit(accept_encoding, ',')) {
+    if (absl::EqualsIgnoreCase(absl::StripAsciiWhitespace(encoding),
+                               algorithm_name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void MaybeCompressUnaryResponse(const CompressionOptions& options,
+                                int64_t response_bytes,
+                                grpc::ServerContext* grpc_ctx) {
+  if (options.algorithm == GRPC_COMPRESS_NONE ||
+      response_bytes < options.min_unary_response_bytes) {
+    return;
+  }
+  MaybeCompress(options, grpc_ctx);
+}
+
+void MaybeCompressStreamingResponses(const CompressionOptions& options,
+                                     grpc::ServerContext* grpc_ctx) {
+  if (options.algorithm == GRPC_COMPRESS_NONE) {
+    return;
+  }
+  MaybeCompress(options, grpc_ctx);
+}
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,71 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_COMPRESSION_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_COMPRESSION_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "grpc/compression.h"
+#include "grpcpp/server_context.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// Compression applied by the gRPC server to the responses it sends.
+struct CompressionOptions {
+  // Algorithm used to compress responses. GRPC_COMPRESS_NONE sends all
+  // responses uncompressed.
+  grpc_compression_algorithm algorithm = GRPC_COMPRESS_NONE;
+
+  // Unary responses smaller than this are sent uncompressed, since compressing
+  // them costs more CPU than it saves on the wire. Streaming responses are
+  // compressed regardless of their size, as it is not known when the stream
+  // starts.
+  int64_t min_unary_response_bytes = 0;
+};
+
+// Parses the name of a compression algorithm ("none", "gzip" or "deflate").
+absl::StatusOr<grpc_compression_algorithm> ParseCompressionAlgorithm(
+    absl::string_view name);
+
+// Returns true if `accept_encoding`, the value of a grpc-accept-encoding
+// header, lists `algorithm`.
+bool AcceptsEncoding(absl::string_view accept_encoding,
+                     grpc_compression_algorithm algorithm);
+
+// Enables compression on a unary call whose response is `response_bytes`
+// long, if `options` asks for it and the client accepts the algorithm. Must
+// be called before the response is sent.
+void MaybeCompressUnaryResponse(const CompressionOptions& options,
+                                int64_t response_bytes,
+                                grpc::ServerContext* grpc_ctx);
+
+// Same as above, for a server streaming call. Must be called before the first
+// response is written.
+void MaybeCompressStreamingResponses(const CompressionOptions& options,
+                                     grpc::ServerContext* grpc_ctx);
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_COMPRESSION_H_
@@ -0,0 +1,66 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/server/compression.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "grpc/compression.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+namespace {
+
+using ::zetasql_base::testing::IsOkAndHolds;
+using ::zetasql_base::testing::StatusIs;
+
+TEST(CompressionTest, ParsesCompressionAlgorithms) {
+  EXPECT_THAT(ParseCompressionAlgorithm("none"),
+              IsOkAndHolds(GRPC_COMPRESS_NONE));
+  EXPECT_THAT(ParseCompressionAlgorithm("gzip"),
+              IsOkAndHolds(GRPC_COMPRESS_GZIP));
+  EXPECT_THAT(ParseCompressionAlgorithm("DEFLATE"),
+              IsOkAndHolds(GRPC_COMPRESS_DEFLATE));
+}
+
+TEST(CompressionTest, RejectsUnknownCompressionAlgorithms) {
+  EXPECT_THAT(ParseCompressionAlgorithm("brotli"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ParseCompressionAlgorithm(""),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(CompressionTest, MatchesAcceptedEncodings) {
+  EXPECT_TRUE(AcceptsEncoding("identity,deflate,gzip", GRPC_COMPRESS_GZIP));
+  EXPECT_TRUE(AcceptsEncoding("identity, deflate", GRPC_COMPRESS_DEFLATE));
+  EXPECT_TRUE(AcceptsEncoding("GZIP", GRPC_COMPRESS_GZIP));
+  EXPECT_FALSE(AcceptsEncoding("identity,deflate", GRPC_COMPRESS_GZIP));
+  EXPECT_FALSE(AcceptsEncoding("gzipx", GRPC_COMPRESS_GZIP));
+  EXPECT_FALSE(AcceptsEncoding("", GRPC_COMPRESS_GZIP));
+}
+
+TEST(CompressionTest, NeverAcceptsNoCompression) {
+  EXPECT_FALSE(AcceptsEncoding("identity", GRPC_COMPRESS_NONE));
+}
+
+}  // namespace
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -18,10 +18,12 @@
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_ENV_H_
 
 #include <memory>
+#include <string>
 
 #include "common/clock.h"
 #include "frontend/collections/database_manager.h"
 #include "frontend/collections/instance_manager.h"
+#include "frontend/collections/lane_manager.h"
 #include "frontend/collections/operation_manager.h"
 #include "frontend/collections/session_manager.h"
 
@@ -33,16 +35,24 @@ namespace frontend {
 // ServerEnv encapsulates global objects for Cloud Spanner Emulator.
 class ServerEnv {
  public:
-  ServerEnv()
+  // Databases are made durable in `wal_dir` if it is not empty (see
+  // DatabaseManager). Requests are isolated per database with the given lane
+  // limits (see LaneManager).
+  explicit ServerEnv(const std::string& wal_dir = "",
+                     int max_active_requests_per_database = 0,
+                     int max_queued_requests_per_database = 0)
       : clock_(new Clock()),
-        database_manager_(new DatabaseManager(clock_.get())),
+        database_manager_(new DatabaseManager(clock_.get(), wal_dir)),
         instance_manager_(new InstanceManager()),
+        lane_manager_(new LaneManager(max_active_requests_per_database,
+                                      max_queued_requests_per_database)),
         operation_manager_(new OperationManager()),
         session_manager_(new SessionManager(clock_.get())) {}
 
   Clock* clock() { return clock_.get(); }
   DatabaseManager* database_manager() { return database_manager_.get(); }
   InstanceManager* instance_manager() { return instance_manager_.get(); }
+  LaneManager* lane_manager() { return lane_manager_.get(); }
   OperationManager* operation_manager() { return operation_manager_.get(); }
   SessionManager* session_manager() { return session_manager_.get(); }
 
@@ -50,6 +60,7 @@ class ServerEnv {
   std::unique_ptr<Clock> clock_;
   std::unique_ptr<DatabaseManager> database_manager_;
   std::unique_ptr<InstanceManager> instance_manager_;
+  std::unique_ptr<LaneManager> lane_manager_;
   std::unique_ptr<OperationManager> operation_manager_;
   std::unique_ptr<SessionManager> session_manager_;
 };
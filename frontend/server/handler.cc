@@ -21,8 +21,20 @@
 #include <string>
 #include <utility>
 
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "common/config.h"
+#include "common/metrics.h"
+#include "frontend/collections/lane_manager.h"
+#include "frontend/server/request_log.h"
 
 namespace google {
 namespace spanner {
@@ -70,8 +82,104 @@ HandlerRegistry* GetHandlerRegistry() {
   return registry;
 }
 
+// Returns the URI of the database that `request` operates on, or an empty
+// string if it does not name one. Requests name their database through a
+// session, database, or other resource of the database (e.g. an operation).
+std::string RequestDatabaseUri(const google::protobuf::Message& request) {
+  static constexpr absl::string_view kDatabases = "/databases/";
+  const google::protobuf::Descriptor* descriptor = request.GetDescriptor();
+  for (const char* field_name : {"session", "database", "name", "parent"}) {
+    const google::protobuf::FieldDescriptor* field =
+        descriptor->FindFieldByName(field_name);
+    if (field == nullptr || field->is_repeated() ||
+        field->type() != google::protobuf::FieldDescriptor::TYPE_STRING) {
+      continue;
+    }
+    std::string uri = request.GetReflection()->GetString(request, field);
+    size_t start = uri.find(kDatabases);
+    if (start == std::string::npos) {
+      continue;
+    }
+    size_t end = uri.find('/', start + kDatabases.size());
+    if (end != std::string::npos) {
+      uri.resize(end);
+    }
+    return uri;
+  }
+  return "";
+}
+
 }  // namespace
 
+GRPCHandlerBase::GRPCHandlerBase(const std::string& service_name,
+                                 const std::string& method_name)
+    : service_name_(service_name),
+      method_name_(method_name),
+      full_method_name_(absl::StrCat(service_name, ".", method_name)) {
+  metrics::MetricRegistry* registry = metrics::MetricRegistry::Global();
+  const metrics::Labels labels = {
+      {"method", full_method_name_}};
+  latency_ = registry->GetHistogram("emulator_grpc_request_latency_seconds",
+                                    "Latency of gRPC requests, in seconds.",
+                                    metrics::LatencyBuckets(), labels);
+  in_flight_ = registry->GetGauge("emulator_grpc_requests_in_flight",
+                                  "Number of gRPC requests being served.",
+                                  labels);
+  request_bytes_ = registry->GetHistogram(
+      "emulator_grpc_request_bytes", "Size of gRPC request messages, in bytes.",
+      metrics::ByteSizeBuckets(), labels);
+  response_bytes_ = registry->GetHistogram(
+      "emulator_grpc_response_bytes",
+      "Size of gRPC responses, in bytes. For streaming methods, this is the "
+      "total size of the messages of a stream.",
+      metrics::ByteSizeBuckets(), labels);
+  errors_ = registry->GetCounter(
+      "emulator_grpc_errors_total", "Number of gRPC requests that failed.",
+      labels);
+}
+
+absl::Time GRPCHandlerBase::StartRequest(int64_t request_bytes) {
+  in_flight_->Add(1);
+  request_bytes_->Record(request_bytes);
+  return absl::Now();
+}
+
+void GRPCHandlerBase::EndRequest(absl::Time start_time, int64_t response_bytes,
+                                 const absl::Status& status) {
+  latency_->Record(absl::ToDoubleSeconds(absl::Now() - start_time));
+  response_bytes_->Record(response_bytes);
+  if (!status.ok()) {
+    errors_->Increment();
+  }
+  in_flight_->Add(-1);
+}
+
+absl::StatusOr<LaneManager::Slot> GRPCHandlerBase::EnterDatabaseLane(
+    RequestContext* ctx, const google::protobuf::Message& request) {
+  if (ctx->env() == nullptr || !ctx->env()->lane_manager()->enabled()) {
+    return LaneManager::Slot();
+  }
+  std::string database_uri = RequestDatabaseUri(request);
+  if (database_uri.empty()) {
+    return LaneManager::Slot();
+  }
+  return ctx->env()->lane_manager()->Admit(database_uri);
+}
+
+RequestLog* GRPCHandlerBase::LogRequest(
+    const google::protobuf::Message& request) {
+  if (!config::should_log_requests()) {
+    return nullptr;
+  }
+  RequestLog* request_log = RequestLog::Global();
+  if (!request_log->Sample()) {
+    return nullptr;
+  }
+  request_log->AddMessage(RequestLog::MessageKind::kRequest,
+                          full_method_name_, request);
+  return request_log;
+}
+
 HandlerRegisterer::HandlerRegisterer(std::unique_ptr<GRPCHandlerBase> handler) {
   GetHandlerRegistry()->AddHandler(std::move(handler));
 }
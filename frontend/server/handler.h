@@ -17,10 +17,25 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_HANDLER_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_HANDLER_H_
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
 #include "zetasql/base/logging.h"
+#include "google/protobuf/message.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "common/config.h"
+#include "common/errors.h"
+#include "common/metrics.h"
+#include "frontend/collections/lane_manager.h"
 #include "frontend/server/request_context.h"
+#include "frontend/server/request_log.h"
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/support/sync_stream.h"
 #include "absl/status/status.h"
@@ -38,34 +53,112 @@ namespace frontend {
 template <typename T>
 class ServerStream {
  public:
-  explicit ServerStream(grpc::ServerWriterInterface<T>* writer)
-      : writer_(writer) {}
+  // Messages are recorded in `request_log` under `method` if it is not null.
+  explicit ServerStream(grpc::ServerWriterInterface<T>* writer,
+                        RequestLog* request_log = nullptr,
+                        absl::string_view method = "")
+      : writer_(writer), request_log_(request_log), method_(method) {}
 
-  void Send(const T& msg) {
-    if (config::should_log_requests()) {
-      ABSL_LOG(INFO) << "Sending streaming response:\n" << msg.DebugString();
+  // Sends a message, blocking until the stream can accept it. Returns false if
+  // the stream has been closed, such as when the client cancelled the call.
+  bool Send(const T& msg) {
+    if (request_log_ != nullptr) {
+      request_log_->AddMessage(RequestLog::MessageKind::kStreamingResponse,
+                               method_, msg);
     }
-    writer_->Write(msg);
+    bytes_sent_ += msg.ByteSizeLong();
+    return writer_->Write(msg);
   }
 
+  // Total size of the messages sent so far.
+  int64_t bytes_sent() const { return bytes_sent_; }
+
  private:
   grpc::ServerWriterInterface<T>* writer_;
+  RequestLog* request_log_;
+  absl::string_view method_;
+  int64_t bytes_sent_ = 0;
+};
+
+// Callback to which type-erased handler invocations pass their responses (see
+// GRPCHandlerBase::RunMessage). Returns false if the responses can no longer be
+// delivered, such as when the client went away.
+using MessageSendFn = std::function<bool(const google::protobuf::Message&)>;
+
+// MessageServerWriter passes the messages written to it to a callback.
+//
+// This lets handlers written against grpc::ServerWriterInterface stream their
+// responses to front ends other than the gRPC server (see RestServer).
+template <typename T>
+class MessageServerWriter final : public grpc::ServerWriterInterface<T> {
+ public:
+  explicit MessageServerWriter(const MessageSendFn& send) : send_(send) {}
+
+  void SendInitialMetadata() override {}
+
+  bool Write(const T& msg, grpc::WriteOptions options) override {
+    return send_(msg);
+  }
+
+ private:
+  const MessageSendFn& send_;
 };
 
 // Base class for gRPC handlers.
+//
+// Handlers record per-method request metrics (latency, in-flight requests,
+// request and response sizes, errors) in the global metrics::MetricRegistry.
+// Requests which name a database, such as through their session, run in the
+// database's lane of the server's LaneManager.
 class GRPCHandlerBase {
  public:
   GRPCHandlerBase(const std::string& service_name,
-                  const std::string& method_name)
-      : service_name_(service_name), method_name_(method_name) {}
+                  const std::string& method_name);
   virtual ~GRPCHandlerBase() {}
 
   const std::string& service_name() { return service_name_; }
   const std::string& method_name() { return method_name_; }
 
+  // The method name qualified by the service name, e.g. "Spanner.Read".
+  const std::string& full_method_name() { return full_method_name_; }
+
+  // Runs the handler on `request`, which must be of the method's request type,
+  // and passes each response to `send`. Unary methods send their response only
+  // if they succeed. Server streaming methods stop sending once `send` returns
+  // false. Used by front ends which don't know the method's types statically.
+  virtual absl::Status RunMessage(RequestContext* ctx,
+                                  const google::protobuf::Message& request,
+                                  const MessageSendFn& send) = 0;
+
+ protected:
+  // Records the start of a request of `request_bytes` bytes. Returns the start
+  // time to pass to EndRequest.
+  absl::Time StartRequest(int64_t request_bytes);
+
+  // Records the end of a request started at `start_time`.
+  void EndRequest(absl::Time start_time, int64_t response_bytes,
+                  const absl::Status& status);
+
+  // Admits `request` into the lane of the database that it names, if any.
+  // Blocks while the lane is full.
+  absl::StatusOr<LaneManager::Slot> EnterDatabaseLane(
+      RequestContext* ctx, const google::protobuf::Message& request);
+
+  // Returns the log in which to record `request` and its responses, or nullptr
+  // if it should not be logged.
+  RequestLog* LogRequest(const google::protobuf::Message& request);
+
  private:
   const std::string service_name_;
   const std::string method_name_;
+  const std::string full_method_name_;
+
+  // Metrics of this method, owned by the global metrics registry.
+  metrics::Histogram* latency_;
+  metrics::Gauge* in_flight_;
+  metrics::Histogram* request_bytes_;
+  metrics::Histogram* response_bytes_;
+  metrics::Counter* errors_;
 };
 
 // UnaryGRPCHandler handles unary gRPC methods.
@@ -84,16 +177,33 @@ class UnaryGRPCHandler final : public GRPCHandlerBase {
   // Invokes the user-defined handler function wrapped by this class.
   absl::Status Run(RequestContext* ctx, const RequestT* request,
                    ResponseT* response) {
-    if (config::should_log_requests()) {
-      ABSL_LOG(INFO) << "Request[" << service_name() << "." << method_name() << "]\n"
-                << request->DebugString();
+    RequestLog* request_log = LogRequest(*request);
+    absl::Time start_time = StartRequest(request->ByteSizeLong());
+    absl::StatusOr<LaneManager::Slot> slot = EnterDatabaseLane(ctx, *request);
+    absl::Status status =
+        slot.ok() ? fn_(ctx, request, response) : slot.status();
+    EndRequest(start_time, response->ByteSizeLong(), status);
+    if (request_log != nullptr) {
+      request_log->AddMessage(RequestLog::MessageKind::kResponse,
+                              full_method_name(), *response);
+      request_log->AddStatus(full_method_name(), status);
+    }
+    return status;
+  }
+
+  absl::Status RunMessage(
+      RequestContext* ctx, const google::protobuf::Message& request,
+      const MessageSendFn& send) override {
+    if (request.GetDescriptor() != RequestT::descriptor()) {
+      return error::Internal(
+          absl::StrCat("Unexpected request type ", request.GetTypeName(),
+                       " for ", service_name(), ".", method_name()));
     }
-    absl::Status status = fn_(ctx, request, response);
-    if (config::should_log_requests()) {
-      ABSL_LOG(INFO) << "Response[" << service_name() << "." << method_name()
-                << "]\n"
-                << response->DebugString() << "\n"
-                << (status.ok() ? "OK" : "Error: " + status.ToString());
+    ResponseT response;
+    absl::Status status =
+        Run(ctx, static_cast<const RequestT*>(&request), &response);
+    if (status.ok()) {
+      send(response);
     }
     return status;
   }
@@ -118,21 +228,32 @@ class ServerStreamingGRPCHandler final : public GRPCHandlerBase {
   // Invokes the user-defined handler function wrapped by this class.
   absl::Status Run(RequestContext* ctx, const RequestT* request,
                    grpc::ServerWriterInterface<ResponseT>* writer) {
-    if (config::should_log_requests()) {
-      ABSL_LOG(INFO) << "Request[" << service_name() << "." << method_name() << "]\n"
-                << request->DebugString();
-    }
-    ServerStream<ResponseT> stream(writer);
-    absl::Status status = fn_(ctx, request, &stream);
-    if (config::should_log_requests()) {
-      ABSL_LOG(INFO) << "Response[" << service_name() << "." << method_name()
-                << "]\n"
-                << (status.ok() ? "OK" : "Error: " + status.ToString());
+    RequestLog* request_log = LogRequest(*request);
+    absl::Time start_time = StartRequest(request->ByteSizeLong());
+    ServerStream<ResponseT> stream(writer, request_log, full_method_name());
+    absl::StatusOr<LaneManager::Slot> slot = EnterDatabaseLane(ctx, *request);
+    absl::Status status =
+        slot.ok() ? fn_(ctx, request, &stream) : slot.status();
+    EndRequest(start_time, stream.bytes_sent(), status);
+    if (request_log != nullptr) {
+      request_log->AddStatus(full_method_name(), status);
     }
 
     return status;
   }
 
+  absl::Status RunMessage(
+      RequestContext* ctx, const google::protobuf::Message& request,
+      const MessageSendFn& send) override {
+    if (request.GetDescriptor() != RequestT::descriptor()) {
+      return error::Internal(
+          absl::StrCat("Unexpected request type ", request.GetTypeName(),
+                       " for ", service_name(), ".", method_name()));
+    }
+    MessageServerWriter<ResponseT> writer(send);
+    return Run(ctx, static_cast<const RequestT*>(&request), &writer);
+  }
+
  private:
   HandlerFn fn_;
 };
@@ -0,0 +1,100 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "frontend/server/listen_socket.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/errors.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+absl::StatusOr<int> ListenOn(const std::string& address,
+                             absl::string_view server_name, int* bound_port) {
+  size_t colon = address.find_last_of(':');
+  if (colon == std::string::npos) {
+    return error::Internal(
+        absl::StrCat("Invalid ", server_name, " address: ", address));
+  }
+  std::string host = address.substr(0, colon);
+  std::string port = address.substr(colon + 1);
+  if (absl::StartsWith(host, "[") && absl::EndsWith(host, "]")) {
+    host = host.substr(1, host.size() - 2);
+  }
+
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  struct addrinfo* addresses = nullptr;
+  int gai_status = ::getaddrinfo(host.empty() ? nullptr : host.c_str(),
+                                 port.c_str(), &hints, &addresses);
+  if (gai_status != 0) {
+    return error::Internal(absl::StrCat("Failed to resolve ", server_name,
+                                        " address ", address, ": ",
+                                        ::gai_strerror(gai_status)));
+  }
+  int listen_fd = -1;
+  for (struct addrinfo* ai = addresses; ai != nullptr; ai = ai->ai_next) {
+    listen_fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (listen_fd < 0) {
+      continue;
+    }
+    int reuse = 1;
+    ::setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (::bind(listen_fd, ai->ai_addr, ai->ai_addrlen) == 0 &&
+        ::listen(listen_fd, SOMAXCONN) == 0) {
+      break;
+    }
+    ::close(listen_fd);
+    listen_fd = -1;
+  }
+  ::freeaddrinfo(addresses);
+  if (listen_fd < 0) {
+    return error::Internal(absl::StrCat("Failed to bind ", server_name, " to ",
+                                        address, ": ", std::strerror(errno)));
+  }
+
+  struct sockaddr_storage bound = {};
+  socklen_t bound_len = sizeof(bound);
+  ::getsockname(listen_fd, reinterpret_cast<struct sockaddr*>(&bound),
+                &bound_len);
+  *bound_port =
+      bound.ss_family == AF_INET6
+          ? ntohs(reinterpret_cast<struct sockaddr_in6*>(&bound)->sin6_port)
+          : ntohs(reinterpret_cast<struct sockaddr_in*>(&bound)->sin_port);
+  return listen_fd;
+}
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
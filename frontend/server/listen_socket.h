@@ -0,0 +1,43 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_LISTEN_SOCKET_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_LISTEN_SOCKET_H_
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// Creates a TCP socket listening on `address` (host:port, with IPv6 hosts
+// optionally in brackets) and returns its file descriptor. A port of 0 picks a
+// free port. The port the socket is bound to is returned in `bound_port`.
+// `server_name` names the server in error messages.
+absl::StatusOr<int> ListenOn(const std::string& address,
+                             absl::string_view server_name, int* bound_port);
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_LISTEN_SOCKET_H_
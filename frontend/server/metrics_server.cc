@@ -0,0 +1,213 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/server/metrics_server.h"
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "zetasql/base/logging.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "common/metrics.h"
+#include "common/profiling.h"
+#include "frontend/server/listen_socket.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+namespace {
+
+// Requests larger than this are rejected. Scrapes only send a request line and
+// a few headers.
+constexpr size_t kMaxRequestSize = 8192;
+
+// Time after which a client that does not send its request is disconnected.
+constexpr int kReadTimeoutSeconds = 5;
+
+void WriteAll(int fd, absl::string_view data) {
+  while (!data.empty()) {
+    ssize_t written = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return;
+    }
+    data.remove_prefix(written);
+  }
+}
+
+// Default and maximum durations of a CPU profile, in seconds.
+constexpr int kDefaultCpuProfileSeconds = 30;
+constexpr int kMaxCpuProfileSeconds = 300;
+
+std::string HttpResponse(
+    absl::string_view status, absl::string_view body,
+    absl::string_view content_type = "text/plain; version=0.0.4") {
+  return absl::StrCat("HTTP/1.1 ", status, "\r\nContent-Type: ", content_type,
+                      "\r\nContent-Length: ", body.size(),
+                      "\r\nConnection: close\r\n\r\n", body);
+}
+
+// Returns the value of parameter `name` in the query string `query`, or an
+// empty string if it is absent.
+absl::string_view QueryParameter(absl::string_view query,
+                                 absl::string_view name) {
+  for (absl::string_view parameter : absl::StrSplit(query, '&')) {
+    std::pair<absl::string_view, absl::string_view> name_value =
+        absl::StrSplit(parameter, absl::MaxSplits('=', 1));
+    if (name_value.first == name) {
+      return name_value.second;
+    }
+  }
+  return "";
+}
+
+std::string CpuProfileResponse(absl::string_view query) {
+  int seconds = kDefaultCpuProfileSeconds;
+  absl::string_view seconds_parameter = QueryParameter(query, "seconds");
+  if (!seconds_parameter.empty() &&
+      (!absl::SimpleAtoi(seconds_parameter, &seconds) || seconds <= 0 ||
+       seconds > kMaxCpuProfileSeconds)) {
+    return HttpResponse("400 Bad Request",
+                        absl::StrCat("seconds must be between 1 and ",
+                                     kMaxCpuProfileSeconds, "\n"));
+  }
+  absl::StatusOr<std::string> profile =
+      profiling::CpuProfile(absl::Seconds(seconds));
+  if (!profile.ok()) {
+    return HttpResponse(absl::IsFailedPrecondition(profile.status())
+                            ? "409 Conflict"
+                            : "500 Internal Server Error",
+                        absl::StrCat(profile.status().message(), "\n"));
+  }
+  return HttpResponse("200 OK", *profile, "application/octet-stream");
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<MetricsServer>> MetricsServer::Create(
+    const std::string& address, metrics::MetricRegistry* registry) {
+  int bound_port = 0;
+  ZETASQL_ASSIGN_OR_RETURN(int listen_fd,
+                   ListenOn(address, "metrics server", &bound_port));
+  auto server =
+      absl::WrapUnique(new MetricsServer(listen_fd, bound_port, registry));
+  server->thread_ = std::thread([server = server.get()]() { server->Serve(); });
+  return server;
+}
+
+MetricsServer::MetricsServer(int listen_fd, int port,
+                             metrics::MetricRegistry* registry)
+    : listen_fd_(listen_fd), port_(port), registry_(registry) {}
+
+MetricsServer::~MetricsServer() { Shutdown(); }
+
+void MetricsServer::Shutdown() {
+  if (shutdown_.exchange(true)) {
+    return;
+  }
+  // Wakes up the serving thread blocked in accept().
+  ::shutdown(listen_fd_, SHUT_RDWR);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  ::close(listen_fd_);
+}
+
+void MetricsServer::Serve() {
+  while (!shutdown_.load()) {
+    int fd = ::accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (!shutdown_.load()) {
+        ABSL_LOG(ERROR) << "Metrics server stopped accepting requests: "
+                        << std::strerror(errno);
+      }
+      return;
+    }
+    HandleConnection(fd);
+    ::close(fd);
+  }
+}
+
+void MetricsServer::HandleConnection(int fd) {
+  struct timeval timeout = {};
+  timeout.tv_sec = kReadTimeoutSeconds;
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  // Read until the end of the request headers.
+  std::string request;
+  char buffer[1024];
+  while (!absl::StrContains(request, "\r\n\r\n") &&
+         request.size() < kMaxRequestSize) {
+    ssize_t read = ::recv(fd, buffer, sizeof(buffer), 0);
+    if (read < 0 && errno == EINTR) {
+      continue;
+    }
+    if (read <= 0) {
+      return;
+    }
+    request.append(buffer, read);
+  }
+
+  // The request target is between the method and the protocol version of the
+  // request line.
+  absl::string_view target;
+  if (absl::StartsWith(request, "GET ")) {
+    target = absl::string_view(request).substr(4);
+    target = target.substr(0, target.find_first_of(" \r\n"));
+  }
+  std::pair<absl::string_view, absl::string_view> path_query =
+      absl::StrSplit(target, absl::MaxSplits('?', 1));
+
+  if (path_query.first == "/metrics") {
+    WriteAll(fd, HttpResponse("200 OK", registry_->ExportPrometheus()));
+  } else if (path_query.first == "/debug/pprof/heap") {
+    WriteAll(fd, HttpResponse("200 OK",
+                              profiling::HeapProfile(
+                                  *profiling::MemoryUsageRegistry::Global())));
+  } else if (path_query.first == "/debug/pprof/profile") {
+    WriteAll(fd, CpuProfileResponse(path_query.second));
+  } else {
+    WriteAll(fd, HttpResponse("404 Not Found", "Not found\n"));
+  }
+}
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,79 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_METRICS_SERVER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_METRICS_SERVER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "absl/status/statusor.h"
+#include "common/metrics.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// MetricsServer serves the metrics of a metrics::MetricRegistry over HTTP, in
+// the Prometheus text exposition format, at the /metrics path.
+//
+// It also serves profiles of the process for debugging:
+//   /debug/pprof/heap              allocator statistics and the memory used by
+//                                  each subsystem, see profiling::HeapProfile.
+//   /debug/pprof/profile?seconds=N a CPU profile of the next N seconds (30 by
+//                                  default, at most 300), readable by pprof.
+//
+// Requests are served one at a time on a thread owned by the server. This is
+// meant for periodic scrapes, not for heavy traffic.
+class MetricsServer {
+ public:
+  // Starts a server listening on `address` (host:port). A port of 0 picks a
+  // free port, see port().
+  static absl::StatusOr<std::unique_ptr<MetricsServer>> Create(
+      const std::string& address, metrics::MetricRegistry* registry);
+
+  ~MetricsServer();
+
+  int port() const { return port_; }
+
+  // Stops accepting requests and waits for the serving thread to exit.
+  void Shutdown();
+
+ private:
+  MetricsServer(int listen_fd, int port, metrics::MetricRegistry* registry);
+
+  // Accepts and serves requests until shut down.
+  void Serve();
+
+  // Reads one request from `fd` and writes the response.
+  void HandleConnection(int fd);
+
+  const int listen_fd_;
+  const int port_;
+  metrics::MetricRegistry* registry_;
+  std::atomic<bool> shutdown_ = false;
+  std::thread thread_;
+};
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_METRICS_SERVER_H_
@@ -0,0 +1,137 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/server/metrics_server.h"
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/strings/str_cat.h"
+#include "common/metrics.h"
+#include "common/profiling.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+namespace {
+
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+using ::testing::StartsWith;
+
+// Sends `request` to the server listening on localhost:`port` and returns the
+// full response.
+std::string SendRequest(int port, const std::string& request) {
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* addresses = nullptr;
+  if (::getaddrinfo("localhost", absl::StrCat(port).c_str(), &hints,
+                    &addresses) != 0) {
+    return "";
+  }
+  int fd = -1;
+  for (struct addrinfo* ai = addresses; ai != nullptr; ai = ai->ai_next) {
+    fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd >= 0 && ::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+      break;
+    }
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+  ::freeaddrinfo(addresses);
+  if (fd < 0) {
+    return "";
+  }
+  ::send(fd, request.data(), request.size(), 0);
+  std::string response;
+  char buffer[1024];
+  ssize_t read;
+  while ((read = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, read);
+  }
+  ::close(fd);
+  return response;
+}
+
+class MetricsServerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    registry_.GetCounter("test_requests_total", "Test requests.")->Increment(7);
+    ZETASQL_ASSERT_OK_AND_ASSIGN(server_,
+                         MetricsServer::Create("localhost:0", &registry_));
+    ASSERT_GT(server_->port(), 0);
+  }
+
+  metrics::MetricRegistry registry_;
+  std::unique_ptr<MetricsServer> server_;
+};
+
+TEST_F(MetricsServerTest, ServesMetrics) {
+  std::string response =
+      SendRequest(server_->port(), "GET /metrics HTTP/1.1\r\n\r\n");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response, EndsWith("test_requests_total 7\n"));
+}
+
+TEST_F(MetricsServerTest, ServesHeapProfile) {
+  auto registration = profiling::MemoryUsageRegistry::Global()->Register(
+      "metrics_server_test", [] { return 42; });
+  std::string response =
+      SendRequest(server_->port(), "GET /debug/pprof/heap HTTP/1.1\r\n\r\n");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response, HasSubstr("\nmetrics_server_test: 42\n"));
+}
+
+TEST_F(MetricsServerTest, ServesCpuProfile) {
+  std::string response = SendRequest(
+      server_->port(), "GET /debug/pprof/profile?seconds=1 HTTP/1.1\r\n\r\n");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response, HasSubstr("Content-Type: application/octet-stream"));
+}
+
+TEST_F(MetricsServerTest, RejectsInvalidCpuProfileDuration) {
+  EXPECT_THAT(
+      SendRequest(server_->port(),
+                  "GET /debug/pprof/profile?seconds=x HTTP/1.1\r\n\r\n"),
+      StartsWith("HTTP/1.1 400 Bad Request\r\n"));
+}
+
+TEST_F(MetricsServerTest, ReturnsNotFoundForOtherPaths) {
+  EXPECT_THAT(SendRequest(server_->port(), "GET /other HTTP/1.1\r\n\r\n"),
+              StartsWith("HTTP/1.1 404 Not Found\r\n"));
+}
+
+TEST_F(MetricsServerTest, ShutsDown) {
+  server_->Shutdown();
+  EXPECT_EQ(SendRequest(server_->port(), "GET /metrics HTTP/1.1\r\n\r\n"), "");
+}
+
+}  // namespace
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
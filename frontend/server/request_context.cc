@@ -16,10 +16,13 @@
 
 #include "frontend/server/request_context.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <string>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "common/errors.h"
 #include "frontend/common/uris.h"
 #include "frontend/entities/instance.h"
 #include "zetasql/base/status_macros.h"
@@ -29,6 +32,19 @@ namespace spanner {
 namespace emulator {
 namespace frontend {
 
+absl::Status RequestContext::CheckNotCancelled() const {
+  if (grpc_ == nullptr) {
+    return absl::OkStatus();
+  }
+  if (grpc_->IsCancelled()) {
+    return error::RequestCancelled();
+  }
+  if (std::chrono::system_clock::now() > grpc_->deadline()) {
+    return error::RequestDeadlineExceeded();
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::shared_ptr<Instance>> GetInstance(
     RequestContext* ctx, const std::string& instance_uri) {
   absl::string_view project_id, instance_id;
@@ -51,9 +67,18 @@ absl::StatusOr<std::shared_ptr<Database>> GetDatabase(
 
 absl::StatusOr<std::shared_ptr<Session>> GetSession(
     RequestContext* ctx, const std::string& session_uri) {
-  // The ParseSessionUri and GetDatabase calls are needed for verification that
-  // the session URI and the database for this session is valid, even though
-  // they are not used after that.
+  // Sessions are only ever registered under valid URIs, and are deleted before
+  // their database and instance are (see DropDatabase and DeleteInstance).
+  // A registered session is therefore already bound to a live database, and
+  // the hot path is a single session lookup.
+  absl::StatusOr<std::shared_ptr<Session>> session =
+      ctx->env()->session_manager()->GetSession(session_uri);
+  if (session.ok()) {
+    return session;
+  }
+
+  // The ParseSessionUri and GetDatabase calls report the more specific error
+  // if the session URI or the database for this session is invalid.
   absl::string_view project_id, instance_id, database_id, session_id;
   ZETASQL_RETURN_IF_ERROR(ParseSessionUri(session_uri, &project_id, &instance_id,
                                   &database_id, &session_id));
@@ -61,7 +86,7 @@ absl::StatusOr<std::shared_ptr<Session>> GetSession(
       std::shared_ptr<Database> database,
       GetDatabase(ctx, MakeDatabaseUri(MakeInstanceUri(project_id, instance_id),
                                        database_id)));
-  return ctx->env()->session_manager()->GetSession(session_uri);
+  return session;
 }
 
 }  // namespace frontend
@@ -17,6 +17,7 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_REQUEST_CONTEXT_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_REQUEST_CONTEXT_H_
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "frontend/server/environment.h"
 #include "grpcpp/server_context.h"
@@ -36,6 +37,12 @@ class RequestContext {
   ServerEnv* env() { return env_; }
   grpc::ServerContext* grpc() { return grpc_; }
 
+  // Returns CANCELLED if the client cancelled the call, DEADLINE_EXCEEDED if
+  // its deadline expired, and OK otherwise, including for requests which are
+  // not gRPC calls. Thread safe, so that work on behalf of the request can
+  // check whether anyone still waits for it from any thread.
+  absl::Status CheckNotCancelled() const;
+
  private:
   // Server environment shared by all requests.
   ServerEnv* env_;
@@ -0,0 +1,203 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/server/request_log.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "zetasql/base/logging.h"
+#include "google/protobuf/message.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "common/config.h"
+#include "common/metrics.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+namespace {
+
+absl::string_view MessageKindName(RequestLog::MessageKind kind) {
+  switch (kind) {
+    case RequestLog::MessageKind::kRequest:
+      return "Request";
+    case RequestLog::MessageKind::kResponse:
+      return "Response";
+    case RequestLog::MessageKind::kStreamingResponse:
+      return "Streaming response";
+  }
+}
+
+void LogToInfo(const std::string& record) { ABSL_LOG(INFO) << record; }
+
+}  // namespace
+
+RequestLog::RequestLog(const Options& options, SinkFn sink)
+    : options_(options),
+      sink_(sink != nullptr ? std::move(sink) : LogToInfo),
+      dropped_metric_(metrics::MetricRegistry::Global()->GetCounter(
+          "emulator_request_log_dropped_total",
+          "Number of request log records dropped because the log buffer was "
+          "full.")) {
+  ring_.resize(std::max(options_.buffer_size, 1));
+  thread_ = std::thread(&RequestLog::WriteRecords, this);
+}
+
+RequestLog::~RequestLog() {
+  {
+    absl::MutexLock lock(&mu_);
+    stop_thread_ = true;
+  }
+  thread_.join();
+}
+
+RequestLog* RequestLog::Global() {
+  static RequestLog* const log = [] {
+    Options options;
+    options.sample_rate = config::request_log_sample_rate();
+    options.max_message_bytes = config::request_log_max_message_bytes();
+    options.buffer_size = config::request_log_buffer_size();
+    return new RequestLog(options);
+  }();
+  return log;
+}
+
+bool RequestLog::Sample() {
+  if (options_.sample_rate >= 1) {
+    return true;
+  }
+  if (options_.sample_rate <= 0) {
+    return false;
+  }
+  // Logs the n-th request whenever n * sample_rate crosses an integer, which
+  // spreads the logged requests evenly without a random number generator.
+  const uint64_t n = sample_counter_.fetch_add(1, std::memory_order_relaxed);
+  return static_cast<uint64_t>((n + 1) * options_.sample_rate) >
+         static_cast<uint64_t>(n * options_.sample_rate);
+}
+
+void RequestLog::AddMessage(MessageKind kind, absl::string_view method,
+                            const google::protobuf::Message& message) {
+  Record record;
+  record.kind = kind;
+  record.method = std::string(method);
+  record.prototype =
+      message.GetReflection()->GetMessageFactory()->GetPrototype(
+          message.GetDescriptor());
+  record.message_bytes = message.ByteSizeLong();
+  if (record.message_bytes <= options_.max_message_bytes) {
+    message.SerializeToString(&record.payload);
+  }
+  Add(std::move(record));
+}
+
+void RequestLog::AddStatus(absl::string_view method,
+                           const absl::Status& status) {
+  Record record;
+  record.method = std::string(method);
+  record.status = status;
+  Add(std::move(record));
+}
+
+void RequestLog::Add(Record record) {
+  absl::MutexLock lock(&mu_);
+  if (size_ == ring_.size()) {
+    num_dropped_.fetch_add(1);
+    dropped_metric_->Increment();
+    return;
+  }
+  ring_[(head_ + size_) % ring_.size()] = std::move(record);
+  ++size_;
+  ++num_added_;
+}
+
+void RequestLog::Flush() {
+  absl::MutexLock lock(&mu_);
+  const int64_t num_added = num_added_;
+  auto written = [this, num_added]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return num_written_ >= num_added;
+  };
+  mu_.Await(absl::Condition(&written));
+}
+
+bool RequestLog::HasRecordsOrStopping() const {
+  return size_ > 0 || stop_thread_;
+}
+
+void RequestLog::WriteRecords() {
+  std::vector<Record> records;
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      num_written_ += records.size();
+      records.clear();
+      mu_.Await(absl::Condition(this, &RequestLog::HasRecordsOrStopping));
+      if (size_ == 0) {
+        return;
+      }
+      // Takes all the pending records at once, so that the handlers can keep
+      // adding records while these are formatted and written.
+      records.reserve(size_);
+      for (; size_ > 0; --size_) {
+        records.push_back(std::move(ring_[head_]));
+        head_ = (head_ + 1) % ring_.size();
+      }
+    }
+    for (const Record& record : records) {
+      sink_(Format(record));
+    }
+  }
+}
+
+std::string RequestLog::Format(const Record& record) const {
+  if (record.status.has_value()) {
+    if (record.status->ok()) {
+      return absl::StrCat("Status[", record.method, "] OK");
+    }
+    return absl::StrCat("Status[", record.method,
+                        "] Error: ", record.status->ToString());
+  }
+  std::string out =
+      absl::StrCat(MessageKindName(record.kind), "[", record.method, "]\n");
+  if (record.message_bytes > options_.max_message_bytes) {
+    absl::StrAppend(&out, "<", record.prototype->GetTypeName(), " of ",
+                    record.message_bytes, " bytes, not logged>");
+    return out;
+  }
+  std::unique_ptr<google::protobuf::Message> message(record.prototype->New());
+  if (!message->ParseFromString(record.payload)) {
+    absl::StrAppend(&out, "<unparsable ", record.prototype->GetTypeName(),
+                    ">");
+    return out;
+  }
+  absl::StrAppend(&out, message->DebugString());
+  return out;
+}
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,156 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_REQUEST_LOG_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_REQUEST_LOG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "google/protobuf/message.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "common/metrics.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// RequestLog records the gRPC requests and responses of the emulator for
+// debugging (see --log_requests).
+//
+// Logging must not slow down the handlers enough to change the behavior being
+// debugged, so handler threads only serialize messages to the binary proto
+// format into a fixed-size ring buffer. A background thread owned by this
+// class drains the buffer, formats the messages as text and passes them to a
+// sink. Requests can be sampled, messages larger than a cap are recorded by
+// size only, and records which don't fit in the buffer are dropped (and
+// counted) rather than blocking the handler.
+class RequestLog {
+ public:
+  struct Options {
+    // Fraction of requests which are logged, along with their responses.
+    double sample_rate = 1;
+
+    // Messages larger than this many bytes are logged by size only.
+    int64_t max_message_bytes = 64 << 10;
+
+    // Maximum number of records waiting to be written.
+    int buffer_size = 4096;
+  };
+
+  // Receives each formatted record, on the background thread.
+  using SinkFn = std::function<void(const std::string&)>;
+
+  // Kinds of messages recorded by the log.
+  enum class MessageKind { kRequest, kResponse, kStreamingResponse };
+
+  // Creates a log which writes its records to the INFO log, or to `sink` if
+  // given.
+  explicit RequestLog(const Options& options, SinkFn sink = nullptr);
+
+  // Writes the remaining records and stops the background thread.
+  ~RequestLog();
+
+  // Returns the log used by the gRPC handlers, configured from the
+  // --request_log_* flags.
+  static RequestLog* Global();
+
+  // Returns true if a new request should be logged, according to the sample
+  // rate. All records of a request should share the decision.
+  bool Sample();
+
+  // Records `message`, of the given kind, sent to or by `method`.
+  void AddMessage(MessageKind kind, absl::string_view method,
+                  const google::protobuf::Message& message)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Records the status with which a call to `method` completed.
+  void AddStatus(absl::string_view method, const absl::Status& status)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Blocks until all records added so far have been passed to the sink.
+  void Flush() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of records dropped because the buffer was full.
+  int64_t dropped() const { return num_dropped_.load(); }
+
+ private:
+  struct Record {
+    MessageKind kind = MessageKind::kRequest;
+    std::string method;
+
+    // Default instance of the message type, used to parse `payload`. nullptr
+    // for status records.
+    const google::protobuf::Message* prototype = nullptr;
+
+    // The message in the binary proto format, unless it was too large.
+    std::string payload;
+    int64_t message_bytes = 0;
+
+    std::optional<absl::Status> status;
+  };
+
+  void Add(Record record) ABSL_LOCKS_EXCLUDED(mu_);
+  bool HasRecordsOrStopping() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void WriteRecords() ABSL_LOCKS_EXCLUDED(mu_);
+  std::string Format(const Record& record) const;
+
+  const Options options_;
+  const SinkFn sink_;
+
+  // Counter used to sample one request out of every 1 / sample_rate.
+  std::atomic<uint64_t> sample_counter_ = 0;
+
+  // Number of records dropped by this log, and by all logs in the global
+  // metrics registry.
+  std::atomic<int64_t> num_dropped_ = 0;
+  metrics::Counter* dropped_metric_;
+
+  absl::Mutex mu_;
+
+  // Ring buffer of the records waiting to be written, of which `size_` start
+  // at `head_`.
+  std::vector<Record> ring_ ABSL_GUARDED_BY(mu_);
+  size_t head_ ABSL_GUARDED_BY(mu_) = 0;
+  size_t size_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // Number of records added to and taken out of the ring buffer so far,
+  // including the ones being written.
+  int64_t num_added_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t num_written_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // Set when the background thread should exit.
+  bool stop_thread_ ABSL_GUARDED_BY(mu_) = false;
+
+  // The background thread which writes the records.
+  std::thread thread_;
+};
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_REQUEST_LOG_H_
@@ -0,0 +1,146 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/server/request_log.h"
+
+#include <string>
+#include <vector>
+
+#include "google/protobuf/wrappers.pb.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::StartsWith;
+
+class RequestLogTest : public testing::Test {
+ protected:
+  RequestLog::SinkFn Sink() {
+    return [this](const std::string& record) {
+      absl::MutexLock lock(&mu_);
+      records_.push_back(record);
+    };
+  }
+
+  std::vector<std::string> records() {
+    absl::MutexLock lock(&mu_);
+    return records_;
+  }
+
+  google::protobuf::StringValue Message(const std::string& value) {
+    google::protobuf::StringValue message;
+    message.set_value(value);
+    return message;
+  }
+
+  absl::Mutex mu_;
+  std::vector<std::string> records_ ABSL_GUARDED_BY(mu_);
+};
+
+TEST_F(RequestLogTest, FormatsRecordsInOrder) {
+  RequestLog log(RequestLog::Options(), Sink());
+  log.AddMessage(RequestLog::MessageKind::kRequest, "Spanner.Read",
+                 Message("request"));
+  log.AddMessage(RequestLog::MessageKind::kStreamingResponse, "Spanner.Read",
+                 Message("response"));
+  log.AddStatus("Spanner.Read", absl::OkStatus());
+  log.AddStatus("Spanner.Read", absl::NotFoundError("missing"));
+  log.Flush();
+
+  EXPECT_THAT(records(),
+              ElementsAre("Request[Spanner.Read]\nvalue: \"request\"\n",
+                          "Streaming response[Spanner.Read]\n"
+                          "value: \"response\"\n",
+                          "Status[Spanner.Read] OK",
+                          "Status[Spanner.Read] Error: NOT_FOUND: missing"));
+}
+
+TEST_F(RequestLogTest, LogsLargeMessagesBySizeOnly) {
+  RequestLog::Options options;
+  options.max_message_bytes = 16;
+  RequestLog log(options, Sink());
+  log.AddMessage(RequestLog::MessageKind::kResponse, "Spanner.ExecuteSql",
+                 Message(std::string(100, 'x')));
+  log.Flush();
+
+  ASSERT_EQ(records().size(), 1);
+  EXPECT_THAT(records()[0], StartsWith("Response[Spanner.ExecuteSql]\n"));
+  EXPECT_THAT(records()[0],
+              HasSubstr("google.protobuf.StringValue of 102 bytes"));
+}
+
+TEST_F(RequestLogTest, DropsRecordsWhenBufferIsFull) {
+  RequestLog::Options options;
+  options.buffer_size = 2;
+  absl::Notification release_sink;
+  absl::Notification sink_blocked;
+  RequestLog log(options, [&](const std::string& record) {
+    if (!sink_blocked.HasBeenNotified()) {
+      sink_blocked.Notify();
+    }
+    release_sink.WaitForNotification();
+  });
+
+  // The first record is taken by the background thread, which then blocks in
+  // the sink while the next two fill the buffer.
+  log.AddStatus("Spanner.Commit", absl::OkStatus());
+  sink_blocked.WaitForNotification();
+  log.AddStatus("Spanner.Commit", absl::OkStatus());
+  log.AddStatus("Spanner.Commit", absl::OkStatus());
+  log.AddStatus("Spanner.Commit", absl::OkStatus());
+  EXPECT_EQ(log.dropped(), 1);
+
+  release_sink.Notify();
+  log.Flush();
+}
+
+TEST_F(RequestLogTest, SamplesRequestsEvenly) {
+  RequestLog::Options options;
+  options.sample_rate = 0.25;
+  RequestLog log(options, Sink());
+  int sampled = 0;
+  for (int i = 0; i < 100; ++i) {
+    sampled += log.Sample();
+  }
+  EXPECT_EQ(sampled, 25);
+}
+
+TEST_F(RequestLogTest, SamplesAllOrNoRequests) {
+  RequestLog::Options all;
+  all.sample_rate = 1;
+  EXPECT_TRUE(RequestLog(all, Sink()).Sample());
+
+  RequestLog::Options none;
+  none.sample_rate = 0;
+  EXPECT_FALSE(RequestLog(none, Sink()).Sample());
+}
+
+}  // namespace
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,971 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "frontend/server/rest_server.h"
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/api/annotations.pb.h"
+#include "google/api/http.pb.h"
+#include "google/longrunning/operations.pb.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/json/json.h"
+#include "google/protobuf/message.h"
+#include "google/protobuf/struct.pb.h"
+#include "google/rpc/status.pb.h"
+#include "google/spanner/admin/database/v1/spanner_database_admin.pb.h"
+#include "google/spanner/admin/instance/v1/spanner_instance_admin.pb.h"
+#include "google/spanner/v1/spanner.pb.h"
+#include "zetasql/base/logging.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "common/errors.h"
+#include "common/limits.h"
+#include "frontend/server/handler.h"
+#include "frontend/server/listen_socket.h"
+#include "frontend/server/request_context.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+namespace {
+
+using ::google::protobuf::Descriptor;
+using ::google::protobuf::FieldDescriptor;
+using ::google::protobuf::Message;
+using ::google::protobuf::MethodDescriptor;
+using ::google::protobuf::Reflection;
+using ::google::protobuf::ServiceDescriptor;
+
+namespace database_api = ::google::spanner::admin::database::v1;
+namespace instance_api = ::google::spanner::admin::instance::v1;
+namespace operations_api = ::google::longrunning;
+namespace spanner_api = ::google::spanner::v1;
+
+// Requests whose headers are larger than this are rejected.
+constexpr size_t kMaxHeaderSize = 64 * 1024;
+
+// Time after which an idle keep-alive connection is closed.
+constexpr int kIdleTimeoutSeconds = 60;
+
+// A parsed google.api.http path template, such as
+//   /v1/{session=projects/*/instances/*/databases/*/sessions/*}:commit
+struct PathTemplate {
+  // A segment of the template: a literal, "*" (any single segment) or "**"
+  // (any number of segments).
+  struct Segment {
+    enum Kind { kLiteral, kSingle, kMulti };
+    Kind kind;
+    std::string literal;
+  };
+
+  // A variable binding the segments in [begin, end) to a request field.
+  struct Variable {
+    std::vector<std::string> field_path;
+    int begin;
+    int end;
+  };
+
+  std::vector<Segment> segments;
+  std::vector<Variable> variables;
+  std::string verb;
+};
+
+void AddTemplateSegment(absl::string_view segment, PathTemplate* path) {
+  if (segment == "*") {
+    path->segments.push_back({PathTemplate::Segment::kSingle, ""});
+  } else if (segment == "**") {
+    path->segments.push_back({PathTemplate::Segment::kMulti, ""});
+  } else {
+    path->segments.push_back(
+        {PathTemplate::Segment::kLiteral, std::string(segment)});
+  }
+}
+
+absl::StatusOr<PathTemplate> ParsePathTemplate(absl::string_view text) {
+  const std::string original(text);
+  if (!absl::ConsumePrefix(&text, "/")) {
+    return error::Internal(absl::StrCat("Invalid path template ", original));
+  }
+  PathTemplate path;
+  // The verb follows the last ':' outside of a variable and the last segment.
+  size_t last = text.find_last_of("}/");
+  size_t colon = text.find(':', last == absl::string_view::npos ? 0 : last);
+  if (colon != absl::string_view::npos) {
+    path.verb = std::string(text.substr(colon + 1));
+    text = text.substr(0, colon);
+  }
+  while (!text.empty()) {
+    if (absl::ConsumePrefix(&text, "{")) {
+      size_t close = text.find('}');
+      if (close == absl::string_view::npos) {
+        return error::Internal(
+            absl::StrCat("Invalid path template ", original));
+      }
+      std::vector<absl::string_view> binding =
+          absl::StrSplit(text.substr(0, close), absl::MaxSplits('=', 1));
+      text.remove_prefix(close + 1);
+      std::vector<std::string> field_path = absl::StrSplit(binding[0], '.');
+      PathTemplate::Variable variable;
+      variable.field_path = std::move(field_path);
+      variable.begin = path.segments.size();
+      for (absl::string_view segment : absl::StrSplit(
+               binding.size() > 1 ? binding[1] : "*", '/')) {
+        AddTemplateSegment(segment, &path);
+      }
+      variable.end = path.segments.size();
+      path.variables.push_back(std::move(variable));
+    } else {
+      absl::string_view segment = text.substr(0, text.find('/'));
+      AddTemplateSegment(segment, &path);
+      text.remove_prefix(segment.size());
+    }
+    if (!text.empty() && !absl::ConsumePrefix(&text, "/")) {
+      return error::Internal(absl::StrCat("Invalid path template ", original));
+    }
+  }
+  return path;
+}
+
+// Matches the (percent-decoded) `segments` and `verb` of a request path
+// against `path`. On a match, returns the value bound to each of the
+// template's variables.
+bool MatchPath(const PathTemplate& path,
+               const std::vector<std::string>& segments,
+               absl::string_view verb, std::vector<std::string>* values) {
+  if (verb != path.verb) {
+    return false;
+  }
+  // The range of request segments matched by each template segment.
+  std::vector<std::pair<int, int>> matched(path.segments.size());
+  int next = 0;
+  for (int i = 0; i < path.segments.size(); ++i) {
+    const PathTemplate::Segment& segment = path.segments[i];
+    int count = 1;
+    if (segment.kind == PathTemplate::Segment::kMulti) {
+      count = segments.size() - next - (path.segments.size() - i - 1);
+      if (count < 0) {
+        return false;
+      }
+    } else if (next >= segments.size() ||
+               (segment.kind == PathTemplate::Segment::kLiteral &&
+                segments[next] != segment.literal)) {
+      return false;
+    }
+    matched[i] = {next, next + count};
+    next += count;
+  }
+  if (next != segments.size()) {
+    return false;
+  }
+  values->clear();
+  for (const PathTemplate::Variable& variable : path.variables) {
+    if (variable.begin == variable.end) {
+      values->emplace_back();
+      continue;
+    }
+    values->push_back(absl::StrJoin(
+        segments.begin() + matched[variable.begin].first,
+        segments.begin() + matched[variable.end - 1].second, "/"));
+  }
+  return true;
+}
+
+// Returns the value of the hexadecimal digit `c`.
+int HexDigitValue(char c) {
+  return absl::ascii_isdigit(c) ? c - '0' : absl::ascii_tolower(c) - 'a' + 10;
+}
+
+// Decodes %XX escapes, and '+' as a space if `plus_is_space`.
+std::string PercentDecode(absl::string_view text, bool plus_is_space) {
+  std::string decoded;
+  decoded.reserve(text.size());
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == '%' && i + 2 < text.size() &&
+        absl::ascii_isxdigit(text[i + 1]) &&
+        absl::ascii_isxdigit(text[i + 2])) {
+      decoded.push_back(static_cast<char>(HexDigitValue(text[i + 1]) * 16 +
+                                          HexDigitValue(text[i + 2])));
+      i += 2;
+    } else if (plus_is_space && text[i] == '+') {
+      decoded.push_back(' ');
+    } else {
+      decoded.push_back(text[i]);
+    }
+  }
+  return decoded;
+}
+
+// Returns the field of `descriptor` named `name`, either by its proto name or
+// by its JSON (lowerCamelCase) name, or nullptr if there is none.
+const FieldDescriptor* FindField(const Descriptor* descriptor,
+                                 absl::string_view name) {
+  const FieldDescriptor* field = descriptor->FindFieldByName(std::string(name));
+  if (field != nullptr) {
+    return field;
+  }
+  for (int i = 0; i < descriptor->field_count(); ++i) {
+    if (descriptor->field(i)->json_name() == name) {
+      return descriptor->field(i);
+    }
+  }
+  return nullptr;
+}
+
+// Sets the field at `field_path` in `message` from its string representation
+// in a URL (a path variable or a query parameter). Repeated fields get `value`
+// appended.
+absl::Status SetFieldFromString(const std::vector<std::string>& field_path,
+                                absl::string_view value, Message* message) {
+  const std::string path = absl::StrJoin(field_path, ".");
+  for (int i = 0; i < field_path.size(); ++i) {
+    const FieldDescriptor* field =
+        FindField(message->GetDescriptor(), field_path[i]);
+    if (field == nullptr) {
+      return error::InvalidArgument(
+          absl::StrCat("Unknown request field ", path));
+    }
+    const Reflection* reflection = message->GetReflection();
+    if (i + 1 < field_path.size()) {
+      if (field->cpp_type() != FieldDescriptor::CPPTYPE_MESSAGE ||
+          field->is_repeated()) {
+        return error::InvalidArgument(
+            absl::StrCat("Invalid request field ", path));
+      }
+      message = reflection->MutableMessage(message, field);
+      continue;
+    }
+
+    bool repeated = field->is_repeated();
+    bool valid = true;
+    switch (field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_STRING: {
+        std::string string_value(value);
+        if (field->type() == FieldDescriptor::TYPE_BYTES) {
+          valid = absl::WebSafeBase64Unescape(value, &string_value) ||
+                  absl::Base64Unescape(value, &string_value);
+        }
+        repeated ? reflection->AddString(message, field, string_value)
+                 : reflection->SetString(message, field, string_value);
+        break;
+      }
+      case FieldDescriptor::CPPTYPE_INT32: {
+        int32_t number = 0;
+        valid = absl::SimpleAtoi(value, &number);
+        repeated ? reflection->AddInt32(message, field, number)
+                 : reflection->SetInt32(message, field, number);
+        break;
+      }
+      case FieldDescriptor::CPPTYPE_INT64: {
+        int64_t number = 0;
+        valid = absl::SimpleAtoi(value, &number);
+        repeated ? reflection->AddInt64(message, field, number)
+                 : reflection->SetInt64(message, field, number);
+        break;
+      }
+      case FieldDescriptor::CPPTYPE_UINT32: {
+        uint32_t number = 0;
+        valid = absl::SimpleAtoi(value, &number);
+        repeated ? reflection->AddUInt32(message, field, number)
+                 : reflection->SetUInt32(message, field, number);
+        break;
+      }
+      case FieldDescriptor::CPPTYPE_UINT64: {
+        uint64_t number = 0;
+        valid = absl::SimpleAtoi(value, &number);
+        repeated ? reflection->AddUInt64(message, field, number)
+                 : reflection->SetUInt64(message, field, number);
+        break;
+      }
+      case FieldDescriptor::CPPTYPE_DOUBLE: {
+        double number = 0;
+        valid = absl::SimpleAtod(value, &number);
+        repeated ? reflection->AddDouble(message, field, number)
+                 : reflection->SetDouble(message, field, number);
+        break;
+      }
+      case FieldDescriptor::CPPTYPE_FLOAT: {
+        float number = 0;
+        valid = absl::SimpleAtof(value, &number);
+        repeated ? reflection->AddFloat(message, field, number)
+                 : reflection->SetFloat(message, field, number);
+        break;
+      }
+      case FieldDescriptor::CPPTYPE_BOOL: {
+        bool boolean = false;
+        valid = absl::SimpleAtob(value, &boolean);
+        repeated ? reflection->AddBool(message, field, boolean)
+                 : reflection->SetBool(message, field, boolean);
+        break;
+      }
+      case FieldDescriptor::CPPTYPE_ENUM: {
+        const google::protobuf::EnumValueDescriptor* enum_value =
+            field->enum_type()->FindValueByName(std::string(value));
+        int number = 0;
+        if (enum_value != nullptr) {
+          number = enum_value->number();
+        } else {
+          valid = absl::SimpleAtoi(value, &number);
+        }
+        repeated ? reflection->AddEnumValue(message, field, number)
+                 : reflection->SetEnumValue(message, field, number);
+        break;
+      }
+      case FieldDescriptor::CPPTYPE_MESSAGE: {
+        // Messages given in URLs are well-known types with a JSON string
+        // representation, such as FieldMask, Timestamp or Duration.
+        Message* field_message =
+            repeated ? reflection->AddMessage(message, field)
+                     : reflection->MutableMessage(message, field);
+        google::protobuf::Value json_value;
+        json_value.set_string_value(std::string(value));
+        std::string json;
+        valid = google::protobuf::json::MessageToJsonString(json_value, &json)
+                    .ok() &&
+                google::protobuf::json::JsonStringToMessage(json, field_message)
+                    .ok();
+        break;
+      }
+    }
+    if (!valid) {
+      return error::InvalidArgument(
+          absl::StrCat("Invalid value for request field ", path, ": ", value));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Maps a gRPC status code to its HTTP status, the same way as the gateway.
+absl::string_view HttpStatusFromCode(absl::StatusCode code) {
+  switch (code) {
+    case absl::StatusCode::kOk:
+      return "200 OK";
+    case absl::StatusCode::kCancelled:
+      return "499 Client Closed Request";
+    case absl::StatusCode::kInvalidArgument:
+    case absl::StatusCode::kFailedPrecondition:
+    case absl::StatusCode::kOutOfRange:
+      return "400 Bad Request";
+    case absl::StatusCode::kDeadlineExceeded:
+      return "504 Gateway Timeout";
+    case absl::StatusCode::kNotFound:
+      return "404 Not Found";
+    case absl::StatusCode::kAlreadyExists:
+    case absl::StatusCode::kAborted:
+      return "409 Conflict";
+    case absl::StatusCode::kPermissionDenied:
+      return "403 Forbidden";
+    case absl::StatusCode::kUnauthenticated:
+      return "401 Unauthorized";
+    case absl::StatusCode::kResourceExhausted:
+      return "429 Too Many Requests";
+    case absl::StatusCode::kUnimplemented:
+      return "501 Not Implemented";
+    case absl::StatusCode::kUnavailable:
+      return "503 Service Unavailable";
+    default:
+      return "500 Internal Server Error";
+  }
+}
+
+// Returns the JSON representation of `message` in the REST API, which uses
+// lowerCamelCase field names.
+std::string ToJson(const Message& message) {
+  std::string json;
+  absl::Status status = google::protobuf::json::MessageToJsonString(
+      message, &json, google::protobuf::json::PrintOptions());
+  if (!status.ok()) {
+    ABSL_LOG(ERROR) << "Failed to convert " << message.GetTypeName()
+                    << " to JSON: " << status;
+    return "{}";
+  }
+  return json;
+}
+
+// Returns the JSON error object for `status`.
+std::string ErrorToJson(const absl::Status& status) {
+  google::rpc::Status status_pb;
+  status_pb.set_code(static_cast<int>(status.code()));
+  status_pb.set_message(std::string(status.message()));
+  return ToJson(status_pb);
+}
+
+bool WriteAll(int fd, absl::string_view data) {
+  while (!data.empty()) {
+    ssize_t written = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+    data.remove_prefix(written);
+  }
+  return true;
+}
+
+// Writes a complete (non-streaming) response.
+bool WriteResponse(int fd, absl::string_view status, absl::string_view body,
+                   bool keep_alive) {
+  return WriteAll(
+      fd, absl::StrCat("HTTP/1.1 ", status,
+                       "\r\nContent-Type: application/json\r\nContent-Length: ",
+                       body.size(), "\r\nConnection: ",
+                       keep_alive ? "keep-alive" : "close", "\r\n\r\n", body));
+}
+
+// Writes `data` as one chunk of a chunked response.
+bool WriteChunk(int fd, absl::string_view data) {
+  return WriteAll(fd, absl::StrCat(absl::Hex(data.size()), "\r\n", data,
+                                   "\r\n"));
+}
+
+// A parsed HTTP request.
+struct HttpRequest {
+  std::string method;
+  std::vector<std::string> path_segments;
+  std::string verb_suffix;
+  std::vector<std::pair<std::string, std::string>> query_params;
+  std::string body;
+  bool keep_alive = true;
+};
+
+// Reads HTTP requests off a connection. Bytes read past the end of a request
+// are kept for the next one, so pipelined requests are served in order.
+class HttpRequestReader {
+ public:
+  explicit HttpRequestReader(int fd) : fd_(fd) {}
+
+  // Reads the next request. Returns false if the connection closed or timed
+  // out before a complete request was read, or if the request was malformed,
+  // in which case `*error` is set to the HTTP status to reply with.
+  bool Read(HttpRequest* request, std::string* error) {
+    size_t header_end;
+    while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos) {
+      if (buffer_.size() > kMaxHeaderSize) {
+        *error = "431 Request Header Fields Too Large";
+        return false;
+      }
+      if (!Fill()) {
+        return false;
+      }
+    }
+    std::vector<absl::string_view> lines = absl::StrSplit(
+        absl::string_view(buffer_).substr(0, header_end), "\r\n");
+    std::vector<absl::string_view> request_line =
+        absl::StrSplit(lines[0], ' ', absl::SkipEmpty());
+    if (request_line.size() != 3) {
+      *error = "400 Bad Request";
+      return false;
+    }
+    request->method = std::string(request_line[0]);
+    request->keep_alive = request_line[2] != "HTTP/1.0";
+    size_t content_length = 0;
+    bool expect_continue = false;
+    for (int i = 1; i < lines.size(); ++i) {
+      std::pair<absl::string_view, absl::string_view> header =
+          absl::StrSplit(lines[i], absl::MaxSplits(':', 1));
+      std::string name = absl::AsciiStrToLower(header.first);
+      std::string value =
+          absl::AsciiStrToLower(absl::StripAsciiWhitespace(header.second));
+      if (name == "content-length") {
+        if (!absl::SimpleAtoi(value, &content_length)) {
+          *error = "400 Bad Request";
+          return false;
+        }
+      } else if (name == "transfer-encoding") {
+        *error = "411 Length Required";
+        return false;
+      } else if (name == "connection") {
+        request->keep_alive = value == "keep-alive" ||
+                              (request->keep_alive && value != "close");
+      } else if (name == "expect") {
+        expect_continue = value == "100-continue";
+      }
+    }
+    if (content_length > limits::kMaxGRPCIncomingMessageSize) {
+      *error = "413 Payload Too Large";
+      return false;
+    }
+    ParseTarget(request_line[1], request);
+    buffer_.erase(0, header_end + 4);
+
+    if (expect_continue && buffer_.size() < content_length &&
+        !WriteAll(fd_, "HTTP/1.1 100 Continue\r\n\r\n")) {
+      return false;
+    }
+    while (buffer_.size() < content_length) {
+      if (!Fill()) {
+        return false;
+      }
+    }
+    request->body = buffer_.substr(0, content_length);
+    buffer_.erase(0, content_length);
+    return true;
+  }
+
+ private:
+  // Splits the request target into its path segments, the verb suffix of the
+  // last segment (after a ':'), and the query parameters.
+  static void ParseTarget(absl::string_view target, HttpRequest* request) {
+    std::pair<absl::string_view, absl::string_view> path_and_query =
+        absl::StrSplit(target, absl::MaxSplits('?', 1));
+    absl::string_view path = path_and_query.first;
+    absl::ConsumePrefix(&path, "/");
+    request->path_segments.clear();
+    for (absl::string_view segment : absl::StrSplit(path, '/')) {
+      request->path_segments.push_back(PercentDecode(segment, false));
+    }
+    request->verb_suffix.clear();
+    std::string& last = request->path_segments.back();
+    size_t colon = last.find_last_of(':');
+    if (colon != std::string::npos) {
+      request->verb_suffix = last.substr(colon + 1);
+    }
+    request->query_params.clear();
+    for (absl::string_view param :
+         absl::StrSplit(path_and_query.second, '&', absl::SkipEmpty())) {
+      std::pair<absl::string_view, absl::string_view> key_value =
+          absl::StrSplit(param, absl::MaxSplits('=', 1));
+      request->query_params.emplace_back(PercentDecode(key_value.first, true),
+                                         PercentDecode(key_value.second, true));
+    }
+  }
+
+  // Reads more bytes into the buffer. Returns false on EOF, error or timeout.
+  bool Fill() {
+    char buffer[16 * 1024];
+    while (true) {
+      ssize_t read = ::recv(fd_, buffer, sizeof(buffer), 0);
+      if (read < 0 && errno == EINTR) {
+        continue;
+      }
+      if (read <= 0) {
+        return false;
+      }
+      buffer_.append(buffer, read);
+      return true;
+    }
+  }
+
+  const int fd_;
+  std::string buffer_;
+};
+
+// The services served by the REST API, and the name of the service their
+// handlers are registered under.
+struct ServiceBinding {
+  const ServiceDescriptor* service;
+  const char* handler_service;
+};
+
+std::vector<ServiceBinding> RestServices() {
+  return {
+      {spanner_api::CreateSessionRequest::descriptor()->file()->service(0),
+       "Spanner"},
+      {database_api::CreateDatabaseRequest::descriptor()->file()->service(0),
+       "DatabaseAdmin"},
+      {instance_api::CreateInstanceRequest::descriptor()->file()->service(0),
+       "InstanceAdmin"},
+  };
+}
+
+// The HTTP bindings of the longrunning operations service, which override the
+// generic ones of its proto (see gateway/operations.yaml).
+struct OperationsBinding {
+  const char* method;
+  const char* http_method;
+  const char* path;
+};
+
+constexpr OperationsBinding kOperationsBindings[] = {
+    {"GetOperation", "GET",
+     "/v1/{name=projects/*/instances/*/databases/*/operations/*}"},
+    {"GetOperation", "GET", "/v1/{name=projects/*/instances/*/operations/*}"},
+    {"ListOperations", "GET",
+     "/v1/{name=projects/*/instances/*/databases/*/operations}"},
+    {"ListOperations", "GET", "/v1/{name=projects/*/instances/*/operations}"},
+    {"CancelOperation", "POST",
+     "/v1/{name=projects/*/instances/*/databases/*/operations/*}:cancel"},
+    {"CancelOperation", "POST",
+     "/v1/{name=projects/*/instances/*/operations/*}:cancel"},
+    {"DeleteOperation", "DELETE",
+     "/v1/{name=projects/*/instances/*/databases/*/operations/*}"},
+    {"DeleteOperation", "DELETE",
+     "/v1/{name=projects/*/instances/*/operations/*}"},
+};
+
+}  // namespace
+
+struct RestServer::Route {
+  std::string http_method;
+  PathTemplate path;
+  // The request field the body is parsed into: "*" for the whole request, or
+  // empty if the request has no body.
+  std::string body;
+  const MethodDescriptor* method;
+  GRPCHandlerBase* handler;
+};
+
+namespace {
+
+// Returns the HTTP method and path template of `rule`.
+std::pair<std::string, std::string> HttpRulePattern(
+    const google::api::HttpRule& rule) {
+  switch (rule.pattern_case()) {
+    case google::api::HttpRule::kGet:
+      return {"GET", rule.get()};
+    case google::api::HttpRule::kPut:
+      return {"PUT", rule.put()};
+    case google::api::HttpRule::kPost:
+      return {"POST", rule.post()};
+    case google::api::HttpRule::kDelete:
+      return {"DELETE", rule.delete_()};
+    case google::api::HttpRule::kPatch:
+      return {"PATCH", rule.patch()};
+    case google::api::HttpRule::kCustom:
+      return {rule.custom().kind(), rule.custom().path()};
+    default:
+      return {"", ""};
+  }
+}
+
+absl::Status AddRoute(const std::string& http_method,
+                      const std::string& path_template,
+                      const std::string& body,
+                      const MethodDescriptor* method,
+                      GRPCHandlerBase* handler,
+                      std::vector<RestServer::Route>* routes) {
+  ZETASQL_ASSIGN_OR_RETURN(PathTemplate path, ParsePathTemplate(path_template));
+  routes->push_back({http_method, std::move(path), body, method, handler});
+  return absl::OkStatus();
+}
+
+// Builds the routes of all the methods of the REST API which have a handler.
+absl::StatusOr<std::vector<RestServer::Route>> BuildRoutes() {
+  std::vector<RestServer::Route> routes;
+  for (const ServiceBinding& binding : RestServices()) {
+    for (int i = 0; i < binding.service->method_count(); ++i) {
+      const MethodDescriptor* method = binding.service->method(i);
+      GRPCHandlerBase* handler =
+          GetHandler(binding.handler_service, method->name());
+      if (handler == nullptr) {
+        // The IAM methods of both admin services share the handlers
+        // registered for InstanceAdmin (see server.cc).
+        handler = GetHandler("InstanceAdmin", method->name());
+      }
+      if (handler == nullptr ||
+          !method->options().HasExtension(google::api::http)) {
+        continue;
+      }
+      const google::api::HttpRule& rule =
+          method->options().GetExtension(google::api::http);
+      std::vector<const google::api::HttpRule*> rules = {&rule};
+      for (const google::api::HttpRule& additional :
+           rule.additional_bindings()) {
+        rules.push_back(&additional);
+      }
+      for (const google::api::HttpRule* http_rule : rules) {
+        auto [http_method, path] = HttpRulePattern(*http_rule);
+        if (http_method.empty()) {
+          continue;
+        }
+        ZETASQL_RETURN_IF_ERROR(AddRoute(http_method, path, http_rule->body(),
+                                 method, handler, &routes));
+      }
+    }
+  }
+
+  const ServiceDescriptor* operations =
+      operations_api::GetOperationRequest::descriptor()->file()->service(0);
+  for (const OperationsBinding& binding : kOperationsBindings) {
+    GRPCHandlerBase* handler = GetHandler("Operations", binding.method);
+    if (handler == nullptr) {
+      continue;
+    }
+    ZETASQL_RETURN_IF_ERROR(AddRoute(binding.http_method, binding.path, /*body=*/"",
+                             operations->FindMethodByName(binding.method),
+                             handler, &routes));
+  }
+  return routes;
+}
+
+// Builds the request message of `route` from `http_request`.
+absl::Status ParseRequest(const RestServer::Route& route,
+                          const HttpRequest& http_request,
+                          const std::vector<std::string>& path_values,
+                          Message* request) {
+  if (!route.body.empty() && !http_request.body.empty()) {
+    Message* body = request;
+    if (route.body != "*") {
+      const FieldDescriptor* field =
+          request->GetDescriptor()->FindFieldByName(route.body);
+      if (field == nullptr ||
+          field->cpp_type() != FieldDescriptor::CPPTYPE_MESSAGE) {
+        return error::Internal(absl::StrCat("Invalid body field ", route.body,
+                                            " of ", route.method->full_name()));
+      }
+      body = request->GetReflection()->MutableMessage(request, field);
+    }
+    absl::Status status =
+        google::protobuf::json::JsonStringToMessage(http_request.body, body);
+    if (!status.ok()) {
+      return error::InvalidArgument(
+          absl::StrCat("Invalid JSON request body: ", status.message()));
+    }
+  }
+  // Fields bound in the path take precedence over the ones in the body.
+  for (int i = 0; i < route.path.variables.size(); ++i) {
+    ZETASQL_RETURN_IF_ERROR(SetFieldFromString(route.path.variables[i].field_path,
+                                       path_values[i], request));
+  }
+  // Query parameters set the fields that are neither in the path nor the body.
+  if (route.body != "*") {
+    for (const auto& [name, value] : http_request.query_params) {
+      std::vector<std::string> field_path = absl::StrSplit(name, '.');
+      ZETASQL_RETURN_IF_ERROR(SetFieldFromString(field_path, value, request));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<RestServer>> RestServer::Create(
+    const std::string& address, ServerEnv* env) {
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<Route> routes, BuildRoutes());
+  int bound_port = 0;
+  ZETASQL_ASSIGN_OR_RETURN(int listen_fd,
+                   ListenOn(address, "REST server", &bound_port));
+  auto server = absl::WrapUnique(
+      new RestServer(listen_fd, bound_port, env, std::move(routes)));
+  server->thread_ = std::thread([server = server.get()]() { server->Serve(); });
+  return server;
+}
+
+RestServer::RestServer(int listen_fd, int port, ServerEnv* env,
+                       std::vector<Route> routes)
+    : listen_fd_(listen_fd),
+      port_(port),
+      env_(env),
+      routes_(std::move(routes)) {}
+
+RestServer::~RestServer() { Shutdown(); }
+
+void RestServer::Shutdown() {
+  if (shutdown_.exchange(true)) {
+    return;
+  }
+  // Wakes up the serving thread blocked in accept().
+  ::shutdown(listen_fd_, SHUT_RDWR);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  ::close(listen_fd_);
+
+  absl::MutexLock lock(&mu_);
+  for (const std::unique_ptr<Connection>& connection : connections_) {
+    // Wakes up connection threads waiting for the next request.
+    ::shutdown(connection->fd, SHUT_RDWR);
+  }
+  for (const std::unique_ptr<Connection>& connection : connections_) {
+    connection->thread.join();
+    ::close(connection->fd);
+  }
+  connections_.clear();
+}
+
+void RestServer::ReapConnections() {
+  for (auto itr = connections_.begin(); itr != connections_.end();) {
+    if ((*itr)->done.load()) {
+      (*itr)->thread.join();
+      ::close((*itr)->fd);
+      itr = connections_.erase(itr);
+    } else {
+      ++itr;
+    }
+  }
+}
+
+void RestServer::Serve() {
+  while (!shutdown_.load()) {
+    int fd = ::accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (!shutdown_.load()) {
+        ABSL_LOG(ERROR) << "REST server stopped accepting requests: "
+                        << std::strerror(errno);
+      }
+      return;
+    }
+    absl::MutexLock lock(&mu_);
+    ReapConnections();
+    auto connection = std::make_unique<Connection>();
+    connection->fd = fd;
+    Connection* raw_connection = connection.get();
+    connection->thread = std::thread([this, raw_connection]() {
+      HandleConnection(raw_connection->fd);
+      raw_connection->done.store(true);
+    });
+    connections_.push_back(std::move(connection));
+  }
+}
+
+void RestServer::HandleConnection(int fd) {
+  struct timeval timeout = {};
+  timeout.tv_sec = kIdleTimeoutSeconds;
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  HttpRequestReader reader(fd);
+  HttpRequest http_request;
+  std::vector<std::string> path_values;
+  while (!shutdown_.load()) {
+    std::string read_error;
+    if (!reader.Read(&http_request, &read_error)) {
+      if (!read_error.empty()) {
+        WriteResponse(fd, read_error, "", /*keep_alive=*/false);
+      }
+      return;
+    }
+    bool keep_alive = http_request.keep_alive;
+
+    // Find the method the request is for.
+    const Route* route = nullptr;
+    for (const Route& candidate : routes_) {
+      if (candidate.http_method != http_request.method) {
+        continue;
+      }
+      std::vector<std::string> segments = http_request.path_segments;
+      absl::string_view verb;
+      if (!candidate.path.verb.empty()) {
+        if (http_request.verb_suffix != candidate.path.verb) {
+          continue;
+        }
+        verb = candidate.path.verb;
+        segments.back().resize(segments.back().size() - verb.size() - 1);
+      }
+      if (MatchPath(candidate.path, segments, verb, &path_values)) {
+        route = &candidate;
+        break;
+      }
+    }
+    if (route == nullptr) {
+      if (!WriteResponse(fd, "404 Not Found",
+                         ErrorToJson(absl::Status(absl::StatusCode::kNotFound,
+                                                 "Not Found")),
+                         keep_alive) ||
+          !keep_alive) {
+        return;
+      }
+      continue;
+    }
+
+    std::unique_ptr<Message> request(
+        google::protobuf::MessageFactory::generated_factory()
+            ->GetPrototype(route->method->input_type())
+            ->New());
+    absl::Status status =
+        ParseRequest(*route, http_request, path_values, request.get());
+
+    // Unary responses are buffered so that their status can be reported in
+    // the HTTP status line. Streaming responses start a chunked response with
+    // their first message.
+    bool streaming = route->method->server_streaming();
+    bool stream_started = false;
+    bool connection_ok = true;
+    std::string response_json;
+    if (status.ok()) {
+      RequestContext ctx(env_, /*grpc=*/nullptr);
+      status = route->handler->RunMessage(
+          &ctx, *request, [&](const Message& response) {
+            if (!streaming) {
+              response_json = ToJson(response);
+              return true;
+            }
+            if (!stream_started) {
+              stream_started = true;
+              connection_ok = WriteAll(
+                  fd, absl::StrCat("HTTP/1.1 200 OK\r\n"
+                                   "Content-Type: application/json\r\n"
+                                   "Transfer-Encoding: chunked\r\n"
+                                   "Connection: ",
+                                   keep_alive ? "keep-alive" : "close",
+                                   "\r\n\r\n"));
+            }
+            connection_ok =
+                connection_ok &&
+                WriteChunk(fd, absl::StrCat("{\"result\":", ToJson(response),
+                                            "}\n"));
+            return connection_ok;
+          });
+    }
+
+    if (stream_started) {
+      if (connection_ok && !status.ok()) {
+        connection_ok = WriteChunk(
+            fd, absl::StrCat("{\"error\":", ErrorToJson(status), "}\n"));
+      }
+      connection_ok = connection_ok && WriteAll(fd, "0\r\n\r\n");
+    } else if (status.ok()) {
+      // A stream which sent no message is an empty chunked response.
+      connection_ok =
+          streaming
+              ? WriteAll(fd, absl::StrCat("HTTP/1.1 200 OK\r\n"
+                                          "Content-Type: application/json\r\n"
+                                          "Transfer-Encoding: chunked\r\n"
+                                          "Connection: ",
+                                          keep_alive ? "keep-alive" : "close",
+                                          "\r\n\r\n0\r\n\r\n"))
+              : WriteResponse(fd, "200 OK", response_json, keep_alive);
+    } else {
+      connection_ok = WriteResponse(fd, HttpStatusFromCode(status.code()),
+                                    ErrorToJson(status), keep_alive);
+    }
+    if (!connection_ok || !keep_alive) {
+      return;
+    }
+  }
+}
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,109 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_REST_SERVER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_REST_SERVER_H_
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "frontend/server/environment.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// RestServer serves the Cloud Spanner REST API (HTTP/1.1 with JSON payloads).
+//
+// Requests are mapped to gRPC methods by the google.api.http annotations of
+// the Cloud Spanner service protos, the same mapping that the REST gateway in
+// gateway/ uses (including its overrides for the longrunning operations
+// service, see gateway/operations.yaml). Unlike the gateway, which proxies
+// each request to the gRPC server over a loopback connection, RestServer runs
+// the handlers registered with REGISTER_GRPC_HANDLER in-process.
+//
+// Each connection is served on its own thread and is kept alive between
+// requests unless the client asks to close it. Responses of server streaming
+// methods (e.g. executeStreamingSql) are streamed with chunked transfer
+// encoding as newline-delimited {"result": ...} objects, with a final
+// {"error": ...} object if the method fails after it started streaming.
+class RestServer {
+ public:
+  // Starts a server listening on `address` (host:port) which serves the
+  // requests against `env`. A port of 0 picks a free port, see port().
+  static absl::StatusOr<std::unique_ptr<RestServer>> Create(
+      const std::string& address, ServerEnv* env);
+
+  ~RestServer();
+
+  int port() const { return port_; }
+
+  // Stops accepting connections, closes the open ones once their current
+  // request completes and waits for all serving threads to exit.
+  void Shutdown();
+
+  // A mapping of HTTP requests to a gRPC method, see rest_server.cc.
+  struct Route;
+
+ private:
+  // A client connection and the thread serving it.
+  struct Connection {
+    int fd;
+    std::thread thread;
+    std::atomic<bool> done = false;
+  };
+
+  RestServer(int listen_fd, int port, ServerEnv* env,
+             std::vector<Route> routes);
+
+  // Accepts connections until shut down.
+  void Serve();
+
+  // Serves the requests sent on `fd` until the connection is closed.
+  void HandleConnection(int fd);
+
+  // Joins and closes the connections whose threads have finished.
+  void ReapConnections() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int listen_fd_;
+  const int port_;
+  ServerEnv* const env_;
+  const std::vector<Route> routes_;
+  std::atomic<bool> shutdown_ = false;
+  std::thread thread_;
+
+  // Mutex to guard state below.
+  absl::Mutex mu_;
+
+  // Connections which have not been closed yet.
+  std::list<std::unique_ptr<Connection>> connections_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_REST_SERVER_H_
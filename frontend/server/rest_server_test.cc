@@ -0,0 +1,207 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "frontend/server/rest_server.h"
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "google/protobuf/struct.pb.h"
+#include "google/spanner/v1/result_set.pb.h"
+#include "google/spanner/v1/spanner.pb.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "frontend/server/environment.h"
+#include "frontend/server/handler.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+namespace {
+
+using ::testing::AllOf;
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+using ::testing::StartsWith;
+
+absl::Status GetSession(RequestContext* ctx,
+                        const google::spanner::v1::GetSessionRequest* request,
+                        google::spanner::v1::Session* response) {
+  response->set_name(request->name());
+  return absl::OkStatus();
+}
+REGISTER_GRPC_HANDLER(Spanner, GetSession);
+
+absl::Status Commit(RequestContext* ctx,
+                    const google::spanner::v1::CommitRequest* request,
+                    google::spanner::v1::CommitResponse* response) {
+  return absl::Status(absl::StatusCode::kInvalidArgument, "Bad commit");
+}
+REGISTER_GRPC_HANDLER(Spanner, Commit);
+
+// Streams the SQL text back, once per result.
+absl::Status ExecuteStreamingSql(
+    RequestContext* ctx, const google::spanner::v1::ExecuteSqlRequest* request,
+    ServerStream<google::spanner::v1::PartialResultSet>* stream) {
+  google::spanner::v1::PartialResultSet result;
+  result.add_values()->set_string_value(request->sql());
+  stream->Send(result);
+  stream->Send(result);
+  if (request->sql() == "fail") {
+    return absl::Status(absl::StatusCode::kAborted, "Stream failed");
+  }
+  return absl::OkStatus();
+}
+REGISTER_GRPC_HANDLER(Spanner, ExecuteStreamingSql);
+
+constexpr char kSessionPath[] =
+    "/v1/projects/p/instances/i/databases/d/sessions/s";
+
+// Sends `request` to the server listening on localhost:`port` and returns
+// everything the server sends back until it closes the connection.
+std::string SendRequest(int port, const std::string& request) {
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* addresses = nullptr;
+  if (::getaddrinfo("localhost", absl::StrCat(port).c_str(), &hints,
+                    &addresses) != 0) {
+    return "";
+  }
+  int fd = -1;
+  for (struct addrinfo* ai = addresses; ai != nullptr; ai = ai->ai_next) {
+    fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd >= 0 && ::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+      break;
+    }
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+  ::freeaddrinfo(addresses);
+  if (fd < 0) {
+    return "";
+  }
+  ::send(fd, request.data(), request.size(), 0);
+  std::string response;
+  char buffer[1024];
+  ssize_t read;
+  while ((read = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, read);
+  }
+  ::close(fd);
+  return response;
+}
+
+// Returns a request with the given method, target and JSON body which asks the
+// server to close the connection after responding.
+std::string HttpRequest(const std::string& method, const std::string& target,
+                        const std::string& body = "") {
+  return absl::StrCat(method, " ", target,
+                      " HTTP/1.1\r\nConnection: close\r\nContent-Length: ",
+                      body.size(), "\r\n\r\n", body);
+}
+
+class RestServerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(server_, RestServer::Create("localhost:0", &env_));
+    ASSERT_GT(server_->port(), 0);
+  }
+
+  ServerEnv env_;
+  std::unique_ptr<RestServer> server_;
+};
+
+TEST_F(RestServerTest, ServesUnaryMethodsBoundToPaths) {
+  std::string response =
+      SendRequest(server_->port(), HttpRequest("GET", kSessionPath));
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response,
+              EndsWith(absl::StrCat("{\"name\":\"", kSessionPath + 4, "\"}")));
+}
+
+TEST_F(RestServerTest, ReportsErrorsWithHttpStatus) {
+  std::string response = SendRequest(
+      server_->port(),
+      HttpRequest("POST", absl::StrCat(kSessionPath, ":commit"), "{}"));
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 400 Bad Request\r\n"));
+  EXPECT_THAT(response, HasSubstr("\"message\":\"Bad commit\""));
+}
+
+TEST_F(RestServerTest, RejectsInvalidJson) {
+  EXPECT_THAT(
+      SendRequest(server_->port(),
+                  HttpRequest("POST", absl::StrCat(kSessionPath, ":commit"),
+                              "{\"noSuchField\": 1}")),
+      StartsWith("HTTP/1.1 400 Bad Request\r\n"));
+}
+
+TEST_F(RestServerTest, StreamsResponsesOfStreamingMethods) {
+  std::string response = SendRequest(
+      server_->port(),
+      HttpRequest("POST", absl::StrCat(kSessionPath, ":executeStreamingSql"),
+                  "{\"sql\": \"SELECT 1\"}"));
+  EXPECT_THAT(response,
+              AllOf(StartsWith("HTTP/1.1 200 OK\r\n"),
+                    HasSubstr("Transfer-Encoding: chunked\r\n"),
+                    HasSubstr("{\"result\":{\"values\":[\"SELECT 1\"]}}\n"),
+                    EndsWith("0\r\n\r\n")));
+}
+
+TEST_F(RestServerTest, ReportsStreamErrorsInTheStream) {
+  std::string response = SendRequest(
+      server_->port(),
+      HttpRequest("POST", absl::StrCat(kSessionPath, ":executeStreamingSql"),
+                  "{\"sql\": \"fail\"}"));
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response, HasSubstr("{\"error\":{\"code\":10,"));
+}
+
+TEST_F(RestServerTest, KeepsConnectionsAlive) {
+  std::string response = SendRequest(
+      server_->port(),
+      absl::StrCat("GET ", kSessionPath, " HTTP/1.1\r\n\r\n",
+                   HttpRequest("GET", kSessionPath)));
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response.substr(1), HasSubstr("HTTP/1.1 200 OK\r\n"));
+}
+
+TEST_F(RestServerTest, ReturnsNotFoundForUnknownPaths) {
+  EXPECT_THAT(SendRequest(server_->port(), HttpRequest("GET", "/v1/unknown")),
+              StartsWith("HTTP/1.1 404 Not Found\r\n"));
+}
+
+TEST_F(RestServerTest, ShutsDown) {
+  server_->Shutdown();
+  EXPECT_EQ(SendRequest(server_->port(), HttpRequest("GET", kSessionPath)), "");
+}
+
+}  // namespace
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
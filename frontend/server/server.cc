@@ -17,8 +17,10 @@
 #include "frontend/server/server.h"
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "zetasql/base/logging.h"
 #include "google/iam/v1/iam_policy.pb.h"
@@ -33,14 +35,27 @@
 #include "google/spanner/v1/spanner.grpc.pb.h"
 #include "google/spanner/v1/transaction.pb.h"
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "common/config.h"
 #include "common/constants.h"
 #include "common/errors.h"
 #include "common/limits.h"
+#include "common/metrics.h"
+#include "common/tracing.h"
 #include "frontend/common/status.h"
+#include "frontend/common/uris.h"
+#include "frontend/server/compression.h"
 #include "frontend/server/handler.h"
+#include "frontend/server/metrics_server.h"
 #include "frontend/server/request_context.h"
+#include "frontend/server/rest_server.h"
+#include "grpcpp/resource_quota.h"
 #include "grpcpp/server_builder.h"
 #include "grpcpp/support/status.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
@@ -71,35 +86,122 @@ void MaybeAddTrailingMetadata(const absl::Status& status, RequestContext* ctx) {
   }
 }
 
+// Returns the span context propagated by the client in the W3C traceparent
+// header, if tracing is enabled and the header is valid.
+std::optional<tracing::SpanContext> IncomingSpanContext(
+    const grpc::ServerContext& grpc_ctx) {
+  if (!config::tracing_enabled()) {
+    return std::nullopt;
+  }
+  auto it = grpc_ctx.client_metadata().find("traceparent");
+  if (it == grpc_ctx.client_metadata().end()) {
+    return std::nullopt;
+  }
+  return tracing::ParseTraceparent(
+      absl::string_view(it->second.data(), it->second.size()));
+}
+
+// Creates the instance with the given project and instance ids if it does not
+// exist yet, using the emulator instance config.
+absl::Status EnsureInstanceExists(absl::string_view project_id,
+                                  absl::string_view instance_id,
+                                  ServerEnv* env) {
+  std::string instance_uri = MakeInstanceUri(project_id, instance_id);
+  if (env->instance_manager()->GetInstance(instance_uri).ok()) {
+    return absl::OkStatus();
+  }
+  instance_api::Instance instance;
+  instance.set_config(MakeInstanceConfigUri(project_id, "emulator-config"));
+  instance.set_display_name(std::string(instance_id));
+  instance.set_node_count(1);
+  return env->instance_manager()->CreateInstance(instance_uri, instance)
+      .status();
+}
+
+// Recovers the durable databases stored in the write-ahead log directory of
+// `env`, creating their instances if needed.
+absl::Status RecoverDurableDatabases(ServerEnv* env) {
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<std::string> database_uris,
+                   env->database_manager()->RecoverDurableDatabases());
+  for (const std::string& database_uri : database_uris) {
+    absl::string_view project_id, instance_id, database_id;
+    ZETASQL_RETURN_IF_ERROR(ParseDatabaseUri(database_uri, &project_id, &instance_id,
+                                     &database_id));
+    ZETASQL_RETURN_IF_ERROR(EnsureInstanceExists(project_id, instance_id, env));
+    ABSL_LOG(INFO) << "Recovered durable database " << database_uri;
+  }
+  return absl::OkStatus();
+}
+
+// Restores the databases listed in `database_snapshots` into `env`. Instances
+// which do not exist yet are created with the emulator instance config.
+// Databases which were already recovered from the write-ahead log are kept as
+// they are.
+absl::Status RestoreDatabaseSnapshots(
+    const std::vector<std::string>& database_snapshots, ServerEnv* env) {
+  for (const std::string& spec : database_snapshots) {
+    std::vector<std::string> parts =
+        absl::StrSplit(spec, absl::MaxSplits('=', 1));
+    if (parts.size() != 2 || parts[0].empty() || parts[1].empty()) {
+      return error::InvalidDatabaseSnapshot(
+          spec, "expected <database_uri>=<snapshot_path>");
+    }
+    absl::string_view project_id, instance_id, database_id;
+    ZETASQL_RETURN_IF_ERROR(
+        ParseDatabaseUri(parts[0], &project_id, &instance_id, &database_id));
+    if (env->database_manager()->GetDatabase(parts[0]).ok()) {
+      ABSL_LOG(INFO) << "Not restoring database " << parts[0]
+                     << " which was recovered from the write-ahead log";
+      continue;
+    }
+    ZETASQL_RETURN_IF_ERROR(EnsureInstanceExists(project_id, instance_id, env));
+    ZETASQL_RETURN_IF_ERROR(env->database_manager()
+                        ->RestoreDatabaseFromSnapshot(parts[0], parts[1])
+                        .status());
+    ABSL_LOG(INFO) << "Restored database " << parts[0] << " from " << parts[1];
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 // Invokes the given unary gRPC method on the given service by looking up the
 // handler registry. Returns INTERNAL error if the handler could not be found.
+// The response is compressed as configured by `compression`.
 template <typename RequestT, typename ResponseT>
 absl::Status Invoke(const std::string& service_name,
                     const std::string& method_name,
                     grpc::ServerContext* grpc_ctx, ServerEnv* env,
+                    const CompressionOptions& compression,
                     const RequestT* request, ResponseT* response) {
   GRPCHandlerBase* handler = GetHandler(service_name, method_name);
   if (!handler) {
     return error::Internal(absl::StrCat("Could not find handler for ",
                                         service_name, ".", method_name));
   }
+  tracing::ScopedSpan span(handler->full_method_name(),
+                           IncomingSpanContext(*grpc_ctx));
   RequestContext ctx(env, grpc_ctx);
   absl::Status status =
       dynamic_cast<UnaryGRPCHandler<RequestT, ResponseT>*>(handler)->Run(
           &ctx, request, response);
   MaybeAddTrailingMetadata(status, &ctx);
+  if (status.ok()) {
+    // The response is only sent once the handler returns, so its size is known
+    // before compression has to be decided.
+    MaybeCompressUnaryResponse(compression, response->ByteSizeLong(), grpc_ctx);
+  }
   return status;
 }
 
 // Invokes the given server streaming gRPC method on the given service by
 // looking up the handler registry. Returns INTERNAL error if the handler could
-// not be found.
+// not be found. The responses are compressed as configured by `compression`.
 template <typename RequestT, typename ResponseT>
 absl::Status Invoke(const std::string& service_name,
                     const std::string& method_name,
                     grpc::ServerContext* grpc_ctx, ServerEnv* env,
+                    const CompressionOptions& compression,
                     const RequestT* request,
                     grpc::ServerWriter<ResponseT>* writer) {
   GRPCHandlerBase* handler = GetHandler(service_name, method_name);
@@ -107,6 +209,9 @@ absl::Status Invoke(const std::string& service_name,
     return error::Internal(absl::StrCat("Could not find handler for ",
                                         service_name, ".", method_name));
   }
+  MaybeCompressStreamingResponses(compression, grpc_ctx);
+  tracing::ScopedSpan span(handler->full_method_name(),
+                           IncomingSpanContext(*grpc_ctx));
   RequestContext ctx(env, grpc_ctx);
   absl::Status status =
       dynamic_cast<ServerStreamingGRPCHandler<RequestT, ResponseT>*>(handler)
@@ -119,14 +224,15 @@ absl::Status Invoke(const std::string& service_name,
   grpc::Status MethodName(grpc::ServerContext* grpc_ctx,                       \
                           const RequestType* request, ResponseType* response)  \
       override {                                                               \
-    return ToGRPCStatus(                                                       \
-        Invoke(#ServiceName, #MethodName, grpc_ctx, env_, request, response)); \
+    return ToGRPCStatus(Invoke(#ServiceName, #MethodName, grpc_ctx, env_,      \
+                               *compression_, request, response));             \
   }
 
 // Implementation of the Spanner gRPC service.
 class SpannerService : public spanner_api::Spanner::Service {
  public:
-  explicit SpannerService(ServerEnv* env) : env_(env) {}
+  SpannerService(ServerEnv* env, const CompressionOptions* compression)
+      : env_(env), compression_(compression) {}
 
   // Sessions.
   DEFINE_GRPC_METHOD(Spanner, CreateSession, spanner_api::CreateSessionRequest,
@@ -172,15 +278,19 @@ class SpannerService : public spanner_api::Spanner::Service {
                      spanner_api::CommitResponse);
   DEFINE_GRPC_METHOD(Spanner, Rollback, spanner_api::RollbackRequest,
                      protobuf_api::Empty);
+  DEFINE_GRPC_METHOD(Spanner, BatchWrite, spanner_api::BatchWriteRequest,
+                     grpc::ServerWriter<v1::BatchWriteResponse>);
 
  private:
   ServerEnv* const env_;
+  const CompressionOptions* const compression_;
 };
 
 // Implementation of the DatabaseAdmin gRPC service.
 class DatabaseAdminService : public database_api::DatabaseAdmin::Service {
  public:
-  explicit DatabaseAdminService(ServerEnv* env) : env_(env) {}
+  DatabaseAdminService(ServerEnv* env, const CompressionOptions* compression)
+      : env_(env), compression_(compression) {}
 
   // Databases.
   DEFINE_GRPC_METHOD(DatabaseAdmin, ListDatabases,
@@ -213,12 +323,14 @@ class DatabaseAdminService : public database_api::DatabaseAdmin::Service {
 
  private:
   ServerEnv* const env_;
+  const CompressionOptions* const compression_;
 };
 
 // Implementation of the InstanceAdmin gRPC service.
 class InstanceAdminService : public instance_api::InstanceAdmin::Service {
  public:
-  explicit InstanceAdminService(ServerEnv* env) : env_(env) {}
+  InstanceAdminService(ServerEnv* env, const CompressionOptions* compression)
+      : env_(env), compression_(compression) {}
 
   // Instance configs.
   DEFINE_GRPC_METHOD(InstanceAdmin, ListInstanceConfigs,
@@ -254,12 +366,14 @@ class InstanceAdminService : public instance_api::InstanceAdmin::Service {
 
  private:
   ServerEnv* const env_;
+  const CompressionOptions* const compression_;
 };
 
 // Implementation of the Operations gRPC service.
 class OperationsService : public operations_api::Operations::Service {
  public:
-  explicit OperationsService(ServerEnv* env) : env_(env) {}
+  OperationsService(ServerEnv* env, const CompressionOptions* compression)
+      : env_(env), compression_(compression) {}
 
   DEFINE_GRPC_METHOD(Operations, ListOperations,
                      operations_api::ListOperationsRequest,
@@ -279,19 +393,48 @@ class OperationsService : public operations_api::Operations::Service {
 
  private:
   ServerEnv* const env_;
+  const CompressionOptions* const compression_;
 };
 
-Server::Server(std::unique_ptr<ServerEnv> env)
+Server::Server(std::unique_ptr<ServerEnv> env,
+               const CompressionOptions& compression)
     : env_(std::move(env)),
-      database_admin_service_(new DatabaseAdminService(env_.get())),
-      instance_admin_service_(new InstanceAdminService(env_.get())),
-      operations_service_(new OperationsService(env_.get())),
-      spanner_service_(new SpannerService(env_.get())) {}
+      compression_(compression),
+      database_admin_service_(
+          new DatabaseAdminService(env_.get(), &compression_)),
+      instance_admin_service_(
+          new InstanceAdminService(env_.get(), &compression_)),
+      operations_service_(new OperationsService(env_.get(), &compression_)),
+      spanner_service_(new SpannerService(env_.get(), &compression_)) {}
 
 // Server lifecycle methods.
 std::unique_ptr<Server> Server::Create(const Server::Options& options) {
-  auto env = std::make_unique<ServerEnv>();
-  std::unique_ptr<Server> server = absl::WrapUnique(new Server(std::move(env)));
+  absl::StatusOr<grpc_compression_algorithm> compression_algorithm =
+      ParseCompressionAlgorithm(options.compression);
+  if (!compression_algorithm.ok()) {
+    ABSL_LOG(ERROR) << compression_algorithm.status();
+    return nullptr;
+  }
+  CompressionOptions compression;
+  compression.algorithm = *compression_algorithm;
+  compression.min_unary_response_bytes =
+      options.compression_min_response_bytes;
+
+  auto env = std::make_unique<ServerEnv>(
+      options.wal_dir, options.max_active_requests_per_database,
+      options.max_queued_requests_per_database);
+  absl::Status status = RecoverDurableDatabases(env.get());
+  if (!status.ok()) {
+    ABSL_LOG(ERROR) << "Failed to recover durable databases: " << status;
+    return nullptr;
+  }
+  status = RestoreDatabaseSnapshots(options.database_snapshots, env.get());
+  if (!status.ok()) {
+    ABSL_LOG(ERROR) << "Failed to restore database snapshots: " << status;
+    return nullptr;
+  }
+  std::unique_ptr<Server> server =
+      absl::WrapUnique(new Server(std::move(env), compression));
   ::grpc::ServerBuilder builder;
 
   // Configure server address.
@@ -306,6 +449,38 @@ std::unique_ptr<Server> Server::Create(const Server::Options& options) {
   builder.AddChannelArgument(GRPC_ARG_MAX_RECEIVE_MESSAGE_LENGTH,
                              limits::kMaxGRPCIncomingMessageSize);
 
+  // Configure HTTP/2 flow control for large streamed requests and responses.
+  if (options.http2_stream_window_bytes > 0) {
+    builder.AddChannelArgument(GRPC_ARG_HTTP2_STREAM_LOOKAHEAD_BYTES,
+                               options.http2_stream_window_bytes);
+  }
+  if (options.http2_write_buffer_bytes > 0) {
+    builder.AddChannelArgument(GRPC_ARG_HTTP2_WRITE_BUFFER_SIZE,
+                               options.http2_write_buffer_bytes);
+  }
+
+  // Configure the server thread model.
+  if (options.num_completion_queues > 0) {
+    builder.SetSyncServerOption(
+        ::grpc::ServerBuilder::SyncServerOption::NUM_CQS,
+        options.num_completion_queues);
+  }
+  if (options.min_pollers > 0) {
+    builder.SetSyncServerOption(
+        ::grpc::ServerBuilder::SyncServerOption::MIN_POLLERS,
+        options.min_pollers);
+  }
+  if (options.max_pollers > 0) {
+    builder.SetSyncServerOption(
+        ::grpc::ServerBuilder::SyncServerOption::MAX_POLLERS,
+        options.max_pollers);
+  }
+  if (options.max_threads > 0) {
+    ::grpc::ResourceQuota resource_quota("emulator_server");
+    resource_quota.SetMaxThreads(options.max_threads);
+    builder.SetResourceQuota(resource_quota);
+  }
+
   // Configure services exported on this server.
   builder.RegisterService(server->spanner_service_.get())
       .RegisterService(server->database_admin_service_.get())
@@ -319,12 +494,43 @@ std::unique_ptr<Server> Server::Create(const Server::Options& options) {
     return nullptr;
   }
 
+  if (!options.metrics_address.empty()) {
+    absl::StatusOr<std::unique_ptr<MetricsServer>> metrics_server =
+        MetricsServer::Create(options.metrics_address,
+                              metrics::MetricRegistry::Global());
+    if (!metrics_server.ok()) {
+      ABSL_LOG(ERROR) << "Failed to start metrics server: "
+                      << metrics_server.status();
+      return nullptr;
+    }
+    server->metrics_server_ = std::move(metrics_server).value();
+  }
+
+  if (!options.rest_address.empty()) {
+    absl::StatusOr<std::unique_ptr<RestServer>> rest_server =
+        RestServer::Create(options.rest_address, server->env());
+    if (!rest_server.ok()) {
+      ABSL_LOG(ERROR) << "Failed to start REST server: "
+                      << rest_server.status();
+      return nullptr;
+    }
+    server->rest_server_ = std::move(rest_server).value();
+  }
+
   return server;
 }
 
 void Server::WaitForShutdown() { grpc_server_->Wait(); }
 
-void Server::Shutdown() { grpc_server_->Shutdown(); }
+void Server::Shutdown() {
+  grpc_server_->Shutdown();
+  if (metrics_server_ != nullptr) {
+    metrics_server_->Shutdown();
+  }
+  if (rest_server_ != nullptr) {
+    rest_server_->Shutdown();
+  }
+}
 
 }  // namespace frontend
 }  // namespace emulator
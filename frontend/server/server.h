@@ -17,10 +17,15 @@
 #ifndef STORAGE_SPANNER_CLOUD_EMULATOR_FRONTEND_SERVER_H_
 #define STORAGE_SPANNER_CLOUD_EMULATOR_FRONTEND_SERVER_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "frontend/server/compression.h"
 #include "frontend/server/environment.h"
+#include "frontend/server/metrics_server.h"
+#include "frontend/server/rest_server.h"
 #include "grpcpp/impl/service_type.h"
 #include "grpcpp/server.h"
 #include "grpcpp/support/status.h"
@@ -54,6 +59,49 @@ class Server {
  public:
   struct Options {
     std::string server_address;
+
+    // Databases to restore from snapshot files before serving requests, as
+    // <database_uri>=<snapshot_path> pairs.
+    std::vector<std::string> database_snapshots;
+
+    // Directory in which databases are made durable. Databases found in it are
+    // recovered before serving requests. Empty to keep databases in memory.
+    std::string wal_dir;
+
+    // Limits of the per-database request lanes (see LaneManager). A
+    // `max_active_requests_per_database` of 0 disables the lanes.
+    int max_active_requests_per_database = 0;
+    int max_queued_requests_per_database = 0;
+
+    // Thread model of the gRPC server. Requests are served by the synchronous
+    // gRPC server, which polls `num_completion_queues` completion queues with
+    // between `min_pollers` and `max_pollers` threads each, and runs each
+    // request on a polling thread. At most `max_threads` threads are used in
+    // total. A value of 0 leaves the gRPC default.
+    int num_completion_queues = 0;
+    int min_pollers = 0;
+    int max_pollers = 0;
+    int max_threads = 0;
+
+    // Compression of the responses sent by the gRPC server (see
+    // CompressionOptions): the algorithm name ("none", "gzip" or "deflate")
+    // and the size below which unary responses are sent uncompressed.
+    std::string compression = "none";
+    int64_t compression_min_response_bytes = 0;
+
+    // HTTP/2 tuning of the gRPC server: the initial flow-control window of
+    // each stream and the size of the write buffer, in bytes. A value of 0
+    // leaves the gRPC default.
+    int http2_stream_window_bytes = 0;
+    int http2_write_buffer_bytes = 0;
+
+    // Address (host:port) at which metrics are served over HTTP in the
+    // Prometheus format, at /metrics. Empty to not serve metrics.
+    std::string metrics_address;
+
+    // Address (host:port) at which the REST API is served over HTTP, using the
+    // same handlers as the gRPC server. Empty to not serve REST.
+    std::string rest_address;
   };
 
   // Returns an initialized Server, or nullptr if the initialization failed.
@@ -73,7 +121,7 @@ class Server {
 
  private:
   // Constructor is only used by the factory function
-  explicit Server(std::unique_ptr<ServerEnv> env);
+  Server(std::unique_ptr<ServerEnv> env, const CompressionOptions& compression);
 
   // Address of the gRPC server.
   std::string host_;
@@ -82,6 +130,9 @@ class Server {
   // Environment shared by all handlers.
   std::unique_ptr<ServerEnv> env_;
 
+  // Compression applied to the responses of all services.
+  const CompressionOptions compression_;
+
   // Services implemented by this gRPC server.
   std::unique_ptr<grpc::Service> database_admin_service_;
   std::unique_ptr<grpc::Service> instance_admin_service_;
@@ -90,6 +141,12 @@ class Server {
 
   // Underlying gRPC server.
   std::unique_ptr<grpc::Server> grpc_server_;
+
+  // Server that exports metrics, if enabled.
+  std::unique_ptr<MetricsServer> metrics_server_;
+
+  // Server that exports the REST API, if enabled.
+  std::unique_ptr<RestServer> rest_server_;
 };
 
 }  // namespace frontend
@@ -47,6 +47,7 @@ type Options struct {
 	LogRequests                        bool
 	EnableFaultInjection               bool
 	DisableQueryNullFilteredIndexCheck bool
+	EnableConcurrentReadWriteTxns      bool
 }
 
 // Gateway implements the emulator gateway server.
@@ -74,6 +75,9 @@ func (gw *Gateway) Run() {
 	if gw.opts.DisableQueryNullFilteredIndexCheck {
 		emulatorArgs = append(emulatorArgs, "--disable_query_null_filtered_index_check")
 	}
+	if gw.opts.EnableConcurrentReadWriteTxns {
+		emulatorArgs = append(emulatorArgs, "--enable_concurrent_read_write_transactions")
+	}
 
 	cmd := exec.Command(gw.opts.FrontendBinary, emulatorArgs...)
 
@@ -42,11 +42,12 @@ namespace test {
 
 namespace {
 
+template <typename ResponseT>
 absl::Status ReadFromClientReader(
-    std::unique_ptr<grpc::ClientReader<spanner_api::PartialResultSet>> reader,
-    std::vector<spanner_api::PartialResultSet>* response) {
+    std::unique_ptr<grpc::ClientReader<ResponseT>> reader,
+    std::vector<ResponseT>* response) {
   response->clear();
-  spanner_api::PartialResultSet result;
+  ResponseT result;
   while (reader->Read(&result)) {
     response->push_back(result);
   }
@@ -112,6 +113,14 @@ absl::Status ServerTest::ExecuteStreamingSql(
   return ReadFromClientReader(std::move(client_reader), response);
 }
 
+absl::Status ServerTest::BatchWrite(
+    const spanner_api::BatchWriteRequest& request,
+    std::vector<spanner_api::BatchWriteResponse>* response) {
+  grpc::ClientContext ctx;
+  auto client_reader = test_env()->spanner_client()->BatchWrite(&ctx, request);
+  return ReadFromClientReader(std::move(client_reader), response);
+}
+
 }  // namespace test
 }  // namespace emulator
 }  // namespace spanner
@@ -290,6 +290,13 @@ class ServerTest : public testing::Test {
     return test_env()->spanner_client()->PartitionRead(&ctx, request, response);
   }
 
+  absl::Status PartitionQuery(const spanner_api::PartitionQueryRequest& request,
+                              spanner_api::PartitionResponse* response) {
+    grpc::ClientContext ctx;
+    return test_env()->spanner_client()->PartitionQuery(&ctx, request,
+                                                        response);
+  }
+
   absl::Status ExecuteSql(const spanner_api::ExecuteSqlRequest& request,
                           spanner_api::ResultSet* response) {
     grpc::ClientContext ctx;
@@ -308,6 +315,10 @@ class ServerTest : public testing::Test {
       const spanner_api::ExecuteSqlRequest& request,
       std::vector<spanner_api::PartialResultSet>* response);
 
+  absl::Status BatchWrite(
+      const spanner_api::BatchWriteRequest& request,
+      std::vector<spanner_api::BatchWriteResponse>* response);
+
  private:
   TestEnv test_env_;
 };
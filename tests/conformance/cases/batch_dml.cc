@@ -14,6 +14,9 @@
 // limitations under the License.
 //
 
+#include <cstdint>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
@@ -124,6 +127,55 @@ TEST_F(BatchDmlTest, ConstraintErrorOnBatchDmlReplaysError) {
               StatusIs(absl::StatusCode::kAlreadyExists));
 }
 
+TEST_F(BatchDmlTest, RepeatedInsertsWithParametersSucceed) {
+  auto txn = Transaction(Transaction::ReadWriteOptions());
+
+  // Consecutive inserts are interleaved with a statement which reads them.
+  std::vector<SqlStatement> statements;
+  for (int64_t id = 1; id <= 5; ++id) {
+    statements.push_back(SqlStatement(
+        "INSERT Users(ID, Name, Age) VALUES (@id, 'Levin', @age)",
+        SqlStatement::ParamType{{"id", Value(id)}, {"age", Value(20 + id)}}));
+  }
+  statements.push_back(
+      SqlStatement("UPDATE Users SET Name = 'Mark' WHERE Age > 23"));
+  statements.push_back(SqlStatement(
+      "INSERT Users(ID, Name, Age) VALUES (@id, 'Dan', @age)",
+      SqlStatement::ParamType{{"id", Value(6)}, {"age", Value(30)}}));
+  auto result = BatchDmlTransaction(txn, statements);
+  ZETASQL_ASSERT_OK(ToUtilStatus(result.value().status));
+  ZETASQL_ASSERT_OK(CommitTransaction(txn, {}));
+
+  EXPECT_THAT(Query("SELECT ID, Name, Age FROM Users ORDER BY ID"),
+              IsOkAndHoldsRows({{1, "Levin", 21},
+                                {2, "Levin", 22},
+                                {3, "Levin", 23},
+                                {4, "Mark", 24},
+                                {5, "Mark", 25},
+                                {6, "Dan", 30}}));
+}
+
+TEST_F(BatchDmlTest, DuplicateKeyInRepeatedInsertsFailsBatch) {
+  auto txn = Transaction(Transaction::ReadWriteOptions());
+  auto result = BatchDmlTransaction(
+      txn, {SqlStatement("INSERT Users(ID, Name, Age) VALUES (1, 'Levin', 27)"),
+            SqlStatement("INSERT Users(ID, Name, Age) VALUES (2, 'Mark', 32)"),
+            SqlStatement("INSERT Users(ID, Name, Age) VALUES (1, 'Dan', 31)")});
+  ZETASQL_ASSERT_OK(result);
+  EXPECT_THAT(ToUtilStatus(result.value().status),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+
+  // Only the third statement failed, so the first two have results.
+  ASSERT_EQ(result.value().stats.size(), 2);
+  EXPECT_EQ(result.value().stats[0].row_count, 1);
+  EXPECT_EQ(result.value().stats[1].row_count, 1);
+
+  // The transaction is invalidated by the constraint error.
+  EXPECT_THAT(CommitTransaction(txn, {}),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+  EXPECT_THAT(Query("SELECT ID FROM Users"), IsOkAndHoldsRows({}));
+}
+
 TEST_F(BatchDmlTest, QueryNotAllowedInBatchDml) {
   auto txn = Transaction(Transaction::ReadWriteOptions());
 
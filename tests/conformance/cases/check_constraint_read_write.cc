@@ -116,6 +116,18 @@ TEST_F(CheckConstraintTest, Update) {
               IsOkAndHoldsRow({1, 15, 15, 15, 20}));
 }
 
+TEST_F(CheckConstraintTest, UpdateOfColumnsNotInConstraints) {
+  ZETASQL_ASSERT_OK(Insert("T", {"K", "V", "V_STR"}, {1, 10, "10"}));
+  ZETASQL_ASSERT_OK(Update("T", {"K", "V_STR"}, {1, "5"}));
+  ZETASQL_ASSERT_OK(Update("T", {"K", "V"}, {1, 5}));
+  EXPECT_THAT(Read("T", {"K", "V", "V_STR"}, Key(1)),
+              IsOkAndHoldsRow({1, 5, "5"}));
+  EXPECT_THAT(Update("T", {"K", "V_STR"}, {1, "-1"}),
+              StatusIs(absl::StatusCode::kOutOfRange,
+                       testing::HasSubstr(
+                           "Check constraint `T`.`v_str_gt_zero` is violated")));
+}
+
 TEST_F(CheckConstraintTest, UpdateNull) {
   ZETASQL_ASSERT_OK(Insert("T", {"K", "V"}, {1, 10}));
   ZETASQL_ASSERT_OK(Update("T", {"K", "V"}, {1, Null<std::int64_t>()}));
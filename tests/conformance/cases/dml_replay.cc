@@ -25,6 +25,7 @@
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "tests/common/proto_matchers.h"
 #include "tests/conformance/common/database_test_base.h"
 #include "absl/status/status.h"
@@ -770,6 +771,125 @@ TEST_F(DmlReplayTest, BatchDMLReturnsTransactionInResponse) {
   }
 }
 
+TEST_F(DmlReplayTest, DMLSequenceReplayOfOldRequestsSucceeds) {
+  spanner_api::Transaction txn;
+  ZETASQL_EXPECT_OK(BeginReadWriteTransaction(&txn));
+
+  // Issue more requests than the emulator keeps full replay outcomes for.
+  constexpr int kNumRequests = 40;
+  auto make_request = [&](int seqno) {
+    spanner_api::ExecuteSqlRequest dml_request;
+    dml_request.set_sql(absl::StrCat(
+        "INSERT INTO Users(ID, Name) VALUES(", seqno, ", 'value'), (",
+        seqno + kNumRequests, ", 'value')"));
+    dml_request.set_seqno(seqno);
+    dml_request.mutable_transaction()->set_id(txn.id());
+    dml_request.set_session(session_name_);
+    return dml_request;
+  };
+  for (int seqno = 1; seqno <= kNumRequests; ++seqno) {
+    spanner_api::ResultSet response;
+    grpc::ClientContext context;
+    ZETASQL_EXPECT_OK(
+        raw_client()->ExecuteSql(&context, make_request(seqno), &response));
+  }
+
+  // Replaying the first and the last requests returns their outcome.
+  for (int seqno : {1, kNumRequests}) {
+    spanner_api::ResultSet response;
+    grpc::ClientContext context;
+    ZETASQL_EXPECT_OK(
+        raw_client()->ExecuteSql(&context, make_request(seqno), &response));
+    EXPECT_THAT(response, EqualsProto(R"pb(
+                  metadata { row_type {} }
+                  stats { row_count_exact: 2 }
+                )pb"));
+  }
+}
+
+TEST_F(DmlReplayTest, DMLSequenceReplayOfOldThenReturnRequest) {
+  spanner_api::Transaction txn;
+  ZETASQL_EXPECT_OK(BeginReadWriteTransaction(&txn));
+
+  constexpr int kNumRequests = 40;
+  spanner_api::ExecuteSqlRequest then_return_request = PARSE_TEXT_PROTO(R"(
+    sql: "INSERT INTO Users(ID, Name) VALUES(0, \'value\') THEN RETURN ID"
+    seqno: 1
+  )");
+  then_return_request.mutable_transaction()->set_id(txn.id());
+  then_return_request.set_session(session_name_);
+  {
+    spanner_api::ResultSet response;
+    grpc::ClientContext context;
+    ZETASQL_EXPECT_OK(
+        raw_client()->ExecuteSql(&context, then_return_request, &response));
+  }
+  for (int seqno = 2; seqno <= kNumRequests; ++seqno) {
+    spanner_api::ExecuteSqlRequest dml_request;
+    dml_request.set_sql(
+        absl::StrCat("INSERT INTO Users(ID, Name) VALUES(", seqno, ", 'v')"));
+    dml_request.set_seqno(seqno);
+    dml_request.mutable_transaction()->set_id(txn.id());
+    dml_request.set_session(session_name_);
+    spanner_api::ResultSet response;
+    grpc::ClientContext context;
+    ZETASQL_EXPECT_OK(raw_client()->ExecuteSql(&context, dml_request, &response));
+  }
+
+  // The emulator only keeps the rows returned by the most recent requests.
+  spanner_api::ResultSet response;
+  grpc::ClientContext context;
+  absl::Status status =
+      raw_client()->ExecuteSql(&context, then_return_request, &response);
+  if (in_prod_env()) {
+    ZETASQL_EXPECT_OK(status);
+  } else {
+    EXPECT_THAT(status, StatusIs(absl::StatusCode::kFailedPrecondition));
+  }
+}
+
+TEST_F(DmlReplayTest, DMLSequenceReplayOfOldFailedRequestReturnsItsError) {
+  spanner_api::Transaction txn;
+  ZETASQL_EXPECT_OK(BeginReadWriteTransaction(&txn));
+
+  constexpr int kNumRequests = 40;
+  auto make_request = [&](int seqno, int id) {
+    spanner_api::ExecuteSqlRequest dml_request;
+    dml_request.set_sql(
+        absl::StrCat("INSERT INTO Users(ID, Name) VALUES(", id, ", 'v')"));
+    dml_request.set_seqno(seqno);
+    dml_request.mutable_transaction()->set_id(txn.id());
+    dml_request.set_session(session_name_);
+    return dml_request;
+  };
+  {
+    spanner_api::ResultSet response;
+    grpc::ClientContext context;
+    ZETASQL_EXPECT_OK(raw_client()->ExecuteSql(&context, make_request(1, 0),
+                                       &response));
+  }
+  {
+    // Attempt to insert a value that already exists.
+    spanner_api::ResultSet response;
+    grpc::ClientContext context;
+    EXPECT_THAT(
+        raw_client()->ExecuteSql(&context, make_request(2, 0), &response),
+        StatusIs(absl::StatusCode::kAlreadyExists));
+  }
+  for (int seqno = 3; seqno <= kNumRequests; ++seqno) {
+    spanner_api::ResultSet response;
+    grpc::ClientContext context;
+    ZETASQL_EXPECT_OK(raw_client()->ExecuteSql(&context, make_request(seqno, seqno),
+                                       &response));
+  }
+
+  // The failed request has left the replay window but still returns its error.
+  spanner_api::ResultSet response;
+  grpc::ClientContext context;
+  EXPECT_THAT(raw_client()->ExecuteSql(&context, make_request(2, 0), &response),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+}
+
 }  // namespace
 
 }  // namespace test
@@ -14,13 +14,19 @@
 // limitations under the License.
 //
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "google/spanner/v1/result_set.pb.h"
+#include "google/spanner/v1/spanner.pb.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "tests/conformance/common/database_test_base.h"
 
 namespace google {
@@ -32,6 +38,7 @@ namespace {
 
 constexpr int64_t kNumRows = 20;
 constexpr int64_t kStringSize = 409600;
+constexpr int64_t kNumJoinedRows = 500;
 
 class LargeReadsTest : public DatabaseTest {
  public:
@@ -83,6 +90,84 @@ TEST_F(LargeReadsTest, CanPerformLargeReadWithAllRows) {
   }
 }
 
+class LargeQueryResumeTest : public DatabaseTest {
+ public:
+  absl::Status SetUpDatabase() override {
+    ZETASQL_RETURN_IF_ERROR(SetSchema({R"(
+      CREATE TABLE Numbers(
+        ID    INT64,
+        Grp   INT64,
+        Value FLOAT64,
+      ) PRIMARY KEY (ID)
+    )"}));
+    std::vector<ValueRow> rows;
+    for (int64_t i = 0; i < kNumJoinedRows; ++i) {
+      rows.push_back({i, 0, static_cast<double>(i)});
+    }
+    ZETASQL_RETURN_IF_ERROR(
+        MultiInsert("Numbers", {"ID", "Grp", "Value"}, rows).status());
+
+    // Resume tokens are only visible to raw clients, the C++ client library
+    // resumes streams on its own.
+    grpc::ClientContext context;
+    spanner_api::CreateSessionRequest request;
+    request.set_database(database()->FullName());
+    spanner_api::Session response;
+    ZETASQL_RETURN_IF_ERROR(raw_client()->CreateSession(&context, request, &response));
+    session_name_ = response.name();
+    return absl::OkStatus();
+  }
+
+ protected:
+  // Returns the values of the responses to `request` and sets `responses`.
+  absl::StatusOr<std::vector<double>> ExecuteStreamingSql(
+      const spanner_api::ExecuteSqlRequest& request,
+      std::vector<spanner_api::PartialResultSet>* responses) {
+    grpc::ClientContext context;
+    std::unique_ptr<grpc::ClientReader<spanner_api::PartialResultSet>> reader =
+        raw_client()->ExecuteStreamingSql(&context, request);
+    responses->clear();
+    std::vector<double> values;
+    spanner_api::PartialResultSet response;
+    while (reader->Read(&response)) {
+      for (const auto& value : response.values()) {
+        values.push_back(value.number_value());
+      }
+      responses->push_back(response);
+    }
+    ZETASQL_RETURN_IF_ERROR(reader->Finish());
+    return values;
+  }
+
+  std::string session_name_;
+};
+
+TEST_F(LargeQueryResumeTest, ResumesUnorderedJoinFromResumeToken) {
+  // Every row joins with every row, so the result spans several responses.
+  // Its only column is a FLOAT64, which is never chunked, so each response
+  // ends on a row boundary and carries a resume token.
+  spanner_api::ExecuteSqlRequest request;
+  request.set_session(session_name_);
+  request.set_sql(
+      "SELECT a.Value FROM Numbers a JOIN Numbers b ON a.Grp = b.Grp");
+  std::vector<spanner_api::PartialResultSet> responses;
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<double> values,
+                       ExecuteStreamingSql(request, &responses));
+  ASSERT_EQ(values.size(), kNumJoinedRows * kNumJoinedRows);
+  ASSERT_GT(responses.size(), 1);
+  ASSERT_FALSE(responses[0].resume_token().empty());
+
+  // The query does not order its rows, yet executing it again for the resumed
+  // request returns the rows following the token in the same order.
+  const int num_skipped_values = responses[0].values_size();
+  request.set_resume_token(responses[0].resume_token());
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<double> resumed_values,
+                       ExecuteStreamingSql(request, &responses));
+  EXPECT_THAT(resumed_values,
+              testing::ElementsAreArray(values.begin() + num_skipped_values,
+                                        values.end()));
+}
+
 }  // namespace
 
 }  // namespace test
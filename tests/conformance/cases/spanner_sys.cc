@@ -14,12 +14,16 @@
 // limitations under the License.
 //
 
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "tests/conformance/common/database_test_base.h"
 
 namespace google {
@@ -43,6 +47,120 @@ TEST_F(SpannerSysTest, SupportedOptimizerVersionsTableIsValid) {
   EXPECT_THAT(results, IsOkAndHoldsRow({true, "2023-09-19", 42}));
 }
 
+class TableSizesTest : public DatabaseTest {
+  absl::Status SetUpDatabase() override {
+    return SetSchema({R"(
+        CREATE TABLE Users(
+          ID INT64 NOT NULL,
+          Name STRING(MAX),
+        ) PRIMARY KEY (ID)
+      )",
+                      "CREATE INDEX UsersByName ON Users(Name)",
+                      R"(
+        CREATE TABLE Empty(
+          ID INT64 NOT NULL,
+        ) PRIMARY KEY (ID)
+      )"});
+  }
+};
+
+TEST_F(TableSizesTest, ReportsTheSizesOfTablesAndIndexes) {
+  // Table sizes are only refreshed periodically in production.
+  if (in_prod_env()) GTEST_SKIP();
+
+  ZETASQL_ASSERT_OK(MultiInsert("Users", {"ID", "Name"},
+                        {{1, "Alice"}, {2, "Bob"}, {3, "Carol"}}));
+
+  EXPECT_THAT(Query(R"(
+      SELECT table_name, used_bytes > 0
+      FROM spanner_sys.TABLE_SIZES_STATS_1HOUR
+      ORDER BY table_name
+    )"),
+              IsOkAndHoldsRows({{"Empty", false},
+                                {"Users", true},
+                                {"UsersByName", true}}));
+}
+
+TEST_F(TableSizesTest, ReportsTheCurrentSizes) {
+  if (in_prod_env()) GTEST_SKIP();
+
+  std::string query = R"(
+      SELECT used_bytes
+      FROM spanner_sys.TABLE_SIZES_STATS_1HOUR
+      WHERE table_name = 'Users'
+    )";
+  ZETASQL_ASSERT_OK(Insert("Users", {"ID", "Name"}, {1, "Alice"}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<ValueRow> before, Query(query));
+  ZETASQL_ASSERT_OK(Insert("Users", {"ID", "Name"}, {2, "Bob"}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<ValueRow> after, Query(query));
+
+  ASSERT_EQ(before.size(), 1);
+  EXPECT_NE(before, after);
+}
+
+class OperationStatsTest : public DatabaseTest {
+  absl::Status SetUpDatabase() override {
+    return SetSchema({R"(
+        CREATE TABLE Users(
+          ID INT64 NOT NULL,
+          Name STRING(MAX),
+        ) PRIMARY KEY (ID)
+      )"});
+  }
+};
+
+TEST_F(OperationStatsTest, ReportsExecutedQueries) {
+  // Statistics are only reported for completed intervals in production.
+  if (in_prod_env()) GTEST_SKIP();
+
+  ZETASQL_ASSERT_OK(Insert("Users", {"ID", "Name"}, {1, "Alice"}));
+  std::string query = "SELECT Name FROM Users WHERE ID = 1";
+  ZETASQL_ASSERT_OK(Query(query));
+  ZETASQL_ASSERT_OK(Query(query));
+
+  // The executions may fall into two intervals.
+  EXPECT_THAT(Query(absl::StrCat(R"(
+      SELECT SUM(execution_count), SUM(all_failed_execution_count),
+             MAX(avg_rows) = 1
+      FROM spanner_sys.QUERY_STATS_TOP_MINUTE
+      WHERE text = ')",
+                                 query, "'")),
+              IsOkAndHoldsRow({2, 0, true}));
+}
+
+TEST_F(OperationStatsTest, ReportsCommittedTransactions) {
+  if (in_prod_env()) GTEST_SKIP();
+
+  ZETASQL_ASSERT_OK(Insert("Users", {"ID", "Name"}, {1, "Alice"}));
+  ZETASQL_ASSERT_OK(Delete("Users", {Key(1)}));
+
+  EXPECT_THAT(Query(R"(
+      SELECT SUM(commit_attempt_count) > 0
+      FROM spanner_sys.TXN_STATS_TOP_MINUTE
+      WHERE 'Users.Name' IN UNNEST(write_constructive_columns)
+    )"),
+              IsOkAndHoldsRow({true}));
+  EXPECT_THAT(Query(R"(
+      SELECT SUM(commit_attempt_count) > 0
+      FROM spanner_sys.TXN_STATS_TOP_MINUTE
+      WHERE 'Users' IN UNNEST(write_delete_tables)
+    )"),
+              IsOkAndHoldsRow({true}));
+}
+
+TEST_F(OperationStatsTest, LockStatsCanBeQueried) {
+  if (in_prod_env()) GTEST_SKIP();
+
+  ZETASQL_ASSERT_OK(Insert("Users", {"ID", "Name"}, {1, "Alice"}));
+
+  // Transactions which do not conflict are not reported.
+  EXPECT_THAT(Query(R"(
+      SELECT COUNT(*)
+      FROM spanner_sys.LOCK_STATS_TOP_MINUTE
+    )"),
+              IsOkAndHoldsRow({0}));
+}
+
 }  // namespace
 
 }  // namespace test
@@ -17,16 +17,19 @@
 #include "tests/conformance/common/database_test_base.h"
 
 #include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "google/cloud/spanner/admin/database_admin_client.h"
 #include "google/cloud/spanner/backoff_policy.h"
 #include "google/cloud/spanner/batch_dml_result.h"
@@ -47,6 +50,22 @@ namespace spanner {
 namespace emulator {
 namespace test {
 
+namespace {
+
+// Returns a database id which is unique across tests, threads and processes, so
+// that concurrently running shards can share a single emulator instance. The
+// id is 30 characters long, the maximum allowed for a database id.
+std::string NewDatabaseId() {
+  static absl::Mutex mu(absl::kConstInit);
+  static absl::BitGen* bitgen = new absl::BitGen();
+  absl::MutexLock lock(&mu);
+  return absl::StrCat("test-database-",
+                      absl::Hex(absl::Uniform<uint64_t>(*bitgen),
+                                absl::kZeroPad16));
+}
+
+}  // namespace
+
 void DatabaseTest::SetUp() {
   // Get the global environment in which the test runs.
   const ConformanceTestGlobals& globals = GetConformanceTestGlobals();
@@ -68,7 +87,7 @@ void DatabaseTest::SetUp() {
   // Pick a unique database name for every test (reuse the instance).
   database_ = std::make_unique<google::cloud::spanner::Database>(
       google::cloud::spanner::Instance(globals.project_id, globals.instance_id),
-      absl::StrCat("test-database-", absl::ToUnixMicros(absl::Now())));
+      NewDatabaseId());
 
   // Setup the database client.
   auto connection_options = *globals.connection_options;
@@ -121,7 +140,7 @@ absl::Status DatabaseTest::ResetDatabase() {
       ToUtilStatus(database_client_->DropDatabase(database_->FullName())));
   database_ = std::make_unique<google::cloud::spanner::Database>(
       google::cloud::spanner::Instance(globals.project_id, globals.instance_id),
-      absl::StrCat("test-database-", absl::ToUnixMicros(absl::Now())));
+      NewDatabaseId());
   google::spanner::admin::database::v1::CreateDatabaseRequest request;
   request.set_parent(database_->instance().FullName());
   std::string quote = kGSQLQuote;
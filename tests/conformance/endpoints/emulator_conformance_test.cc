@@ -14,7 +14,9 @@
 // limitations under the License.
 //
 
+#include <cstdlib>
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "zetasql/base/logging.h"
@@ -22,6 +24,7 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
+#include "absl/status/status.h"
 #include "google/cloud/common_options.h"
 #include "google/cloud/grpc_options.h"
 #include "google/cloud/spanner/admin/instance_admin_client.h"
@@ -50,6 +53,12 @@ constexpr char kInstanceConfigName[] = "test-config";
 }  // namespace
 
 // Environment for emulator conformance tests.
+//
+// By default every test binary starts its own in-process emulator server. When
+// SPANNER_EMULATOR_HOST is set the tests instead target that (shared) emulator,
+// which lets several shards run concurrently against a single emulator process.
+// Every test already creates its own database, so shards only share the
+// instance.
 class EmulatorConformanceTestEnvironment : public testing::Environment {
  public:
   EmulatorConformanceTestEnvironment()
@@ -62,34 +71,46 @@ class EmulatorConformanceTestEnvironment : public testing::Environment {
             .enable_batch_query_with_no_table_scan = true,
         }) {}
   void SetUp() override {
-    // Setup emulator server.
-    frontend::Server::Options options;
-    options.server_address = "localhost:0";
-    server_ = frontend::Server::Create(options);
-    ASSERT_NE(server_, nullptr);
+    // Setup emulator server, unless the tests target a shared one.
+    std::string endpoint;
+    const char* emulator_host = std::getenv("SPANNER_EMULATOR_HOST");
+    if (emulator_host != nullptr && *emulator_host != '\0') {
+      endpoint = emulator_host;
+    } else {
+      frontend::Server::Options options;
+      options.server_address = "localhost:0";
+      server_ = frontend::Server::Create(options);
+      ASSERT_NE(server_, nullptr);
+      endpoint = absl::StrCat(server_->host(), ":", server_->port());
+    }
 
     // Initialize connection options required by the client library.
     auto connection_options = std::make_unique<google::cloud::Options>();
     connection_options->set<google::cloud::GrpcCredentialOption>(
         grpc::InsecureChannelCredentials());
-    connection_options->set<google::cloud::EndpointOption>(
-        absl::StrCat(server_->host(), ":", server_->port()));
+    connection_options->set<google::cloud::EndpointOption>(endpoint);
 
-    // Setup an instance which will be reused for all tests.
+    // Setup an instance which will be reused for all tests. On a shared
+    // emulator another shard may have created it already.
     google::cloud::spanner::Instance instance(kProjectName, kInstanceName);
     auto instance_client =
         std::make_unique<google::cloud::spanner_admin::InstanceAdminClient>(
             google::cloud::spanner_admin::MakeInstanceAdminConnection(
                 *connection_options));
-    ZETASQL_ASSERT_OK(google::spanner::emulator::test::ToUtilStatusOr(
-        instance_client
-            ->CreateInstance(
-                google::cloud::spanner::CreateInstanceRequestBuilder(
-                    instance, kInstanceConfigName)
-                    .SetDisplayName(kInstanceConfigName)
-                    .SetNodeCount(1)
-                    .Build())
-            .get()));
+    absl::Status status =
+        google::spanner::emulator::test::ToUtilStatusOr(
+            instance_client
+                ->CreateInstance(
+                    google::cloud::spanner::CreateInstanceRequestBuilder(
+                        instance, kInstanceConfigName)
+                        .SetDisplayName(kInstanceConfigName)
+                        .SetNodeCount(1)
+                        .Build())
+                .get())
+            .status();
+    if (!absl::IsAlreadyExists(status)) {
+      ZETASQL_ASSERT_OK(status);
+    }
 
     // Set globals for the test.
     globals_ = std::make_unique<ConformanceTestGlobals>();
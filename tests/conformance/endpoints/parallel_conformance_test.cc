@@ -0,0 +1,164 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+// Runs the emulator conformance tests as concurrent shards against a single
+// shared emulator server.
+//
+// Every shard is a separate emulator_conformance_test process which selects its
+// subset of tests through the standard gtest sharding variables and reaches the
+// shared server through SPANNER_EMULATOR_HOST. Since every conformance test
+// creates its own database, the shards only share the emulator's global state
+// (the database and session managers, the sequence and transaction locks, ...)
+// which makes this both a faster way to run the suite and a throughput check of
+// that global state under concurrent load:
+//
+//   bazel test -c opt //tests/conformance/endpoints:parallel_conformance_test \
+//     --test_arg=--num_parallel_shards=16 --test_output=streamed
+
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/flags/flag.h"
+#include "absl/log/absl_log.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "frontend/server/server.h"
+#include "tests/common/scoped_feature_flags_setter.h"
+#include "tools/cpp/runfiles/runfiles.h"
+
+extern char** environ;
+
+ABSL_FLAG(int, num_parallel_shards, 8,
+          "Number of conformance test shards run concurrently against the "
+          "shared emulator.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace test {
+
+namespace {
+
+constexpr char kConformanceTestPath[] =
+    "com_google_cloud_spanner_emulator/tests/conformance/endpoints/"
+    "emulator_conformance_test";
+
+// Environment variables which must not be inherited by the shards, either
+// because they are set per shard below or because they name output files that
+// the shards would otherwise all write concurrently.
+bool IsOverriddenByShard(const std::string& variable) {
+  for (const char* prefix :
+       {"SPANNER_EMULATOR_HOST=", "GTEST_TOTAL_SHARDS=", "GTEST_SHARD_INDEX=",
+        "GTEST_SHARD_STATUS_FILE=", "GTEST_OUTPUT=", "XML_OUTPUT_FILE="}) {
+    if (absl::StartsWith(variable, prefix)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Spawns shard `index` of `num_shards` of the conformance test binary at
+// `path`, targeting the emulator at `endpoint`.
+pid_t SpawnShard(const std::string& path, const std::string& endpoint,
+                 int index, int num_shards) {
+  std::vector<std::string> env;
+  for (char** variable = environ; *variable != nullptr; ++variable) {
+    if (!IsOverriddenByShard(*variable)) {
+      env.push_back(*variable);
+    }
+  }
+  env.push_back(absl::StrCat("SPANNER_EMULATOR_HOST=", endpoint));
+  env.push_back(absl::StrCat("GTEST_TOTAL_SHARDS=", num_shards));
+  env.push_back(absl::StrCat("GTEST_SHARD_INDEX=", index));
+
+  std::vector<char*> envp;
+  for (std::string& variable : env) {
+    envp.push_back(variable.data());
+  }
+  envp.push_back(nullptr);
+  std::string arg0 = path;
+  char* argv[] = {arg0.data(), nullptr};
+
+  pid_t pid;
+  if (posix_spawn(&pid, path.c_str(), nullptr, nullptr, argv, envp.data()) !=
+      0) {
+    return -1;
+  }
+  return pid;
+}
+
+TEST(ParallelConformanceTest, AllShardsPassAgainstSharedEmulator) {
+  // The shards' own feature flag settings only apply to their (unused)
+  // in-process servers, so the shared server needs the same settings as
+  // emulator_conformance_test.
+  ScopedEmulatorFeatureFlagsSetter feature_flags({
+      .enable_check_constraint = true,
+      .enable_column_default_values = true,
+      .enable_views = true,
+      .enable_generated_pk = true,
+      .enable_fk_delete_cascade_action = true,
+      .enable_batch_query_with_no_table_scan = true,
+  });
+
+  frontend::Server::Options options;
+  options.server_address = "localhost:0";
+  std::unique_ptr<frontend::Server> server = frontend::Server::Create(options);
+  ASSERT_NE(server, nullptr);
+  const std::string endpoint =
+      absl::StrCat(server->host(), ":", server->port());
+
+  std::string error;
+  std::unique_ptr<bazel::tools::cpp::runfiles::Runfiles> runfiles(
+      bazel::tools::cpp::runfiles::Runfiles::CreateForTest(&error));
+  ASSERT_NE(runfiles, nullptr) << error;
+  const std::string path = runfiles->Rlocation(kConformanceTestPath);
+
+  const int num_shards = absl::GetFlag(FLAGS_num_parallel_shards);
+  ASSERT_GT(num_shards, 0);
+  const absl::Time start = absl::Now();
+  std::vector<pid_t> pids;
+  for (int i = 0; i < num_shards; ++i) {
+    pid_t pid = SpawnShard(path, endpoint, i, num_shards);
+    ASSERT_GT(pid, 0) << "Failed to spawn " << path;
+    pids.push_back(pid);
+  }
+
+  for (int i = 0; i < num_shards; ++i) {
+    int status = 0;
+    ASSERT_EQ(waitpid(pids[i], &status, 0), pids[i]);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        << "Conformance test shard " << i << " failed";
+  }
+  ABSL_LOG(INFO) << num_shards << " conformance test shards finished in "
+                 << absl::Now() - start << " against a shared emulator.";
+}
+
+}  // namespace
+
+}  // namespace test
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -42,6 +42,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "third_party/spanner_pg/bootstrap_catalog/bootstrap_catalog_info.h"
 #include "third_party/spanner_pg/bootstrap_catalog/bootstrap_catalog_textproto.h"
@@ -63,14 +64,17 @@ PgBootstrapCatalog::PgBootstrapCatalog(
     absl::Span<const FormData_pg_namespace> pg_namespace_data,
     absl::Span<const FormData_pg_type> pg_type_data,
     absl::Span<const FormData_pg_proc_WithArgTypes> pg_proc_data,
-    std::vector<std::string> pg_proc_textproto_data,
+    absl::Span<const std::string> pg_proc_textproto_data,
     absl::Span<const FormData_pg_cast> pg_cast_data,
     absl::Span<const FormData_pg_operator> pg_operator_data,
     absl::Span<const FormData_pg_aggregate> pg_aggregate_data,
     absl::Span<const FormData_pg_opclass> pg_opclass_data,
     absl::Span<const FormData_pg_am> pg_am_data,
     absl::Span<const FormData_pg_amop> pg_amop_data,
-    absl::Span<const FormData_pg_amproc> pg_amproc_data) {
+    absl::Span<const FormData_pg_amproc> pg_amproc_data)
+    : pg_proc_data_(pg_proc_data),
+      pg_proc_textproto_data_(pg_proc_textproto_data) {
+  ABSL_CHECK_EQ(pg_proc_data.size(), pg_proc_textproto_data.size());
   collation_by_name_.reserve(pg_collation_data.size());
   for (const FormData_pg_collation& data : pg_collation_data) {
     collation_by_name_[NameStr(data.collname)] = &data;
@@ -90,35 +94,7 @@ PgBootstrapCatalog::PgBootstrapCatalog(
     type_by_name_[NameStr(data.typname)].push_back(&data);
   }
 
-  // Parse the textproto data into protos. Using an index loop so we can get
-  // the pg_proc struct for a more useful error message.
-  absl::flat_hash_map<Oid, PgProcData> raw_proc_proto_by_oid;
-  raw_proc_proto_by_oid.reserve(pg_proc_textproto_data.size());
-  for (int i = 0; i < pg_proc_data.size(); ++i) {
-    const FormData_pg_proc_WithArgTypes& data = pg_proc_data[i];
-    const std::string& textproto = pg_proc_textproto_data[i];
-    PgProcData proto;
-
-    if (!google::protobuf::TextFormat::ParseFromString(textproto, &proto)) {
-      ABSL_LOG(FATAL)
-          << "Failed to parse PgProcData proto for " << data.data.proname.data
-          << "(" << data.data.oid << ")";
-    }
-    // Catch any protos that have fewer proargnames than pronargs which would
-    // indicate an issue related to the Perl script textproto generation.
-    // A proc can have more proargnames than pronargs if the proc has output
-    // arguments.
-    if (proto.proargnames_size() &&
-        proto.proargnames_size() < proto.pronargs()) {
-      ABSL_LOG(FATAL)
-          << "PgProcData proto for " << proto.proname() << "(" << proto.oid()
-          << ") has " << proto.proargnames_size() << " proargnames but "
-          << "pronargs is " << proto.pronargs();
-    }
-    raw_proc_proto_by_oid[proto.oid()] = proto;
-  }
-
-  proc_proto_by_oid_.reserve(pg_proc_textproto_data.size());
+  proc_index_by_oid_.reserve(pg_proc_data.size());
   proc_by_oid_.reserve(pg_proc_data.size());
   // This proc_by_name_ resize is slightly larger than necessary since
   // there are duplicate names, but duplicate names are <10% of all entries.
@@ -132,13 +108,11 @@ PgBootstrapCatalog::PgBootstrapCatalog(
     // Get the updated (as needed) proc data.
     const FormData_pg_proc_WithArgTypes* final_proc_data =
         GetFinalProcFormData(data);
-    std::unique_ptr<PgProcData> proto = GetFinalProcProto(
-        raw_proc_proto_by_oid[data.data.oid]);
 
     proc_by_oid_[final_proc_data->data.oid] = &final_proc_data->data;
     proc_by_name_[NameStr(final_proc_data->data.proname)].push_back(
         &final_proc_data->data);
-    proc_proto_by_oid_.insert({proto->oid(), std::move(proto)});
+    proc_index_by_oid_[final_proc_data->data.oid] = i;
   }
 
   cast_by_castkey_.reserve(pg_cast_data.size());
@@ -320,12 +294,18 @@ absl::StatusOr<const FormData_pg_proc*> PgBootstrapCatalog::GetProc(
 
 absl::StatusOr<const PgProcData*> PgBootstrapCatalog::GetProcProto(
     Oid oid) const {
-  auto it = proc_proto_by_oid_.find(oid);
-  if (it == proc_proto_by_oid_.end()) {
+  auto it = proc_index_by_oid_.find(oid);
+  if (it == proc_index_by_oid_.end()) {
     return absl::NotFoundError(
         absl::StrCat("Procedure with oid ", oid, " not found"));
   }
-  return it->second.get();
+  absl::MutexLock lock(&proc_proto_mu_);
+  std::unique_ptr<PgProcData>& proto = proc_proto_by_oid_[oid];
+  if (proto == nullptr) {
+    proto = ParseFinalProcProto(pg_proc_data_[it->second],
+                                pg_proc_textproto_data_[it->second]);
+  }
+  return proto.get();
 }
 
 absl::StatusOr<const char*> PgBootstrapCatalog::GetProcName(Oid oid) const {
@@ -634,21 +614,39 @@ const FormData_pg_proc_WithArgTypes* PgBootstrapCatalog::GetFinalProcFormData(
   return updated_proc_by_oid_.find(original_proc.data.oid)->second.get();
 }
 
-std::unique_ptr<PgProcData> PgBootstrapCatalog::GetFinalProcProto(
-    PgProcData& proto) {
-    if (!updated_proc_by_oid_.contains(proto.oid())) {
-        return std::make_unique<PgProcData>(proto);
-    }
-    const PgProcSignature* signature =
-        GetUpdatedProcSignature(proto);
-    ABSL_CHECK(signature != nullptr);  // Should never happen.
-    proto.clear_prorettype();
-    proto.set_prorettype(signature->return_type);
-    proto.clear_proargtypes();
-    for (Oid arg_type : signature->arg_types) {
-        proto.add_proargtypes(arg_type);
-    }
-    return std::make_unique<PgProcData>(proto);
+std::unique_ptr<PgProcData> PgBootstrapCatalog::ParseFinalProcProto(
+    const FormData_pg_proc_WithArgTypes& data,
+    const std::string& textproto) const {
+  auto proto = std::make_unique<PgProcData>();
+  if (!google::protobuf::TextFormat::ParseFromString(textproto, proto.get())) {
+    ABSL_LOG(FATAL)
+        << "Failed to parse PgProcData proto for " << data.data.proname.data
+        << "(" << data.data.oid << ")";
+  }
+  // Catch any protos that have fewer proargnames than pronargs which would
+  // indicate an issue related to the Perl script textproto generation.
+  // A proc can have more proargnames than pronargs if the proc has output
+  // arguments.
+  if (proto->proargnames_size() &&
+      proto->proargnames_size() < proto->pronargs()) {
+    ABSL_LOG(FATAL)
+        << "PgProcData proto for " << proto->proname() << "(" << proto->oid()
+        << ") has " << proto->proargnames_size() << " proargnames but "
+        << "pronargs is " << proto->pronargs();
+  }
+
+  if (!updated_proc_by_oid_.contains(proto->oid())) {
+    return proto;
+  }
+  const PgProcSignature* signature = GetUpdatedProcSignature(*proto);
+  ABSL_CHECK(signature != nullptr);  // Should never happen.
+  proto->clear_prorettype();
+  proto->set_prorettype(signature->return_type);
+  proto->clear_proargtypes();
+  for (Oid arg_type : signature->arg_types) {
+    proto->add_proargtypes(arg_type);
+  }
+  return proto;
 }
 
 // Get a raw pointer to the FormData_pg_operator to store in the
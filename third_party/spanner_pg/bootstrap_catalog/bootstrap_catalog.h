@@ -36,9 +36,11 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "third_party/spanner_pg/bootstrap_catalog/bootstrap_catalog_info.h"
 #include "third_party/spanner_pg/interface/bootstrap_catalog_data.pb.h"
@@ -55,13 +57,14 @@ namespace postgres_translator {
 //   Oid int4oid = PgBootstrapCatalog::Default()->GetTypeOid("int4");
 class PgBootstrapCatalog {
  public:
-  // Constructs a bootstrap catalog from arrays of raw catalog data
+  // Constructs a bootstrap catalog from arrays of raw catalog data. The catalog
+  // keeps pointers into the arrays, so they must outlive it.
   PgBootstrapCatalog(
       absl::Span<const FormData_pg_collation> pg_collation_data,
       absl::Span<const FormData_pg_namespace> pg_namespace_data,
       absl::Span<const FormData_pg_type> pg_type_data,
       absl::Span<const FormData_pg_proc_WithArgTypes> pg_proc_data,
-      std::vector<std::string> pg_proc_textproto_data,
+      absl::Span<const std::string> pg_proc_textproto_data,
       absl::Span<const FormData_pg_cast> pg_cast_data,
       absl::Span<const FormData_pg_operator> pg_operator_data,
       absl::Span<const FormData_pg_aggregate> pg_aggregate_data,
@@ -112,7 +115,8 @@ class PgBootstrapCatalog {
   // Given an oid, returns the corresponding pg_proc.
   absl::StatusOr<const FormData_pg_proc*> GetProc(Oid oid) const;
 
-  // Given an oid, returns the corresponding pg_proc proto.
+  // Given an oid, returns the corresponding pg_proc proto. The proto is parsed
+  // from its textproto on first access and cached for the catalog's lifetime.
   absl::StatusOr<const PgProcData*> GetProcProto(Oid oid) const;
 
   // Given an oid, returns the corresponding proc name.
@@ -278,11 +282,12 @@ class PgBootstrapCatalog {
   const FormData_pg_proc_WithArgTypes* GetFinalProcFormData(
       const FormData_pg_proc_WithArgTypes& original_proc);
 
-  // Given a proc, return the final version of it. If the proc is unmodified,
-  // return its raw pointer. If it's deleted, return a nullptr. If it is
-  // modified, use `UpdateProc` to create a modified copy and return a raw
-  // pointer to the modified copy.
-  std::unique_ptr<PgProcData> GetFinalProcProto(PgProcData& proto);
+  // Parses the textproto for `data` and returns the final version of the
+  // proto, with the signature of modified procs updated to match
+  // `updated_proc_by_oid_`. Crashes if the generated textproto is malformed.
+  std::unique_ptr<PgProcData> ParseFinalProcProto(
+      const FormData_pg_proc_WithArgTypes& data,
+      const std::string& textproto) const;
 
   // Given an operator, return the final version of it. If the underlying proc
   // is unmodified, return the raw pointer of the original operator. If the
@@ -322,7 +327,16 @@ class PgBootstrapCatalog {
   absl::flat_hash_map<AmprocFamilyKey, std::vector<const FormData_pg_amproc*>>
       amprocs_by_partial_familykey_;
 
-  absl::flat_hash_map<Oid, std::unique_ptr<PgProcData>> proc_proto_by_oid_;
+  // Index of each retained proc in `pg_proc_data_` and
+  // `pg_proc_textproto_data_`. Parsing every textproto up front dominated
+  // catalog construction, so protos are parsed on demand by GetProcProto.
+  absl::Span<const FormData_pg_proc_WithArgTypes> pg_proc_data_;
+  absl::Span<const std::string> pg_proc_textproto_data_;
+  absl::flat_hash_map<Oid, int> proc_index_by_oid_;
+
+  mutable absl::Mutex proc_proto_mu_;
+  mutable absl::flat_hash_map<Oid, std::unique_ptr<PgProcData>>
+      proc_proto_by_oid_ ABSL_GUARDED_BY(proc_proto_mu_);
 
   // The updated FormData_pg_proc_WithArgTypes and FormData_pg_operator
   // objects are owned by the bootstrap catalog.
@@ -193,6 +193,15 @@ TEST(BootstrapCatalog, GetProcProtoInt8Sum) {
   }
 }
 
+TEST(BootstrapCatalog, GetProcProtoReturnsSameProtoOnRepeatedLookups) {
+  const Oid sum_oid = 1842;
+  ZETASQL_ASSERT_OK_AND_ASSIGN(const PgProcData* first,
+                       PgBootstrapCatalog::Default()->GetProcProto(sum_oid));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(const PgProcData* second,
+                       PgBootstrapCatalog::Default()->GetProcProto(sum_oid));
+  EXPECT_EQ(first, second);
+}
+
 TEST(BootstrapCatalog, GetProcOidInt8Sum) {
   ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<Oid> int8_sum_oid, GetProcOids("int8_sum"));
   EXPECT_THAT(int8_sum_oid, ElementsAre(1842));
@@ -32,6 +32,9 @@
 #include "third_party/spanner_pg/catalog/catalog_adapter.h"
 
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "zetasql/public/analyzer_options.h"
 #include "absl/container/flat_hash_map.h"
@@ -208,6 +211,36 @@ absl::StatusOr<const FormData_pg_proc*> CatalogAdapter::GetUDFProcFromOid(
   return iter->second;
 }
 
+absl::StatusOr<const zetasql::Table*> CatalogAdapter::GetTableFromOid(
+    Oid oid) {
+  auto iter = oid_to_table_cache_.find(oid);
+  if (iter != oid_to_table_cache_.end()) {
+    return iter->second;
+  }
+  ZETASQL_ASSIGN_OR_RETURN(TableName table_name, GetTableNameFromOid(oid));
+  const zetasql::Table* table = nullptr;
+  ZETASQL_RETURN_IF_ERROR(
+      engine_user_catalog_->FindTable(table_name.AsSpan(), &table));
+  ZETASQL_RET_CHECK_NE(table, nullptr)
+      << "User table " << table_name << " not found.";
+  oid_to_table_cache_.emplace(oid, table);
+  return table;
+}
+
+const std::vector<const FormData_pg_proc*>*
+CatalogAdapter::GetCachedUDFProcsByName(const std::string& name) const {
+  auto iter = name_to_udf_procs_cache_.find(name);
+  if (iter == name_to_udf_procs_cache_.end()) {
+    return nullptr;
+  }
+  return &iter->second;
+}
+
+void CatalogAdapter::CacheUDFProcsByName(
+    const std::string& name, std::vector<const FormData_pg_proc*> procs) {
+  name_to_udf_procs_cache_[name] = std::move(procs);
+}
+
 absl::StatusOr<const zetasql::TableValuedFunction*>
 CatalogAdapter::GetTVFFromOid(Oid oid) const {
   // TVFs can be user defined and assigned a temporary Oid in the CatalogAdapter
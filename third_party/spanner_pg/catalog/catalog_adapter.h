@@ -33,6 +33,8 @@
 #define SHIMS_CATALOG_ADAPTER_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "zetasql/public/analyzer_options.h"
 #include "absl/container/flat_hash_map.h"
@@ -78,6 +80,12 @@ class CatalogAdapter {
   // already tracked by the adapter.
   absl::StatusOr<TableName> GetTableNameFromOid(Oid oid) const;
 
+  // Retrieves the googlesql table for a given oid from the engine user catalog.
+  // Returns error if the oid is not already tracked by the adapter or the table
+  // is not in the catalog. Found tables are cached, since the analyzer probes
+  // the same relation for each of its column references.
+  absl::StatusOr<const zetasql::Table*> GetTableFromOid(Oid oid);
+
   // Gets the oid of a given table. `table_name` should be canonicalized by
   // caller before calling this method (later lookup is case-sensitive).
   // Generates and saves a new oid if this table hasn't been seen before.
@@ -127,6 +135,18 @@ class CatalogAdapter {
   absl::StatusOr<const zetasql::TableValuedFunction*> GetTVFFromOid(
       Oid oid) const;
 
+  // Returns the pg_procs previously generated for the user catalog functions
+  // named `name`, or nullptr if the name has not been looked up yet. An empty
+  // list means that the user catalog has no function with that name. Builtin
+  // function names are looked up in the user catalog for every call, so both
+  // outcomes are cached.
+  const std::vector<const FormData_pg_proc*>* GetCachedUDFProcsByName(
+      const std::string& name) const;
+  // Records the result of looking up `name` in the user catalog. The pg_procs
+  // are unowned, like those passed to GenerateAndStoreUDFProcOid.
+  void CacheUDFProcsByName(const std::string& name,
+                           std::vector<const FormData_pg_proc*> procs);
+
   EngineUserCatalog* GetEngineUserCatalog();
 
   EngineSystemCatalog* GetEngineSystemCatalog();
@@ -197,6 +217,12 @@ class CatalogAdapter {
   absl::flat_hash_map<Oid, const zetasql::TableValuedFunction*>
       oid_to_tvf_map_;
 
+  // Lookup caches for the catalog probes made by the analyzer. This adapter
+  // wraps a single version of the user catalog, so entries never go stale.
+  absl::flat_hash_map<Oid, const zetasql::Table*> oid_to_table_cache_;
+  absl::flat_hash_map<std::string, std::vector<const FormData_pg_proc*>>
+      name_to_udf_procs_cache_;
+
   // A counter to assign unique oids to RTEs.
   // TODO: find a safe method to assign oids.
   // Note: this is -1 only for historical reasons to preserve test outputs.
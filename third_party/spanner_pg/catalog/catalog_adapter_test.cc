@@ -32,6 +32,7 @@
 #include "third_party/spanner_pg/catalog/catalog_adapter.h"
 
 #include <memory>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -340,6 +341,57 @@ TEST_F(CatalogAdapterTest, FailedTVFLookup) {
               StatusIs(absl::StatusCode::kNotFound));
 }
 
+TEST_F(CatalogAdapterTest, GetTableFromOid) {
+  zetasql::AnalyzerOptions analyzer_options =
+      GetSpangresTestAnalyzerOptions();
+  std::unique_ptr<CatalogAdapter> catalog_adapter =
+      GetSpangresTestCatalogAdapter(analyzer_options);
+
+  const zetasql::Table* key_value_table;
+  ZETASQL_ASSERT_OK(catalog_adapter->GetEngineUserCatalog()->FindTable(
+      {"keyvalue"}, &key_value_table));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      Oid oid,
+      catalog_adapter->GetOrGenerateOidFromTableName(TableName({"keyvalue"})));
+
+  EXPECT_THAT(catalog_adapter->GetTableFromOid(oid),
+              IsOkAndHolds(key_value_table));
+  // Answered from the adapter's cache the second time.
+  EXPECT_THAT(catalog_adapter->GetTableFromOid(oid),
+              IsOkAndHolds(key_value_table));
+
+  // Untracked oids and tables missing from the catalog are errors.
+  EXPECT_THAT(catalog_adapter->GetTableFromOid(oid - 20),
+              StatusIs(absl::StatusCode::kInternal));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      Oid missing_oid,
+      catalog_adapter->GetOrGenerateOidFromTableName(TableName({"missing"})));
+  EXPECT_FALSE(catalog_adapter->GetTableFromOid(missing_oid).ok());
+}
+
+TEST_F(CatalogAdapterTest, CachesUDFProcsByName) {
+  zetasql::AnalyzerOptions analyzer_options =
+      GetSpangresTestAnalyzerOptions();
+  std::unique_ptr<CatalogAdapter> catalog_adapter =
+      GetSpangresTestCatalogAdapter(analyzer_options);
+
+  EXPECT_EQ(catalog_adapter->GetCachedUDFProcsByName("my_tvf"), nullptr);
+
+  // A name without user functions is cached as an empty list.
+  catalog_adapter->CacheUDFProcsByName("no_such_function", {});
+  const std::vector<const FormData_pg_proc*>* procs =
+      catalog_adapter->GetCachedUDFProcsByName("no_such_function");
+  ASSERT_NE(procs, nullptr);
+  EXPECT_TRUE(procs->empty());
+
+  FormData_pg_proc* proc =
+      reinterpret_cast<FormData_pg_proc*>(palloc(sizeof(FormData_pg_proc)));
+  catalog_adapter->CacheUDFProcsByName("my_tvf", {proc});
+  procs = catalog_adapter->GetCachedUDFProcsByName("my_tvf");
+  ASSERT_NE(procs, nullptr);
+  EXPECT_THAT(*procs, testing::ElementsAre(proc));
+}
+
 }  // namespace
 }  // namespace postgres_translator::test
 
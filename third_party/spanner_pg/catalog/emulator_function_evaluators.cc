@@ -32,17 +32,25 @@
 #include "third_party/spanner_pg/catalog/emulator_function_evaluators.h"
 
 #include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
 #include <string>
 
 #include "zetasql/public/function.h"
 #include "zetasql/public/value.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "third_party/spanner_pg/datatypes/extended/pg_jsonb_type.h"
 #include "third_party/spanner_pg/interface/pg_arena.h"
 #include "third_party/spanner_pg/interface/pg_arena_factory.h"
 #include "third_party/spanner_pg/interface/pg_timezone.h"
 #include "third_party/spanner_pg/postgres_includes/all.h"
 #include "third_party/spanner_pg/shims/error_shim.h"
+#include "zetasql/base/ret_check.h"
 #include "zetasql/base/status_macros.h"
 
 namespace postgres_translator {
@@ -71,15 +79,65 @@ zetasql::FunctionEvaluator PGFunctionEvaluator(
   };
 }
 
+zetasql::FunctionEvaluator PGFunctionEvaluatorWithFastPath(
+    const PGFastPathEvaluator& fast_path,
+    const zetasql::FunctionEvaluator& function,
+    const std::function<void()>& on_compute_end) {
+  zetasql::FunctionEvaluator slow_path =
+      PGFunctionEvaluator(function, on_compute_end);
+  return [fast_path, slow_path](absl::Span<const zetasql::Value> args)
+             -> absl::StatusOr<zetasql::Value> {
+    if (std::optional<zetasql::Value> result = fast_path(args);
+        result.has_value()) {
+      return *std::move(result);
+    }
+    return slow_path(args);
+  };
+}
+
+namespace {
+
+// Encodes the normalized PG.JSONB text into PG's binary `Jsonb` varlena.
+absl::StatusOr<std::string> EncodeJsonb(const absl::Cord& normalized) {
+  ZETASQL_ASSIGN_OR_RETURN(
+      Datum jsonb_in_datum,
+      postgres_translator::CheckedNullableOidFunctionCall1(
+          F_JSONB_IN, CStringGetDatum(std::string(normalized).c_str())));
+  ZETASQL_RET_CHECK(jsonb_in_datum != NULL_DATUM);
+  const char* jsonb = DatumGetPointer(jsonb_in_datum);
+  return std::string(jsonb, VARSIZE(jsonb));
+}
+
+// Returns a `Jsonb` datum for the PG.JSONB `jsonb`. The cached binary
+// encoding is copied into the current memory context, which also gives it the
+// alignment that PG expects from a varlena.
+absl::StatusOr<Datum> JsonbDatum(const zetasql::Value& jsonb) {
+  ZETASQL_ASSIGN_OR_RETURN(
+      absl::string_view binary,
+      spangres::datatypes::GetPgJsonbBinaryValue(jsonb, EncodeJsonb));
+  ZETASQL_ASSIGN_OR_RETURN(void* copy, CheckedPgPalloc(binary.size()));
+  memcpy(copy, binary.data(), binary.size());
+  return PointerGetDatum(copy);
+}
+
+absl::StatusOr<zetasql::Value> JsonbDatumToValue(Datum jsonb_datum) {
+  ZETASQL_ASSIGN_OR_RETURN(
+      Datum jsonb_out_datum,
+      postgres_translator::CheckedOidFunctionCall1(F_JSONB_OUT, jsonb_datum));
+  ZETASQL_ASSIGN_OR_RETURN(
+      char* jsonb_out,
+      postgres_translator::CheckedPgCStringDatumToCString(jsonb_out_datum));
+  return spangres::datatypes::CreatePgJsonbValue(jsonb_out);
+}
+
+}  // namespace
+
 absl::StatusOr<zetasql::Value> EmulatorJsonbArrayElementText(
-    absl::string_view jsonb, int32_t element) {
+    const zetasql::Value& jsonb, int32_t element) {
   if (element < 0) {
     return zetasql::Value::NullString();
   }
-  ZETASQL_ASSIGN_OR_RETURN(
-      Datum jsonb_in_datum,
-      postgres_translator::CheckedNullableOidFunctionCall1(
-          F_JSONB_IN, CStringGetDatum(std::string(jsonb.data()).c_str())));
+  ZETASQL_ASSIGN_OR_RETURN(Datum jsonb_in_datum, JsonbDatum(jsonb));
   Datum element_in_datum = Int32GetDatum(element);
 
   // Call `jsonb_array_element_text` on `jsonb_in_datum` and `element_in_datum`.
@@ -96,12 +154,9 @@ absl::StatusOr<zetasql::Value> EmulatorJsonbArrayElementText(
 }
 
 absl::StatusOr<zetasql::Value> EmulatorJsonbObjectFieldText(
-    absl::string_view jsonb, absl::string_view key) {
-  ZETASQL_ASSIGN_OR_RETURN(
-      Datum jsonb_in_datum,
-      postgres_translator::CheckedNullableOidFunctionCall1(
-          F_JSONB_IN, CStringGetDatum(std::string(jsonb.data()).c_str())));
-  Datum key_in_datum = CStringGetTextDatum(std::string(key.data()).c_str());
+    const zetasql::Value& jsonb, absl::string_view key) {
+  ZETASQL_ASSIGN_OR_RETURN(Datum jsonb_in_datum, JsonbDatum(jsonb));
+  Datum key_in_datum = CStringGetTextDatum(std::string(key).c_str());
 
   // Call `jsonb_object_field_text` on `jsonb_in_datum` and `key_in_datum`.
   ZETASQL_ASSIGN_OR_RETURN(
@@ -116,4 +171,45 @@ absl::StatusOr<zetasql::Value> EmulatorJsonbObjectFieldText(
   return zetasql::Value::String(result);
 }
 
+absl::StatusOr<zetasql::Value> EmulatorJsonbArrayElement(
+    const zetasql::Value& jsonb, int64_t element) {
+  if (element < std::numeric_limits<int32_t>::min() ||
+      element > std::numeric_limits<int32_t>::max()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("element overflow, it must be within ",
+                     std::numeric_limits<int32_t>::min(), " and ",
+                     std::numeric_limits<int32_t>::max()));
+  }
+  if (element < 0) {
+    return zetasql::Value::Null(spangres::datatypes::GetPgJsonbType());
+  }
+  ZETASQL_ASSIGN_OR_RETURN(Datum jsonb_in_datum, JsonbDatum(jsonb));
+  Datum element_in_datum = Int32GetDatum(static_cast<int32_t>(element));
+
+  // Call `jsonb_array_element` on `jsonb_in_datum` and `element_in_datum`.
+  ZETASQL_ASSIGN_OR_RETURN(Datum result_datum,
+                   postgres_translator::CheckedNullableOidFunctionCall2(
+                       F_JSONB_ARRAY_ELEMENT, jsonb_in_datum,
+                       element_in_datum));
+  if (result_datum == NULL_DATUM) {
+    return zetasql::Value::Null(spangres::datatypes::GetPgJsonbType());
+  }
+  return JsonbDatumToValue(result_datum);
+}
+
+absl::StatusOr<zetasql::Value> EmulatorJsonbObjectField(
+    const zetasql::Value& jsonb, absl::string_view key) {
+  ZETASQL_ASSIGN_OR_RETURN(Datum jsonb_in_datum, JsonbDatum(jsonb));
+  Datum key_in_datum = CStringGetTextDatum(std::string(key).c_str());
+
+  // Call `jsonb_object_field` on `jsonb_in_datum` and `key_in_datum`.
+  ZETASQL_ASSIGN_OR_RETURN(Datum result_datum,
+                   postgres_translator::CheckedNullableOidFunctionCall2(
+                       F_JSONB_OBJECT_FIELD, jsonb_in_datum, key_in_datum));
+  if (result_datum == NULL_DATUM) {
+    return zetasql::Value::Null(spangres::datatypes::GetPgJsonbType());
+  }
+  return JsonbDatumToValue(result_datum);
+}
+
 }  // namespace postgres_translator
@@ -34,11 +34,13 @@
 
 #include <cstdint>
 #include <functional>
+#include <optional>
 
 #include "zetasql/public/function.h"
 #include "zetasql/public/value.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 
 namespace postgres_translator {
 
@@ -49,17 +51,47 @@ zetasql::FunctionEvaluator PGFunctionEvaluator(
     const zetasql::FunctionEvaluator& function,
     const std::function<void()>& on_compute_end = []() {});
 
+// Computes a function result without calling into PG, or returns std::nullopt
+// if PG has to compute it (including every case in which PG would raise an
+// error). It must not call any Checked* shim.
+using PGFastPathEvaluator = std::function<std::optional<zetasql::Value>(
+    absl::Span<const zetasql::Value>)>;
+
+// Like PGFunctionEvaluator, but first tries `fast_path`. The PG memory arena,
+// the PG timezone and the PG error-handling frame of `function` are only set
+// up when `fast_path` returns std::nullopt, so the common case of a function
+// never pays for them.
+zetasql::FunctionEvaluator PGFunctionEvaluatorWithFastPath(
+    const PGFastPathEvaluator& fast_path,
+    const zetasql::FunctionEvaluator& function,
+    const std::function<void()>& on_compute_end = []() {});
+
 // This function calls `F_JSONB_ARRAY_ELEMENT_TEXT` to compute the results on
 // arguments `jsonb` and `element`. The function returns `Value::String`
 // (`Value::NullString` to represent a SQL null).
+//
+// `jsonb` must be a PG.JSONB value. Its binary encoding is computed once per
+// value and reused by subsequent lookups on the same value.
 absl::StatusOr<zetasql::Value> EmulatorJsonbArrayElementText(
-    absl::string_view jsonb, int32_t element);
+    const zetasql::Value& jsonb, int32_t element);
 
 // This function calls `F_JSONB_OBJECT_FIELD_TEXT` to compute the results on
 // arguments `jsonb` and `key`. The function returns `Value::String`
 // (`Value::NullString` to represent a SQL null).
 absl::StatusOr<zetasql::Value> EmulatorJsonbObjectFieldText(
-    absl::string_view jsonb, absl::string_view key);
+    const zetasql::Value& jsonb, absl::string_view key);
+
+// This function calls `F_JSONB_ARRAY_ELEMENT` to compute the results on
+// arguments `jsonb` and `element`. The function returns a PG.JSONB value (a
+// PG.JSONB null to represent a SQL null).
+absl::StatusOr<zetasql::Value> EmulatorJsonbArrayElement(
+    const zetasql::Value& jsonb, int64_t element);
+
+// This function calls `F_JSONB_OBJECT_FIELD` to compute the results on
+// arguments `jsonb` and `key`. The function returns a PG.JSONB value (a
+// PG.JSONB null to represent a SQL null).
+absl::StatusOr<zetasql::Value> EmulatorJsonbObjectField(
+    const zetasql::Value& jsonb, absl::string_view key);
 
 }  // namespace postgres_translator
 
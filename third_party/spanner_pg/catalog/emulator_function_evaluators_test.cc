@@ -33,6 +33,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 
 #include "zetasql/public/function.h"
 #include "zetasql/public/value.h"
@@ -42,6 +43,7 @@
 #include "absl/functional/any_invocable.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "third_party/spanner_pg/datatypes/extended/pg_jsonb_type.h"
 #include "third_party/spanner_pg/shims/error_shim.h"
 #include "third_party/spanner_pg/shims/memory_context_pg_arena.h"
 #include "third_party/spanner_pg/shims/stub_memory_reservation_manager.h"
@@ -50,6 +52,7 @@ namespace postgres_translator {
 namespace {
 
 using ::postgres_translator::CheckedPgPalloc;
+using ::postgres_translator::spangres::datatypes::CreatePgJsonbValue;
 using ::zetasql_base::testing::IsOkAndHolds;
 
 absl::StatusOr<zetasql::Value> EvalPgAlloc(
@@ -79,6 +82,64 @@ TEST(PGFunctionEvaluators, CallsGivenCleanupFunction) {
               IsOkAndHolds(zetasql::values::Int64(123)));
   EXPECT_TRUE(function_called);
 }
+
+TEST(PGFunctionEvaluators, FastPathSkipsPGFunction) {
+  int calls = 0;
+  zetasql::FunctionEvaluator evaluator = PGFunctionEvaluatorWithFastPath(
+      [](absl::Span<const zetasql::Value> args)
+          -> std::optional<zetasql::Value> {
+        if (args[0].int64_value() < 0) {
+          return std::nullopt;
+        }
+        return args[0];
+      },
+      [&calls](absl::Span<const zetasql::Value> args) {
+        ++calls;
+        return EvalPgAlloc(args);
+      });
+
+  EXPECT_THAT(evaluator({zetasql::values::Int64(1)}),
+              IsOkAndHolds(zetasql::values::Int64(1)));
+  EXPECT_EQ(calls, 0);
+
+  // Falls back to the PG function in its arena when the fast path declines.
+  EXPECT_THAT(evaluator({zetasql::values::Int64(-1)}),
+              IsOkAndHolds(zetasql::values::Int64(123)));
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(PGFunctionEvaluators, JsonbLookupsReuseValueAcrossArenas) {
+  zetasql::FunctionEvaluator object_field_text = PGFunctionEvaluator(
+      [](absl::Span<const zetasql::Value> args) {
+        return EmulatorJsonbObjectFieldText(args[0], args[1].string_value());
+      });
+  zetasql::FunctionEvaluator array_element = PGFunctionEvaluator(
+      [](absl::Span<const zetasql::Value> args) {
+        return EmulatorJsonbArrayElement(args[0], args[1].int64_value());
+      });
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      zetasql::Value jsonb,
+      CreatePgJsonbValue(R"({"a": "x", "b": [1, {"c": 2}]})"));
+
+  // Each evaluator call runs in its own arena, so the binary encoding cached
+  // on `jsonb` by the first call must not depend on that arena.
+  EXPECT_THAT(object_field_text({jsonb, zetasql::values::String("a")}),
+              IsOkAndHolds(zetasql::values::String("x")));
+  EXPECT_THAT(object_field_text({jsonb, zetasql::values::String("a")}),
+              IsOkAndHolds(zetasql::values::String("x")));
+  EXPECT_THAT(object_field_text({jsonb, zetasql::values::String("d")}),
+              IsOkAndHolds(zetasql::values::NullString()));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(zetasql::Value array,
+                       CreatePgJsonbValue(R"([1, {"c": 2}])"));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(zetasql::Value element,
+                       CreatePgJsonbValue(R"({"c": 2})"));
+  EXPECT_THAT(array_element({array, zetasql::values::Int64(1)}),
+              IsOkAndHolds(element));
+  EXPECT_THAT(array_element({array, zetasql::values::Int64(1)}),
+              IsOkAndHolds(element));
+}
+
 }  // namespace
 }  // namespace postgres_translator
 
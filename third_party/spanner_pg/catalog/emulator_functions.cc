@@ -63,6 +63,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "zetasql/common/string_util.h"
@@ -72,6 +73,7 @@
 #include "absl/time/time.h"
 #include "third_party/spanner_pg/catalog/emulator_function_evaluators.h"
 #include "third_party/spanner_pg/catalog/jsonb_array_elements_table_valued_function.h"
+#include "third_party/spanner_pg/datatypes/common/fixed_width_numeric.h"
 #include "third_party/spanner_pg/datatypes/common/jsonb/jsonb_parse.h"
 #include "third_party/spanner_pg/datatypes/common/pg_numeric_parse.h"
 #include "third_party/spanner_pg/datatypes/extended/pg_jsonb_conversion_functions.h"
@@ -98,10 +100,12 @@ using postgres_translator::spangres::datatypes::GetPgNumericNormalizedValue;
 using spangres::datatypes::CreatePgJsonbValue;
 using spangres::datatypes::CreatePgJsonbValueFromNormalized;
 using spangres::datatypes::CreatePgNumericValue;
+using spangres::datatypes::CreatePgNumericValueFromNormalized;
 using spangres::datatypes::CreatePgNumericValueWithMemoryContext;
 using spangres::datatypes::CreatePgNumericValueWithPrecisionAndScale;
 using spangres::datatypes::GetPgJsonbNormalizedValue;
 using spangres::datatypes::GetPgNumericNormalizedValue;
+using spangres::datatypes::common::FixedWidthNumeric;
 using spangres::datatypes::common::jsonb::IsValidJsonbString;
 using spangres::datatypes::common::jsonb::NormalizeJsonbString;
 using spangres::datatypes::common::jsonb::ParseJsonbArray;
@@ -144,7 +148,9 @@ constexpr char kNegInfString[] = "\"-Infinity\"";
 constexpr char kFalse[] = "false";
 constexpr char kTrue[] = "true";
 
+using ::postgres_translator::EmulatorJsonbArrayElement;
 using ::postgres_translator::EmulatorJsonbArrayElementText;
+using ::postgres_translator::EmulatorJsonbObjectField;
 using ::postgres_translator::EmulatorJsonbObjectFieldText;
 using ::postgres_translator::function_evaluators::Abs;
 using ::postgres_translator::function_evaluators::Add;
@@ -152,7 +158,6 @@ using ::postgres_translator::function_evaluators::CastNumericToInt8;
 using ::postgres_translator::function_evaluators::Ceil;
 using ::postgres_translator::function_evaluators::CleanupPostgresDateTimeCache;
 using ::postgres_translator::function_evaluators::CleanupPostgresNumberCache;
-using ::postgres_translator::function_evaluators::CleanupRegexCache;
 using ::postgres_translator::function_evaluators::DateMii;
 using ::postgres_translator::function_evaluators::DatePli;
 using ::postgres_translator::function_evaluators::Divide;
@@ -161,8 +166,6 @@ using ::postgres_translator::function_evaluators::Float4ToChar;
 using ::postgres_translator::function_evaluators::Float8ToChar;
 using ::postgres_translator::function_evaluators::Floor;
 using ::postgres_translator::function_evaluators::Int8ToChar;
-using ::postgres_translator::function_evaluators::JsonbArrayElement;
-using ::postgres_translator::function_evaluators::JsonbObjectField;
 using ::postgres_translator::function_evaluators::JsonbTypeof;
 using ::postgres_translator::function_evaluators::Mod;
 using ::postgres_translator::function_evaluators::Multiply;
@@ -273,8 +276,7 @@ absl::StatusOr<zetasql::Value> EvalTextregexne(
 std::unique_ptr<zetasql::Function> TextregexneFunction(
     absl::string_view catalog_name) {
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(
-      PGFunctionEvaluator(EvalTextregexne, CleanupRegexCache));
+  function_options.set_evaluator(PGFunctionEvaluator(EvalTextregexne));
   return std::make_unique<zetasql::Function>(
       kPGTextregexneFunctionName, catalog_name, zetasql::Function::SCALAR,
       std::vector<zetasql::FunctionSignature>{zetasql::FunctionSignature{
@@ -522,6 +524,112 @@ std::unique_ptr<zetasql::Function> ToNumberFunction(
 
 // PG.NUMERIC Mathematical functions
 
+// Returns `value`, a non-NULL INT64 or PG.NUMERIC, as a FixedWidthNumeric, or
+// std::nullopt if it does not fit in one.
+std::optional<FixedWidthNumeric> ToFixedWidthNumeric(
+    const zetasql::Value& value) {
+  if (value.type_kind() == zetasql::TYPE_INT64) {
+    return FixedWidthNumeric::FromInt64(value.int64_value());
+  }
+  absl::StatusOr<absl::Cord> normalized = GetPgNumericNormalizedValue(value);
+  if (!normalized.ok()) {
+    return std::nullopt;
+  }
+  if (std::optional<absl::string_view> flat = normalized->TryFlat();
+      flat.has_value()) {
+    return FixedWidthNumeric::FromNormalized(*flat);
+  }
+  return FixedWidthNumeric::FromNormalized(std::string(*normalized));
+}
+
+zetasql::Value PgNumericValueFromFixedWidth(const FixedWidthNumeric& value) {
+  return CreatePgNumericValueFromNormalized(absl::Cord(value.ToNormalized()));
+}
+
+// Evaluates the binary PG.NUMERIC operator `op` on the non-NULL `args` without
+// calling PG code. Returns std::nullopt if an operand or the result does not
+// fit in a FixedWidthNumeric, in which case PG must evaluate the operator.
+std::optional<zetasql::Value> TryEvalFixedWidthNumericOperator(
+    absl::Span<const zetasql::Value> args,
+    std::optional<FixedWidthNumeric> (*op)(const FixedWidthNumeric&,
+                                           const FixedWidthNumeric&)) {
+  std::optional<FixedWidthNumeric> lhs = ToFixedWidthNumeric(args[0]);
+  if (!lhs.has_value()) {
+    return std::nullopt;
+  }
+  std::optional<FixedWidthNumeric> rhs = ToFixedWidthNumeric(args[1]);
+  if (!rhs.has_value()) {
+    return std::nullopt;
+  }
+  std::optional<FixedWidthNumeric> result = op(*lhs, *rhs);
+  if (!result.has_value()) {
+    return std::nullopt;
+  }
+  return PgNumericValueFromFixedWidth(*result);
+}
+
+// The fast paths below compute PG.NUMERIC functions for NULL inputs and for the
+// common non-NULL inputs without a PG arena or PG error-handling frame. They
+// return std::nullopt for anything else, including every input on which PG
+// raises an error, so that the PG implementation handles it.
+
+PGFastPathEvaluator FixedWidthNumericOperatorFastPath(
+    std::optional<FixedWidthNumeric> (*op)(const FixedWidthNumeric&,
+                                           const FixedWidthNumeric&)) {
+  return [op](absl::Span<const zetasql::Value> args)
+             -> std::optional<zetasql::Value> {
+    if (args.size() != 2) {
+      return std::nullopt;
+    }
+    if (args[0].is_null() || args[1].is_null()) {
+      return zetasql::Value::Null(spangres::datatypes::GetPgNumericType());
+    }
+    return TryEvalFixedWidthNumericOperator(args, op);
+  };
+}
+
+// Returns true if the normalized PG.NUMERIC `normalized` is zero, at any scale.
+bool IsNormalizedNumericZero(absl::string_view normalized) {
+  return std::all_of(normalized.begin(), normalized.end(),
+                     [](char c) { return c == '0' || c == '.'; });
+}
+
+// Fast path of `numeric_uminus` (`negate` = true) and `abs(numeric)`, which
+// only change the sign of the normalized representation. NaN and zero are
+// their own negation, and PG never prints a negative zero.
+std::optional<zetasql::Value> FastEvalNumericSign(
+    absl::Span<const zetasql::Value> args, bool negate) {
+  if (args.size() != 1) {
+    return std::nullopt;
+  }
+  if (args[0].is_null()) {
+    return zetasql::Value::Null(spangres::datatypes::GetPgNumericType());
+  }
+  absl::StatusOr<absl::Cord> normalized = GetPgNumericNormalizedValue(args[0]);
+  if (!normalized.ok()) {
+    return std::nullopt;
+  }
+  std::string value(*normalized);
+  if (absl::StartsWith(value, "-")) {
+    return CreatePgNumericValueFromNormalized(absl::Cord(value.substr(1)));
+  }
+  if (!negate || value == kNan || IsNormalizedNumericZero(value)) {
+    return args[0];
+  }
+  return CreatePgNumericValueFromNormalized(
+      absl::Cord(absl::StrCat("-", value)));
+}
+
+std::optional<zetasql::Value> FastEvalNumericAbs(
+    absl::Span<const zetasql::Value> args) {
+  return FastEvalNumericSign(args, /*negate=*/false);
+}
+
+std::optional<zetasql::Value> FastEvalNumericUminus(
+    absl::Span<const zetasql::Value> args) {
+  return FastEvalNumericSign(args, /*negate=*/true);
+}
+
 absl::StatusOr<zetasql::Value> EvalNumericAbs(
     absl::Span<const zetasql::Value> args) {
   static const zetasql::Type* gsql_pg_numeric =
@@ -545,7 +653,8 @@ std::unique_ptr<zetasql::Function> NumericAbsFunction(
       spangres::datatypes::GetPgNumericType();
 
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(PGFunctionEvaluator(EvalNumericAbs));
+  function_options.set_evaluator(
+      PGFunctionEvaluatorWithFastPath(FastEvalNumericAbs, EvalNumericAbs));
   return std::make_unique<zetasql::Function>(
       kPGNumericAbsFunctionName, catalog_name, zetasql::Function::SCALAR,
       std::vector<zetasql::FunctionSignature>{zetasql::FunctionSignature{
@@ -560,6 +669,11 @@ absl::StatusOr<zetasql::Value> EvalNumericAdd(
     return zetasql::Value::Null(
         postgres_translator::spangres::datatypes::GetPgNumericType());
   }
+  if (std::optional<zetasql::Value> result =
+          TryEvalFixedWidthNumericOperator(args, FixedWidthNumeric::Add);
+      result.has_value()) {
+    return *std::move(result);
+  }
 
   ZETASQL_ASSIGN_OR_RETURN(absl::Cord lhs, GetPgNumericNormalizedValue(args[0]));
   ZETASQL_ASSIGN_OR_RETURN(absl::Cord rhs, GetPgNumericNormalizedValue(args[1]));
@@ -573,7 +687,9 @@ std::unique_ptr<zetasql::Function> NumericAddFunction(
   const zetasql::Type* gsql_pg_numeric =
       postgres_translator::spangres::datatypes::GetPgNumericType();
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(PGFunctionEvaluator(EvalNumericAdd));
+  function_options.set_evaluator(PGFunctionEvaluatorWithFastPath(
+      FixedWidthNumericOperatorFastPath(FixedWidthNumeric::Add),
+      EvalNumericAdd));
 
   return std::make_unique<zetasql::Function>(
       kPGNumericAddFunctionName, catalog_name, zetasql::Function::SCALAR,
@@ -767,6 +883,11 @@ absl::StatusOr<zetasql::Value> EvalNumericMultiply(
     return zetasql::Value::Null(
         postgres_translator::spangres::datatypes::GetPgNumericType());
   }
+  if (std::optional<zetasql::Value> result =
+          TryEvalFixedWidthNumericOperator(args, FixedWidthNumeric::Multiply);
+      result.has_value()) {
+    return *std::move(result);
+  }
 
   ZETASQL_ASSIGN_OR_RETURN(absl::Cord lhs, GetPgNumericNormalizedValue(args[0]));
   ZETASQL_ASSIGN_OR_RETURN(absl::Cord rhs, GetPgNumericNormalizedValue(args[1]));
@@ -781,7 +902,9 @@ std::unique_ptr<zetasql::Function> NumericMultiplyFunction(
   const zetasql::Type* gsql_pg_numeric =
       postgres_translator::spangres::datatypes::GetPgNumericType();
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(PGFunctionEvaluator(EvalNumericMultiply));
+  function_options.set_evaluator(PGFunctionEvaluatorWithFastPath(
+      FixedWidthNumericOperatorFastPath(FixedWidthNumeric::Multiply),
+      EvalNumericMultiply));
 
   return std::make_unique<zetasql::Function>(
       kPGNumericMultiplyFunctionName, catalog_name, zetasql::Function::SCALAR,
@@ -799,6 +922,11 @@ absl::StatusOr<zetasql::Value> EvalNumericSubtract(
     return zetasql::Value::Null(
         postgres_translator::spangres::datatypes::GetPgNumericType());
   }
+  if (std::optional<zetasql::Value> result =
+          TryEvalFixedWidthNumericOperator(args, FixedWidthNumeric::Subtract);
+      result.has_value()) {
+    return *std::move(result);
+  }
 
   ZETASQL_ASSIGN_OR_RETURN(absl::Cord lhs, GetPgNumericNormalizedValue(args[0]));
   ZETASQL_ASSIGN_OR_RETURN(absl::Cord rhs, GetPgNumericNormalizedValue(args[1]));
@@ -813,7 +941,9 @@ std::unique_ptr<zetasql::Function> NumericSubtractFunction(
   const zetasql::Type* gsql_pg_numeric =
       postgres_translator::spangres::datatypes::GetPgNumericType();
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(PGFunctionEvaluator(EvalNumericSubtract));
+  function_options.set_evaluator(PGFunctionEvaluatorWithFastPath(
+      FixedWidthNumericOperatorFastPath(FixedWidthNumeric::Subtract),
+      EvalNumericSubtract));
 
   return std::make_unique<zetasql::Function>(
       kPGNumericSubtractFunctionName, catalog_name, zetasql::Function::SCALAR,
@@ -882,7 +1012,9 @@ std::unique_ptr<zetasql::Function> NumericUminusFunction(
       spangres::datatypes::GetPgNumericType();
 
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(PGFunctionEvaluator(EvalNumericUminus));
+  function_options.set_evaluator(
+      PGFunctionEvaluatorWithFastPath(FastEvalNumericUminus,
+                                      EvalNumericUminus));
   return std::make_unique<zetasql::Function>(
       kPGNumericUminusFunctionName, catalog_name, zetasql::Function::SCALAR,
       std::vector<zetasql::FunctionSignature>{zetasql::FunctionSignature{
@@ -896,7 +1028,9 @@ std::unique_ptr<zetasql::Function> CastToNumericFunction(
       spangres::datatypes::GetPgNumericType();
 
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(PGFunctionEvaluator(EvalCastToNumeric));
+  function_options.set_evaluator(
+      PGFunctionEvaluatorWithFastPath(FastEvalCastToNumeric,
+                                      EvalCastToNumeric));
   return std::make_unique<zetasql::Function>(
       kPGCastToNumericFunctionName, catalog_name, zetasql::Function::SCALAR,
       std::vector<zetasql::FunctionSignature>{
@@ -946,7 +1080,8 @@ std::unique_ptr<zetasql::Function> CastNumericToDoubleFunction(
       spangres::datatypes::GetPgNumericType();
 
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(PGFunctionEvaluator(EvalCastNumericToDouble));
+  function_options.set_evaluator(
+      zetasql::FunctionEvaluator(EvalCastNumericToDouble));
   return std::make_unique<zetasql::Function>(
       kPGCastNumericToDoubleFunctionName, catalog_name,
       zetasql::Function::SCALAR,
@@ -961,7 +1096,8 @@ std::unique_ptr<zetasql::Function> CastNumericToFloatFunction(
       spangres::datatypes::GetPgNumericType();
 
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(PGFunctionEvaluator(EvalCastNumericToFloat));
+  function_options.set_evaluator(
+      zetasql::FunctionEvaluator(EvalCastNumericToFloat));
   return std::make_unique<zetasql::Function>(
       kPGCastNumericToFloatFunctionName, catalog_name,
       zetasql::Function::SCALAR,
@@ -976,7 +1112,8 @@ std::unique_ptr<zetasql::Function> CastNumericToStringFunction(
       spangres::datatypes::GetPgNumericType();
 
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(PGFunctionEvaluator(EvalCastNumericToString));
+  function_options.set_evaluator(
+      zetasql::FunctionEvaluator(EvalCastNumericToString));
   return std::make_unique<zetasql::Function>(
       kPGCastNumericToStringFunctionName, catalog_name,
       zetasql::Function::SCALAR,
@@ -991,7 +1128,9 @@ std::unique_ptr<zetasql::Function> CastNumericToInt64Function(
       spangres::datatypes::GetPgNumericType();
 
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(PGFunctionEvaluator(EvalCastNumericToInt64));
+  function_options.set_evaluator(
+      PGFunctionEvaluatorWithFastPath(FastEvalCastNumericToInt64,
+                                      EvalCastNumericToInt64));
   return std::make_unique<zetasql::Function>(
       kPGCastNumericToInt64FunctionName, catalog_name,
       zetasql::Function::SCALAR,
@@ -1062,8 +1201,7 @@ absl::StatusOr<zetasql::Value> EvalRegexpMatch(
 std::unique_ptr<zetasql::Function> RegexpMatchFunction(
     absl::string_view catalog_name) {
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(
-      PGFunctionEvaluator(EvalRegexpMatch, CleanupRegexCache));
+  function_options.set_evaluator(PGFunctionEvaluator(EvalRegexpMatch));
   return std::make_unique<zetasql::Function>(
       kPGRegexpMatchFunctionName, catalog_name, zetasql::Function::SCALAR,
       std::vector<zetasql::FunctionSignature>{
@@ -1110,8 +1248,7 @@ absl::StatusOr<zetasql::Value> EvalRegexpSplitToArray(
 std::unique_ptr<zetasql::Function> RegexpSplitToArrayFunction(
     absl::string_view catalog_name) {
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(
-      PGFunctionEvaluator(EvalRegexpSplitToArray, CleanupRegexCache));
+  function_options.set_evaluator(PGFunctionEvaluator(EvalRegexpSplitToArray));
   return std::make_unique<zetasql::Function>(
       kPGRegexpSplitToArrayFunctionName, catalog_name,
       zetasql::Function::SCALAR,
@@ -1146,8 +1283,7 @@ absl::StatusOr<zetasql::Value> EvalSubstring(
 std::unique_ptr<zetasql::Function> SubstringFunction(
     absl::string_view catalog_name) {
   zetasql::FunctionOptions function_options;
-  function_options.set_evaluator(
-      PGFunctionEvaluator(EvalSubstring, CleanupRegexCache));
+  function_options.set_evaluator(PGFunctionEvaluator(EvalSubstring));
   return std::make_unique<zetasql::Function>(
       kPGSubstringFunctionName, catalog_name, zetasql::Function::SCALAR,
       std::vector<zetasql::FunctionSignature>{
@@ -1936,13 +2072,11 @@ absl::StatusOr<zetasql::Value> EvalJsonbSubscriptText(
   if (args[0].is_null() || args[1].is_null()) {
     return zetasql::Value::NullString();
   }
-  const std::string jsonb(GetStringRepresentation(args[0]).value());
   if (args[1].type_kind() == zetasql::TYPE_INT64) {
     const int32_t element = static_cast<int32_t>(args[1].int64_value());
-    return EmulatorJsonbArrayElementText(jsonb, element);
+    return EmulatorJsonbArrayElementText(args[0], element);
   } else {
-    const std::string key(args[1].string_value());
-    return EmulatorJsonbObjectFieldText(jsonb, key);
+    return EmulatorJsonbObjectFieldText(args[0], args[1].string_value());
   }
 }
 
@@ -1978,8 +2112,7 @@ absl::StatusOr<zetasql::Value> EvalJsonbArrayElement(
         postgres_translator::spangres::datatypes::GetPgJsonbType());
   }
 
-  ZETASQL_ASSIGN_OR_RETURN(absl::Cord jsonb, GetPgJsonbNormalizedValue(args[0]));
-  return JsonbArrayElement(std::string(jsonb), args[1].int64_value());
+  return EmulatorJsonbArrayElement(args[0], args[1].int64_value());
 }
 
 std::unique_ptr<zetasql::Function> JsonbArrayElementFunction(
@@ -2011,8 +2144,7 @@ absl::StatusOr<zetasql::Value> EvalJsonbObjectField(
         postgres_translator::spangres::datatypes::GetPgJsonbType());
   }
 
-  ZETASQL_ASSIGN_OR_RETURN(absl::Cord jsonb, GetPgJsonbNormalizedValue(args[0]));
-  return JsonbObjectField(std::string(jsonb), args[1].string_value());
+  return EmulatorJsonbObjectField(args[0], args[1].string_value());
 }
 
 std::unique_ptr<zetasql::Function> JsonbObjectFieldFunction(
@@ -2612,6 +2744,11 @@ class SumEvaluator : public zetasql::AggregateFunctionEvaluator {
       return absl::OkStatus();
     }
 
+    if (TryAccumulateFixedWidth(value)) {
+      count_++;
+      return absl::OkStatus();
+    }
+
     // If the result is null, the first value must've been null so set the
     // result to the new value.
     if (result_.is_null()) {
@@ -2693,10 +2830,20 @@ class SumEvaluator : public zetasql::AggregateFunctionEvaluator {
       // doesn't know anything about the return type.
       return zetasql::values::Null(gsql_pg_numeric_);
     }
+    FlushFixedWidthResult();
     return result_;
   }
 
  protected:
+  // Moves the running sum held in `fixed_width_result_`, if any, into
+  // `result_`.
+  void FlushFixedWidthResult() {
+    if (fixed_width_result_.has_value()) {
+      result_ = PgNumericValueFromFixedWidth(*fixed_width_result_);
+      fixed_width_result_.reset();
+    }
+  }
+
   uint64_t count_ = 0;
   zetasql::TypeKind kind_ = zetasql::TYPE_UNKNOWN;
   zetasql::Value result_;
@@ -2704,6 +2851,39 @@ class SumEvaluator : public zetasql::AggregateFunctionEvaluator {
       spangres::datatypes::GetPgNumericType();
 
   virtual bool IsAvgEvaluator() { return false; }
+
+ private:
+  // Adds a non-NULL INT64 or PG.NUMERIC `value` to `fixed_width_result_`
+  // without calling PG code. Returns false once the sum or a value no longer
+  // fits in a FixedWidthNumeric; the sum so far is then flushed to `result_`
+  // and all remaining values are added with PG arithmetic.
+  bool TryAccumulateFixedWidth(const zetasql::Value& value) {
+    if ((kind_ != zetasql::TYPE_INT64 && kind_ != zetasql::TYPE_EXTENDED) ||
+        fixed_width_exhausted_) {
+      return false;
+    }
+    std::optional<FixedWidthNumeric> operand = ToFixedWidthNumeric(value);
+    if (operand.has_value()) {
+      if (!fixed_width_result_.has_value()) {
+        fixed_width_result_ = operand;
+        return true;
+      }
+      std::optional<FixedWidthNumeric> sum =
+          FixedWidthNumeric::Add(*fixed_width_result_, *operand);
+      if (sum.has_value()) {
+        fixed_width_result_ = sum;
+        return true;
+      }
+    }
+    FlushFixedWidthResult();
+    fixed_width_exhausted_ = true;
+    return false;
+  }
+
+  // The running INT64 or PG.NUMERIC sum while it fits in a FixedWidthNumeric.
+  // `result_` is stale while this is set.
+  std::optional<FixedWidthNumeric> fixed_width_result_;
+  bool fixed_width_exhausted_ = false;
 };
 
 std::unique_ptr<zetasql::Function> SumAggregator(
@@ -2762,6 +2942,7 @@ class AvgEvaluator : public SumEvaluator {
     }
 
     // INT64 or PG.NUMERIC:
+    FlushFixedWidthResult();
     // Setup the memory context arena which is required for
     // CreatePgNumericValue() and EvalNumericDivide().
     ZETASQL_ASSIGN_OR_RETURN(
@@ -3452,6 +3633,56 @@ absl::StatusOr<zetasql::Value> EvalCastToNumeric(
                                 input_to_string, precision, scale);
 }
 
+std::optional<zetasql::Value> FastEvalCastNumericToInt64(
+    absl::Span<const zetasql::Value> args) {
+  if (args.size() != 1) {
+    return std::nullopt;
+  }
+  if (args[0].is_null()) {
+    return zetasql::Value::NullInt64();
+  }
+  std::optional<FixedWidthNumeric> value = ToFixedWidthNumeric(args[0]);
+  if (!value.has_value()) {
+    return std::nullopt;
+  }
+  absl::int128 divisor = 1;
+  for (int i = 0; i < value->scale(); ++i) {
+    divisor *= 10;
+  }
+  // Like PG `numeric_int8`, rounds half away from zero.
+  absl::int128 result = value->unscaled_value() / divisor;
+  absl::int128 remainder = value->unscaled_value() % divisor;
+  if (remainder > 0 && remainder >= divisor - remainder) {
+    ++result;
+  } else if (remainder < 0 && -remainder >= divisor + remainder) {
+    --result;
+  }
+  if (result < std::numeric_limits<int64_t>::min() ||
+      result > std::numeric_limits<int64_t>::max()) {
+    return std::nullopt;
+  }
+  return zetasql::Value::Int64(static_cast<int64_t>(result));
+}
+
+std::optional<zetasql::Value> FastEvalCastToNumeric(
+    absl::Span<const zetasql::Value> args) {
+  // Casts with a precision or scale round and check the value in PG.
+  if (args.size() != 1) {
+    return std::nullopt;
+  }
+  if (args[0].is_null()) {
+    return zetasql::Value::Null(spangres::datatypes::GetPgNumericType());
+  }
+  if (args[0].type_kind() == zetasql::TYPE_INT64) {
+    return PgNumericValueFromFixedWidth(
+        FixedWidthNumeric::FromInt64(args[0].int64_value()));
+  }
+  if (args[0].type() == spangres::datatypes::GetPgNumericType()) {
+    return args[0];
+  }
+  return std::nullopt;
+}
+
 absl::StatusOr<zetasql::Value> EvalToJsonb(
     absl::Span<const zetasql::Value> args) {
   ZETASQL_RET_CHECK(args.size() == 1);
@@ -36,6 +36,7 @@
 // emulator catalog for use by the PG to ZetaSQL translator.
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -188,6 +189,15 @@ absl::StatusOr<zetasql::Value> EvalCastNumericToString(
 absl::StatusOr<zetasql::Value> EvalCastToNumeric(
     absl::Span<const zetasql::Value> args);
 
+// Fast paths of EvalCastNumericToInt64 and EvalCastToNumeric for use with
+// PGFunctionEvaluatorWithFastPath. They handle NULLs, PG.NUMERIC values that
+// fit in 38 digits and casts from INT64 without calling into PG.
+std::optional<zetasql::Value> FastEvalCastNumericToInt64(
+    absl::Span<const zetasql::Value> args);
+
+std::optional<zetasql::Value> FastEvalCastToNumeric(
+    absl::Span<const zetasql::Value> args);
+
 absl::StatusOr<zetasql::Value> EvalToJsonb(
     absl::Span<const zetasql::Value> args);
 
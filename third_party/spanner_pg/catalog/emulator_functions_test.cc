@@ -209,6 +209,13 @@ const zetasql::Value kPGNumericNaNValue =
     *CreatePgNumericValueWithMemoryContext("NaN");
 const zetasql::Value kPGNumericMaxValue =
     *CreatePgNumericValueWithMemoryContext(MaxNumericString());
+// The PG.NUMERIC values with the most digits that fit in a FixedWidthNumeric.
+const zetasql::Value kPGNumericMaxFixedWidthValue =
+    *CreatePgNumericValueWithMemoryContext(std::string(38, '9'));
+const zetasql::Value kPGNumericSmallScaleValue =
+    *CreatePgNumericValueWithMemoryContext("1.5");
+const zetasql::Value kPGNumericLargeScaleValue =
+    *CreatePgNumericValueWithMemoryContext("2.25");
 const zetasql::Value kPGNumericMinValue =
     *CreatePgNumericValueWithMemoryContext(MinNumericString());
 const zetasql::Value kPGNumericMaxDoubleValueRetainingFirst15Digits =
@@ -746,6 +753,17 @@ INSTANTIATE_TEST_SUITE_P(
         PGScalarFunctionTestCase{kPGNumericUminusFunctionName,
                                  {CreatePgNumericNullValue()},
                                  CreatePgNumericNullValue()},
+        PGScalarFunctionTestCase{
+            kPGNumericUminusFunctionName,
+            {*CreatePgNumericValueWithMemoryContext("0.00")},
+            *CreatePgNumericValueWithMemoryContext("0.00")},
+        PGScalarFunctionTestCase{kPGNumericUminusFunctionName,
+                                 {kPGNumericNaNValue},
+                                 kPGNumericNaNValue},
+        PGScalarFunctionTestCase{
+            kPGNumericUminusFunctionName,
+            {kPGNumericMaxValue},
+            *CreatePgNumericValueWithMemoryContext(MinNumericString())},
 
         PGScalarFunctionTestCase{kPGCastNumericToInt64FunctionName,
                                  {*CreatePgNumericValueWithMemoryContext("0")},
@@ -783,6 +801,15 @@ INSTANTIATE_TEST_SUITE_P(
         PGScalarFunctionTestCase{kPGCastNumericToInt64FunctionName,
                                  {CreatePgNumericNullValue()},
                                  kNullInt64Value},
+        PGScalarFunctionTestCase{
+            kPGCastNumericToInt64FunctionName,
+            {*CreatePgNumericValueWithMemoryContext("-0.5")},
+            zetasql::Value::Int64(-1)},
+        PGScalarFunctionTestCase{
+            kPGCastNumericToInt64FunctionName,
+            {*CreatePgNumericValueWithMemoryContext(absl::StrCat(
+                std::numeric_limits<int64_t>::max(), ".4999"))},
+            zetasql::Value::Int64(std::numeric_limits<int64_t>::max())},
 
         PGScalarFunctionTestCase{
             kPGCastNumericToDoubleFunctionName,
@@ -3054,6 +3081,12 @@ TEST_F(EmulatorFunctionsTest,
           {*CreatePgNumericValueWithMemoryContext(MinNumericString())})),
       StatusIs(absl::StatusCode::kOutOfRange,
                HasSubstr("bigint out of range")));
+  // Fits in 38 digits but rounds to just past the INT64 range.
+  EXPECT_THAT(evaluator_(absl::MakeConstSpan(
+                  {*CreatePgNumericValueWithMemoryContext(absl::StrCat(
+                      std::numeric_limits<int64_t>::max(), ".5"))})),
+              StatusIs(absl::StatusCode::kOutOfRange,
+                       HasSubstr("bigint out of range")));
 }
 
 class EvalToJsonbTest : public EmulatorFunctionsTest {
@@ -4890,6 +4923,18 @@ INSTANTIATE_TEST_SUITE_P(
           &kNullPGNumericValue},
          *CreatePgNumericValueWithMemoryContext("2.0"),
          absl::StatusCode::kOk},
+        {"PGNumericArgsWithDifferentScales",
+         kPGSumFunctionName,
+         {&kPGNumericSmallScaleValue, &kPGNumericLargeScaleValue},
+         *CreatePgNumericValueWithMemoryContext("3.75"),
+         absl::StatusCode::kOk},
+        {"PGNumericArgsExceedingFixedWidth",
+         kPGSumFunctionName,
+         {&kPGNumericMaxFixedWidthValue, &kPGNumericMaxFixedWidthValue,
+          &kPGNumericValue},
+         *CreatePgNumericValueWithMemoryContext(
+             absl::StrCat("1", std::string(38, '9'), ".0")),
+         absl::StatusCode::kOk},
         {"OneNanPGNumericArg",
          kPGSumFunctionName,
          {&kPGNumericNaNValue},
@@ -0,0 +1,283 @@
+//
+// PostgreSQL is released under the PostgreSQL License, a liberal Open Source
+// license, similar to the BSD or MIT licenses.
+//
+// PostgreSQL Database Management System
+// (formerly known as Postgres, then as Postgres95)
+//
+// Portions Copyright © 1996-2020, The PostgreSQL Global Development Group
+//
+// Portions Copyright © 1994, The Regents of the University of California
+//
+// Portions Copyright 2023 Google LLC
+//
+// Permission to use, copy, modify, and distribute this software and its
+// documentation for any purpose, without fee, and without a written agreement
+// is hereby granted, provided that the above copyright notice and this
+// paragraph and the following two paragraphs appear in all copies.
+//
+// IN NO EVENT SHALL THE UNIVERSITY OF CALIFORNIA BE LIABLE TO ANY PARTY FOR
+// DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING
+// LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION,
+// EVEN IF THE UNIVERSITY OF CALIFORNIA HAS BEEN ADVISED OF THE POSSIBILITY OF
+// SUCH DAMAGE.
+//
+// THE UNIVERSITY OF CALIFORNIA SPECIFICALLY DISCLAIMS ANY WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+// FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS ON AN
+// "AS IS" BASIS, AND THE UNIVERSITY OF CALIFORNIA HAS NO OBLIGATIONS TO PROVIDE
+// MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+//------------------------------------------------------------------------------
+
+#include "third_party/spanner_pg/datatypes/common/fixed_width_numeric.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+
+#include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
+
+namespace postgres_translator::spangres::datatypes::common {
+
+namespace {
+
+// Returns 10^exponent for 0 <= exponent <= FixedWidthNumeric::kMaxDigits.
+absl::int128 PowerOfTen(int exponent) {
+  static const auto* const kPowers = [] {
+    auto* powers = new absl::int128[FixedWidthNumeric::kMaxDigits + 1];
+    powers[0] = 1;
+    for (int i = 1; i <= FixedWidthNumeric::kMaxDigits; ++i) {
+      powers[i] = powers[i - 1] * 10;
+    }
+    return powers;
+  }();
+  return kPowers[exponent];
+}
+
+// The largest unscaled magnitude that is represented: kMaxDigits nines.
+absl::int128 MaxUnscaled() {
+  return PowerOfTen(FixedWidthNumeric::kMaxDigits) - 1;
+}
+
+absl::int128 Abs(absl::int128 value) { return value < 0 ? -value : value; }
+
+// The parts of the normalized representation of a PG.NUMERIC, with leading
+// zeros of `whole` and trailing zeros of `fraction` removed. Zero is never
+// negative.
+struct NormalizedParts {
+  bool nan = false;
+  bool negative = false;
+  absl::string_view whole;
+  absl::string_view fraction;
+};
+
+bool IsDigits(absl::string_view digits) {
+  return std::all_of(digits.begin(), digits.end(),
+                     [](char c) { return c >= '0' && c <= '9'; });
+}
+
+std::optional<NormalizedParts> SplitNormalized(absl::string_view normalized) {
+  NormalizedParts parts;
+  if (normalized == "NaN") {
+    parts.nan = true;
+    return parts;
+  }
+  if (!normalized.empty() &&
+      (normalized.front() == '-' || normalized.front() == '+')) {
+    parts.negative = normalized.front() == '-';
+    normalized.remove_prefix(1);
+  }
+  parts.whole = normalized;
+  size_t point = normalized.find('.');
+  if (point != absl::string_view::npos) {
+    parts.whole = normalized.substr(0, point);
+    parts.fraction = normalized.substr(point + 1);
+  }
+  if ((parts.whole.empty() && parts.fraction.empty()) ||
+      !IsDigits(parts.whole) || !IsDigits(parts.fraction)) {
+    return std::nullopt;
+  }
+  while (!parts.whole.empty() && parts.whole.front() == '0') {
+    parts.whole.remove_prefix(1);
+  }
+  while (!parts.fraction.empty() && parts.fraction.back() == '0') {
+    parts.fraction.remove_suffix(1);
+  }
+  if (parts.whole.empty() && parts.fraction.empty()) {
+    parts.negative = false;
+  }
+  return parts;
+}
+
+// Compares the magnitudes of `lhs` and `rhs`.
+int CompareMagnitudes(const NormalizedParts& lhs, const NormalizedParts& rhs) {
+  // Without leading zeros, the value with more whole digits is larger.
+  if (lhs.whole.size() != rhs.whole.size()) {
+    return lhs.whole.size() < rhs.whole.size() ? -1 : 1;
+  }
+  if (int result = lhs.whole.compare(rhs.whole); result != 0) {
+    return result < 0 ? -1 : 1;
+  }
+  // Without trailing zeros, a fraction that extends a common prefix is larger.
+  if (int result = lhs.fraction.compare(rhs.fraction); result != 0) {
+    return result < 0 ? -1 : 1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+std::optional<FixedWidthNumeric> FixedWidthNumeric::FromNormalized(
+    absl::string_view normalized) {
+  bool negative = false;
+  if (!normalized.empty() &&
+      (normalized.front() == '-' || normalized.front() == '+')) {
+    negative = normalized.front() == '-';
+    normalized.remove_prefix(1);
+  }
+  if (normalized.empty()) {
+    return std::nullopt;
+  }
+
+  absl::int128 unscaled = 0;
+  int scale = 0;
+  bool seen_point = false;
+  bool seen_digit = false;
+  for (char c : normalized) {
+    if (c == '.' && !seen_point) {
+      seen_point = true;
+      continue;
+    }
+    if (c < '0' || c > '9') {
+      // NaN, or a representation that only PostgreSQL can interpret.
+      return std::nullopt;
+    }
+    seen_digit = true;
+    if (seen_point) {
+      ++scale;
+      if (scale > kMaxDigits) {
+        return std::nullopt;
+      }
+    }
+    if (unscaled > (MaxUnscaled() - (c - '0')) / 10) {
+      return std::nullopt;
+    }
+    unscaled = unscaled * 10 + (c - '0');
+  }
+  if (!seen_digit) {
+    return std::nullopt;
+  }
+  return FixedWidthNumeric(negative ? -unscaled : unscaled, scale);
+}
+
+std::string FixedWidthNumeric::ToNormalized() const {
+  // Digits of the magnitude, least significant first, padded so that there is
+  // at least one whole digit.
+  std::string digits;
+  absl::uint128 magnitude = static_cast<absl::uint128>(Abs(unscaled_));
+  do {
+    digits.push_back(static_cast<char>('0' + static_cast<int>(magnitude % 10)));
+    magnitude /= 10;
+  } while (magnitude != 0);
+  while (digits.size() <= static_cast<size_t>(scale_)) {
+    digits.push_back('0');
+  }
+
+  std::string result;
+  result.reserve(digits.size() + 2);
+  if (unscaled_ < 0) {
+    result.push_back('-');
+  }
+  for (int i = digits.size() - 1; i >= 0; --i) {
+    result.push_back(digits[i]);
+    if (i == scale_ && i != 0) {
+      result.push_back('.');
+    }
+  }
+  return result;
+}
+
+std::optional<absl::int128> FixedWidthNumeric::UnscaledAt(int scale) const {
+  const int shift = scale - scale_;
+  if (shift == 0) {
+    return unscaled_;
+  }
+  if (Abs(unscaled_) > MaxUnscaled() / PowerOfTen(shift)) {
+    return std::nullopt;
+  }
+  return unscaled_ * PowerOfTen(shift);
+}
+
+std::optional<FixedWidthNumeric> FixedWidthNumeric::Add(
+    const FixedWidthNumeric& lhs, const FixedWidthNumeric& rhs) {
+  const int scale = std::max(lhs.scale_, rhs.scale_);
+  std::optional<absl::int128> a = lhs.UnscaledAt(scale);
+  std::optional<absl::int128> b = rhs.UnscaledAt(scale);
+  if (!a.has_value() || !b.has_value()) {
+    return std::nullopt;
+  }
+  // Both operands are within +/-MaxUnscaled(), so these checks cannot
+  // themselves overflow.
+  if ((*b > 0 && *a > MaxUnscaled() - *b) ||
+      (*b < 0 && *a < -MaxUnscaled() - *b)) {
+    return std::nullopt;
+  }
+  return FixedWidthNumeric(*a + *b, scale);
+}
+
+std::optional<FixedWidthNumeric> FixedWidthNumeric::Subtract(
+    const FixedWidthNumeric& lhs, const FixedWidthNumeric& rhs) {
+  return Add(lhs, FixedWidthNumeric(-rhs.unscaled_, rhs.scale_));
+}
+
+std::optional<FixedWidthNumeric> FixedWidthNumeric::Multiply(
+    const FixedWidthNumeric& lhs, const FixedWidthNumeric& rhs) {
+  const int scale = lhs.scale_ + rhs.scale_;
+  if (scale > kMaxDigits) {
+    return std::nullopt;
+  }
+  if (rhs.unscaled_ != 0 &&
+      Abs(lhs.unscaled_) > MaxUnscaled() / Abs(rhs.unscaled_)) {
+    return std::nullopt;
+  }
+  return FixedWidthNumeric(lhs.unscaled_ * rhs.unscaled_, scale);
+}
+
+int FixedWidthNumeric::Compare(const FixedWidthNumeric& lhs,
+                               const FixedWidthNumeric& rhs) {
+  const int scale = std::max(lhs.scale_, rhs.scale_);
+  std::optional<absl::int128> a = lhs.UnscaledAt(scale);
+  std::optional<absl::int128> b = rhs.UnscaledAt(scale);
+  // An operand that cannot be rescaled has a larger magnitude than anything
+  // that can, so its sign decides the comparison.
+  if (!a.has_value()) {
+    return lhs.unscaled_ < 0 ? -1 : 1;
+  }
+  if (!b.has_value()) {
+    return rhs.unscaled_ < 0 ? 1 : -1;
+  }
+  if (*a == *b) {
+    return 0;
+  }
+  return *a < *b ? -1 : 1;
+}
+
+std::optional<int> CompareNormalizedNumerics(absl::string_view lhs,
+                                             absl::string_view rhs) {
+  std::optional<NormalizedParts> a = SplitNormalized(lhs);
+  std::optional<NormalizedParts> b = SplitNormalized(rhs);
+  if (!a.has_value() || !b.has_value()) {
+    return std::nullopt;
+  }
+  if (a->nan || b->nan) {
+    return static_cast<int>(a->nan) - static_cast<int>(b->nan);
+  }
+  if (a->negative != b->negative) {
+    return a->negative ? -1 : 1;
+  }
+  int result = CompareMagnitudes(*a, *b);
+  return a->negative ? -result : result;
+}
+
+}  // namespace postgres_translator::spangres::datatypes::common
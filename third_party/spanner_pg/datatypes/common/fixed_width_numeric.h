@@ -0,0 +1,116 @@
+//
+// PostgreSQL is released under the PostgreSQL License, a liberal Open Source
+// license, similar to the BSD or MIT licenses.
+//
+// PostgreSQL Database Management System
+// (formerly known as Postgres, then as Postgres95)
+//
+// Portions Copyright © 1996-2020, The PostgreSQL Global Development Group
+//
+// Portions Copyright © 1994, The Regents of the University of California
+//
+// Portions Copyright 2023 Google LLC
+//
+// Permission to use, copy, modify, and distribute this software and its
+// documentation for any purpose, without fee, and without a written agreement
+// is hereby granted, provided that the above copyright notice and this
+// paragraph and the following two paragraphs appear in all copies.
+//
+// IN NO EVENT SHALL THE UNIVERSITY OF CALIFORNIA BE LIABLE TO ANY PARTY FOR
+// DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING
+// LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION,
+// EVEN IF THE UNIVERSITY OF CALIFORNIA HAS BEEN ADVISED OF THE POSSIBILITY OF
+// SUCH DAMAGE.
+//
+// THE UNIVERSITY OF CALIFORNIA SPECIFICALLY DISCLAIMS ANY WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+// FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS ON AN
+// "AS IS" BASIS, AND THE UNIVERSITY OF CALIFORNIA HAS NO OBLIGATIONS TO PROVIDE
+// MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+//------------------------------------------------------------------------------
+
+#ifndef DATATYPES_COMMON_FIXED_WIDTH_NUMERIC_H_
+#define DATATYPES_COMMON_FIXED_WIDTH_NUMERIC_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
+
+namespace postgres_translator::spangres::datatypes::common {
+
+// A PG.NUMERIC value whose digits fit in a 128-bit integer, stored as an
+// unscaled integer and a display scale (the number of fractional digits):
+// "-12.340" is {unscaled = -12340, scale = 3}.
+//
+// Arithmetic on PG.NUMERIC otherwise round-trips every operand through
+// PostgreSQL's `numeric_in`/`numeric_out` and varlena representation. Values
+// that fit here can skip PostgreSQL entirely. The operations produce the same
+// value and display scale as PostgreSQL for such values. They return
+// std::nullopt instead of a result that would not fit, so callers can fall
+// back to the PostgreSQL implementation.
+class FixedWidthNumeric {
+ public:
+  // The largest number of digits (whole and fractional) that is represented.
+  static constexpr int kMaxDigits = 38;
+
+  // Parses the normalized representation of a PG.NUMERIC (see
+  // NormalizePgNumeric). Returns std::nullopt for NaN and for values with more
+  // than kMaxDigits digits.
+  static std::optional<FixedWidthNumeric> FromNormalized(
+      absl::string_view normalized);
+
+  static FixedWidthNumeric FromInt64(int64_t value) {
+    return FixedWidthNumeric(value, /*scale=*/0);
+  }
+
+  // Returns the normalized representation, matching PostgreSQL `numeric_out`.
+  std::string ToNormalized() const;
+
+  // Scale of the result is the larger of the input scales.
+  static std::optional<FixedWidthNumeric> Add(const FixedWidthNumeric& lhs,
+                                              const FixedWidthNumeric& rhs);
+  static std::optional<FixedWidthNumeric> Subtract(
+      const FixedWidthNumeric& lhs, const FixedWidthNumeric& rhs);
+
+  // Scale of the result is the sum of the input scales.
+  static std::optional<FixedWidthNumeric> Multiply(
+      const FixedWidthNumeric& lhs, const FixedWidthNumeric& rhs);
+
+  // Returns a negative number, zero or a positive number if `lhs` is less
+  // than, equal to or greater than `rhs`. Display scale is ignored, so "1.5"
+  // and "1.50" compare equal.
+  static int Compare(const FixedWidthNumeric& lhs,
+                     const FixedWidthNumeric& rhs);
+
+  absl::int128 unscaled_value() const { return unscaled_; }
+  int scale() const { return scale_; }
+
+ private:
+  FixedWidthNumeric(absl::int128 unscaled, int scale)
+      : unscaled_(unscaled), scale_(scale) {}
+
+  // Returns `unscaled_` rescaled to `scale`, which must not be smaller than
+  // `scale_`, or std::nullopt if that has more than kMaxDigits digits.
+  std::optional<absl::int128> UnscaledAt(int scale) const;
+
+  // Invariant: |unscaled_| < 10^kMaxDigits and 0 <= scale_ <= kMaxDigits.
+  absl::int128 unscaled_;
+  int scale_;
+};
+
+// Compares the normalized representations of two PG.NUMERIC values of any
+// precision (see NormalizePgNumeric) without calling into PostgreSQL, so no PG
+// arena is needed. Returns a negative number, zero or a positive number if
+// `lhs` is less than, equal to or greater than `rhs`, with PostgreSQL's
+// ordering: display scale is ignored and NaN equals itself and sorts after
+// every other value. Returns std::nullopt if either input is not a normalized
+// representation.
+std::optional<int> CompareNormalizedNumerics(absl::string_view lhs,
+                                             absl::string_view rhs);
+
+}  // namespace postgres_translator::spangres::datatypes::common
+
+#endif  // DATATYPES_COMMON_FIXED_WIDTH_NUMERIC_H_
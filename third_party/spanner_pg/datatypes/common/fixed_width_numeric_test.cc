@@ -0,0 +1,150 @@
+//
+// PostgreSQL is released under the PostgreSQL License, a liberal Open Source
+// license, similar to the BSD or MIT licenses.
+//
+// PostgreSQL Database Management System
+// (formerly known as Postgres, then as Postgres95)
+//
+// Portions Copyright © 1996-2020, The PostgreSQL Global Development Group
+//
+// Portions Copyright © 1994, The Regents of the University of California
+//
+// Portions Copyright 2023 Google LLC
+//
+// Permission to use, copy, modify, and distribute this software and its
+// documentation for any purpose, without fee, and without a written agreement
+// is hereby granted, provided that the above copyright notice and this
+// paragraph and the following two paragraphs appear in all copies.
+//
+// IN NO EVENT SHALL THE UNIVERSITY OF CALIFORNIA BE LIABLE TO ANY PARTY FOR
+// DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING
+// LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION,
+// EVEN IF THE UNIVERSITY OF CALIFORNIA HAS BEEN ADVISED OF THE POSSIBILITY OF
+// SUCH DAMAGE.
+//
+// THE UNIVERSITY OF CALIFORNIA SPECIFICALLY DISCLAIMS ANY WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+// FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS ON AN
+// "AS IS" BASIS, AND THE UNIVERSITY OF CALIFORNIA HAS NO OBLIGATIONS TO PROVIDE
+// MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+//------------------------------------------------------------------------------
+
+#include "third_party/spanner_pg/datatypes/common/fixed_width_numeric.h"
+
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+
+namespace postgres_translator::spangres::datatypes::common {
+namespace {
+
+using ::testing::Optional;
+
+FixedWidthNumeric Parse(absl::string_view normalized) {
+  std::optional<FixedWidthNumeric> value =
+      FixedWidthNumeric::FromNormalized(normalized);
+  EXPECT_TRUE(value.has_value()) << normalized;
+  return value.value_or(FixedWidthNumeric::FromInt64(0));
+}
+
+std::optional<std::string> ToNormalized(
+    const std::optional<FixedWidthNumeric>& value) {
+  if (!value.has_value()) {
+    return std::nullopt;
+  }
+  return value->ToNormalized();
+}
+
+TEST(FixedWidthNumericTest, RoundTripsNormalizedValues) {
+  for (absl::string_view normalized :
+       {"0", "0.00", "5", "-12.340", "-0.001",
+        "12345678901234567890123456789012345678",
+        "0.12345678901234567890123456789012345678"}) {
+    EXPECT_EQ(Parse(normalized).ToNormalized(), normalized);
+  }
+  EXPECT_EQ(FixedWidthNumeric::FromInt64(-42).ToNormalized(), "-42");
+}
+
+TEST(FixedWidthNumericTest, RejectsValuesThatDoNotFit) {
+  for (absl::string_view normalized :
+       {"NaN", "", "-", ".", "1e5",
+        "123456789012345678901234567890123456789",
+        "0.000000000000000000000000000000000000001"}) {
+    EXPECT_EQ(FixedWidthNumeric::FromNormalized(normalized), std::nullopt)
+        << normalized;
+  }
+}
+
+TEST(FixedWidthNumericTest, AddUsesLargerScale) {
+  EXPECT_THAT(ToNormalized(FixedWidthNumeric::Add(Parse("1.5"), Parse("2.25"))),
+              Optional(std::string("3.75")));
+  EXPECT_THAT(
+      ToNormalized(FixedWidthNumeric::Add(Parse("-1.5"), Parse("1.5"))),
+      Optional(std::string("0.0")));
+  EXPECT_THAT(
+      ToNormalized(FixedWidthNumeric::Subtract(Parse("0.25"), Parse("0.5"))),
+      Optional(std::string("-0.25")));
+}
+
+TEST(FixedWidthNumericTest, MultiplyAddsScales) {
+  EXPECT_THAT(
+      ToNormalized(FixedWidthNumeric::Multiply(Parse("1.5"), Parse("-2.25"))),
+      Optional(std::string("-3.375")));
+  EXPECT_THAT(
+      ToNormalized(FixedWidthNumeric::Multiply(Parse("0.00"), Parse("3"))),
+      Optional(std::string("0.00")));
+}
+
+TEST(FixedWidthNumericTest, ArithmeticReportsOverflow) {
+  const FixedWidthNumeric max =
+      Parse("99999999999999999999999999999999999999");
+  EXPECT_EQ(FixedWidthNumeric::Add(max, Parse("1")), std::nullopt);
+  EXPECT_EQ(FixedWidthNumeric::Subtract(Parse("-1"), max), std::nullopt);
+  EXPECT_EQ(FixedWidthNumeric::Add(max, Parse("0.1")), std::nullopt);
+  EXPECT_EQ(FixedWidthNumeric::Multiply(max, Parse("2")), std::nullopt);
+}
+
+TEST(FixedWidthNumericTest, CompareIgnoresDisplayScale) {
+  EXPECT_EQ(FixedWidthNumeric::Compare(Parse("1.5"), Parse("1.50")), 0);
+  EXPECT_LT(FixedWidthNumeric::Compare(Parse("-2"), Parse("1.5")), 0);
+  EXPECT_GT(FixedWidthNumeric::Compare(Parse("0.11"), Parse("0.1")), 0);
+  // Rescaling the left operand overflows; its sign decides the result.
+  EXPECT_LT(
+      FixedWidthNumeric::Compare(
+          Parse("-99999999999999999999999999999999999999"), Parse("0.1")),
+      0);
+}
+
+TEST(CompareNormalizedNumericsTest, OrdersValuesOfAnyPrecision) {
+  const std::string large(60, '9');
+  EXPECT_THAT(CompareNormalizedNumerics("1.5", "1.50"), Optional(0));
+  EXPECT_THAT(CompareNormalizedNumerics("0", "-0.000"), Optional(0));
+  EXPECT_THAT(CompareNormalizedNumerics("007.10", "7.1"), Optional(0));
+  EXPECT_THAT(CompareNormalizedNumerics("1.05", "1.5"), Optional(-1));
+  EXPECT_THAT(CompareNormalizedNumerics("10", "9.999"), Optional(1));
+  EXPECT_THAT(CompareNormalizedNumerics("-10", "-9.999"), Optional(-1));
+  EXPECT_THAT(CompareNormalizedNumerics("-0.1", "0"), Optional(-1));
+  EXPECT_THAT(CompareNormalizedNumerics(large, "1" + large), Optional(-1));
+  EXPECT_THAT(CompareNormalizedNumerics("0." + large, "0." + large + "1"),
+              Optional(-1));
+  EXPECT_THAT(CompareNormalizedNumerics("-" + large, large), Optional(-1));
+}
+
+TEST(CompareNormalizedNumericsTest, SortsNaNLast) {
+  EXPECT_THAT(CompareNormalizedNumerics("NaN", "NaN"), Optional(0));
+  EXPECT_THAT(CompareNormalizedNumerics("NaN", "1"), Optional(1));
+  EXPECT_THAT(CompareNormalizedNumerics("-1", "NaN"), Optional(-1));
+}
+
+TEST(CompareNormalizedNumericsTest, RejectsInvalidRepresentations) {
+  EXPECT_EQ(CompareNormalizedNumerics("", "1"), std::nullopt);
+  EXPECT_EQ(CompareNormalizedNumerics("1", "."), std::nullopt);
+  EXPECT_EQ(CompareNormalizedNumerics("1e5", "1"), std::nullopt);
+  EXPECT_EQ(CompareNormalizedNumerics("1", "Infinity"), std::nullopt);
+}
+
+}  // namespace
+}  // namespace postgres_translator::spangres::datatypes::common
@@ -32,6 +32,7 @@
 #include "third_party/spanner_pg/datatypes/extended/pg_jsonb_type.h"
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -46,7 +47,9 @@
 #include "zetasql/public/types/value_equality_check_options.h"
 #include "zetasql/public/value.h"
 #include "zetasql/public/value_content.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/flags/flag.h"
+#include "absl/functional/function_ref.h"
 #include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -55,6 +58,7 @@
 #include "absl/strings/cord.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "third_party/spanner_pg/datatypes/common/jsonb/jsonb_parse.h"
 #include "third_party/spanner_pg/datatypes/extended/spanner_extended_type.h"
 #include "third_party/spanner_pg/interface/pg_arena.h"
@@ -95,12 +99,28 @@ class PgJsonbRef final : public CompactReferenceCounted<PgJsonbRef> {
 
   const absl::Cord& value() const { return normalized_; }
 
+  absl::StatusOr<absl::string_view> binary(
+      absl::FunctionRef<absl::StatusOr<std::string>(const absl::Cord&)>
+          encode) const {
+    absl::MutexLock lock(&binary_mu_);
+    if (!binary_.has_value()) {
+      ZETASQL_ASSIGN_OR_RETURN(binary_, encode(normalized_));
+    }
+    return *binary_;
+  }
+
+  // The cached binary encoding is not counted: it is derived data that may be
+  // added after the value has been accounted for.
   uint64_t physical_byte_size() const {
     return sizeof(PgJsonbRef) + normalized_.size() * sizeof(char);
   }
 
  private:
   const absl::Cord normalized_;
+
+  // Set at most once, so views of it stay valid for the lifetime of the ref.
+  mutable absl::Mutex binary_mu_;
+  mutable std::optional<std::string> binary_ ABSL_GUARDED_BY(binary_mu_);
 };
 
 class PgJsonbType : public SpannerExtendedType {
@@ -283,5 +303,13 @@ absl::StatusOr<absl::Cord> GetPgJsonbNormalizedValue(
   return value.extended_value().GetAs<PgJsonbRef*>()->value();
 }
 
+absl::StatusOr<absl::string_view> GetPgJsonbBinaryValue(
+    const zetasql::Value& value,
+    absl::FunctionRef<absl::StatusOr<std::string>(const absl::Cord&)> encode) {
+  ZETASQL_RET_CHECK(!value.is_null());
+  ZETASQL_RET_CHECK(value.type() == GetPgJsonbType());
+  return value.extended_value().GetAs<PgJsonbRef*>()->binary(encode);
+}
+
 }  // namespace datatypes
 }  // namespace postgres_translator::spangres
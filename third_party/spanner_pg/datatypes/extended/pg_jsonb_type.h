@@ -32,9 +32,12 @@
 #ifndef DATATYPES_EXTENDED_PG_JSONB_TYPE_H_
 #define DATATYPES_EXTENDED_PG_JSONB_TYPE_H_
 
+#include <string>
+
 #include "zetasql/public/types/type.h"
 #include "zetasql/public/value.h"
 #include "absl/flags/declare.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/string_view.h"
@@ -71,6 +74,16 @@ zetasql::Value CreatePgJsonbValueFromNormalized(
 absl::StatusOr<absl::Cord> GetPgJsonbNormalizedValue(
     const zetasql::Value& value);
 
+// Retrieves a binary encoding of the PG.JSONB `value`, computed from its
+// normalized representation by `encode` the first time it is requested. The
+// encoding is cached with the value and shared by all copies of it, so that
+// operators applied repeatedly to the same document parse its text only once.
+// Returns error if `value` doesn't contain non-NULL value of PG.JSONB or if
+// `encode` fails; failures are not cached.
+absl::StatusOr<absl::string_view> GetPgJsonbBinaryValue(
+    const zetasql::Value& value,
+    absl::FunctionRef<absl::StatusOr<std::string>(const absl::Cord&)> encode);
+
 }  // namespace datatypes
 }  // namespace postgres_translator::spangres
 #endif  // DATATYPES_EXTENDED_PG_JSONB_TYPE_H_
@@ -44,7 +44,9 @@ const zetasql::Function* GetInt64ToPgNumericConversion() {
                               zetasql::Function::SCALAR,
                               /*function_signatures=*/{},
                               zetasql::FunctionOptions().set_evaluator(
-                                  PGFunctionEvaluator(EvalCastToNumeric)));
+                                  PGFunctionEvaluatorWithFastPath(
+                                      FastEvalCastToNumeric,
+                                      EvalCastToNumeric)));
   return kInt64ToPgNumericConv;
 }
 
@@ -84,7 +86,9 @@ const zetasql::Function* GetPgNumericToInt64Conversion() {
                               zetasql::Function::SCALAR,
                               /*function_signatures=*/{},
                               zetasql::FunctionOptions().set_evaluator(
-                                  PGFunctionEvaluator(EvalCastNumericToInt64)));
+                                  PGFunctionEvaluatorWithFastPath(
+                                      FastEvalCastNumericToInt64,
+                                      EvalCastNumericToInt64)));
   return kPgNumericToInt64Conv;
 }
 
@@ -94,7 +98,7 @@ const zetasql::Function* GetPgNumericToDoubleConversion() {
           "pg_numeric_to_double_conv", "spanner", zetasql::Function::SCALAR,
           /*function_signatures=*/{},
           zetasql::FunctionOptions().set_evaluator(
-              PGFunctionEvaluator(EvalCastNumericToDouble)));
+              zetasql::FunctionEvaluator(EvalCastNumericToDouble)));
   return kPgNumericToDoubleConv;
 }
 
@@ -104,7 +108,8 @@ const zetasql::Function* GetPgNumericToFloatConversion() {
                               zetasql::Function::SCALAR,
                               /*function_signatures=*/{},
                               zetasql::FunctionOptions().set_evaluator(
-                                  PGFunctionEvaluator(EvalCastNumericToFloat)));
+                                  zetasql::FunctionEvaluator(
+                                      EvalCastNumericToFloat)));
   return kPgNumericToFloatConv;
 }
 
@@ -114,7 +119,7 @@ const zetasql::Function* GetPgNumericToStringConversion() {
           "pg_numeric_to_string_conv", "spanner", zetasql::Function::SCALAR,
           /*function_signatures=*/{},
           zetasql::FunctionOptions().set_evaluator(
-              PGFunctionEvaluator(EvalCastNumericToString)));
+              zetasql::FunctionEvaluator(EvalCastNumericToString)));
   return kPgNumericToStringConv;
 }
 
@@ -32,6 +32,8 @@
 #include "third_party/spanner_pg/datatypes/extended/pg_numeric_type.h"
 
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -55,6 +57,7 @@
 #include "absl/strings/cord.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "third_party/spanner_pg/datatypes/common/fixed_width_numeric.h"
 #include "third_party/spanner_pg/datatypes/common/pg_numeric_parse.h"
 #include "third_party/spanner_pg/datatypes/extended/spanner_extended_type.h"
 #include "third_party/spanner_pg/interface/pg_arena.h"
@@ -231,7 +234,10 @@ class PgNumericType : public SpannerExtendedType {
   absl::StatusOr<int32_t> CollatedCompare(
       const absl::Cord& lhs_normalized,
       const absl::Cord& rhs_normalized) const {
-    // This implementation calls PG `numeric_cmp` to compare the input numerics.
+    // This implementation orders the normalized representations natively, so
+    // comparisons (e.g. of keys while committing) do not need a PG arena. PG
+    // `numeric_cmp` is only called for representations that are not
+    // normalized.
 
     // Convert absl::Cord to std::string
     std::string lhs_normalized_str;
@@ -241,6 +247,19 @@ class PgNumericType : public SpannerExtendedType {
     rhs_normalized_str.reserve(rhs_normalized.size());
     absl::CopyCordToString(rhs_normalized, &rhs_normalized_str);
 
+    std::optional<int> native_result = common::CompareNormalizedNumerics(
+        lhs_normalized_str, rhs_normalized_str);
+    if (native_result.has_value()) {
+      return *native_result;
+    }
+
+    // Only create a PG arena if the calling thread does not have one yet.
+    std::unique_ptr<postgres_translator::interfaces::PGArena> pg_arena;
+    if (CurrentMemoryContext == nullptr) {
+      ZETASQL_ASSIGN_OR_RETURN(pg_arena,
+                       postgres_translator::interfaces::CreatePGArena(nullptr));
+    }
+
     // Create numeric datums from `lhs_normalized_str` and `rhs_normalized_str`
     // by indirectly calling PG function `numeric_in`:
     // - lhs_normalized_str/rhs_normalized_str: numeric datum input
@@ -359,6 +378,13 @@ absl::StatusOr<zetasql::Value> CreatePgNumericValue(
       zetasql::ValueContent::Create(new PgNumericRef(normalized)));
 }
 
+zetasql::Value CreatePgNumericValueFromNormalized(
+    const absl::Cord& normalized_numeric) {
+  return zetasql::Value::Extended(
+      GetPgNumericType(),
+      zetasql::ValueContent::Create(new PgNumericRef(normalized_numeric)));
+}
+
 absl::StatusOr<zetasql::Value> CreatePgNumericValueWithMemoryContext(
     absl::string_view numeric_string) {
   ZETASQL_ASSIGN_OR_RETURN(
@@ -54,6 +54,12 @@ const zetasql::ArrayType* GetPgNumericArrayType();
 absl::StatusOr<zetasql::Value> CreatePgNumericValue(
     absl::string_view readable_numeric);
 
+// Create a zetasql::Value from the normalized input ASCII string format
+// `normalized_numeric`, as produced by NormalizePgNumeric. Does not call PG
+// code.
+zetasql::Value CreatePgNumericValueFromNormalized(
+    const absl::Cord& normalized_numeric);
+
 // Create PG.NUMERIC value in a valid memory context which is required for
 // calling PG code. This function is intended to be used in tests where a memory
 // context is sometimes not initialized.
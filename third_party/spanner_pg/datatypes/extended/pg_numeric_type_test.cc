@@ -47,6 +47,7 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "absl/status/status.h"
+#include "absl/strings/cord.h"
 #include "absl/strings/string_view.h"
 #include "third_party/spanner_pg/datatypes/extended/spanner_extended_type.h"
 #include "third_party/spanner_pg/util/valid_memory_context_fixture.h"
@@ -61,6 +62,8 @@ using ::zetasql::TypeModifiers;
 using ::zetasql::TypeParameters;
 using ::zetasql::TypeParameterValue;
 using ::postgres_translator::spangres::datatypes::CreatePgNumericValue;
+using ::postgres_translator::spangres::datatypes::
+    CreatePgNumericValueFromNormalized;
 using ::postgres_translator::spangres::datatypes::GetPgNumericArrayType;
 using ::postgres_translator::spangres::datatypes::GetPgNumericType;
 using ::postgres_translator::spangres::datatypes::SpannerExtendedType;
@@ -218,6 +221,31 @@ TEST_F(PgNumericTypeTest, ValueComparison) {
   EXPECT_FALSE(smallest_numeric.Equals(numeric));
 }
 
+TEST_F(PgNumericTypeTest, ValueComparisonBeyondFixedWidth) {
+  // 40 significant digits, which is compared by PG `numeric_cmp`.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      zetasql::Value wide_numeric,
+      CreatePgNumericValue("1234567890123456789012345678901234567890"));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(zetasql::Value numeric, CreatePgNumericValue("1.5"));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(zetasql::Value same_numeric,
+                       CreatePgNumericValue("1.50"));
+
+  EXPECT_TRUE(numeric.LessThan(wide_numeric));
+  EXPECT_FALSE(wide_numeric.LessThan(numeric));
+  EXPECT_FALSE(wide_numeric.Equals(numeric));
+  EXPECT_TRUE(numeric.Equals(same_numeric));
+}
+
+TEST_F(PgNumericTypeTest, CreateFromNormalized) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(zetasql::Value expected,
+                       CreatePgNumericValue("-12.340"));
+  zetasql::Value numeric =
+      CreatePgNumericValueFromNormalized(absl::Cord("-12.340"));
+  EXPECT_TRUE(numeric.type()->Equals(GetPgNumericType()));
+  EXPECT_TRUE(numeric.Equals(expected));
+  EXPECT_EQ(numeric.DebugString(), expected.DebugString());
+}
+
 TEST_F(PgNumericTypeTest, FixedPrecisionNumericErrorCases) {
   // store values between -0.099 and 0.099
   EXPECT_THAT(postgres_translator::spangres::datatypes::
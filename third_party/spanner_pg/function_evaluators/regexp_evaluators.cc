@@ -37,6 +37,7 @@
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "third_party/spanner_pg/postgres_includes/all.h"
@@ -51,9 +52,36 @@ inline constexpr Datum kNullDatum = 0;
 
 void CleanupRegexCache() { CleanupCompiledRegexCache(); }
 
+namespace {
+
+// Frees the thread's compiled regex cache when the thread exits. The cache is
+// kept across calls (and across PG arenas) so that a pattern is compiled once
+// per thread rather than once per row; see RE_compile_and_cache.
+class RegexCacheThreadCleanup {
+ public:
+  ~RegexCacheThreadCleanup() {
+    CleanupCompiledRegexCache();
+    // Deleted cache entries may have been kept in the thread's AllocSet
+    // freelists.
+    absl::Status status = CheckedPgAsetDeleteFreelists();
+    if (!status.ok()) {
+      ABSL_LOG(ERROR) << "Regex cache cleanup failed: " << status.message();
+    }
+  }
+
+  // Makes sure that this thread's instance is constructed, so that it is
+  // destroyed when the thread exits.
+  void Register() {}
+};
+
+thread_local RegexCacheThreadCleanup regex_cache_thread_cleanup;
+
+}  // namespace
+
 static absl::StatusOr<std::unique_ptr<std::vector<std::string>>>
 RegexpSplitToArray(absl::string_view string, absl::string_view pattern,
                    std::optional<absl::string_view> flags) {
+  regex_cache_thread_cleanup.Register();
   ZETASQL_ASSIGN_OR_RETURN(
       Datum string_in_datum,
       CheckedPgStringToDatum(std::string(string).c_str(), TEXTOID));
@@ -125,6 +153,7 @@ absl::StatusOr<std::unique_ptr<std::vector<std::string>>> RegexpSplitToArray(
 static absl::StatusOr<std::unique_ptr<std::vector<std::optional<std::string>>>>
 RegexpMatch(absl::string_view string, absl::string_view pattern,
             std::optional<absl::string_view> flags) {
+  regex_cache_thread_cleanup.Register();
   ZETASQL_ASSIGN_OR_RETURN(
       Datum string_in_datum,
       CheckedPgStringToDatum(std::string(string).c_str(), TEXTOID));
@@ -196,6 +225,7 @@ RegexpMatch(absl::string_view string, absl::string_view pattern,
 
 absl::StatusOr<bool> Textregexeq(absl::string_view string,
                                  absl::string_view pattern) {
+  regex_cache_thread_cleanup.Register();
   ZETASQL_ASSIGN_OR_RETURN(
       Datum string_in_datum,
       CheckedPgStringToDatum(std::string(string).c_str(), TEXTOID));
@@ -212,6 +242,7 @@ absl::StatusOr<bool> Textregexeq(absl::string_view string,
 
 absl::StatusOr<bool> Textregexne(absl::string_view string,
                                  absl::string_view pattern) {
+  regex_cache_thread_cleanup.Register();
   ZETASQL_ASSIGN_OR_RETURN(
       Datum string_in_datum,
       CheckedPgStringToDatum(std::string(string).c_str(), TEXTOID));
@@ -229,6 +260,7 @@ absl::StatusOr<bool> Textregexne(absl::string_view string,
 
 absl::StatusOr<std::unique_ptr<std::string>> Textregexsubstr(
     absl::string_view string, absl::string_view pattern) {
+  regex_cache_thread_cleanup.Register();
   ZETASQL_ASSIGN_OR_RETURN(
       Datum string_in_datum,
       CheckedPgStringToDatum(std::string(string).c_str(), TEXTOID));
@@ -252,6 +284,7 @@ absl::StatusOr<std::unique_ptr<std::string>> Textregexsubstr(
 absl::StatusOr<std::string> Textregexreplace(
     absl::string_view source, absl::string_view pattern,
     absl::string_view replacement, std::optional<absl::string_view> flags) {
+  regex_cache_thread_cleanup.Register();
   ZETASQL_ASSIGN_OR_RETURN(
       Datum source_in_datum,
       CheckedPgStringToDatum(std::string(source).c_str(), TEXTOID));
@@ -32,6 +32,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
+#include "absl/strings/str_cat.h"
 #include "third_party/spanner_pg/function_evaluators/tests/test_base.h"
 #include "third_party/spanner_pg/interface/regexp_evaluators.h"
 
@@ -66,6 +67,31 @@ TEST_F(TextregexeqTest, ReturnsFalseWhenExpressionDoesNotMatchRegex) {
   EXPECT_THAT(Textregexeq("", " "), IsOkAndHolds(IsFalse()));
 }
 
+// Each iteration runs in a new PG arena, so the cached compiled regexes must
+// not depend on the arena that compiled them.
+TEST(TextregexeqCacheTest, ReusesCompiledRegexAcrossPgArenas) {
+  for (int i = 0; i < 3; ++i) {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(auto pg_arena, SetUpPgMemoryArena());
+    EXPECT_THAT(Textregexeq("abcde123", "[0-9]+"), IsOkAndHolds(IsTrue()));
+    EXPECT_THAT(Textregexeq("abcde", "[0-9]+"), IsOkAndHolds(IsFalse()));
+  }
+  CleanupRegexCache();
+}
+
+TEST(TextregexeqCacheTest, EvictsLeastRecentlyUsedRegexes) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto pg_arena, SetUpPgMemoryArena());
+  // More distinct patterns than the cache holds.
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(Textregexeq(absl::StrCat("x", i, "y"), absl::StrCat("^x", i)),
+                IsOkAndHolds(IsTrue()));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(Textregexeq(absl::StrCat("x", i), absl::StrCat("^x", i, "y")),
+                IsOkAndHolds(IsFalse()));
+  }
+  CleanupRegexCache();
+}
+
 // ---- Parameterized tests
 // These tests exercise regression scenarios in PostgreSQL
 
@@ -40,6 +40,7 @@
 #include "third_party/spanner_pg/interface/parser_interface.h"
 #include "third_party/spanner_pg/interface/parser_output.h"
 #include "third_party/spanner_pg/interface/pg_arena.h"
+#include "third_party/spanner_pg/shims/memory_context_manager.h"
 #include "third_party/spanner_pg/shims/memory_context_pg_arena.h"
 #include "third_party/spanner_pg/shims/memory_reservation_holder.h"
 #include "third_party/spanner_pg/shims/stub_memory_reservation_manager.h"
@@ -79,6 +80,24 @@ TEST_F(ParserWithoutSerializationTest,
                        HasSubstr("invalid Unicode escape value")));
 }
 
+TEST_F(ParserWithoutSerializationTest,
+       KeepsWarmMemoryContextBetweenStatements) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(interfaces::ParserInterface * parser,
+                       parser_.GetParser());
+  {
+    interfaces::ParserSingleOutput output(parser->Parse("select 1"));
+    ZETASQL_EXPECT_OK(output.output());
+    EXPECT_FALSE(MemoryContextManager::HasPooledContext());
+  }
+  // Releasing the output resets the thread's context and keeps it for the
+  // next statement parsed on this thread.
+  EXPECT_TRUE(MemoryContextManager::HasPooledContext());
+
+  interfaces::ParserSingleOutput output(parser->Parse("select 2"));
+  ZETASQL_EXPECT_OK(output.output());
+  EXPECT_FALSE(MemoryContextManager::HasPooledContext());
+}
+
 }  // namespace
 
 }  // namespace spangres
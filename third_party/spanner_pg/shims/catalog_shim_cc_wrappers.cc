@@ -33,6 +33,7 @@
 
 #include <cstring>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "zetasql/public/catalog.h"
@@ -151,12 +152,7 @@ absl::StatusOr<RangeTblEntry*> AddRangeTableEntryByOidCpp(ParseState* pstate,
 static absl::StatusOr<const zetasql::Table*> GetTableByOid(Oid table_oid) {
   CatalogAdapter* catalog_adapter;
   ZETASQL_ASSIGN_OR_RETURN(catalog_adapter, GetCatalogAdapter());
-  ZETASQL_ASSIGN_OR_RETURN(TableName table_name,
-                   catalog_adapter->GetTableNameFromOid(table_oid));
-  const zetasql::Table* table;
-  ZETASQL_RET_CHECK_OK(catalog_adapter->GetEngineUserCatalog()->FindTable(
-      table_name.AsSpan(), &table));
-  return table;
+  return catalog_adapter->GetTableFromOid(table_oid);
 }
 
 // C++ helper to GetAttributeNameC and other similar functions in this file.
@@ -315,12 +311,8 @@ static absl::Status ExpandRelationCpp(Oid relid, Alias* eref, int rtindex,
     return absl::InternalError(
         "Googlesql catalog not initialized on this thread.");
   }
-  ZETASQL_ASSIGN_OR_RETURN(TableName table_name,
-                   catalog_adapter->GetTableNameFromOid(relid));
-  const zetasql::Table* user_table = nullptr;
-  ZETASQL_RETURN_IF_ERROR(catalog->FindTable(table_name.AsSpan(), &user_table));
-  ZETASQL_RET_CHECK_NE(user_table, nullptr)
-      << "User table " << table_name << " not found.";
+  ZETASQL_ASSIGN_OR_RETURN(const zetasql::Table* user_table,
+                   catalog_adapter->GetTableFromOid(relid));
 
   // Also iterate through eref if one is provided.
   ListCell* aliascell = list_head(eref->colnames);
@@ -424,9 +416,8 @@ static absl::StatusOr<List*> ExpandNSItemVarsForJoinCpp(
     } else {
       RangeTblEntry* rte = rt_fetch(varno, rtable);
       if (rte->rtekind == RTE_RELATION) {
-        ZETASQL_RETURN_IF_ERROR(catalog_adapter->GetEngineUserCatalog()->FindTable(
-            catalog_adapter->GetTableNameFromOid(rte->relid)->AsSpan(),
-            &table));
+        ZETASQL_ASSIGN_OR_RETURN(table,
+                         catalog_adapter->GetTableFromOid(rte->relid));
       }
       // Store the mapping whether the rte is a relation or not.
       varno_to_table_map[varno] = table;
@@ -548,8 +539,7 @@ static absl::StatusOr<std::vector<const FormData_pg_proc*>> BuildPgProcsFromTVF(
 }
 
 // Find functions in the EngineUserCatalog that match the given name and return
-// them as an array of FormData_pg_proc representations for consumption by the
-// PG analyzer.
+// them as FormData_pg_proc representations for consumption by the PG analyzer.
 //
 // ONLY UDFs ARE SUPPORTED. This avoids duplicate entries for builtin functions
 // that may appear in both catalogs. Builtin functions should be added to the
@@ -560,17 +550,8 @@ static absl::StatusOr<std::vector<const FormData_pg_proc*>> BuildPgProcsFromTVF(
 //
 // Conforming to PG's behavior, googlesql functions with multiple signatures
 // are represented as multiple (overloaded) pg_procs.
-//
-// This is a complement to GetProcsByNameFromBootstrapCatalog.
-static absl::Status GetProcsByNameFromUserCatalog(
-    const char* name, const FormData_pg_proc*** outlist, size_t* outcount) {
-  // Initialize outargs for early return.
-  *outlist = nullptr;
-  *outcount = 0;
-  std::vector<const FormData_pg_proc*> found_procs;
-
-  CatalogAdapter* adapter;
-  ZETASQL_ASSIGN_OR_RETURN(adapter, GetCatalogAdapter());
+static absl::StatusOr<std::vector<const FormData_pg_proc*>>
+FindProcsByNameInUserCatalog(const char* name, CatalogAdapter* adapter) {
   EngineUserCatalog* catalog = adapter->GetEngineUserCatalog();
 
   // Get each matching function and add it to our output.
@@ -581,23 +562,46 @@ static absl::Status GetProcsByNameFromUserCatalog(
   // NotFound is fine. Just swallow it and return an empty list. Any other error
   // is unexpected.
   if (absl::IsNotFound(status)) {
-    return absl::OkStatus();
+    return std::vector<const FormData_pg_proc*>();
   } else if (!status.ok()) {
     return status;
   } else if (tvf->Name() != name) {
     // Treat case mismatch as any other not found case (no error, 0 count).
-    return absl::OkStatus();
+    return std::vector<const FormData_pg_proc*>();
   }
+  return BuildPgProcsFromTVF(tvf, adapter);
+}
+
+// Returns the FindProcsByNameInUserCatalog results for the given name as an
+// array. Results are cached in the CatalogAdapter, so each name is looked up in
+// the user catalog (and each UDF's pg_proc is generated) once per translation.
+//
+// This is a complement to GetProcsByNameFromBootstrapCatalog.
+static absl::Status GetProcsByNameFromUserCatalog(
+    const char* name, const FormData_pg_proc*** outlist, size_t* outcount) {
+  // Initialize outargs for early return.
+  *outlist = nullptr;
+  *outcount = 0;
 
-  ZETASQL_ASSIGN_OR_RETURN(std::vector<const FormData_pg_proc*> new_procs,
-                   BuildPgProcsFromTVF(tvf, adapter));
-  found_procs.insert(found_procs.end(), new_procs.begin(), new_procs.end());
+  CatalogAdapter* adapter;
+  ZETASQL_ASSIGN_OR_RETURN(adapter, GetCatalogAdapter());
+  const std::vector<const FormData_pg_proc*>* found_procs =
+      adapter->GetCachedUDFProcsByName(name);
+  if (found_procs == nullptr) {
+    ZETASQL_ASSIGN_OR_RETURN(std::vector<const FormData_pg_proc*> new_procs,
+                     FindProcsByNameInUserCatalog(name, adapter));
+    adapter->CacheUDFProcsByName(name, std::move(new_procs));
+    found_procs = adapter->GetCachedUDFProcsByName(name);
+  }
+  if (found_procs->empty()) {
+    return absl::OkStatus();
+  }
 
   // Copy our results into the output.
-  *outcount = found_procs.size();
-  size_t outsize = sizeof(FormData_pg_proc*) * found_procs.size();
+  *outcount = found_procs->size();
+  size_t outsize = sizeof(FormData_pg_proc*) * found_procs->size();
   *outlist = reinterpret_cast<const FormData_pg_proc**>(palloc(outsize));
-  memcpy(*outlist, found_procs.data(), outsize);
+  memcpy(*outlist, found_procs->data(), outsize);
   return absl::OkStatus();
 }
 
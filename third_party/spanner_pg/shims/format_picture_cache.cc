@@ -0,0 +1,96 @@
+//
+// PostgreSQL is released under the PostgreSQL License, a liberal Open Source
+// license, similar to the BSD or MIT licenses.
+//
+// PostgreSQL Database Management System
+// (formerly known as Postgres, then as Postgres95)
+//
+// Portions Copyright © 1996-2020, The PostgreSQL Global Development Group
+//
+// Portions Copyright © 1994, The Regents of the University of California
+//
+// Portions Copyright 2023 Google LLC
+//
+// Permission to use, copy, modify, and distribute this software and its
+// documentation for any purpose, without fee, and without a written agreement
+// is hereby granted, provided that the above copyright notice and this
+// paragraph and the following two paragraphs appear in all copies.
+//
+// IN NO EVENT SHALL THE UNIVERSITY OF CALIFORNIA BE LIABLE TO ANY PARTY FOR
+// DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING
+// LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION,
+// EVEN IF THE UNIVERSITY OF CALIFORNIA HAS BEEN ADVISED OF THE POSSIBILITY OF
+// SUCH DAMAGE.
+//
+// THE UNIVERSITY OF CALIFORNIA SPECIFICALLY DISCLAIMS ANY WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+// FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS ON AN
+// "AS IS" BASIS, AND THE UNIVERSITY OF CALIFORNIA HAS NO OBLIGATIONS TO PROVIDE
+// MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+//------------------------------------------------------------------------------
+
+// This is a CPP file rather than a C file so that the cache can use absl's
+// thread-safe containers; it is called from `formatting.c`.
+#include "third_party/spanner_pg/shims/format_picture_cache.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include <cstdlib>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace {
+
+// Format pictures come from user queries, so the number of distinct ones is
+// unbounded. Once this many are shared, new pictures only use PostgreSQL's
+// thread-local cache.
+constexpr int kMaxSharedFormatPictures = 256;
+constexpr int kNumFormatPictureKinds = 3;
+
+ABSL_CONST_INIT absl::Mutex shared_format_pictures_mu(absl::kConstInit);
+int num_shared_format_pictures ABSL_GUARDED_BY(shared_format_pictures_mu) = 0;
+absl::flat_hash_map<std::string, const void*>* shared_format_pictures
+    ABSL_GUARDED_BY(shared_format_pictures_mu) = nullptr;
+
+}  // namespace
+
+const void* GetSharedFormatPicture(FormatPictureKind kind, const char* str) {
+  absl::ReaderMutexLock lock(&shared_format_pictures_mu);
+  if (shared_format_pictures == nullptr) {
+    return nullptr;
+  }
+  const auto& pictures = shared_format_pictures[kind];
+  auto it = pictures.find(absl::string_view(str));
+  return it == pictures.end() ? nullptr : it->second;
+}
+
+const void* ShareFormatPicture(FormatPictureKind kind, const char* str,
+                               const void* entry, size_t size) {
+  absl::MutexLock lock(&shared_format_pictures_mu);
+  if (shared_format_pictures == nullptr) {
+    shared_format_pictures =
+        new absl::flat_hash_map<std::string,
+                                const void*>[kNumFormatPictureKinds];
+  }
+  auto& pictures = shared_format_pictures[kind];
+  auto it = pictures.find(absl::string_view(str));
+  if (it != pictures.end()) {
+    return it->second;
+  }
+  if (num_shared_format_pictures >= kMaxSharedFormatPictures) {
+    return nullptr;
+  }
+  void* copy = std::malloc(size);
+  if (copy == nullptr) {
+    return nullptr;
+  }
+  memcpy(copy, entry, size);
+  pictures.emplace(str, copy);
+  ++num_shared_format_pictures;
+  return copy;
+}
@@ -0,0 +1,71 @@
+//
+// PostgreSQL is released under the PostgreSQL License, a liberal Open Source
+// license, similar to the BSD or MIT licenses.
+//
+// PostgreSQL Database Management System
+// (formerly known as Postgres, then as Postgres95)
+//
+// Portions Copyright © 1996-2020, The PostgreSQL Global Development Group
+//
+// Portions Copyright © 1994, The Regents of the University of California
+//
+// Portions Copyright 2023 Google LLC
+//
+// Permission to use, copy, modify, and distribute this software and its
+// documentation for any purpose, without fee, and without a written agreement
+// is hereby granted, provided that the above copyright notice and this
+// paragraph and the following two paragraphs appear in all copies.
+//
+// IN NO EVENT SHALL THE UNIVERSITY OF CALIFORNIA BE LIABLE TO ANY PARTY FOR
+// DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING
+// LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION,
+// EVEN IF THE UNIVERSITY OF CALIFORNIA HAS BEEN ADVISED OF THE POSSIBILITY OF
+// SUCH DAMAGE.
+//
+// THE UNIVERSITY OF CALIFORNIA SPECIFICALLY DISCLAIMS ANY WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+// FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS ON AN
+// "AS IS" BASIS, AND THE UNIVERSITY OF CALIFORNIA HAS NO OBLIGATIONS TO PROVIDE
+// MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+//------------------------------------------------------------------------------
+
+#ifndef SHIMS_FORMAT_PICTURE_CACHE_H_
+#define SHIMS_FORMAT_PICTURE_CACHE_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Kinds of format pictures parsed by `formatting.c`. Each kind has its own
+// namespace of format strings.
+typedef enum FormatPictureKind {
+  FORMAT_PICTURE_DATETIME = 0,
+  FORMAT_PICTURE_DATETIME_STD = 1,
+  FORMAT_PICTURE_NUMBER = 2,
+} FormatPictureKind;
+
+// Process-wide cache of parsed `to_char`/`to_timestamp`/`to_number` format
+// pictures. PostgreSQL's own caches are thread-local and allocated in the
+// current memory context, so they are dropped after every function evaluation.
+// Entries in this cache are copies made outside of any memory context; they are
+// immutable once shared, are never freed, and may be read by any thread without
+// synchronization. Both functions are thread safe.
+
+// Returns the shared copy of the parsed format picture `str` of `kind`, or NULL
+// if it has not been shared.
+extern const void* GetSharedFormatPicture(FormatPictureKind kind,
+                                          const char* str);
+
+// Shares a copy of the `size` bytes of the fully parsed `entry` for the format
+// picture `str` of `kind`. Returns the shared copy, which may come from another
+// thread that shared the same picture first, or NULL if the cache is full.
+extern const void* ShareFormatPicture(FormatPictureKind kind, const char* str,
+                                      const void* entry, size_t size);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // SHIMS_FORMAT_PICTURE_CACHE_H_
@@ -0,0 +1,112 @@
+//
+// PostgreSQL is released under the PostgreSQL License, a liberal Open Source
+// license, similar to the BSD or MIT licenses.
+//
+// PostgreSQL Database Management System
+// (formerly known as Postgres, then as Postgres95)
+//
+// Portions Copyright © 1996-2020, The PostgreSQL Global Development Group
+//
+// Portions Copyright © 1994, The Regents of the University of California
+//
+// Portions Copyright 2023 Google LLC
+//
+// Permission to use, copy, modify, and distribute this software and its
+// documentation for any purpose, without fee, and without a written agreement
+// is hereby granted, provided that the above copyright notice and this
+// paragraph and the following two paragraphs appear in all copies.
+//
+// IN NO EVENT SHALL THE UNIVERSITY OF CALIFORNIA BE LIABLE TO ANY PARTY FOR
+// DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING
+// LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION,
+// EVEN IF THE UNIVERSITY OF CALIFORNIA HAS BEEN ADVISED OF THE POSSIBILITY OF
+// SUCH DAMAGE.
+//
+// THE UNIVERSITY OF CALIFORNIA SPECIFICALLY DISCLAIMS ANY WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+// FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS ON AN
+// "AS IS" BASIS, AND THE UNIVERSITY OF CALIFORNIA HAS NO OBLIGATIONS TO PROVIDE
+// MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+//------------------------------------------------------------------------------
+
+#include "third_party/spanner_pg/shims/format_picture_cache.h"
+
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+struct TestPicture {
+  int value;
+};
+
+TEST(FormatPictureCacheTest, ReturnsNullForUnsharedPicture) {
+  EXPECT_EQ(GetSharedFormatPicture(FORMAT_PICTURE_DATETIME, "unshared"),
+            nullptr);
+}
+
+TEST(FormatPictureCacheTest, SharesCopyOfPicture) {
+  TestPicture picture{.value = 1};
+  const void* shared = ShareFormatPicture(FORMAT_PICTURE_NUMBER, "9999",
+                                          &picture, sizeof(picture));
+  ASSERT_NE(shared, nullptr);
+  EXPECT_NE(shared, &picture);
+  picture.value = 2;
+  EXPECT_EQ(static_cast<const TestPicture*>(shared)->value, 1);
+  EXPECT_EQ(GetSharedFormatPicture(FORMAT_PICTURE_NUMBER, "9999"), shared);
+
+  // Sharing the same picture again keeps the first copy.
+  EXPECT_EQ(ShareFormatPicture(FORMAT_PICTURE_NUMBER, "9999", &picture,
+                               sizeof(picture)),
+            shared);
+  EXPECT_EQ(static_cast<const TestPicture*>(shared)->value, 1);
+}
+
+TEST(FormatPictureCacheTest, KindsAreSeparate) {
+  TestPicture picture{.value = 3};
+  const void* shared = ShareFormatPicture(FORMAT_PICTURE_DATETIME, "YYYY",
+                                          &picture, sizeof(picture));
+  ASSERT_NE(shared, nullptr);
+  EXPECT_EQ(GetSharedFormatPicture(FORMAT_PICTURE_DATETIME_STD, "YYYY"),
+            nullptr);
+  EXPECT_EQ(GetSharedFormatPicture(FORMAT_PICTURE_NUMBER, "YYYY"), nullptr);
+}
+
+TEST(FormatPictureCacheTest, SharedAcrossThreads) {
+  TestPicture picture{.value = 4};
+  std::vector<const void*> shared(8);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < shared.size(); ++i) {
+    threads.emplace_back([&picture, &shared, i] {
+      shared[i] = ShareFormatPicture(FORMAT_PICTURE_DATETIME, "HH24:MI:SS",
+                                     &picture, sizeof(picture));
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  ASSERT_NE(shared[0], nullptr);
+  EXPECT_THAT(shared, testing::Each(shared[0]));
+}
+
+TEST(FormatPictureCacheTest, StopsSharingWhenFull) {
+  TestPicture picture{.value = 5};
+  const void* shared = nullptr;
+  int num_shared = 0;
+  do {
+    shared = ShareFormatPicture(FORMAT_PICTURE_DATETIME_STD,
+                                std::to_string(num_shared).c_str(), &picture,
+                                sizeof(picture));
+  } while (shared != nullptr && ++num_shared < 1000);
+  EXPECT_LT(num_shared, 1000);
+  EXPECT_EQ(
+      GetSharedFormatPicture(FORMAT_PICTURE_DATETIME_STD,
+                             std::to_string(num_shared).c_str()),
+      nullptr);
+}
+
+}  // namespace
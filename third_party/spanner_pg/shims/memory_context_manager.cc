@@ -31,7 +31,11 @@
 
 #include "third_party/spanner_pg/shims/memory_context_manager.h"
 
+#include <cstdint>
+#include <utility>
+
 #include "zetasql/base/logging.h"
+#include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
@@ -42,6 +46,11 @@
 #include "zetasql/base/ret_check.h"
 #include "zetasql/base/status_builder.h"
 
+ABSL_FLAG(int64_t, spangres_pooled_memory_context_max_bytes, 1 << 20,
+          "Memory contexts released with at most this many bytes allocated are "
+          "reset and kept for the next memory context initialized on the same "
+          "thread instead of being deleted. Larger contexts are deleted to "
+          "return their memory. 0 disables reuse.");
 
 namespace postgres_translator {
 
@@ -73,6 +82,12 @@ absl::StatusOr<ActiveMemoryContext> MemoryContextManager::Init(
       << "Memory context already present in slot.";
   ZETASQL_RET_CHECK_EQ(TopMemoryContext, nullptr)
       << "Memory context already present in top slot.";
+  if (MemoryContext pooled = pooled_memory_context.Take(); pooled != nullptr) {
+    pooled->name = name;
+    CurrentMemoryContext = pooled;
+    TopMemoryContext = pooled;
+    return ActiveMemoryContext();
+  }
   ZETASQL_ASSIGN_OR_RETURN(CurrentMemoryContext, CreateDefaultMemoryContext(name),
                    _.With(FailedMemoryContextCreation));
   TopMemoryContext = CurrentMemoryContext;
@@ -91,6 +106,58 @@ static absl::Status DeleteCacheMemoryContext() {
   return absl::OkStatus();
 }
 
+// Deletes the context in the thread's slots, see MemoryContextManager::Clear.
+static absl::Status DeleteCurrentMemoryContext() {
+  ZETASQL_RET_CHECK_NE(CurrentMemoryContext, nullptr) << "No memory context in slot.";
+
+  ZETASQL_RET_CHECK_OK(DeleteCacheMemoryContext());
+  MemoryContext context = TopMemoryContext;
+  CurrentMemoryContext = nullptr;
+  TopMemoryContext = nullptr;
+  ZETASQL_RET_CHECK_OK(CheckedPgMemoryContextDelete(context));
+
+  // Clear thread-local freelists as well
+  ZETASQL_RET_CHECK_OK(CheckedPgAsetDeleteFreelists());
+
+  return absl::OkStatus();
+}
+
+namespace {
+
+// A reset memory context kept by a thread between uses. There is at most one
+// per thread since only one context can occupy the thread's slots at a time.
+class PooledMemoryContext {
+ public:
+  // Deletes the kept context when the thread exits.
+  ~PooledMemoryContext() {
+    if (context_ == nullptr) {
+      return;
+    }
+    CurrentMemoryContext = context_;
+    TopMemoryContext = context_;
+    context_ = nullptr;
+    absl::Status status = DeleteCurrentMemoryContext();
+    if (!status.ok()) {
+      ABSL_LOG(ERROR) << "Pooled MemoryContext cleanup failed: "
+                      << status.message();
+    }
+  }
+
+  // Returns the kept context, leaving none kept.
+  MemoryContext Take() { return std::exchange(context_, nullptr); }
+
+  void Put(MemoryContext context) { context_ = context; }
+
+  bool has_context() const { return context_ != nullptr; }
+
+ private:
+  MemoryContext context_ = nullptr;
+};
+
+thread_local PooledMemoryContext pooled_memory_context;
+
+}  // namespace
+
 absl::Status MemoryContextManager::Reset() {
   ZETASQL_RET_CHECK_NE(CurrentMemoryContext, nullptr) << "No memory context in slot.";
 
@@ -102,18 +169,28 @@ absl::Status MemoryContextManager::Reset() {
 }
 
 absl::Status MemoryContextManager::Clear() {
+  return DeleteCurrentMemoryContext();
+}
+
+absl::StatusOr<bool> MemoryContextManager::ResetIntoPool() {
   ZETASQL_RET_CHECK_NE(CurrentMemoryContext, nullptr) << "No memory context in slot.";
 
-  ZETASQL_RET_CHECK_OK(DeleteCacheMemoryContext());
-  MemoryContext context = TopMemoryContext;
+  const int64_t max_bytes =
+      absl::GetFlag(FLAGS_spangres_pooled_memory_context_max_bytes);
+  if (max_bytes <= 0 || pooled_memory_context.has_context() ||
+      MemoryContextMemAllocated(TopMemoryContext, /*recurse=*/true) >
+          static_cast<Size>(max_bytes)) {
+    return false;
+  }
+  ZETASQL_RETURN_IF_ERROR(Reset());
+  pooled_memory_context.Put(TopMemoryContext);
   CurrentMemoryContext = nullptr;
   TopMemoryContext = nullptr;
-  ZETASQL_RET_CHECK_OK(CheckedPgMemoryContextDelete(context));
-
-  // Clear thread-local freelists as well
-  ZETASQL_RET_CHECK_OK(CheckedPgAsetDeleteFreelists());
+  return true;
+}
 
-  return absl::OkStatus();
+bool MemoryContextManager::HasPooledContext() {
+  return pooled_memory_context.has_context();
 }
 
 absl::StatusOr<MemoryContext> MemoryContextManager::CreateDefaultMemoryContext(
@@ -131,6 +208,17 @@ ActiveMemoryContext::ActiveMemoryContext() {
 
 ActiveMemoryContext::~ActiveMemoryContext() {
   absl::MutexLock lock(&mu_);
+  if (active_memory_context_.has_value() && CheckSameThread().ok()) {
+    absl::StatusOr<bool> pooled = MemoryContextManager::ResetIntoPool();
+    if (pooled.ok() && *pooled) {
+      active_memory_context_ = absl::nullopt;
+      return;
+    }
+    if (!pooled.ok()) {
+      ABSL_LOG(ERROR) << "MemoryContext reset failed: "
+                      << pooled.status().message();
+    }
+  }
   ClearAndLogErrors();
 }
 
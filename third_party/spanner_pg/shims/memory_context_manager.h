@@ -32,8 +32,10 @@
 #ifndef SHIMS_MEMORY_CONTEXT_MANAGER_H_
 #define SHIMS_MEMORY_CONTEXT_MANAGER_H_
 
+#include <cstdint>
 #include <string>
 
+#include "absl/flags/declare.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
@@ -41,16 +43,21 @@
 
 typedef struct MemoryContextData* MemoryContext;
 
+ABSL_DECLARE_FLAG(int64_t, spangres_pooled_memory_context_max_bytes);
+
 namespace postgres_translator {
 
 // Represents a PG MemoryContext that is active in the current thread (i.e.
 // occupies the relevant thread local variables within PG).
 class ActiveMemoryContext {
  public:
-  // Calls Clear(), logging and swallowing any non-ok status returned. See note
-  // on Clear() about which thread it can be called in. Since we swallow any
-  // failed status, calling this on a thread other than the one where this
-  // instance was initialized can lead to leaks.
+  // Resets the context and keeps it for the next MemoryContextManager::Init()
+  // on this thread if it is small enough (see
+  // --spangres_pooled_memory_context_max_bytes), and calls Clear() otherwise,
+  // logging and swallowing any non-ok status returned. See note on Clear()
+  // about which thread it can be called in. Since we swallow any failed
+  // status, calling this on a thread other than the one where this instance
+  // was initialized can lead to leaks.
   ~ActiveMemoryContext();
 
   // Not copyable
@@ -135,13 +142,17 @@ class ActiveMemoryContext {
 // call Clear().
 class MemoryContextManager {
  public:
-  // Creates a default context named 'name' and sets CurrentMemoryContext to it.
+  // Creates a default context named 'name' and sets CurrentMemoryContext to it,
+  // reusing the context last released on this thread if it was kept.
   // Must be called before using the PostgreSQL memory subsystem.
   // `name` is used in debug information and must be statically allocated (or at
   // least outlive the context).
   // If a context already exists, does nothing and returns an error.
   static absl::StatusOr<ActiveMemoryContext> Init(const char* name);
 
+  // Returns true if a released context is kept for reuse on this thread.
+  static bool HasPooledContext();
+
   // Size constants for initial allocation amount, first block size, and largest
   // pooled block size allocated by this memory context.
   static constexpr size_t kMinContextSize = 0;
@@ -158,6 +169,10 @@ class MemoryContextManager {
   // CurrentMemoryContext nulled. After calling this, must call Init() before
   // using the PostgreSQL memory subsystem.
   static absl::Status Clear();
+  // Resets the context and moves it out of the thread's slots, to be reused by
+  // the next Init() on this thread. Returns false and does nothing if the
+  // context is over the pooling limit, in which case it must be cleared.
+  static absl::StatusOr<bool> ResetIntoPool();
   // Internal helper function to create the default-spec context.
   static absl::StatusOr<MemoryContext> CreateDefaultMemoryContext(
       const char* name);
@@ -38,6 +38,7 @@
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
 #include "absl/status/status.h"
 #include "third_party/spanner_pg/postgres_includes/all.h"
 #include "third_party/spanner_pg/shims/memory_reservation_holder.h"
@@ -98,5 +99,59 @@ TEST(MemoryContextTest, ContextWithChild) {
   MemoryContextReset(child);
   MemoryContextDelete(child);
 }
+
+TEST(MemoryContextTest, ReleasedContextIsReused) {
+  auto res_manager = std::make_unique<StubMemoryReservationManager>();
+  auto res_holder = MemoryReservationHolder::Create(res_manager.get());
+  MemoryContext released;
+  {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(ActiveMemoryContext context,
+                         MemoryContextManager::Init("TestMemoryContext"));
+    released = CurrentMemoryContext;
+    EXPECT_NE(palloc(100), nullptr);
+  }
+  // The released context is kept out of the thread's slots.
+  EXPECT_EQ(CurrentMemoryContext, nullptr);
+  EXPECT_EQ(TopMemoryContext, nullptr);
+  EXPECT_TRUE(MemoryContextManager::HasPooledContext());
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(ActiveMemoryContext context,
+                       MemoryContextManager::Init("ReusedMemoryContext"));
+  EXPECT_EQ(CurrentMemoryContext, released);
+  EXPECT_FALSE(MemoryContextManager::HasPooledContext());
+  EXPECT_TRUE(MemoryContextIsEmpty(CurrentMemoryContext));
+  EXPECT_NE(palloc(10), nullptr);
+
+  // An explicitly cleared context is never kept.
+  ZETASQL_ASSERT_OK(context.Clear());
+  EXPECT_FALSE(MemoryContextManager::HasPooledContext());
+}
+
+TEST(MemoryContextTest, LargeReleasedContextIsDeleted) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_spangres_pooled_memory_context_max_bytes, 64 * 1024);
+  auto res_manager = std::make_unique<StubMemoryReservationManager>();
+  auto res_holder = MemoryReservationHolder::Create(res_manager.get());
+  {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(ActiveMemoryContext context,
+                         MemoryContextManager::Init("TestMemoryContext"));
+    EXPECT_NE(palloc(1024 * 1024), nullptr);
+  }
+  EXPECT_EQ(CurrentMemoryContext, nullptr);
+  EXPECT_FALSE(MemoryContextManager::HasPooledContext());
+}
+
+TEST(MemoryContextTest, ReleasedContextIsDeletedWhenPoolingIsDisabled) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_spangres_pooled_memory_context_max_bytes, 0);
+  auto res_manager = std::make_unique<StubMemoryReservationManager>();
+  auto res_holder = MemoryReservationHolder::Create(res_manager.get());
+  {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(ActiveMemoryContext context,
+                         MemoryContextManager::Init("TestMemoryContext"));
+  }
+  EXPECT_EQ(CurrentMemoryContext, nullptr);
+  EXPECT_FALSE(MemoryContextManager::HasPooledContext());
+}
 }  // namespace
 }  // namespace postgres_translator
@@ -31,7 +31,12 @@
 
 #include "third_party/spanner_pg/shims/timezone_helper.h"
 
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "third_party/spanner_pg/postgres_includes/all.h"
@@ -43,6 +48,53 @@ namespace postgres_translator {
 constexpr inline absl::string_view gmt_timezone = "GMT";
 constexpr inline absl::string_view utc_timezone = "UTC";
 
+namespace {
+
+// Timezone data loaded from the tz database, keyed by the requested name. The
+// entries are copies made outside of any memory context, so they outlive the
+// context that loaded them and are shared read-only by all threads. They are
+// never freed; only successfully loaded timezones are kept, which bounds the
+// map by the size of the tz database.
+ABSL_CONST_INIT absl::Mutex shared_timezones_mu(absl::kConstInit);
+absl::flat_hash_map<std::string, pg_tz*>* shared_timezones
+    ABSL_GUARDED_BY(shared_timezones_mu) = nullptr;
+
+// Returns the shared timezone data for `time_zone_name`, loading it with
+// `pg_tzset` on first use. Returns nullptr if the timezone is unknown.
+absl::StatusOr<pg_tz*> GetSharedTimezone(const char* time_zone_name) {
+  {
+    absl::ReaderMutexLock lock(&shared_timezones_mu);
+    if (shared_timezones != nullptr) {
+      auto it = shared_timezones->find(time_zone_name);
+      if (it != shared_timezones->end()) {
+        return it->second;
+      }
+    }
+  }
+
+  ZETASQL_ASSIGN_OR_RETURN(pg_tz* loaded, CheckedPgTZSet(time_zone_name));
+  if (loaded == nullptr) {
+    return nullptr;
+  }
+  absl::MutexLock lock(&shared_timezones_mu);
+  if (shared_timezones == nullptr) {
+    shared_timezones = new absl::flat_hash_map<std::string, pg_tz*>();
+  }
+  auto it = shared_timezones->find(time_zone_name);
+  if (it != shared_timezones->end()) {
+    return it->second;
+  }
+  pg_tz* shared = pg_tz_copy_unmanaged(loaded);
+  if (shared == nullptr) {
+    // Fall back to this context's copy; it is still valid for this use.
+    return loaded;
+  }
+  shared_timezones->emplace(time_zone_name, shared);
+  return shared;
+}
+
+}  // namespace
+
 absl::Status InitTimezone(const char* time_zone_name) {
   ZETASQL_RET_CHECK_NE(CurrentMemoryContext, nullptr)
       << "Must set up memory contexts on this thread before initializing "
@@ -52,7 +104,8 @@ absl::Status InitTimezone(const char* time_zone_name) {
   if (time_zone_name && *time_zone_name &&
       absl::string_view(time_zone_name) != gmt_timezone &&
       absl::string_view(time_zone_name) != utc_timezone) {
-    ZETASQL_ASSIGN_OR_RETURN(session_timezone, CheckedPgTZSet(time_zone_name));
+    ZETASQL_ASSIGN_OR_RETURN(session_timezone,
+                     GetSharedTimezone(time_zone_name));
     log_timezone = session_timezone;
   } else {
     // Initializes session_timezone as "GMT".
@@ -43,7 +43,9 @@ namespace postgres_translator {
 // until the context is cleaned up.
 
 // Sets up PostgreSQL's thread-local timezone data (`session_timezone`,
-// `log_timezone`, and `timezone_cache`) on this thread.
+// `log_timezone`, and `timezone_cache`) on this thread. Named timezones other
+// than GMT and UTC are loaded from the tz database once per process and shared
+// read-only by all threads afterwards.
 absl::Status InitTimezone(const char* time_zone_name = nullptr);
 
 // Sets up PostgreSQL's thread-local timezone data (`session_timezone`,
@@ -140,5 +140,33 @@ TEST(TimezoneHelperTest, InitTimezoneOffset) {
   EXPECT_EQ(log_timezone, nullptr);
   ZETASQL_EXPECT_OK(memory_context.Clear());
 }
+
+// Named timezones are loaded once and outlive the context that loaded them.
+TEST(TimezoneHelperTest, SharesNamedTimezoneAcrossContexts) {
+  auto reservation_manager =
+      std::make_unique<postgres_translator::StubMemoryReservationManager>();
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      MemoryReservationHolder memory_reservation_holder,
+      MemoryReservationHolder::Create(reservation_manager.get()));
+
+  pg_tz* first_timezone = nullptr;
+  {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(auto memory_context,
+                         MemoryContextManager::Init("first"));
+    ZETASQL_ASSERT_OK(InitTimezone("America/Los_Angeles"));
+    first_timezone = session_timezone;
+    CleanupTimezone();
+    ZETASQL_ASSERT_OK(memory_context.Clear());
+  }
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto memory_context,
+                       MemoryContextManager::Init("second"));
+  ZETASQL_ASSERT_OK(InitTimezone("America/Los_Angeles"));
+  EXPECT_EQ(session_timezone, first_timezone);
+  EXPECT_EQ(log_timezone, first_timezone);
+  EXPECT_STREQ(pg_get_timezone_name(session_timezone), "America/Los_Angeles");
+  CleanupTimezone();
+  ZETASQL_EXPECT_OK(memory_context.Clear());
+}
 }  // namespace
 }  // namespace postgres_translator
@@ -98,6 +98,7 @@
 
 // SPANGRES BEGIN
 #include "common/int.h"
+#include "third_party/spanner_pg/shims/format_picture_cache.h"
 #include "third_party/spanner_pg/shims/pg_locale_shim.h"
 // SPANGRES END
 
@@ -4040,6 +4041,17 @@ DCH_cache_fetch(const char *str, bool std)
 {
 	DCHCacheEntry *ent;
 
+	// SPANGRES BEGIN
+	// Prefer the process-wide copy of the parsed picture. Callers only read
+	// `format` from the returned entry, so the shared entry stays immutable.
+	FormatPictureKind kind =
+		std ? FORMAT_PICTURE_DATETIME_STD : FORMAT_PICTURE_DATETIME;
+
+	ent = (DCHCacheEntry *) GetSharedFormatPicture(kind, str);
+	if (ent != NULL)
+		return ent;
+	// SPANGRES END
+
 	if ((ent = DCH_cache_search(str, std)) == NULL)
 	{
 		/*
@@ -4053,6 +4065,16 @@ DCH_cache_fetch(const char *str, bool std)
 					 DCH_FLAG | (std ? STD_FLAG : 0), NULL);
 
 		ent->valid = true;
+
+		// SPANGRES BEGIN
+		{
+			DCHCacheEntry *shared = (DCHCacheEntry *)
+				ShareFormatPicture(kind, str, ent, sizeof(DCHCacheEntry));
+
+			if (shared != NULL)
+				return shared;
+		}
+		// SPANGRES END
 	}
 	return ent;
 }
@@ -5085,6 +5107,14 @@ NUM_cache_fetch(const char *str)
 {
 	NUMCacheEntry *ent;
 
+	// SPANGRES BEGIN
+	// Prefer the process-wide copy of the parsed picture. Callers only read
+	// `format` and `Num` from the returned entry.
+	ent = (NUMCacheEntry *) GetSharedFormatPicture(FORMAT_PICTURE_NUMBER, str);
+	if (ent != NULL)
+		return ent;
+	// SPANGRES END
+
 	if ((ent = NUM_cache_search(str)) == NULL)
 	{
 		/*
@@ -5100,6 +5130,17 @@ NUM_cache_fetch(const char *str)
 					 NULL, NUM_index, NUM_FLAG, &ent->Num);
 
 		ent->valid = true;
+
+		// SPANGRES BEGIN
+		{
+			NUMCacheEntry *shared = (NUMCacheEntry *)
+				ShareFormatPicture(FORMAT_PICTURE_NUMBER, str, ent,
+								   sizeof(NUMCacheEntry));
+
+			if (shared != NULL)
+				return shared;
+		}
+		// SPANGRES END
 	}
 	return ent;
 }
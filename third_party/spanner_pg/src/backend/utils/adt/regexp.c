@@ -108,10 +108,21 @@ typedef struct cached_re_str
 	int			cre_flags;		/* compile flags: extended,icase etc */
 	Oid			cre_collation;	/* collation to use */
 	regex_t		cre_re;			/* the compiled regular expression */
+	// SPANGRES BEGIN
+	// Holds `cre_pat` and the allocations of `cre_re`, so that the entry
+	// outlives the memory context of the call that compiled it.
+	MemoryContext cre_context;
+	// SPANGRES END
 } cached_re_str;
 
 static __thread int	num_res = 0;		/* # of cached re's */
 static __thread cached_re_str re_array[MAX_CACHED_RES];	/* cached re's */
+// SPANGRES BEGIN
+// Parent of the entries' `cre_context`s. This is a root context rather than a
+// child of TopMemoryContext because TopMemoryContext belongs to the PG arena
+// of the current call, while the cache is kept on the thread across calls.
+static __thread MemoryContext RegexpCacheMemoryContext = NULL;
+// SPANGRES END
 
 
 /* Local functions */
@@ -134,9 +145,10 @@ static Datum build_regexp_split_result(regexp_matches_ctx *splitctx);
 // encapsulation, we thought better to add the function directly here
 // than to copy all the functions that required it into a separate shim file.
 void CleanupCompiledRegexCache() {
-	for (int i = 0; i < num_res; ++i) {
-		pg_regfree(&re_array[i].cre_re);
-		pfree(re_array[i].cre_pat);
+	if (RegexpCacheMemoryContext != NULL) {
+		/* Deleting the parent deletes every entry's memory context. */
+		MemoryContextDelete(RegexpCacheMemoryContext);
+		RegexpCacheMemoryContext = NULL;
 	}
 	num_res = 0;
 }
@@ -165,6 +177,9 @@ RE_compile_and_cache(text *text_re, int cflags, Oid collation)
 	int			regcomp_result;
 	cached_re_str re_temp;
 	char		errMsg[100];
+	// SPANGRES BEGIN
+	MemoryContext oldcontext;
+	// SPANGRES END
 
 	/*
 	 * Look for a match among previously compiled REs.  Since the data
@@ -197,6 +212,21 @@ RE_compile_and_cache(text *text_re, int cflags, Oid collation)
 	 * resources on failure, we build into the re_temp local.
 	 */
 
+	// SPANGRES BEGIN
+	// Compile into a memory context of the entry's own. It starts out as a
+	// child of the current memory context so that it is cleaned up with the
+	// current call if compilation throws an ERROR, and is moved under the
+	// thread's cache context once the entry is complete.
+	if (RegexpCacheMemoryContext == NULL)
+		RegexpCacheMemoryContext =
+			AllocSetContextCreate(NULL, "RegexpCacheMemoryContext",
+								  ALLOCSET_SMALL_SIZES);
+	re_temp.cre_context = AllocSetContextCreate(CurrentMemoryContext,
+												"RegexpMemoryContext",
+												ALLOCSET_SMALL_SIZES);
+	oldcontext = MemoryContextSwitchTo(re_temp.cre_context);
+	// SPANGRES END
+
 	/* Convert pattern string to wide characters */
 	pattern = (pg_wchar *) palloc((text_re_len + 1) * sizeof(pg_wchar));
 	pattern_len = pg_mb2wchar_with_len(text_re_val,
@@ -214,6 +244,9 @@ RE_compile_and_cache(text *text_re, int cflags, Oid collation)
 	if (regcomp_result != REG_OKAY)
 	{
 		/* re didn't compile (no need for pg_regfree, if so) */
+		// SPANGRES BEGIN
+		MemoryContextSwitchTo(oldcontext);
+		// SPANGRES END
 
 		/*
 		 * Here and in other places in this file, do CHECK_FOR_INTERRUPTS
@@ -224,6 +257,9 @@ RE_compile_and_cache(text *text_re, int cflags, Oid collation)
 		CHECK_FOR_INTERRUPTS();
 
 		pg_regerror(regcomp_result, &re_temp.cre_re, errMsg, sizeof(errMsg));
+		// SPANGRES BEGIN
+		MemoryContextDelete(re_temp.cre_context);
+		// SPANGRES END
 		ereport(ERROR,
 				(errcode(ERRCODE_INVALID_REGULAR_EXPRESSION),
 				 errmsg("invalid regular expression: %s", errMsg)));
@@ -231,10 +267,13 @@ RE_compile_and_cache(text *text_re, int cflags, Oid collation)
 
 	// SPANGRES BEGIN
 	re_temp.cre_pat = palloc(Max(text_re_len, 1));
+	MemoryContextSwitchTo(oldcontext);
 	// SPANGRES END
 	if (re_temp.cre_pat == NULL)
 	{
-		pg_regfree(&re_temp.cre_re);
+		// SPANGRES BEGIN
+		MemoryContextDelete(re_temp.cre_context);
+		// SPANGRES END
 		ereport(ERROR,
 				(errcode(ERRCODE_OUT_OF_MEMORY),
 				 errmsg("out of memory")));
@@ -252,12 +291,16 @@ RE_compile_and_cache(text *text_re, int cflags, Oid collation)
 	{
 		--num_res;
 		Assert(num_res < MAX_CACHED_RES);
-		pg_regfree(&re_array[num_res].cre_re);
 		// SPANGRES BEGIN
-		pfree(re_array[num_res].cre_pat);
+		// Frees both the compiled regex and its pattern.
+		MemoryContextDelete(re_array[num_res].cre_context);
 		// SPANGRES END
 	}
 
+	// SPANGRES BEGIN
+	MemoryContextSetParent(re_temp.cre_context, RegexpCacheMemoryContext);
+	// SPANGRES END
+
 	if (num_res > 0)
 		memmove(&re_array[1], &re_array[0], num_res * sizeof(cached_re_str));
 
@@ -84,6 +84,7 @@ extern size_t pg_strftime(char *s, size_t max, const char *format,
 // Make these globals thread-locals and add a cleanup function.
 // See pgtz.c for more background.
 void ClearTimezoneHashtablePointer();
+extern pg_tz *pg_tz_copy_unmanaged(const pg_tz *tz);
 extern __thread PGDLLIMPORT pg_tz *session_timezone;
 extern __thread PGDLLIMPORT pg_tz *log_timezone;
 /* SPANGRES END */
@@ -223,6 +223,18 @@ typedef struct
 static __thread HTAB *timezone_cache = NULL;
 void ClearTimezoneHashtablePointer() { timezone_cache = NULL; }
 bool TimezoneCleared() { return timezone_cache == NULL; }
+
+// Returns a copy of `tz` allocated with malloc() rather than in a memory
+// context, so that it can outlive the context that loaded it and be shared
+// read-only across threads. Returns NULL when out of memory.
+pg_tz *pg_tz_copy_unmanaged(const pg_tz *tz)
+{
+	pg_tz	   *copy = malloc(sizeof(pg_tz));
+
+	if (copy != NULL)
+		memcpy(copy, tz, sizeof(pg_tz));
+	return copy;
+}
 /* SPANGRES END */
 
 static bool
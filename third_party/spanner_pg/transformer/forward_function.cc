@@ -128,6 +128,42 @@ MakeResolvedFunctionCall(
       std::move(argument_list), error_mode);
 }
 
+absl::StatusOr<FunctionAndSignature>
+ForwardTransformer::GetFunctionAndSignature(
+    Oid proc_oid,
+    const std::vector<zetasql::InputArgumentType>& input_argument_types) {
+  // Literals, parameters and untyped arguments can coerce differently than
+  // other values of their type, so only resolutions where every argument is a
+  // typed expression are memoized.
+  FunctionSignatureKey key{proc_oid, {}};
+  bool memoize = true;
+  key.second.reserve(input_argument_types.size());
+  for (const zetasql::InputArgumentType& input_arg : input_argument_types) {
+    if (input_arg.is_literal() || input_arg.is_query_parameter() ||
+        input_arg.is_untyped() || input_arg.type() == nullptr) {
+      memoize = false;
+      break;
+    }
+    key.second.push_back(input_arg.type());
+  }
+  if (memoize) {
+    auto it = function_signature_cache_.find(key);
+    if (it != function_signature_cache_.end()) {
+      return it->second;
+    }
+  }
+
+  ZETASQL_ASSIGN_OR_RETURN(
+      FunctionAndSignature function_and_signature,
+      catalog_adapter_->GetEngineSystemCatalog()->GetFunctionAndSignature(
+          proc_oid, input_argument_types,
+          catalog_adapter_->analyzer_options().language()));
+  if (memoize) {
+    function_signature_cache_.emplace(std::move(key), function_and_signature);
+  }
+  return function_and_signature;
+}
+
 absl::StatusOr<std::unique_ptr<zetasql::ResolvedFunctionCall>>
 ForwardTransformer::BuildGsqlResolvedFunctionCall(
     Oid funcid, List* args, ExprTransformerInfo* expr_transformer_info) {
@@ -172,9 +208,7 @@ ForwardTransformer::BuildGsqlResolvedFunctionCall(
       GetInputArgumentTypes(argument_list);
   ZETASQL_ASSIGN_OR_RETURN(
       FunctionAndSignature function_and_signature,
-      catalog_adapter_->GetEngineSystemCatalog()->GetFunctionAndSignature(
-          funcid, input_argument_types,
-          catalog_adapter_->analyzer_options().language()));
+      GetFunctionAndSignature(funcid, input_argument_types));
 
   return MakeResolvedFunctionCall(function_and_signature,
                                   std::move(argument_list));
@@ -238,9 +272,7 @@ ForwardTransformer::BuildGsqlSubstrFunctionCall(
       GetInputArgumentTypes(argument_list);
   ZETASQL_ASSIGN_OR_RETURN(
       FunctionAndSignature function_and_signature,
-      catalog_adapter_->GetEngineSystemCatalog()->GetFunctionAndSignature(
-          substring_oid, input_argument_types,
-          catalog_adapter_->analyzer_options().language()));
+      GetFunctionAndSignature(substring_oid, input_argument_types));
 
   return MakeResolvedFunctionCall(function_and_signature,
                                   std::move(argument_list));
@@ -283,9 +315,7 @@ ForwardTransformer::BuildGsqlResolvedAggregateFunctionCall(
       GetInputArgumentTypes(argument_list);
   ZETASQL_ASSIGN_OR_RETURN(
       FunctionAndSignature function_and_signature,
-      catalog_adapter_->GetEngineSystemCatalog()->GetFunctionAndSignature(
-          funcid, input_argument_types,
-          catalog_adapter_->analyzer_options().language()));
+      GetFunctionAndSignature(funcid, input_argument_types));
 
   // Set aggregation to true.
   local_expr_transformer_info.has_aggregation = true;
@@ -1149,9 +1179,7 @@ ForwardTransformer::BuildGsqlResolvedArraySliceFunctionCall(
 
     ZETASQL_ASSIGN_OR_RETURN(
         FunctionAndSignature array_upper_function_and_signature,
-        catalog_adapter_->GetEngineSystemCatalog()->GetFunctionAndSignature(
-            F_ARRAY_UPPER, upper_bound_arg_types,
-            catalog_adapter_->analyzer_options().language()));
+        GetFunctionAndSignature(F_ARRAY_UPPER, upper_bound_arg_types));
     upper_index = MakeResolvedFunctionCall(array_upper_function_and_signature,
                                            std::move(upper_bound_arg_list));
   } else {
@@ -59,6 +59,7 @@
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "third_party/spanner_pg/catalog/catalog_adapter.h"
+#include "third_party/spanner_pg/catalog/function.h"
 #include "third_party/spanner_pg/postgres_includes/all.h"
 #include "third_party/spanner_pg/datatypes/extended/pg_jsonb_type.h"
 #include "third_party/spanner_pg/transformer/expr_transformer_helper.h"
@@ -733,6 +734,14 @@ class ForwardTransformer {
       ExprTransformerInfo* expr_transformer_info, const Expr* ast_expr);
 
   // Function ==================================================================
+  // Looks up the function and signature for `proc_oid` in the
+  // EngineSystemCatalog. Resolutions for arguments that are neither literals
+  // nor parameters only depend on the argument types, so those are memoized
+  // for the lifetime of this transformer.
+  absl::StatusOr<FunctionAndSignature> GetFunctionAndSignature(
+      Oid proc_oid,
+      const std::vector<zetasql::InputArgumentType>& input_argument_types);
+
   absl::StatusOr<std::unique_ptr<zetasql::ResolvedFunctionCall>>
   BuildGsqlResolvedFunctionCall(Oid funcid, List* args,
                                 ExprTransformerInfo* expr_transformer_info);
@@ -902,7 +911,8 @@ class ForwardTransformer {
 
   // Type ======================================================================
   // If the result PostgresTypeMapping has mapped_type, returns the
-  // mapped_type. Otherwise returns a PostgresTypeMapping.
+  // mapped_type. Otherwise returns a PostgresTypeMapping. Successful lookups
+  // are memoized for the lifetime of this transformer.
   absl::StatusOr<const zetasql::Type*> BuildGsqlType(const Oid pg_type_oid);
 
   // Other =====================================================================
@@ -1017,6 +1027,16 @@ class ForwardTransformer {
 
   const VarIndexScope empty_var_index_scope_;
 
+  // Memoized GetFunctionAndSignature() resolutions, keyed by proc oid and
+  // argument types. Wide statements resolve the same operators and casts for
+  // many expressions.
+  using FunctionSignatureKey =
+      std::pair<Oid, std::vector<const zetasql::Type*>>;
+  absl::flat_hash_map<FunctionSignatureKey, FunctionAndSignature>
+      function_signature_cache_;
+  // Memoized BuildGsqlType() results, keyed by PostgreSQL type oid.
+  absl::flat_hash_map<Oid, const zetasql::Type*> gsql_type_cache_;
+
   // Query-level internal data structures --------------------------------------
   // The following data structures are used to keep track of the transformer's
   // internal states during forward/reverse transformation. They are defined
@@ -58,6 +58,10 @@ absl::StatusOr<const zetasql::Type*> ForwardTransformer::BuildGsqlType(
         "Unable to resolve argument type. "
         "Please consider adding an explicit cast");
   }
+  auto it = gsql_type_cache_.find(pg_type_oid);
+  if (it != gsql_type_cache_.end()) {
+    return it->second;
+  }
   EngineSystemCatalog* engine_system_catalog =
       catalog_adapter_->GetEngineSystemCatalog();
   const PostgresTypeMapping* pg_type_mapping =
@@ -70,10 +74,11 @@ absl::StatusOr<const zetasql::Type*> ForwardTransformer::BuildGsqlType(
         absl::StrCat("The Postgres Type is not supported: ", type_name));
   }
 
-  if (pg_type_mapping->mapped_type()) {
-    return pg_type_mapping->mapped_type();
-  }
-  return pg_type_mapping;
+  const zetasql::Type* gsql_type = pg_type_mapping->mapped_type() != nullptr
+                                       ? pg_type_mapping->mapped_type()
+                                       : pg_type_mapping;
+  gsql_type_cache_.emplace(pg_type_oid, gsql_type);
+  return gsql_type;
 }
 
 }  // namespace postgres_translator
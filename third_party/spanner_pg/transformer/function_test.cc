@@ -282,6 +282,48 @@ TEST_F(FunctionTransformerTest, PgToGsqlFunctionSignatureNotFound) {
               StatusIs(absl::StatusCode::kUnimplemented,
                        testing::HasSubstr("Type is not supported")));
 }
+
+TEST_F(FunctionTransformerTest, PgToGsqlRepeatedFunctionsOfExpressions) {
+  VarIndexScope var_index_scope;
+  ExprTransformerInfo expr_transformer_info =
+      ExprTransformerInfo::ForScalarFunctions(&var_index_scope,
+                                              /*clause_name=*/"");
+
+  // floor(sign(double)). The argument of floor is not a literal, so its
+  // resolution is memoized by the transformer and reused the second time.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      Const* pi_const,
+      internal::makeScalarConst(FLOAT8OID, Float8GetDatum(3.141592653589793),
+                                /*constisnull=*/false));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      FuncExpr* sign_func,
+      internal::makeFuncExpr(2310, FLOAT8OID,
+                             list_make1(PostgresCastToExpr(pi_const)),
+                             COERCE_EXPLICIT_CALL));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      FuncExpr* floor_func,
+      internal::makeFuncExpr(2309, FLOAT8OID,
+                             list_make1(PostgresCastToExpr(sign_func)),
+                             COERCE_EXPLICIT_CALL));
+
+  std::vector<std::unique_ptr<const zetasql::ResolvedExpr>> sign_call;
+  sign_call.push_back(MakeResolvedFunctionCall(sign_function_.get(),
+                                               sign_function_->GetSignature(0),
+                                               MakeDoubleLiteralArgument()));
+  std::unique_ptr<zetasql::ResolvedFunctionCall> expected =
+      MakeResolvedFunctionCall(floor_function_.get(),
+                               floor_function_->GetSignature(0),
+                               std::move(sign_call));
+  for (int i = 0; i < 2; ++i) {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<zetasql::ResolvedFunctionCall> result,
+        forward_transformer_->BuildGsqlResolvedFunctionCall(
+            *floor_func, &expr_transformer_info));
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->DebugString(), expected->DebugString());
+  }
+}
+
 }  // namespace
 }  // namespace postgres_translator::spangres::test
 